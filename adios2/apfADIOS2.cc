@@ -0,0 +1,181 @@
+#include "apfADIOS2.h"
+#include <apf.h>
+#include <apfNumbering.h>
+#include <apfShape.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <adios2.h>
+#include <cstdio>
+#include <stdint.h>
+
+namespace apf {
+
+struct ADIOS2Output
+{
+  ADIOS2Output(const char* config)
+  {
+    if (config)
+      adios = new adios2::ADIOS(config, PCU_Get_Comm());
+    else
+      adios = new adios2::ADIOS(PCU_Get_Comm());
+  }
+  ~ADIOS2Output()
+  {
+    delete adios;
+  }
+  adios2::ADIOS* adios;
+  adios2::IO io;
+  adios2::Engine engine;
+};
+
+ADIOS2Output* openADIOS2Output(const char* name, const char* config)
+{
+  ADIOS2Output* o = new ADIOS2Output(config);
+  o->io = o->adios->DeclareIO("apf");
+  if (!o->io.InConfigFile())
+    o->io.SetEngine("BP5");
+  o->engine = o->io.Open(name, adios2::Mode::Write);
+  return o;
+}
+
+void closeADIOS2Output(ADIOS2Output* o)
+{
+  o->engine.Close();
+  delete o;
+}
+
+/* one block of a global array, placed after the blocks of the
+   lower ranks. Arrays of (width) one are one dimensional */
+template <class T>
+static void putBlock(ADIOS2Output* o, const char* name,
+    std::vector<T> const& data, size_t width)
+{
+  size_t rows = data.size() / width;
+  long total = PCU_Add_Long(rows);
+  long first = PCU_Exscan_Long(rows);
+  adios2::Dims shape(1, total);
+  adios2::Dims start(1, first);
+  adios2::Dims count(1, rows);
+  if (width > 1) {
+    shape.push_back(width);
+    start.push_back(0);
+    count.push_back(width);
+  }
+  adios2::Variable<T> v = o->io.InquireVariable<T>(name);
+  if (!v)
+    v = o->io.DefineVariable<T>(name, shape, start, count);
+  v.SetShape(shape);
+  v.SetSelection(adios2::Box<adios2::Dims>(start, count));
+  o->engine.Put(v, data.empty() ? 0 : &data[0], adios2::Mode::Sync);
+}
+
+static int const vtkTypes[Mesh::TYPES][2] =
+  {{ 1,-1}//vertex
+  ,{ 3,21}//edge
+  ,{ 5,22}//triangle
+  ,{ 9,23}//quad
+  ,{10,24}//tet
+  ,{12,25}//hex
+  ,{13,-1}//prism
+  ,{14,-1}//pyramid
+};
+
+/* the cells as apfVtk.cc writes them: connectivity from the shared
+   table of the mesh, node numbers offset by the nodes of the lower
+   ranks so they count across all the blocks */
+static void putCells(ADIOS2Output* o, Mesh* m, Numbering* n,
+    long firstNode, int cellDim)
+{
+  Connectivity const& c = m->getConnectivity(cellDim);
+  std::vector<int64_t> conn;
+  std::vector<int64_t> offsets;
+  std::vector<uint8_t> types;
+  std::vector<int32_t> parts;
+  NewArray<int> numbers;
+  int order = m->getShape()->getOrder();
+  for (size_t i = 0; i < c.elements.size(); ++i) {
+    int nen = getElementNumbers(n, c.elements[i], numbers);
+    for (int j = 0; j < nen; ++j)
+      conn.push_back(numbers[j] + firstNode);
+    offsets.push_back(conn.size());
+    types.push_back(vtkTypes[m->getType(c.elements[i])][order - 1]);
+    parts.push_back(PCU_Comm_Self());
+  }
+  long firstConn = PCU_Exscan_Long(conn.size());
+  for (size_t i = 0; i < offsets.size(); ++i)
+    offsets[i] += firstConn;
+  putBlock(o, "connectivity", conn, 1);
+  putBlock(o, "offsets", offsets, 1);
+  putBlock(o, "types", types, 1);
+  putBlock(o, "part", parts, 1);
+}
+
+static void putNodes(ADIOS2Output* o, Mesh* m,
+    DynamicArray<Node> const& nodes)
+{
+  std::vector<double> points(nodes.getSize() * 3);
+  std::vector<int32_t> owners(nodes.getSize());
+  for (size_t i = 0; i < nodes.getSize(); ++i) {
+    Vector3 x;
+    m->getPoint(nodes[i].entity, nodes[i].node, x);
+    x.toArray(&points[i * 3]);
+    owners[i] = m->getOwner(nodes[i].entity);
+  }
+  putBlock(o, "points", points, 3);
+  putBlock(o, "owner", owners, 1);
+}
+
+static void putField(ADIOS2Output* o, Mesh* m, Field* f,
+    DynamicArray<Node> const& nodes, int cellDim)
+{
+  int nc = countComponents(f);
+  std::vector<double> values;
+  if (getShape(f) == m->getShape()) {
+    values.resize(nodes.getSize() * nc);
+    for (size_t i = 0; i < nodes.getSize(); ++i)
+      getComponents(f, nodes[i].entity, nodes[i].node, &values[i * nc]);
+  } else if (getShape(f) == getConstant(cellDim)) {
+    Connectivity const& c = m->getConnectivity(cellDim);
+    values.resize(c.elements.size() * nc);
+    for (size_t i = 0; i < c.elements.size(); ++i)
+      getComponents(f, c.elements[i], 0, &values[i * nc]);
+  } else {
+    return;
+  }
+  putBlock(o, getName(f), values, nc);
+}
+
+void writeADIOS2Step(ADIOS2Output* o, Mesh* m,
+    std::vector<std::string> const& writeFields, int cellDim)
+{
+  double t0 = PCU_Time();
+  if (cellDim == -1)
+    cellDim = m->getDimension();
+  Numbering* n = numberOverlapNodes(m, "apf_adios2_number");
+  DynamicArray<Node> nodes;
+  getNodes(n, nodes);
+  long firstNode = PCU_Exscan_Long(nodes.getSize());
+  o->engine.BeginStep();
+  putNodes(o, m, nodes);
+  putCells(o, m, n, firstNode, cellDim);
+  for (size_t i = 0; i < writeFields.size(); ++i) {
+    Field* f = m->findField(writeFields[i].c_str());
+    if (f)
+      putField(o, m, f, nodes, cellDim);
+  }
+  o->engine.EndStep();
+  destroyNumbering(n);
+  double t1 = PCU_Time();
+  if (!PCU_Comm_Self())
+    printf("ADIOS2 step written in %f seconds\n", t1 - t0);
+}
+
+void writeADIOS2Step(ADIOS2Output* o, Mesh* m, int cellDim)
+{
+  std::vector<std::string> writeFields;
+  for (int i = 0; i < m->countFields(); ++i)
+    writeFields.push_back(getName(m->getField(i)));
+  writeADIOS2Step(o, m, writeFields, cellDim);
+}
+
+}
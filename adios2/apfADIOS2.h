@@ -0,0 +1,49 @@
+#ifndef APF_ADIOS2_H
+#define APF_ADIOS2_H
+
+#include <apfMesh.h>
+#include <string>
+#include <vector>
+
+/** \file apfADIOS2.h
+  \brief experimental ADIOS2 output of meshes and fields
+
+  This interface is built only with ENABLE_ADIOS2=ON, which is off by
+  default, and it is not built or tested by continuous integration.
+  Its array layout and functions may change without notice. */
+
+namespace apf {
+
+/** \brief An open ADIOS2 output stream of meshes and fields */
+struct ADIOS2Output;
+
+/** \brief open an ADIOS2 stream for writing, collectively
+  \param name the file or stream name given to the ADIOS2 engine
+  \param config an optional ADIOS2 XML or YAML file, where the IO
+                named "apf" chooses the engine (for example BP5 with
+                aggregation, or SST for staging) and its parameters.
+                Without one, the BP5 engine is used. */
+ADIOS2Output* openADIOS2Output(const char* name, const char* config = 0);
+
+/** \brief write a mesh and its fields as one step of the stream
+  \details the arrays are those of apf::writeVtkFiles, laid out as
+   global arrays with one block per part:
+   "points" (nodes x 3), "connectivity", "offsets" and "types" of
+   the cells, with node numbers counted across all parts, "part" of
+   each cell and "owner" of each node, then a (nodes x components)
+   array per nodal field whose shape is the mesh shape and a
+   (cells x components) array per field with one node per cell.
+   Every part writes its overlap nodes, as a .vtu piece does.
+   Only fields whose name appears in writeFields are written. */
+void writeADIOS2Step(ADIOS2Output* o, Mesh* m,
+    std::vector<std::string> const& writeFields, int cellDim = -1);
+
+/** \brief see the other apf::writeADIOS2Step, with all fields */
+void writeADIOS2Step(ADIOS2Output* o, Mesh* m, int cellDim = -1);
+
+/** \brief finish the stream and free it, collectively */
+void closeADIOS2Output(ADIOS2Output* o);
+
+}
+
+#endif
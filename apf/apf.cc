@@ -47,6 +47,11 @@ MeshElement* createMeshElement(apf::Field* f, MeshEntity*e)
   return new VectorElement(static_cast<VectorField*>(f), e);
 }
 
+void rebindMeshElement(MeshElement* me, MeshEntity* e)
+{
+  me->rebind(e, 0);
+}
+
 void destroyMeshElement(MeshElement* e)
 {
   delete e;
@@ -88,6 +93,13 @@ Field* createGeneralField(
                    new TagDataOf<double>);
 }
 
+Field* createFloatField(Mesh* m, const char* name, int valueType,
+    int components, FieldShape* shape)
+{
+  return makeField(m, name, valueType, components, shape,
+                   new FloatTagData);
+}
+
 Field* createField(Mesh* m, const char* name, int valueType, FieldShape* shape)
 {
   return createGeneralField(m, name, valueType, 0, shape);
@@ -220,6 +232,11 @@ Element* createElement(Field* f, MeshEntity* e)
   return new Element(f,e);
 }
 
+void rebindElement(Element* e, MeshElement* me)
+{
+  e->rebind(me->getEntity(), me);
+}
+
 void destroyElement(Element* e)
 {
   delete e;
@@ -306,6 +323,34 @@ void mapLocalToGlobal(MeshElement* e, Vector3 const& local, Vector3& global)
   global = e->getValue(local);
 }
 
+bool mapGlobalToLocal(MeshElement* e, Vector3 const& global, Vector3& local)
+{
+  static Vector3 const centers[Mesh::TYPES] =
+  {Vector3(0,0,0)
+  ,Vector3(0,0,0)
+  ,Vector3(1./3,1./3,0)
+  ,Vector3(0,0,0)
+  ,Vector3(.25,.25,.25)
+  ,Vector3(0,0,0)
+  ,Vector3(1./3,1./3,0)
+  ,Vector3(0,0,-.5)};
+  local = centers[e->getType()];
+  /* linear simplices converge in one step,
+     curved elements usually in a few more */
+  const int maxIterations = 20;
+  const double tolerance = 1e-12;
+  for (int i = 0; i < maxIterations; ++i) {
+    Vector3 x = e->getValue(local);
+    Matrix3x3 jinv;
+    getJacobianInv(e, local, jinv);
+    Vector3 step = transpose(jinv) * (global - x);
+    local = local + step;
+    if (step.getLength() < tolerance)
+      return true;
+  }
+  return false;
+}
+
 double getDV(MeshElement* e, Vector3 const& param)
 {
   return e->getDV(param);
@@ -385,7 +430,7 @@ void getMatrixNodes(Element* e, NewArray<Matrix3x3>& values)
 void getShapeValues(Element* e, Vector3 const& local,
     NewArray<double>& values)
 {
-  e->getShape()->getValues(e->getMesh(), e->getEntity(), local,values);
+  e->getShapeValues(local,values);
 }
 
 void getShapeGrads(Element* e, Vector3 const& local,
@@ -442,6 +487,13 @@ void freeze(Field* f)
   freezeFieldData<double>(f);
 }
 
+void freeze(Field* f, Numbering* n)
+{
+  if (getArrayNumbering(f) == n) return;
+  f->getMesh()->hasFrozenFields = true;
+  freezeFieldData<double>(f, n);
+}
+
 void unfreeze(Field* f)
 {
   if (isFrozen(f))
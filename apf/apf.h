@@ -37,6 +37,10 @@ class VectorElement;
 typedef VectorElement MeshElement;
 class FieldShape;
 struct Sharing;
+template <class T>
+class NumberingOf;
+typedef NumberingOf<int> Numbering;
+typedef NumberingOf<long> GlobalNumbering;
 
 /** \brief Destroys an apf::Mesh.
   *
@@ -70,6 +74,15 @@ MeshElement* createMeshElement(Field* c, MeshEntity* e);
   */
 MeshEntity * getMeshEntity(MeshElement * me);
 
+/** \brief Move a Mesh Element to another entity.
+  *
+  * \details The element keeps its storage and only refills it,
+  * so one Mesh Element can visit many entities in a loop
+  * without allocating. Field Elements built on it must be
+  * rebound with apf::rebindElement before they are used again.
+  */
+void rebindMeshElement(MeshElement* me, MeshEntity* e);
+
 /** \brief Destroys a Mesh Element.
   *
   * \details This only destroys the apf::MeshElement object,
@@ -148,6 +161,21 @@ Field* createGeneralField(
     int components,
     FieldShape* shape);
 
+/** \brief Create a field whose values are stored in single precision.
+  \details Values are rounded to float when set and read back as
+  double, so the field works everywhere a general field does, while
+  its storage and migration messages are half the size.
+  Clones of the field keep single precision; freezing and
+  unfreezing it converts it to double storage. The components
+  argument is as for apf::createGeneralField.
+  */
+Field* createFloatField(
+    Mesh* m,
+    const char* name,
+    int valueType,
+    int components,
+    FieldShape* shape);
+
 /** \brief Declare a copy of a field on another apf::Mesh
    \details This will just make a Field object with the same
    properties, but not fill in any data. */
@@ -240,6 +268,14 @@ Element* createElement(Field* f, MeshElement* e);
     function if you know the other one isn't right for you. */
 Element* createElement(Field* f, MeshEntity* e);
 
+/** \brief Move a Field Element to another Mesh Element.
+  *
+  * \details The element refills its node values from the field
+  * over the entity of \a me and keeps its storage, which is not
+  * reallocated when the new entity has as many nodes.
+  */
+void rebindElement(Element* e, MeshElement* me);
+
 /** \brief Destroy a Field Element.
  */
 void destroyElement(Element* e);
@@ -339,6 +375,18 @@ double getIntWeight(MeshElement* e, int order, int point);
   */
 void mapLocalToGlobal(MeshElement* e, Vector3 const& local, Vector3& global);
 
+/** \brief Map a global coordinate to a local coordinate.
+  *
+  * \details inverts apf::mapLocalToGlobal by Newton iterations
+  * from the parent element center, using the Jacobian
+  * pseudo-inverse so that faces in 3D and edges in 2D or 3D
+  * find the local coordinate of the nearest point on them.
+  * The local coordinate may lie outside the parent element.
+  *
+  * \returns false if the iterations did not converge
+  */
+bool mapGlobalToLocal(MeshElement* e, Vector3 const& global, Vector3& local);
+
 /** \brief Get the differential volume at a point.
   *
   * \details This function is meant to provide the differential
@@ -425,6 +473,17 @@ double measure(MeshElement* e);
   */
 double measure(Mesh* m, MeshEntity* e);
 
+/** \brief Measures many simplices of one type at once.
+  *
+  * \details With linear coordinates, edges, triangles, and tets
+  * are measured from their vertex coordinates in blocks, with no
+  * Mesh Elements. Other entities take the general path.
+  * As with apf::measure, the volume of an inverted tet is negative.
+  *
+  * \param out the measure of each entity in (e)
+  */
+void measureSimplices(Mesh* m, int n, MeshEntity* const* e, double* out);
+
 /** \brief Returns the polynomial order of the coordinate field.
   */
 int getOrder(MeshElement* e);
@@ -568,6 +627,121 @@ void writeVtkFiles(const char* prefix, Mesh* m, int cellDim = -1);
 void writeVtkFiles(const char* prefix, Mesh* m,
     std::vector<std::string> writeFields, int cellDim = -1);
 
+/** \brief Write a set of parallel VTK Unstructured Mesh files from an apf::Mesh
+  * with the arrays as raw binary in an appended data section
+  * \details this layout skips base64 encoding, so it is the fastest to
+  * write and read. Arrays are still zlib compressed if LION_COMPRESS=ON.
+  * Nodal fields whose shape differs from the mesh shape will
+  * not be output. Fields with incomplete data will not be output.
+  */
+void writeRawVtkFiles(const char* prefix, Mesh* m, int cellDim = -1);
+
+/** \brief Write a set of parallel VTK Unstructured Mesh files from an apf::Mesh
+  * with the arrays as raw binary in an appended data section
+  * \details Only fields whose name appears in the vector writeFields will be
+  * output. Nodal fields whose shape differs from the mesh shape will not be
+  * output. Fields with incomplete data will not be output.
+  */
+void writeRawVtkFiles(const char* prefix, Mesh* m,
+    std::vector<std::string> writeFields, int cellDim = -1);
+
+/** \brief Write a set of parallel VTK Unstructured Mesh files from an apf::Mesh
+  * into (files) .vtu files instead of one per part
+  * \details the parts of consecutive ranks are gathered as the pieces of
+  * one file, written with collective MPI-IO by the ranks sharing it, and
+  * rank 0 writes the .pvtu listing the files. Arrays are encoded as in
+  * writeVtkFiles. Nodal fields whose shape differs from the mesh shape will
+  * not be output. Fields with incomplete data will not be output.
+  */
+void writeAggregatedVtkFiles(const char* prefix, Mesh* m, int files,
+    int cellDim = -1);
+
+/** \brief Write a set of parallel VTK Unstructured Mesh files from an apf::Mesh
+  * into (files) .vtu files instead of one per part
+  * \details Only fields whose name appears in the vector writeFields will be
+  * output. Nodal fields whose shape differs from the mesh shape will not be
+  * output. Fields with incomplete data will not be output.
+  */
+void writeAggregatedVtkFiles(const char* prefix, Mesh* m,
+    std::vector<std::string> writeFields, int files, int cellDim = -1);
+
+/** \brief Set the number of threads that compress binary VTK arrays
+  * \details arrays are compressed in 1MB blocks, which are spread over
+  * this many threads. The default is one thread.
+  */
+void setVtkThreads(int threads);
+
+/** \brief Write one field to a column file for restarts
+  * \details the node values are stored in the order of the global
+  * numbering (n), in blocks of consecutive nodes that are compressed
+  * on their own when PCU is built with PCU_ZLIB, behind a header with
+  * the name, value type, shape and node count of the field.
+  * Each rank holds one block and all ranks write the file with
+  * collective MPI-IO, so one field of one time step costs one file
+  * and no mesh output.
+  * The owned nodes of (n) must be numbered from zero without gaps,
+  * as apf::numberGlobalNodes does, which is the default when (n) is
+  * zero.
+  */
+void writeFieldColumn(Field* f, const char* path, GlobalNumbering* n = 0);
+
+/** \brief Read a field from a column file of apf::writeFieldColumn
+  * \details the field is created on (m) if it has none of that name,
+  * otherwise its shape and components must match the file.
+  * Each rank reads a run of blocks and the owned nodes get their
+  * values by their numbers in (n), which must number the same nodes
+  * as the numbering given to the writer; zero numbers them with
+  * apf::numberGlobalNodes, which only matches when the mesh and its
+  * partition are those that were written.
+  * Copies of nodes are synchronized.
+  */
+Field* readFieldColumn(Mesh* m, const char* path, GlobalNumbering* n = 0);
+
+/** \brief An output written by a background thread
+  * \details the calling thread snapshots all the data an output
+  * needs, then run encodes, compresses and writes the snapshot while
+  * the caller goes on changing the mesh and its fields.
+  * run must not communicate or touch the mesh.
+  */
+class AsyncWrite
+{
+  public:
+    virtual ~AsyncWrite() {}
+    /** \brief encode and write the snapshot */
+    virtual void run() = 0;
+};
+
+/** \brief run an apf::AsyncWrite on a new thread
+  * \details if no thread can be made, the write runs and is
+  * destroyed before this returns. */
+void startAsyncWrite(AsyncWrite* w);
+
+/** \brief wait for one apf::AsyncWrite to finish and destroy it
+  * \details this does nothing if (w) already finished and was
+  * destroyed by apf::waitForWrites. */
+void waitForWrite(AsyncWrite* w);
+
+/** \brief wait for all running writes to finish and destroy them
+  * \details call this before exiting and before reading back
+  * any file that is still being written. */
+void waitForWrites();
+
+/** \brief Start writing a set of parallel VTK Unstructured Mesh files
+  * like apf::writeVtkFiles, on a background thread
+  * \details the .pvtu file is written and the arrays of the .vtu file of
+  * this part are copied right away, so the mesh and its fields may
+  * change as soon as this returns. Compression, base64 encoding and the
+  * write of the .vtu file happen on the background thread.
+  * Only fields whose name appears in the vector writeFields are output.
+  */
+AsyncWrite* writeVtkFilesAsync(const char* prefix, Mesh* m,
+    std::vector<std::string> writeFields, int cellDim = -1);
+
+/** \brief see the other apf::writeVtkFilesAsync, with all printable
+  * fields */
+AsyncWrite* writeVtkFilesAsync(const char* prefix, Mesh* m,
+    int cellDim = -1);
+
 /** \brief Output just the .vtu file with ASCII encoding for this part.
   \details this function is useful for debugging large parallel meshes.
   */
@@ -627,6 +801,45 @@ void synchronize(Field* f, Sharing* shr = 0);
   */
 void accumulate(Field* f, Sharing* shr = 0);
 
+class SyncPlan;
+
+/** \brief Precompute the communication of synchronize and accumulate.
+  \details Building the plan walks the mesh and exchanges entity
+  pointers once, so that later calls only gather field values
+  into one message per neighbor part, send it, and scatter the
+  values on arrival, with no global barrier.
+  The plan stays valid as long as the mesh, the ownership described
+  by \a shr, and the set of entities with values of \a f do not change.
+  A null \a shr means the mesh's default apf::Sharing;
+  the plan does not keep \a shr.
+  Running a plan replaces the PCU neighbor set (PCU_Comm_Neighbors).
+  */
+SyncPlan* makeSyncPlan(Field* f, Sharing* shr = 0);
+
+/** \brief apf::synchronize with a precomputed plan. */
+void synchronize(SyncPlan* p);
+
+/** \brief apf::accumulate with a precomputed plan. */
+void accumulate(SyncPlan* p);
+
+/** \brief Destroy a plan made by apf::makeSyncPlan. */
+void destroySyncPlan(SyncPlan* p);
+
+/** \brief Synchronize several fields in one communication phase.
+  \details This is apf::synchronize for each of the \a n fields,
+  which may have different value types and shapes but must
+  share a mesh. The values of all fields on an entity travel
+  together, so the message latency is paid once for all of them
+  rather than once per field and dimension.
+  */
+void synchronize(Field* const* fields, int n, Sharing* shr = 0);
+
+/** \brief Accumulate several fields in two communication phases.
+  \details This is apf::accumulate for each of the \a n fields,
+  with one phase gathering to the owners and one broadcasting back.
+  */
+void accumulate(Field* const* fields, int n, Sharing* shr = 0);
+
 /** \brief Declare failure of code inside APF.
   \details This function prints the string as an APF
   failure to stderr and then calls abort.
@@ -638,6 +851,16 @@ void fail(const char* why) __attribute__((noreturn));
 /** \brief Convert a Field from Tag to array storage. */
 void freeze(Field* f);
 
+/** \brief Convert a Field to array storage ordered by a numbering.
+  \details node (i) of (n) holds its components at
+  getArrayData(f)[i * countComponents(f)], so a solver vector
+  can wrap the array without copying it.
+  (n) must have the shape of the field, number every node of
+  it from zero with no gaps, and outlive the array storage.
+  A field that is already frozen is copied once into the
+  new order, or left alone if it already uses (n). */
+void freeze(Field* f, Numbering* n);
+
 /** \brief Convert a Field from array to Tag storage. */
 void unfreeze(Field* f);
 
@@ -651,6 +874,10 @@ bool isFrozen(Field* f);
  */
 double* getArrayData(Field* f);
 
+/** \brief Return the numbering that orders the array storage
+  of a frozen field, or zero if it is not frozen. */
+Numbering* getArrayNumbering(Field* f);
+
 /** \brief Initialize all nodal values with all-zero components */
 void zeroField(Field* f);
 
@@ -10,7 +10,10 @@
 #include "apfNumbering.h"
 #include "apfShape.h"
 
+#include <PCU.h>
+#include <algorithm>
 #include <list>
+#include <vector>
 #include <pcu_util.h>
 
 namespace apf {
@@ -20,12 +23,8 @@ namespace apf {
     Field * field = getField(num);
     Mesh * mesh = getMesh(field);
     FieldShape * shape = getShape(field);
-    bool dlt = false;
     if(shr == NULL)
-    {
-      shr = getSharing(mesh);
-      dlt = true;
-    }
+      shr = mesh->getCachedSharing();
     int components = countComponents(field);
     int dim = mesh->getDimension();
     long dof = 0;
@@ -56,7 +55,6 @@ namespace apf {
         mesh->end(it);
       }
     }
-    if(dlt) delete shr;
     return dof;
   }
   int adjReorder(Numbering * num, Sharing * shr)
@@ -67,12 +65,8 @@ namespace apf {
     int dim = mesh->getDimension();
     int components = countComponents(field);
     int dofs = 0;
-    bool dlt = false;
     if(shr == NULL)
-    {
-      shr = getSharing(mesh);
-      dlt = true;
-    }
+      shr = mesh->getCachedSharing();
     MeshIterator * it;
     MeshEntity * ent = NULL;
     // count dofs on all locally owned mesh entities
@@ -187,7 +181,6 @@ namespace apf {
         }
       }
     }
-    if(dlt) delete shr;
     return dofs;
   }
 
@@ -264,18 +257,64 @@ namespace apf {
     return numbering;
   }
 
+  OrderQuality measureOrder(Mesh* m, MeshTag* order)
+  {
+    MeshTag* numbers = order;
+    MeshIterator* it;
+    MeshEntity* e;
+    if (!numbers)
+    {
+      numbers = m->createIntTag("apf_measure_order",1);
+      int i = 0;
+      it = m->begin(0);
+      while ((e = m->iterate(it)))
+      {
+        m->setIntTag(e,numbers,&i);
+        ++i;
+      }
+      m->end(it);
+    }
+    std::vector<int> lowest(m->count(0));
+    for (size_t i = 0; i < lowest.size(); ++i)
+      lowest[i] = i;
+    int bandwidth = 0;
+    it = m->begin(1);
+    while ((e = m->iterate(it)))
+    {
+      MeshEntity* v[2];
+      m->getDownward(e,0,v);
+      int a, b;
+      m->getIntTag(v[0],numbers,&a);
+      m->getIntTag(v[1],numbers,&b);
+      if (a < b)
+        std::swap(a,b);
+      PCU_ALWAYS_ASSERT(b >= 0 && a < (int)lowest.size());
+      bandwidth = std::max(bandwidth,a-b);
+      lowest[a] = std::min(lowest[a],b);
+    }
+    m->end(it);
+    long profile = 0;
+    for (size_t i = 0; i < lowest.size(); ++i)
+      profile += i - lowest[i];
+    if (!order)
+    {
+      removeTagFromDimension(m,numbers,0);
+      m->destroyTag(numbers);
+    }
+    OrderQuality q;
+    q.bandwidth = PCU_Max_Int(bandwidth);
+    q.profile = PCU_Add_Long(profile);
+    return q;
+  }
+
   void setNumberingOffset(Numbering * num, int off, Sharing * shr)
   {
     Mesh * mesh = getMesh(num);
     FieldShape * shape = getShape(num);
     int components = countComponents(num);
     int dim = mesh->getDimension();
-    bool dlt = false;
     if(shr == NULL)
-    {
-      shr = getSharing(mesh);
-      dlt = true;
-    }
+      shr = mesh->getCachedSharing();
     /* iterate over all nodes in the mesh,
        get their current numbering,
        add the offset and set the new numbering */
@@ -307,7 +346,6 @@ namespace apf {
       }
       mesh->end(iter);
     }
-    if(dlt) delete shr;
   }
 }
 
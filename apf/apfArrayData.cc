@@ -1,18 +1,34 @@
 #include "apfArrayData.h"
 #include "apfNumbering.h"
 #include "apfTagData.h"
+#include <PCU.h>
+#include <pcu_util.h>
 
 namespace apf {
 
+/* values are stored by node number, each node holding
+   all the field components at (number * components) */
 template <class T>
 class ArrayDataOf : public FieldDataOf<T>
 {
   public:
+    ArrayDataOf(Numbering* n = 0):
+      num_var(n),
+      storage(DOUBLE_TAGS)
+    {
+    }
     virtual void init(FieldBase* f)
     {
       /* this class inherits a variable (field),
          lets initialize it */
       this->field = f;
+      if (num_var) {
+        PCU_ALWAYS_ASSERT(getShape(num_var) == f->getShape());
+        arraySize = f->countComponents()*countNodes(num_var);
+        dataArray = new T[arraySize];
+        PCU_Mem_Account(PCU_MEM_FIELDS, arraySize * sizeof(T));
+        return;
+      }
       /* this has to set up the array */
       FieldShape* s = f->getShape();
       const char* name = s->getName();
@@ -31,11 +47,13 @@ class ArrayDataOf : public FieldDataOf<T>
       num_var = n;      
       arraySize = f->countComponents()*countNodes(num_var);
       dataArray = new T[arraySize];
+      PCU_Mem_Account(PCU_MEM_FIELDS, arraySize * sizeof(T));
     }
     virtual ~ArrayDataOf()
     {
       /* this has to destroy the array */
       delete [] dataArray;
+      PCU_Mem_Account(PCU_MEM_FIELDS, -long(arraySize * sizeof(T)));
     }
     virtual bool hasEntity(MeshEntity*)
     {
@@ -49,26 +67,29 @@ class ArrayDataOf : public FieldDataOf<T>
          I don't think  we want to remove entities from frozen fields */
       fail("removeEntity called on frozen field data");
     }
+    /* a numbering need not give the nodes of an entity
+       consecutive numbers, so each node is looked up */
     virtual void get(MeshEntity* e, T* data)
     {
       /* this retrieves all the data associated with (e) */
-      int first_node_index = getNumber(this->num_var,e,0,0);
       int num_nodes = this->field->countNodesOn(e);
       int num_components = this->field->countComponents();
-      int start = first_node_index*num_components;
-      for (int i=0; i<num_nodes*num_components; i++) {
-         data[i] = this->dataArray[start+i];
+      for (int n=0; n<num_nodes; n++) {
+        int start = getNumber(this->num_var,e,n,0)*num_components;
+        for (int i=0; i<num_components; i++)
+          data[n*num_components+i] = this->dataArray[start+i];
       }
     }
     virtual void set(MeshEntity* e, T const* data)
     {
       /* this stores all the data associated with (e) */
-      int first_node_index = getNumber(this->num_var,e,0,0);
       int num_nodes = this->field->countNodesOn(e);
       int num_components = this->field->countComponents();
-      int start = first_node_index*num_components;
-      for (int i=0; i<num_nodes*num_components; i++) {
-          this->dataArray[start+i] = data[i];
+      for (int n=0; n<num_nodes; n++) {
+        int start = getNumber(this->num_var,e,n,0)*num_components;
+        PCU_ALWAYS_ASSERT(start + num_components <= arraySize);
+        for (int i=0; i<num_components; i++)
+          this->dataArray[start+i] = data[n*num_components+i];
       }
     }
 
@@ -79,10 +100,20 @@ class ArrayDataOf : public FieldDataOf<T>
     T* getDataArray() {
       return this->dataArray;
     }
+    Numbering* getNumbering() {
+      return this->num_var;
+    }
+    int getStorage() {
+      return storage;
+    }
+    void setStorage(int s) {
+      storage = s;
+    }
     virtual FieldData* clone() {
       //FieldData* newData = new TagDataOf<double>();
-      FieldData* newData = new ArrayDataOf<T>();
+      ArrayDataOf<T>* newData = new ArrayDataOf<T>(num_var);
       newData->init(this->field);
+      newData->setStorage(storage);
       copyFieldData(static_cast<FieldDataOf<T>*>(newData),
                     static_cast<FieldDataOf<T>*>(this->field->getData()));
       return newData;
@@ -91,33 +122,49 @@ class ArrayDataOf : public FieldDataOf<T>
   private:
     /* data variables go here */
     Numbering* num_var; 
+    /* the tag storage to go back to when unfrozen */
+    int storage;
     int arraySize;
     T* dataArray;
 };
 
 template <class T>
-void freezeFieldData(FieldBase* field)
+void freezeFieldData(FieldBase* field, Numbering* n, FieldDataOf<T>* from)
 {
   /* make a new data store of array type */
-  ArrayDataOf<T>* newData = new ArrayDataOf<T>();
+  ArrayDataOf<T>* newData = new ArrayDataOf<T>(n);
   /* call the init function to setup storage */
   newData->init(field);
+  newData->setStorage(getTagStorage(field->getData()));
   /* get the old data store */
-  FieldDataOf<T>* oldData = static_cast<FieldDataOf<T>*>(field->getData());
+  FieldDataOf<T>* oldData = from ? from :
+    static_cast<FieldDataOf<T>*>(field->getData());
   /* call the set function to fill with values */
   copyFieldData<T>(oldData,newData);
   /* replace the old data store with this one */
   field->changeData(newData);
 }
 
+template <class T>
+static FieldDataOf<T>* makeUnfrozenData(int)
+{
+  return new TagDataOf<T>();
+}
+
+template <>
+FieldDataOf<double>* makeUnfrozenData<double>(int storage)
+{
+  return makeTagStorage(storage);
+}
+
 template <class T>
 void unfreezeFieldData(FieldBase* field) {
-  // make a new data store of tag type
-  TagDataOf<T>* newData = new TagDataOf<T>();
+  // get the old data store
+  ArrayDataOf<T>* oldData = static_cast<ArrayDataOf<T>*>(field->getData());
+  // make a new data store of the tag type it was frozen from
+  FieldDataOf<T>* newData = makeUnfrozenData<T>(oldData->getStorage());
   // call init function to setup storage
   newData->init(field);
-  // get the old data store
-  FieldDataOf<T>* oldData = static_cast<FieldDataOf<T>*>(field->getData());
   // call set function to fill with values
   copyFieldData<T>(oldData,newData);
   // replace old data store with this one
@@ -125,11 +172,29 @@ void unfreezeFieldData(FieldBase* field) {
 }
 
 /* instantiate here */
-template void freezeFieldData<int>(FieldBase* field);
-template void freezeFieldData<double>(FieldBase* field);
+template void freezeFieldData<int>(FieldBase* field, Numbering* n,
+    FieldDataOf<int>* from);
+template void freezeFieldData<double>(FieldBase* field, Numbering* n,
+    FieldDataOf<double>* from);
 template void unfreezeFieldData<int>(FieldBase* field);
 template void unfreezeFieldData<double>(FieldBase* field);
 
+int getTagStorage(FieldData* d)
+{
+  if (dynamic_cast<FloatTagData*>(d))
+    return FLOAT_TAGS;
+  if (ArrayDataOf<double>* a = dynamic_cast<ArrayDataOf<double>*>(d))
+    return a->getStorage();
+  return DOUBLE_TAGS;
+}
+
+FieldDataOf<double>* makeTagStorage(int storage)
+{
+  if (storage == FLOAT_TAGS)
+    return new FloatTagData();
+  return new TagDataOf<double>();
+}
+
 double* getArrayData(Field* f) {
   if (!isFrozen(f)) {
     return 0;
@@ -140,4 +205,11 @@ double* getArrayData(Field* f) {
   }
 }
 
+Numbering* getArrayNumbering(Field* f) {
+  if (!isFrozen(f))
+    return 0;
+  FieldDataOf<double>* p = f->getData();
+  return static_cast<ArrayDataOf<double>*>(p)->getNumbering();
+}
+
 }
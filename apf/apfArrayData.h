@@ -12,10 +12,25 @@
 
 namespace apf {
 
+/* a null numbering selects the overlap numbering of the field shape,
+   and a null source copies the values from the field's current data */
 template <class T>
-void freezeFieldData(FieldBase* base);
+void freezeFieldData(FieldBase* base, Numbering* n = 0,
+    FieldDataOf<T>* from = 0);
 template <class T>
 void unfreezeFieldData(FieldBase* base);
+
+/* the kinds of tag storage a field can be rebuilt from,
+   as written to files and sent with mesh clones */
+enum { DOUBLE_TAGS, FLOAT_TAGS };
+
+/* the kind of tag storage of (d), or for frozen
+   data the kind it was frozen from */
+int getTagStorage(FieldData* d);
+
+/* new empty storage of a kind from getTagStorage */
+FieldDataOf<double>* makeTagStorage(int storage);
+
 }
 
 #endif
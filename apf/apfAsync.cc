@@ -0,0 +1,63 @@
+/*
+ * Copyright 2016 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apf.h"
+#include <pcu_util.h>
+#include <pthread.h>
+#include <vector>
+
+namespace apf {
+
+/* writes still running, each with its thread */
+struct RunningWrite
+{
+  AsyncWrite* write;
+  pthread_t thread;
+};
+
+static std::vector<RunningWrite> runningWrites;
+
+static void* runWrite(void* p)
+{
+  static_cast<AsyncWrite*>(p)->run();
+  return 0;
+}
+
+void startAsyncWrite(AsyncWrite* w)
+{
+  RunningWrite r;
+  r.write = w;
+  /* without a thread the write happens right away */
+  if (pthread_create(&r.thread, 0, runWrite, w)) {
+    w->run();
+    delete w;
+    return;
+  }
+  runningWrites.push_back(r);
+}
+
+void waitForWrite(AsyncWrite* w)
+{
+  for (size_t i = 0; i < runningWrites.size(); ++i)
+    if (runningWrites[i].write == w) {
+      pthread_join(runningWrites[i].thread, 0);
+      delete w;
+      runningWrites.erase(runningWrites.begin() + i);
+      return;
+    }
+}
+
+void waitForWrites()
+{
+  for (size_t i = 0; i < runningWrites.size(); ++i) {
+    pthread_join(runningWrites[i].thread, 0);
+    delete runningWrites[i].write;
+  }
+  runningWrites.clear();
+}
+
+}
@@ -9,6 +9,13 @@
 #include "apfCavityOp.h"
 #include "apf.h"
 #include "apfMesh2.h"
+#include <atomic>
+#include <map>
+#include <set>
+
+#if __cplusplus < 201103L
+#error "threaded cavity operators need C++11 std::atomic"
+#endif
 
 namespace apf {
 
@@ -18,6 +25,10 @@ CavityOp::CavityOp(Mesh* m, bool cm):
   canModify(cm),
   movedByDeletion(false),
   iterator(0),
+  independentPulls(false),
+  round(0),
+  list(0),
+  listTag(0),
   sharing(0)
 {
 }
@@ -66,6 +77,12 @@ void CavityOp::applyLocallyWithModification(int d)
 
 void CavityOp::preDeletion(MeshEntity* e)
 {
+  if (list)
+  {
+    /* the list is skipped over, not iterated */
+    destroyed.insert(e);
+    return;
+  }
   Mesh2* mesh2 = static_cast<Mesh2*>(mesh);
   if (( ! mesh2->isDone(this->iterator))&&
       (e == mesh2->deref(this->iterator)))
@@ -94,6 +111,73 @@ void CavityOp::applyLocallyWithoutModification(int d)
   mesh->end(entities);
 }
 
+void CavityOp::applyListWithModification()
+{
+  Requests& l = *list;
+  destroyed.clear();
+  isRequesting = false;
+  for (size_t i = 0; i < l.size(); ++i)
+  {
+    MeshEntity* e = l[i];
+    if (destroyed.count(e) || ( ! sharing->isOwned(e)))
+      continue;
+    if (setEntity(e) == OK)
+      apply();
+  }
+  /* drop the destroyed entities before anything else looks
+     at them, since new entities may have reused their pointers */
+  size_t n = 0;
+  for (size_t i = 0; i < l.size(); ++i)
+    if ( ! destroyed.count(l[i]))
+      l[n++] = l[i];
+  l.resize(n);
+  destroyed.clear();
+  /* as above, requests wait for all the modification */
+  isRequesting = true;
+  for (size_t i = 0; i < l.size(); ++i)
+    if (sharing->isOwned(l[i]))
+      setEntity(l[i]);
+}
+
+void CavityOp::applyListWithoutModification()
+{
+  Requests& l = *list;
+  isRequesting = true;
+  for (size_t i = 0; i < l.size(); ++i)
+  {
+    if ( ! sharing->isOwned(l[i]))
+      continue;
+    Outcome o = setEntity(l[i]);
+    if (o == OK)
+      apply();
+  }
+}
+
+/* migration invalidates the pointers of the entities that moved,
+   so after a pull the list is found again by its tag */
+void CavityOp::gatherList(int d)
+{
+  list->clear();
+  MeshIterator* it = mesh->begin(d);
+  MeshEntity* e;
+  while ((e = mesh->iterate(it)))
+    if (mesh->hasTag(e, listTag))
+      list->push_back(e);
+  mesh->end(it);
+}
+
+void CavityOp::orderList(std::vector<MeshEntity*>&)
+{
+}
+
+/* threads of PCU_Thrd_Run may apply CavityOps at once */
+static std::atomic<long> pullRounds(0);
+
+long countCavityPullRounds()
+{
+  return pullRounds;
+}
+
 void CavityOp::applyToDimension(int d)
 {
   /* the iteration count of this loop is hard to predict,
@@ -101,9 +185,9 @@ void CavityOp::applyToDimension(int d)
    * constant number of iterations that does not grow
    * with parallelism
    */
+  bool pulled;
   do {
-    delete sharing;
-    sharing = apf::getSharing(mesh);
+    sharing = mesh->getCachedSharing();
     /* apply the operator to all local cavities
        and request missing cavity elements */
     if (this->canModify)
@@ -115,8 +199,41 @@ void CavityOp::applyToDimension(int d)
        were made by any process, which should imply
        that all mesh entities that needed to be operated
        on have been. */
-  } while (tryToPull());
-  delete sharing;
+    pulled = independentPulls ? tryToPullIndependent() : tryToPull();
+    if (pulled)
+      ++pullRounds;
+  } while (pulled);
+  sharing = 0;
+}
+
+void CavityOp::applyToList(int d, std::vector<MeshEntity*>& entities)
+{
+  list = &entities;
+  listTag = mesh->createIntTag("apf_cavity_list", 1);
+  int one = 1;
+  for (size_t i = 0; i < list->size(); ++i)
+    mesh->setIntTag((*list)[i], listTag, &one);
+  bool pulled;
+  do {
+    sharing = mesh->getCachedSharing();
+    if (this->canModify)
+      this->applyListWithModification();
+    else
+      this->applyListWithoutModification();
+    pulled = independentPulls ? tryToPullIndependent() : tryToPull();
+    if (pulled)
+    {
+      ++pullRounds;
+      gatherList(d);
+      orderList(*list);
+    }
+  } while (pulled);
+  for (size_t i = 0; i < list->size(); ++i)
+    if (mesh->hasTag((*list)[i], listTag))
+      mesh->removeTag((*list)[i], listTag);
+  mesh->destroyTag(listTag);
+  listTag = 0;
+  list = 0;
   sharing = 0;
 }
 
@@ -126,9 +243,10 @@ bool CavityOp::requestLocality(MeshEntity** entities, int count)
   for (int i=0; i < count; ++i)
     if (sharing->isShared(entities[i]))
       areLocal = false;
-  if (isRequesting && ( ! areLocal))
-    for (int i=0; i < count; ++i)
-      requests.insert(requests.end(),entities,entities+count);
+  if (isRequesting && ( ! areLocal)) {
+    cavities.push_back(requests.size());
+    requests.insert(requests.end(),entities,entities+count);
+  }
   return areLocal;
 }
 
@@ -160,6 +278,7 @@ bool CavityOp::sendPullRequests(std::vector<PullRequest>& received)
     }
   }
   requests.clear();
+  cavities.clear();
   PCU_Comm_Send();
   while (PCU_Comm_Listen())
   {
@@ -229,4 +348,134 @@ bool CavityOp::tryToPull()
   return true;
 }
 
+/* a claim by cavity (cavity) of part (part) on the
+   elements around entity (e) of this part */
+struct Claim
+{
+  MeshEntity* e;
+  int part;
+  int cavity;
+  unsigned priority;
+};
+
+static unsigned getPriority(int part, int cavity, int round)
+{
+  unsigned h = part * 2654435761u;
+  h ^= cavity * 2246822519u + round * 3266489917u;
+  h ^= h >> 15;
+  h *= 668265263u;
+  h ^= h >> 13;
+  return h;
+}
+
+/* a strict total order, ties in priority broken by identity */
+static bool beats(Claim const& a, Claim const& b)
+{
+  if (a.priority != b.priority)
+    return a.priority > b.priority;
+  if (a.part != b.part)
+    return a.part > b.part;
+  return a.cavity > b.cavity;
+}
+
+static bool same(Claim const& a, Claim const& b)
+{
+  return a.part == b.part && a.cavity == b.cavity;
+}
+
+bool CavityOp::tryToPullIndependent()
+{
+  if (PCU_Min_Int(requests.empty()))
+    return false;
+  ++round;
+  int self = PCU_Comm_Self();
+  cavities.push_back(requests.size());
+  int ncav = cavities.size() - 1;
+  /* claim the entities of each cavity on all their copies */
+  std::vector<Claim> claims;
+  PCU_Comm_Begin();
+  for (int c = 0; c < ncav; ++c)
+    for (size_t i = cavities[c]; i < cavities[c + 1]; ++i) {
+      Claim claim = {requests[i], self, c, getPriority(self, c, round)};
+      claims.push_back(claim);
+      CopyArray remotes;
+      sharing->getCopies(requests[i], remotes);
+      APF_ITERATE(CopyArray, remotes, rit) {
+        PCU_COMM_PACK(rit->peer, rit->entity);
+        PCU_COMM_PACK(rit->peer, c);
+      }
+    }
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    Claim claim;
+    claim.part = PCU_Comm_Sender();
+    PCU_COMM_UNPACK(claim.e);
+    PCU_COMM_UNPACK(claim.cavity);
+    claim.priority = getPriority(claim.part, claim.cavity, round);
+    claims.push_back(claim);
+  }
+  /* every element here goes to its best claim */
+  std::map<MeshEntity*, Claim> best;
+  int dim = mesh->getDimension();
+  for (size_t i = 0; i < claims.size(); ++i) {
+    Adjacent a;
+    mesh->getAdjacent(claims[i].e, dim, a);
+    for (size_t j = 0; j < a.getSize(); ++j) {
+      std::map<MeshEntity*, Claim>::iterator it = best.find(a[j]);
+      if (it == best.end())
+        best[a[j]] = claims[i];
+      else if (beats(claims[i], it->second))
+        it->second = claims[i];
+    }
+  }
+  /* tell the owners of cavities that lost any element */
+  std::vector<bool> lost(ncav, false);
+  typedef std::set<std::pair<int, int> > Losers;
+  Losers losers;
+  for (size_t i = 0; i < claims.size(); ++i) {
+    Adjacent a;
+    mesh->getAdjacent(claims[i].e, dim, a);
+    for (size_t j = 0; j < a.getSize(); ++j)
+      if ( ! same(best[a[j]], claims[i]))
+        losers.insert(std::make_pair(claims[i].part, claims[i].cavity));
+  }
+  PCU_Comm_Begin();
+  APF_ITERATE(Losers, losers, it) {
+    if (it->first == self)
+      lost[it->second] = true;
+    else
+      PCU_COMM_PACK(it->first, it->second);
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    int c;
+    PCU_COMM_UNPACK(c);
+    lost[c] = true;
+  }
+  /* pull the winners, whose elements are all distinct */
+  Migration* plan = new Migration(mesh);
+  PCU_Comm_Begin();
+  for (int c = 0; c < ncav; ++c) {
+    if (lost[c])
+      continue;
+    for (size_t i = cavities[c]; i < cavities[c + 1]; ++i) {
+      markElements(plan, requests[i], self);
+      CopyArray remotes;
+      sharing->getCopies(requests[i], remotes);
+      APF_ITERATE(CopyArray, remotes, rit)
+        PCU_COMM_PACK(rit->peer, rit->entity);
+    }
+  }
+  requests.clear();
+  cavities.clear();
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    MeshEntity* e;
+    PCU_COMM_UNPACK(e);
+    markElements(plan, e, PCU_Comm_Sender());
+  }
+  mesh->migrate(plan); //plan deleted here
+  return true;
+}
+
 } //namespace apf
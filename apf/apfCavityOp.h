@@ -13,6 +13,7 @@
 
 #include "apfMesh.h"
 #include <vector>
+#include <set>
 #include <cstring>
 
 namespace apf {
@@ -65,6 +66,12 @@ namespace apf {
    iterator invalidation.
 */
 
+/** \brief the number of pull rounds all CavityOp applications on
+  this part have taken, for profiling the callers
+  \details in PCU thread mode this is the sum over the threads
+  of the process */
+long countCavityPullRounds();
+
 /** \brief user-defined mesh cavity operator */
 class CavityOp
 {
@@ -87,6 +94,32 @@ class CavityOp
     virtual void apply() = 0;
     /** \brief parallel collective operation over entities of one dimension */
     void applyToDimension(int d);
+    /** \brief parallel collective operation over a worklist of entities
+      \details like applyToDimension, but each part only visits the
+      entities of dimension (d) in (entities), which saves sweeping
+      the whole part when few entities need work.
+      On return (entities) holds the pointers still valid on this part:
+      the ones the operator destroyed are gone, and if cavities were
+      pulled the list is rebuilt in mesh order from the surviving
+      entities and those that migrated in while on another part's list. */
+    void applyToList(int d, std::vector<MeshEntity*>& entities);
+    /** \brief reorder the worklist of applyToList
+      \details called each time the worklist is rebuilt after a pull,
+      for operators that visit their worklist in a particular order.
+      The default keeps mesh order. */
+    virtual void orderList(std::vector<MeshEntity*>& entities);
+    /** \brief pull only independent sets of cavities
+      \details by default all requested cavities are pulled at once
+      and competing requests for an element go to the highest
+      part ID, which can leave several cavities partly pulled.
+      When this is on, each round first resolves the competition,
+      so that a cavity is pulled only if it wins every one of its
+      elements against the other cavities, which a randomized
+      priority decides. The cavities pulled in a round share
+      no elements, and the highest priority cavity always goes
+      through, which bounds the number of pull rounds.
+      Each round costs two more message phases than the default. */
+    void setIndependentPulls(bool on) {independentPulls = on;}
     /** \brief within setEntity, require that entities be made local */
     bool requestLocality(MeshEntity** entities, int count);
     /** \brief call before deleting a mesh entity during the operation */
@@ -96,15 +129,27 @@ class CavityOp
   private:
     typedef std::vector<MeshEntity*> Requests;
     Requests requests;
+    /* where each requesting call's entities begin in (requests) */
+    std::vector<size_t> cavities;
     bool isRequesting;
     struct PullRequest { MeshEntity* e; int to; };
     bool sendPullRequests(std::vector<PullRequest>& received);
     bool tryToPull();
+    bool tryToPullIndependent();
     void applyLocallyWithModification(int d);
     void applyLocallyWithoutModification(int d);
+    void applyListWithModification();
+    void applyListWithoutModification();
+    void gatherList(int d);
     bool canModify;
     bool movedByDeletion;
     MeshIterator* iterator;
+    bool independentPulls;
+    int round;
+    /* the worklist of applyToList, tagged so it survives migration */
+    Requests* list;
+    MeshTag* listTag;
+    std::set<MeshEntity*> destroyed;
   protected:
     Sharing* sharing;
 };
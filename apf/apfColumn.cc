@@ -0,0 +1,447 @@
+/*
+ * Copyright 2016 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include <PCU.h>
+#include <pcu_byteorder.h>
+#include <pcu_io.h>
+#include <pcu_util.h>
+#include <reel.h>
+#include "apf.h"
+#include "apfMesh.h"
+#include "apfNumbering.h"
+#include "apfShape.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/* column files: one field at one time, its node values in the order
+   of a global numbering.  All numbers are big endian.  The header is
+
+     "APFC", u32 version, u64 header bytes,
+     u32 value type, u32 components, u64 rows (nodes),
+     u32 codec, u32 blocks,
+     u32 length and bytes of the field name,
+     u32 length and bytes of the shape name,
+
+   followed by one index entry per block of
+
+     u64 first row, u64 rows, u64 offset, u64 stored bytes,
+
+   and then the blocks.  Every writer rank holds one block of
+   consecutive rows, as apf::setCoords spreads vertices, and stores
+   it compressed on its own, so a reader touches only the blocks
+   of the rows it needs. */
+
+namespace apf {
+
+static unsigned const columnVersion = 1;
+static size_t const columnFixedBytes = 40;
+static size_t const columnEntryBytes = 32;
+
+enum {
+  COLUMN_RAW,
+  COLUMN_ZLIB
+};
+
+static void putU32(std::string& s, uint32_t x)
+{
+  for (int i = 3; i >= 0; --i)
+    s.push_back(char((x >> (8 * i)) & 0xFF));
+}
+
+static void putU64(std::string& s, uint64_t x)
+{
+  for (int i = 7; i >= 0; --i)
+    s.push_back(char((x >> (8 * i)) & 0xFF));
+}
+
+static void putString(std::string& s, const char* x)
+{
+  putU32(s, strlen(x));
+  s.append(x);
+}
+
+static uint64_t getBytes(const char* p, int n)
+{
+  uint64_t x = 0;
+  for (int i = 0; i < n; ++i)
+    x = (x << 8) | (unsigned char)p[i];
+  return x;
+}
+
+struct ColumnHeader
+{
+  int valueType;
+  int components;
+  long rows;
+  int codec;
+  std::string name;
+  std::string shape;
+  std::vector<long> first;
+  std::vector<long> count;
+  std::vector<long> offset;
+  std::vector<long> stored;
+};
+
+static size_t getHeaderBytes(ColumnHeader const& h)
+{
+  return columnFixedBytes + 8 + h.name.size() + h.shape.size()
+    + h.first.size() * columnEntryBytes;
+}
+
+static std::string encodeHeader(ColumnHeader const& h)
+{
+  std::string s("APFC");
+  putU32(s, columnVersion);
+  putU64(s, getHeaderBytes(h));
+  putU32(s, h.valueType);
+  putU32(s, h.components);
+  putU64(s, h.rows);
+  putU32(s, h.codec);
+  putU32(s, h.first.size());
+  putString(s, h.name.c_str());
+  putString(s, h.shape.c_str());
+  for (size_t i = 0; i < h.first.size(); ++i) {
+    putU64(s, h.first[i]);
+    putU64(s, h.count[i]);
+    putU64(s, h.offset[i]);
+    putU64(s, h.stored[i]);
+  }
+  PCU_ALWAYS_ASSERT(s.size() == getHeaderBytes(h));
+  return s;
+}
+
+static void decodeHeader(std::string const& s, ColumnHeader& h,
+    const char* path)
+{
+  const char* p = s.c_str();
+  if (s.size() < columnFixedBytes || strncmp(p, "APFC", 4))
+    reel_fail("APF: \"%s\" is not a column file\n", path);
+  unsigned version = getBytes(p + 4, 4);
+  if (version > columnVersion)
+    reel_fail("APF: \"%s\" has column version %u, newer than %u\n",
+        path, version, columnVersion);
+  h.valueType = getBytes(p + 16, 4);
+  h.components = getBytes(p + 20, 4);
+  h.rows = getBytes(p + 24, 8);
+  h.codec = getBytes(p + 32, 4);
+  size_t blocks = getBytes(p + 36, 4);
+  p += columnFixedBytes;
+  size_t n = getBytes(p, 4);
+  h.name.assign(p + 4, n);
+  p += 4 + n;
+  n = getBytes(p, 4);
+  h.shape.assign(p + 4, n);
+  p += 4 + n;
+  h.first.resize(blocks);
+  h.count.resize(blocks);
+  h.offset.resize(blocks);
+  h.stored.resize(blocks);
+  for (size_t i = 0; i < blocks; ++i) {
+    h.first[i] = getBytes(p, 8);
+    h.count[i] = getBytes(p + 8, 8);
+    h.offset[i] = getBytes(p + 16, 8);
+    h.stored[i] = getBytes(p + 24, 8);
+    p += columnEntryBytes;
+  }
+  PCU_ALWAYS_ASSERT(size_t(p - s.c_str()) == getHeaderBytes(h));
+}
+
+static void swapColumn(double* values, size_t n)
+{
+  if (PCU_HOST_ORDER != PCU_BIG_ENDIAN)
+    pcu_swap_doubles(values, n);
+}
+
+/* the first row of the block of a rank, as apf::setCoords
+   gives the last rank the remainder */
+static long getFirstRow(long rows, int rank, int peers)
+{
+  return (rows / peers) * rank;
+}
+
+static long countBlockRows(long rows, int rank, int peers)
+{
+  long n = rows / peers;
+  if (rank == peers - 1)
+    n += rows % peers;
+  return n;
+}
+
+static int getRowRank(long rows, long row, int peers)
+{
+  long quotient = rows / peers;
+  if (!quotient)
+    return peers - 1;
+  return std::min(row / quotient, long(peers - 1));
+}
+
+static GlobalNumbering* getColumnNumbering(Field* f, GlobalNumbering* n)
+{
+  if (n) {
+    PCU_ALWAYS_ASSERT(getShape(n) == getShape(f));
+    return n;
+  }
+  return numberGlobalNodes(getMesh(f), "apf_column", getShape(f));
+}
+
+static void getOwnedNodes(GlobalNumbering* n, DynamicArray<Node>& owned)
+{
+  Mesh* m = getMesh(n);
+  DynamicArray<Node> nodes;
+  getNodes(n, nodes);
+  size_t k = 0;
+  for (size_t i = 0; i < nodes.getSize(); ++i)
+    if (m->isOwned(nodes[i].entity))
+      ++k;
+  owned.setSize(k);
+  k = 0;
+  for (size_t i = 0; i < nodes.getSize(); ++i)
+    if (m->isOwned(nodes[i].entity))
+      owned[k++] = nodes[i];
+}
+
+void writeFieldColumn(Field* f, const char* path, GlobalNumbering* n)
+{
+  double t0 = PCU_Time();
+  GlobalNumbering* numbering = getColumnNumbering(f, n);
+  DynamicArray<Node> owned;
+  getOwnedNodes(numbering, owned);
+  int self = PCU_Comm_Self();
+  int peers = PCU_Comm_Peers();
+  ColumnHeader h;
+  h.valueType = getValueType(f);
+  h.components = countComponents(f);
+  h.rows = PCU_Add_Long(owned.getSize());
+  h.codec = pcu_can_deflate() ? COLUMN_ZLIB : COLUMN_RAW;
+  h.name = getName(f);
+  h.shape = getShape(f)->getName();
+  int nc = h.components;
+  long first = getFirstRow(h.rows, self, peers);
+  long count = countBlockRows(h.rows, self, peers);
+  /* owners send their values to the rank holding their rows */
+  std::vector<double> values(count * nc);
+  std::vector<double> buffer(nc);
+  PCU_Comm_Begin();
+  for (size_t i = 0; i < owned.getSize(); ++i) {
+    long row = getNumber(numbering, owned[i]);
+    PCU_ALWAYS_ASSERT(0 <= row && row < h.rows);
+    int to = getRowRank(h.rows, row, peers);
+    getComponents(f, owned[i].entity, owned[i].node, &buffer[0]);
+    PCU_COMM_PACK(to, row);
+    PCU_Comm_Pack(to, &buffer[0], nc * sizeof(double));
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    long row;
+    PCU_COMM_UNPACK(row);
+    PCU_ALWAYS_ASSERT(first <= row && row < first + count);
+    PCU_Comm_Unpack(&values[(row - first) * nc], nc * sizeof(double));
+  }
+  if (numbering != n)
+    destroyGlobalNumbering(numbering);
+  swapColumn(values.empty() ? 0 : &values[0], values.size());
+  char* block = (char*) (values.empty() ? 0 : &values[0]);
+  long stored = values.size() * sizeof(double);
+  char* packed = 0;
+  if (h.codec == COLUMN_ZLIB && stored) {
+    stored = pcu_deflate(block, stored, &packed);
+    block = packed;
+  }
+  long entry[3] = {first, count, stored};
+  std::vector<long> entries(peers * 3);
+  MPI_Allgather(entry, 3, MPI_LONG, &entries[0], 3, MPI_LONG,
+      PCU_Get_Comm());
+  h.first.resize(peers);
+  h.count.resize(peers);
+  h.offset.resize(peers);
+  h.stored.resize(peers);
+  long offset = getHeaderBytes(h);
+  for (int i = 0; i < peers; ++i) {
+    h.first[i] = entries[i * 3];
+    h.count[i] = entries[i * 3 + 1];
+    h.stored[i] = entries[i * 3 + 2];
+    h.offset[i] = offset;
+    offset += h.stored[i];
+  }
+  MPI_File fh;
+  if (MPI_File_open(PCU_Get_Comm(), const_cast<char*>(path),
+        MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+    reel_fail("APF: could not open \"%s\"\n", path);
+  MPI_File_set_size(fh, 0);
+  if (!self) {
+    std::string header = encodeHeader(h);
+    MPI_File_write_at(fh, 0, &header[0], header.size(), MPI_BYTE,
+        MPI_STATUS_IGNORE);
+  }
+  pcu_io_transfer_all(fh, PCU_Get_Comm(), h.offset[self], block, stored,
+      true, PCU_IO_OTHER);
+  MPI_File_close(&fh);
+  free(packed);
+  double t1 = PCU_Time();
+  if (!self)
+    printf("field \"%s\" written to \"%s\" in %f seconds\n",
+        h.name.c_str(), path, t1 - t0);
+}
+
+static void readHeader(MPI_File fh, const char* path, ColumnHeader& h)
+{
+  std::string s;
+  long size = 0;
+  if (!PCU_Comm_Self()) {
+    s.resize(columnFixedBytes);
+    MPI_File_read_at(fh, 0, &s[0], s.size(), MPI_BYTE, MPI_STATUS_IGNORE);
+    if (strncmp(s.c_str(), "APFC", 4))
+      reel_fail("APF: \"%s\" is not a column file\n", path);
+    size = getBytes(&s[8], 8);
+    s.resize(size);
+    MPI_File_read_at(fh, 0, &s[0], s.size(), MPI_BYTE, MPI_STATUS_IGNORE);
+  }
+  MPI_Bcast(&size, 1, MPI_LONG, 0, PCU_Get_Comm());
+  s.resize(size);
+  MPI_Bcast(&s[0], size, MPI_BYTE, 0, PCU_Get_Comm());
+  decodeHeader(s, h, path);
+}
+
+static Field* getColumnField(Mesh* m, ColumnHeader const& h,
+    const char* path)
+{
+  FieldShape* shape = getShapeByName(h.shape.c_str());
+  if (!shape)
+    reel_fail("APF: \"%s\" has unknown shape \"%s\"\n",
+        path, h.shape.c_str());
+  Field* f = m->findField(h.name.c_str());
+  if (!f)
+    return createGeneralField(m, h.name.c_str(), h.valueType,
+        h.valueType == PACKED ? h.components : 0, shape);
+  if (getShape(f) != shape || countComponents(f) != h.components)
+    reel_fail("APF: field \"%s\" does not match \"%s\"\n",
+        h.name.c_str(), path);
+  return f;
+}
+
+/* the first of the blocks read by a rank: readers get runs of
+   consecutive blocks, so each reads one range of the file */
+static int getFirstBlock(int blocks, int rank, int peers)
+{
+  return long(blocks) * rank / peers;
+}
+
+static int getBlockRank(int blocks, int block, int peers)
+{
+  int rank = long(block) * peers / blocks;
+  while (getFirstBlock(blocks, rank + 1, peers) <= block)
+    ++rank;
+  return rank;
+}
+
+Field* readFieldColumn(Mesh* m, const char* path, GlobalNumbering* n)
+{
+  double t0 = PCU_Time();
+  int self = PCU_Comm_Self();
+  int peers = PCU_Comm_Peers();
+  MPI_File fh;
+  if (MPI_File_open(PCU_Get_Comm(), const_cast<char*>(path),
+        MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+    reel_fail("APF: could not open \"%s\"\n", path);
+  ColumnHeader h;
+  readHeader(fh, path, h);
+  Field* f = getColumnField(m, h, path);
+  int nc = h.components;
+  int blocks = h.first.size();
+  /* read and decode this rank's run of blocks */
+  int firstBlock = getFirstBlock(blocks, self, peers);
+  int endBlock = getFirstBlock(blocks, self + 1, peers);
+  long firstRow = 0;
+  long rows = 0;
+  long offset = 0;
+  long length = 0;
+  if (firstBlock < endBlock) {
+    firstRow = h.first[firstBlock];
+    offset = h.offset[firstBlock];
+    for (int b = firstBlock; b < endBlock; ++b) {
+      rows += h.count[b];
+      length += h.stored[b];
+    }
+  }
+  std::vector<char> data(length);
+  pcu_io_transfer_all(fh, PCU_Get_Comm(), offset,
+      data.empty() ? 0 : &data[0], length, false, PCU_IO_OTHER);
+  MPI_File_close(&fh);
+  std::vector<double> values(rows * nc);
+  for (int b = firstBlock; b < endBlock; ++b) {
+    if (!h.count[b])
+      continue;
+    char* in = &data[h.offset[b] - offset];
+    double* out = &values[(h.first[b] - firstRow) * nc];
+    size_t raw = h.count[b] * nc * sizeof(double);
+    if (h.codec == COLUMN_ZLIB)
+      pcu_inflate(in, h.stored[b], (char*)out, raw);
+    else if (h.codec == COLUMN_RAW && size_t(h.stored[b]) == raw)
+      memcpy(out, in, raw);
+    else
+      reel_fail("APF: bad block %d in \"%s\"\n", b, path);
+  }
+  swapColumn(values.empty() ? 0 : &values[0], values.size());
+  /* owned nodes ask the readers of their rows for their values,
+     then the copies are synchronized */
+  GlobalNumbering* numbering = getColumnNumbering(f, n);
+  DynamicArray<Node> owned;
+  getOwnedNodes(numbering, owned);
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(owned.getSize()) == h.rows);
+  PCU_Comm_Begin();
+  for (size_t i = 0; i < owned.getSize(); ++i) {
+    long row = getNumber(numbering, owned[i]);
+    PCU_ALWAYS_ASSERT(0 <= row && row < h.rows);
+    int b = std::upper_bound(h.first.begin(), h.first.end(), row)
+      - h.first.begin() - 1;
+    int to = getBlockRank(blocks, b, peers);
+    PCU_COMM_PACK(to, i);
+    PCU_COMM_PACK(to, row);
+  }
+  PCU_Comm_Send();
+  std::vector<std::vector<size_t> > asked(peers);
+  std::vector<std::vector<long> > askedRows(peers);
+  while (PCU_Comm_Receive()) {
+    size_t i;
+    long row;
+    PCU_COMM_UNPACK(i);
+    PCU_COMM_UNPACK(row);
+    PCU_ALWAYS_ASSERT(firstRow <= row && row < firstRow + rows);
+    asked[PCU_Comm_Sender()].push_back(i);
+    askedRows[PCU_Comm_Sender()].push_back(row);
+  }
+  PCU_Comm_Begin();
+  for (int to = 0; to < peers; ++to)
+    for (size_t j = 0; j < asked[to].size(); ++j) {
+      PCU_COMM_PACK(to, asked[to][j]);
+      PCU_Comm_Pack(to, &values[(askedRows[to][j] - firstRow) * nc],
+          nc * sizeof(double));
+    }
+  PCU_Comm_Send();
+  std::vector<double> buffer(nc);
+  while (PCU_Comm_Receive()) {
+    size_t i;
+    PCU_COMM_UNPACK(i);
+    PCU_Comm_Unpack(&buffer[0], nc * sizeof(double));
+    setComponents(f, owned[i].entity, owned[i].node, &buffer[0]);
+  }
+  if (numbering != n)
+    destroyGlobalNumbering(numbering);
+  synchronize(f);
+  double t1 = PCU_Time();
+  if (!self)
+    printf("field \"%s\" read from \"%s\" in %f seconds\n",
+        h.name.c_str(), path, t1 - t0);
+  return f;
+}
+
+}
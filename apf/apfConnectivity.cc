@@ -0,0 +1,116 @@
+/*
+ * Copyright 2025 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apfMesh.h"
+#include <pcu_util.h>
+#include <algorithm>
+
+namespace apf {
+
+Connectivity const& Mesh::getConnectivity(int dimension)
+{
+  PCU_ALWAYS_ASSERT(0 <= dimension && dimension < 4);
+  Connectivity*& c = connectivity[dimension];
+  if (c)
+    return *c;
+  c = new Connectivity();
+  std::size_t n = count(dimension);
+  c->elements.reserve(n);
+  c->offsets.reserve(n + 1);
+  c->offsets.push_back(0);
+  MeshIterator* it = begin(dimension);
+  MeshEntity* e;
+  while ((e = iterate(it))) {
+    Downward v;
+    int nv = getDownward(e, 0, v);
+    c->elements.push_back(e);
+    c->vertices.insert(c->vertices.end(), v, v + nv);
+    c->offsets.push_back(c->vertices.size());
+  }
+  end(it);
+  return *c;
+}
+
+void Mesh::clearConnectivity()
+{
+  for (int d = 0; d < 4; ++d) {
+    delete connectivity[d];
+    connectivity[d] = 0;
+  }
+  clearClassified();
+  ++changes;
+}
+
+/* the entities of one dimension grouped by classification:
+   those on models[i] are entities[offsets[i]] up to
+   entities[offsets[i + 1]], with models sorted */
+struct Classification
+{
+  std::vector<ModelEntity*> models;
+  std::vector<int> offsets;
+  std::vector<MeshEntity*> entities;
+};
+
+static Classification* classify(Mesh* m, int dimension)
+{
+  Classification* c = new Classification();
+  std::vector<ModelEntity*> of;
+  of.reserve(m->count(dimension));
+  MeshIterator* it = m->begin(dimension);
+  MeshEntity* e;
+  while ((e = m->iterate(it)))
+    of.push_back(m->toModel(e));
+  m->end(it);
+  c->models = of;
+  std::sort(c->models.begin(), c->models.end());
+  c->models.erase(std::unique(c->models.begin(), c->models.end()),
+      c->models.end());
+  /* counting sort of the entities by model, keeping their order */
+  std::vector<int> next(c->models.size() + 1, 0);
+  std::vector<int> group(of.size());
+  for (size_t i = 0; i < of.size(); ++i) {
+    group[i] = std::lower_bound(c->models.begin(), c->models.end(), of[i])
+      - c->models.begin();
+    ++next[group[i] + 1];
+  }
+  for (size_t i = 1; i < next.size(); ++i)
+    next[i] += next[i - 1];
+  c->offsets = next;
+  c->entities.resize(of.size());
+  it = m->begin(dimension);
+  for (size_t i = 0; (e = m->iterate(it)); ++i)
+    c->entities[next[group[i]]++] = e;
+  m->end(it);
+  return c;
+}
+
+void Mesh::getClassified(ModelEntity* g, int dimension,
+    std::vector<MeshEntity*>& entities)
+{
+  PCU_ALWAYS_ASSERT(0 <= dimension && dimension < 4);
+  Classification*& c = classification[dimension];
+  if (!c)
+    c = classify(this, dimension);
+  std::vector<ModelEntity*>::const_iterator found =
+    std::lower_bound(c->models.begin(), c->models.end(), g);
+  if (found == c->models.end() || *found != g)
+    return;
+  size_t i = found - c->models.begin();
+  entities.insert(entities.end(),
+      c->entities.begin() + c->offsets[i],
+      c->entities.begin() + c->offsets[i + 1]);
+}
+
+void Mesh::clearClassified()
+{
+  for (int d = 0; d < 4; ++d) {
+    delete classification[d];
+    classification[d] = 0;
+  }
+}
+
+}
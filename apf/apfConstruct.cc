@@ -3,7 +3,11 @@
 #include "apfMesh2.h"
 #include "apf.h"
 #include "apfNumbering.h"
+#include <pcu_util.h>
+#include <algorithm>
+#include <iterator>
 #include <map>
+#include <vector>
 
 namespace apf {
 
@@ -25,14 +29,12 @@ static void constructElements(
     GlobalToVert& globalToVert)
 {
   ModelEntity* interior = m->findModelEntity(m->getDimension(), 0);
-  int nev = apf::Mesh::adjacentCount[etype][0];
-  for (int i = 0; i < nelem; ++i) {
-    Downward verts;
-    int offset = i * nev;
-    for (int j = 0; j < nev; ++j)
-      verts[j] = globalToVert[conn[j + offset]];
-    buildElement(m, interior, etype, verts);
-  }
+  int end = nelem * apf::Mesh::adjacentCount[etype][0];
+  std::vector<MeshEntity*> verts(end);
+  for (int i = 0; i < end; ++i)
+    verts[i] = globalToVert[conn[i]];
+  if (nelem)
+    buildElements(m, interior, etype, nelem, &verts[0]);
 }
 
 static Gid getMax(const GlobalToVert& globalToVert)
@@ -144,6 +146,156 @@ static void constructRemotes(Mesh2* m, GlobalToVert& globalToVert)
   }
 }
 
+/* the sorted global ids of the vertices of an entity,
+   which name it the same way on every part that has it */
+struct EntityKey
+{
+  int n;
+  Gid ids[4];
+  bool operator<(EntityKey const& other) const
+  {
+    if (n != other.n)
+      return n < other.n;
+    return std::lexicographical_compare(ids, ids + n,
+        other.ids, other.ids + n);
+  }
+  bool operator==(EntityKey const& other) const
+  {
+    return n == other.n && std::equal(ids, ids + n, other.ids);
+  }
+  /* at most four ids: a plain insertion sort, which also keeps
+     std::sort's 16-element threshold off this small array */
+  void sort()
+  {
+    for (int i = 1; i < n; ++i)
+      for (int j = i; j > 0 && ids[j] < ids[j - 1]; --j)
+        std::swap(ids[j], ids[j - 1]);
+  }
+  int getBroker(int peers) const
+  {
+    unsigned h = n;
+    for (int i = 0; i < n; ++i)
+      h = (h ^ static_cast<unsigned>(ids[i])) * 16777619u;
+    return h % peers;
+  }
+};
+
+struct KeyCopy
+{
+  EntityKey key;
+  int part;
+  MeshEntity* entity;
+  bool operator<(KeyCopy const& other) const
+  {
+    if (key == other.key)
+      return part < other.part;
+    return key < other.key;
+  }
+};
+
+/* an entity can only be shared by the parts that
+   have all of its vertices */
+static bool mayBeShared(Mesh* m, Downward verts, int nv)
+{
+  Parts parts;
+  m->getResidence(verts[0], parts);
+  for (int i = 1; i < nv && parts.size() > 1; ++i) {
+    Parts vp;
+    m->getResidence(verts[i], vp);
+    Parts both;
+    std::set_intersection(parts.begin(), parts.end(), vp.begin(), vp.end(),
+        std::inserter(both, both.begin()));
+    parts.swap(both);
+  }
+  return parts.size() > 1;
+}
+
+/* does the work of apf::stitchMesh for all dimensions at once
+   with the vertex global ids: every entity that may be shared is
+   sent to the broker for its sorted vertex ids, and the brokers
+   send each copy the others they received under the same ids.
+   this is two exchanges in all, without looking up entities by
+   their downward adjacencies */
+static void stitchByGlobalIds(Mesh2* m, GlobalToVert& globalToVert)
+{
+  MeshTag* gids = m->createIntTag("apf_construct_gid", 1);
+  APF_ITERATE(GlobalToVert, globalToVert, it)
+    m->setIntTag(it->second, gids, &it->first);
+  int peers = PCU_Comm_Peers();
+  PCU_Comm_Begin();
+  for (int d = 1; d < m->getDimension(); ++d) {
+    MeshIterator* it = m->begin(d);
+    MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      Downward verts;
+      int nv = m->getDownward(e, 0, verts);
+      bool shared = true;
+      for (int i = 0; i < nv; ++i)
+        if (!m->isShared(verts[i]))
+          shared = false;
+      if (!shared || !mayBeShared(m, verts, nv))
+        continue;
+      EntityKey key;
+      PCU_ALWAYS_ASSERT(nv <= 4);
+      key.n = nv;
+      for (int i = 0; i < nv; ++i)
+        m->getIntTag(verts[i], gids, &key.ids[i]);
+      key.sort();
+      int to = key.getBroker(peers);
+      PCU_COMM_PACK(to, key);
+      PCU_COMM_PACK(to, e);
+    }
+    m->end(it);
+  }
+  PCU_Comm_Send();
+  std::vector<KeyCopy> copies;
+  while (PCU_Comm_Receive()) {
+    KeyCopy c;
+    PCU_COMM_UNPACK(c.key);
+    PCU_COMM_UNPACK(c.entity);
+    c.part = PCU_Comm_Sender();
+    copies.push_back(c);
+  }
+  std::sort(copies.begin(), copies.end());
+  PCU_Comm_Begin();
+  for (size_t i = 0; i < copies.size();) {
+    size_t end = i + 1;
+    while (end < copies.size() && copies[end].key == copies[i].key)
+      ++end;
+    int n = end - i - 1;
+    if (n)
+      for (size_t j = i; j < end; ++j) {
+        int to = copies[j].part;
+        PCU_COMM_PACK(to, copies[j].entity);
+        PCU_COMM_PACK(to, n);
+        for (size_t k = i; k < end; ++k)
+          if (k != j) {
+            PCU_COMM_PACK(to, copies[k].part);
+            PCU_COMM_PACK(to, copies[k].entity);
+          }
+      }
+    i = end;
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    MeshEntity* e;
+    PCU_COMM_UNPACK(e);
+    int n;
+    PCU_COMM_UNPACK(n);
+    for (int i = 0; i < n; ++i) {
+      int part;
+      MeshEntity* remote;
+      PCU_COMM_UNPACK(part);
+      PCU_COMM_UNPACK(remote);
+      m->addRemote(e, part, remote);
+    }
+  }
+  for (int d = 1; d < m->getDimension(); ++d)
+    initResidence(m, d);
+  removeTagFromDimension(m, gids, 0);
+  m->destroyTag(gids);
+}
+
 void construct(Mesh2* m, const int* conn, int nelem, int etype,
     GlobalToVert& globalToVert)
 {
@@ -151,7 +303,20 @@ void construct(Mesh2* m, const int* conn, int nelem, int etype,
   constructElements(m, conn, nelem, etype, globalToVert);
   constructResidence(m, globalToVert);
   constructRemotes(m, globalToVert);
-  stitchMesh(m);
+  stitchByGlobalIds(m, globalToVert);
+  m->acceptChanges();
+}
+
+void construct(Mesh2* m, const int* const* conn, const int* nelem,
+    GlobalToVert& globalToVert)
+{
+  for (int t = 0; t < Mesh::TYPES; ++t)
+    constructVerts(m, conn[t], nelem[t], t, globalToVert);
+  for (int t = 0; t < Mesh::TYPES; ++t)
+    constructElements(m, conn[t], nelem[t], t, globalToVert);
+  constructResidence(m, globalToVert);
+  constructRemotes(m, globalToVert);
+  stitchByGlobalIds(m, globalToVert);
   m->acceptChanges();
 }
 
@@ -1,26 +1,40 @@
 #include <PCU.h>
 #include "apf.h"
 #include "apfConvert.h"
+#include "apfField.h"
+#include "apfFieldData.h"
 #include "apfMesh.h"
 #include "apfMesh2.h"
 #include "apfShape.h"
 #include "apfNumbering.h"
-#include <map>
 #include <pcu_util.h>
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 namespace apf {
 
+/* the entities of each dimension of both meshes are kept in
+   flat arrays in the order of the input iteration, so an input
+   entity stands for its copy by its index. Input entities find
+   their index by storage key when the input has keys and in a
+   temporary tag otherwise. */
 class Converter
 {
   public:
-    Converter(Mesh *a, Mesh2 *b)
+    Converter(Mesh *a, Mesh2 *b, int t)
     {
       inMesh = a;
       outMesh = b;
+      threads = std::max(t, 1);
+      indexTag = 0;
+      oldModel = 0;
+      newModel = 0;
     }
     void run()
     {
+      gather();
+      reserve();
       createVertices();
       createEntities();
       for (int i = 0; i <= inMesh->getDimension(); ++i)
@@ -32,33 +46,89 @@ class Converter
       convertFields();
       convertNumberings();
       convertGlobalNumberings();
+      dropIndices();
       // this must be called after anything that might create tags e.g. fields
       // or numberings to avoid problems with tag duplication
       convertTags();
       outMesh->acceptChanges();
     }
+    /* consecutive entities tend to share their classification */
     ModelEntity* getNewModelFromOld(ModelEntity* oldC)
     {
+      if (oldC && oldC == oldModel)
+        return newModel;
       int type = inMesh->getModelType(oldC);
       int tag = inMesh->getModelTag(oldC);
-      return outMesh->findModelEntity(type,tag);
+      oldModel = oldC;
+      newModel = outMesh->findModelEntity(type,tag);
+      return newModel;
+    }
+    void gather()
+    {
+      int nkeys = inMesh->countStorageKeys();
+      if (nkeys)
+        byKey.assign(nkeys, -1);
+      else
+        indexTag = inMesh->createIntTag("apf_convert_index", 1);
+      for (int d = 0; d <= inMesh->getDimension(); ++d)
+      {
+        olds[d].reserve(inMesh->count(d));
+        MeshIterator* it = inMesh->begin(d);
+        MeshEntity* e;
+        while ((e = inMesh->iterate(it)))
+        {
+          int i = olds[d].size();
+          if (indexTag)
+            inMesh->setIntTag(e, indexTag, &i);
+          else
+            byKey[inMesh->getStorageKey(e)] = i;
+          olds[d].push_back(e);
+        }
+        inMesh->end(it);
+        news[d].resize(olds[d].size());
+      }
+    }
+    int getIndex(MeshEntity* old)
+    {
+      if (!indexTag)
+        return byKey[inMesh->getStorageKey(old)];
+      int i;
+      inMesh->getIntTag(old, indexTag, &i);
+      return i;
+    }
+    MeshEntity* getNew(int dim, MeshEntity* old)
+    {
+      return news[dim][getIndex(old)];
+    }
+    void dropIndices()
+    {
+      if (!indexTag)
+        return;
+      for (int d = 0; d <= inMesh->getDimension(); ++d)
+        for (size_t i = 0; i < olds[d].size(); ++i)
+          inMesh->removeTag(olds[d][i], indexTag);
+      inMesh->destroyTag(indexTag);
+      indexTag = 0;
+    }
+    void reserve()
+    {
+      for (int t = 0; t < Mesh::TYPES; ++t)
+        if (Mesh::typeDimension[t] <= inMesh->getDimension())
+          outMesh->reserve(t, inMesh->countType(t));
     }
     void createVertices()
     {
-      MeshIterator* it = inMesh->begin(0);
-      MeshEntity *oldV;
-      while ((oldV = inMesh->iterate(it)))
+      for (size_t i = 0; i < olds[0].size(); ++i)
       {
+        MeshEntity* oldV = olds[0][i];
         ModelEntity *oldC = inMesh->toModel(oldV);
         ModelEntity *newC = getNewModelFromOld(oldC);
         Vector3 xyz;
         inMesh->getPoint(oldV, 0, xyz);
         Vector3 param(0,0,0);
         inMesh->getParam(oldV,param);
-        MeshEntity* newV = outMesh->createVertex(newC, xyz, param);
-        newFromOld[oldV] = newV;
+        news[0][i] = outMesh->createVertex(newC, xyz, param);
       }
-      inMesh->end(it);
       PCU_ALWAYS_ASSERT(outMesh->count(0) == inMesh->count(0));
     }
     void createEntities()
@@ -66,26 +136,52 @@ class Converter
       for (int i = 1; i < (inMesh->getDimension())+1; ++i)
         createDimension(i);
     }
+    /* the downward indices of a range of the entities of a
+       dimension, which threads gather from the input at once */
+    struct DownChunk
+    {
+      Converter* converter;
+      int dim;
+    };
+    static void gatherChunk(void* p, size_t first, size_t end)
+    {
+      DownChunk* c = static_cast<DownChunk*>(p);
+      Converter* self = c->converter;
+      Mesh* m = self->inMesh;
+      int d = c->dim;
+      for (size_t i = first; i < end; ++i)
+      {
+        Downward down;
+        int ne = m->getDownward(self->olds[d][i], d - 1, down);
+        int* out = &self->down[i * 12];
+        for (int j = 0; j < ne; ++j)
+          out[j] = self->getIndex(down[j]);
+      }
+    }
+    void gatherDown(int dim)
+    {
+      size_t n = olds[dim].size();
+      down.resize(n * 12);
+      DownChunk c;
+      c.converter = this;
+      c.dim = dim;
+      PCU_Thrd_Chunks(threads, n, gatherChunk, &c);
+    }
     void createDimension(int dim)
     { 
-      MeshIterator* it = inMesh->begin(dim);
-      MeshEntity *oldE;
-      while ((oldE = inMesh->iterate(it)))
+      gatherDown(dim);
+      for (size_t i = 0; i < olds[dim].size(); ++i)
       {
+        MeshEntity* oldE = olds[dim][i];
         int type = inMesh->getType(oldE);
         ModelEntity *oldC = inMesh->toModel(oldE);
         ModelEntity *newC = getNewModelFromOld(oldC);
-        Downward down;
-        int ne = inMesh->getDownward(oldE, dim-1, down);
+        int ne = Mesh::adjacentCount[type][dim - 1];
         Downward new_down;
-        for(int i=0; i<ne; ++i)
-        {
-          new_down[i]=newFromOld[down[i]];
-        }
-        MeshEntity *newE = outMesh->createEntity(type, newC, new_down); 
-        newFromOld[oldE] = newE;
+        for(int j=0; j<ne; ++j)
+          new_down[j] = news[dim - 1][down[i * 12 + j]];
+        news[dim][i] = outMesh->createEntity(type, newC, new_down);
       }
-      inMesh->end(it);
       PCU_ALWAYS_ASSERT(outMesh->count(dim) == inMesh->count(dim));
     }
     void createRemotes(int dim)
@@ -99,11 +195,12 @@ class Converter
          they go both ways; as long as every link
          gets a backward copy they will all get copies */
       PCU_Comm_Begin();
-      MeshIterator* it = inMesh->begin(dim);
-      MeshEntity *oldLeft;
-      while ((oldLeft = inMesh->iterate(it)))
+      for (size_t i = 0; i < olds[dim].size(); ++i)
       {
-        MeshEntity *newLeft = newFromOld[oldLeft];
+        MeshEntity *oldLeft = olds[dim][i];
+        if (!inMesh->isShared(oldLeft))
+          continue;
+        MeshEntity *newLeft = news[dim][i];
         Copies remotes;
         inMesh->getRemotes(oldLeft, remotes);
         APF_ITERATE(Copies,remotes,it) 
@@ -114,10 +211,8 @@ class Converter
           PCU_COMM_PACK(rightPart,newLeft);
         }
       }
-      inMesh->end(it);
       PCU_Comm_Send();
-      /* accumulation of residence sets... we could also constantly reclassify... */
-      std::map<MeshEntity*, std::vector<int> > map_ent;
+      std::vector<MeshEntity*> shared;
       while (PCU_Comm_Listen())
       {
         int leftPart = PCU_Comm_Sender();
@@ -127,45 +222,46 @@ class Converter
           PCU_COMM_UNPACK(oldRight);
           MeshEntity* newLeft;
           PCU_COMM_UNPACK(newLeft);
-          MeshEntity *newRight = newFromOld[oldRight];
+          MeshEntity *newRight = getNew(dim, oldRight);
           outMesh->addRemote(newRight, leftPart, newLeft);
-          map_ent[newRight].push_back(leftPart);
+          shared.push_back(newRight);
         }
       }
-      /* assign accumulated residence sets */
-      std::map <MeshEntity*, std::vector<int> >::iterator mit;
-      for(mit=map_ent.begin(); mit!=map_ent.end(); ++mit)
+      /* residence sets follow from the remotes once all arrived */
+      std::sort(shared.begin(), shared.end());
+      shared.erase(std::unique(shared.begin(), shared.end()), shared.end());
+      for (size_t i = 0; i < shared.size(); ++i)
       {
-        MeshEntity* newE;
-        newE = mit->first;
-        std::vector<int>& vecEnt = mit->second;
         Copies remotes;
+        outMesh->getRemotes(shared[i], remotes);
         Parts parts;
-        parts.insert(vecEnt.begin(), vecEnt.end());
+        APF_ITERATE(Copies, remotes, it)
+          parts.insert(it->first);
         parts.insert(PCU_Comm_Self());
-        outMesh->setResidence(newE, parts);
+        outMesh->setResidence(shared[i], parts);
       }
     }
+    /* whole entities at a time through the field data,
+       both meshes having the same nodes on each entity */
     void convertField(Field* in, Field* out)
     {
       FieldShape* s = getShape(in);
-      NewArray<double> data(countComponents(in));
-      for (int d = 0; d <= 3; ++d)
+      FieldDataOf<double>* from = in->getData();
+      FieldDataOf<double>* to = out->getData();
+      NewArray<double> data;
+      for (int d = 0; d <= inMesh->getDimension(); ++d)
       {
-        if (s->hasNodesIn(d))
+        if (!s->hasNodesIn(d))
+          continue;
+        for (size_t i = 0; i < olds[d].size(); ++i)
         {
-          MeshIterator* it = inMesh->begin(d);
-          MeshEntity* e;
-          while ((e = inMesh->iterate(it)))
-          {
-            int n = s->countNodesOn(inMesh->getType(e));
-            for (int i = 0; i < n; ++i)
-            {
-              getComponents(in,e,i,&(data[0]));
-              setComponents(out,newFromOld[e],i,&(data[0]));
-            }
-          }
-          inMesh->end(it);
+          MeshEntity* e = olds[d][i];
+          int n = in->countValuesOn(e);
+          if (!n)
+            continue;
+          data.resize(n);
+          from->get(e, &(data[0]));
+          to->set(news[d][i], &(data[0]));
         }
       }
     }
@@ -173,24 +269,17 @@ class Converter
     {
       FieldShape* s = getShape(in);
       int nc = countComponents(in);
-      for (int d = 0; d <= 3; ++d)
+      for (int d = 0; d <= inMesh->getDimension(); ++d)
       {
-        if (s->hasNodesIn(d))
+        if (!s->hasNodesIn(d))
+          continue;
+        for (size_t k = 0; k < olds[d].size(); ++k)
         {
-          MeshIterator* it = inMesh->begin(d);
-          MeshEntity* e;
-          while ((e = inMesh->iterate(it)))
-          {
-            int nn = s->countNodesOn(inMesh->getType(e));
-            for (int i = 0; i < nn; ++i)
-            {
-              for (int j = 0; j < nc; ++j) {
-                number(out, newFromOld[e], i, j,
-                    getNumber(in, e, i, j));
-              }
-            }
-          }
-          inMesh->end(it);
+          MeshEntity* e = olds[d][k];
+          int nn = s->countNodesOn(inMesh->getType(e));
+          for (int i = 0; i < nn; ++i)
+            for (int j = 0; j < nc; ++j)
+              number(out, news[d][k], i, j, getNumber(in, e, i, j));
         }
       }
     }
@@ -200,60 +289,50 @@ class Converter
       FieldShape* s = getShape(in);
       int nc = countComponents(in);
       PCU_DEBUG_ASSERT(nc == 1);
-      for (int d = 0; d <= 3; ++d) {
-        if (s->hasNodesIn(d)) {
-          MeshIterator* it = inMesh->begin(d);
-          MeshEntity* e;
-          while ((e = inMesh->iterate(it))) {
-            int nn = s->countNodesOn(inMesh->getType(e));
-            for (int i = 0; i < nn; ++i)
-              number(out, newFromOld[e], i,
-                  getNumber(in, e, i, 0));
-          }
-          inMesh->end(it);
+      for (int d = 0; d <= inMesh->getDimension(); ++d) {
+        if (!s->hasNodesIn(d))
+          continue;
+        for (size_t k = 0; k < olds[d].size(); ++k) {
+          MeshEntity* e = olds[d][k];
+          int nn = s->countNodesOn(inMesh->getType(e));
+          for (int i = 0; i < nn; ++i)
+            number(out, news[d][k], i, getNumber(in, e, i, 0));
         }
       }
     }
-    void convertTag(Mesh* inMesh, MeshTag* in, Mesh* outMesh, MeshTag* out)
+    template <class T>
+    void convertTagOf(MeshTag* in, MeshTag* out,
+        void (Mesh::*get)(MeshEntity*, MeshTag*, T*),
+        void (Mesh::*set)(MeshEntity*, MeshTag*, T const*))
     {
-      for (int d = 0; d <= 3; ++d) {
-        int tagType = inMesh->getTagType(in);
-        int tagSize = inMesh->getTagSize(in);
-        PCU_DEBUG_ASSERT(tagType == outMesh->getTagType(out));
-        PCU_DEBUG_ASSERT(tagSize == outMesh->getTagSize(out));
-        MeshIterator* it = inMesh->begin(d);
-        MeshEntity* e;
-        while ((e = inMesh->iterate(it))) {
-          if(inMesh->hasTag(e, in)) {
-            // these initializations cannot go into the cases due to compiler
-            // warnings on gcc 7.3.0
-            double* dblData;
-            int* intData;
-            long* lngData; 
-            switch (tagType) {
-              case apf::Mesh::TagType::DOUBLE:
-                dblData = new double[tagSize];
-                inMesh->getDoubleTag(e, in, dblData);
-                outMesh->setDoubleTag(newFromOld[e], out, dblData);
-                break;
-              case apf::Mesh::TagType::INT:
-                intData = new int[tagSize];
-                inMesh->getIntTag(e, in, intData);
-                outMesh->setIntTag(newFromOld[e], out, intData);
-                break;
-              case apf::Mesh::TagType::LONG:
-                lngData = new long[tagSize];
-                inMesh->getLongTag(e, in, lngData);
-                outMesh->setLongTag(newFromOld[e], out, lngData);
-                break;
-              default:
-                std::cerr << "Tried to convert unknown tag type\n";
-                abort();
-                break;
-            }
-        }
-        }
-        inMesh->end(it);
+      std::vector<T> data(inMesh->getTagSize(in));
+      for (int d = 0; d <= inMesh->getDimension(); ++d)
+        for (size_t i = 0; i < olds[d].size(); ++i)
+          if (inMesh->hasTag(olds[d][i], in)) {
+            (inMesh->*get)(olds[d][i], in, &data[0]);
+            (outMesh->*set)(news[d][i], out, &data[0]);
+          }
+    }
+    void convertTag(MeshTag* in, MeshTag* out)
+    {
+      int tagType = inMesh->getTagType(in);
+      PCU_DEBUG_ASSERT(tagType == outMesh->getTagType(out));
+      PCU_DEBUG_ASSERT(inMesh->getTagSize(in) == outMesh->getTagSize(out));
+      switch (tagType) {
+        case apf::Mesh::TagType::DOUBLE:
+          convertTagOf<double>(in, out, &Mesh::getDoubleTag,
+              &Mesh::setDoubleTag);
+          break;
+        case apf::Mesh::TagType::INT:
+          convertTagOf<int>(in, out, &Mesh::getIntTag, &Mesh::setIntTag);
+          break;
+        case apf::Mesh::TagType::LONG:
+          convertTagOf<long>(in, out, &Mesh::getLongTag, &Mesh::setLongTag);
+          break;
+        default:
+          std::cerr << "Tried to convert unknown tag type\n";
+          abort();
+          break;
       }
     }
     void convertFields()
@@ -334,7 +413,7 @@ class Converter
           }
           PCU_DEBUG_ASSERT(out);
           // copy the tag on the inMesh to the outMesh
-          convertTag(inMesh, in, outMesh, out);
+          convertTag(in, out);
         }
       }
     }
@@ -351,11 +430,10 @@ class Converter
     {
       /* see createRemotes for the algorithm comments */
       PCU_Comm_Begin();
-      MeshIterator* it = inMesh->begin(dim);
-      MeshEntity *oldLeft;
-      while ((oldLeft = inMesh->iterate(it)))
+      for (size_t k = 0; k < olds[dim].size(); ++k)
       {
-        MeshEntity *newLeft = newFromOld[oldLeft];
+        MeshEntity *oldLeft = olds[dim][k];
+        MeshEntity *newLeft = news[dim][k];
         Matches matches;
         inMesh->getMatches(oldLeft, matches);
         for (size_t i = 0; i < matches.getSize(); ++i)
@@ -366,7 +444,6 @@ class Converter
           PCU_COMM_PACK(rightPart,newLeft);
         }
       }
-      inMesh->end(it);
       PCU_Comm_Send();
       while (PCU_Comm_Listen())
       {
@@ -377,7 +454,7 @@ class Converter
           PCU_COMM_UNPACK(oldRight);
           MeshEntity* newLeft;
           PCU_COMM_UNPACK(newLeft);
-          MeshEntity *newRight = newFromOld[oldRight];
+          MeshEntity *newRight = getNew(dim, oldRight);
           outMesh->addMatch(newRight, leftPart, newLeft);
         }
       }
@@ -385,12 +462,19 @@ class Converter
   private:
     Mesh *inMesh;
     Mesh2 *outMesh;
-    std::map<MeshEntity*,MeshEntity*> newFromOld;
+    int threads;
+    std::vector<MeshEntity*> olds[4];
+    std::vector<MeshEntity*> news[4];
+    std::vector<int> byKey;
+    MeshTag* indexTag;
+    std::vector<int> down;
+    ModelEntity* oldModel;
+    ModelEntity* newModel;
 };
 
-void convert(Mesh *in, Mesh2 *out)
+void convert(Mesh *in, Mesh2 *out, int threads)
 {
-  Converter c(in,out);
+  Converter c(in,out,threads);
   c.run();
 }
 
@@ -24,8 +24,13 @@ class MeshEntity;
   \details this function will fill in a structure that fully
   implements apf::Mesh2 by using information from an implementation
   of apf::Mesh. This is a fully scalable parallel mesh conversion
-  tool. */
-void convert(Mesh *in, Mesh2 *out);
+  tool. The entities of (in) are listed once per dimension and found
+  in those lists by apf::Mesh::getStorageKey, or a temporary tag if
+  (in) has no keys, so the copy takes time in proportion to its size.
+  \param threads the number of threads that gather the downward
+         adjacencies of (in), which must then answer adjacency,
+         key and tag queries from several threads at once */
+void convert(Mesh *in, Mesh2 *out, int threads = 1);
 
 /** \brief a map from global ids to vertex objects */
 typedef std::map<int, MeshEntity*> GlobalToVert;
@@ -47,6 +52,13 @@ typedef std::map<int, MeshEntity*> GlobalToVert;
 void construct(Mesh2* m, const int* conn, int nelem, int etype,
     GlobalToVert& globalToVert);
 
+/** \brief construct a mesh with several element types
+  \details the same as apf::construct, with (conn[t]) and (nelem[t])
+  giving the elements of each apf::Mesh::Type (t). Types with no
+  elements may have null connectivity. */
+void construct(Mesh2* m, const int* const* conn, const int* nelem,
+    GlobalToVert& globalToVert);
+
 /** \brief Assign coordinates to the mesh
   * \details
   * Each peer provides a set of the coordinates. The coords most be ordered
@@ -23,30 +23,21 @@ class DynamicArray : public can::Array<T, 0> {
     std::size_t getSize() const {return Base::size();}
     /** \brief resize the array
         \details this is here for backwards compatibility
-        with apf::DynamicArray, hence the different code
-        because it preserves common elements */
+        with apf::DynamicArray, it preserves common elements */
     void setSize(unsigned n)
     {
-      if (Base::size() == n)
-        return;
-      T* newElems = new T[n];
-      unsigned commonSize = Base::size();
-      if (n < Base::size())
-        commonSize = n;
-      for (unsigned i = 0; i < commonSize; ++i)
-        newElems[i] = (*this)[i];
-      delete [] Base::elems;
-      Base::elems = newElems;
-      Base::sz = n;
+      Base::resize_copy(n);
     }
-    /** \brief slow element append
-        \details this is the one operation where
-        std::vector is better. This function is
-        here for convenience, but it is O(N) */
+    /** \brief element append
+        \details the capacity grows geometrically,
+        so appending is amortized constant time */
     void append(T const& v)
     {
-      setSize(Base::size() + 1);
-      (*this)[Base::size() - 1] = v;
+      std::size_t n = Base::size();
+      if (n == Base::capacity())
+        Base::reserve(n ? 2 * n : 1);
+      setSize(n + 1);
+      (*this)[n] = v;
     }
     /** \brief append an array
       \details this is slightly optimized
@@ -38,6 +38,13 @@ Element::~Element()
 {
 }
 
+/* arrays keep their storage when the new entity
+   has as many nodes as the old one */
+void Element::rebind(MeshEntity* e, VectorElement* p)
+{
+  init(field,e,p);
+}
+
 Matrix3x3 getJacobianInverse(Matrix3x3 J, int dim)
 {
   switch (dim) {
@@ -72,14 +79,41 @@ Matrix3x3 getJacobianInverse(Matrix3x3 J, int dim)
   }
 }
 
+/* integration points usually hit the field shape cache,
+   other points are evaluated by the entity shape */
+void Element::getShapeValues(Vector3 const& xi, NewArray<double>& values)
+{
+  double const* cv;
+  Vector3 const* cg;
+  if ( ! field->getShape()->getCached(mesh, entity, xi, &cv, &cg)) {
+    shape->getValues(mesh, entity, xi, values);
+    return;
+  }
+  values.allocate(nen);
+  for (int i = 0; i < nen; ++i)
+    values[i] = cv[i];
+}
+
+void Element::getLocalGradients(Vector3 const& xi, NewArray<Vector3>& grads)
+{
+  double const* cv;
+  Vector3 const* cg;
+  if ( ! field->getShape()->getCached(mesh, entity, xi, &cv, &cg)) {
+    shape->getLocalGradients(mesh, entity, xi, grads);
+    return;
+  }
+  grads.allocate(nen);
+  for (int i = 0; i < nen; ++i)
+    grads[i] = cg[i];
+}
+
 void Element::getGlobalGradients(Vector3 const& local,
                                  NewArray<Vector3>& globalGradients)
 {
   Matrix3x3 J;
   parent->getJacobian(local,J);
   Matrix3x3 jinv = getJacobianInverse(J, getDimension());
-  NewArray<Vector3> localGradients;
-  shape->getLocalGradients(mesh, entity, local,localGradients);
+  getLocalGradients(local,localGradients);
   globalGradients.allocate(nen);
   for (int i=0; i < nen; ++i)
     globalGradients[i] = jinv * localGradients[i];
@@ -87,13 +121,18 @@ void Element::getGlobalGradients(Vector3 const& local,
 
 void Element::getComponents(Vector3 const& xi, double* c)
 {
-  NewArray<double> shapeValues;
-  shape->getValues(mesh, entity, xi, shapeValues);
+  double const* values;
+  Vector3 const* grads;
+  if ( ! field->getShape()->getCached(mesh, entity, xi,
+        &values, &grads)) {
+    shape->getValues(mesh, entity, xi, shapeValues);
+    values = &(shapeValues[0]);
+  }
   for (int ci = 0; ci < nc; ++ci)
     c[ci] = 0;
   for (int ni = 0; ni < nen; ++ni)
     for (int ci = 0; ci < nc; ++ci)
-      c[ci] += nodeData[ni * nc + ci] * shapeValues[ni];
+      c[ci] += nodeData[ni * nc + ci] * values[ni];
 }
 
 void Element::getNodeData()
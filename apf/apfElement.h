@@ -33,6 +33,9 @@ class Element
     Mesh* getMesh() {return mesh;}
     EntityShape* getShape() {return shape;}
     void getComponents(Vector3 const& xi, double* c);
+    void getShapeValues(Vector3 const& xi, NewArray<double>& values);
+    void getLocalGradients(Vector3 const& xi, NewArray<Vector3>& grads);
+    void rebind(MeshEntity* e, VectorElement* p);
   protected:
     void init(Field* f, MeshEntity* e, VectorElement* p);
     void getNodeData();
@@ -44,6 +47,10 @@ class Element
     int nen;
     int nc;
     NewArray<double> nodeData;
+    /* scratch kept across evaluations and rebinding */
+    NewArray<double> shapeValues;
+    NewArray<Vector3> localGradients;
+    NewArray<Vector3> globalGradients;
 };
 
 Matrix3x3 getJacobianInverse(Matrix3x3 J, int dim);
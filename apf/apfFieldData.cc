@@ -3,6 +3,9 @@
 #include "apfShape.h"
 #include <pcu_util.h>
 #include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
 
 namespace apf {
 
@@ -15,16 +18,121 @@ void FieldData::rename(const char*)
   abort();
 }
 
+/* reserves room for an entity pointer followed by its (n) values.
+   In any one exchange every record is a pointer plus a multiple of
+   sizeof(T), so the values are aligned on both ends */
+template <class T>
+static T* packValues(int to, MeshEntity* e, int n)
+{
+  char* p = PCU_COMM_RESERVE(to, char, sizeof(e) + n * sizeof(T));
+  memcpy(p, &e, sizeof(e));
+  return reinterpret_cast<T*>(p + sizeof(e));
+}
+
+struct SharedLists
+{
+  DynamicArray<MeshEntity*> ents[4];
+};
+
+typedef std::map<int, SharedLists> PeerSharedLists;
+
+/* with the per-peer lists of a mesh both sides know which entities
+   a message is about, so it holds only a bit per entity saying
+   whether the sender has values for it, padded to keep the values
+   aligned, followed by those values.
+   Owners send to all copies when (fromOwners) is true,
+   otherwise each non-owner sends to all other copies. */
+template <class T>
+static bool exchangeByLists(FieldDataOf<T>* data, bool fromOwners, bool add)
+{
+  FieldBase* f = data->getField();
+  Mesh* m = f->getMesh();
+  FieldShape* s = f->getShape();
+  if (m->hasMatching() || PCU_Or( ! m->hasSharedLists()))
+    return false;
+  int self = PCU_Comm_Self();
+  PeerSharedLists lists;
+  for (int d = 0; d < 4; ++d) {
+    if ( ! s->hasNodesIn(d))
+      continue;
+    Parts peers;
+    m->getSharedPeers(d, peers);
+    APF_ITERATE(Parts, peers, it)
+      m->getSharedWith(d, *it, lists[*it].ents[d]);
+  }
+  PCU_Comm_Begin();
+  APF_ITERATE(PeerSharedLists, lists, it) {
+    int peer = it->first;
+    for (int d = 0; d < 4; ++d) {
+      DynamicArray<MeshEntity*>& ents = it->second.ents[d];
+      std::vector<MeshEntity*> sent;
+      for (size_t i = 0; i < ents.getSize(); ++i)
+        if ((m->getOwner(ents[i]) == self) == fromOwners)
+          sent.push_back(ents[i]);
+      if (sent.empty())
+        continue;
+      size_t flagBytes = ((sent.size() + 7) / 8 + sizeof(T) - 1)
+        / sizeof(T) * sizeof(T);
+      std::vector<unsigned char> flags(flagBytes, 0);
+      for (size_t i = 0; i < sent.size(); ++i)
+        if (data->hasEntity(sent[i]))
+          flags[i / 8] |= 1 << (i % 8);
+      PCU_Comm_Pack(peer, &(flags[0]), flagBytes);
+      for (size_t i = 0; i < sent.size(); ++i)
+        if (flags[i / 8] & (1 << (i % 8)))
+          data->get(sent[i], PCU_COMM_RESERVE(peer, T,
+                f->countValuesOn(sent[i])));
+    }
+  }
+  PCU_Comm_Send();
+  NewArray<T> values;
+  while (PCU_Comm_Receive()) {
+    int peer = PCU_Comm_Sender();
+    SharedLists& l = lists[peer];
+    for (int d = 0; d < 4; ++d) {
+      DynamicArray<MeshEntity*>& ents = l.ents[d];
+      std::vector<MeshEntity*> received;
+      for (size_t i = 0; i < ents.getSize(); ++i)
+        if ((m->getOwner(ents[i]) == peer) == fromOwners)
+          received.push_back(ents[i]);
+      if (received.empty())
+        continue;
+      size_t flagBytes = ((received.size() + 7) / 8 + sizeof(T) - 1)
+        / sizeof(T) * sizeof(T);
+      unsigned char const* flags =
+        PCU_COMM_EXTRACT(unsigned char, flagBytes);
+      for (size_t i = 0; i < received.size(); ++i) {
+        if ( ! (flags[i / 8] & (1 << (i % 8))))
+          continue;
+        MeshEntity* e = received[i];
+        int n = f->countValuesOn(e);
+        T const* in = PCU_COMM_EXTRACT(T, n);
+        if (add) {
+          values.resize(n);
+          data->get(e, &(values[0]));
+          for (int j = 0; j < n; ++j)
+            values[j] += in[j];
+          data->set(e, &(values[0]));
+        } else
+          data->set(e, in);
+      }
+    }
+  }
+  return true;
+}
+
 template <class T>
 void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr)
 {
   FieldBase* f = data->getField();
   Mesh* m = f->getMesh();
   FieldShape* s = f->getShape();
-  if (!shr)
-  {
-    shr = getSharing(m);
-    delete_shr=true;
+  if ((!shr) && exchangeByLists(data, true, false))
+    return;
+  if (!shr) {
+    /* the mesh owns its cached sharing */
+    shr = m->getCachedSharing();
+    delete_shr = false;
   }
   for (int d=0; d < 4; ++d)
   {
@@ -32,6 +140,7 @@ void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr)
       continue;
     MeshEntity* e;
     MeshIterator* it = m->begin(d);
+    NewArray<T> values;
     PCU_Comm_Begin();
     while ((e = m->iterate(it)))
     {
@@ -39,22 +148,18 @@ void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr)
           ( ! shr->isOwned(e)))
         continue;
       int n = f->countValuesOn(e);
-      NewArray<T> values(n);
+      values.resize(n);
       data->get(e,&(values[0]));
       CopyArray copies;
       shr->getCopies(e, copies);
       for (size_t i = 0; i < copies.getSize(); ++i)
-      {
-        PCU_COMM_PACK(copies[i].peer, copies[i].entity);
-        PCU_Comm_Pack(copies[i].peer, &(values[0]), n*sizeof(T));
-      }
+        memcpy(packValues<T>(copies[i].peer, copies[i].entity, n),
+            &(values[0]), n*sizeof(T));
       apf::Copies ghosts;  
       if (m->getGhosts(e, ghosts))
       APF_ITERATE(Copies, ghosts, it)
-      {
-        PCU_COMM_PACK(it->first, it->second);
-        PCU_Comm_Pack(it->first, &(values[0]), n*sizeof(T));
-      }
+        memcpy(packValues<T>(it->first, it->second, n),
+            &(values[0]), n*sizeof(T));
     }
     m->end(it);
     PCU_Comm_Send();
@@ -63,9 +168,7 @@ void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr)
       MeshEntity* e;
       PCU_COMM_UNPACK(e);
       int n = f->countValuesOn(e);
-      NewArray<T> values(n);
-      PCU_Comm_Unpack(&(values[0]),n*sizeof(T));
-      data->set(e,&(values[0]));
+      data->set(e, PCU_COMM_EXTRACT(T, n));
     }
   }
   if (delete_shr) delete shr;
@@ -81,10 +184,13 @@ void accumulateFieldData(FieldDataOf<double>* data, Sharing* shr, bool delete_sh
   FieldBase* f = data->getField();
   Mesh* m = f->getMesh();
   FieldShape* s = f->getShape();
-  if (!shr)
-  {
-    shr = getSharing(m);
-    delete_shr=true;
+  if ((!shr) && exchangeByLists(data, false, true)) {
+    exchangeByLists(data, true, false);
+    return;
+  }
+  if (!shr) {
+    shr = m->getCachedSharing();
+    delete_shr = false;
   }
   for (int d=0; d < 4; ++d)
   {
@@ -102,18 +208,14 @@ void accumulateFieldData(FieldDataOf<double>* data, Sharing* shr, bool delete_sh
       CopyArray copies;
       shr->getCopies(e, copies);
       int n = f->countValuesOn(e);
-      NewArray<double> values(n);
-      data->get(e,&(values[0]));
       /* actually, non-owners send to all others,
          since apf::Sharing doesn't identify the owner */
       for (size_t i = 0; i < copies.getSize(); ++i)
-      {
-        PCU_COMM_PACK(copies[i].peer, copies[i].entity);
-        PCU_Comm_Pack(copies[i].peer, &(values[0]), n*sizeof(double));
-      }
+        data->get(e, packValues<double>(copies[i].peer, copies[i].entity, n));
     }
     m->end(it);
     PCU_Comm_Send();
+    NewArray<double> values;
     while (PCU_Comm_Listen())
       while ( ! PCU_Comm_Unpacked())
       { /* receive and add. we only care about correctness
@@ -121,9 +223,8 @@ void accumulateFieldData(FieldDataOf<double>* data, Sharing* shr, bool delete_sh
         MeshEntity* e;
         PCU_COMM_UNPACK(e);
         int n = f->countValuesOn(e);
-        NewArray<double> values(n);
-        NewArray<double> inValues(n);
-        PCU_Comm_Unpack(&(inValues[0]),n*sizeof(double));
+        double const* inValues = PCU_COMM_EXTRACT(double, n);
+        values.resize(n);
         data->get(e,&(values[0]));
         for (int i = 0; i < n; ++i)
           values[i] += inValues[i];
@@ -204,14 +305,24 @@ int FieldDataOf<T>::getElementData(MeshEntity* entity, NewArray<T>& data)
       int na = mesh->getDownward(entity,d,a);
       for (int i = 0; i < na; ++i) {
         int nan = fs->countNodesOn(mesh->getType(a[i]));
+        if (!nan)
+          continue;
+        /* read in place when the storage allows it,
+           skipping a copy through the mesh tag interface */
+        T const* stored = getPointer(a[i]);
         if (nan > 1 && ed != d) { /* multiple shared nodes, check alignment */
           order.setSize(nen); /* nen >= nan */
-          adata.setSize(nen); /* setSize is no-op for the same size */
           es->alignSharedNodes(mesh, entity, a[i], &order[0]);
-          get(a[i], &adata[0]);
-          reorderData<T>(&adata[0], &data[n], &order[0], nc, nan);
-        } else if (nan) { /* non-zero set of nodes, either one
-                             or not shared */
+          if (!stored) {
+            adata.setSize(nen); /* setSize is no-op for the same size */
+            get(a[i], &adata[0]);
+            stored = &adata[0];
+          }
+          reorderData<T>(stored, &data[n], &order[0], nc, nan);
+        } else if (stored) { /* one node, or not shared */
+          for (int j = 0; j < nc * nan; ++j)
+            data[n + j] = stored[j];
+        } else {
           get(a[i], &data[n]);
         }
         n += nc * nan;
@@ -52,6 +52,9 @@ class FieldDataOf : public FieldData
   public:
     virtual void get(MeshEntity* e, T* data) = 0;
     virtual void set(MeshEntity* e, T const* data) = 0;
+    /* the stored values of (e) when the storage can hand them out
+       in place, otherwise zero and callers use get */
+    virtual T const* getPointer(MeshEntity* e) {(void)e; return 0;}
     void setNodeComponents(MeshEntity* e, int node, T const* components);
     void getNodeComponents(MeshEntity* e, int node, T* components);
     int getElementData(MeshEntity* entity, NewArray<T>& data);
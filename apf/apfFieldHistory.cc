@@ -0,0 +1,327 @@
+/*
+ * Copyright 2011 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apfFieldHistory.h"
+#include "apf.h"
+#include "apfField.h"
+#include "apfFieldData.h"
+#include "apfShape.h"
+#include <pcu_util.h>
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+namespace apf {
+
+/* the snapshots of each key interval go back to back in one
+   block. Values are predicted from the two before them in the
+   block and only the residual is coded, so the coder keeps the
+   last two snapshots stored, as bit patterns when lossless and
+   as multiples of twice the tolerance otherwise. */
+class FieldHistory
+{
+  public:
+    Field* field;
+    Mesh* mesh;
+    unsigned long changes;
+    double tolerance;
+    int keyInterval;
+    size_t values;
+    std::vector<std::vector<unsigned char> > blocks;
+    std::vector<size_t> offsets;
+    std::vector<uint64_t> last[2];
+};
+
+namespace {
+
+/* the values of a field in the order of apf::Mesh::begin,
+   over the dimensions with nodes */
+template <bool write>
+size_t walk(Field* f, std::vector<double>& values)
+{
+  Mesh* m = f->getMesh();
+  FieldShape* s = f->getShape();
+  FieldDataOf<double>* data = f->getData();
+  size_t n = 0;
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    if (!s->hasNodesIn(d))
+      continue;
+    MeshIterator* it = m->begin(d);
+    MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      int nv = f->countValuesOn(e);
+      if (!nv)
+        continue;
+      if (!write && !data->hasEntity(e))
+        fail("apf::FieldHistory: field has no values on an entity\n");
+      if (values.size() < n + nv)
+        values.resize(n + nv);
+      if (write)
+        data->set(e, &values[n]);
+      else
+        data->get(e, &values[n]);
+      n += nv;
+    }
+    m->end(it);
+  }
+  return n;
+}
+
+uint64_t toBits(double x)
+{
+  uint64_t b;
+  memcpy(&b, &x, sizeof(b));
+  return b;
+}
+
+double fromBits(uint64_t b)
+{
+  double x;
+  memcpy(&x, &b, sizeof(x));
+  return x;
+}
+
+int countLeadingZeroBytes(uint64_t x)
+{
+  int n = 0;
+  while (n < 8 && !(x >> (56 - 8 * n)))
+    ++n;
+  return n;
+}
+
+/* lossless: a residual is the XOR of the bits of a value and
+   its prediction, of which the leading zero bytes are dropped.
+   Two residuals share a byte holding their zero byte counts. */
+void encodeXor(uint64_t const* x, size_t n, std::vector<unsigned char>& out)
+{
+  for (size_t i = 0; i < n; i += 2) {
+    int lz[2] = {8, 8};
+    int nx = (i + 1 < n) ? 2 : 1;
+    for (int j = 0; j < nx; ++j)
+      lz[j] = countLeadingZeroBytes(x[i + j]);
+    out.push_back((unsigned char)((lz[0] << 4) | lz[1]));
+    for (int j = 0; j < nx; ++j)
+      for (int k = 0; k < 8 - lz[j]; ++k)
+        out.push_back((unsigned char)(x[i + j] >> (8 * k)));
+  }
+}
+
+unsigned char const* decodeXor(unsigned char const* in, size_t n,
+    uint64_t* x)
+{
+  for (size_t i = 0; i < n; i += 2) {
+    int lz[2] = {*in >> 4, *in & 0xF};
+    ++in;
+    int nx = (i + 1 < n) ? 2 : 1;
+    for (int j = 0; j < nx; ++j) {
+      uint64_t v = 0;
+      for (int k = 0; k < 8 - lz[j]; ++k)
+        v |= ((uint64_t)(*in++)) << (8 * k);
+      x[i + j] = v;
+    }
+  }
+  return in;
+}
+
+/* lossy: a residual is the difference of a rounded value and
+   its prediction, coded as a zigzag varint */
+void encodeDelta(uint64_t const* x, size_t n, std::vector<unsigned char>& out)
+{
+  for (size_t i = 0; i < n; ++i) {
+    int64_t d = (int64_t)x[i];
+    uint64_t z = ((uint64_t)d << 1) ^ (uint64_t)(d >> 63);
+    while (z >= 0x80) {
+      out.push_back((unsigned char)(z | 0x80));
+      z >>= 7;
+    }
+    out.push_back((unsigned char)z);
+  }
+}
+
+unsigned char const* decodeDelta(unsigned char const* in, size_t n,
+    uint64_t* x)
+{
+  for (size_t i = 0; i < n; ++i) {
+    uint64_t z = 0;
+    int shift = 0;
+    unsigned char b;
+    do {
+      b = *in++;
+      z |= ((uint64_t)(b & 0x7F)) << shift;
+      shift += 7;
+    } while (b & 0x80);
+    int64_t d = (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+    x[i] = (uint64_t)d;
+  }
+  return in;
+}
+
+/* the value of snapshot (n) of a block predicted from the
+   values (a) and (b) of the two snapshots before it */
+uint64_t predict(FieldHistory* h, int n, uint64_t a, uint64_t b)
+{
+  if (n == 0)
+    return 0;
+  if (n == 1)
+    return a;
+  if (h->tolerance > 0)
+    return (uint64_t)(2 * (int64_t)a - (int64_t)b);
+  return toBits(2 * fromBits(a) - fromBits(b));
+}
+
+/* the residual of a value from its prediction, and back */
+uint64_t subtract(FieldHistory* h, uint64_t v, uint64_t p)
+{
+  if (h->tolerance > 0)
+    return (uint64_t)((int64_t)v - (int64_t)p);
+  return v ^ p;
+}
+
+uint64_t add(FieldHistory* h, uint64_t r, uint64_t p)
+{
+  if (h->tolerance > 0)
+    return (uint64_t)((int64_t)r + (int64_t)p);
+  return r ^ p;
+}
+
+uint64_t quantize(FieldHistory* h, double x)
+{
+  if (!(h->tolerance > 0))
+    return toBits(x);
+  double q = x / (2 * h->tolerance);
+  if (!(std::fabs(q) < 1e18))
+    fail("apf::addSnapshot: value out of range of the tolerance\n");
+  return (uint64_t)(int64_t)std::floor(q + 0.5);
+}
+
+double restore(FieldHistory* h, uint64_t v)
+{
+  if (!(h->tolerance > 0))
+    return fromBits(v);
+  return (int64_t)v * 2 * h->tolerance;
+}
+
+/* decode snapshot (i) into (a), from the key snapshot of its block */
+void decode(FieldHistory* h, int i, std::vector<uint64_t>& a)
+{
+  int key = i - i % h->keyInterval;
+  std::vector<unsigned char> const& block = h->blocks[i / h->keyInterval];
+  a.assign(h->values, 0);
+  std::vector<uint64_t> b(h->values, 0);
+  std::vector<uint64_t> r(h->values);
+  for (int j = key; j <= i; ++j) {
+    unsigned char const* in = &block[h->offsets[j]];
+    if (h->tolerance > 0)
+      decodeDelta(in, h->values, &r[0]);
+    else
+      decodeXor(in, h->values, &r[0]);
+    for (size_t k = 0; k < h->values; ++k) {
+      uint64_t v = add(h, r[k], predict(h, j - key, a[k], b[k]));
+      b[k] = a[k];
+      a[k] = v;
+    }
+  }
+}
+
+}
+
+FieldHistory* createFieldHistory(Field* f, double tolerance, int keyInterval)
+{
+  PCU_ALWAYS_ASSERT(tolerance >= 0);
+  PCU_ALWAYS_ASSERT(keyInterval > 0);
+  FieldHistory* h = new FieldHistory();
+  h->field = f;
+  h->mesh = f->getMesh();
+  h->changes = h->mesh->countChanges();
+  h->tolerance = tolerance;
+  h->keyInterval = keyInterval;
+  std::vector<double> x;
+  h->values = walk<false>(f, x);
+  return h;
+}
+
+int addSnapshot(FieldHistory* h)
+{
+  PCU_ALWAYS_ASSERT(h->mesh->countChanges() == h->changes);
+  int i = countSnapshots(h);
+  std::vector<double> x(h->values);
+  PCU_ALWAYS_ASSERT(walk<false>(h->field, x) == h->values);
+  int n = i % h->keyInterval;
+  if (!n) {
+    /* the finished block will not grow again */
+    if (!h->blocks.empty())
+      std::vector<unsigned char>(h->blocks.back()).swap(h->blocks.back());
+    h->blocks.push_back(std::vector<unsigned char>());
+    for (int k = 0; k < 2; ++k)
+      h->last[k].assign(h->values, 0);
+  }
+  std::vector<uint64_t> r(h->values);
+  uint64_t* a = h->values ? &h->last[0][0] : 0;
+  uint64_t* b = h->values ? &h->last[1][0] : 0;
+  for (size_t k = 0; k < h->values; ++k) {
+    uint64_t v = quantize(h, x[k]);
+    r[k] = subtract(h, v, predict(h, n, a[k], b[k]));
+    b[k] = a[k];
+    a[k] = v;
+  }
+  std::vector<unsigned char>& block = h->blocks.back();
+  h->offsets.push_back(block.size());
+  if (!h->values)
+    return i;
+  if (h->tolerance > 0)
+    encodeDelta(&r[0], h->values, block);
+  else
+    encodeXor(&r[0], h->values, block);
+  return i;
+}
+
+void getSnapshot(FieldHistory* h, int i, Field* to)
+{
+  PCU_ALWAYS_ASSERT(0 <= i && i < countSnapshots(h));
+  if (!to)
+    to = h->field;
+  PCU_ALWAYS_ASSERT(to->getMesh() == h->mesh);
+  PCU_ALWAYS_ASSERT(h->mesh->countChanges() == h->changes);
+  if (!h->values)
+    return;
+  std::vector<uint64_t> v;
+  decode(h, i, v);
+  std::vector<double> x(h->values);
+  for (size_t k = 0; k < h->values; ++k)
+    x[k] = restore(h, v[k]);
+  PCU_ALWAYS_ASSERT(walk<true>(to, x) == h->values);
+}
+
+int countSnapshots(FieldHistory* h)
+{
+  return h->offsets.size();
+}
+
+size_t countSnapshotValues(FieldHistory* h)
+{
+  return h->values;
+}
+
+size_t getHistoryBytes(FieldHistory* h)
+{
+  size_t bytes = sizeof(FieldHistory)
+    + h->blocks.capacity() * sizeof(h->blocks[0])
+    + h->offsets.capacity() * sizeof(size_t);
+  for (size_t i = 0; i < h->blocks.size(); ++i)
+    bytes += h->blocks[i].capacity();
+  for (int k = 0; k < 2; ++k)
+    bytes += h->last[k].capacity() * sizeof(uint64_t);
+  return bytes;
+}
+
+void destroyFieldHistory(FieldHistory* h)
+{
+  delete h;
+}
+
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2011 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef APF_FIELD_HISTORY_H
+#define APF_FIELD_HISTORY_H
+
+/** \file apfFieldHistory.h
+  \brief compressed time series of the values of a field */
+
+#include <cstddef>
+
+namespace apf {
+
+class Field;
+
+/** \brief snapshots of one field, compressed in memory */
+class FieldHistory;
+
+/** \brief make an empty history of the values of (f)
+  \details each snapshot is coded as its difference from the one
+  before it, which costs little for fields that change little
+  between steps. Every (keyInterval)'th snapshot is coded on its
+  own, so restoring one decodes at most that many.
+  \param tolerance zero to keep the values exactly, which codes the
+         bits that changed since the previous snapshot. Otherwise
+         each value is rounded to a multiple of twice the tolerance,
+         so restored values are within (tolerance) of the originals
+         and the differences are small integers.
+  \param keyInterval snapshots per independently coded one */
+FieldHistory* createFieldHistory(Field* f, double tolerance = 0,
+    int keyInterval = 16);
+
+/** \brief store the current values of the field
+  \details the mesh must have the structure the history was made at.
+  \returns the index of the snapshot, counting from zero */
+int addSnapshot(FieldHistory* h);
+
+/** \brief restore snapshot (i) into a field
+  \details (to) may be the field of the history or another field of
+  the same shape and number of components on the same mesh. This
+  decodes the snapshots from the last independently coded one to (i).
+  \param to the field to write, or zero for the field of the history */
+void getSnapshot(FieldHistory* h, int i, Field* to = 0);
+
+/** \brief the number of snapshots stored */
+int countSnapshots(FieldHistory* h);
+
+/** \brief the number of values in a snapshot */
+size_t countSnapshotValues(FieldHistory* h);
+
+/** \brief bytes of memory the history holds, including
+  the last two snapshots it keeps uncompressed for coding */
+size_t getHistoryBytes(FieldHistory* h);
+
+/** \brief destroy a history made by apf::createFieldHistory */
+void destroyFieldHistory(FieldHistory* h);
+
+}
+
+#endif
@@ -13,8 +13,10 @@
 #include <pcu_io.h>
 #include "apfFile.h"
 #include "apf.h"
+#include "apfField.h"
 #include "apfShape.h"
 #include "apfTagData.h"
+#include "apfArrayData.h"
 #include "apfNumbering.h"
 
 namespace apf {
@@ -47,9 +49,11 @@ static void save_field_meta(pcu_file* file, apf::Field* field) {
   save_int(file, getValueType(field));
   save_int(file, countComponents(field));
   save_string(file, getShape(field)->getName());
+  save_int(file, getTagStorage(field->getData()));
 }
 
-static void restore_field_meta(pcu_file* file, apf::Mesh* mesh) {
+static void restore_field_meta(pcu_file* file, apf::Mesh* mesh,
+    int version) {
   std::string field_name = restore_string(file);
   int value_type = restore_int(file);
   int ncomps = restore_int(file);
@@ -57,8 +61,11 @@ static void restore_field_meta(pcu_file* file, apf::Mesh* mesh) {
   apf::FieldShape* shape = getShapeByName(shape_name.c_str());
   if (shape == 0)
     reel_fail("field shape \"%s\" could not be found\n", shape_name.c_str());
+  int storage = DOUBLE_TAGS;
+  if (version >= 4)
+    storage = restore_int(file);
   makeField(mesh, field_name.c_str(), value_type, ncomps,
-      shape, new TagDataOf<double>);
+      shape, makeTagStorage(storage));
 }
 
 static void save_numbering_meta(pcu_file* file, apf::Numbering* numbering) {
@@ -77,7 +84,7 @@ static void restore_numbering_meta(pcu_file* file, apf::Mesh* mesh) {
   createNumbering(mesh, numbering_name.c_str(), shape, ncomps);
 }
 
-static int latest_version_number = 3;
+static int latest_version_number = 4;
 
 void save_meta(pcu_file* file, apf::Mesh* mesh) {
   save_string(file, mesh->getShape()->getName());
@@ -118,7 +125,7 @@ void restore_meta(pcu_file* file, apf::Mesh* mesh) {
   PCU_ALWAYS_ASSERT(nfields >= 0);
   PCU_ALWAYS_ASSERT(nfields < 256);
   for (int i = 0; i < nfields; ++i) {
-    restore_field_meta(file, mesh);
+    restore_field_meta(file, mesh, version);
   }
   if (version >= 3) {
     int nnumberings = restore_int(file);
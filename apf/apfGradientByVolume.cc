@@ -61,9 +61,17 @@ class GradientIntegrator : public Integrator
       volumeSum = 0;
       e = 0;
     }
+    ~GradientIntegrator()
+    {
+      if (e)
+        destroyElement(e);
+    }
     virtual void inElement(MeshElement* me)
     {
-      e = createElement(f,me);
+      if (e)
+        rebindElement(e,me);
+      else
+        e = createElement(f,me);
     }
     virtual void atPoint(Vector3 const& p, double w, double dV)
     {
@@ -79,7 +87,6 @@ class GradientIntegrator : public Integrator
     }
     virtual void outElement()
     {
-      destroyElement(e);
     }
     GT getResult() {return gradSum / volumeSum;}
   private:
@@ -126,6 +133,12 @@ class RecoverGradient : public CavityOp
       f = f_in;
       gradf = gradf_in;
       vert = 0;
+      me = 0;
+    }
+    ~RecoverGradient()
+    {
+      if (me)
+        destroyMeshElement(me);
     }
     virtual Outcome setEntity(MeshEntity* v)
     {
@@ -144,9 +157,11 @@ class RecoverGradient : public CavityOp
       for (size_t i=0; i < elements.getSize(); ++i)
       {
         MeshEntity* e = elements[i];
-        MeshElement* me = createMeshElement(mesh,e);
+        if (me)
+          rebindMeshElement(me,e);
+        else
+          me = createMeshElement(mesh,e);
         integrator.process(me);
-        destroyMeshElement(me);
       }
       GT grad = integrator.getResult();
       setValue(gradf,vert,grad);
@@ -154,6 +169,7 @@ class RecoverGradient : public CavityOp
   private:
     Mesh* mesh;
     MeshEntity* vert;
+    MeshElement* me;
     Field* f;
     Field* gradf;
     SetValue<GT> setValue;
@@ -285,6 +285,7 @@ class Hierarchic2 : public FieldShape {
         return 0;
     }
     int getOrder() {return 2;}
+    bool isElementInvariant(int) {return true;}
 };
 
 class Hierarchic3 : public FieldShape
@@ -331,6 +332,8 @@ class Hierarchic3 : public FieldShape
         return 0;
     }
     int getOrder() {return 3;}
+    /* the triangle functions follow the edge orientations */
+    bool isElementInvariant(int type) {return type != Mesh::TRIANGLE;}
 };
 
 FieldShape* getHierarchic(int o)
@@ -8,6 +8,12 @@
 #include "apfIntegrate.h"
 #include "apfMesh.h"
 #include "apf.h"
+#include "apfShape.h"
+#include "apfVectorElement.h"
+#include <pthread.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 namespace apf {
 
@@ -618,6 +624,61 @@ EntityIntegration const* getIntegration(int meshEntityType)
   return integrations[meshEntityType];
 }
 
+static bool lessPoint(Vector3 const& a, Vector3 const& b)
+{
+  for (int i = 0; i < 3; ++i)
+    if (a[i] != b[i])
+      return a[i] < b[i];
+  return false;
+}
+
+/* the distinct integration points of each type, built for all
+   types at once so that threads can share them */
+static std::vector<Vector3> points[Mesh::TYPES];
+static pthread_once_t pointsOnce = PTHREAD_ONCE_INIT;
+
+static void buildPoints()
+{
+  for (int type = 0; type < Mesh::TYPES; ++type) {
+    std::vector<Vector3>& p = points[type];
+    EntityIntegration const* ei = getIntegration(type);
+    if (ei)
+      for (int i = 0; i < ei->countIntegrations(); ++i) {
+        Integration const* in = ei->getIntegration(i);
+        for (int j = 0; j < in->countPoints(); ++j)
+          p.push_back(in->getPoint(j)->param);
+      }
+    std::sort(p.begin(), p.end(), lessPoint);
+    std::vector<Vector3> unique;
+    for (size_t i = 0; i < p.size(); ++i)
+      if (unique.empty() || lessPoint(unique.back(), p[i]))
+        unique.push_back(p[i]);
+    p.swap(unique);
+  }
+}
+
+static std::vector<Vector3> const& getPoints(int type)
+{
+  pthread_once(&pointsOnce, buildPoints);
+  return points[type];
+}
+
+int countIntegrationPoints(int meshEntityType)
+{
+  return getPoints(meshEntityType).size();
+}
+
+int findIntegrationPoint(int meshEntityType, Vector3 const& xi)
+{
+  std::vector<Vector3> const& p = getPoints(meshEntityType);
+  std::vector<Vector3>::const_iterator it =
+    std::lower_bound(p.begin(), p.end(), xi, lessPoint);
+  if (it == p.end() || lessPoint(xi, *it))
+    return -1;
+  return it - p.begin();
+}
+
+
 Integrator::Integrator(int o):
   order(o),
   ipnode(0)
@@ -656,17 +717,26 @@ void Integrator::process(Mesh* m)
   this->parallelReduce();
 }
 
+/* straight-sided simplices have a constant Jacobian */
+static bool isAffine(MeshElement* e)
+{
+  return getOrder(e) == 1 && isSimplex(e->getType());
+}
+
 void Integrator::process(MeshElement* e)
 {
   this->inElement(e);
   int np = countIntPoints(e,this->order);
+  bool affine = isAffine(e);
+  double dV = 0;
   for (int p=0; p < np; ++p)
   {
     ipnode = p;
     Vector3 point;
     getIntPoint(e,this->order,p,point);
     double w = getIntWeight(e,this->order,p);
-    double dV = getDV(e,point);
+    if (p == 0 || ! affine)
+      dV = getDV(e,point);
     this->atPoint(point,w,dV);
   }
   this->outElement();
@@ -690,12 +760,124 @@ double measure(MeshElement* e)
   return measurer.m;
 }
 
+static bool hasLinearCoordinates(Mesh* m)
+{
+  return m->getShape()->getOrder() == 1;
+}
+
 double measure(Mesh* m, MeshEntity* e)
 {
+  int type = m->getType(e);
+  if (hasLinearCoordinates(m) &&
+      (type == Mesh::EDGE || type == Mesh::TRIANGLE || type == Mesh::TET)) {
+    double v;
+    measureSimplices(m, 1, &e, &v);
+    return v;
+  }
   MeshElement* me = createMeshElement(m,e);
   double v = measure(me);
   destroyMeshElement(me);
   return v;
 }
 
+/* coordinates of a block of simplices, ordered
+   [vertex][axis][element] so the loops below
+   run over contiguous elements */
+enum { SIMPLEX_BLOCK = 64 };
+
+struct SimplexBlock
+{
+  double x[4][3][SIMPLEX_BLOCK];
+};
+
+static void gatherBlock(Mesh* m, MeshEntity* const* e, int n, int nv,
+    SimplexBlock& b)
+{
+  for (int i = 0; i < n; ++i) {
+    MeshEntity* v[4];
+    m->getDownward(e[i], 0, v);
+    for (int j = 0; j < nv; ++j) {
+      Vector3 p;
+      m->getPoint(v[j], 0, p);
+      for (int k = 0; k < 3; ++k)
+        b.x[j][k][i] = p[k];
+    }
+  }
+}
+
+static void measureEdges(SimplexBlock& b, int n, double* out)
+{
+  for (int i = 0; i < n; ++i) {
+    double dx = b.x[1][0][i] - b.x[0][0][i];
+    double dy = b.x[1][1][i] - b.x[0][1][i];
+    double dz = b.x[1][2][i] - b.x[0][2][i];
+    out[i] = std::sqrt(dx * dx + dy * dy + dz * dz);
+  }
+}
+
+static void measureTriangles(SimplexBlock& b, int n, double* out)
+{
+  for (int i = 0; i < n; ++i) {
+    double ax = b.x[1][0][i] - b.x[0][0][i];
+    double ay = b.x[1][1][i] - b.x[0][1][i];
+    double az = b.x[1][2][i] - b.x[0][2][i];
+    double bx = b.x[2][0][i] - b.x[0][0][i];
+    double by = b.x[2][1][i] - b.x[0][1][i];
+    double bz = b.x[2][2][i] - b.x[0][2][i];
+    double cx = ay * bz - az * by;
+    double cy = az * bx - ax * bz;
+    double cz = ax * by - ay * bx;
+    out[i] = 0.5 * std::sqrt(cx * cx + cy * cy + cz * cz);
+  }
+}
+
+static void measureTets(SimplexBlock& b, int n, double* out)
+{
+  for (int i = 0; i < n; ++i) {
+    double ax = b.x[1][0][i] - b.x[0][0][i];
+    double ay = b.x[1][1][i] - b.x[0][1][i];
+    double az = b.x[1][2][i] - b.x[0][2][i];
+    double bx = b.x[2][0][i] - b.x[0][0][i];
+    double by = b.x[2][1][i] - b.x[0][1][i];
+    double bz = b.x[2][2][i] - b.x[0][2][i];
+    double cx = b.x[3][0][i] - b.x[0][0][i];
+    double cy = b.x[3][1][i] - b.x[0][1][i];
+    double cz = b.x[3][2][i] - b.x[0][2][i];
+    out[i] = (ax * (by * cz - bz * cy)
+            - ay * (bx * cz - bz * cx)
+            + az * (bx * cy - by * cx)) / 6.0;
+  }
+}
+
+void measureSimplices(Mesh* m, int n, MeshEntity* const* e, double* out)
+{
+  if (!n)
+    return;
+  int type = m->getType(e[0]);
+  bool fast = hasLinearCoordinates(m) &&
+    (type == Mesh::EDGE || type == Mesh::TRIANGLE || type == Mesh::TET);
+  for (int i = 1; fast && i < n; ++i)
+    fast = (m->getType(e[i]) == type);
+  if (!fast) {
+    for (int i = 0; i < n; ++i) {
+      MeshElement* me = createMeshElement(m, e[i]);
+      out[i] = measure(me);
+      destroyMeshElement(me);
+    }
+    return;
+  }
+  SimplexBlock b;
+  int nv = Mesh::adjacentCount[type][0];
+  for (int i = 0; i < n; i += SIMPLEX_BLOCK) {
+    int bn = std::min(n - i, (int)SIMPLEX_BLOCK);
+    gatherBlock(m, e + i, bn, nv, b);
+    if (type == Mesh::EDGE)
+      measureEdges(b, bn, out + i);
+    else if (type == Mesh::TRIANGLE)
+      measureTriangles(b, bn, out + i);
+    else
+      measureTets(b, bn, out + i);
+  }
+}
+
 }//namespace apf
@@ -41,6 +41,12 @@ class EntityIntegration
 
 EntityIntegration const* getIntegration(int meshEntityType);
 
+/* the distinct integration points of an entity type over all
+   accuracies, numbered so that tables can be kept per point */
+int countIntegrationPoints(int meshEntityType);
+/* returns -1 if (xi) is not one of them */
+int findIntegrationPoint(int meshEntityType, Vector3 const& xi);
+
 }//namespace apf
 
 #endif
@@ -1,253 +1,446 @@
-#include <time.h>
-#include <cstdlib>
+#include <PCU.h>
 #include "apfMIS.h"
 #include "apf.h"
-#include <stdio.h>
-namespace apf {    
-  MIS::MIS(Mesh* mesh, int vtx_dim_, int edge_dim_)
-    : m(mesh), vtx_dim(vtx_dim_), edge_dim(edge_dim_),
-      ents(NULL), n(0),color(0) {
-    srand(time(NULL));
-  }
-  MIS* initializeMIS(Mesh* mesh, int vtx_dim, int edge_dim) {
-    MeshTag* coloring = mesh->findTag("coloring");
-    if (coloring!=NULL) {
-      printf("[ERROR] Only one MIS can exist at a time.\n");
-      return NULL;
-    }
-    MIS* mis = new MIS(mesh,vtx_dim,edge_dim);
-    coloring = mesh->createIntTag("coloring",1);
-    MeshIterator* vitr = mesh->begin(vtx_dim);
-    MeshEntity* ent;
-    int uncolored = -2;
-    while ((ent = mesh->iterate(vitr))) {
-      mesh->setIntTag(ent,coloring,&uncolored);
-    }
-    mesh->end(vitr);
-    mesh->createIntTag("degrees",1);
-    return mis;
-  }
-  void finalizeMIS(MIS* mis) {
-    MeshTag* coloring = mis->m->findTag("coloring");
-    MeshTag* degrees = mis->m->findTag("degrees");
-    mis->m->destroyTag(coloring);
-    mis->m->destroyTag(degrees);
-    if (mis->ents) {
-      delete [] mis->ents;
-      mis->ents = NULL;
-    }
-    delete mis;
-  }
-  double getRandomNumber()
-  {
-    return (double)rand() / (double)RAND_MAX ;
-  }
-  void prepareForMIS(Mesh* m, MeshTag* coloring, int vtx_dim,
-                     int uncolored,int neighbor);
-  void selectVertices(Mesh* m, MeshTag* coloring, MeshTag* degrees,
-                      int vtx_dim, int edge_dim, int temp_color, int neighbor);
-  void trimColoring(Mesh* m,MeshTag* coloring, MeshTag* degrees,
-                    int vtx_dim, int edge_dim, int uncolored,
-                    int temp_color, int neighbor);
-  int setColor(Mesh* m, MeshTag* coloring, int vtx_dim,
-               int edge_dim, int temp_color, int neighbor, int color);
-  void constructMIS(Mesh* m, MeshTag* coloring, int vtx_dim, int color,
-                    MeshEntity** ents);
-  bool getIndependentSet(MIS* mis) {
-    Mesh* m = mis->m;
-    int vtx_dim = mis->vtx_dim;
-    int edge_dim = mis->edge_dim;
-    int n=1;
-    int uncolored = -2;
-    int temp_color = -1;
-    int neighbor = 0;
-    mis->color++;
-    MeshTag* coloring = m->findTag("coloring");
-    MeshTag* degrees = m->findTag("degrees");
-    if (mis->ents) {
-      //Cleanup previous MIS if one exists
-      delete [] mis->ents;
-      mis->ents = NULL;
-    }
-    
-    prepareForMIS(m,coloring,vtx_dim,uncolored,neighbor);
-    
-    mis->n=0;    
-    while (n>0) {
-      //Choose the vertices to try to color
-      selectVertices(m, coloring, degrees, vtx_dim,
-                     edge_dim, temp_color, neighbor);
+#include <algorithm>
+#include <map>
+namespace apf {
+
+  namespace {
 
-      //Remove vertices that are adjacent with the new color
-      trimColoring(m, coloring, degrees, vtx_dim, edge_dim,
-                   uncolored, temp_color, neighbor);
-      
-      //Finalize vertices to be colored and set neighbors
-      n = setColor(m, coloring, vtx_dim, edge_dim,
-                   temp_color, neighbor, mis->color);
-      mis->n+=n;
+    enum { UNDECIDED, IN, OUT, DONE };
+
+    //a murmur3 style mix of the seed and the global id
+    unsigned hashId(unsigned seed, int rank, int id)
+    {
+      unsigned h = seed * 2654435761u;
+      h ^= (unsigned)rank + 0x9e3779b9u + (h << 6) + (h >> 2);
+      h ^= (unsigned)id + 0x9e3779b9u + (h << 6) + (h >> 2);
+      h ^= h >> 16;
+      h *= 0x85ebca6bu;
+      h ^= h >> 13;
+      h *= 0xc2b2ae35u;
+      h ^= h >> 16;
+      return h;
     }
 
-    if (mis->n==0)
-      return false;    
+    class Luby {
+    public:
+      Luby(MisGraph const& graph, unsigned seed):
+        g(graph),
+        self(PCU_Comm_Self())
+      {
+        int total = g.owned + (int)g.ghostOwners.size();
+        priority.resize(total);
+        for (int v = 0; v < total; ++v)
+          priority[v] = hashId(seed, getRank(v), getId(v));
+        state.assign(total, UNDECIDED);
+        order.resize(g.owned);
+        for (int v = 0; v < g.owned; ++v)
+          order[v] = v;
+        std::sort(order.begin(), order.end(), Above(this));
+        findSharers();
+      }
+      //keeps an owned vertex out of the set found by the next run
+      void exclude(int v)
+      {
+        state[v] = OUT;
+        if (shareOffsets[v + 1] > shareOffsets[v])
+          excluded.push_back(v);
+      }
+      //one maximal independent set of the undecided vertices
+      void run()
+      {
+        pending.clear();
+        for (size_t i = 0; i < order.size(); ++i)
+          if (state[order[i]] == UNDECIDED)
+            pending.push_back(order[i]);
+        std::vector<int> changed;
+        changed.swap(excluded);
+        while (true) {
+          int left = sweep(changed);
+          exchange(changed);
+          changed.clear();
+          if ( ! PCU_Or(left > 0))
+            break;
+        }
+      }
+      //removes the set found by run and frees its neighbors
+      void next()
+      {
+        for (size_t v = 0; v < state.size(); ++v)
+          if (state[v] == IN)
+            state[v] = DONE;
+          else if (state[v] == OUT)
+            state[v] = UNDECIDED;
+      }
+      bool anyLeft()
+      {
+        int left = 0;
+        for (int v = 0; v < g.owned; ++v)
+          if (state[v] != DONE)
+            left = 1;
+        return PCU_Or(left);
+      }
+      MisGraph const& g;
+      int self;
+      std::vector<unsigned> priority;
+      std::vector<char> state;
+    private:
+      struct Above {
+        Above(Luby* l):luby(l) {}
+        bool operator()(int a, int b) const {return luby->above(a, b);}
+        Luby* luby;
+      };
+      int getRank(int v) const
+      {
+        return v < g.owned ? self : g.ghostOwners[v - g.owned];
+      }
+      int getId(int v) const
+      {
+        return v < g.owned ? v : g.ghostIds[v - g.owned];
+      }
+      bool above(int a, int b) const
+      {
+        if (priority[a] != priority[b])
+          return priority[a] > priority[b];
+        if (getRank(a) != getRank(b))
+          return getRank(a) > getRank(b);
+        return getId(a) > getId(b);
+      }
+      //the ranks ghosting each owned vertex and its ghost index there
+      void findSharers()
+      {
+        PCU_Comm_Begin();
+        for (size_t i = 0; i < g.ghostOwners.size(); ++i) {
+          int gi = i;
+          PCU_COMM_PACK(g.ghostOwners[i], g.ghostIds[i]);
+          PCU_COMM_PACK(g.ghostOwners[i], gi);
+        }
+        PCU_Comm_Send();
+        std::vector<int> vs, peers, ids;
+        while (PCU_Comm_Receive()) {
+          int v, gi;
+          PCU_COMM_UNPACK(v);
+          PCU_COMM_UNPACK(gi);
+          vs.push_back(v);
+          peers.push_back(PCU_Comm_Sender());
+          ids.push_back(gi);
+        }
+        shareOffsets.assign(g.owned + 1, 0);
+        for (size_t i = 0; i < vs.size(); ++i)
+          ++shareOffsets[vs[i] + 1];
+        for (int v = 0; v < g.owned; ++v)
+          shareOffsets[v + 1] += shareOffsets[v];
+        std::vector<int> at(shareOffsets.begin(), shareOffsets.end() - 1);
+        sharePeers.resize(vs.size());
+        shareIds.resize(vs.size());
+        for (size_t i = 0; i < vs.size(); ++i) {
+          int s = at[vs[i]]++;
+          sharePeers[s] = peers[i];
+          shareIds[s] = ids[i];
+        }
+      }
+      //decides the pending vertices in priority order, so that all
+      //  local higher neighbors are decided before a vertex is seen.
+      //  the shared vertices decided are added to changed and the
+      //  number left undecided is returned
+      int sweep(std::vector<int>& changed)
+      {
+        size_t left = 0;
+        for (size_t i = 0; i < pending.size(); ++i) {
+          int v = pending[i];
+          bool top = true;
+          bool out = false;
+          for (int j = g.offsets[v]; j < g.offsets[v + 1]; ++j) {
+            int u = g.adjacent[j];
+            if (state[u] == IN) {
+              out = true;
+              break;
+            }
+            if (state[u] == UNDECIDED && above(u, v))
+              top = false;
+          }
+          if (out)
+            state[v] = OUT;
+          else if (top)
+            state[v] = IN;
+          else {
+            pending[left++] = v;
+            continue;
+          }
+          if (shareOffsets[v + 1] > shareOffsets[v])
+            changed.push_back(v);
+        }
+        pending.resize(left);
+        return left;
+      }
+      void exchange(std::vector<int> const& changed)
+      {
+        PCU_Comm_Begin();
+        for (size_t i = 0; i < changed.size(); ++i) {
+          int v = changed[i];
+          for (int s = shareOffsets[v]; s < shareOffsets[v + 1]; ++s) {
+            PCU_COMM_PACK(sharePeers[s], shareIds[s]);
+            PCU_COMM_PACK(sharePeers[s], state[v]);
+          }
+        }
+        PCU_Comm_Send();
+        while (PCU_Comm_Receive()) {
+          int gi;
+          char s;
+          PCU_COMM_UNPACK(gi);
+          PCU_COMM_UNPACK(s);
+          state[g.owned + gi] = s;
+        }
+      }
+      std::vector<int> order;
+      std::vector<int> pending;
+      std::vector<int> excluded;
+      std::vector<int> shareOffsets;
+      std::vector<int> sharePeers;
+      std::vector<int> shareIds;
+    };
+
+    typedef std::pair<int,int> Gid;
 
-    mis->ents = new MeshEntity*[mis->n];
+  }
 
-    constructMIS(m, coloring, vtx_dim, mis->color, mis->ents);
-    return true;
+  void findIndependentSet(MisGraph const& g, unsigned seed,
+                          std::vector<bool>& isIn,
+                          std::vector<bool> const& candidates) {
+    Luby luby(g, seed);
+    if ( ! candidates.empty())
+      for (int v = 0; v < g.owned; ++v)
+        if ( ! candidates[v])
+          luby.exclude(v);
+    luby.run();
+    isIn.resize(g.owned);
+    for (int v = 0; v < g.owned; ++v)
+      isIn[v] = (luby.state[v] == IN);
   }
 
-  void prepareForMIS(Mesh* m, MeshTag* coloring, int vtx_dim, int uncolored,
-                     int neighbor) {
-    MeshIterator* vitr = m->begin(vtx_dim);
-    MeshEntity* ent;
-    while ((ent = m->iterate(vitr))) {
-      int tag;
-      m->getIntTag(ent,coloring,&tag);
-      if (tag<=neighbor)
-        m->setIntTag(ent,coloring,&uncolored);
+  int colorGraph(MisGraph const& g, unsigned seed,
+                 std::vector<int>& colors) {
+    Luby luby(g, seed);
+    colors.assign(g.owned, -1);
+    int color = 0;
+    while (luby.anyLeft()) {
+      luby.run();
+      for (int v = 0; v < g.owned; ++v)
+        if (luby.state[v] == IN)
+          colors[v] = color;
+      luby.next();
+      ++color;
     }
-    m->end(vitr);
+    return color;
   }
-  void selectVertices(Mesh* m, MeshTag* coloring, MeshTag* degrees,
-                      int vtx_dim, int edge_dim, int temp_color, int neighbor) {
-    //Thread Parallize This:
-    //Choose random set of vertices (temporarily color them to temp_color)
-    MeshIterator* vitr = m->begin(vtx_dim);
-    MeshEntity* ent;
-    while ((ent = m->iterate(vitr))) {
-      int tag;
-      m->getIntTag(ent,coloring,&tag);
-      if (tag>=neighbor)
+
+  void buildMisGraph(Mesh* m, int vtx_dim, int edge_dim,
+                     MisGraph& g, std::vector<MeshEntity*>& ents) {
+    int self = PCU_Comm_Self();
+    MeshTag* gids = m->createIntTag("apf_mis_gid", 2);
+    ents.clear();
+    MeshIterator* it = m->begin(vtx_dim);
+    MeshEntity* e;
+    while ((e = m->iterate(it)))
+      if (m->isOwned(e)) {
+        int gid[2] = {self, (int)ents.size()};
+        m->setIntTag(e, gids, gid);
+        ents.push_back(e);
+      }
+    m->end(it);
+    //copies learn the id given by their owner
+    PCU_Comm_Begin();
+    for (size_t i = 0; i < ents.size(); ++i) {
+      if ( ! m->isShared(ents[i]))
         continue;
-      //use set to uniquely retrieve neighbors
-      std::set<MeshEntity*> neighbors;
-      //get edge_dim adjacent of ent-> edge_adj
-      Adjacent edge_adj;
-      m->getAdjacent(ent,edge_dim,edge_adj);
-      APF_ITERATE(Adjacent,edge_adj,edge_itr) {
-        //get vtx_dim adjacent of edge_adj -> vtx_adj
-        Adjacent vtx_adj;
-        m->getAdjacent(*edge_itr,vtx_dim,vtx_adj);
-        APF_ITERATE(Adjacent,vtx_adj,vtx_itr) {
-          //count unique number of vtx_adj that are not colored -> count
-          MeshEntity* vtx = *vtx_itr;
-          if (vtx == ent)
-            continue;
-          int tag;
-          m->getIntTag(vtx, coloring, &tag);
-          if (tag>temp_color)
+      int id = i;
+      Copies remotes;
+      m->getRemotes(ents[i], remotes);
+      APF_ITERATE(Copies, remotes, rit) {
+        PCU_COMM_PACK(rit->first, rit->second);
+        PCU_COMM_PACK(rit->first, id);
+      }
+    }
+    PCU_Comm_Send();
+    while (PCU_Comm_Receive()) {
+      int gid[2];
+      gid[0] = PCU_Comm_Sender();
+      PCU_COMM_UNPACK(e);
+      PCU_COMM_UNPACK(gid[1]);
+      m->setIntTag(e, gids, gid);
+    }
+    //every copy finds the neighbors it sees, which go to the owner
+    std::vector<std::vector<Gid> > neighbors(ents.size());
+    std::vector<Gid> found;
+    PCU_Comm_Begin();
+    it = m->begin(vtx_dim);
+    while ((e = m->iterate(it))) {
+      found.clear();
+      Adjacent edges;
+      m->getAdjacent(e, edge_dim, edges);
+      for (size_t i = 0; i < edges.getSize(); ++i) {
+        Adjacent verts;
+        m->getAdjacent(edges[i], vtx_dim, verts);
+        for (size_t j = 0; j < verts.getSize(); ++j) {
+          if (verts[j] == e)
             continue;
-          neighbors.insert(vtx);
+          int gid[2];
+          m->getIntTag(verts[j], gids, gid);
+          found.push_back(Gid(gid[0], gid[1]));
         }
       }
-      int count = neighbors.size();
-      m->setIntTag(ent,degrees,&count);
-      //set degree tag of this entity to be count
-      if (count <= 1) {
-        m->setIntTag(ent,coloring,&temp_color);
-      }
-      else {
-        //Get random number in [0,1]
-        double rand = getRandomNumber();
-        if (rand > 1.0 / count) {
-          m->setIntTag(ent, coloring, &temp_color);
-        }
+      int gid[2];
+      m->getIntTag(e, gids, gid);
+      if (gid[0] == self) {
+        std::vector<Gid>& to = neighbors[gid[1]];
+        to.insert(to.end(), found.begin(), found.end());
+        continue;
       }
+      size_t n = found.size();
+      PCU_COMM_PACK(gid[0], gid[1]);
+      PCU_COMM_PACK(gid[0], n);
+      if (n)
+        PCU_Comm_Pack(gid[0], &found[0], n * sizeof(Gid));
     }
-    m->end(vitr);
-  }
-
-  void trimColoring(Mesh* m,MeshTag* coloring, MeshTag* degrees,
-                    int vtx_dim, int edge_dim, int uncolored,
-                    int temp_color, int neighbor) {
-    //Thread Parallize this:
-    MeshIterator* eitr = m->begin(edge_dim);
-    MeshEntity* ent;
-    while ((ent = m->iterate(eitr))) {
-      //Get vtx_dim adjacent of ent -> vtx_adj
-      Adjacent vtx_adj;
-      m->getAdjacent(ent,vtx_dim,vtx_adj);
-      //Find vtx of max degree colored with temp_color
-      int max_deg = -1;
-      int max_index = -1;
-      for (unsigned int i = 0;i < vtx_adj.size(); i++) {
-        MeshEntity* vtx = vtx_adj[i];
-        int color;
-        m->getIntTag(vtx, coloring, &color);
-        if (color != temp_color)
+    m->end(it);
+    PCU_Comm_Send();
+    while (PCU_Comm_Receive()) {
+      int id;
+      size_t n;
+      PCU_COMM_UNPACK(id);
+      PCU_COMM_UNPACK(n);
+      std::vector<Gid>& to = neighbors[id];
+      size_t old = to.size();
+      to.resize(old + n);
+      if (n)
+        PCU_Comm_Unpack(&to[old], n * sizeof(Gid));
+    }
+    removeTagFromDimension(m, gids, vtx_dim);
+    m->destroyTag(gids);
+    //compress, giving each remote neighbor one ghost
+    std::map<Gid, int> ghosts;
+    g.owned = ents.size();
+    g.offsets.assign(1, 0);
+    g.adjacent.clear();
+    g.ghostOwners.clear();
+    g.ghostIds.clear();
+    for (size_t i = 0; i < ents.size(); ++i) {
+      std::vector<Gid>& nv = neighbors[i];
+      std::sort(nv.begin(), nv.end());
+      nv.erase(std::unique(nv.begin(), nv.end()), nv.end());
+      for (size_t j = 0; j < nv.size(); ++j) {
+        if (nv[j].first == self) {
+          g.adjacent.push_back(nv[j].second);
           continue;
-        int deg;
-        m->getIntTag(vtx,degrees,&deg);
-        if (deg > max_deg) {
-          max_deg = deg;
-          max_index = i;
         }
+        std::map<Gid, int>::iterator git = ghosts.find(nv[j]);
+        if (git == ghosts.end()) {
+          git = ghosts.insert(
+              std::make_pair(nv[j], (int)g.ghostOwners.size())).first;
+          g.ghostOwners.push_back(nv[j].first);
+          g.ghostIds.push_back(nv[j].second);
+        }
+        g.adjacent.push_back(g.owned + git->second);
       }
-      if (max_index==-1)
-        continue;
-      //Set colors of all other vtxs to be a neighbor(0)
-      for (unsigned int i = 0; i < vtx_adj.size(); i++) {
-        if (i==(unsigned int)max_index)
-          continue;
-        MeshEntity* vtx = vtx_adj[i];
-        int color;
-        m->getIntTag(vtx, coloring, &color);
-        if (color >= neighbor)
-          continue;
-        m->setIntTag(vtx,coloring,&uncolored);
+      g.offsets.push_back(g.adjacent.size());
+    }
+  }
+
+  void buildPartMisGraph(Parts const& peers, MisGraph& g) {
+    int self = PCU_Comm_Self();
+    Parts all;
+    PCU_Comm_Begin();
+    APF_ITERATE(Parts, peers, pit)
+      if (*pit != self) {
+        all.insert(*pit);
+        PCU_COMM_PACK(*pit, self);
       }
+    PCU_Comm_Send();
+    while (PCU_Comm_Receive()) {
+      int peer;
+      PCU_COMM_UNPACK(peer);
+      all.insert(peer);
     }
-    m->end(eitr);
+    g.owned = 1;
+    g.offsets.assign(1, 0);
+    g.adjacent.clear();
+    g.ghostOwners.assign(all.begin(), all.end());
+    g.ghostIds.assign(all.size(), 0);
+    for (size_t i = 0; i < all.size(); ++i)
+      g.adjacent.push_back(1 + i);
+    g.offsets.push_back(g.adjacent.size());
+  }
+
+  MIS::MIS(Mesh* mesh, int vtx_dim_, int edge_dim_)
+    : m(mesh), vtx_dim(vtx_dim_), edge_dim(edge_dim_),
+      ents(NULL), n(0),color(0) {
   }
-  int setColor(Mesh* m, MeshTag* coloring, int vtx_dim,
-               int edge_dim, int temp_color, int neighbor, int color) {
-    int n=0;
-    //Set all temp_color to color and neighbors of temp_color to neighbor
-    MeshIterator* vitr = m->begin(vtx_dim);
-    MeshEntity* ent;
-    while ((ent = m->iterate(vitr))) {
-      int tag;
-      m->getIntTag(ent,coloring,&tag);
-      if (tag!=temp_color)
+  MIS* initializeMIS(Mesh* mesh, int vtx_dim, int edge_dim) {
+    MIS* mis = new MIS(mesh,vtx_dim,edge_dim);
+    MisGraph g;
+    std::vector<MeshEntity*> owned;
+    buildMisGraph(mesh, vtx_dim, edge_dim, g, owned);
+    std::vector<int> colors;
+    int ncolors = colorGraph(g, 0, colors);
+    //copies take the color of their owner
+    MeshTag* coloring = mesh->createIntTag("apf_mis_color",1);
+    PCU_Comm_Begin();
+    for (size_t i = 0; i < owned.size(); ++i) {
+      mesh->setIntTag(owned[i], coloring, &colors[i]);
+      if ( ! mesh->isShared(owned[i]))
         continue;
-      m->setIntTag(ent,coloring,&color);
-      n++;
-      //get edge_dim adjacent of ent-> edge_adj
-      Adjacent edge_adj;
-      m->getAdjacent(ent,edge_dim,edge_adj);
-      APF_ITERATE(Adjacent,edge_adj,edge_itr) {
-        //get vtx_dim adjacent of edge_adj -> vtx_adj
-        Adjacent vtx_adj;
-        m->getAdjacent(*edge_itr,vtx_dim,vtx_adj);
-        APF_ITERATE(Adjacent,vtx_adj,vtx_itr) {
-          MeshEntity* vtx = *vtx_itr;
-          if (vtx == ent)
-            continue;
-          int tag;
-          m->getIntTag(vtx, coloring, &tag);
-          if (tag>temp_color)
-            continue;
-          m->setIntTag(vtx,coloring,&neighbor);
-        }
+      Copies remotes;
+      mesh->getRemotes(owned[i], remotes);
+      APF_ITERATE(Copies, remotes, rit) {
+        PCU_COMM_PACK(rit->first, rit->second);
+        PCU_COMM_PACK(rit->first, colors[i]);
       }
     }
-    m->end(vitr);
-    return n;
-  }
-  void constructMIS(Mesh* m, MeshTag* coloring, int vtx_dim, int color,
-                    MeshEntity** ents) {
-    //Thread Parallize this: (use an atomic to make index for ents)
-    int n=0;
-    MeshIterator* vitr = m->begin(vtx_dim);
-    MeshEntity* ent;
-    while ((ent = m->iterate(vitr))) {
+    PCU_Comm_Send();
+    while (PCU_Comm_Receive()) {
+      MeshEntity* e;
       int c;
-      m->getIntTag(ent, coloring, &c);
-      if (c == color)
-        ents[n++] = ent;
+      PCU_COMM_UNPACK(e);
+      PCU_COMM_UNPACK(c);
+      mesh->setIntTag(e, coloring, &c);
     }
-    m->end(vitr);
+    mis->first.assign(ncolors + 1, 0);
+    MeshIterator* it = mesh->begin(vtx_dim);
+    MeshEntity* e;
+    while ((e = mesh->iterate(it))) {
+      int c;
+      mesh->getIntTag(e, coloring, &c);
+      ++mis->first[c + 1];
+    }
+    mesh->end(it);
+    for (int c = 0; c < ncolors; ++c)
+      mis->first[c + 1] += mis->first[c];
+    std::vector<int> at(mis->first.begin(), mis->first.end() - 1);
+    mis->byColor.resize(mis->first[ncolors]);
+    it = mesh->begin(vtx_dim);
+    while ((e = mesh->iterate(it))) {
+      int c;
+      mesh->getIntTag(e, coloring, &c);
+      mis->byColor[at[c]++] = e;
+    }
+    mesh->end(it);
+    removeTagFromDimension(mesh, coloring, vtx_dim);
+    mesh->destroyTag(coloring);
+    return mis;
+  }
+  void finalizeMIS(MIS* mis) {
+    delete mis;
   }
-    
+  bool getIndependentSet(MIS* mis) {
+    //colors count from one, the sets from zero
+    int c = mis->color;
+    if (c + 1 >= (int)mis->first.size())
+      return false;
+    mis->color++;
+    mis->n = mis->first[c + 1] - mis->first[c];
+    mis->ents = mis->n ? &mis->byColor[mis->first[c]] : NULL;
+    return true;
+  }
+
 }
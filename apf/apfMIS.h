@@ -1,8 +1,52 @@
 #ifndef __APF_MIS__
 #define __APF_MIS__
 #include "apfMesh.h"
+#include <vector>
+
+namespace apf{
+  //A graph in compressed sparse row form spread over the ranks.
+  //  Vertices 0 to owned-1 belong to this rank, the rest are ghosts:
+  //  ghost g is vertex owned+g here and vertex ghostIds[g] of rank
+  //  ghostOwners[g]. The neighbors of vertex i (owned) are
+  //  adjacent[offsets[i]] to adjacent[offsets[i+1]-1].
+  //  Edges must be symmetric: if an owned vertex lists a ghost,
+  //  the owner of that ghost lists it back.
+  struct MisGraph {
+    MisGraph():owned(0) {}
+    int owned;
+    std::vector<int> offsets;
+    std::vector<int> adjacent;
+    std::vector<int> ghostOwners;
+    std::vector<int> ghostIds;
+  };
+
+  //Builds the graph of the entities of dimension vtx_dim owned by
+  //  this part, adjacent when they bound a common entity of
+  //  dimension edge_dim on any part. ents[i] is owned vertex i.
+  void buildMisGraph(Mesh* m, int vtx_dim, int edge_dim,
+                     MisGraph& g, std::vector<MeshEntity*>& ents);
+  //Builds a graph with one vertex per rank adjacent to the
+  //  given peers and to the ranks that list this one as a peer
+  void buildPartMisGraph(Parts const& peers, MisGraph& g);
+
+  //Finds a maximal independent set of the graph by Luby's method.
+  //  Priorities are hashed from the seed and the global vertex ids,
+  //  so ghosts need no exchange of them; each round greedily decides
+  //  every owned vertex whose higher neighbors are decided and then
+  //  exchanges the decisions on shared vertices.
+  //  Collective; isIn gets one flag per owned vertex. If candidates
+  //  is given only the owned vertices flagged in it may join.
+  void findIndependentSet(MisGraph const& g, unsigned seed,
+                          std::vector<bool>& isIn,
+                          std::vector<bool> const& candidates =
+                            std::vector<bool>());
+  //Colors the graph with one independent set per color, each one
+  //  maximal among the vertices not yet colored. Collective; colors
+  //  gets the color of each owned vertex and the number of colors
+  //  over all ranks is returned.
+  int colorGraph(MisGraph const& g, unsigned seed,
+                 std::vector<int>& colors);
 
-namespace apf{  
   class MIS {
   public:
     MIS(Mesh* mesh, int vtx_dim_, int edge_dim_);
@@ -12,11 +56,19 @@ namespace apf{
     MeshEntity** ents;
     int n;
     int color;
+    //the local entities sorted by color, the ones of color c being
+    //  byColor[first[c]] to byColor[first[c+1]-1]
+    std::vector<MeshEntity*> byColor;
+    std::vector<int> first;
   };
 
-  //Intializes the independent set structure
+  //Intializes the independent set structure by coloring the
+  //  entities of dimension vtx_dim across all parts. Collective.
   MIS* initializeMIS(Mesh* mesh, int vtx_dim, int edge_dim);
-  //Gets the next independent set of elements
+  //Gets the next independent set of elements, returning false
+  //  once every color has been visited. Copies of an entity on
+  //  different parts are in the same set, which may be empty
+  //  on some parts.
   bool getIndependentSet(MIS* mis);
   //Cleans up he independent set structure
   void finalizeMIS(MIS* mis);
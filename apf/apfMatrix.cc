@@ -7,8 +7,7 @@
 
 #include "apfMatrix.h"
 #include "apf2mth.h"
-#include <mthQR.h>
-#include <pcu_util.h>
+#include <mthEigen.h>
 
 namespace apf {
 
@@ -70,12 +69,11 @@ int eigen(Matrix3x3 const& A,
           double* eigenValues)
 {
   mth::Matrix<double,3,3> A2 = to_mth(A);
-  mth::Matrix<double,3,3> L;
+  mth::Vector<double,3> L;
   mth::Matrix<double,3,3> Q;
-  bool converged = mth::eigenQR(A2, L, Q, 100);
-  PCU_ALWAYS_ASSERT(converged);
+  mth::eigenSymmetric(A2, L, Q);
   for (unsigned i = 0; i < 3; ++i)
-    eigenValues[i] = L(i,i);
+    eigenValues[i] = L(i);
   for (unsigned i = 0; i < 3; ++i)
   for (unsigned j = 0; j < 3; ++j)
     eigenVectors[j][i] = Q(i,j);
@@ -124,12 +122,80 @@ double getDeterminant(Matrix<1,1> const& A)
   return A[0][0];
 }
 
+/* the cofactor expansion above copies a minor for every entry,
+   these closed forms are what every Jacobian actually needs */
+
+template <>
+double getDeterminant(Matrix<2,2> const& A)
+{
+  return A[0][0] * A[1][1] - A[1][0] * A[0][1];
+}
+
+template <>
+double getDeterminant(Matrix<3,3> const& A)
+{
+  return A[0][0] * (A[1][1] * A[2][2] - A[2][1] * A[1][2])
+       - A[0][1] * (A[1][0] * A[2][2] - A[2][0] * A[1][2])
+       + A[0][2] * (A[1][0] * A[2][1] - A[2][0] * A[1][1]);
+}
+
+/* Laplace expansion along the first two rows: products of
+   the 2 by 2 minors of rows 0,1 and their complements in rows 2,3 */
+template <>
+double getDeterminant(Matrix<4,4> const& A)
+{
+  double s0 = A[0][0] * A[1][1] - A[1][0] * A[0][1];
+  double s1 = A[0][0] * A[1][2] - A[1][0] * A[0][2];
+  double s2 = A[0][0] * A[1][3] - A[1][0] * A[0][3];
+  double s3 = A[0][1] * A[1][2] - A[1][1] * A[0][2];
+  double s4 = A[0][1] * A[1][3] - A[1][1] * A[0][3];
+  double s5 = A[0][2] * A[1][3] - A[1][2] * A[0][3];
+  double c5 = A[2][2] * A[3][3] - A[3][2] * A[2][3];
+  double c4 = A[2][1] * A[3][3] - A[3][1] * A[2][3];
+  double c3 = A[2][1] * A[3][2] - A[3][1] * A[2][2];
+  double c2 = A[2][0] * A[3][3] - A[3][0] * A[2][3];
+  double c1 = A[2][0] * A[3][2] - A[3][0] * A[2][2];
+  double c0 = A[2][0] * A[3][1] - A[3][0] * A[2][1];
+  return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+}
+
+void getDeterminants(int n, double const* a, double* determinants)
+{
+  for (int i = 0; i < n; ++i) {
+    double const* m = a + i * 9;
+    determinants[i] = m[0] * (m[4] * m[8] - m[7] * m[5])
+                    - m[1] * (m[3] * m[8] - m[6] * m[5])
+                    + m[2] * (m[3] * m[7] - m[6] * m[4]);
+  }
+}
+
+void invert(int n, double const* a, double* inverses)
+{
+  for (int i = 0; i < n; ++i) {
+    double const* m = a + i * 9;
+    double* r = inverses + i * 9;
+    /* the adjugate, as the cross products of columns in apf::invert */
+    r[0] = m[4] * m[8] - m[7] * m[5];
+    r[1] = m[7] * m[2] - m[1] * m[8];
+    r[2] = m[1] * m[5] - m[4] * m[2];
+    r[3] = m[5] * m[6] - m[8] * m[3];
+    r[4] = m[8] * m[0] - m[2] * m[6];
+    r[5] = m[2] * m[3] - m[5] * m[0];
+    r[6] = m[3] * m[7] - m[6] * m[4];
+    r[7] = m[6] * m[1] - m[0] * m[7];
+    r[8] = m[0] * m[4] - m[3] * m[1];
+    double d = m[0] * r[0] + m[1] * r[3] + m[2] * r[6];
+    for (int j = 0; j < 9; ++j)
+      r[j] /= d;
+  }
+}
+
 template Matrix<1,1> getMinor(Matrix<2,2> const& A, std::size_t i, std::size_t j);
 template Matrix<2,2> getMinor(Matrix<3,3> const& A, std::size_t i, std::size_t j);
 template Matrix<3,3> getMinor(Matrix<4,4> const& A, std::size_t i, std::size_t j);
 
-template double getDeterminant(Matrix<2,2> const& A);
-template double getDeterminant(Matrix<3,3> const& A);
-template double getDeterminant(Matrix<4,4> const& A);
+template double getCofactor(Matrix<2,2> const& A, std::size_t i, std::size_t j);
+template double getCofactor(Matrix<3,3> const& A, std::size_t i, std::size_t j);
+template double getCofactor(Matrix<4,4> const& A, std::size_t i, std::size_t j);
 
 }
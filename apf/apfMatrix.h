@@ -142,6 +142,16 @@ double getCofactor(Matrix<M,N> const& A, std::size_t i, std::size_t j);
 template <std::size_t M, std::size_t N>
 double getDeterminant(Matrix<M,N> const& A);
 
+/** \brief closed form 2 by 2 determinant */
+template <>
+double getDeterminant(Matrix<2,2> const& A);
+/** \brief closed form 3 by 3 determinant */
+template <>
+double getDeterminant(Matrix<3,3> const& A);
+/** \brief closed form 4 by 4 determinant */
+template <>
+double getDeterminant(Matrix<4,4> const& A);
+
 /** \brief get the matrix of cofactors for a given matrix */
 inline Matrix<3,3> cofactor(Matrix<3,3> const &m)
 {
@@ -232,7 +242,21 @@ Matrix3x3 rotate(Vector3 const& u, double a);
   It is the user's responsibility to normalize the result if desired */
 Matrix3x3 getFrame(Vector3 const& v);
 
-/** \brief get the eigenvectors and eigenvalues of a 3 by 3 matrix */
+/** \brief get the determinants of many 3 by 3 matrices
+  \details \a a holds \a n matrices of 9 doubles each, stored
+  row by row. The loop has no branches or calls so that the
+  compiler can vectorize it across matrices. */
+void getDeterminants(int n, double const* a, double* determinants);
+
+/** \brief invert many 3 by 3 matrices
+  \details \a a and \a inverses hold \a n matrices of 9 doubles
+  each, stored row by row, and may not overlap. Singular matrices
+  give infinite or NaN entries, like apf::invert. */
+void invert(int n, double const* a, double* inverses);
+
+/** \brief get the eigenvectors and eigenvalues of a symmetric 3 by 3 matrix
+  \details the eigenvalues are in increasing order, see
+  mth::eigenSymmetric */
 int eigen(Matrix3x3 const& A,
           Vector<3>* eigenVectors,
           double* eigenValues);
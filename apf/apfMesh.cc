@@ -11,9 +11,10 @@
 #include "apfShape.h"
 #include "apfNumbering.h"
 #include "apfTagData.h"
-#include <gmi.h>
 #include <pcu_util.h>
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
 
 namespace apf {
 
@@ -148,123 +149,87 @@ void Mesh::init(FieldShape* s)
   baseP->init("coordinates",this,s,data);
   data->init(baseP);
   hasFrozenFields = false;
+  for (int d = 0; d < 4; ++d) {
+    connectivity[d] = 0;
+    classification[d] = 0;
+  }
+  sharing = 0;
+  changes = 0;
+  counters = 0;
+  char const* count = getenv("APF_MESH_COUNTERS");
+  if (count && strcmp(count, "0"))
+    counters = new MeshCounters();
 }
 
-Mesh::~Mesh()
-{
-  delete coordinateField;
-}
-
-int Mesh::getModelType(ModelEntity* e)
-{
-  return gmi_dim(getModel(), (gmi_ent*)e);
-}
-
-int Mesh::getModelTag(ModelEntity* e)
-{
-  return gmi_tag(getModel(), (gmi_ent*)e);
-}
-
-ModelEntity* Mesh::findModelEntity(int type, int tag)
-{
-  return (ModelEntity*)gmi_find(getModel(), type, tag);
-}
-
-bool Mesh::canSnap()
-{
-  return gmi_can_eval(getModel());
-}
-
-bool Mesh::canGetClosestPoint()
+MeshIterator* Mesh::beginChunk(int dimension, int chunk, int chunks)
 {
-  return gmi_can_get_closest_point(getModel());
+  PCU_ALWAYS_ASSERT(0 <= chunk && chunk < chunks);
+  MeshIterator* it = begin(dimension);
+  if (chunk)
+    while (iterate(it));
+  return it;
 }
 
-bool Mesh::canGetModelNormal()
+std::size_t Mesh::countType(int type)
 {
-  return gmi_has_normal(getModel());
+  std::size_t n = 0;
+  MeshIterator* it = begin(typeDimension[type]);
+  MeshEntity* e;
+  while ((e = iterate(it)))
+    if (getType(e) == type)
+      ++n;
+  end(it);
+  return n;
 }
 
-void Mesh::snapToModel(ModelEntity* m, Vector3 const& p, Vector3& x)
+MeshIterator* Mesh::beginType(int)
 {
-  gmi_eval(getModel(), (gmi_ent*)m, &p[0], &x[0]);
+  fail("this mesh does not support iteration by type\n");
+  return 0;
 }
 
-void Mesh::getParamOn(ModelEntity* g, MeshEntity* e, Vector3& p)
+Mesh::~Mesh()
 {
-  ModelEntity* from_g = toModel(e);
-  if (g == from_g)
-    return getParam(e, p);
-  gmi_ent* from = (gmi_ent*)from_g;
-  gmi_ent* to = (gmi_ent*)g;
-  Vector3 from_p;
-  getParam(e, from_p);
-  gmi_reparam(getModel(), from, &from_p[0], to, &p[0]);
+  clearSharing();
+  clearConnectivity();
+  delete coordinateField;
+  delete counters;
 }
 
-bool Mesh::getPeriodicRange(ModelEntity* g, int axis, double range[2])
+double* Mesh::getDoubleTagSpan(MeshTag* tag, int type, int first, int count)
 {
-  gmi_ent* e = (gmi_ent*)g;
-  gmi_range(getModel(), e, axis, range);
-  return gmi_periodic(getModel(), e, axis);
+  PCU_ALWAYS_ASSERT(getTagType(tag) == DOUBLE);
+  return static_cast<double*>(getTagSpan(tag, type, first, count));
 }
 
-void Mesh::getClosestPoint(ModelEntity* g, Vector3 const& from,
-    Vector3& to, Vector3& p)
+double* Mesh::setDoubleTagSpan(MeshTag* tag, int type, int first, int count)
 {
-  gmi_ent* e = (gmi_ent*)g;
-  gmi_closest_point(getModel(),e,&from[0],&to[0],&p[0]);
+  PCU_ALWAYS_ASSERT(getTagType(tag) == DOUBLE);
+  return static_cast<double*>(setTagSpan(tag, type, first, count));
 }
 
-void Mesh::getNormal(ModelEntity* g, Vector3 const& p, Vector3& n)
+int* Mesh::getIntTagSpan(MeshTag* tag, int type, int first, int count)
 {
-  gmi_ent* e = (gmi_ent*)g;
-  gmi_normal(getModel(),e,&p[0],&n[0]);
+  PCU_ALWAYS_ASSERT(getTagType(tag) == INT);
+  return static_cast<int*>(getTagSpan(tag, type, first, count));
 }
 
-void Mesh::getFirstDerivative(ModelEntity* g, Vector3 const& p,
-  Vector3& t0, Vector3& t1)
+int* Mesh::setIntTagSpan(MeshTag* tag, int type, int first, int count)
 {
-  gmi_ent* e = (gmi_ent*)g;
-  gmi_first_derivative(getModel(),e,&p[0], &t0[0], &t1[0]);
+  PCU_ALWAYS_ASSERT(getTagType(tag) == INT);
+  return static_cast<int*>(setTagSpan(tag, type, first, count));
 }
 
-bool Mesh::isParamPointInsideModel(ModelEntity* g,
-    Vector3 const& param, Vector3& x)
+long* Mesh::getLongTagSpan(MeshTag* tag, int type, int first, int count)
 {
-  int dim = getModelType(g);
-  PCU_ALWAYS_ASSERT(dim == 1 || dim == 2);
-  gmi_ent* e = (gmi_ent*)g;
-  gmi_set* adjRegions = gmi_adjacent(getModel(), e, 3);
-  // for 2D models
-  if (adjRegions->n == 0)
-    return true;
-  PCU_ALWAYS_ASSERT(adjRegions->n <= 1);
-  gmi_ent* r = (gmi_ent*)adjRegions->e[0];
-  gmi_eval(getModel(), (gmi_ent*)g, &param[0], &x[0]);
-  int res = gmi_is_point_in_region(getModel(), r, &x[0]);
-  gmi_free_set(adjRegions);
-  return (res == 1) ? true : false;
+  PCU_ALWAYS_ASSERT(getTagType(tag) == LONG);
+  return static_cast<long*>(getTagSpan(tag, type, first, count));
 }
 
-bool Mesh::isInClosureOf(ModelEntity* g, ModelEntity* target){
-  // make sure that the dimension of target is greater or equal the
-  // dimension of the model entity to be checked.
-  PCU_ALWAYS_ASSERT(getModelType(target) >= getModelType(g));
-  gmi_ent* e  = (gmi_ent*)g;
-  gmi_ent* et = (gmi_ent*)target;
-  int res = gmi_is_in_closure_of(getModel(), e, et);
-  return (res == 1) ? true : false;
-}
-
-bool Mesh::isOnModel(ModelEntity* g, Vector3 p, double scale)
+long* Mesh::setLongTagSpan(MeshTag* tag, int type, int first, int count)
 {
-  Vector3 to;
-  double param[2];
-  gmi_ent* c = (gmi_ent*)g;
-  gmi_closest_point(getModel(), c, &p[0], &to[0], param);
-  double ratio = (to - p).getLength() / scale;
-  return ratio < 0.001;
+  PCU_ALWAYS_ASSERT(getTagType(tag) == LONG);
+  return static_cast<long*>(setTagSpan(tag, type, first, count));
 }
 
 void Mesh::getPoint(MeshEntity* e, int node, Vector3& p)
@@ -406,12 +371,14 @@ Migration::Migration(Mesh* m)
 {
   mesh = m;
   tag = m->createIntTag("apf_migrate",1);
+  allTo = -1;
 }
 
 Migration::Migration(Mesh* m, MeshTag* existingTag)
 {
   mesh = m;
   tag = existingTag;
+  allTo = -1;
 }
 
 Migration::~Migration()
@@ -433,18 +400,53 @@ MeshEntity* Migration::get(int i)
 
 bool Migration::has(MeshEntity* e)
 {
+  if (allTo != -1 && getDimension(mesh, e) == mesh->getDimension())
+    return true;
   return mesh->hasTag(e,tag);
 }
 
 void Migration::send(MeshEntity* e, int to)
 {
-  if (!has(e))
+  if (!mesh->hasTag(e,tag))
     elements.push_back(e);
   mesh->setIntTag(e,tag,&to);
 }
 
+void Migration::send(int to)
+{
+  allTo = to;
+}
+
+MigrationBuffers::MigrationBuffers(Mesh* m, int threads):
+  mesh(m),
+  buffers(threads)
+{
+}
+
+void MigrationBuffers::send(int thread, MeshEntity* e, int to)
+{
+  Destination d;
+  d.e = e;
+  d.to = to;
+  buffers[thread].destinations.push_back(d);
+}
+
+Migration* MigrationBuffers::makePlan()
+{
+  Migration* plan = new Migration(mesh);
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    std::vector<Destination>& ds = buffers[i].destinations;
+    for (size_t j = 0; j < ds.size(); ++j)
+      plan->send(ds[j].e, ds[j].to);
+    std::vector<Destination>().swap(ds);
+  }
+  return plan;
+}
+
 int Migration::sending(MeshEntity* e)
 {
+  if (allTo != -1 && !mesh->hasTag(e,tag))
+    return allTo;
   int to;
   mesh->getIntTag(e,tag,&to);
   return to;
@@ -773,24 +775,15 @@ Vector3 getLinearCentroid(Mesh* m, MeshEntity* e)
 
 int countEntitiesOn(Mesh* m, ModelEntity* me, int dim)
 {
-  MeshIterator* it = m->begin(dim);
-  MeshEntity* e;
-  int n = 0;
-  while ((e = m->iterate(it)))
-    if (m->toModel(e) == me)
-      ++n;
-  m->end(it);
-  return n;
+  std::vector<MeshEntity*> on;
+  m->getClassified(me, dim, on);
+  return on.size();
 }
 
 int countOwned(Mesh* m, int dim, Sharing * shr)
 {
-  bool dlt = false;
   if(shr == NULL)
-  {
-    shr = getSharing(m);
-    dlt = true;
-  }
+    shr = m->getCachedSharing();
   MeshIterator* it = m->begin(dim);
   MeshEntity* e;
   int n = 0;
@@ -798,203 +791,9 @@ int countOwned(Mesh* m, int dim, Sharing * shr)
     if (shr->isOwned(e))
       ++n;
   m->end(it);
-  if(dlt) delete shr;
   return n;
 }
 
-void printTypes(Mesh* m)
-{
-  const int dim = m->getDimension();
-  if (dim==1) return;
-  PCU_ALWAYS_ASSERT(dim==2 || dim==3);
-  MeshIterator* it = m->begin(dim);
-  MeshEntity* e;
-  long typeCnt[Mesh::TYPES];
-  for (int i=0; i<Mesh::TYPES; i++)
-    typeCnt[i]=0;
-  while ((e = m->iterate(it)))
-    typeCnt[m->getType(e)]++;
-  m->end(it);
-  PCU_Add_Longs(typeCnt,Mesh::TYPES);
-  if (!PCU_Comm_Self()) {
-    printf("number of");
-    for (int i=0; i<Mesh::TYPES; i++)
-      if (dim == Mesh::typeDimension[i])
-        printf(" %s %ld", Mesh::typeName[i], typeCnt[i]);
-    printf("\n");
-  }
-}
-
-void printStats(Mesh* m)
-{
-  long n[4];
-  for (int i = 0; i < 4; ++i)
-    n[i] = countOwned(m, i);
-  PCU_Add_Longs(n, 4);
-  printTypes(m);
-  if (!PCU_Comm_Self())
-    printf("mesh entity counts: v %ld e %ld f %ld r %ld\n",
-        n[0], n[1], n[2], n[3]);
-}
-
-void warnAboutEmptyParts(Mesh* m)
-{
-  int emptyParts = 0;
-  if (!m->count(m->getDimension()))
-    ++emptyParts;
-  emptyParts = PCU_Add_Int(emptyParts);
-  if (emptyParts && (!PCU_Comm_Self()))
-    fprintf(stderr,"APF warning: %d empty parts\n",emptyParts);
-}
-
-static void getRemotesArray(Mesh* m, MeshEntity* e, CopyArray& a)
-{
-  Copies remotes;
-  m->getRemotes(e, remotes);
-  a.setSize(remotes.size());
-  size_t i = 0;
-  APF_ITERATE(Copies, remotes, it) 
-  {
-    a[i].peer = it->first;
-    a[i].entity = it->second;
-    ++i;
-  }
-}
-
-NormalSharing::NormalSharing(Mesh* m):mesh(m) {}
-
-int NormalSharing::getOwner(MeshEntity* e)
-{
-  return mesh->getOwner(e);
-}
-
-bool NormalSharing::isOwned(MeshEntity* e)
-{
-  return mesh->isOwned(e);
-}
-
-void NormalSharing::getCopies(MeshEntity* e,
-      CopyArray& copies)
-{
-  if (!mesh->isShared(e))
-    return;
-  getRemotesArray(mesh, e, copies);
-}
-
-bool NormalSharing::isShared(MeshEntity* e) {
-  return mesh->isShared(e);
-}
-
-/* okay... so previously this used a min-rank rule
-   for matched copies, but thats inconsistent with
-   the min-count rule in MDS for regular copies,
-   and the usual partition model ignores matched
-   copies.
-   for now, we'll build a full neighbor count
-   system into this object just to implement
-   the min-count rule for matched neighbors */
-MatchedSharing::MatchedSharing(Mesh* m):
-  mesh(m),
-  helper(m)
-{
-  formCountMap();
-}
-
-size_t MatchedSharing::getNeighborCount(int peer)
-{
-  PCU_ALWAYS_ASSERT(countMap.count(peer));
-  return countMap[peer];
-}
-
-bool MatchedSharing::isLess(Copy const& a, Copy const& b)
-{
-  size_t ca = this->getNeighborCount(a.peer);
-  size_t cb = this->getNeighborCount(b.peer);
-  if (ca != cb)
-    return ca < cb;
-  if (a.peer != b.peer)
-    return a.peer < b.peer;
-  return a.entity < b.entity;
-}
-
-Copy MatchedSharing::getOwnerCopy(MeshEntity* e)
-{
-  Copy owner(PCU_Comm_Self(), e);
-  CopyArray copies;
-  this->getCopies(e, copies);
-  APF_ITERATE(CopyArray, copies, cit)
-    if (this->isLess(*cit, owner))
-      owner = *cit;
-  return owner;
-}
-
-int MatchedSharing::getOwner(MeshEntity* e)
-{
-  Copy owner = this->getOwnerCopy(e);
-  return owner.peer;
-}
-
-bool MatchedSharing::isOwned(MeshEntity* e)
-{
-  Copy owner = this->getOwnerCopy(e);
-  return owner.peer == PCU_Comm_Self() && owner.entity == e;
-}
-
-void MatchedSharing::getCopies(MeshEntity* e,
-    CopyArray& copies)
-{
-  mesh->getMatches(e, copies);
-  if (!copies.getSize())
-    helper.getCopies(e, copies);
-}
-
-void MatchedSharing::getNeighbors(Parts& neighbors)
-{
-  MeshIterator* it = mesh->begin(0);
-  MeshEntity* v;
-  while ((v = mesh->iterate(it))) {
-    CopyArray copies;
-    this->getCopies(v, copies);
-    APF_ITERATE(CopyArray, copies, cit)
-      neighbors.insert(cit->peer);
-  }
-  mesh->end(it);
-  neighbors.erase(PCU_Comm_Self());
-}
-
-void MatchedSharing::formCountMap()
-{
-  size_t count = mesh->count(mesh->getDimension());
-  countMap[PCU_Comm_Self()] = count;
-  PCU_Comm_Begin();
-  Parts neighbors;
-  getNeighbors(neighbors);
-  APF_ITERATE(Parts, neighbors, nit)
-    PCU_COMM_PACK(*nit, count);
-  PCU_Comm_Send();
-  while (PCU_Comm_Receive()) {
-    size_t oc;
-    PCU_COMM_UNPACK(oc);
-    countMap[PCU_Comm_Sender()] = oc;
-  }
-}
-
-bool MatchedSharing::isShared(MeshEntity* e) {
-  CopyArray copies;
-  this->getCopies(e, copies);
-  APF_ITERATE(CopyArray, copies, it)
-    if (it->peer != PCU_Comm_Self())
-      return true;
-  return false;
-}
-
-Sharing* getSharing(Mesh* m)
-{
-  if (m->hasMatching())
-    return new MatchedSharing(m);
-  return new NormalSharing(m);
-}
-
 static void getUpBridgeAdjacent(Mesh* m, MeshEntity* origin,
     int bridgeDimension, int targetDimension,
     std::set<MeshEntity*>& result)
@@ -35,6 +35,11 @@ class MeshTag;
 
 class ModelEntity;
 
+struct MeshMemory;
+struct Connectivity;
+struct Sharing;
+struct Classification;
+
 /** \brief Remote copy container.
   \details the key is the part id, the value
   is the on-part pointer to the remote copy */
@@ -93,6 +98,37 @@ typedef CopyArray Matches;
 /** \brief a set of DG copies */
 typedef CopyArray DgCopies;
 
+/** \brief counts of the queries made to a mesh part
+  \details see apf::Mesh::getCounters */
+struct MeshCounters
+{
+  enum {
+    /** \brief apf::Mesh::getAdjacent */
+    ADJACENT,
+    /** \brief getAdjacent calls between dimensions more than one
+               apart whose adjacency is not stored, which traverse
+               the intermediate dimensions */
+    SECOND_ORDER,
+    /** \brief apf::Mesh::getDownward */
+    DOWNWARD,
+    /** \brief apf::Mesh::getUp */
+    UP,
+    /** \brief apf::Mesh::iterate */
+    ITERATE,
+    /** \brief apf::Mesh::getPoint */
+    POINT,
+    /** \brief tag reads, apf::Mesh::getIntTag and the like */
+    TAG_GET,
+    /** \brief tag writes, apf::Mesh::setIntTag and the like */
+    TAG_SET,
+    QUERIES
+  };
+  MeshCounters();
+  /** \brief by query, dimension of the entity and the dimension
+             asked for, which is zero for the other queries */
+  long counts[QUERIES][4][4];
+};
+
 /** \brief Interface to a mesh part
   \details This base class is the interface for almost all mesh
   operations in APF. Code that interacts with a mesh should do
@@ -122,6 +158,26 @@ class Mesh
     /** \brief iterate over mesh entities
         \details 0 is returned at the end of the iteration */
     virtual MeshEntity* iterate(MeshIterator* it) = 0;
+    /** \brief begins iteration over one of (chunks) pieces of a dimension
+        \details the pieces are disjoint, cover all entities of the
+                 dimension in the order of apf::Mesh::begin, and can
+                 be iterated at the same time by different threads
+                 as long as the mesh is not modified.
+                 The default puts every entity in the first piece.
+                 Use apf::Mesh::iterate and apf::Mesh::end as usual. */
+    virtual MeshIterator* beginChunk(int dimension, int chunk, int chunks);
+    /** \brief returns the number of entities of one apf::Mesh::Type
+        \details the default counts them by iterating their dimension */
+    virtual std::size_t countType(int type);
+    /** \brief begins iteration over the entities of one apf::Mesh::Type
+        \details iterating each type of a dimension in turn visits
+                 all its entities in blocks of one type, so the loop
+                 over a block can be specialized for its type instead
+                 of asking getType of every entity, as
+                 apf::evaluateShapeBatch wants.
+                 Use apf::Mesh::iterate and apf::Mesh::end as usual.
+                 The default fails, meshes that can should override it. */
+    virtual MeshIterator* beginType(int type);
     /** \brief destroy an iterator.
         \details an end() call should match every begin()
                  call to prevent memory leaks */
@@ -210,6 +266,18 @@ class Mesh
     void getPoint(MeshEntity* e, int node, Vector3& point);
     /** \brief Implementation-defined code for apf::Mesh::getPoint */
     virtual void getPoint_(MeshEntity* e, int node, Vector3& point) = 0;
+    /** \brief direct access to the coordinates of a range of vertices
+      \details like apf::Mesh::getTagSpan for the vertex coordinates:
+      returns the x, y and z of the vertices with storage indices
+      [first, first + count), one vertex after another.
+      apf::Mesh::countTagSpan of apf::Mesh::VERTEX tells when these
+      indices follow iteration order.
+      Writing through the pointer moves the vertices.
+      The pointer is valid until the mesh is modified.
+      Returns zero if the mesh does not keep its vertex
+      coordinates in one array. */
+    virtual double* getPointSpan(int first, int count)
+    {(void)first; (void)count; return 0;}
     /** \brief Get the geometric parametric coordinates of a vertex */
     virtual void getParam(MeshEntity* e, Vector3& p) = 0;
     /** \brief Get the topological type of a mesh entity.
@@ -217,6 +285,23 @@ class Mesh
     virtual Type getType(MeshEntity* e) = 0;
     /** \brief Get the remote copies of an entity */
     virtual void getRemotes(MeshEntity* e, Copies& remotes) = 0;
+    /** \brief Whether this part keeps per-peer lists of its copies
+      \details if true, apf::Mesh::getSharedPeers and
+               apf::Mesh::getSharedWith list every copy on another
+               part, which rules out ghosts. The default is false. */
+    virtual bool hasSharedLists() {return false;}
+    /** \brief Get the parts sharing entities of a dimension with this one
+      \details only implemented if apf::Mesh::hasSharedLists */
+    virtual void getSharedPeers(int dimension, Parts& peers)
+    {(void)dimension; (void)peers;}
+    /** \brief Get the entities of a dimension shared with a peer
+      \details only implemented if apf::Mesh::hasSharedLists.
+               This part and the peer list the entities they share
+               in the same order, so values can be exchanged
+               without sending the entities. */
+    virtual void getSharedWith(int dimension, int peer,
+        DynamicArray<MeshEntity*>& ents)
+    {(void)dimension; (void)peer; (void)ents;}
 // seol
     virtual int getGhosts(MeshEntity* e, Copies& ghosts) = 0;
     /** \brief Get the resident parts of an entity
@@ -273,6 +358,62 @@ class Mesh
       \returns a pointer to an internal C string.
                do not free this pointer */
     virtual const char* getTagName(MeshTag* t) = 0;
+    /** \brief count the entities of a type reachable through tag spans
+      \details tag spans index the entities of one apf::Mesh::Type
+      by their position in storage. When the storage has no gaps,
+      this returns the number of entities of (type) and the
+      storage index of each is its position in iteration order.
+      Otherwise, or if the mesh does not store tags in arrays,
+      it returns zero. */
+    virtual int countTagSpan(int type) {(void)type; return 0;}
+    /** \brief a key for the place of an entity in storage
+      \details keys are unique among the entities of the part and
+      below apf::Mesh::countStorageKeys. An entity keeps its key until
+      it is destroyed, after which a new entity may take the key.
+      Returns -1 if the mesh has no such keys. */
+    virtual int getStorageKey(MeshEntity* e) {(void)e; return -1;}
+    /** \brief one more than the largest storage key,
+      or zero if the mesh has no storage keys */
+    virtual int countStorageKeys() {return 0;}
+    /** \brief direct access to the tag values of a range of entities
+      \details returns a pointer to the values of the entities of
+      (type) with storage indices [first, first + count),
+      each apf::Mesh::getTagSize values long, one after another.
+      All of these entities must have the tag.
+      The pointer is valid until the mesh is modified
+      or data is attached to more entities.
+      Returns zero if the mesh does not store tags in arrays. */
+    virtual void* getTagSpan(MeshTag* tag, int type, int first, int count)
+    {(void)tag; (void)type; (void)first; (void)count; return 0;}
+    /** \brief like apf::Mesh::getTagSpan, but first attaches
+      the tag to any entity in the range that lacks it,
+      so that the values can be written */
+    virtual void* setTagSpan(MeshTag* tag, int type, int first, int count)
+    {(void)tag; (void)type; (void)first; (void)count; return 0;}
+    /** \brief direct access to the tag values of one entity
+      \details the pointer is valid until the mesh is modified
+      or data is attached to more entities. Returns zero if the
+      entity does not have the tag or the mesh does not store
+      tags in arrays. */
+    virtual void* getTagPointer(MeshEntity* e, MeshTag* tag)
+    {(void)e; (void)tag; return 0;}
+    /** \brief count the memory of a tag in a PCU_MEM_ category
+      \details see PCU_Mem_Current. Meshes whose tag memory
+      PCU does not count ignore this. */
+    virtual void chargeTag(MeshTag* tag, int category)
+    {(void)tag; (void)category;}
+    /** \brief typed apf::Mesh::getTagSpan for double tags */
+    double* getDoubleTagSpan(MeshTag* tag, int type, int first, int count);
+    /** \brief typed apf::Mesh::setTagSpan for double tags */
+    double* setDoubleTagSpan(MeshTag* tag, int type, int first, int count);
+    /** \brief typed apf::Mesh::getTagSpan for int tags */
+    int* getIntTagSpan(MeshTag* tag, int type, int first, int count);
+    /** \brief typed apf::Mesh::setTagSpan for int tags */
+    int* setIntTagSpan(MeshTag* tag, int type, int first, int count);
+    /** \brief typed apf::Mesh::getTagSpan for long tags */
+    long* getLongTagSpan(MeshTag* tag, int type, int first, int count);
+    /** \brief typed apf::Mesh::setTagSpan for long tags */
+    long* setLongTagSpan(MeshTag* tag, int type, int first, int count);
     /** \brief get geometric classification */
     virtual ModelEntity* toModel(MeshEntity* e) = 0;
     /** \brief get a GMI interface to the geometric model */
@@ -291,6 +432,10 @@ class Mesh
     bool canGetModelNormal();
     /** \brief evaluate parametric coordinate (p) as a spatial point (x) */
     void snapToModel(ModelEntity* m, Vector3 const& p, Vector3& x);
+    /** \brief evaluate (n) parametric coordinates at once
+      \details see gmi_eval_batch */
+    void snapToModel(int n, ModelEntity* const* m, Vector3 const* p,
+        Vector3* x);
     /** \brief reparameterize mesh vertex (e) onto model entity (g) */
     void getParamOn(ModelEntity* g, MeshEntity* e, Vector3& p);
     /** \brief get the periodic properties of a model entity
@@ -301,8 +446,16 @@ class Mesh
     /** \brief get closest point on geometry */
     void getClosestPoint(ModelEntity* g, Vector3 const& from,
         Vector3& to, Vector3& p);
+    /** \brief get (n) closest points at once
+      \details see gmi_closest_point_batch */
+    void getClosestPoint(int n, ModelEntity* const* g, Vector3 const* from,
+        Vector3* to, Vector3* p);
     /** \brief get normal vector at a point */
     void getNormal(ModelEntity* g, Vector3 const& p, Vector3& n);
+    /** \brief get (n) normal vectors at once
+      \details see gmi_normal_batch */
+    void getNormal(int n, ModelEntity* const* g, Vector3 const* p,
+        Vector3* normals);
     /** \brief get first derivative at a point */
       void getFirstDerivative(ModelEntity* g, Vector3 const& p,
           Vector3& t0, Vector3& t1);
@@ -348,6 +501,9 @@ class Mesh
       \returns an estimate of how many bytes are needed
       to store an entity of (type) */
     virtual double getElementBytes(int) {return 1.0;}
+    /** \brief report the bytes allocated by the mesh data structure
+      \details the default implementation reports nothing */
+    virtual void getMemoryUsage(MeshMemory& usage);
     /** \brief associate a field with this mesh
       \details most users don't need this, functions in apf.h
                automatically call it */
@@ -385,18 +541,136 @@ class Mesh
     GlobalNumbering* getGlobalNumbering(int i);
     /** \brief true if any associated fields use array storage */
     bool hasFrozenFields;
+    /** \brief get the vertex lists of the entities of one dimension
+      \details the table is gathered on first use and kept until
+               apf::Mesh::clearConnectivity, which apf::Mesh2::acceptChanges
+               and entity creation and destruction call, so that
+               writers and converters in a phase of constant topology
+               share one gather instead of each walking adjacency */
+    Connectivity const& getConnectivity(int dimension);
+    /** \brief drop the tables of apf::Mesh::getConnectivity,
+               and those of apf::Mesh::getClassified */
+    void clearConnectivity();
+    /** \brief the number of apf::Mesh::clearConnectivity calls so far
+      \details caches kept outside the mesh compare this with the
+               count they were built at to notice structural changes */
+    unsigned long countChanges() const {return changes;}
+    /** \brief append the entities of one dimension classified on (g)
+      \details the first call gathers the entities of that dimension
+               grouped by classification, kept until
+               apf::Mesh::clearClassified, which
+               apf::Mesh::clearConnectivity and
+               apf::Mesh2::setModelEntity call, so that later calls
+               take time in proportion to their result.
+               The entities come in the order of apf::Mesh::begin */
+    void getClassified(ModelEntity* g, int dimension,
+        std::vector<MeshEntity*>& entities);
+    /** \brief drop the tables of apf::Mesh::getClassified */
+    void clearClassified();
+    /** \brief the mesh's own apf::Sharing, an apf::CachedSharing
+      \details made by apf::getSharing on first use and kept until
+               apf::Mesh::clearSharing, which apf::Mesh2::acceptChanges
+               calls, so that the code synchronizing and numbering
+               between two changes of the partition shares one set
+               of ownership tables. Do not delete it. On meshes with
+               matching the first call after a change is collective,
+               as apf::getSharing is. */
+    Sharing* getCachedSharing();
+    /** \brief drop the sharing of apf::Mesh::getCachedSharing */
+    void clearSharing();
+    /** \brief the query counters, zero unless the APF_MESH_COUNTERS
+               environment variable was set when the mesh was made,
+               see apf::printMeshCounters */
+    MeshCounters* getCounters() {return counters;}
   protected:
+    /** \brief count a query of an entity of (dimension) for
+               dimension (other), which implementations call
+               from their query methods. While counting is off
+               this costs one test. */
+    void countQuery(int query, int dimension, int other = 0)
+    {
+      if (counters)
+        ++(counters->counts[query][dimension][other]);
+    }
+    MeshCounters* counters;
+    Connectivity* connectivity[4];
+    Classification* classification[4];
+    Sharing* sharing;
+    unsigned long changes;
     Field* coordinateField;
     std::vector<Field*> fields;
     std::vector<Numbering*> numberings;
     std::vector<GlobalNumbering*> globalNumberings;
 };
 
+/** \brief print the query counters summed over the parts
+  \details this is a collective call. Nothing prints the counters
+  on its own, so call it while the mesh is alive, on every part,
+  when APF_MESH_COUNTERS is set. Parts without counters add zeros. */
+void printMeshCounters(Mesh* m);
+
+/** \brief flat downward vertex lists of the entities of one dimension
+  \details entity (i) is elements[i], in the order of apf::Mesh::begin,
+  and its vertices, in the order of apf::Mesh::getDownward, are
+  vertices[offsets[i]] up to vertices[offsets[i + 1]] */
+struct Connectivity
+{
+  std::vector<MeshEntity*> elements;
+  std::vector<int> offsets;
+  std::vector<MeshEntity*> vertices;
+};
+
+/** \brief bytes allocated by a mesh part, by entity type,
+  see apf::Mesh::getMemoryUsage */
+struct MeshMemory
+{
+  MeshMemory();
+  /** \brief links to downward entities */
+  size_t downward[Mesh::TYPES];
+  /** \brief links to upward entities */
+  size_t upward[Mesh::TYPES];
+  /** \brief vertex coordinates and parametric coordinates */
+  size_t coordinates[Mesh::TYPES];
+  /** \brief tag data */
+  size_t tags[Mesh::TYPES];
+  /** \brief remote, matched and ghost copies */
+  size_t remotes[Mesh::TYPES];
+  /** \brief classification, residence and bookkeeping */
+  size_t other[Mesh::TYPES];
+  /** \brief bytes per entity identifier in the adjacency
+     structures, or zero if not applicable */
+  int idBytes;
+};
+
+/** \brief print the memory used by a mesh, summed over all parts */
+void printMemoryUsage(Mesh* m);
+
 /** \brief run consistency checks on an apf::Mesh structure
   \details this can be used to implement apf::Mesh::verify.
   Other implementations may define their own. */
 void verify(Mesh* m, bool abort_on_error=true);
 
+/** \brief how much of the mesh apf::verify checks */
+enum VerifyLevel
+{
+  /** local O(n) checks of counts, adjacencies, classification
+      and residence */
+  VERIFY_STRUCTURE,
+  /** also remote copies, their alignment and coordinates in one
+      exchange, then ghost copies and periodic matches */
+  VERIFY_PARALLEL,
+  /** also tags, fields and element volumes */
+  VERIFY_ALL
+};
+
+/** \brief run the consistency checks up to a level
+  \details the local checks of each entity are split over (threads)
+  threads. The time of each group of checks, the maximum over
+  all parts, is printed with the total. apf::verify(m, abort_on_error)
+  is the same as VERIFY_ALL on one thread. */
+void verify(Mesh* m, VerifyLevel level, bool abort_on_error=true,
+    int threads=1);
+
 long verifyVolumes(Mesh* m, bool printVolumes = true);
 
 /** \brief get the dimension of a mesh entity */
@@ -446,7 +720,8 @@ class Migration
     Migration(Mesh* m);
     Migration(Mesh* m, MeshTag* existingTag);
     ~Migration();
-/** \brief return the number of elements with assigned destinations */
+/** \brief return the number of elements with assigned destinations
+  \details this does not count the elements covered only by send(int) */
     int count();
 /** \brief get the i'th element with an assigned destination */
     MeshEntity* get(int i);
@@ -454,13 +729,53 @@ class Migration
     bool has(MeshEntity* e);
 /** \brief assign a destination part id to an element */
     void send(MeshEntity* e, int to);
+/** \brief assign a destination to all elements without one of their own
+  \details this stores nothing per element, so a plan that sends
+  a whole part to one place except for a few elements should
+  use this and send(MeshEntity*,int) for the exceptions. */
+    void send(int to);
 /** \brief return the destination part id of an element */
     int sending(MeshEntity* e);
+/** \brief return the part given to send(int), or -1 */
+    int sendingAll() {return allTo;}
     Mesh* getMesh() {return mesh;}
   private:
     Mesh* mesh;
     MeshTag* tag;
     std::vector<MeshEntity*> elements;
+    int allTo;
+};
+
+/** \brief element destinations gathered by several threads
+  \details apf::Migration::send writes a tag and may not be called
+  concurrently. Instead, each of (threads) threads can call
+  send with its own thread index at the same time as the others,
+  and once they are all done, one thread calls makePlan to get
+  the apf::Migration to give to apf::Mesh::migrate. */
+class MigrationBuffers
+{
+  public:
+    MigrationBuffers(Mesh* m, int threads);
+/** \brief record a destination from thread (thread) */
+    void send(int thread, MeshEntity* e, int to);
+/** \brief build a plan of all destinations and empty the buffers
+  \details destinations are applied in thread order, so a later
+  thread wins if two threads send the same element */
+    Migration* makePlan();
+  private:
+    struct Destination
+    {
+      MeshEntity* e;
+      int to;
+    };
+    struct Buffer
+    {
+      std::vector<Destination> destinations;
+      /* keeps the vectors of two threads off one cache line */
+      char padding[64];
+    };
+    Mesh* mesh;
+    std::vector<Buffer> buffers;
 };
 
 /** \brief abstract description of entity copy sharing
@@ -512,6 +827,38 @@ private:
   std::map<int, size_t> countMap;
 };
 
+/** \brief a sharing that tabulates the ownership given by another
+  \details the first query of an entity of some dimension asks (inner)
+  about all the entities of that dimension and keeps the answers in
+  bit arrays by apf::Mesh::getStorageKey, along with the owners of the
+  entities owned elsewhere, so that later calls to isOwned and
+  isShared are a bit test. Once the mesh changes (see
+  apf::Mesh::countChanges), or if it has no storage keys, queries go
+  to (inner), which this object deletes. */
+struct CachedSharing : public Sharing
+{
+  CachedSharing(Mesh* m, Sharing* inner);
+  ~CachedSharing();
+  virtual int getOwner(MeshEntity* e);
+  virtual bool isOwned(MeshEntity* e);
+  virtual void getCopies(MeshEntity* e,
+      CopyArray& copies);
+  virtual bool isShared(MeshEntity* e);
+private:
+  int find(MeshEntity* e);
+  void tabulate(int dimension);
+  Mesh* mesh;
+  Sharing* inner;
+  unsigned long changes;
+  int self;
+  bool tabulated[4];
+  std::vector<bool> known;
+  std::vector<bool> owned;
+  std::vector<bool> shared;
+  /* (key, owner) of the entities owned elsewhere, by key */
+  std::vector<std::pair<int, int> > owners;
+};
+
 /** \brief create a default sharing object for this mesh
   \details for normal meshes, the sharing object just
   describes remote copies. For matched meshes, the
@@ -568,12 +915,51 @@ int countEntitiesOn(Mesh* m, ModelEntity* me, int dim);
            the default sharing is used if none is provided */
 int countOwned(Mesh* m, int dim, Sharing * shr = NULL);
 
+/** \brief global mesh statistics, see apf::getStats */
+struct MeshStats
+{
+  /** \brief the mesh dimension */
+  int dimension;
+  /** \brief owned entities per dimension */
+  long counts[4];
+  /** \brief elements per type */
+  long types[Mesh::TYPES];
+  /** \brief the fewest elements on a part */
+  long minElements;
+  /** \brief the most elements on a part */
+  long maxElements;
+  /** \brief parts without elements */
+  long emptyParts;
+};
+
+/** \brief gather global mesh statistics with a single reduction
+  \details collective, gives the same statistics on every part */
+void getStats(Mesh* m, MeshStats& s);
+
+/** \brief a getStats in flight, see apf::beginStats */
+struct StatsReduction;
+
+/** \brief begin a non-blocking apf::getStats
+  \details the local counts are taken now and the reduction
+  proceeds while the caller goes on, even modifying the mesh.
+  Every part must begin and end its reductions in the same order. */
+StatsReduction* beginStats(Mesh* m);
+
+/** \brief wait for the statistics begun by apf::beginStats */
+void endStats(StatsReduction* r, MeshStats& s);
+
 /** \brief print global mesh entity counts per dimension */
 void printStats(Mesh* m);
 
+/** \brief print already gathered statistics as apf::printStats does */
+void printStats(MeshStats const& s);
+
 /** \brief print to stderr the number of empty parts, if any */
 void warnAboutEmptyParts(Mesh* m);
 
+/** \brief warnAboutEmptyParts from already gathered statistics */
+void warnAboutEmptyParts(MeshStats const& s);
+
 /** \brief given a mesh face, return its remote copy */
 Copy getOtherCopy(Mesh* m, MeshEntity* s);
 
@@ -6,7 +6,11 @@
 
 #include "apfShape.h"
 #include "apfTagData.h"
+#include "apfArrayData.h"
 #include "apfNumbering.h"
+#include <algorithm>
+#include <functional>
+#include <vector>
 
 namespace apf
 {
@@ -82,6 +86,181 @@ MeshEntity* buildElement(
   return b.run(type,verts);
 }
 
+/* an entity by its sorted one-level downward entities,
+   which is independent of its orientation */
+struct SideKey
+{
+  int type;
+  MeshEntity* down[4];
+};
+
+static bool operator<(SideKey const& a, SideKey const& b)
+{
+  if (a.type != b.type)
+    return a.type < b.type;
+  std::less<MeshEntity*> less;
+  for (int i = 0; i < 4; ++i)
+    if (a.down[i] != b.down[i])
+      return less(a.down[i], b.down[i]);
+  return false;
+}
+
+static SideKey makeSideKey(int type, MeshEntity** down)
+{
+  SideKey k;
+  k.type = type;
+  int n = Mesh::adjacentCount[type][Mesh::typeDimension[type] - 1];
+  std::fill(k.down, k.down + 4, (MeshEntity*)0);
+  /* an insertion sort of at most four entities */
+  std::less<MeshEntity*> less;
+  for (int i = 0; i < n; ++i) {
+    int j = i;
+    for (; j > 0 && less(down[i], k.down[j - 1]); --j)
+      k.down[j] = k.down[j - 1];
+    k.down[j] = down[i];
+  }
+  return k;
+}
+
+/* one use of a side by an element, in the element's orientation */
+struct SideUse
+{
+  SideKey key;
+  MeshEntity* down[4];
+};
+
+static bool operator<(SideUse const& a, SideUse const& b)
+{
+  return a.key < b.key;
+}
+
+struct Side
+{
+  SideKey key;
+  MeshEntity* entity;
+};
+
+static bool operator<(Side const& a, SideKey const& b)
+{
+  return a.key < b;
+}
+
+/* runs over all the elements once per dimension:
+   the sides of the current dimension are collected,
+   sides of lower dimensions are looked up in sorted tables,
+   and nothing above the current dimension is made */
+class BulkBuilder : public ElementVertOp
+{
+  public:
+    BulkBuilder(Mesh2* m, ModelEntity* c, int type)
+    {
+      mesh = m;
+      modelEntity = c;
+      elementDim = Mesh::typeDimension[type];
+      for (int d = 0; d < 4; ++d)
+        existed[d] = m->count(d) != 0;
+      dim = 1;
+    }
+    void setDimension(int d)
+    {
+      dim = d;
+    }
+    virtual MeshEntity* apply(int type, MeshEntity** down)
+    {
+      int d = Mesh::typeDimension[type];
+      if (d > dim)
+        return 0;
+      if (d == elementDim) {
+        if (existed[d])
+          return makeOrFind(mesh, modelEntity, type, down);
+        return mesh->createEntity(type, modelEntity, down);
+      }
+      if (d == dim) {
+        SideUse u;
+        u.key = makeSideKey(type, down);
+        std::copy(down, down + 4, u.down);
+        uses.push_back(u);
+        return 0;
+      }
+      return find(d, makeSideKey(type, down));
+    }
+    /* stable sorting keeps the first use of each side
+       first, so it gets the orientation buildElement gives it */
+    void makeSides()
+    {
+      std::stable_sort(uses.begin(), uses.end());
+      size_t unique[Mesh::TYPES] = {};
+      size_t total = 0;
+      for (size_t i = 0; i < uses.size(); ++i)
+        if (!i || uses[i - 1].key < uses[i].key) {
+          ++unique[uses[i].key.type];
+          ++total;
+        }
+      for (int t = 0; t < Mesh::TYPES; ++t)
+        if (unique[t])
+          mesh->reserve(t, unique[t]);
+      std::vector<Side>& s = sides[dim];
+      s.reserve(total);
+      for (size_t i = 0; i < uses.size(); ++i) {
+        if (i && !(uses[i - 1].key < uses[i].key))
+          continue;
+        Side side;
+        side.key = uses[i].key;
+        side.entity = 0;
+        if (existed[dim])
+          side.entity = findUpward(mesh, side.key.type, uses[i].down);
+        if (!side.entity)
+          side.entity = mesh->createEntity(
+              side.key.type, modelEntity, uses[i].down);
+        s.push_back(side);
+      }
+      std::vector<SideUse>().swap(uses);
+    }
+  private:
+    MeshEntity* find(int d, SideKey const& k)
+    {
+      std::vector<Side>& s = sides[d];
+      std::vector<Side>::iterator it =
+        std::lower_bound(s.begin(), s.end(), k);
+      PCU_ALWAYS_ASSERT(it != s.end() && !(k < it->key));
+      return it->entity;
+    }
+    Mesh2* mesh;
+    ModelEntity* modelEntity;
+    int elementDim;
+    int dim;
+    bool existed[4];
+    std::vector<SideUse> uses;
+    std::vector<Side> sides[3];
+};
+
+void buildElements(
+    Mesh2* m,
+    ModelEntity* c,
+    int type,
+    int n,
+    MeshEntity** verts,
+    MeshEntity** elements)
+{
+  int elementDim = Mesh::typeDimension[type];
+  PCU_ALWAYS_ASSERT(elementDim > 0);
+  int nv = Mesh::adjacentCount[type][0];
+  BulkBuilder b(m, c, type);
+  for (int d = 1; d < elementDim; ++d) {
+    b.setDimension(d);
+    for (int i = 0; i < n; ++i)
+      b.run(type, verts + i * nv);
+    b.makeSides();
+  }
+  b.setDimension(elementDim);
+  m->reserve(type, n);
+  for (int i = 0; i < n; ++i) {
+    MeshEntity* e = b.run(type, verts + i * nv);
+    if (elements)
+      elements[i] = e;
+  }
+}
+
 MeshEntity* buildOneElement(
     Mesh2* m,
     ModelEntity* c,
@@ -266,6 +445,8 @@ static void packFieldClone(Field* f, int to)
   std::string shapeName = f->getShape()->getName();
   packString(shapeName, to);
   /* warning! this only supports tag-stored fields */
+  int storage = getTagStorage(f->getData());
+  PCU_COMM_PACK(to, storage);
 }
 
 static Field* unpackFieldClone(Mesh2* m)
@@ -279,7 +460,10 @@ static Field* unpackFieldClone(Mesh2* m)
   FieldShape* shape = getShapeByName(shapeName.c_str());
   PCU_ALWAYS_ASSERT(shape);
   /* warning! this only supports tag-stored fields */
-  return makeField(m, name.c_str(), valueType, components, shape, new TagDataOf<double>);
+  int storage;
+  PCU_COMM_UNPACK(storage);
+  return makeField(m, name.c_str(), valueType, components, shape,
+      makeTagStorage(storage));
 }
 
 static void packFieldClones(Mesh2* m, int to)
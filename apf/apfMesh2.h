@@ -105,6 +105,10 @@ class Mesh2 : public Mesh
     }
 /** \brief Change the geometric classification of an entity. */
     virtual void setModelEntity(MeshEntity* e, ModelEntity* c) = 0;
+/** \brief Prepare room for (n) more entities of a type
+  \details this is only a hint that lets bulk construction avoid
+  repeated growth of storage, the default does nothing */
+    virtual void reserve(int type, size_t n) {(void)type; (void)n;}
 /** \brief Add a matched copy to an entity */
     virtual void addMatch(MeshEntity* e, int peer, MeshEntity* match) = 0;
 /** \brief Remove all matched copies of an entity */
@@ -132,12 +136,47 @@ void migrate(Mesh2* m, Migration* plan);
 
 void migrateSilent(Mesh2* m, Migration* plan);
 
+/** \brief the number of elements apf::migrate has sent away
+  from this part so far, for profiling the callers
+  \details in PCU thread mode this is the sum over the threads
+  of the process */
+long countMigratedElements();
+
+/** \brief estimates of what an apf::migrate call would cost a part */
+struct MigrationCost
+{
+  /** \brief bytes of entity messages this part would send */
+  long sendBytes;
+  /** \brief bytes of entity messages this part would receive */
+  long receiveBytes;
+  /** \brief number of entities the part would hold afterwards,
+    the main term of its memory use */
+  long entities;
+  /** \brief number of neighbor parts the part would have afterwards */
+  long neighbors;
+};
+
+/** \brief estimate the cost of migrating (plan) without moving anything
+  \details this follows the closure of the elements that leave,
+  skipping entities whose destination already has a copy, and
+  counts the bytes apf::migrate would pack for each, tags included.
+  Shared entities sent to one part from several parts are counted
+  once per sender, where apf::migrate sends them once, and the
+  neighbors are all the current ones plus the parts exchanging
+  elements, so these are upper bounds. (local) gets this part's
+  estimates and (max) the maximum of each over all parts.
+  The plan is left untouched.
+  This is a collective call with one message phase and one reduction. */
+void estimateMigration(Mesh2* m, Migration* plan,
+    MigrationCost& local, MigrationCost& max);
+
 /** \brief set the maximum elements that apf::migrate moves at once
-  \details apf::migrate implements gradual limited migration
-  in an effort to help applications keep memory use to a minimum.
-  This function globally sets the limit on migration, which
-  causes any migration requests greater than the limit to
-  be performed as several consecutive migrations. */
+  \details plans with more elements on some part are carried out as
+  a sequence of migrations of at most this many elements per part,
+  each finishing before the next begins, to limit peak memory use.
+  Within one migration, the entities of each dimension are also sent
+  in batches of at most this many per part to keep message buffers
+  small. This function sets the limit globally. */
 void setMigrationLimit(size_t maxElements);
 
 class Field;
@@ -178,6 +217,24 @@ MeshEntity* buildElement(
     MeshEntity** verts,
     BuildCallback* cb = 0);
 
+/** \brief build many elements of one type from their vertices
+  \details this builds the same entities as calling apf::buildElement
+  on each element in turn, but the intermediate entities of each
+  dimension are found by sorting the vertex tuples of all the elements
+  at once rather than by searching upward adjacencies, and the mesh
+  is told exactly how many entities to expect.
+  Entities that already exist are still found and reused.
+  \param n the number of elements
+  \param verts (n) rows of the element vertices, one after another
+  \param elements if non-zero, receives the (n) elements */
+void buildElements(
+    Mesh2* m,
+    ModelEntity* c,
+    int type,
+    int n,
+    MeshEntity** verts,
+    MeshEntity** elements = 0);
+
 /** \brief build a one-element mesh
   \details this is mostly useful for debugging
   \todo this doesn't get used much, maybe remove it */
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2025 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apfMesh.h"
+#include "apfNew.h"
+#include <gmi.h>
+#include <pcu_util.h>
+
+namespace apf {
+
+int Mesh::getModelType(ModelEntity* e)
+{
+  return gmi_dim(getModel(), (gmi_ent*)e);
+}
+
+int Mesh::getModelTag(ModelEntity* e)
+{
+  return gmi_tag(getModel(), (gmi_ent*)e);
+}
+
+ModelEntity* Mesh::findModelEntity(int type, int tag)
+{
+  return (ModelEntity*)gmi_find(getModel(), type, tag);
+}
+
+bool Mesh::canSnap()
+{
+  return gmi_can_eval(getModel());
+}
+
+bool Mesh::canGetClosestPoint()
+{
+  return gmi_can_get_closest_point(getModel());
+}
+
+bool Mesh::canGetModelNormal()
+{
+  return gmi_has_normal(getModel());
+}
+
+void Mesh::snapToModel(ModelEntity* m, Vector3 const& p, Vector3& x)
+{
+  gmi_eval(getModel(), (gmi_ent*)m, &p[0], &x[0]);
+}
+
+void Mesh::snapToModel(int n, ModelEntity* const* m, Vector3 const* p,
+    Vector3* x)
+{
+  if (!n)
+    return;
+  NewArray<double> params(2 * n);
+  NewArray<double> points(3 * n);
+  for (int i = 0; i < n; ++i) {
+    params[2 * i] = p[i][0];
+    params[2 * i + 1] = p[i][1];
+  }
+  gmi_eval_batch(getModel(), n, (gmi_ent* const*)m, &params[0], &points[0]);
+  for (int i = 0; i < n; ++i)
+    x[i] = Vector3(&points[3 * i]);
+}
+
+void Mesh::getParamOn(ModelEntity* g, MeshEntity* e, Vector3& p)
+{
+  ModelEntity* from_g = toModel(e);
+  if (g == from_g)
+    return getParam(e, p);
+  gmi_ent* from = (gmi_ent*)from_g;
+  gmi_ent* to = (gmi_ent*)g;
+  Vector3 from_p;
+  getParam(e, from_p);
+  gmi_reparam(getModel(), from, &from_p[0], to, &p[0]);
+}
+
+bool Mesh::getPeriodicRange(ModelEntity* g, int axis, double range[2])
+{
+  gmi_ent* e = (gmi_ent*)g;
+  gmi_range(getModel(), e, axis, range);
+  return gmi_periodic(getModel(), e, axis);
+}
+
+void Mesh::getClosestPoint(ModelEntity* g, Vector3 const& from,
+    Vector3& to, Vector3& p)
+{
+  gmi_ent* e = (gmi_ent*)g;
+  gmi_closest_point(getModel(),e,&from[0],&to[0],&p[0]);
+}
+
+void Mesh::getClosestPoint(int n, ModelEntity* const* g, Vector3 const* from,
+    Vector3* to, Vector3* p)
+{
+  if (!n)
+    return;
+  NewArray<double> points(3 * n);
+  NewArray<double> closest(3 * n);
+  NewArray<double> params(2 * n);
+  for (int i = 0; i < n; ++i)
+    from[i].toArray(&points[3 * i]);
+  gmi_closest_point_batch(getModel(), n, (gmi_ent* const*)g,
+      &points[0], &closest[0], &params[0]);
+  for (int i = 0; i < n; ++i) {
+    to[i] = Vector3(&closest[3 * i]);
+    p[i] = Vector3(params[2 * i], params[2 * i + 1], 0);
+  }
+}
+
+void Mesh::getNormal(ModelEntity* g, Vector3 const& p, Vector3& n)
+{
+  gmi_ent* e = (gmi_ent*)g;
+  gmi_normal(getModel(),e,&p[0],&n[0]);
+}
+
+void Mesh::getNormal(int n, ModelEntity* const* g, Vector3 const* p,
+    Vector3* normals)
+{
+  if (!n)
+    return;
+  NewArray<double> params(2 * n);
+  NewArray<double> results(3 * n);
+  for (int i = 0; i < n; ++i) {
+    params[2 * i] = p[i][0];
+    params[2 * i + 1] = p[i][1];
+  }
+  gmi_normal_batch(getModel(), n, (gmi_ent* const*)g,
+      &params[0], &results[0]);
+  for (int i = 0; i < n; ++i)
+    normals[i] = Vector3(&results[3 * i]);
+}
+
+void Mesh::getFirstDerivative(ModelEntity* g, Vector3 const& p,
+  Vector3& t0, Vector3& t1)
+{
+  gmi_ent* e = (gmi_ent*)g;
+  gmi_first_derivative(getModel(),e,&p[0], &t0[0], &t1[0]);
+}
+
+bool Mesh::isParamPointInsideModel(ModelEntity* g,
+    Vector3 const& param, Vector3& x)
+{
+  int dim = getModelType(g);
+  PCU_ALWAYS_ASSERT(dim == 1 || dim == 2);
+  gmi_ent* e = (gmi_ent*)g;
+  gmi_set* adjRegions = gmi_adjacent(getModel(), e, 3);
+  // for 2D models
+  if (adjRegions->n == 0)
+    return true;
+  PCU_ALWAYS_ASSERT(adjRegions->n <= 1);
+  gmi_ent* r = (gmi_ent*)adjRegions->e[0];
+  gmi_eval(getModel(), (gmi_ent*)g, &param[0], &x[0]);
+  int res = gmi_is_point_in_region(getModel(), r, &x[0]);
+  gmi_free_set(adjRegions);
+  return (res == 1) ? true : false;
+}
+
+bool Mesh::isInClosureOf(ModelEntity* g, ModelEntity* target){
+  // make sure that the dimension of target is greater or equal the
+  // dimension of the model entity to be checked.
+  PCU_ALWAYS_ASSERT(getModelType(target) >= getModelType(g));
+  gmi_ent* e  = (gmi_ent*)g;
+  gmi_ent* et = (gmi_ent*)target;
+  int res = gmi_is_in_closure_of(getModel(), e, et);
+  return (res == 1) ? true : false;
+}
+
+bool Mesh::isOnModel(ModelEntity* g, Vector3 p, double scale)
+{
+  Vector3 to;
+  double param[2];
+  gmi_ent* c = (gmi_ent*)g;
+  gmi_closest_point(getModel(), c, &p[0], &to[0], param);
+  double ratio = (to - p).getLength() / scale;
+  return ratio < 0.001;
+}
+
+}
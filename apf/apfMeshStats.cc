@@ -0,0 +1,207 @@
+/*
+ * Copyright 2025 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include <PCU.h>
+#include "apfMesh.h"
+#include <pcu_util.h>
+#include <climits>
+#include <cstdio>
+
+namespace apf {
+
+MeshCounters::MeshCounters()
+{
+  for (int q = 0; q < QUERIES; ++q)
+  for (int i = 0; i < 4; ++i)
+  for (int j = 0; j < 4; ++j)
+    counts[q][i][j] = 0;
+}
+
+void printMeshCounters(Mesh* m)
+{
+  static char const* const names[MeshCounters::QUERIES] = {
+    "getAdjacent",
+    "second order",
+    "getDownward",
+    "getUp",
+    "iterate",
+    "getPoint",
+    "tag get",
+    "tag set"};
+  MeshCounters sum;
+  if (m->getCounters())
+    sum = *(m->getCounters());
+  PCU_Add_Longs(&sum.counts[0][0][0], MeshCounters::QUERIES * 4 * 4);
+  if (PCU_Comm_Self())
+    return;
+  printf("mesh queries over %d parts, by entity dimension\n",
+      PCU_Comm_Peers());
+  printf("%-14s %4s %14s %14s %14s %14s\n", "query", "from",
+      "to 0", "to 1", "to 2", "to 3");
+  for (int q = 0; q < MeshCounters::QUERIES; ++q)
+    for (int i = 0; i < 4; ++i) {
+      long* c = sum.counts[q][i];
+      if (!(c[0] || c[1] || c[2] || c[3]))
+        continue;
+      printf("%-14s %4d %14ld %14ld %14ld %14ld\n",
+          names[q], i, c[0], c[1], c[2], c[3]);
+    }
+}
+
+/* layout of the reduced statistics: sums, then maxima,
+   the minimum being reduced as a negated maximum */
+enum {
+  STAT_COUNTS = 0,
+  STAT_TYPES = STAT_COUNTS + 4,
+  STAT_EMPTY = STAT_TYPES + Mesh::TYPES,
+  STAT_SUMS,
+  STAT_MAX_ELEMENTS = STAT_SUMS,
+  STAT_NEG_MIN_ELEMENTS,
+  STAT_VALUES
+};
+
+struct StatsReduction
+{
+  int dimension;
+  long values[STAT_VALUES];
+  PCU_Reduction reduction;
+};
+
+StatsReduction* beginStats(Mesh* m)
+{
+  StatsReduction* r = new StatsReduction();
+  const int dim = m->getDimension();
+  r->dimension = dim;
+  long* v = r->values;
+  for (int i = 0; i < STAT_VALUES; ++i)
+    v[i] = 0;
+  for (int d = 0; d <= dim; ++d)
+    v[STAT_COUNTS + d] = countOwned(m, d);
+  for (int t = 0; t < Mesh::TYPES; ++t)
+    if (Mesh::typeDimension[t] == dim)
+      v[STAT_TYPES + t] = m->countType(t);
+  long elements = m->count(dim);
+  v[STAT_EMPTY] = elements ? 0 : 1;
+  v[STAT_MAX_ELEMENTS] = elements;
+  v[STAT_NEG_MIN_ELEMENTS] = -elements;
+  r->reduction = PCU_Add_Max_Longs_Begin(v, STAT_SUMS, STAT_VALUES);
+  return r;
+}
+
+void endStats(StatsReduction* r, MeshStats& s)
+{
+  PCU_Reduction_Wait(r->reduction);
+  long* v = r->values;
+  s.dimension = r->dimension;
+  for (int d = 0; d < 4; ++d)
+    s.counts[d] = v[STAT_COUNTS + d];
+  for (int t = 0; t < Mesh::TYPES; ++t)
+    s.types[t] = v[STAT_TYPES + t];
+  s.emptyParts = v[STAT_EMPTY];
+  s.maxElements = v[STAT_MAX_ELEMENTS];
+  s.minElements = -v[STAT_NEG_MIN_ELEMENTS];
+  delete r;
+}
+
+void getStats(Mesh* m, MeshStats& s)
+{
+  endStats(beginStats(m), s);
+}
+
+static void printTypes(MeshStats const& s)
+{
+  const int dim = s.dimension;
+  if (dim==1) return;
+  PCU_ALWAYS_ASSERT(dim==2 || dim==3);
+  printf("number of");
+  for (int i=0; i<Mesh::TYPES; i++)
+    if (dim == Mesh::typeDimension[i])
+      printf(" %s %ld", Mesh::typeName[i], s.types[i]);
+  printf("\n");
+}
+
+void printStats(MeshStats const& s)
+{
+  if (PCU_Comm_Self())
+    return;
+  printTypes(s);
+  printf("mesh entity counts: v %ld e %ld f %ld r %ld\n",
+      s.counts[0], s.counts[1], s.counts[2], s.counts[3]);
+}
+
+void printStats(Mesh* m)
+{
+  MeshStats s;
+  getStats(m, s);
+  printStats(s);
+}
+
+MeshMemory::MeshMemory()
+{
+  for (int t = 0; t < Mesh::TYPES; ++t)
+    downward[t] = upward[t] = coordinates[t] = tags[t] =
+      remotes[t] = other[t] = 0;
+  idBytes = 0;
+}
+
+void Mesh::getMemoryUsage(MeshMemory&)
+{
+}
+
+void printMemoryUsage(Mesh* m)
+{
+  MeshMemory u;
+  m->getMemoryUsage(u);
+  const int categories = 6;
+  size_t* const parts[categories] = {u.downward, u.upward,
+    u.coordinates, u.tags, u.remotes, u.other};
+  const char* const names[categories] = {"downward", "upward",
+    "coordinates", "tags", "remotes", "other"};
+  long bytes[categories][Mesh::TYPES];
+  for (int i = 0; i < categories; ++i)
+    for (int t = 0; t < Mesh::TYPES; ++t)
+      bytes[i][t] = parts[i][t];
+  PCU_Add_Longs(&bytes[0][0], categories * Mesh::TYPES);
+  int idBytes = PCU_Max_Int(u.idBytes);
+  if (PCU_Comm_Self())
+    return;
+  printf("mesh memory in MB (entity ids of %d bytes):\n", idBytes);
+  printf("%12s", "");
+  for (int t = 0; t < Mesh::TYPES; ++t)
+    printf(" %9s", Mesh::typeName[t]);
+  printf(" %9s\n", "total");
+  long total = 0;
+  for (int i = 0; i < categories; ++i) {
+    long sum = 0;
+    printf("%12s", names[i]);
+    for (int t = 0; t < Mesh::TYPES; ++t) {
+      printf(" %9.2f", bytes[i][t] / 1e6);
+      sum += bytes[i][t];
+    }
+    printf(" %9.2f\n", sum / 1e6);
+    total += sum;
+  }
+  printf("%12s %.2f\n", "total", total / 1e6);
+}
+
+void warnAboutEmptyParts(Mesh* m)
+{
+  int emptyParts = 0;
+  if (!m->count(m->getDimension()))
+    ++emptyParts;
+  emptyParts = PCU_Add_Int(emptyParts);
+  if (emptyParts && (!PCU_Comm_Self()))
+    fprintf(stderr,"APF warning: %d empty parts\n",emptyParts);
+}
+
+void warnAboutEmptyParts(MeshStats const& s)
+{
+  if (s.emptyParts && (!PCU_Comm_Self()))
+    fprintf(stderr,"APF warning: %ld empty parts\n",s.emptyParts);
+}
+
+}
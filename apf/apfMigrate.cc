@@ -9,12 +9,18 @@
 #include "apfMesh2.h"
 #include "apfCavityOp.h"
 #include "apf.h"
+#include "apfMigrate.h"
 #include <pcu_util.h>
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
 
-namespace apf {
+#if __cplusplus < 201103L
+#error "threaded migration counters need C++11 std::atomic"
+#endif
 
-typedef std::vector<MeshEntity*> EntityVector;
+namespace apf {
 
 /* Starting from the elements in the plan,
    constructs their closure (including all
@@ -28,15 +34,12 @@ static void getAffected(
 {
   int maxDimension = m->getDimension();
   int self = PCU_Comm_Self();
-  affected[maxDimension].reserve(plan->count());
-  for (int i=0; i < plan->count(); ++i)
-  {
-    MeshEntity* e = plan->get(i);
-    if (plan->sending(e) != self) {
-      PCU_ALWAYS_ASSERT(apf::getDimension(m, e) == m->getDimension());
-      affected[maxDimension].push_back(e);
-    }
-  }
+  EntityVector planned;
+  getPlanned(m,plan,planned);
+  affected[maxDimension].reserve(planned.size());
+  APF_ITERATE(EntityVector,planned,it)
+    if (plan->sending(*it) != self)
+      affected[maxDimension].push_back(*it);
   int dummy;
   MeshTag* tag = m->createIntTag("apf_migrate_affected",1);
   for (int dimension=maxDimension-1; dimension >= 0; --dimension)
@@ -85,6 +88,26 @@ static void getAffected(
   m->destroyTag(tag);
 }
 
+void getPlanned(Mesh* m, Migration* plan, EntityVector& elements)
+{
+  if (plan->sendingAll() == -1)
+  {
+    elements.reserve(plan->count());
+    for (int i=0; i < plan->count(); ++i)
+    {
+      PCU_ALWAYS_ASSERT(getDimension(m, plan->get(i)) == m->getDimension());
+      elements.push_back(plan->get(i));
+    }
+    return;
+  }
+  elements.reserve(m->count(m->getDimension()));
+  MeshIterator* it = m->begin(m->getDimension());
+  MeshEntity* e;
+  while ((e = m->iterate(it)))
+    elements.push_back(e);
+  m->end(it);
+}
+
 /* gets the subset of the closure copies
    which are owned by this part */
 void getSenders(
@@ -194,9 +217,10 @@ static void updateResidences(
     EntityVector affected[4])
 {
   int maxDimension = m->getDimension();
-  for (int i=0; i < plan->count(); ++i)
+  /* elements staying here keep their residence */
+  APF_ITERATE(EntityVector,affected[maxDimension],it)
   {
-    MeshEntity* e = plan->get(i);
+    MeshEntity* e = *it;
     Parts res = makeResidence(plan->sending(e));
     m->setResidence(e,res);
   }
@@ -309,7 +333,7 @@ MeshEntity* unpackVertex(
   return m->createVertex(c,point,param);
 }
 
-static void packReference(
+static MeshEntity* getReference(
     Mesh2* m,
     int to,
     MeshEntity* e)
@@ -318,19 +342,12 @@ static void packReference(
   m->getRemotes(e,remotes);
   Copies::iterator found = remotes.find(to);
   if (found!=remotes.end())
-  {
-    MeshEntity* remote = found->second;
-    PCU_COMM_PACK(to,remote);
-  }
-  else
-  {
-    Copies ghosts;
-    m->getGhosts(e,ghosts);
-    found = ghosts.find(to);
-    PCU_ALWAYS_ASSERT(found!=ghosts.end());
-    MeshEntity* ghost = found->second;
-    PCU_COMM_PACK(to,ghost);
-  }
+    return found->second;
+  Copies ghosts;
+  m->getGhosts(e,ghosts);
+  found = ghosts.find(to);
+  PCU_ALWAYS_ASSERT(found!=ghosts.end());
+  return found->second;
 }
 
 static void packDownward(Mesh2* m, int to, MeshEntity* e)
@@ -338,9 +355,11 @@ static void packDownward(Mesh2* m, int to, MeshEntity* e)
   Downward down;
   int d = getDimension(m, e);
   int n = m->getDownward(e,d-1,down);
-  PCU_COMM_PACK(to,n);
   for (int i=0; i < n; ++i)
-    packReference(m,to,down[i]);
+    down[i] = getReference(m,to,down[i]);
+  char* p = PCU_COMM_RESERVE(to, char, sizeof(n) + n * sizeof(MeshEntity*));
+  memcpy(p, &n, sizeof(n));
+  memcpy(p + sizeof(n), down, n * sizeof(MeshEntity*));
 }
 
 static void unpackDownward(
@@ -348,8 +367,7 @@ static void unpackDownward(
 {
   int n;
   PCU_COMM_UNPACK(n);
-  for (int i=0; i < n; ++i)
-    PCU_COMM_UNPACK(entities[i]);
+  PCU_Comm_Unpack(entities, n * sizeof(MeshEntity*));
 }
 
 static void packNonVertex(
@@ -401,6 +419,12 @@ static void packTags(
         m->getIntTag(e,tag,&(d[0]));
         PCU_Comm_Pack(to,&(d[0]),size*sizeof(int));
       }
+      if (type == Mesh2::LONG)
+      {
+        DynamicArray<long> d(size);
+        m->getLongTag(e,tag,&(d[0]));
+        PCU_Comm_Pack(to,&(d[0]),size*sizeof(long));
+      }
     }
   }
 }
@@ -466,6 +490,12 @@ void unpackTags(
       PCU_Comm_Unpack(&(d[0]),size*sizeof(int));
       m->setIntTag(e,tag,&(d[0]));
     }
+    if (type == Mesh2::LONG)
+    {
+      DynamicArray<long> d(size);
+      PCU_Comm_Unpack(&(d[0]),size*sizeof(long));
+      m->setLongTag(e,tag,&(d[0]));
+    }
   }
 }
 
@@ -516,11 +546,14 @@ static MeshEntity* unpackEntity(
 static void sendEntities(
     Mesh2* m,
     EntityVector& senders,
-    DynamicArray<MeshTag*>& tags)
+    size_t first,
+    size_t last,
+    DynamicArray<MeshTag*>& tags,
+    Frozen* fz)
 {
-  APF_ITERATE(EntityVector,senders,it)
+  for (size_t i = first; i < last; ++i)
   {
-    MeshEntity* entity = *it;
+    MeshEntity* entity = senders[i];
     Copies remotes;
     m->getRemotes(entity,remotes);
     Parts residence;
@@ -528,18 +561,28 @@ static void sendEntities(
     Parts sendTo;
     split(remotes,residence,sendTo);
     APF_ITERATE(Parts,sendTo,sit)
+    {
       packEntity(m,*sit,entity,tags);
+      if (fz)
+        packFrozen(*sit,entity,*fz);
+    }
   }
 }
 
 static void receiveEntities(
     Mesh2* m,
     DynamicArray<MeshTag*>& tags,
-    EntityVector& received)
+    EntityVector& received,
+    Frozen* fz)
 {
   received.reserve(1024);
   while (PCU_Comm_Receive())
-    received.push_back(unpackEntity(m,tags));
+  {
+    MeshEntity* e = unpackEntity(m,tags);
+    if (fz)
+      unpackFrozen(m,e,*fz);
+    received.push_back(e);
+  }
 }
 
 static void echoRemotes(
@@ -674,24 +717,49 @@ static void setupRemotes(
   bcastRemotes(m,senders);
 }
 
-void moveEntities(
+const size_t maxMigrationLimit = 10*1000*1000;
+static size_t migrationLimit = maxMigrationLimit;
+
+/* each dimension is sent in batches of at most migrationLimit
+   entities per part to bound the message buffers, since the
+   closure of the elements of one round may be larger than the
+   limit. Entities of one dimension only refer to those of lower
+   dimensions, so remote copies are set up once after all batches
+   arrive */
+static void moveEntities(
     Mesh2* m,
-    EntityVector senders[4])
+    EntityVector senders[4],
+    Frozen* fz)
 {
   DynamicArray<MeshTag*> tags;
   m->getTags(tags);
   int maxDimension = m->getDimension();
   for (int dimension = 0; dimension <= maxDimension; ++dimension)
   {
-    PCU_Comm_Begin();
-    sendEntities(m,senders[dimension],tags);
-    PCU_Comm_Send();
+    EntityVector& s = senders[dimension];
+    size_t batches = (s.size() + migrationLimit - 1) / migrationLimit;
+    batches = PCU_Max_SizeT(batches);
     EntityVector received;
-    receiveEntities(m,tags,received);
-    setupRemotes(m,received,senders[dimension]);
+    for (size_t b = 0; b < batches; ++b)
+    {
+      size_t first = std::min(b * migrationLimit, s.size());
+      size_t last = std::min(first + migrationLimit, s.size());
+      PCU_Comm_Begin();
+      sendEntities(m,s,first,last,tags,fz);
+      PCU_Comm_Send();
+      receiveEntities(m,tags,received,fz);
+    }
+    setupRemotes(m,received,s);
   }
 }
 
+void moveEntities(
+    Mesh2* m,
+    EntityVector senders[4])
+{
+  moveEntities(m,senders,0);
+}
+
 /* before this call senders are matched to one another
    an no one else, and they each have the correct remote copies
    for their abstract entity.
@@ -838,25 +906,37 @@ void deleteOldEntities(
     }
 }
 
+/* threads of PCU_Thrd_Run may migrate at once */
+static std::atomic<long> migratedElements(0);
+
+long countMigratedElements()
+{
+  return migratedElements;
+}
+
 /* this is the main migration routine */
 static void migrate1(Mesh2* m, Migration* plan)
 {
+  Frozen frozen;
+  bool hasFrozen = m->hasFrozenFields;
+  if (hasFrozen)
+    beginFrozen(m,frozen);
   EntityVector affected[4];
   getAffected(m,plan,affected);
+  migratedElements += affected[m->getDimension()].size();
   EntityVector senders[4];
   getSenders(m,affected,senders);
   reduceMatchingToSenders(m,senders);
   updateResidences(m,plan,affected);
   delete plan;
-  moveEntities(m,senders);
+  moveEntities(m,senders,hasFrozen ? &frozen : 0);
   updateMatching(m,affected,senders);
   deleteOldEntities(m,affected);
   m->acceptChanges();
+  if (hasFrozen)
+    endFrozen(m,frozen);
 }
 
-const size_t maxMigrationLimit = 10*1000*1000;
-static size_t migrationLimit = maxMigrationLimit;
-
 void setMigrationLimit(size_t maxElements)
 {
   if( maxElements >= maxMigrationLimit ) {
@@ -872,14 +952,13 @@ void setMigrationLimit(size_t maxElements)
    to limit peak memory use */
 static void migrate2(Mesh2* m, Migration* plan)
 {
+  int self = PCU_Comm_Self();
+  EntityVector planned;
+  getPlanned(m, plan, planned);
   std::vector<std::pair<MeshEntity*, int> > tmp;
-  tmp.resize(plan->count());
-  for (size_t i = 0; i < tmp.size(); ++i)
-  {
-    MeshEntity* e = plan->get(i);
-    tmp[i].first = e;
-    tmp[i].second = plan->sending(e);
-  }
+  APF_ITERATE(EntityVector, planned, it)
+    if (plan->sending(*it) != self)
+      tmp.push_back(std::make_pair(*it, plan->sending(*it)));
   delete plan;
   size_t sent = 0;
   while (PCU_Or(sent < tmp.size()))
@@ -893,9 +972,19 @@ static void migrate2(Mesh2* m, Migration* plan)
   }
 }
 
+static size_t countLeaving(Mesh2* m, Migration* plan)
+{
+  if (plan->sendingAll() == -1)
+    return plan->count();
+  if (plan->sendingAll() == PCU_Comm_Self())
+    return 0;
+  return m->count(m->getDimension());
+}
+
 void migrateSilent(Mesh2* m, Migration* plan)
 {
-  if (PCU_Or(static_cast<size_t>(plan->count()) > migrationLimit))
+  PCU_Region region("apf::migrate");
+  if (PCU_Or(countLeaving(m, plan) > migrationLimit))
     migrate2(m, plan);
   else
     migrate1(m, plan);
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2025 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef APFMIGRATE_H
+#define APFMIGRATE_H
+
+#include "apfMesh2.h"
+#include "apfField.h"
+#include <vector>
+
+namespace apf {
+
+/* the elements (plan) gives a destination, which are all of
+   them when it sends every element to one part */
+void getPlanned(Mesh* m, Migration* plan, EntityVector& elements);
+
+/* the values of array-stored fields carried through a migration.
+   Entities with nodes of these fields get an index in the stage
+   tag, and each field keeps their values at offsets[index] */
+struct FrozenField
+{
+  Field* field;
+  std::vector<double> values;
+  std::vector<size_t> offsets;
+};
+
+struct Frozen
+{
+  MeshTag* stage;
+  int count;
+  std::vector<FrozenField> fields;
+};
+
+void beginFrozen(Mesh2* m, Frozen& fz);
+void packFrozen(int to, MeshEntity* e, Frozen& fz);
+void unpackFrozen(Mesh2* m, MeshEntity* e, Frozen& fz);
+void endFrozen(Mesh2* m, Frozen& fz);
+
+}
+
+#endif
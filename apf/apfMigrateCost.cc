@@ -0,0 +1,150 @@
+/*
+ * Copyright 2025 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include <PCU.h>
+#include "apfMigrate.h"
+#include "apf.h"
+#include <algorithm>
+#include <map>
+
+namespace apf {
+
+/* the bytes packEntity would use for (e), except its
+   residence, which is not known before migrating */
+static long packedSize(Mesh2* m, MeshEntity* e,
+    DynamicArray<MeshTag*>& tags)
+{
+  long n = sizeof(int) + sizeof(MeshEntity*) + 2 * sizeof(int)
+         + sizeof(size_t) + sizeof(int);
+  if (m->getType(e) == Mesh::VERTEX)
+    n += 2 * sizeof(Vector3);
+  else {
+    Downward down;
+    n += sizeof(int) + m->getDownward(e, getDimension(m, e) - 1, down)
+       * sizeof(MeshEntity*);
+  }
+  n += sizeof(size_t);
+  for (size_t i = 0; i < tags.getSize(); ++i) {
+    MeshTag* tag = tags[i];
+    if (!m->hasTag(e, tag))
+      continue;
+    n += sizeof(size_t);
+    int type = m->getTagType(tag);
+    if (type == Mesh2::DOUBLE)
+      n += m->getTagSize(tag) * sizeof(double);
+    if (type == Mesh2::INT)
+      n += m->getTagSize(tag) * sizeof(int);
+    if (type == Mesh2::LONG)
+      n += m->getTagSize(tag) * sizeof(long);
+  }
+  return n;
+}
+
+typedef std::pair<int, MeshEntity*> Delivery;
+typedef std::vector<Delivery> Deliveries;
+typedef std::map<int, long> PartCounts;
+
+void estimateMigration(Mesh2* m, Migration* plan,
+    MigrationCost& local, MigrationCost& max)
+{
+  int self = PCU_Comm_Self();
+  int dim = m->getDimension();
+  DynamicArray<MeshTag*> tags;
+  m->getTags(tags);
+  /* each closure entity of a leaving element, once per destination */
+  EntityVector elements;
+  getPlanned(m, plan, elements);
+  Deliveries deliveries;
+  APF_ITERATE(EntityVector, elements, eit) {
+    MeshEntity* e = *eit;
+    int to = plan->sending(e);
+    if (to == self)
+      continue;
+    deliveries.push_back(Delivery(to, e));
+    for (int d = 0; d < dim; ++d) {
+      Downward down;
+      int n = m->getDownward(e, d, down);
+      for (int j = 0; j < n; ++j)
+        deliveries.push_back(Delivery(to, down[j]));
+    }
+  }
+  std::sort(deliveries.begin(), deliveries.end());
+  deliveries.erase(std::unique(deliveries.begin(), deliveries.end()),
+      deliveries.end());
+  PartCounts bytes;
+  PartCounts counts;
+  EntityVector leaving;
+  APF_ITERATE(Deliveries, deliveries, it) {
+    int to = it->first;
+    MeshEntity* e = it->second;
+    leaving.push_back(e);
+    Copies remotes;
+    m->getRemotes(e, remotes);
+    if (remotes.count(to))
+      continue;
+    bytes[to] += packedSize(m, e, tags);
+    ++counts[to];
+  }
+  /* an entity leaves once none of its adjacent elements stays.
+     Shared ones may be sent back by another part, so only the
+     unshared ones are sure to go */
+  std::sort(leaving.begin(), leaving.end());
+  leaving.erase(std::unique(leaving.begin(), leaving.end()), leaving.end());
+  long left = 0;
+  APF_ITERATE(EntityVector, leaving, it) {
+    MeshEntity* e = *it;
+    if (m->isShared(e))
+      continue;
+    bool stays = false;
+    if (getDimension(m, e) == dim) {
+      stays = plan->sending(e) == self;
+    } else {
+      Adjacent elements;
+      m->getAdjacent(e, dim, elements);
+      for (size_t i = 0; i < elements.getSize() && !stays; ++i)
+        stays = !plan->has(elements[i]) || plan->sending(elements[i]) == self;
+    }
+    if (!stays)
+      ++left;
+  }
+  Parts neighbors;
+  getPeers(m, 0, neighbors);
+  local.sendBytes = 0;
+  local.receiveBytes = 0;
+  local.entities = 0;
+  for (int d = 0; d <= dim; ++d)
+    local.entities += m->count(d);
+  local.entities -= left;
+  PCU_Comm_Begin();
+  APF_ITERATE(PartCounts, bytes, it) {
+    local.sendBytes += it->second;
+    neighbors.insert(it->first);
+    PCU_COMM_PACK(it->first, it->second);
+    PCU_COMM_PACK(it->first, counts[it->first]);
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    long b;
+    long c;
+    PCU_COMM_UNPACK(b);
+    PCU_COMM_UNPACK(c);
+    local.receiveBytes += b;
+    local.entities += c;
+    neighbors.insert(PCU_Comm_Sender());
+  }
+  neighbors.erase(self);
+  local.neighbors = neighbors.size();
+  size_t values[4] = {size_t(local.sendBytes), size_t(local.receiveBytes),
+    size_t(local.entities), size_t(local.neighbors)};
+  PCU_Max_SizeTs(values, 4);
+  max.sendBytes = values[0];
+  max.receiveBytes = values[1];
+  max.entities = values[2];
+  max.neighbors = values[3];
+}
+
+}//namespace apf
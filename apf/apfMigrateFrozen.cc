@@ -0,0 +1,165 @@
+/*
+ * Copyright 2025 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include <PCU.h>
+#include "apfMigrate.h"
+#include "apfArrayData.h"
+#include "apfNumbering.h"
+#include <cstring>
+#include <set>
+
+namespace apf {
+
+static const size_t noValues = static_cast<size_t>(-1);
+
+/* frozen values follow the entity in its message, with no
+   per-field headers since the receiver knows the counts */
+void packFrozen(int to, MeshEntity* e, Frozen& fz)
+{
+  std::vector<double> values;
+  for (size_t i = 0; i < fz.fields.size(); ++i) {
+    Field* f = fz.fields[i].field;
+    int n = f->countValuesOn(e);
+    if (!n)
+      continue;
+    size_t at = values.size();
+    values.resize(at + n);
+    f->getData()->get(e, &(values[at]));
+  }
+  if (!values.empty())
+    PCU_Comm_Pack(to, &(values[0]), values.size() * sizeof(double));
+}
+
+static void stage(Mesh2* m, MeshEntity* e, Frozen& fz)
+{
+  int k = fz.count++;
+  m->setIntTag(e, fz.stage, &k);
+  for (size_t i = 0; i < fz.fields.size(); ++i)
+    fz.fields[i].offsets.resize(fz.count, noValues);
+}
+
+void unpackFrozen(Mesh2* m, MeshEntity* e, Frozen& fz)
+{
+  stage(m, e, fz);
+  for (size_t i = 0; i < fz.fields.size(); ++i) {
+    FrozenField& ff = fz.fields[i];
+    int n = ff.field->countValuesOn(e);
+    if (!n)
+      continue;
+    ff.offsets.back() = ff.values.size();
+    double const* in = PCU_COMM_EXTRACT(double, n);
+    ff.values.insert(ff.values.end(), in, in + n);
+  }
+}
+
+/* mesh changes would otherwise unfreeze these fields */
+void beginFrozen(Mesh2* m, Frozen& fz)
+{
+  for (int i = 0; i < m->countFields(); ++i) {
+    Field* f = m->getField(i);
+    if ( ! isFrozen(f))
+      continue;
+    fz.fields.push_back(FrozenField());
+    fz.fields.back().field = f;
+  }
+  fz.count = 0;
+  fz.stage = m->createIntTag("apf_frozen_stage", 1);
+  m->hasFrozenFields = false;
+}
+
+/* all values, received or kept, are read from the stage */
+class StagedData : public FieldDataOf<double>
+{
+  public:
+    StagedData(Mesh* m, Frozen& fz, FrozenField& ff):
+      mesh(m),frozen(fz),staged(ff)
+    {
+    }
+    virtual void init(FieldBase* f) {this->field = f;}
+    virtual bool hasEntity(MeshEntity* e)
+    {
+      if ( ! mesh->hasTag(e, frozen.stage))
+        return false;
+      return staged.offsets[index(e)] != noValues;
+    }
+    virtual void removeEntity(MeshEntity*) {}
+    virtual void get(MeshEntity* e, double* data)
+    {
+      int n = staged.field->countValuesOn(e);
+      double const* v = &(staged.values[staged.offsets[index(e)]]);
+      for (int i = 0; i < n; ++i)
+        data[i] = v[i];
+    }
+    virtual void set(MeshEntity*, double const*)
+    {
+      fail("staged migration data is read only");
+    }
+    virtual bool isFrozen() {return false;}
+    virtual FieldData* clone() {return 0;}
+  private:
+    int index(MeshEntity* e)
+    {
+      int k;
+      mesh->getIntTag(e, frozen.stage, &k);
+      return k;
+    }
+    Mesh* mesh;
+    Frozen& frozen;
+    FrozenField& staged;
+};
+
+/* entities that stayed still index the old arrays through
+   the old numberings, so their values are staged before
+   the numberings are replaced. Fields frozen with a
+   caller's numbering come back with the shape's own one */
+void endFrozen(Mesh2* m, Frozen& fz)
+{
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    bool hasNodes = false;
+    for (size_t i = 0; i < fz.fields.size(); ++i)
+      hasNodes = hasNodes ||
+        fz.fields[i].field->getShape()->hasNodesIn(d);
+    if (!hasNodes)
+      continue;
+    MeshIterator* it = m->begin(d);
+    MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      if (m->hasTag(e, fz.stage))
+        continue;
+      stage(m, e, fz);
+      for (size_t i = 0; i < fz.fields.size(); ++i) {
+        FrozenField& ff = fz.fields[i];
+        int n = ff.field->countValuesOn(e);
+        if (!n)
+          continue;
+        ff.offsets.back() = ff.values.size();
+        ff.values.resize(ff.values.size() + n);
+        ff.field->getData()->get(e, &(ff.values[ff.offsets.back()]));
+      }
+    }
+    m->end(it);
+  }
+  std::set<Numbering*> old;
+  for (size_t i = 0; i < fz.fields.size(); ++i) {
+    Numbering* n = getArrayNumbering(fz.fields[i].field);
+    if (!strcmp(getName(n), getShape(fz.fields[i].field)->getName()))
+      old.insert(n);
+  }
+  APF_ITERATE(std::set<Numbering*>, old, it)
+    destroyNumbering(*it);
+  for (size_t i = 0; i < fz.fields.size(); ++i) {
+    StagedData staged(m, fz, fz.fields[i]);
+    staged.init(fz.fields[i].field);
+    freezeFieldData<double>(fz.fields[i].field, 0, &staged);
+  }
+  for (int d = 0; d <= m->getDimension(); ++d)
+    removeTagFromDimension(m, fz.stage, d);
+  m->destroyTag(fz.stage);
+  m->hasFrozenFields = true;
+}
+
+}//namespace apf
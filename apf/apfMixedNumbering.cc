@@ -5,13 +5,15 @@
  * BSD license as described in the LICENSE file in the top-level directory.
  */
 
-#include "apfNumbering.h"
+#include "apfMixedNumbering.h"
 #include "apfNumberingClass.h"
+#include "apfFieldData.h"
 #include "apfShape.h"
 #include <PCU.h>
 #include <sstream>
 #include <pcu_util.h>
 #include <list>
+#include <cstring>
 
 namespace apf {
 
@@ -321,4 +323,218 @@ void makeGlobal(
   globalize(dofs, owned, global);
 }
 
+/* the owned entities carrying nodes of any field, in the order
+   number_owned visits them */
+static void get_owned_ents(
+    Mesh* m,
+    Sharing* shr,
+    std::vector<FieldShape*> const& shapes,
+    int hdim,
+    std::vector<MeshEntity*>& ents) {
+  MeshTag* seen = m->createIntTag("mixed_seen", 1);
+  int one = 1;
+  MeshEntity* vtx = 0;
+  MeshIterator* verts = m->begin(0);
+  Adjacent adjacent;
+  while ((vtx = m->iterate(verts))) {
+    for (int d=0; d <= hdim; ++d) {
+      if (d == 0) {
+        adjacent.setSize(1);
+        adjacent[0] = vtx;
+      } else
+        m->getAdjacent(vtx, d, adjacent);
+      APF_ITERATE(Adjacent, adjacent, ent) {
+        if (m->hasTag(*ent, seen) || (! shr->isOwned(*ent)))
+          continue;
+        m->setIntTag(*ent, seen, &one);
+        int type = m->getType(*ent);
+        for (size_t f=0; f < shapes.size(); ++f)
+          if (shapes[f]->countNodesOn(type)) {
+            ents.push_back(*ent);
+            break;
+          }
+      }
+    }
+  }
+  m->end(verts);
+  for (int d=0; d <= hdim; ++d)
+    removeTagFromDimension(m, seen, d);
+  m->destroyTag(seen);
+}
+
+static void number_global_ent(
+    long* idx,
+    MeshEntity* ent,
+    std::vector<int> const& comps,
+    std::vector<FieldShape*> const& shapes,
+    std::vector<GlobalNumbering*>& global,
+    bool blocked) {
+  int type = getMesh(global[0])->getType(ent);
+  for (size_t f=0; f < global.size(); ++f) {
+    long& i = blocked ? idx[f] : idx[0];
+    int nnodes = shapes[f]->countNodesOn(type);
+    for (int n=0; n < nnodes; ++n)
+      for (int c=0; c < comps[f]; ++c)
+        number(global[f], Node(ent, n), i++, c);
+  }
+}
+
+/* one message per shared entity carries the numbers of all fields */
+static void send_global(
+    Sharing* shr,
+    std::vector<MeshEntity*> const& ents,
+    std::vector<GlobalNumbering*>& global) {
+  Mesh* m = getMesh(global[0]);
+  NewArray<long> values;
+  PCU_Comm_Begin();
+  for (size_t i=0; i < ents.size(); ++i) {
+    MeshEntity* e = ents[i];
+    CopyArray copies;
+    shr->getCopies(e, copies);
+    Copies ghosts;
+    m->getGhosts(e, ghosts);
+    if ((! copies.getSize()) && ghosts.empty())
+      continue;
+    std::vector<long> all;
+    for (size_t f=0; f < global.size(); ++f) {
+      FieldDataOf<long>* data = global[f]->getData();
+      if (! data->hasEntity(e))
+        continue;
+      int n = global[f]->countValuesOn(e);
+      values.resize(n);
+      data->get(e, &values[0]);
+      all.insert(all.end(), &values[0], &values[0] + n);
+    }
+    size_t bytes = all.size() * sizeof(long);
+    for (size_t j=0; j < copies.getSize(); ++j) {
+      PCU_COMM_PACK(copies[j].peer, copies[j].entity);
+      PCU_Comm_Pack(copies[j].peer, &all[0], bytes);
+    }
+    APF_ITERATE(Copies, ghosts, it) {
+      PCU_COMM_PACK(it->first, it->second);
+      PCU_Comm_Pack(it->first, &all[0], bytes);
+    }
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    MeshEntity* e;
+    PCU_COMM_UNPACK(e);
+    int type = m->getType(e);
+    for (size_t f=0; f < global.size(); ++f) {
+      if (! global[f]->getShape()->countNodesOn(type))
+        continue;
+      int n = global[f]->countValuesOn(e);
+      long const* in = PCU_COMM_EXTRACT(long, n);
+      global[f]->getData()->set(e, in);
+    }
+  }
+}
+
+long numberGlobal(
+    std::vector<Field*> const& fields,
+    std::vector<GlobalNumbering*>& global,
+    MixedLayout layout) {
+  verify_fields(fields);
+  std::vector<int> comps;
+  std::vector<FieldShape*> shapes;
+  get_components(fields, comps);
+  get_shapes(fields, shapes);
+  Mesh* m = getMesh(fields[0]);
+  global.resize(fields.size());
+  for (size_t f=0; f < fields.size(); ++f) {
+    std::string name = getName(fields[f]);
+    name += "_global";
+    global[f] = createGlobalNumbering(m, name.c_str(), shapes[f], comps[f]);
+  }
+  Sharing* shr = m->getCachedSharing();
+  std::vector<MeshEntity*> ents;
+  get_owned_ents(m, shr, shapes, get_highest_dof_dim(fields, shapes), ents);
+  std::vector<long> counts(fields.size(), 0);
+  for (size_t i=0; i < ents.size(); ++i) {
+    int type = m->getType(ents[i]);
+    for (size_t f=0; f < fields.size(); ++f)
+      counts[f] += shapes[f]->countNodesOn(type) * comps[f];
+  }
+  long dofs = 0;
+  std::vector<long> idx(fields.size());
+  for (size_t f=0; f < fields.size(); ++f) {
+    idx[f] = dofs;
+    dofs += counts[f];
+  }
+  long start = PCU_Exscan_Long(dofs);
+  for (size_t f=0; f < fields.size(); ++f)
+    idx[f] += start;
+  bool blocked = (layout == FIELD_BLOCKED);
+  for (size_t i=0; i < ents.size(); ++i)
+    number_global_ent(&idx[0], ents[i], comps, shapes, global, blocked);
+  send_global(shr, ents, global);
+  return dofs;
+}
+
+namespace {
+
+/* the element numbers of all fields in getElementNumbers order,
+   each with the entity holding its node */
+struct MixedElementDofs : public ElementDofs
+{
+  MixedElementDofs(std::vector<GlobalNumbering*> const& gn):n(gn) {}
+  void get(MeshEntity* e, std::vector<long>& numbers,
+      std::vector<MeshEntity*>& ents)
+  {
+    getElementNumbers(n, e, numbers);
+    ents.clear();
+    Mesh* m = getMesh(n[0]);
+    int dim = getDimension(m, e);
+    for (size_t f=0; f < n.size(); ++f) {
+      FieldShape* s = getShape(n[f]);
+      int comps = countComponents(n[f]);
+      for (int d=0; d <= dim; ++d) {
+        if (! s->hasNodesIn(d))
+          continue;
+        Downward a;
+        int na = m->getDownward(e, d, a);
+        for (int i=0; i < na; ++i)
+          ents.insert(ents.end(),
+              s->countNodesOn(m->getType(a[i])) * comps, a[i]);
+      }
+    }
+  }
+  std::vector<GlobalNumbering*> const& n;
+};
+
+}
+
+void getMixedGraph(
+    std::vector<GlobalNumbering*> const& global,
+    NodeGraph& g) {
+  Mesh* m = getMesh(global[0]);
+  Sharing* shr = m->getCachedSharing();
+  long owned = 0;
+  long first = -1;
+  for (size_t f=0; f < global.size(); ++f) {
+    FieldShape* s = getShape(global[f]);
+    int comps = countComponents(global[f]);
+    for (int d=0; d < 4; ++d) {
+      if (! s->hasNodesIn(d))
+        continue;
+      MeshIterator* it = m->begin(d);
+      MeshEntity* e;
+      while ((e = m->iterate(it)))
+        if (shr->isOwned(e))
+          for (int i=0; i < global[f]->countNodesOn(e); ++i)
+            for (int c=0; c < comps; ++c) {
+              long k = getNumber(global[f], Node(e, i), c);
+              if (first == -1 || k < first)
+                first = k;
+              ++owned;
+            }
+      m->end(it);
+    }
+  }
+  if (first == -1)
+    first = 0;
+  MixedElementDofs dofs(global);
+  buildNodeGraph(m, shr, dofs, owned, first, g);
+}
+
 }
@@ -14,6 +14,7 @@
   * in std::vector. */
 
 #include "apf.h"
+#include "apfNumbering.h"
 #include <vector>
 
 namespace apf {
@@ -71,6 +72,41 @@ void makeGlobal(
     std::vector<Numbering*>& owned,
     std::vector<GlobalNumbering*>& global);
 
+/** \brief How numberGlobal orders the dofs of several fields. */
+enum MixedLayout {
+  /** \brief all the dofs of an entity are consecutive, field
+    * after field, so the dofs of a node stay together */
+  NODE_INTERLEAVED,
+  /** \brief the part's dofs of each field are consecutive,
+    * so each field is one block of the part's rows */
+  FIELD_BLOCKED
+};
+
+/** \brief Globally number the nodes of multiple fields in one pass.
+  * \details This replaces numberOwned, makeGlobal and a synchronize
+  * per field: the owned entities are walked once in the order of
+  * numberOwned, one exscan offsets the part's range, and one exchange
+  * sends the numbers of all fields to the copies and ghosts.
+  * Collective.
+  * \param fields The input fields to be numbered.
+  * \param global The output global numberings, one per field.
+  * \param layout How the dofs of the fields are interleaved.
+  * \returns The number of on-part owned dofs across all fields. */
+long numberGlobal(
+    std::vector<Field*> const& fields,
+    std::vector<GlobalNumbering*>& global,
+    MixedLayout layout = NODE_INTERLEAVED);
+
+/** \brief Get the sparsity pattern coupling the dofs of mixed fields.
+  * \details The rows are the dofs owned by this part under the
+  * global numberings, as from numberGlobal, and two dofs couple
+  * when they share an element. Collective.
+  * \param global The input global numberings.
+  * \param g The output graph, as from getNodeGraph. */
+void getMixedGraph(
+    std::vector<GlobalNumbering*> const& global,
+    NodeGraph& g);
+
 }
 
 #endif
@@ -13,6 +13,8 @@
 #include "apfShape.h"
 #include "apfTagData.h"
 #include <pcu_util.h>
+#include <algorithm>
+#include <vector>
 
 namespace apf {
 
@@ -255,13 +257,9 @@ Numbering* numberNodes(
 Numbering* numberOwnedDimension(Mesh* mesh, const char* name, int dim,
     Sharing* shr)
 {
-  bool delete_shr=false;
-  if (!shr) 
-  {
-    shr = getSharing(mesh);
-    delete_shr=true;
-  }
-  return numberNodes(mesh, name, getConstant(dim), shr, delete_shr);
+  if (!shr)
+    shr = mesh->getCachedSharing();
+  return numberNodes(mesh, name, getConstant(dim), shr, false);
 }
 
 Numbering* numberOverlapDimension(Mesh* mesh, const char* name, int dim)
@@ -292,13 +290,9 @@ Numbering* numberOwnedNodes(
 {
   if (!s)
     s = mesh->getShape();
-  bool delete_shr=false;
   if (!shr)
-  {
-    shr = getSharing(mesh);
-    delete_shr=true;
-  }
-  return numberNodes(mesh, name, s, shr, delete_shr);
+    shr = mesh->getCachedSharing();
+  return numberNodes(mesh, name, s, shr, false);
 }
 
 class Counter : public FieldOp
@@ -438,13 +432,11 @@ void getNodesOnClosure(
   if (!sh)
     sh = m->getShape();
   int d = m->getModelType(me);
-  MeshIterator* it = m->begin(d);
-  MeshEntity* e;
+  std::vector<MeshEntity*> classified;
+  m->getClassified(me, d, classified);
   EntitySet s;
-  while ((e = m->iterate(it)))
-    if (m->toModel(e) == me)
-      getClosureEntitiesWithNodes(m, e, s, sh);
-  m->end(it);
+  for (size_t i = 0; i < classified.size(); ++i)
+    getClosureEntitiesWithNodes(m, classified[i], s, sh);
   synchronizeEntitySet(m, s);
   getNodesOnEntitySet(m, s, on, sh);
 }
@@ -598,6 +590,82 @@ void synchronize(GlobalNumbering* n, Sharing* shr)
   synchronizeFieldData<long>(n->getData(), shr);
 }
 
+struct RankedEntity
+{
+  int rank;
+  MeshEntity* entity;
+  bool operator<(RankedEntity const& other) const
+  {
+    return rank < other.rank;
+  }
+};
+
+/* the owned entities of one dimension, by tag value if
+   they have the order tag and then in mesh order */
+static void getOwnedEntities(Mesh* m, FieldShape* s, Sharing* shr,
+    int dim, MeshTag* order, std::vector<MeshEntity*>& owned)
+{
+  std::vector<RankedEntity> ranked;
+  MeshIterator* it = m->begin(dim);
+  MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    if (( ! s->countNodesOn(m->getType(e))) || ( ! shr->isOwned(e)))
+      continue;
+    if (order && m->hasTag(e, order)) {
+      RankedEntity r;
+      m->getIntTag(e, order, &r.rank);
+      r.entity = e;
+      ranked.push_back(r);
+    } else
+      owned.push_back(e);
+  }
+  m->end(it);
+  std::stable_sort(ranked.begin(), ranked.end());
+  std::vector<MeshEntity*> sorted(ranked.size());
+  for (size_t i = 0; i < ranked.size(); ++i)
+    sorted[i] = ranked[i].entity;
+  owned.insert(owned.begin(), sorted.begin(), sorted.end());
+}
+
+GlobalNumbering* numberGlobalNodes(Mesh* mesh, const char* name,
+    FieldShape* s, MeshTag* order, DynamicArray<long>* map)
+{
+  if (!s)
+    s = mesh->getShape();
+  Sharing* shr = mesh->getCachedSharing();
+  GlobalNumbering* n = createGlobalNumbering(mesh, name, s);
+  std::vector<MeshEntity*> owned[4];
+  long count = 0;
+  for (int d = 0; d < 4; ++d) {
+    if ( ! s->hasNodesIn(d))
+      continue;
+    getOwnedEntities(mesh, s, shr, d, order, owned[d]);
+    for (size_t i = 0; i < owned[d].size(); ++i)
+      count += n->countNodesOn(owned[d][i]);
+  }
+  long next = PCU_Exscan_Long(count);
+  for (int d = 0; d < 4; ++d)
+    for (size_t i = 0; i < owned[d].size(); ++i)
+      for (int j = 0; j < n->countNodesOn(owned[d][i]); ++j)
+        number(n, owned[d][i], j, next++);
+  synchronize(n);
+  if (!map)
+    return n;
+  map->setSize(countNodes(n));
+  size_t k = 0;
+  for (int d = 0; d < 4; ++d) {
+    if ( ! s->hasNodesIn(d))
+      continue;
+    MeshIterator* it = mesh->begin(d);
+    MeshEntity* e;
+    while ((e = mesh->iterate(it)))
+      for (int j = 0; j < n->countNodesOn(e); ++j)
+        (*map)[k++] = getNumber(n, e, j);
+    mesh->end(it);
+  }
+  return n;
+}
+
 void destroyGlobalNumbering(GlobalNumbering* n)
 {
   n->getMesh()->removeGlobalNumbering(n);
@@ -609,5 +677,170 @@ void getNodes(GlobalNumbering* n, DynamicArray<Node>& nodes)
   getFieldNodes(n,nodes);
 }
 
+void buildNodeGraph(Mesh* m, Sharing* shr, ElementDofs& dofs,
+    long owned, long first, NodeGraph& g)
+{
+  g.firstRow = first;
+  /* count the couplings of owned rows and send those of
+     rows owned elsewhere to their owners, keeping the
+     element dof tables for the second pass */
+  std::vector<long> counts(owned + 1, 0);
+  std::vector<long> table;
+  std::vector<int> rowOwner;
+  std::vector<long> numbers;
+  std::vector<MeshEntity*> ents;
+  PCU_Comm_Begin();
+  MeshIterator* it = m->begin(m->getDimension());
+  MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    dofs.get(e, numbers, ents);
+    int nen = numbers.size();
+    PCU_ALWAYS_ASSERT((int)ents.size() == nen);
+    table.push_back(nen);
+    for (int i = 0; i < nen; ++i) {
+      table.push_back(numbers[i]);
+      if (shr->isOwned(ents[i])) {
+        long row = numbers[i] - first;
+        PCU_ALWAYS_ASSERT(0 <= row && row < owned);
+        counts[row] += nen;
+        rowOwner.push_back(-1);
+      } else {
+        int to = shr->getOwner(ents[i]);
+        PCU_COMM_PACK(to, numbers[i]);
+        PCU_COMM_PACK(to, nen);
+        PCU_Comm_Pack(to, &numbers[0], nen * sizeof(long));
+        rowOwner.push_back(to);
+      }
+    }
+  }
+  m->end(it);
+  PCU_Comm_Send();
+  std::vector<long> received;
+  while (PCU_Comm_Receive()) {
+    long row;
+    int nen;
+    PCU_COMM_UNPACK(row);
+    PCU_COMM_UNPACK(nen);
+    row -= first;
+    PCU_ALWAYS_ASSERT(0 <= row && row < owned);
+    counts[row] += nen;
+    received.push_back(row);
+    received.push_back(nen);
+    long const* in = PCU_COMM_EXTRACT(long, nen);
+    received.insert(received.end(), in, in + nen);
+  }
+  /* fill the preallocated rows */
+  std::vector<long> offsets(owned + 1, 0);
+  for (long i = 0; i < owned; ++i)
+    offsets[i + 1] = offsets[i] + counts[i];
+  std::vector<long> columns(offsets[owned]);
+  std::vector<long> at(offsets.begin(), offsets.end() - 1);
+  size_t k = 0;
+  size_t node = 0;
+  while (k < table.size()) {
+    int nen = table[k++];
+    long const* elem = &table[k];
+    for (int i = 0; i < nen; ++i, ++node)
+      if (rowOwner[node] == -1) {
+        long row = elem[i] - first;
+        std::copy(elem, elem + nen, &columns[at[row]]);
+        at[row] += nen;
+      }
+    k += nen;
+  }
+  k = 0;
+  while (k < received.size()) {
+    long row = received[k++];
+    int nen = received[k++];
+    std::copy(&received[k], &received[k] + nen, &columns[at[row]]);
+    at[row] += nen;
+    k += nen;
+  }
+  /* sort and compact each row, and collect the ghosts */
+  g.offsets.setSize(owned + 1);
+  g.offsets[0] = 0;
+  long size = 0;
+  std::vector<long> ghosts;
+  for (long i = 0; i < owned; ++i) {
+    long* b = &columns[0] + offsets[i];
+    long* end = &columns[0] + offsets[i + 1];
+    std::sort(b, end);
+    end = std::unique(b, end);
+    for (long* c = b; c != end; ++c) {
+      columns[size++] = *c;
+      if (*c < first || *c >= first + owned)
+        ghosts.push_back(*c);
+    }
+    g.offsets[i + 1] = size;
+  }
+  g.columns.setSize(size);
+  std::copy(columns.begin(), columns.begin() + size, g.columns.begin());
+  std::sort(ghosts.begin(), ghosts.end());
+  ghosts.erase(std::unique(ghosts.begin(), ghosts.end()), ghosts.end());
+  g.ghosts.setSize(ghosts.size());
+  std::copy(ghosts.begin(), ghosts.end(), g.ghosts.begin());
+}
+
+/* the entity of each element node, in element node order */
+static void getNodeEntities(Mesh* m, FieldShape* s, MeshEntity* e,
+    std::vector<MeshEntity*>& out)
+{
+  out.clear();
+  int dim = getDimension(m, e);
+  for (int d = 0; d <= dim; ++d) {
+    if ( ! s->hasNodesIn(d))
+      continue;
+    Downward a;
+    int na = m->getDownward(e, d, a);
+    for (int i = 0; i < na; ++i)
+      out.insert(out.end(), s->countNodesOn(m->getType(a[i])), a[i]);
+  }
+}
+
+struct ElementNodes : public ElementDofs
+{
+  ElementNodes(GlobalNumbering* gn):n(gn) {}
+  void get(MeshEntity* e, std::vector<long>& numbers,
+      std::vector<MeshEntity*>& ents)
+  {
+    int nen = getElementNumbers(n, e, buffer);
+    numbers.assign(&buffer[0], &buffer[0] + nen);
+    getNodeEntities(getMesh(n), getShape(n), e, ents);
+  }
+  GlobalNumbering* n;
+  NewArray<long> buffer;
+};
+
+void getNodeGraph(GlobalNumbering* n, NodeGraph& g, Sharing* shr)
+{
+  PCU_ALWAYS_ASSERT(countComponents(n) == 1);
+  Mesh* m = getMesh(n);
+  FieldShape* s = getShape(n);
+  if (!shr)
+    shr = m->getCachedSharing();
+  /* the owned range of global numbers */
+  long owned = 0;
+  long first = -1;
+  for (int d = 0; d < 4; ++d) {
+    if ( ! s->hasNodesIn(d))
+      continue;
+    MeshIterator* it = m->begin(d);
+    MeshEntity* e;
+    while ((e = m->iterate(it)))
+      if (shr->isOwned(e))
+        for (int i = 0; i < n->countNodesOn(e); ++i) {
+          long k = getNumber(n, e, i);
+          if (first == -1 || k < first)
+            first = k;
+          ++owned;
+        }
+    m->end(it);
+  }
+  if (first == -1)
+    first = 0;
+  ElementNodes dofs(n);
+  buildNodeGraph(m, shr, dofs, owned, first, g);
+}
+
 Field* getField(GlobalNumbering* n) { return n->getField(); }
 }
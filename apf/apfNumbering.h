@@ -91,7 +91,9 @@ int countFixed(Numbering* n);
    \details Works even if the non-owned nodes have no number currently
    assigned, after this they are all numbered
    \param shr if non-zero, use this Sharing model to determine ownership
-              and copies, otherwise call apf::getSharing */
+              and copies, otherwise the mesh's cached sharing is used
+   \param delete_shr delete (shr) when done. The cached sharing
+              is never deleted. */
 void synchronize(Numbering * n, Sharing* shr = 0, bool delete_shr = false);
 
 /** \brief number the local owned entities of a given dimension */
@@ -111,7 +113,7 @@ Numbering* numberOverlapNodes(
   \param s if non-zero, use nodes from this FieldShape, otherwise
            use the mesh's coordinate nodes
   \param shr if non-zero, use this Sharing to determine ownership,
-             otherwise call apf::getSharing */
+             otherwise the mesh's cached sharing is used */
 Numbering* numberOwnedNodes(
     Mesh* mesh,
     const char* name,
@@ -208,17 +210,75 @@ GlobalNumbering* makeGlobal(Numbering* n, bool destroy=true);
 /** \brief see the Numbering equivalent and apf::makeGlobal */
 void synchronize(GlobalNumbering* n, Sharing* shr = 0);
 
+/** \brief number the owned nodes globally and give all copies
+           their numbers
+  \details this does the work of numberOwnedNodes, makeGlobal
+   and synchronize with one sweep over the owned nodes, one Exscan
+   and one exchange of numbers to the copies, never making the
+   local numbering.
+   Owned nodes are numbered dimension by dimension in mesh
+   iteration order, except that entities with the int tag (order),
+   such as one from Parma_BfsReorder, come first by increasing tag
+   value.
+  \param map if given, it is filled with the global number of
+   each local node, in the order that numberOverlapNodes gives
+   the nodes of (s) */
+GlobalNumbering* numberGlobalNodes(Mesh* mesh, const char* name,
+    FieldShape* s = 0, MeshTag* order = 0, DynamicArray<long>* map = 0);
+
 /** \brief destroy a global numbering */
 void destroyGlobalNumbering(GlobalNumbering* n);
 
 /** \brief see the Numbering equivalent */
 void getNodes(GlobalNumbering* n, DynamicArray<Node>& nodes);
 
+/** \brief the rows of a node to node sparsity pattern
+           that belong to one part
+  \details row i is the owned node with global number
+   (firstRow + i). Its columns are the global numbers of all nodes
+   that share an element with it anywhere in the mesh, sorted, at
+   columns[offsets[i]] up to columns[offsets[i + 1]]. */
+struct NodeGraph
+{
+  long firstRow;
+  DynamicArray<long> offsets;
+  DynamicArray<long> columns;
+/** \brief the sorted distinct columns owned by other parts */
+  DynamicArray<long> ghosts;
+};
+
+/** \brief build the sparsity pattern of the owned rows of a
+           global numbering of nodes
+  \details the owned nodes must have consecutive global numbers,
+   as makeGlobal and numberGlobalNodes give them, and every node
+   must be numbered, as after synchronize.
+   Rows are filled by counting first and then writing into
+   preallocated arrays, and the couplings of owned nodes found
+   on other parts arrive in a single exchange. */
+void getNodeGraph(GlobalNumbering* n, NodeGraph& g, Sharing* shr = 0);
+
 /** \brief Number by adjacency graph traversal
   \details a plain single-integer tag is used to
   number the vertices and elements of a mesh */
 MeshTag* reorder(Mesh* mesh, const char* name);
 
+/** \brief the quality of a vertex ordering for solvers
+  \details on the graph of vertices joined by edges, the bandwidth
+   is the largest difference between the numbers of neighbors and
+   the profile sums over vertices how far below its own number its
+   lowest neighbor is. */
+struct OrderQuality
+{
+  long bandwidth;
+  long profile;
+};
+
+/** \brief measure the vertex order given by the int tag (order)
+           with values [0, #vertices), or by mesh iteration
+  \details the bandwidth is the largest of any part and the
+   profile the sum over parts. This is a collective call. */
+OrderQuality measureOrder(Mesh* m, MeshTag* order = 0);
+
 void globalize(Numbering* n);
 
 /** \brief number all components by simple iteration */
@@ -9,6 +9,8 @@
 #define APFNUMBERINGCLASS_H
 
 #include "apfField.h"
+#include "apfNumbering.h"
+#include <vector>
 
 namespace apf {
 
@@ -34,6 +36,21 @@ class NumberingOf : public FieldBase
     int components;
 };
 
+/* the global numbers of the dofs of an element and the entity
+   holding each, as buildNodeGraph reads them */
+class ElementDofs
+{
+  public:
+    virtual ~ElementDofs() {}
+    virtual void get(MeshEntity* e, std::vector<long>& numbers,
+        std::vector<MeshEntity*>& ents) = 0;
+};
+
+/* the rows of the sparsity pattern whose owned dofs are the (owned)
+   consecutive global numbers starting at (first), see getNodeGraph */
+void buildNodeGraph(Mesh* m, Sharing* shr, ElementDofs& dofs,
+    long owned, long first, NodeGraph& g);
+
 }
 
 #endif
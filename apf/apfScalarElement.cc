@@ -17,7 +17,6 @@ ScalarElement::ScalarElement(ScalarField* f, VectorElement* e):
 
 void ScalarElement::grad(Vector3 const& local, Vector3& g)
 {
-  NewArray<Vector3> globalGradients;
   getGlobalGradients(local,globalGradients);
   double* nodeValues = getNodeValues();
   g = globalGradients[0] * nodeValues[0];
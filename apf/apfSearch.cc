@@ -0,0 +1,413 @@
+/*
+ * Copyright 2011 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include <PCU.h>
+#include "apfSearch.h"
+#include "apf.h"
+#include "apfShape.h"
+#include <pcu_util.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+namespace apf {
+
+namespace {
+
+struct Box
+{
+  double lower[3];
+  double upper[3];
+  void clear()
+  {
+    for (int i = 0; i < 3; ++i) {
+      lower[i] = DBL_MAX;
+      upper[i] = -DBL_MAX;
+    }
+  }
+  void add(double const* x)
+  {
+    for (int i = 0; i < 3; ++i) {
+      lower[i] = std::min(lower[i], x[i]);
+      upper[i] = std::max(upper[i], x[i]);
+    }
+  }
+  void add(Box const& b)
+  {
+    add(b.lower);
+    add(b.upper);
+  }
+  void grow(double fraction)
+  {
+    double size = 0;
+    for (int i = 0; i < 3; ++i)
+      size = std::max(size, upper[i] - lower[i]);
+    double margin = fraction * size + DBL_EPSILON * 16;
+    for (int i = 0; i < 3; ++i) {
+      lower[i] -= margin;
+      upper[i] += margin;
+    }
+  }
+  bool holds(Vector3 const& x) const
+  {
+    for (int i = 0; i < 3; ++i)
+      if (x[i] < lower[i] || x[i] > upper[i])
+        return false;
+    return true;
+  }
+  double center(int axis) const
+  {
+    return (lower[axis] + upper[axis]) / 2;
+  }
+};
+
+/* how far parent coordinates lie outside the parent element,
+   in the units of the parent coordinates */
+double getOutside(int type, Vector3 const& xi)
+{
+  double o = 0;
+  switch (type) {
+    case Mesh::EDGE:
+      return std::max(0.0, std::fabs(xi[0]) - 1);
+    case Mesh::TRIANGLE:
+      o = std::max(-xi[0], -xi[1]);
+      return std::max(0.0, std::max(o, xi[0] + xi[1] - 1));
+    case Mesh::TET:
+      o = std::max(std::max(-xi[0], -xi[1]), -xi[2]);
+      return std::max(0.0, std::max(o, xi[0] + xi[1] + xi[2] - 1));
+    case Mesh::PRISM:
+      o = std::max(-xi[0], -xi[1]);
+      o = std::max(o, xi[0] + xi[1] - 1);
+      return std::max(0.0, std::max(o, std::fabs(xi[2]) - 1));
+    case Mesh::QUAD:
+      return std::max(0.0,
+          std::max(std::fabs(xi[0]), std::fabs(xi[1])) - 1);
+    default: /* hexahedra and pyramids */
+      o = std::max(std::fabs(xi[0]), std::fabs(xi[1]));
+      return std::max(0.0, std::max(o, std::fabs(xi[2])) - 1);
+  }
+}
+
+/* the fraction of its size by which each element box grows */
+double const boxGrowth = 0.1;
+
+}
+
+/* the nodes are stored depth-first, leaves hold
+   up to leafSize elements in order[begin, end) */
+class ElementTree
+{
+  public:
+    enum { leafSize = 8 };
+    struct Node
+    {
+      Box box;
+      int begin;
+      int end;
+      int right; /* the left child is the next node, -1 in a leaf */
+    };
+    ElementTree(Mesh* m):mesh(m)
+    {
+      int dim = m->getDimension();
+      MeshIterator* it = m->begin(dim);
+      MeshEntity* e;
+      while ((e = m->iterate(it))) {
+        Downward verts;
+        int nv = m->getDownward(e, 0, verts);
+        Box b;
+        b.clear();
+        for (int i = 0; i < nv; ++i) {
+          Vector3 x;
+          m->getPoint(verts[i], 0, x);
+          double a[3];
+          x.toArray(a);
+          b.add(a);
+        }
+        b.grow(boxGrowth);
+        elements.push_back(e);
+        boxes.push_back(b);
+      }
+      m->end(it);
+      order.resize(elements.size());
+      for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+      if (!elements.empty())
+        build(0, order.size());
+    }
+    struct ByCenter
+    {
+      ByCenter(std::vector<Box> const& b, int a):boxes(b),axis(a) {}
+      bool operator()(int a, int b) const
+      {
+        return boxes[a].center(axis) < boxes[b].center(axis);
+      }
+      std::vector<Box> const& boxes;
+      int axis;
+    };
+    /* splits at the median of the box centers along
+       the axis over which they spread the most */
+    int build(int begin, int end)
+    {
+      int n = nodes.size();
+      nodes.push_back(Node());
+      Box box, centers;
+      box.clear();
+      centers.clear();
+      for (int i = begin; i < end; ++i) {
+        box.add(boxes[order[i]]);
+        double c[3];
+        for (int j = 0; j < 3; ++j)
+          c[j] = boxes[order[i]].center(j);
+        centers.add(c);
+      }
+      nodes[n].box = box;
+      nodes[n].begin = begin;
+      nodes[n].end = end;
+      nodes[n].right = -1;
+      if (end - begin <= leafSize)
+        return n;
+      int axis = 0;
+      for (int j = 1; j < 3; ++j)
+        if (centers.upper[j] - centers.lower[j] >
+            centers.upper[axis] - centers.lower[axis])
+          axis = j;
+      int middle = (begin + end) / 2;
+      std::nth_element(order.begin() + begin, order.begin() + middle,
+          order.begin() + end, ByCenter(boxes, axis));
+      build(begin, middle);
+      int right = build(middle, end);
+      nodes[n].right = right;
+      return n;
+    }
+    MeshEntity* locate(Vector3 const& x, Vector3& xi, double& outside)
+    {
+      MeshEntity* best = 0;
+      outside = DBL_MAX;
+      if (nodes.empty())
+        return 0;
+      std::vector<int> stack(1, 0);
+      while (!stack.empty()) {
+        Node const& node = nodes[stack.back()];
+        int at = stack.back();
+        stack.pop_back();
+        if (!node.box.holds(x))
+          continue;
+        if (node.right != -1) {
+          stack.push_back(node.right);
+          stack.push_back(at + 1);
+          continue;
+        }
+        for (int i = node.begin; i < node.end; ++i) {
+          int e = order[i];
+          if (!boxes[e].holds(x))
+            continue;
+          MeshElement* me = createMeshElement(mesh, elements[e]);
+          Vector3 local;
+          mapGlobalToLocal(me, x, local);
+          destroyMeshElement(me);
+          double o = getOutside(mesh->getType(elements[e]), local);
+          if (o < outside) {
+            outside = o;
+            xi = local;
+            best = elements[e];
+            if (o == 0)
+              return best;
+          }
+        }
+      }
+      return best;
+    }
+    Box const& getBox()
+    {
+      return nodes[0].box;
+    }
+    bool empty()
+    {
+      return nodes.empty();
+    }
+  private:
+    Mesh* mesh;
+    std::vector<MeshEntity*> elements;
+    std::vector<Box> boxes;
+    std::vector<int> order;
+    std::vector<Node> nodes;
+};
+
+ElementTree* createElementTree(Mesh* m)
+{
+  return new ElementTree(m);
+}
+
+void destroyElementTree(ElementTree* t)
+{
+  delete t;
+}
+
+MeshEntity* locatePoint(ElementTree* t, Vector3 const& x, Vector3& xi,
+    double* outside)
+{
+  double o;
+  MeshEntity* e = t->locate(x, xi, o);
+  if (outside)
+    *outside = o;
+  return e;
+}
+
+void locatePoints(ElementTree* t, int n, Vector3 const* x,
+    MeshEntity** elements, Vector3* xi, double* outside)
+{
+  for (int i = 0; i < n; ++i)
+    elements[i] = locatePoint(t, x[i], xi[i], outside ? outside + i : 0);
+}
+
+namespace {
+
+/* a node of the target field, found by its entity and number */
+struct Target
+{
+  MeshEntity* entity;
+  int node;
+  Vector3 point;
+};
+
+void getTargets(Field* f, std::vector<Target>& targets)
+{
+  Mesh* m = getMesh(f);
+  FieldShape* s = getShape(f);
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    if (!s->hasNodesIn(d))
+      continue;
+    MeshIterator* it = m->begin(d);
+    MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      if (!m->isOwned(e))
+        continue;
+      int type = m->getType(e);
+      int nodes = s->countNodesOn(type);
+      if (!nodes)
+        continue;
+      MeshElement* me = 0;
+      if (d)
+        me = createMeshElement(m, e);
+      for (int n = 0; n < nodes; ++n) {
+        Target t;
+        t.entity = e;
+        t.node = n;
+        if (d) {
+          Vector3 xi;
+          s->getNodeXi(type, n, xi);
+          mapLocalToGlobal(me, xi, t.point);
+        } else {
+          m->getPoint(e, 0, t.point);
+        }
+        targets.push_back(t);
+      }
+      if (me)
+        destroyMeshElement(me);
+    }
+    m->end(it);
+  }
+}
+
+}
+
+long transferField(Field* from, Field* to)
+{
+  PCU_Region region("apf::transferField");
+  int components = countComponents(from);
+  PCU_ALWAYS_ASSERT(components == countComponents(to));
+  ElementTree* tree = createElementTree(getMesh(from));
+  /* every part learns the boxes of all the others,
+     empty parts having boxes that hold nothing */
+  Box box;
+  box.clear();
+  if (!tree->empty())
+    box = tree->getBox();
+  int peers = PCU_Comm_Peers();
+  std::vector<Box> partBoxes(peers);
+  MPI_Allgather(&box, 6, MPI_DOUBLE, &partBoxes[0], 6, MPI_DOUBLE,
+      PCU_Get_Comm());
+  std::vector<Target> targets;
+  getTargets(to, targets);
+  PCU_Comm_Begin();
+  for (size_t i = 0; i < targets.size(); ++i)
+    for (int p = 0; p < peers; ++p)
+      if (partBoxes[p].holds(targets[i].point)) {
+        int id = i;
+        PCU_COMM_PACK(p, id);
+        PCU_COMM_PACK(p, targets[i].point);
+      }
+  PCU_Comm_Send();
+  /* the queries are answered in the order they arrive */
+  std::vector<int> askers;
+  std::vector<int> ids;
+  std::vector<double> outsides;
+  std::vector<double> values;
+  Mesh* sourceMesh = getMesh(from);
+  std::vector<double> v(components);
+  while (PCU_Comm_Receive()) {
+    int id;
+    Vector3 x;
+    PCU_COMM_UNPACK(id);
+    PCU_COMM_UNPACK(x);
+    Vector3 xi;
+    double outside;
+    MeshEntity* e = tree->locate(x, xi, outside);
+    if (!e)
+      continue;
+    MeshElement* me = createMeshElement(sourceMesh, e);
+    Element* fe = createElement(from, me);
+    getComponents(fe, xi, &v[0]);
+    destroyElement(fe);
+    destroyMeshElement(me);
+    askers.push_back(PCU_Comm_Sender());
+    ids.push_back(id);
+    outsides.push_back(outside);
+    values.insert(values.end(), v.begin(), v.end());
+  }
+  destroyElementTree(tree);
+  PCU_Comm_Begin();
+  for (size_t i = 0; i < ids.size(); ++i) {
+    PCU_COMM_PACK(askers[i], ids[i]);
+    PCU_COMM_PACK(askers[i], outsides[i]);
+    PCU_Comm_Pack(askers[i], &values[i * components],
+        components * sizeof(double));
+  }
+  PCU_Comm_Send();
+  /* keep the answer of the element the node is least
+     outside of, ties going to the lowest part */
+  std::vector<double> best(targets.size(), DBL_MAX);
+  std::vector<int> bestPart(targets.size(), peers);
+  std::vector<double> bestValues(targets.size() * components);
+  while (PCU_Comm_Receive()) {
+    int id;
+    double outside;
+    PCU_COMM_UNPACK(id);
+    PCU_COMM_UNPACK(outside);
+    PCU_Comm_Unpack(&v[0], components * sizeof(double));
+    int part = PCU_Comm_Sender();
+    if (outside < best[id] || (outside == best[id] && part < bestPart[id])) {
+      best[id] = outside;
+      bestPart[id] = part;
+      std::copy(v.begin(), v.end(), bestValues.begin() + id * components);
+    }
+  }
+  long missing = 0;
+  for (size_t i = 0; i < targets.size(); ++i) {
+    if (bestPart[i] == peers) {
+      ++missing;
+      continue;
+    }
+    setComponents(to, targets[i].entity, targets[i].node,
+        &bestValues[i * components]);
+  }
+  synchronize(to);
+  return PCU_Add_Long(missing);
+}
+
+}
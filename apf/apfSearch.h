@@ -0,0 +1,62 @@
+/*
+ * Copyright 2011 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef APF_SEARCH_H
+#define APF_SEARCH_H
+
+/** \file apfSearch.h
+  \brief point location and field transfer between meshes */
+
+#include "apfMesh.h"
+
+namespace apf {
+
+class Field;
+
+/** \brief a bounding volume hierarchy over the elements of one part */
+class ElementTree;
+
+/** \brief build an apf::ElementTree over the elements of this part
+  \details each element is bounded by the box of its vertices grown
+  by a tenth of its size, which lets points just outside the mesh,
+  as on a curved boundary discretized differently, still find the
+  nearest element. The tree is invalid once the mesh changes. */
+ElementTree* createElementTree(Mesh* m);
+
+/** \brief destroy a tree made by apf::createElementTree */
+void destroyElementTree(ElementTree* t);
+
+/** \brief locate a point in the elements of this part
+  \details among the elements whose boxes hold the point, finds one
+  that contains it, or else the one it is least outside of.
+  \param xi the parent coordinates of the point in that element
+  \param outside if given, how far outside of the parent element
+                 (xi) lies, zero if the element contains the point
+  \returns the element, or zero if no box holds the point */
+MeshEntity* locatePoint(ElementTree* t, Vector3 const& x, Vector3& xi,
+    double* outside = 0);
+
+/** \brief locate (n) points at once, see apf::locatePoint
+  \details elements[i] is zero for the points no box holds */
+void locatePoints(ElementTree* t, int n, Vector3 const* x,
+    MeshEntity** elements, Vector3* xi, double* outside = 0);
+
+/** \brief interpolate a field onto the nodes of a field on another mesh
+  \details collective. Both meshes cover the same domain but may be
+  partitioned differently. Each part sends the nodes of (to) it owns
+  to the parts whose bounding boxes hold them, in one exchange, and
+  each of those parts answers with the values of (from) in the element
+  nearest to containing the node. The value of the nearest element
+  over all parts is kept. Copies of the nodes are then synchronized.
+  The fields must have the same number of components.
+  \returns the number of nodes that no part could locate,
+           over all parts; they are left unchanged */
+long transferField(Field* from, Field* to);
+
+}
+
+#endif
@@ -30,10 +30,28 @@ void EntityShape::alignSharedNodes(Mesh* m,
   fail("unimplemented alignSharedNodes\n");
 }
 
-FieldShape::~FieldShape()
+int EntityShape::getTensorNodes(NewArray<double>&, NewArray<int>&) const
 {
+  return 0;
+}
+
+static int setTensorNodes(int n, double const* points,
+    int nodes, int const* order,
+    NewArray<double>& pointsOut, NewArray<int>& orderOut)
+{
+  pointsOut.allocate(n);
+  for (int i = 0; i < n; ++i)
+    pointsOut[i] = points[i];
+  orderOut.allocate(nodes);
+  for (int i = 0; i < nodes; ++i)
+    orderOut[i] = order[i];
+  return n;
 }
 
+/* the 1D nodes of the linear and quadratic Lagrange shapes */
+static double const linearPoints[2] = {-1, 1};
+static double const quadraticPoints[3] = {-1, 1, 0};
+
 void FieldShape::getNodeXi(int, int, Vector3&)
 {
   fail("unimplemented getNodeXi called");
@@ -106,6 +124,12 @@ class Linear : public FieldShape
           grads[1] = Vector3( 0.5,0,0);
         }
         int countNodes() const {return 2;}
+        int getTensorNodes(NewArray<double>& points,
+            NewArray<int>& order) const
+        {
+          static int const o[2] = {0, 1};
+          return setTensorNodes(2, linearPoints, 2, o, points, order);
+        }
     };
     class Triangle : public EntityShape
     {
@@ -159,6 +183,12 @@ class Linear : public FieldShape
           grads[3] = Vector3(-l1y, l0x,0)/4;
         }
         int countNodes() const {return 4;}
+        int getTensorNodes(NewArray<double>& points,
+            NewArray<int>& order) const
+        {
+          static int const o[4] = {0, 1, 3, 2};
+          return setTensorNodes(2, linearPoints, 4, o, points, order);
+        }
     };
     class Tetrahedron : public EntityShape
     {
@@ -310,6 +340,12 @@ class Linear : public FieldShape
           grads[7] = Vector3(-l1y * l1z,  l0x * l1z,  l0x * l1y) / 8;
         }
         int countNodes() const {return 8;}
+        int getTensorNodes(NewArray<double>& points,
+            NewArray<int>& order) const
+        {
+          static int const o[8] = {0, 1, 3, 2, 4, 5, 7, 6};
+          return setTensorNodes(2, linearPoints, 8, o, points, order);
+        }
     };
     EntityShape* getEntityShape(int type)
     {
@@ -347,6 +383,7 @@ class Linear : public FieldShape
         return 0;
     }
     int getOrder() {return 1;}
+    bool isElementInvariant(int) {return true;}
     void getNodeXi(int, int, Vector3& xi)
     {
       xi = Vector3(0,0,0);
@@ -377,6 +414,12 @@ class QuadraticBase : public FieldShape
           grads[2] = Vector3(-2*xi[0],0,0);
         }
         int countNodes() const {return 3;}
+        int getTensorNodes(NewArray<double>& points,
+            NewArray<int>& order) const
+        {
+          static int const o[3] = {0, 1, 2};
+          return setTensorNodes(3, quadraticPoints, 3, o, points, order);
+        }
     };
     class Triangle : public EntityShape
     {
@@ -465,6 +508,7 @@ class QuadraticBase : public FieldShape
       return shapes[type];
     }
     int getOrder() {return 2;}
+    bool isElementInvariant(int) {return true;}
     void getNodeXi(int, int, Vector3& xi)
     {
       /* for vertex nodes, mid-edge nodes,
@@ -545,6 +589,12 @@ class LagrangeQuadratic : public QuadraticBase
               -2.0*n*(1-(e*e)), 0.0);
         }
         int countNodes() const {return 9;}
+        int getTensorNodes(NewArray<double>& points,
+            NewArray<int>& order) const
+        {
+          static int const o[9] = {0, 1, 4, 3, 2, 7, 5, 6, 8};
+          return setTensorNodes(3, quadraticPoints, 9, o, points, order);
+        }
     };
     EntityShape* getEntityShape(int type)
     {
@@ -864,6 +914,7 @@ class LagrangeCubic : public FieldShape
         return 0;
     }
     int getOrder() {return 3;}
+    bool isElementInvariant(int) {return true;}
     void getNodeXi(int type, int node, Vector3& xi)
     {
       PCU_ALWAYS_ASSERT(node < 2);
@@ -898,82 +949,6 @@ FieldShape* getSerendipity()
   return &s;
 }
 
-/* these are step-wise fields which are defined by nodes
-   at element centers, and the field value is constant
-   throughout an element and discontinuous between elements.
-   The first example is the gradient computed from a 1st-order
-   Lagrange field, another example is the per-element error estimate */
-template <int D>
-class Constant : public FieldShape
-{
-  public:
-    Constant()
-    {
-      std::stringstream ss;
-      ss << "Constant_" << D;
-      name = ss.str();
-      registerSelf(name.c_str());
-    }
-    const char* getName() const
-    {
-      return name.c_str();
-    }
-    class Element : public EntityShape
-    {
-      public:
-        void getValues(Mesh*, MeshEntity*,
-            Vector3 const&, NewArray<double>& values) const
-        {
-          values.allocate(1);
-          values[0] = 1;
-        }
-        void getLocalGradients(Mesh*, MeshEntity*,
-            Vector3 const&, NewArray<Vector3>& grads) const
-        {
-          grads.allocate(1);
-          grads[0] = Vector3( 0, 0, 0);
-        }
-        int countNodes() const {return 1;}
-        int getDimension() const {return D;}
-    };
-    EntityShape* getEntityShape(int type)
-    {
-      static Element element;
-      if (countNodesOn(type))
-        return &element;
-      return NULL;
-    }
-    bool hasNodesIn(int dimension)
-    {
-      if (dimension == D)
-        return true;
-      else
-        return false;
-    }
-    int countNodesOn(int type)
-    {
-      int dimension = Mesh::typeDimension[type];
-      if (dimension == D)
-        return 1;
-      else
-        return 0;
-   }
-    int getOrder() {return 0;}
-  private:
-    std::string name;
-};
-
-FieldShape* getConstant(int dimension)
-{
-  static Constant<0> c0;
-  static Constant<1> c1;
-  static Constant<2> c2;
-  static Constant<3> c3;
-  static FieldShape* const table[4] =
-  {&c0, &c1 ,&c2, &c3};
-  return table[dimension];
-}
-
 int countElementNodes(FieldShape* s, int type)
 {
   return s->getEntityShape(type)->countNodes();
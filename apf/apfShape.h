@@ -65,14 +65,26 @@ class EntityShape
     help of apf::getAlignment */
     virtual void alignSharedNodes(Mesh* m,
         MeshEntity* elem, MeshEntity* shared, int order[]);
+/** \brief describe a tensor product of 1D Lagrange polynomials
+    \details edge, quadrilateral and hexahedron shapes that are such
+    products give the parent coordinates of their (n) 1D nodes in
+    (points) and, for each element node, the index i + n * (j + n * k)
+    of its 1D nodes along the parent directions in (order).
+    apf::ShapeBatch uses this to evaluate fields by sum factorization.
+    \returns n, or zero if this is not a tensor product (the default) */
+    virtual int getTensorNodes(NewArray<double>& points,
+        NewArray<int>& order) const;
 };
 
 /** \brief Describes field distribution and shape functions
   \details these classes are typically singletons, one for
   each shape function scheme */
+class ShapeCache;
+
 class FieldShape
 {
   public:
+    FieldShape();
     virtual ~FieldShape();
 /** \brief Get the sub-descriptor for this entity type
   \param type select from apf::Mesh::Type */
@@ -97,6 +109,39 @@ class FieldShape
 /** \brief Get a unique string for this shape function scheme */
     virtual const char* getName() const = 0;
     void registerSelf(const char* name);
+/** \brief Return true iff the shape functions of this type are
+           the same functions of parent coordinates on every element
+  \details the values of such shapes at integration points are
+  computed once and cached, see getCached. The default is false.
+  \param type select from apf::Mesh::Type */
+    virtual bool isElementInvariant(int type);
+/** \brief Return the number of variants of an element invariant type
+  \details some shapes are the same functions of parent coordinates
+  on all elements that share a few properties, such as which of
+  their faces are on the boundary. getCached keeps the results
+  of each variant apart. The default is one.
+  \param type select from apf::Mesh::Type */
+    virtual int countElementVariants(int type);
+/** \brief Return the variant of (e), in [0, countElementVariants) */
+    virtual int getElementVariant(Mesh* m, MeshEntity* e);
+/** \brief Look up the shape values and parent gradients at a point
+  \details for element invariant shapes, the results at each
+  integration point are kept after their first use, and
+  then stay valid until the order of the shape changes
+  or clearCached is called. Threads may call this at once,
+  but not while another changes the order or clears the cache.
+  \returns false if (xi) is not an integration point of the
+            element type or the shape is not element invariant */
+    bool getCached(Mesh* m, MeshEntity* e, Vector3 const& xi,
+        double const** values, Vector3 const** grads);
+/** \brief Forget the results kept by getCached
+  \details for shapes whose functions change without a change
+  of order */
+    void clearCached();
+  private:
+    FieldShape(FieldShape const&);
+    FieldShape& operator=(FieldShape const&);
+    ShapeCache* cache;
 };
 
 /** \brief Get the Lagrangian shape function of some polynomial order
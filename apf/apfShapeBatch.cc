@@ -0,0 +1,434 @@
+#include "apfShapeBatch.h"
+#include "apfElement.h"
+#include "apfField.h"
+#include "apfFieldData.h"
+#include "apfShape.h"
+#include <pcu_util.h>
+#include <vector>
+
+namespace apf {
+
+/* parent-space tables of one shape at every point,
+   [point][node] for values and [point][node][direction]
+   for gradients */
+struct ShapeTable
+{
+  ShapeTable():nodes(0) {}
+  int nodes;
+  std::vector<double> values;
+  std::vector<double> grads;
+};
+
+/* the 1D factors of a tensor product shape at the 1D points
+   of a batch, [point][1D node], and the tensor index of
+   each element node. size is zero for other shapes */
+struct TensorTable
+{
+  TensorTable():size(0) {}
+  int size;
+  std::vector<int> order;
+  std::vector<double> values;
+  std::vector<double> derivatives;
+};
+
+class ShapeBatch
+{
+  public:
+    Mesh* mesh;
+    FieldShape* shape;
+    int type;
+    int dimension;
+    int points;
+    std::vector<Vector3> xi;
+    std::vector<double> x1d; /* empty unless made by createTensorShapeBatch */
+    MeshEntity* first; /* the tables come from this element */
+    bool tabulated;
+    bool gradsCurrent;
+    int fieldNodes;
+    ShapeTable field;
+    ShapeTable coords;
+    TensorTable fieldTensor;
+    TensorTable coordsTensor;
+    int elements;
+    std::vector<MeshEntity*> entities;
+    std::vector<double> jacobians;
+    std::vector<double> determinants;
+    std::vector<double> inverses;
+    std::vector<double> grads;
+    NewArray<double> nodes;
+    /* buffers of the sum factorization */
+    std::vector<double> tensorNodes;
+    std::vector<double> stages[2][4];
+    std::vector<double> coordValues;
+    std::vector<double> localGrads;
+};
+
+static void tabulate(ShapeTable& t, ShapeBatch* b, FieldShape* s,
+    MeshEntity* e)
+{
+  EntityShape* es = s->getEntityShape(b->type);
+  t.nodes = es->countNodes();
+  t.values.resize(b->points * t.nodes);
+  t.grads.resize(b->points * t.nodes * 3);
+  NewArray<double> values;
+  NewArray<Vector3> grads;
+  for (int p = 0; p < b->points; ++p) {
+    es->getValues(b->mesh, e, b->xi[p], values);
+    es->getLocalGradients(b->mesh, e, b->xi[p], grads);
+    for (int n = 0; n < t.nodes; ++n) {
+      t.values[p * t.nodes + n] = values[n];
+      for (int d = 0; d < 3; ++d)
+        t.grads[(p * t.nodes + n) * 3 + d] = grads[n][d];
+    }
+  }
+}
+
+/* the field table is only needed by the point-wise outputs,
+   which tensor product batches of high order should avoid */
+static ShapeTable& getFieldTable(ShapeBatch* b)
+{
+  if (b->field.values.empty() && b->first)
+    tabulate(b->field, b, b->shape, b->first);
+  return b->field;
+}
+
+/* the 1D Lagrange polynomials through the nodes z and
+   their derivatives, at each of the batch's 1D points */
+static void tabulateTensor(TensorTable& t, ShapeBatch* b, FieldShape* s)
+{
+  if (b->x1d.empty())
+    return;
+  EntityShape* es = s->getEntityShape(b->type);
+  NewArray<double> z;
+  NewArray<int> order;
+  int n = es->getTensorNodes(z, order);
+  if (!n)
+    return;
+  int nq = b->x1d.size();
+  t.size = n;
+  t.order.assign(&order[0], &order[0] + es->countNodes());
+  t.values.resize(nq * n);
+  t.derivatives.resize(nq * n);
+  for (int q = 0; q < nq; ++q) {
+    double x = b->x1d[q];
+    for (int i = 0; i < n; ++i) {
+      double value = 1;
+      double derivative = 0;
+      for (int l = 0; l < n; ++l) {
+        if (l == i)
+          continue;
+        double term = 1 / (z[i] - z[l]);
+        for (int m = 0; m < n; ++m)
+          if (m != i && m != l)
+            term *= (x - z[m]) / (z[i] - z[m]);
+        derivative += term;
+        value *= (x - z[l]) / (z[i] - z[l]);
+      }
+      t.values[q * n + i] = value;
+      t.derivatives[q * n + i] = derivative;
+    }
+  }
+}
+
+/* out[o][q][i] = sum over k of m[q][k] in[o][k][i] */
+static void contract(int outer, int n, int inner, int nq,
+    double const* m, double const* in, double* out)
+{
+  for (int o = 0; o < outer; ++o)
+    for (int q = 0; q < nq; ++q) {
+      double* to = out + (o * nq + q) * inner;
+      for (int i = 0; i < inner; ++i)
+        to[i] = 0;
+      for (int k = 0; k < n; ++k) {
+        double c = m[q * n + k];
+        double const* from = in + (o * n + k) * inner;
+        for (int i = 0; i < inner; ++i)
+          to[i] += c * from[i];
+      }
+    }
+}
+
+/* interpolates the element node values (u), [node][component]
+   in tensor order, at the tensor product points by contracting
+   one parent direction at a time, which takes O(p^(d+1)) work
+   per element instead of the O(p^(2d)) of summing every shape
+   function at every point. values are [point][component] and
+   the parent gradients, if wanted, [point][component][direction] */
+static void sumFactorize(ShapeBatch* b, TensorTable const& t, int nc,
+    double const* u, double* values, double* grads)
+{
+  int dim = b->dimension;
+  int n = t.size;
+  int nq = b->x1d.size();
+  /* stage s holds the partial sums of the value, slot 0,
+     and of the derivative along each direction d < s, slot d + 1 */
+  int partials = 1;
+  double const* in[4] = {u, 0, 0, 0};
+  int outer = 1;
+  for (int d = 1; d < dim; ++d)
+    outer *= n;
+  int inner = nc;
+  for (int d = 0; d < dim; ++d) {
+    std::vector<double>* out = b->stages[d % 2];
+    int size = outer * nq * inner;
+    int next = grads ? partials + 1 : 1;
+    for (int s = 0; s < next; ++s)
+      out[s].resize(size);
+    for (int s = 0; s < partials; ++s)
+      contract(outer, n, inner, nq, &t.values[0], in[s], &out[s][0]);
+    if (grads)
+      contract(outer, n, inner, nq, &t.derivatives[0], in[0],
+          &out[partials][0]);
+    partials = next;
+    for (int s = 0; s < partials; ++s)
+      in[s] = &out[s][0];
+    outer /= n;
+    inner *= nq;
+  }
+  int np = inner / nc;
+  for (int i = 0; i < np * nc; ++i)
+    values[i] = in[0][i];
+  if (!grads)
+    return;
+  for (int i = 0; i < np * nc; ++i)
+    for (int d = 0; d < 3; ++d)
+      grads[i * 3 + d] = d < dim ? in[d + 1][i] : 0;
+}
+
+/* element node data from getElementData, [node][component],
+   moved into the tensor order */
+static double const* toTensorOrder(ShapeBatch* b, TensorTable const& t,
+    int nc, double const* data)
+{
+  int nodes = t.order.size();
+  b->tensorNodes.resize(nodes * nc);
+  for (int k = 0; k < nodes; ++k)
+    for (int c = 0; c < nc; ++c)
+      b->tensorNodes[t.order[k] * nc + c] = data[k * nc + c];
+  return &(b->tensorNodes[0]);
+}
+
+ShapeBatch* createShapeBatch(Mesh* m, FieldShape* s, int type,
+    int points, Vector3 const* xi)
+{
+  ShapeBatch* b = new ShapeBatch();
+  b->mesh = m;
+  b->shape = s;
+  b->type = type;
+  b->dimension = Mesh::typeDimension[type];
+  b->points = points;
+  b->xi.assign(xi, xi + points);
+  b->first = 0;
+  b->tabulated = false;
+  b->gradsCurrent = false;
+  b->fieldNodes = s->getEntityShape(type)->countNodes();
+  b->elements = 0;
+  return b;
+}
+
+ShapeBatch* createTensorShapeBatch(Mesh* m, FieldShape* s, int type,
+    int points, double const* x)
+{
+  PCU_ALWAYS_ASSERT(type == Mesh::EDGE || type == Mesh::QUAD ||
+                    type == Mesh::HEX);
+  int dim = Mesh::typeDimension[type];
+  int np = 1;
+  for (int d = 0; d < dim; ++d)
+    np *= points;
+  std::vector<Vector3> xi(np, Vector3(0, 0, 0));
+  for (int p = 0; p < np; ++p)
+    for (int d = 0, i = p; d < dim; ++d, i /= points)
+      xi[p][d] = x[i % points];
+  ShapeBatch* b = createShapeBatch(m, s, type, np, &xi[0]);
+  b->x1d.assign(x, x + points);
+  tabulateTensor(b->fieldTensor, b, s);
+  tabulateTensor(b->coordsTensor, b, m->getShape());
+  return b;
+}
+
+void evaluateShapeBatch(ShapeBatch* b, int n, MeshEntity* const* elements)
+{
+  bool tensorCoords = b->coordsTensor.size;
+  if (n && ! b->tabulated) {
+    b->first = elements[0];
+    if (!tensorCoords)
+      tabulate(b->coords, b, b->mesh->getShape(), elements[0]);
+    b->tabulated = true;
+  }
+  int np = b->points;
+  int cn = b->coords.nodes;
+  b->elements = n;
+  b->entities.assign(elements, elements + n);
+  b->gradsCurrent = false;
+  b->jacobians.resize(n * np * 9);
+  b->determinants.resize(n * np);
+  b->inverses.resize(n * np * 9);
+  if (!n)
+    return;
+  FieldDataOf<double>* coords = b->mesh->getCoordinateField()->getData();
+  if (tensorCoords) {
+    b->coordValues.resize(np * 3);
+    b->localGrads.resize(np * 3 * 3);
+  }
+  for (int e = 0; e < n; ++e) {
+    PCU_ALWAYS_ASSERT(b->mesh->getType(elements[e]) == b->type);
+    coords->getElementData(elements[e], b->nodes);
+    double const* x = &(b->nodes[0]);
+    if (tensorCoords) {
+      /* the Jacobian is the parent gradient of the coordinates,
+         J[direction][coordinate] */
+      std::vector<double>& g = b->localGrads;
+      sumFactorize(b, b->coordsTensor, 3,
+          toTensorOrder(b, b->coordsTensor, 3, x), &(b->coordValues[0]), &g[0]);
+      for (int p = 0; p < np; ++p) {
+        double* J = &(b->jacobians[(e * np + p) * 9]);
+        for (int i = 0; i < 3; ++i)
+          for (int j = 0; j < 3; ++j)
+            J[i * 3 + j] = g[(p * 3 + j) * 3 + i];
+      }
+      continue;
+    }
+    for (int p = 0; p < np; ++p) {
+      double const* cg = &(b->coords.grads[p * cn * 3]);
+      double* J = &(b->jacobians[(e * np + p) * 9]);
+      for (int k = 0; k < 9; ++k)
+        J[k] = 0;
+      for (int c = 0; c < cn; ++c)
+        for (int i = 0; i < 3; ++i)
+          for (int j = 0; j < 3; ++j)
+            J[i * 3 + j] += cg[c * 3 + i] * x[c * 3 + j];
+    }
+  }
+  /* volume Jacobians are square, so all of them go through
+     the batched kernels at once. lower dimensions need the
+     pseudo-inverse one point at a time */
+  if (b->dimension == 3) {
+    getDeterminants(n * np, &(b->jacobians[0]), &(b->determinants[0]));
+    invert(n * np, &(b->jacobians[0]), &(b->inverses[0]));
+  } else {
+    for (int ep = 0; ep < n * np; ++ep) {
+      Matrix3x3 J;
+      for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+          J[i][j] = b->jacobians[ep * 9 + i * 3 + j];
+      b->determinants[ep] = getJacobianDeterminant(J, b->dimension);
+      Matrix3x3 jinv = getJacobianInverse(J, b->dimension);
+      for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+          b->inverses[ep * 9 + i * 3 + j] = jinv[i][j];
+    }
+  }
+}
+
+/* the global gradients of every shape function at every
+   point cost O(p^(2d)) per element, so they wait until
+   someone asks for them */
+static void computeGrads(ShapeBatch* b)
+{
+  int n = b->elements;
+  int np = b->points;
+  int nn = b->fieldNodes;
+  b->grads.resize(n * np * 3 * nn);
+  if (b->gradsCurrent || !n)
+    return;
+  ShapeTable& t = getFieldTable(b);
+  for (int ep = 0; ep < n * np; ++ep) {
+    int p = ep % np;
+    double const* jinv = &(b->inverses[ep * 9]);
+    double const* lg = &(t.grads[p * nn * 3]);
+    double* g = &(b->grads[ep * 3 * nn]);
+    for (int k = 0; k < nn; ++k)
+      for (int d = 0; d < 3; ++d)
+        g[d * nn + k] = jinv[d * 3 + 0] * lg[k * 3 + 0] +
+                        jinv[d * 3 + 1] * lg[k * 3 + 1] +
+                        jinv[d * 3 + 2] * lg[k * 3 + 2];
+  }
+  b->gradsCurrent = true;
+}
+
+void evaluateFieldBatch(ShapeBatch* b, Field* f, double* values,
+    double* grads)
+{
+  PCU_ALWAYS_ASSERT(getShape(f) == b->shape);
+  int n = b->elements;
+  int np = b->points;
+  int nn = b->fieldNodes;
+  int nc = countComponents(f);
+  bool tensor = b->fieldTensor.size;
+  FieldDataOf<double>* data = f->getData();
+  NewArray<double> nodes;
+  std::vector<double> pointValues(np * nc);
+  b->localGrads.resize(np * nc * 3);
+  double* lg = &(b->localGrads[0]);
+  for (int e = 0; e < n; ++e) {
+    data->getElementData(b->entities[e], nodes);
+    double const* u = &(nodes[0]);
+    double* v = values ? values + e * np * nc : &pointValues[0];
+    if (tensor) {
+      sumFactorize(b, b->fieldTensor, nc,
+          toTensorOrder(b, b->fieldTensor, nc, u), v, grads ? lg : 0);
+    } else {
+      ShapeTable& t = getFieldTable(b);
+      for (int p = 0; p < np; ++p)
+        for (int c = 0; c < nc; ++c) {
+          double value = 0;
+          double g[3] = {0, 0, 0};
+          for (int k = 0; k < nn; ++k) {
+            double uk = u[k * nc + c];
+            value += t.values[p * nn + k] * uk;
+            for (int d = 0; d < 3; ++d)
+              g[d] += t.grads[(p * nn + k) * 3 + d] * uk;
+          }
+          v[p * nc + c] = value;
+          for (int d = 0; d < 3; ++d)
+            lg[(p * nc + c) * 3 + d] = g[d];
+        }
+    }
+    if (!grads)
+      continue;
+    for (int p = 0; p < np; ++p) {
+      double const* jinv = &(b->inverses[(e * np + p) * 9]);
+      for (int c = 0; c < nc; ++c) {
+        double const* l = lg + (p * nc + c) * 3;
+        double* g = grads + ((e * np + p) * nc + c) * 3;
+        for (int d = 0; d < 3; ++d)
+          g[d] = jinv[d * 3 + 0] * l[0] +
+                 jinv[d * 3 + 1] * l[1] +
+                 jinv[d * 3 + 2] * l[2];
+      }
+    }
+  }
+}
+
+int countBatchNodes(ShapeBatch* b)
+{
+  return b->fieldNodes;
+}
+
+double const* getBatchValues(ShapeBatch* b)
+{
+  return &(getFieldTable(b).values[0]);
+}
+
+double const* getBatchJacobians(ShapeBatch* b)
+{
+  return &(b->jacobians[0]);
+}
+
+double const* getBatchDetJ(ShapeBatch* b)
+{
+  return &(b->determinants[0]);
+}
+
+double const* getBatchGrads(ShapeBatch* b)
+{
+  computeGrads(b);
+  return &(b->grads[0]);
+}
+
+void destroyShapeBatch(ShapeBatch* b)
+{
+  delete b;
+}
+
+}
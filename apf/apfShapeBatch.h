@@ -0,0 +1,82 @@
+/*
+ * Copyright 2025 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef APF_SHAPE_BATCH_H
+#define APF_SHAPE_BATCH_H
+
+/** \file apfShapeBatch.h
+  \brief evaluation of shapes and fields over blocks of elements */
+
+#include "apf.h"
+
+namespace apf {
+
+class ShapeBatch;
+
+/** \brief Prepare to evaluate many elements of one type at once
+  \details a batch tabulates the parent-space values and gradients
+  of (s) and of the mesh coordinate shape once at the given points,
+  so evaluating a block of elements makes no virtual shape calls
+  and no allocations once its buffers have grown.
+  The tables come from the first element evaluated, which suits
+  shapes that do not vary by element, such as the Lagrange,
+  serendipity and hierarchic ones.
+  \param type select from apf::Mesh::Type
+  \param points the number of parent coordinates in (xi) */
+ShapeBatch* createShapeBatch(Mesh* m, FieldShape* s, int type,
+    int points, Vector3 const* xi);
+
+/** \brief Prepare a batch at a tensor product of 1D points
+  \details the points of an edge, quad or hex are all combinations
+  of the (points) coordinates in (x) along each parent direction,
+  the first direction varying fastest, as with tensor product
+  Gauss rules. When (s) and the mesh coordinates are tensor products
+  of 1D shapes (see EntityShape::getTensorNodes), the Jacobians and
+  apf::evaluateFieldBatch work by sum factorization, one direction
+  at a time, which is what makes high orders affordable. */
+ShapeBatch* createTensorShapeBatch(Mesh* m, FieldShape* s, int type,
+    int points, double const* x);
+
+/** \brief Evaluate a batch on (n) elements of its type
+  \details the results below are replaced by those of
+  these elements, in the given order */
+void evaluateShapeBatch(ShapeBatch* b, int n, MeshEntity* const* elements);
+
+/** \brief Return the number of shape functions per element */
+int countBatchNodes(ShapeBatch* b);
+
+/** \brief Return the shape function values, [point][node]
+  \details these are the same for every element */
+double const* getBatchValues(ShapeBatch* b);
+
+/** \brief Return the Jacobians, [element][point][row][column] */
+double const* getBatchJacobians(ShapeBatch* b);
+
+/** \brief Return the Jacobian determinants, [element][point] */
+double const* getBatchDetJ(ShapeBatch* b);
+
+/** \brief Return the shape function gradients in global
+  coordinates, [element][point][direction][node] */
+double const* getBatchGrads(ShapeBatch* b);
+
+/** \brief Interpolate a field at the points of the evaluated elements
+  \details (f) must use the shape of the batch. Either output may be
+  null. Unlike apf::getBatchGrads, this never forms the gradient of
+  every shape function, and for tensor product batches it never sums
+  over every node at every point.
+  \param values [element][point][component]
+  \param grads gradients in global coordinates,
+                [element][point][component][direction] */
+void evaluateFieldBatch(ShapeBatch* b, Field* f, double* values,
+    double* grads);
+
+/** \brief Destroy a batch made by apf::createShapeBatch */
+void destroyShapeBatch(ShapeBatch* b);
+
+}
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2025 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apfShape.h"
+#include "apfMesh.h"
+#include "apfIntegrate.h"
+#include <pthread.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#if __cplusplus < 201103L
+#error "the shape cache needs C++11 std::atomic"
+#endif
+
+namespace apf {
+
+/* the values and parent gradients of one entity shape
+   at the integration points of its type,
+   [point][variant][node], filled in as points are used */
+/* tables are laid out and their rows filled under fillLock, then
+   published through (order) and (done) so that threads looking up
+   rows that are already there take no lock */
+struct ShapeTable
+{
+  ShapeTable():order(-1),variants(0),nodes(0) {}
+  std::atomic<int> order;
+  int variants;
+  int nodes;
+  std::unique_ptr<std::atomic<bool>[]> done;
+  std::vector<double> values;
+  std::vector<Vector3> grads;
+};
+
+class ShapeCache
+{
+  public:
+    ShapeTable tables[Mesh::TYPES];
+};
+
+static pthread_mutex_t fillLock = PTHREAD_MUTEX_INITIALIZER;
+
+FieldShape::FieldShape():
+  cache(new ShapeCache())
+{
+}
+
+FieldShape::~FieldShape()
+{
+  delete cache;
+}
+
+bool FieldShape::isElementInvariant(int)
+{
+  return false;
+}
+
+int FieldShape::countElementVariants(int)
+{
+  return 1;
+}
+
+int FieldShape::getElementVariant(Mesh*, MeshEntity*)
+{
+  return 0;
+}
+
+void FieldShape::clearCached()
+{
+  delete cache;
+  cache = new ShapeCache();
+}
+
+bool FieldShape::getCached(Mesh* m, MeshEntity* e, Vector3 const& xi,
+    double const** values, Vector3 const** grads)
+{
+  int type = m->getType(e);
+  if ( ! isElementInvariant(type))
+    return false;
+  int point = findIntegrationPoint(type, xi);
+  if (point < 0)
+    return false;
+  ShapeTable& t = cache->tables[type];
+  EntityShape* es = getEntityShape(type);
+  int variants = countElementVariants(type);
+  if (t.order.load(std::memory_order_acquire) != getOrder() ||
+      t.variants != variants) {
+    pthread_mutex_lock(&fillLock);
+    if (t.order.load(std::memory_order_relaxed) != getOrder() ||
+        t.variants != variants) {
+      int rows = countIntegrationPoints(type) * variants;
+      t.variants = variants;
+      t.nodes = es->countNodes();
+      t.done.reset(new std::atomic<bool>[rows]);
+      for (int i = 0; i < rows; ++i)
+        t.done[i].store(false, std::memory_order_relaxed);
+      t.values.assign(rows * t.nodes, 0);
+      t.grads.assign(rows * t.nodes, Vector3(0,0,0));
+      t.order.store(getOrder(), std::memory_order_release);
+    }
+    pthread_mutex_unlock(&fillLock);
+  }
+  int row = point * variants;
+  if (variants > 1)
+    row += getElementVariant(m, e);
+  double* v = &(t.values[row * t.nodes]);
+  Vector3* g = &(t.grads[row * t.nodes]);
+  if ( ! t.done[row].load(std::memory_order_acquire)) {
+    pthread_mutex_lock(&fillLock);
+    if ( ! t.done[row].load(std::memory_order_relaxed)) {
+      NewArray<double> nv;
+      NewArray<Vector3> ng;
+      es->getValues(m, e, xi, nv);
+      es->getLocalGradients(m, e, xi, ng);
+      for (int i = 0; i < t.nodes; ++i)
+        v[i] = nv[i];
+      /* shapes that are constant over the element have no gradients */
+      if (ng.allocated())
+        for (int i = 0; i < t.nodes; ++i)
+          g[i] = ng[i];
+      t.done[row].store(true, std::memory_order_release);
+    }
+    pthread_mutex_unlock(&fillLock);
+  }
+  *values = v;
+  *grads = g;
+  return true;
+}
+
+}//namespace apf
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2011 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apfShape.h"
+#include "apfMesh.h"
+
+namespace apf {
+
+/* these are step-wise fields which are defined by nodes
+   at element centers, and the field value is constant
+   throughout an element and discontinuous between elements.
+   The first example is the gradient computed from a 1st-order
+   Lagrange field, another example is the per-element error estimate */
+template <int D>
+class Constant : public FieldShape
+{
+  public:
+    Constant()
+    {
+      std::stringstream ss;
+      ss << "Constant_" << D;
+      name = ss.str();
+      registerSelf(name.c_str());
+    }
+    const char* getName() const
+    {
+      return name.c_str();
+    }
+    class Element : public EntityShape
+    {
+      public:
+        void getValues(Mesh*, MeshEntity*,
+            Vector3 const&, NewArray<double>& values) const
+        {
+          values.allocate(1);
+          values[0] = 1;
+        }
+        void getLocalGradients(Mesh*, MeshEntity*,
+            Vector3 const&, NewArray<Vector3>& grads) const
+        {
+          grads.allocate(1);
+          grads[0] = Vector3( 0, 0, 0);
+        }
+        int countNodes() const {return 1;}
+        int getDimension() const {return D;}
+    };
+    EntityShape* getEntityShape(int type)
+    {
+      static Element element;
+      if (countNodesOn(type))
+        return &element;
+      return NULL;
+    }
+    bool hasNodesIn(int dimension)
+    {
+      if (dimension == D)
+        return true;
+      else
+        return false;
+    }
+    int countNodesOn(int type)
+    {
+      int dimension = Mesh::typeDimension[type];
+      if (dimension == D)
+        return 1;
+      else
+        return 0;
+   }
+    int getOrder() {return 0;}
+    bool isElementInvariant(int) {return true;}
+  private:
+    std::string name;
+};
+
+FieldShape* getConstant(int dimension)
+{
+  static Constant<0> c0;
+  static Constant<1> c1;
+  static Constant<2> c2;
+  static Constant<3> c3;
+  static FieldShape* const table[4] =
+  {&c0, &c1 ,&c2, &c3};
+  return table[dimension];
+}
+
+}//namespace apf
@@ -0,0 +1,271 @@
+/*
+ * Copyright 2025 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include <PCU.h>
+#include "apf.h"
+#include "apfMesh.h"
+#include <pcu_util.h>
+#include <algorithm>
+#include <climits>
+
+namespace apf {
+
+static void getRemotesArray(Mesh* m, MeshEntity* e, CopyArray& a)
+{
+  Copies remotes;
+  m->getRemotes(e, remotes);
+  a.setSize(remotes.size());
+  size_t i = 0;
+  APF_ITERATE(Copies, remotes, it) 
+  {
+    a[i].peer = it->first;
+    a[i].entity = it->second;
+    ++i;
+  }
+}
+
+NormalSharing::NormalSharing(Mesh* m):mesh(m) {}
+
+int NormalSharing::getOwner(MeshEntity* e)
+{
+  return mesh->getOwner(e);
+}
+
+bool NormalSharing::isOwned(MeshEntity* e)
+{
+  return mesh->isOwned(e);
+}
+
+void NormalSharing::getCopies(MeshEntity* e,
+      CopyArray& copies)
+{
+  if (!mesh->isShared(e))
+    return;
+  getRemotesArray(mesh, e, copies);
+}
+
+bool NormalSharing::isShared(MeshEntity* e) {
+  return mesh->isShared(e);
+}
+
+/* okay... so previously this used a min-rank rule
+   for matched copies, but thats inconsistent with
+   the min-count rule in MDS for regular copies,
+   and the usual partition model ignores matched
+   copies.
+   for now, we'll build a full neighbor count
+   system into this object just to implement
+   the min-count rule for matched neighbors */
+MatchedSharing::MatchedSharing(Mesh* m):
+  mesh(m),
+  helper(m)
+{
+  formCountMap();
+}
+
+size_t MatchedSharing::getNeighborCount(int peer)
+{
+  PCU_ALWAYS_ASSERT(countMap.count(peer));
+  return countMap[peer];
+}
+
+bool MatchedSharing::isLess(Copy const& a, Copy const& b)
+{
+  size_t ca = this->getNeighborCount(a.peer);
+  size_t cb = this->getNeighborCount(b.peer);
+  if (ca != cb)
+    return ca < cb;
+  if (a.peer != b.peer)
+    return a.peer < b.peer;
+  return a.entity < b.entity;
+}
+
+Copy MatchedSharing::getOwnerCopy(MeshEntity* e)
+{
+  Copy owner(PCU_Comm_Self(), e);
+  CopyArray copies;
+  this->getCopies(e, copies);
+  APF_ITERATE(CopyArray, copies, cit)
+    if (this->isLess(*cit, owner))
+      owner = *cit;
+  return owner;
+}
+
+int MatchedSharing::getOwner(MeshEntity* e)
+{
+  Copy owner = this->getOwnerCopy(e);
+  return owner.peer;
+}
+
+bool MatchedSharing::isOwned(MeshEntity* e)
+{
+  Copy owner = this->getOwnerCopy(e);
+  return owner.peer == PCU_Comm_Self() && owner.entity == e;
+}
+
+void MatchedSharing::getCopies(MeshEntity* e,
+    CopyArray& copies)
+{
+  mesh->getMatches(e, copies);
+  if (!copies.getSize())
+    helper.getCopies(e, copies);
+}
+
+void MatchedSharing::getNeighbors(Parts& neighbors)
+{
+  MeshIterator* it = mesh->begin(0);
+  MeshEntity* v;
+  while ((v = mesh->iterate(it))) {
+    CopyArray copies;
+    this->getCopies(v, copies);
+    APF_ITERATE(CopyArray, copies, cit)
+      neighbors.insert(cit->peer);
+  }
+  mesh->end(it);
+  neighbors.erase(PCU_Comm_Self());
+}
+
+void MatchedSharing::formCountMap()
+{
+  size_t count = mesh->count(mesh->getDimension());
+  countMap[PCU_Comm_Self()] = count;
+  PCU_Comm_Begin();
+  Parts neighbors;
+  getNeighbors(neighbors);
+  APF_ITERATE(Parts, neighbors, nit)
+    PCU_COMM_PACK(*nit, count);
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    size_t oc;
+    PCU_COMM_UNPACK(oc);
+    countMap[PCU_Comm_Sender()] = oc;
+  }
+}
+
+bool MatchedSharing::isShared(MeshEntity* e) {
+  CopyArray copies;
+  this->getCopies(e, copies);
+  APF_ITERATE(CopyArray, copies, it)
+    if (it->peer != PCU_Comm_Self())
+      return true;
+  return false;
+}
+
+Sharing* getSharing(Mesh* m)
+{
+  if (m->hasMatching())
+    return new MatchedSharing(m);
+  return new NormalSharing(m);
+}
+
+CachedSharing::CachedSharing(Mesh* m, Sharing* s):
+  mesh(m),
+  inner(s),
+  changes(m->countChanges()),
+  self(PCU_Comm_Self())
+{
+  for (int d = 0; d < 4; ++d)
+    tabulated[d] = false;
+  int n = m->countStorageKeys();
+  known.assign(n, false);
+  owned.assign(n, false);
+  shared.assign(n, false);
+}
+
+CachedSharing::~CachedSharing()
+{
+  delete inner;
+}
+
+void CachedSharing::tabulate(int dimension)
+{
+  tabulated[dimension] = true;
+  if (known.empty())
+    return;
+  size_t elsewhere = owners.size();
+  MeshIterator* it = mesh->begin(dimension);
+  MeshEntity* e;
+  while ((e = mesh->iterate(it))) {
+    int k = mesh->getStorageKey(e);
+    known[k] = true;
+    owned[k] = inner->isOwned(e);
+    shared[k] = inner->isShared(e);
+    if (!owned[k])
+      owners.push_back(std::make_pair(k, inner->getOwner(e)));
+  }
+  mesh->end(it);
+  std::inplace_merge(owners.begin(), owners.begin() + elsewhere,
+      owners.end());
+}
+
+/* the key of (e) if the tables hold it, otherwise -1 */
+int CachedSharing::find(MeshEntity* e)
+{
+  if (mesh->countChanges() != changes)
+    return -1;
+  int k = mesh->getStorageKey(e);
+  if (k < 0 || size_t(k) >= known.size())
+    return -1;
+  if (known[k])
+    return k;
+  int d = getDimension(mesh, e);
+  if (tabulated[d])
+    return -1;
+  tabulate(d);
+  return k;
+}
+
+int CachedSharing::getOwner(MeshEntity* e)
+{
+  int k = find(e);
+  if (k < 0)
+    return inner->getOwner(e);
+  if (owned[k])
+    return self;
+  std::vector<std::pair<int, int> >::iterator it = std::lower_bound(
+      owners.begin(), owners.end(), std::make_pair(k, INT_MIN));
+  return it->second;
+}
+
+bool CachedSharing::isOwned(MeshEntity* e)
+{
+  int k = find(e);
+  if (k < 0)
+    return inner->isOwned(e);
+  return owned[k];
+}
+
+/* copies are not tabulated: matching may give
+   an entity copies on its own part */
+void CachedSharing::getCopies(MeshEntity* e,
+    CopyArray& copies)
+{
+  inner->getCopies(e, copies);
+}
+
+bool CachedSharing::isShared(MeshEntity* e)
+{
+  int k = find(e);
+  if (k < 0)
+    return inner->isShared(e);
+  return shared[k];
+}
+
+Sharing* Mesh::getCachedSharing()
+{
+  if (!sharing)
+    sharing = new CachedSharing(this, apf::getSharing(this));
+  return sharing;
+}
+
+void Mesh::clearSharing()
+{
+  delete sharing;
+  sharing = 0;
+}
+
+}
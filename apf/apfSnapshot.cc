@@ -0,0 +1,172 @@
+/*
+ * Copyright 2011 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apfSnapshot.h"
+#include "apf.h"
+#include "apfShape.h"
+#include <pcu_util.h>
+
+namespace apf {
+
+namespace {
+
+/* the vertex numbers, by storage key when the mesh has
+   keys and in a temporary tag otherwise */
+class VertexNumbers
+{
+  public:
+    VertexNumbers(Mesh* m, std::vector<MeshEntity*> const& verts):
+      mesh(m),tag(0)
+    {
+      int nkeys = m->countStorageKeys();
+      if (nkeys)
+        byKey.assign(nkeys, -1);
+      else
+        tag = m->createIntTag("apf_snapshot_number", 1);
+      for (size_t i = 0; i < verts.size(); ++i) {
+        int n = i;
+        if (tag)
+          m->setIntTag(verts[i], tag, &n);
+        else
+          byKey[m->getStorageKey(verts[i])] = n;
+      }
+    }
+    ~VertexNumbers()
+    {
+      if (!tag)
+        return;
+      removeTagFromDimension(mesh, tag, 0);
+      mesh->destroyTag(tag);
+    }
+    int get(MeshEntity* v)
+    {
+      if (!tag)
+        return byKey[mesh->getStorageKey(v)];
+      int n;
+      mesh->getIntTag(v, tag, &n);
+      return n;
+    }
+  private:
+    Mesh* mesh;
+    MeshTag* tag;
+    std::vector<int> byKey;
+};
+
+void getModels(Mesh* m, std::vector<MeshEntity*> const& ents,
+    std::vector<int>& models)
+{
+  models.resize(ents.size() * 2);
+  for (size_t i = 0; i < ents.size(); ++i) {
+    ModelEntity* g = m->toModel(ents[i]);
+    models[i * 2 + 0] = g ? m->getModelType(g) : -1;
+    models[i * 2 + 1] = g ? m->getModelTag(g) : -1;
+  }
+}
+
+void layOut(Mesh* m, SnapshotField& sf)
+{
+  FieldShape* s = getShape(sf.field);
+  sf.components = countComponents(sf.field);
+  size_t n = 0;
+  for (int d = 0; d < 4; ++d) {
+    sf.nodes[d] = 0;
+    sf.start[d] = n;
+    if (d > m->getDimension() || !s->hasNodesIn(d))
+      continue;
+    std::vector<MeshEntity*> const& ents = m->getConnectivity(d).elements;
+    if (ents.empty())
+      continue;
+    sf.nodes[d] = s->countNodesOn(m->getType(ents[0]));
+    for (size_t i = 1; i < ents.size(); ++i)
+      if (s->countNodesOn(m->getType(ents[i])) != sf.nodes[d])
+        fail("apf::makeSnapshot: field nodes vary within a dimension\n");
+    n += ents.size() * sf.nodes[d];
+  }
+  sf.values.resize(n * sf.components);
+}
+
+}
+
+Snapshot* makeSnapshot(Mesh* m, Field** fields, int n)
+{
+  Snapshot* s = new Snapshot();
+  s->mesh = m;
+  s->dimension = m->getDimension();
+  std::vector<MeshEntity*> const& verts = m->getConnectivity(0).elements;
+  Connectivity const& c = m->getConnectivity(s->dimension);
+  s->changes = m->countChanges();
+  s->coordinates.resize(verts.size() * 3);
+  for (size_t i = 0; i < verts.size(); ++i) {
+    Vector3 x;
+    m->getPoint(verts[i], 0, x);
+    x.toArray(&s->coordinates[i * 3]);
+  }
+  s->types.resize(c.elements.size());
+  for (size_t i = 0; i < c.elements.size(); ++i)
+    s->types[i] = m->getType(c.elements[i]);
+  s->offsets = c.offsets;
+  s->vertices.resize(c.vertices.size());
+  VertexNumbers numbers(m, verts);
+  for (size_t i = 0; i < c.vertices.size(); ++i)
+    s->vertices[i] = numbers.get(c.vertices[i]);
+  getModels(m, verts, s->vertexModels);
+  getModels(m, c.elements, s->elementModels);
+  s->fields.resize(n);
+  for (int i = 0; i < n; ++i) {
+    s->fields[i].field = fields[i];
+    layOut(m, s->fields[i]);
+    readSnapshotField(s, i);
+  }
+  return s;
+}
+
+void readSnapshotField(Snapshot* s, int i)
+{
+  Mesh* m = s->mesh;
+  PCU_ALWAYS_ASSERT(m->countChanges() == s->changes);
+  SnapshotField& sf = s->fields.at(i);
+  for (int d = 0; d <= s->dimension; ++d) {
+    if (!sf.nodes[d])
+      continue;
+    std::vector<MeshEntity*> const& ents = m->getConnectivity(d).elements;
+    double* out = &sf.values[sf.start[d] * sf.components];
+    for (size_t e = 0; e < ents.size(); ++e)
+      for (int node = 0; node < sf.nodes[d]; ++node) {
+        getComponents(sf.field, ents[e], node, out);
+        out += sf.components;
+      }
+  }
+}
+
+void writeSnapshotField(Snapshot* s, int i, double const* values)
+{
+  Mesh* m = s->mesh;
+  PCU_ALWAYS_ASSERT(m->countChanges() == s->changes);
+  SnapshotField& sf = s->fields.at(i);
+  if (sf.values.empty())
+    return;
+  if (values != &sf.values[0])
+    sf.values.assign(values, values + sf.values.size());
+  for (int d = 0; d <= s->dimension; ++d) {
+    if (!sf.nodes[d])
+      continue;
+    std::vector<MeshEntity*> const& ents = m->getConnectivity(d).elements;
+    double const* in = &sf.values[sf.start[d] * sf.components];
+    for (size_t e = 0; e < ents.size(); ++e)
+      for (int node = 0; node < sf.nodes[d]; ++node) {
+        setComponents(sf.field, ents[e], node, in);
+        in += sf.components;
+      }
+  }
+}
+
+void destroySnapshot(Snapshot* s)
+{
+  delete s;
+}
+
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2011 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef APF_SNAPSHOT_H
+#define APF_SNAPSHOT_H
+
+/** \file apfSnapshot.h
+  \brief flat arrays of a mesh part for element kernels off the mesh */
+
+#include "apfMesh.h"
+#include <vector>
+
+namespace apf {
+
+class Field;
+
+/** \brief the node values of one field in an apf::Snapshot
+  \details the values of the entities of each dimension follow one
+  another, the entities in apf::Mesh::getConnectivity order, with
+  (nodes[d]) nodes per entity of dimension (d) and (components)
+  values per node. The value (c) of node (n) of entity (i) of
+  dimension (d) is values[(start[d] + i * nodes[d] + n) * components + c] */
+struct SnapshotField
+{
+  /** \brief the field the values came from */
+  Field* field;
+  /** \brief values per node */
+  int components;
+  /** \brief nodes per entity of each dimension, zero where there are none */
+  int nodes[4];
+  /** \brief the node number of the first node on each dimension */
+  size_t start[4];
+  /** \brief all the node values */
+  std::vector<double> values;
+};
+
+/** \brief a mesh part as flat arrays of numbers
+  \details meant for kernels that run away from the mesh database,
+  as on an accelerator: each array is contiguous, holds only numbers
+  and indices, and can be copied to device memory in one transfer or
+  wrapped in an unmanaged view. Vertices are numbered in the order of
+  apf::Mesh::getConnectivity of dimension zero and elements in that
+  of the mesh dimension, so building a snapshot reuses and fills
+  those tables. A snapshot is only valid while the mesh keeps the
+  structure it was made at, see apf::Mesh::countChanges. */
+struct Snapshot
+{
+  /** \brief the mesh the snapshot was made of */
+  Mesh* mesh;
+  /** \brief apf::Mesh::countChanges when the snapshot was made */
+  unsigned long changes;
+  /** \brief the mesh dimension */
+  int dimension;
+  /** \brief x, y and z of each vertex */
+  std::vector<double> coordinates;
+  /** \brief the apf::Mesh::Type of each element */
+  std::vector<int> types;
+  /** \brief where the vertices of each element start in (vertices),
+    with one more entry at the end */
+  std::vector<int> offsets;
+  /** \brief the vertex numbers of the elements, in canonical order */
+  std::vector<int> vertices;
+  /** \brief model dimension and model tag of each vertex */
+  std::vector<int> vertexModels;
+  /** \brief model dimension and model tag of each element */
+  std::vector<int> elementModels;
+  /** \brief the fields given to apf::makeSnapshot, in that order */
+  std::vector<SnapshotField> fields;
+};
+
+/** \brief gather the flat arrays of a mesh part
+  \details the fields must have the same number of nodes on every
+  entity of a dimension, as Lagrange and integration point fields
+  on meshes of one element type do.
+  \param fields the fields whose node values to gather, may be zero
+  \param n the number of fields */
+Snapshot* makeSnapshot(Mesh* m, Field** fields = 0, int n = 0);
+
+/** \brief gather the values of field (i) of the snapshot again */
+void readSnapshotField(Snapshot* s, int i);
+
+/** \brief write node values into field (i) of the snapshot
+  \details sets every node of the field from (values), laid out as
+  SnapshotField::values, which is also updated. Values computed on
+  an accelerator can be copied back into SnapshotField::values and
+  written by passing that array. Each part writes the copies it has;
+  call apf::synchronize afterwards if only owned values are right.
+  The mesh must not have changed since the snapshot was made. */
+void writeSnapshotField(Snapshot* s, int i, double const* values);
+
+/** \brief destroy a snapshot made by apf::makeSnapshot */
+void destroySnapshot(Snapshot* s);
+
+}
+
+#endif
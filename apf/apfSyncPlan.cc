@@ -0,0 +1,299 @@
+#include <PCU.h>
+#include "apf.h"
+#include "apfField.h"
+#include "apfFieldData.h"
+#include "apfShape.h"
+#include <pcu_util.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace apf {
+
+/* the entities exchanged with one peer, in message order */
+struct PeerList
+{
+  PeerList():values(0) {}
+  std::vector<MeshEntity*> entities;
+  int values;
+};
+
+typedef std::map<int, PeerList> PeerLists;
+
+/* one direction of communication: what to gather into messages
+   to each peer and where to scatter what arrives from each peer */
+struct Exchange
+{
+  PeerLists sends;
+  PeerLists receives;
+  std::vector<int> neighbors;
+};
+
+class SyncPlan
+{
+  public:
+    Field* field;
+    Exchange broadcast; /* owners to copies and ghosts */
+    Exchange gather; /* non-owners to all other copies */
+};
+
+static void addSend(Exchange& x, Field* f, MeshEntity* e,
+    int peer, MeshEntity* remote)
+{
+  PeerList& l = x.sends[peer];
+  l.entities.push_back(e);
+  l.values += f->countValuesOn(e);
+  PCU_COMM_PACK(peer, remote);
+}
+
+/* the receiver learns its entities in the order
+   the sender will pack their values */
+static void receiveEntities(Exchange& x, Field* f)
+{
+  PCU_Comm_Send();
+  while (PCU_Comm_Listen()) {
+    PeerList& l = x.receives[PCU_Comm_Sender()];
+    while ( ! PCU_Comm_Unpacked()) {
+      MeshEntity* e;
+      PCU_COMM_UNPACK(e);
+      l.entities.push_back(e);
+      l.values += f->countValuesOn(e);
+    }
+  }
+  APF_ITERATE(PeerLists, x.sends, it)
+    x.neighbors.push_back(it->first);
+  APF_ITERATE(PeerLists, x.receives, it)
+    if ( ! x.sends.count(it->first))
+      x.neighbors.push_back(it->first);
+}
+
+static void planBroadcast(Exchange& x, Field* f, Sharing* shr)
+{
+  Mesh* m = f->getMesh();
+  FieldShape* s = f->getShape();
+  FieldDataOf<double>* data = f->getData();
+  PCU_Comm_Begin();
+  for (int d = 0; d < 4; ++d) {
+    if ( ! s->hasNodesIn(d))
+      continue;
+    MeshEntity* e;
+    MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      if (( ! data->hasEntity(e)) || ( ! shr->isOwned(e)))
+        continue;
+      CopyArray copies;
+      shr->getCopies(e, copies);
+      for (size_t i = 0; i < copies.getSize(); ++i)
+        addSend(x, f, e, copies[i].peer, copies[i].entity);
+      Copies ghosts;
+      if (m->getGhosts(e, ghosts))
+        APF_ITERATE(Copies, ghosts, git)
+          addSend(x, f, e, git->first, git->second);
+    }
+    m->end(it);
+  }
+  receiveEntities(x, f);
+}
+
+static void planGather(Exchange& x, Field* f, Sharing* shr)
+{
+  Mesh* m = f->getMesh();
+  FieldShape* s = f->getShape();
+  FieldDataOf<double>* data = f->getData();
+  PCU_Comm_Begin();
+  for (int d = 0; d < 4; ++d) {
+    if ( ! s->hasNodesIn(d))
+      continue;
+    MeshEntity* e;
+    MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      if (( ! data->hasEntity(e)) || m->isGhost(e) || shr->isOwned(e))
+        continue;
+      CopyArray copies;
+      shr->getCopies(e, copies);
+      for (size_t i = 0; i < copies.getSize(); ++i)
+        addSend(x, f, e, copies[i].peer, copies[i].entity);
+    }
+    m->end(it);
+  }
+  receiveEntities(x, f);
+}
+
+SyncPlan* makeSyncPlan(Field* f, Sharing* shr)
+{
+  if (!shr)
+    shr = f->getMesh()->getCachedSharing();
+  SyncPlan* p = new SyncPlan();
+  p->field = f;
+  planBroadcast(p->broadcast, f, shr);
+  planGather(p->gather, f, shr);
+  return p;
+}
+
+/* all dimensions go in one neighbor phase, and messages
+   hold only values since both sides know the entities */
+static void run(Field* f, Exchange& x, bool add)
+{
+  FieldDataOf<double>* data = f->getData();
+  PCU_Comm_Neighbors(x.neighbors.empty() ? 0 : &(x.neighbors[0]),
+      x.neighbors.size());
+  PCU_Comm_Begin_Neighbors();
+  APF_ITERATE(PeerLists, x.sends, it) {
+    PeerList& l = it->second;
+    double* out = PCU_COMM_RESERVE(it->first, double, l.values);
+    for (size_t i = 0; i < l.entities.size(); ++i) {
+      data->get(l.entities[i], out);
+      out += f->countValuesOn(l.entities[i]);
+    }
+  }
+  PCU_Comm_Send();
+  NewArray<double> values;
+  while (PCU_Comm_Receive()) {
+    PeerList& l = x.receives[PCU_Comm_Sender()];
+    double const* in = PCU_COMM_EXTRACT(double, l.values);
+    for (size_t i = 0; i < l.entities.size(); ++i) {
+      MeshEntity* e = l.entities[i];
+      int n = f->countValuesOn(e);
+      if (add) {
+        values.resize(n);
+        data->get(e, &(values[0]));
+        for (int j = 0; j < n; ++j)
+          values[j] += in[j];
+        data->set(e, &(values[0]));
+      } else
+        data->set(e, in);
+      in += n;
+    }
+  }
+}
+
+void synchronize(SyncPlan* p)
+{
+  run(p->field, p->broadcast, false);
+}
+
+void accumulate(SyncPlan* p)
+{
+  run(p->field, p->gather, true);
+  run(p->field, p->broadcast, false);
+}
+
+void destroySyncPlan(SyncPlan* p)
+{
+  delete p;
+}
+
+/* the fields with values on an entity, one bit each,
+   padded so the values after them stay aligned */
+static size_t countFlagBytes(int n)
+{
+  return ((n + 7) / 8 + sizeof(double) - 1)
+    / sizeof(double) * sizeof(double);
+}
+
+static void packFields(int peer, MeshEntity* remote,
+    std::vector<unsigned char>& flags, std::vector<double>& values)
+{
+  PCU_COMM_PACK(peer, remote);
+  PCU_Comm_Pack(peer, &(flags[0]), flags.size());
+  if (!values.empty())
+    PCU_Comm_Pack(peer, &(values[0]), values.size() * sizeof(double));
+}
+
+/* one phase over all dimensions and fields. owners send to their
+   copies and ghosts, or for a gather, non-owners send to all
+   other copies and the values are added on arrival */
+static void exchangeFields(Field* const* fields, int n, Sharing* shr,
+    bool gather)
+{
+  Mesh* m = fields[0]->getMesh();
+  std::vector<unsigned char> flags(countFlagBytes(n));
+  std::vector<double> values;
+  PCU_Comm_Begin();
+  for (int d = 0; d < 4; ++d) {
+    bool hasNodes = false;
+    for (int i = 0; i < n; ++i)
+      hasNodes = hasNodes || fields[i]->getShape()->hasNodesIn(d);
+    if (!hasNodes)
+      continue;
+    MeshEntity* e;
+    MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      if (gather ? (m->isGhost(e) || shr->isOwned(e)) : !shr->isOwned(e))
+        continue;
+      std::fill(flags.begin(), flags.end(), 0);
+      values.clear();
+      for (int i = 0; i < n; ++i) {
+        FieldDataOf<double>* data = fields[i]->getData();
+        if (( ! fields[i]->getShape()->hasNodesIn(d)) ||
+            ( ! data->hasEntity(e)))
+          continue;
+        flags[i / 8] |= (1 << (i % 8));
+        size_t at = values.size();
+        values.resize(at + fields[i]->countValuesOn(e));
+        data->get(e, &(values[at]));
+      }
+      if (values.empty())
+        continue;
+      CopyArray copies;
+      shr->getCopies(e, copies);
+      for (size_t i = 0; i < copies.getSize(); ++i)
+        packFields(copies[i].peer, copies[i].entity, flags, values);
+      Copies ghosts;
+      if ((!gather) && m->getGhosts(e, ghosts))
+        APF_ITERATE(Copies, ghosts, git)
+          packFields(git->first, git->second, flags, values);
+    }
+    m->end(it);
+  }
+  PCU_Comm_Send();
+  NewArray<double> sum;
+  while (PCU_Comm_Receive()) {
+    MeshEntity* e;
+    PCU_COMM_UNPACK(e);
+    unsigned char const* in =
+      PCU_COMM_EXTRACT(unsigned char, countFlagBytes(n));
+    for (int i = 0; i < n; ++i) {
+      if ( ! (in[i / 8] & (1 << (i % 8))))
+        continue;
+      FieldDataOf<double>* data = fields[i]->getData();
+      int nv = fields[i]->countValuesOn(e);
+      double const* v = PCU_COMM_EXTRACT(double, nv);
+      if (gather) {
+        sum.resize(nv);
+        data->get(e, &(sum[0]));
+        for (int j = 0; j < nv; ++j)
+          sum[j] += v[j];
+        data->set(e, &(sum[0]));
+      } else
+        data->set(e, v);
+    }
+  }
+}
+
+static void exchangeFields(Field* const* fields, int n, Sharing* shr,
+    bool gather, bool broadcast)
+{
+  if (!n)
+    return;
+  for (int i = 1; i < n; ++i)
+    PCU_ALWAYS_ASSERT(fields[i]->getMesh() == fields[0]->getMesh());
+  if (!shr)
+    shr = fields[0]->getMesh()->getCachedSharing();
+  if (gather)
+    exchangeFields(fields, n, shr, true);
+  if (broadcast)
+    exchangeFields(fields, n, shr, false);
+}
+
+void synchronize(Field* const* fields, int n, Sharing* shr)
+{
+  exchangeFields(fields, n, shr, false, true);
+}
+
+void accumulate(Field* const* fields, int n, Sharing* shr)
+{
+  exchangeFields(fields, n, shr, true, true);
+}
+
+}
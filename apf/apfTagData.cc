@@ -8,7 +8,9 @@
 #include "apfTagData.h"
 #include "apfShape.h"
 
+#include <PCU.h>
 #include <pcu_util.h>
+#include <cstring>
 
 namespace apf {
 
@@ -73,6 +75,7 @@ void TagData::createTags(const char* name, int components)
       tagName += '_';
       tagName += typePostfix[type];
       tags[type] = makeOrFindTag(tagName.c_str(),n*components);
+      mesh->chargeTag(tags[type], PCU_MEM_FIELDS);
     }
     else
       tags[type] = 0;
@@ -110,4 +113,38 @@ void TagData::rename(const char* newName)
     }
 }
 
+void FloatTagData::init(FieldBase* f)
+{
+  PCU_ALWAYS_ASSERT(sizeof(float) == sizeof(int));
+  this->FieldData::field = f;
+  mesh = f->getMesh();
+  tagData.init(f->getName(), mesh, f->getShape(), &helper,
+      f->countComponents());
+}
+
+void FloatTagData::get(MeshEntity* e, double* data)
+{
+  MeshTag* t = tagData.getTag(e);
+  int n = mesh->getTagSize(t);
+  bits.allocate(n);
+  helper.get(mesh, e, t, &bits[0]);
+  for (int i = 0; i < n; ++i) {
+    float x;
+    memcpy(&x, &bits[i], sizeof(x));
+    data[i] = x;
+  }
+}
+
+void FloatTagData::set(MeshEntity* e, double const* data)
+{
+  MeshTag* t = tagData.getTag(e);
+  int n = mesh->getTagSize(t);
+  bits.allocate(n);
+  for (int i = 0; i < n; ++i) {
+    float x = data[i];
+    memcpy(&bits[i], &x, sizeof(x));
+  }
+  helper.set(mesh, e, t, &bits[0]);
+}
+
 }
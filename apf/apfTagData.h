@@ -125,6 +125,11 @@ class TagDataOf : public FieldDataOf<T>
     {
       helper.set(mesh,e,tagData.getTag(e),data);
     }
+    virtual T const* getPointer(MeshEntity* e)
+    {
+      return static_cast<T const*>(
+          mesh->getTagPointer(e,tagData.getTag(e)));
+    }
     virtual bool isFrozen()
     {
       return false;
@@ -143,6 +148,26 @@ class TagDataOf : public FieldDataOf<T>
     TagHelper<T> helper;
 };
 
+/* double values kept in single precision, as the bits of int tags
+   so that every mesh can store and migrate them at half the size */
+class FloatTagData : public FieldDataOf<double>
+{
+  public:
+    virtual void init(FieldBase* f);
+    virtual bool hasEntity(MeshEntity* e) {return tagData.hasEntity(e);}
+    virtual void removeEntity(MeshEntity* e) {tagData.removeEntity(e);}
+    virtual void get(MeshEntity* e, double* data);
+    virtual void set(MeshEntity* e, double const* data);
+    virtual bool isFrozen() {return false;}
+    virtual FieldData* clone() {return new FloatTagData();}
+    virtual void rename(const char* newName) {tagData.rename(newName);}
+  private:
+    Mesh* mesh;
+    TagData tagData;
+    TagHelper<int> helper;
+    NewArray<int> bits;
+};
+
 }
 
 #endif
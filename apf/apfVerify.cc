@@ -77,7 +77,7 @@ static void getUpwardCounts(gmi_model* gm, int meshDimension, UpwardCounts& uc)
   }
 }
 
-static void verifyUp(Mesh* m, UpwardCounts& guc,
+static void verifyUp(Mesh* m, UpwardCounts const& guc,
     MeshEntity* e, bool abort_on_error)
 {
   apf::Up up;
@@ -99,7 +99,8 @@ static void verifyUp(Mesh* m, UpwardCounts& guc,
   PCU_ALWAYS_ASSERT(difference);
   ModelEntity* ge = m->toModel(e);
   int modelDimension = m->getModelType(ge);
-  int modelUpwardCount = guc[ge];
+  UpwardCounts::const_iterator git = guc.find(ge);
+  int modelUpwardCount = (git == guc.end()) ? 0 : git->second;
   bool isOnNonManifoldFace = (modelDimension == meshDimension - 1) &&
                              (modelUpwardCount > 1);
   bool isOnManifoldBoundary = ( ! isOnNonManifoldFace) &&
@@ -193,7 +194,7 @@ static void verifyResidence(Mesh* m, MeshEntity* e)
     PCU_ALWAYS_ASSERT(p.count(it->first));
 }
 
-static void verifyEntity(Mesh* m, UpwardCounts& guc, MeshEntity* e, bool abort_on_error)
+static void verifyEntity(Mesh* m, UpwardCounts const& guc, MeshEntity* e, bool abort_on_error)
 {
   int ed = getDimension(m, e);
   int md = m->getDimension();
@@ -253,46 +254,108 @@ static void unpackCopies(
   }
 }
 
-static void sendAllCopies(Mesh* m, MeshEntity* e)
+static void receiveAllCopies(Mesh* m, MeshEntity* e)
 {
   Copies a;
-  Copies r;
-  a = getAllCopies(m, e);
-  verifyAllCopies(a);
-  m->getRemotes(e, r);
-  PCU_ALWAYS_ASSERT(!r.count(PCU_Comm_Self()));
-  APF_ITERATE(Copies, r, it)
-  {
-    PCU_COMM_PACK(it->first, it->second);
-    packCopies(it->first, a);
+  unpackCopies(a);
+  Copies b = getAllCopies(m, e);
+  PCU_ALWAYS_ASSERT(a == b);
+}
+
+/* for each copy: its full set of copies unless it is a ghost,
+   then its downward entities on the receiver, or for a vertex
+   its coordinates and parametric coordinates */
+static void sendCopy(Mesh* m, MeshEntity* e, int d, int ghost,
+    Copies& all, int to, MeshEntity* r)
+{
+  PCU_COMM_PACK(to, r);
+  PCU_COMM_PACK(to, ghost);
+  if (!ghost)
+    packCopies(to, all);
+  if (d) {
+    Downward down;
+    int nd = m->getDownward(e, d - 1, down);
+    for (int i = 0; i < nd; ++i) {
+      Copies remotes;
+      m->getRemotes(down[i], remotes);
+      MeshEntity* dr = remotes[to];
+      PCU_COMM_PACK(to, dr);
+    }
+  } else {
+    Vector3 x;
+    m->getPoint(e, 0, x);
+    Vector3 p(0,0,0);
+    m->getParam(e, p);
+    PCU_COMM_PACK(to, x);
+    PCU_COMM_PACK(to, p);
   }
 }
 
-static void receiveAllCopies(Mesh* m)
+/* returns false if the coordinates of a vertex differ */
+static bool receiveCopy(Mesh* m)
 {
   MeshEntity* e;
   PCU_COMM_UNPACK(e);
-  Copies a;
-  unpackCopies(a);
-  Copies b = getAllCopies(m, e);
-  PCU_ALWAYS_ASSERT(a == b);
+  int ghost;
+  PCU_COMM_UNPACK(ghost);
+  if (!ghost)
+    receiveAllCopies(m, e);
+  int d = getDimension(m, e);
+  if (d) {
+    Downward down;
+    int nd = m->getDownward(e, d - 1, down);
+    for (int i = 0; i < nd; ++i) {
+      MeshEntity* dr;
+      PCU_COMM_UNPACK(dr);
+      PCU_ALWAYS_ASSERT(down[i] == dr);
+    }
+    return true;
+  }
+  Vector3 ox;
+  Vector3 op;
+  PCU_COMM_UNPACK(ox);
+  PCU_COMM_UNPACK(op);
+  Vector3 x;
+  Vector3 p(0,0,0);
+  m->getPoint(e, 0, x);
+  m->getParam(e, p);
+  return areClose(x, ox, 0.0) &&
+         areClose(p, op, 0.0);
 }
 
-static void verifyRemoteCopies(Mesh* m)
+/* verifies remote copies, the alignment of shared entities and
+   the coordinates of shared vertices in one exchange,
+   returning the number of coordinate mismatches */
+static long verifyCopies(Mesh* m)
 {
   PCU_Comm_Begin();
   for (int d = 0; d <= m->getDimension(); ++d)
   {
     MeshIterator* it = m->begin(d);
     MeshEntity* e;
-    while ((e = m->iterate(it)))
-      if (m->isShared(e) && !m->isGhost(e))
-        sendAllCopies(m, e);
+    while ((e = m->iterate(it))) {
+      if (!m->isShared(e))
+        continue;
+      int ghost = m->isGhost(e);
+      Copies all;
+      if (!ghost) {
+        all = getAllCopies(m, e);
+        verifyAllCopies(all);
+      }
+      Copies r;
+      m->getRemotes(e, r);
+      PCU_ALWAYS_ASSERT(!r.count(PCU_Comm_Self()));
+      APF_ITERATE(Copies, r, rit)
+        sendCopy(m, e, d, ghost, all, rit->first, rit->second);
+    }
     m->end(it);
   }
   PCU_Comm_Send();
+  long n = 0;
   while (PCU_Comm_Receive())
-    receiveAllCopies(m);
+    if (!receiveCopy(m))
+      ++n;
+  return PCU_Add_Long(n);
 }
 
 // ghost verification
@@ -408,55 +471,6 @@ static void verifyMatches(Mesh* m)
     receiveMatches(m);
 }
 
-static void sendCoords(Mesh* m, MeshEntity* e)
-{
-  Vector3 x;
-  m->getPoint(e, 0, x);
-  Vector3 p(0,0,0);
-  m->getParam(e, p);
-  Copies r;
-  m->getRemotes(e, r);
-  APF_ITERATE(Copies, r, it)
-  {
-    PCU_COMM_PACK(it->first, it->second);
-    PCU_COMM_PACK(it->first, x);
-    PCU_COMM_PACK(it->first, p);
-  }
-}
-
-static bool receiveCoords(Mesh* m)
-{
-  MeshEntity* e;
-  Vector3 ox;
-  Vector3 op;
-  PCU_COMM_UNPACK(e);
-  PCU_COMM_UNPACK(ox);
-  PCU_COMM_UNPACK(op);
-  Vector3 x;
-  Vector3 p(0,0,0);
-  m->getPoint(e, 0, x);
-  m->getParam(e, p);
-  return areClose(x, ox, 0.0) &&
-         areClose(p, op, 0.0);
-}
-
-static long verifyCoords(Mesh* m)
-{
-  PCU_Comm_Begin();
-  MeshIterator* it = m->begin(0);
-  MeshEntity* e;
-  while ((e = m->iterate(it)))
-    if (m->isShared(e))
-      sendCoords(m, e);
-  m->end(it);
-  PCU_Comm_Send();
-  long n = 0;
-  while (PCU_Comm_Receive())
-    if (!receiveCoords(m))
-      ++n;
-  return PCU_Add_Long(n);
-}
-
 long verifyVolumes(Mesh* m, bool printVolumes)
 {
   MeshIterator* it = m->begin(m->getDimension());
@@ -483,58 +497,6 @@ long verifyVolumes(Mesh* m, bool printVolumes)
   return PCU_Add_Long(n);
 }
 
-static void packAlignment(Mesh* m, MeshEntity* e, MeshEntity* r, int to)
-{
-  PCU_COMM_PACK(to,r);
-  int d = getDimension(m, e);
-  Downward down;
-  int nd = m->getDownward(e, d - 1, down);
-  for (int i = 0; i < nd; ++i) {
-    Copies remotes;
-    m->getRemotes(down[i], remotes);
-    MeshEntity* dr = remotes[to];
-    PCU_COMM_PACK(to,dr);
-  }
-}
-
-static void sendAlignment(Mesh* m, MeshEntity* e)
-{
-  Copies remotes;
-  m->getRemotes(e, remotes);
-  APF_ITERATE(Copies, remotes, it)
-    packAlignment(m, e, it->second, it->first);
-}
-
-static void receiveAlignment(Mesh* m)
-{
-  MeshEntity* e;
-  PCU_COMM_UNPACK(e);
-  int d = getDimension(m, e);
-  Downward down;
-  int nd = m->getDownward(e, d - 1, down);
-  for (int i = 0; i < nd; ++i) {
-    PCU_COMM_UNPACK(e);
-    PCU_ALWAYS_ASSERT(down[i] == e);
-  }
-}
-
-static void verifyAlignment(Mesh* m)
-{
-  PCU_Comm_Begin();
-  for (int d = 1; d <= m->getDimension(); ++d)
-  {
-    MeshIterator* it = m->begin(d);
-    MeshEntity* e;
-    while ((e = m->iterate(it)))
-      if (m->isShared(e))
-        sendAlignment(m, e);
-    m->end(it);
-  }
-  PCU_Comm_Send();
-  while (PCU_Comm_Receive())
-    receiveAlignment(m);
-}
-
 void packFieldInfo(Field* f, int to)
 {
   std::string name; 
@@ -799,45 +761,116 @@ static void verifyTags(Mesh* m)
   receiveTagData(m, tags);
 }
 
-void verify(Mesh* m, bool abort_on_error)
+/* the local checks of the entities of one dimension,
+   one chunk of Mesh::beginChunk per thread */
+struct EntityChunks
 {
-  double t0 = PCU_Time();
-  verifyTags(m);
-  verifyFields(m);
+  static void verify(void* p, size_t first, size_t end)
+  {
+    EntityChunks* all = static_cast<EntityChunks*>(p);
+    Mesh* m = all->mesh;
+    for (size_t i = first; i < end; ++i) {
+      MeshIterator* it = m->beginChunk(all->dimension, i, all->chunks);
+      MeshEntity* e;
+      while ((e = m->iterate(it))) {
+        verifyEntity(m, *all->guc, e, all->abort_on_error);
+        ++all->counts[i];
+      }
+      m->end(it);
+    }
+  }
+  size_t run(int d)
+  {
+    dimension = d;
+    counts.assign(chunks, 0);
+    PCU_Thrd_Chunks(chunks, chunks, verify, this);
+    size_t n = 0;
+    for (int i = 0; i < chunks; ++i)
+      n += counts[i];
+    return n;
+  }
+  Mesh* mesh;
+  UpwardCounts const* guc;
+  bool abort_on_error;
+  int dimension;
+  int chunks;
+  std::vector<size_t> counts;
+};
 
+static void verifyStructure(Mesh* m, bool abort_on_error, int threads)
+{
   UpwardCounts guc;
   getUpwardCounts(m->getModel(), m->getDimension(), guc);
+  EntityChunks chunks;
+  chunks.mesh = m;
+  chunks.guc = &guc;
+  chunks.abort_on_error = abort_on_error;
+  chunks.chunks = threads < 1 ? 1 : threads;
   /* got to 3 on purpose, so we can verify if
      m->getDimension is lying */
   for (int d = 0; d <= 3; ++d)
   {
-    MeshIterator* it = m->begin(d);
-    MeshEntity* e;
-    size_t n = 0;
-    while ((e = m->iterate(it)))
-    {
-      verifyEntity(m, guc, e, abort_on_error);
-      ++n;
-    }
-    m->end(it);
+    size_t n = chunks.run(d);
     PCU_ALWAYS_ASSERT(n == m->count(d));
     if (d > m->getDimension())
       PCU_ALWAYS_ASSERT(!n);
   }
-  guc.clear();
-  verifyRemoteCopies(m);
-  verifyGhostCopies(m);
-  verifyAlignment(m);
-  verifyMatches(m);
-  long n = verifyCoords(m);
-  if (n && (!PCU_Comm_Self()))
-    fprintf(stderr,"apf::verify fail: %ld coordinate mismatches\n", n);
-  n = verifyVolumes(m);
-  if (n && (!PCU_Comm_Self()))
-    fprintf(stderr,"apf::verify warning: %ld negative simplex elements\n", n);
+}
+
+void verify(Mesh* m, VerifyLevel level, bool abort_on_error, int threads)
+{
+  PCU_Region region("apf::verify");
+  enum { STRUCTURE, COPIES, GHOSTS, TAGS, VOLUMES, CHECKS };
+  static char const* const names[CHECKS] =
+  {"structure", "copies", "ghosts and matches", "tags and fields",
+   "volumes"};
+  double times[CHECKS] = {0, 0, 0, 0, 0};
+  double t0 = PCU_Time();
+  double t = t0;
+  verifyStructure(m, abort_on_error, threads);
+  times[STRUCTURE] = PCU_Time() - t;
+  if (level >= VERIFY_PARALLEL) {
+    t = PCU_Time();
+    long n = verifyCopies(m);
+    if (n && (!PCU_Comm_Self()))
+      fprintf(stderr,"apf::verify fail: %ld coordinate mismatches\n", n);
+    times[COPIES] = PCU_Time() - t;
+    t = PCU_Time();
+    verifyGhostCopies(m);
+    verifyMatches(m);
+    times[GHOSTS] = PCU_Time() - t;
+  }
+  if (level >= VERIFY_ALL) {
+    t = PCU_Time();
+    verifyTags(m);
+    verifyFields(m);
+    times[TAGS] = PCU_Time() - t;
+    t = PCU_Time();
+    long n = verifyVolumes(m);
+    if (n && (!PCU_Comm_Self()))
+      fprintf(stderr,"apf::verify warning: %ld negative simplex elements\n", n);
+    times[VOLUMES] = PCU_Time() - t;
+  }
   double t1 = PCU_Time();
-  if (!PCU_Comm_Self())
-    printf("mesh verified in %f seconds\n", t1 - t0);
+  PCU_Max_Doubles(times, CHECKS);
+  if (!PCU_Comm_Self()) {
+    std::stringstream ss;
+    ss << "mesh verified in " << std::fixed << (t1 - t0) << " seconds (";
+    int last = STRUCTURE;
+    if (level >= VERIFY_PARALLEL)
+      last = GHOSTS;
+    if (level >= VERIFY_ALL)
+      last = VOLUMES;
+    for (int i = 0; i <= last; ++i)
+      ss << names[i] << ' ' << times[i] << (i < last ? ", " : ")\n");
+    std::string s = ss.str();
+    printf("%s", s.c_str());
+  }
+}
+
+void verify(Mesh* m, bool abort_on_error)
+{
+  verify(m, VERIFY_ALL, abort_on_error);
 }
 
 }
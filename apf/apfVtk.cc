@@ -13,6 +13,7 @@
 #include "apfNumberingClass.h"
 #include "apfShape.h"
 #include "apfFieldData.h"
+#include "apfVtk.h"
 #include <sstream>
 #include <fstream>
 #include <pcu_util.h>
@@ -82,6 +83,30 @@ static bool isIP(FieldBase* f, int cellDim)
   return s->hasNodesIn(cellDim);
 }
 
+/* while a piece is written as raw appended data, its encoded
+   arrays collect here and each DataArray points at its offset */
+static std::string* appendedData = 0;
+
+/* while a piece is snapshot for an asynchronous write, its binary
+   arrays collect here, see apf::snapshotPiece */
+static VtkSnapshot* snapshot = 0;
+
+void describeFormat(std::ostream& file, bool isWritingBinary)
+{
+  if (!isWritingBinary)
+  {
+    file << " format=\"ascii\"";
+  }
+  else if (appendedData)
+  {
+    file << " format=\"appended\" offset=\"" << appendedData->size() << "\"";
+  }
+  else
+  {
+    file << " format=\"binary\"";
+  }
+}
+
 static void describeArray(
     std::ostream& file,
     const char* name,
@@ -93,15 +118,8 @@ static void describeArray(
   const char* typeNames[3] = {"Float64","Int32","Int64"};
   file << typeNames[type];
   file << "\" Name=\"" << name;
-  file << "\" NumberOfComponents=\"" << size;
-  if (isWritingBinary)
-  {
-    file << "\" format=\"binary\"";
-  }
-  else
-  {
-    file << "\" format=\"ascii\"";
-  }
+  file << "\" NumberOfComponents=\"" << size << "\"";
+  describeFormat(file, isWritingBinary);
 }
 
 static void writePDataArray(
@@ -248,7 +266,7 @@ static void writePCellData(std::ostream& file,
   file << "</PCellData>\n";
 }
 
-static std::string getPieceFileName(int id)
+std::string getPieceFileName(int id)
 {
   std::stringstream ss;
   ss << id << ".vtu";
@@ -273,9 +291,9 @@ static std::string getRelativePathPSource(int id)
   return ss.str();
 }
 
-static void writePSources(std::ostream& file)
+static void writePSources(std::ostream& file, int sources)
 {
-  for (int i=0; i < PCU_Comm_Peers(); ++i)
+  for (int i=0; i < sources; ++i)
   {
     std::string fileName = stripPath(getPieceFileName(i));
     std::string fileNameAndPath = getRelativePathPSource(i) + fileName;
@@ -287,21 +305,21 @@ static void writePvtuFile(const char* prefix,
     Mesh* m,
     std::vector<std::string> writeFields,
     bool isWritingBinary,
-    int cellDim)
+    int cellDim,
+    int sources)
 {
   std::string fileName = stripPath(prefix);
   fileName += ".pvtu";
   std::stringstream ss;
   ss << prefix << '/' << fileName;
-  std::string fileNameAndPath = ss.str();
-  std::ofstream file(fileNameAndPath.c_str());
-  PCU_ALWAYS_ASSERT(file.is_open());
+  VtkFile vtk(ss.str());
+  std::ofstream& file = vtk.file;
   file << "<VTKFile type=\"PUnstructuredGrid\">\n";
   file << "<PUnstructuredGrid GhostLevel=\"0\">\n";
   writePPoints(file,m->getCoordinateField(),isWritingBinary);
   writePPointData(file,m,writeFields,isWritingBinary);
   writePCellData(file, m, writeFields, isWritingBinary, cellDim);
-  writePSources(file);
+  writePSources(file, sources);
   file << "</PUnstructuredGrid>\n";
   file << "</VTKFile>\n";
 }
@@ -317,37 +335,17 @@ static void writeDataHeader(std::ostream& file,
   file << ">\n";
 }
 
-static void writeEncodedArray(std::ostream& file,
-    unsigned int dataLenBytes,
+void writeEncodedArray(std::ostream& file,
+    unsigned long dataLenBytes,
     char* dataToEncode)
 {
-  if ( lion::can_compress )
-  {
-    //build the data header and compress dataToEncode
-    long lensToEncode[4];
-    lensToEncode[0] = 1; //data is compressed in one block
-    lensToEncode[1] = dataLenBytes; //size of each block before compression
-    lensToEncode[2] = dataLenBytes; //size of the final block before compression
-    unsigned long dataCompressedLen = lion::compressBound(dataLenBytes);
-        //gets the size to allocate for the compressed data array
-    char* dataCompressed = new char[dataCompressedLen]();
-    lion::compress( (void*)dataCompressed,
-        dataCompressedLen,
-        (void*)dataToEncode,
-        dataLenBytes);
-        //compresses and sets dataCompressedLen to the size of the correct length
-    lensToEncode[3] = dataCompressedLen; //size of the compressed block
-    //encode and output the compressed data
-    file << lion::base64Encode( (char*)lensToEncode, sizeof(lensToEncode) );
-    file << lion::base64Encode( dataCompressed, dataCompressedLen ) << '\n';
-    delete[] dataCompressed;
-  }
-  else
+  if (snapshot)
   {
-    //not compressing, encode and output
-    file << lion::base64Encode( (char*)&dataLenBytes, sizeof(dataLenBytes) );
-    file << lion::base64Encode( dataToEncode, dataLenBytes ) << '\n';
+    snapshot->at.push_back(file.tellp());
+    snapshot->arrays.push_back(std::string(dataToEncode, dataLenBytes));
+    return;
   }
+  encodeArray(file, dataLenBytes, dataToEncode, appendedData);
 }
 
 /* Paraview/VTK has trouble with sub-normal double precision floating point
@@ -425,206 +423,6 @@ static void writePoints(std::ostream& file,
   file << "</Points>\n";
 }
 
-static int countElementNodes(Numbering* n, MeshEntity* e)
-{
-  return n->getShape()->getEntityShape(n->getMesh()->getType(e))->countNodes();
-}
-
-static void writeConnectivity(std::ostream& file,
-    Numbering* n,
-    bool isWritingBinary,
-    int cellDim)
-{
-  file << "<DataArray type=\"Int32\" Name=\"connectivity\"";
-  if (isWritingBinary)
-  {
-    file << " format=\"binary\"";
-  }
-  else
-  {
-    file << " format=\"ascii\"";
-  }
-  file << ">\n";
-  Mesh* m = n->getMesh();
-  MeshEntity* e;
-  if (isWritingBinary)
-  {
-    MeshIterator* elements = m->begin(cellDim);
-    unsigned int dataLen = 0;
-    while ((e = m->iterate(elements)))
-    {
-      dataLen += countElementNodes(n,e);
-    }
-    m->end(elements);
-    unsigned int dataLenBytes = dataLen*sizeof(int);
-    int* dataToEncode = new int[dataLen]();
-    elements = m->begin(cellDim);
-    unsigned int dataIndex = 0;
-    while ((e = m->iterate(elements)))
-    {
-      int nen = countElementNodes(n,e);
-      NewArray<int> numbers(nen);
-      getElementNumbers(n,e,numbers);
-      for (int i=0; i < nen; ++i)
-      {
-        dataToEncode[dataIndex] = numbers[i];
-        dataIndex++;
-      }
-    }
-    m->end(elements);
-    writeEncodedArray(file, dataLenBytes, (char*)dataToEncode);
-    delete [] dataToEncode;
-  }
-  else
-  {
-    MeshIterator* elements = m->begin(cellDim);
-    while ((e = m->iterate(elements)))
-    {
-      int nen = countElementNodes(n,e);
-      NewArray<int> numbers(nen);
-      getElementNumbers(n,e,numbers);
-      for (int i=0; i < nen; ++i)
-      {
-        file << numbers[i] << ' ';
-      }
-      file << '\n';
-    }
-    m->end(elements);
-  }
-  file << "</DataArray>\n";
-}
-
-static void writeOffsets(std::ostream& file,
-    Numbering* n,
-    bool isWritingBinary,
-    int cellDim)
-{
-  file << "<DataArray type=\"Int32\" Name=\"offsets\"";
-  if (isWritingBinary)
-  {
-    file << " format=\"binary\"";
-  }
-  else
-  {
-    file << " format=\"ascii\"";
-  }
-  file << ">\n";
-  Mesh* m = n->getMesh();
-  MeshEntity* e;
-  if (isWritingBinary)
-  {
-    MeshIterator* elements = m->begin(cellDim);
-    unsigned int dataLen = 0;
-    while ((e = m->iterate(elements)))
-    {
-      dataLen++;
-    }
-    m->end(elements);
-    unsigned int dataLenBytes = dataLen*sizeof(int);
-    int* dataToEncode = new int[dataLen]();
-    elements = m->begin(cellDim);
-    unsigned int dataIndex = 0;
-    int offset = 0;
-    while ((e = m->iterate(elements)))
-    {
-      offset += countElementNodes(n,e);
-      dataToEncode[dataIndex] = offset;
-      dataIndex++;
-    }
-    m->end(elements);
-    writeEncodedArray(file, dataLenBytes, (char*)dataToEncode);
-    delete [] dataToEncode;
-  }
-  else
-  {
-    MeshIterator* elements = m->begin(cellDim);
-    int offset = 0;
-    while ((e = m->iterate(elements)))
-    {
-      offset += countElementNodes(n,e);
-      file << offset << '\n';
-    }
-    m->end(elements);
-  }
-  file << "</DataArray>\n";
-}
-
-static void writeTypes(std::ostream& file,
-    Mesh* m,
-    bool isWritingBinary,
-    int cellDim)
-{
-  file << "<DataArray type=\"UInt8\" Name=\"types\"";
-  if (isWritingBinary)
-  {
-    file << " format=\"binary\"";
-  }
-  else
-  {
-    file << " format=\"ascii\"";
-  }
-  file << ">\n";
-  MeshEntity* e;
-  int order = m->getShape()->getOrder();
-  static int vtkTypes[Mesh::TYPES][2] =
-    /* order
-       linear,quadratic
-       V  V */
-    {{ 1,-1}//vertex
-    ,{ 3,21}//edge
-    ,{ 5,22}//triangle
-    ,{ 9,23}//quad
-    ,{10,24}//tet
-    ,{12,25}//hex
-    ,{13,-1}//prism
-    ,{14,-1}//pyramid
-  };
-  if (isWritingBinary)
-  {
-    unsigned int dataLen = 0;
-    MeshIterator* elements = m->begin(cellDim);
-    while ((e = m->iterate(elements)))
-    {
-      dataLen++;
-    }
-    m->end(elements);
-    unsigned int dataLenBytes = dataLen*sizeof(uint8_t);
-    uint8_t* dataToEncode = new uint8_t[dataLen]();
-    elements = m->begin(cellDim);
-    unsigned int dataIndex = 0;
-    while ((e = m->iterate(elements)))
-    {
-      dataToEncode[dataIndex] = vtkTypes[m->getType(e)][order-1];
-      dataIndex++;
-    }
-    m->end(elements);
-    writeEncodedArray(file, dataLenBytes, (char*)dataToEncode);
-    delete [] dataToEncode;
-  }
-  else
-  {
-    MeshIterator* elements = m->begin(cellDim);
-    while ((e = m->iterate(elements)))
-    {
-      file << vtkTypes[m->getType(e)][order-1] << '\n';
-    }
-    m->end(elements);
-  }
-  file << "</DataArray>\n";
-}
-
-static void writeCells(std::ostream& file,
-    Numbering* n,
-    bool isWritingBinary,
-    int cellDim)
-{
-  file << "<Cells>\n";
-  writeConnectivity(file, n, isWritingBinary, cellDim);
-  writeOffsets(file, n, isWritingBinary, cellDim);
-  writeTypes(file, n->getMesh(), isWritingBinary, cellDim);
-  file << "</Cells>\n";
-}
-
 static void writePointData(std::ostream& file,
     Mesh* m,
     DynamicArray<Node>& nodes,
@@ -835,7 +633,7 @@ bool isBigEndian()
   return bint.c[0] == 1;
 }
 
-static std::string getFileNameAndPathVtu(const char* prefix,
+std::string getFileNameAndPathVtu(const char* prefix,
     std::string fileName,
     int id)
 {
@@ -845,19 +643,8 @@ static std::string getFileNameAndPathVtu(const char* prefix,
   return ss.str();
 }
 
-static void writeVtuFile(const char* prefix,
-    Numbering* n,
-    std::vector<std::string> writeFields,
-    bool isWritingBinary,
-    int cellDim)
+void writeVtuHeader(std::ostream& buf, bool isWritingBinary)
 {
-  double t0 = PCU_Time();
-  std::string fileName = getPieceFileName(PCU_Comm_Self());
-  std::string fileNameAndPath = getFileNameAndPathVtu(prefix, fileName, PCU_Comm_Self());
-  std::stringstream buf;
-  Mesh* m = n->getMesh();
-  DynamicArray<Node> nodes;
-  getNodes(n,nodes);
   buf << "<VTKFile type=\"UnstructuredGrid\"";
   if (isWritingBinary)
   {
@@ -883,6 +670,17 @@ static void writeVtuFile(const char* prefix,
   }
   buf<< ">\n";
   buf << "<UnstructuredGrid>\n";
+}
+
+void writePiece(std::ostream& buf,
+    Numbering* n,
+    std::vector<std::string> writeFields,
+    bool isWritingBinary,
+    int cellDim)
+{
+  Mesh* m = n->getMesh();
+  DynamicArray<Node> nodes;
+  getNodes(n,nodes);
   buf << "<Piece NumberOfPoints=\"" << nodes.getSize();
   buf << "\" NumberOfCells=\"" << m->count(cellDim);
   buf << "\">\n";
@@ -891,17 +689,48 @@ static void writeVtuFile(const char* prefix,
   writePointData(buf,m,nodes,writeFields,isWritingBinary);
   writeCellData(buf, m, writeFields, isWritingBinary, cellDim);
   buf << "</Piece>\n";
+}
+
+static void writeVtuFile(const char* prefix,
+    Numbering* n,
+    std::vector<std::string> writeFields,
+    bool isWritingBinary,
+    int cellDim,
+    bool isWritingRaw = false)
+{
+  double t0 = PCU_Time();
+  std::string fileName = getPieceFileName(PCU_Comm_Self());
+  std::string fileNameAndPath = getFileNameAndPathVtu(prefix, fileName, PCU_Comm_Self());
+  std::stringstream buf;
+  writeVtuHeader(buf, isWritingBinary);
+  std::string appended;
+  if (isWritingRaw)
+  {
+    appendedData = &appended;
+  }
+  writePiece(buf, n, writeFields, isWritingBinary, cellDim);
   buf << "</UnstructuredGrid>\n";
-  buf << "</VTKFile>\n";
+  appendedData = 0;
+  if (!isWritingRaw)
+  {
+    buf << "</VTKFile>\n";
+  }
   double t1 = PCU_Time();
   if (!PCU_Comm_Self())
   {
     printf("writeVtuFile into buffers: %f seconds\n", t1 - t0);
   }
-  { //block forces std::ofstream destructor call
-    std::ofstream file(fileNameAndPath.c_str());
-    PCU_ALWAYS_ASSERT(file.is_open());
+  { //block forces the VtkFile destructor call
+    VtkFile vtk(fileNameAndPath, std::ios::binary);
+    std::ofstream& file = vtk.file;
     file << buf.rdbuf();
+    if (isWritingRaw)
+    {
+      file << "<AppendedData encoding=\"raw\">\n_";
+      file.write(appended.data(), appended.size());
+      file << "\n</AppendedData>\n";
+      file << "</VTKFile>\n";
+    }
   }
   double t2 = PCU_Time();
   if (!PCU_Comm_Self())
@@ -940,24 +769,49 @@ static void makeVtuSubdirectories(const char* prefix, int numParts)
   }
 }
 
-void writeVtkFilesRunner(const char* prefix,
+void startVtkFiles(const char* prefix,
     Mesh* m,
     std::vector<std::string> writeFields,
     bool isWritingBinary,
-    int cellDim)
+    int cellDim,
+    int sources)
 {
-  if (cellDim == -1) cellDim = m->getDimension();
-  double t0 = PCU_Time();
   if (!PCU_Comm_Self())
   {
     safe_mkdir(prefix);
-    makeVtuSubdirectories(prefix, PCU_Comm_Peers());
-    writePvtuFile(prefix, m, writeFields, isWritingBinary, cellDim);
+    makeVtuSubdirectories(prefix, sources);
+    writePvtuFile(prefix, m, writeFields, isWritingBinary, cellDim, sources);
   }
   PCU_Barrier();
+}
+
+void snapshotPiece(std::ostream& buf,
+    Numbering* n,
+    std::vector<std::string> writeFields,
+    int cellDim,
+    VtkSnapshot* arrays)
+{
+  snapshot = arrays;
+  writePiece(buf, n, writeFields, true, cellDim);
+  snapshot = 0;
+}
+
+void writeVtkFilesRunner(const char* prefix,
+    Mesh* m,
+    std::vector<std::string> writeFields,
+    bool isWritingBinary,
+    int cellDim,
+    bool isWritingRaw = false)
+{
+  PCU_Region region("apf::writeVtkFiles");
+  if (cellDim == -1) cellDim = m->getDimension();
+  double t0 = PCU_Time();
+  startVtkFiles(prefix, m, writeFields, isWritingBinary, cellDim,
+      PCU_Comm_Peers());
   Numbering* n = numberOverlapNodes(m,"apf_vtk_number");
   m->removeNumbering(n);
-  writeVtuFile(prefix, n, writeFields, isWritingBinary, cellDim);
+  writeVtuFile(prefix, n, writeFields, isWritingBinary, cellDim,
+      isWritingRaw);
   double t1 = PCU_Time();
   if (!PCU_Comm_Self())
   {
@@ -1019,6 +873,21 @@ void writeVtkFiles(const char* prefix, Mesh* m, int cellDim)
   writeVtkFiles(prefix, m, writeFields, cellDim);
 }
 
+void writeRawVtkFiles(
+    const char* prefix,
+    Mesh* m,
+    std::vector<std::string> writeFields,
+    int cellDim)
+{
+  writeVtkFilesRunner(prefix, m, writeFields, true, cellDim, true);
+}
+
+void writeRawVtkFiles(const char* prefix, Mesh* m, int cellDim)
+{
+  std::vector<std::string> writeFields = populateWriteFields(m);
+  writeRawVtkFiles(prefix, m, writeFields, cellDim);
+}
+
 void writeASCIIVtkFiles(
     const char* prefix,
     Mesh* m,
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2025 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef APFVTK_H
+#define APFVTK_H
+
+#include "apf.h"
+#include "apfNumbering.h"
+#include <pcu_io.h>
+#include <pcu_util.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace apf {
+
+/* an ofstream for the I/O statistics: its writes are buffered,
+   so they are counted together when it is flushed and closed */
+struct VtkFile
+{
+  VtkFile(std::string const& path,
+      std::ios::openmode mode = std::ios::out)
+  {
+    double t = pcu_io_time();
+    file.open(path.c_str(), mode);
+    PCU_ALWAYS_ASSERT(file.is_open());
+    pcu_io_opened(PCU_IO_VTK, t);
+    start = pcu_io_time();
+  }
+  ~VtkFile()
+  {
+    file.flush();
+    pcu_io_wrote(PCU_IO_VTK, file.tellp(), start);
+    double t = pcu_io_time();
+    file.close();
+    pcu_io_closed(PCU_IO_VTK, t);
+  }
+  std::ofstream file;
+  double start;
+};
+
+/* while a piece is snapshot for an asynchronous write, its binary
+   arrays are copied here with the position in the text where
+   they go, and are encoded later by the background thread */
+struct VtkSnapshot
+{
+  std::vector<size_t> at;
+  std::vector<std::string> arrays;
+};
+
+/* the names of all fields and numberings that can be written */
+std::vector<std::string> populateWriteFields(Mesh* m);
+
+/* compresses (if LION_COMPRESS=ON) and encodes a binary array,
+   appending it to (appended) if that is not null and base64
+   encoding it into (file) otherwise, see apfVtkEncode.cc */
+void encodeArray(std::ostream& file,
+    unsigned long dataLenBytes,
+    const char* dataToEncode,
+    std::string* appended);
+
+/* the format attribute of a DataArray */
+void describeFormat(std::ostream& file, bool isWritingBinary);
+
+/* writes a binary array as the current piece needs it:
+   snapshot, appended raw, or base64 encoded inline */
+void writeEncodedArray(std::ostream& file,
+    unsigned long dataLenBytes,
+    char* dataToEncode);
+
+/* the <Cells> of a piece, see apfVtkCells.cc */
+void writeCells(std::ostream& file,
+    Numbering* n,
+    bool isWritingBinary,
+    int cellDim);
+
+std::string getPieceFileName(int id);
+
+std::string getFileNameAndPathVtu(const char* prefix,
+    std::string fileName,
+    int id);
+
+void writeVtuHeader(std::ostream& buf, bool isWritingBinary);
+
+void writePiece(std::ostream& buf,
+    Numbering* n,
+    std::vector<std::string> writeFields,
+    bool isWritingBinary,
+    int cellDim);
+
+/* writes a binary piece whose arrays are copied into (arrays)
+   instead of being encoded, along with their positions in (buf) */
+void snapshotPiece(std::ostream& buf,
+    Numbering* n,
+    std::vector<std::string> writeFields,
+    int cellDim,
+    VtkSnapshot* arrays);
+
+/* rank 0 makes the directories of (sources) .vtu files and
+   writes the .pvtu file listing them */
+void startVtkFiles(const char* prefix,
+    Mesh* m,
+    std::vector<std::string> writeFields,
+    bool isWritingBinary,
+    int cellDim,
+    int sources);
+
+}
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2025 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include <PCU.h>
+#include <reel.h>
+#include "apfVtk.h"
+#include "apfNumberingClass.h"
+#include <algorithm>
+#include <sstream>
+
+namespace apf {
+
+/* the pieces of consecutive ranks share a file. Each group opens
+   its file collectively and every rank writes its piece text at the
+   sum of the lengths before it, the first adding the file header
+   and the last its footer */
+static void writeAggregatedVtuFile(const char* prefix,
+    Numbering* n,
+    std::vector<std::string> writeFields,
+    int cellDim,
+    int files)
+{
+  double t0 = PCU_Time();
+  int self = PCU_Comm_Self();
+  int partsPerFile = (PCU_Comm_Peers() + files - 1) / files;
+  int fileId = self / partsPerFile;
+  MPI_Comm group;
+  MPI_Comm_split(PCU_Get_Comm(), fileId, self, &group);
+  int groupSelf, groupPeers;
+  MPI_Comm_rank(group, &groupSelf);
+  MPI_Comm_size(group, &groupPeers);
+  std::stringstream buf;
+  if (groupSelf == 0)
+  {
+    writeVtuHeader(buf, true);
+  }
+  writePiece(buf, n, writeFields, true, cellDim);
+  if (groupSelf == groupPeers - 1)
+  {
+    buf << "</UnstructuredGrid>\n";
+    buf << "</VTKFile>\n";
+  }
+  std::string text = buf.str();
+  double t1 = PCU_Time();
+  if (!self)
+  {
+    printf("writeAggregatedVtuFile into buffers: %f seconds\n", t1 - t0);
+  }
+  long length = text.size();
+  long offset = 0;
+  MPI_Exscan(&length, &offset, 1, MPI_LONG, MPI_SUM, group);
+  if (groupSelf == 0)
+  {
+    offset = 0;
+  }
+  std::string fileName = getPieceFileName(fileId);
+  std::string fileNameAndPath =
+    getFileNameAndPathVtu(prefix, fileName, fileId);
+  MPI_File fh;
+  double start = pcu_io_time();
+  int err = MPI_File_open(group, const_cast<char*>(fileNameAndPath.c_str()),
+      MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh);
+  if (err != MPI_SUCCESS)
+  {
+    reel_fail("APF: could not open \"%s\"\n", fileNameAndPath.c_str());
+  }
+  MPI_File_set_size(fh, 0);
+  pcu_io_opened(PCU_IO_VTK, start);
+  pcu_io_transfer_all(fh, group, offset, length ? &text[0] : 0, length,
+      true, PCU_IO_VTK);
+  start = pcu_io_time();
+  MPI_File_close(&fh);
+  pcu_io_closed(PCU_IO_VTK, start);
+  MPI_Comm_free(&group);
+  double t2 = PCU_Time();
+  if (!self)
+  {
+    printf("writeAggregatedVtuFile buffers to disk: %f seconds\n", t2 - t1);
+  }
+}
+
+static void writeAggregatedVtkFilesRunner(const char* prefix,
+    Mesh* m,
+    std::vector<std::string> writeFields,
+    int files,
+    int cellDim)
+{
+  if (cellDim == -1) cellDim = m->getDimension();
+  files = std::max(1, std::min(files, PCU_Comm_Peers()));
+  int partsPerFile = (PCU_Comm_Peers() + files - 1) / files;
+  files = (PCU_Comm_Peers() + partsPerFile - 1) / partsPerFile;
+  double t0 = PCU_Time();
+  startVtkFiles(prefix, m, writeFields, true, cellDim, files);
+  Numbering* n = numberOverlapNodes(m,"apf_vtk_number");
+  m->removeNumbering(n);
+  writeAggregatedVtuFile(prefix, n, writeFields, cellDim, files);
+  double t1 = PCU_Time();
+  if (!PCU_Comm_Self())
+  {
+    printf("vtk files %s written to %d files in %f seconds\n",
+        prefix, files, t1 - t0);
+  }
+  delete n;
+}
+
+void writeAggregatedVtkFiles(
+    const char* prefix,
+    Mesh* m,
+    std::vector<std::string> writeFields,
+    int files,
+    int cellDim)
+{
+  writeAggregatedVtkFilesRunner(prefix, m, writeFields, files, cellDim);
+}
+
+void writeAggregatedVtkFiles(const char* prefix, Mesh* m, int files,
+    int cellDim)
+{
+  std::vector<std::string> writeFields = populateWriteFields(m);
+  writeAggregatedVtkFiles(prefix, m, writeFields, files, cellDim);
+}
+
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2025 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include <PCU.h>
+#include "apfVtk.h"
+#include "apfNumberingClass.h"
+#include <sstream>
+
+namespace apf {
+
+/* the text of a .vtu file with its arrays cut out, which are
+   encoded back into their places as the file is written */
+class VtuWrite : public AsyncWrite
+{
+  public:
+    void run()
+    {
+      VtkFile vtk(path, std::ios::binary);
+      std::ofstream& file = vtk.file;
+      size_t done = 0;
+      for (size_t i = 0; i < arrays.at.size(); ++i)
+      {
+        file.write(text.data() + done, arrays.at[i] - done);
+        done = arrays.at[i];
+        std::string const& a = arrays.arrays[i];
+        encodeArray(file, a.size(), a.data(), 0);
+      }
+      file.write(text.data() + done, text.size() - done);
+    }
+    std::string path;
+    std::string text;
+    VtkSnapshot arrays;
+};
+
+static AsyncWrite* writeVtkFilesAsyncRunner(const char* prefix,
+    Mesh* m,
+    std::vector<std::string> writeFields,
+    int cellDim)
+{
+  if (cellDim == -1) cellDim = m->getDimension();
+  double t0 = PCU_Time();
+  startVtkFiles(prefix, m, writeFields, true, cellDim, PCU_Comm_Peers());
+  Numbering* n = numberOverlapNodes(m,"apf_vtk_number");
+  m->removeNumbering(n);
+  VtuWrite* w = new VtuWrite();
+  w->path = getFileNameAndPathVtu(prefix,
+      getPieceFileName(PCU_Comm_Self()), PCU_Comm_Self());
+  std::stringstream buf;
+  writeVtuHeader(buf, true);
+  snapshotPiece(buf, n, writeFields, cellDim, &w->arrays);
+  buf << "</UnstructuredGrid>\n";
+  buf << "</VTKFile>\n";
+  w->text = buf.str();
+  delete n;
+  double t1 = PCU_Time();
+  if (!PCU_Comm_Self())
+  {
+    printf("vtk files %s snapshot in %f seconds\n", prefix, t1 - t0);
+  }
+  startAsyncWrite(w);
+  return w;
+}
+
+AsyncWrite* writeVtkFilesAsync(
+    const char* prefix,
+    Mesh* m,
+    std::vector<std::string> writeFields,
+    int cellDim)
+{
+  return writeVtkFilesAsyncRunner(prefix, m, writeFields, cellDim);
+}
+
+AsyncWrite* writeVtkFilesAsync(const char* prefix, Mesh* m, int cellDim)
+{
+  std::vector<std::string> writeFields = populateWriteFields(m);
+  return writeVtkFilesAsync(prefix, m, writeFields, cellDim);
+}
+
+}
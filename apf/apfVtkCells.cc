@@ -0,0 +1,200 @@
+/*
+ * Copyright 2025 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apfVtk.h"
+#include "apfNumberingClass.h"
+#include "apfShape.h"
+#include <stdint.h>
+
+namespace apf {
+
+static int countElementNodes(Numbering* n, MeshEntity* e)
+{
+  return n->getShape()->getEntityShape(n->getMesh()->getType(e))->countNodes();
+}
+
+/* the node numbers of all cells in iteration order. Vertex-only
+   numberings read the vertices from the mesh's connectivity table,
+   which the other writers and converters of a phase share */
+static void getConnectivityNumbers(Numbering* n, int cellDim,
+    std::vector<int>& numbers)
+{
+  Mesh* m = n->getMesh();
+  FieldShape* s = n->getShape();
+  Connectivity const& c = m->getConnectivity(cellDim);
+  numbers.clear();
+  bool verticesOnly = countComponents(n) == 1;
+  for (int d = 1; d <= cellDim; ++d)
+    verticesOnly = verticesOnly && ( ! s->hasNodesIn(d));
+  if (verticesOnly)
+  {
+    numbers.reserve(c.vertices.size());
+    for (size_t i = 0; i < c.vertices.size(); ++i)
+      numbers.push_back(getNumber(n, c.vertices[i], 0, 0));
+    return;
+  }
+  NewArray<int> elementNumbers;
+  for (size_t i = 0; i < c.elements.size(); ++i)
+  {
+    int nen = getElementNumbers(n, c.elements[i], elementNumbers);
+    numbers.insert(numbers.end(), &elementNumbers[0],
+        &elementNumbers[0] + nen);
+  }
+}
+
+static void writeConnectivity(std::ostream& file,
+    Numbering* n,
+    bool isWritingBinary,
+    int cellDim)
+{
+  file << "<DataArray type=\"Int32\" Name=\"connectivity\"";
+  describeFormat(file, isWritingBinary);
+  file << ">\n";
+  std::vector<int> numbers;
+  getConnectivityNumbers(n, cellDim, numbers);
+  if (isWritingBinary)
+  {
+    unsigned int dataLenBytes = numbers.size()*sizeof(int);
+    writeEncodedArray(file, dataLenBytes,
+        (char*)(numbers.empty() ? 0 : &numbers[0]));
+  }
+  else
+  {
+    Mesh* m = n->getMesh();
+    Connectivity const& c = m->getConnectivity(cellDim);
+    size_t k = 0;
+    for (size_t i = 0; i < c.elements.size(); ++i)
+    {
+      int nen = countElementNodes(n,c.elements[i]);
+      for (int j=0; j < nen; ++j)
+      {
+        file << numbers[k++] << ' ';
+      }
+      file << '\n';
+    }
+  }
+  file << "</DataArray>\n";
+}
+
+static void writeOffsets(std::ostream& file,
+    Numbering* n,
+    bool isWritingBinary,
+    int cellDim)
+{
+  file << "<DataArray type=\"Int32\" Name=\"offsets\"";
+  describeFormat(file, isWritingBinary);
+  file << ">\n";
+  Mesh* m = n->getMesh();
+  MeshEntity* e;
+  if (isWritingBinary)
+  {
+    MeshIterator* elements = m->begin(cellDim);
+    unsigned int dataLen = 0;
+    while ((e = m->iterate(elements)))
+    {
+      dataLen++;
+    }
+    m->end(elements);
+    unsigned int dataLenBytes = dataLen*sizeof(int);
+    int* dataToEncode = new int[dataLen]();
+    elements = m->begin(cellDim);
+    unsigned int dataIndex = 0;
+    int offset = 0;
+    while ((e = m->iterate(elements)))
+    {
+      offset += countElementNodes(n,e);
+      dataToEncode[dataIndex] = offset;
+      dataIndex++;
+    }
+    m->end(elements);
+    writeEncodedArray(file, dataLenBytes, (char*)dataToEncode);
+    delete [] dataToEncode;
+  }
+  else
+  {
+    MeshIterator* elements = m->begin(cellDim);
+    int offset = 0;
+    while ((e = m->iterate(elements)))
+    {
+      offset += countElementNodes(n,e);
+      file << offset << '\n';
+    }
+    m->end(elements);
+  }
+  file << "</DataArray>\n";
+}
+
+static void writeTypes(std::ostream& file,
+    Mesh* m,
+    bool isWritingBinary,
+    int cellDim)
+{
+  file << "<DataArray type=\"UInt8\" Name=\"types\"";
+  describeFormat(file, isWritingBinary);
+  file << ">\n";
+  MeshEntity* e;
+  int order = m->getShape()->getOrder();
+  static int vtkTypes[Mesh::TYPES][2] =
+    /* order
+       linear,quadratic
+       V  V */
+    {{ 1,-1}//vertex
+    ,{ 3,21}//edge
+    ,{ 5,22}//triangle
+    ,{ 9,23}//quad
+    ,{10,24}//tet
+    ,{12,25}//hex
+    ,{13,-1}//prism
+    ,{14,-1}//pyramid
+  };
+  if (isWritingBinary)
+  {
+    unsigned int dataLen = 0;
+    MeshIterator* elements = m->begin(cellDim);
+    while ((e = m->iterate(elements)))
+    {
+      dataLen++;
+    }
+    m->end(elements);
+    unsigned int dataLenBytes = dataLen*sizeof(uint8_t);
+    uint8_t* dataToEncode = new uint8_t[dataLen]();
+    elements = m->begin(cellDim);
+    unsigned int dataIndex = 0;
+    while ((e = m->iterate(elements)))
+    {
+      dataToEncode[dataIndex] = vtkTypes[m->getType(e)][order-1];
+      dataIndex++;
+    }
+    m->end(elements);
+    writeEncodedArray(file, dataLenBytes, (char*)dataToEncode);
+    delete [] dataToEncode;
+  }
+  else
+  {
+    MeshIterator* elements = m->begin(cellDim);
+    while ((e = m->iterate(elements)))
+    {
+      file << vtkTypes[m->getType(e)][order-1] << '\n';
+    }
+    m->end(elements);
+  }
+  file << "</DataArray>\n";
+}
+
+void writeCells(std::ostream& file,
+    Numbering* n,
+    bool isWritingBinary,
+    int cellDim)
+{
+  file << "<Cells>\n";
+  writeConnectivity(file, n, isWritingBinary, cellDim);
+  writeOffsets(file, n, isWritingBinary, cellDim);
+  writeTypes(file, n->getMesh(), isWritingBinary, cellDim);
+  file << "</Cells>\n";
+}
+
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2025 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include <PCU.h>
+#include <lionBase64.h>
+#include <lionCompress.h>
+#include "apfVtk.h"
+#include <algorithm>
+#include <cstring>
+
+namespace apf {
+
+/* threads compressing the blocks of each binary array */
+static int vtkThreads = 1;
+
+/* bytes of each separately compressed block of an array,
+   the block size of VTK's own writers */
+static unsigned long const compressBlockBytes = 1 << 20;
+
+/* compresses the blocks of an array in contiguous ranges
+   of blocks, one range per thread */
+struct CompressChunks
+{
+  static void compress(void* p, size_t first, size_t end)
+  {
+    CompressChunks* all = static_cast<CompressChunks*>(p);
+    for (size_t b = first; b < end; ++b)
+    {
+      unsigned long offset = b * compressBlockBytes;
+      all->sizes[b] = all->bound;
+      lion::compress(&(all->blocks[b * all->bound]), all->sizes[b],
+          all->source + offset,
+          std::min(compressBlockBytes, all->sourceLen - offset));
+    }
+  }
+  void run(const char* data, unsigned long len, int threads)
+  {
+    source = data;
+    sourceLen = len;
+    size_t n = (len + compressBlockBytes - 1) / compressBlockBytes;
+    bound = lion::compressBound(compressBlockBytes);
+    blocks.resize(n * bound);
+    sizes.resize(n);
+    PCU_Thrd_Chunks(threads, n, compress, this);
+  }
+  const char* source;
+  unsigned long sourceLen;
+  unsigned long bound;
+  std::vector<char> blocks;
+  std::vector<unsigned long> sizes;
+};
+
+/* base64 encodes inline arrays into one buffer, raw arrays
+   are appended as they are */
+static void writeEncodedBytes(std::ostream& file,
+    const char* data,
+    unsigned long len,
+    std::string* appended)
+{
+  if (appended)
+  {
+    appended->append(data, len);
+    return;
+  }
+  if (!len)
+    return;
+  std::vector<char> encoded(lion::base64EncodedLength(len));
+  lion::base64Encode(data, len, &encoded[0]);
+  file.write(&encoded[0], encoded.size());
+}
+
+void encodeArray(std::ostream& file,
+    unsigned long dataLenBytes,
+    const char* dataToEncode,
+    std::string* appended)
+{
+  if ( lion::can_compress )
+  {
+    //compress dataToEncode in blocks
+    CompressChunks chunks;
+    chunks.run(dataToEncode, dataLenBytes, vtkThreads);
+    size_t numBlocks = chunks.sizes.size();
+    //build the data header and pack the compressed blocks together
+    std::vector<long> lensToEncode(3 + numBlocks);
+    lensToEncode[0] = numBlocks; //number of blocks
+    lensToEncode[1] = compressBlockBytes; //size of each block before compression
+    lensToEncode[2] = numBlocks ? //size of the final block before compression
+      dataLenBytes - (numBlocks - 1) * compressBlockBytes : 0;
+    unsigned long dataCompressedLen = 0;
+    for (size_t b = 0; b < numBlocks; ++b)
+    {
+      memmove(&chunks.blocks[dataCompressedLen],
+          &chunks.blocks[b * chunks.bound], chunks.sizes[b]);
+      lensToEncode[3 + b] = chunks.sizes[b]; //size of each compressed block
+      dataCompressedLen += chunks.sizes[b];
+    }
+    //encode and output the compressed data
+    writeEncodedBytes(file, (char*)&lensToEncode[0],
+        lensToEncode.size() * sizeof(long), appended);
+    writeEncodedBytes(file,
+        numBlocks ? &chunks.blocks[0] : 0, dataCompressedLen, appended);
+  }
+  else
+  {
+    //not compressing, encode and output
+    unsigned int dataLenHeader = dataLenBytes;
+    writeEncodedBytes(file, (char*)&dataLenHeader, sizeof(dataLenHeader),
+        appended);
+    writeEncodedBytes(file, dataToEncode, dataLenBytes, appended);
+  }
+  if (!appended)
+    file << '\n';
+}
+
+void setVtkThreads(int threads)
+{
+  vtkThreads = threads < 1 ? 1 : threads;
+}
+
+}
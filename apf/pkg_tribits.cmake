@@ -20,11 +20,23 @@ set(APF_SOURCES
   apfDynamicVector.cc
   apfMatrixField.cc
   apfMesh.cc
+  apfMeshModel.cc
+  apfMeshStats.cc
+  apfConnectivity.cc
+  apfSharing.cc
   apfMesh2.cc
   apfMigrate.cc
+  apfMigrateCost.cc
+  apfMigrateFrozen.cc
   apfScalarElement.cc
   apfScalarField.cc
   apfShape.cc
+  apfShapeCache.cc
+  apfShapeConstant.cc
+  apfShapeBatch.cc
+  apfSearch.cc
+  apfSnapshot.cc
+  apfFieldHistory.cc
   apfIPShape.cc
   apfHierarchic.cc
   apfVector.cc
@@ -35,7 +47,12 @@ set(APF_SOURCES
   apfMixedNumbering.cc
   apfAdjReorder.cc
   apfVtk.cc
+  apfVtkAggregate.cc
+  apfVtkAsync.cc
+  apfVtkCells.cc
+  apfVtkEncode.cc
   apfFieldData.cc
+  apfSyncPlan.cc
   apfTagData.cc
   apfCoordData.cc
   apfArrayData.cc
@@ -48,6 +65,8 @@ set(APF_SOURCES
   apfBoundaryToElementXi.cc
   apfSimplexAngleCalcs.cc
   apfFile.cc
+  apfColumn.cc
+  apfAsync.cc
 )
 
 set(APF_HEADERS
@@ -63,12 +82,16 @@ set(APF_HEADERS
   apfNew.h
   apfCavityOp.h
   apfShape.h
+  apfShapeBatch.h
   apfNumbering.h
   apfMixedNumbering.h
   apfPartition.h
   apfConvert.h
   apfGeometry.h
   apf2mth.h
+  apfSearch.h
+  apfSnapshot.h
+  apfFieldHistory.h
 )
 
 set(APF_SOURCES
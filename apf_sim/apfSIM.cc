@@ -872,12 +872,27 @@ void MeshSIM::migrate(Migration* plan)
 {
   pMigrator migrator = Migrator_new(mesh,this->getDimension(),0);
   int gid = PMU_gid(getId(),0);
-  for (int i=0; i < plan->count(); ++i)
+  if (plan->sendingAll() != -1)
   {
-    MeshEntity* e = plan->get(i);
-    int newgid = PMU_gid(plan->sending(e),0);
-    pEntity entity = reinterpret_cast<pEntity>(e);
-    Migrator_add(migrator,entity,newgid,gid);
+    MeshIterator* it = begin(getDimension());
+    MeshEntity* e;
+    while ((e = iterate(it)))
+    {
+      int newgid = PMU_gid(plan->sending(e),0);
+      pEntity entity = reinterpret_cast<pEntity>(e);
+      Migrator_add(migrator,entity,newgid,gid);
+    }
+    end(it);
+  }
+  else
+  {
+    for (int i=0; i < plan->count(); ++i)
+    {
+      MeshEntity* e = plan->get(i);
+      int newgid = PMU_gid(plan->sending(e),0);
+      pEntity entity = reinterpret_cast<pEntity>(e);
+      Migrator_add(migrator,entity,newgid,gid);
+    }
   }
   delete plan;
   Migrator_run(migrator,NULL);
@@ -107,7 +107,7 @@ class MeshSIM : public Mesh2
     void addMatch(MeshEntity*, int, MeshEntity* ) {}
     void clearMatches(MeshEntity*) {}
     void clear_() {}
-    void acceptChanges() {}
+    void acceptChanges() {clearSharing(); clearConnectivity();}
     void resetPmodel() {} 
     void setPtnClas(MeshEntity*, Parts&, int) {}
     void addGhost(MeshEntity*, int, MeshEntity*) {}
@@ -12,6 +12,9 @@
     \brief compile-time size array */
 
 #include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 /** \namespace can
   * \brief All CAN symbols are contained in this namespace.
@@ -51,51 +54,110 @@ class Array
     }
 };
 
-/** \brief run-time (dynamic) array */ 
+/** \brief bytes of elements that a run-time array keeps inside
+    itself before it allocates */
+enum { ARRAY_INLINE_BYTES = 128 };
+
+/** \brief run-time (dynamic) array
+  \details small arrays, such as adjacencies and element node values,
+  are kept in a buffer inside the object, and arrays that grow keep
+  their capacity, so resizing to at most the largest size used so far
+  does not allocate. */
 template <class T>
 class Array<T,0>
 {
   public:
     /** \brief default constructor - no allocation */
-    Array() : sz(0), elems(0) {}
+    Array() : sz(0), cap(inline_count), elems(inlineElems()) {}
     /** \brief construct with n elems */
-    Array(unsigned n) : sz(0), elems(0) {resize(n);}
+    Array(unsigned n) : sz(0), cap(inline_count), elems(inlineElems())
+    {
+      resize(n);
+    }
     /** \brief copy constructor */
-    Array(Array<T,0> const& other) : sz(0), elems(0) {copy(other);}
-    /** \brief destructor - need to delete elems */
-    ~Array() {delete [] elems;}
+    Array(Array<T,0> const& other) :
+      sz(0), cap(inline_count), elems(inlineElems())
+    {
+      copy(other);
+    }
+    /** \brief move constructor, takes the other's memory if
+      it allocated and moves its elements otherwise */
+    Array(Array<T,0>&& other) :
+      sz(0), cap(inline_count), elems(inlineElems())
+    {
+      take(other);
+    }
+    /** \brief destructor - frees allocated memory */
+    ~Array()
+    {
+      destroy(0, sz);
+      release();
+    }
     /** \brief assignment operator */
     Array<T,0>& operator=(Array<T,0> const& other)
     {
       copy(other);
       return *this;
     }
+    /** \brief move assignment operator */
+    Array<T,0>& operator=(Array<T,0>&& other)
+    {
+      if (this != &other) {
+        destroy(0, sz);
+        sz = 0;
+        release();
+        take(other);
+      }
+      return *this;
+    }
     /** \brief mutable index operator */
     T& operator[](unsigned i) {return elems[i];}
     /** \brief immutable index operator */
     T const& operator[](unsigned i) const {return elems[i];}
     /** \brief get the size of this array */
     unsigned size() const {return sz;}
-    /** \brief resize the array */
+    /** \brief get the number of elements that fit without allocating */
+    unsigned capacity() const {return cap;}
+    /** \brief resize the array, the elements are default-initialized */
     void resize(unsigned n)
     {
       if (sz == n)
         return;
-      delete [] elems;
+      destroy(0, sz);
+      sz = 0;
+      if (n > cap) {
+        release();
+        elems = allocate(n);
+        cap = n;
+      }
+      construct(0, n);
       sz = n;
-      elems = new T[n];
     }
+    /** \brief resize the array, keeping the common elements */
     void resize_copy(unsigned n)
     {
-       if (sz == n)
+      if (sz == n)
         return;
-      T* tmp = new T[n];
-      unsigned min = sz > n ? n : sz; 
-      for(unsigned int x = 0; x < min; x++)
-        tmp[x] = elems[x];
-      delete [] elems;
+      if (n > cap)
+        reserve(n);
+      if (n < sz)
+        destroy(n, sz);
+      else
+        construct(sz, n);
       sz = n;
+    }
+    /** \brief make room for n elements, keeping the current ones */
+    void reserve(unsigned n)
+    {
+      if (n <= cap)
+        return;
+      T* tmp = allocate(n);
+      for (unsigned i = 0; i < sz; ++i)
+        new (tmp + i) T(std::move(elems[i]));
+      destroy(0, sz);
+      release();
       elems = tmp;
+      cap = n;
     }
     typedef T* iterator;
     typedef T const* const_iterator;
@@ -104,15 +166,66 @@ class Array<T,0>
     T* begin() {return elems;}
     T* end() {return elems + sz;}
   protected:
+    enum { inline_count = ARRAY_INLINE_BYTES / sizeof(T) };
     unsigned sz;
+    unsigned cap;
     T* elems;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type
+      small[inline_count > 0 ? inline_count : 1];
+    T* inlineElems()
+    {
+      return reinterpret_cast<T*>(small);
+    }
+    static T* allocate(unsigned n)
+    {
+      return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    /* elements are default-initialized as by new T[n] */
+    void construct(unsigned from, unsigned to)
+    {
+      for (unsigned i = from; i < to; ++i)
+        new (elems + i) T;
+    }
+    void destroy(unsigned from, unsigned to)
+    {
+      for (unsigned i = from; i < to; ++i)
+        elems[i].~T();
+    }
+    /* frees allocated memory, to be called without elements */
+    void release()
+    {
+      if (elems != inlineElems())
+        ::operator delete(elems);
+      elems = inlineElems();
+      cap = inline_count;
+    }
     void copy(Array<T,0> const& other)
     {
+      if (this == &other)
+        return;
       if (sz != other.sz)
         resize(other.sz);
       for (unsigned i = 0; i < sz; ++i)
         elems[i] = other.elems[i];
     }
+    /* this array is empty and uses its own buffer */
+    void take(Array<T,0>& other)
+    {
+      if (other.elems != other.inlineElems()) {
+        elems = other.elems;
+        cap = other.cap;
+        sz = other.sz;
+        other.elems = other.inlineElems();
+        other.cap = inline_count;
+        other.sz = 0;
+        return;
+      }
+      for (unsigned i = 0; i < other.sz; ++i)
+        new (elems + i) T(std::move(other.elems[i]));
+      sz = other.sz;
+      other.destroy(0, other.sz);
+      other.sz = 0;
+    }
 };
 
 }
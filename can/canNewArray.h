@@ -33,14 +33,14 @@ class NewArray : public Array<T,0>
     NewArray(std::size_t n) : Array<T,0>(n) {}
     /** \brief Array destructor frees memory */
     ~NewArray() {}
-    /** \brief return true if memory has been allocated */
-    bool allocated() const {return this->elems;}
+    /** \brief return true if elements have been allocated */
+    bool allocated() const {return this->sz;}
     /** \brief user-callable deallocation helper */
     void deallocate()
     {
-      delete [] this->elems;
+      this->destroy(0, this->sz);
       this->sz = 0;
-      this->elems=0;
+      this->release();
     }
     /** \brief user-callable allocation helper
       \details note that no mix of allocate/deallocate
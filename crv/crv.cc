@@ -10,6 +10,8 @@
 #include "crvTables.h"
 #include "crvQuality.h"
 #include <cstdlib>
+#include <PCU.h>
+#include <vector>
 
 namespace crv {
 
@@ -65,8 +67,8 @@ double interpolationError(apf::Mesh* m, apf::MeshEntity* e, int n){
     return 0.;
   int d = apf::getDimension(m,e);
   int nj = (d == 2) ? n : 1;
-  apf::Vector3 pt,pa(0.,0.,0.),cpt,cpa;
-  double max = 0.0;
+  apf::Vector3 pa(0.,0.,0.);
+  std::vector<apf::Vector3> pts;
   apf::Element* elem =
       apf::createElement(m->getCoordinateField(),e);
   for (int j = 0; j <= nj; ++j){
@@ -74,12 +76,19 @@ double interpolationError(apf::Mesh* m, apf::MeshEntity* e, int n){
     for (int i = 0; i <= n-j; ++i){
       if(d == 1) pa[0] = 2.*i/n-1.;
       else pa[0] = 1.*i/n;
+      apf::Vector3 pt;
       apf::getVector(elem,pa,pt);
-      m->getClosestPoint(g,pt,cpt,cpa);
-      max = std::max((cpt-pt).getLength(),max);
+      pts.push_back(pt);
     }
   }
   apf::destroyElement(elem);
+  int np = pts.size();
+  std::vector<apf::ModelEntity*> models(np,g);
+  std::vector<apf::Vector3> cpts(np), cpas(np);
+  m->getClosestPoint(np,&models[0],&pts[0],&cpts[0],&cpas[0]);
+  double max = 0.0;
+  for (int i = 0; i < np; ++i)
+    max = std::max((cpts[i]-pts[i]).getLength(),max);
   return max;
 }
 
@@ -152,24 +161,59 @@ void getTransformationMatrix(apf::Mesh* m, apf::MeshEntity* e,
   }
 }
 
-int countNumberInvalidElements(apf::Mesh2* m)
+/* checks the validity of many elements in
+   contiguous chunks, one per thread */
+struct ValidityChunks
+{
+  static void check(void* p, size_t first, size_t end)
+  {
+    ValidityChunks* all = static_cast<ValidityChunks*>(p);
+    all->qual->checkValidities(&all->elements[first],
+        end - first, &all->tags[first]);
+  }
+  void run(int threads)
+  {
+    size_t n = elements.size();
+    tags.resize(n);
+    PCU_Thrd_Chunks(threads, n, check, this);
+  }
+  Quality* qual;
+  std::vector<apf::MeshEntity*> elements;
+  std::vector<int> tags;
+};
+
+int findInvalidElements(apf::Mesh* m,
+    std::vector<apf::MeshEntity*>& invalid, int threads)
 {
-  int n = 0;
+  invalid.clear();
   apf::MeshEntity* e;
   apf::MeshIterator* it = m->begin(m->getDimension());
   if (m->getShape()->getOrder() == 1){
-    while ((e = m->iterate(it))) {
-      n += (apf::measure(m,e) < 1e-10);
-    }
-  } else {
-    Quality* qual = makeQuality(m,2);
-    while ((e = m->iterate(it))) {
-      n += (qual->checkValidity(e) > 1);
-    }
-    delete qual;
+    while ((e = m->iterate(it)))
+      if (apf::measure(m,e) < 1e-10)
+        invalid.push_back(e);
+    m->end(it);
+    return invalid.size();
   }
+  ValidityChunks chunks;
+  while ((e = m->iterate(it)))
+    chunks.elements.push_back(e);
   m->end(it);
-  return n;
+  /* the quality object fills the shared matrix caches
+     before any thread reads them */
+  chunks.qual = makeQuality(m,2);
+  chunks.run(threads);
+  delete chunks.qual;
+  for (size_t i = 0; i < chunks.elements.size(); ++i)
+    if (chunks.tags[i] > 1)
+      invalid.push_back(chunks.elements[i]);
+  return invalid.size();
+}
+
+int countNumberInvalidElements(apf::Mesh2* m, int threads)
+{
+  std::vector<apf::MeshEntity*> invalid;
+  return findInvalidElements(m,invalid,threads);
 }
 
 void fail(const char* why)
@@ -34,8 +34,16 @@ void setBlendingOrder(const int type, const int b);
 /** \brief gets the blending order */
 int getBlendingOrder(const int type);
 
-/** \brief count invalid elements of the mesh */
-int countNumberInvalidElements(apf::Mesh2* m);
+/** \brief count invalid elements of the mesh
+  \details the elements are checked in (threads) chunks */
+int countNumberInvalidElements(apf::Mesh2* m, int threads = 1);
+/** \brief list the invalid elements of the mesh, returning their count
+  \details the elements are checked in (threads) chunks. Each check stops
+   at the first sample of det(J) that is not positive, passes when all
+   the Bezier coefficients of det(J) are positive, and only subdivides
+   the entities with a coefficient that is not */
+int findInvalidElements(apf::Mesh* m,
+    std::vector<apf::MeshEntity*>& invalid, int threads = 1);
 
 /** \brief Base Mesh curving object
   \details P is the order, S is the space dimension,
@@ -169,6 +177,9 @@ public:
   virtual double getQuality(apf::MeshEntity* e) = 0;
   /** \brief check the validity (det(Jacobian) > eps) of an element */
   virtual int checkValidity(apf::MeshEntity* e) = 0;
+  /** \brief checkValidity of (n) elements, the tags go in (tags)
+    \details implementations may share work between the elements */
+  virtual void checkValidities(apf::MeshEntity* const* e, int n, int* tags);
 protected:
   apf::Mesh* mesh;
   int algorithm;
@@ -188,6 +199,11 @@ double interpolationError(apf::Mesh* m, apf::MeshEntity* e, int n);
    but bigger file */
 void writeCurvedVtuFiles(apf::Mesh* m, int type, int n, const char* prefix);
 
+/** \brief Visualization, writes the elements of the specified type as
+   VTK Lagrange cells of the mesh order, one cell per element, so
+   the file is about as big as the mesh */
+void writeLagrangeVtuFiles(apf::Mesh* m, int type, const char* prefix);
+
 /** \brief Visualization, writes wireframe of the curved mesh, n is
    number of subdivisions, higher number -> better resolution,
    but bigger file */
@@ -17,6 +17,7 @@
 #include <maLayer.h>
 #include <PCU.h>
 #include <pcu_util.h>
+#include <vector>
 
 namespace crv {
 
@@ -115,23 +116,28 @@ int markInvalidEntities(Adapt* a)
   ma::Mesh* m = a->mesh;
   int dimension = m->getDimension();
   ma::Iterator* it = m->begin(dimension);
-  Quality* qual = makeQuality(m,2);
+  std::vector<ma::Entity*> unchecked;
   while ((e = m->iterate(it)))
   {
     /* this skip conditional is powerful: it affords us a
        3X speedup of the entire adaptation in some cases */
-    int qualityTag = crv::getTag(a,e);
-    if (qualityTag) continue;
-    qualityTag = qual->checkValidity(e);
-    if (qualityTag >= 2)
-    {
-      crv::setTag(a,e,qualityTag);
-      if (m->isOwned(e))
-        ++count;
-    }
+    if (crv::getTag(a,e)) continue;
+    unchecked.push_back(e);
   }
   m->end(it);
+  std::vector<int> qualityTags(unchecked.size());
+  Quality* qual = makeQuality(m,2);
+  if (!unchecked.empty())
+    qual->checkValidities(&unchecked[0],unchecked.size(),&qualityTags[0]);
   delete qual;
+  /* valid elements keep a tag of 1, so they are not checked
+     again until their control points change */
+  for (size_t i = 0; i < unchecked.size(); ++i)
+  {
+    crv::setTag(a,unchecked[i],qualityTags[i]);
+    if (qualityTags[i] >= 2 && m->isOwned(unchecked[i]))
+      ++count;
+  }
   return PCU_Add_Int(count);
 }
 
@@ -149,6 +155,18 @@ void clearTag(Adapt* a, ma::Entity* e)
 {
   setTags(a,e,0);
 }
+
+void clearTagsAdjacent(Adapt* a, ma::Entity* e)
+{
+  ma::Mesh* m = a->mesh;
+  apf::Adjacent elements;
+  m->getAdjacent(e,m->getDimension(),elements);
+  for (size_t i = 0; i < elements.getSize(); ++i) {
+    setTags(a,elements[i],0);
+    if (m->hasTag(elements[i],a->qualityCache))
+      m->removeTag(elements[i],a->qualityCache);
+  }
+}
 // use an identity configuration but with default fixing values
 ma::Input* configureShapeCorrection(
     ma::Mesh* m, ma::SizeField* f,
@@ -196,6 +214,7 @@ static void flagCleaner(crv::Adapt* a)
 
 void adapt(ma::Input* in)
 {
+  PCU_Region region("crv::adapt");
   std::string name = in->mesh->getShape()->getName();
   if(name != std::string("Bezier"))
     fail("mesh must be bezier to adapt\n");
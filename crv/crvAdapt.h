@@ -32,9 +32,11 @@ class Adapt : public ma::Adapt
 /** \brief change the order of a Bezier Mesh
  * \details going up in order is exact,
  * except for boundary elements, where snapping changes things
- * Going down in order is approximate everywhere
+ * Going down in order is approximate everywhere.
+ * Going up, the interior points of entities off the boundary
+ * are elevated in (threads) chunks per entity type
  * */
-void changeMeshOrder(apf::Mesh2* m, int newOrder);
+void changeMeshOrder(apf::Mesh2* m, int newOrder, int threads = 1);
 
 
 }
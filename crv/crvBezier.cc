@@ -27,11 +27,46 @@ namespace crv {
  */
 static int P = 1;
 
+/* the shape functions of order P, chosen when the order is set */
+static bezierShape orderShapes[apf::Mesh::TYPES] = {NULL};
+static bezierShapeGrads orderShapeGrads[apf::Mesh::TYPES] = {NULL};
+
 static bool useBlending(int type)
 {
   return (getBlendingOrder(type) != 0);
 }
 
+/* blended triangles, and blended tets with blended faces, depend on
+   the element only through which of their triangles are on the
+   boundary, since those use the full functions. That gives one
+   variant per boundary triangle mask */
+static int countBlendedVariants(int type)
+{
+  if (!useBlending(apf::Mesh::TRIANGLE))
+    return 1;
+  if (type == apf::Mesh::TRIANGLE)
+    return 2;
+  if (type == apf::Mesh::TET && useBlending(apf::Mesh::TET))
+    return 16;
+  return 1;
+}
+
+static int getBlendedVariant(apf::Mesh* m, apf::MeshEntity* e)
+{
+  int type = m->getType(e);
+  if (countBlendedVariants(type) == 1)
+    return 0;
+  if (type == apf::Mesh::TRIANGLE)
+    return isBoundaryEntity(m,e);
+  apf::MeshEntity* faces[4];
+  m->getDownward(e,2,faces);
+  int variant = 0;
+  for (int i = 0; i < 4; ++i)
+    if (isBoundaryEntity(m,faces[i]))
+      variant |= 1 << i;
+  return variant;
+}
+
 void getFullRepFromBlended(int type,
     apf::NewArray<double>& transformCoefficients,
     apf::NewArray<apf::Vector3>& elemNodes)
@@ -104,13 +139,13 @@ public:
         apf::Vector3 const& xi, apf::NewArray<double>& values) const
     {
       values.allocate(P+1);
-      bezier[apf::Mesh::EDGE](P,xi,values);
+      orderShapes[apf::Mesh::EDGE](P,xi,values);
     }
     void getLocalGradients(apf::Mesh* /*m*/, apf::MeshEntity* /*e*/,
         apf::Vector3 const& xi, apf::NewArray<apf::Vector3>& grads) const
     {
       grads.allocate(P+1);
-      bezierGrads[apf::Mesh::EDGE](P,xi,grads);
+      orderShapeGrads[apf::Mesh::EDGE](P,xi,grads);
     }
     int countNodes() const {return P+1;}
     void alignSharedNodes(apf::Mesh*,
@@ -129,7 +164,7 @@ public:
 
       if(!useBlending(apf::Mesh::TRIANGLE)
           || isBoundaryEntity(m,e)){
-        bezier[apf::Mesh::TRIANGLE](P,xi,values);
+        orderShapes[apf::Mesh::TRIANGLE](P,xi,values);
       } else
         BlendedTriangleGetValues(m,e,xi,values);
 
@@ -141,7 +176,7 @@ public:
 
       if(!useBlending(apf::Mesh::TRIANGLE)
           || isBoundaryEntity(m,e)){
-        bezierGrads[apf::Mesh::TRIANGLE](P,xi,grads);
+        orderShapeGrads[apf::Mesh::TRIANGLE](P,xi,grads);
       } else
         BlendedTriangleGetLocalGradients(m,e,xi,grads);
 
@@ -161,7 +196,7 @@ public:
     {
       if(!useBlending(apf::Mesh::TET)){
         values.allocate((P+1)*(P+2)*(P+3)/6);
-        bezier[apf::Mesh::TET](P,xi,values);
+        orderShapes[apf::Mesh::TET](P,xi,values);
       } else {
         values.allocate(2*P*P+2);
         BlendedTetGetValues(m,e,xi,values);
@@ -173,7 +208,7 @@ public:
     {
       if(!useBlending(apf::Mesh::TET)){
         grads.allocate((P+1)*(P+2)*(P+3)/6);
-        bezierGrads[apf::Mesh::TET](P,xi,grads);
+        orderShapeGrads[apf::Mesh::TET](P,xi,grads);
       } else {
         grads.allocate(2*P*P+2);
         BlendedTetGetLocalGradients(m,e,xi,grads);
@@ -270,6 +305,18 @@ public:
     }
   }
   int getOrder() {return P;}
+  bool isElementInvariant(int)
+  {
+    return true;
+  }
+  int countElementVariants(int type)
+  {
+    return countBlendedVariants(type);
+  }
+  int getElementVariant(apf::Mesh* m, apf::MeshEntity* e)
+  {
+    return getBlendedVariant(m,e);
+  }
   void getNodeXi(int type, int node, apf::Vector3& xi)
   {
     getBezierNodeXi(type,P,node,xi);
@@ -602,6 +649,18 @@ public:
       xi.zero();
   }
   int getOrder() {return 4;}
+  bool isElementInvariant(int)
+  {
+    return true;
+  }
+  int countElementVariants(int type)
+  {
+    return countBlendedVariants(type);
+  }
+  int getElementVariant(apf::Mesh* m, apf::MeshEntity* e)
+  {
+    return getBlendedVariant(m,e);
+  }
 protected:
   std::string name;
 };
@@ -609,6 +668,10 @@ protected:
 void setOrder(const int order)
 {
   P = order;
+  for (int type = 0; type < apf::Mesh::TYPES; ++type) {
+    orderShapes[type] = getBezierShape(type,P);
+    orderShapeGrads[type] = getBezierShapeGrads(type,P);
+  }
 }
 int getOrder()
 {
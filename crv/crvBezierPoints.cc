@@ -175,8 +175,7 @@ void getBezierTransformationCoefficients(int P, int type,
 
 }
 
-void getBezierJacobianDetSubdivisionCoefficients(int P, int type,
-    apf::NewArray<double> & c)
+double const* getBezierJacobianDetSubdivisionCoefficients(int P, int type)
 {
   int n = getNumControlPoints(type,P);
   PCU_ALWAYS_ASSERT(n > 0);
@@ -259,13 +258,7 @@ void getBezierJacobianDetSubdivisionCoefficients(int P, int type,
           transform[type][P][i*n+j+k*n*n] = A(i,j);
     }
   }
-
-  c.allocate(n*n*numMatrices);
-  for( int k = 0; k < numMatrices; ++k)
-    for( int i = 0; i < n; ++i)
-      for( int j = 0; j < n; ++j)
-        c[i*n+j+k*n*n] = transform[type][P][i*n+j+k*n*n];
-
+  return &transform[type][P][0];
 }
 
 void getInternalBezierTransformationCoefficients(apf::Mesh* m, int P, int blend,
@@ -231,6 +231,279 @@ static void bezierTetGrads(int P, apf::Vector3 const& xi,
       }
 }
 
+/* For the common orders the polynomials are evaluated from a table,
+   built once per element type and order, of the exponents of the
+   barycentric coordinates and the multinomial coefficient of each
+   node. The powers of each coordinate are then computed once per
+   point and shared by all the nodes, in loops of fixed length. */
+static int const maxTableOrder = 4;
+
+template <int D, int P>
+struct BernsteinTable
+{
+  enum { N = D == 2 ? P+1 :
+             D == 3 ? (P+1)*(P+2)/2 :
+                      (P+1)*(P+2)*(P+3)/6 };
+  int exponents[N][D];
+  double coefficients[N];
+  void set(int node, int const* e)
+  {
+    for (int b = 0; b < D; ++b)
+      exponents[node][b] = e[b];
+    if (D == 2)
+      coefficients[node] = binomial(P,e[0]);
+    else if (D == 3)
+      coefficients[node] = trinomial(P,e[0],e[1]);
+    else
+      coefficients[node] = quadnomial(P,e[0],e[1],e[2]);
+  }
+};
+
+/* the node order of bezierCurve */
+template <int P>
+static BernsteinTable<2,P> buildEdgeTable()
+{
+  BernsteinTable<2,P> t;
+  for (int n = 0; n <= P; ++n) {
+    int a = (n == 0) ? P : ((n == 1) ? 0 : P-n+1);
+    int e[2] = {a,P-a};
+    t.set(n,e);
+  }
+  return t;
+}
+
+/* the node order of bezierTriangle */
+template <int P>
+static BernsteinTable<3,P> buildTriangleTable()
+{
+  BernsteinTable<3,P> t;
+  for (int i = 0; i <= P; ++i)
+    for (int j = 0; j <= P-i; ++j) {
+      int e[3] = {i,j,P-i-j};
+      t.set(getTriNodeIndex(P,i,j),e);
+    }
+  return t;
+}
+
+/* the node order of bezierTet */
+template <int P>
+static BernsteinTable<4,P> buildTetTable()
+{
+  BernsteinTable<4,P> t;
+  for (int v = 0; v < 4; ++v) {
+    int e[4] = {0,0,0,0};
+    e[v] = P;
+    t.set(v,e);
+  }
+  int const (*tev)[2] = apf::tet_edge_verts;
+  for (int a = 0; a < 6; ++a)
+    for (int b = 0; b < P-1; ++b) {
+      int e[4] = {0,0,0,0};
+      e[tev[a][0]] = P-b-1;
+      e[tev[a][1]] = b+1;
+      t.set(4+a*(P-1)+b,e);
+    }
+  /* face and interior nodes have at most one zero exponent */
+  for (int i = 0; i <= P; ++i)
+    for (int j = 0; j <= P-i; ++j)
+      for (int k = 0; k <= P-i-j; ++k) {
+        int e[4] = {i,j,k,P-i-j-k};
+        int zeros = (i == 0) + (j == 0) + (k == 0) + (e[3] == 0);
+        if (zeros <= 1)
+          t.set(computeTetNodeIndex(P,i,j,k),e);
+      }
+  return t;
+}
+
+template <int D, int P>
+static void getPowers(double const* xii, double pw[D][P+1])
+{
+  for (int b = 0; b < D; ++b) {
+    pw[b][0] = 1.;
+    for (int e = 1; e <= P; ++e)
+      pw[b][e] = pw[b][e-1]*xii[b];
+  }
+}
+
+/* dpw[b][e] is the derivative of xii[b]^e */
+template <int D, int P>
+static void getPowerDerivatives(double const pw[D][P+1],
+    double dpw[D][P+1])
+{
+  for (int b = 0; b < D; ++b) {
+    dpw[b][0] = 0.;
+    for (int e = 1; e <= P; ++e)
+      dpw[b][e] = e*pw[b][e-1];
+  }
+}
+
+/* the gradient in xi from the partial derivatives in the
+   barycentric coordinates, of which only the edge is scaled */
+static apf::Vector3 getXiGradient(double const* p, int D)
+{
+  if (D == 2)
+    return apf::Vector3(0.5*(p[1]-p[0]),0,0);
+  if (D == 3)
+    return apf::Vector3(p[1]-p[0],p[2]-p[0],0);
+  return apf::Vector3(p[1]-p[0],p[2]-p[0],p[3]-p[0]);
+}
+
+template <int D, int P>
+static void getTableValues(BernsteinTable<D,P> const& t,
+    double const* xii, apf::NewArray<double>& values)
+{
+  double pw[D][P+1];
+  getPowers<D,P>(xii,pw);
+  for (int n = 0; n < BernsteinTable<D,P>::N; ++n) {
+    double v = t.coefficients[n];
+    for (int b = 0; b < D; ++b)
+      v *= pw[b][t.exponents[n][b]];
+    values[n] = v;
+  }
+}
+
+template <int D, int P>
+static void getTableGrads(BernsteinTable<D,P> const& t,
+    double const* xii, apf::NewArray<apf::Vector3>& grads)
+{
+  double pw[D][P+1];
+  double dpw[D][P+1];
+  getPowers<D,P>(xii,pw);
+  getPowerDerivatives<D,P>(pw,dpw);
+  for (int n = 0; n < BernsteinTable<D,P>::N; ++n) {
+    int const* e = t.exponents[n];
+    /* each partial is the product of the other factors,
+       from the products before and after it */
+    double before[D];
+    before[0] = t.coefficients[n];
+    for (int b = 1; b < D; ++b)
+      before[b] = before[b-1]*pw[b-1][e[b-1]];
+    double partials[D];
+    double after = 1.;
+    for (int b = D-1; b >= 0; --b) {
+      partials[b] = before[b]*dpw[b][e[b]]*after;
+      after *= pw[b][e[b]];
+    }
+    grads[n] = getXiGradient(partials,D);
+  }
+}
+
+template <int P>
+static BernsteinTable<2,P> const& getEdgeTable()
+{
+  static BernsteinTable<2,P> const t = buildEdgeTable<P>();
+  return t;
+}
+
+template <int P>
+static BernsteinTable<3,P> const& getTriangleTable()
+{
+  static BernsteinTable<3,P> const t = buildTriangleTable<P>();
+  return t;
+}
+
+template <int P>
+static BernsteinTable<4,P> const& getTetTable()
+{
+  static BernsteinTable<4,P> const t = buildTetTable<P>();
+  return t;
+}
+
+template <int P>
+static void bezierCurveTable(int, apf::Vector3 const& xi,
+    apf::NewArray<double>& values)
+{
+  double t = 0.5*(xi[0]+1.);
+  double xii[2] = {1.-t,t};
+  getTableValues(getEdgeTable<P>(),xii,values);
+}
+
+template <int P>
+static void bezierCurveGradsTable(int, apf::Vector3 const& xi,
+    apf::NewArray<apf::Vector3>& grads)
+{
+  double t = 0.5*(xi[0]+1.);
+  double xii[2] = {1.-t,t};
+  getTableGrads(getEdgeTable<P>(),xii,grads);
+}
+
+template <int P>
+static void bezierTriangleTable(int, apf::Vector3 const& xi,
+    apf::NewArray<double>& values)
+{
+  double xii[3] = {1.-xi[0]-xi[1],xi[0],xi[1]};
+  getTableValues(getTriangleTable<P>(),xii,values);
+}
+
+template <int P>
+static void bezierTriangleGradsTable(int, apf::Vector3 const& xi,
+    apf::NewArray<apf::Vector3>& grads)
+{
+  double xii[3] = {1.-xi[0]-xi[1],xi[0],xi[1]};
+  getTableGrads(getTriangleTable<P>(),xii,grads);
+}
+
+template <int P>
+static void bezierTetTable(int, apf::Vector3 const& xi,
+    apf::NewArray<double>& values)
+{
+  double xii[4] = {1.-xi[0]-xi[1]-xi[2],xi[0],xi[1],xi[2]};
+  getTableValues(getTetTable<P>(),xii,values);
+}
+
+template <int P>
+static void bezierTetGradsTable(int, apf::Vector3 const& xi,
+    apf::NewArray<apf::Vector3>& grads)
+{
+  double xii[4] = {1.-xi[0]-xi[1]-xi[2],xi[0],xi[1],xi[2]};
+  getTableGrads(getTetTable<P>(),xii,grads);
+}
+
+static bezierShape const bezierTables[apf::Mesh::TYPES][maxTableOrder+1] =
+{
+  {NULL,NULL,NULL,NULL,NULL}, //vertex
+  {NULL,bezierCurveTable<1>,bezierCurveTable<2>,
+    bezierCurveTable<3>,bezierCurveTable<4>}, //edge
+  {NULL,bezierTriangleTable<1>,bezierTriangleTable<2>,
+    bezierTriangleTable<3>,bezierTriangleTable<4>}, //triangle
+  {NULL,NULL,NULL,NULL,NULL}, //quad
+  {NULL,bezierTetTable<1>,bezierTetTable<2>,
+    bezierTetTable<3>,bezierTetTable<4>}, //tet
+  {NULL,NULL,NULL,NULL,NULL}, //hex
+  {NULL,NULL,NULL,NULL,NULL}, //prism
+  {NULL,NULL,NULL,NULL,NULL}  //pyramid
+};
+
+static bezierShapeGrads const
+bezierGradsTables[apf::Mesh::TYPES][maxTableOrder+1] =
+{
+  {NULL,NULL,NULL,NULL,NULL}, //vertex
+  {NULL,bezierCurveGradsTable<1>,bezierCurveGradsTable<2>,
+    bezierCurveGradsTable<3>,bezierCurveGradsTable<4>}, //edge
+  {NULL,bezierTriangleGradsTable<1>,bezierTriangleGradsTable<2>,
+    bezierTriangleGradsTable<3>,bezierTriangleGradsTable<4>}, //triangle
+  {NULL,NULL,NULL,NULL,NULL}, //quad
+  {NULL,bezierTetGradsTable<1>,bezierTetGradsTable<2>,
+    bezierTetGradsTable<3>,bezierTetGradsTable<4>}, //tet
+  {NULL,NULL,NULL,NULL,NULL}, //hex
+  {NULL,NULL,NULL,NULL,NULL}, //prism
+  {NULL,NULL,NULL,NULL,NULL}  //pyramid
+};
+
+bezierShape getBezierShape(int type, int P)
+{
+  if (P >= 1 && P <= maxTableOrder && bezierTables[type][P])
+    return bezierTables[type][P];
+  return bezier[type];
+}
+
+bezierShapeGrads getBezierShapeGrads(int type, int P)
+{
+  if (P >= 1 && P <= maxTableOrder && bezierGradsTables[type][P])
+    return bezierGradsTables[type][P];
+  return bezierGrads[type];
+}
+
 void collectNodeXi(int parentType, int childType, int P,
     const apf::Vector3* range, apf::NewArray<apf::Vector3>& xi)
 {
@@ -284,8 +557,9 @@ void getBezierTransformationMatrix(int type, int P,
 
   A.zero();
 
+  bezierShape shape = getBezierShape(type,P);
   for (int x = 0; x < n; ++x){
-    bezier[type](P,xi[x],values);
+    shape(P,xi[x],values);
     for(int i = 0; i < n; ++i){
       A(x,i) = values[i];
     }
@@ -304,8 +578,9 @@ void getBezierTransformationMatrix(int parentType,
   collectNodeXi(parentType,childType,P,childRange,xi);
 
   apf::NewArray<double> values(n);
+  bezierShape shape = getBezierShape(parentType,P);
   for(int x = 0; x < nxi; ++x){
-    bezier[parentType](P,xi[x],values);
+    shape(P,xi[x],values);
     for(int i = 0; i < n; ++i){
       A(x,i) = values[i];
     }
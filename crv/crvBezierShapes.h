@@ -39,6 +39,15 @@ extern const bezierShape bezier[apf::Mesh::TYPES];
 /** \brief table of shape function gradients */
 extern const bezierShapeGrads bezierGrads[apf::Mesh::TYPES];
 
+/** \brief the shape functions of a type and order
+    \details orders up to 4 use functions specialized for the order,
+    higher orders the bezier table entry, which they agree with
+    to rounding */
+bezierShape getBezierShape(int type, int P);
+/** \brief the shape function gradients of a type and order,
+    see getBezierShape */
+bezierShapeGrads getBezierShapeGrads(int type, int P);
+
 /** \brief Get transformation matrix corresponding to a parametric range
     \details Range is an array of size(num vertices), this is used for
     subdivision, refinement. It is the element transformation matrix,
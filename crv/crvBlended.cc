@@ -10,6 +10,7 @@
 #include "crvBezier.h"
 #include "crvMath.h"
 #include "crvTables.h"
+#include <apfShape.h>
 #include <pcu_util.h>
 /* see bezier.tex in SCOREC/docs repo */
 namespace crv {
@@ -21,14 +22,29 @@ static double const blendingTol = 1.e-12;
 static int B[apf::Mesh::TYPES] =
   {0,0,0,0,0,0,0,0};
 
+/* the shapes keep their values at integration points,
+   which the blending changes */
+static void clearBlendedCaches()
+{
+  const char* names[2] = {"Bezier","GregorySurface"};
+  for (int i = 0; i < 2; ++i){
+    apf::FieldShape* s = apf::getShapeByName(names[i]);
+    if (s)
+      s->clearCached();
+  }
+}
+
 void setBlendingOrder(const int type, const int b)
 {
   PCU_ALWAYS_ASSERT(b >= 0 && b <= 2);
-  if (type == apf::Mesh::TYPES){
-    for(int t = 0; t < apf::Mesh::TYPES; ++t)
+  bool changed = false;
+  for(int t = 0; t < apf::Mesh::TYPES; ++t)
+    if ((type == apf::Mesh::TYPES || t == type) && B[t] != b){
       B[t] = b;
-  } else
-    B[type] = b;
+      changed = true;
+    }
+  if (changed)
+    clearBlendedCaches();
 }
 
 int getBlendingOrder(const int type)
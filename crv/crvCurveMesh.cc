@@ -67,22 +67,30 @@ void snapToInterpolate(apf::Mesh2* m, apf::MeshEntity* e, bool isNew)
   double lengthScale = (p1 - p0).getLength();
   apf::FieldShape * fs = m->getShape();
   int non = fs->countNodesOn(type);
-  apf::Vector3 p, xi, pt0, pt(0,0,0);
+  apf::Vector3 xi, pt0;
+  SplitVertexParams split;
+  getSplitVertexParams(m,e,split);
+  apf::ModelEntity* g = split.g;
+  /* the nodes of the entity are evaluated in one batch */
+  apf::NewArray<apf::ModelEntity*> models(non);
+  apf::NewArray<apf::Vector3> params(non);
+  apf::NewArray<apf::Vector3> pts(non);
   for(int i = 0; i < non; ++i){
-    apf::ModelEntity* g = m->toModel(e);
     fs->getNodeXi(type,i,xi);
     if(type == apf::Mesh::EDGE)
-      transferParametricOnEdgeSplit(m,e,0.5*(xi[0]+1.),p);
-    else
-      transferParametricOnTriSplit(m,e,xi,p);
-    m->snapToModel(g,p,pt);
+      xi[0] = 0.5*(xi[0]+1.);
+    transferParametricOnSplit(m,split,xi,params[i]);
+    models[i] = g;
+  }
+  m->snapToModel(non,&models[0],&params[0],&pts[0]);
+  for(int i = 0; i < non; ++i){
     if (isNew || !m->canGetClosestPoint()) {
-      m->setPoint(e,i,pt);
+      m->setPoint(e,i,pts[i]);
       continue;
     }
     m->getPoint(e,i,pt0);
     if (!m->isOnModel(g, pt0, lengthScale))
-      m->setPoint(e,i,pt);
+      m->setPoint(e,i,pts[i]);
   }
 }
 
@@ -297,12 +305,13 @@ void GregoryCurver::setInternalPointsLocally()
     // elevated edges
     apf::NewArray<apf::Vector3> q(12);
 
+    apf::ModelEntity* models[3] = {g,g,g};
+    apf::Vector3 params[3];
     for(int i = 0; i < 3; ++i){
-      apf::Vector3 param;
       m_mesh->getPoint(verts[i],0,q[i]);
-      m_mesh->getParamOn(g,verts[i],param);
-      m_mesh->getNormal(g,param,n[i]);
+      m_mesh->getParamOn(g,verts[i],params[i]);
     }
+    m_mesh->getNormal(3,models,params,n);
 
     // elevate the edge points without formally setting them to q
     // compute tangent vectors, W
@@ -14,10 +14,88 @@
 #include "crvQuality.h"
 #include <apfTagData.h>
 #include <apfVectorField.h>
+#include <PCU.h>
+#include <vector>
 
 namespace crv {
 
-void changeMeshOrder(apf::Mesh2* m, int newOrder)
+/* the rows of the elevation of one entity type from order P to P+r
+   that give its interior control points of order P+r, row-major over
+   the control points of order P, built once from unit vectors */
+static double const* getInteriorElevation(int type, int P, int r)
+{
+  static std::vector<double> rows[apf::Mesh::TYPES][MAX_ORDER][MAX_ORDER];
+  std::vector<double>& op = rows[type][P][r];
+  if (!op.empty())
+    return &op[0];
+  int n = getNumControlPoints(type,P);
+  int ne = getNumControlPoints(type,P+r);
+  int nOn = getNumInternalControlPoints(type,P+r);
+  int offset = (type == apf::Mesh::EDGE) ? 1 : ne-nOn;
+  op.resize(nOn*n);
+  apf::NewArray<apf::Vector3> unit(n);
+  apf::NewArray<apf::Vector3> elevated(ne);
+  for (int j = 0; j < n; ++j){
+    for (int i = 0; i < n; ++i)
+      unit[i].zero();
+    unit[j][0] = 1.;
+    for (int i = 0; i < ne; ++i)
+      elevated[i].zero();
+    elevateBezier(type,P,r,unit,elevated);
+    for (int i = 0; i < nOn; ++i)
+      op[i*n+j] = elevated[offset+i][0];
+  }
+  return &op[0];
+}
+
+/* elevates the interior control points of many entities of one type
+   in contiguous chunks, one per thread, reading the coordinates of
+   the old order and writing the new points into one array */
+struct ElevationChunks
+{
+  static void elevate(void* p, size_t first, size_t end)
+  {
+    ElevationChunks* all = static_cast<ElevationChunks*>(p);
+    int n = all->n;
+    int nOn = all->nOn;
+    apf::NewArray<apf::Vector3> nodes;
+    apf::MeshElement* me =
+      apf::createMeshElement(all->mesh,all->entities[first]);
+    apf::Element* elem =
+      apf::createElement(all->mesh->getCoordinateField(),me);
+    for (size_t k = first; k < end; ++k){
+      if (k != first){
+        apf::rebindMeshElement(me,all->entities[k]);
+        apf::rebindElement(elem,me);
+      }
+      apf::getVectorNodes(elem,nodes);
+      apf::Vector3* points = &all->points[k*nOn];
+      for (int i = 0; i < nOn; ++i){
+        double const* row = all->rows + i*n;
+        apf::Vector3 x(0,0,0);
+        for (int j = 0; j < n; ++j)
+          x += nodes[j]*row[j];
+        points[i] = x;
+      }
+    }
+    apf::destroyElement(elem);
+    apf::destroyMeshElement(me);
+  }
+  void run(int threads)
+  {
+    size_t ne = entities.size();
+    points.resize(ne*nOn);
+    PCU_Thrd_Chunks(threads, ne, elevate, this);
+  }
+  apf::Mesh* mesh;
+  int n;
+  int nOn;
+  double const* rows;
+  std::vector<apf::MeshEntity*> entities;
+  std::vector<apf::Vector3> points;
+};
+
+void changeMeshOrder(apf::Mesh2* m, int newOrder, int threads)
 {
   std::string name = m->getShape()->getName();
   if(name != std::string("Bezier"))
@@ -60,14 +138,14 @@ void changeMeshOrder(apf::Mesh2* m, int newOrder)
     apf::Vector3 p;
     while ((e = m->iterate(it))) {
       if(canSnap && isBoundaryEntity(m,e)){
+        SplitVertexParams split;
+        getSplitVertexParams(m,e,split);
         for(int i = 0; i < nNewOn; ++i){
-          apf::ModelEntity* g = m->toModel(e);
           getBezierNodeXi(type,newOrder,i,xi);
           if(type == apf::Mesh::EDGE)
-            transferParametricOnEdgeSplit(m,e,0.5*(xi[0]+1.),p);
-          else
-            transferParametricOnTriSplit(m,e,xi,p);
-          m->snapToModel(g,p,coord);
+            xi[0] = 0.5*(xi[0]+1.);
+          transferParametricOnSplit(m,split,xi,p);
+          m->snapToModel(split.g,p,coord);
           apf::setVector(newCoordinateField,e,i,coord);
         }
       } else if (newOrder < oldOrder) {
@@ -96,14 +174,11 @@ void changeMeshOrder(apf::Mesh2* m, int newOrder)
     apf::NewArray<apf::Vector3> newNodes(nNew);
     it = m->begin(d);
 
-    // offset used in elevation
-    int offset = nNew-nNewOn;
-    if (type == apf::Mesh::EDGE)
-      offset = 1;
-
     apf::NewArray<double> c;
     crv::getBezierTransformationCoefficients(newOrder,type,c);
 
+    // entities that only need elevation are done together below
+    ElevationChunks elevation;
     while ((e = m->iterate(it))) {
       if(newOrder < oldOrder || (canSnap && isBoundaryEntity(m,e))){
         // create element to change interpolating points
@@ -116,20 +191,24 @@ void changeMeshOrder(apf::Mesh2* m, int newOrder)
           apf::setVector(newCoordinateField,e,i,newNodes[i]);
         apf::destroyElement(newElem);
       } else {
-        // elevate the order to create elements from coordinate field
-        setOrder(oldOrder);
-        apf::Element* oldElem = apf::createElement(m->getCoordinateField(),e);
-        apf::getVectorNodes(oldElem,oldNodes);
-        elevateBezier(type,oldOrder,newOrder-oldOrder,oldNodes,newNodes);
-        setOrder(newOrder); //set order back
-        for(int i = 0; i < nNewOn; ++i){
-          apf::setVector(newCoordinateField,e,i,newNodes[offset+i]);
-        }
-        apf::destroyElement(oldElem);
-
+        elevation.entities.push_back(e);
       }
     }
     m->end(it);
+    if (elevation.entities.empty())
+      continue;
+    // elevate the order to create elements from coordinate field
+    setOrder(oldOrder);
+    elevation.mesh = m;
+    elevation.n = getNumControlPoints(type,oldOrder);
+    elevation.nOn = nNewOn;
+    elevation.rows = getInteriorElevation(type,oldOrder,newOrder-oldOrder);
+    elevation.run(threads);
+    setOrder(newOrder); //set order back
+    for (size_t k = 0; k < elevation.entities.size(); ++k)
+      for(int i = 0; i < nNewOn; ++i)
+        apf::setVector(newCoordinateField,elevation.entities[k],i,
+            elevation.points[k*nNewOn+i]);
   }
   setOrder(newOrder);
   // set the coordinate field to the newly created one
@@ -266,11 +345,64 @@ elevateBezierJacobianDetArray[apf::Mesh::TYPES] =
   NULL     //pyramid
 };
 
+/* elevation by one as a sparse matrix, each elevated node
+   having at most one parent per vertex of the entity */
+struct ElevationOperator
+{
+  std::vector<int> offsets;
+  std::vector<int> columns;
+  std::vector<double> weights;
+};
+
+static ElevationOperator const& getJacobianDetElevation(int type, int P)
+{
+  static ElevationOperator ops[apf::Mesh::TYPES][MAX_ORDER];
+  ElevationOperator& op = ops[type][P];
+  if (!op.offsets.empty())
+    return op;
+  int n = getNumControlPoints(type,P);
+  int ne = getNumControlPoints(type,P+1);
+  std::vector<std::vector<std::pair<int,double> > > rows(ne);
+  apf::NewArray<double> unit(n);
+  apf::NewArray<double> elevated(ne);
+  for (int j = 0; j < n; ++j){
+    for (int i = 0; i < n; ++i)
+      unit[i] = 0.;
+    unit[j] = 1.;
+    for (int i = 0; i < ne; ++i)
+      elevated[i] = 0.;
+    elevateBezierJacobianDetArray[type](P,1,unit,elevated);
+    for (int i = 0; i < ne; ++i)
+      if (elevated[i] != 0.)
+        rows[i].push_back(std::make_pair(j,elevated[i]));
+  }
+  op.offsets.push_back(0);
+  for (int i = 0; i < ne; ++i){
+    for (size_t k = 0; k < rows[i].size(); ++k){
+      op.columns.push_back(rows[i][k].first);
+      op.weights.push_back(rows[i][k].second);
+    }
+    op.offsets.push_back(op.columns.size());
+  }
+  return op;
+}
+
 void elevateBezierJacobianDet(int type, int P, int r,
     apf::NewArray<double>& nodes,
     apf::NewArray<double>& elevatedNodes)
 {
-  elevateBezierJacobianDetArray[type](P,r,nodes,elevatedNodes);
+  if (r != 1 || P+1 >= (int)MAX_ORDER){
+    elevateBezierJacobianDetArray[type](P,r,nodes,elevatedNodes);
+    return;
+  }
+  ElevationOperator const& op = getJacobianDetElevation(type,P);
+  int ne = op.offsets.size()-1;
+  for (int i = 0; i < ne; ++i){
+    double sum = 0.;
+    for (int k = op.offsets[i]; k < op.offsets[i+1]; ++k)
+      sum += nodes[op.columns[k]]*op.weights[k];
+    elevatedNodes[i] = sum;
+  }
 }
 
 typedef void (*ElevateFunction)(int P, int r,
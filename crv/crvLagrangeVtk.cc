@@ -0,0 +1,294 @@
+/*
+ * Copyright 2025 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "crv.h"
+#include "crvVtk.h"
+#include "PCU.h"
+#include <sstream>
+#include <fstream>
+#include <pcu_util.h>
+
+namespace crv {
+
+/* writes the curved mesh as VTK Lagrange cells, which paraview
+   draws at any order */
+
+/* the lattice points of a simplex in the node order of the VTK
+   Lagrange cells: vertices, then edge interiors from the first vertex
+   of the edge to the second, then face interiors, which are ordered
+   as triangles of order (p-3) inset by one step, then the region
+   interior as a tet of order (p-4) inset by one step.
+   Points are barycentric coordinates times the cell order. */
+typedef std::vector<int> Lattice;
+
+static Lattice getStep(Lattice const& a, Lattice const& b, int p)
+{
+  Lattice s(4);
+  for (int i = 0; i < 4; ++i)
+    s[i] = (b[i] - a[i]) / p;
+  return s;
+}
+
+static Lattice move(Lattice const& a, Lattice const& s, int k)
+{
+  Lattice b(4);
+  for (int i = 0; i < 4; ++i)
+    b[i] = a[i] + s[i] * k;
+  return b;
+}
+
+static void addEdgeInterior(Lattice const& a, Lattice const& b, int p,
+    std::vector<Lattice>& points)
+{
+  Lattice s = getStep(a,b,p);
+  for (int k = 1; k < p; ++k)
+    points.push_back(move(a,s,k));
+}
+
+static void addTriangle(Lattice const& a, Lattice const& b,
+    Lattice const& c, int p, std::vector<Lattice>& points);
+
+static void addTriangleInterior(Lattice const& a, Lattice const& b,
+    Lattice const& c, int p, std::vector<Lattice>& points)
+{
+  if (p < 3)
+    return;
+  Lattice ab = getStep(a,b,p);
+  Lattice ac = getStep(a,c,p);
+  Lattice bc = getStep(b,c,p);
+  addTriangle(move(move(a,ab,1),ac,1),
+              move(move(b,ab,-1),bc,1),
+              move(move(c,ac,-1),bc,-1),p-3,points);
+}
+
+static void addTriangle(Lattice const& a, Lattice const& b,
+    Lattice const& c, int p, std::vector<Lattice>& points)
+{
+  points.push_back(a);
+  if (p == 0)
+    return;
+  points.push_back(b);
+  points.push_back(c);
+  addEdgeInterior(a,b,p,points);
+  addEdgeInterior(b,c,p,points);
+  addEdgeInterior(c,a,p,points);
+  addTriangleInterior(a,b,c,p,points);
+}
+
+static void addTet(Lattice const& a, Lattice const& b,
+    Lattice const& c, Lattice const& d, int p, std::vector<Lattice>& points)
+{
+  points.push_back(a);
+  if (p == 0)
+    return;
+  points.push_back(b);
+  points.push_back(c);
+  points.push_back(d);
+  addEdgeInterior(a,b,p,points);
+  addEdgeInterior(b,c,p,points);
+  addEdgeInterior(c,a,p,points);
+  addEdgeInterior(a,d,p,points);
+  addEdgeInterior(b,d,p,points);
+  addEdgeInterior(c,d,p,points);
+  addTriangleInterior(a,b,d,p,points);
+  addTriangleInterior(b,c,d,p,points);
+  addTriangleInterior(a,c,d,p,points);
+  addTriangleInterior(a,b,c,p,points);
+  if (p < 4)
+    return;
+  Lattice ab = getStep(a,b,p);
+  Lattice ac = getStep(a,c,p);
+  Lattice ad = getStep(a,d,p);
+  Lattice bc = getStep(b,c,p);
+  Lattice bd = getStep(b,d,p);
+  Lattice cd = getStep(c,d,p);
+  addTet(move(move(move(a,ab,1),ac,1),ad,1),
+         move(move(move(b,ab,-1),bc,1),bd,1),
+         move(move(move(c,ac,-1),bc,-1),cd,1),
+         move(move(move(d,ad,-1),bd,-1),cd,-1),p-4,points);
+}
+
+/* the parametric coordinates of the Lagrange nodes of one cell */
+static void getLagrangeXi(int type, int p, std::vector<apf::Vector3>& xi)
+{
+  std::vector<Lattice> verts(4, Lattice(4,0));
+  for (int i = 0; i < 4; ++i)
+    verts[i][i] = p;
+  std::vector<Lattice> points;
+  switch (type) {
+  case apf::Mesh::EDGE:
+    points.push_back(verts[0]);
+    points.push_back(verts[1]);
+    addEdgeInterior(verts[0],verts[1],p,points);
+    break;
+  case apf::Mesh::TRIANGLE:
+    addTriangle(verts[0],verts[1],verts[2],p,points);
+    break;
+  case apf::Mesh::TET:
+    addTet(verts[0],verts[1],verts[2],verts[3],p,points);
+    break;
+  default:
+    fail("Lagrange cells are only written for simplices\n");
+  }
+  xi.resize(points.size());
+  for (size_t i = 0; i < points.size(); ++i) {
+    if (type == apf::Mesh::EDGE)
+      xi[i] = apf::Vector3(2.*points[i][1]/p-1.,0,0);
+    else
+      xi[i] = apf::Vector3(points[i][1],points[i][2],points[i][3])/p;
+  }
+}
+
+/* the values of the (es) shape functions of (e) at each of (xi),
+   one row per point */
+static void getShapeValues(apf::Mesh* m, apf::EntityShape* es,
+    apf::MeshEntity* e, std::vector<apf::Vector3> const& xi,
+    std::vector<double>& values)
+{
+  int nn = es->countNodes();
+  apf::NewArray<double> v;
+  for (size_t i = 0; i < xi.size(); ++i) {
+    es->getValues(m,e,xi[i],v);
+    for (int j = 0; j < nn; ++j)
+      values[i*nn+j] = v[j];
+  }
+}
+
+static std::string getLagrangeDirectoryStr(const char* prefix, int type)
+{
+  std::stringstream ss;
+  ss << prefix << "/lagrange" << getSuffix(type);
+  return ss.str();
+}
+
+void writeLagrangeVtuFiles(apf::Mesh* m, int type, const char* prefix)
+{
+  double t0 = PCU_Time();
+  std::string dir = getLagrangeDirectoryStr(prefix, type);
+  if (!PCU_Comm_Self()) {
+    safe_mkdir(prefix);
+    safe_mkdir(dir.c_str());
+    safe_mkdir((dir + "/vtu").c_str());
+    writePvtuFile(dir.c_str(),"",m,type,false);
+  }
+  PCU_Barrier();
+
+  std::stringstream ss;
+  ss << dir << "/vtu/order_"
+     << m->getShape()->getOrder() << "_"
+     << PCU_Comm_Self()
+     << ".vtu";
+  std::string fileName = ss.str();
+
+  int order = m->getShape()->getOrder();
+  std::vector<apf::Vector3> xi;
+  getLagrangeXi(type,order,xi);
+  int nc = xi.size();
+  /* the geometry is a fixed combination of the element nodes, so the
+     shape functions are evaluated once for all elements, unless
+     blending or the Gregory shape make them depend on the element */
+  apf::FieldShape* shape = m->getShape();
+  apf::EntityShape* es = shape->getEntityShape(type);
+  bool perElement = getBlendingOrder(type) > 0 ||
+    std::string(shape->getName()) == "GregorySurface";
+  int nn = es->countNodes();
+  std::vector<double> values(nc*nn);
+
+  std::vector<apf::MeshEntity*> elements;
+  apf::MeshIterator* it = m->begin(apf::Mesh::typeDimension[type]);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it)))
+    if (m->getType(e) == type && m->isOwned(e))
+      elements.push_back(e);
+  m->end(it);
+
+  int count = elements.size();
+  std::stringstream buf;
+  writeStart(buf,count*nc,count);
+  buf << "<Points>\n";
+  apf::Field* coordinates = m->getCoordinateField();
+  writeDataHeader(buf,coordinates->getName(),
+      coordinates->getScalarType(),3);
+  apf::NewArray<apf::Vector3> nodes;
+  for (int k = 0; k < count; ++k) {
+    if (k == 0 || perElement)
+      getShapeValues(m,es,elements[k],xi,values);
+    apf::Element* elem = apf::createElement(coordinates,elements[k]);
+    apf::getVectorNodes(elem,nodes);
+    apf::destroyElement(elem);
+    for (int i = 0; i < nc; ++i) {
+      apf::Vector3 pt(0,0,0);
+      for (int j = 0; j < nn; ++j)
+        pt += nodes[j] * values[i*nn+j];
+      writePoint(buf,pt);
+    }
+  }
+  buf << "</DataArray>\n";
+  buf << "</Points>\n";
+
+  /* VTK_LAGRANGE_CURVE, VTK_LAGRANGE_TRIANGLE and
+     VTK_LAGRANGE_TETRAHEDRON */
+  int lagrangeType = 68;
+  if (type == apf::Mesh::TRIANGLE)
+    lagrangeType = 69;
+  else if (type == apf::Mesh::TET)
+    lagrangeType = 71;
+  buf << "<Cells>\n";
+  buf << "<DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n";
+  for (int k = 0; k < count; ++k) {
+    for (int i = 0; i < nc; ++i)
+      buf << k*nc+i << ' ';
+    buf << '\n';
+  }
+  buf << "</DataArray>\n";
+  buf << "<DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n";
+  for (int k = 0; k < count; ++k)
+    buf << (k+1)*nc << '\n';
+  buf << "</DataArray>\n";
+  buf << "<DataArray type=\"UInt8\" Name=\"types\" format=\"ascii\">\n";
+  for (int k = 0; k < count; ++k)
+    buf << lagrangeType << '\n';
+  buf << "</DataArray>\n";
+  buf << "</Cells>\n";
+
+  buf << "<PointData>\n";
+  for (int f = 0; f < m->countFields(); ++f) {
+    apf::Field* field = m->getField(f);
+    if (!isPrintable(field))
+      continue;
+    int ncomp = apf::countComponents(field);
+    writeDataHeader(buf,field->getName(),field->getScalarType(),ncomp);
+    apf::NewArray<double> c(ncomp);
+    for (int k = 0; k < count; ++k) {
+      apf::Element* elem = apf::createElement(field,elements[k]);
+      for (int i = 0; i < nc; ++i) {
+        apf::getComponents(elem,xi[i],&c[0]);
+        for (int j = 0; j < ncomp; ++j)
+          buf << c[j] << ' ';
+        buf << '\n';
+      }
+      apf::destroyElement(elem);
+    }
+    buf << "</DataArray>\n";
+  }
+  buf << "</PointData>\n";
+  writeEnd(buf);
+
+  {
+    std::ofstream file(fileName.c_str());
+    PCU_ALWAYS_ASSERT(file.is_open());
+    file << buf.rdbuf();
+  }
+
+  PCU_Barrier();
+  double t1 = PCU_Time();
+  if (!PCU_Comm_Self())
+    printf("%s Lagrange vtk files %s written in %f seconds\n",
+        apf::Mesh::typeName[type],dir.c_str(),t1 - t0);
+}
+
+} //namespace crv
@@ -35,8 +35,8 @@ public:
     n = getNumControlPoints(apf::Mesh::TRIANGLE,2*(order-1));
     if (algorithm == 0 || algorithm == 2){
       for (int d = 1; d <= 2; ++d)
-      getBezierJacobianDetSubdivisionCoefficients(
-          2*(order-1),apf::Mesh::simplexTypes[d],subdivisionCoeffs[d]);
+      subdivisionCoeffs[d] = getBezierJacobianDetSubdivisionCoefficients(
+          2*(order-1),apf::Mesh::simplexTypes[d]);
     }
   };
   virtual ~Quality2D() {};
@@ -45,7 +45,7 @@ public:
   int blendingOrder;
   int n;
   apf::NewArray<double> blendingCoeffs;
-  apf::NewArray<double> subdivisionCoeffs[3];
+  double const* subdivisionCoeffs[3];
 };
 
 class Quality3D : public Quality
@@ -55,34 +55,57 @@ public:
   {
     if (algorithm == 0 || algorithm == 2){
       for (int d = 1; d <= 3; ++d)
-      getBezierJacobianDetSubdivisionCoefficients(
-          3*(order-1),apf::Mesh::simplexTypes[d],subdivisionCoeffs[d]);
+      subdivisionCoeffs[d] = getBezierJacobianDetSubdivisionCoefficients(
+          3*(order-1),apf::Mesh::simplexTypes[d]);
     }
     n = getNumControlPoints(apf::Mesh::TET,3*(order-1));
     xi.allocate(n);
-    transformationMatrix.resize(n,n);
-    mth::Matrix<double> A(n,n);
     collectNodeXi(apf::Mesh::TET,apf::Mesh::TET,3*(order-1),
         elem_vert_xi[apf::Mesh::TET],xi);
-    getBezierTransformationMatrix(apf::Mesh::TET,3*(order-1),A,
-        elem_vert_xi[apf::Mesh::TET]);
-    invertMatrixWithPLU(n,A,transformationMatrix);
+    transformationMatrix = getTransformationMatrix(order,n);
   }
   virtual ~Quality3D() {};
   double getQuality(apf::MeshEntity* e);
   int checkValidity(apf::MeshEntity* e);
+  void checkValidities(apf::MeshEntity* const* e, int count, int* tags);
   // 3D uses an alternate method of computing these
   // returns a validity tag so both quality and validity can
   // quit early if this function thinks they should
   // if validity = true, quit if its obvious the element is invalid
   int computeJacDetNodes(apf::MeshEntity* e,
       apf::NewArray<double>& nodes, bool validity);
+  // the two halves of computeJacDetNodes, sampling det(J) at xi
+  // and transforming the samples, stride apart, into control points
+  int sampleJacDet(apf::MeshEntity* e, double* interNodes, int stride,
+      bool validity);
+  int checkJacDetNodes(apf::MeshEntity* e, apf::NewArray<double>& nodes);
+  // the inverse of the Bezier transformation matrix, row major,
+  // computed once per order
+  static double const* getTransformationMatrix(int order, int n);
   int n;
-  apf::NewArray<double> subdivisionCoeffs[4];
+  double const* subdivisionCoeffs[4];
   apf::NewArray<apf::Vector3> xi;
-  mth::Matrix<double> transformationMatrix;
+  double const* transformationMatrix;
 };
 
+double const* Quality3D::getTransformationMatrix(int order, int n)
+{
+  static apf::NewArray<double> transform[MAX_ORDER];
+  PCU_ALWAYS_ASSERT(order < (int)MAX_ORDER);
+  if (!transform[order].allocated()){
+    mth::Matrix<double> A(n,n);
+    mth::Matrix<double> Ai(n,n);
+    getBezierTransformationMatrix(apf::Mesh::TET,3*(order-1),A,
+        elem_vert_xi[apf::Mesh::TET]);
+    invertMatrixWithPLU(n,A,Ai);
+    transform[order].allocate(n*n);
+    for (int i = 0; i < n; ++i)
+      for (int j = 0; j < n; ++j)
+        transform[order][i*n+j] = Ai(i,j);
+  }
+  return &transform[order][0];
+}
+
 Quality* makeQuality(apf::Mesh* m, int algorithm)
 {
   if (m->getDimension() == 2)
@@ -100,6 +123,12 @@ Quality::Quality(apf::Mesh* m, int algorithm_) :
   PCU_ALWAYS_ASSERT(order >= 1);
 };
 
+void Quality::checkValidities(apf::MeshEntity* const* e, int n, int* tags)
+{
+  for (int i = 0; i < n; ++i)
+    tags[i] = checkValidity(e[i]);
+}
+
 /* This work is based on the approach of Geometric Validity of high-order
  * lagrange finite elements, theory and practical guidance,
  * by George, Borouchaki, and Barral. (2014)
@@ -331,7 +360,7 @@ static void getJacDetBySubdivision(int type, int P,
 }
 
 static void getJacDetBySubdivisionMatrices(int type, int P,
-    int iter, apf::NewArray<double>& c,apf::NewArray<double>& nodes,
+    int iter, double const* c,apf::NewArray<double>& nodes,
     double& minJ, double& maxJ, bool& done, bool& quality)
 {
   int n = getNumControlPoints(type,P);
@@ -474,6 +503,47 @@ int Quality3D::checkValidity(apf::MeshEntity* e)
   int validityTag = computeJacDetNodes(e,nodes,true);
   if (validityTag > 1)
     return validityTag;
+  return checkJacDetNodes(e,nodes);
+}
+
+/* elements in batches share each pass over the transformation
+   matrix, which for higher orders does not fit in cache */
+static int const validityBatch = 32;
+
+void Quality3D::checkValidities(apf::MeshEntity* const* e, int count,
+    int* tags)
+{
+  apf::NewArray<double> interNodes(n*validityBatch);
+  apf::NewArray<double> batchNodes(n*validityBatch);
+  apf::NewArray<double> nodes(n);
+  for (int first = 0; first < count; first += validityBatch){
+    int nb = std::min(validityBatch,count-first);
+    for (int b = 0; b < nb; ++b)
+      tags[first+b] = sampleJacDet(e[first+b],&interNodes[b],nb,true);
+    for (int k = 0; k < n*nb; ++k)
+      batchNodes[k] = 0.;
+    for (int i = 0; i < n; ++i){
+      double* row = &batchNodes[i*nb];
+      for (int j = 0; j < n; ++j){
+        double t = transformationMatrix[i*n+j];
+        double const* in = &interNodes[j*nb];
+        for (int b = 0; b < nb; ++b)
+          row[b] += in[b]*t;
+      }
+    }
+    for (int b = 0; b < nb; ++b){
+      if (tags[first+b] > 1)
+        continue;
+      for (int i = 0; i < n; ++i)
+        nodes[i] = batchNodes[i*nb+b];
+      tags[first+b] = checkJacDetNodes(e[first+b],nodes);
+    }
+  }
+}
+
+int Quality3D::checkJacDetNodes(apf::MeshEntity* e,
+    apf::NewArray<double>& nodes)
+{
 // check verts
   apf::Downward verts;
   mesh->getDownward(e,0,verts);
@@ -618,16 +688,36 @@ int Quality3D::computeJacDetNodes(apf::MeshEntity* e,
     apf::NewArray<double>& nodes, bool validity)
 {
   apf::NewArray<double> interNodes(n);
+  int validityTag = sampleJacDet(e,&interNodes[0],1,validity);
+  if (validityTag > 1)
+    return validityTag;
+
+  for( int i = 0; i < n; ++i){
+    nodes[i] = 0.;
+    for( int j = 0; j < n; ++j)
+      nodes[i] += interNodes[j]*transformationMatrix[i*n+j];
+  }
+
+  return 1;
+}
+
+/* samples that are skipped by an early return are zeroed, so
+   batches of samples never hold garbage */
+int Quality3D::sampleJacDet(apf::MeshEntity* e, double* interNodes,
+    int stride, bool validity)
+{
+  for (int i = 0; i < n; ++i)
+    interNodes[i*stride] = 0.;
   apf::MeshElement* me = apf::createMeshElement(mesh,e);
   if (validity == false)
   {
     for (int i = 0; i < n; ++i){
-      interNodes[i] = apf::getDV(me,xi[i]);
+      interNodes[i*stride] = apf::getDV(me,xi[i]);
     }
   }
   for (int i = 0; i < 4; ++i){
-    interNodes[i] = apf::getDV(me,xi[i]);
-    if(interNodes[i] < 1e-10){
+    interNodes[i*stride] = apf::getDV(me,xi[i]);
+    if(interNodes[i*stride] < 1e-10){
       apf::destroyMeshElement(me);
       return i+2;
     }
@@ -635,8 +725,8 @@ int Quality3D::computeJacDetNodes(apf::MeshEntity* e,
   for (int edge = 0; edge < 6; ++edge){
     for (int i = 0; i < 3*(order-1)-1; ++i){
       int index = 4+edge*(3*(order-1)-1)+i;
-      interNodes[index] = apf::getDV(me,xi[index]);
-      if(interNodes[index] < 1e-10){
+      interNodes[index*stride] = apf::getDV(me,xi[index]);
+      if(interNodes[index*stride] < 1e-10){
         apf::destroyMeshElement(me);
         return edge+8;
       }
@@ -645,8 +735,8 @@ int Quality3D::computeJacDetNodes(apf::MeshEntity* e,
   for (int face = 0; face < 4; ++face){
     for (int i = 0; i < (3*order-4)*(3*order-5)/2; ++i){
       int index = 18*order-20+face*(3*order-4)*(3*order-5)/2+i;
-      interNodes[index] = apf::getDV(me,xi[index]);
-      if(interNodes[index] < 1e-10){
+      interNodes[index*stride] = apf::getDV(me,xi[index]);
+      if(interNodes[index*stride] < 1e-10){
         apf::destroyMeshElement(me);
         return face+14;
       }
@@ -654,20 +744,13 @@ int Quality3D::computeJacDetNodes(apf::MeshEntity* e,
   }
   for (int i = 0; i < (3*order-4)*(3*order-5)*(3*order-6)/6; ++i){
     int index = 18*order*order-36*order+20+i;
-    interNodes[index] = apf::getDV(me,xi[index]);
-    if(interNodes[index] < 1e-10){
+    interNodes[index*stride] = apf::getDV(me,xi[index]);
+    if(interNodes[index*stride] < 1e-10){
       apf::destroyMeshElement(me);
       return 20;
     }
   }
   apf::destroyMeshElement(me);
-
-  for( int i = 0; i < n; ++i){
-    nodes[i] = 0.;
-    for( int j = 0; j < n; ++j)
-      nodes[i] += interNodes[j]*transformationMatrix(i,j);
-  }
-
   return 1;
 }
 
@@ -20,12 +20,12 @@ namespace crv {
 /** \brief subdivide jacobian det using subdivision matrices
     \details see getBezierJacobianDetSubdivisionCoefficients */
 void subdivideBezierEntityJacobianDet(int P, int type,
-    apf::NewArray<double>& c, apf::NewArray<double>& nodes,
+    double const* c, apf::NewArray<double>& nodes,
     apf::NewArray<double> *subNodes);
 /** \brief get matrices used for uniform subdivision, 2^dim matrices,
-     unrolled into a double */
-void getBezierJacobianDetSubdivisionCoefficients(int P, int type,
-    apf::NewArray<double>& c);
+     unrolled into a double
+    \details they are computed once per type and order and kept */
+double const* getBezierJacobianDetSubdivisionCoefficients(int P, int type);
 
 /** \brief typedef for table of jacobian det subdivision functions */
 typedef void (*SubdivisionFunction)(int P,
@@ -34,7 +34,8 @@ typedef void (*SubdivisionFunction)(int P,
 /** \brief table of jacobian det subdivision functions */
 extern const SubdivisionFunction subdivideBezierJacobianDet[apf::Mesh::TYPES];
 
-/** \brief elevate jacobian det to higher order, used in getQuality */
+/** \brief elevate jacobian det to higher order, used in getQuality
+    \details elevation by one is kept as a matrix per type and order */
 void elevateBezierJacobianDet(int type, int P, int r,
     apf::NewArray<double>& nodes,
     apf::NewArray<double>& elevatedNodes);
@@ -199,7 +199,7 @@ public:
       if (!isBoundaryEntity(mesh,edges[i]) &&
           repositionEdge(edges[i])){
         nr++;
-        crv::clearTag(adapter,simplex);
+        crv::clearTagsAdjacent(adapter,edges[i]);
         ma::clearFlag(adapter,edges[i],ma::COLLAPSE | ma::BAD_QUALITY);
         break;
       }
@@ -600,22 +600,16 @@ int fixInvalidEdges(Adapt* a)
 }
 
 
+/* the qualities are kept in the ma quality cache, so elements
+   that no pass has changed are not measured again */
 struct IsBadCrvQuality : public ma::Predicate
 {
-  IsBadCrvQuality(Adapt* a_):a(a_)
-  {
-    sh = crv::getShapeHandler(a);
-  }
-  ~IsBadCrvQuality()
-  {
-    delete sh;
-  }
+  IsBadCrvQuality(Adapt* a_):a(a_) {}
   bool operator()(apf::MeshEntity* e)
   {
-    return sh->getQuality(e) < a->input->goodQuality;
+    return ma::getWorstQuality(a,&e,1) < a->input->goodQuality;
   }
   Adapt* a;
-  ma::ShapeHandler* sh;
 };
 
 int markCrvBadQuality(Adapt* a)
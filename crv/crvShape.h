@@ -37,6 +37,9 @@ int getTag(Adapt* a, ma::Entity* e);
 void setTag(Adapt* a, ma::Entity* e, int tag);
 /** \brief reset validityTag */
 void clearTag(Adapt* a, ma::Entity* e);
+/** \brief reset the validityTag and the cached quality of the elements
+    adjacent to (e), after its control points move */
+void clearTagsAdjacent(Adapt* a, ma::Entity* e);
 /** \brief get validityTag
     \details Use an integer to determine the validity tag
     0 -> Not checked
@@ -61,17 +61,53 @@ static void interpolateParametricCoordinates(
   ma::interpolateParametricCoordinates(m, g, t, a, b, p);
 }
 
-static void transferParametricBetween(
+void getSplitVertexParams(
     apf::Mesh* m,
-    apf::ModelEntity* g,
-    apf::MeshEntity* v[2],
-    double t,
+    apf::MeshEntity* e,
+    SplitVertexParams& s)
+{
+  s.g = m->toModel(e);
+  s.type = m->getType(e);
+  apf::MeshEntity* ev[3];
+  int nv = m->getDownward(e,0,ev);
+  for (int i = 0; i < nv; ++i)
+    m->getParamOn(s.g,ev[i],s.p[i]);
+  s.rotation = 0;
+  if (s.type != apf::Mesh::TRIANGLE)
+    return;
+  // adjust so the degenerate point is in p[2]
+  if(checkIsDegenerate(m,s.g,s.p[0],0) || checkIsDegenerate(m,s.g,s.p[0],1))
+    s.rotation = 1;
+  else if(checkIsDegenerate(m,s.g,s.p[1],0) ||
+          checkIsDegenerate(m,s.g,s.p[1],1))
+    s.rotation = 2;
+  apf::Vector3 p[3] = {s.p[0],s.p[1],s.p[2]};
+  for (int i = 0; i < 3; ++i)
+    s.p[i] = p[(i+s.rotation) % 3];
+}
+
+void transferParametricOnSplit(
+    apf::Mesh* m,
+    SplitVertexParams const& s,
+    apf::Vector3 const& t,
     apf::Vector3& p)
 {
-  apf::Vector3 ep[2];
-  for (int i=0; i < 2; ++i)
-    m->getParamOn(g,v[i],ep[i]);
-  crv::interpolateParametricCoordinates(m,g,t,ep[0],ep[1],p);
+  if (s.type != apf::Mesh::TRIANGLE) {
+    crv::interpolateParametricCoordinates(m,s.g,t[0],s.p[0],s.p[1],p);
+    return;
+  }
+  double t0 = t[0], t1 = t[1];
+  if (s.rotation == 1) {
+    t0 = t[1];
+    t1 = 1-t[0]-t[1];
+  } else if (s.rotation == 2) {
+    t0 = 1-t[0]-t[1];
+    t1 = t[0];
+  }
+  // two linear splits
+  apf::Vector3 p1;
+  crv::interpolateParametricCoordinates(m,s.g,t0/(1.-t1),s.p[0],s.p[1],p1);
+  crv::interpolateParametricCoordinates(m,s.g,t1,p1,s.p[2],p);
 }
 
 void transferParametricOnEdgeSplit(
@@ -80,10 +116,9 @@ void transferParametricOnEdgeSplit(
     double t,
     apf::Vector3& p)
 {
-  apf::ModelEntity* g = m->toModel(e);
-  apf::MeshEntity* ev[2];
-  m->getDownward(e,0,ev);
-  crv::transferParametricBetween(m, g, ev, t, p);
+  SplitVertexParams s;
+  getSplitVertexParams(m,e,s);
+  transferParametricOnSplit(m,s,apf::Vector3(t,0,0),p);
 }
 
 /* see bezier.tex in SCOREC/docs repo for more info on this,
@@ -94,28 +129,9 @@ void transferParametricOnTriSplit(
     apf::Vector3& t,
     apf::Vector3& p)
 {
-  apf::ModelEntity* g = m->toModel(e);
-  apf::MeshEntity* ev[3];
-  m->getDownward(e,0,ev); // pick two points, split on edge
-  // adjust so the degenerate point is in ev[2]
-  m->getParamOn(g,ev[0],p);
-  if(checkIsDegenerate(m,g,p,0) || checkIsDegenerate(m,g,p,1)){
-    apf::MeshEntity* v = ev[0];
-    ev[0] = ev[1]; ev[1] = ev[2];ev[2] = v;
-    t[2] = 1-t[0]-t[1]; t[0] = t[1]; t[1] = t[2];
-  } else {
-    m->getParamOn(g,ev[1],p);
-    if(checkIsDegenerate(m,g,p,0) || checkIsDegenerate(m,g,p,1)){
-      apf::MeshEntity* v = ev[1];
-      ev[1] = ev[0]; ev[0] = ev[2]; ev[2] = v;
-      t[2] = 1-t[0]-t[1]; t[1] = t[0];t[0] = t[2];
-    }
-  }
-  apf::Vector3 p1,p2;
-  m->getParamOn(g,ev[2],p2);
-  // two linear splits
-  crv::transferParametricBetween(m, g, ev, t[0]/(1.-t[1]), p1);
-  crv::interpolateParametricCoordinates(m,g,t[1],p1,p2,p);
+  SplitVertexParams s;
+  getSplitVertexParams(m,e,s);
+  transferParametricOnSplit(m,s,t,p);
 }
 
 void transferParametricOnGeometricEdgeSplit(
@@ -17,6 +17,31 @@
 
 namespace crv {
 
+/** \brief the parametric coordinates of the vertices of a boundary
+    edge or triangle on its model entity, in the order the splits use them
+    \details finding them takes model evaluations that are the same for
+    every node of the entity, so they are found once per entity */
+struct SplitVertexParams
+{
+  apf::ModelEntity* g;
+  int type;
+  /* the triangle vertices are rotated so a degenerate one is last */
+  int rotation;
+  apf::Vector3 p[3];
+};
+void getSplitVertexParams(
+    apf::Mesh* m,
+    apf::MeshEntity* e,
+    SplitVertexParams& s);
+/** \brief transferParametricOnEdgeSplit or transferParametricOnTriSplit
+    from the vertex parameters, t[0] in [0,1] on an edge or the
+    barycentric coordinate on a triangle */
+void transferParametricOnSplit(
+    apf::Mesh* m,
+    SplitVertexParams const& s,
+    apf::Vector3 const& t,
+    apf::Vector3& p);
+
 /** \brief gets parametric location on geometry given t in [0,1] on edge */
 void transferParametricOnEdgeSplit(
     apf::Mesh* m,
@@ -215,7 +215,7 @@ void subdivideBezierTet(int P, apf::Vector3& p,
 }
 
 void subdivideBezierEntityJacobianDet(int P, int type,
-    apf::NewArray<double>& c, apf::NewArray<double>& nodes,
+    double const* c, apf::NewArray<double>& nodes,
     apf::NewArray<double> *subNodes){
   int typeDim = apf::Mesh::typeDimension[type];
   int n = getNumControlPoints(type,P);
@@ -6,6 +6,7 @@
  */
 
 #include "crv.h"
+#include "crvVtk.h"
 #include "PCU.h"
 #include "apfDynamicVector.h"
 #include "apfFieldData.h"
@@ -49,7 +50,7 @@ class HasAll : public apf::FieldOp
     apf::FieldBase* f;
 };
 
-static bool isPrintable(apf::FieldBase* f)
+bool isPrintable(apf::FieldBase* f)
 {
   HasAll op;
   return op.run(f);
@@ -69,7 +70,7 @@ static void describeArray(
   file << "\" format=\"ascii\"";
 }
 
-static void writeDataHeader(std::ostream& file, const char* name,
+void writeDataHeader(std::ostream& file, const char* name,
     int type, int size)
 {
   file << "<DataArray ";
@@ -89,7 +90,7 @@ static int countOwnedEntitiesOfType(apf::Mesh* m, int type)
   return count;
 }
 
-static const char* getSuffix(int type)
+const char* getSuffix(int type)
 {
   std::stringstream ss;
   switch (type) {
@@ -270,14 +271,14 @@ static void writeTypes(std::ostream& file, int type, int nCells)
   file << "</DataArray>\n";
 }
 
-static void writePoint(std::ostream& file, apf::Vector3 & pt)
+void writePoint(std::ostream& file, apf::Vector3 & pt)
 {
   for (int j=0; j < 3; ++j)
     file << pt[j] << ' ';
   file << '\n';
 }
 
-static void writeStart(std::ostream& file, int nPoints, int nCells)
+void writeStart(std::ostream& file, int nPoints, int nCells)
 {
   file << "<VTKFile type=\"UnstructuredGrid\">\n";
   file << "<UnstructuredGrid>\n";
@@ -296,7 +297,7 @@ static void writeCells(std::ostream& file,
   file << "</Cells>\n";
 }
 
-static void writeEnd(std::ostream& file)
+void writeEnd(std::ostream& file)
 {
   file << "</Piece>\n";
   file << "</UnstructuredGrid>\n";
@@ -733,8 +734,8 @@ static void writePPointData(std::ostream& file, apf::Mesh* m)
   }
 }
 
-static void writePvtuFile(const char* prefix, const char* suffix,
-    apf::Mesh* m, int type)
+void writePvtuFile(const char* prefix, const char* suffix,
+    apf::Mesh* m, int type, bool jacobians)
 {
   std::stringstream ss;
   ss << prefix << "/order_"
@@ -752,7 +753,7 @@ static void writePvtuFile(const char* prefix, const char* suffix,
   if(type == apf::Mesh::VERTEX){
     file << "<PDataArray type=\"UInt8\" Name=\"entityType\" "
          << "NumberOfComponents=\"1\" format=\"ascii\"/>\n";
-  } else {
+  } else if (jacobians) {
     file << "<PDataArray type=\"Float64\" Name=\"detJacobian\" "
          << "NumberOfComponents=\"1\" format=\"ascii\"/>\n";
     if(m->getDimension() == 3)
@@ -930,7 +931,7 @@ void writeControlPointVtuFiles(apf::Mesh* m, const char* prefix)
   PCU_Barrier();
 }
 
-static void safe_mkdir(const char* path)
+void safe_mkdir(const char* path)
 {
   mode_t const mode = S_IRWXU|S_IRGRP|S_IXGRP|S_IROTH|S_IXOTH;
   int err;
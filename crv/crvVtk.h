@@ -0,0 +1,40 @@
+/*
+ * Copyright 2025 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef CRVVTK_H
+#define CRVVTK_H
+
+#include "apfMesh.h"
+#include "apfField.h"
+#include <ostream>
+
+/** \file crvVtk.h
+  * \brief the pieces of the curved VTK writers shared by
+  * crvVtk.cc and crvLagrangeVtk.cc */
+
+namespace crv {
+
+/** \brief true if the field has values on all of its nodes */
+bool isPrintable(apf::FieldBase* f);
+/** \brief open an ascii DataArray of a field or tag type */
+void writeDataHeader(std::ostream& file, const char* name,
+    int type, int size);
+/** \brief the file suffix of an entity type */
+const char* getSuffix(int type);
+void writePoint(std::ostream& file, apf::Vector3 & pt);
+void writeStart(std::ostream& file, int nPoints, int nCells);
+void writeEnd(std::ostream& file);
+/** \brief write the .pvtu of a set of files,
+  * with or without the Jacobian determinant cell data */
+void writePvtuFile(const char* prefix, const char* suffix,
+    apf::Mesh* m, int type, bool jacobians = true);
+/** \brief create a directory, failing on any error but EEXIST */
+void safe_mkdir(const char* path);
+
+}
+
+#endif
@@ -1,6 +1,9 @@
 #include "dsp.h"
 #include <apf.h>
+#include <apfShape.h>
 #include <gmi.h>
+#include <PCU.h>
+#include <algorithm>
 
 namespace dsp {
 
@@ -25,20 +28,165 @@ void closeBoundary(apf::Mesh* m, Boundary& b)
   b = nb;
 }
 
-bool tryToDisplace(apf::Mesh2* m, apf::Field* df)
+/* the elements with a vertex that moves more than threshold times
+   its shortest edge. elements whose vertices all stay (nearly) put
+   keep the volume they had, which was valid */
+static void getMovingElements(apf::Mesh* m, apf::Field* df,
+    double threshold, std::vector<apf::MeshEntity*>& elements)
+{
+  int dim = m->getDimension();
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 u;
+    apf::getVector(df, v, 0, u);
+    double d = u.getLength();
+    if (d == 0)
+      continue;
+    if (threshold > 0) {
+      double h = -1;
+      apf::Adjacent edges;
+      m->getAdjacent(v, 1, edges);
+      for (size_t i = 0; i < edges.getSize(); ++i) {
+        double l = apf::measure(m, edges[i]);
+        if (h < 0 || l < h)
+          h = l;
+      }
+      if (d <= threshold * h)
+        continue;
+    }
+    apf::Adjacent adjacent;
+    m->getAdjacent(v, dim, adjacent);
+    for (size_t i = 0; i < adjacent.getSize(); ++i)
+      if (apf::isSimplex(m->getType(adjacent[i])))
+        elements.push_back(adjacent[i]);
+  }
+  m->end(it);
+  std::sort(elements.begin(), elements.end());
+  elements.erase(std::unique(elements.begin(), elements.end()),
+      elements.end());
+}
+
+/* straight sided tets packed as vertex coordinates and
+   displacements, so that trying a fraction of the displacement
+   is a flat loop over arrays instead of a pass over the mesh */
+struct Tets {
+  std::vector<apf::MeshEntity*> elements;
+  std::vector<double> x;
+  std::vector<double> d;
+  bool pack(apf::Mesh* m, apf::Field* df,
+      std::vector<apf::MeshEntity*> const& from)
+  {
+    if (m->getDimension() != 3 || m->getShape()->getOrder() != 1)
+      return false;
+    for (size_t i = 0; i < from.size(); ++i) {
+      if (m->getType(from[i]) != apf::Mesh::TET)
+        return false;
+      apf::Downward verts;
+      m->getDownward(from[i], 0, verts);
+      for (int j = 0; j < 4; ++j) {
+        apf::Vector3 p;
+        m->getPoint(verts[j], 0, p);
+        apf::Vector3 u;
+        apf::getVector(df, verts[j], 0, u);
+        for (int k = 0; k < 3; ++k) {
+          x.push_back(p[k]);
+          d.push_back(u[k]);
+        }
+      }
+    }
+    elements = from;
+    return true;
+  }
+  /* counts the tets inverted by the fraction f of the displacement,
+     adding them to inverted if it is given */
+  long countInverted(double f, std::vector<apf::MeshEntity*>* inverted)
+  {
+    long n = 0;
+    size_t nt = elements.size();
+    double const* px = x.empty() ? 0 : &x[0];
+    double const* pd = d.empty() ? 0 : &d[0];
+    for (size_t i = 0; i < nt; ++i) {
+      double const* a = px + 12 * i;
+      double const* b = pd + 12 * i;
+      double e[3][3];
+      for (int j = 0; j < 3; ++j)
+        for (int k = 0; k < 3; ++k)
+          e[j][k] = (a[3 * (j + 1) + k] - a[k]) +
+            f * (b[3 * (j + 1) + k] - b[k]);
+      double v = e[0][0] * (e[1][1] * e[2][2] - e[1][2] * e[2][1])
+               - e[0][1] * (e[1][0] * e[2][2] - e[1][2] * e[2][0])
+               + e[0][2] * (e[1][0] * e[2][1] - e[1][1] * e[2][0]);
+      if (v < 0) {
+        ++n;
+        if (inverted)
+          inverted->push_back(elements[i]);
+      }
+    }
+    return PCU_Add_Long(n);
+  }
+};
+
+static long countInverted(apf::Mesh* m,
+    std::vector<apf::MeshEntity*> const& elements,
+    std::vector<apf::MeshEntity*>* inverted)
+{
+  long n = 0;
+  for (size_t i = 0; i < elements.size(); ++i)
+    if (apf::measure(m, elements[i]) < 0) {
+      ++n;
+      if (inverted)
+        inverted->push_back(elements[i]);
+    }
+  return PCU_Add_Long(n);
+}
+
+/* curved or mixed meshes move the coordinates and measure
+   the moving elements, halving back as before */
+static bool displaceByMeasure(apf::Mesh2* m, apf::Field* df,
+    std::vector<apf::MeshEntity*> const& elements,
+    std::vector<apf::MeshEntity*>& inverted)
 {
   double f = 1;
   apf::axpy(f, df, m->getCoordinateField());
-  if (0 == verifyVolumes(m, false))
+  if (0 == countInverted(m, elements, &inverted))
     return true;
   do {
     f /= 2;
     apf::axpy(-f, df, m->getCoordinateField());
-  } while (0 != verifyVolumes(m, false));
+  } while (0 != countInverted(m, elements, 0));
   apf::axpy(-f, df, df);
   return false;
 }
 
+bool tryToDisplace(apf::Mesh2* m, apf::Field* df,
+    std::vector<apf::MeshEntity*>& inverted, double threshold)
+{
+  std::vector<apf::MeshEntity*> elements;
+  getMovingElements(m, df, threshold, elements);
+  Tets tets;
+  bool packed = tets.pack(m, df, elements);
+  if (!PCU_And(packed))
+    return displaceByMeasure(m, df, elements, inverted);
+  double f = 1;
+  if (0 == tets.countInverted(f, &inverted)) {
+    apf::axpy(f, df, m->getCoordinateField());
+    return true;
+  }
+  do
+    f /= 2;
+  while (f > 0 && 0 != tets.countInverted(f, 0));
+  apf::axpy(f, df, m->getCoordinateField());
+  apf::axpy(-f, df, df);
+  return false;
+}
+
+bool tryToDisplace(apf::Mesh2* m, apf::Field* df)
+{
+  std::vector<apf::MeshEntity*> inverted;
+  return tryToDisplace(m, df, inverted);
+}
+
 void displace(apf::Mesh2* m, apf::Field* df,
     Smoother* smoother, Adapter* adapter,
     Boundary& fixed, Boundary& moving)
@@ -3,6 +3,7 @@
 
 #include <apfMesh2.h>
 #include <apfMatrix.h>
+#include <vector>
 #include "dspSmoothers.h"
 #include "dspAdapters.h"
 
@@ -12,6 +13,14 @@ void closeBoundary(apf::Mesh* m, Boundary& b);
 
 bool tryToDisplace(apf::Mesh2* m, apf::Field* df);
 
+/* displaces by as much of df as keeps the mesh valid and leaves
+   the rest in df. only elements with a vertex moving more than
+   threshold times its shortest edge are checked; zero checks every
+   element that moves at all. the local elements that the full
+   displacement inverts are added to inverted for local repair */
+bool tryToDisplace(apf::Mesh2* m, apf::Field* df,
+    std::vector<apf::MeshEntity*>& inverted, double threshold = 0);
+
 void displace(apf::Mesh2* m, apf::Field* df,
     Smoother* smoother, Adapter* adapter,
     Boundary& fixed, Boundary& moving);
@@ -1,11 +1,7 @@
 #include "dspSmoothers.h"
-#include <math.h>
 #include <apf.h>
-#include <apfMesh2.h>
-#include <apfNumbering.h>
-#include <cmath>
+#include <PCU.h>
 #include <vector>
-#include <queue>
 
 using namespace std;
 
@@ -26,157 +22,220 @@ void Smoother::cleanup()
 {
 }
 
+/* the graph Laplacian of the mesh edges with the displacements
+   of the fixed and moving vertices as Dirichlet conditions,
+   solved for all three components at once by conjugate gradients.
+   the vertex and edge lists are kept until the topology or the
+   boundaries change, so repeated time steps only pay for the
+   iterations and one communication plan */
 class LaplacianSmoother : public Smoother {
 public:
+  LaplacianSmoother():
+    mesh(0),
+    changes(0),
+    freeCount(0),
+    sums(0),
+    plan(0)
+  {
+  }
+  ~LaplacianSmoother()
+  {
+    clear();
+  }
+  void preprocess(apf::Mesh* m, Boundary& fixed, Boundary& moving)
+  {
+    if (!isCurrent(m, fixed, moving))
+      build(m, fixed, moving);
+  }
   void smooth(apf::Field* df, Boundary& fixed, Boundary& moving)
   {
-    apf::Mesh* m = apf::getMesh(df);
-    /* start Fan's code */
-    apf::MeshIterator* it;
-    apf::MeshEntity* v;
-    apf::ModelEntity* me;
-    apf::Vector3 p;
-    
-    //---------------------------------------------------------
-    int n_mb = 0; int n_in = 0; int n_fb = 0;
-    
-    //iterate vertex to count the number of each type of vertex
-    it = m->begin(0);
-    while ((v = m->iterate(it))) {
-      me = m->toModel(v);
-      if (moving.count(me)) n_mb++;
-      else if (fixed.count(me)) n_fb++;
-      else n_in++;
+    preprocess(apf::getMesh(df), fixed, moving);
+    createSums();
+    size_t n = verts.size();
+    vector<apf::Vector3> x(n);
+    vector<apf::Vector3> d(n);
+    for (size_t i = 0; i < n; ++i) {
+      apf::getVector(df, verts[i], 0, x[i]);
+      d[i] = isFree[i] ? apf::Vector3(0,0,0) : x[i];
+      if (!isFree[i])
+        x[i] = apf::Vector3(0,0,0);
     }
-    m->end(it);
-    
-    //----------------------------------------------------------
-    int MB_begin = 0;            int MB_end = n_mb - 1;
-    int IN_begin = n_mb;         int IN_end = n_mb + n_in - 1;
-    int FB_begin = n_mb + n_in;  //int FB_end = n_mb + n_in + n_fb - 1;
-    int ithMB = 0; int ithIN =0; int ithFB = 0;
-    
-    vector < apf::MeshEntity* > V_total(n_mb + n_in + n_fb);
-    vector < apf::Vector3 > P_total(n_mb + n_in + n_fb);
-    apf::Numbering* numbers = numberOwnedDimension(m, "my_numbering", 0);
-    
-    //iterate to store vertices and points
-    it = m->begin(0);
-    while ((v = m->iterate(it))) {
-      apf::getVector(df, v, 0, p);
-      me = m->toModel(v);
-      if (moving.count(me)) {
-        V_total[MB_begin + ithMB] = v;
-        P_total[MB_begin + ithMB] = p;
-        apf::number(numbers, v, 0, 0, MB_begin + ithMB);
-        ithMB++;
-      }
-      else if (fixed.count(me)) {
-        V_total[FB_begin + ithFB] = v;
-        P_total[FB_begin + ithFB] = p;
-        apf::number(numbers, v, 0, 0, FB_begin + ithFB);
-        ithFB++;
+    vector<apf::Vector3> b;
+    sumNeighbors(d, b);
+    vector<apf::Vector3> r;
+    multiply(x, r);
+    for (size_t i = 0; i < n; ++i)
+      r[i] = isFree[i] ? b[i] - r[i] : apf::Vector3(0,0,0);
+    apf::Vector3 bb = dot(b, b);
+    apf::Vector3 rr = dot(r, r);
+    vector<apf::Vector3> p = r;
+    vector<apf::Vector3> q;
+    for (long k = 0; k < freeCount; ++k) {
+      if (isConverged(rr, bb))
+        break;
+      multiply(p, q);
+      apf::Vector3 pq = dot(p, q);
+      apf::Vector3 alpha;
+      for (int c = 0; c < 3; ++c)
+        alpha[c] = pq[c] > 0 ? rr[c] / pq[c] : 0;
+      for (size_t i = 0; i < n; ++i)
+      for (int c = 0; c < 3; ++c) {
+        x[i][c] += alpha[c] * p[i][c];
+        r[i][c] -= alpha[c] * q[i][c];
       }
-      else {
-        V_total[IN_begin + ithIN] = v;
-        P_total[IN_begin + ithIN] = p;
-        // apf::number(numbers, v, 0, 0, IN_begin + ithIN);
-        ithIN++;
-      }
-    }
-    m->end(it);
-    
-    //----------------------------------------------------------
-    ithIN = 0; int zero = 0; int one = 1;
-    apf::Adjacent adj;
-    
-    //make a queue and put all MB vertex in it
-    queue < apf::MeshEntity* > q;
-    for (int i = MB_begin ; i < MB_end + 1 ; i++) {
-      q.push(V_total[i]);
+      apf::Vector3 rr2 = dot(r, r);
+      for (size_t i = 0; i < n; ++i)
+      for (int c = 0; c < 3; ++c)
+        p[i][c] = r[i][c] + (rr[c] > 0 ? rr2[c] / rr[c] : 0) * p[i][c];
+      rr = rr2;
     }
-    
-    //tag = 1, indicates this is in queue before AND this is a interior vertex
-    apf::MeshTag* in_queue_tag = m->createIntTag("In_Queue_Tag", 1);
-    it = m->begin(0);
+    destroySums();
+    for (size_t i = 0; i < n; ++i)
+      if (isFree[i])
+        apf::setVector(df, verts[i], 0, x[i]);
+  }
+private:
+  bool isCurrent(apf::Mesh* m, Boundary& fixed, Boundary& moving)
+  {
+    return m == mesh && m->countChanges() == changes &&
+      fixed == fixedCopy && moving == movingCopy;
+  }
+  /* the field that carries the neighbor sums between parts only
+     exists during build and smooth, so the mesh is left without it */
+  void createSums()
+  {
+    sums = apf::createFieldOn(mesh, "dsp_neighbor_sums", apf::VECTOR);
+    /* the plan covers the vertices that have values when it is made */
+    apf::zeroField(sums);
+    plan = apf::makeSyncPlan(sums);
+  }
+  void destroySums()
+  {
+    apf::destroySyncPlan(plan);
+    apf::destroyField(sums);
+    plan = 0;
+    sums = 0;
+  }
+  void clear()
+  {
+    mesh = 0;
+    verts.clear();
+    isFree.clear();
+    isOwned.clear();
+    edges.clear();
+    degree.clear();
+  }
+  void build(apf::Mesh* m, Boundary& fixed, Boundary& moving)
+  {
+    clear();
+    mesh = m;
+    changes = m->countChanges();
+    fixedCopy = fixed;
+    movingCopy = moving;
+    apf::MeshTag* ids = m->createIntTag("dsp_index", 1);
+    apf::MeshIterator* it = m->begin(0);
+    apf::MeshEntity* v;
+    long localFree = 0;
     while ((v = m->iterate(it))) {
-      m->setIntTag(v, in_queue_tag, &zero);
+      int id = verts.size();
+      m->setIntTag(v, ids, &id);
+      apf::ModelEntity* me = m->toModel(v);
+      bool f = !moving.count(me) && !fixed.count(me);
+      verts.push_back(v);
+      isFree.push_back(f);
+      isOwned.push_back(m->isOwned(v));
+      if (f && m->isOwned(v))
+        ++localFree;
     }
     m->end(it);
-    
-    //find its adj, if it is never in queue, put it in queue
-    while (!q.empty()) {
-      v = q.front();
-      me = m->toModel(v);
-      apf::getVector(df, v, 0, p);
-      m->getAdjacent(v, 1, adj);
-      int num_adj = adj.getSize();
-      for (int i = 0 ; i < num_adj ; i++) {
-        apf::MeshEntity* adj_v = apf::getEdgeVertOppositeVert(m, adj[i], v);
-        apf::ModelEntity* adj_v_me = m->toModel(adj_v);
-        if ((!moving.count(adj_v_me)) & (!fixed.count(adj_v_me))) {
-          int tag;
-          m->getIntTag(adj_v, in_queue_tag, &tag);
-          if (tag == 0) {
-            q.push(adj_v);
-            m->setIntTag(adj_v, in_queue_tag, &one);
-          }
-        }
-      }
-      if ((!moving.count(me)) & (!fixed.count(me))) {
-        V_total[IN_begin + ithIN] = v;
-        P_total[IN_begin + ithIN] = p;
-        apf::number(numbers, v, 0, 0, IN_begin + ithIN);
-        ithIN++;
-      }
-      q.pop();
+    freeCount = PCU_Add_Long(localFree);
+    /* each edge is counted by its owner, so that summing
+       over the copies of a vertex visits every edge once */
+    it = m->begin(1);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      if (!m->isOwned(e))
+        continue;
+      apf::MeshEntity* ev[2];
+      m->getDownward(e, 0, ev);
+      int a, b;
+      m->getIntTag(ev[0], ids, &a);
+      m->getIntTag(ev[1], ids, &b);
+      edges.push_back(a);
+      edges.push_back(b);
     }
-    
-    //----------------------------------------------------------
-    double tol = 1.0E-5; //tolerance
-    vector < apf::Vector3 > delta_P(n_mb + n_in + n_fb);
-    apf::Vector3 P_temp = apf::Vector3(0, 0, 0);
-    
-    for (int i = 0 ; i < n_mb + n_in + n_fb ; i++) {
-      delta_P[i] = apf::Vector3(0, 0, 0);
-    }
-    
-    // average nodal position = sum(all adj_V's position)/num of adj_V
-    // check max, stop until it is less the tolerance
-    double max = 1.0;
-    while (max > tol) {
-      max = 0.0;
-      for (int i = IN_begin ; i < IN_end + 1 ; i++) {
-        m->getAdjacent(V_total[i], 1, adj);
-        int num_adj = adj.getSize();
-        for (int j = 0 ; j < num_adj ; j++) {
-          apf::MeshEntity* adj_v = apf::getEdgeVertOppositeVert(m, adj[j], V_total[i]);
-          int adj_v_id = apf::getNumber(numbers, adj_v, 0, 0);
-          P_temp = P_temp + P_total[adj_v_id];
-        }
-        P_temp[0] = P_temp[0]/num_adj;
-        P_temp[1] = P_temp[1]/num_adj;
-        P_temp[2] = P_temp[2]/num_adj;
-        delta_P[i] = P_temp - P_total[i];
-        
-        double temp_max = sqrt(pow(delta_P[i][0], 2) + pow(delta_P[i][1], 2) + pow(delta_P[i][2], 2));
-        if (max < temp_max) {
-          max = temp_max;
-        }
-        //update IN
-        P_total[i] = P_temp;
-        apf::setVector(df, V_total[i], 0, P_total[i]);
-      }
+    m->end(it);
+    apf::removeTagFromDimension(m, ids, 0);
+    m->destroyTag(ids);
+    createSums();
+    vector<apf::Vector3> ones(verts.size(), apf::Vector3(1,1,1));
+    vector<apf::Vector3> counts;
+    sumNeighbors(ones, counts);
+    destroySums();
+    degree.resize(verts.size());
+    for (size_t i = 0; i < verts.size(); ++i)
+      degree[i] = counts[i][0];
+  }
+  /* the sum over all the mesh neighbors of each vertex,
+     the same on every copy of a shared vertex */
+  void sumNeighbors(vector<apf::Vector3> const& in,
+      vector<apf::Vector3>& out)
+  {
+    out.assign(verts.size(), apf::Vector3(0,0,0));
+    for (size_t i = 0; i < edges.size(); i += 2) {
+      out[edges[i]] += in[edges[i + 1]];
+      out[edges[i + 1]] += in[edges[i]];
     }
-    
-    /* end Fan's code */
-    (void)m;
-    (void)df;
-    (void)fixed;
-    (void)moving;
+    for (size_t i = 0; i < verts.size(); ++i)
+      apf::setVector(sums, verts[i], 0, out[i]);
+    apf::accumulate(plan);
+    for (size_t i = 0; i < verts.size(); ++i)
+      apf::getVector(sums, verts[i], 0, out[i]);
+  }
+  /* the Laplacian restricted to the free vertices,
+     x is zero on the others */
+  void multiply(vector<apf::Vector3> const& x, vector<apf::Vector3>& y)
+  {
+    sumNeighbors(x, y);
+    for (size_t i = 0; i < verts.size(); ++i)
+      y[i] = isFree[i] ? x[i] * degree[i] - y[i] : apf::Vector3(0,0,0);
   }
+  apf::Vector3 dot(vector<apf::Vector3> const& a,
+      vector<apf::Vector3> const& b)
+  {
+    double d[3] = {0,0,0};
+    for (size_t i = 0; i < verts.size(); ++i)
+      if (isFree[i] && isOwned[i])
+        for (int c = 0; c < 3; ++c)
+          d[c] += a[i][c] * b[i][c];
+    PCU_Add_Doubles(d, 3);
+    return apf::Vector3(d);
+  }
+  bool isConverged(apf::Vector3 const& rr, apf::Vector3 const& bb)
+  {
+    for (int c = 0; c < 3; ++c)
+      if (rr[c] > tolerance * tolerance * bb[c] && rr[c] > 0)
+        return false;
+    return true;
+  }
+  static double const tolerance;
+  apf::Mesh* mesh;
+  unsigned long changes;
+  Boundary fixedCopy;
+  Boundary movingCopy;
+  vector<apf::MeshEntity*> verts;
+  vector<bool> isFree;
+  vector<bool> isOwned;
+  vector<int> edges;
+  vector<double> degree;
+  long freeCount;
+  apf::Field* sums;
+  apf::SyncPlan* plan;
 };
 
+/* relative to the norm of the boundary terms */
+double const LaplacianSmoother::tolerance = 1e-10;
+
 class EmptySmoother : public Smoother {
 public:
   void smooth(apf::Field* df, Boundary& fixed, Boundary& moving)
@@ -11,6 +11,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pcu_util.h>
+#include <pcu_io.h>
 
 struct creator {
   gmi_creator f;
@@ -101,12 +102,42 @@ void gmi_eval(struct gmi_model* m, struct gmi_ent* e,
   m->ops->eval(m, e, p, x);
 }
 
+void gmi_eval_batch(struct gmi_model* m, int n, struct gmi_ent* const* e,
+    double const* p, double* x)
+{
+  int i;
+  if (m->ops->eval_batch) {
+    m->ops->eval_batch(m, n, e, p, x);
+    return;
+  }
+  for (i = 0; i < n; ++i)
+    m->ops->eval(m, e[i], p + 2 * i, x + 3 * i);
+}
+
+int gmi_is_thread_safe(struct gmi_model* m)
+{
+  return m->ops->thread_safe;
+}
+
 void gmi_reparam(struct gmi_model* m, struct gmi_ent* from,
     double const from_p[2], struct gmi_ent* to, double to_p[2])
 {
   m->ops->reparam(m, from, from_p, to, to_p);
 }
 
+void gmi_reparam_batch(struct gmi_model* m, int n,
+    struct gmi_ent* const* from, double const* from_p,
+    struct gmi_ent* const* to, double* to_p)
+{
+  int i;
+  if (m->ops->reparam_batch) {
+    m->ops->reparam_batch(m, n, from, from_p, to, to_p);
+    return;
+  }
+  for (i = 0; i < n; ++i)
+    m->ops->reparam(m, from[i], from_p + 2 * i, to[i], to_p + 2 * i);
+}
+
 int gmi_periodic(struct gmi_model* m, struct gmi_ent* e, int dim)
 {
   return m->ops->periodic(m, e, dim);
@@ -124,12 +155,46 @@ void gmi_closest_point(struct gmi_model* m, struct gmi_ent* e,
   m->ops->closest_point(m, e, from, to, to_p);
 }
 
+void gmi_closest_point_seeded(struct gmi_model* m, struct gmi_ent* e,
+    double const from[3], double const seed_p[2], double to[3],
+    double to_p[2])
+{
+  if (m->ops->closest_point_seeded)
+    m->ops->closest_point_seeded(m, e, from, seed_p, to, to_p);
+  else
+    m->ops->closest_point(m, e, from, to, to_p);
+}
+
+void gmi_closest_point_batch(struct gmi_model* m, int n,
+    struct gmi_ent* const* e, double const* from, double* to, double* to_p)
+{
+  int i;
+  if (m->ops->closest_point_batch) {
+    m->ops->closest_point_batch(m, n, e, from, to, to_p);
+    return;
+  }
+  for (i = 0; i < n; ++i)
+    m->ops->closest_point(m, e[i], from + 3 * i, to + 3 * i, to_p + 2 * i);
+}
+
 void gmi_normal(struct gmi_model* m, struct gmi_ent* e,
     double const p[2], double n[3])
 {
   m->ops->normal(m, e, p, n);
 }
 
+void gmi_normal_batch(struct gmi_model* m, int n, struct gmi_ent* const* e,
+    double const* p, double* normals)
+{
+  int i;
+  if (m->ops->normal_batch) {
+    m->ops->normal_batch(m, n, e, p, normals);
+    return;
+  }
+  for (i = 0; i < n; ++i)
+    m->ops->normal(m, e[i], p + 2 * i, normals + 3 * i);
+}
+
 void gmi_first_derivative(struct gmi_model* m, struct gmi_ent* e,
     double const p[2], double t0[3], double t1[3])
 {
@@ -225,8 +290,11 @@ void gmi_write_dmg(struct gmi_model* m, const char* filename)
   struct gmi_iter* it;
   struct gmi_ent* e;
   struct gmi_set* s;
+  double start = pcu_io_time();
   FILE* f = fopen(filename, "w");
   int i;
+  pcu_io_opened(PCU_IO_MODEL, start);
+  start = pcu_io_time();
   /* entity counts */
   fprintf(f, "%d %d %d %d\n", m->n[3], m->n[2], m->n[1], m->n[0]);
   /* bounding box */
@@ -278,5 +346,8 @@ void gmi_write_dmg(struct gmi_model* m, const char* filename)
     gmi_free_set(s);
   }
   gmi_end(m, it);
+  pcu_io_wrote(PCU_IO_MODEL, ftell(f), start);
+  start = pcu_io_time();
   fclose(f);
+  pcu_io_closed(PCU_IO_MODEL, start);
 }
@@ -19,6 +19,7 @@
   - The built-in meshmodel system is in gmi_mesh.h
   - The built-in analytic model is in gmi_analytic.h
   - The don't-use null model is in gmi_null.h
+  - The closest point cache over any model is in gmi_cache.h
   */
 
 /** \file gmi.h
@@ -103,6 +104,32 @@ struct gmi_model_ops {
   int (*is_discrete_ent)(struct gmi_model* m, struct gmi_ent* e);
   /** \brief implement gmi_destroy */
   void (*destroy)(struct gmi_model* m);
+  /** \brief implement gmi_eval_batch
+   \details if omitted then gmi_eval_batch calls eval on each point */
+  void (*eval_batch)(struct gmi_model* m, int n, struct gmi_ent* const* e,
+      double const* p, double* x);
+  /** \brief implement gmi_reparam_batch
+   \details if omitted then gmi_reparam_batch calls reparam on each point */
+  void (*reparam_batch)(struct gmi_model* m, int n,
+      struct gmi_ent* const* from, double const* from_p,
+      struct gmi_ent* const* to, double* to_p);
+  /** \brief implement gmi_closest_point_batch
+   \details if omitted then gmi_closest_point_batch calls
+            closest_point on each point */
+  void (*closest_point_batch)(struct gmi_model* m, int n,
+      struct gmi_ent* const* e, double const* from, double* to, double* to_p);
+  /** \brief implement gmi_normal_batch
+   \details if omitted then gmi_normal_batch calls normal on each point */
+  void (*normal_batch)(struct gmi_model* m, int n, struct gmi_ent* const* e,
+      double const* p, double* normals);
+  /** \brief implement gmi_closest_point_seeded
+   \details if omitted then gmi_closest_point_seeded ignores the seed */
+  void (*closest_point_seeded)(struct gmi_model* m, struct gmi_ent* e,
+      double const from[3], double const seed_p[2], double to[3],
+      double to_p[2]);
+  /** \brief nonzero if the geometric queries of these models may be
+   called from several threads at once, see gmi_is_thread_safe */
+  int thread_safe;
 };
 
 /** \brief the basic structure for all GMI models */
@@ -156,6 +183,22 @@ int gmi_has_normal(struct gmi_model* m);
   \param x the resulting point in space */
 void gmi_eval(struct gmi_model* m, struct gmi_ent* e,
     double const p[2], double x[3]);
+/** \brief evaluate many parametric points at once
+  \details the same as calling gmi_eval on each point, but lets
+           a modeler whose evaluations are costly answer the whole
+           batch in one call, for example on several threads.
+  \param n the number of points
+  \param e the model entity of each point
+  \param p two parametric coordinates per point
+  \param x the resulting three coordinates per point */
+void gmi_eval_batch(struct gmi_model* m, int n, struct gmi_ent* const* e,
+    double const* p, double* x);
+/** \brief check whether gmi_eval, gmi_reparam, gmi_closest_point,
+  gmi_normal and their batches may run on several threads at once
+  \details callers use this to split large batches across threads
+            themselves; models that do not say so must be queried
+            from one thread at a time */
+int gmi_is_thread_safe(struct gmi_model* m);
 /** \brief re-parameterize from one model entity to another
   \param from the model entity to start from
   \param from_p the parametric coordinates on entity (from),
@@ -165,6 +208,13 @@ void gmi_eval(struct gmi_model* m, struct gmi_ent* e,
               in the form described by gmi_eval */
 void gmi_reparam(struct gmi_model* m, struct gmi_ent* from,
     double const from_p[2], struct gmi_ent* to, double to_p[2]);
+/** \brief re-parameterize many points at once
+  \details the same as calling gmi_reparam on each point,
+           with two parametric coordinates per point in
+           (from_p) and (to_p), see gmi_eval_batch */
+void gmi_reparam_batch(struct gmi_model* m, int n,
+    struct gmi_ent* const* from, double const* from_p,
+    struct gmi_ent* const* to, double* to_p);
 /** \brief return true iff the model entity is periodic around this dimension */
 int gmi_periodic(struct gmi_model* m, struct gmi_ent* e, int dim);
 /** \brief return the range of parametric coordinates along this dimension */
@@ -173,9 +223,26 @@ void gmi_range(struct gmi_model* m, struct gmi_ent* e, int dim,
 /** \brief return closest point and its parameter*/
 void gmi_closest_point(struct gmi_model* m, struct gmi_ent* e,
     double const from[3], double to[3], double to_p[2]);
+/** \brief return closest point and its parameter, starting the
+  search from the parametric coordinates (seed_p) of a nearby point */
+void gmi_closest_point_seeded(struct gmi_model* m, struct gmi_ent* e,
+    double const from[3], double const seed_p[2], double to[3],
+    double to_p[2]);
+/** \brief find the closest points of many points at once
+  \details the same as calling gmi_closest_point on each point,
+           with three coordinates per point in (from) and (to)
+           and two parametric coordinates in (to_p) */
+void gmi_closest_point_batch(struct gmi_model* m, int n,
+    struct gmi_ent* const* e, double const* from, double* to, double* to_p);
 /** \brief return normal vector at a parameter*/
 void gmi_normal(struct gmi_model* m, struct gmi_ent* e,
     double const p[2], double n[3]);
+/** \brief evaluate many normals at once
+  \details the same as calling gmi_normal on each point,
+           with two parametric coordinates per point in (p)
+           and three components per normal in (normals) */
+void gmi_normal_batch(struct gmi_model* m, int n, struct gmi_ent* const* e,
+    double const* p, double* normals);
 /** \brief return first derivative */
 void gmi_first_derivative(struct gmi_model* m, struct gmi_ent* e,
     double const p[2], double t0[3], double t1[3]);
@@ -10,6 +10,7 @@
 #include "gmi_analytic.h"
 #include "gmi_null.h"
 #include "gmi_base.h"
+#include <math.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -17,6 +18,17 @@
 typedef uint8_t periodic_t[2];
 typedef double ranges_t[2][2];
 
+/* a closed form surface in the frame (ex, ey, ez) at (center),
+   or kind -1 for entities defined by their functions */
+struct primitive {
+  int kind;
+  double center[3];
+  double ex[3];
+  double ey[3];
+  double ez[3];
+  double radii[2];
+};
+
 struct gmi_analytic
 {
   struct gmi_base base;
@@ -26,6 +38,8 @@ struct gmi_analytic
   struct agm_tag* data;
   struct agm_tag* reparam;
   struct agm_tag* reparam_data;
+  struct agm_tag* batch;
+  struct agm_tag* primitive;
 };
 
 static gmi_analytic_fun* f_of(struct gmi_analytic* m, struct agm_ent e)
@@ -48,6 +62,18 @@ static void** data_of(struct gmi_analytic* m, struct agm_ent e)
   return agm_tag_at(m->data, AGM_ENTITY, e.type, e.id);
 }
 
+static gmi_analytic_batch_fun* batch_of(struct gmi_analytic* m,
+    struct agm_ent e)
+{
+  return agm_tag_at(m->batch, AGM_ENTITY, e.type, e.id);
+}
+
+static struct primitive* primitive_of(struct gmi_analytic* m,
+    struct agm_ent e)
+{
+  return agm_tag_at(m->primitive, AGM_ENTITY, e.type, e.id);
+}
+
 static gmi_reparam_fun* reparam_of(struct gmi_analytic* m, struct agm_use u)
 {
   return agm_tag_at(m->reparam, AGM_USE, u.type, u.id);
@@ -87,9 +113,93 @@ struct gmi_ent* gmi_add_analytic(struct gmi_model* m, int dim, int tag,
     (*rp)[i][1] = 0;
   }
   *(data_of(m2, e)) = user_data;
+  *(batch_of(m2, e)) = NULL;
+  primitive_of(m2, e)->kind = -1;
   return gmi_from_agm(e);
 }
 
+static void normalize(double v[3])
+{
+  double l;
+  int i;
+  l = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+  for (i = 0; i < 3; ++i)
+    v[i] /= l;
+}
+
+struct gmi_ent* gmi_add_analytic_primitive(struct gmi_model* m, int tag,
+    enum gmi_analytic_primitive kind, double const center[3],
+    double const axis[3], double const radial[3], double const radii[2],
+    int* periodic, double (*ranges)[2])
+{
+  struct gmi_ent* e;
+  struct primitive* s;
+  double d;
+  int i;
+  e = gmi_add_analytic(m, 2, tag, NULL, periodic, ranges, NULL);
+  s = primitive_of(to_model(m), agm_from_gmi(e));
+  s->kind = kind;
+  for (i = 0; i < 3; ++i) {
+    s->center[i] = center[i];
+    s->ez[i] = axis[i];
+  }
+  normalize(s->ez);
+  d = 0;
+  for (i = 0; i < 3; ++i)
+    d += radial[i] * s->ez[i];
+  for (i = 0; i < 3; ++i)
+    s->ex[i] = radial[i] - d * s->ez[i];
+  normalize(s->ex);
+  s->ey[0] = s->ez[1] * s->ex[2] - s->ez[2] * s->ex[1];
+  s->ey[1] = s->ez[2] * s->ex[0] - s->ez[0] * s->ex[2];
+  s->ey[2] = s->ez[0] * s->ex[1] - s->ez[1] * s->ex[0];
+  s->radii[0] = radii ? radii[0] : 0;
+  s->radii[1] = radii ? radii[1] : 0;
+  return e;
+}
+
+void gmi_set_analytic_batch(struct gmi_model* m, struct gmi_ent* e,
+    gmi_analytic_batch_fun f)
+{
+  *(batch_of(to_model(m), agm_from_gmi(e))) = f;
+}
+
+/* the point at (a, b, c) in the frame of the primitive */
+static void eval_primitive(struct primitive* s, double const p[2],
+    double x[3])
+{
+  double a, b, c, w;
+  int i;
+  switch (s->kind) {
+    case GMI_ANALYTIC_PLANE:
+      a = p[0];
+      b = p[1];
+      c = 0;
+      break;
+    case GMI_ANALYTIC_CYLINDER:
+      a = s->radii[0] * cos(p[0]);
+      b = s->radii[0] * sin(p[0]);
+      c = p[1];
+      break;
+    case GMI_ANALYTIC_SPHERE:
+      w = s->radii[0] * sin(p[1]);
+      a = w * cos(p[0]);
+      b = w * sin(p[0]);
+      c = s->radii[0] * cos(p[1]);
+      break;
+    case GMI_ANALYTIC_TORUS:
+      w = s->radii[0] + s->radii[1] * cos(p[1]);
+      a = w * cos(p[0]);
+      b = w * sin(p[0]);
+      c = s->radii[1] * sin(p[1]);
+      break;
+    default:
+      gmi_fail("unknown analytic primitive");
+  }
+  for (i = 0; i < 3; ++i)
+    x[i] = s->center[i] + a * s->ex[i] + b * s->ey[i] + c * s->ez[i];
+}
+
 static void eval(struct gmi_model* m, struct gmi_ent* e,
       double const p[2], double x[3])
 {
@@ -97,11 +207,50 @@ static void eval(struct gmi_model* m, struct gmi_ent* e,
   struct agm_ent a;
   void* u;
   gmi_analytic_fun f;
+  gmi_analytic_batch_fun b;
+  struct primitive* s;
   m2 = to_model(m);
   a = agm_from_gmi(e);
+  s = primitive_of(m2, a);
+  if (s->kind != -1) {
+    eval_primitive(s, p, x);
+    return;
+  }
   u = *(data_of(m2, a));
   f = *(f_of(m2, a));
-  (*f)(p, x, u);
+  if (f) {
+    (*f)(p, x, u);
+    return;
+  }
+  b = *(batch_of(m2, a));
+  (*b)(1, p, x, u);
+}
+
+/* runs of points on the same entity go to its batch function
+   or its primitive in one go */
+static void eval_batch(struct gmi_model* m, int n, struct gmi_ent* const* e,
+    double const* p, double* x)
+{
+  struct gmi_analytic* m2;
+  struct agm_ent a;
+  struct primitive* s;
+  gmi_analytic_batch_fun b;
+  int i, j, k;
+  m2 = to_model(m);
+  for (i = 0; i < n; i = j) {
+    for (j = i + 1; j < n && e[j] == e[i]; ++j);
+    a = agm_from_gmi(e[i]);
+    s = primitive_of(m2, a);
+    b = *(batch_of(m2, a));
+    if (s->kind != -1)
+      for (k = i; k < j; ++k)
+        eval_primitive(s, p + 2 * k, x + 3 * k);
+    else if (b)
+      (*b)(j - i, p + 2 * i, x + 3 * i, *(data_of(m2, a)));
+    else
+      for (k = i; k < j; ++k)
+        eval(m, e[i], p + 2 * k, x + 3 * k);
+  }
 }
 
 static void reparam_across(struct gmi_analytic* m, struct agm_use u,
@@ -171,7 +320,8 @@ static struct gmi_model_ops ops = {
   .reparam  = reparam,
   .periodic = periodic,
   .range    = range,
-  .destroy  = gmi_base_destroy
+  .destroy  = gmi_base_destroy,
+  .eval_batch = eval_batch
 };
 
 struct gmi_model* gmi_make_analytic(void)
@@ -186,9 +336,20 @@ struct gmi_model* gmi_make_analytic(void)
   m->data = agm_new_tag(m->base.topo, sizeof(void*));
   m->reparam = agm_new_tag(m->base.topo, sizeof(gmi_reparam_fun));
   m->reparam_data = agm_new_tag(m->base.topo, sizeof(void*));
+  m->batch = agm_new_tag(m->base.topo, sizeof(gmi_analytic_batch_fun));
+  m->primitive = agm_new_tag(m->base.topo, sizeof(struct primitive));
   return &m->base.model;
 }
 
+void gmi_set_analytic_thread_safe(struct gmi_model* m, int safe)
+{
+  /* the same operations, reported thread safe */
+  static struct gmi_model_ops safe_ops;
+  safe_ops = ops;
+  safe_ops.thread_safe = 1;
+  m->ops = safe ? &safe_ops : &ops;
+}
+
 void* gmi_analytic_data(struct gmi_model* m, struct gmi_ent* e)
 {
   struct gmi_analytic* m2 = to_model(m);
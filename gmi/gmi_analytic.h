@@ -32,8 +32,40 @@ typedef void (*gmi_analytic_fun)(double const p[2], double x[3], void* u);
   \param u    extra user-provided data */
 typedef void (*gmi_reparam_fun)(double const from[2], double to[2], void* u);
 
-/** \brief make an empty analytic model */
+/** \brief the analytic parameterization of many points at once
+  \param n the number of points
+  \param p two parametric coordinates per point
+  \param x the resulting three coordinates per point
+  \param u pointer to user data */
+typedef void (*gmi_analytic_batch_fun)(int n, double const* p, double* x,
+    void* u);
+
+/** \brief closed form surfaces built into the analytic model
+  \details each is placed in a frame given by a center, an axis and
+  a radial direction. With (ez) the axis, (ex) the radial direction
+  made normal to it and ey = ez x ex, the parameterizations are:
+  - plane: center + p0 ex + p1 ey
+  - cylinder of radius r0: center + r0 (cos p0 ex + sin p0 ey) + p1 ez
+  - sphere of radius r0, with p1 from the axis:
+    center + r0 (sin p1 (cos p0 ex + sin p0 ey) + cos p1 ez)
+  - torus of radii r0 around the axis and r1 around the tube:
+    center + (r0 + r1 cos p1)(cos p0 ex + sin p0 ey) + r1 sin p1 ez */
+enum gmi_analytic_primitive {
+  GMI_ANALYTIC_PLANE,
+  GMI_ANALYTIC_CYLINDER,
+  GMI_ANALYTIC_SPHERE,
+  GMI_ANALYTIC_TORUS
+};
+
+/** \brief make an empty analytic model
+  \details the model is not reported by gmi_is_thread_safe
+  unless gmi_set_analytic_thread_safe says so */
 struct gmi_model* gmi_make_analytic(void);
+/** \brief choose whether gmi_is_thread_safe reports the model
+  \details set (safe) to nonzero only if every analytic and
+  re-parameterization function given to the model may be called
+  from several threads at once. The built-in primitives are. */
+void gmi_set_analytic_thread_safe(struct gmi_model* m, int safe);
 /** \brief add an entity to the analytic model
   \param m the analytic model
   \param dim the dimension of the entity
@@ -48,6 +80,22 @@ struct gmi_model* gmi_make_analytic(void);
                    function for this entity */
 struct gmi_ent* gmi_add_analytic(struct gmi_model* m, int dim, int tag,
     gmi_analytic_fun f, int* periodic, double (*ranges)[2], void* user_data);
+/** \brief add a face with a built-in closed form
+  \details the face is evaluated directly, without calling user code.
+  see gmi_analytic_primitive for the frame and the meaning of (radii),
+  which may be NULL for planes. (periodic) and (ranges) are as
+  in gmi_add_analytic */
+struct gmi_ent* gmi_add_analytic_primitive(struct gmi_model* m, int tag,
+    enum gmi_analytic_primitive kind, double const center[3],
+    double const axis[3], double const radial[3], double const radii[2],
+    int* periodic, double (*ranges)[2]);
+/** \brief give an entity a function that evaluates many points per call
+  \details gmi_eval_batch passes each run of consecutive points
+  on (e) to (f) in one call, with the user data of (e).
+  If the entity was added with a NULL analytic function, gmi_eval
+  calls (f) with one point. */
+void gmi_set_analytic_batch(struct gmi_model* m, struct gmi_ent* e,
+    gmi_analytic_batch_fun f);
 /** \brief get the analytic user data
   \details this function returns the pointer passed as (user_data)
   to gmi_add_analytic when creating entity (e) */
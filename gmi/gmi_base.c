@@ -219,3 +219,76 @@ void gmi_base_set_tag(struct gmi_model* m, struct gmi_ent* e, int tag)
   b = to_base(m);
   gmi_set_lookup(b->lookup, agm_from_gmi(e), tag);
 }
+
+/* the encoding is, for each dimension from vertices up: the entity
+   count, then per entity its tag, its boundary count, and per
+   boundary the use count followed by the indices of the used
+   entities. Replaying it in order rebuilds the same topology,
+   including the order of boundaries and uses. */
+
+int* gmi_base_encode(struct gmi_model* m, int* size)
+{
+  struct agm* topo;
+  struct gmi_lookup* lookup;
+  struct agm_ent e;
+  struct agm_bdry b;
+  struct agm_use u;
+  int* data;
+  int n;
+  int i;
+  topo = to_base(m)->topo;
+  lookup = to_base(m)->lookup;
+  n = 0;
+  for (i = 0; i < AGM_ENT_TYPES; ++i)
+    n += 1 + 2 * agm_ent_count(topo, i);
+  for (i = 0; i < AGM_BDRY_TYPES; ++i)
+    n += agm_bdry_count(topo, i);
+  for (i = 0; i < AGM_USE_TYPES; ++i)
+    n += agm_use_count(topo, i);
+  data = malloc(n * sizeof(*data));
+  *size = n;
+  n = 0;
+  for (i = 0; i < AGM_ENT_TYPES; ++i) {
+    data[n++] = agm_ent_count(topo, i);
+    for (e = agm_first_ent(topo, i); !agm_ent_null(e);
+         e = agm_next_ent(topo, e)) {
+      data[n++] = gmi_get_lookup(lookup, e);
+      data[n++] = agm_bdry_count_of(topo, e);
+      for (b = agm_first_bdry_of(topo, e); !agm_bdry_null(b);
+           b = agm_next_bdry_of(topo, b)) {
+        data[n++] = agm_use_count_by(topo, b);
+        for (u = agm_first_use_by(topo, b); !agm_use_null(u);
+             u = agm_next_use_by(topo, u))
+          data[n++] = agm_used(topo, u).id;
+      }
+    }
+  }
+  return data;
+}
+
+void gmi_base_decode(struct gmi_base* m, int const* data)
+{
+  struct agm_ent e;
+  struct agm_ent d;
+  struct agm_bdry b;
+  int i, j;
+  int n, bdrys, uses;
+  gmi_base_init(m);
+  for (i = 0; i < AGM_ENT_TYPES; ++i) {
+    n = *data++;
+    gmi_base_reserve(m, i, n);
+    for (j = 0; j < n; ++j) {
+      e = agm_add_ent(m->topo, i);
+      gmi_set_lookup(m->lookup, e, *data++);
+      for (bdrys = *data++; bdrys; --bdrys) {
+        b = agm_add_bdry(m->topo, e);
+        for (uses = *data++; uses; --uses) {
+          d.type = i - 1;
+          d.id = *data++;
+          agm_add_use(m->topo, b, d);
+        }
+      }
+    }
+    gmi_freeze_lookup(m->lookup, i);
+  }
+}
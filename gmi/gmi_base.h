@@ -55,6 +55,12 @@ void gmi_base_read_tess(struct gmi_base* m, FILE* f);
 
 void gmi_base_set_tag(struct gmi_model* m, struct gmi_ent* e, int tag);
 
+/* a flat array of the tags and topology of a base model, to
+   send it elsewhere. the caller frees the result */
+int* gmi_base_encode(struct gmi_model* m, int* size);
+/* initialize (m) from an array of gmi_base_encode */
+void gmi_base_decode(struct gmi_base* m, int const* data);
+
 extern struct gmi_model_ops gmi_base_ops;
 
 #ifdef __cplusplus
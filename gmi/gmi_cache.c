@@ -0,0 +1,336 @@
+/******************************************************************************
+
+  Copyright 2014 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#include "gmi_cache.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* the recent results kept per model entity */
+#define CACHE_ENTRIES 32
+
+struct entry {
+  double from[3];
+  double to[3];
+  double to_p[2];
+};
+
+/* a ring of the recent results on one model entity */
+struct ent_cache {
+  struct gmi_ent* e;
+  int n;
+  int next;
+  struct entry entries[CACHE_ENTRIES];
+};
+
+struct gmi_cache {
+  struct gmi_model model;
+  struct gmi_model_ops ops;
+  struct gmi_model* inner;
+  double tolerance;
+  /* open addressing table of entity caches, by entity pointer */
+  struct ent_cache** slots;
+  int capacity;
+  int count;
+  long hits;
+  long misses;
+};
+
+static struct gmi_cache* to_cache(struct gmi_model* m)
+{
+  return (struct gmi_cache*)m;
+}
+
+static struct gmi_model* inner_of(struct gmi_model* m)
+{
+  return to_cache(m)->inner;
+}
+
+static size_t hash(struct gmi_ent* e, int capacity)
+{
+  /* base model entities are small integers, not real pointers */
+  uint64_t k = (uint64_t)(uintptr_t)e * 0x9E3779B97F4A7C15ull;
+  return (size_t)(k >> 32) & (capacity - 1);
+}
+
+static struct ent_cache** find_slot(struct ent_cache** slots, int capacity,
+    struct gmi_ent* e)
+{
+  size_t i;
+  i = hash(e, capacity);
+  while (slots[i] && slots[i]->e != e)
+    i = (i + 1) & (capacity - 1);
+  return &slots[i];
+}
+
+static void grow(struct gmi_cache* c)
+{
+  struct ent_cache** slots;
+  int capacity;
+  int i;
+  capacity = c->capacity ? c->capacity * 2 : 64;
+  slots = calloc(capacity, sizeof(*slots));
+  for (i = 0; i < c->capacity; ++i)
+    if (c->slots[i])
+      *find_slot(slots, capacity, c->slots[i]->e) = c->slots[i];
+  free(c->slots);
+  c->slots = slots;
+  c->capacity = capacity;
+}
+
+static struct ent_cache* get_ent_cache(struct gmi_cache* c,
+    struct gmi_ent* e)
+{
+  struct ent_cache** slot;
+  if (2 * (c->count + 1) > c->capacity)
+    grow(c);
+  slot = find_slot(c->slots, c->capacity, e);
+  if (!*slot) {
+    *slot = calloc(1, sizeof(**slot));
+    (*slot)->e = e;
+    ++c->count;
+  }
+  return *slot;
+}
+
+static double distance2(double const a[3], double const b[3])
+{
+  double d;
+  double s;
+  int i;
+  s = 0;
+  for (i = 0; i < 3; ++i) {
+    d = a[i] - b[i];
+    s += d * d;
+  }
+  return s;
+}
+
+static struct entry* find_nearest(struct ent_cache* ec, double const from[3],
+    double* d2)
+{
+  struct entry* best;
+  double d;
+  int i;
+  best = NULL;
+  for (i = 0; i < ec->n; ++i) {
+    d = distance2(ec->entries[i].from, from);
+    if (!best || d < *d2) {
+      best = &ec->entries[i];
+      *d2 = d;
+    }
+  }
+  return best;
+}
+
+static void closest_point(struct gmi_model* m, struct gmi_ent* e,
+    double const from[3], double to[3], double to_p[2])
+{
+  struct gmi_cache* c;
+  struct ent_cache* ec;
+  struct entry* best;
+  struct entry* added;
+  double d2;
+  c = to_cache(m);
+  d2 = 0;
+  ec = get_ent_cache(c, e);
+  best = find_nearest(ec, from, &d2);
+  if (best && d2 <= c->tolerance * c->tolerance) {
+    memcpy(to, best->to, sizeof(best->to));
+    memcpy(to_p, best->to_p, sizeof(best->to_p));
+    ++c->hits;
+    return;
+  }
+  if (best)
+    gmi_closest_point_seeded(c->inner, e, from, best->to_p, to, to_p);
+  else
+    gmi_closest_point(c->inner, e, from, to, to_p);
+  ++c->misses;
+  added = &ec->entries[ec->next];
+  memcpy(added->from, from, sizeof(added->from));
+  memcpy(added->to, to, sizeof(added->to));
+  memcpy(added->to_p, to_p, sizeof(added->to_p));
+  ec->next = (ec->next + 1) % CACHE_ENTRIES;
+  if (ec->n < CACHE_ENTRIES)
+    ++ec->n;
+}
+
+/* the rest of the queries go to the inner model unchanged */
+
+static struct gmi_iter* begin(struct gmi_model* m, int dim)
+{
+  return gmi_begin(inner_of(m), dim);
+}
+
+static struct gmi_ent* next(struct gmi_model* m, struct gmi_iter* i)
+{
+  return gmi_next(inner_of(m), i);
+}
+
+static void end(struct gmi_model* m, struct gmi_iter* i)
+{
+  gmi_end(inner_of(m), i);
+}
+
+static int dim(struct gmi_model* m, struct gmi_ent* e)
+{
+  return gmi_dim(inner_of(m), e);
+}
+
+static int tag(struct gmi_model* m, struct gmi_ent* e)
+{
+  return gmi_tag(inner_of(m), e);
+}
+
+static struct gmi_ent* find(struct gmi_model* m, int dim, int tag)
+{
+  struct gmi_ent* e;
+  e = gmi_find(inner_of(m), dim, tag);
+  /* the null model adds entities as they are found */
+  memcpy(m->n, inner_of(m)->n, sizeof(m->n));
+  return e;
+}
+
+static struct gmi_set* adjacent(struct gmi_model* m, struct gmi_ent* e,
+    int dim)
+{
+  return gmi_adjacent(inner_of(m), e, dim);
+}
+
+static void eval(struct gmi_model* m, struct gmi_ent* e,
+    double const p[2], double x[3])
+{
+  gmi_eval(inner_of(m), e, p, x);
+}
+
+static void reparam(struct gmi_model* m, struct gmi_ent* from,
+    double const from_p[2], struct gmi_ent* to, double to_p[2])
+{
+  gmi_reparam(inner_of(m), from, from_p, to, to_p);
+}
+
+static int periodic(struct gmi_model* m, struct gmi_ent* e, int dim)
+{
+  return gmi_periodic(inner_of(m), e, dim);
+}
+
+static void range(struct gmi_model* m, struct gmi_ent* e, int dim,
+    double r[2])
+{
+  gmi_range(inner_of(m), e, dim, r);
+}
+
+static void normal(struct gmi_model* m, struct gmi_ent* e,
+    double const p[2], double n[3])
+{
+  gmi_normal(inner_of(m), e, p, n);
+}
+
+static void first_derivative(struct gmi_model* m, struct gmi_ent* e,
+    double const p[2], double t0[3], double t1[3])
+{
+  gmi_first_derivative(inner_of(m), e, p, t0, t1);
+}
+
+static int is_point_in_region(struct gmi_model* m, struct gmi_ent* e,
+    double point[3])
+{
+  return gmi_is_point_in_region(inner_of(m), e, point);
+}
+
+static int is_in_closure_of(struct gmi_model* m, struct gmi_ent* e,
+    struct gmi_ent* et)
+{
+  return gmi_is_in_closure_of(inner_of(m), e, et);
+}
+
+static int is_discrete_ent(struct gmi_model* m, struct gmi_ent* e)
+{
+  return gmi_is_discrete_ent(inner_of(m), e);
+}
+
+static void eval_batch(struct gmi_model* m, int n, struct gmi_ent* const* e,
+    double const* p, double* x)
+{
+  gmi_eval_batch(inner_of(m), n, e, p, x);
+}
+
+static void reparam_batch(struct gmi_model* m, int n,
+    struct gmi_ent* const* from, double const* from_p,
+    struct gmi_ent* const* to, double* to_p)
+{
+  gmi_reparam_batch(inner_of(m), n, from, from_p, to, to_p);
+}
+
+static void normal_batch(struct gmi_model* m, int n, struct gmi_ent* const* e,
+    double const* p, double* normals)
+{
+  gmi_normal_batch(inner_of(m), n, e, p, normals);
+}
+
+static void destroy(struct gmi_model* m)
+{
+  struct gmi_cache* c;
+  int i;
+  c = to_cache(m);
+  for (i = 0; i < c->capacity; ++i)
+    free(c->slots[i]);
+  free(c->slots);
+  gmi_destroy(c->inner);
+  free(c);
+}
+
+struct gmi_model* gmi_make_cached(struct gmi_model* inner, double tolerance)
+{
+  struct gmi_cache* c;
+  struct gmi_model_ops const* in;
+  struct gmi_model_ops* ops;
+  c = calloc(1, sizeof(*c));
+  c->inner = inner;
+  c->tolerance = tolerance;
+  memcpy(c->model.n, inner->n, sizeof(c->model.n));
+  in = inner->ops;
+  ops = &c->ops;
+  ops->begin = begin;
+  ops->next = next;
+  ops->end = end;
+  ops->dim = dim;
+  ops->tag = tag;
+  ops->find = find;
+  ops->destroy = destroy;
+  /* optional queries stay optional, so that gmi_can_eval and
+     friends answer for the inner model */
+  ops->adjacent = in->adjacent ? adjacent : NULL;
+  ops->eval = in->eval ? eval : NULL;
+  ops->reparam = in->reparam ? reparam : NULL;
+  ops->periodic = in->periodic ? periodic : NULL;
+  ops->range = in->range ? range : NULL;
+  ops->closest_point = in->closest_point ? closest_point : NULL;
+  ops->normal = in->normal ? normal : NULL;
+  ops->first_derivative = in->first_derivative ? first_derivative : NULL;
+  ops->is_point_in_region = in->is_point_in_region ?
+    is_point_in_region : NULL;
+  ops->is_in_closure_of = in->is_in_closure_of ? is_in_closure_of : NULL;
+  ops->is_discrete_ent = in->is_discrete_ent ? is_discrete_ent : NULL;
+  ops->eval_batch = in->eval_batch ? eval_batch : NULL;
+  ops->reparam_batch = in->reparam_batch ? reparam_batch : NULL;
+  ops->normal_batch = in->normal_batch ? normal_batch : NULL;
+  /* closest_point_batch is left out so that gmi_closest_point_batch
+     goes through the cache one point at a time */
+  c->model.ops = ops;
+  return &c->model;
+}
+
+void gmi_cache_stats(struct gmi_model* m, long* hits, long* misses)
+{
+  struct gmi_cache* c;
+  c = to_cache(m);
+  *hits = c->hits;
+  *misses = c->misses;
+}
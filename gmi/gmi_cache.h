@@ -0,0 +1,45 @@
+/******************************************************************************
+
+  Copyright 2014 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#ifndef GMI_CACHE_H
+#define GMI_CACHE_H
+
+/** \file gmi_cache.h
+  \brief GMI closest point cache over any model */
+
+#include "gmi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \brief wrap a model with a cache of its closest point queries
+  \details the returned model answers every query by calling (inner),
+  except gmi_closest_point. For that query, each model entity keeps
+  its most recent results. If a query point is within (tolerance)
+  of a cached query point on the same entity, the cached result is
+  returned and the model is not called. Otherwise the model searches
+  from the parameters of the nearest cached result, if it implements
+  gmi_closest_point_seeded.
+  A tolerance of zero only reuses exact repeats. Larger values trade
+  accuracy for speed: a hit can be about (tolerance) off.
+  The cache is not thread safe, whatever (inner) is.
+  gmi_destroy on the returned model also destroys (inner). */
+struct gmi_model* gmi_make_cached(struct gmi_model* inner, double tolerance);
+
+/** \brief get the closest point counters of a gmi_make_cached model
+  \param hits queries answered from the cache
+  \param misses queries passed on to the inner model */
+void gmi_cache_stats(struct gmi_model* m, long* hits, long* misses);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -3,49 +3,74 @@
 #include <stdlib.h>
 #include <pcu_util.h>
 
+/* an open addressing table from tag to entity index,
+   empty slots have index -1 */
 struct entry {
   int index;
   int tag;
 };
 
+struct table {
+  struct entry* slots;
+  unsigned mask;
+};
+
 struct gmi_lookup {
-  struct entry* sorted[AGM_ENT_TYPES];
+  struct table frozen[AGM_ENT_TYPES];
   struct agm_tag* tag;
   struct agm* topo;
 };
 
-static int comp_entries(const void* va, const void* vb)
+static int* get_tag(struct gmi_lookup* l, struct agm_ent e)
 {
-  const struct entry* a = va;
-  const struct entry* b = vb;
-  return a->tag - b->tag;
+  return agm_tag_at(l->tag, AGM_ENTITY, e.type, e.id);
 }
 
-static int* get_tag(struct gmi_lookup* l, struct agm_ent e)
+static unsigned hash_tag(int tag)
 {
-  return agm_tag_at(l->tag, AGM_ENTITY, e.type, e.id);
+  return (unsigned)tag * 2654435761u;
+}
+
+static struct entry* probe(struct table* t, int tag)
+{
+  unsigned i;
+  i = hash_tag(tag) & t->mask;
+  while (t->slots[i].index != -1 && t->slots[i].tag != tag)
+    i = (i + 1) & t->mask;
+  return &t->slots[i];
 }
 
 void gmi_freeze_lookup(struct gmi_lookup* l, enum agm_ent_type t)
 {
-  struct entry* es;
+  struct table* tab;
+  unsigned size;
+  unsigned i;
   int n;
   struct agm_ent e;
   struct entry* y;
-  PCU_ALWAYS_ASSERT(!(l->sorted[t]));
+  int tag;
+  tab = &l->frozen[t];
+  PCU_ALWAYS_ASSERT(!(tab->slots));
   n = agm_ent_count(l->topo, t);
-  es = malloc(n * sizeof(*es));
-  y = es;
+  /* at most half full */
+  size = 4;
+  while (size < 2 * (unsigned)n)
+    size *= 2;
+  tab->slots = malloc(size * sizeof(*(tab->slots)));
+  tab->mask = size - 1;
+  for (i = 0; i < size; ++i)
+    tab->slots[i].index = -1;
   for (e = agm_first_ent(l->topo, t);
        !agm_ent_null(e);
        e = agm_next_ent(l->topo, e)) {
-    y->index = e.id;
-    y->tag = *(get_tag(l, e));
-    ++y;
+    tag = *(get_tag(l, e));
+    y = probe(tab, tag);
+    /* a repeated tag finds the first entity, as the scan does */
+    if (y->index == -1) {
+      y->index = e.id;
+      y->tag = tag;
+    }
   }
-  PCU_ALWAYS_ASSERT(y - es == n);
-  qsort(es, n, sizeof(*es), comp_entries);
-  l->sorted[t] = es;
 }
 
 struct gmi_lookup* gmi_new_lookup(struct agm* topo)
@@ -69,17 +94,10 @@ int gmi_get_lookup(struct gmi_lookup* l, struct agm_ent e)
 
 struct agm_ent gmi_look_up(struct gmi_lookup* l, enum agm_ent_type t, int tag)
 {
-  struct entry key;
-  struct entry* found;
   struct agm_ent e;
-  if (l->sorted[t]) {
+  if (l->frozen[t].slots) {
     e.type = t;
-    e.id = -1;
-    key.tag = tag;
-    found = bsearch(&key, l->sorted[t], agm_ent_count(l->topo, t), sizeof(key),
-                    comp_entries);
-    if (found)
-      e.id = found->index;
+    e.id = probe(&l->frozen[t], tag)->index;
   } else {
     for (e = agm_first_ent(l->topo, t);
          !agm_ent_null(e);
@@ -94,8 +112,8 @@ void gmi_unfreeze_lookups(struct gmi_lookup* l)
 {
   enum agm_ent_type t;
   for (t = 0; t < AGM_ENT_TYPES; ++t) {
-    free(l->sorted[t]);
-    l->sorted[t] = 0;
+    free(l->frozen[t].slots);
+    l->frozen[t].slots = 0;
   }
 }
 
@@ -24,6 +24,9 @@ void gmi_free_lookup(struct gmi_lookup* l);
 void gmi_set_lookup(struct gmi_lookup* l, struct agm_ent e, int tag);
 int gmi_get_lookup(struct gmi_lookup* l, struct agm_ent e);
 struct agm_ent gmi_look_up(struct gmi_lookup* l, enum agm_ent_type t, int tag);
+/* hashes the tags of one entity type so that gmi_look_up takes
+   constant time, until gmi_unfreeze_lookups. tags must not change
+   while frozen */
 void gmi_freeze_lookup(struct gmi_lookup* l, enum agm_ent_type t);
 void gmi_unfreeze_lookups(struct gmi_lookup* l);
 
@@ -9,19 +9,27 @@
 *******************************************************************************/
 #include "gmi_mesh.h"
 #include <stdlib.h>
+#include <pcu_io.h>
+#include <PCU.h>
 
 static struct gmi_model* create(const char* filename,
     void (*readfp)(struct gmi_base*, FILE*))
 {
   struct gmi_base* m;
   FILE* f;
+  double start = pcu_io_time();
   f = fopen(filename, "r");
   if (!f)
     gmi_fail("could not open model file");
+  pcu_io_opened(PCU_IO_MODEL, start);
   m = malloc(sizeof(*m));
   m->model.ops = &gmi_base_ops;
+  start = pcu_io_time();
   (*readfp)(m, f);
+  pcu_io_read(PCU_IO_MODEL, ftell(f), start);
+  start = pcu_io_time();
   fclose(f);
+  pcu_io_closed(PCU_IO_MODEL, start);
   return &m->model;
 }
 
@@ -40,3 +48,32 @@ void gmi_register_mesh(void)
   gmi_register(from_dmg, "dmg");
   gmi_register(from_tess, "tess");
 }
+
+struct gmi_model* gmi_load_bcast(const char* filename)
+{
+  struct gmi_model* m;
+  struct gmi_base* b;
+  int* data;
+  int size;
+  m = 0;
+  data = 0;
+  size = 0;
+  if (!PCU_Comm_Self()) {
+    m = gmi_load(filename);
+    if (m->ops != &gmi_base_ops)
+      gmi_fail("gmi_load_bcast only supports .dmg and .tess models");
+    data = gmi_base_encode(m, &size);
+  }
+  MPI_Bcast(&size, 1, MPI_INT, 0, PCU_Get_Comm());
+  if (PCU_Comm_Self())
+    data = malloc(size * sizeof(*data));
+  MPI_Bcast(data, size, MPI_INT, 0, PCU_Get_Comm());
+  if (PCU_Comm_Self()) {
+    b = malloc(sizeof(*b));
+    b->model.ops = &gmi_base_ops;
+    gmi_base_decode(b, data);
+    m = &b->model;
+  }
+  free(data);
+  return m;
+}
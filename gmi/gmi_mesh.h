@@ -22,6 +22,14 @@ extern "C" {
 /** \brief register the meshmodel reader for .dmg files */
 void gmi_register_mesh(void);
 
+/** \brief load a .dmg or .tess file once and share it with all ranks
+  \details rank 0 reads the file and broadcasts the model topology
+  in a binary encoding, so the file system sees one reader instead
+  of every rank. The result is the same as gmi_load on each rank.
+  This is collective over the PCU communicator and needs
+  gmi_register_mesh first. */
+struct gmi_model* gmi_load_bcast(const char* filename);
+
 #ifdef __cplusplus
 }
 #endif
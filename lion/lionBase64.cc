@@ -129,44 +129,56 @@ std::string base64Encode1Byte (char byte)
 
 // ===========================================================================
 
-std::string base64Encode (const char* input, const unsigned long len )
+unsigned long base64EncodedLength (const unsigned long len)
 {
-  std::string encoded;
-  char inputChars[3];
-  unsigned int index = 0;
+  return (len + 2) / 3 * 4;
+}
+
+// ===========================================================================
+
+void base64Encode (const char* input, const unsigned long len, char* output)
+{
+  const unsigned char* in = (const unsigned char*)input;
+  unsigned long full = len / 3 * 3;
+  unsigned long i = 0;
 
-  //encode all the string in 3 byte sections, this loop won't encode the last
-  // 1 or 2 bytes if the len is not divisible by 3
-  if ( len > 2 )
+  //each 3 bytes are read as one 24 bit group and written as 4 chars
+  for ( ; i < full; i += 3 )
   {
-    for ( ; index <= len - 3; index += 3 )
-    {
-      inputChars[0] = input[index];
-      inputChars[1] = input[index+1];
-      inputChars[2] = input[index+2];
-      encoded += base64Encode3Bytes(inputChars);
-   }
+    unsigned long group = (in[i] << 16) | (in[i+1] << 8) | in[i+2];
+    output[0] = base64EncodeTable[(group >> 18) & 0x3F];
+    output[1] = base64EncodeTable[(group >> 12) & 0x3F];
+    output[2] = base64EncodeTable[(group >> 6) & 0x3F];
+    output[3] = base64EncodeTable[group & 0x3F];
+    output += 4;
   }
 
-  //encode the last 2 bytes if there are 2 bytes left at the end of the string
-  // i.e. if (len % 3 == 2)
-  if ( len - index == 2 )
+  //the last 1 or 2 bytes are padded with '='
+  if ( len - i == 2 )
   {
-    inputChars[0] = input[index];
-    inputChars[1] = input[index+1];
-    encoded += base64Encode2Bytes(inputChars);
-    index += 2;
+    unsigned long group = (in[i] << 16) | (in[i+1] << 8);
+    output[0] = base64EncodeTable[(group >> 18) & 0x3F];
+    output[1] = base64EncodeTable[(group >> 12) & 0x3F];
+    output[2] = base64EncodeTable[(group >> 6) & 0x3F];
+    output[3] = '=';
   }
-
-  //encode the last 1 byte if there is one byte left at the end of the string
-  // i.e. if (len % 3 == 1)
-  if ( len - index == 1 )
+  else if ( len - i == 1 )
   {
-    char inputChar = input[index];
-    encoded += base64Encode1Byte(inputChar);
-    index++;
+    unsigned long group = in[i] << 16;
+    output[0] = base64EncodeTable[(group >> 18) & 0x3F];
+    output[1] = base64EncodeTable[(group >> 12) & 0x3F];
+    output[2] = '=';
+    output[3] = '=';
   }
+}
+
+// ===========================================================================
 
+std::string base64Encode (const char* input, const unsigned long len )
+{
+  std::string encoded(base64EncodedLength(len), '\0');
+  if ( len )
+    base64Encode(input, len, &encoded[0]);
   return encoded;
 }
 
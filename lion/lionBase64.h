@@ -89,6 +89,36 @@ std::string base64Encode (const char* input, const unsigned long len );
 
 // ===========================================================================
 
+/*
+Function base64EncodedLength:
+  gets the number of Base64 chars that encode len bytes, including padding
+
+Arguments:
+  long len - number of bytes to be encoded
+
+Returns:
+  long - number of chars written by base64Encode
+*/
+unsigned long base64EncodedLength (const unsigned long len);
+
+// ===========================================================================
+
+/*
+Function base64Encode:
+  Encodes a series of bytes into a caller allocated buffer. Each 3 bytes are
+  looked up in the encode table as one 24 bit group, so nothing is appended
+  to a string and large arrays encode in one pass.
+
+Arguments:
+  char* input - pointer to start of byte string to be encoded
+  long len - number of bytes to be encoded
+  char* output - buffer of at least base64EncodedLength(len) chars, no null
+                 terminator is written
+*/
+void base64Encode (const char* input, const unsigned long len, char* output);
+
+// ===========================================================================
+
 /*
 Function base64Decode4Bytes:
   Decodes 4 bytes send to it from Base64 to plaintext,
@@ -17,67 +17,176 @@
 #include "maBalance.h"
 #include "maLayer.h"
 #include "maDBG.h"
+#include <cmath>
+#include <sstream>
 #include <pcu_util.h>
 
 namespace ma {
 
+/* runs one stage, recording it if the input asks for a profile */
+template <class Stage>
+static void run(Adapt* a, const char* name, int iteration, Stage stage)
+{
+  beginStage(a, name, iteration);
+  stage(a);
+  endStage(a);
+}
+
+/* decides after an iteration whether another is worth it,
+   from its operation count (already global) and one reduction
+   of the owned edges outside the metric length band */
+static bool hasConverged(Adapt* a, int iteration, long operations)
+{
+  Input* in = a->input;
+  if (( ! in->convergedEdgeFraction) && ( ! in->convergedOperationCount))
+    return false;
+  bool converged = in->convergedOperationCount &&
+    operations < in->convergedOperationCount;
+  if ( ! in->convergedEdgeFraction) {
+    print("iteration %d: %li operations", iteration, operations);
+    return converged;
+  }
+  double upper = sqrt(2.0);
+  double lower = 1.0 / upper;
+  long n[2] = {0, 0};
+  Mesh* m = a->mesh;
+  Iterator* it = m->begin(1);
+  Entity* e;
+  while ((e = m->iterate(it)))
+    if (m->isOwned(e)) {
+      double l = a->sizeField->measure(e);
+      if (l < lower || l > upper)
+        ++n[0];
+      ++n[1];
+    }
+  m->end(it);
+  PCU_Add_Longs(n, 2);
+  double fraction = n[1] ? double(n[0]) / n[1] : 0;
+  print("iteration %d: %li operations, %.2f%% of edges outside the length band",
+      iteration, operations, fraction * 100);
+  return converged || fraction < in->convergedEdgeFraction;
+}
+
+/* after an early stop no more refinements or coarsenings follow,
+   so balancing should not weight elements for them */
+static void skipIterations(Adapt* a)
+{
+  a->refinesLeft = 0;
+  a->coarsensLeft = 0;
+}
+
+/* writes the mesh after an iteration if the input asks for checkpoints.
+   The caches and the refinement tag are left out, so that only
+   the flags come back with the resumed mesh */
+static void writeCheckpoint(Adapt* a, int iteration)
+{
+  Input* in = a->input;
+  if ( ! in->checkpointPrefix)
+    return;
+  double t0 = PCU_Time();
+  clearQualityCache(a);
+  clearLengthCache(a);
+  delete a->refine;
+  std::stringstream ss;
+  ss << in->checkpointPrefix << iteration << ".smb";
+  std::string name = ss.str();
+  a->mesh->writeNative(name.c_str());
+  a->refine = new Refine(a);
+  setupQualityCache(a);
+  setupLengthCache(a);
+  double t1 = PCU_Time();
+  print("checkpoint %s written in %f seconds", name.c_str(), t1 - t0);
+}
+
 void adapt(Input* in)
 {
+  PCU_Region region("ma::adapt");
   print("version 2.0 !");
   double t0 = PCU_Time();
   validateInput(in);
+  bool wasOrdered = PCU_Comm_Ordered();
+  if (in->shouldBeDeterministic)
+    PCU_Comm_Order(true);
   Adapt* a = new Adapt(in);
-  preBalance(a);
-  for (int i = 0; i < in->maximumIterations; ++i)
+  if ( ! in->firstIteration)
+    run(a, "preBalance", -1, preBalance);
+  for (int i = in->firstIteration; i < in->maximumIterations; ++i)
   {
     print("iteration %d",i);
-    coarsen(a);
-    coarsenLayer(a);
-    midBalance(a);
-    refine(a);
-    snap(a);
+    long operations = a->operations;
+    run(a, "coarsen", i, coarsen);
+    run(a, "coarsenLayer", i, coarsenLayer);
+    run(a, "midBalance", i, midBalance);
+    run(a, "refine", i, refine);
+    run(a, "snap", i, snap);
+    if (in->shouldPrintReport)
+      printReport(a);
+    writeCheckpoint(a, i);
+    if (hasConverged(a, i, a->operations - operations)) {
+      skipIterations(a);
+      break;
+    }
   }
   allowSplitCollapseOutsideLayer(a);
-  fixElementShapes(a);
-  cleanupLayer(a);
-  tetrahedronize(a);
+  run(a, "fixElementShapes", -1, fixElementShapes);
+  run(a, "cleanupLayer", -1, cleanupLayer);
+  run(a, "tetrahedronize", -1, tetrahedronize);
   printQuality(a);
-  postBalance(a);
-  Mesh* m = a->mesh;
+  run(a, "postBalance", -1, postBalance);
+  if (in->tracer)
+    in->tracer->finish();
+  /* the statistics reduce while the adapt state is torn down */
+  apf::StatsReduction* stats = apf::beginStats(a->mesh);
   delete a;
   delete in;
+  PCU_Comm_Order(wasOrdered);
   double t1 = PCU_Time();
   print("mesh adapted in %f seconds",t1-t0);
-  apf::printStats(m);
+  apf::MeshStats s;
+  apf::endStats(stats, s);
+  apf::printStats(s);
 }
 
 void adaptVerbose(Input* in, bool verbose)
 {
+  PCU_Region region("ma::adapt");
   print("version 2.0 - dev !");
   double t0 = PCU_Time();
   validateInput(in);
+  bool wasOrdered = PCU_Comm_Ordered();
+  if (in->shouldBeDeterministic)
+    PCU_Comm_Order(true);
   Adapt* a = new Adapt(in);
-  preBalance(a);
-  for (int i = 0; i < in->maximumIterations; ++i)
+  if ( ! in->firstIteration)
+    run(a, "preBalance", -1, preBalance);
+  for (int i = in->firstIteration; i < in->maximumIterations; ++i)
   {
     print("iteration %d",i);
-    coarsen(a);
+    long operations = a->operations;
+    run(a, "coarsen", i, coarsen);
     if (verbose && in->shouldCoarsen)
       ma_dbg::dumpMeshWithQualities(a,i,"after_coarsen");
-    coarsenLayer(a);
-    midBalance(a);
-    refine(a);
+    run(a, "coarsenLayer", i, coarsenLayer);
+    run(a, "midBalance", i, midBalance);
+    run(a, "refine", i, refine);
     if (verbose)
       ma_dbg::dumpMeshWithQualities(a,i,"after_refine");
-    snap(a);
+    run(a, "snap", i, snap);
     if (verbose && in->shouldSnap)
       ma_dbg::dumpMeshWithQualities(a,i,"after_snap");
-    fixElementShapes(a);
+    run(a, "fixElementShapes", i, fixElementShapes);
     if (verbose && in->shouldFixShape)
       ma_dbg::dumpMeshWithQualities(a,i,"after_fix");
+    if (in->shouldPrintReport)
+      printReport(a);
+    writeCheckpoint(a, i);
+    if (hasConverged(a, i, a->operations - operations)) {
+      skipIterations(a);
+      break;
+    }
   }
   allowSplitCollapseOutsideLayer(a);
-  fixElementShapes(a);
+  run(a, "fixElementShapes", -1, fixElementShapes);
   if (verbose) ma_dbg::dumpMeshWithQualities(a,999,"after_final_fix");
   /* The following loop ensures that no long edges are left in
    * the mesh. Note that at this point all elements are of "good"
@@ -89,8 +198,8 @@ void adaptVerbose(Input* in, bool verbose)
   print("Maximum (metric) edge length in the mesh is %f", lMax);
   while (lMax > 1.5) {
     print("%dth additional refine-snap call", count);
-    refine(a);
-    snap(a);
+    run(a, "refine", -1, refine);
+    run(a, "snap", -1, snap);
     lMax = ma::getMaximumEdgeLength(a->mesh, a->sizeField);
     count++;
     print("Maximum (metric) edge length in the mesh is %f", lMax);
@@ -98,16 +207,22 @@ void adaptVerbose(Input* in, bool verbose)
   }
   if (verbose)
     ma_dbg::dumpMeshWithQualities(a,999,"after_final_refine_snap_loop");
-  cleanupLayer(a);
-  tetrahedronize(a);
+  run(a, "cleanupLayer", -1, cleanupLayer);
+  run(a, "tetrahedronize", -1, tetrahedronize);
   printQuality(a);
-  postBalance(a);
-  Mesh* m = a->mesh;
+  run(a, "postBalance", -1, postBalance);
+  if (in->tracer)
+    in->tracer->finish();
+  /* the statistics reduce while the adapt state is torn down */
+  apf::StatsReduction* stats = apf::beginStats(a->mesh);
   delete a;
   delete in;
+  PCU_Comm_Order(wasOrdered);
   double t1 = PCU_Time();
   print("mesh adapted in %f seconds",t1-t0);
-  apf::printStats(m);
+  apf::MeshStats s;
+  apf::endStats(stats, s);
+  apf::printStats(s);
 }
 
 
@@ -123,7 +238,10 @@ void adapt(Mesh* m, IsotropicFunction* f, SolutionTransfer* s)
 
 void runUniformRefinement(Mesh* m, int n, SolutionTransfer* s)
 {
-  adapt(configureUniformRefine(m,n,s));
+  if (canRefineUniformly(m))
+    refineUniformly(m,n,s);
+  else
+    adapt(configureUniformRefine(m,n,s));
 }
 
 void adaptMatching(Mesh* m, int n, SolutionTransfer* s)
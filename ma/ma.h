@@ -35,6 +35,7 @@
   \brief The MeshAdapt interface */
 
 #include "maInput.h"
+#include "maProfile.h"
 
 /** \namespace ma
     \brief All MeshAdapt symbols */
@@ -53,8 +54,23 @@ void adapt(Input* in);
   \details see maInput.h for details. The mesh will be
   written (vtk-format) at each operation stage */
 void adaptVerbose(Input* in, bool verbosef = false);
-/** \brief run uniform refinement, plus snapping and shape correction */
+/** \brief run uniform refinement, plus snapping and shape correction
+  \details meshes that ma::canRefineUniformly accepts go through
+  ma::refineUniformly, which needs neither */
 void runUniformRefinement(Mesh* m, int n=1, SolutionTransfer* s=0);
+/** \brief return true if ma::refineUniformly can refine this mesh
+  \details collective. The mesh must be made of linear simplices,
+  without matching, and its model must have no geometry to snap to */
+bool canRefineUniformly(Mesh* m);
+/** \brief split every edge (n) times with fixed templates
+  \details this skips the size field, marking, cavities and
+  template matching of ma::adapt, and makes exactly
+  E vertices, 2E + 3F + T edges, 4F + 8T triangles and
+  8T tetrahedra per level. New vertices lie at edge midpoints
+  and each octahedron splits along its shortest diagonal,
+  so there is no shape correction.
+  If (s) is null, all fields are transferred, as with ma::adapt. */
+void refineUniformly(Mesh* m, int n=1, SolutionTransfer* s=0);
 /** \brief run uniform refinement with matched entity support
   \details currently this supports snapping but not shape correction */
 void adaptMatching(Mesh* m, int n=1, SolutionTransfer* s=0);
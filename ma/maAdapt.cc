@@ -33,6 +33,7 @@ Adapt::Adapt(Input* in)
   deleteCallback = 0;
   buildCallback = 0;
   sizeField = in->sizeField;
+  setupLengthCache(this);
   solutionTransfer = in->solutionTransfer;
   refine = new Refine(this);
   if (in->shapeHandler){
@@ -40,10 +41,12 @@ Adapt::Adapt(Input* in)
   } else
     shape = getShapeHandler(this);
   if (in->shouldCoarsen)
-    coarsensLeft = in->maximumIterations;
+    coarsensLeft = in->maximumIterations - in->firstIteration;
   else
     coarsensLeft = 0;
-  refinesLeft = in->maximumIterations;
+  refinesLeft = in->maximumIterations - in->firstIteration;
+  operations = 0;
+  tracer = in->tracer;
   resetLayer(this);
   if (hasLayer)
     checkLayerShape(mesh, "input mesh");
@@ -53,13 +56,19 @@ Adapt::~Adapt()
 {
   clearFlags(this);
   clearQualityCache(this);
+  clearLengthCache(this);
   delete refine;
   delete shape;
 }
 
 void setupFlags(Adapt* a)
 {
-  a->flagsTag = a->mesh->createIntTag("ma_flags",1);
+  /* a mesh resumed from a checkpoint comes with its flags,
+     which are counted as adaptation memory like new ones */
+  a->flagsTag = a->mesh->findTag("ma_flags");
+  if ( ! a->flagsTag)
+    a->flagsTag = a->mesh->createIntTag("ma_flags",1);
+  a->mesh->chargeTag(a->flagsTag, PCU_MEM_MA);
 }
 
 void clearFlags(Adapt* a)
@@ -150,6 +159,7 @@ void clearFlagFromDimension(Adapt* a, int flag, int dimension)
 void setupQualityCache(Adapt* a)
 {
   a->qualityCache = a->mesh->createDoubleTag("ma_qual_cache",1);
+  a->mesh->chargeTag(a->qualityCache, PCU_MEM_MA);
 }
 
 void clearQualityCache(Adapt* a)
@@ -168,6 +178,19 @@ void clearQualityCache(Adapt* a)
   m->destroyTag(a->qualityCache);
 }
 
+void setupLengthCache(Adapt* a)
+{
+  a->lengthCache = createLengthCache(a->mesh);
+  setLengthCache(a->sizeField, a->lengthCache);
+}
+
+void clearLengthCache(Adapt* a)
+{
+  setLengthCache(a->sizeField, 0);
+  apf::removeTagFromDimension(a->mesh, a->lengthCache, 1);
+  a->mesh->destroyTag(a->lengthCache);
+}
+
 double getCachedQuality(Adapt* a, Entity* e)
 {
   Mesh* m = a->mesh;
@@ -205,6 +228,8 @@ void destroyElement(Adapt* a, Entity* e)
   if (dim > 0)
     nd = m->getDownward(e,dim-1,down);
   if (a->deleteCallback) a->deleteCallback->call(e);
+  if (dim == 1 && m->hasTag(e, a->lengthCache))
+    m->removeTag(e, a->lengthCache);
   m->destroy(e);
   /* destruction applies recursively to the closure of the entity */
   if (dim > 0)
@@ -226,7 +251,7 @@ DeleteCallback::~DeleteCallback()
 bool checkFlagConsistency(Adapt* a, int dimension, int flag)
 {
   Mesh* m = a->mesh;
-  apf::Sharing* sh = apf::getSharing(m);
+  apf::Sharing* sh = m->getCachedSharing();
   PCU_Comm_Begin();
   Entity* e;
   Iterator* it = m->begin(dimension);
@@ -251,7 +276,6 @@ bool checkFlagConsistency(Adapt* a, int dimension, int flag)
     if(value != getFlag(a,e,flag))
       ok = false;
   }
-  delete sh;
   return ok;
 }
 
@@ -295,7 +319,8 @@ long markEntities(
     int dimension,
     Predicate& predicate,
     int trueFlag,
-    int falseFlag)
+    int falseFlag,
+    std::vector<Entity*>* marked)
 {
   Entity* e;
   long count = 0;
@@ -311,6 +336,8 @@ long markEntities(
     if (predicate(e))
     {
       setFlag(a,e,trueFlag);
+      if (marked)
+        marked->push_back(e);
       if (a->mesh->isOwned(e))
         ++count;
     }
@@ -487,7 +514,7 @@ void setFlagOnClosure(Adapt* a, Entity* element, int flag)
 void syncFlag(Adapt* a, int dimension, int flag)
 {
   Mesh* m = a->mesh;
-  apf::Sharing* sh = apf::getSharing(m);
+  apf::Sharing* sh = m->getCachedSharing();
   PCU_Comm_Begin();
   Entity* e;
   Iterator* it = m->begin(dimension);
@@ -505,7 +532,6 @@ void syncFlag(Adapt* a, int dimension, int flag)
     PCU_COMM_UNPACK(e);
     setFlag(a,e,flag);
   }
-  delete sh;
 }
 
 HasTag::HasTag(Mesh* m, Tag* t)
@@ -48,6 +48,7 @@ class Adapt
     Mesh* mesh;
     Tag* flagsTag;
     Tag* qualityCache; // to avoid repeated quality computations
+    Tag* lengthCache; // to avoid repeated edge length computations
     DeleteCallback* deleteCallback;
     apf::BuildCallback* buildCallback;
     SizeField* sizeField;
@@ -57,6 +58,8 @@ class Adapt
     int coarsensLeft;
     int refinesLeft;
     bool hasLayer;
+    long operations; // global successes of all stages so far
+    Tracer* tracer; // from the input, 0 if not tracing
 };
 
 void setTolerance(Adapt* a, double t);
@@ -76,11 +79,20 @@ void clearFlagFromDimension(Adapt* a, int flag, int dimension);
 
 void setupQualityCache(Adapt* a);
 void clearQualityCache(Adapt* a);
+void setupLengthCache(Adapt* a);
+void clearLengthCache(Adapt* a);
 double getCachedQuality(Adapt* a, Entity* e);
 void   setCachedQuality(Adapt* a, Entity* e, double q);
 
 void destroyElement(Adapt* a, Entity* e);
 
+/* record a stage in a->input->profile, if there is one */
+void beginStage(Adapt* a, const char* name, int iteration);
+void endStage(Adapt* a);
+/* called by a stage with the global counts of its operations,
+   which also adds them to a->operations */
+void noteOperations(Adapt* a, long attempted, long succeeded);
+
 class DeleteCallback
 {
   public:
@@ -103,12 +115,14 @@ struct Predicate
   virtual bool operator()(Entity* e) = 0;
 };
 
+/* if (marked) is given, the entities that get (trueFlag) are appended */
 long markEntities(
     Adapt* a,
     int dimension,
     Predicate& predicate,
     int trueFlag,
-    int falseFlag);
+    int falseFlag,
+    std::vector<Entity*>* marked = 0);
 
 class NewEntities : public apf::BuildCallback
 {
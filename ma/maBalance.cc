@@ -1,8 +1,11 @@
 #include <PCU.h>
 #include "maBalance.h"
 #include "maAdapt.h"
+#include "maRefine.h"
 #include <parma.h>
 #include <apfZoltan.h>
+#include <cmath>
+#include <map>
 
 namespace ma {
 
@@ -90,27 +93,59 @@ Tag* getElementWeights(Adapt* a)
   return weights;
 }
 
-static void runBalancer(Adapt* a, apf::Balancer* b)
+/* weighs each element by the number of elements the coming
+   refinement makes of it, marking the edges to split for this
+   and then forgetting them so refine can mark them again */
+Tag* getRefinementWeights(Adapt* a)
+{
+  Mesh* m = a->mesh;
+  markEdgesToSplit(a);
+  Tag* weights = m->createDoubleTag("ma_weight",1);
+  Entity* e;
+  Iterator* it = m->begin(m->getDimension());
+  while ((e = m->iterate(it)))
+  {
+    double weight = countSplitElements(a,e);
+    if ( ! weight)
+      weight = getElementWeight(a,e);
+    m->setDoubleTag(e,weights,&weight);
+  }
+  m->end(it);
+  clearFlagFromDimension(a,SPLIT,1);
+  return weights;
+}
+
+static void runBalancer(Adapt* a, apf::Balancer* b, bool beforeRefine)
 {
   Mesh* m = a->mesh;
   Input* in = a->input;
-  Tag* weights = getElementWeights(a);
+  /* layer setup changes the split marks, so it keeps size weights */
+  Tag* weights;
+  if (beforeRefine && in->shouldBalanceForRefinement && ( ! a->hasLayer))
+    weights = getRefinementWeights(a);
+  else
+    weights = getElementWeights(a);
   b->balance(weights,in->maximumImbalance);
   delete b;
   removeTagFromDimension(m,weights,m->getDimension());
   m->destroyTag(weights);
 }
 
-void runZoltan(Adapt* a, int method=apf::GRAPH)
+void runZoltan(Adapt* a, int method=apf::GRAPH, bool beforeRefine=false)
 {
   runBalancer(a, apf::makeZoltanBalancer(
         a->mesh, method, apf::REPARTITION,
-        /* debug = */ false));
+        /* debug = */ false), beforeRefine);
+}
+
+void runParma(Adapt* a, bool beforeRefine=false)
+{
+  runBalancer(a, Parma_MakeElmBalancer(a->mesh), beforeRefine);
 }
 
-void runParma(Adapt* a)
+void runHilbert(Adapt* a, bool beforeRefine=false)
 {
-  runBalancer(a, Parma_MakeElmBalancer(a->mesh));
+  runBalancer(a, Parma_MakeHilbertBalancer(a->mesh), beforeRefine);
 }
 
 void printEntityImbalance(Mesh* m)
@@ -121,8 +156,183 @@ void printEntityImbalance(Mesh* m)
   print("element imbalance %.0f%% of average",p);
 }
 
+/* sends the elements around each matched vertex to the lowest
+   part holding one of its matches, taking the lowest such part
+   when an element touches several matched vertices.
+   All the copies agree on that part, so one migration makes most
+   matches local and the matched operators stop pulling cavities
+   across parts one entity at a time. */
+static apf::Migration* planMatchColocation(Mesh* m)
+{
+  int self = PCU_Comm_Self();
+  Tag* tag = m->createIntTag("ma_match_part", 1);
+  Iterator* it = m->begin(0);
+  Entity* v;
+  while ((v = m->iterate(it))) {
+    apf::Matches matches;
+    m->getMatches(v, matches);
+    int to = self;
+    for (size_t i = 0; i < matches.getSize(); ++i)
+      to = std::min(to, matches[i].peer);
+    if (to == self)
+      continue;
+    apf::Adjacent elements;
+    m->getAdjacent(v, m->getDimension(), elements);
+    for (size_t i = 0; i < elements.getSize(); ++i) {
+      int old = to;
+      if (m->hasTag(elements[i], tag))
+        m->getIntTag(elements[i], tag, &old);
+      int dest = std::min(old, to);
+      m->setIntTag(elements[i], tag, &dest);
+    }
+  }
+  m->end(it);
+  apf::Migration* plan = new apf::Migration(m);
+  Entity* e;
+  it = m->begin(m->getDimension());
+  while ((e = m->iterate(it)))
+    if (m->hasTag(e, tag)) {
+      int dest;
+      m->getIntTag(e, tag, &dest);
+      plan->send(e, dest);
+      m->removeTag(e, tag);
+    }
+  m->end(it);
+  m->destroyTag(tag);
+  return plan;
+}
+
+void colocateMatches(Adapt* a)
+{
+  Mesh* m = a->mesh;
+  if (PCU_Comm_Peers()==1 || ( ! a->input->shouldColocateMatches))
+    return;
+  apf::Migration* plan = planMatchColocation(m);
+  bool wouldEmpty = (size_t)plan->count() == m->count(m->getDimension());
+  long moved = PCU_Add_Long(plan->count());
+  if (PCU_Or(wouldEmpty)) {
+    print("skipped moving %li elements to their matches"
+          " because a part would be emptied", moved);
+    delete plan;
+    return;
+  }
+  m->migrate(plan);
+  print("moved %li elements to their matches", moved);
+}
+
+/* the parts sharing vertices with this one, each
+   paired with its count of bad elements */
+typedef std::map<int, long> BadCounts;
+
+static void getNeighborBadCounts(Mesh* m, long count, BadCounts& counts)
+{
+  apf::Parts neighbors;
+  Iterator* it = m->begin(0);
+  Entity* v;
+  while ((v = m->iterate(it))) {
+    apf::Copies remotes;
+    m->getRemotes(v, remotes);
+    APF_ITERATE(apf::Copies, remotes, rit)
+      neighbors.insert(rit->first);
+  }
+  m->end(it);
+  PCU_Comm_Begin();
+  APF_ITERATE(apf::Parts, neighbors, nit)
+    PCU_COMM_PACK(*nit, count);
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    long c;
+    PCU_COMM_UNPACK(c);
+    counts[PCU_Comm_Sender()] = c;
+  }
+}
+
+/* picks a neighbor with room left that shares a vertex of (e) */
+static int pickRoom(Mesh* m, Entity* e, BadCounts& room)
+{
+  Downward v;
+  int nv = m->getDownward(e, 0, v);
+  for (int i = 0; i < nv; ++i) {
+    apf::Copies remotes;
+    m->getRemotes(v[i], remotes);
+    APF_ITERATE(apf::Copies, remotes, rit)
+      if (room.count(rit->first) && room[rit->first] > 0)
+        return rit->first;
+  }
+  return -1;
+}
+
+/* one diffusion step of the bad elements: a part with more
+   of them than the average over itself and its neighbors
+   sends its excess to the neighbors below that average.
+   only bad elements on the part boundary are sent, each with
+   the elements around its vertices, which is the cavity the
+   shape fixers work in */
+static apf::Migration* planBadElementSpread(Adapt* a)
+{
+  Mesh* m = a->mesh;
+  int dim = m->getDimension();
+  std::vector<Entity*> bad;
+  Iterator* it = m->begin(dim);
+  Entity* e;
+  while ((e = m->iterate(it)))
+    if (getFlag(a, e, BAD_QUALITY))
+      bad.push_back(e);
+  m->end(it);
+  BadCounts counts;
+  getNeighborBadCounts(m, bad.size(), counts);
+  double total = bad.size();
+  APF_ITERATE(BadCounts, counts, cit)
+    total += cit->second;
+  double average = total / (counts.size() + 1);
+  long excess = bad.size() - long(std::ceil(average));
+  apf::Migration* plan = new apf::Migration(m);
+  if (excess <= 0)
+    return plan;
+  BadCounts room;
+  APF_ITERATE(BadCounts, counts, cit)
+    if (cit->second < average)
+      room[cit->first] = long(average) - cit->second;
+  for (size_t i = 0; i < bad.size() && excess > 0; ++i) {
+    if (plan->has(bad[i]))
+      continue;
+    int to = pickRoom(m, bad[i], room);
+    if (to == -1)
+      continue;
+    Downward v;
+    int nv = m->getDownward(bad[i], 0, v);
+    for (int j = 0; j < nv; ++j) {
+      apf::Adjacent cavity;
+      m->getAdjacent(v[j], dim, cavity);
+      for (size_t k = 0; k < cavity.getSize(); ++k)
+        if ( ! plan->has(cavity[k]))
+          plan->send(cavity[k], to);
+    }
+    --room[to];
+    --excess;
+  }
+  return plan;
+}
+
+void spreadBadElements(Adapt* a)
+{
+  Mesh* m = a->mesh;
+  if (PCU_Comm_Peers()==1 || ( ! a->input->shouldSpreadBadElements))
+    return;
+  apf::Migration* plan = planBadElementSpread(a);
+  bool wouldEmpty = (size_t)plan->count() == m->count(m->getDimension());
+  long moved = PCU_Add_Long(plan->count());
+  if (( ! moved) || PCU_Or(wouldEmpty)) {
+    delete plan;
+    return;
+  }
+  m->migrate(plan);
+  print("moved %li elements around bad elements to neighbor parts", moved);
+}
+
 void preBalance(Adapt* a)
 {
+  PCU_Region region("ma::preBalance");
   if (PCU_Comm_Peers()==1)
     return;
   Input* in = a->input;
@@ -130,23 +340,37 @@ void preBalance(Adapt* a)
     runZoltan(a);
   if (in->shouldRunPreZoltanRib)
     runZoltan(a,apf::RIB);
+  if (in->shouldRunPreHilbert)
+    runHilbert(a);
   if (in->shouldRunPreParma)
     runParma(a);
+  colocateMatches(a);
 }
 
 void midBalance(Adapt* a)
 {
+  PCU_Region region("ma::midBalance");
   if (PCU_Comm_Peers()==1)
     return;
   Input* in = a->input;
+  /* shape correction also balances here, and after the
+     last refinement there is nothing to predict */
+  bool beforeRefine = a->refinesLeft > 0;
   if (in->shouldRunMidZoltan)
-    runZoltan(a);
+    runZoltan(a, apf::GRAPH, beforeRefine);
+  if (in->shouldRunMidHilbert)
+    runHilbert(a, beforeRefine);
   if (in->shouldRunMidParma)
-    runParma(a);
+    runParma(a, beforeRefine);
+  /* the balancers know nothing of matching */
+  if (in->shouldRunMidZoltan || in->shouldRunMidHilbert ||
+      in->shouldRunMidParma)
+    colocateMatches(a);
 }
 
 void postBalance(Adapt* a)
 {
+  PCU_Region region("ma::postBalance");
   if (PCU_Comm_Peers()==1)
     return;
   Input* in = a->input;
@@ -154,6 +378,8 @@ void postBalance(Adapt* a)
     runZoltan(a);
   if (in->shouldRunPostZoltanRib)
     runZoltan(a,apf::RIB);
+  if (in->shouldRunPostHilbert)
+    runHilbert(a);
   if (in->shouldRunPostParma)
     runParma(a);
   printEntityImbalance(a->mesh);
@@ -5,6 +5,8 @@ namespace ma {
 
 class Adapt;
 
+void colocateMatches(Adapt* a);
+void spreadBadElements(Adapt* a);
 void preBalance(Adapt* a);
 void midBalance(Adapt* a);
 void postBalance(Adapt* a);
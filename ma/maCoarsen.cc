@@ -64,6 +64,18 @@ void checkAllEdgeCollapses(Adapt* a, int modelDimension)
   PCU_ALWAYS_ASSERT(checkFlagConsistency(a,0,COLLAPSE));
 }
 
+/* checkAllEdgeCollapses over the edges in (edges) only */
+static void checkEdgeCollapses(Adapt* a, int modelDimension,
+    std::vector<Entity*>& edges)
+{
+  CollapseChecker checker(a,modelDimension);
+  checker.applyToList(1, edges);
+  for (size_t i = 0; i < edges.size(); ++i)
+    clearFlag(a,edges[i],CHECKED);
+  PCU_ALWAYS_ASSERT(checkFlagConsistency(a,1,COLLAPSE));
+  PCU_ALWAYS_ASSERT(checkFlagConsistency(a,0,COLLAPSE));
+}
+
 class IndependentSetFinder : public apf::CavityOp
 {
   public:
@@ -73,6 +85,10 @@ class IndependentSetFinder : public apf::CavityOp
     {
       vertex = 0;
     }
+    virtual void orderList(std::vector<Entity*>& entities)
+    {
+      sortByPosition(mesh, entities);
+    }
     virtual Outcome setEntity(Entity* v)
     {
       if (( ! getFlag(adapt,v,COLLAPSE))||
@@ -98,7 +114,23 @@ class IndependentSetFinder : public apf::CavityOp
 void findIndependentSet(Adapt* a)
 {
   IndependentSetFinder finder(a);
-  finder.applyToDimension(0);
+  if (a->input->shouldBeDeterministic) {
+    /* the first vertices visited stay in the set, so the order
+       picks which of them are collapsed. PCU message ordering
+       does not fix it, since the part-local vertex order comes
+       from how the mesh was built. */
+    std::vector<Entity*> vertices;
+    Mesh* m = a->mesh;
+    Iterator* it = m->begin(0);
+    Entity* v;
+    while ((v = m->iterate(it)))
+      if (getFlag(a,v,COLLAPSE))
+        vertices.push_back(v);
+    m->end(it);
+    finder.orderList(vertices);
+    finder.applyToList(0, vertices);
+  } else
+    finder.applyToDimension(0);
   clearFlagFromDimension(a,CHECKED,0);
   PCU_ALWAYS_ASSERT(checkFlagConsistency(a, 0, COLLAPSE));
 }
@@ -116,6 +148,7 @@ class AllEdgeCollapser : public Operator
       else
         qualityToBeat = getAdapt()->input->goodQuality;
     }
+    virtual const char* getName() {return "collapse";}
     virtual int getTargetDimension() {return 1;}
     virtual bool shouldApply(Entity* e)
     {
@@ -136,10 +169,11 @@ class AllEdgeCollapser : public Operator
     }
     virtual void apply()
     {
-      if ( ! collapse.checkTopo())
-        return;
-      if ( ! collapse.tryBothDirections(qualityToBeat))
+      if (( ! collapse.checkTopo()) ||
+          ( ! collapse.tryBothDirections(qualityToBeat))) {
+        rolledBack = true;
         return;
+      }
       collapse.destroyOldElements();
       ++successCount;
     }
@@ -158,6 +192,28 @@ int collapseAllEdges(Adapt* a, int modelDimension)
   return collapser.successCount;
 }
 
+/* the vertex cavities of findIndependentSet can move edges,
+   after which the marked ones are found again */
+static void gatherCollapses(Adapt* a, std::vector<Entity*>& edges)
+{
+  Mesh* m = a->mesh;
+  edges.clear();
+  Iterator* it = m->begin(1);
+  Entity* e;
+  while ((e = m->iterate(it)))
+    if (getFlag(a,e,COLLAPSE))
+      edges.push_back(e);
+  m->end(it);
+}
+
+static int collapseEdges(Adapt* a, int modelDimension,
+    std::vector<Entity*>& edges)
+{
+  AllEdgeCollapser collapser(a,modelDimension);
+  applyOperator(a,&collapser,edges);
+  return collapser.successCount;
+}
+
 class MatchedEdgeCollapser : public Operator
 {
   public:
@@ -167,6 +223,7 @@ class MatchedEdgeCollapser : public Operator
     {
       successCount = 0;
     }
+    virtual const char* getName() {return "matched collapse";}
     virtual int getTargetDimension() {return 1;}
     virtual bool shouldApply(Entity* e)
     {
@@ -188,10 +245,11 @@ class MatchedEdgeCollapser : public Operator
     {
       double qualityToBeat = getAdapt()->input->validQuality;
       collapse.setEdges();
-      if ( ! collapse.checkTopo())
-        return;
-      if ( ! collapse.tryBothDirections(qualityToBeat))
+      if (( ! collapse.checkTopo()) ||
+          ( ! collapse.tryBothDirections(qualityToBeat))) {
+        rolledBack = true;
         return;
+      }
       collapse.destroyOldElements();
       ++successCount;
     }
@@ -219,27 +277,43 @@ struct ShouldCollapse : public Predicate
   Adapt* a;
 };
 
-long markEdgesToCollapse(Adapt* a)
+long markEdgesToCollapse(Adapt* a, std::vector<Entity*>* marked)
 {
   ShouldCollapse p(a);
-  return markEntities(a, 1, p, COLLAPSE, DONT_COLLAPSE);
+  return markEntities(a, 1, p, COLLAPSE, DONT_COLLAPSE, marked);
 }
 
 bool coarsen(Adapt* a)
 {
+  PCU_Region region("ma::coarsen");
   if (!a->input->shouldCoarsen)
     return false;
   double t0 = PCU_Time();
   --(a->coarsensLeft);
-  long count = markEdgesToCollapse(a);
+  Mesh* m = a->mesh;
+  /* one worklist of the marked edges serves every model dimension,
+     since the operators keep it valid as the mesh changes and
+     skip the edges classified on other dimensions */
+  bool useWorklist = a->input->shouldUseWorklist && ( ! m->hasMatching());
+  std::vector<Entity*> edges;
+  long count = markEdgesToCollapse(a, useWorklist ? &edges : 0);
   if ( ! count)
     return false;
-  Mesh* m = a->mesh;
   int maxDimension = m->getDimension();
   PCU_ALWAYS_ASSERT(checkFlagConsistency(a,1,COLLAPSE));
   long successCount = 0;
   for (int modelDimension=1; modelDimension <= maxDimension; ++modelDimension)
   {
+    if (useWorklist)
+    {
+      checkEdgeCollapses(a, modelDimension, edges);
+      long pulls = apf::countCavityPullRounds();
+      findIndependentSet(a);
+      if (apf::countCavityPullRounds() != pulls)
+        gatherCollapses(a, edges);
+      successCount += collapseEdges(a, modelDimension, edges);
+      continue;
+    }
     checkAllEdgeCollapses(a,modelDimension);
     findIndependentSet(a);
     if (m->hasMatching())
@@ -248,6 +322,7 @@ bool coarsen(Adapt* a)
       successCount += collapseAllEdges(a, modelDimension);
   }
   successCount = PCU_Add_Long(successCount);
+  noteOperations(a, count, successCount);
   double t1 = PCU_Time();
   print("coarsened %li edges in %f seconds",successCount,t1-t0);
   return true;
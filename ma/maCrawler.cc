@@ -3,6 +3,7 @@
 #include "maAdapt.h"
 #include "maLayer.h"
 #include <apfCavityOp.h>
+#include <pcu_util.h>
 
 namespace ma {
 
@@ -56,6 +57,25 @@ void crawlLayers(Crawler* c)
   c->end();
 }
 
+void crawlStacks(Crawler* c)
+{
+  PCU_ALWAYS_ASSERT(c->stacks);
+  Mesh* m = c->mesh;
+  Crawler::Layer layer;
+  c->begin(layer);
+  while (PCU_Or( ! layer.empty())) {
+    Crawler::Layer crossing;
+    for (size_t i = 0; i < layer.size(); ++i)
+      for (Entity* e = c->crawl(layer[i]); e; e = c->crawl(e))
+        if (m->isShared(e))
+          crossing.push_back(e);
+    size_t sent = crossing.size();
+    syncLayer(c, crossing);
+    layer.assign(crossing.begin() + sent, crossing.end());
+  }
+  c->end();
+}
+
 void getDimensionBase(Adapt* a, int d, Crawler::Layer& base)
 {
   Mesh* m = a->mesh;
@@ -104,6 +124,104 @@ Entity* getOtherEdge(Mesh* m, Entity* e, Predicate& visited)
   return 0;
 }
 
+Entity* Crawler::getOther(Entity* e, Predicate& visited)
+{
+  if (stacks)
+    return stacks->getNext(e, visited);
+  if (apf::getDimension(mesh, e) == 0)
+    return getOtherVert(mesh, e, visited);
+  return getOtherEdge(mesh, e, visited);
+}
+
+/* crawls the layer once, growing a column from each
+   base entity and from each entity that arrives
+   from another part */
+struct StackBuilder : public Crawler
+{
+  StackBuilder(Adapt* a_, int d, Tag* t):
+    Crawler(a_->mesh)
+  {
+    a = a_;
+    dimension = d;
+    tag = t;
+  }
+  void start(Entity* e)
+  {
+    int column = columns.size();
+    columns.push_back(Layer(1, e));
+    mesh->setIntTag(e, tag, &column);
+  }
+  void begin(Layer& first)
+  {
+    getDimensionBase(a, dimension, first);
+    for (size_t i = 0; i < first.size(); ++i)
+      start(first[i]);
+  }
+  Entity* crawl(Entity* e)
+  {
+    HasTag p(mesh, tag);
+    Entity* oe = getOther(e, p);
+    if (!oe)
+      return 0;
+    int column;
+    mesh->getIntTag(e, tag, &column);
+    columns[column].push_back(oe);
+    mesh->setIntTag(oe, tag, &column);
+    return oe;
+  }
+  void send(Entity*, int)
+  {
+  }
+  bool recv(Entity* e, int)
+  {
+    if (mesh->hasTag(e, tag))
+      return false;
+    start(e);
+    return true;
+  }
+  Adapt* a;
+  int dimension;
+  Tag* tag;
+  std::vector<Layer> columns;
+};
+
+LayerStacks::LayerStacks(Adapt* a, int d)
+{
+  PCU_ALWAYS_ASSERT(d == 0 || d == 1);
+  mesh = a->mesh;
+  dimension = d;
+  tag = mesh->createIntTag("ma_stack", 1);
+  StackBuilder b(a, d, tag);
+  crawlLayers(&b);
+  for (size_t i = 0; i < b.columns.size(); ++i) {
+    Crawler::Layer& column = b.columns[i];
+    for (size_t j = 0; j < column.size(); ++j) {
+      int position = entities.size();
+      entities.push_back(column[j]);
+      mesh->setIntTag(column[j], tag, &position);
+    }
+    entities.push_back(0);
+  }
+}
+
+LayerStacks::~LayerStacks()
+{
+  apf::removeTagFromDimension(mesh, tag, dimension);
+  mesh->destroyTag(tag);
+}
+
+Entity* LayerStacks::getNext(Entity* e, Predicate& visited)
+{
+  if ( ! mesh->hasTag(e, tag))
+    return 0;
+  int position;
+  mesh->getIntTag(e, tag, &position);
+  Entity* next = entities[position + 1];
+  if (next && !visited(next))
+    return next;
+  return 0;
+}
+
 struct Tagger
 {
   void init(Mesh* m_, Tag* t_)
@@ -148,7 +266,7 @@ struct LayerNumberer : public Crawler
   Entity* crawl(Entity* v)
   {
     HasTag p(m, tag);
-    Entity* ov = getOtherVert(m, v, p);
+    Entity* ov = getOther(v, p);
     if (!ov)
       return 0;
     t.setNumber(ov, t.getNumber(v) + 1);
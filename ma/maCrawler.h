@@ -6,9 +6,11 @@
 
 namespace ma {
 
+struct LayerStacks;
+
 struct Crawler
 {
-  Crawler(Mesh* m):mesh(m) {}
+  Crawler(Mesh* m):mesh(m),stacks(0) {}
   virtual ~Crawler() {}
   typedef std::vector<Entity*> Layer;
   virtual void begin(Layer& first) = 0;
@@ -16,10 +18,41 @@ struct Crawler
   virtual Entity* crawl(Entity* e) = 0;
   virtual void send(Entity* e, int to) = 0;
   virtual bool recv(Entity* e, int from) = 0;
+  /* the next unvisited entity up the curve of (e),
+     read from (stacks) when they are set */
+  Entity* getOther(Entity* e, Predicate& visited);
+  Mesh* mesh;
+  LayerStacks* stacks;
+};
+
+/* the layer curves through the vertices or edges of one dimension
+   on this part, stored contiguously. each column runs up from
+   a base entity, or from where its curve enters this part,
+   and ends with a null pointer.
+   the index is built by one crawl and stays valid while the
+   layer topology and the partition don't change, so a stage
+   that crawls the same layer several times can follow the
+   columns instead of searching quads at every step. */
+struct LayerStacks
+{
+  LayerStacks(Adapt* a, int d);
+  ~LayerStacks();
+  Entity* getNext(Entity* e, Predicate& visited);
   Mesh* mesh;
+  int dimension;
+  /* position of each entity in (entities) */
+  Tag* tag;
+  std::vector<Entity*> entities;
 };
 
 void crawlLayers(Crawler* c);
+/* like crawlLayers, but each part follows its columns
+   to their ends before exchanging the shared entities,
+   so there is a message phase per part boundary along
+   a curve instead of one per layer.
+   this only suits crawlers whose information moves up the
+   curves, with recv never changing an entity already visited. */
+void crawlStacks(Crawler* c);
 void crawlLayer(Crawler* c, Crawler::Layer& layer);
 void syncLayer(Crawler* c, Crawler::Layer& layer);
 void getDimensionBase(Adapt* a, int d, Crawler::Layer& base);
@@ -17,257 +17,15 @@
 
 namespace ma {
 
-/* most of these tables are from old MeshAdapt's
-   Eswp3.cc. */
-/* they represent an encoding of all possible triangulations
-   of an N-vertex polygon, with N ranging from 3 to 7.
-   This implies that we cannot re-triangulate polygons with
-   more than 7 vertices. */
+/* a polygon of N vertices has Catalan(N-2) triangulations, which
+   old MeshAdapt listed in tables up to N=7. Instead of trying them
+   in turn, SwapCavity searches over sub-polygons: the edge between
+   loop vertices i and j can be filled if some k between them makes
+   a good triangle (i,k,j) and the edges (i,k) and (k,j) can be
+   filled in turn. Each triangle and each sub-polygon is settled at
+   most once, so the work grows as N^3 rather than Catalan(N-2). */
 
-#define MAX_VERTS 7
-
-static int triangulation_size[MAX_VERTS+1] =
-{0 //0 vertices
-,0 //1 vertices
-,0 //2 vertices
-,1 //3 vertices
-,2 //4 vertices
-,3 //5 vertices
-,4 //6 vertices
-,5 //7 vertices
-};
-
-static int triangulation_count[MAX_VERTS+1] =
-{0 //0 vertices
-,0 //1 vertices
-,0 //2 vertices
-,1 //3 vertices
-,2 //4 vertices
-,5 //5 vertices
-,14 //6 vertices
-,42 //7 vertices
-};
-
-static int unique_triangle_count[MAX_VERTS+1] =
-{0 //0 vertices
-,0 //1 vertices
-,0 //2 vertices
-,1 //3 vertices
-,4 //4 vertices
-,10 //5 vertices
-,20 //6 vertices
-,35 //7 vertices
-};
-
-static int triangles_3[1][3] = {{0,1,2}};
-static int triangulations_3[1][1] = {{0}};
-
-static int triangles_4[4][3] =
-{{0,1,2}
-,{0,2,3}
-,{0,1,3}
-,{1,2,3}
-};
-static int triangulations_4[2][2] =
-{{0,1}
-,{2,3}
-};
-
-static int triangles_5[10][3] =
-{{0,1,2}
-,{0,2,3}
-,{0,3,4}
-,{0,1,4}
-,{1,3,4}
-,{1,2,3}
-,{2,3,4}
-,{0,2,4}
-,{0,1,3}
-,{1,2,4}
-};
-static int triangulations_5[5][3] =
-{{0,1,2}
-,{3,4,5}
-,{0,6,7}
-,{2,5,8}
-,{3,6,9}
-};
-
-static int triangles_6[20][3] =
-{{0,1,2}
-,{0,2,3}
-,{0,3,4}
-,{0,4,5}
-,{0,2,5}
-,{2,4,5}
-,{2,3,4}
-,{0,3,5}
-,{3,4,5}
-,{0,2,4}
-,{2,3,5}
-,{1,2,3}
-,{0,1,3}
-,{0,1,5}
-,{1,4,5}
-,{1,3,4}
-,{0,1,4}
-,{1,3,5}
-,{1,2,4}
-,{1,2,5}
-};
-static int triangulations_6[14][4] =
-{{0,1,2,3}
-,{0,4,5,6}
-,{0,1,7,8}
-,{0,3,6,9}
-,{0,4,8,10}
-,{2,3,11,12}
-,{11,13,14,15}
-,{7,8,11,12}
-,{3,11,15,16}
-,{8,11,13,17}
-,{6,13,14,18}
-,{3,6,16,18}
-,{5,6,13,19}
-,{8,10,13,19}
-};
-
-static int triangles_7[35][3] =
-{{0,1,2}
-,{0,2,3}
-,{0,3,4}
-,{0,4,5}
-,{0,5,6}
-,{0,3,6}
-,{3,5,6}
-,{3,4,5}
-,{0,4,6}
-,{4,5,6}
-,{0,3,5}
-,{3,4,6}
-,{0,2,4}
-,{2,3,4}
-,{0,2,6}
-,{2,5,6}
-,{2,4,5}
-,{0,2,5}
-,{2,4,6}
-,{2,3,5}
-,{2,3,6}
-,{0,1,3}
-,{1,2,3}
-,{0,1,4}
-,{1,3,4}
-,{0,1,6}
-,{1,5,6}
-,{1,4,5}
-,{0,1,5}
-,{1,4,6}
-,{1,3,5}
-,{1,3,6}
-,{1,2,4}
-,{1,2,5}
-,{1,2,6}
-};
-static int triangulations_7[42][5] =
-{{0,1,2,3,4}
-,{0,1,5,6,7}
-,{0,1,2,8,9}
-,{0,1,4,7,10}
-,{0,1,5,9,11}
-,{0,3,4,12,13}
-,{0,13,14,15,16}
-,{0,8,9,12,13}
-,{0,4,13,16,17}
-,{0,9,13,14,18}
-,{0,7,14,15,19}
-,{0,4,7,17,19}
-,{0,6,7,14,20}
-,{0,9,11,14,20}
-,{2,3,4,21,22}
-,{5,6,7,21,22}
-,{2,8,9,21,22}
-,{4,7,10,21,22}
-,{5,9,11,21,22}
-,{3,4,22,23,24}
-,{22,24,25,26,27}
-,{8,9,22,23,24}
-,{4,22,24,27,28}
-,{9,22,24,25,29}
-,{7,22,25,26,30}
-,{4,7,22,28,30}
-,{6,7,22,25,31}
-,{9,11,22,25,31}
-,{3,4,13,23,32}
-,{13,25,26,27,32}
-,{8,9,13,23,32}
-,{4,13,27,28,32}
-,{9,13,25,29,32}
-,{13,16,25,26,33}
-,{4,13,16,28,33}
-,{13,15,16,25,34}
-,{9,13,18,25,34}
-,{7,19,25,26,33}
-,{4,7,19,28,33}
-,{7,15,19,25,34}
-,{6,7,20,25,34}
-,{9,11,20,25,34}
-};
-
-/* array [8] of pointer to array [3] of int */
-static int (*triangles[MAX_VERTS+1])[3] =
-{0
-,0
-,0
-,triangles_3
-,triangles_4
-,triangles_5
-,triangles_6
-,triangles_7
-};
-
-static void getTriangulation_3(int i, apf::DynamicArray<int>& t)
-{
-  for (int j=0; j < triangulation_size[3]; ++j)
-    t[j] = triangulations_3[i][j];
-}
-static void getTriangulation_4(int i, apf::DynamicArray<int>& t)
-{
-  for (int j=0; j < triangulation_size[4]; ++j)
-    t[j] = triangulations_4[i][j];
-}
-static void getTriangulation_5(int i, apf::DynamicArray<int>& t)
-{
-  for (int j=0; j < triangulation_size[5]; ++j)
-    t[j] = triangulations_5[i][j];
-}
-static void getTriangulation_6(int i, apf::DynamicArray<int>& t)
-{
-  for (int j=0; j < triangulation_size[6]; ++j)
-    t[j] = triangulations_6[i][j];
-}
-static void getTriangulation_7(int i, apf::DynamicArray<int>& t)
-{
-  for (int j=0; j < triangulation_size[7]; ++j)
-    t[j] = triangulations_7[i][j];
-}
-
-static void getTriangulation(int loopSize, int i, apf::DynamicArray<int>& t)
-{
-  PCU_ALWAYS_ASSERT(t.getSize() == static_cast<size_t>(triangulation_size[loopSize]));
-  typedef void (*GetTriangulationFunction)(int,apf::DynamicArray<int>&);
-  static GetTriangulationFunction table[MAX_VERTS+1] =
-  {0
-  ,0
-  ,0
-  ,getTriangulation_3
-  ,getTriangulation_4
-  ,getTriangulation_5
-  ,getTriangulation_6
-  ,getTriangulation_7
-  };
-  table[loopSize](i,t);
-}
+#define MAX_VERTS 10
 
 class EdgeSwap2D : public EdgeSwap
 {
@@ -562,7 +320,7 @@ class SwapLoop
     Entity* edge;
     Entity* edge_verts[2];
     int size;
-    Entity* verts[7];
+    Entity* verts[MAX_VERTS];
     Model* model;
 };
 
@@ -572,6 +330,9 @@ class SwapLoop
    and creating the first one that works */
 class SwapCavity
 {
+    enum { UNKNOWN, GOOD, BAD };
+    /* triangle (i,k,j) with i < k < j, by loop vertex */
+    struct Triangle { int v[3]; };
   public:
     void init(Adapt* a)
     {
@@ -597,11 +358,10 @@ class SwapCavity
       double quality = shape->getQuality(tet);
       return (quality > qualityToBeat);
     }
-    void getTriVerts(int tri, Entity** v)
+    void getTriVerts(Triangle const& tri, Entity** v)
     {
-      int* ti = triangles[loop.getSize()][tri];
       for (int j=0; j < 3; ++j)
-        v[j] = loop.getVert(ti[j]);
+        v[j] = loop.getVert(tri.v[j]);
     }
     Entity* buildTopTet(Entity* triv[3])
     {
@@ -627,47 +387,61 @@ class SwapCavity
       destroyElement(adapter,tet);
       return ok;
     }
-    bool checkTriangle(int i)
+    bool checkTriangle(Triangle const& tri)
     {
       Entity* tv[3];
-      getTriVerts(i,tv);
+      getTriVerts(tri,tv);
       if (findElement(mesh, apf::Mesh::TRIANGLE, tv))
         return false;
       return checkTet(true,tv) && checkTet(false,tv);
     }
-    void acceptTriangle(int unique_i, int local_i)
+    void acceptTriangle(Triangle const& tri, int local_i)
     {
       Entity* tv[3];
-      getTriVerts(unique_i,tv);
+      getTriVerts(tri,tv);
       Entity* tet = buildTopTet(tv);
       this->tets[2*local_i] = tet;
       tet = buildBottomTet(tv);
       this->tets[2*local_i+1] = tet;
     }
-    void cancelTriangle(int i)
+    bool isTriangleOk(int i, int k, int j)
     {
-      Entity* tv[3];
-      getTriVerts(i,tv);
-/* the buildElement function just retrieves existing tets */
-      destroyElement(adapter,buildTopTet(tv));
-      destroyElement(adapter,buildBottomTet(tv));
+      if (triangleState[i][k][j] == UNKNOWN)
+      { /* cache the expensive check */
+        Triangle tri = {{i,k,j}};
+        triangleState[i][k][j] = checkTriangle(tri) ? GOOD : BAD;
+      }
+      return triangleState[i][k][j] == GOOD;
     }
-    bool isTriangleOk(int i)
+/* whether the sub-polygon of loop vertices i through j
+   can be filled, remembering the apex of the triangle
+   on the edge (i,j) when it can */
+    bool canFill(int i, int j)
     {
-      if ( ! triangleChecked[i])
-      { /* cache the expensive check */
-        triangleOk[i] = checkTriangle(i);
-        triangleChecked[i] = true;
+      if (j - i < 2)
+        return true;
+      if (fillState[i][j] == UNKNOWN)
+      {
+        fillState[i][j] = BAD;
+        for (int k=i+1; k < j; ++k)
+          if (isTriangleOk(i,k,j) && canFill(i,k) && canFill(k,j))
+          {
+            fillState[i][j] = GOOD;
+            fillApex[i][j] = k;
+            break;
+          }
       }
-      return triangleOk[i];
+      return fillState[i][j] == GOOD;
     }
-    bool tryTriangulation(int i)
+    void gatherTriangles(int i, int j)
     {
-      getTriangulation(loop.getSize(),i,triangulation);
-      for (size_t i=0; i < triangulation.getSize(); ++i)
-        if ( ! isTriangleOk(triangulation[i]))
-          return false;
-      return true;
+      if (j - i < 2)
+        return;
+      int k = fillApex[i][j];
+      Triangle tri = {{i,k,j}};
+      triangulation.push_back(tri);
+      gatherTriangles(i,k);
+      gatherTriangles(k,j);
     }
     bool findGoodTriangulation(double q, Upward& ot)
     {
@@ -677,21 +451,24 @@ class SwapCavity
         return false;
       qualityToBeat = std::max(q,adapter->input->validQuality);
       oldTets = &ot;
-      int unique_count = unique_triangle_count[loop.getSize()];
-      triangleOk.setSize(unique_count);
-      triangleChecked.setSize(unique_count);
-      for (int i=0; i < unique_count; ++i)
-        triangleChecked[i] = false;
-      triangulation.setSize(triangulation_size[loop.getSize()]);
-      for (int i=0; i < triangulation_count[loop.getSize()]; ++i)
-        if (tryTriangulation(i))
-          return true;
-      return false;
+      int n = loop.getSize();
+      for (int i=0; i < n; ++i)
+      for (int j=0; j < n; ++j)
+      {
+        fillState[i][j] = UNKNOWN;
+        for (int k=0; k < n; ++k)
+          triangleState[i][k][j] = UNKNOWN;
+      }
+      triangulation.clear();
+      if ( ! canFill(0,n-1))
+        return false;
+      gatherTriangles(0,n-1);
+      return true;
     }
     void acceptTriangulation()
     {
-      tets.setSize(2*(triangulation.getSize()));
-      for (size_t i=0; i < triangulation.getSize(); ++i)
+      tets.setSize(2*(triangulation.size()));
+      for (size_t i=0; i < triangulation.size(); ++i)
         acceptTriangle(triangulation[i],i);
     }
     EntityArray& getNewTets() {return tets;}
@@ -700,9 +477,10 @@ class SwapCavity
     ShapeHandler* shape;
     Mesh* mesh;
     SwapLoop loop;
-    apf::DynamicArray<int> triangleOk;
-    apf::DynamicArray<int> triangleChecked;
-    apf::DynamicArray<int> triangulation;
+    unsigned char triangleState[MAX_VERTS][MAX_VERTS][MAX_VERTS];
+    unsigned char fillState[MAX_VERTS][MAX_VERTS];
+    int fillApex[MAX_VERTS][MAX_VERTS];
+    std::vector<Triangle> triangulation;
     EntityArray tets;
     double qualityToBeat;
     Cavity tempTet;
@@ -4,6 +4,7 @@
 #include <PCU.h>
 
 #include <pcu_util.h>
+#include <algorithm>
 #include <sstream>
 #include <cstdlib>
 
@@ -15,10 +16,34 @@ typedef std::set<Model*> ModelSet;
 
 typedef std::vector<Crawler::Layer> Layers;
 
-typedef std::vector<double> LayerFieldData;
-typedef std::vector<LayerFieldData> FieldData;
 typedef std::vector<apf::Field*> Fields;
 
+/* the values of a field at every vertex of every layer in one
+   array, ordered by layer, then by vertex, then by component */
+struct FieldData {
+  FieldData():
+    nlayers(0),
+    nverts(0),
+    ncomps(0)
+  {}
+  FieldData(size_t l, size_t v, int c):
+    nlayers(l),
+    nverts(v),
+    ncomps(c),
+    values(l * v * c)
+  {}
+  double* at(size_t layer, size_t vert) {
+    return &values[(layer * nverts + vert) * ncomps];
+  }
+  double const* at(size_t layer, size_t vert) const {
+    return &values[(layer * nverts + vert) * ncomps];
+  }
+  size_t nlayers;
+  size_t nverts;
+  int ncomps;
+  std::vector<double> values;
+};
+
 struct AllFieldsData {
   std::vector<FieldData> flat_data;
   FieldData flat_z_data;
@@ -63,17 +88,11 @@ struct ZDataGetter : public DataGetter {
 
 FieldData gatherExtrudedFieldData(DataGetter const& getter,
     Layers const& layers) {
-  int ncomps = getter.ncomps();
-  FieldData data;
+  FieldData data(layers.size(), layers[0].size(), getter.ncomps());
   for (size_t l = 0; l < layers.size(); ++l) {
     Crawler::Layer const& layer = layers[l];
-    data.push_back(LayerFieldData());
-    LayerFieldData& layer_data = data.back();
-    layer_data.resize(layer.size() * ncomps);
-    for (size_t i = 0; i < layer.size(); ++i) {
-      Entity* e = layer[i];
-      getter.get(e, &layer_data[i * ncomps]);
-    }
+    for (size_t i = 0; i < layer.size(); ++i)
+      getter.get(layer[i], data.at(l, i));
   }
   return data;
 }
@@ -182,18 +201,17 @@ std::string getExtrudedName(std::string const& flat_name) {
 }
 
 void applyFlatField(Mesh* m, std::string const& extruded_name,
-    int ncomps, int value_type, apf::FieldShape* shape,
+    int value_type, apf::FieldShape* shape,
     FieldData const& field_data) {
-  for (size_t i = 0; i < field_data.size(); ++i) {
+  for (size_t i = 0; i < field_data.nlayers; ++i) {
     std::string flat_name = getFlatName(extruded_name, i);
     apf::Field* flat_field = apf::createGeneralField(
-        m, flat_name.c_str(), value_type, ncomps, shape);
-    LayerFieldData const& layer_data = field_data[i];
+        m, flat_name.c_str(), value_type, field_data.ncomps, shape);
     Iterator* it = m->begin(0);
     Entity* v;
     size_t k = 0;
     while ((v = m->iterate(it))) {
-      apf::setComponents(flat_field, v, 0, &layer_data[k * ncomps]);
+      apf::setComponents(flat_field, v, 0, field_data.at(i, k));
       ++k;
     }
     m->end(it);
@@ -205,14 +223,13 @@ void applyFlatFields(Mesh* m, Fields const& extruded_fields,
   for (size_t i = 0; i < extruded_fields.size(); ++i) {
     apf::Field* extruded_field = extruded_fields[i];
     std::string extruded_name = apf::getName(extruded_field);
-    int ncomps = apf::countComponents(extruded_field);
     int value_type = apf::getValueType(extruded_field);
     apf::FieldShape* shape = apf::getShape(extruded_field);
     apf::destroyField(extruded_field);
     FieldData const& field_data = all_data.flat_data[i];
-    applyFlatField(m, extruded_name, ncomps, value_type, shape, field_data);
+    applyFlatField(m, extruded_name, value_type, shape, field_data);
   }
-  applyFlatField(m, "z", 1, apf::PACKED, m->getShape(), all_data.flat_z_data);
+  applyFlatField(m, "z", apf::PACKED, m->getShape(), all_data.flat_z_data);
 }
 
 void zeroOutZCoords(Mesh* m) {
@@ -259,162 +276,201 @@ FullLayer getFullFlatLayer(Mesh* m) {
   return full_layer;
 }
 
-ModelExtrusion getLocalClass(Mesh* m, Entity* prev_ent,
-    ModelExtrusions const& extrusions, bool is_last) {
-  ModelExtrusion out;
-  out.bottom = m->toModel(prev_ent);
+/* the extrusion a base entity follows, found once
+   for all the layers above it */
+ModelExtrusion const& getExtrusion(Mesh* m, Entity* base_ent,
+    ModelExtrusions const& extrusions) {
+  Model* bottom = m->toModel(base_ent);
   for (size_t j = 0; j < extrusions.size(); ++j) {
     ModelExtrusion const& match = extrusions[j];
-    if (out.bottom == match.bottom ||
-        out.bottom == match.middle) {
-      out.middle = match.middle;
-      if (is_last) out.top = match.top;
-      else out.top = match.middle;
-      return out;
-    }
+    if (bottom == match.bottom ||
+        bottom == match.middle)
+      return match;
   }
   abort();
-  return ModelExtrusion();
+  return extrusions[0];
 }
 
-class DebugBuildCallback : public apf::BuildCallback {
-  Mesh* mesh;
-  int expected_type_;
-
+/* The extruded mesh is laid out arithmetically: entity i of base
+   dimension d in layer l is horizontal[d][l * n[d] + i], and the
+   entity swept by it between layers l and l + 1 is
+   vertical[d][l * n[d] + i]. With the base connectivity in indices,
+   every entity is made from its downward entities directly,
+   without searching for them. */
+class LayerBuilder {
   public:
-    DebugBuildCallback(Mesh* m, int expected_type):
+    LayerBuilder(Mesh* m, FullLayer const& base,
+        ModelExtrusions const& extrusions, size_t num_layers):
       mesh(m),
-      expected_type_(expected_type)
-    {}
-    virtual void call(Entity* e) {
-      PCU_ALWAYS_ASSERT(mesh->getType(e) == expected_type_);
+      nlayers(num_layers)
+    {
+      PCU_ALWAYS_ASSERT(nlayers > 0);
+      indices = m->createIntTag("index", 1);
+      for (int d = 0; d < 3; ++d) {
+        Crawler::Layer const& ents = base.ents[d];
+        n[d] = ents.size();
+        horizontal[d].resize(nlayers * n[d]);
+        std::copy(ents.begin(), ents.end(), horizontal[d].begin());
+        vertical[d].resize((nlayers - 1) * n[d]);
+        classes[d].reserve(n[d]);
+        for (size_t i = 0; i < n[d]; ++i) {
+          int i_int = int(i);
+          m->setIntTag(ents[i], indices, &i_int);
+          classes[d].push_back(&getExtrusion(m, ents[i], extrusions));
+        }
+      }
+      for (int d = 1; d < 3; ++d) {
+        down[d].resize(n[d] * (d + 1));
+        for (size_t i = 0; i < n[d]; ++i) {
+          Downward de;
+          m->getDownward(base.ents[d][i], d - 1, de);
+          for (int j = 0; j <= d; ++j)
+            m->getIntTag(de[j], indices, &down[d][i * (d + 1) + j]);
+        }
+      }
+      for (size_t i = 0; i < n[2]; ++i)
+        PCU_ALWAYS_ASSERT(m->getModelType(classes[2][i]->middle) == 3);
     }
-};
-
-void stitchVerts(Mesh* m, Crawler::Layer const& prev_verts,
-    Crawler::Layer const& next_verts, Tag* indices) {
-  PCU_Comm_Begin();
-  PCU_ALWAYS_ASSERT(prev_verts.size() == next_verts.size());
-  for (size_t i = 0; i < prev_verts.size(); ++i) {
-    Entity* prev_vert = prev_verts[i];
-    Entity* next_vert = next_verts[i];
-    Remotes remotes;
-    m->getRemotes(prev_vert, remotes);
-    APF_ITERATE(Remotes, remotes, rit) {
-      int remote_part = rit->first;
-      Entity* remote_prev_vert = rit->second;
-      PCU_COMM_PACK(remote_part, remote_prev_vert);
-      PCU_COMM_PACK(remote_part, next_vert);
+    ~LayerBuilder() {
+      mesh->destroyTag(indices);
     }
-  }
-  PCU_Comm_Send();
-  while (PCU_Comm_Receive()) {
-    int remote_part = PCU_Comm_Sender();
-    Entity* prev_vert;
-    Entity* remote_next_vert;
-    PCU_COMM_UNPACK(prev_vert);
-    PCU_COMM_UNPACK(remote_next_vert);
-    int prev_idx;
-    m->getIntTag(prev_vert, indices, &prev_idx);
-    Entity* next_vert = next_verts.at(prev_idx);
-    m->addRemote(next_vert, remote_part, remote_next_vert);
-  }
-}
-
-FullLayer buildLayer(Mesh* m, FullLayer const& prev_layer,
-    ModelExtrusions const& extrusions, bool is_last) {
-  Crawler::Layer const& prev_verts = prev_layer.ents[0];
-  Tag* indices = m->createIntTag("index", 1);
-  for (size_t i = 0; i < prev_verts.size(); ++i) {
-    int i_int = int(i);
-    m->setIntTag(prev_verts[i], indices, &i_int);
-  }
-  FullLayer next_layer;
-  for (size_t i = 0; i < prev_verts.size(); ++i) {
-    Entity* ev[2];
-    ev[0] = prev_verts[i];
-    ModelExtrusion local_class = getLocalClass(m, ev[0], extrusions, is_last);
-    ev[1] = m->createVert(local_class.top);
-    Vector x;
-    m->getPoint(ev[0], 0, x);
-    m->setPoint(ev[1], 0, x);
-    m->createEntity(apf::Mesh::EDGE, local_class.middle, ev);
-    next_layer.ents[0].push_back(ev[1]);
-  }
-  for (size_t i = 0; i < prev_layer.ents[1].size(); ++i) {
-    Entity* pe = prev_layer.ents[1][i];
-    PCU_ALWAYS_ASSERT(m->getType(pe) == apf::Mesh::EDGE);
-    ModelExtrusion local_class = getLocalClass(m, pe, extrusions, is_last);
-    Entity* pev[2];
-    m->getDownward(pe, 0, pev);
-    Entity* nev[2];
-    for (int j = 0; j < 2; ++j) {
-      int vindex;
-      m->getIntTag(pev[j], indices, &vindex);
-      nev[j] = next_layer.ents[0][vindex];
+    void run() {
+      size_t nnew = nlayers - 1;
+      mesh->reserve(apf::Mesh::VERTEX, nnew * n[0]);
+      mesh->reserve(apf::Mesh::EDGE, nnew * (n[0] + n[1]));
+      mesh->reserve(apf::Mesh::TRIANGLE, nnew * n[2]);
+      mesh->reserve(apf::Mesh::QUAD, nnew * n[1]);
+      mesh->reserve(apf::Mesh::PRISM, nnew * n[2]);
+      for (size_t l = 1; l < nlayers; ++l) {
+        buildVerts(l);
+        buildEdges(l);
+        buildTriangles(l);
+      }
+      stitchVerts();
     }
-    DebugBuildCallback ecb(m, apf::Mesh::EDGE);
-    Entity* ne = apf::buildElement(m, local_class.top, apf::Mesh::EDGE, nev, &ecb);
-    Entity* qv[4] = {pev[0], pev[1], nev[1], nev[0]};
-    DebugBuildCallback qcb(m, apf::Mesh::QUAD);
-    apf::buildElement(m, local_class.middle, apf::Mesh::QUAD, qv, &qcb);
-    next_layer.ents[1].push_back(ne);
-  }
-  for (size_t i = 0; i < prev_layer.ents[2].size(); ++i) {
-    Entity* pt = prev_layer.ents[2][i];
-    ModelExtrusion local_class = getLocalClass(m, pt, extrusions, is_last);
-    PCU_ALWAYS_ASSERT(m->getModelType(local_class.middle) == 3);
-    Entity* ptv[3];
-    m->getDownward(pt, 0, ptv);
-    Entity* ntv[3];
-    for (int j = 0; j < 3; ++j) {
-      int vindex;
-      m->getIntTag(ptv[j], indices, &vindex);
-      ntv[j] = next_layer.ents[0][vindex];
+    Crawler::Layer const& getVerts() {
+      return horizontal[0];
     }
-    DebugBuildCallback tcb(m, apf::Mesh::TRIANGLE);
-    Entity* nt =
-      apf::buildElement(m, local_class.top, apf::Mesh::TRIANGLE, ntv, &tcb);
-    Entity* wv[6] = {ptv[0], ptv[1], ptv[2], ntv[0], ntv[1], ntv[2]};
-    DebugBuildCallback wcb(m, apf::Mesh::PRISM);
-    apf::buildElement(m, local_class.middle, apf::Mesh::PRISM, wv, &wcb);
-    next_layer.ents[2].push_back(nt);
-  }
-  stitchVerts(m, prev_layer.ents[0], next_layer.ents[0], indices);
-  m->destroyTag(indices);
-  return next_layer;
-}
+  private:
+    Model* getClass(int d, size_t i, size_t l) {
+      ModelExtrusion const& c = *classes[d][i];
+      return l == nlayers - 1 ? c.top : c.middle;
+    }
+    void buildVerts(size_t l) {
+      for (size_t i = 0; i < n[0]; ++i) {
+        Entity* ev[2];
+        ev[0] = horizontal[0][(l - 1) * n[0] + i];
+        ev[1] = mesh->createVert(getClass(0, i, l));
+        Vector x;
+        mesh->getPoint(ev[0], 0, x);
+        mesh->setPoint(ev[1], 0, x);
+        horizontal[0][l * n[0] + i] = ev[1];
+        vertical[0][(l - 1) * n[0] + i] = mesh->createEntity(
+            apf::Mesh::EDGE, classes[0][i]->middle, ev);
+      }
+    }
+    /* the quad has vertices {pev[0], pev[1], nev[1], nev[0]} */
+    void buildEdges(size_t l) {
+      for (size_t i = 0; i < n[1]; ++i) {
+        int const* ev = &down[1][i * 2];
+        Entity* nev[2];
+        for (int j = 0; j < 2; ++j)
+          nev[j] = horizontal[0][l * n[0] + ev[j]];
+        Entity* ne = mesh->createEntity(
+            apf::Mesh::EDGE, getClass(1, i, l), nev);
+        horizontal[1][l * n[1] + i] = ne;
+        Entity* qe[4];
+        qe[0] = horizontal[1][(l - 1) * n[1] + i];
+        qe[1] = vertical[0][(l - 1) * n[0] + ev[1]];
+        qe[2] = ne;
+        qe[3] = vertical[0][(l - 1) * n[0] + ev[0]];
+        vertical[1][(l - 1) * n[1] + i] = mesh->createEntity(
+            apf::Mesh::QUAD, classes[1][i]->middle, qe);
+      }
+    }
+    /* the prism faces follow apf::prism_tri_verts and
+       apf::prism_quad_verts: the quad on triangle edge j
+       is the one swept by that edge */
+    void buildTriangles(size_t l) {
+      for (size_t i = 0; i < n[2]; ++i) {
+        int const* te = &down[2][i * 3];
+        Entity* nte[3];
+        for (int j = 0; j < 3; ++j)
+          nte[j] = horizontal[1][l * n[1] + te[j]];
+        Entity* nt = mesh->createEntity(
+            apf::Mesh::TRIANGLE, getClass(2, i, l), nte);
+        horizontal[2][l * n[2] + i] = nt;
+        Entity* wf[5];
+        wf[0] = horizontal[2][(l - 1) * n[2] + i];
+        for (int j = 0; j < 3; ++j)
+          wf[j + 1] = vertical[1][(l - 1) * n[1] + te[j]];
+        wf[4] = nt;
+        vertical[2][(l - 1) * n[2] + i] = mesh->createEntity(
+            apf::Mesh::PRISM, classes[2][i]->middle, wf);
+      }
+    }
+    /* one exchange for all layers: each copy of a base vertex
+       sends the column of vertices built above it */
+    void stitchVerts() {
+      PCU_Comm_Begin();
+      for (size_t i = 0; i < n[0]; ++i) {
+        Remotes remotes;
+        mesh->getRemotes(horizontal[0][i], remotes);
+        APF_ITERATE(Remotes, remotes, rit) {
+          int remote_part = rit->first;
+          PCU_COMM_PACK(remote_part, rit->second);
+          for (size_t l = 1; l < nlayers; ++l)
+            PCU_COMM_PACK(remote_part, horizontal[0][l * n[0] + i]);
+        }
+      }
+      PCU_Comm_Send();
+      while (PCU_Comm_Receive()) {
+        int remote_part = PCU_Comm_Sender();
+        Entity* base_vert;
+        PCU_COMM_UNPACK(base_vert);
+        int i;
+        mesh->getIntTag(base_vert, indices, &i);
+        for (size_t l = 1; l < nlayers; ++l) {
+          Entity* remote_vert;
+          PCU_COMM_UNPACK(remote_vert);
+          mesh->addRemote(horizontal[0][l * n[0] + i],
+              remote_part, remote_vert);
+        }
+      }
+    }
+    Mesh* mesh;
+    size_t nlayers;
+    size_t n[3];
+    Tag* indices;
+    std::vector<ModelExtrusion const*> classes[3];
+    /* base vertices of edges, base edges of triangles */
+    std::vector<int> down[3];
+    std::vector<Entity*> horizontal[3];
+    std::vector<Entity*> vertical[3];
+};
 
-Layers buildLayers(Mesh* m, ModelExtrusions const& extrusions, size_t nlayers,
-    FullLayer const& base_layer) {
-  Layers out_layers;
+Crawler::Layer buildLayers(Mesh* m, ModelExtrusions const& extrusions,
+    size_t nlayers, FullLayer const& base_layer) {
   apf::changeMdsDimension(m, 3);
-  FullLayer prev_layer = base_layer;
-  out_layers.push_back(prev_layer.ents[0]);
-  for (size_t i = 1; i < nlayers; ++i) {
-    bool is_last = (i == (nlayers - 1));
-    prev_layer = buildLayer(m, prev_layer, extrusions, is_last);
-    out_layers.push_back(prev_layer.ents[0]);
-  }
+  LayerBuilder builder(m, base_layer, extrusions, nlayers);
+  builder.run();
+  Crawler::Layer verts = builder.getVerts();
   apf::stitchMesh(m);
   m->acceptChanges();
   apf::alignMdsRemotes(m);
-  return out_layers;
+  return verts;
 }
 
 FieldData gatherFlatFieldData(Mesh* m, std::string const& extruded_name,
     int ncomps, Crawler::Layer const& base_verts, size_t nlayers) {
-  FieldData field_data;
+  FieldData field_data(nlayers, base_verts.size(), ncomps);
   for (size_t i = 0; i < nlayers; ++i) {
     std::string flat_name = getFlatName(extruded_name, i);
     apf::Field* flat_field = m->findField(flat_name.c_str());
     PCU_ALWAYS_ASSERT(flat_field);
-    LayerFieldData layer_data(base_verts.size() * ncomps);
-    for (size_t j = 0; j < base_verts.size(); ++j) {
-      apf::getComponents(flat_field, base_verts[j], 0, &layer_data[j * ncomps]);
-    }
+    for (size_t j = 0; j < base_verts.size(); ++j)
+      apf::getComponents(flat_field, base_verts[j], 0, field_data.at(i, j));
     if (i != 0) apf::destroyField(flat_field);
-    field_data.push_back(layer_data);
   }
   return field_data;
 }
@@ -461,20 +517,18 @@ struct ZDataSetter : public DataSetter {
   virtual int ncomps() const { return 1; }
 };
 
+/* the vertices are laid out like the data, layer by layer */
 void applyExtrudedData(DataSetter const& setter,
-    FieldData const& field_data, Layers const& layers) {
-  int ncomps = setter.ncomps();
-  for (size_t i = 0; i < layers.size(); ++i) {
-    Crawler::Layer const& layer_verts = layers[i];
-    LayerFieldData const& layer_data = field_data[i];
-    for (size_t j = 0; j < layer_verts.size(); ++j) {
-      setter.set(layer_verts[j], &layer_data[j * ncomps]);
-    }
-  }
+    FieldData const& field_data, Crawler::Layer const& verts) {
+  PCU_ALWAYS_ASSERT(setter.ncomps() == field_data.ncomps);
+  PCU_ALWAYS_ASSERT(verts.size() == field_data.nlayers * field_data.nverts);
+  for (size_t i = 0; i < field_data.nlayers; ++i)
+    for (size_t j = 0; j < field_data.nverts; ++j)
+      setter.set(verts[i * field_data.nverts + j], field_data.at(i, j));
 }
 
 void applyExtrudedFields(Mesh* m, Fields const& base_fields,
-    AllFieldsData const& all_data, Layers const& layers) {
+    AllFieldsData const& all_data, Crawler::Layer const& verts) {
   size_t j = 0;
   for (size_t i = 0; i < base_fields.size(); ++i) {
     apf::Field* base_field = base_fields[i];
@@ -483,7 +537,7 @@ void applyExtrudedFields(Mesh* m, Fields const& base_fields,
     if (extruded_name == "z") {
       ZDataSetter setter(m);
       FieldData const& field_data = all_data.flat_z_data;
-      applyExtrudedData(setter, field_data, layers);
+      applyExtrudedData(setter, field_data, verts);
     } else {
       int ncomps = apf::countComponents(base_field);
       int value_type = apf::getValueType(base_field);
@@ -492,7 +546,7 @@ void applyExtrudedFields(Mesh* m, Fields const& base_fields,
           m, extruded_name.c_str(), value_type, ncomps, shape);
       FieldDataSetter setter(extruded_field);
       FieldData const& field_data = all_data.flat_data[j];
-      applyExtrudedData(setter, field_data, layers);
+      applyExtrudedData(setter, field_data, verts);
       ++j;
     }
     apf::destroyField(base_field);
@@ -530,8 +584,9 @@ void extrude(Mesh* m, ModelExtrusions const& model_extrusions,
   Crawler::Layer const& base_verts = base_layer.ents[0];
   AllFieldsData all_data = gatherFlatFieldsData(m, base_fields,
       base_verts, num_layers);
-  Layers layers = buildLayers(m, model_extrusions, num_layers, base_layer);
-  applyExtrudedFields(m, base_fields, all_data, layers);
+  Crawler::Layer verts = buildLayers(m, model_extrusions, num_layers,
+      base_layer);
+  applyExtrudedFields(m, base_fields, all_data, verts);
 }
 
 } // end namespac ma
@@ -175,7 +175,10 @@ Entity* makeSplitVertOnFace(Adapt* a, Entity* face)
   if (a->input->shouldTransferToClosestPoint)
     transferToClosestPointOnTriSplit(m, face, xi, param);
   Entity* vert = buildVertex(a, c, point, param);
-  st->onVertex(me, xi, vert);
+  Entity* fv[3];
+  m->getDownward(face, 0, fv);
+  double const weights[3] = {1.0/3.0, 1.0/3.0, 1.0/3.0};
+  st->onBarycentricVertex(me, xi, 3, fv, weights, vert);
   sf->interpolate(me, xi, vert);
   apf::destroyMeshElement(me);
   return vert;
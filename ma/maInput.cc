@@ -27,14 +27,21 @@ void setDefaultValues(Input* in)
 {
   in->ownsSizeField = true;
   in->maximumIterations = 3;
+  in->firstIteration = 0;
+  in->convergedEdgeFraction = 0;
+  in->convergedOperationCount = 0;
+  in->refineBatchSize = 0;
   in->shouldCoarsen = true;
   in->shouldSnap = in->mesh->canSnap();
   in->shouldTransferParametric = in->mesh->canSnap();
   in->shouldTransferToClosestPoint = false;
   in->shouldHandleMatching = in->mesh->hasMatching();
+  in->shouldColocateMatches = false;
   in->shouldFixShape = true;
   in->shouldForceAdaptation = false;
   in->shouldPrintQuality = true;
+  in->shouldPrintReport = false;
+  in->shouldUseWorklist = false;
   if (in->mesh->getDimension()==3)
   {
     in->goodQuality = 0.027;
@@ -56,17 +63,26 @@ void setDefaultValues(Input* in)
   in->shouldRunPreZoltan = false;
   in->shouldRunPreZoltanRib = false;
   in->shouldRunPreParma = false;
+  in->shouldRunPreHilbert = false;
   in->shouldRunMidZoltan = false;
   in->shouldRunMidParma = false;
+  in->shouldRunMidHilbert = false;
+  in->shouldBalanceForRefinement = false;
+  in->shouldSpreadBadElements = false;
   in->shouldRunPostZoltan = false;
   in->shouldRunPostZoltanRib = false;
   in->shouldRunPostParma = false;
+  in->shouldRunPostHilbert = false;
   in->shouldTurnLayerToTets = false;
   in->shouldCleanupLayer = false;
   in->shouldRefineLayer = false;
   in->shouldCoarsenLayer = false;
   in->splitAllLayerEdges = false;
   in->shapeHandler = 0;
+  in->checkpointPrefix = 0;
+  in->profile = 0;
+  in->tracer = 0;
+  in->shouldBeDeterministic = false;
 }
 
 void rejectInput(const char* str)
@@ -86,6 +102,13 @@ void validateInput(Input* in)
     rejectInput("negative maximum iteration count");
   if (in->maximumIterations > 10)
     rejectInput("unusually high maximum iteration count");
+  if (in->firstIteration < 0 ||
+      in->firstIteration > in->maximumIterations)
+    rejectInput("first iteration outside [0,maximum iterations]");
+  if (in->convergedEdgeFraction < 0.0 || in->convergedEdgeFraction > 1.0)
+    rejectInput("converged edge fraction outside [0,1]");
+  if (in->convergedOperationCount < 0)
+    rejectInput("negative converged operation count");
   if (in->shouldSnap
     &&( ! in->mesh->canSnap()))
     rejectInput("user requested snapping "
@@ -134,10 +157,23 @@ void setSolutionTransfer(Input* in, SolutionTransfer* s)
   }
 }
 
+/* a mesh resumed from a checkpoint carries the fields of the size
+   field it was adapting with, which are made again after this */
+static void forgetSizeFields(Mesh* m)
+{
+  const char* names[3] = {"ma_sizes", "ma_frame", "ma_logM"};
+  for (int i = 0; i < 3; ++i) {
+    apf::Field* f = m->findField(names[i]);
+    if (f)
+      apf::destroyField(f);
+  }
+}
+
 Input* configure(
     Mesh* m,
     SolutionTransfer* s)
 {
+  forgetSizeFields(m);
   Input* in = new Input;
   in->mesh = m;
   setDefaultValues(in);
@@ -186,10 +222,11 @@ Input* configure(
     apf::Field* sizes,
     apf::Field* frames,
     SolutionTransfer* s,
-    bool logInterpolation)
+    bool logInterpolation,
+    int threads)
 {
   Input* in = configure(m,s);
-  in->sizeField = makeSizeField(m, sizes, frames, logInterpolation);
+  in->sizeField = makeSizeField(m, sizes, frames, logInterpolation, threads);
   return in;
 }
 
@@ -27,6 +27,8 @@ namespace ma {
 
 class ShapeHandler;
 class Adapt;
+struct Profile;
+class Tracer;
 
 typedef ShapeHandler* (*ShapeHandlerFunction)(Adapt* a);
 
@@ -43,6 +45,24 @@ class Input
     ShapeHandlerFunction shapeHandler;
 /** \brief number of refine/coarsen iterations to run (default 3) */
     int maximumIterations;
+/** \brief the iteration to start from when resuming from a checkpoint
+   (default 0), see checkpointPrefix */
+    int firstIteration;
+/** \brief stop iterating once fewer than this fraction of the edges
+   have a metric length outside [1/sqrt(2), sqrt(2)] (default 0, off)
+   \details the check measures every edge once per iteration */
+    double convergedEdgeFraction;
+/** \brief stop iterating once an iteration succeeds at fewer than this
+   many operations, counting collapses, splits and snaps (default 0, off) */
+    long convergedOperationCount;
+/** \brief if positive, refinement splits, transfers and destroys the
+   elements of the mesh dimension this many at a time (default 0)
+   \details this bounds the old elements that live next to their
+   replacements, which dominate the memory of a uniform refinement.
+   The new vertices, edges and faces are still made all at once.
+   Tetrahedronization of the layer follows the same setting, so 1
+   converts the prisms and pyramids one by one. */
+    long refineBatchSize;
 /** \brief whether to perform the collapse step */
     bool shouldCoarsen;
 /** \brief whether to snap new vertices to the model surface
@@ -56,12 +76,31 @@ class Input
     bool shouldTransferToClosestPoint;
 /** \brief whether to update matched entity info (limited support) */
     bool shouldHandleMatching;
+/** \brief whether balancing moves the elements around matched vertices
+   to the part of their matches (default false)
+   \details runs after the pre-balancers and after the mid-balancers,
+   which ignore matching. Matched collapses and snaps then find most
+   matches local instead of pulling cavities across parts. Skipped
+   if it would empty a part. */
+    bool shouldColocateMatches;
 /** \brief whether to run shape correction (default true) */
     bool shouldFixShape;
 /** \brief whether to adapt if it makes local quality worse (default false) */
     bool shouldForceAdaptation;
+/** \brief whether coarsening and shape correction visit only the
+   entities they marked instead of sweeping the mesh (default false)
+   \details the marking still visits every entity not known
+   to be fine, but the collapse and shape operators that follow
+   iterate over the marked list. Ignored for matched meshes. */
+    bool shouldUseWorklist;
 /** \brief whether to print the worst shape quality */
     bool shouldPrintQuality;
+/** \brief whether to print the edge length and quality report of
+   ma::printReport after every iteration and in place of the worst
+   quality (default false)
+   \details the report takes one sweep and one exchange, cheap
+   enough for production runs. */
+    bool shouldPrintReport;
 /** \brief minimum desired mean ratio cubed for simplex elements
    \details a different measure is used for curved elements */
     double goodQuality;
@@ -80,16 +119,41 @@ class Input
     bool shouldRunPreZoltanRib;
 /** \brief whether to run parma predictive load balancing (default false) */
     bool shouldRunPreParma;
+/** \brief whether to repartition along a Hilbert curve before adapting
+   (default false)
+   \details a geometric repartition like zoltan RIB that does not need
+   zoltan, see Parma_MakeHilbertBalancer */
+    bool shouldRunPreHilbert;
 /** \brief whether to run zoltan during adaptation (default false) */
     bool shouldRunMidZoltan;
 /** \brief whether to run parma during adaptation (default false)*/
     bool shouldRunMidParma;
+/** \brief whether to repartition along a Hilbert curve during adaptation
+   (default false) */
+    bool shouldRunMidHilbert;
+/** \brief whether balancing during adaptation weighs elements by
+   what the next refinement makes of them (default false)
+   \details the edges to split are marked as refinement would mark
+   them, and each simplex weighs the element count of its split
+   template. Other elements, and meshes with boundary layers,
+   keep the size field weights. */
+    bool shouldBalanceForRefinement;
+/** \brief whether each shape correction pass first sends bad elements
+   to neighbor parts with fewer of them (default false)
+   \details bad elements tend to cluster on a few parts, which then
+   do all the fixing while the others wait. Each pass takes one
+   diffusion step: the elements around a bad element on the part
+   boundary move to a neighbor below the local average count. */
+    bool shouldSpreadBadElements;
 /** \brief whether to run zoltan after adapting (default false) */
     bool shouldRunPostZoltan;
 /** \brief whether to run zoltan RIB after adapting (default false) */
     bool shouldRunPostZoltanRib;
 /** \brief whether to run parma after adapting (default false) */
     bool shouldRunPostParma;
+/** \brief whether to repartition along a Hilbert curve after adapting
+   (default false) */
+    bool shouldRunPostHilbert;
 /** \brief the ratio between longest and shortest edges that differentiates a
    "short edge" element from a "large angle" element. */
     double maximumEdgeRatio;
@@ -105,6 +169,30 @@ class Input
     bool splitAllLayerEdges;
 /** \brief this a folder that debugging meshes will be written to, if provided! */
     const char* debugFolder;
+/** \brief if set, the mesh is written after each iteration (i) to
+   (checkpointPrefix)(i).smb (default 0, no checkpoints)
+   \details the files hold the fields, including field size fields and
+   the transferred solution, and the ma flags. Each part writes its own
+   file. To resume, load the last such mesh, configure it as before
+   and set firstIteration to (i+1). */
+    const char* checkpointPrefix;
+/** \brief if non-zero, ma::adapt adds a ma::StageProfile here
+   for each stage it runs (default 0). It is not deleted by adapt. */
+    Profile* profile;
+/** \brief if non-zero, receives what each ma::Operator did and is
+   finished at the end of ma::adapt (default 0). It is not deleted
+   by adapt. See ma::TraceSummary. */
+    Tracer* tracer;
+/** \brief whether operators visit entities in a repeatable order
+   (default false)
+   \details operators and the collapse independent set go over their
+   entities sorted by vertex coordinates instead of part-local mesh
+   order, and PCU message ordering is kept on during adapt, so reruns
+   with the same partition give the same mesh even if its entities
+   were created in another order. Results still depend on where part
+   boundaries fall, so runs on different numbers of ranks may differ.
+   This costs a sort of each worklist. */
+    bool shouldBeDeterministic;
 };
 
 /** \brief generate a configuration based on an anisotropic function.
@@ -130,13 +218,16 @@ Input* configure(
                for each vertex
  \param s if non-zero, use that to transfer all fields. otherwise,
           transfer any associated fields with default algorithms
- \param logInterpolation if true uses logarithmic interpolation */
+ \param logInterpolation if true uses logarithmic interpolation
+ \param threads the number of threads computing the log metrics
+                at the vertices, see ma::makeSizeField */
 Input* configure(
     Mesh* m,
     apf::Field* sizes,
     apf::Field* frames,
     SolutionTransfer* s=0,
-    bool logInterpolation=true);
+    bool logInterpolation=true,
+    int threads=1);
 /** \brief generate a configuration based on an isotropic field
  \param size a scalar field of desired element size
  \param s if non-zero, use that to transfer all fields. otherwise,
@@ -278,6 +278,8 @@ bool coarsenLayer(Adapt* a)
     findIndependentSet(a);
     successCount += collapseAllStacks(a, d);
   }
+  successCount = PCU_Add_Long(successCount);
+  noteOperations(a, count, successCount);
   double t1 = PCU_Time();
   print("coarsened %li layer edges in %f seconds",successCount,t1-t0);
   resetLayer(a);
@@ -35,7 +35,7 @@ struct SnapTagger : public Crawler
   Entity* crawl(Entity* v)
   {
     HasFlag p(a, CHECKED);
-    Entity* ov = getOtherVert(m, v, p);
+    Entity* ov = getOther(v, p);
     if (!ov)
       return 0;
     setFlag(a, ov, CHECKED);
@@ -84,10 +84,11 @@ struct SnapTagger : public Crawler
   Tag* snapTag;
 };
 
-static void tagLayerForSnap(Adapt* a, Tag* snapTag)
+static void tagLayerForSnap(Adapt* a, Tag* snapTag, LayerStacks* s)
 {
   SnapTagger op(a, snapTag);
-  crawlLayers(&op);
+  op.stacks = s;
+  crawlStacks(&op);
 }
 
 /* this class tags each layer vertex
@@ -148,7 +149,7 @@ struct BaseTopLinker : public Crawler
   Entity* crawl(Entity* v)
   {
     HasTag p(m, linkTag);
-    Entity* ov = getOtherVert(m, v, p);
+    Entity* ov = getOther(v, p);
     if (!ov)
       return 0;
     int peer, idx;
@@ -243,7 +244,7 @@ struct LayerSnapper : public Crawler
   Entity* crawl(Entity* v)
   {
     HasFlag p(a, CHECKED);
-    Entity* ov = getOtherVert(m, v, p);
+    Entity* ov = getOther(v, p);
     if (!ov)
       return 0;
     handle(ov, m->hasTag(v, snapTag));
@@ -269,11 +270,12 @@ struct LayerSnapper : public Crawler
   long ncurves;
 };
 
-static long snapAllCurves(Adapt* a, Tag* snapTag)
+static long snapAllCurves(Adapt* a, Tag* snapTag, LayerStacks* s)
 {
   double t0 = PCU_Time();
   LayerSnapper op(a, snapTag);
-  crawlLayers(&op);
+  op.stacks = s;
+  crawlStacks(&op);
   double t1 = PCU_Time();
   print("snapped %ld curves in %f seconds", op.ncurves, t1 - t0);
   return op.ncurves;
@@ -343,7 +345,7 @@ struct UnsnapChecker : public Crawler
   Entity* crawl(Entity* v)
   {
     HasFlag p(a, CHECKED);
-    Entity* ov = getOtherVert(m, v, p);
+    Entity* ov = getOther(v, p);
     if (!ov)
       return 0;
     handle(ov, getFlag(a, v, LAYER_UNSNAP));
@@ -395,10 +397,11 @@ static void crawlLayers_doubleSync(Crawler* c)
   c->end();
 }
 
-static bool checkForUnsnap(Adapt* a, Tag* snapTag)
+static bool checkForUnsnap(Adapt* a, Tag* snapTag, LayerStacks* s)
 {
   double t0 = PCU_Time();
   UnsnapChecker op(a, snapTag);
+  op.stacks = s;
   crawlLayers_doubleSync(&op);
   bool notOk = PCU_Or(op.foundAnything);
   double t1 = PCU_Time();
@@ -413,7 +416,7 @@ static bool checkForUnsnap(Adapt* a, Tag* snapTag)
    flag, this flag is fed back to its base vertex. */
 static void feedbackUnsnap(Adapt* a, Tag* snapTag, BaseTopLinker& l)
 {
-  crawlLayers(&l);
+  crawlStacks(&l);
   Mesh* m = l.m;
   long n = 0;
   Entity* v;
@@ -497,7 +500,7 @@ struct Unsnapper : public Crawler
   Entity* crawl(Entity* v)
   {
     HasFlag p(a, CHECKED);
-    Entity* ov = getOtherVert(m, v, p);
+    Entity* ov = getOther(v, p);
     if (!ov)
       return 0;
     handle(ov, getFlag(a, v, LAYER_UNSNAP));
@@ -523,11 +526,12 @@ struct Unsnapper : public Crawler
   long ncurves;
 };
 
-static long unsnapMarkedCurves(Adapt* a, Tag* snapTag)
+static long unsnapMarkedCurves(Adapt* a, Tag* snapTag, LayerStacks* s)
 {
   double t0 = PCU_Time();
   Unsnapper op(a, snapTag);
-  crawlLayers(&op);
+  op.stacks = s;
+  crawlStacks(&op);
   double t1 = PCU_Time();
   print("unsnapped %ld curves in %f seconds", op.ncurves, t1 - t0); 
   return op.ncurves;
@@ -539,17 +543,22 @@ void snapLayer(Adapt* a, Tag* snapTag)
     return;
   double t0 = PCU_Time();
   findLayerBase(a);
-  tagLayerForSnap(a, snapTag);
+  /* flagging the tops can migrate, so the curves
+     are indexed after it */
   flagLayerTop(a);
+  LayerStacks* s = new LayerStacks(a, 0);
+  tagLayerForSnap(a, snapTag, s);
   BaseTopLinker* l = new BaseTopLinker(a);
-  crawlLayers(l);
-  long nsnapped = snapAllCurves(a, snapTag);
+  l->stacks = s;
+  crawlStacks(l);
+  long nsnapped = snapAllCurves(a, snapTag, s);
   long nunsnapped = 0;
-  while (checkForUnsnap(a, snapTag)) {
+  while (checkForUnsnap(a, snapTag, s)) {
     feedbackUnsnap(a, snapTag, *l);
-    nunsnapped += unsnapMarkedCurves(a, snapTag);
+    nunsnapped += unsnapMarkedCurves(a, snapTag, s);
   }
   delete l;
+  delete s;
   double t1 = PCU_Time();
   print("finished snapping %ld of %ld layer curves in %f seconds",
       nsnapped - nunsnapped, nsnapped, t1 - t0);
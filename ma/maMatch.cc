@@ -29,14 +29,16 @@ static void unpackSplits(EntityArray& splits)
       splits.getSize()*sizeof(Entity*));
 }
 
+/* the splits of all dimensions go out in one exchange,
+   each match tagged with the dimension of its split list */
 void matchNewElements(Refine* r)
 {
   Adapt* a = r->adapt;
   Mesh* m = a->mesh;
   long face_count = 0;
+  PCU_Comm_Begin();
   for (int d=1; d < m->getDimension(); ++d)
   {
-    PCU_Comm_Begin();
     for (size_t i=0; i < r->toSplit[d].getSize(); ++i)
     {
       Entity* e = r->toSplit[d][i];
@@ -49,27 +51,30 @@ void matchNewElements(Refine* r)
       {
         int to = matches[i].peer;
         Entity* match = matches[i].entity;
+        PCU_COMM_PACK(to,d);
         PCU_COMM_PACK(to,match);
         packSplits(to,splits);
       }
     }
-    PCU_Comm_Send();
-    while (PCU_Comm_Listen())
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Listen())
+  {
+    int from = PCU_Comm_Sender();
+    while ( ! PCU_Comm_Unpacked())
     {
-      int from = PCU_Comm_Sender();
-      while ( ! PCU_Comm_Unpacked())
-      {
-        Entity* e;
-        PCU_COMM_UNPACK(e);
-        int number;
-        m->getIntTag(e,r->numberTag,&number);
-        EntityArray& splits = r->newEntities[d][number];
-        EntityArray remoteSplits(splits.getSize());
-        unpackSplits(remoteSplits);
-        for (size_t i=0; i < splits.getSize(); ++i)
-          m->addMatch(splits[i],from,remoteSplits[i]);
-        if (d==2) ++face_count;
-      }
+      int d;
+      PCU_COMM_UNPACK(d);
+      Entity* e;
+      PCU_COMM_UNPACK(e);
+      int number;
+      m->getIntTag(e,r->numberTag,&number);
+      EntityArray& splits = r->newEntities[d][number];
+      EntityArray remoteSplits(splits.getSize());
+      unpackSplits(remoteSplits);
+      for (size_t i=0; i < splits.getSize(); ++i)
+        m->addMatch(splits[i],from,remoteSplits[i]);
+      if (d==2) ++face_count;
     }
   }
   face_count = PCU_Add_Long(face_count);
@@ -60,6 +60,13 @@ struct IsFalseRebuild {
   }
 };
 
+struct IsBefore {
+  bool operator()(Entity* original, Rebuild const& r) const
+  {
+    return original < r.original;
+  }
+};
+
 void Rebuilds::match(apf::Sharing* sh)
 {
   /* the ma::rebuildElement call will produce more logs than we want:
@@ -80,12 +87,14 @@ void Rebuilds::match(apf::Sharing* sh)
     sh->getCopies(orig, orig_matches);
     for (unsigned j = 0; j < orig_matches.getSize(); ++j) {
       PCU_ALWAYS_ASSERT(orig_matches[j].peer == PCU_Comm_Self());
-      Entity* gen_match_j = 0;
-      for (unsigned k = 0; k < v.size(); ++k)
-        if (v[k].original == orig_matches[j].entity)
-          gen_match_j = v[k].e;
-      PCU_ALWAYS_ASSERT(gen_match_j);
-      mesh->addMatch(gen, PCU_Comm_Self(), gen_match_j);
+      /* (v) is sorted by original, so the rebuilds of the
+         match are a range found by binary search */
+      std::vector<Rebuild>::iterator k = std::upper_bound(
+          v.begin(), v.end(), orig_matches[j].entity, IsBefore());
+      PCU_ALWAYS_ASSERT(k != v.begin());
+      --k;
+      PCU_ALWAYS_ASSERT(k->original == orig_matches[j].entity);
+      mesh->addMatch(gen, PCU_Comm_Self(), k->e);
     }
   }
 }
@@ -243,21 +243,42 @@ bool isInClosure(Mesh* m, Entity* parent, Entity* e)
   return findIn(es, n, e) != -1;
 }
 
+/* streams the coordinate array when the mesh has one without gaps */
+static bool getSpanBoundingBox(Mesh* m, Vector& lower, Vector& upper)
+{
+  int n = m->countTagSpan(apf::Mesh::VERTEX);
+  if (!n)
+    return false;
+  double const* x = m->getPointSpan(0, n);
+  if (!x)
+    return false;
+  lower = upper = Vector(x);
+  for (int v = 1; v < n; ++v)
+    for (int i=0; i < 3; ++i)
+    {
+      lower[i] = std::min(lower[i],x[3 * v + i]);
+      upper[i] = std::max(upper[i],x[3 * v + i]);
+    }
+  return true;
+}
+
 void getBoundingBox(Mesh* m, Vector& lower, Vector& upper)
 {
-  Iterator* it = m->begin(0);
-  Entity* v = m->iterate(it);
-  lower = upper = getPosition(m,v);
-  while ((v = m->iterate(it)))
-  {
-    Vector p = getPosition(m,v);
-    for (int i=0; i < 3; ++i)
+  if (!getSpanBoundingBox(m, lower, upper)) {
+    Iterator* it = m->begin(0);
+    Entity* v = m->iterate(it);
+    lower = upper = getPosition(m,v);
+    while ((v = m->iterate(it)))
     {
-      lower[i] = std::min(lower[i],p[i]);
-      upper[i] = std::max(upper[i],p[i]);
+      Vector p = getPosition(m,v);
+      for (int i=0; i < 3; ++i)
+      {
+        lower[i] = std::min(lower[i],p[i]);
+        upper[i] = std::max(upper[i],p[i]);
+      }
     }
+    m->end(it);
   }
-  m->end(it);
   double a[3];
   lower.toArray(a);
   double b[3];
@@ -9,9 +9,14 @@
 *******************************************************************************/
 #include "maOperator.h"
 #include "maAdapt.h"
+#include "maProfile.h"
+#include <PCU.h>
+#include <algorithm>
 
 namespace ma {
 
+/* with a tracer, counts and times the calls to the operator
+   and hands the totals to the tracer once the operation is done */
 class CollectiveOperation : public apf::CavityOp, public DeleteCallback
 {
   public:
@@ -20,33 +25,151 @@ class CollectiveOperation : public apf::CavityOp, public DeleteCallback
       DeleteCallback(a)
     {
       op = o;
+      sorted = a->input->shouldBeDeterministic;
+      tracer = a->tracer;
+      trace.name = o->getName();
+      trace.shouldApplyCalls = 0;
+      trace.shouldApplyTime = 0;
+      trace.localityFailures = 0;
+      trace.applyCalls = 0;
+      trace.rollbacks = 0;
+      trace.applyTime = 0;
+      setIndependentPulls(true);
+    }
+    ~CollectiveOperation()
+    {
+      if (tracer)
+        tracer->traced(trace);
     }
     Outcome setEntity(Entity* e)
     {
-      if ( ! op->shouldApply(e))
-        return SKIP;
-      if ( ! op->requestLocality(this))
-        return REQUEST;
-      return OK;
+      if ( ! tracer)
+        return decide(e);
+      double t0 = PCU_Time();
+      Outcome o = decide(e);
+      trace.shouldApplyTime += PCU_Time() - t0;
+      ++trace.shouldApplyCalls;
+      if (o == REQUEST)
+        ++trace.localityFailures;
+      return o;
     }
     void apply()
     {
+      op->rolledBack = false;
+      if ( ! tracer) {
+        op->apply();
+        return;
+      }
+      double t0 = PCU_Time();
       op->apply();
+      trace.applyTime += PCU_Time() - t0;
+      ++trace.applyCalls;
+      if (op->rolledBack)
+        ++trace.rollbacks;
     }
     void call(Entity* e)
     {
       this->preDeletion(e);
     }
+    void orderList(std::vector<Entity*>& entities)
+    {
+      if (sorted)
+        sortByPosition(mesh, entities);
+    }
   private:
+    Outcome decide(Entity* e)
+    {
+      if ( ! op->shouldApply(e))
+        return SKIP;
+      if ( ! op->requestLocality(this))
+        return REQUEST;
+      return OK;
+    }
     Operator* op;
+    Tracer* tracer;
+    OperatorTrace trace;
+    bool sorted;
 };
 
+Operator::Operator():
+  rolledBack(false)
+{
+}
+
 Operator::~Operator() {}
 
+const char* Operator::getName()
+{
+  return "operator";
+}
+
 void applyOperator(Adapt* a, Operator* o)
 {
+  if (a->input->shouldBeDeterministic) {
+    std::vector<Entity*> worklist;
+    Mesh* m = a->mesh;
+    Iterator* it = m->begin(o->getTargetDimension());
+    Entity* e;
+    while ((e = m->iterate(it)))
+      worklist.push_back(e);
+    m->end(it);
+    applyOperator(a, o, worklist);
+    return;
+  }
   CollectiveOperation op(a,o);
   op.applyToDimension(o->getTargetDimension());
 }
 
+void applyOperator(Adapt* a, Operator* o, std::vector<Entity*>& worklist)
+{
+  CollectiveOperation op(a,o);
+  op.orderList(worklist);
+  op.applyToList(o->getTargetDimension(), worklist);
+}
+
+/* an entity's vertex coordinates in increasing order */
+struct PositionKey
+{
+  Entity* entity;
+  int n;
+  Vector points[8];
+};
+
+static bool isBefore(Vector const& a, Vector const& b)
+{
+  for (int i = 0; i < 3; ++i)
+    if (a[i] != b[i])
+      return a[i] < b[i];
+  return false;
+}
+
+static bool isKeyBefore(PositionKey const& a, PositionKey const& b)
+{
+  int n = std::min(a.n, b.n);
+  for (int i = 0; i < n; ++i) {
+    if (isBefore(a.points[i], b.points[i]))
+      return true;
+    if (isBefore(b.points[i], a.points[i]))
+      return false;
+  }
+  return a.n < b.n;
+}
+
+void sortByPosition(apf::Mesh* m, std::vector<Entity*>& entities)
+{
+  std::vector<PositionKey> keys(entities.size());
+  for (size_t i = 0; i < entities.size(); ++i) {
+    PositionKey& k = keys[i];
+    k.entity = entities[i];
+    Downward v;
+    k.n = m->getDownward(k.entity, 0, v);
+    for (int j = 0; j < k.n; ++j)
+      m->getPoint(v[j], 0, k.points[j]);
+    std::sort(k.points, k.points + k.n, isBefore);
+  }
+  std::stable_sort(keys.begin(), keys.end(), isKeyBefore);
+  for (size_t i = 0; i < keys.size(); ++i)
+    entities[i] = keys[i].entity;
+}
+
 }
@@ -18,14 +18,26 @@ namespace ma {
 class Operator
 {
   public:
+    Operator();
     virtual ~Operator();
+    /* names the operator in the traces of Adapt::tracer */
+    virtual const char* getName();
     virtual int getTargetDimension() = 0;
     virtual bool shouldApply(Entity* e) = 0;
     virtual bool requestLocality(apf::CavityOp* o) = 0;
     virtual void apply() = 0;
+    /* apply() sets this when it gives up and leaves the cavity
+       as it was, it is cleared before each apply() */
+    bool rolledBack;
 };
 
 void applyOperator(Adapt* a, Operator* o);
+/* applies (o) only to the entities in (worklist),
+   see apf::CavityOp::applyToList */
+void applyOperator(Adapt* a, Operator* o, std::vector<Entity*>& worklist);
+/* sorts (entities) by their vertex coordinates, which orders
+   them the same way however the mesh was built */
+void sortByPosition(apf::Mesh* m, std::vector<Entity*>& entities);
 
 }
 
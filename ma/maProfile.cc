@@ -0,0 +1,144 @@
+/*
+ * Copyright 2015 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+#include <PCU.h>
+#include "maProfile.h"
+#include "maAdapt.h"
+#include <apfCavityOp.h>
+#include <apfMesh2.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <sstream>
+#include <cstring>
+
+namespace ma {
+
+static void countEntities(Mesh* m, long* n)
+{
+  for (int d = 0; d < 4; ++d)
+    n[d] = d <= m->getDimension() ? apf::countOwned(m, d) : 0;
+  PCU_Add_Longs(n, 4);
+}
+
+void beginStage(Adapt* a, const char* name, int iteration)
+{
+  Profile* p = a->input->profile;
+  if (!p)
+    return;
+  StageProfile s;
+  s.name = name;
+  s.iteration = iteration;
+  s.attempted = 0;
+  s.succeeded = 0;
+  /* until endStage these hold the starting values */
+  s.pullRounds = apf::countCavityPullRounds();
+  s.migratedElements = apf::countMigratedElements();
+  countEntities(a->mesh, s.entitiesBefore);
+  s.time = PCU_Time();
+  p->stages.push_back(s);
+}
+
+void endStage(Adapt* a)
+{
+  Profile* p = a->input->profile;
+  if (!p)
+    return;
+  StageProfile& s = p->stages.back();
+  s.time = PCU_Time() - s.time;
+  s.minTime = PCU_Min_Double(s.time);
+  s.maxTime = PCU_Max_Double(s.time);
+  s.averageTime = PCU_Add_Double(s.time) / PCU_Comm_Peers();
+  /* pull rounds are collective, so every part counts the same */
+  s.pullRounds = apf::countCavityPullRounds() - s.pullRounds;
+  s.migratedElements = PCU_Add_Long(
+      apf::countMigratedElements() - s.migratedElements);
+  countEntities(a->mesh, s.entitiesAfter);
+}
+
+void noteOperations(Adapt* a, long attempted, long succeeded)
+{
+  a->operations += succeeded;
+  Profile* p = a->input->profile;
+  if (!p || p->stages.empty())
+    return;
+  p->stages.back().attempted = attempted;
+  p->stages.back().succeeded = succeeded;
+}
+
+static void writeCounts(std::ostream& o, const char* name, long const* n)
+{
+  o << "    \"" << name << "\": [" << n[0] << ", " << n[1] << ", "
+    << n[2] << ", " << n[3] << "]";
+}
+
+void writeProfile(Profile* p, const char* prefix)
+{
+  std::stringstream name;
+  name << prefix << PCU_Comm_Self() << ".json";
+  std::stringstream o;
+  o << "{\n\"part\": " << PCU_Comm_Self() << ",\n\"stages\": [\n";
+  for (size_t i = 0; i < p->stages.size(); ++i) {
+    StageProfile& s = p->stages[i];
+    o << "  {\n";
+    o << "    \"name\": \"" << s.name << "\",\n";
+    o << "    \"iteration\": " << s.iteration << ",\n";
+    o << "    \"time\": " << s.time << ",\n";
+    o << "    \"minTime\": " << s.minTime << ",\n";
+    o << "    \"averageTime\": " << s.averageTime << ",\n";
+    o << "    \"maxTime\": " << s.maxTime << ",\n";
+    o << "    \"attempted\": " << s.attempted << ",\n";
+    o << "    \"succeeded\": " << s.succeeded << ",\n";
+    o << "    \"pullRounds\": " << s.pullRounds << ",\n";
+    o << "    \"migratedElements\": " << s.migratedElements << ",\n";
+    writeCounts(o, "entitiesBefore", s.entitiesBefore);
+    o << ",\n";
+    writeCounts(o, "entitiesAfter", s.entitiesAfter);
+    o << "\n  }" << (i + 1 < p->stages.size() ? "," : "") << "\n";
+  }
+  o << "]\n}\n";
+  FILE* f = fopen(name.str().c_str(), "w");
+  PCU_ALWAYS_ASSERT(f);
+  fputs(o.str().c_str(), f);
+  fclose(f);
+}
+
+Tracer::~Tracer()
+{
+}
+
+void Tracer::finish()
+{
+}
+
+void TraceSummary::traced(OperatorTrace const& t)
+{
+  for (size_t i = 0; i < operators.size(); ++i) {
+    OperatorTrace& s = operators[i];
+    if (strcmp(s.name, t.name))
+      continue;
+    s.shouldApplyCalls += t.shouldApplyCalls;
+    s.shouldApplyTime += t.shouldApplyTime;
+    s.localityFailures += t.localityFailures;
+    s.applyCalls += t.applyCalls;
+    s.rollbacks += t.rollbacks;
+    s.applyTime += t.applyTime;
+    return;
+  }
+  operators.push_back(t);
+}
+
+void TraceSummary::finish()
+{
+  for (size_t i = 0; i < operators.size(); ++i) {
+    OperatorTrace& s = operators[i];
+    printf("MeshAdapt part %d: %s shouldApply %ld in %f s, "
+           "%ld not local, apply %ld in %f s, %ld rolled back\n",
+           PCU_Comm_Self(), s.name, s.shouldApplyCalls, s.shouldApplyTime,
+           s.localityFailures, s.applyCalls, s.applyTime, s.rollbacks);
+  }
+}
+
+}
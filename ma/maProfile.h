@@ -0,0 +1,104 @@
+/*
+ * Copyright 2015 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+#ifndef MA_PROFILE_H
+#define MA_PROFILE_H
+
+/** \file maProfile.h
+  \brief per-stage and per-operator measurements of ma::adapt */
+
+#include <vector>
+
+namespace ma {
+
+/** \brief measurements of one stage of ma::adapt
+  \details all values except (time) are the same on every part */
+struct StageProfile
+{
+/** \brief the stage, such as "coarsen" or "postBalance" */
+  const char* name;
+/** \brief the adapt loop iteration, or -1 outside the loop */
+  int iteration;
+/** \brief wall time of this part in seconds */
+  double time;
+/** \brief minimum wall time over all parts */
+  double minTime;
+/** \brief average wall time over all parts */
+  double averageTime;
+/** \brief maximum wall time over all parts */
+  double maxTime;
+/** \brief operations the stage tried, such as marked edges */
+  long attempted;
+/** \brief operations that went through */
+  long succeeded;
+/** \brief CavityOp pull rounds, see apf::countCavityPullRounds */
+  long pullRounds;
+/** \brief elements migrated between parts */
+  long migratedElements;
+/** \brief owned entities of each dimension before the stage */
+  long entitiesBefore[4];
+/** \brief owned entities of each dimension after the stage */
+  long entitiesAfter[4];
+};
+
+/** \brief the measurements of a whole ma::adapt run
+  \details point ma::Input::profile at one of these to fill it */
+struct Profile
+{
+/** \brief one entry per stage, in the order they ran */
+  std::vector<StageProfile> stages;
+};
+
+/** \brief write this part's profile as JSON to (prefix)(part).json */
+void writeProfile(Profile* p, const char* prefix);
+
+/** \brief what one kind of ma::Operator did on this part
+  \details times are wall time in seconds */
+struct OperatorTrace
+{
+/** \brief the operator, such as "collapse" or "snap" */
+  const char* name;
+/** \brief entities offered to the operator */
+  long shouldApplyCalls;
+/** \brief time deciding whether to apply */
+  double shouldApplyTime;
+/** \brief cavities that were not local and had to be pulled */
+  long localityFailures;
+/** \brief times the operator was applied */
+  long applyCalls;
+/** \brief applications that gave up and left the mesh as it was */
+  long rollbacks;
+/** \brief time applying */
+  double applyTime;
+};
+
+/** \brief receives what each ma::Operator did
+  \details point ma::Input::tracer at one of these to trace.
+  Without one the operators take no timings. */
+class Tracer
+{
+  public:
+    virtual ~Tracer();
+/** \brief called after each application of an operator to the mesh */
+    virtual void traced(OperatorTrace const& t) = 0;
+/** \brief called at the end of ma::adapt */
+    virtual void finish();
+};
+
+/** \brief sums the traces of each operator and prints
+  them for every part at the end of ma::adapt */
+class TraceSummary : public Tracer
+{
+  public:
+    virtual void traced(OperatorTrace const& t);
+    virtual void finish();
+/** \brief one entry per operator, in the order they first ran */
+    std::vector<OperatorTrace> operators;
+};
+
+}
+
+#endif
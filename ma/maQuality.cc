@@ -11,12 +11,15 @@
 #include <cfloat>
 #include <pcu_util.h>
 #include <cstdlib>
+#include <algorithm>
 #include "maMesh.h"
 #include "maSize.h"
 #include "maAdapt.h"
 #include "maShapeHandler.h"
 #include "maShape.h"
 #include <apfGeometry.h>
+#include <apfShape.h>
+#include <vector>
 
 namespace ma {
 
@@ -135,22 +138,104 @@ double measureTriQuality(Mesh* m, SizeField* f, Entity* tri, bool useMax)
   return 48*(A*A)/(s*s);
 }
 
-/* applies the mean ratio cubed formula from Li's thesis */
-double measureTetQuality(Mesh* m, SizeField* f, Entity* tet, bool useMax)
+static Matrix getTetMetric(Mesh* m, SizeField* f, Entity* tet, bool useMax)
 {
   /* By default, we are using Q at the center of the tet.
    * If useMax is true metric at a (downward) vertex with the
    * largest determinant is used.
    * Note: In the future we may want to used average of Q over the tet */
-  Matrix Q;
   if (useMax)
-    Q = getMetricWithMaxJacobean(m, f, tet);
-  else {
-    apf::MeshElement* me = createMeshElement(m, tet);
-    Vector xi(0.25, 0.25, 0.25);
-    f->getTransform(me, xi, Q);
-    apf::destroyMeshElement(me);
+    return getMetricWithMaxJacobean(m, f, tet);
+  Matrix Q;
+  apf::MeshElement* me = createMeshElement(m, tet);
+  Vector xi(0.25, 0.25, 0.25);
+  f->getTransform(me, xi, Q);
+  apf::destroyMeshElement(me);
+  return Q;
+}
+
+void measureTetQualities(size_t n, double const* x, double* q)
+{
+  double const* x0 = x;
+  double const* y0 = x + n;
+  double const* z0 = x + 2 * n;
+  double const* x1 = x + 3 * n;
+  double const* y1 = x + 4 * n;
+  double const* z1 = x + 5 * n;
+  double const* x2 = x + 6 * n;
+  double const* y2 = x + 7 * n;
+  double const* z2 = x + 8 * n;
+  double const* x3 = x + 9 * n;
+  double const* y3 = x + 10 * n;
+  double const* z3 = x + 11 * n;
+  /* straight-line code without branches, so that the
+     compiler can vectorize this loop */
+  for (size_t k = 0; k < n; ++k) {
+    double ax = x1[k] - x0[k], ay = y1[k] - y0[k], az = z1[k] - z0[k];
+    double bx = x2[k] - x0[k], by = y2[k] - y0[k], bz = z2[k] - z0[k];
+    double cx = x3[k] - x0[k], cy = y3[k] - y0[k], cz = z3[k] - z0[k];
+    double dx = x2[k] - x1[k], dy = y2[k] - y1[k], dz = z2[k] - z1[k];
+    double ex = x3[k] - x1[k], ey = y3[k] - y1[k], ez = z3[k] - z1[k];
+    double fx = x3[k] - x2[k], fy = y3[k] - y2[k], fz = z3[k] - z2[k];
+    double s = ax * ax + ay * ay + az * az
+             + bx * bx + by * by + bz * bz
+             + cx * cx + cy * cy + cz * cz
+             + dx * dx + dy * dy + dz * dz
+             + ex * ex + ey * ey + ez * ez
+             + fx * fx + fy * fy + fz * fz;
+    double V = (ax * (by * cz - bz * cy)
+              + ay * (bz * cx - bx * cz)
+              + az * (bx * cy - by * cx)) / 6;
+    double sign = V < 0 ? -1 : 1;
+    q[k] = sign * 15552 * (V * V) / (s * s * s);
+  }
+}
+
+/* puts the vertices of (tet) in the metric space as column (k)
+   of the (n) column layout of measureTetQualities */
+static void gatherTet(Mesh* m, SizeField* f, Entity* tet, bool useMax,
+    size_t n, size_t k, double* x)
+{
+  Matrix Qt = transpose(getTetMetric(m, f, tet, useMax));
+  Vector v[4];
+  getVertPoints(m, tet, v);
+  for (int i = 0; i < 4; ++i) {
+    Vector y = Qt * v[i];
+    for (int j = 0; j < 3; ++j)
+      x[(i * 3 + j) * n + k] = y[j];
+  }
+}
+
+static bool hasLinearCoordinates(Mesh* m)
+{
+  return m->getShape()->getOrder() == 1;
+}
+
+void measureTetQualities(Mesh* m, SizeField* f, Entity** tets, size_t n,
+    double* q, bool useMax)
+{
+  if ( ! hasLinearCoordinates(m)) {
+    for (size_t k = 0; k < n; ++k)
+      q[k] = measureTetQuality(m, f, tets[k], useMax);
+    return;
   }
+  std::vector<double> x(12 * n);
+  for (size_t k = 0; k < n; ++k)
+    gatherTet(m, f, tets[k], useMax, n, k, &x[0]);
+  measureTetQualities(n, &x[0], q);
+}
+
+/* applies the mean ratio cubed formula from Li's thesis */
+double measureTetQuality(Mesh* m, SizeField* f, Entity* tet, bool useMax)
+{
+  if (hasLinearCoordinates(m)) {
+    double x[12];
+    double q;
+    gatherTet(m, f, tet, useMax, 1, 0, x);
+    measureTetQualities(1, x, &q);
+    return q;
+  }
+  Matrix Q = getTetMetric(m, f, tet, useMax);
 
   Entity* e[6];
   m->getDownward(tet,1,e);
@@ -186,24 +271,22 @@ double getWorstQuality(Adapt* a, Entity** e, size_t n)
   PCU_ALWAYS_ASSERT(n);
   Mesh* m = a->mesh;
   ShapeHandler* sh = a->shape;
-  double worst;
-  if (m->hasTag(e[0], a->qualityCache))
-    worst = getCachedQuality(a, e[0]);
-  else {
-    worst = sh->getQuality(e[0]);
-    setCachedQuality(a, e[0], worst);
+  double worst = DBL_MAX;
+  /* the uncached elements are measured together */
+  std::vector<Entity*> missing;
+  for (size_t i = 0; i < n; ++i) {
+    if (m->hasTag(e[i], a->qualityCache))
+      worst = std::min(worst, getCachedQuality(a, e[i]));
+    else
+      missing.push_back(e[i]);
   }
-  for (size_t i = 1; i < n; ++i) {
-    double quality;
-    if (m->hasTag(e[i], a->qualityCache)) {
-      quality = getCachedQuality(a, e[i]);
-    }
-    else {
-      quality = sh->getQuality(e[i]);
-      setCachedQuality(a, e[i], quality);
-    }
-    if (quality < worst)
-      worst = quality;
+  if (missing.empty())
+    return worst;
+  std::vector<double> qualities(missing.size());
+  sh->getQualities(&missing[0], missing.size(), &qualities[0]);
+  for (size_t i = 0; i < missing.size(); ++i) {
+    setCachedQuality(a, missing[i], qualities[i]);
+    worst = std::min(worst, qualities[i]);
   }
   return worst;
 }
@@ -216,12 +299,13 @@ double getWorstQuality(Adapt* a, EntityArray& e)
 bool hasWorseQuality(Adapt* a, EntityArray& e, double qualityToBeat)
 {
   size_t n = e.getSize();
-  ShapeHandler* sh = a->shape;
-  for (size_t i = 0; i < n; ++i) {
-    double quality = sh->getQuality(e[i]);
-    if (quality < qualityToBeat)
+  if ( ! n)
+    return false;
+  std::vector<double> qualities(n);
+  a->shape->getQualities(&(e[0]), n, &qualities[0]);
+  for (size_t i = 0; i < n; ++i)
+    if (qualities[i] < qualityToBeat)
       return true;
-  }
   return false;
 }
 
@@ -119,6 +119,7 @@ Refine::Refine(Adapt* a)
   adapt = a;
   Mesh* m = a->mesh;
   numberTag = m->createIntTag("ma_refine_number",1);
+  m->chargeTag(numberTag, PCU_MEM_MA);
 }
 
 Refine::~Refine()
@@ -145,7 +146,10 @@ Entity* makeSplitVert(Refine* r, Entity* edge)
   if (a->input->shouldTransferToClosestPoint)
     transferToClosestPointOnEdgeSplit(m,edge,0.5,param);
   Entity* vert = buildVertex(a,c,point,param);
-  st->onVertex(me,xi,vert);
+  Entity* ev[2];
+  m->getDownward(edge,0,ev);
+  double const weights[2] = {0.5,0.5};
+  st->onBarycentricVertex(me,xi,2,ev,weights,vert);
   sf->interpolate(me,xi,vert);
   apf::destroyMeshElement(me);
   return vert;
@@ -223,6 +227,22 @@ int matchEntityToTemplate(Adapt* a, Entity* e, Entity** vo)
   return matchToTemplate(type, vi, code, vo);
 }
 
+int countSplitElements(Adapt* a, Entity* e)
+{
+  int type = a->mesh->getType(e);
+  int const* sizes;
+  if (type == apf::Mesh::TRIANGLE)
+    sizes = tri_template_sizes;
+  else if (type == apf::Mesh::TET)
+    sizes = tet_template_sizes;
+  else
+    return 0;
+  int code = getEdgeSplitCode(a,e);
+  int index = code_match[type][code].code_index;
+  PCU_ALWAYS_ASSERT(index != -1);
+  return sizes[index];
+}
+
 static SplitFunction* all_templates[apf::Mesh::TYPES] =
 {0,//vert
  edge_templates,
@@ -313,31 +333,39 @@ void collectForTransfer(Refine* r)
     r->shouldCollect[d] = true;
 }
 
-void splitElements(Refine* r)
+/* splits (toSplit[d]) from (first) up to (end) */
+static void splitRange(Refine* r, int d, size_t first, size_t end)
 {
   Adapt* a = r->adapt;
-  Mesh* m = a->mesh;
   NewEntities cb;
-  for (int d=1; d <= m->getDimension(); ++d)
+  bool shouldCollect = r->shouldCollect[d];
+  if (shouldCollect)
+    setBuildCallback(a,&cb);
+  for (size_t i=first; i < end; ++i)
   {
-    bool shouldCollect = r->shouldCollect[d];
+    Entity* e = r->toSplit[d][i];
     if (shouldCollect)
-    {
-      r->newEntities[d].setSize(r->toSplit[d].getSize());
-      setBuildCallback(a,&cb);
-    }
-    for (size_t i=0; i < r->toSplit[d].getSize(); ++i)
-    {
-      Entity* e = r->toSplit[d][i];
-      if (shouldCollect)
-        cb.reset();
-      splitElement(r,e);
-      if (shouldCollect)
-        cb.retrieve(r->newEntities[d][i]);
-    }
+      cb.reset();
+    splitElement(r,e);
     if (shouldCollect)
-      clearBuildCallback(a);
+      cb.retrieve(r->newEntities[d][i]);
   }
+  if (shouldCollect)
+    clearBuildCallback(a);
+}
+
+static void splitDimension(Refine* r, int d)
+{
+  if (r->shouldCollect[d])
+    r->newEntities[d].setSize(r->toSplit[d].getSize());
+  splitRange(r, d, 0, r->toSplit[d].getSize());
+}
+
+void splitElements(Refine* r)
+{
+  Mesh* m = r->adapt->mesh;
+  for (int d=1; d <= m->getDimension(); ++d)
+    splitDimension(r, d);
 }
 
 void transferElements(Refine* r)
@@ -355,6 +383,18 @@ void transferElements(Refine* r)
       a->shape->onRefine(r->toSplit[d][i],r->newEntities[d][i]);
 }
 
+static void transferRange(Refine* r, int d, size_t first, size_t end)
+{
+  Adapt* a = r->adapt;
+  SolutionTransfer* st = a->solutionTransfer;
+  if (d >= st->getTransferDimension())
+    for (size_t i=first; i < end; ++i)
+      st->onRefine(r->toSplit[d][i],r->newEntities[d][i]);
+  if (d >= a->shape->getTransferDimension())
+    for (size_t i=first; i < end; ++i)
+      a->shape->onRefine(r->toSplit[d][i],r->newEntities[d][i]);
+}
+
 void forgetNewEntities(Refine* r)
 {
   for (int d=0; d <= 3; ++d)
@@ -400,6 +440,47 @@ void processNewElements(Refine* r)
   transferElements(r);
 }
 
+/* does the work of splitElements, processNewElements and
+   destroySplitElements, but splits, transfers and destroys
+   the elements of the mesh dimension (batch) at a time.
+   The lower dimensions are split all at once first, so every
+   element finds the splits of its faces made, and only they
+   can be shared with other parts. */
+void refineInBatches(Refine* r, size_t batch)
+{
+  Adapt* a = r->adapt;
+  Mesh* m = a->mesh;
+  int D = m->getDimension();
+  for (int d=1; d < D; ++d)
+    splitDimension(r, d);
+  linkNewVerts(r);
+  if (PCU_Comm_Peers()>1) {
+    apf::stitchMesh(m);
+    m->acceptChanges();
+  }
+  if (a->input->shouldHandleMatching)
+    matchNewElements(r);
+  for (int d=1; d < D; ++d)
+    transferRange(r, d, 0, r->toSplit[d].getSize());
+  size_t n = r->toSplit[D].getSize();
+  if (r->shouldCollect[D])
+    r->newEntities[D].setSize(n);
+  for (size_t first=0; first < n; first += batch)
+  {
+    size_t end = std::min(n, first + batch);
+    splitRange(r, D, first, end);
+    transferRange(r, D, first, end);
+    for (size_t i=first; i < end; ++i)
+    {
+      destroyElement(a,r->toSplit[D][i]);
+      if (r->shouldCollect[D])
+        r->newEntities[D][i].setSize(0);
+    }
+  }
+  for (int d=1; d <= D; ++d)
+    r->toSplit[d].setSize(0);
+}
+
 void cleanupAfter(Refine* r)
 {
   forgetNewEntities(r);
@@ -407,6 +488,7 @@ void cleanupAfter(Refine* r)
 
 bool refine(Adapt* a)
 {
+  PCU_Region region("ma::refine");
   double t0 = PCU_Time();
   --(a->refinesLeft);
   setupLayerForSplit(a);
@@ -422,10 +504,15 @@ bool refine(Adapt* a)
   collectForMatching(r);
   setupRefineForLayer(r);
   addAllMarkedEdges(r);
-  splitElements(r);
-  processNewElements(r);
-  destroySplitElements(r);
+  if (a->input->refineBatchSize > 0)
+    refineInBatches(r, a->input->refineBatchSize);
+  else {
+    splitElements(r);
+    processNewElements(r);
+    destroySplitElements(r);
+  }
   forgetNewEntities(r);
+  noteOperations(a, count, count);
   double t1 = PCU_Time();
   print("refined %li edges in %f seconds",count,t1-t0);
   resetLayer(a);
@@ -61,6 +61,9 @@ void destroySplitElements(Refine* r);
 
 void splitElements(Refine* r);
 void processNewElements(Refine* r);
+/* splitElements, processNewElements and destroySplitElements,
+   with the elements of the mesh dimension done (batch) at a time */
+void refineInBatches(Refine* r, size_t batch);
 void cleanupAfter(Refine* r);
 
 bool refine(Adapt* a);
@@ -80,6 +83,9 @@ typedef void (*SplitFunction)(Refine* r, Entity* p, Entity** v);
 
 int matchEntityToTemplate(Adapt* a, Entity* e, Entity** vo);
 int matchToTemplate(int type, Entity** vi, int code, Entity** vo);
+/* the number of elements the templates split (e) into given
+   the edges marked to split, or zero if (e) is not a simplex */
+int countSplitElements(Adapt* a, Entity* e);
 
 }
 
@@ -21,7 +21,10 @@
 #include "maShapeHandler.h"
 #include "maBalance.h"
 #include "maDBG.h"
+#include "maStats.h"
 #include <pcu_util.h>
+#include <algorithm>
+#include <vector>
 
 namespace ma {
 
@@ -89,10 +92,24 @@ struct IsBadQuality : public Predicate
   Adapt* a;
 };
 
-int markBadQuality(Adapt* a)
+int markBadQuality(Adapt* a, std::vector<Entity*>* marked = 0)
 {
   IsBadQuality p(a);
-  return markEntities(a, a->mesh->getDimension(), p, BAD_QUALITY, OK_QUALITY);
+  return markEntities(a, a->mesh->getDimension(), p, BAD_QUALITY, OK_QUALITY,
+      marked);
+}
+
+/* finds the marked elements again after migration */
+static void gatherBadQuality(Adapt* a, std::vector<Entity*>& bad)
+{
+  Mesh* m = a->mesh;
+  bad.clear();
+  Iterator* it = m->begin(m->getDimension());
+  Entity* e;
+  while ((e = m->iterate(it)))
+    if (getFlag(a, e, BAD_QUALITY))
+      bad.push_back(e);
+  m->end(it);
 }
 
 void unMarkBadQuality(Adapt* a)
@@ -119,13 +136,20 @@ double getMinQuality(Adapt* a)
   Iterator* it = m->begin(m->getDimension());
   Entity* e;
   double minqual = 1;
-  while ((e = m->iterate(it))) {
-    if (!apf::isSimplex(m->getType(e)))
-      continue;
-    double qual = a->shape->getQuality(e);
-    if (qual < minqual)
-      minqual = qual;
-  }
+  /* elements are measured in batches */
+  std::vector<Entity*> batch;
+  std::vector<double> quals(qualityBatchSize);
+  do {
+    e = m->iterate(it);
+    if (e && apf::isSimplex(m->getType(e)))
+      batch.push_back(e);
+    if (batch.size() == qualityBatchSize || ( ! e && ! batch.empty())) {
+      a->shape->getQualities(&batch[0], batch.size(), &quals[0]);
+      for (size_t i = 0; i < batch.size(); ++i)
+        minqual = std::min(minqual, quals[i]);
+      batch.clear();
+    }
+  } while (e);
   m->end(it);
   return PCU_Min_Double(minqual);
 }
@@ -146,6 +170,7 @@ class ShortEdgeFixer : public Operator
     virtual ~ShortEdgeFixer()
     {
     }
+    virtual const char* getName() {return "short edge fixer";}
     virtual int getTargetDimension() {return mesh->getDimension();}
     virtual bool shouldApply(Entity* e)
     {
@@ -190,6 +215,7 @@ class ShortEdgeFixer : public Operator
       else
       {
         ++nf;
+        rolledBack = true;
         clearFlag(adapter,element,BAD_QUALITY);
       }
     }
@@ -430,6 +456,7 @@ class LargeAngleTetFixer : public Operator
     virtual ~LargeAngleTetFixer()
     {
     }
+    virtual const char* getName() {return "large angle tet fixer";}
     virtual int getTargetDimension() {return 3;}
     enum { EDGE_EDGE, FACE_VERT };
     virtual bool shouldApply(Entity* e)
@@ -457,8 +484,10 @@ class LargeAngleTetFixer : public Operator
     }
     virtual void apply()
     {
-      if ( ! fixer->run())
+      if ( ! fixer->run()) {
+        rolledBack = true;
         clearFlag(adapter,tet,BAD_QUALITY);
+      }
     }
   private:
     Adapt* adapter;
@@ -483,6 +512,7 @@ class LargeAngleTetAligner : public Operator
     virtual ~LargeAngleTetAligner()
     {
     }
+    virtual const char* getName() {return "large angle tet aligner";}
     virtual int getTargetDimension() {return 3;}
     virtual bool shouldApply(Entity* e)
     {
@@ -511,8 +541,10 @@ class LargeAngleTetAligner : public Operator
     }
     virtual void apply()
     {
-      if ( ! fixer.run())
+      if ( ! fixer.run()) {
+        rolledBack = true;
         clearFlag(adapter,tet,BAD_QUALITY);
+      }
     }
   private:
     Adapt* adapter;
@@ -537,6 +569,7 @@ class LargeAngleTriFixer : public Operator
     {
       delete edgeSwap;
     }
+    virtual const char* getName() {return "large angle tri fixer";}
     virtual int getTargetDimension() {return 2;}
     virtual bool shouldApply(Entity* e)
     {
@@ -577,6 +610,7 @@ class LargeAngleTriFixer : public Operator
           return;
         }
       ++nf;
+      rolledBack = true;
       clearFlag(adapter,tri,BAD_QUALITY);
     }
   private:
@@ -589,25 +623,34 @@ class LargeAngleTriFixer : public Operator
     int nf;
 };
 
-static double fixShortEdgeElements(Adapt* a)
+/* applies (o) to the worklist if there is one, otherwise everywhere */
+static void applyToMarked(Adapt* a, Operator* o, std::vector<Entity*>* marked)
+{
+  if (marked)
+    applyOperator(a,o,*marked);
+  else
+    applyOperator(a,o);
+}
+
+static double fixShortEdgeElements(Adapt* a, std::vector<Entity*>* marked)
 {
   double t0 = PCU_Time();
   ShortEdgeFixer fixer(a);
-  applyOperator(a,&fixer);
+  applyToMarked(a,&fixer,marked);
   double t1 = PCU_Time();
   return t1 - t0;
 }
 
-static void fixLargeAngleTets(Adapt* a)
+static void fixLargeAngleTets(Adapt* a, std::vector<Entity*>* marked)
 {
   LargeAngleTetFixer fixer(a);
-  applyOperator(a,&fixer);
+  applyToMarked(a,&fixer,marked);
 }
 
-static void fixLargeAngleTris(Adapt* a)
+static void fixLargeAngleTris(Adapt* a, std::vector<Entity*>* marked)
 {
   LargeAngleTriFixer fixer(a);
-  applyOperator(a,&fixer);
+  applyToMarked(a,&fixer,marked);
 }
 
 static void alignLargeAngleTets(Adapt* a)
@@ -622,13 +665,13 @@ static void alignLargeAngleTris(Adapt* a)
   applyOperator(a,&aligner);
 }
 
-static double fixLargeAngles(Adapt* a)
+static double fixLargeAngles(Adapt* a, std::vector<Entity*>* marked)
 {
   double t0 = PCU_Time();
   if (a->mesh->getDimension()==3)
-    fixLargeAngleTets(a);
+    fixLargeAngleTets(a, marked);
   else
-    fixLargeAngleTris(a);
+    fixLargeAngleTris(a, marked);
   double t1 = PCU_Time();
   return t1 - t0;
 }
@@ -643,10 +686,15 @@ static void alignLargeAngles(Adapt* a)
 
 void fixElementShapes(Adapt* a)
 {
+  PCU_Region region("ma::fixElementShapes");
   if ( ! a->input->shouldFixShape)
     return;
   double t0 = PCU_Time();
-  int count = markBadQuality(a);
+  /* with a worklist, each fixer visits the elements the
+     marking before it found, rather than all of them */
+  std::vector<Entity*> bad;
+  std::vector<Entity*>* marked = a->input->shouldUseWorklist ? &bad : 0;
+  int count = markBadQuality(a, marked);
   int originalCount = count;
   int prev_count;
   double time;
@@ -656,7 +704,10 @@ void fixElementShapes(Adapt* a)
       break;
     prev_count = count;
     print("--iter %d of shape correction loop: #bad elements %d", iter, count);
-    time = fixLargeAngles(a);
+    spreadBadElements(a);
+    if (marked)
+      gatherBadQuality(a, bad);
+    time = fixLargeAngles(a, marked);
     /* We need to snap the new verts as soon as they are
      * created (to avoid future problems). At the moment
      * new verts are created only during 3D mesh adapt, so
@@ -664,19 +715,25 @@ void fixElementShapes(Adapt* a)
      */
     if (a->mesh->getDimension() == 3)
       snap(a);
-    count = markBadQuality(a);
+    bad.clear();
+    count = markBadQuality(a, marked);
     print("--fixLargeAngles       in %f seconds: #bad elements %d",time,count);
-    time = fixShortEdgeElements(a);
-    count = markBadQuality(a);
+    time = fixShortEdgeElements(a, marked);
+    bad.clear();
+    count = markBadQuality(a, marked);
     print("--fixShortEdgeElements in %f seconds: #bad elements %d",time,count);
     if (count >= prev_count)
       unMarkBadQuality(a); // to make sure markEntities does not complain!
     // balance the mesh to avoid empty parts
     midBalance(a);
+    if (marked)
+      gatherBadQuality(a, bad);
     print("--percent change in number of bad elements %f",
 	((double) prev_count - (double) count) / (double) prev_count);
     iter++;
   } while(count < prev_count);
+  /* this overrides the counts of the snaps it ran */
+  noteOperations(a, originalCount, originalCount - count);
   double t1 = PCU_Time();
   print("bad shapes down from %d to %d in %f seconds",
         originalCount,count,t1-t0);
@@ -712,6 +769,10 @@ void printQuality(Adapt* a)
 {
   if ( ! a->input->shouldPrintQuality)
     return;
+  if (a->input->shouldPrintReport) {
+    printReport(a);
+    return;
+  }
   double minqual = getMinQuality(a);
   print("worst element quality is %e", minqual);
 }
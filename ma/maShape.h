@@ -25,6 +25,16 @@ double measureTriQuality(Mesh* m, SizeField* f, Entity* tri, bool useMax=true);
 double measureTetQuality(Mesh* m, SizeField* f, Entity* tet, bool useMax=true);
 double measureElementQuality(Mesh* m, SizeField* f, Entity* e, bool useMax=true);
 
+/* mean ratio cubed of (n) tets from their metric space vertex
+   coordinates, stored as a structure of arrays: coordinate j of
+   vertex i of tet k is x[(i * 3 + j) * n + k] */
+void measureTetQualities(size_t n, double const* x, double* q);
+/* how many elements the whole-mesh quality loops measure at once */
+enum { qualityBatchSize = 64 };
+/* measureTetQuality of (n) tets, batched when the mesh is linear */
+void measureTetQualities(Mesh* m, SizeField* f, Entity** tets, size_t n,
+    double* q, bool useMax=true);
+
 /* gets the quality of an element based on
  * the vertices used for curved elements
  */
@@ -16,6 +16,12 @@
 
 namespace ma {
 
+void ShapeHandler::getQualities(Entity** e, size_t n, double* q)
+{
+  for (size_t i = 0; i < n; ++i)
+    q[i] = getQuality(e[i]);
+}
+
 class LinearHandler : public ShapeHandler
 {
   public:
@@ -28,6 +34,15 @@ class LinearHandler : public ShapeHandler
     {
       return measureElementQuality(mesh, sizeField, e);
     }
+    virtual void getQualities(Entity** e, size_t n, double* q)
+    {
+      for (size_t i = 0; i < n; ++i)
+        if (mesh->getType(e[i]) != apf::Mesh::TET) {
+          ShapeHandler::getQualities(e, n, q);
+          return;
+        }
+      measureTetQualities(mesh, sizeField, e, n, q);
+    }
     virtual bool hasNodesOn(int dimension)
     {
       return dimension == 0;
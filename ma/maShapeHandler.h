@@ -11,6 +11,9 @@ class ShapeHandler : public SolutionTransfer
 {
   public:
     virtual double getQuality(Entity* e) = 0;
+    /* the qualities of (n) elements, which handlers
+       able to evaluate many at once override */
+    virtual void getQualities(Entity** e, size_t n, double* q);
 };
 
 ShapeHandler* getShapeHandler(Adapt* a);
@@ -12,6 +12,8 @@
 #include "apfMatrix.h"
 #include <apfShape.h>
 #include <cstdlib>
+#include <algorithm>
+#include <vector>
 #include <pcu_util.h>
 
 namespace ma {
@@ -177,9 +179,18 @@ class SizeFieldIntegrator : public apf::Integrator
     int dimension;
 };
 
+/* edge lengths in the cache tag of setLengthCache are stored
+   with the coordinates of the edge vertices they were measured
+   at, so that moving a vertex invalidates them */
+enum { CACHED_LENGTH_SIZE = 7 };
+
 struct MetricSizeField : public SizeField
 {
-  double measure(Entity* e)
+  MetricSizeField():
+    lengths(0)
+  {
+  }
+  double measureElement(Entity* e)
   {
     SizeFieldIntegrator sFI(this); 
     apf::MeshElement* me = apf::createMeshElement(mesh, e);
@@ -187,6 +198,25 @@ struct MetricSizeField : public SizeField
     apf::destroyMeshElement(me);
     return sFI.measurement;
   }
+  double measure(Entity* e)
+  {
+    if (( ! lengths) || mesh->getType(e) != apf::Mesh::EDGE)
+      return measureElement(e);
+    double now[CACHED_LENGTH_SIZE];
+    Entity* v[2];
+    mesh->getDownward(e, 0, v);
+    getPosition(mesh, v[0]).toArray(now + 1);
+    getPosition(mesh, v[1]).toArray(now + 4);
+    if (mesh->hasTag(e, lengths)) {
+      double cached[CACHED_LENGTH_SIZE];
+      mesh->getDoubleTag(e, lengths, cached);
+      if (std::equal(now + 1, now + CACHED_LENGTH_SIZE, cached + 1))
+        return cached[0];
+    }
+    now[0] = measureElement(e);
+    mesh->setDoubleTag(e, lengths, now);
+    return now[0];
+  }
   bool shouldSplit(Entity* edge)
   {
     return this->measure(edge) > 1.5;
@@ -201,8 +231,23 @@ struct MetricSizeField : public SizeField
     return measure(e) / parentMeasure[mesh->getType(e)];
   }
   Mesh* mesh;
+  Tag* lengths;
 };
 
+void setLengthCache(SizeField* sf, Tag* t)
+{
+  MetricSizeField* msf = dynamic_cast<MetricSizeField*>(sf);
+  if (msf)
+    msf->lengths = t;
+}
+
+Tag* createLengthCache(Mesh* m)
+{
+  Tag* t = m->createDoubleTag("ma_length_cache", CACHED_LENGTH_SIZE);
+  m->chargeTag(t, PCU_MEM_MA);
+  return t;
+}
+
 AnisotropicFunction::~AnisotropicFunction()
 {
 }
@@ -420,6 +465,34 @@ struct AnisoSizeField : public MetricSizeField
   FrameEval frameEval;
 };
 
+static Matrix getLogMetric(Vector const& h, Matrix const& f)
+{
+  Vector s(log(1/h[0]/h[0]), log(1/h[1]/h[1]), log(1/h[2]/h[2]));
+  Matrix S(s[0], 0   , 0,
+          0    , s[1], 0,
+          0    , 0   , s[2]);
+  return f * S * transpose(f);
+}
+
+/* computes the log metrics of many vertices in
+   contiguous chunks, one per thread */
+struct LogMChunks
+{
+  static void compute(void* p, size_t first, size_t end)
+  {
+    LogMChunks* all = static_cast<LogMChunks*>(p);
+    for (size_t i = first; i < end; ++i)
+      all->logMs[i] = getLogMetric(all->sizes[i], all->frames[i]);
+  }
+  void run(int threads)
+  {
+    PCU_Thrd_Chunks(threads, logMs.size(), compute, this);
+  }
+  std::vector<Vector> sizes;
+  std::vector<Matrix> frames;
+  std::vector<Matrix> logMs;
+};
+
 struct LogAnisoSizeField : public MetricSizeField
 {
   LogAnisoSizeField()
@@ -436,23 +509,31 @@ struct LogAnisoSizeField : public MetricSizeField
   {
     apf::destroyField(logMField);
   }
-  void init(Mesh* m, apf::Field* sizes, apf::Field* frames)
+  /* the fields are read and the results written serially,
+     only the metrics in between are computed on (threads) */
+  void init(Mesh* m, apf::Field* sizes, apf::Field* frames, int threads)
   {
     mesh = m;
     logMField = apf::createFieldOn(m, "ma_logM", apf::MATRIX);
+    size_t n = m->count(0);
+    std::vector<Entity*> verts(n);
+    LogMChunks chunks;
+    chunks.sizes.resize(n);
+    chunks.frames.resize(n);
+    chunks.logMs.resize(n);
     Entity* v;
+    size_t i = 0;
     Iterator* it = m->begin(0);
     while ( (v = m->iterate(it)) ) {
-      Vector h;
-      Matrix f;
-      apf::getVector(sizes, v, 0, h);
-      apf::getMatrix(frames, v, 0, f);
-      Vector s(log(1/h[0]/h[0]), log(1/h[1]/h[1]), log(1/h[2]/h[2]));
-      Matrix S(s[0], 0   , 0,
-              0    , s[1], 0,
-              0    , 0   , s[2]);
-      apf::setMatrix(logMField, v, 0, f * S * transpose(f));
+      verts[i] = v;
+      apf::getVector(sizes, v, 0, chunks.sizes[i]);
+      apf::getMatrix(frames, v, 0, chunks.frames[i]);
+      ++i;
     }
+    m->end(it);
+    chunks.run(threads);
+    for (i = 0; i < n; ++i)
+      apf::setMatrix(logMField, verts[i], 0, chunks.logMs[i]);
   }
   void getTransform(
       apf::MeshElement* me,
@@ -539,7 +620,7 @@ struct IsoUserField : public IsoSizeField
 };
 
 SizeField* makeSizeField(Mesh* m, apf::Field* sizes, apf::Field* frames,
-    bool logInterpolation)
+    bool logInterpolation, int threads)
 {
   // logInterpolation is "false" by default
   if (! logInterpolation) {
@@ -549,7 +630,7 @@ SizeField* makeSizeField(Mesh* m, apf::Field* sizes, apf::Field* frames,
   }
   else {
     LogAnisoSizeField* logAnisoF = new LogAnisoSizeField();
-    logAnisoF->init(m, sizes, frames);
+    logAnisoF->init(m, sizes, frames, threads);
     return logAnisoF;
   }
 }
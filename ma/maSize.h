@@ -89,13 +89,24 @@ class IsotropicFunction
     virtual double getValue(Entity* vert) = 0;
 };
 
+/** \brief make a size field from sizes and frames at the vertices
+  \details with logarithmic interpolation, the per-vertex log metrics
+  are computed in (threads) chunks of the vertices */
 SizeField* makeSizeField(Mesh* m, apf::Field* sizes, apf::Field* frames,
-    bool logInterpolation = false);
+    bool logInterpolation = false, int threads = 1);
 SizeField* makeSizeField(Mesh* m, AnisotropicFunction* f,
     bool logInterpolation = false);
 SizeField* makeSizeField(Mesh* m, apf::Field* size);
 SizeField* makeSizeField(Mesh* m, IsotropicFunction* f);
 
+/** \brief create the tag for ma::setLengthCache */
+Tag* createLengthCache(Mesh* m);
+/** \brief make a metric size field reuse the edge lengths in (t)
+  \details a cached length is used until a vertex of its edge
+  moves. Size fields that are not based on a metric ignore this.
+  Pass zero to stop using the cache. */
+void setLengthCache(SizeField* sf, Tag* t);
+
 double getAverageEdgeLength(Mesh* m);
 double getMaximumEdgeLength(Mesh* m, SizeField* sf = 0);
 
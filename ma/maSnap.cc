@@ -670,15 +670,6 @@ void transferToClosestPointOnQuadSplit(
   (void) targetPt;
 }
 
-static void getSnapPoint(Mesh* m, Entity* v, Vector& x)
-{
-  m->getPoint(v,0,x);
-  Vector p;
-  m->getParam(v,p);
-  Model* g = m->toModel(v);
-  m->snapToModel(g,p,x);
-}
-
 class SnapAll : public Operator
 {
   public:
@@ -691,6 +682,7 @@ class SnapAll : public Operator
       didAnything = false;
       vert = 0;
     }
+    const char* getName() {return "snap";}
     int getTargetDimension() {return 0;}
     bool shouldApply(Entity* e)
     {
@@ -707,6 +699,7 @@ class SnapAll : public Operator
     void apply()
     {
       bool snapped = snapper.run();
+      rolledBack = ! snapped;
       didAnything = didAnything || snapped || snapper.dug;
       if (snapped)
         ++successCount;
@@ -741,6 +734,7 @@ class SnapMatched : public Operator
       didAnything = false;
       vert = 0;
     }
+    const char* getName() {return "matched snap";}
     int getTargetDimension() {return 0;}
     bool shouldApply(Entity* e)
     {
@@ -758,6 +752,7 @@ class SnapMatched : public Operator
     {
       snapper.setVerts();
       bool snapped = snapper.trySnaps();
+      rolledBack = ! snapped;
       didAnything = didAnything || snapped;
       if (snapped)
         ++successCount;
@@ -780,28 +775,42 @@ bool snapMatchedVerts(Adapt* a, Tag* t, bool isSimple, long& successCount)
   return PCU_Or(op.didAnything);
 }
 
+/* the targets of all boundary vertices are evaluated in one
+   batch, since each evaluation may be a costly CAD query */
 long tagVertsToSnap(Adapt* a, Tag*& t)
 {
   Mesh* m = a->mesh;
   int dim = m->getDimension();
   t = m->createDoubleTag("ma_snap", 3);
+  std::vector<Entity*> verts;
+  std::vector<Model*> models;
+  std::vector<Vector> params;
   Entity* v;
-  long n = 0;
   Iterator* it = m->begin(0);
   while ((v = m->iterate(it))) {
-    int md = m->getModelType(m->toModel(v));
-    if (dim == 3 && md == 3)
+    Model* g = m->toModel(v);
+    if (dim == 3 && m->getModelType(g) == 3)
       continue;
-    Vector s;
-    getSnapPoint(m, v, s);
+    Vector p;
+    m->getParam(v, p);
+    verts.push_back(v);
+    models.push_back(g);
+    params.push_back(p);
+  }
+  m->end(it);
+  std::vector<Vector> targets(verts.size());
+  if (!verts.empty())
+    m->snapToModel(verts.size(), &models[0], &params[0], &targets[0]);
+  long n = 0;
+  for (size_t i = 0; i < verts.size(); ++i) {
+    v = verts[i];
     Vector x = getPosition(m, v);
-    if (apf::areClose(s, x, 1e-12))
+    if (apf::areClose(targets[i], x, 1e-12))
       continue;
-    m->setDoubleTag(v, t, &s[0]);
+    m->setDoubleTag(v, t, &targets[i][0]);
     if (m->isOwned(v))
       ++n;
   }
-  m->end(it);
   return PCU_Add_Long(n);
 }
 
@@ -845,6 +854,7 @@ long snapTaggedVerts(Adapt* a, Tag* tag)
 
 void snap(Adapt* a)
 {
+  PCU_Region region("ma::snap");
   if ( ! a->input->shouldSnap)
     return;
   double t0 = PCU_Time();
@@ -858,6 +868,7 @@ void snap(Adapt* a)
   snapLayer(a, tag);
   apf::removeTagFromDimension(a->mesh, tag, 0);
   a->mesh->destroyTag(tag);
+  noteOperations(a, targets, success);
   double t1 = PCU_Time();
   print("snapped in %f seconds: %ld targets, %ld non-layer snaps",
     t1 - t0, targets, success);
@@ -13,6 +13,8 @@
 #include <apfShape.h>
 #include <apfNumbering.h>
 #include <float.h>
+#include <cmath>
+#include <algorithm>
 
 namespace ma {
 
@@ -27,6 +29,17 @@ void SolutionTransfer::onVertex(
 {
 }
 
+void SolutionTransfer::onBarycentricVertex(
+        apf::MeshElement* parent,
+        Vector const& xi,
+        int,
+        Entity**,
+        double const*,
+        Entity* vert)
+{
+  onVertex(parent,xi,vert);
+}
+
 void SolutionTransfer::onRefine(
     Entity*,
     EntityArray&)
@@ -91,17 +104,55 @@ class LinearTransfer : public FieldTransfer
     LinearTransfer(apf::Field* f):
       FieldTransfer(f)
     {
+      e = 0;
+      blend.allocate(apf::countComponents(f));
+    }
+    ~LinearTransfer()
+    {
+      if (e)
+        apf::destroyElement(e);
     }
     virtual void onVertex(
         apf::MeshElement* parent,
         Vector const& xi, 
         Entity* vert)
     {
-      apf::Element* e = apf::createElement(field,parent);
+      if (e)
+        apf::rebindElement(e,parent);
+      else
+        e = apf::createElement(field,parent);
       apf::getComponents(e,xi,&(value[0]));
       apf::setComponents(field,vert,0,&(value[0]));
-      apf::destroyElement(e);
     }
+    /* a linear field on a simplex is the barycentric
+       blend of its vertex values */
+    virtual void onBarycentricVertex(
+        apf::MeshElement* parent,
+        Vector const& xi,
+        int n,
+        Entity** parentVerts,
+        double const* weights,
+        Entity* vert)
+    {
+      if ( ! apf::isSimplex(mesh->getType(apf::getMeshEntity(parent))))
+      {
+        onVertex(parent,xi,vert);
+        return;
+      }
+      int nc = apf::countComponents(field);
+      for (int j = 0; j < nc; ++j)
+        blend[j] = 0;
+      for (int i = 0; i < n; ++i)
+      {
+        apf::getComponents(field,parentVerts[i],0,&(value[0]));
+        for (int j = 0; j < nc; ++j)
+          blend[j] += weights[i] * value[j];
+      }
+      apf::setComponents(field,vert,0,&(blend[0]));
+    }
+  private:
+    apf::Element* e;
+    apf::NewArray<double> blend;
 };
 
 class CavityTransfer : public FieldTransfer
@@ -246,6 +297,184 @@ class HighOrderTransfer : public SolutionTransfer
     }
 };
 
+/* solves the dense n by n system (A) in place for (nc) right hand
+   sides stored row-major in (B), by elimination with partial pivoting */
+static void solveSmall(int n, int nc, double* A, double* B)
+{
+  for (int k = 0; k < n; ++k)
+  {
+    int p = k;
+    for (int i = k + 1; i < n; ++i)
+      if (fabs(A[i * n + k]) > fabs(A[p * n + k]))
+        p = i;
+    if (p != k)
+    {
+      for (int j = 0; j < n; ++j)
+        std::swap(A[k * n + j], A[p * n + j]);
+      for (int j = 0; j < nc; ++j)
+        std::swap(B[k * nc + j], B[p * nc + j]);
+    }
+    for (int i = k + 1; i < n; ++i)
+    {
+      double f = A[i * n + k] / A[k * n + k];
+      for (int j = k; j < n; ++j)
+        A[i * n + j] -= f * A[k * n + j];
+      for (int j = 0; j < nc; ++j)
+        B[i * nc + j] -= f * B[k * nc + j];
+    }
+  }
+  for (int k = n - 1; k >= 0; --k)
+    for (int j = 0; j < nc; ++j)
+    {
+      double x = B[k * nc + j];
+      for (int i = k + 1; i < n; ++i)
+        x -= A[k * n + i] * B[i * nc + j];
+      B[k * nc + j] = x / A[k * n + k];
+    }
+}
+
+/* for fields whose nodes are all inside elements, each new element
+   gets the L2 projection of the old field restricted to it, sampled
+   at the new element's integration points. The projection keeps the
+   integral over each new element up to quadrature, and the cavity
+   total is then made exact by a uniform offset, which relies on the
+   shape functions summing to one. */
+class ConservativeTransfer : public CavityTransfer
+{
+  public:
+    ConservativeTransfer(apf::Field* f):
+      CavityTransfer(f)
+    {
+      dim = mesh->getDimension();
+      order = std::max(1, 2 * shape->getOrder());
+      nc = apf::countComponents(f);
+    }
+    void addIntegral(Entity* elem, double* total, double& volume)
+    {
+      apf::MeshElement* me = apf::createMeshElement(mesh, elem);
+      apf::Element* e = apf::createElement(field, me);
+      int np = apf::countIntPoints(me, order);
+      for (int p = 0; p < np; ++p)
+      {
+        Vector xi;
+        apf::getIntPoint(me, order, p, xi);
+        double w = apf::getIntWeight(me, order, p) * apf::getDV(me, xi);
+        apf::getComponents(e, xi, &(value[0]));
+        for (int j = 0; j < nc; ++j)
+          total[j] += w * value[j];
+        volume += w;
+      }
+      apf::destroyElement(e);
+      apf::destroyMeshElement(me);
+    }
+    void project(
+        int n,
+        apf::Element** elems,
+        Affine* elemInvMaps,
+        Entity* newElement)
+    {
+      apf::MeshElement* me = apf::createMeshElement(mesh, newElement);
+      apf::EntityShape* es =
+        shape->getEntityShape(mesh->getType(newElement));
+      int nn = es->countNodes();
+      apf::NewArray<double> mass(nn * nn);
+      apf::NewArray<double> rhs(nn * nc);
+      for (int i = 0; i < nn * nn; ++i)
+        mass[i] = 0;
+      for (int i = 0; i < nn * nc; ++i)
+        rhs[i] = 0;
+      apf::NewArray<double> N;
+      Affine map = getMap(mesh, newElement);
+      int np = apf::countIntPoints(me, order);
+      for (int p = 0; p < np; ++p)
+      {
+        Vector xi;
+        apf::getIntPoint(me, order, p, xi);
+        double w = apf::getIntWeight(me, order, p) * apf::getDV(me, xi);
+        es->getValues(mesh, newElement, xi, N);
+        Vector oldXi;
+        int o = getBestElement(n, elems, elemInvMaps, map * xi, oldXi);
+        apf::getComponents(elems[o], oldXi, &(value[0]));
+        for (int a = 0; a < nn; ++a)
+        {
+          for (int b = 0; b < nn; ++b)
+            mass[a * nn + b] += w * N[a] * N[b];
+          for (int j = 0; j < nc; ++j)
+            rhs[a * nc + j] += w * N[a] * value[j];
+        }
+      }
+      solveSmall(nn, nc, &(mass[0]), &(rhs[0]));
+      for (int a = 0; a < nn; ++a)
+        apf::setComponents(field, newElement, a, &(rhs[a * nc]));
+      apf::destroyMeshElement(me);
+    }
+    void offset(Entity* newElement, double const* c)
+    {
+      int nn = shape->countNodesOn(mesh->getType(newElement));
+      for (int a = 0; a < nn; ++a)
+      {
+        apf::getComponents(field, newElement, a, &(value[0]));
+        for (int j = 0; j < nc; ++j)
+          value[j] += c[j];
+        apf::setComponents(field, newElement, a, &(value[0]));
+      }
+    }
+    void transfer(
+        int n,
+        Entity** cavity,
+        EntityArray& newEntities)
+    {
+      if (getDimension(mesh, cavity[0]) != dim)
+        return;
+      apf::NewArray<apf::Element*> elems(n);
+      apf::NewArray<Affine> elemInvMaps(n);
+      apf::NewArray<double> oldTotal(nc);
+      apf::NewArray<double> newTotal(nc);
+      for (int j = 0; j < nc; ++j)
+        oldTotal[j] = newTotal[j] = 0;
+      double oldVolume = 0;
+      for (int i = 0; i < n; ++i)
+      {
+        elems[i] = apf::createElement(field, cavity[i]);
+        elemInvMaps[i] = invert(getMap(mesh, cavity[i]));
+        addIntegral(cavity[i], &(oldTotal[0]), oldVolume);
+      }
+      double newVolume = 0;
+      for (size_t i = 0; i < newEntities.getSize(); ++i)
+      {
+        if (getDimension(mesh, newEntities[i]) != dim)
+          continue;
+        project(n, &(elems[0]), &(elemInvMaps[0]), newEntities[i]);
+        addIntegral(newEntities[i], &(newTotal[0]), newVolume);
+      }
+      for (int i = 0; i < n; ++i)
+        apf::destroyElement(elems[i]);
+      if (newVolume <= 0)
+        return;
+      for (int j = 0; j < nc; ++j)
+        newTotal[j] = (oldTotal[j] - newTotal[j]) / newVolume;
+      for (size_t i = 0; i < newEntities.getSize(); ++i)
+        if (getDimension(mesh, newEntities[i]) == dim)
+          offset(newEntities[i], &(newTotal[0]));
+    }
+    virtual void onRefine(
+        Entity* parent,
+        EntityArray& newEntities)
+    {
+      transfer(1,&parent,newEntities);
+    }
+    virtual void onCavity(
+        EntityArray& oldElements,
+        EntityArray& newEntities)
+    {
+      transfer(oldElements.getSize(),&(oldElements[0]),newEntities);
+    }
+  private:
+    int dim;
+    int order;
+    int nc;
+};
+
 SolutionTransfer* createFieldTransfer(apf::Field* f)
 {
   apf::FieldShape* shape = apf::getShape(f);
@@ -260,6 +489,16 @@ SolutionTransfer* createFieldTransfer(apf::Field* f)
   return new CavityTransfer(f);
 }
 
+SolutionTransfer* createConservativeTransfer(apf::Field* f)
+{
+  apf::FieldShape* shape = apf::getShape(f);
+  int dim = apf::getMesh(f)->getDimension();
+  for (int d = 0; d < dim; ++d)
+    if (shape->hasNodesIn(d))
+      return createFieldTransfer(f);
+  return new ConservativeTransfer(f);
+}
+
 SolutionTransfers::SolutionTransfers()
 {
 }
@@ -292,6 +531,18 @@ void SolutionTransfers::onVertex(
     transfers[i]->onVertex(parent,xi,vert);
 }
 
+void SolutionTransfers::onBarycentricVertex(
+    apf::MeshElement* parent,
+    Vector const& xi,
+    int n,
+    Entity** parentVerts,
+    double const* weights,
+    Entity* vert)
+{
+  for (size_t i = 0; i < transfers.size(); ++i)
+    transfers[i]->onBarycentricVertex(parent,xi,n,parentVerts,weights,vert);
+}
+
 void SolutionTransfers::onRefine(
     Entity* parent,
     EntityArray& newEntities)
@@ -46,6 +46,21 @@ class SolutionTransfer
         apf::MeshElement* parent,
         Vector const& xi, 
         Entity* vert);
+    /** \brief perform solution transfer on a vertex made at known
+               barycentric coordinates of a simplex parent
+      \details refinement knows where its new vertices lie in the
+               parent from the templates, so it also gives the parent's
+               (n) vertices and their (weights). Fields that are linear
+               on the parent can then blend the vertex values without
+               building an element.
+               The default calls onVertex. */
+    virtual void onBarycentricVertex(
+        apf::MeshElement* parent,
+        Vector const& xi,
+        int n,
+        Entity** parentVerts,
+        double const* weights,
+        Entity* vert);
     /** \brief perform solution transfer on refined entities
       \details when there are nodes on entities other
                than vertices, it becomes necessary to transfer
@@ -79,6 +94,15 @@ class SolutionTransfer
   integration point fields. */
 SolutionTransfer* createFieldTransfer(apf::Field* f);
 
+/** \brief Creates a solution transfer object that conserves
+           the integral of an element field
+  \details for fields with nodes only inside elements, each new
+  element receives the local L2 projection of the old elements it
+  overlaps, and the integral over each cavity is kept exactly.
+  This replaces a global projection after adaptation.
+  Fields with nodes on lower dimensions get ma::createFieldTransfer. */
+SolutionTransfer* createConservativeTransfer(apf::Field* f);
+
 /** \brief a meta-object that carries out a series of transfers
   \details use this class to put together solution transfer
   objects for several fields before giving them to MeshAdapt. */
@@ -94,6 +118,13 @@ class SolutionTransfers : public SolutionTransfer
         apf::MeshElement* parent,
         Vector const& xi, 
         Entity* vert);
+    virtual void onBarycentricVertex(
+        apf::MeshElement* parent,
+        Vector const& xi,
+        int n,
+        Entity** parentVerts,
+        double const* weights,
+        Entity* vert);
     virtual void onRefine(
         Entity* parent,
         EntityArray& newEntities);
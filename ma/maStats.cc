@@ -6,6 +6,8 @@
  */
 #include "maStats.h"
 #include "maAdapt.h"
+#include "maShapeHandler.h"
+#include <PCU.h>
 
 namespace ma {
 
@@ -15,18 +17,27 @@ void getLinearQualitiesInMetricSpace(ma::Mesh* m, ma::SizeField* sf,
   ma::Entity* e;
   ma::Iterator* it;
   it = m->begin(m->getDimension());
-  while( (e = m->iterate(it)) ) {
-    if (! m->isOwned(e))
-      continue;
-    if (! apf::isSimplex(m->getType(e))) // ignore non-simplex elements
-      continue;
-    double lq = ma::measureElementQuality(m, sf, e);
-    if (m->getDimension() == 2)
-      lq = (lq > 0) ? std::sqrt(lq) : -std::sqrt(-lq);
-    else
-      lq = cbrt(lq);
-    linearQualities.push_back(lq);
-  }
+  /* tets are measured in batches */
+  std::vector<ma::Entity*> tets;
+  std::vector<double> q(ma::qualityBatchSize);
+  do {
+    e = m->iterate(it);
+    if (e && m->isOwned(e)) {
+      int type = m->getType(e);
+      if (type == apf::Mesh::TET)
+        tets.push_back(e);
+      else if (type == apf::Mesh::TRIANGLE) {
+        double lq = ma::measureElementQuality(m, sf, e);
+        linearQualities.push_back((lq > 0) ? std::sqrt(lq) : -std::sqrt(-lq));
+      }
+    }
+    if (tets.size() == ma::qualityBatchSize || ( ! e && ! tets.empty())) {
+      ma::measureTetQualities(m, sf, &tets[0], tets.size(), &q[0]);
+      for (size_t i = 0; i < tets.size(); ++i)
+        linearQualities.push_back(cbrt(q[i]));
+      tets.clear();
+    }
+  } while (e);
   m->end(it);
 }
 
@@ -84,14 +95,17 @@ void getLinearQualitiesInPhysicalSpace(ma::Mesh* m,
 void getEdgeLengthsInPhysicalSpace(ma::Mesh* m,
     std::vector<double> &edgeLengths)
 {
+  std::vector<ma::Entity*> edges;
   ma::Entity* e;
   ma::Iterator* it;
   it = m->begin(1);
-  while( (e = m->iterate(it)) ) {
-    SizeField* sf = new IdentitySizeField(m);
-    edgeLengths.push_back(sf->measure(e));
-  }
+  while( (e = m->iterate(it)) )
+    edges.push_back(e);
   m->end(it);
+  size_t first = edgeLengths.size();
+  edgeLengths.resize(first + edges.size());
+  if (!edges.empty())
+    apf::measureSimplices(m, edges.size(), &edges[0], &edgeLengths[first]);
 }
 
 void getStatsInMetricSpace(ma::Mesh* m, ma::SizeField* sf,
@@ -134,4 +148,225 @@ void stats(ma::Mesh* m, ma::SizeField* sf,
     getStatsInPhysicalSpace(m, edgeLengths, linearQualities);
 }
 
+/* lengths go in bins of a quarter power of two,
+   centered on the desired length of one */
+static double const lengthBinsPerOctave = 4;
+
+static int getLengthBin(double l)
+{
+  double x = Report::BINS / 2 + std::floor(std::log2(l) * lengthBinsPerOctave);
+  if (!(x > 0))
+    return 0;
+  return std::min(int(x), int(Report::BINS) - 1);
+}
+
+static double getLengthBinStart(int i)
+{
+  return std::pow(2.0, (i - Report::BINS / 2) / lengthBinsPerOctave);
+}
+
+static int getQualityBin(double q)
+{
+  double x = std::floor(q * Report::BINS);
+  if (!(x > 0))
+    return 0;
+  return std::min(int(x), int(Report::BINS) - 1);
+}
+
+static double getQualityBinStart(int i)
+{
+  return double(i) / Report::BINS;
+}
+
+/* finds the bin holding the (p) fraction of the (n) values and
+   interpolates within it, trusting only the known extremes
+   for the end bins, which also hold the values out of range */
+static double getPercentile(long const* histogram, long n, double p,
+    double min, double max, double (*getBinStart)(int))
+{
+  if (!n)
+    return 0;
+  double target = p * n;
+  long below = 0;
+  int i = 0;
+  for (; i < Report::BINS - 1; ++i) {
+    if (below + histogram[i] >= target)
+      break;
+    below += histogram[i];
+  }
+  double start = i ? getBinStart(i) : min;
+  double end = (i < Report::BINS - 1) ? getBinStart(i + 1) : max;
+  start = std::max(start, min);
+  end = std::min(end, max);
+  if (!histogram[i] || end < start)
+    return start;
+  return start + (end - start) * ((target - below) / histogram[i]);
+}
+
+double Report::getLengthPercentile(double p)
+{
+  return getPercentile(lengthHistogram, edgeCount, p,
+      minLength, maxLength, getLengthBinStart);
+}
+
+double Report::getQualityPercentile(double p)
+{
+  return getPercentile(qualityHistogram, elementCount, p,
+      minQuality, maxQuality, getQualityBinStart);
+}
+
+static void clearReport(Report& r)
+{
+  r.edgeCount = 0;
+  r.minLength = HUGE_VAL;
+  r.maxLength = 0;
+  r.elementCount = 0;
+  r.invalidCount = 0;
+  r.minQuality = HUGE_VAL;
+  r.maxQuality = -HUGE_VAL;
+  for (int i = 0; i < Report::BINS; ++i) {
+    r.lengthHistogram[i] = 0;
+    r.qualityHistogram[i] = 0;
+  }
+}
+
+static void mergeReport(Report& r, Report const& o)
+{
+  r.edgeCount += o.edgeCount;
+  r.minLength = std::min(r.minLength, o.minLength);
+  r.maxLength = std::max(r.maxLength, o.maxLength);
+  r.elementCount += o.elementCount;
+  r.invalidCount += o.invalidCount;
+  r.minQuality = std::min(r.minQuality, o.minQuality);
+  r.maxQuality = std::max(r.maxQuality, o.maxQuality);
+  for (int i = 0; i < Report::BINS; ++i) {
+    r.lengthHistogram[i] += o.lengthHistogram[i];
+    r.qualityHistogram[i] += o.qualityHistogram[i];
+  }
+}
+
+static void addQualities(Adapt* a, Report& r,
+    std::vector<Entity*>& batch, std::vector<double>& q)
+{
+  a->shape->getQualities(&batch[0], batch.size(), &q[0]);
+  for (size_t i = 0; i < batch.size(); ++i) {
+    ++r.elementCount;
+    if (q[i] < a->input->validQuality)
+      ++r.invalidCount;
+    r.minQuality = std::min(r.minQuality, q[i]);
+    r.maxQuality = std::max(r.maxQuality, q[i]);
+    ++r.qualityHistogram[getQualityBin(q[i])];
+  }
+  batch.clear();
+}
+
+/* the elements of one chunk of Mesh::beginChunk, measured in batches */
+static void reportChunk(Adapt* a, int chunk, int chunks, Report& r)
+{
+  Mesh* m = a->mesh;
+  clearReport(r);
+  std::vector<Entity*> batch;
+  std::vector<double> q(qualityBatchSize);
+  Entity* e;
+  Iterator* it = m->beginChunk(m->getDimension(), chunk, chunks);
+  while ((e = m->iterate(it))) {
+    if (!apf::isSimplex(m->getType(e)))
+      continue;
+    batch.push_back(e);
+    if (batch.size() == qualityBatchSize)
+      addQualities(a, r, batch, q);
+  }
+  m->end(it);
+  if (!batch.empty())
+    addQualities(a, r, batch, q);
+}
+
+static int reportThreads = 1;
+
+/* one report per element chunk, filled by one thread each */
+struct ReportChunks
+{
+  static void run(void* p, size_t first, size_t end)
+  {
+    ReportChunks* all = static_cast<ReportChunks*>(p);
+    int chunks = all->reports.size();
+    for (size_t i = first; i < end; ++i)
+      reportChunk(all->adapt, i, chunks, all->reports[i]);
+  }
+  Adapt* adapt;
+  std::vector<Report> reports;
+};
+
+static void reportLocally(Adapt* a, Report& r)
+{
+  Mesh* m = a->mesh;
+  clearReport(r);
+  /* edge lengths may be written to the length cache, so the
+     edges are measured on this thread only */
+  Entity* e;
+  Iterator* it = m->begin(1);
+  while ((e = m->iterate(it))) {
+    if (!m->isOwned(e))
+      continue;
+    double l = a->sizeField->measure(e);
+    ++r.edgeCount;
+    r.minLength = std::min(r.minLength, l);
+    r.maxLength = std::max(r.maxLength, l);
+    ++r.lengthHistogram[getLengthBin(l)];
+  }
+  m->end(it);
+  ReportChunks chunks;
+  chunks.adapt = a;
+  chunks.reports.resize(reportThreads);
+  PCU_Thrd_Chunks(reportThreads, reportThreads, ReportChunks::run, &chunks);
+  for (int i = 0; i < reportThreads; ++i)
+    mergeReport(r, chunks.reports[i]);
+}
+
+void setReportThreads(int threads)
+{
+  reportThreads = threads < 1 ? 1 : threads;
+}
+
+void report(Adapt* a, Report& r)
+{
+  reportLocally(a, r);
+  PCU_Comm_Begin();
+  if (PCU_Comm_Self())
+    PCU_COMM_PACK(0, r);
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    Report o;
+    PCU_COMM_UNPACK(o);
+    mergeReport(r, o);
+  }
+}
+
+static void printHistogram(const char* name, long const* histogram,
+    double (*getBinStart)(int))
+{
+  for (int i = 0; i < Report::BINS; ++i)
+    if (histogram[i])
+      print("%s from %8.3f: %ld", name, getBinStart(i), histogram[i]);
+}
+
+void printReport(Adapt* a)
+{
+  Report r;
+  report(a, r);
+  if (r.edgeCount) {
+    print("edge length min %f max %f, percentiles 5%% %f 50%% %f 95%% %f",
+        r.minLength, r.maxLength, r.getLengthPercentile(0.05),
+        r.getLengthPercentile(0.5), r.getLengthPercentile(0.95));
+    printHistogram("edge length", r.lengthHistogram, getLengthBinStart);
+  }
+  if (r.elementCount) {
+    print("element quality min %e max %f, percentiles 5%% %f 50%% %f 95%% %f",
+        r.minQuality, r.maxQuality, r.getQualityPercentile(0.05),
+        r.getQualityPercentile(0.5), r.getQualityPercentile(0.95));
+    printHistogram("element quality", r.qualityHistogram, getQualityBinStart);
+    print("%ld of %ld elements invalid", r.invalidCount, r.elementCount);
+  }
+}
+
 }
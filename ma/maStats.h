@@ -44,5 +44,45 @@ void stats(ma::Mesh* m, ma::SizeField* sf,
     std::vector<double> &linearQualities,
     bool inMetric);
 
+/** \brief edge lengths and element qualities of a mesh, summarized
+  \details lengths are measured in the metric of the size field and
+  qualities by the shape handler, so both are what adaptation aims at.
+  Lengths are binned on a log2 scale around 1 and qualities on [0,1],
+  each with BINS bins, and values outside the range go to the end bins.
+  Percentiles are interpolated within those bins. */
+struct Report
+{
+  enum { BINS = 20 };
+  long edgeCount;
+  double minLength;
+  double maxLength;
+  long lengthHistogram[BINS];
+  long elementCount;
+  long invalidCount;
+  double minQuality;
+  double maxQuality;
+  long qualityHistogram[BINS];
+  double getLengthPercentile(double p);
+  double getQualityPercentile(double p);
+};
+
+/** \brief fills the report with one sweep over each dimension
+  \details the parts send their summaries to part 0 in one exchange,
+  so on part 0 the report covers the whole mesh and elsewhere only
+  the local part. Only simplex elements are measured, and those below
+  Input::validQuality count as invalid. */
+void report(Adapt* a, Report& r);
+
+/** \brief Set the number of threads that measure elements in report
+  \details each thread takes one chunk of the elements from
+  Mesh::beginChunk, and their summaries are merged. The size field
+  and shape handler must then be safe to evaluate from several
+  threads. The default is one thread.
+  */
+void setReportThreads(int threads);
+
+/** \brief computes and prints the report from part 0 */
+void printReport(Adapt* a);
+
 }
 #endif
@@ -131,6 +131,10 @@ SplitFunction edge_templates[edge_edge_code_count] =
  splitEdge,
 };
 
+/* the number of elements each template makes */
+int const tri_template_sizes[tri_edge_code_count] =
+{1,2,3,4};
+
 SplitFunction tri_templates[tri_edge_code_count] =
 {0,
  splitTri1,
@@ -409,7 +413,10 @@ bool splitTet_prismToTets(
   Vector point;
   apf::mapLocalToGlobal(me,xi,point);
   Entity* vert = prismToTetsBadCase(r,tet,pv,code,point);
-  a->solutionTransfer->onVertex(me,xi,vert);
+  Entity* dv[4];
+  m->getDownward(tet,0,dv);
+  double const weights[4] = {1 - xi[0] - xi[1] - xi[2], xi[0], xi[1], xi[2]};
+  a->solutionTransfer->onBarycentricVertex(me,xi,4,dv,weights,vert);
   a->sizeField->interpolate(me,xi,vert);
   apf::destroyMeshElement(me);
   return false;
@@ -642,6 +649,10 @@ void splitTet_6(Refine* r, Entity* tet, Entity** v)
   }
 }
 
+/* the prisms left by some templates count as three tets */
+int const tet_template_sizes[tet_edge_code_count] =
+{1,2,3,4,4,5,5,4,6,6,7,8};
+
 SplitFunction tet_templates[tet_edge_code_count] =
 {0
 ,splitTet_1    // 1
@@ -27,6 +27,8 @@ void octToTetsGeometric(Refine* r, Entity* parent, Entity** v);
 extern SplitFunction edge_templates[edge_edge_code_count];
 extern SplitFunction tri_templates[tri_edge_code_count];
 extern SplitFunction tet_templates[tet_edge_code_count];
+extern int const tri_template_sizes[tri_edge_code_count];
+extern int const tet_template_sizes[tet_edge_code_count];
 extern SplitFunction quad_templates[quad_edge_code_count];
 extern SplitFunction prism_templates[prism_edge_code_count];
 extern SplitFunction pyramid_templates[pyramid_edge_code_count];
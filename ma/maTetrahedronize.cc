@@ -473,19 +473,57 @@ static void addAllLayerElements(Refine* r)
   PCU_ALWAYS_ASSERT(static_cast<size_t>(nr) == r->toSplit[3].getSize());
 }
 
+/* the acyclic templates turn a quad into two triangles
+   and one diagonal edge, a prism into three tets with two
+   inner triangles and a pyramid into two tets with one.
+   these counts are exact unless a cyclic prism or a bad
+   pyramid needs a centroid, which then grows storage as usual */
+static void reserveForTets(Refine* r)
+{
+  Mesh* m = r->adapt->mesh;
+  size_t n[apf::Mesh::TYPES] = {};
+  for (size_t i = 0; i < r->toSplit[2].getSize(); ++i)
+    if (m->getType(r->toSplit[2][i]) == apf::Mesh::QUAD) {
+      n[apf::Mesh::EDGE] += 1;
+      n[apf::Mesh::TRIANGLE] += 2;
+    }
+  for (size_t i = 0; i < r->toSplit[3].getSize(); ++i) {
+    int type = m->getType(r->toSplit[3][i]);
+    if (type == apf::Mesh::PRISM) {
+      n[apf::Mesh::TRIANGLE] += 2;
+      n[apf::Mesh::TET] += 3;
+    } else if (type == apf::Mesh::PYRAMID) {
+      n[apf::Mesh::TRIANGLE] += 1;
+      n[apf::Mesh::TET] += 2;
+    }
+  }
+  for (int t = 0; t < apf::Mesh::TYPES; ++t)
+    if (n[t])
+      m->reserve(t, n[t]);
+}
+
 /* the commonly reused part of the
    tetrahedronization driver.
    as mentioned above, this uses refinement
    machinery, so these calls are copied
-   from maRefine.cc */
+   from maRefine.cc.
+   with a refineBatchSize the elements are converted
+   and destroyed that many at a time, which bounds the
+   old and new elements alive together */
 void tetrahedronizeCommon(Refine* r)
 {
   resetCollection(r);
   collectForTransfer(r);
   collectForMatching(r);
-  splitElements(r);
-  processNewElements(r);
-  destroySplitElements(r);
+  reserveForTets(r);
+  long batch = r->adapt->input->refineBatchSize;
+  if (batch > 0)
+    refineInBatches(r, batch);
+  else {
+    splitElements(r);
+    processNewElements(r);
+    destroySplitElements(r);
+  }
   cleanupAfter(r);
 }
 
@@ -0,0 +1,323 @@
+/******************************************************************************
+
+  Copyright 2013 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  The LICENSE file included with this distribution describes the terms
+  of the SCOREC Non-Commercial License this program is distributed under.
+
+*******************************************************************************/
+#include <PCU.h>
+#include "ma.h"
+#include "maAdapt.h"
+#include "maMesh.h"
+#include "maSolutionTransfer.h"
+#include <apf.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <pcu_util.h>
+#include <vector>
+
+/* Uniform refinement without the adaptation machinery: every edge
+   splits, so there is no size field to ask, no marking to agree on
+   across parts and no template to match. Each level makes one vertex
+   per edge and then splits edges, triangles and tetrahedra with their
+   fixed templates, in that order, so the splits of the boundary of an
+   entity exist before it is split. Copies of a shared edge make their
+   vertices independently at the same point, one exchange links them,
+   and stitching links the rest. */
+
+namespace ma {
+
+namespace {
+
+class UniformRefine
+{
+  public:
+    UniformRefine(Mesh* m, SolutionTransfer* s):mesh(m),transfer(s)
+    {
+      dimension = m->getDimension();
+      transferDimension = s->getTransferDimension();
+    }
+    void run()
+    {
+      double t0 = PCU_Time();
+      long edges = apf::countOwned(mesh, 1);
+      reserve();
+      gather();
+      makeVerts();
+      for (int d = 1; d <= dimension; ++d)
+        split(d);
+      linkVerts();
+      if (PCU_Comm_Peers() > 1) {
+        apf::stitchMesh(mesh);
+        mesh->acceptChanges();
+      }
+      transferElements();
+      for (size_t i = 0; i < parents[dimension].size(); ++i)
+        destroyClosure(parents[dimension][i]);
+      mesh->destroyTag(numbers);
+      edges = PCU_Add_Long(edges);
+      double t1 = PCU_Time();
+      print("uniformly refined %li edges in %f seconds", edges, t1 - t0);
+    }
+  private:
+    /* a level adds E vertices, 2E + 3F + T edges,
+       4F + 8T triangles and 8T tetrahedra */
+    void reserve()
+    {
+      size_t n[4] = {0, 0, 0, 0};
+      for (int d = 1; d <= dimension; ++d)
+        n[d] = mesh->count(d);
+      mesh->reserve(apf::Mesh::VERTEX, n[1]);
+      mesh->reserve(apf::Mesh::EDGE, 2 * n[1] + 3 * n[2] + n[3]);
+      if (dimension > 1)
+        mesh->reserve(apf::Mesh::TRIANGLE, 4 * n[2] + 8 * n[3]);
+      if (dimension > 2)
+        mesh->reserve(apf::Mesh::TET, 8 * n[3]);
+    }
+    /* the entities to split, listed before any is made,
+       and the edges numbered for finding their vertices */
+    void gather()
+    {
+      numbers = mesh->createIntTag("ma_uniform_number", 1);
+      for (int d = 1; d <= dimension; ++d) {
+        parents[d].reserve(mesh->count(d));
+        Iterator* it = mesh->begin(d);
+        Entity* e;
+        while ((e = mesh->iterate(it)))
+          parents[d].push_back(e);
+        mesh->end(it);
+        children[d].resize(d >= transferDimension ? parents[d].size() : 0);
+      }
+      for (size_t i = 0; i < parents[1].size(); ++i) {
+        int n = i;
+        mesh->setIntTag(parents[1][i], numbers, &n);
+      }
+    }
+    /* the midpoint is (x0 + x1) / 2 on every copy of an edge,
+       whichever way the copy is oriented */
+    void makeVerts()
+    {
+      verts.resize(parents[1].size());
+      double const weights[2] = {0.5, 0.5};
+      Vector xi(0, 0, 0);
+      for (size_t i = 0; i < parents[1].size(); ++i) {
+        Entity* edge = parents[1][i];
+        Entity* ev[2];
+        mesh->getDownward(edge, 0, ev);
+        Vector point = (getPosition(mesh, ev[0]) +
+                        getPosition(mesh, ev[1])) / 2;
+        Vector param(0, 0, 0);
+        verts[i] = mesh->createVertex(mesh->toModel(edge), point, param);
+        apf::MeshElement* me = apf::createMeshElement(mesh, edge);
+        transfer->onBarycentricVertex(me, xi, 2, ev, weights, verts[i]);
+        apf::destroyMeshElement(me);
+      }
+    }
+    Entity* getVert(Entity* edge)
+    {
+      int n;
+      mesh->getIntTag(edge, numbers, &n);
+      return verts[n];
+    }
+    /* the vertex of the edge from v0 to v1 among the (n) edges
+       of an element, which is cheaper than searching upward */
+    Entity* getVert(int n, Entity** edges, Entity* v0, Entity* v1)
+    {
+      int i;
+      for (i = 0; i < n; ++i) {
+        Entity* ev[2];
+        mesh->getDownward(edges[i], 0, ev);
+        if ((ev[0] == v0 && ev[1] == v1) || (ev[0] == v1 && ev[1] == v0))
+          break;
+      }
+      PCU_ALWAYS_ASSERT(i < n);
+      return getVert(edges[i]);
+    }
+    Entity* build(Entity* parent, int type, Entity** v, NewEntities* cb)
+    {
+      return apf::buildElement(mesh, mesh->toModel(parent), type, v, cb);
+    }
+    void splitEdge(Entity* edge, NewEntities* cb)
+    {
+      Entity* v[2];
+      mesh->getDownward(edge, 0, v);
+      Entity* mid = getVert(edge);
+      if (cb)
+        cb->call(mid);
+      Entity* ev[2] = {v[0], mid};
+      build(edge, apf::Mesh::EDGE, ev, cb);
+      ev[0] = mid; ev[1] = v[1];
+      build(edge, apf::Mesh::EDGE, ev, cb);
+    }
+    /* the template of splitTri3 */
+    void splitTri(Entity* face, NewEntities* cb)
+    {
+      Entity* v[3];
+      mesh->getDownward(face, 0, v);
+      Entity* e[3];
+      mesh->getDownward(face, 1, e);
+      Entity* sv[3];
+      for (int i = 0; i < 3; ++i)
+        sv[i] = getVert(3, e, v[i], v[(i + 1) % 3]);
+      Entity* tv[3] = {sv[0], sv[1], sv[2]};
+      build(face, apf::Mesh::TRIANGLE, tv, cb);
+      for (int i = 0; i < 3; ++i) {
+        tv[0] = v[i]; tv[1] = sv[i]; tv[2] = sv[(i + 2) % 3];
+        build(face, apf::Mesh::TRIANGLE, tv, cb);
+      }
+    }
+    /* the template of splitTet_6: four corner tetrahedra and
+       an octahedron split along its shortest diagonal */
+    void splitTet(Entity* tet, NewEntities* cb)
+    {
+      Entity* v[4];
+      mesh->getDownward(tet, 0, v);
+      Entity* e[6];
+      mesh->getDownward(tet, 1, e);
+      /* the vertices of the octahedron are numbered
+         as the tetrahedron edges they split */
+      Entity* ov[6];
+      for (int i = 0; i < 6; ++i)
+        ov[i] = getVert(6, e, v[apf::tet_edge_verts[i][0]],
+                        v[apf::tet_edge_verts[i][1]]);
+      int n = 0;
+      double shortest = 0;
+      for (int i = 0; i < 3; ++i) {
+        double l = (getPosition(mesh, ov[i]) -
+                    getPosition(mesh, ov[i == 0 ? 5 : i + 2])).getLength();
+        if (i == 0 || l < shortest) {
+          shortest = l;
+          n = i;
+        }
+      }
+      Entity* rov[6];
+      rotateOct(ov, n * 4, rov);
+      for (int i = 0; i < 4; ++i) {
+        Entity* v2[6];
+        rotateOct(rov, i, v2);
+        Entity* tv[4] = {v2[0], v2[1], v2[2], v2[5]};
+        build(tet, apf::Mesh::TET, tv, cb);
+      }
+      for (int i = 0; i < 4; ++i) {
+        Entity* v2[4];
+        rotateTet(v, i * 3, v2);
+        Entity* tv[4];
+        tv[0] = v2[0];
+        for (int j = 1; j < 4; ++j)
+          tv[j] = getVert(6, e, v2[0], v2[j]);
+        build(tet, apf::Mesh::TET, tv, cb);
+      }
+    }
+    void split(int d)
+    {
+      NewEntities cb;
+      bool collect = !children[d].empty();
+      for (size_t i = 0; i < parents[d].size(); ++i) {
+        Entity* e = parents[d][i];
+        if (collect)
+          cb.reset();
+        NewEntities* c = collect ? &cb : 0;
+        int type = mesh->getType(e);
+        if (type == apf::Mesh::EDGE)
+          splitEdge(e, c);
+        else if (type == apf::Mesh::TRIANGLE)
+          splitTri(e, c);
+        else
+          splitTet(e, c);
+        if (collect)
+          cb.retrieve(children[d][i]);
+      }
+    }
+    /* the one exchange: each copy of a shared edge
+       tells the others which vertex it made */
+    void linkVerts()
+    {
+      if (PCU_Comm_Peers() == 1)
+        return;
+      PCU_Comm_Begin();
+      for (size_t i = 0; i < parents[1].size(); ++i) {
+        Entity* e = parents[1][i];
+        if (!mesh->isShared(e))
+          continue;
+        apf::Copies remotes;
+        mesh->getRemotes(e, remotes);
+        APF_ITERATE(apf::Copies, remotes, rit) {
+          PCU_COMM_PACK(rit->first, rit->second);
+          PCU_COMM_PACK(rit->first, verts[i]);
+        }
+      }
+      PCU_Comm_Send();
+      while (PCU_Comm_Receive()) {
+        Entity* e;
+        Entity* v;
+        PCU_COMM_UNPACK(e);
+        PCU_COMM_UNPACK(v);
+        mesh->addRemote(getVert(e), PCU_Comm_Sender(), v);
+      }
+    }
+    void transferElements()
+    {
+      for (int d = transferDimension; d <= dimension; ++d)
+        for (size_t i = 0; i < children[d].size(); ++i)
+          transfer->onRefine(parents[d][i], children[d][i]);
+    }
+    /* destroys an old element and what it leaves unused */
+    void destroyClosure(Entity* e)
+    {
+      int d = getDimension(mesh, e);
+      if (d < dimension && mesh->hasUp(e))
+        return;
+      Downward down;
+      int nd = d ? mesh->getDownward(e, d - 1, down) : 0;
+      mesh->destroy(e);
+      for (int i = 0; i < nd; ++i)
+        destroyClosure(down[i]);
+    }
+    Mesh* mesh;
+    SolutionTransfer* transfer;
+    int dimension;
+    int transferDimension;
+    apf::MeshTag* numbers;
+    std::vector<Entity*> parents[4];
+    std::vector<EntityArray> children[4];
+    std::vector<Entity*> verts;
+};
+
+}
+
+bool canRefineUniformly(Mesh* m)
+{
+  int dim = m->getDimension();
+  int const types[4] = {apf::Mesh::VERTEX, apf::Mesh::EDGE,
+                        apf::Mesh::TRIANGLE, apf::Mesh::TET};
+  int ok = m->count(dim) == m->countType(types[dim]) &&
+           ! m->hasMatching() &&
+           ! m->canSnap() &&
+           m->getShape()->getOrder() == 1;
+  return PCU_Min_Int(ok);
+}
+
+void refineUniformly(Mesh* m, int n, SolutionTransfer* s)
+{
+  PCU_Region region("ma::refineUniformly");
+  PCU_ALWAYS_ASSERT(canRefineUniformly(m));
+  double t0 = PCU_Time();
+  AutoSolutionTransfer* automatic = 0;
+  if (!s)
+    s = automatic = new AutoSolutionTransfer(m);
+  for (int i = 0; i < n; ++i) {
+    UniformRefine r(m, s);
+    r.run();
+  }
+  delete automatic;
+  apf::StatsReduction* stats = apf::beginStats(m);
+  double t1 = PCU_Time();
+  print("mesh refined uniformly in %f seconds", t1 - t0);
+  apf::MeshStats st;
+  apf::endStats(stats, st);
+  apf::printStats(st);
+}
+
+}
@@ -45,6 +45,8 @@ set(SOURCES
   maExtrude.cc
   maDBG.cc
   maStats.cc
+  maProfile.cc
+  maUniform.cc
 )
 
 set(HEADERS
@@ -58,6 +60,7 @@ set(HEADERS
   maExtrude.h
   maDBG.h
   maStats.h
+  maProfile.h
 )
 
 # THIS IS WHERE TRIBITS GETS HEADERS
@@ -2,6 +2,7 @@
 
 #include "apfMDS.h"
 #include <gmi_lookup.h>
+#include <PCU.h>
 #include <pcu_util.h>
 #include <cstdlib>
 
@@ -66,11 +67,17 @@ int Grid::in(Indices is)
 
 BoxBuilder::BoxBuilder(int nx, int ny, int nz,
       double wx, double wy, double wz,
-      bool is):
+      bool is, bool distributed):
   grid(nx + 1, ny + 1, nz + 1),
-  mgrid(nx ? 3 : 1, ny ? 3 : 1, nz ? 3 : 1)
+  mgrid(nx ? 3 : 1, ny ? 3 : 1, nz ? 3 : 1),
+  origin(0, 0, 0),
+  globalSize(nx + 1, ny + 1, nz + 1),
+  parts(1, 1, 1),
+  block(0, 0, 0)
 {
   for (dim = 0; dim < 3 && grid.size[dim] > 1; ++dim);
+  if (distributed)
+    splitGrid();
   w[0] = nx ? (wx / nx) : 0;
   w[1] = ny ? (wy / ny) : 0;
   w[2] = nz ? (wz / nz) : 0;
@@ -82,6 +89,28 @@ BoxBuilder::BoxBuilder(int nx, int ny, int nz,
   buildMeshAndModel();
 }
 
+/* cuts the box into a grid of blocks, one per part, and
+   keeps only the vertices of this part's block */
+void BoxBuilder::splitGrid()
+{
+  int dims[3] = {0, 0, 0};
+  for (int i = dim; i < 3; ++i)
+    dims[i] = 1;
+  MPI_Dims_create(PCU_Comm_Peers(), 3, dims);
+  int self = PCU_Comm_Self();
+  parts = Indices(dims[0], dims[1], dims[2]);
+  block = Indices(self % dims[0], (self / dims[0]) % dims[1],
+      self / (dims[0] * dims[1]));
+  Indices size(1, 1, 1);
+  for (int i = 0; i < dim; ++i) {
+    long cells = globalSize[i] - 1;
+    PCU_ALWAYS_ASSERT(cells >= parts[i]);
+    origin[i] = cells * block[i] / parts[i];
+    size[i] = cells * (block[i] + 1) / parts[i] - origin[i] + 1;
+  }
+  grid = Grid(size.x, size.y, size.z);
+}
+
 void BoxBuilder::formModelTable()
 {
   int nd[4] = {0,0,0,0};
@@ -102,7 +131,7 @@ int BoxBuilder::getModelIndex(int i, int d)
 {
   if (i == 0)
     return 0;
-  if (i == grid.size[d] - 1)
+  if (i == globalSize[d] - 1)
     return 2;
   return 1;
 }
@@ -111,7 +140,7 @@ Indices BoxBuilder::getModelIndices(Indices vi)
 {
   Indices mi;
   for (int i = 0; i < 3; ++i)
-    mi[i] = getModelIndex(vi[i], i);
+    mi[i] = getModelIndex(origin[i] + vi[i], i);
   return mi;
 }
 
@@ -179,7 +208,8 @@ void BoxBuilder::buildCellVert(int i)
 {
   Indices vi = grid.out(i);
   v[i] = m->createVert(getModelEntity(getModelIndices(vi)));
-  Vector3 pt(w[0] * vi.x, w[1] * vi.y, w[2] * vi.z);
+  Indices gi = vi + origin;
+  Vector3 pt(w[0] * gi.x, w[1] * gi.y, w[2] * gi.z);
   m->setPoint(v[i], 0, pt);
 }
 
@@ -195,7 +225,7 @@ void BoxBuilder::buildCellEdges(int i)
   MeshEntity* ev[2];
   ev[0] = getVert(vi);
   for (int j = 0; j < 3; ++j) {
-    if (mi[j] == mgrid.size[j] - 1)
+    if (vi[j] == grid.size[j] - 1)
       continue;
     ev[1] = getVert(vi + Indices::unit(j));
     Indices emi = mi;
@@ -230,8 +260,8 @@ void BoxBuilder::buildCellFaces(int i)
   fv[0] = getVert(vi);
   for (int jx = 0; jx < 3; ++jx) {
     int jy = (jx + 1) % 3;
-    if (mi[jx] == mgrid.size[jx] - 1 ||
-        mi[jy] == mgrid.size[jy] - 1)
+    if (vi[jx] == grid.size[jx] - 1 ||
+        vi[jy] == grid.size[jy] - 1)
       continue;
     fv[1] = getVert(vi + Indices::unit(jx));
     fv[2] = getVert(vi + Indices::unit(jx) + Indices::unit(jy));
@@ -277,10 +307,9 @@ void BoxBuilder::buildRegion(MeshEntity* rv[8], ModelEntity* me)
 void BoxBuilder::buildCellRegion(int i)
 {
   Indices vi = grid.out(i);
-  Indices mi = getModelIndices(vi);
-  if (mi.x == mgrid.size.x - 1 ||
-      mi.y == mgrid.size.y - 1 ||
-      mi.z == mgrid.size.z - 1)
+  if (vi.x == grid.size.x - 1 ||
+      vi.y == grid.size.y - 1 ||
+      vi.z == grid.size.z - 1)
     return;
   MeshEntity* rv[8];
   rv[0] = getVert(Indices(vi.x + 0, vi.y + 0, vi.z + 0));
@@ -319,10 +348,55 @@ void BoxBuilder::buildDimension(int d)
     buildCell(i, d);
 }
 
+int BoxBuilder::getPart(Indices bi)
+{
+  return bi.x + parts.x * (bi.y + parts.y * bi.z);
+}
+
+/* sends each vertex on the side of the block to every
+   neighboring block that has it too, by its global indices,
+   leaving the other entities to apf::stitchMesh */
+void BoxBuilder::shareVerts()
+{
+  PCU_Comm_Begin();
+  for (int i = 0; i < grid.total(); ++i) {
+    Indices vi = grid.out(i);
+    Indices lo, hi;
+    for (int j = 0; j < 3; ++j) {
+      lo[j] = (vi[j] == 0 && block[j] > 0) ? -1 : 0;
+      hi[j] = (vi[j] == grid.size[j] - 1 && block[j] < parts[j] - 1) ? 1 : 0;
+    }
+    Indices gi = vi + origin;
+    Indices di;
+    for (di.z = lo.z; di.z <= hi.z; ++di.z)
+    for (di.y = lo.y; di.y <= hi.y; ++di.y)
+    for (di.x = lo.x; di.x <= hi.x; ++di.x) {
+      if (!di.x && !di.y && !di.z)
+        continue;
+      int to = getPart(block + di);
+      PCU_COMM_PACK(to, gi);
+      PCU_COMM_PACK(to, v[i]);
+    }
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    Indices gi;
+    MeshEntity* remote;
+    PCU_COMM_UNPACK(gi);
+    PCU_COMM_UNPACK(remote);
+    Indices vi(gi.x - origin.x, gi.y - origin.y, gi.z - origin.z);
+    m->addRemote(getVert(vi), PCU_Comm_Sender(), remote);
+  }
+}
+
 void BoxBuilder::buildMeshAndModel()
 {
   for (int d = 0; d <= dim; ++d)
     buildDimension(d);
+  if (parts.x * parts.y * parts.z > 1) {
+    shareVerts();
+    stitchMesh(m);
+  }
   m->acceptChanges();
 }
 
@@ -334,4 +408,12 @@ Mesh2* makeMdsBox(
   return bb.m;
 }
 
+Mesh2* makeDistributedMdsBox(
+    int nex, int ney, int nez,
+    double wx, double wy, double wz, bool is)
+{
+  BoxBuilder bb(nex, ney, nez, wx, wy, wz, is, true);
+  return bb.m;
+}
+
 }
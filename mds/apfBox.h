@@ -28,8 +28,16 @@ struct Grid {
 
 struct BoxBuilder
 {
+  /* the vertices this part builds */
   Grid grid;
   Grid mgrid;
+  /* global indices of the first local vertex */
+  Indices origin;
+  /* vertices in the whole box */
+  Indices globalSize;
+  /* the grid of parts and this part's place in it */
+  Indices parts;
+  Indices block;
   int dim;
   double w[3];
   bool is_simplex;
@@ -39,7 +47,8 @@ struct BoxBuilder
   std::vector<MeshEntity*> v;
   BoxBuilder(int nx, int ny, int nz,
       double wx, double wy, double wz,
-      bool is);
+      bool is, bool distributed = false);
+  void splitGrid();
   void formModelTable();
   void addModelUse(gmi_base* gb, agm_bdry ab, Indices di);
   gmi_model* buildModel();
@@ -58,6 +67,8 @@ struct BoxBuilder
   void buildCellRegion(int i);
   void buildCell(int i, int d);
   void buildDimension(int d);
+  int getPart(Indices bi);
+  void shareVerts();
   void buildMeshAndModel();
 };
 
@@ -73,6 +84,16 @@ struct BoxBuilder
 Mesh2* makeMdsBox(
     int nx, int ny, int nz, double wx, double wy, double wz, bool is);
 
+/** \brief create a box with one block of it on each part
+  \details takes the same arguments as apf::makeMdsBox and gives
+   the same mesh, but each part builds only its own block of the
+   structured grid, with remote copies to the neighboring blocks,
+   so no part ever holds the whole box and nothing is migrated.
+   The parts are arranged in a grid chosen by MPI_Dims_create and
+   each must get at least one element across in every direction. */
+Mesh2* makeDistributedMdsBox(
+    int nx, int ny, int nz, double wx, double wy, double wz, bool is);
+
 }
 
 #endif
@@ -9,15 +9,11 @@
 *******************************************************************************/
 
 #include <PCU.h>
-#include "apfMDS.h"
-#include "mds_apf.h"
-#include "apfPM.h"
-#include <apfMesh2.h>
-#include <apfConvert.h>
-#include <apfShape.h>
+#include "apfMDSMesh.h"
 #include <apfNumbering.h>
 #include <apfPartition.h>
 #include <apfFile.h>
+#include <pcu_io.h>
 #include <cstring>
 #include <pcu_util.h>
 #include <cstdlib>
@@ -93,696 +89,6 @@ static int getEdgeIdInFace(apf::Mesh* mesh, apf::MeshEntity* face,
   return 12; // Should give segmentation fault
 }
 
-static MeshEntity* toEnt(mds_id id)
-{
-  //for pointers 0 is null, but mds_id 0 is ok and -1 is null
-  return reinterpret_cast<MeshEntity*>(((char*)1) + id);
-}
-
-static mds_id fromEnt(MeshEntity* e)
-{
-  return (reinterpret_cast<char*>(e) - ((char*)1));
-}
-
-static MeshIterator* makeIter()
-{
-  mds_id* p = new mds_id;
-  return reinterpret_cast<MeshIterator*>(p);
-}
-
-static void freeIter(MeshIterator* it)
-{
-  mds_id* p = reinterpret_cast<mds_id*>(it);
-  delete p;
-}
-
-static void toIter(mds_id id, MeshIterator* it)
-{
-  *(reinterpret_cast<mds_id*>(it)) = id;
-}
-
-static mds_id fromIter(MeshIterator* it)
-{
-  return *(reinterpret_cast<mds_id*>(it));
-}
-
-static Mesh::Type mds2apf(int t_mds)
-{
-  static Mesh::Type const table[MDS_TYPES] =
-  {Mesh::VERTEX
-  ,Mesh::EDGE
-  ,Mesh::TRIANGLE
-  ,Mesh::QUAD
-  ,Mesh::PRISM
-  ,Mesh::PYRAMID
-  ,Mesh::TET
-  ,Mesh::HEX};
-  return table[t_mds];
-
-}
-
-static int apf2mds(int t_apf)
-{
-  static int const table[Mesh::TYPES] =
-  {MDS_VERTEX
-  ,MDS_EDGE
-  ,MDS_TRIANGLE
-  ,MDS_QUADRILATERAL
-  ,MDS_TETRAHEDRON
-  ,MDS_HEXAHEDRON
-  ,MDS_WEDGE
-  ,MDS_PYRAMID
-  };
-  return table[t_apf];
-}
-
-class MeshMDS : public Mesh2
-{
-  public:
-    MeshMDS()
-    {
-      mesh = 0;
-      isMatched = false;
-      ownsModel = false;
-    }
-    MeshMDS(gmi_model* m, int d, bool isMatched_)
-    {
-      init(apf::getLagrange(1));
-      mds_id cap[MDS_TYPES] = {};
-      mesh = mds_apf_create(m, d, cap);
-      isMatched = isMatched_;
-      ownsModel = true;
-    }
-    MeshMDS(gmi_model* m, Mesh* from)
-    {
-      init(apf::getLagrange(1));
-      mds_id cap[MDS_TYPES];
-      cap[MDS_VERTEX] = from->count(0);
-      cap[MDS_EDGE] = from->count(1);
-      cap[MDS_TRIANGLE] = countEntitiesOfType(from,TRIANGLE);
-      cap[MDS_QUADRILATERAL] = countEntitiesOfType(from,QUAD);
-      cap[MDS_WEDGE] = countEntitiesOfType(from,PRISM);
-      cap[MDS_PYRAMID] = countEntitiesOfType(from,PYRAMID);
-      cap[MDS_TETRAHEDRON] = countEntitiesOfType(from,TET);
-      cap[MDS_HEXAHEDRON] = countEntitiesOfType(from,HEX);
-      int d = from->getDimension();
-      mesh = mds_apf_create(m,d,cap);
-      isMatched = from->hasMatching();
-      ownsModel = true;
-      apf::convert(from,this);
-    }
-    MeshMDS(gmi_model* m, const char* pathname)
-    {
-      init(apf::getLagrange(1));
-      mesh = mds_read_smb(m, pathname, 0, this);
-      isMatched = PCU_Or(!mds_net_empty(&mesh->matches));
-      ownsModel = true;
-    }
-    ~MeshMDS()
-    {
-      if (mesh)
-        destroyNative();
-    }
-    int getDimension()
-    {
-      return mesh->mds.d;
-    }
-    std::size_t count(int dimension)
-    {
-      mds_id c = 0;
-      for (int t = 0; t < MDS_TYPES; ++t)
-        if (mds_dim[t] == dimension)
-          c += mesh->mds.n[t];
-      return c;
-    }
-    MeshIterator* begin(int dimension)
-    {
-      mds_id id = mds_begin(&(mesh->mds),dimension);
-      MeshIterator* it = makeIter();
-      toIter(id,it);
-      return it;
-    }
-    MeshEntity* iterate(MeshIterator* it)
-    {
-      mds_id id = fromIter(it);
-      if (id == MDS_NONE)
-        return 0;
-      MeshEntity* e = toEnt(id);
-      id = mds_next(&(mesh->mds),id);
-      toIter(id,it);
-      return e;
-    }
-    void end(MeshIterator* it)
-    {
-      freeIter(it);
-    }
-    // return true if adjacency *from_dim <--> to_dim*  is stored
-    bool hasAdjacency(int from_dim, int to_dim)
-    {
-      return (mesh->mds.mrm[from_dim][to_dim] == 1);
-    }
-
-    // store adjacency *from_dim <--> to_dim* if not stored
-    void createAdjacency(int from_dim, int to_dim)
-    {
-      if (mesh->mds.mrm[from_dim][to_dim] != 1)
-        mds_add_adjacency(&(mesh->mds), from_dim, to_dim);
-    }
-    // remove adjacency *from_dim <--> to_dim* except for one-level apart adjacency
-    void deleteAdjacency(int from_dim, int to_dim)
-    {
-      if (mesh->mds.mrm[from_dim][to_dim] == 1 && (abs(from_dim-to_dim)>1))
-        mds_remove_adjacency(&(mesh->mds), from_dim, to_dim);
-    }
-    bool isShared(MeshEntity* e)
-    {
-      return mds_get_copies(&mesh->remotes, fromEnt(e));
-    }
-    bool isGhost(MeshEntity* e)
-    {
-      MeshTag* t = findTag("ghost_tag");
-      if (t && hasTag(e, t))
-        return true;
-      return false;
-    }
-
-    void deleteGhost(MeshEntity* e)
-    {
-      mds_set_copies(&mesh->ghosts, &mesh->mds, fromEnt(e), NULL);
-    }
-
-    bool isGhosted(MeshEntity* e)
-    {
-      MeshTag* t = findTag("ghosted_tag");
-      if (t && hasTag(e, t))
-        return true;
-      return false;
-    }
-
-    bool isOwned(MeshEntity* e)
-    {
-      return getId() == getOwner(e);
-    }
-
-    int getOwner(MeshEntity* e)
-    {
-      void* vp = mds_get_part(mesh, fromEnt(e));
-      PME* p = static_cast<PME*>(vp);
-      return p->owner;
-    }
-
-    void getAdjacent(MeshEntity* e, int dimension, Adjacent& adjacent)
-    {
-      mds_set s;
-      mds_id id = fromEnt(e);
-      mds_get_adjacent(&(mesh->mds),id,dimension,&s);
-      adjacent.setSize(s.n);
-      for (int i = 0; i < s.n; ++i)
-        adjacent[i] = toEnt(s.e[i]);
-    }
-    int getDownward(MeshEntity* e, int dimension, MeshEntity** adjacent)
-    {
-      PCU_ALWAYS_ASSERT((0 <= dimension) && (dimension <= 3));
-      mds_set s;
-      mds_id id = fromEnt(e);
-      mds_get_adjacent(&(mesh->mds),id,dimension,&s);
-      for (int i = 0; i < s.n; ++i)
-        adjacent[i] = toEnt(s.e[i]);
-      return s.n;
-    }
-    int countUpward(MeshEntity* e)
-    {
-      mds_set s;
-      mds_id id = fromEnt(e);
-      mds_get_adjacent(&(mesh->mds),id,mds_dim[mds_type(id)] + 1,&s);
-      return s.n;
-    }
-    MeshEntity* getUpward(MeshEntity* e, int i)
-    {
-      mds_set s;
-      mds_id id = fromEnt(e);
-      mds_get_adjacent(&(mesh->mds),id,mds_dim[mds_type(id)] + 1,&s);
-      PCU_ALWAYS_ASSERT(i < s.n);
-      return toEnt(s.e[i]);
-    }
-    void getUp(MeshEntity* e, Up& up)
-    {
-      mds_set s;
-      mds_id id = fromEnt(e);
-      mds_get_adjacent(&(mesh->mds),id,mds_dim[mds_type(id)] + 1,&s);
-      up.n = s.n;
-      for (int i = 0; i < s.n; ++i)
-        up.e[i] = toEnt(s.e[i]);
-    }
-    bool hasUp(MeshEntity* e)
-    {
-      return mds_has_up(&(mesh->mds),fromEnt(e));
-    }
-    void getPoint_(MeshEntity* e, int, Vector3& point)
-    {
-      mds_id id = fromEnt(e);
-      point = Vector3(mds_apf_point(mesh,id));
-    }
-    void setPoint_(MeshEntity* e, int, Vector3 const& p)
-    {
-      mds_id id = fromEnt(e);
-      p.toArray(mds_apf_point(mesh,id));
-    }
-    void getParam(MeshEntity* e, Vector3& p)
-    {
-      mds_id id = fromEnt(e);
-      double* p2 = mds_apf_param(mesh,id);
-      p[0] = p2[0];
-      p[1] = p2[1];
-    }
-    void setParam(MeshEntity* e, Vector3 const& p)
-    {
-      mds_id id = fromEnt(e);
-      double* p2 = mds_apf_param(mesh,id);
-      p2[0] = p[0];
-      p2[1] = p[1];
-    }
-    Type getType(MeshEntity* e)
-    {
-      return mds2apf(mds_type(fromEnt(e)));
-    }
-    void getRemotes(MeshEntity* e, Copies& remotes)
-    {
-      if (!isShared(e))
-        return;
-      mds_copies* c = mds_get_copies(&mesh->remotes, fromEnt(e));
-      PCU_ALWAYS_ASSERT(c != NULL);
-      for (int i = 0; i < c->n; ++i)
-        remotes[c->c[i].p] = toEnt(c->c[i].e);
-    }
-
-// seol
-    int getGhosts(MeshEntity* e, Copies& ghosts)
-    {
-      mds_copies* c = mds_get_copies(&mesh->ghosts, fromEnt(e));
-      if (c==NULL) return 0;
-      for (int i = 0; i < c->n; ++i)
-        ghosts[c->c[i].p] = toEnt(c->c[i].e);
-      return c->n;
-    }
-
-    void getResidence(MeshEntity* e, Parts& residence)
-    {
-      void* vp = mds_get_part(mesh, fromEnt(e));
-      PME* p = static_cast<PME*>(vp);
-      for (size_t i = 0; i < p->ids.size(); ++i)
-        residence.insert(p->ids[i]);
-    }
-    MeshTag* createDoubleTag(const char* name, int size)
-    {
-      mds_tag* tag;
-      PCU_ALWAYS_ASSERT(!mds_find_tag(&mesh->tags, name));
-      tag = mds_create_tag(&(mesh->tags),name,
-          sizeof(double)*size, Mesh::DOUBLE);
-      return reinterpret_cast<MeshTag*>(tag);
-    }
-    MeshTag* createIntTag(const char* name, int size)
-    {
-      mds_tag* tag;
-      PCU_ALWAYS_ASSERT(!mds_find_tag(&mesh->tags, name));
-      tag = mds_create_tag(&(mesh->tags),name,
-          sizeof(int)*size, Mesh::INT);
-      return reinterpret_cast<MeshTag*>(tag);
-    }
-    MeshTag* createLongTag(const char* name, int size)
-    {
-      mds_tag* tag;
-      PCU_ALWAYS_ASSERT(!mds_find_tag(&mesh->tags, name));
-      tag = mds_create_tag(&(mesh->tags),name,
-          sizeof(long)*size, Mesh::LONG);
-      return reinterpret_cast<MeshTag*>(tag);
-    }
-    MeshTag* findTag(const char* name)
-    {
-      mds_tag* tag;
-      tag = mds_find_tag(&(mesh->tags),name);
-      return reinterpret_cast<MeshTag*>(tag);
-    }
-    void destroyTag(MeshTag* t)
-    {
-      mds_tag* tag;
-      tag = reinterpret_cast<mds_tag*>(t);
-      mds_destroy_tag(&(mesh->tags),tag);
-    }
-    void getTags(DynamicArray<MeshTag*>& tags)
-    {
-      int c = 0;
-      for (mds_tag* t = mesh->tags.first; t; t = t->next)
-        ++c;
-      tags.setSize(c);
-      c = 0;
-      for (mds_tag* t = mesh->tags.first; t; t = t->next)
-        tags[c++] = reinterpret_cast<MeshTag*>(t);
-    }
-    void getTag(MeshEntity* e, MeshTag* t, void* data)
-    {
-      if (!hasTag(e,t)) {
-        fprintf(stderr, "expected tag \"%s\" on entity type %d\n",
-            getTagName(t), getType(e));
-        abort();
-      }
-      mds_tag* tag;
-      tag = reinterpret_cast<mds_tag*>(t);
-      mds_id id = fromEnt(e);
-      memcpy(data,mds_get_tag(tag,id),tag->bytes);
-    }
-    void setTag(MeshEntity* e, MeshTag* t, void const* data)
-    {
-      mds_tag* tag;
-      tag = reinterpret_cast<mds_tag*>(t);
-      mds_id id = fromEnt(e);
-      if ( ! mds_has_tag(tag,id))
-        mds_give_tag(tag,&(mesh->mds),id);
-      memcpy(mds_get_tag(tag,id),data,tag->bytes);
-    }
-    void getDoubleTag(MeshEntity* e, MeshTag* tag, double* data)
-    {
-      getTag(e,tag,data);
-    }
-    void setDoubleTag(MeshEntity* e, MeshTag* tag, double const* data)
-    {
-      setTag(e,tag,data);
-    }
-    void getIntTag(MeshEntity* e, MeshTag* tag, int* data)
-    {
-      getTag(e,tag,data);
-    }
-    void setIntTag(MeshEntity* e, MeshTag* tag, int const* data)
-    {
-      setTag(e,tag,data);
-    }
-    void getLongTag(MeshEntity* e, MeshTag* tag, long* data)
-    {
-      getTag(e,tag,data);
-    }
-    void setLongTag(MeshEntity* e, MeshTag* tag, long const* data)
-    {
-      setTag(e,tag,data);
-    }
-    void removeTag(MeshEntity* e, MeshTag* t)
-    {
-      mds_tag* tag;
-      tag = reinterpret_cast<mds_tag*>(t);
-      mds_id id = fromEnt(e);
-      mds_take_tag(tag,id);
-    }
-    bool hasTag(MeshEntity* e, MeshTag* t)
-    {
-      mds_tag* tag;
-      tag = reinterpret_cast<mds_tag*>(t);
-      mds_id id = fromEnt(e);
-      return mds_has_tag(tag,id);
-    }
-    int getTagType(MeshTag* t)
-    {
-      mds_tag* tag;
-      tag = reinterpret_cast<mds_tag*>(t);
-      return tag->user_type;
-    }
-    int getTagSize(MeshTag* t)
-    {
-      mds_tag* tag;
-      tag = reinterpret_cast<mds_tag*>(t);
-      size_t const table[3] =
-      {sizeof(double),sizeof(int),sizeof(long)};
-      return tag->bytes / table[tag->user_type];
-    }
-    const char* getTagName(MeshTag* t)
-    {
-      mds_tag* tag;
-      tag = reinterpret_cast<mds_tag*>(t);
-      return tag->name;
-    }
-    void renameTag(MeshTag* t, const char* newName)
-    {
-      mds_tag* tag;
-      tag = reinterpret_cast<mds_tag*>(t);
-      mds_rename_tag(tag,newName);
-    }
-    /* \brief 16 bit additive checksum of a tag
-     * \remark the code is from
-     *  http://barrgroup.com/Embedded-Systems/How-To/Additive-Checksums
-     */
-    unsigned getTagChecksum(MeshTag* t, int type)
-    {
-      mds_tag* tag;
-      tag = reinterpret_cast<mds_tag*>(t);
-      /* count the number of 'live' indices */
-      int numLive = 0;
-      for (int i=0; i < mesh->mds.end[type]; ++i) {
-        if (mesh->mds.free[type][i] == MDS_LIVE)
-          numLive++;
-      }
-      int nWords = numLive / sizeof(uint16_t);
-      uint16_t* data = reinterpret_cast<uint16_t*>(tag->data[type]);
-      uint32_t sum = 0;
-      while (nWords-- > 0)
-        sum += *(data++);
-      /* Use carries to compute 1's complement sum. */
-      sum = (sum >> 16) + (sum & 0xFFFF);
-      sum += sum >> 16;
-      /* Return the inverted 16-bit result.  */
-      return ((unsigned) ~sum);
-    }
-    ModelEntity* toModel(MeshEntity* e)
-    {
-      return reinterpret_cast<ModelEntity*>(mds_apf_model(mesh, fromEnt(e)));
-    }
-    gmi_model* getModel()
-    {
-      return mesh->user_model;
-    }
-    void acceptChanges()
-    {
-      updateOwners(this, pmodel);
-    }
-
-    void migrate(Migration* plan)
-    {
-      apf::migrate(this,plan);
-    }
-    int getId()
-    {
-      return PCU_Comm_Self();
-    }
-    void writeNative(const char* fileName)
-    {
-      double t0 = PCU_Time();
-      mesh = mds_write_smb(mesh, fileName, 0, this);
-      double t1 = PCU_Time();
-      if (!PCU_Comm_Self())
-        printf("mesh %s written in %f seconds\n", fileName, t1 - t0);
-    }
-    void destroyNative()
-    {
-      while (this->countFields())
-        apf::destroyField(this->getField(0));
-      while (this->countNumberings())
-        apf::destroyNumbering(this->getNumbering(0));
-      apf::destroyField(coordinateField);
-      coordinateField = 0;
-      gmi_model* model = static_cast<gmi_model*>(mesh->user_model);
-      if (ownsModel)
-        gmi_destroy(model);
-      mds_apf_destroy(mesh);
-      mesh = 0;
-    }
-    void verify()
-    {
-      apf::verify(this);
-    }
-    void setRemotes(MeshEntity* e, Copies& remotes)
-    {
-      mds_id id = fromEnt(e);
-      if (!remotes.size())
-        return mds_set_copies(&mesh->remotes, &mesh->mds, id, NULL);
-      mds_copies* c = mds_make_copies(remotes.size());
-      c->n = 0;
-      APF_ITERATE(Copies, remotes, it) {
-        c->c[c->n].p = it->first;
-        c->c[c->n].e = fromEnt(it->second);
-        ++c->n;
-      }
-      mds_set_copies(&mesh->remotes, &mesh->mds, id, c);
-    }
-    void addRemote(MeshEntity* e, int p, MeshEntity* r)
-    {
-      mds_copy c;
-      c.e = fromEnt(r);
-      c.p = p;
-      mds_add_copy(&mesh->remotes, &mesh->mds, fromEnt(e), c);
-    }
-
-//seol
-    void addGhost(MeshEntity* e, int p, MeshEntity* r)
-    {
-      mds_copy c;
-      c.e = fromEnt(r);
-      c.p = p;
-      mds_add_copy(&mesh->ghosts, &mesh->mds, fromEnt(e), c);
-    }
-
-    void resetPmodel()
-    {
-      deletePM(pmodel); // delete all PME in pmodel
-      MeshEntity* e;
-      Parts empty_parts;
-      for (int dim=0; dim<4; ++dim)
-      {
-        MeshIterator* it = begin(dim);
-        while ((e = iterate(it)))
-          setPtnClas(e, empty_parts, -1); // set NULL to ptn classification of each entity
-        end(it);
-      }
-    }
-
-    void setPtnClas(MeshEntity* e, Parts& residence, int owner)
-    {
-      mds_id id = fromEnt(e);
-      PME* p=NULL;
-      if (residence.size())
-      {
-        p = getPMent(pmodel, residence, owner);
-        PCU_ALWAYS_ASSERT(p);
-      }
-      mds_set_part(mesh, id, (void*)p);
-      PCU_ALWAYS_ASSERT(mds_get_part(mesh, id)==(void*)p);
-      if (p) PCU_ALWAYS_ASSERT(getOwner(e)==p->owner);
-    }
-
-    void setResidence(MeshEntity* e, Parts& residence)
-    {
-      mds_id id = fromEnt(e);
-      PME* p = getPME(pmodel, residence);
-      void* vp = static_cast<void*>(p);
-      void* ovp = mds_get_part(mesh, id);
-      if (ovp) { /* partition model classification can be NULL during
-        early mesh initialization, such as after reading SMB or in
-        createEntity_ */
-        PME* op = static_cast<PME*>(ovp);
-        putPME(pmodel, op);
-      }
-      mds_set_part(mesh, id, vp);
-    }
-    void increment(MeshIterator* it)
-    {
-      toIter(mds_next(&(mesh->mds),fromIter(it)),it);
-    }
-    bool isDone(MeshIterator* it)
-    {
-      return fromIter(it) == MDS_NONE;
-    }
-    MeshEntity* deref(MeshIterator* it)
-    {
-      return toEnt(fromIter(it));
-    }
-    MeshEntity* createVert_(ModelEntity* c)
-    {
-      return createEntity_(VERTEX,c,0);
-    }
-    MeshEntity* createEntity_(int type, ModelEntity* c,
-                                      MeshEntity** down)
-    {
-      int t = apf2mds(type);
-      int dim = mds_dim[t];
-      if (dim > mesh->mds.d) {
-        fprintf(stderr,"error: creating entity of dimension %d "
-                       "in mesh of dimension %d\n", dim, mesh->mds.d);
-        fprintf(stderr,"please use apf::changeMdsDimension\n");
-        abort();
-      }
-      mds_set s;
-      if (type != VERTEX) {
-        s.n = mds_degree[t][mds_dim[t]-1];
-        for (int i = 0; i < s.n; ++i)
-          s.e[i] = fromEnt(down[i]);
-      }
-      mds_id id = mds_apf_create_entity(
-          mesh, t, reinterpret_cast<gmi_ent*>(c), s.e);
-      MeshEntity* e = toEnt(id);
-      apf::Parts r;
-      r.insert(getId());
-      setResidence(e, r);
-      return e;
-    }
-    void destroy_(MeshEntity* e)
-    {
-      mds_id id = fromEnt(e);
-      void* ovp = mds_get_part(mesh, id);
-      PME* op = static_cast<PME*>(ovp);
-      putPME(pmodel, op);
-      mds_apf_destroy_entity(mesh,id);
-    }
-    void setModelEntity(MeshEntity* e, ModelEntity* c)
-    {
-      mds_apf_set_model(mesh, fromEnt(e),
-         reinterpret_cast<gmi_ent*>(c));
-    }
-    bool hasMatching()
-    {
-      return isMatched;
-    }
-    void getMatches(MeshEntity* e, Matches& m)
-    {
-      mds_copies* c = mds_get_copies(&mesh->matches, fromEnt(e));
-      if (!c) {
-        m.setSize(0);
-        return;
-      }
-      m.setSize(c->n);
-      for (int i = 0; i < c->n; ++i) {
-        m[i].entity = toEnt(c->c[i].e);
-        m[i].peer = c->c[i].p;
-      }
-    }
-    void getDgCopies(MeshEntity* e, DgCopies& dgCopies, ModelEntity* me)
-    {
-      (void) e;
-      (void) dgCopies;
-      (void) me;
-      PCU_ALWAYS_ASSERT_VERBOSE(false, "error: getDgCopies for MDS is not implemented yet! ");
-    }
-    void addMatch(MeshEntity* e, int peer, MeshEntity* match)
-    {
-      PCU_ALWAYS_ASSERT(isMatched);
-      mds_copy c;
-      c.e = fromEnt(match);
-      c.p = peer;
-      mds_add_copy(&mesh->matches, &mesh->mds, fromEnt(e), c);
-    }
-    void clearMatches(MeshEntity* e)
-    {
-      mds_set_copies(&mesh->matches, &mesh->mds, fromEnt(e), 0);
-    }
-    void clear_()
-    {
-      mesh = mds_apf_create(mesh->user_model, mesh->mds.d, mesh->mds.n);
-    }
-    double getElementBytes(int type)
-    {
-      static double const table[TYPES] =
-      {1  , //vertex
-       1  , //edge
-       1  , //triangle
-       1  , //quad
-       250, //tet
-       1  , //hex
-       350, //prism
-       300, //pyramid
-      };
-      return table[type];
-    }
-    mds_apf* mesh;
-    PM pmodel;
-    bool isMatched;
-    bool ownsModel;
-};
-
 Mesh2* makeEmptyMdsMesh(gmi_model* model, int dim, bool isMatched)
 {
   Mesh2* m = new MeshMDS(model, dim, isMatched);
@@ -790,26 +96,34 @@ Mesh2* makeEmptyMdsMesh(gmi_model* model, int dim, bool isMatched)
   return m;
 }
 
-Mesh2* createMdsMesh(gmi_model* model, Mesh* from)
+Mesh2* createMdsMesh(gmi_model* model, Mesh* from, int threads)
 {
-  return new MeshMDS(model, from);
+  return new MeshMDS(model, from, threads);
 }
 
-Mesh2* loadMdsMesh(gmi_model* model, const char* meshfile)
+Mesh2* loadMdsMesh(gmi_model* model, const char* meshfile, bool lazyTags)
 {
+  PCU_Region region("mds::loadMdsMesh");
   double t0 = PCU_Time();
-  Mesh2* m = new MeshMDS(model, meshfile);
+  Mesh2* m = new MeshMDS(model, meshfile, lazyTags);
   initResidence(m, m->getDimension());
   stitchMesh(m);
   m->acceptChanges();
   double t1 = PCU_Time();
   if (!PCU_Comm_Self())
     printf("mesh %s loaded in %f seconds\n", meshfile, t1 - t0);
-  printStats(m);
-  warnAboutEmptyParts(m);
+  MeshStats stats;
+  getStats(m, stats);
+  printStats(stats);
+  warnAboutEmptyParts(stats);
   return m;
 }
 
+void setSmbPartsPerFile(int n)
+{
+  mds_set_smb_parts_per_file(n);
+}
+
 Mesh2* loadMdsMesh(const char* modelfile, const char* meshfile)
 {
   double t0 = PCU_Time();
@@ -823,6 +137,7 @@ Mesh2* loadMdsMesh(const char* modelfile, const char* meshfile)
 
 void reorderMdsMesh(Mesh2* mesh, MeshTag* t)
 {
+  PCU_Region region("mds::reorderMdsMesh");
   double t0 = PCU_Time();
   MeshMDS* m = static_cast<MeshMDS*>(mesh);
   mds_tag* vert_nums;
@@ -832,11 +147,54 @@ void reorderMdsMesh(Mesh2* mesh, MeshTag* t)
   } else {
     vert_nums = mds_number_verts_bfs(m->mesh);
   }
+  m->clearConnectivity();
   m->mesh = mds_reorder(m->mesh, 0, vert_nums);
   if (!PCU_Comm_Self())
     printf("mesh reordered in %f seconds\n", PCU_Time()-t0);
 }
 
+void compactMdsMesh(Mesh2* mesh)
+{
+  double t0 = PCU_Time();
+  MeshMDS* m = static_cast<MeshMDS*>(mesh);
+  m->clearConnectivity();
+  mds_apf_compact(m->mesh, 0);
+  if (!PCU_Comm_Self())
+    printf("mesh compacted in %f seconds\n", PCU_Time()-t0);
+}
+
+MeshTag* numberMdsVertices(Mesh2* mesh, MdsOrder order, int blockSize)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(mesh);
+  mds_tag* vert_nums;
+  if (order == HILBERT_ORDER)
+    vert_nums = mds_number_verts_hilbert(m->mesh);
+  else if (order == MORTON_ORDER)
+    vert_nums = mds_number_verts_morton(m->mesh);
+  else if (order == RCM_ORDER)
+    vert_nums = mds_number_verts_rcm(m->mesh);
+  else if (order == BLOCKED_ORDER)
+    vert_nums = mds_number_verts_blocked(m->mesh, blockSize);
+  else
+    vert_nums = mds_number_verts_bfs(m->mesh);
+  return reinterpret_cast<MeshTag*>(vert_nums);
+}
+
+void reorderMdsMesh(Mesh2* mesh, MdsOrder order)
+{
+  double t0 = PCU_Time();
+  OrderQuality before = measureOrder(mesh);
+  MeshTag* vert_nums = numberMdsVertices(mesh, order);
+  OrderQuality after = measureOrder(mesh, vert_nums);
+  MeshMDS* m = static_cast<MeshMDS*>(mesh);
+  m->clearConnectivity();
+  m->mesh = mds_reorder(m->mesh, 0, reinterpret_cast<mds_tag*>(vert_nums));
+  if (!PCU_Comm_Self())
+    printf("mesh reordered in %f seconds, bandwidth %ld to %ld,"
+        " profile %ld to %ld\n", PCU_Time()-t0,
+        before.bandwidth, after.bandwidth, before.profile, after.profile);
+}
+
 Mesh2* expandMdsMesh(Mesh2* m, gmi_model* g, int inputPartCount)
 {
   double t0 = PCU_Time();
@@ -908,6 +266,7 @@ bool alignMdsRemotes(Mesh2* in)
 void deriveMdsModel(Mesh2* in)
 {
   MeshMDS* m = static_cast<MeshMDS*>(in);
+  m->clearClassified();
   return mds_derive_model(m->mesh);
 }
 
@@ -1004,6 +363,7 @@ void deriveMdlFromManifold(Mesh2* mesh, bool* isModelVert,
   }
 
   MeshMDS* m = static_cast<MeshMDS*>(mesh);
+  m->clearClassified();
   if ((classifnTag)) {
     int tagData[2];
     MeshEntity* ent;
@@ -1093,6 +453,7 @@ void derive2DMdlFromManifold(Mesh2* mesh, bool* isModelVert,
 
   // TODO: Use classifnTag to classify
   MeshMDS* m = static_cast<MeshMDS*>(mesh);
+  m->clearClassified();
   if ((classifnTag)) {
     int tagData[2];
     MeshEntity* ent;
@@ -1172,7 +533,7 @@ Mesh2* loadMdsPart(gmi_model* model, const char* meshfile)
 {
   MeshMDS* m = new MeshMDS();
   m->init(apf::getLagrange(1));
-  m->mesh = mds_read_smb(model, meshfile, 1, m);
+  m->mesh = mds_read_smb(model, meshfile, 1, m, 0);
   m->isMatched = false;
   m->ownsModel = true;
   initResidence(m, m->getDimension());
@@ -1185,6 +546,57 @@ void writeMdsPart(Mesh2* in, const char* meshfile)
   m->mesh = mds_write_smb(m->mesh, meshfile, 1, m);
 }
 
+/* the bytes of one smb file, already serialized, and the file
+   they go to, compressing them on the way if its path says so */
+class SmbWrite : public AsyncWrite
+{
+  public:
+    SmbWrite():file(0),data(0),size(0) {}
+    ~SmbWrite()
+    {
+      free(data);
+    }
+    void run()
+    {
+      pcu_write(file, data, size);
+      pcu_fclose(file);
+    }
+    pcu_file* file;
+    char* data;
+    size_t size;
+};
+
+static AsyncWrite* writeMdsAsyncRunner(Mesh2* in, const char* meshfile,
+    int ignorePeers)
+{
+  double t0 = PCU_Time();
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  if (!ignorePeers)
+    m->clearConnectivity();
+  SmbWrite* w = new SmbWrite();
+  m->mesh = mds_snapshot_smb(m->mesh, meshfile, ignorePeers, m,
+      &w->file, &w->data, &w->size);
+  double t1 = PCU_Time();
+  if (!ignorePeers && !PCU_Comm_Self())
+    printf("mesh %s snapshot in %f seconds\n", meshfile, t1 - t0);
+  if (!w->file) {
+    delete w;
+    return 0;
+  }
+  startAsyncWrite(w);
+  return w;
+}
+
+AsyncWrite* writeMdsAsync(Mesh2* m, const char* meshfile)
+{
+  return writeMdsAsyncRunner(m, meshfile, 0);
+}
+
+AsyncWrite* writeMdsPartAsync(Mesh2* m, const char* meshfile)
+{
+  return writeMdsAsyncRunner(m, meshfile, 1);
+}
+
 
 }
 
@@ -31,6 +31,7 @@
   \brief Interface to the compact Mesh Data Structure */
 
 #include <map>
+#include <cstddef>
 
 struct gmi_model;
 
@@ -41,6 +42,7 @@ class Mesh2;
 class MeshTag;
 class MeshEntity;
 class Migration;
+class AsyncWrite;
 
 /** \brief create an empty MDS part
   \param model the geometric model interface
@@ -62,19 +64,51 @@ typedef std::map<int, MeshEntity*> GlobalToVert;
                   file "something/N.smb" will be loaded.
                   For both of these cases, if the path is
                   prepended with "bz2:", then it will be uncompressed
-                  using PCU file IO functions.
+                  using PCU file IO functions, and with "gz:" the
+                  same is done with the faster gzip streams of zlib
+                  (PCU must be built with PCU_ZLIB).
+                  If the path is prepended with "agg:" instead, the
+                  parts are read from the shared files
+                  "somethingK.smba" (or "something/K.smba") written
+                  by apf::Mesh::writeNative with the same prefix,
+                  see apf::setSmbPartsPerFile.
                   Calling apf::Mesh::writeNative on the
-                  resulting object will do the same in reverse. */
-Mesh2* loadMdsMesh(gmi_model* model, const char* meshfile);
+                  resulting object will do the same in reverse.
+  \param lazyTags if true and the file is not compressed, tag values
+                  (including those of fields) are only read from
+                  the file when their tag is first used, so the file
+                  stays open until then. Destroying entities or
+                  writing the mesh reads all remaining tags. */
+Mesh2* loadMdsMesh(gmi_model* model, const char* meshfile,
+    bool lazyTags = false);
+
+/** \brief set how many parts share each file of "agg:" smb paths
+  \details consecutive parts are grouped, so K.smba holds parts
+  K*n to K*n+n-1. Each part's section is written and read with
+  collective MPI-IO calls within its group, and is deflated when
+  PCU is built with PCU_ZLIB. The default is 64. */
+void setSmbPartsPerFile(int n);
 
 /** \brief load an MDS mesh and model from file
   \param modelfile will be passed to gmi_load to get the model */
 Mesh2* loadMdsMesh(const char* modelfile, const char* meshfile);
 
+/** \brief load the part of an MDS mesh classified on some model entities
+  \details the whole mesh is read as apf::loadMdsMesh does, then only
+  the entities classified on the model entities of dimension modelDim
+  with the given tags are kept, with their closure, and each part
+  is compacted. Remote copies and matches are kept consistent.
+  \param layer also keep the elements adjacent to those entities
+               (and their closure), as a one element thick layer */
+Mesh2* loadMdsSubset(gmi_model* model, const char* meshfile, int modelDim,
+    int const* modelTags, int ntags, bool layer = false);
+
 /** \brief create an MDS mesh from an existing mesh
   \param from the mesh to copy
-  \details this function uses apf::convert to copy any apf::Mesh */
-Mesh2* createMdsMesh(gmi_model* model, Mesh* from);
+  \param threads see apf::convert
+  \details this function uses apf::convert to copy any apf::Mesh,
+  after sizing the MDS arrays by apf::Mesh::countType */
+Mesh2* createMdsMesh(gmi_model* model, Mesh* from, int threads = 1);
 
 /** \brief apply adjacency-based reordering
   \param t Optional user-defined ordering of the vertices.
@@ -91,9 +125,93 @@ Mesh2* createMdsMesh(gmi_model* model, Mesh* from);
            there are no gaps in the MDS arrays after this */
 void reorderMdsMesh(Mesh2* mesh, MeshTag* t = 0);
 
+/** \brief remove the gaps left in the MDS arrays by mesh modification
+  \details unlike apf::reorderMdsMesh this works in place, keeping the
+  order of the remaining entities and needing little extra memory.
+  Array capacities shrink to the entity counts, and tags and copies
+  on other parts are updated. Like reordering, it invalidates all
+  MeshEntity pointers. This is a collective call. */
+void compactMdsMesh(Mesh2* mesh);
+
+/** \brief built-in vertex orderings for apf::reorderMdsMesh */
+enum MdsOrder
+{
+  /** \brief breadth-first traversal, the default */
+  BFS_ORDER,
+  /** \brief Hilbert curve through the vertex coordinates */
+  HILBERT_ORDER,
+  /** \brief Morton (Z-order) curve through the vertex coordinates */
+  MORTON_ORDER,
+  /** \brief reverse Cuthill-McKee from a pseudo-peripheral vertex,
+      for a small matrix bandwidth and profile */
+  RCM_ORDER,
+  /** \brief Hilbert curve cut into cache-sized blocks of vertices,
+      each ordered by reverse Cuthill-McKee */
+  BLOCKED_ORDER
+};
+
+/** \brief number the vertices of an MDS mesh by a built-in ordering
+  \details the result is an int vertex tag with the values
+  [0, #vertices) that apf::reorderMdsMesh(mesh, tag) applies and
+  apf::measureOrder can compare with other orderings. A tag that is
+  not applied should be removed with Mesh::destroyTag.
+  \param blockSize vertices per block of BLOCKED_ORDER */
+MeshTag* numberMdsVertices(Mesh2* mesh, MdsOrder order,
+    int blockSize = 4096);
+
+/** \brief reorder an MDS mesh using one of the built-in vertex orderings
+  \details the curve orderings sort vertices along a space-filling
+  curve through their bounding box, so that entities close in space
+  are close in memory. As with the BFS ordering, all other entities
+  are then ordered by their vertices. The bandwidth and profile
+  of the vertex order are printed before and after. */
+void reorderMdsMesh(Mesh2* mesh, MdsOrder order);
+
 Mesh2* repeatMdsMesh(Mesh2* m, gmi_model* g, Migration* plan, int factor);
 Mesh2* expandMdsMesh(Mesh2* m, gmi_model* g, int inputPartCount);
 
+/** \brief splits a freshly loaded part for apf::loadSplitMdsMesh
+  \details this is called on the reading ranks only, with PCU on a
+  communicator of the reading ranks, and should return a plan
+  sending each element of reader i to a part from i * (factor)
+  to (i + 1) * (factor) - 1, as the synchronous splitters
+  of Parma and Zoltan do. */
+typedef Migration* (*PartSplitFunction)(Mesh2* m, int factor, void* data);
+
+/** \brief load a mesh onto (factor) times as many ranks as it has parts
+  \details every (factor)'th rank reads one part of (meshfile) and
+  calls (split) on it. The elements are then sent to their
+  destination ranks in waves of at most (wave) elements per reader,
+  each wave being fully migrated before the next one, so the reader
+  ranks never hold the migration state of their whole part, unlike
+  apf::repeatMdsMesh which migrates the part in one go.
+  This is a collective call over all ranks. */
+Mesh2* loadSplitMdsMesh(gmi_model* g, const char* meshfile, int factor,
+    PartSplitFunction split, void* data, size_t wave = 100*1000);
+
+/** \brief a mesh operation run on each thread by apf::runThreadedMdsMesh */
+typedef void (*ThreadedMeshFunction)(Mesh2* m, void* data);
+
+/** \brief run a mesh operation on several threads of each process
+  \details the part of each process is cut into (threads) slabs of
+  equal element counts along its longest axis, and each slab becomes
+  the part of one thread in PCU thread mode (see PCU_Thrd_Run),
+  where (function) is called on it. A CavityOp in (function) then
+  works on the slabs concurrently and pulls the cavities that cross
+  slab boundaries as it does across processes. MDS does not allow
+  concurrent modification of one part, hence the separate parts.
+  The slabs are migrated back into (m) before this returns.
+  (function) is called concurrently with the same (data), and field
+  shapes it uses should be created before this call. The shared
+  state apf keeps outside the mesh, such as the shape and integration
+  point caches and the profiling counters, is safe to use from the
+  threads, but changing the migration limit or the order of a shape
+  inside (function) is not.
+  With several processes, MPI must provide MPI_THREAD_MULTIPLE.
+  This is a collective call. */
+void runThreadedMdsMesh(Mesh2* m, gmi_model* g, int threads,
+    ThreadedMeshFunction function, void* data);
+
 /** \brief align the downward adjacencies of matched entities */
 bool alignMdsMatches(Mesh2* in);
 /** \brief align the downward adjacencies of remote copies */
@@ -181,10 +299,37 @@ int getMdsIndex(Mesh2* in, MeshEntity* e);
   so call apf::reorderMdsMesh after any mesh modification. */
 MeshEntity* getMdsEntity(Mesh2* in, int dimension, int index);
 
+/** \brief load a Gmsh file on this part alone
+  \details version 2 ASCII files and version 4.1 ASCII or binary
+  files are read, the latter from a memory map of the file. */
 Mesh2* loadMdsFromGmsh(gmi_model* g, const char* filename);
 
+/** \brief load a Gmsh 4.1 file across all parts
+  \details this is a collective call. Each rank memory maps the file
+  and reads its share of the elements of the highest dimension,
+  which must be linear and all of one type, then builds its part
+  with apf::construct using the node tags as global ids.
+  Each rank also sends its share of the nodes' coordinates to the
+  ranks that hold them in one exchange, and the lower dimensional
+  elements of the file classify the entities they match. */
+Mesh2* loadMdsFromGmshParallel(gmi_model* g, const char* filename);
+
 Mesh2* loadMdsFromUgrid(gmi_model* g, const char* filename);
 
+/** \brief load a UGRID file across all parts
+  \details this is a collective call. Every rank reads its slice of
+  each element array at offsets computed from the header, with
+  collective MPI-IO, and builds its part with apf::construct using
+  the vertex ids as global ids. Each rank then reads the
+  coordinates apf::setCoords expects from it. The boundary faces
+  get the "ugrid-face-tag" and the vertices the "ugrid-vtx-ids"
+  tags, as with apf::loadMdsFromUgrid.
+  \param ptnfile if not null, a text file with the part of each
+  vertex on its own line. Each element goes to the part of its
+  first vertex. */
+Mesh2* loadMdsFromUgridParallel(gmi_model* g, const char* filename,
+    const char* ptnfile = 0);
+
 void printUgridPtnStats(gmi_model* g, const char* ugridfile, const char* ptnfile,
     const double elmWeights[]);
 
@@ -201,6 +346,63 @@ void printUgridPtnStats(gmi_model* g, const char* ugridfile, const char* ptnfile
   respectively. */
 Mesh2* loadMdsFromANSYS(const char* nodefile, const char* elemfile);
 
+/** \brief snapshot upward adjacencies for read-only use
+  \details afterwards upward queries such as apf::Mesh::getUp and
+  apf::Mesh::getAdjacent read contiguous arrays instead of
+  following linked lists. The snapshot costs memory for
+  every upward adjacency and is discarded by the next
+  change to the mesh structure or by apf::thawMdsAdjacency */
+void freezeMdsAdjacency(Mesh2* in);
+
+/** \brief discard the snapshot made by apf::freezeMdsAdjacency */
+void thawMdsAdjacency(Mesh2* in);
+
+/** \brief statistics of the adjacency queries of an MDS mesh
+  \details see apf::watchMdsAdjacency */
+struct MdsAdjacencyStats
+{
+  MdsAdjacencyStats();
+  /** \brief Mesh::getAdjacent calls by dimension from and to */
+  long queries[4][4];
+  /** \brief entities those calls returned */
+  long entities[4][4];
+  /** \brief seconds spent in those calls */
+  double seconds[4][4];
+  /** \brief times the adjacency was kept */
+  long keeps[4][4];
+  /** \brief times a kept adjacency was dropped by a mesh change */
+  long drops[4][4];
+  /** \brief whether the adjacency is stored now */
+  bool stored[4][4];
+  /** \brief whether it is stored because it was kept */
+  bool kept[4][4];
+  /** \brief bytes of all stored adjacencies */
+  size_t bytes;
+};
+
+/** \brief count adjacency queries and store the frequent ones
+  \details afterwards apf::Mesh::getAdjacent counts and times its
+  calls by pair of dimensions. Once a pair that is not stored, such
+  as vertex to face, has been asked for (threshold) times, the mesh
+  stores it as apf::Mesh::createAdjacency does, unless all stored
+  adjacencies would then take more than (budget) bytes, in which case
+  that pair is never tried again. Kept adjacencies are removed by the
+  next entity creation or destruction, since those only maintain
+  the adjacencies one dimension apart, and a pair dropped this way
+  waits twice as many queries before it is kept again.
+  A (threshold) of zero only counts. */
+void watchMdsAdjacency(Mesh2* in, long threshold, size_t budget);
+
+/** \brief stop counting, kept adjacencies stay until the mesh changes */
+void unwatchMdsAdjacency(Mesh2* in);
+
+/** \brief get the statistics of apf::watchMdsAdjacency on this part */
+void getMdsAdjacencyStats(Mesh2* in, MdsAdjacencyStats& stats);
+
+/** \brief print the query counts and entities summed over the parts
+  and the largest seconds, collective */
+void printMdsAdjacencyStats(Mesh2* in);
+
 void disownMdsModel(Mesh2* in);
 
 void setMdsMatching(Mesh2* in, bool has);
@@ -208,6 +410,19 @@ void setMdsMatching(Mesh2* in, bool has);
 Mesh2* loadMdsPart(gmi_model* model, const char* meshfile);
 void writeMdsPart(Mesh2* m, const char* meshfile);
 
+/** \brief start writing an MDS mesh like apf::Mesh::writeNative,
+           on a background thread
+  \details the part is serialized into memory and its file opened
+   before this returns, so the mesh may change right away, while
+   compression and the write happen on the thread, see
+   apf::waitForWrite.
+   Paths with the "agg:" prefix are written collectively before
+   this returns, which then gives zero. */
+AsyncWrite* writeMdsAsync(Mesh2* m, const char* meshfile);
+
+/** \brief see apf::writeMdsAsync and apf::writeMdsPart */
+AsyncWrite* writeMdsPartAsync(Mesh2* m, const char* meshfile);
+
 }
 
 #endif
@@ -0,0 +1,942 @@
+/******************************************************************************
+
+  Copyright 2025 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+
+#ifndef APF_MDS_MESH_H
+#define APF_MDS_MESH_H
+
+/* the apf::Mesh2 implementation over mds_apf, shared by the
+   files of the apfMDS.h interface */
+
+#include <PCU.h>
+#include "apfMDS.h"
+#include "mds_apf.h"
+#include "apfPM.h"
+#include <apf.h>
+#include <apfMesh2.h>
+#include <apfConvert.h>
+#include <apfShape.h>
+#include <apfNumbering.h>
+#include <cstring>
+#include <pcu_util.h>
+#include <cstdlib>
+#include <stdint.h>
+#include <algorithm>
+
+namespace apf {
+
+inline MeshEntity* toEnt(mds_id id)
+{
+  //for pointers 0 is null, but mds_id 0 is ok and -1 is null
+  return reinterpret_cast<MeshEntity*>(((char*)1) + id);
+}
+
+inline mds_id fromEnt(MeshEntity* e)
+{
+  return (reinterpret_cast<char*>(e) - ((char*)1));
+}
+
+/* iteration ends at the stop entity, which is
+   MDS_NONE unless the iterator covers one chunk */
+struct MdsIterator
+{
+  mds_id at;
+  mds_id stop;
+};
+
+inline MeshIterator* makeIter(mds_id stop = MDS_NONE)
+{
+  MdsIterator* p = new MdsIterator;
+  p->stop = stop;
+  return reinterpret_cast<MeshIterator*>(p);
+}
+
+inline void freeIter(MeshIterator* it)
+{
+  MdsIterator* p = reinterpret_cast<MdsIterator*>(it);
+  delete p;
+}
+
+inline void toIter(mds_id id, MeshIterator* it)
+{
+  MdsIterator* p = reinterpret_cast<MdsIterator*>(it);
+  p->at = (id == p->stop) ? MDS_NONE : id;
+}
+
+inline mds_id fromIter(MeshIterator* it)
+{
+  return reinterpret_cast<MdsIterator*>(it)->at;
+}
+
+inline Mesh::Type mds2apf(int t_mds)
+{
+  static Mesh::Type const table[MDS_TYPES] =
+  {Mesh::VERTEX
+  ,Mesh::EDGE
+  ,Mesh::TRIANGLE
+  ,Mesh::QUAD
+  ,Mesh::PRISM
+  ,Mesh::PYRAMID
+  ,Mesh::TET
+  ,Mesh::HEX};
+  return table[t_mds];
+
+}
+
+inline int apf2mds(int t_apf)
+{
+  static int const table[Mesh::TYPES] =
+  {MDS_VERTEX
+  ,MDS_EDGE
+  ,MDS_TRIANGLE
+  ,MDS_QUADRILATERAL
+  ,MDS_TETRAHEDRON
+  ,MDS_HEXAHEDRON
+  ,MDS_WEDGE
+  ,MDS_PYRAMID
+  };
+  return table[t_apf];
+}
+
+/* the state of apf::watchMdsAdjacency, see apfMDSWatch.cc */
+struct AdjacencyWatch;
+
+class MeshMDS : public Mesh2
+{
+  public:
+    MeshMDS()
+    {
+      mesh = 0;
+      isMatched = false;
+      ownsModel = false;
+      watch = 0;
+    }
+    MeshMDS(gmi_model* m, int d, bool isMatched_)
+    {
+      init(apf::getLagrange(1));
+      mds_id cap[MDS_TYPES] = {};
+      mesh = mds_apf_create(m, d, cap);
+      isMatched = isMatched_;
+      ownsModel = true;
+      watch = 0;
+    }
+    MeshMDS(gmi_model* m, Mesh* from, int threads)
+    {
+      init(apf::getLagrange(1));
+      mds_id cap[MDS_TYPES];
+      cap[MDS_VERTEX] = from->count(0);
+      cap[MDS_EDGE] = from->count(1);
+      cap[MDS_TRIANGLE] = from->countType(TRIANGLE);
+      cap[MDS_QUADRILATERAL] = from->countType(QUAD);
+      cap[MDS_WEDGE] = from->countType(PRISM);
+      cap[MDS_PYRAMID] = from->countType(PYRAMID);
+      cap[MDS_TETRAHEDRON] = from->countType(TET);
+      cap[MDS_HEXAHEDRON] = from->countType(HEX);
+      int d = from->getDimension();
+      mesh = mds_apf_create(m,d,cap);
+      isMatched = from->hasMatching();
+      ownsModel = true;
+      watch = 0;
+      apf::convert(from,this,threads);
+    }
+    MeshMDS(gmi_model* m, const char* pathname, bool lazyTags)
+    {
+      init(apf::getLagrange(1));
+      mesh = mds_read_smb(m, pathname, 0, this, lazyTags);
+      isMatched = PCU_Or(!mds_net_empty(&mesh->matches));
+      ownsModel = true;
+      watch = 0;
+    }
+    ~MeshMDS()
+    {
+      if (mesh)
+        destroyNative();
+    }
+    int getDimension()
+    {
+      return mesh->mds.d;
+    }
+    std::size_t count(int dimension)
+    {
+      mds_id c = 0;
+      for (int t = 0; t < MDS_TYPES; ++t)
+        if (mds_dim[t] == dimension)
+          c += mesh->mds.n[t];
+      return c;
+    }
+    MeshIterator* begin(int dimension)
+    {
+      mds_id id = mds_begin(&(mesh->mds),dimension);
+      MeshIterator* it = makeIter();
+      toIter(id,it);
+      return it;
+    }
+    MeshIterator* beginChunk(int dimension, int chunk, int chunks)
+    {
+      mds_id first, stop;
+      mds_chunk(&(mesh->mds), dimension, chunk, chunks, &first, &stop);
+      MeshIterator* it = makeIter(stop);
+      toIter(first,it);
+      return it;
+    }
+    std::size_t countType(int type)
+    {
+      return mesh->mds.n[apf2mds(type)];
+    }
+    MeshIterator* beginType(int type)
+    {
+      mds_id first, stop;
+      mds_type_range(&(mesh->mds), apf2mds(type), &first, &stop);
+      MeshIterator* it = makeIter(stop);
+      toIter(first,it);
+      return it;
+    }
+    MeshEntity* iterate(MeshIterator* it)
+    {
+      mds_id id = fromIter(it);
+      if (id == MDS_NONE)
+        return 0;
+      countQuery(MeshCounters::ITERATE, mds_dim[mds_type(id)]);
+      MeshEntity* e = toEnt(id);
+      id = mds_next(&(mesh->mds),id);
+      toIter(id,it);
+      return e;
+    }
+    void end(MeshIterator* it)
+    {
+      freeIter(it);
+    }
+    // return true if adjacency *from_dim <--> to_dim*  is stored
+    bool hasAdjacency(int from_dim, int to_dim)
+    {
+      return (mesh->mds.mrm[from_dim][to_dim] == 1);
+    }
+
+    // store adjacency *from_dim <--> to_dim* if not stored
+    void createAdjacency(int from_dim, int to_dim)
+    {
+      mds* m = &(mesh->mds);
+      /* an adjacency kept by apf::watchMdsAdjacency stays */
+      if (m->kept[from_dim][to_dim]) {
+        m->kept[from_dim][to_dim] = 0;
+        --(m->keeping);
+      } else if (m->mrm[from_dim][to_dim] != 1)
+        mds_add_adjacency(m, from_dim, to_dim);
+    }
+    // remove adjacency *from_dim <--> to_dim* except for one-level apart adjacency
+    void deleteAdjacency(int from_dim, int to_dim)
+    {
+      if (mesh->mds.mrm[from_dim][to_dim] == 1 && (abs(from_dim-to_dim)>1))
+        mds_remove_adjacency(&(mesh->mds), from_dim, to_dim);
+    }
+    bool isShared(MeshEntity* e)
+    {
+      return mds_get_copies(&mesh->remotes, fromEnt(e));
+    }
+    bool isGhost(MeshEntity* e)
+    {
+      MeshTag* t = findTag("ghost_tag");
+      if (t && hasTag(e, t))
+        return true;
+      return false;
+    }
+
+    void deleteGhost(MeshEntity* e)
+    {
+      mds_set_copies(&mesh->ghosts, &mesh->mds, fromEnt(e), NULL);
+    }
+
+    bool isGhosted(MeshEntity* e)
+    {
+      MeshTag* t = findTag("ghosted_tag");
+      if (t && hasTag(e, t))
+        return true;
+      return false;
+    }
+
+    bool isOwned(MeshEntity* e)
+    {
+      return getId() == getOwner(e);
+    }
+
+    int getOwner(MeshEntity* e)
+    {
+      void* vp = mds_get_part(mesh, fromEnt(e));
+      PME* p = static_cast<PME*>(vp);
+      return p->owner;
+    }
+
+    void getAdjacent(MeshEntity* e, int dimension, Adjacent& adjacent)
+    {
+      if (counters)
+        countAdjacent(e, dimension);
+      if (watch)
+        return getWatchedAdjacent(e, dimension, adjacent);
+      mds_set s;
+      mds_id id = fromEnt(e);
+      mds_get_adjacent(&(mesh->mds),id,dimension,&s);
+      adjacent.setSize(s.n);
+      for (int i = 0; i < s.n; ++i)
+        adjacent[i] = toEnt(s.e[i]);
+    }
+    void countAdjacent(MeshEntity* e, int dimension)
+    {
+      int from = mds_dim[mds_type(fromEnt(e))];
+      countQuery(MeshCounters::ADJACENT, from, dimension);
+      if (abs(from - dimension) > 1 && !mesh->mds.mrm[from][dimension] &&
+          !(mesh->mds.frozen && dimension > from))
+        countQuery(MeshCounters::SECOND_ORDER, from, dimension);
+    }
+    /* counts and times the query, after keeping the
+       adjacency if it was missed often enough */
+    void getWatchedAdjacent(MeshEntity* e, int dimension,
+        Adjacent& adjacent);
+    size_t getAdjacencyBytes();
+    void keepAdjacency(int from, int to);
+    void startWatch(long threshold, size_t budget);
+    void stopWatch();
+    void getWatchStats(MdsAdjacencyStats& stats);
+    int getDownward(MeshEntity* e, int dimension, MeshEntity** adjacent)
+    {
+      PCU_ALWAYS_ASSERT((0 <= dimension) && (dimension <= 3));
+      mds_set s;
+      mds_id id = fromEnt(e);
+      countQuery(MeshCounters::DOWNWARD, mds_dim[mds_type(id)], dimension);
+      mds_get_adjacent(&(mesh->mds),id,dimension,&s);
+      for (int i = 0; i < s.n; ++i)
+        adjacent[i] = toEnt(s.e[i]);
+      return s.n;
+    }
+    int countUpward(MeshEntity* e)
+    {
+      mds_set s;
+      mds_id id = fromEnt(e);
+      mds_get_adjacent(&(mesh->mds),id,mds_dim[mds_type(id)] + 1,&s);
+      return s.n;
+    }
+    MeshEntity* getUpward(MeshEntity* e, int i)
+    {
+      mds_set s;
+      mds_id id = fromEnt(e);
+      mds_get_adjacent(&(mesh->mds),id,mds_dim[mds_type(id)] + 1,&s);
+      PCU_ALWAYS_ASSERT(i < s.n);
+      return toEnt(s.e[i]);
+    }
+    void getUp(MeshEntity* e, Up& up)
+    {
+      mds_set s;
+      mds_id id = fromEnt(e);
+      countQuery(MeshCounters::UP, mds_dim[mds_type(id)],
+          mds_dim[mds_type(id)] + 1);
+      mds_get_adjacent(&(mesh->mds),id,mds_dim[mds_type(id)] + 1,&s);
+      up.n = s.n;
+      for (int i = 0; i < s.n; ++i)
+        up.e[i] = toEnt(s.e[i]);
+    }
+    bool hasUp(MeshEntity* e)
+    {
+      return mds_has_up(&(mesh->mds),fromEnt(e));
+    }
+    void getPoint_(MeshEntity* e, int, Vector3& point)
+    {
+      mds_id id = fromEnt(e);
+      countQuery(MeshCounters::POINT, mds_dim[mds_type(id)]);
+      point = Vector3(mds_apf_point(mesh,id));
+    }
+    double* getPointSpan(int first, int count)
+    {
+      PCU_ALWAYS_ASSERT(0 <= first);
+      PCU_ALWAYS_ASSERT(first + count <= mesh->mds.end[MDS_VERTEX]);
+      return mesh->point[first];
+    }
+    void setPoint_(MeshEntity* e, int, Vector3 const& p)
+    {
+      mds_id id = fromEnt(e);
+      p.toArray(mds_apf_point(mesh,id));
+    }
+    void getParam(MeshEntity* e, Vector3& p)
+    {
+      mds_id id = fromEnt(e);
+      double* p2 = mds_apf_param(mesh,id);
+      p[0] = p2[0];
+      p[1] = p2[1];
+    }
+    void setParam(MeshEntity* e, Vector3 const& p)
+    {
+      mds_id id = fromEnt(e);
+      double* p2 = mds_apf_param(mesh,id);
+      p2[0] = p[0];
+      p2[1] = p[1];
+    }
+    Type getType(MeshEntity* e)
+    {
+      return mds2apf(mds_type(fromEnt(e)));
+    }
+    bool hasSharedLists()
+    {
+      return mds_net_empty(&mesh->ghosts);
+    }
+    void getSharedPeers(int dimension, Parts& peers)
+    {
+      for (int t = 0; t < MDS_TYPES; ++t) {
+        if (mds_dim[t] != dimension)
+          continue;
+        int* p;
+        int np = mds_get_peers(&mesh->remotes, &mesh->mds, t, &p);
+        peers.insert(p, p + np);
+      }
+    }
+    void getSharedWith(int dimension, int peer,
+        DynamicArray<MeshEntity*>& ents)
+    {
+      mds_id* e[MDS_TYPES];
+      mds_id ne[MDS_TYPES] = {};
+      size_t n = 0;
+      for (int t = 0; t < MDS_TYPES; ++t)
+        if (mds_dim[t] == dimension) {
+          ne[t] = mds_get_peer_entities(&mesh->remotes, &mesh->mds,
+              t, peer, &e[t]);
+          n += ne[t];
+        }
+      ents.setSize(n);
+      n = 0;
+      for (int t = 0; t < MDS_TYPES; ++t)
+        for (mds_id i = 0; i < ne[t]; ++i)
+          ents[n++] = toEnt(mds_identify(t, e[t][i]));
+    }
+    void getRemotes(MeshEntity* e, Copies& remotes)
+    {
+      if (!isShared(e))
+        return;
+      mds_copies* c = mds_get_copies(&mesh->remotes, fromEnt(e));
+      PCU_ALWAYS_ASSERT(c != NULL);
+      for (int i = 0; i < c->n; ++i)
+        remotes[c->c[i].p] = toEnt(c->c[i].e);
+    }
+
+// seol
+    int getGhosts(MeshEntity* e, Copies& ghosts)
+    {
+      mds_copies* c = mds_get_copies(&mesh->ghosts, fromEnt(e));
+      if (c==NULL) return 0;
+      for (int i = 0; i < c->n; ++i)
+        ghosts[c->c[i].p] = toEnt(c->c[i].e);
+      return c->n;
+    }
+
+    void getResidence(MeshEntity* e, Parts& residence)
+    {
+      void* vp = mds_get_part(mesh, fromEnt(e));
+      PME* p = static_cast<PME*>(vp);
+      for (size_t i = 0; i < p->ids.size(); ++i)
+        residence.insert(p->ids[i]);
+    }
+    MeshTag* createDoubleTag(const char* name, int size)
+    {
+      mds_tag* tag;
+      PCU_ALWAYS_ASSERT(!mds_find_tag(&mesh->tags, name));
+      tag = mds_create_tag(&(mesh->tags),name,
+          sizeof(double)*size, Mesh::DOUBLE);
+      return reinterpret_cast<MeshTag*>(tag);
+    }
+    MeshTag* createIntTag(const char* name, int size)
+    {
+      mds_tag* tag;
+      PCU_ALWAYS_ASSERT(!mds_find_tag(&mesh->tags, name));
+      tag = mds_create_tag(&(mesh->tags),name,
+          sizeof(int)*size, Mesh::INT);
+      return reinterpret_cast<MeshTag*>(tag);
+    }
+    MeshTag* createLongTag(const char* name, int size)
+    {
+      mds_tag* tag;
+      PCU_ALWAYS_ASSERT(!mds_find_tag(&mesh->tags, name));
+      tag = mds_create_tag(&(mesh->tags),name,
+          sizeof(long)*size, Mesh::LONG);
+      return reinterpret_cast<MeshTag*>(tag);
+    }
+    MeshTag* findTag(const char* name)
+    {
+      mds_tag* tag;
+      tag = mds_find_tag(&(mesh->tags),name);
+      return reinterpret_cast<MeshTag*>(tag);
+    }
+    /* tags read lazily from an smb file are loaded on first use */
+    mds_tag* useTag(MeshTag* t)
+    {
+      mds_tag* tag = reinterpret_cast<mds_tag*>(t);
+      if (mesh->lazy)
+        mds_load_tag(mesh, tag);
+      return tag;
+    }
+    void destroyTag(MeshTag* t)
+    {
+      mds_tag* tag;
+      tag = reinterpret_cast<mds_tag*>(t);
+      if (mesh->lazy)
+        mds_forget_tag(mesh, tag);
+      mds_destroy_tag(&(mesh->tags),tag);
+    }
+    void getTags(DynamicArray<MeshTag*>& tags)
+    {
+      int c = 0;
+      for (mds_tag* t = mesh->tags.first; t; t = t->next)
+        ++c;
+      tags.setSize(c);
+      c = 0;
+      for (mds_tag* t = mesh->tags.first; t; t = t->next)
+        tags[c++] = reinterpret_cast<MeshTag*>(t);
+    }
+    void getTag(MeshEntity* e, MeshTag* t, void* data)
+    {
+      if (!hasTag(e,t)) {
+        fprintf(stderr, "expected tag \"%s\" on entity type %d\n",
+            getTagName(t), getType(e));
+        abort();
+      }
+      mds_tag* tag;
+      tag = reinterpret_cast<mds_tag*>(t);
+      mds_id id = fromEnt(e);
+      countQuery(MeshCounters::TAG_GET, mds_dim[mds_type(id)]);
+      memcpy(data,mds_get_tag(tag,id),tag->bytes);
+    }
+    void* getTagPointer(MeshEntity* e, MeshTag* t)
+    {
+      mds_tag* tag = useTag(t);
+      mds_id id = fromEnt(e);
+      if (!mds_has_tag(tag,id))
+        return 0;
+      return mds_get_tag(tag,id);
+    }
+    void setTag(MeshEntity* e, MeshTag* t, void const* data)
+    {
+      mds_tag* tag;
+      tag = useTag(t);
+      mds_id id = fromEnt(e);
+      countQuery(MeshCounters::TAG_SET, mds_dim[mds_type(id)]);
+      if ( ! mds_has_tag(tag,id))
+        mds_give_tag(tag,&(mesh->mds),id);
+      memcpy(mds_get_tag(tag,id),data,tag->bytes);
+    }
+    void getDoubleTag(MeshEntity* e, MeshTag* tag, double* data)
+    {
+      getTag(e,tag,data);
+    }
+    void setDoubleTag(MeshEntity* e, MeshTag* tag, double const* data)
+    {
+      setTag(e,tag,data);
+    }
+    void getIntTag(MeshEntity* e, MeshTag* tag, int* data)
+    {
+      getTag(e,tag,data);
+    }
+    void setIntTag(MeshEntity* e, MeshTag* tag, int const* data)
+    {
+      setTag(e,tag,data);
+    }
+    void getLongTag(MeshEntity* e, MeshTag* tag, long* data)
+    {
+      getTag(e,tag,data);
+    }
+    void setLongTag(MeshEntity* e, MeshTag* tag, long const* data)
+    {
+      setTag(e,tag,data);
+    }
+    void removeTag(MeshEntity* e, MeshTag* t)
+    {
+      mds_tag* tag;
+      tag = useTag(t);
+      mds_id id = fromEnt(e);
+      mds_take_tag(tag,id);
+    }
+    bool hasTag(MeshEntity* e, MeshTag* t)
+    {
+      mds_tag* tag;
+      tag = useTag(t);
+      mds_id id = fromEnt(e);
+      return mds_has_tag(tag,id);
+    }
+    int getTagType(MeshTag* t)
+    {
+      mds_tag* tag;
+      tag = reinterpret_cast<mds_tag*>(t);
+      return tag->user_type;
+    }
+    int getTagSize(MeshTag* t)
+    {
+      mds_tag* tag;
+      tag = reinterpret_cast<mds_tag*>(t);
+      size_t const table[3] =
+      {sizeof(double),sizeof(int),sizeof(long)};
+      return tag->bytes / table[tag->user_type];
+    }
+    const char* getTagName(MeshTag* t)
+    {
+      mds_tag* tag;
+      tag = reinterpret_cast<mds_tag*>(t);
+      return tag->name;
+    }
+    void getMemoryUsage(MeshMemory& u)
+    {
+      mds* m = &(mesh->mds);
+      for (int type = 0; type < TYPES; ++type) {
+        int t = apf2mds(type);
+        u.downward[type] = mds_down_bytes(m, t);
+        u.upward[type] = mds_up_bytes(m, t);
+        u.coordinates[type] = 0;
+        if (t == MDS_VERTEX)
+          u.coordinates[type] = m->cap[t] *
+            (sizeof(*(mesh->point)) + sizeof(*(mesh->param)));
+        u.tags[type] = mds_tag_bytes(&(mesh->tags), m, t);
+        u.remotes[type] = mds_net_bytes(&(mesh->remotes), m, t) +
+                          mds_net_bytes(&(mesh->ghosts), m, t) +
+                          mds_net_bytes(&(mesh->matches), m, t);
+        u.other[type] = m->cap[t] * (sizeof(mds_id) +
+            sizeof(*(mesh->model[t])) + sizeof(*(mesh->parts[t])));
+      }
+      u.idBytes = sizeof(mds_id);
+    }
+    void reserve(int type, size_t n)
+    {
+      int t = apf2mds(type);
+      mds_apf_reserve(mesh, t, mesh->mds.n[t] + n);
+    }
+    int countTagSpan(int type)
+    {
+      int t = apf2mds(type);
+      if (mesh->mds.n[t] != mesh->mds.end[t])
+        return 0;
+      return mesh->mds.n[t];
+    }
+    int getStorageKey(MeshEntity* e)
+    {
+      return fromEnt(e);
+    }
+    /* ids interleave the types, see mds_identify */
+    int countStorageKeys()
+    {
+      int end = 0;
+      for (int t = 0; t < MDS_TYPES; ++t)
+        end = std::max(end, mesh->mds.end[t]);
+      return mds_identify(0, end);
+    }
+    void* getTagSpan(MeshTag* t, int type, int first, int count)
+    {
+      mds_tag* tag = useTag(t);
+      int mt = apf2mds(type);
+      PCU_ALWAYS_ASSERT(0 <= first);
+      PCU_ALWAYS_ASSERT(first + count <= mesh->mds.end[mt]);
+      for (int i = first; i < first + count; ++i)
+        if (!mds_has_tag(tag, mds_identify(mt, i))) {
+          fprintf(stderr, "expected tag \"%s\" on entity type %d\n",
+              getTagName(t), type);
+          abort();
+        }
+      return tag->data[mt] + tag->bytes * first;
+    }
+    void* setTagSpan(MeshTag* t, int type, int first, int count)
+    {
+      mds_tag* tag = useTag(t);
+      int mt = apf2mds(type);
+      PCU_ALWAYS_ASSERT(0 <= first);
+      PCU_ALWAYS_ASSERT(first + count <= mesh->mds.end[mt]);
+      for (int i = first; i < first + count; ++i) {
+        mds_id id = mds_identify(mt, i);
+        PCU_ALWAYS_ASSERT(mesh->mds.free[mt][i] == MDS_LIVE);
+        if (!mds_has_tag(tag, id))
+          mds_give_tag(tag, &(mesh->mds), id);
+      }
+      return tag->data[mt] + tag->bytes * first;
+    }
+    void renameTag(MeshTag* t, const char* newName)
+    {
+      mds_tag* tag;
+      tag = reinterpret_cast<mds_tag*>(t);
+      mds_rename_tag(tag,newName);
+    }
+    void chargeTag(MeshTag* t, int category)
+    {
+      mds_charge_tag(reinterpret_cast<mds_tag*>(t), category);
+    }
+    /* \brief 16 bit additive checksum of a tag
+     * \remark the code is from
+     *  http://barrgroup.com/Embedded-Systems/How-To/Additive-Checksums
+     */
+    unsigned getTagChecksum(MeshTag* t, int type)
+    {
+      mds_tag* tag;
+      tag = useTag(t);
+      /* count the number of 'live' indices */
+      int numLive = 0;
+      for (int i=0; i < mesh->mds.end[type]; ++i) {
+        if (mesh->mds.free[type][i] == MDS_LIVE)
+          numLive++;
+      }
+      int nWords = numLive / sizeof(uint16_t);
+      uint16_t* data = reinterpret_cast<uint16_t*>(tag->data[type]);
+      uint32_t sum = 0;
+      while (nWords-- > 0)
+        sum += *(data++);
+      /* Use carries to compute 1's complement sum. */
+      sum = (sum >> 16) + (sum & 0xFFFF);
+      sum += sum >> 16;
+      /* Return the inverted 16-bit result.  */
+      return ((unsigned) ~sum);
+    }
+    ModelEntity* toModel(MeshEntity* e)
+    {
+      return reinterpret_cast<ModelEntity*>(mds_apf_model(mesh, fromEnt(e)));
+    }
+    gmi_model* getModel()
+    {
+      return mesh->user_model;
+    }
+    void acceptChanges()
+    {
+      clearSharing();
+      clearConnectivity();
+      updateOwners(this, pmodel);
+      mds_pack_net(&mesh->remotes, &mesh->mds);
+      mds_pack_net(&mesh->ghosts, &mesh->mds);
+      mds_pack_net(&mesh->matches, &mesh->mds);
+    }
+
+    void migrate(Migration* plan)
+    {
+      apf::migrate(this,plan);
+    }
+    int getId()
+    {
+      return PCU_Comm_Self();
+    }
+    void writeNative(const char* fileName)
+    {
+      PCU_Region region("mds::writeMdsMesh");
+      double t0 = PCU_Time();
+      clearConnectivity();
+      mesh = mds_write_smb(mesh, fileName, 0, this);
+      double t1 = PCU_Time();
+      if (!PCU_Comm_Self())
+        printf("mesh %s written in %f seconds\n", fileName, t1 - t0);
+    }
+    void destroyNative()
+    {
+      while (this->countFields())
+        apf::destroyField(this->getField(0));
+      while (this->countNumberings())
+        apf::destroyNumbering(this->getNumbering(0));
+      apf::destroyField(coordinateField);
+      coordinateField = 0;
+      gmi_model* model = static_cast<gmi_model*>(mesh->user_model);
+      if (ownsModel)
+        gmi_destroy(model);
+      clearConnectivity();
+      mds_apf_destroy(mesh);
+      mesh = 0;
+      stopWatch();
+    }
+    void verify()
+    {
+      apf::verify(this);
+    }
+    void setRemotes(MeshEntity* e, Copies& remotes)
+    {
+      mds_id id = fromEnt(e);
+      if (!remotes.size())
+        return mds_set_copies(&mesh->remotes, &mesh->mds, id, NULL);
+      mds_copies* c = mds_make_copies(remotes.size());
+      c->n = 0;
+      APF_ITERATE(Copies, remotes, it) {
+        c->c[c->n].p = it->first;
+        c->c[c->n].e = fromEnt(it->second);
+        ++c->n;
+      }
+      mds_set_copies(&mesh->remotes, &mesh->mds, id, c);
+    }
+    void addRemote(MeshEntity* e, int p, MeshEntity* r)
+    {
+      mds_copy c;
+      c.e = fromEnt(r);
+      c.p = p;
+      mds_add_copy(&mesh->remotes, &mesh->mds, fromEnt(e), c);
+    }
+
+//seol
+    void addGhost(MeshEntity* e, int p, MeshEntity* r)
+    {
+      mds_copy c;
+      c.e = fromEnt(r);
+      c.p = p;
+      mds_add_copy(&mesh->ghosts, &mesh->mds, fromEnt(e), c);
+    }
+
+    void resetPmodel()
+    {
+      deletePM(pmodel); // delete all PME in pmodel
+      MeshEntity* e;
+      Parts empty_parts;
+      for (int dim=0; dim<4; ++dim)
+      {
+        MeshIterator* it = begin(dim);
+        while ((e = iterate(it)))
+          setPtnClas(e, empty_parts, -1); // set NULL to ptn classification of each entity
+        end(it);
+      }
+    }
+
+    void setPtnClas(MeshEntity* e, Parts& residence, int owner)
+    {
+      mds_id id = fromEnt(e);
+      PME* p=NULL;
+      if (residence.size())
+      {
+        p = getPMent(pmodel, residence, owner);
+        PCU_ALWAYS_ASSERT(p);
+      }
+      mds_set_part(mesh, id, (void*)p);
+      PCU_ALWAYS_ASSERT(mds_get_part(mesh, id)==(void*)p);
+      if (p) PCU_ALWAYS_ASSERT(getOwner(e)==p->owner);
+    }
+
+    void setResidence(MeshEntity* e, Parts& residence)
+    {
+      mds_id id = fromEnt(e);
+      PME* p = getPME(pmodel, residence);
+      void* vp = static_cast<void*>(p);
+      void* ovp = mds_get_part(mesh, id);
+      if (ovp) { /* partition model classification can be NULL during
+        early mesh initialization, such as after reading SMB or in
+        createEntity_ */
+        PME* op = static_cast<PME*>(ovp);
+        putPME(pmodel, op);
+      }
+      mds_set_part(mesh, id, vp);
+    }
+    void increment(MeshIterator* it)
+    {
+      toIter(mds_next(&(mesh->mds),fromIter(it)),it);
+    }
+    bool isDone(MeshIterator* it)
+    {
+      return fromIter(it) == MDS_NONE;
+    }
+    MeshEntity* deref(MeshIterator* it)
+    {
+      return toEnt(fromIter(it));
+    }
+    MeshEntity* createVert_(ModelEntity* c)
+    {
+      return createEntity_(VERTEX,c,0);
+    }
+    MeshEntity* createEntity_(int type, ModelEntity* c,
+                                      MeshEntity** down)
+    {
+      int t = apf2mds(type);
+      int dim = mds_dim[t];
+      if (dim > mesh->mds.d) {
+        fprintf(stderr,"error: creating entity of dimension %d "
+                       "in mesh of dimension %d\n", dim, mesh->mds.d);
+        fprintf(stderr,"please use apf::changeMdsDimension\n");
+        abort();
+      }
+      mds_set s;
+      if (type != VERTEX) {
+        s.n = mds_degree[t][mds_dim[t]-1];
+        for (int i = 0; i < s.n; ++i)
+          s.e[i] = fromEnt(down[i]);
+      }
+      clearConnectivity();
+      mds_id id = mds_apf_create_entity(
+          mesh, t, reinterpret_cast<gmi_ent*>(c), s.e);
+      MeshEntity* e = toEnt(id);
+      apf::Parts r;
+      r.insert(getId());
+      setResidence(e, r);
+      return e;
+    }
+    void destroy_(MeshEntity* e)
+    {
+      mds_id id = fromEnt(e);
+      void* ovp = mds_get_part(mesh, id);
+      PME* op = static_cast<PME*>(ovp);
+      putPME(pmodel, op);
+      clearConnectivity();
+      mds_apf_destroy_entity(mesh,id);
+    }
+    void setModelEntity(MeshEntity* e, ModelEntity* c)
+    {
+      clearClassified();
+      mds_apf_set_model(mesh, fromEnt(e),
+         reinterpret_cast<gmi_ent*>(c));
+    }
+    bool hasMatching()
+    {
+      return isMatched;
+    }
+    void getMatches(MeshEntity* e, Matches& m)
+    {
+      mds_copies* c = mds_get_copies(&mesh->matches, fromEnt(e));
+      if (!c) {
+        m.setSize(0);
+        return;
+      }
+      m.setSize(c->n);
+      for (int i = 0; i < c->n; ++i) {
+        m[i].entity = toEnt(c->c[i].e);
+        m[i].peer = c->c[i].p;
+      }
+    }
+    void getDgCopies(MeshEntity* e, DgCopies& dgCopies, ModelEntity* me)
+    {
+      (void) e;
+      (void) dgCopies;
+      (void) me;
+      PCU_ALWAYS_ASSERT_VERBOSE(false, "error: getDgCopies for MDS is not implemented yet! ");
+    }
+    void addMatch(MeshEntity* e, int peer, MeshEntity* match)
+    {
+      PCU_ALWAYS_ASSERT(isMatched);
+      mds_copy c;
+      c.e = fromEnt(match);
+      c.p = peer;
+      mds_add_copy(&mesh->matches, &mesh->mds, fromEnt(e), c);
+    }
+    void clearMatches(MeshEntity* e)
+    {
+      mds_set_copies(&mesh->matches, &mesh->mds, fromEnt(e), 0);
+    }
+    void clear_()
+    {
+      clearConnectivity();
+      mesh = mds_apf_create(mesh->user_model, mesh->mds.d, mesh->mds.n);
+    }
+    double getElementBytes(int type)
+    {
+      static double const table[TYPES] =
+      {1  , //vertex
+       1  , //edge
+       1  , //triangle
+       1  , //quad
+       250, //tet
+       1  , //hex
+       350, //prism
+       300, //pyramid
+      };
+      return table[type];
+    }
+    mds_apf* mesh;
+    PM pmodel;
+    bool isMatched;
+    bool ownsModel;
+    AdjacencyWatch* watch;
+};
+
+}
+
+#endif
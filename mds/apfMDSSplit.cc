@@ -0,0 +1,176 @@
+/******************************************************************************
+
+  Copyright 2025 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+
+#include <PCU.h>
+#include "apfMDS.h"
+#include <apf.h>
+#include <apfMesh2.h>
+#include <apfPartition.h>
+#include <pcu_util.h>
+#include <algorithm>
+#include <vector>
+
+namespace apf {
+
+/* migrates the elements of (plan) at most (wave) elements
+   per rank at a time, deleting (plan). Only the first of every
+   (factor) ranks is expected to send anything. */
+static void migrateInWaves(Mesh2* m, Migration* plan, int factor,
+    size_t wave)
+{
+  int self = PCU_Comm_Self();
+  std::vector<MeshEntity*> elements;
+  std::vector<int> destinations;
+  if (self % factor == 0) {
+    for (int i = 0; i < plan->count(); ++i) {
+      MeshEntity* e = plan->get(i);
+      int to = plan->sending(e);
+      if (to != self) {
+        elements.push_back(e);
+        destinations.push_back(to);
+      }
+    }
+  }
+  /* the waves make plans of their own under the same tag name */
+  delete plan;
+  size_t first = 0;
+  while (PCU_Or(first < elements.size())) {
+    size_t last = std::min(first + wave, elements.size());
+    Migration* part = new Migration(m);
+    for (size_t i = first; i < last; ++i)
+      part->send(elements[i], destinations[i]);
+    first = last;
+    migrateSilent(m, part);
+  }
+}
+
+Mesh2* loadSplitMdsMesh(gmi_model* g, const char* meshfile, int factor,
+    PartSplitFunction split, void* data, size_t wave)
+{
+  PCU_ALWAYS_ASSERT(factor >= 1);
+  PCU_ALWAYS_ASSERT(wave >= 1);
+  PCU_ALWAYS_ASSERT(PCU_Comm_Peers() % factor == 0);
+  int self = PCU_Comm_Self();
+  bool isReader = (self % factor == 0);
+  MPI_Comm world = PCU_Get_Comm();
+  MPI_Comm readers;
+  MPI_Comm_split(world, self % factor, self / factor, &readers);
+  PCU_Switch_Comm(readers);
+  Mesh2* m = 0;
+  Migration* plan = 0;
+  if (isReader) {
+    m = loadMdsMesh(g, meshfile);
+    plan = split(m, factor, data);
+  }
+  PCU_Switch_Comm(world);
+  MPI_Comm_free(&readers);
+  m = expandMdsMesh(m, g, PCU_Comm_Peers() / factor);
+  if (!isReader)
+    plan = new Migration(m, m->findTag("apf_migrate"));
+  double t0 = PCU_Time();
+  migrateInWaves(m, plan, factor, wave);
+  warnAboutEmptyParts(m);
+  double t1 = PCU_Time();
+  if (!PCU_Comm_Self())
+    printf("mesh streamed from %d to %d parts in %f seconds\n",
+        PCU_Comm_Peers() / factor, PCU_Comm_Peers(), t1 - t0);
+  return m;
+}
+
+/* cuts the part into (n) slabs of equal element counts
+   along the longest axis of the element centroids */
+static Migration* splitIntoSlabs(Mesh2* m, int n)
+{
+  Migration* plan = new Migration(m);
+  std::vector<MeshEntity*> elements;
+  std::vector<Vector3> centroids;
+  MeshIterator* it = m->begin(m->getDimension());
+  MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    elements.push_back(e);
+    centroids.push_back(getLinearCentroid(m, e));
+  }
+  m->end(it);
+  if (elements.empty())
+    return plan;
+  Vector3 lo = centroids[0];
+  Vector3 hi = centroids[0];
+  for (size_t i = 1; i < centroids.size(); ++i)
+    for (int j = 0; j < 3; ++j) {
+      lo[j] = std::min(lo[j], centroids[i][j]);
+      hi[j] = std::max(hi[j], centroids[i][j]);
+    }
+  int axis = 0;
+  for (int j = 1; j < 3; ++j)
+    if (hi[j] - lo[j] > hi[axis] - lo[axis])
+      axis = j;
+  std::vector<std::pair<double, size_t> > order(elements.size());
+  for (size_t i = 0; i < elements.size(); ++i)
+    order[i] = std::make_pair(centroids[i][axis], i);
+  std::sort(order.begin(), order.end());
+  int self = PCU_Comm_Self();
+  for (size_t i = 0; i < order.size(); ++i) {
+    int slab = i * n / order.size();
+    if (slab)
+      plan->send(elements[order[i].second], self + slab);
+  }
+  return plan;
+}
+
+struct ThreadedRun
+{
+  Mesh2* mesh;
+  gmi_model* model;
+  ThreadedMeshFunction function;
+  void* data;
+};
+
+static void* runThread(void* in)
+{
+  ThreadedRun* run = static_cast<ThreadedRun*>(in);
+  int threads = PCU_Thrd_Peers();
+  int thread = PCU_Thrd_Self();
+  Mesh2* m = thread ? 0 : run->mesh;
+  m = expandMdsMesh(m, run->model, PCU_Comm_Peers() / threads);
+  Migration* plan = thread ? new Migration(m) : splitIntoSlabs(m, threads);
+  m->migrate(plan);
+  run->function(m, run->data);
+  /* each thread hands its elements to the first thread of its process */
+  plan = new Migration(m);
+  if (thread) {
+    MeshIterator* it = m->begin(m->getDimension());
+    MeshEntity* e;
+    while ((e = m->iterate(it)))
+      plan->send(e, PCU_Comm_Self() - thread);
+    m->end(it);
+  }
+  m->migrate(plan);
+  if (thread) {
+    disownMdsModel(m);
+    m->destroyNative();
+    destroyMesh(m);
+  }
+  return 0;
+}
+
+void runThreadedMdsMesh(Mesh2* m, gmi_model* g, int threads,
+    ThreadedMeshFunction function, void* data)
+{
+  ThreadedRun run;
+  run.mesh = m;
+  run.model = g;
+  run.function = function;
+  run.data = data;
+  PCU_Thrd_Run(threads, runThread, &run);
+  Divide divide(threads);
+  remapPartition(m, divide);
+}
+
+}
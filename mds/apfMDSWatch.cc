@@ -0,0 +1,195 @@
+/******************************************************************************
+
+  Copyright 2025 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+
+#include <PCU.h>
+#include "apfMDSMesh.h"
+
+namespace apf {
+
+/* the state of apf::watchMdsAdjacency */
+struct AdjacencyWatch
+{
+  long threshold;
+  size_t budget;
+  /* queries of each pair while it was not stored,
+     and the count that makes it kept */
+  long missed[4][4];
+  long needed[4][4];
+  bool rejected[4][4];
+  MdsAdjacencyStats stats;
+};
+
+void MeshMDS::getWatchedAdjacent(MeshEntity* e, int dimension,
+    Adjacent& adjacent)
+{
+  mds* m = &(mesh->mds);
+  mds_id id = fromEnt(e);
+  int from = mds_dim[mds_type(id)];
+  int to = dimension;
+  if (to <= m->d && from != to &&
+      !m->mrm[from][to] && !watch->rejected[from][to] &&
+      !(m->frozen && to > from)) {
+    if (watch->stats.kept[from][to]) {
+      /* dropped by a change to the mesh since it was kept,
+         so wait twice as long before keeping it again */
+      watch->stats.kept[from][to] = false;
+      ++(watch->stats.drops[from][to]);
+      watch->needed[from][to] *= 2;
+      watch->missed[from][to] = 0;
+    }
+    if (watch->threshold &&
+        ++(watch->missed[from][to]) >= watch->needed[from][to])
+      keepAdjacency(from, to);
+  }
+  double t0 = PCU_Time();
+  mds_set s;
+  mds_get_adjacent(m,id,dimension,&s);
+  adjacent.setSize(s.n);
+  for (int i = 0; i < s.n; ++i)
+    adjacent[i] = toEnt(s.e[i]);
+  MdsAdjacencyStats& st = watch->stats;
+  if (to <= m->d) {
+    st.seconds[from][to] += PCU_Time() - t0;
+    ++(st.queries[from][to]);
+    st.entities[from][to] += s.n;
+  }
+}
+
+size_t MeshMDS::getAdjacencyBytes()
+{
+  size_t bytes = 0;
+  for (int t = 0; t < MDS_TYPES; ++t)
+    bytes += mds_down_bytes(&(mesh->mds), t) +
+             mds_up_bytes(&(mesh->mds), t);
+  return bytes;
+}
+
+void MeshMDS::keepAdjacency(int from, int to)
+{
+  mds* m = &(mesh->mds);
+  mds_keep_adjacency(m, from, to);
+  if (getAdjacencyBytes() > watch->budget) {
+    mds_remove_adjacency(m, from, to);
+    watch->rejected[from][to] = true;
+    return;
+  }
+  watch->stats.kept[from][to] = true;
+  ++(watch->stats.keeps[from][to]);
+}
+
+void MeshMDS::startWatch(long threshold, size_t budget)
+{
+  delete watch;
+  watch = new AdjacencyWatch();
+  watch->threshold = threshold;
+  watch->budget = budget;
+  for (int i = 0; i < 4; ++i)
+  for (int j = 0; j < 4; ++j)
+    watch->needed[i][j] = threshold;
+}
+
+void MeshMDS::stopWatch()
+{
+  delete watch;
+  watch = 0;
+}
+
+void MeshMDS::getWatchStats(MdsAdjacencyStats& stats)
+{
+  if (watch)
+    stats = watch->stats;
+  else
+    stats = MdsAdjacencyStats();
+  for (int i = 0; i < 4; ++i)
+  for (int j = 0; j < 4; ++j) {
+    stats.stored[i][j] = mesh->mds.mrm[i][j] == 1;
+    stats.kept[i][j] = mesh->mds.kept[i][j] == 1;
+  }
+  stats.bytes = getAdjacencyBytes();
+}
+
+void freezeMdsAdjacency(Mesh2* in)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds_freeze(&(m->mesh->mds));
+}
+
+void thawMdsAdjacency(Mesh2* in)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds_thaw(&(m->mesh->mds));
+}
+
+void watchMdsAdjacency(Mesh2* in, long threshold, size_t budget)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  m->startWatch(threshold, budget);
+}
+
+void unwatchMdsAdjacency(Mesh2* in)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  m->stopWatch();
+}
+
+MdsAdjacencyStats::MdsAdjacencyStats()
+{
+  for (int i = 0; i < 4; ++i)
+  for (int j = 0; j < 4; ++j) {
+    queries[i][j] = 0;
+    entities[i][j] = 0;
+    seconds[i][j] = 0;
+    keeps[i][j] = 0;
+    drops[i][j] = 0;
+    stored[i][j] = false;
+    kept[i][j] = false;
+  }
+  bytes = 0;
+}
+
+void getMdsAdjacencyStats(Mesh2* in, MdsAdjacencyStats& stats)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  m->getWatchStats(stats);
+}
+
+void printMdsAdjacencyStats(Mesh2* in)
+{
+  MdsAdjacencyStats s;
+  getMdsAdjacencyStats(in, s);
+  long counts[4][4][4];
+  double seconds[4][4];
+  for (int i = 0; i < 4; ++i)
+  for (int j = 0; j < 4; ++j) {
+    counts[i][j][0] = s.queries[i][j];
+    counts[i][j][1] = s.entities[i][j];
+    counts[i][j][2] = s.keeps[i][j];
+    counts[i][j][3] = s.stored[i][j];
+    seconds[i][j] = s.seconds[i][j];
+  }
+  PCU_Add_Longs(&counts[0][0][0], 4 * 4 * 4);
+  PCU_Max_Doubles(&seconds[0][0], 4 * 4);
+  long bytes = PCU_Add_Long(s.bytes);
+  if (PCU_Comm_Self())
+    return;
+  printf("adjacency queries over %d parts, %ld bytes stored\n",
+      PCU_Comm_Peers(), bytes);
+  printf("%4s %4s %12s %14s %12s %6s %7s\n",
+      "from", "to", "queries", "entities", "max seconds", "keeps",
+      "stored");
+  for (int i = 0; i < 4; ++i)
+  for (int j = 0; j < 4; ++j)
+    if (counts[i][j][0])
+      printf("%4d %4d %12ld %14ld %12f %6ld %4ld/%d\n", i, j,
+          counts[i][j][0], counts[i][j][1], seconds[i][j],
+          counts[i][j][2], counts[i][j][3], PCU_Comm_Peers());
+}
+
+}
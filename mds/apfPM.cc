@@ -19,34 +19,10 @@ namespace apf {
 // the last arg "owner" is used only if a new pmodel entity is created
 PME* getPMent(PM& ps, apf::Parts const& pids, int owner)
 {
-  APF_ITERATE(PM, ps, it) 
-  {
-    bool equal=true;
-    APF_ITERATE(Parts,pids,pit)
-    {
-      bool found=false;
-      for (size_t i = 0; i < (*it).ids.size(); ++i)
-        if ((*it).ids[i]==*pit)
-          found=true;
-      if (!found)
-      {
-        equal=false;
-        break;
-      }
-    }
-
-    if (equal)
-    {  
-      PME& p = const_cast<PME&>(*it);
-      ++(p.refs);
-      return &p;
-    }
-  }
-  static int pme_id=ps.size();
-  PME *pme = new PME(pme_id++, pids, owner);
-  ps.insert(*pme);
-  ++(pme->refs);
-  return pme;
+  std::pair<PM::iterator, bool> r = ps.insert(PME(ps.size(), pids, owner));
+  PME& p = const_cast<PME&>(*(r.first));
+  ++(p.refs);
+  return &p;
 }
 
 // the partition classification of mesh entities has to be updated separately
@@ -18,17 +18,7 @@
 
 static void* mds_realloc(void* p, size_t n)
 {
-  if ((!p)&&(!n))
-    return NULL;
-  if (n)
-    p = realloc(p,n);
-  else {
-    free(p);
-    p = NULL;
-  }
-  if ((!p) && (n))
-    reel_fail("MDS ran out of memory!\n");
-  return p;
+  return PCU_Mem_Realloc(PCU_MEM_MDS_ADJACENCY, p, n);
 }
 
 #define REALLOC(p,n) ((p)=mds_realloc(p,(n)*sizeof(*(p))))
@@ -233,8 +223,24 @@ static void alloc_adjacency(struct mds* m, int from_dim, int to_dim)
 void mds_remove_adjacency(struct mds* m, int from_dim, int to_dim)
 {
   mds_id zero_cap[MDS_TYPES] = {0};
+  mds_thaw(m);
   resize_adjacency(m,from_dim,to_dim,m->cap,zero_cap);
   m->mrm[from_dim][to_dim] = 0;
+  if (m->kept[from_dim][to_dim]) {
+    m->kept[from_dim][to_dim] = 0;
+    --(m->keeping);
+  }
+}
+
+static void drop_kept(struct mds* m)
+{
+  int i,j;
+  if (!m->keeping)
+    return;
+  for (i = 0; i <= 3; ++i)
+  for (j = 0; j <= 3; ++j)
+    if (m->kept[i][j])
+      mds_remove_adjacency(m, i, j);
 }
 
 static void resize_adjacencies(struct mds* m, mds_id old_cap[MDS_TYPES])
@@ -259,6 +265,17 @@ static void resize(struct mds* m, mds_id old_cap[MDS_TYPES])
   resize_free(m);
 }
 
+void mds_resize(struct mds* m, mds_id cap[MDS_TYPES])
+{
+  int i;
+  mds_id old_cap[MDS_TYPES];
+  for (i = 0; i < MDS_TYPES; ++i) {
+    old_cap[i] = m->cap[i];
+    m->cap[i] = cap[i];
+  }
+  resize(m,old_cap);
+}
+
 void mds_create(struct mds* m, int d, mds_id cap[MDS_TYPES])
 {
   int i,j;
@@ -280,6 +297,7 @@ void mds_destroy(struct mds* m)
 {
   int i;
   mds_id old_cap[MDS_TYPES];
+  mds_thaw(m);
   for (i = 0; i < MDS_TYPES; ++i)
     old_cap[i] = m->cap[i];
   ZERO(m->cap);
@@ -515,6 +533,18 @@ static void grow(struct mds* m, int t)
   resize(m,old_cap);
 }
 
+void mds_reserve(struct mds* m, int t, mds_id cap)
+{
+  int i;
+  mds_id old_cap[MDS_TYPES];
+  if (cap <= m->cap[t])
+    return;
+  for (i = 0; i < MDS_TYPES; ++i)
+    old_cap[i] = m->cap[i];
+  m->cap[t] = cap;
+  resize(m,old_cap);
+}
+
 static mds_id fill_hole(struct mds* m, int t)
 {
   mds_id *head;
@@ -603,6 +633,8 @@ static void unrelate_ent(struct mds* m, mds_id e)
 void mds_destroy_entity(struct mds* m, mds_id e)
 {
   check_ent(m,e);
+  mds_thaw(m);
+  drop_kept(m);
   if (TYPE(e) != MDS_VERTEX)
     unrelate_ent(m,e);
   free_ent(m,e);
@@ -618,6 +650,7 @@ void mds_hack_adjacent(struct mds* m, mds_id up, int i, mds_id down)
   mds_id od;
   check_ent(m, up);
   check_ent(m, down);
+  mds_thaw(m);
   ut = TYPE(up);
   ui = INDEX(up);
   dd = mds_dim[ut] - 1;
@@ -671,6 +704,8 @@ mds_id mds_create_entity(struct mds* m, int t, mds_id* from)
 {
   PCU_ALWAYS_ASSERT(0 <= t);
   PCU_ALWAYS_ASSERT(t < MDS_TYPES);
+  mds_thaw(m);
+  drop_kept(m);
   if (t == MDS_VERTEX)
     return alloc_ent(m, t);
   return add_ent(m, t, from);
@@ -730,6 +765,10 @@ void mds_get_adjacent(struct mds* m, mds_id e, int d, struct mds_set* s)
   }
   check_ent(m,e);
   e_dim = mds_dim[TYPE(e)];
+  if (m->frozen && (d > e_dim)) {
+    mds_get_frozen(m,e,d,s);
+    return;
+  }
   if ((e_dim == d) || m->mrm[e_dim][d]) {
     look(m,e,d,s);
     return;
@@ -740,6 +779,34 @@ void mds_get_adjacent(struct mds* m, mds_id e, int d, struct mds_set* s)
   get_up(m,e,d,s);
 }
 
+size_t mds_down_bytes(struct mds* m, int t)
+{
+  int d;
+  size_t n = 0;
+  for (d = 0; d < mds_dim[t]; ++d)
+    if (m->mrm[mds_dim[t]][d])
+      n += m->cap[t] * mds_degree[t][d];
+  return n * sizeof(mds_id);
+}
+
+size_t mds_up_bytes(struct mds* m, int t)
+{
+  int d;
+  size_t n = 0;
+  for (d = 0; d < mds_dim[t]; ++d)
+    if (m->mrm[d][mds_dim[t]])
+      n += m->cap[t] * mds_degree[t][d];
+  for (d = mds_dim[t] + 1; d <= 3; ++d)
+    if (m->mrm[mds_dim[t]][d])
+      n += m->cap[t];
+  if (m->frozen)
+    for (d = mds_dim[t] + 1; d <= 3; ++d)
+      if (m->frozen_offset[d][t])
+        n += m->end[t] + 1 +
+          m->frozen_offset[d][t][m->end[t]];
+  return n * sizeof(mds_id);
+}
+
 static mds_id skip(struct mds* m, mds_id e)
 {
   int t;
@@ -774,10 +841,57 @@ mds_id mds_next(struct mds* m, mds_id e)
   return skip(m,ID(TYPE(e),INDEX(e) + 1));
 }
 
+/* the first live entity at or after a position
+   in the slots of all types of one dimension */
+static mds_id skip_to(struct mds* m, int d, mds_id slot)
+{
+  int t;
+  for (t = 0; t < MDS_TYPES; ++t) {
+    if (mds_dim[t] != d)
+      continue;
+    if (slot < m->end[t])
+      return skip(m,ID(t,slot));
+    slot -= m->end[t];
+  }
+  return MDS_NONE;
+}
+
+/* chunks are equal ranges of slots, so free slots may make
+   them uneven, but finding one costs no more than skipping
+   the free slots at its start */
+void mds_chunk(struct mds* m, int d, int chunk, int chunks,
+    mds_id* first, mds_id* stop)
+{
+  int t;
+  double slots;
+  slots = 0;
+  for (t = 0; t < MDS_TYPES; ++t)
+    if (mds_dim[t] == d)
+      slots += m->end[t];
+  *first = skip_to(m,d,(mds_id)(slots * chunk / chunks));
+  *stop = skip_to(m,d,(mds_id)(slots * (chunk + 1) / chunks));
+}
+
+/* the entities of one type are those that iteration over
+   their dimension visits before the first live entity of
+   any later type of that dimension */
+void mds_type_range(struct mds* m, int type, mds_id* first, mds_id* stop)
+{
+  int t;
+  *first = skip(m,ID(type,0));
+  *stop = MDS_NONE;
+  for (t = type + 1; t < MDS_TYPES; ++t)
+    if (mds_dim[t] == mds_dim[type]) {
+      *stop = skip(m,ID(t,0));
+      return;
+    }
+}
+
 void mds_add_adjacency(struct mds* m, int from_dim, int to_dim)
 {
   mds_id e;
   struct mds_set adj;
+  mds_thaw(m);
   alloc_adjacency(m,from_dim,to_dim);
   if (from_dim < to_dim)
     for (e = mds_begin(m,to_dim);
@@ -796,6 +910,15 @@ void mds_add_adjacency(struct mds* m, int from_dim, int to_dim)
   m->mrm[from_dim][to_dim] = 1;
 }
 
+void mds_keep_adjacency(struct mds* m, int from_dim, int to_dim)
+{
+  if (m->mrm[from_dim][to_dim])
+    return;
+  mds_add_adjacency(m, from_dim, to_dim);
+  m->kept[from_dim][to_dim] = 1;
+  ++(m->keeping);
+}
+
 int mds_has_up(struct mds* m, mds_id e)
 {
   int d;
@@ -12,6 +12,7 @@
 #define MDS_H
 
 #include "mds_config.h"
+#include <stddef.h>
 
 enum {
   MDS_VERTEX,
@@ -41,6 +42,15 @@ struct mds {
   mds_id* first_up[4][MDS_TYPES];
   mds_id* free[MDS_TYPES];
   mds_id first_free[MDS_TYPES];
+  /* optional read-only snapshot of upward adjacency,
+     see mds_freeze */
+  int frozen;
+  mds_id* frozen_offset[4][MDS_TYPES];
+  mds_id* frozen_up[4][MDS_TYPES];
+  /* adjacencies stored until the next structural
+     change, see mds_keep_adjacency */
+  int kept[4][4];
+  int keeping;
 };
 
 struct mds_set {
@@ -56,15 +66,24 @@ void mds_create(struct mds* m, int d, mds_id cap[MDS_TYPES]);
 void mds_destroy(struct mds* m);
 mds_id mds_create_entity(struct mds* m, int type, mds_id *from);
 void mds_destroy_entity(struct mds* m, mds_id e);
+void mds_reserve(struct mds* m, int type, mds_id cap);
 int mds_type(mds_id e);
 mds_id mds_index(mds_id e);
 mds_id mds_identify(int type, mds_id idx);
 void mds_get_adjacent(struct mds* m, mds_id e, int dim, struct mds_set* s);
 mds_id mds_begin(struct mds* m, int dim);
 mds_id mds_next(struct mds* m, mds_id);
+void mds_chunk(struct mds* m, int dim, int chunk, int chunks,
+    mds_id* first, mds_id* stop);
+void mds_type_range(struct mds* m, int type, mds_id* first, mds_id* stop);
 
 void mds_add_adjacency(struct mds* m, int from_dim, int to_dim);
 void mds_remove_adjacency(struct mds* m, int from_dim, int to_dim);
+/* stores an adjacency like mds_add_adjacency, but only until the
+   next entity is created or destroyed, which removes it again.
+   creation and destruction maintain only the adjacencies one
+   dimension apart, so these are the only others that stay valid. */
+void mds_keep_adjacency(struct mds* m, int from_dim, int to_dim);
 
 int mds_has_up(struct mds* m, mds_id e);
 
@@ -72,4 +91,26 @@ void mds_change_dimension(struct mds* m, int d);
 
 void mds_hack_adjacent(struct mds* m, mds_id up, int i, mds_id down);
 
+/* moves entity i of type t to index new_index[t][i] for all live
+   entities, where new_index must rank the live entities of each
+   type in order, and shrinks the arrays to fit */
+void mds_compact(struct mds* m, mds_id* new_index[MDS_TYPES]);
+/* sets the capacity of each type, keeping the entities below it */
+void mds_resize(struct mds* m, mds_id cap[MDS_TYPES]);
+
+/* builds a compressed (CSR) copy of all upward adjacencies
+   which mds_get_adjacent reads instead of the linked lists.
+   any change to the mesh structure discards it. */
+void mds_freeze(struct mds* m);
+void mds_thaw(struct mds* m);
+/* the upward adjacent entities of e in dimension d
+   from the frozen copy */
+void mds_get_frozen(struct mds* m, mds_id e, int d, struct mds_set* s);
+
+/* bytes allocated for the adjacency of entities of type t.
+   the upward count includes the links stored in the
+   upward entities and the frozen snapshot, if any. */
+size_t mds_down_bytes(struct mds* m, int t);
+size_t mds_up_bytes(struct mds* m, int t);
+
 #endif
@@ -2,12 +2,20 @@
 #include "apfMDS.h"
 #include "apfMesh2.h"
 #include "apfShape.h"
+#include "apfConvert.h"
 #include "gmi.h" /* this is for gmi_getline... */
 
+#include <PCU.h>
+#include <algorithm>
+#include <climits>
 #include <cstdio>
 #include <cstring>
 #include <pcu_util.h>
 #include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace {
 
@@ -145,6 +153,23 @@ apf::MeshEntity* lookupVert(Reader* r, long nodeId, apf::ModelEntity* g)
   return n.entity;
 }
 
+/* builds an element from its vertex nodes, or just the
+   vertex of a point element, which returns null */
+apf::MeshEntity* buildGmshElement(Reader* r, apf::ModelEntity* g,
+    int apfType, long const* nids)
+{
+  int nverts = apf::Mesh::adjacentCount[apfType][0];
+  int dim = apf::Mesh::typeDimension[apfType];
+  apf::Downward verts;
+  for (int i = 0; i < nverts; ++i)
+    verts[i] = lookupVert(r, nids[i], g);
+  if (dim == 0)
+    return 0;
+  if (dim > r->mesh->getDimension())
+    apf::changeMdsDimension(r->mesh, dim);
+  return apf::buildElement(r->mesh, g, apfType, verts);
+}
+
 void readElement(Reader* r)
 {
   long id = getLong(r);
@@ -162,18 +187,12 @@ void readElement(Reader* r)
   for (long i = 2; i < ntags; ++i)
     getLong(r); /* discard all other element tags */
   apf::ModelEntity* g = r->mesh->findModelEntity(dim, gtag);
-  apf::Downward verts;
-  for (int i = 0; i < nverts; ++i) {
-    long nid = getLong(r);
-    verts[i] = lookupVert(r, nid, g);
-  }
-  if (dim != 0) {
-    if (dim > r->mesh->getDimension())
-      apf::changeMdsDimension(r->mesh, dim);
-    apf::MeshEntity* ent = apf::buildElement(r->mesh, g, apfType, verts);
-    if (r->isQuadratic)
-      r->entMap[dim][id] = ent;
-  }
+  long nids[8];
+  for (int i = 0; i < nverts; ++i)
+    nids[i] = getLong(r);
+  apf::MeshEntity* ent = buildGmshElement(r, g, apfType, nids);
+  if (ent && r->isQuadratic)
+    r->entMap[dim][id] = ent;
   getLine(r);
 }
 
@@ -247,8 +266,664 @@ void readQuadratic(Reader* r, apf::Mesh2* m, const char* filename)
   freeReader(r);
 }
 
+/* Gmsh 4.1 files, ASCII or binary, are parsed in place
+   from a memory map of the whole file */
+
+struct Mapped {
+  char const* begin;
+  char const* end;
+  size_t size;
+};
+
+void mapFile(Mapped* f, const char* filename)
+{
+  int fd = open(filename, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    fprintf(stderr,"couldn't open Gmsh file \"%s\"\n",filename);
+    abort();
+  }
+  f->size = st.st_size;
+  void* p = mmap(0, f->size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    fprintf(stderr,"couldn't map Gmsh file \"%s\"\n",filename);
+    abort();
+  }
+  f->begin = static_cast<char const*>(p);
+  f->end = f->begin + f->size;
+}
+
+void unmapFile(Mapped* f)
+{
+  munmap(const_cast<char*>(f->begin), f->size);
+}
+
+struct Cursor {
+  char const* p;
+  char const* end;
+  bool binary;
+};
+
+/* points (c) just past the line of (marker), searching from (from) */
+void seekMarker4(Cursor* c, char const* from, char const* marker)
+{
+  size_t lm = strlen(marker);
+  char const* p = from;
+  while (p && p + lm <= c->end) {
+    if (*p == '$' && !strncmp(p, marker, lm) &&
+        (p + lm == c->end || p[lm] == '\n' || p[lm] == '\r')) {
+      p = static_cast<char const*>(memchr(p, '\n', c->end - p));
+      PCU_ALWAYS_ASSERT(p);
+      c->p = p + 1;
+      return;
+    }
+    p = static_cast<char const*>(memchr(p + 1, '$', c->end - p - 1));
+  }
+  fprintf(stderr,"Gmsh file has no %s section\n", marker);
+  abort();
+}
+
+/* moves an ASCII cursor to the start of the next line */
+void endLine(Cursor* c)
+{
+  if (c->binary)
+    return;
+  char const* p = static_cast<char const*>(memchr(c->p, '\n', c->end - c->p));
+  PCU_ALWAYS_ASSERT(p);
+  c->p = p + 1;
+}
+
+size_t getSize(Cursor* c)
+{
+  size_t x;
+  if (c->binary) {
+    memcpy(&x, c->p, sizeof(x));
+    c->p += sizeof(x);
+    return x;
+  }
+  char* e;
+  x = strtoull(c->p, &e, 10);
+  PCU_ALWAYS_ASSERT(e != c->p);
+  c->p = e;
+  return x;
+}
+
+int getInt(Cursor* c)
+{
+  int x;
+  if (c->binary) {
+    memcpy(&x, c->p, sizeof(x));
+    c->p += sizeof(x);
+    return x;
+  }
+  char* e;
+  x = strtol(c->p, &e, 10);
+  PCU_ALWAYS_ASSERT(e != c->p);
+  c->p = e;
+  return x;
+}
+
+double getDouble(Cursor* c)
+{
+  double x;
+  if (c->binary) {
+    memcpy(&x, c->p, sizeof(x));
+    c->p += sizeof(x);
+    return x;
+  }
+  char* e;
+  x = strtod(c->p, &e);
+  PCU_ALWAYS_ASSERT(e != c->p);
+  c->p = e;
+  return x;
+}
+
+/* returns the format version and leaves (c) at the start of the file */
+double readFormat(Cursor* c, Mapped const& f)
+{
+  c->end = f.end;
+  c->binary = false;
+  seekMarker4(c, f.begin, "$MeshFormat");
+  double version = getDouble(c);
+  if (version < 4) {
+    c->p = f.begin;
+    return version;
+  }
+  PCU_ALWAYS_ASSERT_VERBOSE(version >= 4.1, "Gmsh 4.0 files are not supported");
+  int fileType = getInt(c);
+  int dataSize = getInt(c);
+  PCU_ALWAYS_ASSERT(dataSize == sizeof(size_t));
+  endLine(c);
+  if (fileType == 1) {
+    int one;
+    memcpy(&one, c->p, sizeof(one));
+    PCU_ALWAYS_ASSERT_VERBOSE(one == 1,
+        "Gmsh binary file has the wrong endianness");
+  }
+  c->binary = (fileType == 1);
+  c->p = f.begin;
+  return version;
+}
+
+/* the number of nodes of each Gmsh element type, linear or not */
+int gmshNodeCount(int gmshType)
+{
+  switch (gmshType) {
+    case 1: return 2;
+    case 2: return 3;
+    case 3: return 4;
+    case 4: return 4;
+    case 5: return 8;
+    case 6: return 6;
+    case 7: return 5;
+    case 8: return 3;
+    case 9: return 6;
+    case 10: return 9;
+    case 11: return 10;
+    case 12: return 27;
+    case 13: return 18;
+    case 14: return 14;
+    case 15: return 1;
+    case 16: return 8;
+    case 17: return 20;
+    case 18: return 15;
+    case 19: return 13;
+    default:
+      fprintf(stderr,"unknown Gmsh element type %d\n", gmshType);
+      abort();
+  }
+}
+
+struct NodeBlock {
+  char const* data;
+  int dim;
+  bool parametric;
+  size_t count;
+};
+
+struct ElementBlock {
+  char const* data;
+  int dim;
+  int tag;
+  int gmshType;
+  size_t count;
+};
+
+/* skips the data of (count) records of (values) numbers of (bytes)
+   each, one record per line in ASCII */
+void skipRecords(Cursor* c, size_t count, size_t values, size_t bytes)
+{
+  if (c->binary) {
+    c->p += count * values * bytes;
+    return;
+  }
+  for (size_t i = 0; i < count; ++i)
+    endLine(c);
+}
+
+size_t nodeValues(NodeBlock const& b)
+{
+  return 3 + (b.parametric ? b.dim : 0);
+}
+
+/* reads the $Nodes header and the location of each block */
+void scanNodes(Cursor* c, Mapped const& f, std::vector<NodeBlock>& blocks,
+    size_t& minTag, size_t& maxTag)
+{
+  seekMarker4(c, f.begin, "$Nodes");
+  size_t nblocks = getSize(c);
+  getSize(c); /* total nodes */
+  minTag = getSize(c);
+  maxTag = getSize(c);
+  endLine(c);
+  blocks.resize(nblocks);
+  for (size_t i = 0; i < nblocks; ++i) {
+    NodeBlock& b = blocks[i];
+    b.dim = getInt(c);
+    getInt(c); /* entity tag */
+    b.parametric = getInt(c);
+    b.count = getSize(c);
+    endLine(c);
+    b.data = c->p;
+    skipRecords(c, b.count, 1, sizeof(size_t));
+    skipRecords(c, b.count, nodeValues(b), sizeof(double));
+  }
+}
+
+/* reads nodes (first) to (first + count) of the block */
+void readNodeRange(Cursor* c, NodeBlock const& b, size_t first, size_t count,
+    std::vector<size_t>& tags, std::vector<double>& coords)
+{
+  c->p = b.data;
+  skipRecords(c, first, 1, sizeof(size_t));
+  for (size_t i = 0; i < count; ++i) {
+    tags.push_back(getSize(c));
+    endLine(c);
+  }
+  c->p = b.data;
+  skipRecords(c, b.count, 1, sizeof(size_t));
+  skipRecords(c, first, nodeValues(b), sizeof(double));
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t j = 0; j < nodeValues(b); ++j) {
+      double x = getDouble(c);
+      if (j < 3)
+        coords.push_back(x);
+    }
+    endLine(c);
+  }
+}
+
+/* reads the $Elements header and the location of each block,
+   the $Nodes section must come first */
+void scanElements(Cursor* c, std::vector<ElementBlock>& blocks)
+{
+  seekMarker4(c, c->p, "$Elements");
+  size_t nblocks = getSize(c);
+  getSize(c); /* total elements */
+  getSize(c); /* min tag */
+  getSize(c); /* max tag */
+  endLine(c);
+  blocks.resize(nblocks);
+  for (size_t i = 0; i < nblocks; ++i) {
+    ElementBlock& b = blocks[i];
+    b.dim = getInt(c);
+    b.tag = getInt(c);
+    b.gmshType = getInt(c);
+    b.count = getSize(c);
+    endLine(c);
+    b.data = c->p;
+    skipRecords(c, b.count, 1 + gmshNodeCount(b.gmshType), sizeof(size_t));
+  }
+}
+
+/* reads the node tags of elements (first) to (first + count) */
+void readElementRange(Cursor* c, ElementBlock const& b, size_t first,
+    size_t count, std::vector<size_t>& nodes)
+{
+  int nn = gmshNodeCount(b.gmshType);
+  c->p = b.data;
+  skipRecords(c, first, 1 + nn, sizeof(size_t));
+  for (size_t i = 0; i < count; ++i) {
+    getSize(c); /* element tag */
+    for (int j = 0; j < nn; ++j)
+      nodes.push_back(getSize(c));
+    endLine(c);
+  }
+}
+
+void readGmsh4(apf::Mesh2* m, Mapped const& f, Cursor* c)
+{
+  Reader r;
+  r.mesh = m;
+  r.isQuadratic = false;
+  std::vector<NodeBlock> nodeBlocks;
+  size_t minTag, maxTag;
+  scanNodes(c, f, nodeBlocks, minTag, maxTag);
+  std::vector<size_t> tags;
+  std::vector<double> coords;
+  for (size_t i = 0; i < nodeBlocks.size(); ++i)
+    readNodeRange(c, nodeBlocks[i], 0, nodeBlocks[i].count, tags, coords);
+  for (size_t i = 0; i < tags.size(); ++i)
+    r.nodeMap[tags[i]].point = apf::Vector3(&coords[i * 3]);
+  std::vector<ElementBlock> blocks;
+  scanElements(c, blocks);
+  std::vector<apf::MeshEntity*> quadratic;
+  std::vector<long> edgeNodes;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    ElementBlock const& b = blocks[i];
+    int apfType = apfFromGmsh(b.gmshType);
+    PCU_ALWAYS_ASSERT(0 <= apfType);
+    int dim = apf::Mesh::typeDimension[apfType];
+    int nn = gmshNodeCount(b.gmshType);
+    int nverts = apf::Mesh::adjacentCount[apfType][0];
+    apf::ModelEntity* g = m->findModelEntity(dim, b.tag);
+    std::vector<size_t> nodes;
+    readElementRange(c, b, 0, b.count, nodes);
+    for (size_t j = 0; j < b.count; ++j) {
+      long nids[10];
+      for (int k = 0; k < nn; ++k)
+        nids[k] = nodes[j * nn + k];
+      apf::MeshEntity* ent = buildGmshElement(&r, g, apfType, nids);
+      if (isQuadratic(b.gmshType)) {
+        r.isQuadratic = true;
+        quadratic.push_back(ent);
+        for (int k = nverts; k < nn; ++k)
+          edgeNodes.push_back(nids[k]);
+      }
+    }
+  }
+  m->acceptChanges();
+  if (!r.isQuadratic)
+    return;
+  m->changeShape(apf::getSerendipity());
+  apf::Field* coord = m->getCoordinateField();
+  size_t k = 0;
+  for (size_t i = 0; i < quadratic.size(); ++i) {
+    apf::MeshEntity* ent = quadratic[i];
+    int apfType = m->getType(ent);
+    int nedges = apf::Mesh::adjacentCount[apfType][1];
+    apf::Downward edges;
+    m->getDownward(ent, 1, edges);
+    for (int j = 0; j < nedges; ++j) {
+      long nid = edgeNodes[k + getQuadGmshIdx(j, apfType)];
+      apf::setVector(coord, edges[j], 0, r.nodeMap[nid].point);
+    }
+    k += nedges;
+  }
+}
+
+/* the brokers of global vertex ids follow apf::setCoords:
+   each rank has a contiguous range of (quotient) ids, and the
+   last rank also has the remainder */
+int getBroker(int gid, int quotient)
+{
+  return std::min(PCU_Comm_Peers() - 1, gid / quotient);
+}
+
+/* classifies all entities below the elements on the
+   model entity of an adjacent element */
+void classifyClosure(apf::Mesh2* m)
+{
+  int dim = m->getDimension();
+  for (int d = 0; d < dim; ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      apf::Adjacent elems;
+      m->getAdjacent(e, dim, elems);
+      m->setModelEntity(e, m->toModel(elems[0]));
+    }
+    m->end(it);
+  }
+}
+
+/* classifies (e) and the entities it bounds that are
+   classified on higher dimensional model entities than (g) */
+void classifyDown(apf::Mesh2* m, apf::MeshEntity* e, apf::ModelEntity* g)
+{
+  int modelDim = m->getModelType(g);
+  m->setModelEntity(e, g);
+  for (int d = 0; d < apf::getDimension(m, e); ++d) {
+    apf::Adjacent down;
+    m->getAdjacent(e, d, down);
+    for (size_t i = 0; i < down.getSize(); ++i)
+      if (m->getModelType(m->toModel(down[i])) > modelDim)
+        m->setModelEntity(down[i], g);
+  }
+}
+
+/* the lower dimensional elements of the file are sent to the
+   broker of their first vertex, and every part asks the brokers
+   of its vertices for the elements it may have */
+void classifyBoundary(apf::Mesh2* m, std::vector<int> const& lower,
+    apf::GlobalToVert& globalToVert, int quotient)
+{
+  /* (type, tag, nverts, gids...) records by first vertex */
+  std::map<int, std::vector<int> > records;
+  PCU_Comm_Begin();
+  for (size_t i = 0; i < lower.size(); i += 3 + lower[i + 2]) {
+    int to = getBroker(lower[i + 3], quotient);
+    PCU_Comm_Pack(to, &lower[i], (3 + lower[i + 2]) * sizeof(int));
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    int head[3];
+    PCU_Comm_Unpack(head, sizeof(head));
+    std::vector<int> gids(head[2]);
+    PCU_Comm_Unpack(&gids[0], head[2] * sizeof(int));
+    std::vector<int>& r = records[gids[0]];
+    r.insert(r.end(), head, head + 3);
+    r.insert(r.end(), gids.begin(), gids.end());
+  }
+  PCU_Comm_Begin();
+  APF_ITERATE(apf::GlobalToVert, globalToVert, it) {
+    int gid = it->first;
+    PCU_COMM_PACK(getBroker(gid, quotient), gid);
+  }
+  PCU_Comm_Send();
+  std::vector<std::pair<int, int> > asks;
+  while (PCU_Comm_Receive()) {
+    int gid;
+    PCU_COMM_UNPACK(gid);
+    if (records.count(gid))
+      asks.push_back(std::make_pair(PCU_Comm_Sender(), gid));
+  }
+  PCU_Comm_Begin();
+  for (size_t i = 0; i < asks.size(); ++i) {
+    std::vector<int>& r = records[asks[i].second];
+    PCU_Comm_Pack(asks[i].first, &r[0], r.size() * sizeof(int));
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    int head[3];
+    PCU_Comm_Unpack(head, sizeof(head));
+    int type = head[0];
+    int dim = apf::Mesh::typeDimension[type];
+    apf::Downward verts;
+    bool found = true;
+    for (int i = 0; i < head[2]; ++i) {
+      int gid;
+      PCU_COMM_UNPACK(gid);
+      if (globalToVert.count(gid))
+        verts[i] = globalToVert[gid];
+      else
+        found = false;
+    }
+    if (!found)
+      continue;
+    apf::MeshEntity* e = verts[0];
+    if (dim > 0)
+      e = apf::findElement(m, type, verts);
+    if (e)
+      classifyDown(m, e, m->findModelEntity(dim, head[1]));
+  }
+}
+
+/* copies the classification of owned entities to their remotes */
+void syncClassification(apf::Mesh2* m)
+{
+  PCU_Comm_Begin();
+  for (int d = 0; d < m->getDimension(); ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      if (!m->isShared(e) || !m->isOwned(e))
+        continue;
+      apf::ModelEntity* g = m->toModel(e);
+      int model[2] = {m->getModelType(g), m->getModelTag(g)};
+      apf::Copies remotes;
+      m->getRemotes(e, remotes);
+      APF_ITERATE(apf::Copies, remotes, rit) {
+        PCU_COMM_PACK(rit->first, rit->second);
+        PCU_Comm_Pack(rit->first, model, sizeof(model));
+      }
+    }
+    m->end(it);
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    apf::MeshEntity* e;
+    PCU_COMM_UNPACK(e);
+    int model[2];
+    PCU_Comm_Unpack(model, sizeof(model));
+    m->setModelEntity(e, m->findModelEntity(model[0], model[1]));
+  }
+}
+
+/* the part of (total) items this rank reads */
+void getShare(size_t total, size_t& first, size_t& count)
+{
+  size_t self = PCU_Comm_Self();
+  size_t peers = PCU_Comm_Peers();
+  first = total * self / peers;
+  count = total * (self + 1) / peers - first;
+}
+
+/* visits the part of the blocks' items in (first, first + count) */
+template <class B, class F>
+void forRange(std::vector<B> const& blocks, std::vector<bool> const& use,
+    size_t first, size_t count, F const& f)
+{
+  size_t at = 0;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    if (!use[i])
+      continue;
+    size_t lo = std::max(at, first);
+    size_t hi = std::min(at + blocks[i].count, first + count);
+    if (lo < hi)
+      f(blocks[i], lo - at, hi - lo);
+    at += blocks[i].count;
+  }
+}
+
+struct NodeRangeReader {
+  Cursor* c;
+  std::vector<size_t>* tags;
+  std::vector<double>* coords;
+  void operator()(NodeBlock const& b, size_t first, size_t count) const
+  {
+    readNodeRange(c, b, first, count, *tags, *coords);
+  }
+};
+
+struct ElementRangeReader {
+  Cursor* c;
+  std::vector<size_t>* nodes;
+  std::vector<int>* blockOf;
+  std::vector<ElementBlock> const* all;
+  void operator()(ElementBlock const& b, size_t first, size_t count) const
+  {
+    readElementRange(c, b, first, count, *nodes);
+    blockOf->insert(blockOf->end(), count, &b - &(*all)[0]);
+  }
+};
+
+apf::Mesh2* readGmshParallel(gmi_model* model, Mapped const& f, Cursor* c)
+{
+  int peers = PCU_Comm_Peers();
+  std::vector<NodeBlock> nodeBlocks;
+  size_t minTag, maxTag;
+  scanNodes(c, f, nodeBlocks, minTag, maxTag);
+  PCU_ALWAYS_ASSERT_VERBOSE(maxTag - minTag < size_t(INT_MAX),
+      "Gmsh node tags span more than an int");
+  std::vector<ElementBlock> blocks;
+  scanElements(c, blocks);
+  int dim = 0;
+  for (size_t i = 0; i < blocks.size(); ++i)
+    dim = std::max(dim, blocks[i].dim);
+  int type = -1;
+  size_t elements = 0;
+  size_t lowerElements = 0;
+  std::vector<bool> isElement(blocks.size());
+  std::vector<bool> isLower(blocks.size());
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    ElementBlock const& b = blocks[i];
+    PCU_ALWAYS_ASSERT_VERBOSE(!isQuadratic(b.gmshType),
+        "the parallel Gmsh reader only supports linear elements");
+    int apfType = apfFromGmsh(b.gmshType);
+    PCU_ALWAYS_ASSERT(0 <= apfType);
+    isElement[i] = (b.dim == dim);
+    isLower[i] = !isElement[i];
+    if (isElement[i]) {
+      PCU_ALWAYS_ASSERT_VERBOSE(type < 0 || type == apfType,
+          "the parallel Gmsh reader needs one element type");
+      type = apfType;
+      elements += b.count;
+    } else {
+      lowerElements += b.count;
+    }
+  }
+  /* this rank's elements, with global ids from the node tags */
+  size_t first, count;
+  getShare(elements, first, count);
+  std::vector<size_t> nodes;
+  std::vector<int> blockOf;
+  ElementRangeReader er = {c, &nodes, &blockOf, &blocks};
+  forRange(blocks, isElement, first, count, er);
+  std::vector<int> conn(nodes.size());
+  for (size_t i = 0; i < nodes.size(); ++i)
+    conn[i] = nodes[i] - minTag;
+  apf::Mesh2* m = apf::makeEmptyMdsMesh(model, dim, false);
+  apf::GlobalToVert globalToVert;
+  apf::construct(m, conn.empty() ? 0 : &conn[0], blockOf.size(), type,
+      globalToVert);
+  apf::alignMdsRemotes(m);
+  for (size_t i = 0; i < blockOf.size(); ++i)
+    m->setModelEntity(apf::getMdsEntity(m, dim, i),
+        m->findModelEntity(dim, blocks[blockOf[i]].tag));
+  classifyClosure(m);
+  /* this rank's nodes go to their brokers in one exchange */
+  int maxGid = -1;
+  APF_ITERATE(apf::GlobalToVert, globalToVert, it)
+    maxGid = std::max(maxGid, it->first);
+  int total = PCU_Max_Int(maxGid) + 1;
+  int quotient = total / peers;
+  PCU_ALWAYS_ASSERT_VERBOSE(quotient > 0, "more ranks than Gmsh nodes");
+  int self = PCU_Comm_Self();
+  int mySize = quotient;
+  if (self == peers - 1)
+    mySize += total % peers;
+  std::vector<size_t> tags;
+  std::vector<double> coords;
+  std::vector<bool> allNodes(nodeBlocks.size(), true);
+  size_t nodeCount = 0;
+  for (size_t i = 0; i < nodeBlocks.size(); ++i)
+    nodeCount += nodeBlocks[i].count;
+  getShare(nodeCount, first, count);
+  NodeRangeReader nr = {c, &tags, &coords};
+  forRange(nodeBlocks, allNodes, first, count, nr);
+  PCU_Comm_Begin();
+  for (size_t i = 0; i < tags.size(); ++i) {
+    int gid = tags[i] - minTag;
+    if (gid >= total)
+      continue;
+    int to = getBroker(gid, quotient);
+    PCU_COMM_PACK(to, gid);
+    PCU_Comm_Pack(to, &coords[i * 3], 3 * sizeof(double));
+  }
+  PCU_Comm_Send();
+  std::vector<double> mine(mySize * 3, 0.0);
+  while (PCU_Comm_Receive()) {
+    int gid;
+    PCU_COMM_UNPACK(gid);
+    PCU_Comm_Unpack(&mine[(gid - self * quotient) * 3], 3 * sizeof(double));
+  }
+  apf::setCoords(m, &mine[0], mySize, globalToVert);
+  /* then this rank's share of the boundary elements */
+  getShare(lowerElements, first, count);
+  nodes.clear();
+  blockOf.clear();
+  forRange(blocks, isLower, first, count, er);
+  std::vector<int> lower;
+  size_t k = 0;
+  for (size_t i = 0; i < blockOf.size(); ++i) {
+    ElementBlock const& b = blocks[blockOf[i]];
+    int nn = gmshNodeCount(b.gmshType);
+    lower.push_back(apfFromGmsh(b.gmshType));
+    lower.push_back(b.tag);
+    lower.push_back(nn);
+    for (int j = 0; j < nn; ++j)
+      lower.push_back(nodes[k++] - minTag);
+  }
+  classifyBoundary(m, lower, globalToVert, quotient);
+  syncClassification(m);
+  m->acceptChanges();
+  return m;
+}
+
 void readGmsh(apf::Mesh2* m, const char* filename)
 {
+  Mapped f;
+  mapFile(&f, filename);
+  Cursor c;
+  double version = readFormat(&c, f);
+  if (version >= 4) {
+    readGmsh4(m, f, &c);
+    unmapFile(&f);
+    return;
+  }
+  unmapFile(&f);
   Reader r;
   initReader(&r, m, filename);
   readNodes(&r);
@@ -270,4 +945,22 @@ Mesh2* loadMdsFromGmsh(gmi_model* g, const char* filename)
   return m;
 }
 
+Mesh2* loadMdsFromGmshParallel(gmi_model* g, const char* filename)
+{
+  double t0 = PCU_Time();
+  Mapped f;
+  mapFile(&f, filename);
+  Cursor c;
+  double version = readFormat(&c, f);
+  PCU_ALWAYS_ASSERT_VERBOSE(version >= 4,
+      "the parallel Gmsh reader needs a version 4.1 file");
+  Mesh2* m = readGmshParallel(g, f, &c);
+  unmapFile(&f);
+  double t1 = PCU_Time();
+  if (!PCU_Comm_Self())
+    printf("Gmsh file %s loaded in parallel in %f seconds\n",
+        filename, t1 - t0);
+  return m;
+}
+
 }
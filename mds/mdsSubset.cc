@@ -0,0 +1,152 @@
+#include "apfMDS.h"
+#include <apfMesh2.h>
+#include <apf.h>
+#include <gmi.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace apf {
+
+static void keep(Mesh* m, MeshTag* kept, MeshEntity* e)
+{
+  int one = 1;
+  m->setIntTag(e, kept, &one);
+  int d = getDimension(m, e);
+  for (int i = 0; i < d; ++i) {
+    Downward down;
+    int nd = m->getDownward(e, i, down);
+    for (int j = 0; j < nd; ++j)
+      m->setIntTag(down[j], kept, &one);
+  }
+}
+
+/* entities classified on the selected model entities, their
+   closure, and if (layer) the elements on them and their closure */
+static void markSubset(Mesh* m, MeshTag* kept, int modelDim,
+    std::vector<int> const& tags, bool layer)
+{
+  int dim = m->getDimension();
+  for (int d = 0; d <= std::min(modelDim, dim); ++d) {
+    MeshIterator* it = m->begin(d);
+    MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      ModelEntity* c = m->toModel(e);
+      if (m->getModelType(c) != modelDim ||
+          !std::binary_search(tags.begin(), tags.end(), m->getModelTag(c)))
+        continue;
+      keep(m, kept, e);
+      if (!layer || d == dim)
+        continue;
+      Adjacent elements;
+      m->getAdjacent(e, dim, elements);
+      for (size_t i = 0; i < elements.getSize(); ++i)
+        keep(m, kept, elements[i]);
+    }
+    m->end(it);
+  }
+}
+
+/* copies and matches of dropped entities are removed from the
+   kept entities that point at them, on any part */
+static void dropCopies(Mesh2* m, MeshTag* kept)
+{
+  int self = PCU_Comm_Self();
+  PCU_Comm_Begin();
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    MeshIterator* it = m->begin(d);
+    MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      if (m->hasTag(e, kept))
+        continue;
+      int isMatch = 0;
+      Copies remotes;
+      m->getRemotes(e, remotes);
+      APF_ITERATE(Copies, remotes, rit) {
+        PCU_COMM_PACK(rit->first, rit->second);
+        PCU_COMM_PACK(rit->first, isMatch);
+      }
+      if (!m->hasMatching())
+        continue;
+      isMatch = 1;
+      Matches matches;
+      m->getMatches(e, matches);
+      for (size_t i = 0; i < matches.getSize(); ++i) {
+        PCU_COMM_PACK(matches[i].peer, matches[i].entity);
+        PCU_COMM_PACK(matches[i].peer, isMatch);
+        PCU_COMM_PACK(matches[i].peer, e);
+      }
+    }
+    m->end(it);
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    MeshEntity* e;
+    int isMatch;
+    PCU_COMM_UNPACK(e);
+    PCU_COMM_UNPACK(isMatch);
+    int from = PCU_Comm_Sender();
+    if (!isMatch) {
+      Copies remotes;
+      m->getRemotes(e, remotes);
+      remotes.erase(from);
+      m->setRemotes(e, remotes);
+      Parts residence;
+      residence.insert(self);
+      APF_ITERATE(Copies, remotes, rit)
+        residence.insert(rit->first);
+      m->setResidence(e, residence);
+      continue;
+    }
+    MeshEntity* match;
+    PCU_COMM_UNPACK(match);
+    Matches matches;
+    m->getMatches(e, matches);
+    m->clearMatches(e);
+    for (size_t i = 0; i < matches.getSize(); ++i)
+      if (matches[i].peer != from || matches[i].entity != match)
+        m->addMatch(e, matches[i].peer, matches[i].entity);
+  }
+}
+
+Mesh2* loadMdsSubset(gmi_model* model, const char* meshfile, int modelDim,
+    int const* modelTags, int ntags, bool layer)
+{
+  double t0 = PCU_Time();
+  Mesh2* m = loadMdsMesh(model, meshfile);
+  std::vector<int> tags(modelTags, modelTags + ntags);
+  std::sort(tags.begin(), tags.end());
+  MeshTag* kept = m->createIntTag("apf_subset_kept", 1);
+  markSubset(m, kept, modelDim, tags, layer);
+  dropCopies(m, kept);
+  long counts[2] = {0, 0};
+  for (int d = m->getDimension(); d >= 0; --d) {
+    std::vector<MeshEntity*> dropped;
+    MeshIterator* it = m->begin(d);
+    MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      ++counts[0];
+      if (!m->hasTag(e, kept))
+        dropped.push_back(e);
+    }
+    m->end(it);
+    for (size_t i = 0; i < dropped.size(); ++i)
+      m->destroy(dropped[i]);
+    counts[1] += dropped.size();
+  }
+  for (int d = 0; d <= m->getDimension(); ++d)
+    removeTagFromDimension(m, kept, d);
+  m->destroyTag(kept);
+  m->acceptChanges();
+  compactMdsMesh(m);
+  PCU_Add_Longs(counts, 2);
+  double t1 = PCU_Time();
+  if (!PCU_Comm_Self())
+    printf("mesh subset of %ld of %ld entities loaded in %f seconds\n",
+        counts[0] - counts[1], counts[0], t1 - t0);
+  return m;
+}
+
+}
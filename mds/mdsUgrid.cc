@@ -1,13 +1,17 @@
 #include "apf.h"
 #include "apfMDS.h"
 #include "apfMesh2.h"
+#include "apfConvert.h"
 #include "pcu_io.h"
 #include "pcu_byteorder.h"
 
+#include <PCU.h>
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <pcu_util.h>
 #include <cstdlib>
+#include <vector>
 
 /*
 read files in the AFLR3 format from Dave Marcum at Mississippi State
@@ -48,13 +52,7 @@ namespace {
     }
   };
 
-  void initReader(Reader* r, apf::Mesh2* m, const char* filename) {
-    r->mesh = m;
-    r->file = fopen(filename, "rb");
-    if (!r->file) {
-      fprintf(stderr,"ERROR couldn't open ugrid file \"%s\"\n",filename);
-      abort();
-    }
+  bool needsSwap(const char* filename) {
     unsigned endian = -1;
     if ( strstr(filename, ".b8.ugrid") ) {
       endian = PCU_BIG_ENDIAN;
@@ -65,7 +63,17 @@ namespace {
           "ERROR file extension of \"%s\" is not supported\n", filename);
       exit(EXIT_FAILURE);
     }
-    r->swapBytes = ( endian != PCU_HOST_ORDER );
+    return ( endian != PCU_HOST_ORDER );
+  }
+
+  void initReader(Reader* r, apf::Mesh2* m, const char* filename) {
+    r->mesh = m;
+    r->file = fopen(filename, "rb");
+    if (!r->file) {
+      fprintf(stderr,"ERROR couldn't open ugrid file \"%s\"\n",filename);
+      abort();
+    }
+    r->swapBytes = needsSwap(filename);
   }
 
   void readUnsigneds(FILE* f, unsigned* v, size_t cnt, bool swap) {
@@ -216,17 +224,16 @@ namespace {
     size_t cnt = nelms*nverts;
     unsigned* vtx = (unsigned*) calloc(cnt,sizeof(unsigned));
     readUnsigneds(r->file, vtx, cnt, r->swapBytes);
+    std::vector<apf::MeshEntity*> verts(cnt);
     for(unsigned i=0; i<nelms; i++) {
-      apf::Downward verts;
       for(unsigned j=0; j<nverts; j++) {
         const unsigned mdsIdx = ugridToMdsElmIdx(apfType,j);
-        verts[mdsIdx] = lookupVert(r, vtx[i*nverts+j]);
+        verts[i*nverts+mdsIdx] = lookupVert(r, vtx[i*nverts+j]);
       }
-      apf::MeshEntity* elm =
-        apf::buildElement(r->mesh, g, apfType, verts);
-      PCU_ALWAYS_ASSERT(elm);
     }
     free(vtx);
+    if (nelms)
+      apf::buildElements(r->mesh, g, apfType, nelms, &verts[0]);
     fprintf(stderr, "read %d %s\n", nelms, apf::Mesh::typeName[apfType]);
   }
 
@@ -401,6 +408,337 @@ namespace {
         "avgvtx %.3f avgelmW %.3f avgelm %.3f\n",
         imbvtx, imbelmW, imbelm, avgvtx, avgelmW, avgelm);
   }
+
+  /* the parallel reader: every rank reads its slices of the
+     fixed-size arrays at offsets computed from the header */
+
+  struct ParallelReader {
+    MPI_File file;
+    bool swapBytes;
+    header h;
+  };
+
+  void readAtAll(ParallelReader* r, MPI_Offset offset, void* data,
+      size_t bytes) {
+    pcu_io_transfer_all(r->file, PCU_Get_Comm(), offset,
+        static_cast<char*>(data), bytes, false, PCU_IO_OTHER);
+  }
+
+  void readUnsignedsAt(ParallelReader* r, MPI_Offset offset,
+      std::vector<unsigned>& v, size_t cnt) {
+    v.resize(cnt);
+    readAtAll(r, offset, cnt ? &v[0] : 0, cnt * sizeof(unsigned));
+    if ( r->swapBytes && cnt )
+      pcu_swap_unsigneds(&v[0], cnt);
+  }
+
+  void openParallel(ParallelReader* r, const char* filename) {
+    r->swapBytes = needsSwap(filename);
+    if (MPI_File_open(PCU_Get_Comm(), filename, MPI_MODE_RDONLY,
+          MPI_INFO_NULL, &r->file) != MPI_SUCCESS) {
+      fprintf(stderr,"ERROR couldn't open ugrid file \"%s\"\n",filename);
+      abort();
+    }
+    std::vector<unsigned> v;
+    readUnsignedsAt(r, 0, v, 7);
+    header& h = r->h;
+    h.nvtx = v[0]; h.ntri = v[1]; h.nquad = v[2]; h.ntet = v[3];
+    h.npyr = v[4]; h.nprz = v[5]; h.nhex = v[6];
+  }
+
+  /* the arrays follow the header in this order: vertex coordinates,
+     triangle then quad vertices, triangle then quad tags, and the
+     vertices of tets, pyramids, prisms and hexes */
+  const int elmTypes[4] =
+    {apf::Mesh::TET, apf::Mesh::PYRAMID, apf::Mesh::PRISM, apf::Mesh::HEX};
+
+  MPI_Offset faceVtxOffset(header const& h, int apfType) {
+    MPI_Offset at = 7 * sizeof(unsigned) + MPI_Offset(h.nvtx) * 3 *
+      sizeof(double);
+    if (apfType == apf::Mesh::QUAD)
+      at += MPI_Offset(h.ntri) * 3 * sizeof(unsigned);
+    return at;
+  }
+
+  MPI_Offset faceTagOffset(header const& h, int apfType) {
+    MPI_Offset at = faceVtxOffset(h, apf::Mesh::QUAD) +
+      MPI_Offset(h.nquad) * 4 * sizeof(unsigned);
+    if (apfType == apf::Mesh::QUAD)
+      at += MPI_Offset(h.ntri) * sizeof(unsigned);
+    return at;
+  }
+
+  unsigned elmCount(header const& h, int apfType) {
+    switch (apfType) {
+      case apf::Mesh::TET: return h.ntet;
+      case apf::Mesh::PYRAMID: return h.npyr;
+      case apf::Mesh::PRISM: return h.nprz;
+      default: return h.nhex;
+    }
+  }
+
+  MPI_Offset elmOffset(header const& h, int apfType) {
+    MPI_Offset at = faceTagOffset(h, apf::Mesh::QUAD) +
+      MPI_Offset(h.nquad) * sizeof(unsigned);
+    for (int i = 0; elmTypes[i] != apfType; ++i)
+      at += MPI_Offset(elmCount(h, elmTypes[i])) *
+        apf::Mesh::adjacentCount[elmTypes[i]][0] * sizeof(unsigned);
+    return at;
+  }
+
+  /* the part of (total) items this rank reads */
+  void getSlice(size_t total, size_t& first, size_t& count) {
+    size_t self = PCU_Comm_Self();
+    size_t peers = PCU_Comm_Peers();
+    first = total * self / peers;
+    count = total * (self + 1) / peers - first;
+  }
+
+  /* this rank's slice of each element type, as zero-based
+     vertex ids in MDS order */
+  void readElmSlices(ParallelReader* r, std::vector<int> conn[apf::Mesh::TYPES]) {
+    for (int i = 0; i < 4; ++i) {
+      int apfType = elmTypes[i];
+      const unsigned nverts = apf::Mesh::adjacentCount[apfType][0];
+      size_t first, count;
+      getSlice(elmCount(r->h, apfType), first, count);
+      std::vector<unsigned> vtx;
+      readUnsignedsAt(r, elmOffset(r->h, apfType) +
+          MPI_Offset(first) * nverts * sizeof(unsigned), vtx, count * nverts);
+      std::vector<int>& c = conn[apfType];
+      c.resize(vtx.size());
+      for (size_t e = 0; e < count; ++e)
+        for (unsigned j = 0; j < nverts; ++j)
+          c[e * nverts + ugridToMdsElmIdx(apfType, j)] =
+            ftnToC(vtx[e * nverts + j]);
+    }
+  }
+
+  /* reads a text partition vector of one part id per line by byte
+     ranges. Each rank parses the lines that start in its range and
+     an exscan of the line counts gives the id of its first vertex */
+  void readPtnSlice(const char* ptnFile, std::vector<int>& ptn,
+      std::vector<int>& firsts) {
+    FILE* f = fopen(ptnFile, "r");
+    if (!f) {
+      fprintf(stderr,"ERROR couldn't open partition file \"%s\"\n",ptnFile);
+      abort();
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    long self = PCU_Comm_Self();
+    long peers = PCU_Comm_Peers();
+    long lo = size * self / peers;
+    long hi = size * (self + 1) / peers;
+    fseek(f, lo ? lo - 1 : 0, SEEK_SET);
+    if (lo) {
+      int c;
+      while ((c = getc(f)) != EOF && c != '\n');
+    }
+    char line[64];
+    while (ftell(f) < hi && fgets(line, sizeof(line), f)) {
+      int part;
+      if (sscanf(line, "%d", &part) == 1)
+        ptn.push_back(part);
+    }
+    fclose(f);
+    firsts.resize(peers + 1);
+    int first = PCU_Exscan_Int(ptn.size());
+    MPI_Allgather(&first, 1, MPI_INT, &firsts[0], 1, MPI_INT,
+        PCU_Get_Comm());
+    firsts[peers] = PCU_Add_Int(ptn.size());
+  }
+
+  /* sends each element to the rank holding the partition entry of
+     its first vertex, which forwards it to that part */
+  void distributeElms(const char* ptnFile,
+      std::vector<int> conn[apf::Mesh::TYPES]) {
+    std::vector<int> ptn;
+    std::vector<int> firsts;
+    readPtnSlice(ptnFile, ptn, firsts);
+    int self = PCU_Comm_Self();
+    PCU_Comm_Begin();
+    for (int i = 0; i < 4; ++i) {
+      int t = elmTypes[i];
+      const int nverts = apf::Mesh::adjacentCount[t][0];
+      for (size_t e = 0; e < conn[t].size(); e += nverts) {
+        int to = std::upper_bound(firsts.begin(), firsts.end() - 1,
+            conn[t][e]) - firsts.begin() - 1;
+        PCU_COMM_PACK(to, t);
+        PCU_Comm_Pack(to, &conn[t][e], nverts * sizeof(int));
+      }
+      conn[t].clear();
+    }
+    PCU_Comm_Send();
+    std::vector<int> routed;
+    while (PCU_Comm_Receive()) {
+      int t;
+      PCU_COMM_UNPACK(t);
+      const int nverts = apf::Mesh::adjacentCount[t][0];
+      int verts[8];
+      PCU_Comm_Unpack(verts, nverts * sizeof(int));
+      int part = ptn.at(verts[0] - firsts[self]);
+      PCU_ALWAYS_ASSERT(0 <= part && part < PCU_Comm_Peers());
+      routed.push_back(part);
+      routed.push_back(t);
+      routed.insert(routed.end(), verts, verts + nverts);
+    }
+    PCU_Comm_Begin();
+    for (size_t i = 0; i < routed.size();) {
+      int to = routed[i];
+      int t = routed[i + 1];
+      const int nverts = apf::Mesh::adjacentCount[t][0];
+      PCU_COMM_PACK(to, t);
+      PCU_Comm_Pack(to, &routed[i + 2], nverts * sizeof(int));
+      i += 2 + nverts;
+    }
+    PCU_Comm_Send();
+    while (PCU_Comm_Receive()) {
+      int t;
+      PCU_COMM_UNPACK(t);
+      const int nverts = apf::Mesh::adjacentCount[t][0];
+      int verts[8];
+      PCU_Comm_Unpack(verts, nverts * sizeof(int));
+      conn[t].insert(conn[t].end(), verts, verts + nverts);
+    }
+  }
+
+  /* the brokers of vertex ids follow apf::setCoords: each rank
+     has a contiguous range of (quotient) ids and the last rank
+     also has the remainder */
+  int getBroker(int gid, int quotient) {
+    return std::min(PCU_Comm_Peers() - 1, gid / quotient);
+  }
+
+  /* boundary faces go to the broker of their first vertex, and
+     every part asks the brokers of its vertices for the faces
+     it may have */
+  void setFaceTagsParallel(ParallelReader* r, apf::Mesh2* m,
+      apf::GlobalToVert& gv, int quotient) {
+    std::map<int, std::vector<int> > records;
+    int faceTypes[2] = {apf::Mesh::TRIANGLE, apf::Mesh::QUAD};
+    unsigned faceCounts[2] = {r->h.ntri, r->h.nquad};
+    PCU_Comm_Begin();
+    for (int i = 0; i < 2; ++i) {
+      int t = faceTypes[i];
+      const unsigned nverts = apf::Mesh::adjacentCount[t][0];
+      size_t first, count;
+      getSlice(faceCounts[i], first, count);
+      std::vector<unsigned> vtx;
+      std::vector<unsigned> tags;
+      readUnsignedsAt(r, faceVtxOffset(r->h, t) +
+          MPI_Offset(first) * nverts * sizeof(unsigned), vtx, count * nverts);
+      readUnsignedsAt(r, faceTagOffset(r->h, t) +
+          MPI_Offset(first) * sizeof(unsigned), tags, count);
+      for (size_t f = 0; f < count; ++f) {
+        int rec[6];
+        rec[0] = t;
+        rec[1] = tags[f];
+        for (unsigned j = 0; j < nverts; ++j)
+          rec[2 + j] = ftnToC(vtx[f * nverts + j]);
+        PCU_Comm_Pack(getBroker(rec[2], quotient), rec,
+            (2 + nverts) * sizeof(int));
+      }
+    }
+    PCU_Comm_Send();
+    while (PCU_Comm_Receive()) {
+      int rec[6];
+      PCU_Comm_Unpack(rec, 2 * sizeof(int));
+      const int nverts = apf::Mesh::adjacentCount[rec[0]][0];
+      PCU_Comm_Unpack(rec + 2, nverts * sizeof(int));
+      std::vector<int>& v = records[rec[2]];
+      v.insert(v.end(), rec, rec + 2 + nverts);
+    }
+    PCU_Comm_Begin();
+    APF_ITERATE(apf::GlobalToVert, gv, it)
+      PCU_COMM_PACK(getBroker(it->first, quotient), it->first);
+    PCU_Comm_Send();
+    std::vector<std::pair<int, int> > asks;
+    while (PCU_Comm_Receive()) {
+      int gid;
+      PCU_COMM_UNPACK(gid);
+      if (records.count(gid))
+        asks.push_back(std::make_pair(PCU_Comm_Sender(), gid));
+    }
+    PCU_Comm_Begin();
+    for (size_t i = 0; i < asks.size(); ++i) {
+      std::vector<int>& v = records[asks[i].second];
+      PCU_Comm_Pack(asks[i].first, &v[0], v.size() * sizeof(int));
+    }
+    PCU_Comm_Send();
+    apf::MeshTag* tag = m->createIntTag("ugrid-face-tag", 1);
+    while (PCU_Comm_Receive()) {
+      int rec[6];
+      PCU_Comm_Unpack(rec, 2 * sizeof(int));
+      const int nverts = apf::Mesh::adjacentCount[rec[0]][0];
+      PCU_Comm_Unpack(rec + 2, nverts * sizeof(int));
+      apf::Downward verts;
+      bool found = true;
+      for (int j = 0; j < nverts; ++j) {
+        if (gv.count(rec[2 + j]))
+          verts[j] = gv[rec[2 + j]];
+        else
+          found = false;
+      }
+      if (!found)
+        continue;
+      apf::MeshEntity* f = apf::findElement(m, rec[0], verts);
+      if (f)
+        m->setIntTag(f, tag, &rec[1]);
+    }
+  }
+
+  void setNodeIdsParallel(apf::Mesh2* m, apf::GlobalToVert& gv) {
+    apf::MeshTag* t = m->createIntTag("ugrid-vtx-ids",1);
+    APF_ITERATE(apf::GlobalToVert, gv, it)
+      m->setIntTag(it->second, t, &it->first);
+  }
+
+  apf::Mesh2* readUgridParallel(gmi_model* g, const char* filename,
+      const char* ptnFile) {
+    ParallelReader r;
+    openParallel(&r, filename);
+    if (!PCU_Comm_Self())
+      r.h.print();
+    std::vector<int> conn[apf::Mesh::TYPES];
+    readElmSlices(&r, conn);
+    if (ptnFile)
+      distributeElms(ptnFile, conn);
+    const int* conns[apf::Mesh::TYPES];
+    int nelem[apf::Mesh::TYPES];
+    for (int t = 0; t < apf::Mesh::TYPES; ++t) {
+      conns[t] = conn[t].empty() ? 0 : &conn[t][0];
+      nelem[t] = conn[t].size() / apf::Mesh::adjacentCount[t][0];
+    }
+    apf::Mesh2* m = apf::makeEmptyMdsMesh(g, 3, false);
+    apf::GlobalToVert gv;
+    apf::construct(m, conns, nelem, gv);
+    apf::alignMdsRemotes(m);
+    /* each rank reads exactly the coordinates apf::setCoords
+       expects from it, so they need no exchange of their own */
+    int maxGid = -1;
+    APF_ITERATE(apf::GlobalToVert, gv, it)
+      maxGid = std::max(maxGid, it->first);
+    int total = PCU_Max_Int(maxGid) + 1;
+    int peers = PCU_Comm_Peers();
+    int quotient = total / peers;
+    PCU_ALWAYS_ASSERT(quotient > 0);
+    int mySize = quotient;
+    if (PCU_Comm_Self() == peers - 1)
+      mySize += total % peers;
+    std::vector<double> xyz(mySize * 3);
+    readAtAll(&r, 7 * sizeof(unsigned) + MPI_Offset(PCU_Comm_Self()) *
+        quotient * 3 * sizeof(double), &xyz[0], xyz.size() * sizeof(double));
+    if ( r.swapBytes )
+      pcu_swap_doubles(&xyz[0], xyz.size());
+    apf::setCoords(m, &xyz[0], mySize, gv);
+    setNodeIdsParallel(m, gv);
+    setFaceTagsParallel(&r, m, gv, quotient);
+    MPI_File_close(&r.file);
+    m->acceptChanges();
+    return m;
+  }
+
 }
 
 namespace apf {
@@ -413,6 +751,20 @@ namespace apf {
         m->count(0), m->count(1), m->count(2), m->count(3));
     return m;
   }
+  Mesh2* loadMdsFromUgridParallel(gmi_model* g, const char* filename,
+      const char* ptnfile)
+  {
+    double t0 = PCU_Time();
+    Mesh2* m = readUgridParallel(g, filename, ptnfile);
+    long n[4];
+    for (int d = 0; d < 4; ++d)
+      n[d] = countOwned(m, d);
+    PCU_Add_Longs(n, 4);
+    if (!PCU_Comm_Self())
+      fprintf(stderr,"vtx %ld edge %ld face %ld rgn %ld in %f seconds\n",
+          n[0], n[1], n[2], n[3], PCU_Time() - t0);
+    return m;
+  }
   void printUgridPtnStats(gmi_model* g, const char* ufile, const char* vtxptn,
       const double elmWeights[]) {
     Mesh2* m = makeEmptyMdsMesh(g, 0, false);
@@ -10,6 +10,7 @@
 
 #include "mds_apf.h"
 #include <stdlib.h>
+#include <string.h>
 #include <pcu_util.h>
 #include <PCU.h>
 
@@ -23,33 +24,39 @@ struct mds_apf* mds_apf_create(struct gmi_model* model, int d,
   m = malloc(sizeof(*m));
   mds_create(&(m->mds),d,cap);
   mds_create_tags(&(m->tags));
-  m->point = malloc(cap[MDS_VERTEX] * sizeof(*(m->point)));
-  m->param = malloc(cap[MDS_VERTEX] * sizeof(*(m->param)));
+  m->point = PCU_Mem_Alloc(PCU_MEM_MDS_COORDINATES,
+      cap[MDS_VERTEX] * sizeof(*(m->point)));
+  m->param = PCU_Mem_Alloc(PCU_MEM_MDS_COORDINATES,
+      cap[MDS_VERTEX] * sizeof(*(m->param)));
   for (t = 0; t < MDS_TYPES; ++t)
-    m->model[t] = malloc(cap[t] * sizeof(*(m->model[t])));
+    m->model[t] = PCU_Mem_Alloc(PCU_MEM_OTHER,
+        cap[t] * sizeof(*(m->model[t])));
   m->user_model = model;
   for (t = 0; t < MDS_TYPES; ++t)
-    m->parts[t] = calloc(cap[t], sizeof(*(m->parts[t])));
+    m->parts[t] = PCU_Mem_Calloc(PCU_MEM_OTHER,
+        cap[t], sizeof(*(m->parts[t])));
   mds_create_net(&m->remotes);
 //seol
   mds_create_net(&m->ghosts);
   mds_create_net(&m->matches);
+  m->lazy = NULL;
   return m;
 }
 
 void mds_apf_destroy(struct mds_apf* m)
 {
   int t;
+  mds_forget_tags(m);
   mds_destroy_net(&m->matches, &m->mds);
 //seol
   mds_destroy_net(&m->ghosts, &m->mds);
   mds_destroy_net(&m->remotes, &m->mds);
   for (t = 0; t < MDS_TYPES; ++t)
-    free(m->model[t]);
+    PCU_Mem_Free(m->model[t]);
   for (t = 0; t < MDS_TYPES; ++t)
-    free(m->parts[t]);
-  free(m->point);
-  free(m->param);
+    PCU_Mem_Free(m->parts[t]);
+  PCU_Mem_Free(m->point);
+  PCU_Mem_Free(m->param);
   mds_destroy_tags(&(m->tags));
   mds_destroy(&(m->mds));
   free(m);
@@ -75,33 +82,50 @@ void mds_apf_set_model(struct mds_apf* m, mds_id e, struct gmi_ent* model)
   m->model[mds_type(e)][mds_index(e)] = model;
 }
 
-mds_id mds_apf_create_entity(
-    struct mds_apf* m, int type, struct gmi_ent* model, mds_id* from)
+/* follow a change in the capacity of one type */
+static void grow(struct mds_apf* m, int type, mds_id type_cap)
 {
   int t;
   mds_id old_cap[MDS_TYPES];
+  for (t = 0; t < MDS_TYPES; ++t)
+    old_cap[t] = m->mds.cap[t];
+  old_cap[type] = type_cap;
+  mds_grow_tags(&(m->tags),&(m->mds),old_cap);
+  if (type == MDS_VERTEX) {
+    m->point = PCU_Mem_Realloc(PCU_MEM_MDS_COORDINATES, m->point,
+        m->mds.cap[type] * sizeof(*(m->point)));
+    m->param = PCU_Mem_Realloc(PCU_MEM_MDS_COORDINATES, m->param,
+        m->mds.cap[type] * sizeof(*(m->param)));
+  }
+  m->model[type] = PCU_Mem_Realloc(PCU_MEM_OTHER, m->model[type],
+      m->mds.cap[type] * sizeof(*(m->model[type])));
+  m->parts[type] = PCU_Mem_Realloc(PCU_MEM_OTHER, m->parts[type],
+      m->mds.cap[type] * sizeof(*(m->parts[type])));
+  mds_grow_net(&m->remotes, &m->mds, old_cap); 
+  mds_grow_net(&m->ghosts, &m->mds, old_cap); //seol
+  mds_grow_net(&m->matches, &m->mds, old_cap);
+}
+
+void mds_apf_reserve(struct mds_apf* m, int type, mds_id cap)
+{
+  mds_id old_cap;
+  old_cap = m->mds.cap[type];
+  mds_reserve(&(m->mds),type,cap);
+  if (m->mds.cap[type] != old_cap)
+    grow(m,type,old_cap);
+}
+
+mds_id mds_apf_create_entity(
+    struct mds_apf* m, int type, struct gmi_ent* model, mds_id* from)
+{
+  mds_id old_cap;
   mds_id e;
   mds_id i;
-  old_cap[type] = m->mds.cap[type];
+  old_cap = m->mds.cap[type];
   e = mds_create_entity(&(m->mds),type,from);
   i = mds_index(e);
-  if (m->mds.cap[type] != old_cap[type]) {
-    for (t = 0; t < MDS_TYPES; ++t)
-      if (t != type)
-        old_cap[t] = m->mds.cap[t];
-    mds_grow_tags(&(m->tags),&(m->mds),old_cap);
-    if (type == MDS_VERTEX) {
-      m->point = realloc(m->point,m->mds.cap[type] * sizeof(*(m->point)));
-      m->param = realloc(m->param,m->mds.cap[type] * sizeof(*(m->param)));
-    }
-    m->model[type] = realloc(m->model[type],
-        m->mds.cap[type] * sizeof(*(m->model[type])));
-    m->parts[type] = realloc(m->parts[type],
-        m->mds.cap[type] * sizeof(*(m->parts[type])));
-    mds_grow_net(&m->remotes, &m->mds, old_cap); 
-    mds_grow_net(&m->ghosts, &m->mds, old_cap); //seol
-    mds_grow_net(&m->matches, &m->mds, old_cap);
-  }
+  if (m->mds.cap[type] != old_cap)
+    grow(m,type,old_cap);
   m->model[type][i] = model;
   m->parts[type][i] = NULL;
   if (type == MDS_VERTEX) {
@@ -114,6 +138,7 @@ mds_id mds_apf_create_entity(
 void mds_apf_destroy_entity(struct mds_apf* m, mds_id e)
 {
   struct mds_tag* t;
+  mds_load_tags(m);
   for (t = m->tags.first; t; t = t->next)
     if (mds_has_tag(t,e))
       mds_take_tag(t,e);
@@ -123,6 +148,132 @@ void mds_apf_destroy_entity(struct mds_apf* m, mds_id e)
   mds_destroy_entity(&(m->mds),e);
 }
 
+/* copies hold entity ids of other parts, so before anything
+   moves each copy asks its part for the new id of its entity.
+   copy structures do not move during this, so the question
+   carries the address where the answer goes. */
+struct answer {
+  struct mds_copy* c;
+  mds_id e;
+  int p;
+};
+
+static void update_net(struct mds_net* net, struct mds* m,
+    mds_id* new_index[MDS_TYPES])
+{
+  int d;
+  int i;
+  int from;
+  mds_id e;
+  struct mds_copies* cs;
+  struct mds_copy* c;
+  struct answer* answers;
+  int n;
+  int cap;
+  PCU_Comm_Begin();
+  for (d = 0; d <= m->d; ++d)
+    for (e = mds_begin(m, d); e != MDS_NONE; e = mds_next(m, e)) {
+      cs = mds_get_copies(net, e);
+      if (!cs)
+        continue;
+      for (i = 0; i < cs->n; ++i) {
+        c = cs->c + i;
+        PCU_COMM_PACK(c->p, c);
+        PCU_COMM_PACK(c->p, c->e);
+      }
+    }
+  PCU_Comm_Send();
+  n = 0;
+  cap = 0;
+  answers = NULL;
+  while (PCU_Comm_Listen()) {
+    from = PCU_Comm_Sender();
+    while (!PCU_Comm_Unpacked()) {
+      if (n == cap) {
+        cap = cap ? cap * 2 : 64;
+        answers = realloc(answers, cap * sizeof(*answers));
+      }
+      PCU_COMM_UNPACK(answers[n].c);
+      PCU_COMM_UNPACK(e);
+      answers[n].e =
+        mds_identify(mds_type(e), new_index[mds_type(e)][mds_index(e)]);
+      answers[n].p = from;
+      ++n;
+    }
+  }
+  PCU_Comm_Begin();
+  for (i = 0; i < n; ++i) {
+    PCU_COMM_PACK(answers[i].p, answers[i].c);
+    PCU_COMM_PACK(answers[i].p, answers[i].e);
+  }
+  free(answers);
+  PCU_Comm_Send();
+  while (PCU_Comm_Listen())
+    while (!PCU_Comm_Unpacked()) {
+      PCU_COMM_UNPACK(c);
+      PCU_COMM_UNPACK(e);
+      c->e = e;
+    }
+}
+
+#define COMPACT(a,t,m,new_index) \
+  do { \
+    mds_id i_; \
+    for (i_ = 0; i_ < (m)->end[t]; ++i_) \
+      if ((m)->free[t][i_] == MDS_LIVE) \
+        memmove((a) + (new_index)[t][i_], (a) + i_, sizeof(*(a))); \
+  } while (0)
+
+void mds_apf_compact(struct mds_apf* m, int ignore_peers)
+{
+  mds_id* new_index[MDS_TYPES];
+  mds_id old_cap[MDS_TYPES];
+  mds_id i;
+  mds_id n;
+  int t;
+  mds_load_tags(m);
+  for (t = 0; t < MDS_TYPES; ++t) {
+    new_index[t] = malloc(m->mds.end[t] * sizeof(mds_id));
+    n = 0;
+    for (i = 0; i < m->mds.end[t]; ++i)
+      new_index[t][i] = (m->mds.free[t][i] == MDS_LIVE) ? n++ : MDS_NONE;
+  }
+  if (!ignore_peers) {
+    update_net(&m->remotes, &m->mds, new_index);
+    update_net(&m->ghosts, &m->mds, new_index);
+    update_net(&m->matches, &m->mds, new_index);
+  }
+  COMPACT(m->point, MDS_VERTEX, &m->mds, new_index);
+  COMPACT(m->param, MDS_VERTEX, &m->mds, new_index);
+  for (t = 0; t < MDS_TYPES; ++t) {
+    COMPACT(m->model[t], t, &m->mds, new_index);
+    COMPACT(m->parts[t], t, &m->mds, new_index);
+  }
+  mds_compact_tags(&m->tags, &m->mds, new_index);
+  mds_compact_net(&m->remotes, &m->mds, new_index);
+  mds_compact_net(&m->ghosts, &m->mds, new_index);
+  mds_compact_net(&m->matches, &m->mds, new_index);
+  for (t = 0; t < MDS_TYPES; ++t)
+    old_cap[t] = m->mds.cap[t];
+  mds_compact(&m->mds, new_index);
+  for (t = 0; t < MDS_TYPES; ++t)
+    free(new_index[t]);
+  m->point = PCU_Mem_Realloc(PCU_MEM_MDS_COORDINATES, m->point,
+      m->mds.cap[MDS_VERTEX] * sizeof(*(m->point)));
+  m->param = PCU_Mem_Realloc(PCU_MEM_MDS_COORDINATES, m->param,
+      m->mds.cap[MDS_VERTEX] * sizeof(*(m->param)));
+  for (t = 0; t < MDS_TYPES; ++t) {
+    m->model[t] = PCU_Mem_Realloc(PCU_MEM_OTHER, m->model[t],
+        m->mds.cap[t] * sizeof(*(m->model[t])));
+    m->parts[t] = PCU_Mem_Realloc(PCU_MEM_OTHER, m->parts[t],
+        m->mds.cap[t] * sizeof(*(m->parts[t])));
+  }
+  mds_grow_tags(&m->tags, &m->mds, old_cap);
+  mds_grow_net(&m->remotes, &m->mds, old_cap);
+  mds_grow_net(&m->ghosts, &m->mds, old_cap);
+  mds_grow_net(&m->matches, &m->mds, old_cap);
+}
+
 void* mds_get_part(struct mds_apf* m, mds_id e)
 {
   return m->parts[mds_type(e)][mds_index(e)];
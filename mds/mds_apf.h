@@ -22,6 +22,7 @@ extern "C" {
 #include "mds_net.h"
 
 struct pcu_file;
+struct mds_lazy;
 
 struct gmi_model;
 struct gmi_ent;
@@ -38,6 +39,7 @@ struct mds_apf {
 //seol
   struct mds_net ghosts;
   struct mds_net matches;
+  struct mds_lazy* lazy; /* tags still in the smb file, see mds_smb.c */
 };
 
 struct mds_apf* mds_apf_create(struct gmi_model* model, int d,
@@ -50,22 +52,47 @@ void mds_apf_set_model(struct mds_apf* m, mds_id e, struct gmi_ent* model);
 mds_id mds_apf_create_entity(
     struct mds_apf* m, int type, struct gmi_ent* model, mds_id* from);
 void mds_apf_destroy_entity(struct mds_apf* m, mds_id e);
+void mds_apf_reserve(struct mds_apf* m, int type, mds_id cap);
 
 void* mds_get_part(struct mds_apf* m, mds_id e);
 void mds_set_part(struct mds_apf* m, mds_id e, void* p);
 
 struct mds_tag* mds_number_verts_bfs(struct mds_apf* m);
+struct mds_tag* mds_number_verts_hilbert(struct mds_apf* m);
+struct mds_tag* mds_number_verts_morton(struct mds_apf* m);
+struct mds_tag* mds_number_verts_rcm(struct mds_apf* m);
+struct mds_tag* mds_number_verts_blocked(struct mds_apf* m, int block_size);
 struct mds_apf* mds_reorder(struct mds_apf* m, int ignore_peers,
     struct mds_tag* vert_numbers);
+void mds_apf_compact(struct mds_apf* m, int ignore_peers);
 
 struct gmi_ent* mds_find_model(struct mds_apf* m, int dim, int id);
 int mds_model_dim(struct mds_apf* m, struct gmi_ent* model);
 int mds_model_id(struct mds_apf* m, struct gmi_ent* model);
 
 struct mds_apf* mds_read_smb(struct gmi_model* model, const char* pathname,
-    int ignore_peers, void* apf_mesh);
+    int ignore_peers, void* apf_mesh, int lazy_tags);
+void mds_load_tag(struct mds_apf* m, struct mds_tag* t);
+void mds_load_tags(struct mds_apf* m);
+void mds_forget_tag(struct mds_apf* m, struct mds_tag* t);
+void mds_forget_tags(struct mds_apf* m);
 struct mds_apf* mds_write_smb(struct mds_apf* m, const char* pathname,
     int ignore_peers, void* apf_mesh);
+struct mds_apf* mds_read_smb_file(struct pcu_file* f,
+    struct gmi_model* model, int ignore_peers, void* apf_mesh, int lazy_tags);
+void mds_write_smb_file(struct pcu_file* f, struct mds_apf* m,
+    int ignore_peers, void* apf_mesh);
+void mds_smb_base_path(char* path, int is_write);
+/* aggregated smb files, see mds_smbAgg.c */
+void mds_set_smb_parts_per_file(int n);
+void mds_write_agg(struct mds_apf* m, const char* pathname, void* apf_mesh);
+struct mds_apf* mds_read_agg(struct gmi_model* model, const char* pathname,
+    void* apf_mesh, int lazy_tags);
+/* serializes the part to (data) and opens its file as (file), which
+   is left NULL when the path is written collectively right away */
+struct mds_apf* mds_snapshot_smb(struct mds_apf* m, const char* pathname,
+    int ignore_peers, void* apf_mesh, struct pcu_file** file,
+    char** data, size_t* size);
 
 void mds_verify(struct mds_apf* m);
 void mds_verify_residence(struct mds_apf* m, mds_id e);
@@ -0,0 +1,112 @@
+/****************************************************************************** 
+
+  Copyright 2025 Scientific Computation Research Center, 
+      Rensselaer Polytechnic Institute. All rights reserved.
+  
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+
+#include "mds.h"
+
+/* compaction moves every live entity of type t from index i
+   down to index new_index[t][i], preserving order, so moves never
+   overwrite an entity that has yet to move. */
+
+static mds_id moved(mds_id* new_index[MDS_TYPES], mds_id e)
+{
+  return mds_identify(mds_type(e), new_index[mds_type(e)][mds_index(e)]);
+}
+
+/* a use of entity i of type t by its j'th downward entity
+   is the node mds_identify(t, i * deg + j) */
+static mds_id moved_node(mds_id* new_index[MDS_TYPES], mds_id node,
+    int down_dim)
+{
+  int t;
+  int deg;
+  mds_id idx;
+  if (node == MDS_NONE)
+    return MDS_NONE;
+  t = mds_type(node);
+  deg = mds_degree[t][down_dim];
+  idx = mds_index(node);
+  return mds_identify(t, new_index[t][idx / deg] * deg + idx % deg);
+}
+
+static void compact_array(mds_id* a, mds_id* new_index, mds_id end,
+    mds_id* free, int deg)
+{
+  mds_id i;
+  int j;
+  for (i = 0; i < end; ++i)
+    if ((free[i] == MDS_LIVE) && (new_index[i] != i))
+      for (j = 0; j < deg; ++j)
+        a[new_index[i] * deg + j] = a[i * deg + j];
+}
+
+static void compact_down(struct mds* m, int from, int to,
+    mds_id* new_index[MDS_TYPES])
+{
+  int t;
+  int deg;
+  mds_id k;
+  mds_id* a;
+  for (t = 0; t < MDS_TYPES; ++t)
+    if (mds_dim[t] == from) {
+      deg = mds_degree[t][to];
+      a = m->down[to][t];
+      for (k = 0; k < m->end[t] * deg; ++k)
+        if (m->free[t][k / deg] == MDS_LIVE)
+          a[k] = moved(new_index, a[k]);
+      compact_array(a, new_index[t], m->end[t], m->free[t], deg);
+    }
+}
+
+static void compact_up(struct mds* m, int from, int to,
+    mds_id* new_index[MDS_TYPES])
+{
+  int t;
+  int deg;
+  mds_id k;
+  mds_id* a;
+  for (t = 0; t < MDS_TYPES; ++t)
+    if (mds_dim[t] == to) {
+      deg = mds_degree[t][from];
+      a = m->up[from][t];
+      for (k = 0; k < m->end[t] * deg; ++k)
+        if (m->free[t][k / deg] == MDS_LIVE)
+          a[k] = moved_node(new_index, a[k], from);
+      compact_array(a, new_index[t], m->end[t], m->free[t], deg);
+    } else if (mds_dim[t] == from) {
+      a = m->first_up[to][t];
+      for (k = 0; k < m->end[t]; ++k)
+        if (m->free[t][k] == MDS_LIVE)
+          a[k] = moved_node(new_index, a[k], from);
+      compact_array(a, new_index[t], m->end[t], m->free[t], 1);
+    }
+}
+
+void mds_compact(struct mds* m, mds_id* new_index[MDS_TYPES])
+{
+  int i, j;
+  int t;
+  mds_id k;
+  mds_thaw(m);
+  for (i = 0; i <= 3; ++i)
+  for (j = 0; j <= 3; ++j)
+    if (m->mrm[i][j]) {
+      if (i < j)
+        compact_up(m, i, j, new_index);
+      else if (i > j)
+        compact_down(m, i, j, new_index);
+    }
+  for (t = 0; t < MDS_TYPES; ++t) {
+    for (k = 0; k < m->n[t]; ++k)
+      m->free[t][k] = MDS_LIVE;
+    m->first_free[t] = MDS_NONE;
+    m->end[t] = m->n[t];
+  }
+  mds_resize(m, m->n);
+}
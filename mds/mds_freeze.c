@@ -0,0 +1,86 @@
+/****************************************************************************** 
+
+  Copyright 2025 Scientific Computation Research Center, 
+      Rensselaer Polytechnic Institute. All rights reserved.
+  
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+
+#include "mds.h"
+#include <PCU.h>
+
+#define REALLOC(p,n) \
+  ((p)=PCU_Mem_Realloc(PCU_MEM_MDS_ADJACENCY,p,(n)*sizeof(*(p))))
+
+/* the upward sets of each entity of type t in dimension d,
+   stored one after another in index order, so that
+   the sets of entity i are up[offset[i]] to up[offset[i + 1]] */
+static void freeze_up(struct mds* m, int t, int d)
+{
+  mds_id* offset = NULL;
+  mds_id* up = NULL;
+  mds_id cap;
+  mds_id n;
+  mds_id i;
+  int j;
+  struct mds_set s;
+  REALLOC(offset,m->end[t] + 1);
+  cap = m->n[t];
+  REALLOC(up,cap);
+  n = 0;
+  offset[0] = 0;
+  for (i = 0; i < m->end[t]; ++i) {
+    if (m->free[t][i] == MDS_LIVE) {
+      mds_get_adjacent(m,mds_identify(t,i),d,&s);
+      if (n + s.n > cap) {
+        cap = (n + s.n) * 2;
+        REALLOC(up,cap);
+      }
+      for (j = 0; j < s.n; ++j)
+        up[n++] = s.e[j];
+    }
+    offset[i + 1] = n;
+  }
+  REALLOC(up,n);
+  m->frozen_offset[d][t] = offset;
+  m->frozen_up[d][t] = up;
+}
+
+void mds_freeze(struct mds* m)
+{
+  int t;
+  int d;
+  mds_thaw(m);
+  for (t = 0; t < MDS_TYPES; ++t)
+    for (d = mds_dim[t] + 1; d <= m->d; ++d)
+      freeze_up(m,t,d);
+  m->frozen = 1;
+}
+
+void mds_thaw(struct mds* m)
+{
+  int t;
+  int d;
+  if (!m->frozen)
+    return;
+  for (d = 0; d < 4; ++d)
+    for (t = 0; t < MDS_TYPES; ++t) {
+      REALLOC(m->frozen_offset[d][t],0);
+      REALLOC(m->frozen_up[d][t],0);
+    }
+  m->frozen = 0;
+}
+
+void mds_get_frozen(struct mds* m, mds_id e, int d, struct mds_set* s)
+{
+  mds_id* o;
+  mds_id* u;
+  mds_id j;
+  o = m->frozen_offset[d][mds_type(e)] + mds_index(e);
+  u = m->frozen_up[d][mds_type(e)];
+  s->n = o[1] - o[0];
+  for (j = o[0]; j < o[1]; ++j)
+    s->e[j - o[0]] = u[j];
+}
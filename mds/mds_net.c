@@ -19,6 +19,48 @@ void mds_create_net(struct mds_net* net)
   memset(net, 0, sizeof(*net));
 }
 
+/* copies are malloc'd one at a time as they are made,
+   then moved into one block per type by mds_pack_net.
+   Copies in the block are never freed alone, the space of
+   ones that get replaced is reclaimed by the next packing. */
+
+static int in_pool(struct mds_net* net, int t, struct mds_copies* c)
+{
+  char* p = (char*)c;
+  return net->pool[t] && p >= net->pool[t] &&
+    p < net->pool[t] + net->pool_bytes[t];
+}
+
+static void free_copies(struct mds_net* net, int t, struct mds_copies* c)
+{
+  if (!in_pool(net, t, c))
+    PCU_Mem_Free(c);
+}
+
+static size_t copies_bytes(int n)
+{
+  return sizeof(struct mds_copies) + (n - 1) * sizeof(struct mds_copy);
+}
+
+static void free_peers(struct mds_net* net, int t)
+{
+  struct mds_peers* ps = net->peers[t];
+  if (!ps)
+    return;
+  PCU_Mem_Free(ps->p);
+  PCU_Mem_Free(ps->offset);
+  PCU_Mem_Free(ps->e);
+  PCU_Mem_Free(ps);
+  net->peers[t] = NULL;
+}
+
+static void free_pool(struct mds_net* net, int t)
+{
+  PCU_Mem_Free(net->pool[t]);
+  net->pool[t] = NULL;
+  net->pool_bytes[t] = 0;
+}
+
 void mds_destroy_net(struct mds_net* net, struct mds* m)
 {
   int t;
@@ -26,15 +68,17 @@ void mds_destroy_net(struct mds_net* net, struct mds* m)
   for (t = 0; t < MDS_TYPES; ++t) {
     if (net->data[t])
       for (i = 0; i < m->cap[t]; ++i)
-        free(net->data[t][i]);
-    free(net->data[t]);
+        free_copies(net, t, net->data[t][i]);
+    PCU_Mem_Free(net->data[t]);
+    free_pool(net, t);
+    free_peers(net, t);
   }
 }
 
 struct mds_copies* mds_make_copies(int n)
 {
   struct mds_copies* c;
-  c = malloc(sizeof(struct mds_copies) + (n - 1) * sizeof(struct mds_copy));
+  c = PCU_Mem_Alloc(PCU_MEM_MDS_REMOTES, copies_bytes(n));
   c->n = n;
   return c;
 }
@@ -49,7 +93,8 @@ void mds_set_copies(struct mds_net* net, struct mds* m, mds_id e,
   i = mds_index(e);
   if (!net->data[t]) {
     if (c)
-      net->data[t] = calloc(m->cap[t], sizeof(*(net->data[t])));
+      net->data[t] = PCU_Mem_Calloc(PCU_MEM_MDS_REMOTES,
+          m->cap[t], sizeof(*(net->data[t])));
     else
       return;
   }
@@ -59,11 +104,13 @@ void mds_set_copies(struct mds_net* net, struct mds* m, mds_id e,
     ++net->n[t];
   else if (*p && !c)
     --net->n[t];
-  free(*p);
+  free_copies(net, t, *p);
   *p = c;
+  free_peers(net, t);
   if (!net->n[t]) {
-    free(net->data[t]);
+    PCU_Mem_Free(net->data[t]);
     net->data[t] = NULL;
+    free_pool(net, t);
   }
 }
 
@@ -84,13 +131,210 @@ void mds_grow_net(
   mds_id i;
   for (t = 0; t < MDS_TYPES; ++t)
     if (net->data[t]) {
-      net->data[t] = realloc(net->data[t],
+      net->data[t] = PCU_Mem_Realloc(PCU_MEM_MDS_REMOTES, net->data[t],
           m->cap[t] * sizeof(struct mds_copies*));
       for (i = old_cap[t]; i < m->cap[t]; ++i)
         net->data[t][i] = NULL;
     }
 }
 
+void mds_compact_net(
+    struct mds_net* net,
+    struct mds* m,
+    mds_id* new_index[MDS_TYPES])
+{
+  int t;
+  mds_id i;
+  for (t = 0; t < MDS_TYPES; ++t)
+    free_peers(net, t);
+  for (t = 0; t < MDS_TYPES; ++t)
+    if (net->data[t])
+      for (i = 0; i < m->end[t]; ++i)
+        if ((m->free[t][i] == MDS_LIVE) && (new_index[t][i] != i)) {
+          net->data[t][new_index[t][i]] = net->data[t][i];
+          net->data[t][i] = NULL;
+        }
+}
+
+size_t mds_net_bytes(struct mds_net* net, struct mds* m, int t)
+{
+  mds_id i;
+  size_t n;
+  if (!net->data[t])
+    return 0;
+  n = m->cap[t] * sizeof(struct mds_copies*) + net->pool_bytes[t];
+  for (i = 0; i < m->cap[t]; ++i)
+    if (net->data[t][i] && !in_pool(net, t, net->data[t][i]))
+      n += copies_bytes(net->data[t][i]->n);
+  if (net->peers[t])
+    n += (2 * net->peers[t]->np + 1) * sizeof(int) +
+      net->peers[t]->offset[net->peers[t]->np] * sizeof(mds_id);
+  return n;
+}
+
+static void pack_type(struct mds_net* net, struct mds* m, int t)
+{
+  char* pool;
+  size_t bytes;
+  size_t at;
+  size_t size;
+  mds_id i;
+  struct mds_copies* c;
+  bytes = 0;
+  for (i = 0; i < m->end[t]; ++i)
+    if (net->data[t][i])
+      bytes += copies_bytes(net->data[t][i]->n);
+  pool = PCU_Mem_Alloc(PCU_MEM_MDS_REMOTES, bytes);
+  at = 0;
+  for (i = 0; i < m->end[t]; ++i) {
+    c = net->data[t][i];
+    if (!c)
+      continue;
+    size = copies_bytes(c->n);
+    memcpy(pool + at, c, size);
+    free_copies(net, t, c);
+    net->data[t][i] = (struct mds_copies*)(pool + at);
+    at += size;
+  }
+  free_pool(net, t);
+  net->pool[t] = pool;
+  net->pool_bytes[t] = bytes;
+}
+
+static int find_rank(int* p, int np, int rank)
+{
+  int lo = 0;
+  int hi = np;
+  int mid;
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    if (p[mid] < rank)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+struct peer_entry {
+  mds_id remote;
+  mds_id local;
+};
+
+static int compare_remote(const void* a, const void* b)
+{
+  mds_id ra = ((const struct peer_entry*)a)->remote;
+  mds_id rb = ((const struct peer_entry*)b)->remote;
+  return (ra > rb) - (ra < rb);
+}
+
+/* the number of peers is small, so they are kept
+   in a sorted array found by bisection.
+   Two parts list the entities they share in the same order,
+   that of the indices on the lower-ranked part, so values
+   can be exchanged without naming the entities */
+static void index_peers(struct mds_net* net, struct mds* m, int t)
+{
+  struct mds_peers* ps;
+  struct mds_copies* c;
+  struct peer_entry* entries;
+  mds_id i;
+  mds_id* at;
+  int j, k;
+  int self = PCU_Comm_Self();
+  ps = PCU_Mem_Calloc(PCU_MEM_MDS_REMOTES, 1, sizeof(*ps));
+  for (i = 0; i < m->end[t]; ++i) {
+    c = net->data[t][i];
+    if (!c)
+      continue;
+    for (j = 0; j < c->n; ++j) {
+      k = find_rank(ps->p, ps->np, c->c[j].p);
+      if (k < ps->np && ps->p[k] == c->c[j].p)
+        continue;
+      ps->p = PCU_Mem_Realloc(PCU_MEM_MDS_REMOTES, ps->p,
+          (ps->np + 1) * sizeof(int));
+      memmove(ps->p + k + 1, ps->p + k, (ps->np - k) * sizeof(int));
+      ps->p[k] = c->c[j].p;
+      ++ps->np;
+    }
+  }
+  ps->offset = PCU_Mem_Calloc(PCU_MEM_MDS_REMOTES,
+      ps->np + 1, sizeof(mds_id));
+  for (i = 0; i < m->end[t]; ++i) {
+    c = net->data[t][i];
+    if (c)
+      for (j = 0; j < c->n; ++j)
+        ++ps->offset[find_rank(ps->p, ps->np, c->c[j].p) + 1];
+  }
+  for (k = 0; k < ps->np; ++k)
+    ps->offset[k + 1] += ps->offset[k];
+  entries = malloc(ps->offset[ps->np] * sizeof(*entries));
+  at = malloc(ps->np * sizeof(mds_id));
+  memcpy(at, ps->offset, ps->np * sizeof(mds_id));
+  for (i = 0; i < m->end[t]; ++i) {
+    c = net->data[t][i];
+    if (c)
+      for (j = 0; j < c->n; ++j) {
+        k = find_rank(ps->p, ps->np, c->c[j].p);
+        entries[at[k]].remote = c->c[j].e;
+        entries[at[k]].local = i;
+        ++at[k];
+      }
+  }
+  free(at);
+  for (k = 0; k < ps->np; ++k)
+    if (ps->p[k] < self)
+      qsort(entries + ps->offset[k], ps->offset[k + 1] - ps->offset[k],
+          sizeof(*entries), compare_remote);
+  ps->e = PCU_Mem_Alloc(PCU_MEM_MDS_REMOTES,
+      ps->offset[ps->np] * sizeof(mds_id));
+  for (i = 0; i < ps->offset[ps->np]; ++i)
+    ps->e[i] = entries[i].local;
+  free(entries);
+  net->peers[t] = ps;
+}
+
+void mds_pack_net(struct mds_net* net, struct mds* m)
+{
+  int t;
+  for (t = 0; t < MDS_TYPES; ++t) {
+    if (!net->data[t])
+      continue;
+    pack_type(net, m, t);
+    if (!net->peers[t])
+      index_peers(net, m, t);
+  }
+}
+
+int mds_get_peers(struct mds_net* net, struct mds* m, int t, int** p)
+{
+  *p = NULL;
+  if (!net->data[t])
+    return 0;
+  if (!net->peers[t])
+    index_peers(net, m, t);
+  *p = net->peers[t]->p;
+  return net->peers[t]->np;
+}
+
+mds_id mds_get_peer_entities(struct mds_net* net, struct mds* m,
+    int t, int p, mds_id** e)
+{
+  struct mds_peers* ps;
+  int k;
+  *e = NULL;
+  if (!net->data[t])
+    return 0;
+  if (!net->peers[t])
+    index_peers(net, m, t);
+  ps = net->peers[t];
+  k = find_rank(ps->p, ps->np, p);
+  if (k == ps->np || ps->p[k] != p)
+    return 0;
+  *e = ps->e + ps->offset[k];
+  return ps->offset[k + 1] - ps->offset[k];
+}
+
 static int find_place(struct mds_copies* cs, int p)
 {
   int i;
@@ -112,13 +356,17 @@ void mds_add_copy(struct mds_net* net, struct mds* m, mds_id e,
   cs = mds_get_copies(net, e);
   if (cs) {
     p = find_place(cs, c.p);
-    cs = realloc(cs, sizeof(struct mds_copies) +
-        (cs->n) * sizeof(struct mds_copy));
+    if (in_pool(net, t, cs)) {
+      cs = mds_make_copies(cs->n);
+      memcpy(cs, net->data[t][i], copies_bytes(cs->n));
+    }
+    cs = PCU_Mem_Realloc(PCU_MEM_MDS_REMOTES, cs, copies_bytes(cs->n + 1));
 /* insert sorted by moving greater items up by one */
     memmove(&cs->c[p + 1], &cs->c[p], (cs->n - p) * sizeof(struct mds_copy));
     cs->c[p] = c;
     ++cs->n;
     net->data[t][i] = cs;
+    free_peers(net, t);
   } else {
     cs = mds_make_copies(1);
     cs->c[0] = c;
@@ -23,9 +23,22 @@ struct mds_copies {
   struct mds_copy c[1];
 };
 
+/* the indices of the entities of one type shared with each peer,
+   grouped by peer in compressed sparse row form */
+struct mds_peers {
+  int np;
+  int* p; /* sorted peer ranks */
+  mds_id* offset; /* np + 1 offsets into e */
+  mds_id* e;
+};
+
 struct mds_net {
   mds_id n[MDS_TYPES];
   struct mds_copies** data[MDS_TYPES];
+  /* one block holding the copies of a type, see mds_pack_net */
+  char* pool[MDS_TYPES];
+  size_t pool_bytes[MDS_TYPES];
+  struct mds_peers* peers[MDS_TYPES];
 };
 
 struct mds_links {
@@ -46,6 +59,15 @@ void mds_grow_net(
     struct mds_net* net,
     struct mds* m,
     mds_id old_cap[MDS_TYPES]);
+void mds_compact_net(
+    struct mds_net* net,
+    struct mds* m,
+    mds_id* new_index[MDS_TYPES]);
+size_t mds_net_bytes(struct mds_net* net, struct mds* m, int t);
+void mds_pack_net(struct mds_net* net, struct mds* m);
+int mds_get_peers(struct mds_net* net, struct mds* m, int t, int** p);
+mds_id mds_get_peer_entities(struct mds_net* net, struct mds* m,
+    int t, int p, mds_id** e);
 
 void mds_add_copy(struct mds_net* net, struct mds* m, mds_id e,
     struct mds_copy c);
@@ -134,6 +134,356 @@ struct mds_tag* mds_number_verts_bfs(struct mds_apf* m)
   return tag;
 }
 
+/* space-filling curve keys are built from vertex coordinates
+   scaled to (bits) bits per axis within the bounding box,
+   using as many axes as the mesh has dimensions */
+
+struct curve_vert {
+  unsigned long long key;
+  mds_id v;
+};
+
+static void bounding_box(struct mds_apf* m, double lo[3], double hi[3])
+{
+  mds_id v;
+  double* p;
+  int i;
+  for (i = 0; i < 3; ++i) {
+    lo[i] = 0;
+    hi[i] = 0;
+  }
+  v = mds_begin(&m->mds, 0);
+  if (v == MDS_NONE)
+    return;
+  p = mds_apf_point(m, v);
+  for (i = 0; i < 3; ++i)
+    lo[i] = hi[i] = p[i];
+  for (; v != MDS_NONE; v = mds_next(&m->mds, v)) {
+    p = mds_apf_point(m, v);
+    for (i = 0; i < 3; ++i) {
+      if (p[i] < lo[i])
+        lo[i] = p[i];
+      if (p[i] > hi[i])
+        hi[i] = p[i];
+    }
+  }
+}
+
+/* Skilling's in-place conversion of axes to the
+   transposed Hilbert index, see
+   "Programming the Hilbert curve", AIP Conf. Proc. 707 (2004) */
+static void axes_to_transpose(unsigned* x, int bits, int n)
+{
+  unsigned m, p, q, t;
+  int i;
+  m = 1u << (bits - 1);
+  for (q = m; q > 1; q >>= 1) {
+    p = q - 1;
+    for (i = 0; i < n; ++i) {
+      if (x[i] & q)
+        x[0] ^= p;
+      else {
+        t = (x[0] ^ x[i]) & p;
+        x[0] ^= t;
+        x[i] ^= t;
+      }
+    }
+  }
+  for (i = 1; i < n; ++i)
+    x[i] ^= x[i - 1];
+  t = 0;
+  for (q = m; q > 1; q >>= 1)
+    if (x[n - 1] & q)
+      t ^= q - 1;
+  for (i = 0; i < n; ++i)
+    x[i] ^= t;
+}
+
+static unsigned long long interleave(unsigned* x, int bits, int n)
+{
+  unsigned long long key = 0;
+  int i, j;
+  for (j = bits - 1; j >= 0; --j)
+    for (i = 0; i < n; ++i)
+      key = (key << 1) | ((x[i] >> j) & 1);
+  return key;
+}
+
+static unsigned long long curve_key(double* p, double lo[3], double hi[3],
+    int bits, int n, int hilbert)
+{
+  unsigned x[3];
+  double scale;
+  double range;
+  int i;
+  scale = (double)((1u << bits) - 1);
+  for (i = 0; i < n; ++i) {
+    range = hi[i] - lo[i];
+    x[i] = range > 0 ? (unsigned)(((p[i] - lo[i]) / range) * scale) : 0;
+  }
+  if (hilbert && n > 1)
+    axes_to_transpose(x, bits, n);
+  return interleave(x, bits, n);
+}
+
+static int compare_curve_verts(const void* a, const void* b)
+{
+  const struct curve_vert* ca = a;
+  const struct curve_vert* cb = b;
+  if (ca->key != cb->key)
+    return ca->key < cb->key ? -1 : 1;
+  if (ca->v != cb->v)
+    return ca->v < cb->v ? -1 : 1;
+  return 0;
+}
+
+/* the vertices sorted along the curve, to be freed by the caller */
+static struct curve_vert* sort_verts_curve(struct mds_apf* m, int hilbert)
+{
+  struct curve_vert* cv;
+  double lo[3], hi[3];
+  int n, bits;
+  mds_id v;
+  mds_id i;
+  n = m->mds.d;
+  if (n < 1)
+    n = 1;
+  bits = 63 / n;
+  if (bits > 31)
+    bits = 31;
+  bounding_box(m, lo, hi);
+  cv = malloc(m->mds.n[MDS_VERTEX] * sizeof(*cv));
+  i = 0;
+  for (v = mds_begin(&m->mds, 0); v != MDS_NONE; v = mds_next(&m->mds, v)) {
+    cv[i].key = curve_key(mds_apf_point(m, v), lo, hi, bits, n, hilbert);
+    cv[i].v = v;
+    ++i;
+  }
+  qsort(cv, i, sizeof(*cv), compare_curve_verts);
+  return cv;
+}
+
+static struct mds_tag* number_verts_curve(struct mds_apf* m, int hilbert)
+{
+  struct mds_tag* tag;
+  struct curve_vert* cv;
+  int label;
+  mds_id i;
+  PCU_ALWAYS_ASSERT(m->mds.n[MDS_VERTEX] < INT_MAX);
+  cv = sort_verts_curve(m, hilbert);
+  tag = mds_create_tag(&m->tags, "mds_number", sizeof(int), 1);
+  label = 0;
+  for (i = 0; i < m->mds.n[MDS_VERTEX]; ++i)
+    visit(&m->mds, tag, &label, cv[i].v);
+  free(cv);
+  return tag;
+}
+
+struct mds_tag* mds_number_verts_hilbert(struct mds_apf* m)
+{
+  return number_verts_curve(m, 1);
+}
+
+struct mds_tag* mds_number_verts_morton(struct mds_apf* m)
+{
+  return number_verts_curve(m, 0);
+}
+
+/* Cuthill-McKee orderings work on the vertex graph through edges,
+   with per-vertex arrays indexed by mds_index */
+
+static int get_vert_neighbors(struct mds* m, mds_id v, mds_id* nv)
+{
+  struct mds_set es;
+  int i;
+  mds_get_adjacent(m, v, 1, &es);
+  for (i = 0; i < es.n; ++i)
+    nv[i] = other_vert(m, es.e[i], v);
+  return es.n;
+}
+
+static void sort_by_degree(mds_id* nv, int n, int* degree)
+{
+  int i, j;
+  mds_id t;
+  for (i = 1; i < n; ++i) {
+    t = nv[i];
+    for (j = i; j > 0 && degree[mds_index(nv[j - 1])] >
+                         degree[mds_index(t)]; --j)
+      nv[j] = nv[j - 1];
+    nv[j] = t;
+  }
+}
+
+/* writes to (q) the unleveled vertices reachable from (v) in
+   breadth-first order, setting their levels. With (degree) the
+   neighbors of each vertex are queued by increasing degree, the
+   Cuthill-McKee order. With (block) only neighbors of the same
+   block as (v) are followed. Returns the number reached. */
+static mds_id bfs_levels(struct mds* m, mds_id v, int* level,
+    int* degree, int* block, mds_id* q)
+{
+  mds_id nv[MDS_SET_MAX];
+  mds_id first, end;
+  int i, n, b;
+  first = end = 0;
+  b = block ? block[mds_index(v)] : 0;
+  level[mds_index(v)] = 0;
+  q[end++] = v;
+  while (first < end) {
+    v = q[first++];
+    n = get_vert_neighbors(m, v, nv);
+    if (degree)
+      sort_by_degree(nv, n, degree);
+    for (i = 0; i < n; ++i) {
+      if (level[mds_index(nv[i])] >= 0)
+        continue;
+      if (block && block[mds_index(nv[i])] != b)
+        continue;
+      level[mds_index(nv[i])] = level[mds_index(v)] + 1;
+      q[end++] = nv[i];
+    }
+  }
+  return end;
+}
+
+/* the George-Liu search for a pseudo-peripheral vertex: restart
+   from a least-degree vertex of the last level until the
+   eccentricity stops growing. Levels are left unset. */
+static mds_id find_peripheral(struct mds* m, mds_id v, int* level,
+    int* degree, int* block, mds_id* q)
+{
+  mds_id n, i, best;
+  int ecc, last, tries;
+  ecc = -1;
+  for (tries = 0; tries < 8; ++tries) {
+    n = bfs_levels(m, v, level, 0, block, q);
+    last = level[mds_index(q[n - 1])];
+    best = q[n - 1];
+    for (i = n - 1; i >= 0 && level[mds_index(q[i])] == last; --i)
+      if (degree[mds_index(q[i])] < degree[mds_index(best)])
+        best = q[i];
+    for (i = 0; i < n; ++i)
+      level[mds_index(q[i])] = -1;
+    if (last <= ecc)
+      break;
+    ecc = last;
+    v = best;
+  }
+  return v;
+}
+
+static int* make_vert_array(struct mds* m, int value)
+{
+  int* a;
+  mds_id i;
+  a = malloc(m->cap[MDS_VERTEX] * sizeof(int));
+  for (i = 0; i < m->cap[MDS_VERTEX]; ++i)
+    a[i] = value;
+  return a;
+}
+
+static int* get_degrees(struct mds* m)
+{
+  int* degree;
+  struct mds_set es;
+  mds_id v;
+  degree = make_vert_array(m, 0);
+  for (v = mds_begin(m, 0); v != MDS_NONE; v = mds_next(m, v)) {
+    mds_get_adjacent(m, v, 1, &es);
+    degree[mds_index(v)] = es.n;
+  }
+  return degree;
+}
+
+/* reverse Cuthill-McKee from (v) over its component, or over the
+   part of it in the same block, appended to (order) at (count) */
+static mds_id add_rcm_component(struct mds* m, mds_id v, int* level,
+    int* degree, int* block, mds_id* order, mds_id count)
+{
+  mds_id n, i, t;
+  mds_id* q;
+  q = order + count;
+  v = find_peripheral(m, v, level, degree, block, q);
+  n = bfs_levels(m, v, level, degree, block, q);
+  for (i = 0; i < n / 2; ++i) {
+    t = q[i];
+    q[i] = q[n - 1 - i];
+    q[n - 1 - i] = t;
+  }
+  return count + n;
+}
+
+static struct mds_tag* label_verts(struct mds_apf* m, mds_id* order)
+{
+  struct mds_tag* tag;
+  int label;
+  mds_id i;
+  tag = mds_create_tag(&m->tags, "mds_number", sizeof(int), 1);
+  label = 0;
+  for (i = 0; i < m->mds.n[MDS_VERTEX]; ++i)
+    visit(&m->mds, tag, &label, order[i]);
+  return tag;
+}
+
+struct mds_tag* mds_number_verts_rcm(struct mds_apf* m)
+{
+  struct mds_tag* tag;
+  int* level;
+  int* degree;
+  mds_id* order;
+  mds_id count;
+  mds_id v;
+  PCU_ALWAYS_ASSERT(m->mds.n[MDS_VERTEX] < INT_MAX);
+  level = make_vert_array(&m->mds, -1);
+  degree = get_degrees(&m->mds);
+  order = malloc(m->mds.n[MDS_VERTEX] * sizeof(mds_id));
+  count = 0;
+  for (v = mds_begin(&m->mds, 0); v != MDS_NONE; v = mds_next(&m->mds, v))
+    if (level[mds_index(v)] < 0)
+      count = add_rcm_component(&m->mds, v, level, degree, 0, order, count);
+  PCU_ALWAYS_ASSERT(count == m->mds.n[MDS_VERTEX]);
+  tag = label_verts(m, order);
+  free(order);
+  free(degree);
+  free(level);
+  return tag;
+}
+
+struct mds_tag* mds_number_verts_blocked(struct mds_apf* m, int block_size)
+{
+  struct mds_tag* tag;
+  struct curve_vert* cv;
+  int* level;
+  int* degree;
+  int* block;
+  mds_id* order;
+  mds_id count;
+  mds_id i;
+  PCU_ALWAYS_ASSERT(m->mds.n[MDS_VERTEX] < INT_MAX);
+  PCU_ALWAYS_ASSERT(block_size > 0);
+  cv = sort_verts_curve(m, 1);
+  block = make_vert_array(&m->mds, 0);
+  for (i = 0; i < m->mds.n[MDS_VERTEX]; ++i)
+    block[mds_index(cv[i].v)] = i / block_size;
+  level = make_vert_array(&m->mds, -1);
+  degree = get_degrees(&m->mds);
+  order = malloc(m->mds.n[MDS_VERTEX] * sizeof(mds_id));
+  count = 0;
+  for (i = 0; i < m->mds.n[MDS_VERTEX]; ++i)
+    if (level[mds_index(cv[i].v)] < 0)
+      count = add_rcm_component(&m->mds, cv[i].v, level, degree, block,
+          order, count);
+  PCU_ALWAYS_ASSERT(count == m->mds.n[MDS_VERTEX]);
+  tag = label_verts(m, order);
+  free(order);
+  free(degree);
+  free(level);
+  free(block);
+  free(cv);
+  return tag;
+}
+
 static mds_id* sort_verts(struct mds_apf* m, struct mds_tag* tag)
 {
   mds_id v;
@@ -410,6 +760,7 @@ struct mds_apf* mds_reorder(struct mds_apf* m, int ignore_peers,
 {
   struct mds_tag* tag;
   struct mds_apf* m2;
+  mds_load_tags(m);
   tag = vert_numbers;
   number_other_ents(m, tag);
   m2 = rebuild(m, tag, ignore_peers);
@@ -235,6 +235,7 @@ static void read_class(struct pcu_file* f, struct mds_apf* m)
   size_t size;
   int type_mds;
   unsigned* class;
+  struct gmi_ent* model;
   int i,j;
   for (i = 0; i < SMB_TYPES; ++i) {
     type_mds = smb2mds(i);
@@ -242,10 +243,17 @@ static void read_class(struct pcu_file* f, struct mds_apf* m)
     size = 2 * cap;
     class = malloc(size * sizeof(*class));
     pcu_read_unsigneds(f, class, size);
+    /* neighboring entities are mostly classified alike,
+       so the model is only looked up when the pair changes */
+    model = NULL;
     for (j = 0; j < cap; ++j) {
-      m->model[type_mds][j] =
-        mds_find_model(m, class[2 * j + 1], class[2 * j]);
-      PCU_ALWAYS_ASSERT(m->model[type_mds][j]);
+      if (!model ||
+          class[2 * j] != class[2 * j - 2] ||
+          class[2 * j + 1] != class[2 * j - 1]) {
+        model = mds_find_model(m, class[2 * j + 1], class[2 * j]);
+        PCU_ALWAYS_ASSERT(model);
+      }
+      m->model[type_mds][j] = model;
     }
     free(class);
   }
@@ -443,11 +451,46 @@ static void write_dbl_tag(struct pcu_file* f, struct mds_apf* m,
   free(ids);
 }
 
-static void read_tags(struct pcu_file* f, struct mds_apf* m)
+static void read_tag(struct pcu_file* f, struct mds_apf* m,
+    struct mds_tag* tag, unsigned count, int t)
+{
+  if (tag->user_type == mds_apf_int)
+    read_int_tag(f, m, tag, count, t);
+  else
+    read_dbl_tag(f, m, tag, count, t);
+}
+
+/* with lazy tags, the data of each tag and type is skipped
+   over while reading and its place in the file is kept so the
+   tag can be read the first time it is used.
+   The file stays open until every tag is read or forgotten.
+   The sizes that precede the data of each type give its length,
+   so this needs nothing from the file format that
+   version 5 did not already have. */
+
+struct mds_lazy_tag {
+  struct mds_tag* tag;
+  unsigned count[SMB_TYPES];
+  long offset[SMB_TYPES];
+};
+
+struct mds_lazy {
+  struct pcu_file* file;
+  unsigned n;
+  struct mds_lazy_tag* tags;
+};
+
+static long tag_data_bytes(struct mds_tag* tag, unsigned count)
+{
+  return (long)count * (sizeof(unsigned) + tag->bytes);
+}
+
+static void read_tags(struct pcu_file* f, struct mds_apf* m, int lazy)
 {
   unsigned n;
   unsigned* sizes;
   struct mds_tag** tags;
+  struct mds_lazy* l = NULL;
   unsigned i,j;
   int type_mds;
   PCU_READ_UNSIGNED(f,n);
@@ -456,21 +499,90 @@ static void read_tags(struct pcu_file* f, struct mds_apf* m)
   sizes = malloc(n * sizeof(*sizes));
   for (i = 0; i < n; ++i)
     tags[i] = read_tag_header(f, m);
+  if (lazy && n) {
+    l = malloc(sizeof(*l));
+    l->file = f;
+    l->n = n;
+    l->tags = malloc(n * sizeof(*(l->tags)));
+    for (j = 0; j < n; ++j)
+      l->tags[j].tag = tags[j];
+  }
   for (i = 0; i < SMB_TYPES; ++i) {
     pcu_read_unsigneds(f, sizes, n);
     type_mds = smb2mds(i);
     for (j = 0; j < n; ++j) {
       if (sizeof(mds_id) == 4) PCU_ALWAYS_ASSERT(sizes[j] < MAX_ENTITIES);
-      if (tags[j]->user_type == mds_apf_int)
-        read_int_tag(f, m, tags[j], sizes[j], type_mds);
-      else
-        read_dbl_tag(f, m, tags[j], sizes[j], type_mds);
+      if (l) {
+        l->tags[j].count[i] = sizes[j];
+        l->tags[j].offset[i] = pcu_ftell(f);
+        pcu_fseek(f, l->tags[j].offset[i] +
+            tag_data_bytes(tags[j], sizes[j]));
+      } else
+        read_tag(f, m, tags[j], sizes[j], type_mds);
     }
   }
+  m->lazy = l;
   free(tags);
   free(sizes);
 }
 
+static struct mds_lazy_tag* find_lazy(struct mds_apf* m, struct mds_tag* t)
+{
+  unsigned i;
+  if (!m->lazy)
+    return NULL;
+  for (i = 0; i < m->lazy->n; ++i)
+    if (m->lazy->tags[i].tag == t)
+      return m->lazy->tags + i;
+  return NULL;
+}
+
+static void drop_lazy(struct mds_apf* m, struct mds_lazy_tag* lt)
+{
+  struct mds_lazy* l = m->lazy;
+  *lt = l->tags[--(l->n)];
+  if (l->n)
+    return;
+  pcu_fclose(l->file);
+  free(l->tags);
+  free(l);
+  m->lazy = NULL;
+}
+
+void mds_load_tag(struct mds_apf* m, struct mds_tag* t)
+{
+  struct mds_lazy_tag* lt;
+  int i;
+  lt = find_lazy(m, t);
+  if (!lt)
+    return;
+  for (i = 0; i < SMB_TYPES; ++i) {
+    pcu_fseek(m->lazy->file, lt->offset[i]);
+    read_tag(m->lazy->file, m, t, lt->count[i], smb2mds(i));
+  }
+  drop_lazy(m, lt);
+}
+
+void mds_load_tags(struct mds_apf* m)
+{
+  while (m->lazy)
+    mds_load_tag(m, m->lazy->tags[0].tag);
+}
+
+void mds_forget_tag(struct mds_apf* m, struct mds_tag* t)
+{
+  struct mds_lazy_tag* lt;
+  lt = find_lazy(m, t);
+  if (lt)
+    drop_lazy(m, lt);
+}
+
+void mds_forget_tags(struct mds_apf* m)
+{
+  while (m->lazy)
+    drop_lazy(m, m->lazy->tags);
+}
+
 static void write_tags(struct pcu_file* f, struct mds_apf* m)
 {
   unsigned n;
@@ -556,11 +668,11 @@ static void write_matches(struct pcu_file* f, struct mds_apf* m,
     write_type_matches(f, m, smb2mds(t), ignore_peers);
 }
 
-static struct mds_apf* read_smb(struct gmi_model* model, const char* filename,
-    int zip, int ignore_peers, void* apf_mesh)
+/* reads one part from (f), which stays open for lazy tags */
+struct mds_apf* mds_read_smb_file(struct pcu_file* f,
+    struct gmi_model* model, int ignore_peers, void* apf_mesh, int lazy_tags)
 {
   struct mds_apf* m;
-  struct pcu_file* f;
   unsigned version;
   unsigned dim;
   unsigned n[SMB_TYPES];
@@ -568,8 +680,6 @@ static struct mds_apf* read_smb(struct gmi_model* model, const char* filename,
   int i;
   unsigned tmp;
   unsigned pi, pj;
-  f = pcu_fopen(filename, 0, zip);
-  PCU_ALWAYS_ASSERT(f);
   read_header(f, &version, &dim, ignore_peers);
   pcu_read_unsigneds(f, n, SMB_TYPES);
   for (i = 0; i < MDS_TYPES; ++i) {
@@ -591,17 +701,28 @@ static struct mds_apf* read_smb(struct gmi_model* model, const char* filename,
   }
   read_remotes(f, m, ignore_peers);
   read_class(f, m);
-  read_tags(f, m);
+  read_tags(f, m, lazy_tags);
   if (version >= 4)
     read_matches_new(f, m, ignore_peers);
   else if (version >= 3)
     read_matches_old(f, m, ignore_peers);
   if (version >= 5)
     mds_read_smb_meta(f, m, apf_mesh);
-  pcu_fclose(f);
+  if (!m->lazy)
+    pcu_fclose(f);
   return m;
 }
 
+static struct mds_apf* read_smb(struct gmi_model* model, const char* filename,
+    int zip, int ignore_peers, void* apf_mesh, int lazy_tags)
+{
+  struct pcu_file* f;
+  f = pcu_fopen_kind(filename, 0, zip, PCU_IO_SMB);
+  PCU_ALWAYS_ASSERT(f);
+  return mds_read_smb_file(f, model, ignore_peers, apf_mesh,
+      lazy_tags && !zip);
+}
+
 static void write_coords(struct pcu_file* f, struct mds_apf* m)
 {
   size_t count;
@@ -611,14 +732,11 @@ static void write_coords(struct pcu_file* f, struct mds_apf* m)
   pcu_write_doubles(f, &m->param[0][0], count);
 }
 
-static void write_smb(struct mds_apf* m, const char* filename,
-    int zip, int ignore_peers, void* apf_mesh)
+void mds_write_smb_file(struct pcu_file* f, struct mds_apf* m,
+    int ignore_peers, void* apf_mesh)
 {
-  struct pcu_file* f;
   unsigned n[SMB_TYPES] = {0};
   int i;
-  f = pcu_fopen(filename, 1, zip);
-  PCU_ALWAYS_ASSERT(f);
   write_header(f, m->mds.d, ignore_peers);
   for (i = 0; i < MDS_TYPES; ++i)
     n[mds2smb(i)] = m->mds.end[i];
@@ -630,6 +748,15 @@ static void write_smb(struct mds_apf* m, const char* filename,
   write_tags(f, m);
   write_matches(f, m, ignore_peers);
   mds_write_smb_meta(f, apf_mesh);
+}
+
+static void write_smb(struct mds_apf* m, const char* filename,
+    int zip, int ignore_peers, void* apf_mesh)
+{
+  struct pcu_file* f;
+  f = pcu_fopen_kind(filename, 1, zip, PCU_IO_SMB);
+  PCU_ALWAYS_ASSERT(f);
+  mds_write_smb_file(f, m, ignore_peers, apf_mesh);
   pcu_fclose(f);
 }
 
@@ -676,6 +803,8 @@ static void append(char* s, size_t size, const char* format, ...)
 
 #define SMB_FANOUT 2048
 
+static const char* aggpre = "agg:";
+
 static void safe_mkdir(const char* path, mode_t mode)
 {
   int err;
@@ -685,57 +814,72 @@ static void safe_mkdir(const char* path, mode_t mode)
     reel_fail("MDS: could not create directory \"%s\"\n", path);
 }
 
+void mds_smb_base_path(char* path, int is_write)
+{
+  static const char* smbext = ".smb";
+  mode_t const dir_perm = S_IRWXU|S_IRGRP|S_IXGRP|S_IROTH|S_IXOTH;
+  if (ends_with(path, "/")) {
+    if (is_write) {
+      if (!PCU_Comm_Self())
+        safe_mkdir(path, dir_perm);
+      PCU_Barrier();
+    }
+  } else if (ends_with(path, smbext)) {
+    remove_ext(path, smbext);
+  } else {
+    reel_fail("MDS: invalid smb path \"%s\"\n", path);
+  }
+}
+
 static char* handle_path(const char* in, int is_write, int* zip,
     int ignore_peers)
 {
   static const char* zippre = "bz2:";
-  static const char* smbext = ".smb";
+  static const char* gzpre = "gz:";
   size_t bufsize;
   char* path;
   mode_t const dir_perm = S_IRWXU|S_IRGRP|S_IXGRP|S_IROTH|S_IXOTH;
   int self = PCU_Comm_Self();
+  int is_dir;
   bufsize = strlen(in) + 256;
   path = malloc(bufsize);
   strcpy(path, in);
   if (starts_with(path, zippre)) {
-    *zip = 1;
+    *zip = PCU_BZIP2;
     remove_prefix(path, zippre);
+  } else if (starts_with(path, gzpre)) {
+    *zip = PCU_GZIP;
+    remove_prefix(path, gzpre);
   } else {
-    *zip = 0;
+    *zip = PCU_PLAIN;
   }
   if (ignore_peers)
     return path;
-  if (ends_with(path, "/")) {
+  is_dir = ends_with(path, "/");
+  mds_smb_base_path(path, is_write);
+  if (is_dir && PCU_Comm_Peers() > SMB_FANOUT) {
+    append(path, bufsize, "%d/", self / SMB_FANOUT);
     if (is_write) {
-      if (!self)
+      if (self % SMB_FANOUT == 0)
         safe_mkdir(path, dir_perm);
       PCU_Barrier();
     }
-    if (PCU_Comm_Peers() > SMB_FANOUT) {
-      append(path, bufsize, "%d/", self / SMB_FANOUT);
-      if (is_write) {
-        if (self % SMB_FANOUT == 0)
-          safe_mkdir(path, dir_perm);
-        PCU_Barrier();
-      }
-    }
-  } else if (ends_with(path, smbext)) {
-    remove_ext(path, smbext);
-  } else {
-    reel_fail("MDS: invalid smb path \"%s\"\n", path);
   }
   append(path, bufsize, "%d.smb", self);
   return path;
 }
 
 struct mds_apf* mds_read_smb(struct gmi_model* model, const char* pathname,
-    int ignore_peers, void* apf_mesh)
+    int ignore_peers, void* apf_mesh, int lazy_tags)
 {
   char* filename;
   int zip;
   struct mds_apf* m;
+  if (!ignore_peers && starts_with(pathname, aggpre))
+    return mds_read_agg(model, pathname + strlen(aggpre), apf_mesh,
+        lazy_tags);
   filename = handle_path(pathname, 0, &zip, ignore_peers);
-  m = read_smb(model, filename, zip, ignore_peers, apf_mesh);
+  m = read_smb(model, filename, zip, ignore_peers, apf_mesh, lazy_tags);
   free(filename);
   return m;
 }
@@ -749,19 +893,29 @@ static int is_compact(struct mds_apf* m)
   return 1;
 }
 
+static void compact_for_write(struct mds_apf* m, int ignore_peers)
+{
+  const char* compactWarning ="MDS: compacting before writing smb files\n";
+  mds_load_tags(m);
+  if (ignore_peers && (!is_compact(m))) {
+    if(!PCU_Comm_Self()) fprintf(stderr, "%s", compactWarning);
+    mds_apf_compact(m, 1);
+  }
+  if ((!ignore_peers) && PCU_Or(!is_compact(m))) {
+    if(!PCU_Comm_Self()) fprintf(stderr, "%s", compactWarning);
+    mds_apf_compact(m, 0);
+  }
+}
+
 struct mds_apf* mds_write_smb(struct mds_apf* m, const char* pathname,
     int ignore_peers, void* apf_mesh)
 {
-  const char* reorderWarning ="MDS: reordering before writing smb files\n";
   char* filename;
   int zip;
-  if (ignore_peers && (!is_compact(m))) {
-    if(!PCU_Comm_Self()) fprintf(stderr, "%s", reorderWarning);
-    m = mds_reorder(m, 1, mds_number_verts_bfs(m));
-  }
-  if ((!ignore_peers) && PCU_Or(!is_compact(m))) {
-    if(!PCU_Comm_Self()) fprintf(stderr, "%s", reorderWarning);
-    m = mds_reorder(m, 0, mds_number_verts_bfs(m));
+  compact_for_write(m, ignore_peers);
+  if (!ignore_peers && starts_with(pathname, aggpre)) {
+    mds_write_agg(m, pathname + strlen(aggpre), apf_mesh);
+    return m;
   }
   filename = handle_path(pathname, 1, &zip, ignore_peers);
   write_smb(m, filename, zip, ignore_peers, apf_mesh);
@@ -769,3 +923,24 @@ struct mds_apf* mds_write_smb(struct mds_apf* m, const char* pathname,
   return m;
 }
 
+struct mds_apf* mds_snapshot_smb(struct mds_apf* m, const char* pathname,
+    int ignore_peers, void* apf_mesh, struct pcu_file** file,
+    char** data, size_t* size)
+{
+  char* filename;
+  int zip;
+  struct pcu_file* mem;
+  if (!ignore_peers && starts_with(pathname, aggpre)) {
+    *file = NULL;
+    return mds_write_smb(m, pathname, ignore_peers, apf_mesh);
+  }
+  compact_for_write(m, ignore_peers);
+  filename = handle_path(pathname, 1, &zip, ignore_peers);
+  *file = pcu_fopen_kind(filename, 1, zip, PCU_IO_SMB);
+  free(filename);
+  mem = pcu_fopen_memstream();
+  mds_write_smb_file(mem, m, ignore_peers, apf_mesh);
+  pcu_fclose_memstream(mem, data, size);
+  return m;
+}
+
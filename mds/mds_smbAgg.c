@@ -0,0 +1,222 @@
+/****************************************************************************** 
+
+  Copyright 2014 Scientific Computation Research Center, 
+      Rensselaer Polytechnic Institute. All rights reserved.
+  
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+
+#include "mds_apf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <PCU.h>
+#include <pcu_io.h>
+#include <reel.h>
+
+/* aggregated smb files: with an "agg:" path, groups of parts share
+   one file each.  A file holds a header, an index with one entry per
+   part, then the parts' sections in order.  Each section is a whole
+   smb stream, optionally deflated, so the usual reader decodes it
+   from memory.  All numbers are big-endian like the rest of smb. */
+
+enum { SMBA_VERSION = 1 };
+
+enum {
+  SMBA_RAW,
+  SMBA_ZLIB
+};
+
+/* magic, version, parts, files, first part, parts in this file */
+#define SMBA_HEADER_BYTES 24
+/* offset, stored bytes, decoded bytes, codec, unused */
+#define SMBA_ENTRY_BYTES 32
+
+static int smb_parts_per_file = 64;
+
+void mds_set_smb_parts_per_file(int n)
+{
+  smb_parts_per_file = n < 1 ? 1 : n;
+}
+
+static void put_be(unsigned char* p, unsigned long long v, int bytes)
+{
+  int i;
+  for (i = bytes - 1; i >= 0; --i) {
+    p[i] = v & 0xFF;
+    v >>= 8;
+  }
+}
+
+static unsigned long long get_be(unsigned char const* p, int bytes)
+{
+  unsigned long long v = 0;
+  int i;
+  for (i = 0; i < bytes; ++i)
+    v = (v << 8) | p[i];
+  return v;
+}
+
+static char* agg_path(const char* in, int file, int is_write)
+{
+  size_t bufsize;
+  char* path;
+  bufsize = strlen(in) + 64;
+  path = malloc(bufsize);
+  strcpy(path, in);
+  mds_smb_base_path(path, is_write);
+  snprintf(path + strlen(path), bufsize - strlen(path), "%d.smba", file);
+  return path;
+}
+
+void mds_write_agg(struct mds_apf* m, const char* pathname,
+    void* apf_mesh)
+{
+  struct pcu_file* f;
+  char* raw;
+  size_t raw_size;
+  char* data;
+  unsigned long long stored;
+  unsigned long long offset = 0;
+  int codec;
+  int self = PCU_Comm_Self();
+  int peers = PCU_Comm_Peers();
+  int per = smb_parts_per_file;
+  int files = (peers + per - 1) / per;
+  int file = self / per;
+  int first = file * per;
+  int count = peers - first < per ? peers - first : per;
+  int rank;
+  MPI_Comm comm;
+  MPI_File fh;
+  unsigned char entry[SMBA_ENTRY_BYTES] = {0};
+  unsigned char* head = NULL;
+  unsigned long long head_size = 0;
+  char* filename;
+  double start;
+  f = pcu_fopen_memstream();
+  mds_write_smb_file(f, m, 0, apf_mesh);
+  pcu_fclose_memstream(f, &raw, &raw_size);
+  if (pcu_can_deflate()) {
+    codec = SMBA_ZLIB;
+    stored = pcu_deflate(raw, raw_size, &data);
+    free(raw);
+  } else {
+    codec = SMBA_RAW;
+    stored = raw_size;
+    data = raw;
+  }
+  MPI_Comm_split(PCU_Get_Comm(), file, self, &comm);
+  MPI_Comm_rank(comm, &rank);
+  MPI_Exscan(&stored, &offset, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+  if (!rank)
+    offset = 0;
+  offset += SMBA_HEADER_BYTES + (unsigned long long)count * SMBA_ENTRY_BYTES;
+  put_be(entry, offset, 8);
+  put_be(entry + 8, stored, 8);
+  put_be(entry + 16, raw_size, 8);
+  put_be(entry + 24, codec, 4);
+  if (!rank) {
+    head_size = SMBA_HEADER_BYTES + (unsigned long long)count *
+      SMBA_ENTRY_BYTES;
+    head = malloc(head_size);
+    memcpy(head, "SMBA", 4);
+    put_be(head + 4, SMBA_VERSION, 4);
+    put_be(head + 8, peers, 4);
+    put_be(head + 12, files, 4);
+    put_be(head + 16, first, 4);
+    put_be(head + 20, count, 4);
+  }
+  MPI_Gather(entry, SMBA_ENTRY_BYTES, MPI_BYTE,
+      head ? head + SMBA_HEADER_BYTES : NULL, SMBA_ENTRY_BYTES, MPI_BYTE,
+      0, comm);
+  filename = agg_path(pathname, file, 1);
+  start = pcu_io_time();
+  if (MPI_File_open(comm, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+        MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+    reel_fail("MDS: could not open \"%s\" for writing\n", filename);
+  MPI_File_set_size(fh, 0);
+  pcu_io_opened(PCU_IO_SMB, start);
+  pcu_io_transfer_all(fh, comm, 0, (char*)head, head_size, true, PCU_IO_SMB);
+  pcu_io_transfer_all(fh, comm, offset, data, stored, true, PCU_IO_SMB);
+  start = pcu_io_time();
+  MPI_File_close(&fh);
+  pcu_io_closed(PCU_IO_SMB, start);
+  MPI_Comm_free(&comm);
+  free(filename);
+  free(head);
+  free(data);
+}
+
+struct mds_apf* mds_read_agg(struct gmi_model* model,
+    const char* pathname, void* apf_mesh, int lazy_tags)
+{
+  unsigned char head[SMBA_HEADER_BYTES];
+  unsigned char entry[SMBA_ENTRY_BYTES];
+  unsigned info[2];
+  unsigned long long offset, stored, raw_size;
+  int codec;
+  char* data;
+  char* raw;
+  char* filename;
+  FILE* file0;
+  int self = PCU_Comm_Self();
+  int per;
+  int rank;
+  MPI_Comm comm;
+  MPI_File fh;
+  double start;
+  if (!self) {
+    filename = agg_path(pathname, 0, 0);
+    file0 = fopen(filename, "rb");
+    if (!file0 || fread(head, 1, SMBA_HEADER_BYTES, file0) !=
+        SMBA_HEADER_BYTES || memcmp(head, "SMBA", 4))
+      reel_fail("MDS: \"%s\" is not an aggregated smb file\n", filename);
+    fclose(file0);
+    free(filename);
+    if (get_be(head + 4, 4) > SMBA_VERSION)
+      reel_fail("MDS: aggregated smb version %u is newer than %d\n",
+          (unsigned)get_be(head + 4, 4), SMBA_VERSION);
+    info[0] = get_be(head + 8, 4);
+    info[1] = get_be(head + 20, 4);
+  }
+  MPI_Bcast(info, 2, MPI_UNSIGNED, 0, PCU_Get_Comm());
+  if (info[0] != (unsigned)PCU_Comm_Peers())
+    reel_fail("MDS: aggregated smb has %u parts, running on %d\n",
+        info[0], PCU_Comm_Peers());
+  per = info[1];
+  MPI_Comm_split(PCU_Get_Comm(), self / per, self, &comm);
+  MPI_Comm_rank(comm, &rank);
+  filename = agg_path(pathname, self / per, 0);
+  start = pcu_io_time();
+  if (MPI_File_open(comm, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh)
+      != MPI_SUCCESS)
+    reel_fail("MDS: could not open \"%s\"\n", filename);
+  pcu_io_opened(PCU_IO_SMB, start);
+  pcu_io_transfer_all(fh, comm, SMBA_HEADER_BYTES + rank * SMBA_ENTRY_BYTES,
+      (char*)entry, SMBA_ENTRY_BYTES, false, PCU_IO_SMB);
+  offset = get_be(entry, 8);
+  stored = get_be(entry + 8, 8);
+  raw_size = get_be(entry + 16, 8);
+  codec = get_be(entry + 24, 4);
+  data = malloc(stored ? stored : 1);
+  pcu_io_transfer_all(fh, comm, offset, data, stored, false, PCU_IO_SMB);
+  start = pcu_io_time();
+  MPI_File_close(&fh);
+  pcu_io_closed(PCU_IO_SMB, start);
+  MPI_Comm_free(&comm);
+  free(filename);
+  if (codec == SMBA_ZLIB) {
+    raw = malloc(raw_size ? raw_size : 1);
+    pcu_inflate(data, stored, raw, raw_size);
+    free(data);
+  } else if (codec == SMBA_RAW) {
+    raw = data;
+  } else {
+    reel_fail("MDS: unknown aggregated smb codec %d\n", codec);
+  }
+  return mds_read_smb_file(pcu_fopen_memory(raw, raw_size), model, 0,
+      apf_mesh, lazy_tags);
+}
@@ -11,6 +11,7 @@
 #include "mds_tag.h"
 #include <stdlib.h>
 #include <string.h>
+#include <PCU.h>
 
 void mds_create_tags(struct mds_tags* ts)
 {
@@ -36,10 +37,10 @@ static void grow_tag(
       continue;
     has[0] = (old_cap[t] / 8) + 1;
     has[1] = (m->cap[t] / 8) + 1;
-    tag->has[t] = realloc(tag->has[t], has[1]);
+    tag->has[t] = PCU_Mem_Realloc(tag->category, tag->has[t], has[1]);
     for (i = has[0]; i < has[1]; ++i)
       tag->has[t][i] = 0;
-    tag->data[t] = realloc(tag->data[t],
+    tag->data[t] = PCU_Mem_Realloc(tag->category, tag->data[t],
         tag->bytes * m->cap[t]);
   }
 }
@@ -67,6 +68,7 @@ struct mds_tag* mds_create_tag(
   ts->first = t;
   t->bytes = bytes;
   t->user_type = user_type;
+  t->category = PCU_MEM_MDS_TAGS;
   l = strlen(name);
   t->name = malloc(l + 1);
   strcpy(t->name,name);
@@ -80,9 +82,9 @@ void mds_destroy_tag(struct mds_tags* ts, struct mds_tag* t)
   for (p = &(ts->first); *p != t; p = &((*p)->next));
   *p = (*p)->next;
   for (i = 0; i < MDS_TYPES; ++i)
-    free(t->data[i]);
+    PCU_Mem_Free(t->data[i]);
   for (i = 0; i < MDS_TYPES; ++i)
-    free(t->has[i]);
+    PCU_Mem_Free(t->has[i]);
   free(t->name);
   free(t);
 }
@@ -127,8 +129,8 @@ void mds_give_tag(struct mds_tag* tag, struct mds* m, mds_id e)
   unsigned char* has;
   t = mds_type(e);
   if ( ! tag->has[t]) {
-    tag->has[t] = calloc((m->cap[t] / 8) + 1, 1);
-    tag->data[t] = malloc(tag->bytes * m->cap[t]);
+    tag->has[t] = PCU_Mem_Calloc(tag->category, (m->cap[t] / 8) + 1, 1);
+    tag->data[t] = PCU_Mem_Alloc(tag->category, tag->bytes * m->cap[t]);
   }
   i = mds_index(e);
   c = i / 8;
@@ -154,6 +156,45 @@ void mds_take_tag(struct mds_tag* tag, mds_id e)
   *has &= ~(1 << b);
 }
 
+void mds_compact_tags(
+    struct mds_tags* ts,
+    struct mds* m,
+    mds_id* new_index[MDS_TYPES])
+{
+  struct mds_tag* tag;
+  int t;
+  mds_id i;
+  mds_id e;
+  mds_id ne;
+  for (tag = ts->first; tag; tag = tag->next)
+    for (t = 0; t < MDS_TYPES; ++t) {
+      if ( ! tag->has[t])
+        continue;
+      for (i = 0; i < m->end[t]; ++i) {
+        if ((m->free[t][i] != MDS_LIVE) || (new_index[t][i] == i))
+          continue;
+        e = mds_identify(t, i);
+        ne = mds_identify(t, new_index[t][i]);
+        if (mds_has_tag(tag, e)) {
+          memcpy(mds_get_tag(tag, ne), mds_get_tag(tag, e), tag->bytes);
+          mds_give_tag(tag, m, ne);
+          mds_take_tag(tag, e);
+        } else
+          mds_take_tag(tag, ne);
+      }
+    }
+}
+
+size_t mds_tag_bytes(struct mds_tags* ts, struct mds* m, int t)
+{
+  struct mds_tag* tag;
+  size_t n = 0;
+  for (tag = ts->first; tag; tag = tag->next)
+    if (tag->has[t])
+      n += (size_t)tag->bytes * m->cap[t] + (m->cap[t] / 8) + 1;
+  return n;
+}
+
 void mds_rename_tag(struct mds_tag* tag, const char* newName)
 {
   int l;
@@ -198,3 +239,13 @@ void mds_swap_tag_structs(struct mds_tags* as, struct mds_tag** a,
   *a = *b;
   *b = tmp_p;
 }
+
+void mds_charge_tag(struct mds_tag* tag, int category)
+{
+  int t;
+  tag->category = category;
+  for (t = 0; t < MDS_TYPES; ++t) {
+    PCU_Mem_Charge(tag->data[t], category);
+    PCU_Mem_Charge(tag->has[t], category);
+  }
+}
@@ -17,6 +17,8 @@ struct mds_tag {
   struct mds_tag* next;
   int bytes;
   int user_type;
+  /* the PCU_MEM_ category the data is counted in */
+  int category;
   char* data[MDS_TYPES];
   unsigned char* has[MDS_TYPES];
   char* name;
@@ -32,6 +34,10 @@ void mds_grow_tags(
     struct mds_tags* ts,
     struct mds* m,
     mds_id old_cap[MDS_TYPES]);
+void mds_compact_tags(
+    struct mds_tags* ts,
+    struct mds* m,
+    mds_id* new_index[MDS_TYPES]);
 struct mds_tag* mds_create_tag(
     struct mds_tags* ts,
     const char* name,
@@ -43,7 +49,11 @@ struct mds_tag* mds_find_tag(struct mds_tags* ts, const char* name);
 int mds_has_tag(struct mds_tag* tag, mds_id e);
 void mds_give_tag(struct mds_tag* tag, struct mds* m, mds_id e);
 void mds_take_tag(struct mds_tag* tag, mds_id e);
+size_t mds_tag_bytes(struct mds_tags* ts, struct mds* m, int t);
 void mds_rename_tag(struct mds_tag* tag, const char* newName);
+/* moves the data of the tag, present and future,
+   to a PCU_MEM_ category */
+void mds_charge_tag(struct mds_tag* tag, int category);
 
 void mds_swap_tag_structs(struct mds_tags* as, struct mds_tag** a,
     struct mds_tags* bs, struct mds_tag** b);
@@ -10,17 +10,23 @@ include_directories(${CMAKE_CURRENT_BINARY_DIR})
 #Sources & Headers
 set(MDS_SOURCES
   mds.c
+  mds_compact.c
+  mds_freeze.c
   mds_apf.c
   mds_net.c
   mds_order.c
   mds_smb.c
+  mds_smbAgg.c
   mds_tag.c
   apfMDS.cc
+  apfMDSSplit.cc
+  apfMDSWatch.cc
   apfPM.cc
   apfBox.cc
   mdsANSYS.cc
   mdsGmsh.cc
-  mdsUgrid.cc)
+  mdsUgrid.cc
+  mdsSubset.cc)
 
 set(MDS_HEADERS
   apfMDS.h
@@ -112,9 +112,10 @@ class AD
     template<class B>
     AD<T, N>& operator*=(AD<B, N> const& other)
     {
-      x_ *= other.x_;
       for (unsigned int i=0; i < N; ++i)
-        dx_[i] = dx_[i]*other + x_*other.dx_[i];
+        dx_[i] = dx_[i]*other.x_ + x_*other.dx_[i];
+      x_ *= other.x_;
+      return *this;
     }
     /** \brief division assignment with a double */
     AD<T, N>& operator/=(double other)
@@ -128,9 +129,11 @@ class AD
     template<class B>
     AD<T, N>& operator/=(AD<B, N> const& other)
     {
-      x_ /= other.x_;
+      double inv = 1. / other.x_;
       for (unsigned int i=0; i < N; ++i)
-        dx_[i] = (dx_[i]*other - other*other.dx_[i]) / (other*other);
+        dx_[i] = (dx_[i]*other.x_ - x_*other.dx_[i]) * inv * inv;
+      x_ *= inv;
+      return *this;
     }
   private:
     void zero()
@@ -255,9 +258,9 @@ class AD<T,0>
     AD<T, 0>& operator*=(AD<T, 0> const& other)
     {
       resize(other.size());
-      x_ *= other.x_;
       for (unsigned int i=0; i < size(); ++i)
         dx_[i] = dx_[i]*other.x_ + x_*other.dx_[i];
+      x_ *= other.x_;
       return *this;
     }
     /** \brief division assignment with a double */
@@ -272,9 +275,10 @@ class AD<T,0>
     AD<T, 0>& operator/=(AD<T, 0> const& other)
     {
       resize(other.size());
-      x_ /= other.x_;
+      double inv = 1. / other.x_;
       for (unsigned int i=0; i < size(); ++i)
-        dx_[i] = (dx_[i]*other.x_ - x_*other.dx_[i]) / (other.x_*other.x_);
+        dx_[i] = (dx_[i]*other.x_ - x_*other.dx_[i]) * inv * inv;
+      x_ *= inv;
       return *this;
     }
     void resize(unsigned int n)
@@ -423,8 +427,10 @@ AD<T, N> operator*(AD<T, N> const& L, AD<B, N> const& R)
   AD<T, N> tmp;
   unsigned int max = L.size() > R.size() ? L.size() : R.size();
   tmp.resize(max);
+  T l = L;
+  T r = R;
   for (unsigned int i=0; i < tmp.size(); ++i)
-    tmp.dx(i) = T(L.dx(i) * R + L * R.dx(i));
+    tmp.dx(i) = T(L.dx(i) * r + l * R.dx(i));
   tmp.val() = L.val() * R.val();
   return tmp;
 }
@@ -436,8 +442,9 @@ AD<T, N> operator/(double L, AD<T, N> const& R)
   AD<T, N> tmp;
   tmp.resize(R.size());
   T R_tmp = R; //Recursive R, used to prevent infinite recurrsion.
+  T d = -L * (1. / R_tmp) * (1. / R_tmp);
   for (unsigned int i = 0; i < R.size(); i++)
-    tmp.dx(i) = T(-L * R.dx(i) * (1. / R_tmp) * (1. / R_tmp));
+    tmp.dx(i) = T(R.dx(i) * d);
   tmp.val() = L / R.val();
   return tmp;
 }
@@ -461,8 +468,11 @@ AD<T, N> operator/(AD<B, N> const& L, AD<T, N> const& R)
   AD<T, N> tmp;
   unsigned int max = L.size() > R.size() ? L.size() : R.size();
   tmp.resize(max);
+  T l = L;
+  T r = R;
+  T inv2 = (1. / r) * (1. / r);
   for (unsigned int i=0; i < tmp.size(); ++i)
-    tmp.dx(i) = T(((L.dx(i) * R) - (L * R.dx(i))) * (1. / R) * (1. / R));
+    tmp.dx(i) = T(((L.dx(i) * r) - (l * R.dx(i))) * inv2);
   tmp.val() = L.val() / R.val();
   return tmp;
 }
@@ -472,7 +482,7 @@ AD<T, N> operator/(AD<B, N> const& L, AD<T, N> const& R)
 *********************/
 
 /** \brief wrapper to standard exp function */
-double exp(double x)
+inline double exp(double x)
 {
   return std::exp(x);
 }
@@ -485,13 +495,14 @@ AD<T, N> exp(AD<T, N> const& A)
   tmp.resize(A.size());
   T A_tmp = A;
   tmp.val() = std::exp(A.val());
+  T d = exp(A_tmp);
   for (unsigned int i=0; i < A.size(); ++i)
-    tmp.dx(i) = T(A.dx(i) * exp(A_tmp));
+    tmp.dx(i) = T(A.dx(i) * d);
   return tmp;
 }
 
 /** \brief wrapper for stander log function */
-double log(double A)
+inline double log(double A)
 {
   return std::log(A);
 }
@@ -504,13 +515,14 @@ AD<T, N> log(AD<T, N> const& A)
   tmp.resize(A.size());
   T A_tmp = A;
   tmp.val() = std::log(A.val());
+  T d = 1. / A_tmp;
   for (unsigned int i=0; i < A.size(); ++i)
-    tmp.dx(i) = T(A.dx(i) / A_tmp);
+    tmp.dx(i) = T(A.dx(i) * d);
   return tmp;
 }
 
 /** \brief wrapper to standard pow function */
-double pow(double A, double e)
+inline double pow(double A, double e)
 {
   return std::pow(A, e);
 }
@@ -523,8 +535,9 @@ AD<T, N> pow(AD<T, N> const& A, const int e)
   tmp.resize(A.size());
   T A_tmp = A;
   tmp.val() = std::pow(A.val(), e);
+  T d = double(e) * pow(A_tmp, (double)e-1.);
   for (unsigned int i=0; i < tmp.size(); ++i)
-    tmp.dx(i) = T(AD<T, N>(e)*A.dx(i)*pow(A_tmp, (double)e-1.));
+    tmp.dx(i) = T(A.dx(i) * d);
   return tmp;
 }
 
@@ -536,8 +549,9 @@ AD<T, N> pow(AD<T, N> const& A, const double e)
   tmp.resize(A.size());
   T A_tmp = A; 
   tmp.val() = pow(A.val(), e);
+  T d = e * pow(A_tmp, e - 1.);
   for (unsigned int i=0; i < tmp.size(); ++i)
-    tmp.dx(i) = T(e*A.dx(i)*pow(A_tmp, e - 1.));
+    tmp.dx(i) = T(A.dx(i) * d);
   return tmp;
 }
 
@@ -549,8 +563,9 @@ AD<T, N> pow(const int base, AD<T, N> const& A)
   tmp.resize(A.size());
   T A_tmp = A;
   tmp.val() = std::pow((double)base, A.val());
+  T d = std::log((double)base) * pow((double)base, A_tmp);
   for (unsigned int i=0; i < tmp.size(); ++i)
-    tmp.dx(i) = T(std::log((double)base) * pow((double)base, A_tmp)  * A.dx(i));
+    tmp.dx(i) = T(d * A.dx(i));
   return tmp;
 }
 
@@ -562,8 +577,9 @@ AD<T, N> pow(const double base, AD<T, N> const& A)
   tmp.resize(A.size());
   T A_tmp = A;
   tmp.val() = std::pow((double)base, A.val());
+  T d = std::log(base) * pow(base, A_tmp);
   for (unsigned int i=0; i < tmp.size(); ++i)
-    tmp.dx(i) = T(std::log(base) * pow(base, A_tmp) * A.dx(i));
+    tmp.dx(i) = T(d * A.dx(i));
   return tmp;
 }
 
@@ -578,14 +594,15 @@ AD<T, N> pow(AD<T, N> const& A, AD<T, N> const& e)
   T A_tmp = A;
   T e_tmp = e;
   tmp.val() = std::pow(A.val(), e.val());
+  T de = log(A_tmp) * pow(A_tmp, e_tmp);
+  T dA = e_tmp * pow(A_tmp, e_tmp - 1.);
   for (unsigned int i=0; i < tmp.size(); ++i)
-    tmp.dx(i) = T(e.dx(i) * log(A_tmp) * pow(A_tmp, e_tmp) +
-      e_tmp * A.dx(i) * pow(A_tmp, e_tmp - 1.));
+    tmp.dx(i) = T(e.dx(i) * de + A.dx(i) * dA);
   return tmp;
 }
 
 /** \brief wrapper for standard sqrt function */
-double sqrt(double A)
+inline double sqrt(double A)
 {
   return std::sqrt(A);
 }
@@ -598,19 +615,20 @@ AD<T, N> sqrt(AD<T, N> const& A)
   tmp.resize(A.size());
   tmp.val() = std::sqrt(A.val());
   T A_tmp = A;
+  T d = .5 / sqrt(A_tmp);
   for (unsigned int i=0; i < tmp.size(); ++i)
-    tmp.dx(i) = T(.5 * A.dx(i) / sqrt(A_tmp));
+    tmp.dx(i) = T(A.dx(i) * d);
   return tmp;
 }
 
 /** \brief wrapper for standard sin function */
-double sin(double A)
+inline double sin(double A)
 {
   return std::sin(A);
 }
 
 /** \brief wrapper for standard cos function */
-double cos(double A)
+inline double cos(double A)
 {
   return std::cos(A);
 }
@@ -623,8 +641,9 @@ AD<T, N> sin(AD<T, N> const& A)
   tmp.resize(A.size());
   tmp.val() = std::sin(A.val());
   T A_tmp = A;
+  T d = cos(A_tmp);
   for(unsigned int i = 0; i < tmp.size(); i++)
-    tmp.dx(i) = T(cos(A_tmp) * A.dx(i));
+    tmp.dx(i) = T(d * A.dx(i));
   return tmp;
 }
 
@@ -636,8 +655,9 @@ AD<T, N> cos(AD<T, N> const& A)
   tmp.val() = std::cos(A.val());
   T A_tmp = A;
   tmp.resize(A.size());
+  T d = -sin(A_tmp);
   for(unsigned int i = 0; i < tmp.size(); i++)
-    tmp.dx(i) = T(-sin(A_tmp) * A.dx(i));
+    tmp.dx(i) = T(d * A.dx(i));
   return tmp;
 }
 
@@ -649,8 +669,9 @@ AD<T, N> tan(AD<T, N> const& A)
   tmp.val() = std::tan(A.val());
   T A_tmp = A;
   tmp.resize(A.size());
+  T d = 1. / (cos(A_tmp) * cos(A_tmp));
   for(unsigned int i = 0; i < tmp.size(); i++)
-    tmp.dx(i) = T(A.dx(i) * (1. / (cos(A_tmp) * cos(A_tmp))));
+    tmp.dx(i) = T(A.dx(i) * d);
   return tmp;
 }
 
@@ -0,0 +1,222 @@
+#include "mthEigen.h"
+#include "mth_def.h"
+#include <algorithm>
+#include <cmath>
+
+namespace mth {
+
+/* below this ratio of the eigenvalue spread to the largest entry,
+   the cross products of the closed form lose too many digits */
+static double const isotropic_spread = 1e-5;
+
+template <class T>
+static void fill_symmetric(Matrix<T,3,3> const& a, Matrix<T,3,3>& s,
+    T scale)
+{
+  for (unsigned i = 0; i < 3; ++i)
+  for (unsigned j = i; j < 3; ++j)
+    s(i,j) = s(j,i) = a(i,j) / scale;
+}
+
+/* the largest entry, scaling by it keeps the squares and
+   cubes below from overflowing or underflowing */
+template <class T>
+static T get_scale(Matrix<T,3,3> const& a)
+{
+  T scale = 0;
+  for (unsigned i = 0; i < 3; ++i)
+  for (unsigned j = i; j < 3; ++j)
+    scale = std::max(scale, T(std::fabs(a(i,j))));
+  return scale;
+}
+
+template <class T>
+static void fill_identity(Matrix<T,3,3>& q)
+{
+  for (unsigned i = 0; i < 3; ++i)
+  for (unsigned j = 0; j < 3; ++j)
+    q(i,j) = (i == j) ? 1 : 0;
+}
+
+/* the rotation that zeroes the off-diagonal of the
+   symmetric 2x2 block [app apq; apq aqq], as t = tan(angle) */
+static double get_rotation(double app, double apq, double aqq,
+    double& c, double& s)
+{
+  if (apq == 0) {
+    c = 1;
+    s = 0;
+    return 0;
+  }
+  double theta = (aqq - app) / (2 * apq);
+  double t = 1 / (std::fabs(theta) + std::sqrt(theta * theta + 1));
+  if (theta < 0)
+    t = -t;
+  c = 1 / std::sqrt(t * t + 1);
+  s = t * c;
+  return t;
+}
+
+/* sorts the eigenpairs by increasing eigenvalue and
+   flips the last eigenvector to make the frame right-handed */
+template <class T>
+static void sort_pairs(Vector<T,3>& l, Matrix<T,3,3>& q)
+{
+  for (unsigned i = 0; i < 2; ++i)
+  for (unsigned j = 0; j < 2 - i; ++j)
+    if (l(j + 1) < l(j)) {
+      std::swap(l(j), l(j + 1));
+      for (unsigned k = 0; k < 3; ++k)
+        std::swap(q(k,j), q(k,j + 1));
+    }
+  if (determinant(q) < 0)
+    for (unsigned k = 0; k < 3; ++k)
+      q(k,2) = -q(k,2);
+}
+
+template <class T>
+bool eigenJacobi(Matrix<T,3,3> const& a,
+    Vector<T,3>& l,
+    Matrix<T,3,3>& q,
+    unsigned max_sweeps)
+{
+  fill_identity(q);
+  T scale = get_scale(a);
+  if (scale == 0) {
+    l.zero();
+    return true;
+  }
+  Matrix<T,3,3> b;
+  fill_symmetric(a, b, scale);
+  bool converged = false;
+  for (unsigned sweep = 0; sweep < max_sweeps; ++sweep) {
+    double off = b(0,1) * b(0,1) + b(0,2) * b(0,2) + b(1,2) * b(1,2);
+    double diag = b(0,0) * b(0,0) + b(1,1) * b(1,1) + b(2,2) * b(2,2);
+    if (off <= 1e-32 * diag || off == 0) {
+      converged = true;
+      break;
+    }
+    for (unsigned p = 0; p < 2; ++p)
+    for (unsigned r = p + 1; r < 3; ++r) {
+      double c, s;
+      get_rotation(b(p,p), b(p,r), b(r,r), c, s);
+      for (unsigned k = 0; k < 3; ++k) {
+        double bkp = b(k,p);
+        double bkr = b(k,r);
+        b(k,p) = c * bkp - s * bkr;
+        b(k,r) = s * bkp + c * bkr;
+      }
+      for (unsigned k = 0; k < 3; ++k) {
+        double bpk = b(p,k);
+        double brk = b(r,k);
+        b(p,k) = c * bpk - s * brk;
+        b(r,k) = s * bpk + c * brk;
+      }
+      for (unsigned k = 0; k < 3; ++k) {
+        double qkp = q(k,p);
+        double qkr = q(k,r);
+        q(k,p) = c * qkp - s * qkr;
+        q(k,r) = s * qkp + c * qkr;
+      }
+    }
+  }
+  for (unsigned i = 0; i < 3; ++i)
+    l(i) = b(i,i) * scale;
+  sort_pairs(l, q);
+  return converged;
+}
+
+template bool eigenJacobi(Matrix<double,3,3> const& a, Vector<double,3>& l,
+    Matrix<double,3,3>& q, unsigned max_sweeps);
+
+/* the null vector of the rank 2 matrix (a - lI) is parallel to
+   the cross products of its rows, take the best conditioned one */
+template <class T>
+static Vector<T,3> get_null_vector(Matrix<T,3,3> const& a, T l)
+{
+  Matrix<T,3,3> b = a;
+  for (unsigned i = 0; i < 3; ++i)
+    b(i,i) -= l;
+  Vector<T,3> c[3];
+  c[0] = cross(b[0], b[1]);
+  c[1] = cross(b[0], b[2]);
+  c[2] = cross(b[1], b[2]);
+  unsigned best = 0;
+  for (unsigned i = 1; i < 3; ++i)
+    if (c[i] * c[i] > c[best] * c[best])
+      best = i;
+  return c[best] / std::sqrt(c[best] * c[best]);
+}
+
+template <class T>
+void eigenSymmetric(Matrix<T,3,3> const& a,
+    Vector<T,3>& l,
+    Matrix<T,3,3>& q)
+{
+  T scale = get_scale(a);
+  if (scale == 0) {
+    l.zero();
+    fill_identity(q);
+    return;
+  }
+  Matrix<T,3,3> s;
+  fill_symmetric(a, s, scale);
+  /* the trigonometric roots of the characteristic polynomial
+     of the shifted and scaled matrix (s - mI) / p */
+  T m = (s(0,0) + s(1,1) + s(2,2)) / 3;
+  T off = s(0,1) * s(0,1) + s(0,2) * s(0,2) + s(1,2) * s(1,2);
+  T p2 = (s(0,0) - m) * (s(0,0) - m) + (s(1,1) - m) * (s(1,1) - m) +
+         (s(2,2) - m) * (s(2,2) - m) + 2 * off;
+  T p = std::sqrt(p2 / 6);
+  if (p < isotropic_spread) {
+    eigenJacobi(a, l, q, 50);
+    return;
+  }
+  Matrix<T,3,3> b = s;
+  for (unsigned i = 0; i < 3; ++i)
+    b(i,i) -= m;
+  T r = determinant(b) / (2 * p * p * p);
+  r = std::min(T(1), std::max(T(-1), r));
+  T phi = std::acos(r) / 3;
+  T high = m + 2 * p * std::cos(phi);
+  T low = m + 2 * p * std::cos(phi + (2 * M_PI / 3));
+  T middle = 3 * m - high - low;
+  /* only the eigenvalue farthest from the other two is accurate
+     to machine precision, and so is its eigenvector */
+  T distinct = (high - middle > middle - low) ? high : low;
+  Vector<T,3> v = get_null_vector(s, distinct);
+  /* an orthonormal basis of the plane orthogonal to v,
+     starting from the axis least aligned with it */
+  unsigned axis = 0;
+  for (unsigned i = 1; i < 3; ++i)
+    if (std::fabs(v(i)) < std::fabs(v(axis)))
+      axis = i;
+  Vector<T,3> e;
+  e.zero();
+  e(axis) = 1;
+  Vector<T,3> u = cross(v, e);
+  u = u / std::sqrt(u * u);
+  Vector<T,3> w = cross(v, u);
+  /* the other two eigenpairs diagonalize s restricted to that plane */
+  Vector<T,3> su = s * u;
+  Vector<T,3> sw = s * w;
+  T buu = u * su;
+  T buw = u * sw;
+  T bww = w * sw;
+  T c, sn;
+  T t = get_rotation(buu, buw, bww, c, sn);
+  l(0) = distinct * scale;
+  l(1) = (buu - t * buw) * scale;
+  l(2) = (bww + t * buw) * scale;
+  for (unsigned k = 0; k < 3; ++k) {
+    q(k,0) = v(k);
+    q(k,1) = c * u(k) - sn * w(k);
+    q(k,2) = sn * u(k) + c * w(k);
+  }
+  sort_pairs(l, q);
+}
+
+template void eigenSymmetric(Matrix<double,3,3> const& a,
+    Vector<double,3>& l, Matrix<double,3,3>& q);
+
+}
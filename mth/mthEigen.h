@@ -0,0 +1,46 @@
+#ifndef MTH_EIGEN_H
+#define MTH_EIGEN_H
+
+#include "mthMatrix.h"
+
+/** \file mthEigen.h
+  * \brief eigendecomposition of small symmetric matrices */
+
+namespace mth {
+
+/** \brief computes the eigendecomposition of a symmetric 3x3 matrix
+  * \details the eigenvalues come from the closed form roots of the
+  *          characteristic polynomial. The eigenvector of the
+  *          eigenvalue farthest from the other two is a cross product
+  *          of rows of (A - lI), and the other two come from an exact
+  *          2x2 rotation in the plane orthogonal to it, which keeps
+  *          them accurate when those two eigenvalues are close or equal.
+  *          Nearly isotropic matrices, for which the closed form
+  *          loses its precision, go to cyclic Jacobi rotations instead.
+  *          Only the double type is explicitly instantiated.
+  * \param a the real symmetric input matrix, only its upper
+  *          triangle is read
+  * \param l the eigenvalues in increasing order
+  * \param q the orthogonal matrix whose columns are the
+  *          corresponding eigenvectors, with determinant 1
+  */
+template <class T>
+void eigenSymmetric(Matrix<T,3,3> const& a,
+    Vector<T,3>& l,
+    Matrix<T,3,3>& q);
+
+/** \brief the Jacobi eigensolver used by mth::eigenSymmetric
+  * \details exposed to check the closed form against it.
+  *          Sweeps until the off-diagonal entries vanish relative
+  *          to the diagonal, which takes a handful of sweeps.
+  * \returns true if converged in less than max_sweeps
+  */
+template <class T>
+bool eigenJacobi(Matrix<T,3,3> const& a,
+    Vector<T,3>& l,
+    Matrix<T,3,3>& q,
+    unsigned max_sweeps);
+
+}
+
+#endif
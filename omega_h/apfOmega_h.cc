@@ -15,99 +15,83 @@
 
 namespace apf {
 
+/* the field helpers walk flat entity lists, the cached
+   apf::Mesh::getConnectivity order on the way out and the
+   entities as created on the way in, which both match the
+   Omega_h numbering */
+typedef std::vector<apf::MeshEntity*> Entities;
+
 static void components_to_osh(
     apf::Field* f,
-    apf::MeshIterator* it,
+    Entities const& ents,
     osh::HostWrite<osh::Real> data) {
-  auto am = apf::getMesh(f);
   auto nc = apf::countComponents(f);
-  apf::MeshEntity* v;
-  int i = 0;
-  while ((v = am->iterate(it))) {
-    apf::getComponents(f, v, 0, data.data() + i * nc);
-    ++i;
-  }
+  auto out = data.data();
+  for (size_t i = 0; i < ents.size(); ++i)
+    apf::getComponents(f, ents[i], 0, out + i * nc);
 }
 
 static void components_from_osh(
     apf::Field* f,
-    apf::MeshIterator* it,
+    Entities const& ents,
     osh::HostRead<osh::Real> data) {
-  auto am = apf::getMesh(f);
   auto nc = apf::countComponents(f);
-  apf::MeshEntity* v;
-  int i = 0;
-  while ((v = am->iterate(it))) {
-    apf::setComponents(f, v, 0, data.data() + i * nc);
-    ++i;
+  std::vector<double> x(nc);
+  for (size_t i = 0; i < ents.size(); ++i) {
+    for (int j = 0; j < nc; ++j) x[j] = data[i * nc + j];
+    apf::setComponents(f, ents[i], 0, &x[0]);
   }
 }
 
 static void vectors_to_osh(
     apf::Field* f,
-    apf::MeshIterator* it,
+    Entities const& ents,
     osh::HostWrite<osh::Real> data) {
-  auto am = apf::getMesh(f);
-  auto dim = am->getDimension();
-  apf::MeshEntity* v;
-  int i = 0;
-  while ((v = am->iterate(it))) {
+  auto dim = apf::getMesh(f)->getDimension();
+  for (size_t i = 0; i < ents.size(); ++i) {
     apf::Vector3 x;
-    apf::getVector(f, v, 0, x);
+    apf::getVector(f, ents[i], 0, x);
     for (int j = 0; j < dim; ++j) data[i * dim + j] = x[j];
-    ++i;
   }
 }
 
 static void vectors_from_osh(
     apf::Field* f,
-    apf::MeshIterator* it,
+    Entities const& ents,
     osh::HostRead<osh::Real> data) {
-  auto am = apf::getMesh(f);
-  auto dim = am->getDimension();
-  apf::MeshEntity* v;
-  int i = 0;
-  while ((v = am->iterate(it))) {
+  auto dim = apf::getMesh(f)->getDimension();
+  for (size_t i = 0; i < ents.size(); ++i) {
     apf::Vector3 x(0,0,0);
     for (int j = 0; j < dim; ++j) x[j] = data[i * dim + j];
-    apf::setVector(f, v, 0, x);
-    ++i;
+    apf::setVector(f, ents[i], 0, x);
   }
 }
 
 template <int dim>
 static void matrices_to_osh(
     apf::Field* f,
-    apf::MeshIterator* it,
+    Entities const& ents,
     osh::HostWrite<osh::Real> data) {
-  auto am = apf::getMesh(f);
-  apf::MeshEntity* v;
-  int i = 0;
-  while ((v = am->iterate(it))) {
+  for (size_t i = 0; i < ents.size(); ++i) {
     apf::Matrix3x3 x;
-    apf::getMatrix(f, v, 0, x);
+    apf::getMatrix(f, ents[i], 0, x);
     for (int j = 0; j < dim; ++j)
       for (int k = 0; k < dim; ++k)
         data[i * dim * dim + k * dim + j] = x[j][k];
-    ++i;
   }
 }
 
 template <int dim>
 static void matrices_from_osh(
     apf::Field* f,
-    apf::MeshIterator* it,
+    Entities const& ents,
     osh::HostRead<osh::Real> data) {
-  auto am = apf::getMesh(f);
-  apf::MeshEntity* v;
-  int i = 0;
-  while ((v = am->iterate(it))) {
-    apf::Matrix3x3 x;
+  for (size_t i = 0; i < ents.size(); ++i) {
+    apf::Matrix3x3 x(0,0,0,0,0,0,0,0,0);
     for (int j = 0; j < dim; ++j)
       for (int k = 0; k < dim; ++k)
         x[j][k] = data[i * dim * dim + k * dim + j];
-    apf::setMatrix(f, v, 0, x);
-    ++i;
+    apf::setMatrix(f, ents[i], 0, x);
   }
 }
 
@@ -139,35 +123,31 @@ static void field_to_osh(osh::Mesh* om, apf::Field* f) {
     nc = apf::countComponents(f);
   }
   auto data = osh::HostWrite<osh::Real>(om->nents(ent_dim) * nc);
-  auto it = am->begin(ent_dim);
+  auto& ents = am->getConnectivity(ent_dim).elements;
   if (vt == apf::VECTOR) {
-    vectors_to_osh(f, it, data);
+    vectors_to_osh(f, ents, data);
   } else if (vt == apf::MATRIX) {
-    if (dim == 2) matrices_to_osh<2>(f, it, data);
-    if (dim == 3) matrices_to_osh<3>(f, it, data);
-  } else components_to_osh(f, it, data);
-  am->end(it);
+    if (dim == 2) matrices_to_osh<2>(f, ents, data);
+    if (dim == 3) matrices_to_osh<3>(f, ents, data);
+  } else components_to_osh(f, ents, data);
   om->add_tag(ent_dim, name, nc, osh::Reals(data.write()));
 }
 
 static void field_from_osh(apf::Field* f, osh::Tag<osh::Real> const* tag,
-    int ent_dim) {
-  auto am = apf::getMesh(f);
-  auto dim = am->getDimension();
+    Entities const& ents) {
+  auto dim = apf::getMesh(f)->getDimension();
   auto data = osh::HostRead<osh::Real>(tag->array());
   auto value_type = apf::getValueType(f);
-  apf::MeshIterator* it = am->begin(ent_dim);
   if (value_type == apf::VECTOR) {
-    vectors_from_osh(f, it, data);
-  } if (value_type == apf::MATRIX) {
-    if (dim == 2) matrices_from_osh<2>(f, it, data);
-    if (dim == 3) matrices_from_osh<3>(f, it, data);
-  } else components_from_osh(f, it, data);
-  am->end(it);
+    vectors_from_osh(f, ents, data);
+  } else if (value_type == apf::MATRIX) {
+    if (dim == 2) matrices_from_osh<2>(f, ents, data);
+    if (dim == 3) matrices_from_osh<3>(f, ents, data);
+  } else components_from_osh(f, ents, data);
 }
 
 static void field_from_osh(apf::Mesh* am, osh::Tag<osh::Real> const* tag,
-    int ent_dim) {
+    Entities const* ents, int ent_dim) {
   auto dim = am->getDimension();
   auto nc = tag->ncomps();
   auto name = tag->name();
@@ -187,7 +167,7 @@ static void field_from_osh(apf::Mesh* am, osh::Tag<osh::Real> const* tag,
   }
   auto f = apf::createGeneralField(am, name.c_str(), value_type, nc,
       shape);
-  field_from_osh(f, tag, ent_dim);
+  field_from_osh(f, tag, ents[ent_dim]);
 }
 
 static void fields_to_osh(osh::Mesh* om, apf::Mesh* am) {
@@ -195,67 +175,54 @@ static void fields_to_osh(osh::Mesh* om, apf::Mesh* am) {
     field_to_osh(om, am->getField(i));
 }
 
-static void fields_from_osh(apf::Mesh* am, osh::Mesh* om, int ent_dim) {
+static void fields_from_osh(apf::Mesh* am, osh::Mesh* om,
+    Entities const* ents, int ent_dim) {
   for (int i = 0; i < om->ntags(ent_dim); ++i) {
     auto tagbase = om->get_tag(ent_dim, i);
     if (tagbase->type() == OMEGA_H_F64 &&
         tagbase->name() != "metric" &&
         tagbase->name() != "coordinates") {
-      field_from_osh(am, dynamic_cast<osh::Tag<osh::Real> const*>(tagbase), ent_dim);
+      field_from_osh(am, dynamic_cast<osh::Tag<osh::Real> const*>(tagbase),
+          ents, ent_dim);
     }
   }
 }
 
-static void fields_from_osh(apf::Mesh* am, osh::Mesh* om) {
-  fields_from_osh(am, om, 0);
-  fields_from_osh(am, om, am->getDimension());
+static void fields_from_osh(apf::Mesh* am, osh::Mesh* om,
+    Entities const* ents) {
+  fields_from_osh(am, om, ents, 0);
+  fields_from_osh(am, om, ents, am->getDimension());
 }
 
 static void coords_to_osh(osh::Mesh* om, apf::Mesh* am) {
   field_to_osh(om, am->getCoordinateField());
 }
 
-static void coords_from_osh(apf::Mesh* am, osh::Mesh* om) {
-  field_from_osh(am->getCoordinateField(),
-      om->get_tag<osh::Real>(0, "coordinates"), 0);
-}
-
 static void class_to_osh(osh::Mesh* mesh_osh, apf::Mesh* mesh_apf, int dim) {
-  auto nents = osh::LO(mesh_apf->count(dim));
+  auto& ents = mesh_apf->getConnectivity(dim).elements;
+  auto nents = osh::LO(ents.size());
   auto host_class_id = osh::HostWrite<osh::LO>(nents);
   auto host_class_dim = osh::HostWrite<osh::I8>(nents);
-  auto iter = mesh_apf->begin(dim);
-  apf::MeshEntity* e;
-  int i = 0;
-  while ((e = mesh_apf->iterate(iter))) {
-    auto me = mesh_apf->toModel(e);
+  for (osh::LO i = 0; i < nents; ++i) {
+    auto me = mesh_apf->toModel(ents[i]);
     host_class_dim[i] = osh::I8(mesh_apf->getModelType(me));
     host_class_id[i] = mesh_apf->getModelTag(me);
-    ++i;
   }
-  mesh_apf->end(iter);
   mesh_osh->add_tag(dim, "class_dim", 1, osh::Read<osh::I8>(host_class_dim.write()));
   mesh_osh->add_tag(dim, "class_id", 1, osh::LOs(host_class_id.write()));
 }
 
+/* the vertex lists come from the connectivity table the
+   mesh keeps while its topology is unchanged */
 static void conn_to_osh(osh::Mesh* mesh_osh, apf::Mesh* mesh_apf,
     apf::Numbering* vert_nums, int d) {
-  auto nhigh = osh::LO(mesh_apf->count(d));
+  auto& conn = mesh_apf->getConnectivity(d);
+  auto nhigh = osh::LO(conn.elements.size());
   auto deg = d + 1;
+  OMEGA_H_CHECK(conn.vertices.size() == size_t(nhigh * deg));
   osh::HostWrite<osh::LO> host_ev2v(nhigh * deg);
-  auto iter = mesh_apf->begin(d);
-  apf::MeshEntity* he;
-  int i = 0;
-  while ((he = mesh_apf->iterate(iter))) {
-    apf::Downward eev;
-    auto deg2 = mesh_apf->getDownward(he, 0, eev);
-    OMEGA_H_CHECK(deg == deg2);
-    for (int j = 0; j < deg; ++j) {
-      host_ev2v[i * deg + j] = apf::getNumber(vert_nums, eev[j], 0, 0);
-    }
-    ++i;
-  }
-  mesh_apf->end(iter);
+  for (osh::LO i = 0; i < nhigh * deg; ++i)
+    host_ev2v[i] = apf::getNumber(vert_nums, conn.vertices[i], 0, 0);
   auto ev2v = osh::LOs(host_ev2v.write());
   osh::Adj high2low;
   if (d == 1) {
@@ -273,19 +240,14 @@ static void globals_to_osh(
   apf::GlobalNumbering* globals_apf = apf::makeGlobal(
       apf::numberOwnedDimension(mesh_apf, "smb2osh_global", dim));
   apf::synchronize(globals_apf);
-  auto nents = osh::LO(mesh_apf->count(dim));
+  auto& ents = mesh_apf->getConnectivity(dim).elements;
+  auto nents = osh::LO(ents.size());
   osh::HostWrite<osh::GO> host_globals(nents);
-  auto iter = mesh_apf->begin(dim);
-  apf::MeshEntity* e;
-  int i = 0;
-  while ((e = mesh_apf->iterate(iter))) {
-    host_globals[i++] = apf::getNumber(globals_apf, apf::Node(e, 0));
-  }
-  mesh_apf->end(iter);
+  for (osh::LO i = 0; i < nents; ++i)
+    host_globals[i] = apf::getNumber(globals_apf, apf::Node(ents[i], 0));
   apf::destroyGlobalNumbering(globals_apf);
   auto globals = osh::Read<osh::GO>(host_globals.write());
-  mesh_osh->add_tag(dim, "global", 1,
-      osh::Read<osh::GO>(host_globals.write()));
+  mesh_osh->add_tag(dim, "global", 1, globals);
   auto owners = osh::owners_from_globals(
       mesh_osh->comm(), globals, osh::Read<osh::I32>());
   mesh_osh->set_owners(dim, owners);
@@ -315,36 +277,40 @@ void to_omega_h(osh::Mesh* om, apf::Mesh* am) {
   fields_to_osh(om, am);
 }
 
-static void
-class_from_osh(apf::Mesh2* am, osh::Mesh* om,
-    std::vector<apf::MeshEntity*> const& ents,
-    int ent_dim) {
-  auto class_dim = osh::HostRead<osh::I8>(om->get_array<osh::I8>(ent_dim, "class_dim"));
-  auto class_id = osh::HostRead<osh::LO>(om->get_array<osh::LO>(ent_dim, "class_id"));
-  for (int i = 0; i < om->nents(ent_dim); ++i) {
-    auto ge = am->findModelEntity(class_dim[i], class_id[i]);
-    am->setModelEntity(ents[i], ge);
-  }
-}
-
-static std::vector<apf::MeshEntity*>
+/* vertices are made classified and placed in one pass,
+   with room reserved for all of them */
+static Entities
 verts_from_osh(apf::Mesh2* am, osh::Mesh* om) {
-  std::vector<apf::MeshEntity*> verts(om->nverts());
-  for (int i = 0; i < om->nverts(); ++i) {
-    verts[i] = am->createVert(nullptr);
+  auto nverts = om->nverts();
+  auto dim = om->dim();
+  Entities verts(nverts);
+  auto class_dim = osh::HostRead<osh::I8>(
+      om->get_array<osh::I8>(0, "class_dim"));
+  auto class_id = osh::HostRead<osh::LO>(
+      om->get_array<osh::LO>(0, "class_id"));
+  auto coords = osh::HostRead<osh::Real>(om->coords());
+  am->reserve(apf::Mesh::VERTEX, nverts);
+  for (int i = 0; i < nverts; ++i) {
+    auto ge = am->findModelEntity(class_dim[i], class_id[i]);
+    apf::Vector3 x(0,0,0);
+    for (int j = 0; j < dim; ++j) x[j] = coords[i * dim + j];
+    verts[i] = am->createVertex(ge, x, apf::Vector3(0,0,0));
   }
-  assert(int(am->count(0)) == om->nverts());
+  assert(int(am->count(0)) == nverts);
   return verts;
 }
 
-static std::vector<apf::MeshEntity*>
+/* buildElement classifies each entity as it is made and,
+   since lower dimensions are built first, finds rather than
+   makes its boundary */
+static Entities
 ents_from_osh(
     apf::Mesh2* am,
     osh::Mesh* om,
-    std::vector<apf::MeshEntity*> const& verts,
+    Entities const& verts,
     int ent_dim)
 {
-  std::vector<apf::MeshEntity*> ents(om->nents(ent_dim));
+  Entities ents(om->nents(ent_dim));
   auto ev2v = osh::HostRead<osh::LO>(om->ask_verts_of(ent_dim));
   auto class_dim = osh::HostRead<osh::I8>(
       om->get_array<osh::I8>(ent_dim, "class_dim"));
@@ -352,6 +318,7 @@ ents_from_osh(
       om->get_array<osh::LO>(ent_dim, "class_id"));
   apf::Mesh::Type t = apf::Mesh::simplexTypes[ent_dim];
   int nverts_per_ent = ent_dim + 1;
+  am->reserve(t, ents.size());
   for (int i = 0; i < om->nents(ent_dim); ++i) {
     auto ge = am->findModelEntity(class_dim[i], class_id[i]);
     apf::Downward ev;
@@ -362,15 +329,22 @@ ents_from_osh(
   return ents;
 }
 
+/* the remote copies of all dimensions are made in two
+   exchanges: copies report to their owners, then owners
+   tell each copy about the others. a single part has none */
 static void owners_from_osh(
     apf::Mesh2* am,
     osh::Mesh* om,
-    std::vector<apf::MeshEntity*> const& ents,
-    int ent_dim)
+    Entities const* ents)
 {
-  auto owners = om->ask_owners(ent_dim);
-  auto own_ranks = osh::HostRead<osh::I32>(owners.ranks);
-  auto own_ids = osh::HostRead<osh::LO>(owners.idxs);
+  int dim = om->dim();
+  std::vector<osh::HostRead<osh::I32> > own_ranks;
+  std::vector<osh::HostRead<osh::LO> > own_ids;
+  for (int d = 0; d <= dim; ++d) {
+    auto owners = om->ask_owners(d);
+    own_ranks.push_back(osh::HostRead<osh::I32>(owners.ranks));
+    own_ids.push_back(osh::HostRead<osh::LO>(owners.idxs));
+  }
   if (om->parting() != OMEGA_H_ELEM_BASED) {
     /* currently MDS defines ownership between pairs of ranks
        only, which is insufficient to represent ghosting
@@ -379,50 +353,55 @@ static void owners_from_osh(
        which can later be used by an apf::Sharing */
     apf::MeshTag* own_tag = am->findTag("owner");
     if (!own_tag) own_tag = am->createIntTag("owner", 1);
-    for (int i = 0; i < om->nents(ent_dim); ++i) {
-      int tmp = own_ranks[i];
-      am->setIntTag(ents[i], own_tag, &tmp);
-    }
+    for (int d = 0; d <= dim; ++d)
+      for (int i = 0; i < om->nents(d); ++i) {
+        int tmp = own_ranks[d][i];
+        am->setIntTag(ents[d][i], own_tag, &tmp);
+      }
   }
+  if (PCU_Comm_Peers() == 1)
+    return;
+  int self = PCU_Comm_Self();
   PCU_Comm_Begin();
-  for (int i = 0; i < om->nents(ent_dim); ++i) {
-    osh::LO tmp = own_ids[i];
-    PCU_COMM_PACK(own_ranks[i], tmp);
-    PCU_COMM_PACK(own_ranks[i], ents[i]);
-  }
+  for (int d = 0; d <= dim; ++d)
+    for (int i = 0; i < om->nents(d); ++i) {
+      int to = own_ranks[d][i];
+      if (to == self)
+        continue;
+      osh::LO tmp = own_ids[d][i];
+      PCU_COMM_PACK(to, d);
+      PCU_COMM_PACK(to, tmp);
+      PCU_COMM_PACK(to, ents[d][i]);
+    }
   PCU_Comm_Send();
   while (PCU_Comm_Receive()) {
-    int own_id;
+    int d;
+    PCU_COMM_UNPACK(d);
+    osh::LO own_id;
     PCU_COMM_UNPACK(own_id);
     apf::MeshEntity* r;
     PCU_COMM_UNPACK(r);
-    int from = PCU_Comm_Sender();
-    if (from == PCU_Comm_Self()) {
-      assert((int)from == own_ranks[own_id]);
-      continue;
-    }
-    apf::MeshEntity* owner = ents[own_id];
-    am->addRemote(owner, from, r);
+    am->addRemote(ents[d][own_id], PCU_Comm_Sender(), r);
   }
   PCU_Comm_Begin();
-  for (int i = 0; i < om->nents(ent_dim); ++i)
-    if (own_ranks[i] == (int)(PCU_Comm_Self())) {
-      apf::Copies remotes;
-      am->getRemotes(ents[i], remotes);
-      int ncopies = remotes.size();
-      int self = PCU_Comm_Self();
-      APF_ITERATE(apf::Copies, remotes, it) {
-        PCU_COMM_PACK(it->first, it->second);
-        PCU_COMM_PACK(it->first, ncopies);
-        PCU_COMM_PACK(it->first, self);
-        PCU_COMM_PACK(it->first, ents[i]);
-        APF_ITERATE(apf::Copies, remotes, it2)
-          if (it2->first != it->first) {
-            PCU_COMM_PACK(it->first, it2->first);
-            PCU_COMM_PACK(it->first, it2->second);
-          }
+  for (int d = 0; d <= dim; ++d)
+    for (int i = 0; i < om->nents(d); ++i)
+      if (own_ranks[d][i] == self) {
+        apf::Copies remotes;
+        am->getRemotes(ents[d][i], remotes);
+        int ncopies = remotes.size();
+        APF_ITERATE(apf::Copies, remotes, it) {
+          PCU_COMM_PACK(it->first, it->second);
+          PCU_COMM_PACK(it->first, ncopies);
+          PCU_COMM_PACK(it->first, self);
+          PCU_COMM_PACK(it->first, ents[d][i]);
+          APF_ITERATE(apf::Copies, remotes, it2)
+            if (it2->first != it->first) {
+              PCU_COMM_PACK(it->first, it2->first);
+              PCU_COMM_PACK(it->first, it2->second);
+            }
+        }
       }
-    }
   PCU_Comm_Send();
   while (PCU_Comm_Receive()) {
     apf::MeshEntity* e;
@@ -441,18 +420,15 @@ static void owners_from_osh(
 
 void from_omega_h(apf::Mesh2* am, osh::Mesh* om)
 {
-  std::vector<apf::MeshEntity*> ents[4];
+  Entities ents[4];
   ents[0] = verts_from_osh(am, om);
   for (int d = 1; d <= om->dim(); ++d)
     ents[d] = ents_from_osh(am, om, ents[0], d);
-  coords_from_osh(am, om);
-  for (int d = 0; d <= om->dim(); ++d) {
-    class_from_osh(am, om, ents[d], d);
-    owners_from_osh(am, om, ents[d], d);
+  owners_from_osh(am, om, ents);
+  for (int d = 0; d <= om->dim(); ++d)
     apf::initResidence(am, d);
-  }
   am->acceptChanges();
-  fields_from_osh(am, om);
+  fields_from_osh(am, om, ents);
 }
 
 };
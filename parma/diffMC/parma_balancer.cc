@@ -3,6 +3,7 @@
 #include "parma_monitor.h"
 #include "parma_graphDist.h"
 #include "parma_commons.h"
+#include "parma_totals.h"
 
 namespace {
   void printTiming(const char* type, int steps, double tol, double time) {
@@ -20,6 +21,7 @@ namespace parma {
       iA = new parma::Average(8);
       sS = new parma::Slope();
       sA = new parma::Average(8);
+      totals = 0;
   }
   Balancer::~Balancer() {
     delete iA;
@@ -33,12 +35,20 @@ namespace parma {
     }
   }
   void Balancer::balance(apf::MeshTag* wtag, double tolerance) {
+    PCU_Region region("parma::balance");
     if( 1 == PCU_Comm_Peers() ) return;
     int step = 0;
     double t0 = PCU_Time();
     while (runStep(wtag,tolerance) && step++ < maxStep);
+    delete totals;
+    totals = 0;
     printTiming(name, step, tolerance, PCU_Time()-t0);
   }
+  Totals* Balancer::getTotals(apf::MeshTag* wtag) {
+    if (!totals)
+      totals = new Totals(mesh, wtag);
+    return totals;
+  }
   void Balancer::monitorUpdate(double v, Slope* s, Average* a) {
     s->push(v);
     const double slope = (s->full()) ? s->slope() : 1.0;
@@ -6,6 +6,7 @@
 namespace parma {
   class Slope;
   class Average;
+  class Totals;
   class Balancer : public apf::Balancer {
     public:
       Balancer(apf::Mesh* m, double f, int v, const char* n);
@@ -13,6 +14,8 @@ namespace parma {
       virtual bool runStep(apf::MeshTag* wtag, double tolerance)=0;
       virtual void balance(apf::MeshTag* wtag, double tolerance);
       void monitorUpdate(double v, Slope* s, Average* a);
+      /* element totals kept across the steps of one balance call */
+      Totals* getTotals(apf::MeshTag* wtag);
       apf::Mesh* mesh;
       double factor;
       int verbose;
@@ -23,6 +26,7 @@ namespace parma {
       Average* iA;
       Slope* sS;
       Average* sA;
+      Totals* totals;
   };
 
   apf::Balancer* makeElmLtVtxEdgeBalancer(apf::Mesh* m, double maxVtx,
@@ -0,0 +1,58 @@
+#include <PCU.h>
+#include <parma.h>
+#include <pcu_util.h>
+#include "parma_capacity.h"
+#include <unistd.h>
+#include <vector>
+
+namespace {
+  /* every part's capacity over the mean capacity */
+  std::vector<double> capacities;
+}
+
+namespace parma {
+  double getCapacity(int part) {
+    /* capacities set for another communicator do not apply */
+    if (capacities.size() != static_cast<size_t>(PCU_Comm_Peers()))
+      return 1;
+    return capacities[part];
+  }
+
+  double getLoadDifference(int peer, double selfW, double peerW) {
+    const double selfC = getCapacity(PCU_Comm_Self());
+    const double peerC = getCapacity(peer);
+    return (selfW / selfC - peerW / peerC) *
+      (2 * selfC * peerC / (selfC + peerC));
+  }
+}
+
+void Parma_SetCapacities(double capacity) {
+  PCU_ALWAYS_ASSERT(capacity > 0);
+  const int peers = PCU_Comm_Peers();
+  capacities.assign(peers, 0);
+  capacities[PCU_Comm_Self()] = capacity;
+  PCU_Add_Doubles(&capacities[0], peers);
+  double mean = 0;
+  for (int i = 0; i < peers; ++i)
+    mean += capacities[i];
+  mean /= peers;
+  for (int i = 0; i < peers; ++i)
+    capacities[i] /= mean;
+}
+
+double Parma_GetMemoryCapacity() {
+  long pageBytes = sysconf(_SC_PAGESIZE);
+#ifdef _SC_AVPHYS_PAGES
+  long pages = sysconf(_SC_AVPHYS_PAGES);
+#else
+  long pages = sysconf(_SC_PHYS_PAGES);
+#endif
+  /* the ranks of one node share its memory */
+  MPI_Comm nodeComm;
+  MPI_Comm_split_type(PCU_Get_Comm(), MPI_COMM_TYPE_SHARED,
+      PCU_Comm_Self(), MPI_INFO_NULL, &nodeComm);
+  int nodeRanks;
+  MPI_Comm_size(nodeComm, &nodeRanks);
+  MPI_Comm_free(&nodeComm);
+  return static_cast<double>(pages) * pageBytes / nodeRanks;
+}
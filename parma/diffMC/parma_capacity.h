@@ -0,0 +1,14 @@
+#ifndef PARMA_CAPACITY_H
+#define PARMA_CAPACITY_H
+
+namespace parma {
+  /* the share of the total weight (part) should hold relative to
+     an equal share, 1 unless Parma_SetCapacities was called */
+  double getCapacity(int part);
+  /* the weight that evens the loads, weight over capacity, of this
+     part and (peer) when moved between them. For equal capacities
+     this is selfW - peerW. */
+  double getLoadDifference(int peer, double selfW, double peerW);
+}
+
+#endif
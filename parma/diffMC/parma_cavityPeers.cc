@@ -0,0 +1,66 @@
+#include <map>
+#include <PCU.h>
+#include <apf.h>
+#include "parma.h"
+#include "parma_cavityPeers.h"
+
+namespace {
+  int selectorThreads = 1;
+
+  typedef std::map<int,int> PeerCounts;
+
+  struct Scores {
+    apf::Mesh* mesh;
+    apf::MeshEntity** verts;
+    parma::Peers* peers;
+  };
+
+  void scoreChunk(void* p, size_t first, size_t end) {
+    Scores* s = static_cast<Scores*>(p);
+    for (size_t i = first; i < end; ++i)
+      parma::getCavityPeers(s->mesh, s->verts[i], s->peers[i]);
+  }
+}
+
+namespace parma {
+  void getCavityPeers(apf::Mesh* m, apf::MeshEntity* v, Peers& peers) {
+    PeerCounts pc;
+    apf::Adjacent sideSides;
+    m->getAdjacent(v, m->getDimension()-2, sideSides);
+    APF_ITERATE(apf::Adjacent, sideSides, ss) {
+      apf::Copies rmts;
+      m->getRemotes(*ss,rmts);
+      APF_ITERATE(apf::Copies, rmts, r)
+         pc[r->first]++;
+    }
+    int max = 0;
+    APF_ITERATE(PeerCounts, pc, p)
+      if( p->second > max )
+         max = p->second;
+    peers.clear();
+    APF_ITERATE(PeerCounts, pc, p)
+      if( p->second == max )
+        peers.push_back(p->first);
+  }
+
+  void getCavityPeers(apf::Mesh* m, std::vector<apf::MeshEntity*>& verts,
+      std::vector<Peers>& peers) {
+    const size_t n = verts.size();
+    peers.resize(n);
+    if (!n)
+      return;
+    Scores s;
+    s.mesh = m;
+    s.verts = &verts[0];
+    s.peers = &peers[0];
+    PCU_Thrd_Chunks(selectorThreads, n, scoreChunk, &s);
+  }
+
+  int getSelectorThreads() {
+    return selectorThreads;
+  }
+}
+
+void Parma_SetSelectorThreads(int threads) {
+  selectorThreads = threads < 1 ? 1 : threads;
+}
@@ -0,0 +1,20 @@
+#ifndef PARMA_CAVITYPEERS_H
+#define PARMA_CAVITYPEERS_H
+
+#include <apfMesh.h>
+#include <vector>
+
+namespace parma {
+  typedef std::vector<int> Peers;
+  /* the peers that share the most of the (dim-2) entities
+     around the boundary vertex (v), in increasing order */
+  void getCavityPeers(apf::Mesh* m, apf::MeshEntity* v, Peers& peers);
+  /* getCavityPeers for each of (verts), in contiguous chunks of
+     (verts) over getSelectorThreads() threads. The threads only
+     read the mesh, which the mds mesh allows. */
+  void getCavityPeers(apf::Mesh* m, std::vector<apf::MeshEntity*>& verts,
+      std::vector<Peers>& peers);
+  int getSelectorThreads();
+}
+
+#endif
@@ -8,6 +8,7 @@
 #include "parma_centroids.h"
 #include "parma_targets.h"
 #include "parma_selector.h"
+#include "parma_totals.h"
 
 namespace {
   class CentroidBalancer : public parma::Balancer {
@@ -16,12 +17,13 @@ namespace {
         : Balancer(m, f, v, "elements") { }
       bool runStep(apf::MeshTag* wtag, double tolerance) {
         parma::Sides* s = parma::makeElmBdrySides(mesh);
-        parma::Weights* w =
-          parma::makeEntWeights(mesh, wtag, s, mesh->getDimension());
+        parma::Totals* tot = getTotals(wtag);
+        parma::Weights* w = parma::makeElmWeights(mesh, wtag, s, tot);
         parma::Targets* t = parma::makeTargets(s, w, factor);
-        parma::Centroids c(mesh, wtag, s);
+        parma::Centroids c(mesh, tot, s);
         parma::Selector* sel = parma::makeCentroidSelector(mesh, wtag, &c);
         parma::Stepper b(mesh, factor, s, w, t, sel, "elm");
+        b.track(tot);
         return b.step(tolerance, verbose);
       }
   };
@@ -2,6 +2,7 @@
 #include <PCU.h>
 #include "parma_centroids.h"
 #include "parma_sides.h"
+#include "parma_totals.h"
 
 namespace {
   double getEntWeight(apf::Mesh* m, apf::MeshTag* w, apf::MeshEntity* e) {
@@ -29,6 +30,12 @@ namespace parma {
     init(m, s);
   }
 
+  Centroids::Centroids(apf::Mesh* m, Totals* t, Sides* s) {
+    weight = t->weight();
+    centroid = t->centroid();
+    init(m, s);
+  }
+
   apf::Vector3 Centroids::self() {
     return centroid;
   }
@@ -5,9 +5,11 @@
 
 namespace parma {
   class Sides;
+  class Totals;
   class Centroids : public Associative<apf::Vector3> {
     public:
       Centroids(apf::Mesh* m, apf::MeshTag* w, Sides* s);
+      Centroids(apf::Mesh* m, Totals* t, Sides* s);
       ~Centroids() {}
       apf::Vector3 self();
     private:
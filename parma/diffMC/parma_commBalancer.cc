@@ -0,0 +1,101 @@
+#include <PCU.h>
+#include <parma_balancer.h>
+#include "parma.h"
+#include "parma_step.h"
+#include "parma_sides.h"
+#include "parma_weights.h"
+#include "parma_targets.h"
+#include "parma_selector.h"
+#include "parma_stop.h"
+#include "parma_commons.h"
+#include "parma_convert.h"
+#include "parma_totals.h"
+#include <algorithm>
+
+namespace {
+  using parmaCommons::status;
+
+  /* steps without a better cost before giving up */
+  const int patience = 3;
+
+  /* balances elements while watching a cost that adds to the element
+     imbalance the growth of the largest part boundary and of the
+     largest neighbor count, both relative to the starting partition.
+     Weight only moves to lighter peers with small boundaries, and
+     stepping stops once the cost stops improving. */
+  class CommBalancer : public parma::Balancer {
+    private:
+      double commWeight;
+      int sideTol;
+      double shared0;
+      double nbors0;
+      double best;
+      int worse;
+      void getCommStats(double& shared, double& nbors) {
+        int loc, min, max;
+        long tot;
+        double avg;
+        Parma_GetSharedBdryVtxStats(mesh, loc, tot, min, max, avg);
+        shared = max;
+        int maxNbors, numMax;
+        Parma_GetNeighborStats(mesh, maxNbors, numMax, avg, loc);
+        nbors = maxNbors;
+      }
+      double getCost(double elmImb) {
+        double shared, nbors;
+        getCommStats(shared, nbors);
+        double penalty = (shared / shared0 - 1) + (nbors / nbors0 - 1);
+        if( !PCU_Comm_Self() && verbose )
+          status("elmImb %f maxShared %.0f maxNbors %.0f\n",
+              elmImb, shared, nbors);
+        return elmImb + commWeight * penalty;
+      }
+    public:
+      CommBalancer(apf::Mesh* m, double w, double f, int v)
+        : Balancer(m, f, v, "communication"), commWeight(w) {
+          parma::Sides* s = parma::makeVtxSides(mesh);
+          sideTol = TO_INT(parma::avgSharedSides(s));
+          delete s;
+          getCommStats(shared0, nbors0);
+          shared0 = std::max(shared0, 1.0);
+          nbors0 = std::max(nbors0, 1.0);
+          best = 0;
+          worse = -1;
+          if( !PCU_Comm_Self() && verbose )
+            status("commWeight %.3f sideTol %d\n", commWeight, sideTol);
+      }
+      bool runStep(apf::MeshTag* wtag, double tolerance) {
+        parma::Sides* s = parma::makeVtxSides(mesh);
+        parma::Totals* tot = getTotals(wtag);
+        parma::Weights* w = parma::makeElmWeights(mesh, wtag, s, tot);
+        double maxElmImb, avgElm;
+        parma::getImbalance(w, maxElmImb, avgElm);
+        double cost = getCost(maxElmImb);
+        if( !PCU_Comm_Self() && verbose )
+          status("cost %f\n", cost);
+        if( worse < 0 || cost < best ) {
+          best = cost;
+          worse = 0;
+        } else if( ++worse >= patience ) {
+          if( !PCU_Comm_Self() && verbose )
+            status("cost stalled at %f\n", best);
+          delete w;
+          delete s;
+          return false;
+        }
+        parma::Targets* t =
+          parma::makeWeightSideTargets(s, w, sideTol, factor);
+        parma::Selector* sel = parma::makeElmSelector(mesh, wtag);
+        parma::Stepper b(mesh, factor, s, w, t, sel, "elm", new parma::Less);
+        b.track(tot);
+        return b.step(tolerance, verbose);
+      }
+  };
+}
+
+apf::Balancer* Parma_MakeElmCommBalancer(apf::Mesh* m,
+    double commWeight, double stepFactor, int verbosity) {
+  if( !PCU_Comm_Self() && verbosity )
+    status("stepFactor %.3f\n", stepFactor);
+  return new CommBalancer(m, commWeight, stepFactor, verbosity);
+}
@@ -34,6 +34,7 @@ namespace parma {
     for(unsigned i=0; i<n; i++) 
       depth[i] = 0;
     idT = m->createIntTag("parmaVtxCompId",1);
+    m->chargeTag(idT, PCU_MEM_PARMA);
     markVertices();
     getCoreVerts();
     getCoreVtx();
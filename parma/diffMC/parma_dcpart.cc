@@ -3,11 +3,9 @@
 #include "parma_commons.h"
 #include "parma_meshaux.h"
 #include "parma_convert.h"
-#include <maximalIndependentSet/mis.h>
 #include <stdio.h>
-#include <set>
-#include <list>
 #include <map>
+#include <vector>
 #include <pcu_util.h>
 
 typedef std::map<unsigned, unsigned> muu;
@@ -16,6 +14,8 @@ dcPart::dcPart(apf::Mesh*& mesh, unsigned v)
   : m(mesh), verbose(v) {
    vtag = mesh->createIntTag("dcVisited",1);
    isotag = mesh->createIntTag("dcIsolated",1);
+   mesh->chargeTag(vtag, PCU_MEM_PARMA);
+   mesh->chargeTag(isotag, PCU_MEM_PARMA);
    numDisconnectedComps();
 }
 
@@ -47,23 +47,6 @@ bool dcPart::isIsolated(apf::MeshEntity* e) {
   return m->hasTag(e, isotag);
 }
 
-void dcPart::markIsolated(const unsigned dcComp) {
-  int one = 1;
-  int tval = -1;
-  apf::MeshEntity* elm;
-  apf::MeshIterator* itr = m->begin(m->getDimension());
-  while( (elm = m->iterate(itr)) ) {
-    if( m->hasTag(elm, vtag) ) {
-      m->getIntTag(elm, vtag, &tval);
-      if( tval == TO_INT(dcComp) ) {
-        m->removeTag(elm, vtag); //clear the dc comp id
-        m->setIntTag(elm, isotag, &one);
-      }
-    }
-  }
-  m->end(itr);
-}
-
 unsigned dcPart::getNumComps() {
   return TO_UINT(dcCompSz.size());
 }
@@ -99,25 +82,101 @@ void dcPart::reset() {
    numIso = 0;
 }
 
+namespace {
+  unsigned findRoot(std::vector<unsigned>& parent, unsigned i) {
+    while( parent[i] != i ) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  }
+}
+
+/**
+ * @brief label the components of the element graph
+ * @remark elements sharing a side are united into sets, then the
+ *         components are numbered in the order their first element
+ *         is iterated and the shared sides of each are counted by
+ *         part in one more pass over the elements
+ */
 unsigned dcPart::numDisconnectedComps() {
    double t1 = PCU_Time();
    reset();
+   const int dim = m->getDimension();
+   const unsigned self = TO_UINT(m->getId());
+   std::vector<apf::MeshEntity*> elms;
+   elms.reserve(m->count(dim));
+   apf::MeshEntity* e;
+   apf::MeshIterator* itr = m->begin(dim);
+   while( (e = m->iterate(itr)) ) {
+      const int idx = TO_INT(elms.size());
+      m->setIntTag(e, vtag, &idx);
+      elms.push_back(e);
+   }
+   m->end(itr);
+   const unsigned numElms = TO_UINT(elms.size());
+   std::vector<unsigned> parent(numElms);
+   for(unsigned i=0; i<numElms; i++)
+      parent[i] = i;
+   itr = m->begin(dim-1);
+   while( (e = m->iterate(itr)) ) {
+      const int nu = m->countUpward(e);
+      if( nu < 2 ) continue;
+      int a; m->getIntTag(m->getUpward(e, 0), vtag, &a);
+      for(int i=1; i<nu; i++) {
+         int b; m->getIntTag(m->getUpward(e, i), vtag, &b);
+         unsigned ra = findRoot(parent, TO_UINT(a));
+         unsigned rb = findRoot(parent, TO_UINT(b));
+         if( ra != rb )
+            parent[rb] = ra;
+      }
+   }
+   m->end(itr);
+   // components in order of their first element, as a walk would find them
+   std::vector<int> rootComp(numElms, -1);
+   std::vector<unsigned> comp(numElms);
+   std::vector<unsigned> sz;
+   std::vector<muu> bdryFaceCnt;
+   apf::Downward sides;
+   apf::Parts resPid;
+   for(unsigned i=0; i<numElms; i++) {
+      unsigned r = findRoot(parent, i);
+      if( rootComp[r] < 0 ) {
+         rootComp[r] = TO_INT(sz.size());
+         sz.push_back(0);
+         bdryFaceCnt.push_back(muu());
+      }
+      const unsigned c = TO_UINT(rootComp[r]);
+      comp[i] = c;
+      sz[c]++;
+      int ns = m->getDownward(elms[i], dim-1, sides);
+      for(int sIdx=0; sIdx<ns; sIdx++) {
+         if( ! m->isShared(sides[sIdx]) ) continue;
+         m->getResidence(sides[sIdx], resPid);
+         APF_ITERATE(apf::Parts, resPid, rp)
+            (bdryFaceCnt[c][TO_UINT(*rp)])++;
+      }
+   }
+   std::vector<int> dcId(sz.size(), -1);
    unsigned numDc = 0;
-   size_t count = 0;
-   unsigned self = TO_UINT(m->getId());
-   const size_t numElms = m->count(m->getDimension());
-   while( count != numElms ) {
-      unsigned sz = walkPart(numDc);
-      unsigned nbor = maxContactNeighbor(numDc);
+   for(unsigned c=0; c<sz.size(); c++) {
+      unsigned nbor = maxContactNeighbor(bdryFaceCnt[c]);
       if( nbor != self || PCU_Comm_Peers() == 1 ) {
-        dcCompSz.push_back(sz);
+        dcCompSz.push_back(sz[c]);
         dcCompNbor.push_back(nbor);
-        numDc++;
+        dcId[c] = TO_INT(numDc++);
       } else {
         numIso++;
-        markIsolated(numDc);
       }
-      count += sz;
+   }
+   int one = 1;
+   for(unsigned i=0; i<numElms; i++) {
+      if( dcId[comp[i]] < 0 ) {
+         m->removeTag(elms[i], vtag);
+         m->setIntTag(elms[i], isotag, &one);
+      } else {
+         m->setIntTag(elms[i], vtag, &(dcId[comp[i]]));
+      }
    }
    if( verbose )
      parmaCommons::printElapsedTime(__func__, PCU_Time() - t1);
@@ -125,65 +184,7 @@ unsigned dcPart::numDisconnectedComps() {
    return (numDc+numIso)-1;
 }
 
-unsigned dcPart::walkPart(unsigned visited) {
-   unsigned count = 0;
-   const int dim = m->getDimension();
-
-   std::list<apf::MeshEntity*> elms;
-   apf::MeshEntity* elm;
-   // find an untagged element
-   apf::MeshIterator* itr = m->begin(dim);
-   while( (elm = m->iterate(itr)) &&
-          ( m->hasTag(elm, vtag) || m->hasTag(elm, isotag) ) );
-   m->end(itr);
-   // start the walk
-   PCU_ALWAYS_ASSERT(elm);
-   elms.push_back(elm);
-   while( ! elms.empty() ) {
-      elm = elms.front();
-      elms.pop_front();
-      PCU_ALWAYS_ASSERT( elm != NULL );
-      if ( m->hasTag(elm, vtag) || m->hasTag(elm, isotag) ) continue;
-      const int dcId = TO_INT(visited);
-      m->setIntTag(elm, vtag, &dcId);
-      count++;
-      apf::Adjacent adjElms;
-      getDwn2ndAdj(m, elm, adjElms);
-      APF_ITERATE(apf::Adjacent, adjElms, eit)
-        if ( ! m->hasTag(*eit, vtag) )
-          elms.push_back(*eit);
-      PCU_ALWAYS_ASSERT( count <= TO_UINT(m->count(dim)) );
-   }
-   return count;
-}
-
-
-unsigned dcPart::maxContactNeighbor(const unsigned dcComp) {
-   // < dcComId, maxFace >
-   muu bdryFaceCnt;
-
-   const int dim = m->getDimension();
-   int tval;
-   apf::Downward sides;
-   apf::Parts resPid;
-
-   apf::MeshEntity* e;
-   apf::MeshIterator* itr = m->begin(dim);
-   while( (e = m->iterate(itr)) ) {
-      if( m->hasTag(e, vtag) ) {
-	 m->getIntTag(e, vtag, &tval);
-	 if( tval != TO_INT(dcComp) ) continue;
-         int ns = m->getDownward(e, dim-1, sides);
-         for(int sIdx=0; sIdx<ns; sIdx++) {
-           apf::MeshEntity* s = sides[sIdx];
-           if( ! m->isShared(s) ) continue;
-           m->getResidence(s, resPid);
-           APF_ITERATE(apf::Parts, resPid, rp)
-             (bdryFaceCnt[TO_UINT(*rp)])++;
-         }
-      }
-   }
-   m->end(itr);
+unsigned dcPart::maxContactNeighbor(muu& bdryFaceCnt) {
    unsigned max = 0;
    unsigned maxId = TO_UINT(m->getId());
    unsigned self = maxId;
@@ -3,6 +3,7 @@
 
 #include "apf.h"
 #include "apfMesh.h"
+#include <map>
 #include <vector>
 
 class dcPart {
@@ -23,9 +24,7 @@ class dcPart {
       void reset();
    private:
       dcPart() {}
-      unsigned walkPart(unsigned visited);
-      void markIsolated(const unsigned dcComp);
-      unsigned maxContactNeighbor(const unsigned dcComp);
+      unsigned maxContactNeighbor(std::map<unsigned, unsigned>& bdryFaceCnt);
 
       unsigned numIso;
       std::vector<unsigned> dcCompSz;
@@ -40,6 +39,8 @@ class dcPartFixer {
   public:
     dcPartFixer(apf::Mesh* mesh, unsigned verbose=0);
     ~dcPartFixer();
+    long getMovedComps();
+    long getMovedElms();
   private:
     dcPartFixer();
     class PartFixer;
@@ -2,96 +2,146 @@
 #include "parma_dcpart.h"
 #include "parma_commons.h"
 #include "parma_convert.h"
-#include <maximalIndependentSet/mis.h>
 #include <pcu_util.h>
+#include <map>
+#include <vector>
 
 typedef std::map<unsigned, unsigned> muu;
 
-namespace {
-  bool isInMis(muu& mt) {
-    unsigned seed = TO_UINT(PCU_Comm_Self()+1);
-    mis_init(seed);
-    misLuby::partInfo part;
-    part.id = PCU_Comm_Self();
-    std::set<int> targets;
-    APF_ITERATE(muu, mt, mtItr) {
-      int peer = TO_INT(mtItr->second);
-      if( !targets.count(peer) ) {
-        part.adjPartIds.push_back(peer);
-        part.net.push_back(peer);
-        targets.insert(peer);
-      }
-    }
-    part.net.push_back(part.id);
-    return mis(part,false,true);
-  }
-}
-
 class dcPartFixer::PartFixer : public dcPart {
   public:
     PartFixer(apf::Mesh* mesh, unsigned verbose=0) 
-      : dcPart(mesh,verbose), m(mesh), vb(verbose) 
+      : dcPart(mesh,verbose), movedComps(0), movedElms(0),
+        m(mesh), vb(verbose)
     {
       fix();
     }
+    long movedComps;
+    long movedElms;
 
   private:
     apf::Mesh* m;
     unsigned vb;
 
-    int totNumDc() {
-      int ndc = TO_INT(numDisconnectedComps());
-      return PCU_Add_Int(ndc);
+    /* the largest component stays in the part */
+    unsigned getCore() {
+      unsigned core = 0;
+      for(unsigned i=1; i<getNumComps(); i++)
+        if( getCompSize(i) > getCompSize(core) )
+          core = i;
+      return core;
+    }
+
+    /**
+     * @brief count the sides each component shares with the
+     *        cores of the neighboring parts
+     * @remark a component sent to a part whose core it touches is
+     *         connected there after the migration, since cores stay
+     */
+    void countCoreContacts(unsigned core, std::vector<muu>& contacts) {
+      const int dim = m->getDimension();
+      contacts.assign(getNumComps(), muu());
+      PCU_Comm_Begin();
+      apf::MeshEntity* s;
+      apf::MeshIterator* itr = m->begin(dim-1);
+      while( (s = m->iterate(itr)) ) {
+        if( ! m->isShared(s) || m->countUpward(s) != 1 ) continue;
+        apf::MeshEntity* e = m->getUpward(s, 0);
+        if( isIsolated(e) || compId(e) != core ) continue;
+        apf::Copies remotes;
+        m->getRemotes(s, remotes);
+        APF_ITERATE(apf::Copies, remotes, rp)
+          PCU_COMM_PACK(rp->first, rp->second);
+      }
+      m->end(itr);
+      PCU_Comm_Send();
+      while( PCU_Comm_Receive() ) {
+        PCU_COMM_UNPACK(s);
+        if( m->countUpward(s) != 1 ) continue;
+        apf::MeshEntity* e = m->getUpward(s, 0);
+        if( isIsolated(e) ) continue;
+        unsigned id = compId(e);
+        if( id != core )
+          (contacts[id][TO_UINT(PCU_Comm_Sender())])++;
+      }
     }
 
-    void setupPlan(muu& dcCompTgts, apf::Migration* plan) {
+    /**
+     * @brief send every component but the core to the part whose
+     *        core it shares the most sides with
+     * @return the number of components sent
+     */
+    int setupPlan(apf::Migration* plan, long& elms) {
+      elms = 0;
+      if( PCU_Comm_Peers() == 1 )
+        return 0;
+      unsigned core = getCore();
+      std::vector<muu> contacts;
+      countCoreContacts(core, contacts);
+      std::vector<int> tgts(getNumComps(), -1);
+      int comps = 0;
+      for(unsigned i=0; i<getNumComps(); i++) {
+        unsigned max = 0;
+        APF_ITERATE(muu, contacts[i], c)
+          if( c->second > max ) {
+            max = c->second;
+            tgts[i] = TO_INT(c->first);
+          }
+        if( tgts[i] >= 0 ) {
+          comps++;
+          elms += getCompSize(i);
+        }
+      }
       apf::MeshEntity* e;
       apf::MeshIterator* itr = m->begin(m->getDimension());
       while( (e = m->iterate(itr)) ) {
         if( isIsolated(e) ) continue;
-        unsigned id = compId(e);
-        if ( dcCompTgts.count(id) )
-          plan->send(e, TO_INT(dcCompTgts[id]));
+        int tgt = tgts[compId(e)];
+        if( tgt >= 0 )
+          plan->send(e, tgt);
       }
       m->end(itr);
+      return comps;
     }
 
     /**
      * @brief remove the disconnected set(s) of elements from the part
-     * @remark migrate the disconnected set(s) of elements into the adjacent part
-     *         that shares the most faces with the disconnected set of elements
-     *         requires that the sets of elements forming disconnected components
-     *         are tagged
+     * @remark all the components that touch the core of a neighboring
+     *         part go to the one they share the most sides with in a
+     *         single migration. Another migration is only needed for
+     *         components that touched no core of another part, which
+     *         may touch one once their neighbors have moved.
      */
     void fix() {
       double t1 = PCU_Time();
       int loop = 0;
-      int ndc = 0;
-      while( (ndc = totNumDc()) && loop++ < 50 ) {
+      while( loop++ < 50 ) {
         double t2 = PCU_Time();
-        muu dcCompTgts;
-
-        unsigned maxSz = 0;
-        for(unsigned i=0; i<getNumComps(); i++)
-          if( getCompSize(i) > maxSz )
-            maxSz = getCompSize(i);
-
-        for(unsigned i=0; i<getNumComps(); i++)
-          if( getCompSize(i) != maxSz )
-            dcCompTgts[i] = getCompPeer(i);
-        PCU_ALWAYS_ASSERT( dcCompTgts.size() == getNumComps()-1 );
         apf::Migration* plan = new apf::Migration(m);
-        if ( isInMis(dcCompTgts) )
-          setupPlan(dcCompTgts, plan);
-
+        long elms = 0;
+        long comps = PCU_Add_Long(setupPlan(plan, elms));
+        if( ! comps ) {
+          delete plan;
+          break;
+        }
+        elms = PCU_Add_Long(elms);
+        movedComps += comps;
+        movedElms += elms;
         reset();
         double t3 = PCU_Time();
         m->migrate(plan);
         if( ! PCU_Comm_Self() && vb)
           parmaCommons::status(
-              "loop %d components %d seconds <fix migrate> %.3f %.3f\n",
-              loop, ndc, t3-t2, PCU_Time()-t3);
+              "loop %d moved components %ld elements %ld "
+              "seconds <plan migrate> %.3f %.3f\n",
+              loop, comps, elms, t3-t2, PCU_Time()-t3);
+        numDisconnectedComps();
       }
+      long left = PCU_Add_Long(TO_LONG(getNumDcComps()));
+      if( ! PCU_Comm_Self() )
+        parmaCommons::status(
+            "%s moved %ld components %ld elements, %ld remain\n",
+            __func__, movedComps, movedElms, left);
       parmaCommons::printElapsedTime(__func__, PCU_Time() - t1);
     }
 };
@@ -102,3 +152,11 @@ dcPartFixer::dcPartFixer(apf::Mesh* mesh, unsigned verbose)
 dcPartFixer::~dcPartFixer() {
 delete pf;
 }
+
+long dcPartFixer::getMovedComps() {
+  return pf->movedComps;
+}
+
+long dcPartFixer::getMovedElms() {
+  return pf->movedElms;
+}
@@ -7,6 +7,7 @@
 #include "parma_targets.h"
 #include "parma_selector.h"
 #include "parma_commons.h"
+#include "parma_totals.h"
 
 namespace {
   using parmaCommons::status;
@@ -14,21 +15,24 @@ namespace {
   class ElmBalancer : public parma::Balancer {
     private:
       double sideTol;
+      bool flows;
     public:
-      ElmBalancer(apf::Mesh* m, double f, int v)
-        : Balancer(m, f, v, "elements") {
+      ElmBalancer(apf::Mesh* m, double f, int v, bool fl = false)
+        : Balancer(m, f, v, fl ? "element flows" : "elements"), flows(fl) {
           parma::Sides* s = parma::makeVtxSides(mesh);
           sideTol = parma::avgSharedSides(s);
           delete s;
       }
       bool runStep(apf::MeshTag* wtag, double tolerance) {
-        const double maxElmImb =
-          Parma_GetWeightedEntImbalance(mesh, wtag, mesh->getDimension());
         parma::Sides* s = parma::makeVtxSides(mesh);
         double avgSides = parma::avgSharedSides(s);
-        parma::Weights* w =
-          parma::makeEntWeights(mesh, wtag, s, mesh->getDimension());
-        parma::Targets* t = parma::makeTargets(s, w, factor);
+        parma::Totals* tot = getTotals(wtag);
+        parma::Weights* w = parma::makeElmWeights(mesh, wtag, s, tot);
+        double maxElmImb, avgElm;
+        parma::getImbalance(w, maxElmImb, avgElm);
+        parma::Targets* t = flows ?
+          parma::makeFlowTargets(s, w, factor) :
+          parma::makeTargets(s, w, factor);
         parma::Selector* sel = parma::makeElmSelector(mesh, wtag);
 
         monitorUpdate(maxElmImb, iS, iA);
@@ -39,6 +43,7 @@ namespace {
           new parma::BalOrStall(iA, sA, sideTol*.001, verbose);
 
         parma::Stepper b(mesh, factor, s, w, t, sel, "elm", stopper);
+        b.track(tot);
         return b.step(tolerance, verbose);
       }
   };
@@ -50,3 +55,10 @@ apf::Balancer* Parma_MakeElmBalancer(apf::Mesh* m,
     status("stepFactor %.3f\n", stepFactor);
   return new ElmBalancer(m, stepFactor, verbosity);
 }
+
+apf::Balancer* Parma_MakeElmFlowBalancer(apf::Mesh* m,
+    double stepFactor, int verbosity) {
+  if( !PCU_Comm_Self() && verbosity )
+    status("stepFactor %.3f\n", stepFactor);
+  return new ElmBalancer(m, stepFactor, verbosity, true);
+}
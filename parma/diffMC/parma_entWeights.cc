@@ -2,6 +2,8 @@
 #include <PCU.h>
 #include "parma_entWeights.h"
 #include "parma_sides.h"
+#include "parma_totals.h"
+#include "parma_capacity.h"
 
 namespace parma {  
   double getMaxWeight(apf::Mesh* m, apf::MeshTag* w, int entDim) {
@@ -14,8 +16,36 @@ namespace parma {
     return PCU_Add_Double(locW) / PCU_Comm_Peers();
   }
 
+  /* sums whole arrays of weights when the mesh allows it */
+  static bool getSpanWeight(apf::Mesh* m, apf::MeshTag* w, int entDim,
+      double& sum) {
+    if (m->getTagSize(w) != 1)
+      return false;
+    std::size_t spanned = 0;
+    for (int t = 0; t < apf::Mesh::TYPES; ++t)
+      if (apf::Mesh::typeDimension[t] == entDim)
+        spanned += m->countTagSpan(t);
+    if (spanned != m->count(entDim))
+      return false;
+    sum = 0;
+    for (int t = 0; t < apf::Mesh::TYPES; ++t) {
+      if (apf::Mesh::typeDimension[t] != entDim)
+        continue;
+      int n = m->countTagSpan(t);
+      if (!n)
+        continue;
+      double const* weights = m->getDoubleTagSpan(w, t, 0, n);
+      for (int i = 0; i < n; ++i)
+        sum += weights[i];
+    }
+    return true;
+  }
+
   double getWeight(apf::Mesh* m, apf::MeshTag* w, int entDim) {
     PCU_ALWAYS_ASSERT(entDim >= 0 && entDim <= 3);
+    double spanSum;
+    if (getSpanWeight(m, w, entDim, spanSum))
+      return spanSum;
     apf::MeshIterator* it = m->begin(entDim);
     apf::MeshEntity* e;
     double sum = 0;
@@ -27,7 +57,8 @@ namespace parma {
 
   void getImbalance(Weights* w, double& imb, double& avg) {
     double sum, max;
-    sum = max = w->self();
+    sum = w->self();
+    max = sum / getCapacity(PCU_Comm_Self());
     sum = PCU_Add_Double(sum);
     max = PCU_Max_Double(max);
     avg = sum/PCU_Comm_Peers();
@@ -52,6 +83,12 @@ namespace parma {
     weight = getWeight(m, w, entDim);
     init(m, w, s);
   }
+  EntWeights::EntWeights(apf::Mesh* m, apf::MeshTag* w, Sides* s, int d,
+      double selfWeight)
+    : Weights(m, w, s), entDim(d), weight(selfWeight)
+  {
+    init(m, w, s);
+  }
   double EntWeights::self() {
     return weight;
   }
@@ -80,6 +117,9 @@ namespace parma {
   Weights* makeEntWeights(apf::Mesh* m, apf::MeshTag* w, Sides* s, int dim) {
     return new EntWeights(m, w, s, dim);
   }
+  Weights* makeElmWeights(apf::Mesh* m, apf::MeshTag* w, Sides* s, Totals* t) {
+    return new EntWeights(m, w, s, m->getDimension(), t->weight());
+  }
 
 
 } //end namespace
@@ -5,6 +5,8 @@ namespace parma {
   class EntWeights : public Weights {
     public:
       EntWeights(apf::Mesh* m, apf::MeshTag* w, Sides* s, int d);
+      EntWeights(apf::Mesh* m, apf::MeshTag* w, Sides* s, int d,
+          double selfWeight);
       double self();
     private:
       EntWeights();
@@ -0,0 +1,98 @@
+#include <PCU.h>
+#include <cmath>
+#include <algorithm>
+#include "parma_sides.h"
+#include "parma_weights.h"
+#include "parma_targets.h"
+#include "parma_capacity.h"
+
+namespace {
+  /* how close to the average weight the planned flows take every part,
+     and how many diffusion rounds may be spent getting there */
+  const double flowTol = 0.01;
+  const int maxFlowRounds = 1000;
+  const int roundsPerCheck = 10;
+
+  template <class T>
+  void exchange(parma::Sides* s, T mine, parma::Associative<T>& theirs) {
+    PCU_Comm_Begin();
+    const parma::Sides::Item* side;
+    s->begin();
+    while( (side = s->iterate()) )
+      PCU_COMM_PACK(side->first, mine);
+    s->end();
+    PCU_Comm_Send();
+    while (PCU_Comm_Receive()) {
+      T v;
+      PCU_COMM_UNPACK(v);
+      theirs.set(PCU_Comm_Sender(), v);
+    }
+  }
+}
+
+namespace parma {
+  /* Instead of moving a fraction of the weight difference to each
+     neighbor, the flow over each edge of the part graph is planned
+     by running first-order diffusion on the part weights alone until
+     they are balanced. The flows summed over those rounds carry a
+     spike's surplus past its immediate neighbors, so weight that must
+     go several hops starts moving in the first step, and the few
+     scalars exchanged per round are much cheaper than a migration.
+     With capacities the diffusion evens weight over capacity, and
+     the flows stay in units of weight. */
+  class FlowTargets : public Targets {
+    public:
+      FlowTargets(Sides* s, Weights* w, double alpha) {
+        init(s, w, alpha);
+      }
+      double total() {
+        return totW;
+      }
+    private:
+      FlowTargets();
+      double totW;
+      void init(Sides* s, Weights* w, double alpha) {
+        const double capacity = getCapacity(PCU_Comm_Self());
+        double load = w->self() / capacity;
+        const double avg = PCU_Add_Double(w->self()) / PCU_Comm_Peers();
+        const int degree = static_cast<int>(s->size());
+        Associative<int> degrees;
+        exchange(s, degree, degrees);
+        Associative<double> flows;
+        Associative<double> loads;
+        const Sides::Item* side;
+        for (int round = 0; round < maxFlowRounds; ++round) {
+          if (round % roundsPerCheck == 0 &&
+              PCU_Max_Double(fabs(load - avg)) <= flowTol * avg)
+            break;
+          exchange(s, load, loads);
+          double out = 0;
+          s->begin();
+          while( (side = s->iterate()) ) {
+            const int peer = side->first;
+            const int maxDegree = std::max(degree, degrees.get(peer));
+            const double peerCapacity = getCapacity(peer);
+            const double f = (load - loads.get(peer)) / (maxDegree + 1) *
+              (2 * capacity * peerCapacity / (capacity + peerCapacity));
+            flows.set(peer, flows.get(peer) + f);
+            out += f;
+          }
+          s->end();
+          load -= out / capacity;
+        }
+        totW = 0;
+        s->begin();
+        while( (side = s->iterate()) ) {
+          const double f = flows.get(side->first);
+          if (f > 0) {
+            set(side->first, f * alpha);
+            totW += f * alpha;
+          }
+        }
+        s->end();
+      }
+  };
+  Targets* makeFlowTargets(Sides* s, Weights* w, double alpha) {
+    return new FlowTargets(s,w,alpha);
+  }
+} //end namespace
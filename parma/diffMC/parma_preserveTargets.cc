@@ -2,6 +2,7 @@
 #include "parma_sides.h"
 #include "parma_weights.h"
 #include "parma_targets.h"
+#include "parma_capacity.h"
 namespace parma {
   class PreserveTargets : public Targets {
     public:
@@ -26,10 +27,11 @@ namespace parma {
           const double selfBalW = balance->self();
           const double peerBalW = balance->get(peer);
           const int peerSides = s->get(peer);
-          if( selfBalW > peerBalW  &&
+          const double difference =
+            getLoadDifference(peer, selfBalW, peerBalW);
+          if( difference > 0 &&
               peerPresW < preserveTol &&
               peerSides < sideTol ) {
-            const double difference = selfBalW - peerBalW;
             double sideFraction = side->second;
             sideFraction /= s->total();
             double scaledW = difference * sideFraction * alpha;
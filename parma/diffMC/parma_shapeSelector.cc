@@ -5,51 +5,9 @@
 #include "parma_selector.h"
 #include "parma_targets.h"
 #include "parma_weights.h"
-#include "parma_convert.h"
-#include <stdlib.h>
-
-typedef unsigned uint;
-typedef std::map<uint,uint> muu;
+#include "parma_cavityPeers.h"
 
 namespace {
-  struct UintArr {
-    uint s; //size of d array
-    uint l; //used entries in d
-    uint d[1];
-  };
-
-  UintArr* makeUintArr(uint n) {
-    UintArr* a =
-      static_cast<UintArr*>(malloc(sizeof(UintArr) + sizeof(uint)*(n-1)));
-    a->s = n;
-    a->l = 0;
-    return a;
-  }
-  void destroy(UintArr* u) {
-    free(u);
-  }
-
-  void getCavityPeers(apf::Mesh* m, apf::MeshEntity* v, UintArr* peers) {
-    muu pc;
-    apf::Adjacent sideSides;
-    m->getAdjacent(v, m->getDimension()-2, sideSides);
-    APF_ITERATE(apf::Adjacent, sideSides, ss) {
-      apf::Copies rmts;
-      m->getRemotes(*ss,rmts);
-      APF_ITERATE(apf::Copies, rmts, r)
-         pc[TO_UINT(r->first)]++;
-    }
-    uint max = 0;
-    APF_ITERATE(muu, pc, p)
-      if( p->second > max )
-         max = p->second;
-    PCU_ALWAYS_ASSERT( peers->s >= pc.size() );
-    peers->l=0;
-    APF_ITERATE(muu, pc, p)
-      if( p->second == max )
-        peers->d[peers->l++] = p->first;
-  }
-
   void getCavity(apf::Mesh* m, apf::MeshEntity* v, apf::Migration* plan,
       apf::Up& cavity) {
     cavity.n = 0;
@@ -92,25 +50,28 @@ namespace {
        */
       apf::Migration* run(parma::Targets* tgts) {
         apf::Migration* plan = new apf::Migration(mesh);
-        apf::Up cavity;
-        UintArr* peers = makeUintArr(1024);
+        std::vector<apf::MeshEntity*> verts;
         apf::MeshEntity* e;
         apf::MeshIterator* it = mesh->begin(0);
         while( (e = mesh->iterate(it)) ) {
           if( !mesh->isShared(e) ) continue;
           if( !sharedWithTarget(mesh,e,tgts) ) continue;
-          getCavity(mesh, e, plan, cavity);
-          getCavityPeers(mesh,e,peers);
-          for( uint i=0; i<peers->l; i++ ) {
-            int destPid = TO_INT(peers->d[i]);
+          verts.push_back(e);
+        }
+        mesh->end(it);
+        std::vector<parma::Peers> peers;
+        parma::getCavityPeers(mesh, verts, peers);
+        apf::Up cavity;
+        for( size_t v=0; v<verts.size(); v++ ) {
+          getCavity(mesh, verts[v], plan, cavity);
+          for( size_t i=0; i<peers[v].size(); i++ ) {
+            int destPid = peers[v][i];
             if( !tgts->has(destPid) ) {
               add(cavity, destPid, plan);
               break;
             }
           }
         }
-        destroy(peers);
-        mesh->end(it);
         return plan;
       }
   };
@@ -6,6 +6,7 @@
 #include "parma_targets.h"
 #include "parma_selector.h"
 #include "parma_stop.h"
+#include "parma_totals.h"
 #include "parma_commons.h"
 
 namespace parma {
@@ -15,7 +16,7 @@ namespace parma {
      Sides* s, Weights* w, Targets* t, Selector* sel,
      const char* entType, Stop* stopper)
     : m(mIn), alpha(alphaIn), sides(s), weights(w), targets(t),
-    selects(sel), name(entType), stop(stopper) {
+    selects(sel), name(entType), stop(stopper), totals(0) {
       verbose = 0;
   }
 
@@ -36,6 +37,8 @@ namespace parma {
       return false;
     apf::Migration* plan = selects->run(targets);
     int planSz = PCU_Add_Int(plan->count());
+    if (totals)
+      totals->migrate(plan);
     const double t0 = PCU_Time();
     m->migrate(plan);
     if ( !PCU_Comm_Self() && verbosity )
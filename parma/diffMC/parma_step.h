@@ -9,6 +9,7 @@ namespace parma {
   class Weights;
   class Targets;
   class Selector;
+  class Totals;
   class Stepper {
     public:
       Stepper(apf::Mesh* mIn, double alphaIn,
@@ -16,6 +17,8 @@ namespace parma {
         const char* entType, Stop* stopper = new Less);
       virtual ~Stepper();
       bool step(double maxImb, int verbosity=0);
+      /* update (t) with the plan of each step */
+      void track(Totals* t) { totals = t; }
     private:
       Stepper();
       apf::Mesh* m;
@@ -27,6 +30,7 @@ namespace parma {
       Selector* selects;
       const char* name;
       Stop* stop;
+      Totals* totals;
   };
 }
 #endif
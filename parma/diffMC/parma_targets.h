@@ -14,6 +14,7 @@ namespace parma {
       virtual double total()=0;
   };
   Targets* makeTargets(Sides* s, Weights* w, double alpha);
+  Targets* makeFlowTargets(Sides* s, Weights* w, double alpha);
   Targets* makePreservingTargets(Sides* s, Weights* balanceW, Weights* preserveW,
       int sideTol, double vtxTol, double alpha);
   Targets* makeWeightSideTargets(Sides* s, Weights* w, int sideTol,
@@ -0,0 +1,87 @@
+#include <PCU.h>
+#include <apf.h>
+#include "parma_totals.h"
+#include "parma_weights.h"
+#include <map>
+
+namespace {
+  struct Outgoing {
+    Outgoing() : w(0), x(0,0,0) {}
+    double w;
+    apf::Vector3 x;
+  };
+  typedef std::map<int, Outgoing> Outgoings;
+}
+
+namespace parma {
+  Totals::Totals(apf::Mesh* m, apf::MeshTag* wt)
+    : mesh(m), wtag(wt) {
+    sweep();
+  }
+
+  void Totals::sweep() {
+    w = 0;
+    x = apf::Vector3(0,0,0);
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = mesh->begin(mesh->getDimension());
+    while ((e = mesh->iterate(it))) {
+      const double ew = getEntWeight(mesh, e, wtag);
+      w += ew;
+      x = x + apf::getLinearCentroid(mesh, e) * ew;
+    }
+    mesh->end(it);
+    stale = false;
+  }
+
+  /* the totals leaving for each part are sent there, so the
+     cost is in the planned elements rather than the part */
+  void Totals::migrate(apf::Migration* plan) {
+    if (stale)
+      sweep();
+    /* the elements covered by send(int) are not listed */
+    if (plan->sendingAll() != -1) {
+      stale = true;
+      return;
+    }
+    const int self = PCU_Comm_Self();
+    Outgoings out;
+    for (int i = 0; i < plan->count(); ++i) {
+      apf::MeshEntity* e = plan->get(i);
+      const int to = plan->sending(e);
+      if (to == self)
+        continue;
+      const double ew = getEntWeight(mesh, e, wtag);
+      Outgoing& o = out[to];
+      o.w += ew;
+      o.x = o.x + apf::getLinearCentroid(mesh, e) * ew;
+    }
+    PCU_Comm_Begin();
+    APF_ITERATE(Outgoings, out, o) {
+      w -= o->second.w;
+      x = x - o->second.x;
+      PCU_COMM_PACK(o->first, o->second.w);
+      PCU_COMM_PACK(o->first, o->second.x);
+    }
+    PCU_Comm_Send();
+    while (PCU_Comm_Receive()) {
+      double inW;
+      apf::Vector3 inX;
+      PCU_COMM_UNPACK(inW);
+      PCU_COMM_UNPACK(inX);
+      w += inW;
+      x = x + inX;
+    }
+  }
+
+  double Totals::weight() {
+    if (stale)
+      sweep();
+    return w;
+  }
+
+  apf::Vector3 Totals::centroid() {
+    if (stale)
+      sweep();
+    return x / w;
+  }
+}
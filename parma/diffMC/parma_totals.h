@@ -0,0 +1,27 @@
+#ifndef PARMA_TOTALS_H
+#define PARMA_TOTALS_H
+#include <apfMesh.h>
+
+namespace parma {
+  /* the part's element weight and weighted centroid sum, kept across
+     steps by applying each migration plan to them instead of
+     sweeping the part again */
+  class Totals {
+    public:
+      Totals(apf::Mesh* m, apf::MeshTag* w);
+      /* call with the plan before it is migrated */
+      void migrate(apf::Migration* plan);
+      double weight();
+      apf::Vector3 centroid();
+    private:
+      Totals();
+      void sweep();
+      apf::Mesh* mesh;
+      apf::MeshTag* wtag;
+      double w;
+      apf::Vector3 x;
+      bool stale;
+  };
+}
+
+#endif
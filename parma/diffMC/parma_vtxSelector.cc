@@ -9,50 +9,8 @@
 #include "parma_commons.h"
 #include "parma_convert.h"
 #include <apf.h>
-#include <cstdlib>
-
-typedef unsigned int uint;
-typedef std::map<uint,uint> muu;
 
 namespace {
-  struct UintArr {
-    uint s; //size of d array
-    uint l; //used entries in d
-    uint d[1];
-  };
-
-  UintArr* makeUintArr(uint n) {
-    UintArr* a = 
-      static_cast<UintArr*>(malloc(sizeof(UintArr) + sizeof(uint)*(n-1)));
-    a->s = n;
-    a->l = 0;
-    return a;
-  }
-  void destroy(UintArr* u) {
-    free(u);
-  }
-
-  UintArr* getCavityPeers(apf::Mesh* m, apf::MeshEntity* v) {
-    muu pc;
-    apf::Adjacent sideSides;
-    m->getAdjacent(v, m->getDimension()-2, sideSides);
-    APF_ITERATE(apf::Adjacent, sideSides, ss) {
-      apf::Copies rmts;
-      m->getRemotes(*ss,rmts);
-      APF_ITERATE(apf::Copies, rmts, r)
-         pc[TO_UINT(r->first)]++;
-    }
-    uint max = 0;
-    APF_ITERATE(muu, pc, p)
-      if( p->second > max )
-         max = p->second;
-    UintArr* peers = makeUintArr(TO_UINT(pc.size()));
-    APF_ITERATE(muu, pc, p)
-      if( p->second == max )
-        peers->d[peers->l++] = p->first;
-    return peers;
-  }
-
   typedef std::map<apf::MeshEntity*,unsigned> meu;
   // construct a map of <faces, occurances in cavity>
   meu* getCavityFaces(apf::Mesh* m, apf::Up& cavity) {
@@ -99,11 +57,21 @@ namespace {
 
 namespace parma {
   VtxSelector::VtxSelector(apf::Mesh* m, apf::MeshTag* w)
-    : Selector(m, w)
+    : Selector(m, w), scored(false)
   {
     dist = measureGraphDist(m);
   }
 
+  void VtxSelector::score() {
+    BdryVtxItr* it = makeBdryVtxDistItr(mesh, dist);
+    apf::MeshEntity* e;
+    while( (e = it->next()) )
+      bdryVerts.push_back(e);
+    delete it;
+    getCavityPeers(mesh, bdryVerts, bdryPeers);
+    scored = true;
+  }
+
   VtxSelector::~VtxSelector() { }
 
   apf::Migration* VtxSelector::run(Targets* tgts) {
@@ -127,17 +95,18 @@ namespace parma {
 
   double VtxSelector::select(Targets* tgts, apf::Migration* plan, double planW,
       int maxSize) {
-    BdryVtxItr* bdryVerts = makeBdryVtxDistItr(mesh, dist);
+    if( !scored )
+      score();
     apf::Up cavity;
-    apf::MeshEntity* e;
     unsigned dcCnt = 0;
-    while( (e = bdryVerts->next()) ) {
+    for( size_t v=0; v<bdryVerts.size(); v++ ) {
       if( planW > tgts->total() ) break;
+      apf::MeshEntity* e = bdryVerts[v];
+      Peers& peers = bdryPeers[v];
       getCavity(mesh, e, plan, cavity);
-      UintArr* peers = getCavityPeers(mesh,e);
       bool sent = false;
-      for( uint i=0; i<peers->l; i++ ) {
-        int destPid = TO_INT(peers->d[i]);
+      for( size_t i=0; i<peers.size(); i++ ) {
+        int destPid = peers[i];
         if( tgts->has(destPid) &&
             sending[destPid] < tgts->get(destPid) &&
             cavity.n <= maxSize ) {
@@ -149,17 +118,15 @@ namespace parma {
         }
       }
       if( !sent && disconnected(mesh, plan, cavity) ) {
-        PCU_ALWAYS_ASSERT(peers->l);
-        int destPid = TO_INT(peers->d[0]);
+        PCU_ALWAYS_ASSERT(peers.size());
+        int destPid = peers[0];
         dcCnt++;
         double ew = add(e, cavity, destPid, plan);
         sending[destPid] += ew;
         planW += ew;
       }
-      destroy(peers);
     }
     PCU_Debug_Print("sent %u disconnected cavities\n", dcCnt);
-    delete bdryVerts;
     return planW;
   }
 
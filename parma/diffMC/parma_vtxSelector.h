@@ -2,7 +2,9 @@
 #define PARMA_VTXSELECTOR_H
 
 #include <map>
+#include <vector>
 #include "parma_selector.h"
+#include "parma_cavityPeers.h"
 
 namespace parma {
   typedef std::map<int,double> Mid;
@@ -22,6 +24,12 @@ namespace parma {
       apf::MeshTag* dist;
       VtxSelector();
       Mid sending;
+      /* the boundary vertices in distance order and their cavity
+         peers, found once for all the select() passes */
+      void score();
+      std::vector<apf::MeshEntity*> bdryVerts;
+      std::vector<Peers> bdryPeers;
+      bool scored;
   };
 }
 
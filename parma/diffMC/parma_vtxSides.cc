@@ -1,5 +1,6 @@
 #include "parma_sides.h"
 #include <apf.h>
+#include "parma_convert.h"
 
 namespace parma {  
   class VtxSides : public Sides {
@@ -9,12 +10,14 @@ namespace parma {
       }
     private:
       void init(apf::Mesh* m) {
+        if (m->hasSharedLists()) {
+          initFromLists(m);
+          return;
+        }
         apf::MeshEntity* s;
         apf::MeshIterator* it = m->begin(0);
         totalSides = 0;
         while ((s = m->iterate(it))) {
-	  apf::Adjacent adj;
-          m->getAdjacent(s,m->getDimension(),adj);
           if ( m->isShared(s) ) {
             apf::Copies rmts;
             m->getRemotes(s, rmts);
@@ -25,6 +28,24 @@ namespace parma {
 	}
         m->end(it);
       }
+      /* only visits the part boundary. A vertex shared with several
+         peers is counted once, from the list of its lowest peer */
+      void initFromLists(apf::Mesh* m) {
+        totalSides = 0;
+        apf::Parts peers;
+        m->getSharedPeers(0, peers);
+        APF_ITERATE(apf::Parts, peers, p) {
+          apf::DynamicArray<apf::MeshEntity*> shared;
+          m->getSharedWith(0, *p, shared);
+          set(*p, TO_INT(shared.getSize()));
+          for (size_t i = 0; i < shared.getSize(); ++i) {
+            apf::Copies rmts;
+            m->getRemotes(shared[i], rmts);
+            if (rmts.begin()->first == *p)
+              ++totalSides;
+          }
+        }
+      }
   };
 
   Sides* makeVtxSides(apf::Mesh* m) {
@@ -2,6 +2,7 @@
 #include "parma_sides.h"
 #include "parma_weights.h"
 #include "parma_targets.h"
+#include "parma_capacity.h"
 namespace parma {
   class WeightSideTargets : public Targets {
     public:
@@ -23,9 +24,9 @@ namespace parma {
           const int peer = side->first;
           const double peerW = w->get(peer);
           const int peerSides = s->get(peer);
-          if( selfW > peerW && 
+          const double difference = getLoadDifference(peer, selfW, peerW);
+          if( difference > 0 &&
               peerSides < sideTol ) {
-            const double difference = selfW - peerW;
             double sideFraction = side->second;
             sideFraction /= s->total();
             double scaledW = difference * sideFraction * alpha;
@@ -1,6 +1,7 @@
 #include "parma_sides.h"
 #include "parma_weights.h"
 #include "parma_targets.h"
+#include "parma_capacity.h"
 namespace parma {
   class WeightTargets : public Targets {
     public:
@@ -21,8 +22,8 @@ namespace parma {
           const int peer = side->first;
           const double selfW = w->self();
           const double peerW = w->get(peer);
-          if ( selfW > peerW ) {
-            const double difference = selfW - peerW;
+          const double difference = getLoadDifference(peer, selfW, peerW);
+          if ( difference > 0 ) {
             double sideFraction = side->second;
             sideFraction /= s->total();
             double scaledW = difference * sideFraction * alpha;
@@ -15,6 +15,9 @@ namespace parma {
   };
   class GhostWeights;
   Weights* makeEntWeights(apf::Mesh* m, apf::MeshTag* w, Sides* s, int dim);
+  class Totals;
+  /* element weights with the part's own from (t) */
+  Weights* makeElmWeights(apf::Mesh* m, apf::MeshTag* w, Sides* s, Totals* t);
   Weights* makeGhostMPASWeights(apf::Mesh* m, apf::MeshTag* w, Sides* s,
       int layers, int bridge);
   GhostWeights* makeVtxGhostWeights(apf::Mesh* m, apf::MeshTag* w, Sides* s,
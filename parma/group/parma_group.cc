@@ -7,11 +7,7 @@ static void retreat(apf::Mesh2* m, Remap& remap)
 {
   int to = remap(PCU_Comm_Self());
   apf::Migration* plan = new apf::Migration(m);
-  apf::MeshIterator* it = m->begin(m->getDimension());
-  apf::MeshEntity* e;
-  while ((e = m->iterate(it)))
-    plan->send(e, to);
-  m->end(it);
+  plan->send(to);
   apf::migrateSilent(m, plan);
 }
 
@@ -0,0 +1,192 @@
+#include <PCU.h>
+#include <parma.h>
+#include <pcu_util.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+/* places parts on ranks so that the pairs of parts sharing the most
+   vertices end up on the same node. Rank 0 gathers the part graph
+   and fills one node at a time, starting from a part already on the
+   node and adding the part most connected to the node's parts. */
+
+namespace {
+
+typedef std::map<int, int> PeerCounts;
+typedef std::map<int, std::vector<int> > NodeRanks;
+
+/* shared vertices with each neighboring part */
+void countShared(apf::Mesh* m, PeerCounts& counts)
+{
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    if (!m->isShared(v))
+      continue;
+    apf::Copies remotes;
+    m->getRemotes(v, remotes);
+    APF_ITERATE(apf::Copies, remotes, rit)
+      ++counts[rit->first];
+  }
+  m->end(it);
+}
+
+/* the node of each rank, named by its lowest rank */
+int getNode(int ranksPerNode)
+{
+  int self = PCU_Comm_Self();
+  if (ranksPerNode > 0)
+    return self / ranksPerNode * ranksPerNode;
+  MPI_Comm nodeComm;
+  MPI_Comm_split_type(PCU_Get_Comm(), MPI_COMM_TYPE_SHARED, self,
+      MPI_INFO_NULL, &nodeComm);
+  int node = self;
+  MPI_Bcast(&node, 1, MPI_INT, 0, nodeComm);
+  MPI_Comm_free(&nodeComm);
+  return node;
+}
+
+struct Graph
+{
+  /* compressed neighbor lists of each part */
+  std::vector<int> offsets;
+  std::vector<int> peers;
+  std::vector<int> weights;
+};
+
+void gatherGraph(PeerCounts& counts, Graph& g)
+{
+  int peers = PCU_Comm_Peers();
+  MPI_Comm comm = PCU_Get_Comm();
+  std::vector<int> local;
+  APF_ITERATE(PeerCounts, counts, it) {
+    local.push_back(it->first);
+    local.push_back(it->second);
+  }
+  int n = local.size();
+  std::vector<int> sizes(peers);
+  MPI_Gather(&n, 1, MPI_INT, &sizes[0], 1, MPI_INT, 0, comm);
+  std::vector<int> displs(peers + 1, 0);
+  for (int i = 0; i < peers; ++i)
+    displs[i + 1] = displs[i] + sizes[i];
+  std::vector<int> all(PCU_Comm_Self() ? 0 : displs[peers] + 1);
+  MPI_Gatherv(local.empty() ? 0 : &local[0], n, MPI_INT,
+      all.empty() ? 0 : &all[0], &sizes[0], &displs[0], MPI_INT, 0, comm);
+  if (PCU_Comm_Self())
+    return;
+  g.offsets.resize(peers + 1);
+  for (int i = 0; i <= peers; ++i)
+    g.offsets[i] = displs[i] / 2;
+  for (int i = 0; i < displs[peers]; i += 2) {
+    g.peers.push_back(all[i]);
+    g.weights.push_back(all[i + 1]);
+  }
+}
+
+/* shared vertices between parts on different nodes, counted once */
+long countOffNode(Graph& g, std::vector<int>& rankOf,
+    std::vector<int>& nodeOf)
+{
+  long off = 0;
+  for (size_t p = 0; p + 1 < g.offsets.size(); ++p)
+    for (int i = g.offsets[p]; i < g.offsets[p + 1]; ++i)
+      if (nodeOf[rankOf[p]] != nodeOf[rankOf[g.peers[i]]])
+        off += g.weights[i];
+  return off / 2;
+}
+
+/* greedily fills the ranks of each node with connected parts.
+   Parts already on a node are preferred when connections tie, so
+   a good placement moves few parts. */
+void mapParts(Graph& g, std::vector<int>& nodeOf, std::vector<int>& rankOf)
+{
+  int peers = nodeOf.size();
+  NodeRanks nodeRanks;
+  for (int r = 0; r < peers; ++r)
+    nodeRanks[nodeOf[r]].push_back(r);
+  std::vector<bool> placed(peers, false);
+  std::vector<long> gain(peers);
+  rankOf.assign(peers, -1);
+  APF_ITERATE(NodeRanks, nodeRanks, nit) {
+    int node = nit->first;
+    std::vector<int> const& ranks = nit->second;
+    std::vector<int> members;
+    gain.assign(peers, 0);
+    while (members.size() < ranks.size()) {
+      int best = -1;
+      for (int p = 0; p < peers; ++p) {
+        if (placed[p])
+          continue;
+        if (best < 0 || gain[p] > gain[best] ||
+            (gain[p] == gain[best] &&
+             nodeOf[p] == node && nodeOf[best] != node))
+          best = p;
+      }
+      placed[best] = true;
+      members.push_back(best);
+      for (int i = g.offsets[best]; i < g.offsets[best + 1]; ++i)
+        gain[g.peers[i]] += g.weights[i];
+    }
+    /* parts whose rank is on this node stay, the rest take
+       the free ranks in order */
+    std::vector<bool> taken(peers, false);
+    for (size_t i = 0; i < members.size(); ++i)
+      if (nodeOf[members[i]] == node) {
+        rankOf[members[i]] = members[i];
+        taken[members[i]] = true;
+      }
+    size_t next = 0;
+    for (size_t i = 0; i < members.size(); ++i) {
+      if (rankOf[members[i]] >= 0)
+        continue;
+      while (taken[ranks[next]])
+        ++next;
+      rankOf[members[i]] = ranks[next];
+      taken[ranks[next]] = true;
+    }
+  }
+}
+
+}
+
+void Parma_MapToTopology(apf::Mesh2* m, int ranksPerNode, int verbosity)
+{
+  double t0 = PCU_Time();
+  int self = PCU_Comm_Self();
+  int peers = PCU_Comm_Peers();
+  int node = getNode(ranksPerNode);
+  std::vector<int> nodeOf(peers);
+  MPI_Allgather(&node, 1, MPI_INT, &nodeOf[0], 1, MPI_INT, PCU_Get_Comm());
+  PeerCounts counts;
+  countShared(m, counts);
+  Graph g;
+  gatherGraph(counts, g);
+  std::vector<int> rankOf(peers);
+  if (!self) {
+    std::vector<int> identity(peers);
+    for (int p = 0; p < peers; ++p)
+      identity[p] = p;
+    long before = countOffNode(g, identity, nodeOf);
+    mapParts(g, nodeOf, rankOf);
+    long after = countOffNode(g, rankOf, nodeOf);
+    /* keep the placement unless it lowers the off-node traffic */
+    if (after >= before)
+      rankOf = identity;
+    if (verbosity)
+      printf("off-node shared vertices %ld -> %ld\n",
+          before, std::min(before, after));
+  }
+  MPI_Bcast(&rankOf[0], peers, MPI_INT, 0, PCU_Get_Comm());
+  int moved = 0;
+  for (int p = 0; p < peers; ++p)
+    if (rankOf[p] != p)
+      ++moved;
+  if (moved) {
+    apf::Migration* plan = new apf::Migration(m);
+    plan->send(rankOf[self]);
+    apf::migrateSilent(m, plan);
+  }
+  if (verbosity && !self)
+    printf("moved %d parts to match the topology in %f seconds\n",
+        moved, PCU_Time() - t0);
+}
@@ -1,13 +1,19 @@
 #include <PCU.h>
 #include <pcu_util.h>
 #include "parma.h"
-#include "diffMC/maximalIndependentSet/mis.h"
 #include "diffMC/parma_commons.h"
 #include "diffMC/parma_convert.h"
+#include "diffMC/parma_entWeights.h"
+#include "diffMC/parma_capacity.h"
 #include <parma_dcpart.h>
+#include <apfMIS.h>
+#include <algorithm>
+#include <climits>
+#include <cstdio>
 #include <limits>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace {
   typedef std::map<int,int> mii;
@@ -62,13 +68,6 @@ namespace {
     }
   }
 
-  double getEntWeight(apf::Mesh* m, apf::MeshEntity* e, apf::MeshTag* w) {
-    PCU_ALWAYS_ASSERT(m->hasTag(e,w));
-    double weight;
-    m->getDoubleTag(e,w,&weight);
-    return weight;
-  }
-
   void getPartWeights(apf::Mesh* m, apf::MeshTag* w, double (*weight)[4]) {
     int hasWeight[4];
     hasEntWeight(m,w,&hasWeight);
@@ -76,31 +75,13 @@ namespace {
     for(int i=0; i < dims; i++) {
       (*weight)[i] = 0;
       if(hasWeight[i]) {
-        apf::MeshIterator* it = m->begin(i);
-        apf::MeshEntity* e;
-        while ((e = m->iterate(it)))
-          (*weight)[i] += getEntWeight(m, e, w);
-        m->end(it);
+        (*weight)[i] += parma::getWeight(m, w, i);
       } else {
         (*weight)[i] += TO_DOUBLE(m->count(i));
       }
     }
   }
 
-  void getWeightedStats(
-      int dim, double (*loc)[4], double (*tot)[4],
-      double (*min)[4], double (*max)[4], double (*avg)[4]) {
-    for(int d=0; d<=dim; d++)
-      (*min)[d] = (*max)[d] = (*tot)[d] = (*loc)[d];
-    PCU_Min_Doubles(*min, dim+1);
-    PCU_Max_Doubles(*max, dim+1);
-    PCU_Add_Doubles(*tot, dim+1);
-    for(int d=0; d<=dim; d++) {
-      (*avg)[d] = (*tot)[d];
-      (*avg)[d] /= TO_DOUBLE(PCU_Comm_Peers());
-    }
-  }
-
   void getStats(int& loc, long& tot, int& min, int& max, double& avg) {
     min = PCU_Min_Int(loc);
     max = PCU_Max_Int(loc);
@@ -132,22 +113,6 @@ namespace {
     PCU_Barrier();
   }
 
-  void writeWeightedEntStats(apf::Mesh* m, apf::MeshTag* w, std::string key) {
-    double weight[4];
-    getPartWeights(m, w, &weight);
-    double minEnt[4] = {0,0,0,0}, maxEnt[4] = {0,0,0,0};
-    double totEnt[4] = {0,0,0,0}, avgEnt[4] = {0,0,0,0};
-    getWeightedStats(m->getDimension(), &weight, &totEnt, &minEnt, &maxEnt, &avgEnt);
-    const char* orders[4] = {"vtx","edge","face","rgn"};
-    if(!PCU_Comm_Self()) {
-      for( int d=0; d<=m->getDimension(); d++)
-        status("%s weighted %s <tot max min avg> "
-            "%.1f %.1f %.1f %.3f\n",
-            key.c_str(), orders[d],
-            totEnt[d], maxEnt[d], minEnt[d], avgEnt[d]);
-    }
-  }
-
   void getNeighborCounts(apf::Mesh* m, mii& nborToShared) {
     apf::MeshIterator *it = m->begin(0);
     apf::MeshEntity* e;
@@ -180,8 +145,11 @@ void Parma_GetWeightedEntImbalance(apf::Mesh* mesh, apf::MeshTag* w,
   size_t dims = TO_SIZET(mesh->getDimension()) + 1;
   getPartWeights(mesh, w, entImb);
   double tot[4] = {0,0,0,0};
-  for(size_t i=0; i < dims; i++)
+  const double capacity = parma::getCapacity(PCU_Comm_Self());
+  for(size_t i=0; i < dims; i++) {
     tot[i] = (*entImb)[i];
+    (*entImb)[i] /= capacity;
+  }
   PCU_Add_Doubles(tot, TO_SIZET(dims));
   PCU_Max_Doubles(*entImb, TO_SIZET(dims));
   for(size_t i=0; i < dims; i++)
@@ -193,14 +161,9 @@ void Parma_GetWeightedEntImbalance(apf::Mesh* mesh, apf::MeshTag* w,
 double Parma_GetWeightedEntImbalance(apf::Mesh* m, apf::MeshTag* w,
     int dim) {
     PCU_ALWAYS_ASSERT(dim >= 0 && dim <= 3);
-    apf::MeshIterator* it = m->begin(dim);
-    apf::MeshEntity* e;
-    double sum = 0;
-    while ((e = m->iterate(it)))
-      sum += getEntWeight(m, e, w);
-    m->end(it);
+    double sum = parma::getWeight(m, w, dim);
    double tot = PCU_Add_Double(sum);
-   double max = PCU_Max_Double(sum);
+   double max = PCU_Max_Double(sum / parma::getCapacity(PCU_Comm_Self()));
    return max/(tot/PCU_Comm_Peers());
 }
 
@@ -278,8 +241,16 @@ void Parma_ProcessDisconnectedParts(apf::Mesh* m) {
   dcPartFixer dcf(m);
 }
 
+void Parma_ProcessDisconnectedParts(apf::Mesh* m, long& components,
+    long& elements) {
+  dcPartFixer dcf(m);
+  components = dcf.getMovedComps();
+  elements = dcf.getMovedElms();
+}
+
 void Parma_PrintPtnStats(apf::Mesh* m, std::string key, bool fine) {
   apf::MeshTag* w = m->createDoubleTag("parma_ent_weights", 1);
+  m->chargeTag(w, PCU_MEM_PARMA);
   int dims = m->getDimension() + 1;
   double entWeight=1;
   for(int i=0; i < dims; i++) {
@@ -295,6 +266,56 @@ void Parma_PrintPtnStats(apf::Mesh* m, std::string key, bool fine) {
   m->destroyTag(w);
 }
 
+namespace {
+  /* layout of the printed statistics: sums, maxima with minima as
+     negated maxima, then the most neighbors with the number of parts
+     that have them and the negated smallest side among those parts */
+  enum {
+    STAT_SUM_DC = 0,
+    STAT_SUM_NBORS,
+    STAT_SUM_SMALL,
+    STAT_SUM_BDRY = STAT_SUM_SMALL + 10,
+    STAT_SUM_SURF_TO_VOL = STAT_SUM_BDRY + 3,
+    STAT_SUM_EMPTY,
+    STAT_SUM_WEIGHT,
+    STAT_SUMS = STAT_SUM_WEIGHT + 4,
+    STAT_MAX_DC = STAT_SUMS,
+    STAT_MAX_BDRY,
+    STAT_NEG_MIN_BDRY = STAT_MAX_BDRY + 3,
+    STAT_MAX_SURF_TO_VOL = STAT_NEG_MIN_BDRY + 3,
+    STAT_NEG_MIN_SURF_TO_VOL,
+    STAT_MAX_WEIGHT,
+    STAT_NEG_MIN_WEIGHT = STAT_MAX_WEIGHT + 4,
+    STAT_MAX_LOAD = STAT_NEG_MIN_WEIGHT + 4,
+    STAT_MAXES = STAT_MAX_LOAD + 4,
+    STAT_MAX_NBORS = STAT_MAXES,
+    STAT_MAX_NBOR_PARTS,
+    STAT_NEG_SMALLEST_SIDE,
+    NUM_STATS
+  };
+
+  void reduceStats(void* in, void* inout, int* len, MPI_Datatype*) {
+    double* a = static_cast<double*>(in);
+    double* b = static_cast<double*>(inout);
+    for (int r = 0; r < *len; ++r, a += NUM_STATS, b += NUM_STATS) {
+      for (int i = 0; i < STAT_SUMS; ++i)
+        b[i] += a[i];
+      for (int i = STAT_SUMS; i < STAT_MAXES; ++i)
+        b[i] = std::max(a[i], b[i]);
+      if (a[STAT_MAX_NBORS] > b[STAT_MAX_NBORS]) {
+        for (int i = STAT_MAXES; i < NUM_STATS; ++i)
+          b[i] = a[i];
+      } else if (a[STAT_MAX_NBORS] == b[STAT_MAX_NBORS]) {
+        b[STAT_MAX_NBOR_PARTS] += a[STAT_MAX_NBOR_PARTS];
+        b[STAT_NEG_SMALLEST_SIDE] = std::max(a[STAT_NEG_SMALLEST_SIDE],
+            b[STAT_NEG_SMALLEST_SIDE]);
+      }
+    }
+  }
+}
+
+/* everything printed is reduced at once, these run
+   after each balancing step on all parts */
 void Parma_PrintWeightedPtnStats(apf::Mesh* m, apf::MeshTag* w, std::string key, bool fine) {
   PCU_Debug_Print("%s vtx %lu\n", key.c_str(), m->count(0));
   PCU_Debug_Print("%s edge %lu\n", key.c_str(), m->count(1));
@@ -302,90 +323,314 @@ void Parma_PrintWeightedPtnStats(apf::Mesh* m, apf::MeshTag* w, std::string key,
   if( m->getDimension() == 3 )
     PCU_Debug_Print("%s rgn %lu\n", key.c_str(), m->count(3));
 
-  int maxDc = 0;
-  double avgDc = 0;
-  int locDc = 0;
-  Parma_GetDisconnectedStats(m, maxDc, avgDc, locDc);
+  const int dim = m->getDimension();
+  double loc[NUM_STATS];
+  for (int i = 0; i < NUM_STATS; ++i)
+    loc[i] = 0;
+
+  dcPart dc(m);
+  int locDc = TO_INT(dc.getNumDcComps());
+  loc[STAT_SUM_DC] = loc[STAT_MAX_DC] = locDc;
   PCU_Debug_Print("%s dc %d\n", key.c_str(), locDc);
 
-  int maxNb = 0, maxNbParts = 0;
-  double avgNb = 0;
-  int locNb = 0;
-  Parma_GetNeighborStats(m, maxNb, maxNbParts, avgNb, locNb);
-  int smallSideMaxNbPart = Parma_GetSmallestSideMaxNeighborParts(m);
+  mii nborToShared;
+  getNeighborCounts(m,nborToShared);
+  int locNb = TO_INT(nborToShared.size())-1;
+  int smallest = INT_MAX;
+  APF_ITERATE(mii, nborToShared, nbor) {
+    smallest = std::min(smallest, nbor->second);
+    if (nbor->second >= 1 && nbor->second <= 10)
+      ++loc[STAT_SUM_SMALL + nbor->second - 1];
+  }
+  loc[STAT_SUM_NBORS] = loc[STAT_MAX_NBORS] = locNb;
+  loc[STAT_MAX_NBOR_PARTS] = 1;
+  loc[STAT_NEG_SMALLEST_SIDE] = -smallest;
   PCU_Debug_Print("%s neighbors %d\n", key.c_str(), locNb);
 
-  int locV[3], minV[3], maxV[3];
-  long totV[3];
-  double avgV[3];
-  Parma_GetOwnedBdryVtxStats(m, locV[0], totV[0], minV[0], maxV[0], avgV[0]);
-  Parma_GetSharedBdryVtxStats(m, locV[1], totV[1], minV[1], maxV[1], avgV[1]);
-  Parma_GetMdlBdryVtxStats(m, locV[2], totV[2], minV[2], maxV[2], avgV[2]);
+  int locV[3];
+  locV[0] = numBdryVtx(m);
+  locV[1] = numBdryVtx(m,true);
+  locV[2] = numMdlBdryVtx(m);
+  for (int i = 0; i < 3; ++i) {
+    loc[STAT_SUM_BDRY + i] = loc[STAT_MAX_BDRY + i] = locV[i];
+    loc[STAT_NEG_MIN_BDRY + i] = -locV[i];
+  }
   PCU_Debug_Print("%s ownedBdryVtx %d\n", key.c_str(), locV[0]);
   PCU_Debug_Print("%s sharedBdryVtx %d\n", key.c_str(), locV[1]);
   PCU_Debug_Print("%s mdlBdryVtx %d\n", key.c_str(), locV[2]);
 
   int surf = numSharedSides(m);
-  double vol = TO_DOUBLE( m->count(m->getDimension()) );
+  double vol = TO_DOUBLE( m->count(dim) );
   double surfToVol = surf/vol;
-  double minSurfToVol = PCU_Min_Double(surfToVol);
-  double maxSurfToVol = PCU_Max_Double(surfToVol);
-  double avgSurfToVol = PCU_Add_Double(surfToVol) / PCU_Comm_Peers();
+  loc[STAT_SUM_SURF_TO_VOL] = loc[STAT_MAX_SURF_TO_VOL] = surfToVol;
+  loc[STAT_NEG_MIN_SURF_TO_VOL] = -surfToVol;
   PCU_Debug_Print("%s sharedSidesToElements %.3f\n", key.c_str(), surfToVol);
 
-  int empty = (m->count(m->getDimension()) == 0 ) ? 1 : 0;
-  empty = PCU_Add_Int(empty);
+  loc[STAT_SUM_EMPTY] = (m->count(dim) == 0 ) ? 1 : 0;
 
-  double imb[4] = {0, 0, 0, 0};
-  Parma_GetWeightedEntImbalance(m,w,&imb);
+  double weight[4];
+  getPartWeights(m, w, &weight);
+  const double capacity = parma::getCapacity(PCU_Comm_Self());
+  for (int d = 0; d <= dim; ++d) {
+    loc[STAT_SUM_WEIGHT + d] = loc[STAT_MAX_WEIGHT + d] = weight[d];
+    loc[STAT_NEG_MIN_WEIGHT + d] = -weight[d];
+    loc[STAT_MAX_LOAD + d] = weight[d] / capacity;
+  }
+
+  MPI_Datatype record;
+  MPI_Type_contiguous(NUM_STATS, MPI_DOUBLE, &record);
+  MPI_Type_commit(&record);
+  MPI_Op op;
+  MPI_Op_create(reduceStats, 1, &op);
+  double red[NUM_STATS];
+  MPI_Allreduce(loc, red, 1, record, op, PCU_Get_Comm());
+  MPI_Op_free(&op);
+  MPI_Type_free(&record);
+  const double peers = TO_DOUBLE(PCU_Comm_Peers());
 
   if (fine)
     writeFineStats(m, key, locDc, locNb, locV, surf, vol);
 
   PCU_Debug_Print("%s vtxAdjacentNeighbors ", key.c_str());
-  apf::Parts peers;
-  apf::getPeers(m,0,peers);
-  APF_ITERATE(apf::Parts,peers,p)
+  apf::Parts peerParts;
+  apf::getPeers(m,0,peerParts);
+  APF_ITERATE(apf::Parts,peerParts,p)
     PCU_Debug_Print("%d ", *p);
   PCU_Debug_Print("\n");
 
-  if( 0 == PCU_Comm_Self() ) {
-    status("%s disconnected <max avg> %d %.3f\n",
-        key.c_str(), maxDc, avgDc);
-    status("%s neighbors <max avg> %d %.3f\n",
-        key.c_str(), maxNb, avgNb);
-    status("%s smallest side of max neighbor part %d\n",
-        key.c_str(), smallSideMaxNbPart);
-    status("%s num parts with max neighbors %d\n",
-        key.c_str(), maxNbParts);
-    status("%s empty parts %d\n",
-        key.c_str(), empty);
-  }
-  const int smallestSide = 10;
-  Parma_WriteSmallNeighbors(m, smallestSide, key.c_str());
-  writeWeightedEntStats(m,w,key);
-  if( 0 == PCU_Comm_Self() ) {
-    status("%s owned bdry vtx <tot max min avg> "
+  if (PCU_Comm_Self())
+    return;
+  status("%s disconnected <max avg> %d %.3f\n",
+      key.c_str(), TO_INT(red[STAT_MAX_DC]), red[STAT_SUM_DC] / peers);
+  status("%s neighbors <max avg> %d %.3f\n",
+      key.c_str(), TO_INT(red[STAT_MAX_NBORS]), red[STAT_SUM_NBORS] / peers);
+  status("%s smallest side of max neighbor part %d\n",
+      key.c_str(), TO_INT(-red[STAT_NEG_SMALLEST_SIDE]));
+  status("%s num parts with max neighbors %d\n",
+      key.c_str(), TO_INT(red[STAT_MAX_NBOR_PARTS]));
+  status("%s empty parts %d\n",
+      key.c_str(), TO_INT(red[STAT_SUM_EMPTY]));
+  std::stringstream ss;
+  for (int i = 0; i < 10; ++i)
+    ss << i+1 << ":" << TO_INT(red[STAT_SUM_SMALL + i]) << " ";
+  std::string small = ss.str();
+  status("%s small neighbor counts %s\n", key.c_str(), small.c_str());
+  const char* orders[4] = {"vtx","edge","face","rgn"};
+  for (int d = 0; d <= dim; ++d)
+    status("%s weighted %s <tot max min avg> "
+        "%.1f %.1f %.1f %.3f\n",
+        key.c_str(), orders[d], red[STAT_SUM_WEIGHT + d],
+        red[STAT_MAX_WEIGHT + d], -red[STAT_NEG_MIN_WEIGHT + d],
+        red[STAT_SUM_WEIGHT + d] / peers);
+  const char* bdry[3] = {"owned", "shared", "model"};
+  for (int i = 0; i < 3; ++i)
+    status("%s %s bdry vtx <tot max min avg> "
         "%ld %d %d %.3f\n",
-        key.c_str(), totV[0], maxV[0], minV[0], avgV[0]);
-    status("%s shared bdry vtx <tot max min avg> "
-        "%ld %d %d %.3f\n",
-        key.c_str(), totV[1], maxV[1], minV[1], avgV[1]);
-    status("%s model bdry vtx <tot max min avg> "
-        "%ld %d %d %.3f\n",
-        key.c_str(), totV[2], maxV[2], minV[2], avgV[2]);
-    status("%s sharedSidesToElements <max min avg> "
-        "%.3f %.3f %.3f\n",
-        key.c_str(), maxSurfToVol, minSurfToVol, avgSurfToVol);
-    status("%s entity imbalance <v e f r>: "
-        "%.2f %.2f %.2f %.2f\n", key.c_str(), imb[0], imb[1], imb[2], imb[3]);
+        key.c_str(), bdry[i], TO_LONG(red[STAT_SUM_BDRY + i]),
+        TO_INT(red[STAT_MAX_BDRY + i]), TO_INT(-red[STAT_NEG_MIN_BDRY + i]),
+        red[STAT_SUM_BDRY + i] / peers);
+  status("%s sharedSidesToElements <max min avg> "
+      "%.3f %.3f %.3f\n",
+      key.c_str(), red[STAT_MAX_SURF_TO_VOL],
+      -red[STAT_NEG_MIN_SURF_TO_VOL], red[STAT_SUM_SURF_TO_VOL] / peers);
+  double imb[4] = {1, 1, 1, 1};
+  for (int d = 0; d <= dim; ++d)
+    imb[d] = red[STAT_MAX_LOAD + d] / (red[STAT_SUM_WEIGHT + d] / peers);
+  status("%s entity imbalance <v e f r>: "
+      "%.2f %.2f %.2f %.2f\n", key.c_str(), imb[0], imb[1], imb[2], imb[3]);
+}
+
+namespace {
+  /* layout of the reduced metrics: sums, then maxima. The minimum is
+     reduced as a negated maximum so one reduction covers everything */
+  enum {
+    SUM_ENT = 0,
+    SUM_WEIGHT = SUM_ENT + 4,
+    SUM_NBORS = SUM_WEIGHT + 4,
+    SUM_SHARED,
+    SUM_OWNED,
+    SUM_DC,
+    SUM_EMPTY,
+    SUM_VOLUME,
+    NUM_SUMS,
+    MAX_ENT = NUM_SUMS,
+    MAX_WEIGHT = MAX_ENT + 4,
+    MAX_NBORS = MAX_WEIGHT + 4,
+    MAX_SHARED,
+    NEG_MIN_SHARED,
+    MAX_DC,
+    MAX_VOLUME,
+    NUM_METRICS
+  };
+
+  void reduceMetrics(void* in, void* inout, int* len, MPI_Datatype*) {
+    double* a = static_cast<double*>(in);
+    double* b = static_cast<double*>(inout);
+    for (int r = 0; r < *len; ++r, a += NUM_METRICS, b += NUM_METRICS) {
+      for (int i = 0; i < NUM_SUMS; ++i)
+        b[i] += a[i];
+      for (int i = NUM_SUMS; i < NUM_METRICS; ++i)
+        b[i] = std::max(a[i], b[i]);
+    }
+  }
+
+  /* the vertex metrics in one traversal */
+  void getVtxMetrics(apf::Mesh* m, double* loc) {
+    mii nborToShared;
+    int shared = 0, owned = 0, volume = 0;
+    apf::MeshIterator* it = m->begin(0);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      apf::Parts sharers;
+      m->getResidence(e, sharers);
+      APF_ITERATE(apf::Parts, sharers, nbor)
+        nborToShared[*nbor]++;
+      if (!m->isShared(e))
+        continue;
+      ++shared;
+      if (m->isOwned(e))
+        ++owned;
+      volume += TO_INT(sharers.size()) - 1;
+    }
+    m->end(it);
+    loc[SUM_NBORS] = loc[MAX_NBORS] = TO_INT(nborToShared.size()) - 1;
+    loc[SUM_SHARED] = loc[MAX_SHARED] = shared;
+    loc[NEG_MIN_SHARED] = -shared;
+    loc[SUM_OWNED] = owned;
+    loc[SUM_VOLUME] = loc[MAX_VOLUME] = volume;
+  }
+
+  void getImbalances(int dims, double* reduced, int ent, double (*imb)[4]) {
+    const int peers = PCU_Comm_Peers();
+    for (int d = 0; d < 4; ++d)
+      (*imb)[d] = 1.0;
+    for (int d = 0; d < dims; ++d)
+      if (reduced[ent + d] > 0)
+        (*imb)[d] = reduced[NUM_SUMS + ent + d] / (reduced[ent + d] / peers);
+  }
+
+  void getFields(Parma_PtnMetrics const& pm,
+      std::vector<std::string>& names, std::vector<std::string>& values) {
+    const char* orders[4] = {"vtx","edge","face","rgn"};
+    std::stringstream ss;
+    names.clear();
+    values.clear();
+#define PARMA_FIELD(name, value) \
+    ss.str(""); ss << (value); names.push_back(name); values.push_back(ss.str());
+    PARMA_FIELD("parts", pm.parts);
+    for (int d = 0; d < 4; ++d) {
+      PARMA_FIELD(std::string(orders[d]) + "Imb", pm.entImbalance[d]);
+    }
+    for (int d = 0; d < 4; ++d) {
+      PARMA_FIELD(std::string(orders[d]) + "WeightImb",
+          pm.weightedImbalance[d]);
+    }
+    PARMA_FIELD("maxNeighbors", pm.maxNeighbors);
+    PARMA_FIELD("avgNeighbors", pm.avgNeighbors);
+    PARMA_FIELD("totSharedVtx", pm.totSharedVtx);
+    PARMA_FIELD("maxSharedVtx", pm.maxSharedVtx);
+    PARMA_FIELD("minSharedVtx", pm.minSharedVtx);
+    PARMA_FIELD("avgSharedVtx", pm.avgSharedVtx);
+    PARMA_FIELD("totOwnedBdryVtx", pm.totOwnedBdryVtx);
+    PARMA_FIELD("maxDisconnected", pm.maxDisconnected);
+    PARMA_FIELD("avgDisconnected", pm.avgDisconnected);
+    PARMA_FIELD("emptyParts", pm.emptyParts);
+    PARMA_FIELD("commVolume", pm.commVolume);
+    PARMA_FIELD("maxCommVolume", pm.maxCommVolume);
+#undef PARMA_FIELD
+  }
+}
+
+void Parma_GetPtnMetrics(apf::Mesh* m, apf::MeshTag* w,
+    Parma_PtnMetrics& metrics) {
+  const int dims = m->getDimension() + 1;
+  double loc[NUM_METRICS];
+  for (int i = 0; i < NUM_METRICS; ++i)
+    loc[i] = 0;
+  double weight[4] = {0,0,0,0};
+  if (w)
+    getPartWeights(m, w, &weight);
+  const double capacity = parma::getCapacity(PCU_Comm_Self());
+  for (int d = 0; d < dims; ++d) {
+    if (!w)
+      weight[d] = TO_DOUBLE(m->count(d));
+    loc[SUM_ENT + d] = loc[MAX_ENT + d] = TO_DOUBLE(m->count(d));
+    loc[SUM_WEIGHT + d] = weight[d];
+    loc[MAX_WEIGHT + d] = weight[d] / capacity;
+  }
+  getVtxMetrics(m, loc);
+  dcPart dc(m);
+  loc[SUM_DC] = loc[MAX_DC] = dc.getNumDcComps();
+  loc[SUM_EMPTY] = (m->count(m->getDimension()) == 0) ? 1 : 0;
+  MPI_Datatype record;
+  MPI_Type_contiguous(NUM_METRICS, MPI_DOUBLE, &record);
+  MPI_Type_commit(&record);
+  MPI_Op op;
+  MPI_Op_create(reduceMetrics, 1, &op);
+  double red[NUM_METRICS];
+  MPI_Allreduce(loc, red, 1, record, op, PCU_Get_Comm());
+  MPI_Op_free(&op);
+  MPI_Type_free(&record);
+  const int peers = PCU_Comm_Peers();
+  metrics.parts = peers;
+  getImbalances(dims, red, SUM_ENT, &metrics.entImbalance);
+  getImbalances(dims, red, SUM_WEIGHT, &metrics.weightedImbalance);
+  metrics.maxNeighbors = TO_INT(red[MAX_NBORS]);
+  metrics.avgNeighbors = red[SUM_NBORS] / peers;
+  metrics.totSharedVtx = TO_LONG(red[SUM_SHARED]);
+  metrics.maxSharedVtx = TO_INT(red[MAX_SHARED]);
+  metrics.minSharedVtx = TO_INT(-red[NEG_MIN_SHARED]);
+  metrics.avgSharedVtx = red[SUM_SHARED] / peers;
+  metrics.totOwnedBdryVtx = TO_LONG(red[SUM_OWNED]);
+  metrics.maxDisconnected = TO_INT(red[MAX_DC]);
+  metrics.avgDisconnected = red[SUM_DC] / peers;
+  metrics.emptyParts = TO_INT(red[SUM_EMPTY]);
+  metrics.commVolume = TO_LONG(red[SUM_VOLUME]);
+  metrics.maxCommVolume = TO_INT(red[MAX_VOLUME]);
+}
+
+void Parma_WritePtnMetrics(Parma_PtnMetrics const& metrics,
+    const char* path, const char* key) {
+  if (PCU_Comm_Self())
+    return;
+  std::vector<std::string> names, values;
+  getFields(metrics, names, values);
+  const std::string p(path);
+  const std::string ext(".json");
+  const bool json = p.size() >= ext.size() &&
+    p.compare(p.size() - ext.size(), ext.size(), ext) == 0;
+  FILE* f = fopen(path, "a");
+  if (!f) {
+    status("could not open %s for partition metrics\n", path);
+    return;
+  }
+  fseek(f, 0, SEEK_END);
+  const bool empty = (ftell(f) == 0);
+  if (json) {
+    fprintf(f, "{\"key\": \"%s\"", key);
+    for (size_t i = 0; i < names.size(); ++i)
+      fprintf(f, ", \"%s\": %s", names[i].c_str(), values[i].c_str());
+    fprintf(f, "}\n");
+  } else {
+    if (empty) {
+      fprintf(f, "key");
+      for (size_t i = 0; i < names.size(); ++i)
+        fprintf(f, ",%s", names[i].c_str());
+      fprintf(f, "\n");
+    }
+    fprintf(f, "%s", key);
+    for (size_t i = 0; i < values.size(); ++i)
+      fprintf(f, ",%s", values[i].c_str());
+    fprintf(f, "\n");
   }
+  fclose(f);
 }
 
 apf::MeshTag* Parma_WeighByMemory(apf::Mesh* m) {
   apf::MeshIterator* it = m->begin(m->getDimension());
   apf::MeshEntity* e;
   apf::MeshTag* tag = m->createDoubleTag("parma_bytes", 1);
+  m->chargeTag(tag, PCU_MEM_PARMA);
   while ((e = m->iterate(it))) {
     double bytes = m->getElementBytes(m->getType(e));
     m->setDoubleTag(e, tag, &bytes);
@@ -394,32 +639,67 @@ apf::MeshTag* Parma_WeighByMemory(apf::Mesh* m) {
   return tag;
 }
 
-int Parma_MisNumbering(apf::Mesh* m, int d) {
-  apf::Parts neighbors;
-  apf::getPeers(m,d,neighbors);
+namespace {
+  double getElmWeight(apf::Mesh* m, apf::MeshEntity* e, apf::MeshTag* w) {
+    double weight = 1;
+    if (w && m->hasTag(e, w))
+      m->getDoubleTag(e, w, &weight);
+    return weight;
+  }
 
-  misLuby::partInfo part;
-  part.id = m->getId();
-  part.net.push_back(m->getId());
-  APF_ITERATE(apf::Parts, neighbors, nItr) {
-    part.adjPartIds.push_back(*nItr);
-    part.net.push_back(*nItr);
+  bool touchesPartBdry(apf::Mesh* m, apf::MeshEntity* e) {
+    apf::Downward verts;
+    int nverts = m->getDownward(e, 0, verts);
+    for (int i = 0; i < nverts; ++i)
+      if (m->isShared(verts[i]))
+        return true;
+    return false;
   }
+}
 
-  unsigned seed = TO_UINT(part.id+1);
-  mis_init(seed);
-  int misNumber=-1;
-  int iter=0;
-  int misSize=0;
-  while( misSize != PCU_Comm_Peers() ) {
-    if( mis(part, false, true) || 1 == part.net.size() ) {
-      misNumber = iter;
-      part.net.clear();
-      part.adjPartIds.clear();
+apf::MeshTag* Parma_WeighByGhosts(apf::Mesh* m, apf::MeshTag* w) {
+  const int dim = m->getDimension();
+  double ghostW = 0, bdryW = 0, ownW = 0;
+  apf::MeshIterator* it = m->begin(dim);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    const double weight = getElmWeight(m, e, w);
+    if (m->isGhost(e)) {
+      ghostW += weight;
+      continue;
     }
-    iter++;
-    misSize = (misNumber != -1);
-    misSize = PCU_Add_Int(misSize);
+    ownW += weight;
+    if (touchesPartBdry(m, e))
+      bdryW += weight;
+  }
+  m->end(it);
+  /* the ghosts are charged to the boundary elements they hang from,
+     or to all elements of a part without a boundary */
+  bool all = !(bdryW > 0);
+  if (all)
+    bdryW = ownW;
+  const double ratio = bdryW > 0 ? ghostW / bdryW : 0;
+  apf::MeshTag* tag = m->createDoubleTag("parma_ghost_cost", 1);
+  m->chargeTag(tag, PCU_MEM_PARMA);
+  it = m->begin(dim);
+  while ((e = m->iterate(it))) {
+    if (m->isGhost(e))
+      continue;
+    double cost = getElmWeight(m, e, w);
+    if (all || touchesPartBdry(m, e))
+      cost *= 1 + ratio;
+    m->setDoubleTag(e, tag, &cost);
   }
-  return misNumber;
+  m->end(it);
+  return tag;
+}
+
+int Parma_MisNumbering(apf::Mesh* m, int d) {
+  apf::Parts neighbors;
+  apf::getPeers(m,d,neighbors);
+  apf::MisGraph g;
+  apf::buildPartMisGraph(neighbors, g);
+  std::vector<int> colors;
+  apf::colorGraph(g, 0, colors);
+  return colors[0];
 }
@@ -141,12 +141,73 @@ void Parma_PrintPtnStats(apf::Mesh* m, std::string key, bool fine=false);
  */
 void Parma_PrintWeightedPtnStats(apf::Mesh* m, apf::MeshTag* w, std::string key, bool fine=false);
 
+/**
+ * @brief partition quality metrics filled by Parma_GetPtnMetrics
+ * @remark imbalances are max/avg, entries beyond the mesh dimension are one
+ */
+struct Parma_PtnMetrics
+{
+  int parts;
+  double entImbalance[4];
+  double weightedImbalance[4];
+  int maxNeighbors;
+  double avgNeighbors;
+  long totSharedVtx;
+  int maxSharedVtx;
+  int minSharedVtx;
+  double avgSharedVtx;
+  long totOwnedBdryVtx;
+  int maxDisconnected;
+  double avgDisconnected;
+  int emptyParts;
+  /** vertex copies sent by one synchronization of vertex data */
+  long commVolume;
+  int maxCommVolume;
+};
+
+/**
+ * @brief compute the partition quality metrics
+ * @remark collective. The local values come from one traversal of the
+ *         vertices plus the disconnected component walk, and all of them
+ *         are reduced together by a single MPI_Allreduce, so this is cheap
+ *         enough to call between balancing steps.
+ * @param m (In) partitioned mesh
+ * @param w (In) entity weights, may be NULL to weigh every entity by one
+ * @param metrics (Out) the metrics, the same on all ranks
+ */
+void Parma_GetPtnMetrics(apf::Mesh* m, apf::MeshTag* w,
+    Parma_PtnMetrics& metrics);
+
+/**
+ * @brief append the metrics to a file from rank 0
+ * @remark a path ending in ".json" gets one JSON object per line,
+ *         any other path gets a CSV row, after a header row if the
+ *         file was empty
+ * @param metrics (In) metrics from Parma_GetPtnMetrics
+ * @param path (In) file to append to
+ * @param key (In) identifying string written with the row
+ */
+void Parma_WritePtnMetrics(Parma_PtnMetrics const& metrics,
+    const char* path, const char* key);
+
 /**
  * @brief re-connect disconnected parts
+ * @remark each component other than the largest of its part goes to
+ *         the neighboring part whose largest component it shares the
+ *         most sides with, all in one migration
  * @param m (In) partitioned mesh
  */
 void Parma_ProcessDisconnectedParts(apf::Mesh* m);
 
+/**
+ * @brief re-connect disconnected parts and count what moved
+ * @param m (In) partitioned mesh
+ * @param components (Out) number of components migrated, over all parts
+ * @param elements (Out) number of elements migrated, over all parts
+ */
+void Parma_ProcessDisconnectedParts(apf::Mesh* m, long& components,
+    long& elements);
+
 /**
  * @brief create an APF Balancer using centroid diffusion
  * @param m (In) partitioned mesh
@@ -241,6 +302,50 @@ apf::Balancer* Parma_MakeVtxBalancer(apf::Mesh* m, double stepFactor=0.1,
 apf::Balancer* Parma_MakeElmBalancer(apf::Mesh* m, double stepFactor=0.1,
     int verbosity=0);
 
+/**
+ * @brief create an APF Balancer targeting element imbalance with
+ *        globally planned flows
+ * @details each step first diffuses the part weights over the part
+ *          graph until they balance, then migrates along the summed
+ *          flows, so weight several parts away from an underloaded
+ *          part moves in a few steps instead of one hop per step
+ * @param m (In) partitioned mesh
+ * @param stepFactor (In) fraction of the planned flows migrated per step
+ * @param verbosity (In) output control, higher values output more
+ * @return apf balancer instance
+ */
+apf::Balancer* Parma_MakeElmFlowBalancer(apf::Mesh* m, double stepFactor=1.0,
+    int verbosity=0);
+
+/**
+ * @brief create an APF Balancer that trades element balance for
+ *        communication cost
+ * @details each step weighs the element imbalance plus (commWeight)
+ *          times the relative growth, since the balancer was made, of
+ *          the largest part boundary (Parma_GetSharedBdryVtxStats) and
+ *          of the largest neighbor count (Parma_GetNeighborStats).
+ *          Elements only move to lighter neighbors sharing few
+ *          vertices, and balancing stops when the tolerance is met or
+ *          that cost has not improved for a few steps.
+ * @param m (In) partitioned mesh
+ * @param commWeight (In) weight of the communication penalty
+ * @param stepFactor (In) amount of weight to migrate per step
+ * @param verbosity (In) output control, higher values output more
+ * @return apf balancer instance
+ */
+apf::Balancer* Parma_MakeElmCommBalancer(apf::Mesh* m, double commWeight=0.5,
+    double stepFactor=0.1, int verbosity=0);
+
+/**
+ * @brief set the number of threads the diffusive selectors use
+ * @details each part scores the cavities of its boundary vertices,
+ *          the most costly part of selection on large parts, in
+ *          contiguous chunks over this many threads (default 1).
+ *          The threads only read the mesh, which mds meshes allow.
+ * @param threads (In) threads per process
+ */
+void Parma_SetSelectorThreads(int threads);
+
 /**
  * @brief create an APF Balancer targeting vertex, edge, and elm imbalance
  * @param m (In) partitioned mesh
@@ -267,6 +372,46 @@ apf::Balancer* Parma_MakeVtxElmBalancer(apf::Mesh* m,
  */
 apf::Splitter* Parma_MakeRibSplitter(apf::Mesh* m, bool sync = true);
 
+/**
+ * @brief create an APF Splitter that cuts a Hilbert curve through
+ *        the element centroids into pieces of equal weight
+ * @param m (In) partitioned mesh
+ * @param sync (In) true if all parts will be split, false o.w.
+ * @return apf splitter instance
+ */
+apf::Splitter* Parma_MakeHilbertSplitter(apf::Mesh* m, bool sync = true);
+
+/**
+ * @brief create an APF Balancer that repartitions the whole mesh
+ *        along a Hilbert curve through the element centroids
+ * @details the curve keys are sorted locally and the cuts between
+ *          parts come from a sample of all ranks' keys, refined until
+ *          each part is within the tolerance. The result ignores the
+ *          current partition, so it is a cheap replacement for a
+ *          geometric repartitioner such as Zoltan RIB.
+ * @param m (In) partitioned mesh
+ * @param verbosity (In) output control, higher values output more
+ * @return apf balancer instance
+ */
+apf::Balancer* Parma_MakeHilbertBalancer(apf::Mesh* m, int verbosity=0);
+
+/**
+ * @brief plan a repartition of the whole mesh by parallel recursive
+ *        inertial bisection
+ * @details unlike Parma_MakeRibSplitter, the bisection runs over the
+ *          elements of all ranks together and ignores the current
+ *          partition, so it can partition a mesh from scratch.
+ *          Cuts are found by histogram refinement of the projected
+ *          element weights, with reductions instead of sorting.
+ *          The number of parts, PCU_Comm_Peers(), need not be a
+ *          power of two.
+ * @param m (In) partitioned mesh
+ * @param weights (In) element weights, or NULL for equal weights
+ * @return plan that sends each element to its new part; the caller
+ *         migrates with it
+ */
+apf::Migration* Parma_PlanGlobalRib(apf::Mesh* m, apf::MeshTag* weights);
+
 /**
  * @brief create a mesh tag that weighs elements by their memory consumption
  * @param m (In) partitioned mesh
@@ -274,6 +419,48 @@ apf::Splitter* Parma_MakeRibSplitter(apf::Mesh* m, bool sync = true);
  */
 apf::MeshTag* Parma_WeighByMemory(apf::Mesh* m);
 
+/**
+ * @brief create a mesh tag that weighs elements by the exact work of
+ *        their part's owned and ghost elements
+ * @details call this while a ghost layer, such as one made by
+ *          pumi_ghost_createLayer, is in place. The weight of the
+ *          part's ghost elements is charged to its elements touching
+ *          the part boundary in proportion to their weight, so the
+ *          tag sums to each part's owned plus ghost work. The tag is
+ *          only set on non-ghost elements: delete the ghosts, balance
+ *          with this tag, then rebuild the layer. The element
+ *          balancers keep part totals as elements migrate, so no
+ *          step walks a ghost layer the way Parma_MakeGhostDiffuser
+ *          does.
+ * @param m (In) partitioned mesh with ghost elements
+ * @param w (In) element weights, or NULL for equal weights
+ * @return mesh tag
+ */
+apf::MeshTag* Parma_WeighByGhosts(apf::Mesh* m, apf::MeshTag* w);
+
+/**
+ * @brief set how much weight each part should hold
+ * @details collective. Each rank passes its own capacity in any unit
+ *          shared by all ranks, such as bytes or relative speed. Part
+ *          p is then meant to hold the fraction capacity(p)/sum of the
+ *          total weight. The diffusive balancers move weight towards
+ *          those shares, and their imbalance, Parma_GetWeightedEntImbalance
+ *          and Parma_PrintWeightedPtnStats measure the largest weight
+ *          relative to its share. Passing the same value on all ranks
+ *          restores equal shares.
+ * @param capacity (In) positive capacity of this rank's part
+ */
+void Parma_SetCapacities(double capacity);
+
+/**
+ * @brief estimate this rank's capacity as its share of the free memory
+ *        on its node, in bytes
+ * @details pairs with Parma_WeighByMemory: passing this to
+ *          Parma_SetCapacities and balancing the memory weights fills
+ *          each node in proportion to the memory it has left
+ */
+double Parma_GetMemoryCapacity();
+
 /**
  * @brief User-defined code to run on process sub-groups.
  */
@@ -320,6 +507,22 @@ void Parma_ShrinkPartition(apf::Mesh2* m, int factor, Parma_GroupCode& toRun);
  */
 void Parma_SplitPartition(apf::Mesh2* m, int factor, Parma_GroupCode& toRun);
 
+/**
+ * @brief move parts so that heavily connected parts share a node
+ * @details the part graph, weighted by shared vertex counts, is
+ *          gathered on rank 0 and greedily packed onto the nodes
+ *          reported by MPI_Comm_split_type. Every part then moves
+ *          whole to its new rank, which lowers the inter-node traffic
+ *          of later exchanges. The parts stay in place unless the
+ *          packing lowers the off-node shared vertex count.
+ * @param m (In/Out) partitioned mesh, one part per rank
+ * @param ranksPerNode (In) if positive, consecutive ranks in groups of
+ *        this size are treated as nodes instead of asking MPI
+ * @param verbosity (In) output control, higher values output more
+ */
+void Parma_MapToTopology(apf::Mesh2* m, int ranksPerNode = 0,
+    int verbosity = 0);
+
 /**
  * @brief Compute maximal independent set numbering
  * @remark This function will compute the maximal independent set numbering
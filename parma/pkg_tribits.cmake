@@ -8,9 +8,12 @@ SET(DIFFMC_SOURCES
   diffMC/parma_balancer.cc
   diffMC/parma_bdryVtx.cc
   diffMC/parma_centroidDiffuser.cc
+  diffMC/parma_cavityPeers.cc
+  diffMC/parma_capacity.cc
   diffMC/parma_centroids.cc
   diffMC/parma_centroidSelector.cc
   diffMC/parma_commons.cc
+  diffMC/parma_commBalancer.cc
   diffMC/parma_components.cc
   diffMC/parma_dcpart.cc
   diffMC/parma_dcpartFixer.cc
@@ -35,6 +38,7 @@ SET(DIFFMC_SOURCES
   diffMC/parma_monitor.cc
   diffMC/parma_sides.cc
   diffMC/parma_step.cc
+  diffMC/parma_totals.cc
   diffMC/parma_stop.cc
   diffMC/parma_shapeOptimizer.cc
   diffMC/parma_shapeTargets.cc
@@ -42,6 +46,7 @@ SET(DIFFMC_SOURCES
   diffMC/parma_vtxBalancer.cc
   diffMC/parma_vtxSelector.cc
   diffMC/parma_weightTargets.cc
+  diffMC/parma_flowTargets.cc
   diffMC/parma_weightSideTargets.cc
   diffMC/parma_preserveTargets.cc
   diffMC/parma_vtxEdgeTargets.cc
@@ -50,17 +55,21 @@ SET(DIFFMC_SOURCES
   diffMC/parma_vtxElmBalancer.cc
   diffMC/parma_elmLtVtxEdgeBalancer.cc
   diffMC/zeroOneKnapsack.c
-  diffMC/maximalIndependentSet/misLuby.cc
-  diffMC/maximalIndependentSet/mersenne_twister.cc
   )
 
 SET(RIB_SOURCES
   rib/parma_rib.cc
   rib/parma_mesh_rib.cc
+  rib/parma_global_rib.cc
+  )
+
+SET(SFC_SOURCES
+  sfc/parma_sfc.cc
   )
 
 SET(GROUP_SOURCES
   group/parma_group.cc
+  group/parma_topology.cc
   )
 
 INCLUDE_DIRECTORIES(${CMAKE_CURRENT_BINARY_DIR})
@@ -71,7 +80,7 @@ SET(parmaDepLibs ${APF_LIBS})
 
 TRIBITS_ADD_LIBRARY(
   parma
-  SOURCES ${DIFFMC_SOURCES} ${RIB_SOURCES} ${GROUP_SOURCES} ${API_SOURCE}
+  SOURCES ${DIFFMC_SOURCES} ${RIB_SOURCES} ${SFC_SOURCES} ${GROUP_SOURCES} ${API_SOURCE}
   HEADERS ${PARMA_EXTERNAL_HEADERS})
 
 TRIBITS_PACKAGE_POSTPROCESS()
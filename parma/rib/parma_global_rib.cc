@@ -0,0 +1,259 @@
+#include <PCU.h>
+#include "parma.h"
+#include "parma_rib.h"
+#include <apfPartition.h>
+#include <apf2mth.h>
+#include <mth_def.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+/* recursive inertial bisection over all ranks at once. Each element
+   carries the range of parts [lo,hi) it may still go to. The ranges
+   split the same way on every rank, so each level bisects all of its
+   ranges together with a few reductions of per-range sums.
+   Cuts are found by narrowing a histogram of the projected masses
+   around the wanted fraction, so nothing is sorted or gathered. */
+
+namespace parma {
+
+namespace {
+
+/* bins per histogram and narrowing rounds per level; a cut is
+   settled once the mass left in its interval is below (cutTol)
+   of its range's mass */
+const int bins = 32;
+const int maxRounds = 12;
+const double cutTol = 1e-4;
+
+struct Item
+{
+  apf::MeshEntity* e;
+  mth::Vector3<double> point;
+  double mass;
+  double proj;
+  int lo;
+};
+
+struct Range
+{
+  int lo;
+  int hi;
+  int split() const {return lo + (hi - lo) / 2;}
+};
+
+void getItems(apf::Mesh* m, apf::MeshTag* weights, std::vector<Item>& items)
+{
+  int dim = m->getDimension();
+  items.resize(m->count(dim));
+  apf::MeshEntity* e;
+  size_t i = 0;
+  apf::MeshIterator* it = m->begin(dim);
+  while ((e = m->iterate(it))) {
+    Item& item = items[i++];
+    item.e = e;
+    item.point = apf::to_mth(apf::getLinearCentroid(m, e));
+    if (weights)
+      m->getDoubleTag(e, weights, &(item.mass));
+    else
+      item.mass = 1;
+    item.lo = 0;
+  }
+  m->end(it);
+}
+
+/* the unit normal of each range's cutting plane and its center */
+void getPlanes(std::vector<Item> const& items,
+    std::vector<Range> const& ranges, std::vector<int> const& index,
+    std::vector<double>& mass,
+    std::vector<mth::Vector3<double> >& centers,
+    std::vector<mth::Vector3<double> >& normals)
+{
+  size_t n = ranges.size();
+  std::vector<double> sums(4 * n, 0.0);
+  for (size_t i = 0; i < items.size(); ++i) {
+    int r = index[items[i].lo];
+    if (r < 0)
+      continue;
+    sums[4 * r] += items[i].mass;
+    for (int j = 0; j < 3; ++j)
+      sums[4 * r + 1 + j] += items[i].point(j) * items[i].mass;
+  }
+  PCU_Add_Doubles(&sums[0], sums.size());
+  mass.resize(n);
+  centers.resize(n);
+  for (size_t r = 0; r < n; ++r) {
+    mass[r] = sums[4 * r];
+    for (int j = 0; j < 3; ++j)
+      centers[r](j) = mass[r] > 0 ? sums[4 * r + 1 + j] / mass[r] : 0;
+  }
+  std::vector<double> inertia(9 * n, 0.0);
+  for (size_t i = 0; i < items.size(); ++i) {
+    int r = index[items[i].lo];
+    if (r < 0)
+      continue;
+    mth::Matrix3x3<double> c = mth::cross(items[i].point - centers[r]);
+    mth::Matrix3x3<double> contribution = c * c * -(items[i].mass);
+    for (int j = 0; j < 3; ++j)
+    for (int k = 0; k < 3; ++k)
+      inertia[9 * r + 3 * j + k] += contribution(j,k);
+  }
+  PCU_Add_Doubles(&inertia[0], inertia.size());
+  normals.resize(n);
+  for (size_t r = 0; r < n; ++r) {
+    mth::Matrix3x3<double> A;
+    for (int j = 0; j < 3; ++j)
+    for (int k = 0; k < 3; ++k)
+      A(j,k) = inertia[9 * r + 3 * j + k];
+    getWeakestEigenvector(A, normals[r]);
+  }
+}
+
+/* narrows each range's interval of projections around the point
+   below which the left parts' share of its mass lies */
+void findCuts(std::vector<Item> const& items,
+    std::vector<Range> const& ranges, std::vector<int> const& index,
+    std::vector<double> const& mass,
+    std::vector<double>& cuts)
+{
+  size_t n = ranges.size();
+  std::vector<double> lows(n, 0.0);
+  std::vector<double> highs(n, 0.0);
+  for (size_t r = 0; r < n; ++r) {
+    lows[r] = 1e300;
+    highs[r] = -1e300;
+  }
+  for (size_t i = 0; i < items.size(); ++i) {
+    int r = index[items[i].lo];
+    if (r < 0)
+      continue;
+    lows[r] = std::min(lows[r], items[i].proj);
+    highs[r] = std::max(highs[r], items[i].proj);
+  }
+  PCU_Min_Doubles(&lows[0], n);
+  PCU_Max_Doubles(&highs[0], n);
+  std::vector<double> target(n);
+  std::vector<double> below(n, 0.0);
+  std::vector<double> inside(mass);
+  std::vector<bool> settled(n, false);
+  for (size_t r = 0; r < n; ++r) {
+    Range const& g = ranges[r];
+    target[r] = mass[r] * (g.split() - g.lo) / (g.hi - g.lo);
+    settled[r] = !(mass[r] > 0) || !(highs[r] > lows[r]);
+  }
+  std::vector<double> hist(bins * n);
+  for (int round = 0; round < maxRounds; ++round) {
+    bool done = true;
+    for (size_t r = 0; r < n; ++r)
+      if (!settled[r])
+        done = false;
+    if (done)
+      break;
+    hist.assign(bins * n, 0.0);
+    for (size_t i = 0; i < items.size(); ++i) {
+      int r = index[items[i].lo];
+      if (r < 0 || settled[r])
+        continue;
+      double p = items[i].proj;
+      if (p < lows[r] || p > highs[r])
+        continue;
+      int b = static_cast<int>((p - lows[r]) / (highs[r] - lows[r]) * bins);
+      b = std::min(std::max(b, 0), bins - 1);
+      hist[bins * r + b] += items[i].mass;
+    }
+    PCU_Add_Doubles(&hist[0], hist.size());
+    for (size_t r = 0; r < n; ++r) {
+      if (settled[r])
+        continue;
+      double width = (highs[r] - lows[r]) / bins;
+      int b = 0;
+      while (b < bins - 1 && below[r] + hist[bins * r + b] < target[r]) {
+        below[r] += hist[bins * r + b];
+        ++b;
+      }
+      lows[r] += b * width;
+      highs[r] = lows[r] + width;
+      inside[r] = hist[bins * r + b];
+      if (inside[r] <= cutTol * mass[r])
+        settled[r] = true;
+    }
+  }
+  cuts.resize(n);
+  for (size_t r = 0; r < n; ++r) {
+    double f = inside[r] > 0 ? (target[r] - below[r]) / inside[r] : 0;
+    f = std::min(std::max(f, 0.0), 1.0);
+    cuts[r] = lows[r] + f * (highs[r] - lows[r]);
+  }
+}
+
+void bisectLevel(std::vector<Item>& items,
+    std::vector<Range> const& ranges, int parts)
+{
+  std::vector<int> index(parts, -1);
+  for (size_t r = 0; r < ranges.size(); ++r)
+    index[ranges[r].lo] = r;
+  std::vector<double> mass;
+  std::vector<mth::Vector3<double> > centers;
+  std::vector<mth::Vector3<double> > normals;
+  getPlanes(items, ranges, index, mass, centers, normals);
+  for (size_t i = 0; i < items.size(); ++i) {
+    int r = index[items[i].lo];
+    if (r >= 0)
+      items[i].proj = (items[i].point - centers[r]) * normals[r];
+  }
+  std::vector<double> cuts;
+  findCuts(items, ranges, index, mass, cuts);
+  for (size_t i = 0; i < items.size(); ++i) {
+    int r = index[items[i].lo];
+    if (r >= 0 && !(items[i].proj < cuts[r]))
+      items[i].lo = ranges[r].split();
+  }
+}
+
+}
+
+apf::Migration* planGlobalRib(apf::Mesh* m, apf::MeshTag* weights)
+{
+  int parts = PCU_Comm_Peers();
+  std::vector<Item> items;
+  getItems(m, weights, items);
+  std::vector<Range> ranges(1);
+  ranges[0].lo = 0;
+  ranges[0].hi = parts;
+  while (true) {
+    std::vector<Range> active;
+    for (size_t r = 0; r < ranges.size(); ++r)
+      if (ranges[r].hi - ranges[r].lo > 1)
+        active.push_back(ranges[r]);
+    if (active.empty())
+      break;
+    bisectLevel(items, active, parts);
+    std::vector<Range> next;
+    for (size_t r = 0; r < active.size(); ++r) {
+      Range left = {active[r].lo, active[r].split()};
+      Range right = {active[r].split(), active[r].hi};
+      next.push_back(left);
+      next.push_back(right);
+    }
+    ranges = next;
+  }
+  int self = PCU_Comm_Self();
+  apf::Migration* plan = new apf::Migration(m);
+  for (size_t i = 0; i < items.size(); ++i)
+    if (items[i].lo != self)
+      plan->send(items[i].e, items[i].lo);
+  return plan;
+}
+
+}
+
+apf::Migration* Parma_PlanGlobalRib(apf::Mesh* m, apf::MeshTag* weights)
+{
+  double t0 = PCU_Time();
+  apf::Migration* plan = parma::planGlobalRib(m, weights);
+  double t1 = PCU_Time();
+  if (!PCU_Comm_Self())
+    printf("planned global RIB to %d parts in %f seconds\n",
+        PCU_Comm_Peers(), t1 - t0);
+  return plan;
+}
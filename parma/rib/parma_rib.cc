@@ -63,7 +63,7 @@ static mth::Matrix3x3<double> normalize(mth::Matrix3x3<double> const& A)
   return A / max;
 }
 
-static void getWeakestEigenvector(mth::Matrix3x3<double> const& A_in,
+void getWeakestEigenvector(mth::Matrix3x3<double> const& A_in,
     mth::Vector3<double>& v)
 {
   std::cout << std::scientific << std::setprecision(10);
@@ -1,7 +1,7 @@
 #ifndef PARMA_RIB_H
 #define PARMA_RIB_H
 
-#include <mthVector.h>
+#include <mthMatrix.h>
 
 namespace parma {
 
@@ -22,6 +22,11 @@ struct Bodies
 
 void bisect(Bodies* all, Bodies* left, Bodies* right);
 
+/* the eigenvector of the smallest eigenvalue of (A), the
+   normal of the plane that best bisects an inertia matrix */
+void getWeakestEigenvector(mth::Matrix3x3<double> const& A,
+    mth::Vector3<double>& v);
+
 void recursivelyBisect(Bodies* all, int depth, Bodies out[]);
 
 }
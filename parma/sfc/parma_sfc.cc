@@ -0,0 +1,340 @@
+#include <PCU.h>
+#include "parma.h"
+#include <apfPartition.h>
+#include <apfMesh.h>
+#include <pcu_util.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+/* orders elements along a Hilbert curve through their centroids and
+   cuts the curve into chunks of equal weight. The curve keys are
+   sorted locally; the cuts across ranks come from a sample of every
+   rank's keys, narrowed by bisection over the key space until each
+   chunk is within the balance tolerance. */
+
+namespace parma {
+
+namespace {
+
+/* bits per axis of the curve. Three axes fill a 60 bit key,
+   which leaves room for the bound one past the last key
+   in a signed 64 bit Key */
+const int curveBits = 20;
+/* keys each rank contributes to the cut candidates */
+const int samplesPerRank = 16;
+/* bisection rounds allowed to narrow each cut */
+const int maxRounds = 64;
+
+typedef long Key;
+
+struct Item
+{
+  apf::MeshEntity* e;
+  Key key;
+  double mass;
+  bool operator<(Item const& other) const
+  {
+    return key < other.key;
+  }
+};
+
+/* Skilling's transform of a point of the grid into the
+   transposed form of its Hilbert index, then interleaved */
+Key getHilbertKey(unsigned x[3])
+{
+  unsigned top = 1u << (curveBits - 1);
+  for (unsigned q = top; q > 1; q >>= 1) {
+    unsigned p = q - 1;
+    for (int i = 0; i < 3; ++i)
+      if (x[i] & q)
+        x[0] ^= p;
+      else {
+        unsigned t = (x[0] ^ x[i]) & p;
+        x[0] ^= t;
+        x[i] ^= t;
+      }
+  }
+  for (int i = 1; i < 3; ++i)
+    x[i] ^= x[i - 1];
+  unsigned t = 0;
+  for (unsigned q = top; q > 1; q >>= 1)
+    if (x[2] & q)
+      t ^= q - 1;
+  for (int i = 0; i < 3; ++i)
+    x[i] ^= t;
+  Key key = 0;
+  for (int b = curveBits - 1; b >= 0; --b)
+    for (int i = 0; i < 3; ++i)
+      key = (key << 1) | ((x[i] >> b) & 1);
+  return key;
+}
+
+/* fills (items) sorted by curve key in the bounding box of
+   all elements, or of the local ones if (global) is false */
+void getItems(apf::Mesh* m, apf::MeshTag* weights, bool global,
+    std::vector<Item>& items)
+{
+  int dim = m->getDimension();
+  std::vector<apf::Vector3> points(m->count(dim));
+  items.resize(m->count(dim));
+  double lo[3] = {1e300, 1e300, 1e300};
+  double hi[3] = {-1e300, -1e300, -1e300};
+  apf::MeshEntity* e;
+  size_t i = 0;
+  apf::MeshIterator* it = m->begin(dim);
+  while ((e = m->iterate(it))) {
+    points[i] = apf::getLinearCentroid(m, e);
+    for (int j = 0; j < 3; ++j) {
+      lo[j] = std::min(lo[j], points[i][j]);
+      hi[j] = std::max(hi[j], points[i][j]);
+    }
+    items[i].e = e;
+    if (weights)
+      m->getDoubleTag(e, weights, &(items[i].mass));
+    else
+      items[i].mass = 1;
+    ++i;
+  }
+  m->end(it);
+  if (global) {
+    PCU_Min_Doubles(lo, 3);
+    PCU_Max_Doubles(hi, 3);
+  }
+  double cells = (1u << curveBits) - 1;
+  for (i = 0; i < items.size(); ++i) {
+    unsigned x[3];
+    for (int j = 0; j < 3; ++j) {
+      double span = hi[j] - lo[j];
+      x[j] = span > 0 ? (points[i][j] - lo[j]) / span * cells : 0;
+    }
+    items[i].key = getHilbertKey(x);
+  }
+  std::sort(items.begin(), items.end());
+}
+
+/* prefix[i] is the weight of items[0..i) */
+void getPrefix(std::vector<Item> const& items, std::vector<double>& prefix)
+{
+  prefix.resize(items.size() + 1);
+  prefix[0] = 0;
+  for (size_t i = 0; i < items.size(); ++i)
+    prefix[i + 1] = prefix[i] + items[i].mass;
+}
+
+/* local weight of the items with keys below (k) */
+double getWeightBelow(std::vector<Item> const& items,
+    std::vector<double> const& prefix, Key k)
+{
+  Item probe;
+  probe.key = k;
+  size_t i = std::lower_bound(items.begin(), items.end(), probe)
+           - items.begin();
+  return prefix[i];
+}
+
+/* the global weights below each of (keys) */
+void getGlobalBelow(std::vector<Item> const& items,
+    std::vector<double> const& prefix, std::vector<Key> const& keys,
+    std::vector<double>& below)
+{
+  below.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i)
+    below[i] = getWeightBelow(items, prefix, keys[i]);
+  if (!below.empty())
+    PCU_Add_Doubles(&below[0], below.size());
+}
+
+/* every rank's keys at regular fractions of its local weight,
+   sorted and the same on all ranks */
+void getSamples(std::vector<Item> const& items,
+    std::vector<double> const& prefix, std::vector<Key>& samples)
+{
+  int self = PCU_Comm_Self();
+  samples.assign(PCU_Comm_Peers() * samplesPerRank, 0);
+  double total = prefix.back();
+  size_t i = 0;
+  for (int j = 0; j < samplesPerRank && !items.empty(); ++j) {
+    double at = total * (j + 0.5) / samplesPerRank;
+    while (i + 1 < items.size() && prefix[i + 1] < at)
+      ++i;
+    samples[self * samplesPerRank + j] = items[i].key;
+  }
+  PCU_Add_Longs(&samples[0], samples.size());
+  std::sort(samples.begin(), samples.end());
+  samples.erase(std::unique(samples.begin(), samples.end()), samples.end());
+}
+
+/* keys that cut the global curve into (parts) chunks of equal
+   weight, each within (slack) of its target */
+void getGlobalCuts(std::vector<Item> const& items,
+    std::vector<double> const& prefix, int parts, double slack,
+    std::vector<Key>& cuts)
+{
+  double total = PCU_Add_Double(prefix.back());
+  std::vector<Key> samples;
+  getSamples(items, prefix, samples);
+  std::vector<double> sampleBelow;
+  getGlobalBelow(items, prefix, samples, sampleBelow);
+  int n = parts - 1;
+  std::vector<Key> lo(n, 0);
+  std::vector<Key> hi(n, Key(1) << (3 * curveBits));
+  std::vector<double> loBelow(n, 0);
+  std::vector<double> hiBelow(n, total);
+  std::vector<double> target(n);
+  for (int c = 0; c < n; ++c) {
+    target[c] = total * (c + 1) / parts;
+    for (size_t s = 0; s < samples.size(); ++s) {
+      if (sampleBelow[s] <= target[c] && samples[s] >= lo[c]) {
+        lo[c] = samples[s];
+        loBelow[c] = sampleBelow[s];
+      }
+      if (sampleBelow[s] >= target[c] && samples[s] < hi[c]) {
+        hi[c] = samples[s];
+        hiBelow[c] = sampleBelow[s];
+      }
+    }
+  }
+  std::vector<int> open;
+  std::vector<Key> mids;
+  std::vector<double> midBelow;
+  for (int round = 0; round < maxRounds; ++round) {
+    open.clear();
+    mids.clear();
+    for (int c = 0; c < n; ++c)
+      if (target[c] - loBelow[c] > slack &&
+          hiBelow[c] - target[c] > slack &&
+          hi[c] - lo[c] > 1) {
+        open.push_back(c);
+        mids.push_back(lo[c] + (hi[c] - lo[c]) / 2);
+      }
+    if (open.empty())
+      break;
+    getGlobalBelow(items, prefix, mids, midBelow);
+    for (size_t i = 0; i < open.size(); ++i) {
+      int c = open[i];
+      if (midBelow[i] <= target[c]) {
+        lo[c] = mids[i];
+        loBelow[c] = midBelow[i];
+      } else {
+        hi[c] = mids[i];
+        hiBelow[c] = midBelow[i];
+      }
+    }
+  }
+  cuts.resize(n);
+  for (int c = 0; c < n; ++c) {
+    if (target[c] - loBelow[c] <= hiBelow[c] - target[c])
+      cuts[c] = lo[c];
+    else
+      cuts[c] = hi[c];
+  }
+  std::sort(cuts.begin(), cuts.end());
+}
+
+/* the chunk of each item is the number of cuts at or below its key.
+   Items of chunk (stay) are not sent, the others go to chunk plus
+   (offset) */
+apf::Migration* planCuts(apf::Mesh* m, std::vector<Item> const& items,
+    std::vector<Key> const& cuts, int stay, int offset)
+{
+  apf::Migration* plan = new apf::Migration(m);
+  for (size_t i = 0; i < items.size(); ++i) {
+    int c = std::upper_bound(cuts.begin(), cuts.end(), items[i].key)
+          - cuts.begin();
+    if (c != stay)
+      plan->send(items[i].e, c + offset);
+  }
+  return plan;
+}
+
+class HilbertSplitter : public apf::Splitter
+{
+  public:
+    HilbertSplitter(apf::Mesh* m, bool s)
+    {
+      mesh = m;
+      sync = s;
+    }
+    virtual ~HilbertSplitter() {}
+    virtual apf::Migration* split(apf::MeshTag* weights, double,
+        int multiple)
+    {
+      double t0 = PCU_Time();
+      std::vector<Item> items;
+      getItems(mesh, weights, false, items);
+      std::vector<double> prefix;
+      getPrefix(items, prefix);
+      std::vector<Key> cuts;
+      size_t i = 0;
+      for (int c = 1; c < multiple && !items.empty(); ++c) {
+        double at = prefix.back() * c / multiple;
+        while (i < items.size() && prefix[i + 1] <= at)
+          ++i;
+        if (i < items.size())
+          cuts.push_back(items[i].key);
+      }
+      int offset = sync ? mesh->getId() * multiple : 0;
+      apf::Migration* plan = planCuts(mesh, items, cuts, 0, offset);
+      if (sync) {
+        double t1 = PCU_Time();
+        if (!PCU_Comm_Self())
+          printf("planned Hilbert factor %d in %f seconds\n",
+              multiple, t1 - t0);
+      }
+      return plan;
+    }
+  private:
+    apf::Mesh* mesh;
+    bool sync;
+};
+
+class HilbertBalancer : public apf::Balancer
+{
+  public:
+    HilbertBalancer(apf::Mesh* m, int v)
+    {
+      mesh = m;
+      verbose = v;
+    }
+    virtual ~HilbertBalancer() {}
+    virtual void balance(apf::MeshTag* weights, double tolerance)
+    {
+      double t0 = PCU_Time();
+      int parts = PCU_Comm_Peers();
+      std::vector<Item> items;
+      getItems(mesh, weights, true, items);
+      std::vector<double> prefix;
+      getPrefix(items, prefix);
+      /* a chunk is off by at most the slack at both of its cuts */
+      double average = PCU_Add_Double(prefix.back()) / parts;
+      double slack = std::max(tolerance - 1, 0.0) * average / 2;
+      std::vector<Key> cuts;
+      getGlobalCuts(items, prefix, parts, slack, cuts);
+      apf::Migration* plan = planCuts(mesh, items, cuts,
+          PCU_Comm_Self(), 0);
+      long moved = PCU_Add_Long(plan->count());
+      mesh->migrate(plan);
+      double t1 = PCU_Time();
+      if (verbose && !PCU_Comm_Self())
+        printf("Hilbert balance moved %ld elements in %f seconds\n",
+            moved, t1 - t0);
+    }
+  private:
+    apf::Mesh* mesh;
+    int verbose;
+};
+
+}
+
+}
+
+apf::Splitter* Parma_MakeHilbertSplitter(apf::Mesh* m, bool sync)
+{
+  return new parma::HilbertSplitter(m, sync);
+}
+
+apf::Balancer* Parma_MakeHilbertBalancer(apf::Mesh* m, int verbosity)
+{
+  return new parma::HilbertBalancer(m, verbosity);
+}
@@ -35,9 +35,13 @@ int PCU_Comm_Peers(void);
 
 /*recommended message passing API*/
 void PCU_Comm_Begin(void);
+void PCU_Comm_Begin_Named(const char* name);
 int PCU_Comm_Pack(int to_rank, const void* data, size_t size);
 #define PCU_COMM_PACK(to_rank,object)\
 PCU_Comm_Pack(to_rank,&(object),sizeof(object))
+void* PCU_Comm_Reserve(int to_rank, size_t size);
+#define PCU_COMM_RESERVE(to_rank,type,n)\
+((type*)PCU_Comm_Reserve(to_rank,(n)*sizeof(type)))
 int PCU_Comm_Send(void);
 bool PCU_Comm_Receive(void);
 bool PCU_Comm_Listen(void);
@@ -47,9 +51,61 @@ int PCU_Comm_Unpack(void* data, size_t size);
 #define PCU_COMM_UNPACK(object)\
 PCU_Comm_Unpack(&(object),sizeof(object))
 
+/*neighbor-only message passing, no global termination barrier*/
+void PCU_Comm_Neighbors(const int* ranks, int n);
+void PCU_Comm_Begin_Neighbors(void);
+void PCU_Comm_Graph(bool on);
+
+/*non-blocking phases, several may be in flight at once*/
+typedef struct pcu_phase_struct* PCU_Phase;
+PCU_Phase PCU_Phase_Begin(void);
+int PCU_Phase_Pack(PCU_Phase p, int to_rank, const void* data, size_t size);
+#define PCU_PHASE_PACK(p,to_rank,object)\
+PCU_Phase_Pack(p,to_rank,&(object),sizeof(object))
+void* PCU_Phase_Reserve(PCU_Phase p, int to_rank, size_t size);
+void PCU_Phase_Send(PCU_Phase p);
+bool PCU_Phase_Test(PCU_Phase p);
+void PCU_Phase_Wait(PCU_Phase p);
+bool PCU_Phase_Receive(PCU_Phase p);
+int PCU_Phase_Sender(PCU_Phase p);
+size_t PCU_Phase_Received(PCU_Phase p);
+bool PCU_Phase_Unpacked(PCU_Phase p);
+int PCU_Phase_Unpack(PCU_Phase p, void* data, size_t size);
+#define PCU_PHASE_UNPACK(p,object)\
+PCU_Phase_Unpack(p,&(object),sizeof(object))
+void* PCU_Phase_Extract(PCU_Phase p, size_t size);
+void PCU_Phase_End(PCU_Phase p);
+
 /*turns deterministic ordering for the
   above API on/off*/
 void PCU_Comm_Order(bool on);
+/*whether that ordering is on*/
+bool PCU_Comm_Ordered(void);
+
+/*compression of large messages for the above API,
+  and byte counters for what it saves*/
+void PCU_Comm_Compress(size_t threshold);
+void PCU_Comm_Traffic(size_t* raw, size_t* wire);
+
+/*per-phase communication statistics, printed by PCU_Comm_Free*/
+void PCU_Comm_Profile(bool on);
+
+/*I/O statistics by kind of file, see pcu_io.h*/
+void PCU_IO_Stats(bool on);
+void PCU_IO_Report(void);
+
+/*named regions timed as a call tree, printed by PCU_Comm_Free*/
+void PCU_Timers(bool on);
+void PCU_Timers_Trace(const char* prefix);
+void PCU_Timers_Report(void);
+void PCU_Timer_Begin(const char* name);
+void PCU_Timer_End(void);
+/*the local regions so far, parents before children, -1 for no parent*/
+int PCU_Timers_Count(void);
+const char* PCU_Timer_Name(int region);
+int PCU_Timer_Parent(int region);
+int PCU_Timer_Calls(int region);
+double PCU_Timer_Seconds(int region);
 
 /*collective operations*/
 void PCU_Barrier(void);
@@ -79,6 +135,22 @@ void PCU_Max_Ints(int* p, size_t n);
 int PCU_Max_Int(int x);
 int PCU_Or(int c);
 int PCU_And(int c);
+/*the first (sums) values are summed and the rest maximized in one
+  reduction, the non-blocking form owns p until PCU_Reduction_Wait*/
+void PCU_Add_Max_Longs(long* p, size_t sums, size_t n);
+typedef struct pcu_reduction_struct* PCU_Reduction;
+PCU_Reduction PCU_Add_Max_Longs_Begin(long* p, size_t sums, size_t n);
+bool PCU_Reduction_Test(PCU_Reduction r);
+void PCU_Reduction_Wait(PCU_Reduction r);
+
+/*thread-hybrid mode, see PCU_Thrd_Run*/
+typedef void* (*PCU_Thrd_Func)(void*);
+void* PCU_Thrd_Run(int nthreads, PCU_Thrd_Func function, void* in);
+int PCU_Thrd_Self(void);
+int PCU_Thrd_Peers(void);
+typedef void (*PCU_Thrd_Chunk)(void* in, size_t first, size_t end);
+void PCU_Thrd_Chunks(int nthreads, size_t n, PCU_Thrd_Chunk function,
+    void* in);
 
 /*process-level self/peers (mpi wrappers)*/
 int PCU_Proc_Self(void);
@@ -105,6 +177,8 @@ int PCU_Comm_Packed(int to_rank, size_t* size);
 int PCU_Comm_From(int* from_rank);
 int PCU_Comm_Received(size_t* size);
 void* PCU_Comm_Extract(size_t size);
+#define PCU_COMM_EXTRACT(type,n)\
+((type*)PCU_Comm_Extract((n)*sizeof(type)))
 int PCU_Comm_Rank(int* rank);
 int PCU_Comm_Size(int* size);
 
@@ -126,8 +200,52 @@ void PCU_Protect(void);
 /*MPI_Wtime() equivalent*/
 double PCU_Time(void);
 
+/*memory accounting by category: blocks from PCU_Mem_Alloc carry
+  their size and category, other memory is added with
+  PCU_Mem_Account, and each category keeps its current and
+  highest byte counts*/
+enum {
+  PCU_MEM_OTHER,
+  PCU_MEM_MDS_ADJACENCY,
+  PCU_MEM_MDS_COORDINATES,
+  PCU_MEM_MDS_TAGS,
+  PCU_MEM_MDS_REMOTES,
+  PCU_MEM_FIELDS,
+  PCU_MEM_PCU_BUFFERS,
+  PCU_MEM_MA,
+  PCU_MEM_PARMA,
+  PCU_MEM_CATEGORIES,
+  /*queries the totals over all categories*/
+  PCU_MEM_ALL = PCU_MEM_CATEGORIES
+};
+void* PCU_Mem_Alloc(int category, size_t size);
+void* PCU_Mem_Calloc(int category, size_t count, size_t size);
+/*a block keeps its category, (category) is used for NULL (p)*/
+void* PCU_Mem_Realloc(int category, void* p, size_t size);
+void PCU_Mem_Free(void* p);
+void PCU_Mem_Charge(void* p, int category);
+void PCU_Mem_Account(int category, long bytes);
+long PCU_Mem_Current(int category);
+long PCU_Mem_Peak(int category);
+const char* PCU_Mem_Name(int category);
+/*collective: prints the largest and summed current and peak
+  bytes of each category over the ranks*/
+void PCU_Mem_Print(void);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
 
+#ifdef __cplusplus
+/*times the enclosing scope as a PCU_Timer_Begin region*/
+class PCU_Region {
+  public:
+    PCU_Region(const char* name) {PCU_Timer_Begin(name);}
+    ~PCU_Region() {PCU_Timer_End();}
+  private:
+    PCU_Region(PCU_Region const&);
+    PCU_Region& operator=(PCU_Region const&);
+};
+#endif
+
 #endif
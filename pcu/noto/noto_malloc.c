@@ -8,90 +8,150 @@
 
 *******************************************************************************/
 #include "noto_malloc.h"
+#include "PCU.h" /* for the PCU_MEM_ categories */
 #include "reel.h" /* for reel_fail */
 #include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 
-//#define DEBUG_MEMORY
+/* the header keeps the blocks as aligned as malloc made them */
+typedef union
+{
+  struct {
+    size_t size;
+    int category;
+  } h;
+  long double align;
+  void* align_p;
+} header;
 
-#ifdef DEBUG_MEMORY
-#include <pthread.h>
-static size_t allocated = 0;
-static pthread_mutex_t allocated_mutex = PTHREAD_MUTEX_INITIALIZER;
-#endif
+static long current[PCU_MEM_CATEGORIES + 1];
+static long peak[PCU_MEM_CATEGORIES + 1];
+static pthread_mutex_t counts_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-void* noto_malloc(size_t size)
+static void check_category(int category, int last)
 {
+  if (category < 0 || category > last)
+    reel_fail("noto: invalid memory category %d", category);
+}
+
+static void count(int category, long bytes)
+{
+  pthread_mutex_lock(&counts_mutex);
+  current[category] += bytes;
+  if (current[category] > peak[category])
+    peak[category] = current[category];
+  current[PCU_MEM_ALL] += bytes;
+  if (current[PCU_MEM_ALL] > peak[PCU_MEM_ALL])
+    peak[PCU_MEM_ALL] = current[PCU_MEM_ALL];
+  pthread_mutex_unlock(&counts_mutex);
+}
+
+void* noto_malloc_in(int category, size_t size)
+{
+  header* p;
   if (!size)
     return NULL;
-#ifdef DEBUG_MEMORY
-  size += sizeof(size_t);
-  pthread_mutex_lock(&allocated_mutex);
-  allocated += size;
-  pthread_mutex_unlock(&allocated_mutex);
-#endif
-  size_t* p = malloc(size);
+  check_category(category, PCU_MEM_CATEGORIES - 1);
+  p = malloc(sizeof(header) + size);
   if (!p)
     reel_fail("malloc(%lu) failed", (unsigned long) size);
-#ifdef DEBUG_MEMORY
-  *p = size;
-  ++p;
-#endif
+  p->h.size = size;
+  p->h.category = category;
+  count(category, (long)size);
+  return p + 1;
+}
+
+void* noto_calloc_in(int category, size_t count, size_t size)
+{
+  void* p = noto_malloc_in(category, count * size);
+  if (p)
+    memset(p, 0, count * size);
   return p;
 }
 
-void* noto_realloc(void* p, size_t size)
+void* noto_realloc_in(int category, void* p, size_t size)
 {
-  if ((!p)&&(!size))
+  header* h;
+  header* h2;
+  if (!p)
+    return noto_malloc_in(category, size);
+  if (!size) {
+    noto_free(p);
     return NULL;
-  size_t* p2 = p;
-#ifdef DEBUG_MEMORY
-  size += sizeof(size_t);
-  pthread_mutex_lock(&allocated_mutex);
-  if (p2)
-  {
-    --p2;
-    allocated -= *p2;
   }
-  allocated += size;
-  pthread_mutex_unlock(&allocated_mutex);
-#endif
-  size_t* ret = realloc(p2, size);
-  if ((!ret) && (size))
-    reel_fail("realloc(%p, %lu) failed", (void*) p2, size);
-  p2 = ret;
-#ifdef DEBUG_MEMORY
-  if (p2)
-  {
-    *p2 = size;
-    ++p2;
-  }
-#endif
-  return p2;
+  h = (header*)p - 1;
+  category = h->h.category;
+  long old = (long)h->h.size;
+  h2 = realloc(h, sizeof(header) + size);
+  if (!h2)
+    reel_fail("realloc(%p, %lu) failed", p, (unsigned long) size);
+  h2->h.size = size;
+  count(category, (long)size - old);
+  return h2 + 1;
 }
 
 void noto_free(void* p)
 {
-  size_t* p2 = p;
-#ifdef DEBUG_MEMORY
-  if (p)
-  {
-    --p2;
-    pthread_mutex_lock(&allocated_mutex);
-    allocated -= *p2;
-    pthread_mutex_unlock(&allocated_mutex);
-  }
-#endif
-  free(p2);
+  header* h;
+  if (!p)
+    return;
+  h = (header*)p - 1;
+  count(h->h.category, -(long)h->h.size);
+  free(h);
+}
+
+void noto_charge(void* p, int category)
+{
+  header* h;
+  if (!p)
+    return;
+  check_category(category, PCU_MEM_CATEGORIES - 1);
+  h = (header*)p - 1;
+  if (h->h.category == category)
+    return;
+  count(h->h.category, -(long)h->h.size);
+  h->h.category = category;
+  count(category, (long)h->h.size);
+}
+
+void noto_account(int category, long bytes)
+{
+  check_category(category, PCU_MEM_CATEGORIES - 1);
+  count(category, bytes);
+}
+
+void* noto_malloc(size_t size)
+{
+  return noto_malloc_in(PCU_MEM_OTHER, size);
+}
+
+void* noto_realloc(void* p, size_t size)
+{
+  return noto_realloc_in(PCU_MEM_OTHER, p, size);
 }
 
 size_t noto_malloced(void)
 {
-#ifdef DEBUG_MEMORY
-  pthread_mutex_lock(&allocated_mutex);
-  size_t sample = allocated;
-  pthread_mutex_unlock(&allocated_mutex);
+  return (size_t)noto_current(PCU_MEM_ALL);
+}
+
+long noto_current(int category)
+{
+  long sample;
+  check_category(category, PCU_MEM_ALL);
+  pthread_mutex_lock(&counts_mutex);
+  sample = current[category];
+  pthread_mutex_unlock(&counts_mutex);
+  return sample;
+}
+
+long noto_peak(int category)
+{
+  long sample;
+  check_category(category, PCU_MEM_ALL);
+  pthread_mutex_lock(&counts_mutex);
+  sample = peak[category];
+  pthread_mutex_unlock(&counts_mutex);
   return sample;
-#else
-  return 0;
-#endif
 }
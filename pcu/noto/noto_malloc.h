@@ -12,11 +12,29 @@
 
 #include <stddef.h>
 
+/* every block carries a small header with its size and category,
+   so the bytes held by each category are known at all times.
+   Categories are the PCU_MEM_ values of PCU.h. */
+
 void* noto_malloc(size_t size);
 #define NOTO_MALLOC(p,c) ((p)=noto_malloc(sizeof(*(p))*(c)))
 void* noto_realloc(void* p, size_t size);
 void noto_free(void* p);
 size_t noto_malloced(void);
 
-#endif
+void* noto_malloc_in(int category, size_t size);
+/* a NULL (p) gets a new block of (category), otherwise the
+   block keeps the category it has */
+void* noto_realloc_in(int category, void* p, size_t size);
+void* noto_calloc_in(int category, size_t count, size_t size);
+/* moves a block to another category */
+void noto_charge(void* p, int category);
+/* adds (bytes), which may be negative, to a category for
+   memory noto did not allocate */
+void noto_account(int category, long bytes);
+/* the bytes a category holds now and the most it has held,
+   PCU_MEM_ALL giving the totals */
+long noto_current(int category);
+long noto_peak(int category);
 
+#endif
@@ -29,12 +29,19 @@
   The API documentation is here: pcu.c
 */
 
+#include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
+#include <stdlib.h>
 #include "PCU.h"
 #include "pcu_msg.h"
 #include "pcu_pmpi.h"
 #include "pcu_order.h"
+#include "pcu_phase.h"
+#include "pcu_profile.h"
+#include "pcu_iostats.h"
+#include "pcu_timer.h"
+#include "pcu_thread.h"
 #include "noto_malloc.h"
 #include "reel.h"
 #include <sys/types.h> /*required for mode_t for mkdir on some systems*/
@@ -43,9 +50,10 @@
 
 enum state { uninit, init };
 static enum state global_state = uninit;
-static pcu_msg global_pmsg;
+/* each thread is a rank of its own in thread mode (PCU_Thrd_Run) */
+static PCU_THREAD_LOCAL pcu_msg global_pmsg;
 
-static pcu_msg* get_msg()
+pcu_msg* pcu_get_msg(void)
 {
   return &global_pmsg;
 }
@@ -67,6 +75,19 @@ int PCU_Comm_Init(void)
      PCU_Comm_Order(false) after PCU_Comm_Init
      to disable this */
   PCU_Comm_Order(true);
+  /* setting PCU_PROFILE to anything but 0 on any
+     rank turns the profiler on, see PCU_Comm_Profile */
+  const char* profile = getenv("PCU_PROFILE");
+  PCU_Comm_Profile(PCU_Or(profile && strcmp(profile, "0")));
+  /* and PCU_IO_STATS the I/O statistics, see PCU_IO_Stats */
+  const char* iostats = getenv("PCU_IO_STATS");
+  PCU_IO_Stats(PCU_Or(iostats && strcmp(iostats, "0")));
+  /* and PCU_TIMERS the timers, with PCU_TRACE naming the
+     trace files as well, see PCU_Timers */
+  const char* timers = getenv("PCU_TIMERS");
+  const char* trace = getenv("PCU_TRACE");
+  PCU_Timers_Trace(trace);
+  PCU_Timers(PCU_Or((timers && strcmp(timers, "0")) || trace));
   return PCU_SUCCESS;
 }
 
@@ -78,6 +99,19 @@ int PCU_Comm_Free(void)
 {
   if (global_state == uninit)
     reel_fail("Comm_Free called before Comm_Init");
+  if (pcu_thread_running())
+    reel_fail("Comm_Free called inside PCU_Thrd_Run");
+  if (pcu_phase_any())
+    reel_fail("Comm_Free called with PCU phases in flight");
+  pcu_profile_report(&(global_pmsg.coll));
+  pcu_profile_free();
+  pcu_profile_enable(false);
+  pcu_iostats_report(&(global_pmsg.coll));
+  pcu_iostats_reset();
+  pcu_iostats_enable(false);
+  pcu_timer_report(pcu_pmpi_comm());
+  pcu_timer_free();
+  pcu_timer_enable(false);
   if (global_pmsg.order)
     pcu_order_free(global_pmsg.order);
   pcu_free_msg(&global_pmsg);
@@ -120,10 +154,83 @@ int PCU_Comm_Peers(void)
   PCU_Comm_Pack or PCU_Comm_Write.
 */
 void PCU_Comm_Begin(void)
+{
+  PCU_Comm_Begin_Named(NULL);
+}
+
+/** \brief Begins a PCU communication phase called \a name.
+  \details This is PCU_Comm_Begin for phases that the profiler
+  should report separately (see PCU_Comm_Profile).
+  Phases with the same name are added together, and unnamed
+  phases are reported as "(unnamed)".
+  All threads must use the same name for the same phase.
+*/
+void PCU_Comm_Begin_Named(const char* name)
 {
   if (global_state == uninit)
     reel_fail("Comm_Begin called before Comm_Init");
-  pcu_msg_start(get_msg());
+  pcu_profile_begin(name);
+  pcu_msg_start(pcu_get_msg());
+  pcu_profile_begun();
+}
+
+/** \brief Registers the neighbor set used by neighbor phases.
+  \details \a ranks points to \a n ranks that this rank exchanges
+  messages with, for example the parts adjacent to this one in
+  a partition model.
+  The sets must be symmetric: if rank a lists rank b then rank b
+  must list rank a.
+  The set persists until the next call, and is only used by phases
+  started with PCU_Comm_Begin_Neighbors.
+  This function should be called between communication phases.
+ */
+void PCU_Comm_Neighbors(const int* ranks, int n)
+{
+  if (global_state == uninit)
+    reel_fail("Comm_Neighbors called before Comm_Init");
+  pcu_msg_neighbors(pcu_get_msg(), ranks, n);
+}
+
+/** \brief Begins a PCU communication phase among neighbors only.
+  \details This is the counterpart of PCU_Comm_Begin for phases in
+  which each rank only sends to ranks in its set from PCU_Comm_Neighbors.
+  Instead of the global termination barrier, each rank receives one
+  message from each neighbor, so the phase costs no global
+  synchronization.
+  All threads in the MPI job must call this function in place of
+  PCU_Comm_Begin for the same phase, and packing to
+  a non-neighbor during the phase is an error.
+*/
+void PCU_Comm_Begin_Neighbors(void)
+{
+  if (global_state == uninit)
+    reel_fail("Comm_Begin_Neighbors called before Comm_Init");
+  pcu_profile_begin("(neighbors)");
+  pcu_msg_start_neighbors(pcu_get_msg());
+  pcu_profile_begun();
+}
+
+/** \brief Runs neighbor phases as MPI neighborhood collectives.
+  \details While on, PCU_Comm_Begin_Neighbors phases are carried out
+  over an MPI distributed graph topology built from the neighbor sets,
+  using MPI_Neighbor_alltoall for message sizes and
+  MPI_Neighbor_alltoallv for the messages themselves.
+  This suits programs that run many phases over the same
+  neighbor graph.
+  While on, PCU_Comm_Neighbors becomes a collective call, and the
+  graph is rebuilt only if some rank's set changed.
+  Phases are the same to the user either way, and without MPI-3
+  they stay point-to-point.
+  This function must be called by all ranks between phases,
+  and it is not available inside PCU_Thrd_Run.
+ */
+void PCU_Comm_Graph(bool on)
+{
+  if (global_state == uninit)
+    reel_fail("Comm_Graph called before Comm_Init");
+  if (pcu_thread_running())
+    reel_fail("Comm_Graph called inside PCU_Thrd_Run");
+  pcu_msg_graph(pcu_get_msg(), on);
 }
 
 /** \brief Packs data to be sent to \a to_rank.
@@ -138,10 +245,33 @@ int PCU_Comm_Pack(int to_rank, const void* data, size_t size)
     reel_fail("Comm_Pack called before Comm_Init");
   if ((to_rank < 0)||(to_rank >= pcu_mpi_size()))
     reel_fail("Invalid rank in Comm_Pack");
-  memcpy(pcu_msg_pack(get_msg(),to_rank,size),data,size);
+  memcpy(pcu_msg_pack(pcu_get_msg(),to_rank,size),data,size);
   return PCU_SUCCESS;
 }
 
+/** \brief Reserves \a size bytes at the end of the buffer to \a to_rank.
+  \details This is the bulk version of PCU_Comm_Pack:
+  instead of copying data in, the caller gets the address of
+  \a size bytes to fill directly, so whole arrays can be written
+  with one buffer growth check.
+  The address is only valid until the next pack or reserve to
+  \a to_rank, which may move the buffer.
+  It is aligned to the start of the buffer plus the bytes
+  already packed to \a to_rank, so it is only safe to write through
+  a typed pointer if those bytes are a multiple of the type's size;
+  see PCU_COMM_RESERVE.
+  This function should be called after PCU_Comm_Start and before
+  PCU_Comm_Send.
+ */
+void* PCU_Comm_Reserve(int to_rank, size_t size)
+{
+  if (global_state == uninit)
+    reel_fail("Comm_Reserve called before Comm_Init");
+  if ((to_rank < 0)||(to_rank >= pcu_mpi_size()))
+    reel_fail("Invalid rank in Comm_Reserve");
+  return pcu_msg_pack(pcu_get_msg(),to_rank,size);
+}
+
 /** \brief Sends all buffers for this communication phase.
   \details This function should be called by all threads in the MPI job
   after calls to PCU_Comm_Pack or PCU_Comm_Write and before calls
@@ -153,7 +283,11 @@ int PCU_Comm_Send(void)
 {
   if (global_state == uninit)
     reel_fail("Comm_Send called before Comm_Init");
-  pcu_msg_send(get_msg());
+  pcu_msg* m = pcu_get_msg();
+  size_t raw = m->raw_bytes;
+  size_t wire = m->wire_bytes;
+  pcu_msg_send(m);
+  pcu_profile_send(m->peer_count, m->raw_bytes - raw, m->wire_bytes - wire);
   return PCU_SUCCESS;
 }
 
@@ -172,10 +306,21 @@ bool PCU_Comm_Listen(void)
 {
   if (global_state == uninit)
     reel_fail("Comm_Listen called before Comm_Init");
-  pcu_msg* m = get_msg();
-  if (m->order)
-    return pcu_order_receive(m->order, m);
-  return pcu_msg_receive(m);
+  pcu_msg* m = pcu_get_msg();
+  pcu_profile_listen();
+  bool received;
+  size_t size = 0;
+  if (m->order) {
+    received = pcu_order_receive(m->order, m);
+    if (received)
+      size = pcu_order_received_size(m->order);
+  } else {
+    received = pcu_msg_receive(m);
+    if (received)
+      size = pcu_msg_received_size(m);
+  }
+  pcu_profile_listened(received, size);
+  return received;
 }
 
 /** \brief Returns in * \a from_rank the sender of the current received buffer.
@@ -185,7 +330,7 @@ int PCU_Comm_Sender(void)
 {
   if (global_state == uninit)
     reel_fail("Comm_Sender called before Comm_Init");
-  pcu_msg* m = get_msg();
+  pcu_msg* m = pcu_get_msg();
   if (m->order)
     return pcu_order_received_from(m->order);
   return pcu_msg_received_from(m);
@@ -198,7 +343,7 @@ bool PCU_Comm_Unpacked(void)
 {
   if (global_state == uninit)
     reel_fail("Comm_Unpacked called before Comm_Init");
-  pcu_msg* m = get_msg();
+  pcu_msg* m = pcu_get_msg();
   if (m->order)
     return pcu_order_unpacked(m->order);
   return pcu_msg_unpacked(m);
@@ -218,7 +363,7 @@ int PCU_Comm_Unpack(void* data, size_t size)
 {
   if (global_state == uninit)
     reel_fail("Comm_Unpack called before Comm_Init");
-  pcu_msg* m = get_msg();
+  pcu_msg* m = pcu_get_msg();
   if (m->order)
     memcpy(data,pcu_order_unpack(m->order,size),size);
   else
@@ -230,7 +375,7 @@ void PCU_Comm_Order(bool on)
 {
   if (global_state == uninit)
     reel_fail("Comm_Order called before Comm_Init");
-  pcu_msg* m = get_msg();
+  pcu_msg* m = pcu_get_msg();
   if (on && (!m->order))
     m->order = pcu_order_new();
   if ((!on) && m->order) {
@@ -239,12 +384,52 @@ void PCU_Comm_Order(bool on)
   }
 }
 
+bool PCU_Comm_Ordered(void)
+{
+  if (global_state == uninit)
+    reel_fail("Comm_Ordered called before Comm_Init");
+  return pcu_get_msg()->order != NULL;
+}
+
+/** \brief Compresses messages of at least \a threshold bytes.
+  \details Messages sent by this rank whose packed size is at least
+  \a threshold bytes are compressed before sending and restored
+  on arrival, which trades some CPU time for network bandwidth.
+  Messages that do not shrink are sent as packed.
+  A \a threshold of zero stops this rank from compressing.
+  Compression is invisible to the rest of the API.
+  This is a collective call that should be made between
+  communication phases, ranks may pass different thresholds.
+ */
+void PCU_Comm_Compress(size_t threshold)
+{
+  if (global_state == uninit)
+    reel_fail("Comm_Compress called before Comm_Init");
+  bool framed = PCU_Or(threshold != 0);
+  pcu_msg_compress(pcu_get_msg(),threshold,framed);
+}
+
+/** \brief Returns the number of bytes sent by this rank so far.
+  \details \a raw is the number of bytes packed by the user and
+  \a wire is the number actually sent, after compression
+  (see PCU_Comm_Compress) and its small per-message overhead.
+  Both count all phases since PCU_Comm_Init.
+ */
+void PCU_Comm_Traffic(size_t* raw, size_t* wire)
+{
+  if (global_state == uninit)
+    reel_fail("Comm_Traffic called before Comm_Init");
+  pcu_msg* m = pcu_get_msg();
+  *raw = m->raw_bytes;
+  *wire = m->wire_bytes;
+}
+
 /** \brief Blocking barrier over all threads. */
 void PCU_Barrier(void)
 {
   if (global_state == uninit)
     reel_fail("Barrier called before Comm_Init");
-  pcu_barrier(&(get_msg()->coll));
+  pcu_barrier(&(pcu_get_msg()->coll));
 }
 
 /** \brief Performs an Allreduce sum of double arrays.
@@ -257,7 +442,7 @@ void PCU_Add_Doubles(double* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Add_Doubles called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_add_doubles,p,n*sizeof(double));
+  pcu_allreduce(&(pcu_get_msg()->coll),pcu_add_doubles,p,n*sizeof(double));
 }
 
 double PCU_Add_Double(double x)
@@ -274,7 +459,7 @@ void PCU_Min_Doubles(double* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Min_Doubles called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_min_doubles,p,n*sizeof(double));
+  pcu_allreduce(&(pcu_get_msg()->coll),pcu_min_doubles,p,n*sizeof(double));
 }
 
 double PCU_Min_Double(double x)
@@ -291,7 +476,7 @@ void PCU_Max_Doubles(double* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Max_Doubles called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_max_doubles,p,n*sizeof(double));
+  pcu_allreduce(&(pcu_get_msg()->coll),pcu_max_doubles,p,n*sizeof(double));
 }
 
 double PCU_Max_Double(double x)
@@ -308,7 +493,7 @@ void PCU_Add_Ints(int* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Add_Ints called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_add_ints,p,n*sizeof(int));
+  pcu_allreduce(&(pcu_get_msg()->coll),pcu_add_ints,p,n*sizeof(int));
 }
 
 int PCU_Add_Int(int x)
@@ -325,7 +510,7 @@ void PCU_Add_Longs(long* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Add_Longs called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_add_longs,p,n*sizeof(long));
+  pcu_allreduce(&(pcu_get_msg()->coll),pcu_add_longs,p,n*sizeof(long));
 }
 
 long PCU_Add_Long(long x)
@@ -342,7 +527,7 @@ void PCU_Add_SizeTs(size_t* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Add_SizeTs called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_add_sizets,p,n*sizeof(size_t));
+  pcu_allreduce(&(pcu_get_msg()->coll),pcu_add_sizets,p,n*sizeof(size_t));
 }
 
 size_t PCU_Add_SizeT(size_t x)
@@ -358,7 +543,7 @@ size_t PCU_Add_SizeT(size_t x)
 void PCU_Min_SizeTs(size_t* p, size_t n) {
   if (global_state == uninit)
     reel_fail("Min_SizeTs called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_min_sizets,p,n*sizeof(size_t));
+  pcu_allreduce(&(pcu_get_msg()->coll),pcu_min_sizets,p,n*sizeof(size_t));
 }
 
 size_t PCU_Min_SizeT(size_t x) {
@@ -373,7 +558,7 @@ size_t PCU_Min_SizeT(size_t x) {
 void PCU_Max_SizeTs(size_t* p, size_t n) {
   if (global_state == uninit)
     reel_fail("Max_SizeTs called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_max_sizets,p,n*sizeof(size_t));
+  pcu_allreduce(&(pcu_get_msg()->coll),pcu_max_sizets,p,n*sizeof(size_t));
 }
 
 size_t PCU_Max_SizeT(size_t x) {
@@ -397,7 +582,7 @@ void PCU_Exscan_Ints(int* p, size_t n)
   NOTO_MALLOC(originals,n);
   for (size_t i=0; i < n; ++i)
     originals[i] = p[i];
-  pcu_scan(&(get_msg()->coll),pcu_add_ints,p,n*sizeof(int));
+  pcu_scan(&(pcu_get_msg()->coll),pcu_add_ints,p,n*sizeof(int));
   //convert inclusive scan to exclusive
   for (size_t i=0; i < n; ++i)
     p[i] -= originals[i];
@@ -421,7 +606,7 @@ void PCU_Exscan_Longs(long* p, size_t n)
   NOTO_MALLOC(originals,n);
   for (size_t i=0; i < n; ++i)
     originals[i] = p[i];
-  pcu_scan(&(get_msg()->coll),pcu_add_longs,p,n*sizeof(long));
+  pcu_scan(&(pcu_get_msg()->coll),pcu_add_longs,p,n*sizeof(long));
   //convert inclusive scan to exclusive
   for (size_t i=0; i < n; ++i)
     p[i] -= originals[i];
@@ -442,7 +627,7 @@ void PCU_Min_Ints(int* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Min_Ints called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_min_ints,p,n*sizeof(int));
+  pcu_allreduce(&(pcu_get_msg()->coll),pcu_min_ints,p,n*sizeof(int));
 }
 
 int PCU_Min_Int(int x)
@@ -459,7 +644,7 @@ void PCU_Max_Ints(int* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Max_Ints called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_max_ints,p,n*sizeof(int));
+  pcu_allreduce(&(pcu_get_msg()->coll),pcu_max_ints,p,n*sizeof(int));
 }
 
 int PCU_Max_Int(int x)
@@ -534,7 +719,9 @@ int PCU_Comm_Start(PCU_Method method)
   (void)method; //warning silencer
   if (global_state == uninit)
     reel_fail("Comm_Start called before Comm_Init");
-  pcu_msg_start(get_msg());
+  pcu_profile_begin(NULL);
+  pcu_msg_start(pcu_get_msg());
+  pcu_profile_begun();
   return PCU_SUCCESS;
 }
 
@@ -549,7 +736,7 @@ int PCU_Comm_Packed(int to_rank, size_t* size)
     reel_fail("Comm_Packed called before Comm_Init");
   if ((to_rank < 0)||(to_rank >= pcu_mpi_size()))
     reel_fail("Invalid rank in Comm_Packed");
-  *size = pcu_msg_packed(get_msg(),to_rank);
+  *size = pcu_msg_packed(pcu_get_msg(),to_rank);
   return PCU_SUCCESS;
 }
 
@@ -568,7 +755,7 @@ int PCU_Comm_Write(int to_rank, const void* data, size_t size)
     reel_fail("Comm_Write called before Comm_Init");
   if ((to_rank < 0)||(to_rank >= pcu_mpi_size()))
     reel_fail("Invalid rank in Comm_Write");
-  pcu_msg* msg = get_msg();
+  pcu_msg* msg = pcu_get_msg();
   PCU_MSG_PACK(msg,to_rank,size);
   memcpy(pcu_msg_pack(msg,to_rank,size),data,size);
   return PCU_SUCCESS;
@@ -646,7 +833,7 @@ void PCU_Debug_Open(void)
   }
 
   append(path,bufsize, "%s", "debug");
-  pcu_msg* msg = get_msg();
+  pcu_msg* msg = pcu_get_msg();
   if ( ! msg->file)
     msg->file = pcu_open_parallel(path,"txt");
   noto_free(path);
@@ -657,7 +844,7 @@ void PCU_Debug_Print(const char* format, ...)
 {
   if (global_state == uninit)
     reel_fail("Debug_Print called before Comm_Init");
-  pcu_msg* msg = get_msg();
+  pcu_msg* msg = pcu_get_msg();
   if ( ! msg->file)
     return; //Print is a no-op if no file is open
   va_list ap;
@@ -672,7 +859,7 @@ int PCU_Comm_From(int* from_rank)
 {
   if (global_state == uninit)
     reel_fail("Comm_From called before Comm_Init");
-  pcu_msg* m = get_msg();
+  pcu_msg* m = pcu_get_msg();
   if (m->order)
     *from_rank = pcu_order_received_from(m->order);
   else
@@ -689,7 +876,7 @@ int PCU_Comm_Received(size_t* size)
 {
   if (global_state == uninit)
     reel_fail("Comm_Received called before Comm_Init");
-  pcu_msg* m = get_msg();
+  pcu_msg* m = pcu_get_msg();
   if (m->order)
     *size = pcu_order_received_size(m->order);
   else
@@ -701,13 +888,16 @@ int PCU_Comm_Received(size_t* size)
   \details This function should be called after a successful PCU_Comm_Receive.
   The next \a size bytes of the current received buffer are unpacked,
   and an internal pointer to that data is returned.
+  This is the zero-copy counterpart of PCU_Comm_Unpack, the data
+  stays valid until the next call to PCU_Comm_Listen or PCU_Comm_Receive.
+  The alignment rules of PCU_Comm_Reserve apply to the returned address.
   The returned pointer must not be freed by the user.
  */
 void* PCU_Comm_Extract(size_t size)
 {
   if (global_state == uninit)
     reel_fail("Comm_Extract called before Comm_Init");
-  pcu_msg* m = get_msg();
+  pcu_msg* m = pcu_get_msg();
   if (m->order)
     return pcu_order_unpack(m->order,size);
   return pcu_msg_unpack(m,size);
@@ -724,6 +914,11 @@ void PCU_Switch_Comm(MPI_Comm new_comm)
 {
   if (global_state == uninit)
     reel_fail("Switch_Comm called before Comm_Init");
+  if (pcu_thread_running())
+    reel_fail("Switch_Comm called inside PCU_Thrd_Run");
+  pcu_msg_graph(pcu_get_msg(), false);
+  if (pcu_phase_any())
+    reel_fail("Switch_Comm called with PCU phases in flight");
   pcu_pmpi_switch(new_comm);
 }
 
@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include "pcu_buffer.h"
 #include "noto_malloc.h"
+#include "PCU.h"
 #include "reel.h"
 
 void pcu_make_buffer(pcu_buffer* b)
@@ -34,7 +35,7 @@ void* pcu_push_buffer(pcu_buffer* b, size_t size)
     b->capacity = b->size;
     if (min_growth > b->capacity)
       b->capacity = min_growth;
-    b->start = noto_realloc(b->start, b->capacity);
+    b->start = noto_realloc_in(PCU_MEM_PCU_BUFFERS, b->start, b->capacity);
   }
   return b->start + b->size - size;
 }
@@ -62,7 +63,7 @@ void pcu_resize_buffer(pcu_buffer* b, size_t size)
 {
   if (b->size == size && b->capacity == size) return;
   b->size = b->capacity = size;
-  b->start = noto_realloc(b->start,size);
+  b->start = noto_realloc_in(PCU_MEM_PCU_BUFFERS, b->start, size);
 }
 
 void pcu_set_buffer(pcu_buffer* b, void* p, size_t size)
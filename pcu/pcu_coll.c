@@ -9,6 +9,7 @@
 *******************************************************************************/
 #include "pcu_coll.h"
 #include "pcu_pmpi.h"
+#include "noto_malloc.h"
 #include "reel.h"
 #include <string.h>
 
@@ -128,12 +129,12 @@ void pcu_add_longs(void* local, void* incoming, size_t size)
    communication step */
 static void begin_coll_step(pcu_coll* c)
 {
-  int action = c->pattern->action(c->bit);
+  int action = c->pattern->action(&(c->group),c->bit);
   if (action == pcu_coll_idle)
     return;
-  c->message.peer = c->pattern->peer(c->bit);
+  c->message.peer = c->pattern->peer(&(c->group),c->bit);
   if (action == pcu_coll_send)
-    pcu_mpi_send(&(c->message),pcu_coll_comm);
+    pcu_mpi_send(&(c->message),c->group.comm);
 }
 
 /* tries to complete this communication step.
@@ -142,15 +143,15 @@ static void begin_coll_step(pcu_coll* c)
    if necessary, and returns true */
 static bool end_coll_step(pcu_coll* c)
 {
-  int action = c->pattern->action(c->bit);
+  int action = c->pattern->action(&(c->group),c->bit);
   if (action == pcu_coll_idle)
     return true;
   if (action == pcu_coll_send)
     return pcu_mpi_done(&(c->message));
   pcu_message incoming;
   pcu_make_message(&incoming);
-  incoming.peer = c->pattern->peer(c->bit);
-  if ( ! pcu_mpi_receive(&incoming,pcu_coll_comm))
+  incoming.peer = c->pattern->peer(&(c->group),c->bit);
+  if ( ! pcu_mpi_receive(&incoming,c->group.comm))
     return false;
   if (c->message.buffer.size != incoming.buffer.size)
     reel_fail("PCU unexpected incoming message.\n"
@@ -160,10 +161,27 @@ static bool end_coll_step(pcu_coll* c)
   return true;
 }
 
+static void make_group(pcu_group* g, MPI_Comm comm)
+{
+  g->comm = comm;
+  MPI_Comm_rank(comm,&(g->rank));
+  MPI_Comm_size(comm,&(g->size));
+}
+
+static void make_world(pcu_group* g)
+{
+  g->comm = pcu_coll_comm;
+  g->rank = pcu_mpi_rank();
+  g->size = pcu_mpi_size();
+}
+
+/* collectives run over all ranks unless
+   the group is changed after this call */
 void pcu_make_coll(pcu_coll* c, pcu_pattern* p, pcu_merge* m)
 {
   c->pattern = p;
   c->merge = m;
+  make_world(&(c->group));
 }
 
 /* the abstract algorithm for a collective communication
@@ -188,8 +206,8 @@ void pcu_make_coll(pcu_coll* c, pcu_pattern* p, pcu_merge* m)
 void pcu_begin_coll(pcu_coll* c, void* data, size_t size)
 {
   pcu_set_buffer(&(c->message.buffer),data,size);
-  c->bit = c->pattern->begin_bit();
-  if (c->pattern->end_bit(c->bit))
+  c->bit = c->pattern->begin_bit(&(c->group));
+  if (c->pattern->end_bit(&(c->group),c->bit))
     return;
   begin_coll_step(c);
 }
@@ -199,12 +217,12 @@ void pcu_begin_coll(pcu_coll* c, void* data, size_t size)
    returns false if its done. */
 bool pcu_progress_coll(pcu_coll* c)
 {
-  if (c->pattern->end_bit(c->bit))
+  if (c->pattern->end_bit(&(c->group),c->bit))
     return false;
   if (end_coll_step(c))
   {
     c->bit = c->pattern->shift(c->bit);
-    if (c->pattern->end_bit(c->bit))
+    if (c->pattern->end_bit(&(c->group),c->bit))
       return false;
     begin_coll_step(c);
   }
@@ -215,29 +233,30 @@ bool pcu_progress_coll(pcu_coll* c)
    then odd multiples of 2 into even ones, etc...
    until rank 0 has all inputs merged */
 
-static int reduce_begin_bit(void)
+static int reduce_begin_bit(pcu_group* g)
 {
+  (void)g;
   return 1;
 }
 
-static bool reduce_end_bit(int bit)
+static bool reduce_end_bit(pcu_group* g, int bit)
 {
-  int rank = pcu_mpi_rank();
+  int rank = g->rank;
   if (rank==0)
-    return bit >= pcu_mpi_size();
+    return bit >= g->size;
   return (bit>>1) & rank;
 }
 
-static int reduce_peer(int bit)
+static int reduce_peer(pcu_group* g, int bit)
 {
-  return pcu_mpi_rank() ^ bit;
+  return g->rank ^ bit;
 }
 
-static int reduce_action(int bit)
+static int reduce_action(pcu_group* g, int bit)
 {
-  if (reduce_peer(bit) >= pcu_mpi_size())
+  if (reduce_peer(g,bit) >= g->size)
     return pcu_coll_idle;
-  if (bit & pcu_mpi_rank())
+  if (bit & g->rank)
     return pcu_coll_send;
   return pcu_coll_recv;
 }
@@ -260,31 +279,32 @@ static pcu_pattern reduce =
    the pattern runs backwards and send/recv
    are flipped. */
 
-static int bcast_begin_bit(void)
+static int bcast_begin_bit(pcu_group* g)
 {
-  int rank = pcu_mpi_rank();
+  int rank = g->rank;
   if (rank == 0)
-    return 1 << ceil_log2(pcu_mpi_size());
+    return 1 << ceil_log2(g->size);
   int bit = 1;
   while ( ! (bit & rank)) bit <<= 1;
   return bit;
 }
 
-static bool bcast_end_bit(int bit)
+static bool bcast_end_bit(pcu_group* g, int bit)
 {
+  (void)g;
   return bit == 0;
 }
 
-static int bcast_peer(int bit)
+static int bcast_peer(pcu_group* g, int bit)
 {
-  return pcu_mpi_rank() ^ bit;
+  return g->rank ^ bit;
 }
 
-static int bcast_action(int bit)
+static int bcast_action(pcu_group* g, int bit)
 {
-  if (bcast_peer(bit) >= pcu_mpi_size())
+  if (bcast_peer(g,bit) >= g->size)
     return pcu_coll_idle;
-  if (bit & pcu_mpi_rank())
+  if (bit & g->rank)
     return pcu_coll_recv;
   return pcu_coll_send;
 }
@@ -310,14 +330,15 @@ static pcu_pattern bcast =
    "Parallel Prefix (Scan) Algorithms for MPI".
 */
 
-static int scan_up_begin_bit(void)
+static int scan_up_begin_bit(pcu_group* g)
 {
+  (void)g;
   return 1;
 }
 
-static bool scan_up_end_bit(int bit)
+static bool scan_up_end_bit(pcu_group* g, int bit)
 {
-  return bit == (1 << floor_log2(pcu_mpi_size()));
+  return bit == (1 << floor_log2(g->size));
 }
 
 static bool scan_up_could_receive(int rank, int bit)
@@ -336,28 +357,28 @@ static int scan_up_receiver_for(int rank, int bit)
   return rank + bit;
 }
 
-static int scan_up_action(int bit)
+static int scan_up_action(pcu_group* g, int bit)
 {
-  int rank = pcu_mpi_rank();
+  int rank = g->rank;
   if ((scan_up_could_receive(rank,bit))&&
       (0 <= scan_up_sender_for(rank,bit)))
     return pcu_coll_recv;
   int receiver = scan_up_receiver_for(rank,bit);
-  if ((receiver < pcu_mpi_size())&&
+  if ((receiver < g->size)&&
       (scan_up_could_receive(receiver,bit)))
     return pcu_coll_send;
   return pcu_coll_idle;
 }
 
-static int scan_up_peer(int bit)
+static int scan_up_peer(pcu_group* g, int bit)
 {
-  int rank = pcu_mpi_rank();
+  int rank = g->rank;
   int sender = scan_up_sender_for(rank,bit);
   if ((scan_up_could_receive(rank,bit))&&
       (0 <= sender))
     return sender;
   int receiver = scan_up_receiver_for(rank,bit);
-  if ((receiver < pcu_mpi_size())&&
+  if ((receiver < g->size)&&
       (scan_up_could_receive(receiver,bit)))
     return receiver;
   return -1;
@@ -377,13 +398,14 @@ static pcu_pattern scan_up =
   .shift = scan_up_shift,
 };
 
-static int scan_down_begin_bit(void)
+static int scan_down_begin_bit(pcu_group* g)
 {
-  return 1 << floor_log2(pcu_mpi_size());
+  return 1 << floor_log2(g->size);
 }
 
-static bool scan_down_end_bit(int bit)
+static bool scan_down_end_bit(pcu_group* g, int bit)
 {
+  (void)g;
   return bit == 1;
 }
 
@@ -403,11 +425,11 @@ static int scan_down_sender_for(int rank, int bit)
   return rank - (bit >> 1);
 }
 
-static int scan_down_action(int bit)
+static int scan_down_action(pcu_group* g, int bit)
 {
-  int rank = pcu_mpi_rank();
+  int rank = g->rank;
   if ((scan_down_could_send(rank,bit))&&
-      (scan_down_receiver_for(rank,bit) < pcu_mpi_size()))
+      (scan_down_receiver_for(rank,bit) < g->size))
     return pcu_coll_send;
   int sender = scan_down_sender_for(rank,bit);
   if ((0 <= sender)&&
@@ -416,13 +438,13 @@ static int scan_down_action(int bit)
   return pcu_coll_idle;
 }
 
-static int scan_down_peer(int bit)
+static int scan_down_peer(pcu_group* g, int bit)
 {
-  int rank = pcu_mpi_rank();
+  int rank = g->rank;
   if (scan_down_could_send(rank,bit))
   {
     int receiver = scan_down_receiver_for(rank,bit);
-    if (receiver < pcu_mpi_size())
+    if (receiver < g->size)
       return receiver;
   }
   int sender = scan_down_sender_for(rank,bit);
@@ -446,18 +468,50 @@ static pcu_pattern scan_down =
   .shift = scan_down_shift,
 };
 
-void pcu_reduce(pcu_coll* c, pcu_merge* m, void* data, size_t size)
+static void run_coll(pcu_coll* c, pcu_pattern* p, pcu_merge* m,
+    MPI_Comm comm, void* data, size_t size)
 {
-  pcu_make_coll(c,&reduce,m);
+  pcu_make_coll(c,p,m);
+  if (comm != pcu_coll_comm)
+    make_group(&(c->group),comm);
   pcu_begin_coll(c,data,size);
   while(pcu_progress_coll(c));
 }
 
+/* node groups are made of MPI ranks, so they only
+   apply when each PCU rank is an MPI rank (not in thread mode) */
+static bool use_nodes(void)
+{
+  return pcu_pmpi_hierarchical() && (pcu_get_mpi() == &pcu_pmpi);
+}
+
+static bool is_leader(void)
+{
+  return pcu_leader_comm != MPI_COMM_NULL;
+}
+
+/* the lowest rank overall is the leader of the first node and
+   the first of the leaders, so rank 0 ends up with the result */
+void pcu_reduce(pcu_coll* c, pcu_merge* m, void* data, size_t size)
+{
+  if (!use_nodes()) {
+    run_coll(c,&reduce,m,pcu_coll_comm,data,size);
+    return;
+  }
+  run_coll(c,&reduce,m,pcu_node_comm,data,size);
+  if (is_leader())
+    run_coll(c,&reduce,m,pcu_leader_comm,data,size);
+}
+
 void pcu_bcast(pcu_coll* c, void* data, size_t size)
 {
-  pcu_make_coll(c,&bcast,pcu_merge_assign);
-  pcu_begin_coll(c,data,size);
-  while(pcu_progress_coll(c));
+  if (!use_nodes()) {
+    run_coll(c,&bcast,pcu_merge_assign,pcu_coll_comm,data,size);
+    return;
+  }
+  if (is_leader())
+    run_coll(c,&bcast,pcu_merge_assign,pcu_leader_comm,data,size);
+  run_coll(c,&bcast,pcu_merge_assign,pcu_node_comm,data,size);
 }
 
 void pcu_allreduce(pcu_coll* c, pcu_merge* m, void* data, size_t size)
@@ -466,14 +520,63 @@ void pcu_allreduce(pcu_coll* c, pcu_merge* m, void* data, size_t size)
   pcu_bcast(c,data,size);
 }
 
+static void flat_scan(pcu_coll* c, pcu_merge* m,
+    MPI_Comm comm, void* data, size_t size)
+{
+  run_coll(c,&scan_up,m,comm,data,size);
+  run_coll(c,&scan_down,m,comm,data,size);
+}
+
+/* leader i sends its inclusive prefix to leader i+1,
+   which is the offset for all ranks on node i+1 */
+static void shift_leaders(void* prefix, void* offset, size_t size)
+{
+  pcu_group g;
+  make_group(&g,pcu_leader_comm);
+  pcu_message out;
+  pcu_make_message(&out);
+  if (g.rank + 1 < g.size) {
+    pcu_set_buffer(&(out.buffer),prefix,size);
+    out.peer = g.rank + 1;
+    pcu_mpi_send(&out,g.comm);
+  }
+  if (g.rank) {
+    pcu_message in;
+    pcu_make_message(&in);
+    in.peer = g.rank - 1;
+    while ( ! pcu_mpi_receive(&in,g.comm));
+    memcpy(offset,in.buffer.start,size);
+    pcu_free_message(&in);
+  }
+  if (g.rank + 1 < g.size)
+    while ( ! pcu_mpi_done(&out));
+}
+
+/* scan within each node, then scan the node totals over the
+   leaders and merge the total of all previous nodes into every
+   rank. This relies on the merge being commutative, which
+   all the pcu_merge operations are. */
 void pcu_scan(pcu_coll* c, pcu_merge* m, void* data, size_t size)
 {
-  pcu_make_coll(c,&scan_up,m);
-  pcu_begin_coll(c,data,size);
-  while(pcu_progress_coll(c));
-  pcu_make_coll(c,&scan_down,m);
-  pcu_begin_coll(c,data,size);
-  while(pcu_progress_coll(c));
+  if ((!use_nodes()) || (!pcu_pmpi_nodes_contiguous())) {
+    flat_scan(c,m,pcu_coll_comm,data,size);
+    return;
+  }
+  char* total = noto_malloc(size);
+  char* offset = noto_malloc(size);
+  if (size)
+    memcpy(total,data,size);
+  run_coll(c,&reduce,m,pcu_node_comm,total,size);
+  flat_scan(c,m,pcu_node_comm,data,size);
+  if (is_leader()) {
+    flat_scan(c,m,pcu_leader_comm,total,size);
+    shift_leaders(total,offset,size);
+  }
+  run_coll(c,&bcast,pcu_merge_assign,pcu_node_comm,offset,size);
+  if (pcu_pmpi_node_index())
+    m(data,offset,size);
+  noto_free(total);
+  noto_free(offset);
 }
 
 /* a barrier is just an allreduce of nothing in particular */
@@ -499,6 +602,5 @@ bool pcu_barrier_done(pcu_coll* c)
 
 void pcu_barrier(pcu_coll* c)
 {
-  pcu_begin_barrier(c);
-  while( ! pcu_barrier_done(c));
+  pcu_allreduce(c,pcu_merge_assign,NULL,0);
 }
@@ -47,6 +47,16 @@ enum
   pcu_coll_idle
 };
 
+/* A group of ranks that a collective runs over:
+   either all ranks or a subset with its own communicator,
+   like the ranks on one node or the leaders of all nodes. */
+typedef struct
+{
+  MPI_Comm comm;
+  int rank;
+  int size;
+} pcu_group;
+
 /* The pcu_pattern is an abstraction of a communication
    pattern that takes O(lg(n)) steps for n peers,
    and at each step (rank) communicates with (rank +- 2^k)
@@ -56,10 +66,10 @@ enum
  */
 typedef struct
 {
-  int (*begin_bit)(void); //initialize state bit
-  bool (*end_bit)(int bit); //return true if bit is one past the last
-  int (*action)(int bit); //return action enum for this step
-  int (*peer)(int bit); //return the peer to communicate with
+  int (*begin_bit)(pcu_group* g); //initialize state bit
+  bool (*end_bit)(pcu_group* g, int bit); //true if bit is one past the last
+  int (*action)(pcu_group* g, int bit); //return action enum for this step
+  int (*peer)(pcu_group* g, int bit); //return the peer to communicate with
   int (*shift)(int bit); //shift the bit up or down
 } pcu_pattern;
 
@@ -68,6 +78,7 @@ typedef struct
 typedef struct
 {
   pcu_pattern* pattern; //communication pattern controller
+  pcu_group group; //ranks taking part in the operation
   pcu_merge* merge; //merge operation
   pcu_message message; //local data being operated on
   int bit; //pattern's state bit
@@ -78,11 +89,15 @@ void pcu_begin_coll(pcu_coll* c, void* data, size_t size);
 //returns false when done
 bool pcu_progress_coll(pcu_coll* c);
 
+/* the blocking collectives below are node-aware when the job spans
+   several multi-rank nodes: they run over the ranks of each node first
+   and then over one leader rank per node */
 void pcu_reduce(pcu_coll* c, pcu_merge* m, void* data, size_t size);
 void pcu_bcast(pcu_coll* c, void* data, size_t size);
 void pcu_allreduce(pcu_coll* c, pcu_merge* m, void* data, size_t size);
 void pcu_scan(pcu_coll* c, pcu_merge* m, void* data, size_t size);
 
+/* the non-blocking barrier always runs over all ranks */
 void pcu_begin_barrier(pcu_coll* c);
 bool pcu_barrier_done(pcu_coll* c);
 void pcu_barrier(pcu_coll* c);
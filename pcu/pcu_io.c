@@ -23,13 +23,32 @@
 #include <bzlib.h>
 #endif
 
+#ifdef PCU_ZLIB
+#include <zlib.h>
+#endif
+
+#include <unistd.h>
+
+/* bytes of the stdio buffer of each file */
+#define PCU_FILE_BUFFER (1 << 22)
+
 typedef struct pcu_file {
   FILE* f;
 #ifdef PCU_BZIP
   BZFILE* bzf;
+#endif
+#ifdef PCU_ZLIB
+  gzFile gzf;
 #endif
   bool write;
-  bool compress;
+  int compress;
+  /* the stdio buffer of a file */
+  char* buf;
+  /* the buffer behind a memory file */
+  char* mem;
+  size_t mem_size;
+  /* the kind for the I/O statistics, negative for memory files */
+  int kind;
 } pcu_file;
 
 #ifdef PCU_BZIP
@@ -150,6 +169,81 @@ static void close_compressed(pcu_file* pf)
 
 #endif
 
+#ifdef PCU_ZLIB
+
+static void open_gzip(pcu_file* pf)
+{
+  /* gzclose closes its own descriptor, fclose the original */
+  pf->gzf = gzdopen(dup(fileno(pf->f)), pf->write ? "wb1" : "rb");
+  if (!pf->gzf)
+    reel_fail("gzdopen failed");
+  gzbuffer(pf->gzf, PCU_FILE_BUFFER);
+}
+
+/* gzread and gzwrite count bytes in an int */
+#define PCU_GZIP_CHUNK (1 << 30)
+
+static void gzip_read(pcu_file* pf, void* data, size_t size)
+{
+  char* p = data;
+  unsigned n;
+  for (; size; size -= n, p += n) {
+    n = size < PCU_GZIP_CHUNK ? size : PCU_GZIP_CHUNK;
+    if (gzread(pf->gzf, p, n) != (int)n)
+      reel_fail("gzread of %u bytes failed", n);
+  }
+}
+
+static void gzip_write(pcu_file* pf, void const* data, size_t size)
+{
+  char const* p = data;
+  unsigned n;
+  for (; size; size -= n, p += n) {
+    n = size < PCU_GZIP_CHUNK ? size : PCU_GZIP_CHUNK;
+    if (gzwrite(pf->gzf, p, n) != (int)n)
+      reel_fail("gzwrite of %u bytes failed", n);
+  }
+}
+
+static void close_gzip(pcu_file* pf)
+{
+  int err = gzclose(pf->gzf);
+  if (err != Z_OK)
+    reel_fail("gzclose failed with code %d", err);
+}
+
+#else
+
+static void open_gzip(pcu_file* pf)
+{
+  (void)pf;
+  reel_fail("recompile PCU with -DPCU_ZLIB=ON");
+}
+
+static void gzip_read(pcu_file* pf, void* data, size_t size)
+{
+  (void)pf;
+  (void)data;
+  (void)size;
+  reel_fail("recompile PCU with -DPCU_ZLIB=ON");
+}
+
+static void gzip_write(pcu_file* pf, void const* data, size_t size)
+{
+  (void)pf;
+  (void)data;
+  (void)size;
+  reel_fail("recompile PCU with -DPCU_ZLIB=ON");
+}
+
+static void close_gzip(pcu_file* pf)
+{
+  (void)pf;
+  reel_fail("recompile PCU with -DPCU_ZLIB=ON");
+}
+
+#endif
+
 /**
  * brief limit the number of ranks that can call fopen simultaneously
  * remark Argonne's GPFS filesystem is failing to open some files when
@@ -181,51 +275,188 @@ FILE* pcu_group_open(const char* path, bool write) {
   return fp;
 }
 
-pcu_file* pcu_fopen(const char* name, bool write, bool compress)
+pcu_file* pcu_fopen(const char* name, bool write, int compress)
+{
+  return pcu_fopen_kind(name, write, compress, PCU_IO_OTHER);
+}
+
+pcu_file* pcu_fopen_kind(const char* name, bool write, int compress,
+    int kind)
 {
+  double start = pcu_io_time();
   pcu_file* pf = (pcu_file*) malloc(sizeof(pcu_file));
   pf->compress = compress;
   pf->write = write;
+  pf->mem = NULL;
+  pf->mem_size = 0;
+  pf->kind = kind;
   pf->f = pcu_group_open(name, write);
   if (!pf->f) {
     perror("pcu_fopen");
     reel_fail("pcu_fopen couldn't open \"%s\"", name);
   }
-  if(compress)
+  /* files are mostly written and read in many small pieces */
+  pf->buf = malloc(PCU_FILE_BUFFER);
+  setvbuf(pf->f, pf->buf, _IOFBF, PCU_FILE_BUFFER);
+  if (compress == PCU_GZIP)
+    open_gzip(pf);
+  else if (compress)
     open_compressed(pf);
+  pcu_io_opened(kind, start);
   return pf;
 }
 
 void pcu_fclose(pcu_file* pf)
 {
-  if (pf->compress)
+  double start = pcu_io_time();
+  int kind = pf->kind;
+  if (pf->compress == PCU_GZIP)
+    close_gzip(pf);
+  else if (pf->compress)
     close_compressed(pf);
   fclose(pf->f);
+  free(pf->buf);
+  free(pf->mem);
+  free(pf);
+  pcu_io_closed(kind, start);
+}
+
+pcu_file* pcu_fopen_memory(char* data, size_t size)
+{
+  pcu_file* pf = (pcu_file*) malloc(sizeof(pcu_file));
+  pf->compress = PCU_PLAIN;
+  pf->write = false;
+  pf->buf = NULL;
+  pf->mem = data;
+  pf->mem_size = size;
+  pf->kind = -1;
+  /* fmemopen refuses an empty buffer */
+  pf->f = fmemopen(data, size ? size : 1, "r");
+  if (!pf->f)
+    reel_fail("pcu_fopen_memory couldn't open %lu bytes", size);
+  return pf;
+}
+
+pcu_file* pcu_fopen_memstream(void)
+{
+  pcu_file* pf = (pcu_file*) malloc(sizeof(pcu_file));
+  pf->compress = PCU_PLAIN;
+  pf->write = true;
+  pf->buf = NULL;
+  pf->mem = NULL;
+  pf->mem_size = 0;
+  pf->kind = -1;
+  pf->f = open_memstream(&pf->mem, &pf->mem_size);
+  if (!pf->f)
+    reel_fail("pcu_fopen_memstream failed");
+  return pf;
+}
+
+void pcu_fclose_memstream(pcu_file* pf, char** data, size_t* size)
+{
+  fclose(pf->f);
+  *data = pf->mem;
+  *size = pf->mem_size;
   free(pf);
 }
 
+#ifdef PCU_ZLIB
+
+bool pcu_can_deflate(void)
+{
+  return true;
+}
+
+size_t pcu_deflate(const char* in, size_t n, char** out)
+{
+  uLongf len = compressBound(n);
+  *out = malloc(len);
+  if (compress2((Bytef*)*out, &len, (const Bytef*)in, n, Z_BEST_SPEED) != Z_OK)
+    reel_fail("pcu_deflate: compress2 failed on %lu bytes", n);
+  return len;
+}
+
+void pcu_inflate(const char* in, size_t n, char* out, size_t out_n)
+{
+  uLongf len = out_n;
+  if (uncompress((Bytef*)out, &len, (const Bytef*)in, n) != Z_OK ||
+      len != out_n)
+    reel_fail("pcu_inflate: uncompress failed on %lu bytes", n);
+}
+
+#else
+
+bool pcu_can_deflate(void)
+{
+  return false;
+}
+
+size_t pcu_deflate(const char* in, size_t n, char** out)
+{
+  (void)in;
+  (void)n;
+  (void)out;
+  reel_fail("recompile PCU with -DPCU_ZLIB=ON");
+  return 0;
+}
+
+void pcu_inflate(const char* in, size_t n, char* out, size_t out_n)
+{
+  (void)in;
+  (void)n;
+  (void)out;
+  (void)out_n;
+  reel_fail("recompile PCU with -DPCU_ZLIB=ON");
+}
+
+#endif
+
 void pcu_fwrite(void const* p, size_t size, size_t nmemb, pcu_file * f)
 {
+  double start = pcu_io_time();
   if (!f->write)
     reel_fail("pcu_fwrite: file not opened for writing.");
-  if (f->compress) {
+  if (f->compress == PCU_GZIP) {
+    gzip_write(f, p, size * nmemb);
+  } else if (f->compress) {
     compressed_write(f, p, size * nmemb);
   } else {
     if (nmemb != fwrite(p, size, nmemb, f->f))
       reel_fail("fwrite(%p, %lu, %lu, %p) failed", p, size, nmemb, (void*) f->f);
   }
+  pcu_io_wrote(f->kind, size * nmemb, start);
 }
 
 void pcu_fread(void* p, size_t size, size_t nmemb, pcu_file * f)
 {
+  double start = pcu_io_time();
   if (f->write)
     reel_fail("pcu_fread: file not opened for reading.");
-  if (f->compress) {
+  if (f->compress == PCU_GZIP) {
+    gzip_read(f, p, size * nmemb);
+  } else if (f->compress) {
     compressed_read(f, p, size * nmemb);
   } else {
     if (nmemb != fread(p, size, nmemb, f->f))
       reel_fail("fread(%p, %lu, %lu, %p) failed", p, size, nmemb, (void*) f->f);
   }
+  pcu_io_read(f->kind, size * nmemb, start);
+}
+
+/* positioning only works on uncompressed files */
+long pcu_ftell(pcu_file* f)
+{
+  if (f->compress)
+    reel_fail("pcu_ftell: file is compressed.");
+  return ftell(f->f);
+}
+
+void pcu_fseek(pcu_file* f, long offset)
+{
+  if (f->compress)
+    reel_fail("pcu_fseek: file is compressed.");
+  if (fseek(f->f, offset, SEEK_SET))
+    reel_fail("fseek(%p, %ld) failed", (void*) f->f, offset);
 }
 
 void pcu_read(pcu_file* f, char* p, size_t n)
@@ -243,58 +474,61 @@ static const uint16_t pcu_endian_value = 1;
 #define PCU_BIG_ENDIAN 0
 #define PCU_ENCODED_ENDIAN PCU_BIG_ENDIAN //consistent with network byte order
 
-static void pcu_swap_16(uint16_t* p)
-{
-  uint8_t* p2 = (uint8_t*)p;
-  uint8_t temp = p2[0];
-  p2[0] = p2[1];
-  p2[1] = temp;
-}
-
-static void pcu_swap_32(uint32_t* p)
+/* whole words are swapped in registers, which compilers vectorize */
+#if defined(__GNUC__) || defined(__clang__)
+#define pcu_bswap_32 __builtin_bswap32
+#define pcu_bswap_64 __builtin_bswap64
+#else
+static uint32_t pcu_bswap_32(uint32_t x)
 {
-  uint16_t* p2 = (uint16_t*)p;
-  uint16_t temp = p2[0];
-  p2[0] = p2[1];
-  p2[1] = temp;
-  pcu_swap_16(p2);
-  pcu_swap_16(p2+1);
+  return (x >> 24) | ((x >> 8) & 0xFF00) | ((x << 8) & 0xFF0000) | (x << 24);
 }
 
-static void pcu_swap_64(uint32_t* p)
+static uint64_t pcu_bswap_64(uint64_t x)
 {
-  uint32_t temp = p[0];
-  p[0] = p[1];
-  p[1] = temp;
-  pcu_swap_32(p);
-  pcu_swap_32(p+1);
+  return ((uint64_t)pcu_bswap_32(x) << 32) | pcu_bswap_32(x >> 32);
 }
+#endif
 
 void pcu_swap_unsigneds(unsigned* p, size_t n)
 {
+  uint32_t x;
   PCU_ALWAYS_ASSERT(sizeof(unsigned)==4);
-  for (size_t i=0; i < n; ++i)
-    pcu_swap_32(p++);
+  for (size_t i=0; i < n; ++i) {
+    memcpy(&x, p + i, sizeof(x));
+    x = pcu_bswap_32(x);
+    memcpy(p + i, &x, sizeof(x));
+  }
 }
 
 void pcu_swap_doubles(double* p, size_t n)
 {
+  uint64_t x;
   PCU_ALWAYS_ASSERT(sizeof(double)==8);
-  for (size_t i=0; i < n; ++i)
-    pcu_swap_64((uint32_t*)(p++));
+  for (size_t i=0; i < n; ++i) {
+    memcpy(&x, p + i, sizeof(x));
+    x = pcu_bswap_64(x);
+    memcpy(p + i, &x, sizeof(x));
+  }
 }
 
+/* swapped copies are written through a buffer of this many bytes */
+#define PCU_SWAP_CHUNK 65536
+
 void pcu_write_unsigneds(pcu_file* f, unsigned* p, size_t n)
 {
-  unsigned* tmp;
+  unsigned tmp[PCU_SWAP_CHUNK / sizeof(unsigned)];
+  size_t m;
   if (n)
     PCU_ALWAYS_ASSERT(p != 0);
   if (PCU_ENDIANNESS != PCU_ENCODED_ENDIAN) {
-    tmp = malloc(n * sizeof(unsigned));
-    memcpy(tmp, p, n * sizeof(unsigned));
-    pcu_swap_unsigneds(tmp, n);
-    pcu_fwrite(tmp,sizeof(unsigned),n,f);
-    free(tmp);
+    for (; n; n -= m, p += m) {
+      m = n < PCU_SWAP_CHUNK / sizeof(unsigned) ?
+        n : PCU_SWAP_CHUNK / sizeof(unsigned);
+      memcpy(tmp, p, m * sizeof(unsigned));
+      pcu_swap_unsigneds(tmp, m);
+      pcu_fwrite(tmp,sizeof(unsigned),m,f);
+    }
   } else {
     pcu_fwrite(p,sizeof(unsigned),n,f);
   }
@@ -302,15 +536,18 @@ void pcu_write_unsigneds(pcu_file* f, unsigned* p, size_t n)
 
 void pcu_write_doubles(pcu_file* f, double* p, size_t n)
 {
-  double* tmp;
+  double tmp[PCU_SWAP_CHUNK / sizeof(double)];
+  size_t m;
   if (n)
     PCU_ALWAYS_ASSERT(p != 0);
   if (PCU_ENDIANNESS != PCU_ENCODED_ENDIAN) {
-    tmp = malloc(n * sizeof(double));
-    memcpy(tmp, p, n * sizeof(double));
-    pcu_swap_doubles(tmp, n);
-    pcu_fwrite(tmp,sizeof(double),n,f);
-    free(tmp);
+    for (; n; n -= m, p += m) {
+      m = n < PCU_SWAP_CHUNK / sizeof(double) ?
+        n : PCU_SWAP_CHUNK / sizeof(double);
+      memcpy(tmp, p, m * sizeof(double));
+      pcu_swap_doubles(tmp, m);
+      pcu_fwrite(tmp,sizeof(double),m,f);
+    }
   } else {
     pcu_fwrite(p,sizeof(double),n,f);
   }
@@ -340,8 +577,10 @@ void pcu_read_string (pcu_file* f, char ** p)
     c = buf.start + buf.size - 1;
     pcu_read(f,c,1);
   } while (*c != '\0');
-  pcu_resize_buffer(&buf,buf.size);
-  *p = buf.start;
+  /* callers free the string */
+  *p = malloc(buf.size);
+  memcpy(*p, buf.start, buf.size);
+  pcu_free_buffer(&buf);
 }
 
 void pcu_write_string (pcu_file * f, const char * p)
@@ -362,3 +601,33 @@ FILE* pcu_open_parallel(const char* prefix, const char* ext)
   noto_free(path);
   return file;
 }
+
+/* the most bytes of one collective call of pcu_io_transfer_all */
+#define PCU_TRANSFER_ROUND_BYTES ((size_t)1 << 30)
+
+void pcu_io_transfer_all(MPI_File fh, MPI_Comm comm, MPI_Offset offset,
+    char* data, size_t size, bool write, int kind)
+{
+  double start = pcu_io_time();
+  unsigned long long rounds =
+    (size + PCU_TRANSFER_ROUND_BYTES - 1) / PCU_TRANSFER_ROUND_BYTES;
+  MPI_Allreduce(MPI_IN_PLACE, &rounds, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX,
+      comm);
+  size_t done = 0;
+  for (unsigned long long r = 0; r < rounds; ++r) {
+    size_t left = size - done;
+    int n = left < PCU_TRANSFER_ROUND_BYTES ? left : PCU_TRANSFER_ROUND_BYTES;
+    char* p = n ? data + done : NULL;
+    if (write)
+      MPI_File_write_at_all(fh, offset + done, p, n, MPI_BYTE,
+          MPI_STATUS_IGNORE);
+    else
+      MPI_File_read_at_all(fh, offset + done, p, n, MPI_BYTE,
+          MPI_STATUS_IGNORE);
+    done += n;
+  }
+  if (write)
+    pcu_io_wrote(kind, size, start);
+  else
+    pcu_io_read(kind, size, start);
+}
@@ -10,6 +10,7 @@
 #ifndef PCU_IO_H
 #define PCU_IO_H
 
+#include <mpi.h>
 
 #ifdef __cplusplus
 #include <cstdio>
@@ -21,7 +22,37 @@ extern "C" {
 
 struct pcu_file;
 
-struct pcu_file* pcu_fopen(const char* path, bool write, bool compress);
+/* the compress argument of pcu_fopen */
+enum {
+  PCU_PLAIN,
+  PCU_BZIP2,
+  PCU_GZIP
+};
+
+/* kinds of files for the I/O statistics, see PCU_IO_Stats */
+enum {
+  PCU_IO_SMB,
+  PCU_IO_VTK,
+  PCU_IO_PHASTA,
+  PCU_IO_MODEL,
+  PCU_IO_OTHER,
+  PCU_IO_KINDS
+};
+
+/* hooks for the readers and writers of each kind of file, given
+   the time pcu_io_time returned before the operation. They do
+   nothing, and pcu_io_time returns zero, unless the statistics
+   are on. Files of pcu_fopen are recorded as they are used. */
+double pcu_io_time(void);
+void pcu_io_opened(int kind, double start);
+void pcu_io_closed(int kind, double start);
+void pcu_io_read(int kind, size_t bytes, double start);
+void pcu_io_wrote(int kind, size_t bytes, double start);
+
+struct pcu_file* pcu_fopen(const char* path, bool write, int compress);
+/* pcu_fopen for files recorded as (kind) rather than PCU_IO_OTHER */
+struct pcu_file* pcu_fopen_kind(const char* path, bool write, int compress,
+    int kind);
 void pcu_fclose (struct pcu_file * pf);
 void pcu_read(struct pcu_file* f, char* p, size_t n);
 void pcu_write(struct pcu_file* f, const char* p, size_t n);
@@ -33,10 +64,31 @@ void pcu_read_doubles(struct pcu_file* f, double* p, size_t n);
 void pcu_write_doubles(struct pcu_file* f, double* p, size_t n);
 void pcu_read_string(struct pcu_file* f, char** p);
 void pcu_write_string(struct pcu_file* f, const char* p);
+long pcu_ftell(struct pcu_file* f);
+void pcu_fseek(struct pcu_file* f, long offset);
+
+/* memory files read from (data), which pcu_fclose frees, or write
+   to a buffer handed back by pcu_fclose_memstream */
+struct pcu_file* pcu_fopen_memory(char* data, size_t size);
+struct pcu_file* pcu_fopen_memstream(void);
+void pcu_fclose_memstream(struct pcu_file* f, char** data, size_t* size);
+
+/* zlib buffers, available if PCU was built with PCU_ZLIB */
+bool pcu_can_deflate(void);
+size_t pcu_deflate(const char* in, size_t n, char** out);
+void pcu_inflate(const char* in, size_t n, char* out, size_t out_n);
 
 FILE* pcu_open_parallel(const char* prefix, const char* ext);
 FILE* pcu_group_open(const char* path, bool write);
 
+/* writes or reads (size) bytes at (offset) of (fh) with collective
+   MPI-IO calls that every rank of (comm) joins. MPI counts are ints,
+   so long transfers go in rounds of at most 1GB, and ranks with fewer
+   rounds join the rest with empty ones. The bytes are recorded as
+   (kind) for the I/O statistics. */
+void pcu_io_transfer_all(MPI_File fh, MPI_Comm comm, MPI_Offset offset,
+    char* data, size_t size, bool write, int kind);
+
 void pcu_swap_doubles(double* p, size_t n);
 void pcu_swap_unsigneds(unsigned* p, size_t n);
 
@@ -0,0 +1,208 @@
+/******************************************************************************
+
+  Copyright 2011 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#include "pcu_iostats.h"
+#include "PCU.h"
+#include "reel.h"
+#include "pcu_io.h"
+#include "pcu_msg.h"
+#include "pcu_thread.h"
+#include "pcu_mpi.h"
+#include <pthread.h>
+#include <stdio.h>
+
+/* statistics of one kind of file, summed over its files */
+enum {
+  opens_stat,
+  read_bytes_stat,
+  written_bytes_stat,
+  open_stat, //seconds opening
+  close_stat, //seconds closing, which includes flushing
+  read_stat, //seconds reading
+  write_stat, //seconds writing
+  stat_count
+};
+
+static const char* const stat_names[stat_count] = {
+  "files",
+  "read bytes",
+  "written bytes",
+  "open seconds",
+  "close seconds",
+  "read seconds",
+  "write seconds"
+};
+
+static const char* const kind_names[PCU_IO_KINDS] = {
+  "smb",
+  "vtk",
+  "phasta",
+  "model",
+  "other"
+};
+
+static bool enabled = false;
+static double stats[PCU_IO_KINDS][stat_count];
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+void pcu_iostats_enable(bool on)
+{
+  enabled = on;
+}
+
+bool pcu_iostats_enabled(void)
+{
+  return enabled;
+}
+
+double pcu_io_time(void)
+{
+  if (!enabled)
+    return 0;
+  return MPI_Wtime();
+}
+
+static void add(int kind, int stat, double value, int time_stat,
+    double start)
+{
+  if (!enabled || kind < 0 || kind >= PCU_IO_KINDS)
+    return;
+  double seconds = MPI_Wtime() - start;
+  pthread_mutex_lock(&lock);
+  stats[kind][stat] += value;
+  stats[kind][time_stat] += seconds;
+  pthread_mutex_unlock(&lock);
+}
+
+void pcu_io_opened(int kind, double start)
+{
+  add(kind, opens_stat, 1, open_stat, start);
+}
+
+void pcu_io_closed(int kind, double start)
+{
+  add(kind, opens_stat, 0, close_stat, start);
+}
+
+void pcu_io_read(int kind, size_t bytes, double start)
+{
+  add(kind, read_bytes_stat, bytes, read_stat, start);
+}
+
+void pcu_io_wrote(int kind, size_t bytes, double start)
+{
+  add(kind, written_bytes_stat, bytes, write_stat, start);
+}
+
+static void print_row(const char* name, double min, double avg,
+    double max)
+{
+  printf("  %-16s %14.6g %14.6g %14.6g\n", name, min, avg, max);
+}
+
+/* bytes per second of one rank, or zero if it spent no time */
+static double get_rate(double bytes, double seconds)
+{
+  return seconds > 0 ? bytes / seconds : 0;
+}
+
+void pcu_iostats_report(pcu_coll* c)
+{
+  if (!enabled)
+    return;
+  bool root = !pcu_mpi_rank();
+  /* the stats and the two bandwidths of each kind */
+  enum { width = stat_count + 2 };
+  size_t n = PCU_IO_KINDS * width;
+  double min[PCU_IO_KINDS * width];
+  double max[PCU_IO_KINDS * width];
+  double sum[PCU_IO_KINDS * width];
+  pthread_mutex_lock(&lock);
+  for (int i = 0; i < PCU_IO_KINDS; ++i) {
+    double* s = sum + i * width;
+    for (int j = 0; j < stat_count; ++j)
+      s[j] = stats[i][j];
+    s[stat_count] = get_rate(s[read_bytes_stat], s[read_stat]);
+    s[stat_count + 1] = get_rate(s[written_bytes_stat], s[write_stat]);
+  }
+  pthread_mutex_unlock(&lock);
+  for (size_t k = 0; k < n; ++k)
+    min[k] = max[k] = sum[k];
+  pcu_allreduce(c, pcu_min_doubles, min, n * sizeof(double));
+  pcu_allreduce(c, pcu_max_doubles, max, n * sizeof(double));
+  pcu_allreduce(c, pcu_add_doubles, sum, n * sizeof(double));
+  if (!root)
+    return;
+  int ranks = pcu_mpi_size();
+  printf("PCU I/O statistics over %d ranks\n", ranks);
+  for (int i = 0; i < PCU_IO_KINDS; ++i) {
+    size_t k = i * width;
+    if (!sum[k + opens_stat] && !sum[k + read_bytes_stat] &&
+        !sum[k + written_bytes_stat])
+      continue;
+    printf("%s files\n", kind_names[i]);
+    printf("  %-16s %14s %14s %14s\n", "per rank", "min", "avg", "max");
+    for (int j = 0; j < stat_count; ++j)
+      print_row(stat_names[j], min[k + j], sum[k + j] / ranks, max[k + j]);
+    print_row("read bytes/s", min[k + stat_count],
+        sum[k + stat_count] / ranks, max[k + stat_count]);
+    print_row("write bytes/s", min[k + stat_count + 1],
+        sum[k + stat_count + 1] / ranks, max[k + stat_count + 1]);
+    /* the job moves all the bytes in the time of the slowest rank */
+    printf("  %-16s %14.6g\n", "job read B/s",
+        get_rate(sum[k + read_bytes_stat], max[k + read_stat]));
+    printf("  %-16s %14.6g\n", "job write B/s",
+        get_rate(sum[k + written_bytes_stat], max[k + write_stat]));
+  }
+}
+
+void pcu_iostats_reset(void)
+{
+  pthread_mutex_lock(&lock);
+  for (int i = 0; i < PCU_IO_KINDS; ++i)
+    for (int j = 0; j < stat_count; ++j)
+      stats[i][j] = 0;
+  pthread_mutex_unlock(&lock);
+}
+
+/** \brief Turns the I/O statistics on or off.
+  \details While on, the smb, vtk, phasta and model readers and
+  writers, and all files of pcu_fopen, count the files they open,
+  the bytes they read and write and the seconds they spend opening,
+  reading, writing and closing, by kind of file.
+  The statistics are kept per process and include writes on
+  background threads.
+  PCU_IO_Report prints them, as does PCU_Comm_Free.
+  They are also turned on by setting the PCU_IO_STATS environment
+  variable to anything but 0.
+ */
+void PCU_IO_Stats(bool on)
+{
+  if (!PCU_Comm_Initialized())
+    reel_fail("IO_Stats called before Comm_Init");
+  pcu_iostats_enable(on);
+}
+
+/** \brief Prints the I/O statistics and starts them over.
+  \details Rank 0 prints, for each kind of file, the minimum,
+  average and maximum over ranks of each statistic and of the
+  bandwidth of each rank, and the bandwidth of the job: all the
+  bytes over the time of the slowest rank.
+  This function must be called by all ranks, outside PCU_Thrd_Run,
+  and does nothing if the statistics are off.
+ */
+void PCU_IO_Report(void)
+{
+  if (!PCU_Comm_Initialized())
+    reel_fail("IO_Report called before Comm_Init");
+  if (pcu_thread_running())
+    reel_fail("IO_Report called inside PCU_Thrd_Run");
+  pcu_iostats_report(&(pcu_get_msg()->coll));
+  pcu_iostats_reset();
+}
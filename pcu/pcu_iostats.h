@@ -0,0 +1,27 @@
+/******************************************************************************
+
+  Copyright 2011 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#ifndef PCU_IOSTATS_H
+#define PCU_IOSTATS_H
+
+#include "pcu_coll.h"
+
+/* the I/O statistics accumulate the opens, closes, reads and writes
+   that the readers and writers of the libraries report through the
+   hooks in pcu_io.h, by kind of file, and report them across ranks.
+   Unlike the profiler, they are kept per process, so that writes
+   on background threads count too. */
+
+void pcu_iostats_enable(bool on);
+bool pcu_iostats_enabled(void);
+/* collective, prints the table from rank 0 */
+void pcu_iostats_report(pcu_coll* c);
+void pcu_iostats_reset(void);
+
+#endif
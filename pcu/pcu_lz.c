@@ -0,0 +1,169 @@
+/******************************************************************************
+
+  Copyright 2011 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#include "pcu_lz.h"
+#include "reel.h"
+#include <stdint.h>
+#include <string.h>
+
+/* the format is a series of sequences, each one being:
+
+   token: high 4 bits literal count, low 4 bits match length - MIN_MATCH.
+          a nibble of 15 means more length bytes follow,
+          each adding up to 255, the first byte below 255 ends them.
+   [literal length bytes]
+   literals
+   offset: 2 bytes little endian, distance back to the match
+   [match length bytes]
+
+   the last sequence stops after its literals. */
+
+enum {
+  MIN_MATCH = 4,
+  MAX_OFFSET = 65535,
+  HASH_BITS = 12,
+  /* after this many misses in a row the search starts
+     skipping ahead, so incompressible data passes quickly */
+  SKIP_TRIGGER = 6
+};
+
+static uint32_t read32(const unsigned char* p)
+{
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static unsigned hash(uint32_t v)
+{
+  return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+size_t pcu_lz_bound(size_t n)
+{
+  return n + n / 255 + 16;
+}
+
+static unsigned char* put_length(unsigned char* op, size_t length)
+{
+  for (; length >= 255; length -= 255)
+    *op++ = 255;
+  *op++ = (unsigned char)length;
+  return op;
+}
+
+/* a match_length of zero marks the last sequence */
+static unsigned char* put_sequence(unsigned char* op,
+    const unsigned char* literals, size_t literal_length,
+    size_t match_length, size_t offset)
+{
+  unsigned char* token = op++;
+  *token = (unsigned char)((literal_length < 15 ? literal_length : 15) << 4);
+  if (literal_length >= 15)
+    op = put_length(op, literal_length - 15);
+  memcpy(op, literals, literal_length);
+  op += literal_length;
+  if (!match_length)
+    return op;
+  *op++ = (unsigned char)(offset & 0xFF);
+  *op++ = (unsigned char)(offset >> 8);
+  size_t extra = match_length - MIN_MATCH;
+  *token |= (unsigned char)(extra < 15 ? extra : 15);
+  if (extra >= 15)
+    op = put_length(op, extra - 15);
+  return op;
+}
+
+size_t pcu_lz_compress(const void* in, size_t n, void* out)
+{
+  const unsigned char* src = in;
+  unsigned char* op = out;
+  size_t table[1 << HASH_BITS];
+  memset(table, 0, sizeof(table));
+  size_t anchor = 0;
+  size_t ip = 0;
+  size_t misses = 0;
+  while (ip + MIN_MATCH <= n) {
+    uint32_t v = read32(src + ip);
+    unsigned h = hash(v);
+    size_t candidate = table[h];
+    table[h] = ip;
+    if ((candidate < ip) && (ip - candidate <= MAX_OFFSET) &&
+        (read32(src + candidate) == v)) {
+      size_t length = MIN_MATCH;
+      while ((ip + length < n) && (src[candidate + length] == src[ip + length]))
+        ++length;
+      op = put_sequence(op, src + anchor, ip - anchor, length, ip - candidate);
+      ip += length;
+      anchor = ip;
+      misses = 0;
+    } else {
+      ip += 1 + (misses++ >> SKIP_TRIGGER);
+    }
+  }
+  op = put_sequence(op, src + anchor, n - anchor, 0, 0);
+  return (size_t)(op - (unsigned char*)out);
+}
+
+static size_t get_length(const unsigned char** ip, const unsigned char* end)
+{
+  size_t length = 0;
+  unsigned char byte;
+  do {
+    if (*ip == end)
+      reel_fail("pcu_lz_decompress: truncated length");
+    byte = *(*ip)++;
+    length += byte;
+  } while (byte == 255);
+  return length;
+}
+
+void pcu_lz_decompress(const void* in, size_t n, void* out, size_t raw)
+{
+  const unsigned char* ip = in;
+  const unsigned char* end = ip + n;
+  unsigned char* start = out;
+  unsigned char* op = start;
+  unsigned char* oend = op + raw;
+  for (;;) {
+    if (ip == end)
+      reel_fail("pcu_lz_decompress: missing token");
+    unsigned token = *ip++;
+    size_t length = token >> 4;
+    if (length == 15)
+      length += get_length(&ip, end);
+    if ((length > (size_t)(end - ip)) || (length > (size_t)(oend - op)))
+      reel_fail("pcu_lz_decompress: literals out of bounds");
+    memcpy(op, ip, length);
+    op += length;
+    ip += length;
+    if (ip == end)
+      break;
+    if (end - ip < 2)
+      reel_fail("pcu_lz_decompress: truncated offset");
+    size_t offset = ip[0] | ((size_t)ip[1] << 8);
+    ip += 2;
+    length = token & 15;
+    if (length == 15)
+      length += get_length(&ip, end);
+    length += MIN_MATCH;
+    if ((!offset) || (offset > (size_t)(op - start)) ||
+        (length > (size_t)(oend - op)))
+      reel_fail("pcu_lz_decompress: match out of bounds");
+    const unsigned char* match = op - offset;
+    if (offset >= length)
+      memcpy(op, match, length);
+    else /* overlapping matches repeat the last (offset) bytes */
+      for (size_t i = 0; i < length; ++i)
+        op[i] = match[i];
+    op += length;
+  }
+  if (op != oend)
+    reel_fail("pcu_lz_decompress: wrong uncompressed size");
+}
@@ -0,0 +1,27 @@
+/******************************************************************************
+
+  Copyright 2011 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#ifndef PCU_LZ_H
+#define PCU_LZ_H
+
+#include <stddef.h>
+
+/* a small LZ77 codec in the style of LZ4, used to compress
+   message payloads. It favors speed over ratio: one hash probe per
+   position and no entropy coding, which is enough to squeeze
+   the repeated ids and small integers of mesh messages. */
+
+/* the most bytes pcu_lz_compress can write for (n) input bytes */
+size_t pcu_lz_bound(size_t n);
+/* compresses (n) bytes from (in) to (out), returns the compressed size */
+size_t pcu_lz_compress(const void* in, size_t n, void* out);
+/* restores exactly (raw) bytes to (out) from (n) compressed bytes */
+void pcu_lz_decompress(const void* in, size_t n, void* out, size_t raw);
+
+#endif
@@ -0,0 +1,94 @@
+/******************************************************************************
+
+  Copyright 2025 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#include "PCU.h"
+#include "noto_malloc.h"
+#include "reel.h"
+#include <stdio.h>
+
+void* PCU_Mem_Alloc(int category, size_t size)
+{
+  return noto_malloc_in(category, size);
+}
+
+void* PCU_Mem_Calloc(int category, size_t count, size_t size)
+{
+  return noto_calloc_in(category, count, size);
+}
+
+void* PCU_Mem_Realloc(int category, void* p, size_t size)
+{
+  return noto_realloc_in(category, p, size);
+}
+
+void PCU_Mem_Free(void* p)
+{
+  noto_free(p);
+}
+
+void PCU_Mem_Charge(void* p, int category)
+{
+  noto_charge(p, category);
+}
+
+void PCU_Mem_Account(int category, long bytes)
+{
+  noto_account(category, bytes);
+}
+
+long PCU_Mem_Current(int category)
+{
+  return noto_current(category);
+}
+
+long PCU_Mem_Peak(int category)
+{
+  return noto_peak(category);
+}
+
+const char* PCU_Mem_Name(int category)
+{
+  static const char* const names[PCU_MEM_CATEGORIES + 1] = {
+    "other",
+    "mds adjacency",
+    "mds coordinates",
+    "mds tags",
+    "mds remotes",
+    "fields",
+    "pcu buffers",
+    "ma",
+    "parma",
+    "total"};
+  if (category < 0 || category > PCU_MEM_ALL)
+    reel_fail("PCU_Mem_Name: invalid category %d", category);
+  return names[category];
+}
+
+void PCU_Mem_Print(void)
+{
+  enum { N = PCU_MEM_CATEGORIES + 1 };
+  long sums[2 * N];
+  double maxs[2 * N];
+  int i;
+  for (i = 0; i < N; ++i) {
+    sums[i] = PCU_Mem_Current(i);
+    sums[N + i] = PCU_Mem_Peak(i);
+    maxs[i] = sums[i];
+    maxs[N + i] = sums[N + i];
+  }
+  PCU_Add_Longs(sums, 2 * N);
+  PCU_Max_Doubles(maxs, 2 * N);
+  if (PCU_Comm_Self())
+    return;
+  printf("memory in MB %16s %10s %10s %10s\n",
+      "current max", "sum", "peak max", "sum");
+  for (i = 0; i < N; ++i)
+    printf("%-23s %10.2f %10.2f %10.2f %10.2f\n", PCU_Mem_Name(i),
+        maxs[i] / 1e6, sums[i] / 1e6, maxs[N + i] / 1e6, sums[N + i] / 1e6);
+}
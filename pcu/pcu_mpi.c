@@ -15,6 +15,7 @@ static pcu_mpi* global_mpi;
 void pcu_make_message(pcu_message* m)
 {
   pcu_make_buffer(&(m->buffer));
+  m->envelope = NULL;
 }
 
 void pcu_free_message(pcu_message* m)
@@ -18,6 +18,7 @@ typedef struct
   pcu_buffer buffer;
   MPI_Request request;
   int peer;
+  struct pcu_envelope_struct* envelope; //in-process delivery, see pcu_thread.c
 } pcu_message;
 
 void pcu_make_message(pcu_message* m);
@@ -9,9 +9,12 @@
 *******************************************************************************/
 #include "pcu_msg.h"
 #include "pcu_pmpi.h"
+#include "pcu_lz.h"
 #include "noto_malloc.h"
 #include "reel.h"
 #include <string.h>
+#include <stdlib.h>
+#include <limits.h>
 
 /* the pcu_msg algorithm for a communication phase
    is as follows:
@@ -50,6 +53,35 @@
    If another rank is notified first and quickly goes on to
    a new phase, it may be able to send a message that is
    received by the slow rank out-of-phase.
+
+   A neighbor phase (pcu_msg_start_neighbors) replaces the
+   termination barrier with counting.
+   Each rank has registered a symmetric set of neighbors and
+   sends exactly one (possibly empty) message to each of them,
+   so a rank is done once it has received one message from
+   each neighbor and its own sends have completed.
+   Messages are received from each neighbor by its specific rank
+   on a separate communicator, so MPI's non-overtaking rule keeps
+   the messages of consecutive neighbor phases apart, and
+   no message of a neighbor phase can be mistaken for one of
+   a global phase.
+   This removes both barriers of the algorithm above.
+
+   With a graph (pcu_msg_graph), neighbor phases instead go through
+   an MPI distributed graph communicator over the neighbor sets:
+   message sizes are exchanged with MPI_Neighbor_alltoall and then
+   all messages at once with MPI_Neighbor_alltoallv, which
+   MPI implementations can schedule better than separate sends.
+   The graph is rebuilt whenever some rank's neighbor set changes,
+   and without MPI-3 neighbor phases stay point-to-point.
+
+   When compression is enabled on all ranks (pcu_msg_compress),
+   each non-empty message ends with a size_t trailer holding
+   its uncompressed size, or zero if it was sent as packed.
+   Messages are compressed just before sending and restored as soon
+   as they are received, so the rest of the algorithm and the
+   user never see compressed data. A trailer rather than a header
+   leaves uncompressed buffers where they are.
 */
 
 //enumeration for pcu_msg.state
@@ -62,29 +94,46 @@ enum {
 
 static void make_comm(pcu_msg* m)
 {
-  pcu_make_aa(&(m->peers));
+  m->peer_count = 0;
+  m->last_peer = -1;
+  for (int i = 0; i < m->slot_count; ++i)
+    m->slots[i] = -1;
   pcu_make_message(&(m->received));
   m->state = idle_state;
+  m->neighborly = false;
 }
 
 void pcu_make_msg(pcu_msg* m)
 {
+  m->peers = NULL;
+  m->peer_capacity = 0;
+  m->slots = NULL;
+  m->slot_count = 0;
   make_comm(m);
+  m->neighbors = NULL;
+  m->neighbor_count = 0;
+  m->pending = NULL;
+  m->pending_count = 0;
+  m->graph = MPI_COMM_NULL;
+  m->send_counts = NULL;
+  m->receive_counts = NULL;
+  m->receive_offsets = NULL;
+  pcu_make_buffer(&(m->graph_buffer));
+  m->graph_at = 0;
+  m->framed = false;
+  m->compress_threshold = 0;
+  m->raw_bytes = 0;
+  m->wire_bytes = 0;
   m->file = NULL;
   m->order = NULL;
 }
 
-static void free_peers(pcu_aa_tree* t)
+/* the peer table keeps its memory between phases,
+   only the send buffers are freed */
+static void free_peers(pcu_msg* m)
 {
-  if (pcu_aa_empty(*t))
-    return;
-  free_peers(&((*t)->left));
-  free_peers(&((*t)->right));
-  pcu_msg_peer* peer;
-  peer = (pcu_msg_peer*) *t;
-  pcu_free_message(&(peer->message));
-  noto_free(peer);
-  pcu_make_aa(t);
+  for (int i = 0; i < m->peer_count; ++i)
+    pcu_free_message(&(m->peers[i].message));
 }
 
 void pcu_msg_start(pcu_msg* m)
@@ -98,38 +147,214 @@ void pcu_msg_start(pcu_msg* m)
   m->state = pack_state;
 }
 
-static bool peer_less(pcu_aa_node* a, pcu_aa_node* b)
+static int compare_ints(const void* a, const void* b)
+{
+  return *((const int*)a) - *((const int*)b);
+}
+
+static void free_graph(pcu_msg* m)
 {
-  return ((pcu_msg_peer*)a)->message.peer
-       < ((pcu_msg_peer*)b)->message.peer;
+  if (m->graph != MPI_COMM_NULL)
+    MPI_Comm_free(&(m->graph));
+  noto_free(m->send_counts);
+  noto_free(m->receive_counts);
+  noto_free(m->receive_offsets);
+  m->send_counts = m->receive_counts = m->receive_offsets = NULL;
 }
 
-static pcu_msg_peer* find_peer(pcu_aa_tree t, int id)
+#if MPI_VERSION >= 3
+static void build_graph(pcu_msg* m)
 {
-  pcu_msg_peer key;
-  key.message.peer = id;
-  return (pcu_msg_peer*) pcu_aa_find(&(key.node),t,peer_less);
+  free_graph(m);
+  int n = m->neighbor_count;
+  NOTO_MALLOC(m->send_counts, n + 1);
+  NOTO_MALLOC(m->receive_counts, n + 1);
+  NOTO_MALLOC(m->receive_offsets, n + 1);
+  /* unit weights rather than MPI_UNWEIGHTED, which some
+     MPI headers define in a way compilers warn about */
+  int* weights = m->send_counts;
+  for (int i = 0; i < n; ++i)
+    weights[i] = 1;
+  MPI_Dist_graph_create_adjacent(pcu_user_comm,
+      n, m->neighbors, weights,
+      n, m->neighbors, weights,
+      MPI_INFO_NULL, 0, &(m->graph));
 }
+#endif
 
-static pcu_msg_peer* make_peer(int id)
+/* collective, but the graph is only rebuilt by
+   a later pcu_msg_neighbors if some rank's set changed */
+void pcu_msg_graph(pcu_msg* m, bool on)
 {
-  pcu_msg_peer* p;
-  NOTO_MALLOC(p,1);
+  if (m->state != idle_state)
+    reel_fail("PCU_Comm_Graph called at the wrong time");
+#if MPI_VERSION >= 3
+  if (on)
+    build_graph(m);
+  else
+    free_graph(m);
+#else
+  (void)on;
+#endif
+}
+
+static bool same_neighbors(pcu_msg* m, const int* old, int old_count)
+{
+  if (old_count != m->neighbor_count)
+    return false;
+  for (int i = 0; i < old_count; ++i)
+    if (old[i] != m->neighbors[i])
+      return false;
+  return true;
+}
+
+static void update_graph(pcu_msg* m, const int* old, int old_count)
+{
+  int changed = !same_neighbors(m, old, old_count);
+  pcu_allreduce(&(m->coll), pcu_max_ints, &changed, sizeof(changed));
+#if MPI_VERSION >= 3
+  if (changed)
+    build_graph(m);
+#endif
+}
+
+/* the neighbor set must be symmetric: if rank a lists b
+   then rank b lists a. */
+void pcu_msg_neighbors(pcu_msg* m, const int* ranks, int n)
+{
+  if (m->state != idle_state)
+    reel_fail("PCU_Comm_Neighbors called at the wrong time");
+  int* old = m->neighbors;
+  int old_count = m->neighbor_count;
+  noto_free(m->pending);
+  NOTO_MALLOC(m->neighbors, n);
+  NOTO_MALLOC(m->pending, n);
+  if (n)
+    memcpy(m->neighbors, ranks, n * sizeof(int));
+  qsort(m->neighbors, n, sizeof(int), compare_ints);
+  int unique = 0;
+  for (int i = 0; i < n; ++i) {
+    if ((m->neighbors[i] < 0) || (m->neighbors[i] >= pcu_mpi_size()))
+      reel_fail("Invalid rank %d in PCU_Comm_Neighbors", m->neighbors[i]);
+    if ((!unique) || (m->neighbors[unique - 1] != m->neighbors[i]))
+      m->neighbors[unique++] = m->neighbors[i];
+  }
+  m->neighbor_count = unique;
+  m->pending_count = 0;
+  if (m->graph != MPI_COMM_NULL)
+    update_graph(m, old, old_count);
+  noto_free(old);
+}
+
+static bool is_neighbor(pcu_msg* m, int id)
+{
+  return bsearch(&id, m->neighbors, m->neighbor_count,
+      sizeof(int), compare_ints) != NULL;
+}
+
+/* no barrier here, see the neighbor phase description above */
+void pcu_msg_start_neighbors(pcu_msg* m)
+{
+  if (m->state != idle_state)
+    reel_fail("PCU_Comm_Begin_Neighbors called at the wrong time");
+  m->neighborly = true;
+  m->state = pack_state;
+}
+
+/* lets a messenger be packed into without any synchronization,
+   for messengers whose exchange is driven elsewhere (pcu_phase) */
+void pcu_msg_open(pcu_msg* m)
+{
+  if (m->state != idle_state)
+    reel_fail("pcu_msg_open called at the wrong time");
+  m->state = pack_state;
+}
+
+/* all ranks must agree on (framed), since it changes the
+   layout of every message, but each rank may use its own
+   (threshold) to decide which of its messages to compress */
+void pcu_msg_compress(pcu_msg* m, size_t threshold, bool framed)
+{
+  if (m->state != idle_state)
+    reel_fail("PCU_Comm_Compress called at the wrong time");
+  m->compress_threshold = threshold;
+  m->framed = framed;
+}
+
+/* Knuth's multiplicative hash, so that strided
+   rank patterns do not cluster in the table */
+static int first_slot(pcu_msg* m, int id)
+{
+  unsigned mask = (unsigned)(m->slot_count - 1);
+  return (int)(((unsigned)id * 2654435761u) & mask);
+}
+
+static int find_slot(pcu_msg* m, int id)
+{
+  int mask = m->slot_count - 1;
+  int slot = first_slot(m, id);
+  while ((m->slots[slot] != -1) &&
+         (m->peers[m->slots[slot]].message.peer != id))
+    slot = (slot + 1) & mask;
+  return slot;
+}
+
+static pcu_msg_peer* find_peer(pcu_msg* m, int id)
+{
+  if ((m->last_peer != -1) &&
+      (m->peers[m->last_peer].message.peer == id))
+    return m->peers + m->last_peer;
+  if (!m->slot_count)
+    return NULL;
+  int i = m->slots[find_slot(m, id)];
+  if (i == -1)
+    return NULL;
+  m->last_peer = i;
+  return m->peers + i;
+}
+
+static void grow_slots(pcu_msg* m)
+{
+  noto_free(m->slots);
+  m->slot_count = m->slot_count ? (m->slot_count * 2) : 16;
+  NOTO_MALLOC(m->slots, m->slot_count);
+  for (int i = 0; i < m->slot_count; ++i)
+    m->slots[i] = -1;
+  for (int i = 0; i < m->peer_count; ++i)
+    m->slots[find_slot(m, m->peers[i].message.peer)] = i;
+}
+
+static pcu_msg_peer* make_peer(pcu_msg* m, int id)
+{
+  if (m->peer_count == m->peer_capacity) {
+    m->peer_capacity = m->peer_capacity ? (m->peer_capacity * 2) : 8;
+    m->peers = noto_realloc(m->peers,
+        m->peer_capacity * sizeof(pcu_msg_peer));
+  }
+  if ((m->peer_count + 1) * 2 > m->slot_count)
+    grow_slots(m);
+  int i = m->peer_count++;
+  pcu_msg_peer* p = m->peers + i;
   pcu_make_message(&(p->message));
   p->message.peer = id;
+  m->slots[find_slot(m, id)] = i;
+  m->last_peer = i;
   return p;
 }
 
+static pcu_msg_peer* get_peer(pcu_msg* m, int id)
+{
+  pcu_msg_peer* peer = find_peer(m, id);
+  if (!peer)
+    peer = make_peer(m, id);
+  return peer;
+}
+
 void* pcu_msg_pack(pcu_msg* m, int id, size_t size)
 {
   if (m->state != pack_state)
     reel_fail("PCU_Comm_Pack called at the wrong time");
-  pcu_msg_peer* peer = find_peer(m->peers,id);
-  if (!peer)
-  {
-    peer = make_peer(id);
-    pcu_aa_insert(&(peer->node),&(m->peers),peer_less);
-  }
+  pcu_msg_peer* peer = get_peer(m,id);
   return pcu_push_buffer(&(peer->message.buffer),size);
 }
 
@@ -137,40 +362,167 @@ size_t pcu_msg_packed(pcu_msg* m, int id)
 {
   if (m->state != pack_state)
     reel_fail("PCU_Comm_Packed called at the wrong time");
-  pcu_msg_peer* peer = find_peer(m->peers,id);
+  pcu_msg_peer* peer = find_peer(m,id);
   if (!peer)
     reel_fail("PCU_Comm_Packed called but nothing was packed");
   return peer->message.buffer.size;
 }
 
-static void send_peers(pcu_aa_tree t)
+/* compressed data is kept only if it is smaller */
+static void encode(pcu_msg* m, pcu_buffer* b)
+{
+  size_t raw = b->size;
+  if (!raw)
+    return;
+  size_t trailer = 0;
+  if (m->compress_threshold && raw >= m->compress_threshold) {
+    pcu_buffer z;
+    pcu_make_buffer(&z);
+    pcu_resize_buffer(&z, pcu_lz_bound(raw) + sizeof(trailer));
+    size_t size = pcu_lz_compress(b->start, raw, z.start);
+    if (size < raw) {
+      pcu_free_buffer(b);
+      *b = z;
+      b->size = size;
+      trailer = raw;
+    } else
+      pcu_free_buffer(&z);
+  }
+  memcpy(pcu_push_buffer(b, sizeof(trailer)), &trailer, sizeof(trailer));
+}
+
+static void decode(pcu_buffer* b)
+{
+  if (!b->size)
+    return;
+  size_t trailer;
+  if (b->size < sizeof(trailer))
+    reel_fail("PCU received a message without a compression trailer");
+  size_t size = b->size - sizeof(trailer);
+  memcpy(&trailer, b->start + size, sizeof(trailer));
+  if (!trailer) {
+    pcu_resize_buffer(b, size);
+    return;
+  }
+  pcu_buffer raw;
+  pcu_make_buffer(&raw);
+  pcu_resize_buffer(&raw, trailer);
+  pcu_lz_decompress(b->start, size, raw.start, trailer);
+  pcu_free_buffer(b);
+  *b = raw;
+}
+
+static void prepare(pcu_msg* m, pcu_buffer* b)
+{
+  m->raw_bytes += b->size;
+  if (m->framed)
+    encode(m, b);
+  m->wire_bytes += b->size;
+}
+
+static void send_peers(pcu_msg* m, MPI_Comm comm)
+{
+  for (int i = 0; i < m->peer_count; ++i) {
+    prepare(m, &(m->peers[i].message.buffer));
+    pcu_mpi_send(&(m->peers[i].message),comm);
+  }
+}
+
+static void check_peers(pcu_msg* m)
+{
+  for (int i = 0; i < m->peer_count; ++i) {
+    int id = m->peers[i].message.peer;
+    if (!is_neighbor(m, id))
+      reel_fail("PCU neighbor phase packed data for non-neighbor %d", id);
+  }
+}
+
+#if MPI_VERSION >= 3
+static int exchange_offsets(int* counts, int* offsets, int n)
+{
+  int total = 0;
+  for (int i = 0; i < n; ++i) {
+    offsets[i] = total;
+    total += counts[i];
+  }
+  return total;
+}
+
+/* the whole exchange happens here, receiving
+   only hands out the pieces of graph_buffer */
+static void send_graph(pcu_msg* m)
 {
-  if (pcu_aa_empty(t))
+  int n = m->neighbor_count;
+  for (int i = 0; i < n; ++i) {
+    pcu_msg_peer* peer = find_peer(m, m->neighbors[i]);
+    m->send_counts[i] = 0;
+    if (peer) {
+      prepare(m, &(peer->message.buffer));
+      if (peer->message.buffer.size > (size_t)INT_MAX)
+        reel_fail("PCU message size exceeds INT_MAX");
+      m->send_counts[i] = (int)(peer->message.buffer.size);
+    }
+  }
+  MPI_Neighbor_alltoall(m->send_counts, 1, MPI_INT,
+      m->receive_counts, 1, MPI_INT, m->graph);
+  int* send_offsets;
+  NOTO_MALLOC(send_offsets, n);
+  pcu_buffer out;
+  pcu_make_buffer(&out);
+  pcu_resize_buffer(&out, exchange_offsets(m->send_counts, send_offsets, n));
+  for (int i = 0; i < n; ++i)
+    if (m->send_counts[i])
+      memcpy(out.start + send_offsets[i],
+          find_peer(m, m->neighbors[i])->message.buffer.start,
+          m->send_counts[i]);
+  pcu_resize_buffer(&(m->graph_buffer),
+      exchange_offsets(m->receive_counts, m->receive_offsets, n));
+  MPI_Neighbor_alltoallv(out.start, m->send_counts, send_offsets, MPI_BYTE,
+      m->graph_buffer.start, m->receive_counts, m->receive_offsets, MPI_BYTE,
+      m->graph);
+  pcu_free_buffer(&out);
+  noto_free(send_offsets);
+  m->graph_at = 0;
+}
+#endif
+
+/* every neighbor gets a message, even an empty one,
+   so that receivers can count them */
+static void send_neighbors(pcu_msg* m)
+{
+  check_peers(m);
+#if MPI_VERSION >= 3
+  if (m->graph != MPI_COMM_NULL) {
+    send_graph(m);
     return;
-  pcu_msg_peer* peer;
-  peer = (pcu_msg_peer*)t;
-  pcu_mpi_send(&(peer->message),pcu_user_comm);
-  send_peers(t->left);
-  send_peers(t->right);
+  }
+#endif
+  for (int i = 0; i < m->neighbor_count; ++i) {
+    int id = m->neighbors[i];
+    get_peer(m, id);
+    m->pending[i] = id;
+  }
+  m->pending_count = m->neighbor_count;
+  send_peers(m, pcu_neighbor_comm);
 }
 
 void pcu_msg_send(pcu_msg* m)
 {
   if (m->state != pack_state)
     reel_fail("PCU_Comm_Send called at the wrong time");
-  send_peers(m->peers);
+  if (m->neighborly)
+    send_neighbors(m);
+  else
+    send_peers(m, pcu_user_comm);
   m->state = send_recv_state;
 }
 
-static bool done_sending_peers(pcu_aa_tree t)
+static bool done_sending_peers(pcu_msg* m)
 {
-  if (pcu_aa_empty(t))
-    return true;
-  pcu_msg_peer* peer;
-  peer = (pcu_msg_peer*)t;
-  return pcu_mpi_done(&(peer->message))
-    && done_sending_peers(t->left)
-    && done_sending_peers(t->right);
+  for (int i = 0; i < m->peer_count; ++i)
+    if ( ! pcu_mpi_done(&(m->peers[i].message)))
+      return false;
+  return true;
 }
 
 static bool receive_global(pcu_msg* m)
@@ -179,7 +531,7 @@ static bool receive_global(pcu_msg* m)
   while ( ! pcu_mpi_receive(&(m->received),pcu_user_comm))
   {
     if (m->state == send_recv_state)
-      if (done_sending_peers(m->peers))
+      if (done_sending_peers(m))
       {
         pcu_begin_barrier(&(m->coll));
         m->state = recv_state;
@@ -188,12 +540,54 @@ static bool receive_global(pcu_msg* m)
       if (pcu_barrier_done(&(m->coll)))
         return false;
   }
+  if (m->framed)
+    decode(&(m->received.buffer));
   return true;
 }
 
+/* empty messages only exist for counting,
+   they are not given to the user */
+static bool receive_graph(pcu_msg* m)
+{
+  while (m->graph_at < m->neighbor_count) {
+    int i = m->graph_at++;
+    int count = m->receive_counts[i];
+    if (!count)
+      continue;
+    m->received.peer = m->neighbors[i];
+    pcu_resize_buffer(&(m->received.buffer), count);
+    memcpy(m->received.buffer.start,
+        m->graph_buffer.start + m->receive_offsets[i], count);
+    if (m->framed)
+      decode(&(m->received.buffer));
+    return true;
+  }
+  return false;
+}
+
+static bool receive_neighbors(pcu_msg* m)
+{
+  if (m->graph != MPI_COMM_NULL)
+    return receive_graph(m);
+  while (m->pending_count) {
+    for (int i = 0; i < m->pending_count; ++i) {
+      m->received.peer = m->pending[i];
+      if (!pcu_mpi_receive(&(m->received),pcu_neighbor_comm))
+        continue;
+      if (m->framed)
+        decode(&(m->received.buffer));
+      m->pending[i--] = m->pending[--(m->pending_count)];
+      if (m->received.buffer.size)
+        return true;
+    }
+  }
+  while ( ! done_sending_peers(m));
+  return false;
+}
+
 static void free_comm(pcu_msg* m)
 {
-  free_peers(&(m->peers));
+  free_peers(m);
   pcu_free_message(&(m->received));
 }
 
@@ -204,7 +598,12 @@ bool pcu_msg_receive(pcu_msg* m)
     reel_fail("PCU_Comm_Receive called at the wrong time");
   if ( ! pcu_msg_unpacked(m))
     reel_fail("PCU_Comm_Receive called before previous message unpacked");
-  if (receive_global(m))
+  bool received;
+  if (m->neighborly)
+    received = receive_neighbors(m);
+  else
+    received = receive_global(m);
+  if (received)
   {
     pcu_begin_buffer(&(m->received.buffer));
     return true;
@@ -238,6 +637,12 @@ size_t pcu_msg_received_size(pcu_msg* m)
 void pcu_free_msg(pcu_msg* m)
 {
   free_comm(m);
+  noto_free(m->peers);
+  noto_free(m->slots);
+  noto_free(m->neighbors);
+  noto_free(m->pending);
+  free_graph(m);
+  pcu_free_buffer(&(m->graph_buffer));
   if (m->file)
     fclose(m->file);
 }
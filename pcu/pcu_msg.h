@@ -11,7 +11,6 @@
 #define PCU_MSG_H
 
 #include "pcu_coll.h"
-#include "pcu_aa.h"
 #include "pcu_io.h"
 
 /* the PCU Messenger (pcu_msg for short) system implements
@@ -23,7 +22,6 @@
    this communication phase. */
 typedef struct
 {
-  pcu_aa_node node; //binary tree node for lookup
   pcu_message message; //send buffer and peer id
 } pcu_msg_peer;
 
@@ -31,10 +29,30 @@ struct pcu_order_struct;
 
 struct pcu_msg_struct
 {
-  pcu_aa_tree peers; //binary tree of send buffers
+  pcu_msg_peer* peers; //send buffers in order of first packing
+  int peer_count;
+  int peer_capacity;
+  int* slots; //open addressing hash table: rank -> index in peers
+  int slot_count; //a power of two, at least twice peer_count
+  int last_peer; //index of the most recently packed peer, or -1
   pcu_message received; //current received buffer
   pcu_coll coll; //collective operation object
   int state; //state within a communication phase
+  bool neighborly; //current phase only talks to the neighbor set
+  int* neighbors; //sorted neighbor ranks, see pcu_msg_neighbors
+  int neighbor_count;
+  int* pending; //neighbors not yet received from in this phase
+  int pending_count;
+  MPI_Comm graph; //topology over the neighbors, see pcu_msg_graph
+  int* send_counts; //bytes to each neighbor in a graph phase
+  int* receive_counts; //bytes from each neighbor in a graph phase
+  int* receive_offsets;
+  pcu_buffer graph_buffer; //everything received in a graph phase
+  int graph_at; //next neighbor to receive from in a graph phase
+  bool framed; //messages carry a compression trailer, see pcu_msg_compress
+  size_t compress_threshold; //smallest message worth compressing, 0 for none
+  size_t raw_bytes; //bytes packed by the user and sent so far
+  size_t wire_bytes; //bytes actually sent so far
   /* below this point are variables that just need
      to be thread-specific but have been tacked onto
      pcu_msg. if this gets out of hand, create a
@@ -44,8 +62,15 @@ struct pcu_msg_struct
 };
 typedef struct pcu_msg_struct pcu_msg;
 
+/* the messenger of the calling thread, see pcu.c */
+pcu_msg* pcu_get_msg(void);
 void pcu_make_msg(pcu_msg* m);
 void pcu_msg_start(pcu_msg* b);
+void pcu_msg_neighbors(pcu_msg* m, const int* ranks, int n);
+void pcu_msg_start_neighbors(pcu_msg* m);
+void pcu_msg_graph(pcu_msg* m, bool on);
+void pcu_msg_open(pcu_msg* m);
+void pcu_msg_compress(pcu_msg* m, size_t threshold, bool framed);
 void* pcu_msg_pack(pcu_msg* m, int id, size_t size);
 #define PCU_MSG_PACK(m,id,o) \
 memcpy(pcu_msg_pack(m,id,sizeof(o)),&(o),sizeof(o))
@@ -0,0 +1,365 @@
+/******************************************************************************
+
+  Copyright 2011 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#include "pcu_phase.h"
+#include "PCU.h"
+#include "pcu_thread.h"
+#include "pcu_pmpi.h"
+#include "noto_malloc.h"
+#include "reel.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* a phase follows the same algorithm as a pcu_msg phase
+   (see pcu_msg.c), with two differences that let it overlap
+   with other phases:
+
+   1. its point-to-point messages carry a tag that no other phase
+      in flight uses, so the messages of different phases are
+      never confused and the leading barrier is not needed.
+   2. termination uses an MPI_Ibarrier. Since MPI matches
+      collectives by the order in which they are called,
+      each phase only begins its barrier after all phases created
+      before it have begun theirs. Phases are created in the same
+      order on all ranks, so the barriers match.
+
+   Progress is made on all phases in flight whenever any of them
+   is tested, and messages are kept until the phase is done,
+   at which point they are sorted by sender so that unpacking
+   is deterministic. */
+
+enum {
+  pack_state, //after begin, before sending
+  send_state, //sends are going
+  barrier_state, //sends are done, termination barrier begun
+  done_state //all messages received
+};
+
+static pcu_phase* first_phase = NULL;
+static int next_tag = 1;
+
+static int get_max_tag(void)
+{
+  int* value;
+  int flag;
+  MPI_Comm_get_attr(MPI_COMM_WORLD, MPI_TAG_UB, &value, &flag);
+  if (!flag)
+    return 32767;
+  return *value;
+}
+
+/* tags are only reused once all phases have ended everywhere */
+static int take_tag(void)
+{
+  static int max_tag = 0;
+  if (!max_tag)
+    max_tag = get_max_tag();
+  if (next_tag > max_tag) {
+    if (first_phase)
+      reel_fail("PCU ran out of phase tags with phases in flight");
+    MPI_Barrier(pcu_user_comm);
+    next_tag = 1;
+  }
+  return next_tag++;
+}
+
+pcu_phase* pcu_phase_begin(void)
+{
+  pcu_phase* p;
+  NOTO_MALLOC(p, 1);
+  pcu_make_msg(&(p->msg));
+  pcu_msg_open(&(p->msg));
+  p->tag = take_tag();
+  p->state = pack_state;
+  p->received = NULL;
+  p->received_count = 0;
+  p->received_capacity = 0;
+  p->at = -1;
+  p->next = NULL;
+  pcu_phase** last = &first_phase;
+  while (*last)
+    last = &((*last)->next);
+  *last = p;
+  return p;
+}
+
+void* pcu_phase_pack(pcu_phase* p, int id, size_t size)
+{
+  if (p->state != pack_state)
+    reel_fail("PCU_Phase_Pack called at the wrong time");
+  return pcu_msg_pack(&(p->msg), id, size);
+}
+
+void pcu_phase_send(pcu_phase* p)
+{
+  if (p->state != pack_state)
+    reel_fail("PCU_Phase_Send called at the wrong time");
+  pcu_msg* m = &(p->msg);
+  for (int i = 0; i < m->peer_count; ++i)
+    pcu_pmpi_send2(&(m->peers[i].message), p->tag, pcu_user_comm);
+  p->state = send_state;
+}
+
+static bool done_sending(pcu_phase* p)
+{
+  pcu_msg* m = &(p->msg);
+  for (int i = 0; i < m->peer_count; ++i)
+    if ( ! pcu_pmpi_done(&(m->peers[i].message)))
+      return false;
+  return true;
+}
+
+static void receive_available(pcu_phase* p)
+{
+  pcu_message incoming;
+  pcu_make_message(&incoming);
+  incoming.peer = MPI_ANY_SOURCE;
+  while (pcu_pmpi_receive2(&incoming, p->tag, pcu_user_comm)) {
+    if (p->received_count == p->received_capacity) {
+      p->received_capacity = p->received_capacity ?
+        p->received_capacity * 2 : 8;
+      p->received = noto_realloc(p->received,
+          p->received_capacity * sizeof(pcu_phase_message));
+    }
+    pcu_phase_message* r = p->received + p->received_count++;
+    r->from = incoming.peer;
+    r->buffer = incoming.buffer; /* steal the buffer */
+    pcu_make_message(&incoming);
+    incoming.peer = MPI_ANY_SOURCE;
+  }
+}
+
+static int message_compare(const void* a, const void* b)
+{
+  return ((const pcu_phase_message*)a)->from
+       - ((const pcu_phase_message*)b)->from;
+}
+
+static void progress(pcu_phase* p, bool can_begin_barrier)
+{
+  if (p->state == done_state)
+    return;
+  receive_available(p);
+  if ((p->state == send_state) && can_begin_barrier && done_sending(p)) {
+    MPI_Ibarrier(pcu_user_comm, &(p->barrier));
+    p->state = barrier_state;
+  }
+  if (p->state == barrier_state) {
+    int flag;
+    MPI_Test(&(p->barrier), &flag, MPI_STATUS_IGNORE);
+    if (flag) {
+      qsort(p->received, p->received_count, sizeof(pcu_phase_message),
+          message_compare);
+      p->state = done_state;
+    }
+  }
+}
+
+static void progress_all(void)
+{
+  bool can_begin_barrier = true;
+  for (pcu_phase* p = first_phase; p; p = p->next) {
+    progress(p, can_begin_barrier);
+    can_begin_barrier = (p->state >= barrier_state);
+  }
+}
+
+bool pcu_phase_test(pcu_phase* p)
+{
+  if (p->state == pack_state)
+    reel_fail("PCU_Phase_Test called before PCU_Phase_Send");
+  progress_all();
+  return p->state == done_state;
+}
+
+void pcu_phase_wait(pcu_phase* p)
+{
+  for (pcu_phase* q = first_phase; q != p; q = q->next)
+    if (q->state == pack_state)
+      reel_fail("PCU_Phase_Wait would wait on an earlier unsent phase");
+  while ( ! pcu_phase_test(p));
+}
+
+/* like PCU_Comm_Receive, skips to the next
+   message that has something left to unpack */
+bool pcu_phase_receive(pcu_phase* p)
+{
+  pcu_phase_wait(p);
+  while (p->at < p->received_count) {
+    if ((p->at != -1) && ( ! pcu_phase_unpacked(p)))
+      return true;
+    ++(p->at);
+    if (p->at < p->received_count)
+      pcu_begin_buffer(&(p->received[p->at].buffer));
+  }
+  return false;
+}
+
+void* pcu_phase_unpack(pcu_phase* p, size_t size)
+{
+  if ((p->at < 0) || (p->at >= p->received_count))
+    reel_fail("PCU_Phase_Unpack called without a received message");
+  return pcu_walk_buffer(&(p->received[p->at].buffer), size);
+}
+
+bool pcu_phase_unpacked(pcu_phase* p)
+{
+  if ((p->at < 0) || (p->at >= p->received_count))
+    return true;
+  return pcu_buffer_walked(&(p->received[p->at].buffer));
+}
+
+int pcu_phase_received_from(pcu_phase* p)
+{
+  return p->received[p->at].from;
+}
+
+size_t pcu_phase_received_size(pcu_phase* p)
+{
+  return p->received[p->at].buffer.capacity;
+}
+
+void pcu_phase_end(pcu_phase* p)
+{
+  pcu_phase_wait(p);
+  pcu_phase** link = &first_phase;
+  while (*link != p)
+    link = &((*link)->next);
+  *link = p->next;
+  pcu_free_msg(&(p->msg));
+  for (int i = 0; i < p->received_count; ++i)
+    pcu_free_buffer(&(p->received[i].buffer));
+  noto_free(p->received);
+  noto_free(p);
+}
+
+bool pcu_phase_any(void)
+{
+  return first_phase != NULL;
+}
+
+/** \brief Begins a non-blocking PCU communication phase.
+  \details The returned phase is packed and sent like a regular phase,
+  but PCU_Phase_Send returns immediately and the caller may do local
+  work or run other phases while the messages are delivered.
+  Several phases may be in flight at once, each has its own
+  messages and they do not interfere with the global phase
+  of PCU_Comm_Begin.
+  All threads in the MPI job must begin phases in the same order.
+  Every phase must be ended with PCU_Phase_End.
+ */
+PCU_Phase PCU_Phase_Begin(void)
+{
+  if (!PCU_Comm_Initialized())
+    reel_fail("Phase_Begin called before Comm_Init");
+  if (pcu_thread_running())
+    reel_fail("PCU phases are not supported inside PCU_Thrd_Run");
+  return pcu_phase_begin();
+}
+
+/** \brief Packs data to be sent to \a to_rank in phase \a p.
+  \details Like PCU_Comm_Pack, this should be called
+  before PCU_Phase_Send.
+ */
+int PCU_Phase_Pack(PCU_Phase p, int to_rank, const void* data, size_t size)
+{
+  memcpy(PCU_Phase_Reserve(p,to_rank,size),data,size);
+  return PCU_SUCCESS;
+}
+
+/** \brief Reserves \a size bytes to \a to_rank in phase \a p.
+  \details The same rules as PCU_Comm_Reserve apply.
+ */
+void* PCU_Phase_Reserve(PCU_Phase p, int to_rank, size_t size)
+{
+  if ((to_rank < 0)||(to_rank >= pcu_mpi_size()))
+    reel_fail("Invalid rank in Phase_Pack");
+  return pcu_phase_pack(p,to_rank,size);
+}
+
+/** \brief Starts sending all buffers of phase \a p.
+  \details This function returns without waiting for delivery.
+ */
+void PCU_Phase_Send(PCU_Phase p)
+{
+  pcu_phase_send(p);
+}
+
+/** \brief Makes progress on all phases in flight.
+  \details Returns true once all messages of phase \a p have arrived.
+  This should be called after PCU_Phase_Send and may be
+  called periodically during local work to keep messages moving.
+ */
+bool PCU_Phase_Test(PCU_Phase p)
+{
+  return pcu_phase_test(p);
+}
+
+/** \brief Waits until all messages of phase \a p have arrived.
+  \details Since phases finish in the order they were begun, all
+  phases begun before \a p must have been sent.
+ */
+void PCU_Phase_Wait(PCU_Phase p)
+{
+  pcu_phase_wait(p);
+}
+
+/** \brief Moves to the next received message of phase \a p.
+  \details This waits for the phase if needed and then behaves
+  like PCU_Comm_Receive, returning false when all messages have
+  been unpacked. Messages are visited in order of sender rank.
+ */
+bool PCU_Phase_Receive(PCU_Phase p)
+{
+  return pcu_phase_receive(p);
+}
+
+/** \brief Returns the sender of the current message of phase \a p. */
+int PCU_Phase_Sender(PCU_Phase p)
+{
+  return pcu_phase_received_from(p);
+}
+
+/** \brief Returns the size of the current message of phase \a p. */
+size_t PCU_Phase_Received(PCU_Phase p)
+{
+  return pcu_phase_received_size(p);
+}
+
+/** \brief Returns true if the current message of phase \a p
+  has been unpacked entirely. */
+bool PCU_Phase_Unpacked(PCU_Phase p)
+{
+  return pcu_phase_unpacked(p);
+}
+
+/** \brief Unpacks \a size bytes of the current message of phase \a p.
+ */
+int PCU_Phase_Unpack(PCU_Phase p, void* data, size_t size)
+{
+  memcpy(data,pcu_phase_unpack(p,size),size);
+  return PCU_SUCCESS;
+}
+
+/** \brief Zero-copy counterpart of PCU_Phase_Unpack.
+  \details The data stays valid until PCU_Phase_End, and the
+  alignment rules of PCU_Comm_Reserve apply.
+ */
+void* PCU_Phase_Extract(PCU_Phase p, size_t size)
+{
+  return pcu_phase_unpack(p,size);
+}
+
+/** \brief Ends phase \a p and frees its memory.
+  \details This waits for the phase if it is still in flight.
+ */
+void PCU_Phase_End(PCU_Phase p)
+{
+  pcu_phase_end(p);
+}
@@ -0,0 +1,54 @@
+/******************************************************************************
+
+  Copyright 2011 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#ifndef PCU_PHASE_H
+#define PCU_PHASE_H
+
+#include "pcu_msg.h"
+
+/* the PCU phase system (pcu_phase for short) runs communication
+   phases that do not block the caller, so that several of them can
+   be in flight at once and overlap with local work.
+   Each phase is a pcu_msg for packing, its own MPI tag for
+   point-to-point messages, and an MPI_Ibarrier for termination. */
+
+typedef struct
+{
+  pcu_buffer buffer;
+  int from;
+} pcu_phase_message;
+
+struct pcu_phase_struct
+{
+  pcu_msg msg; //send buffers
+  int tag; //unique among the phases in flight
+  int state; //progress of the phase, see pcu_phase.c
+  MPI_Request barrier; //termination barrier
+  pcu_phase_message* received; //sorted by sender once the phase is done
+  int received_count;
+  int received_capacity;
+  int at; //index of the message being unpacked
+  struct pcu_phase_struct* next; //next phase in creation order
+};
+typedef struct pcu_phase_struct pcu_phase;
+
+pcu_phase* pcu_phase_begin(void);
+void* pcu_phase_pack(pcu_phase* p, int id, size_t size);
+void pcu_phase_send(pcu_phase* p);
+bool pcu_phase_test(pcu_phase* p);
+void pcu_phase_wait(pcu_phase* p);
+bool pcu_phase_receive(pcu_phase* p);
+void* pcu_phase_unpack(pcu_phase* p, size_t size);
+bool pcu_phase_unpacked(pcu_phase* p);
+int pcu_phase_received_from(pcu_phase* p);
+size_t pcu_phase_received_size(pcu_phase* p);
+void pcu_phase_end(pcu_phase* p);
+bool pcu_phase_any(void);
+
+#endif
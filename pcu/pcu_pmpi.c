@@ -15,10 +15,16 @@
 
 static int global_size;
 static int global_rank;
+static bool hierarchical;
+static bool nodes_contiguous;
+static int node_index;
 
 MPI_Comm original_comm;
 MPI_Comm pcu_user_comm;
 MPI_Comm pcu_coll_comm;
+MPI_Comm pcu_neighbor_comm;
+MPI_Comm pcu_node_comm;
+MPI_Comm pcu_leader_comm;
 
 pcu_mpi pcu_pmpi =
 { .size = pcu_pmpi_size,
@@ -27,19 +33,56 @@ pcu_mpi pcu_pmpi =
   .done = pcu_pmpi_done,
   .receive = pcu_pmpi_receive };
 
+/* splits the ranks into shared-memory nodes, with the lowest
+   rank of each node as its leader.
+   Collectives only use the two levels if there are several nodes and
+   at least one of them holds several ranks.
+   Scans additionally need each node to be a contiguous range of
+   ranks, since they respect rank order. */
+static void init_nodes(MPI_Comm comm)
+{
+  MPI_Comm_split_type(comm,MPI_COMM_TYPE_SHARED,global_rank,
+      MPI_INFO_NULL,&pcu_node_comm);
+  int node_rank, node_size;
+  MPI_Comm_rank(pcu_node_comm,&node_rank);
+  MPI_Comm_size(pcu_node_comm,&node_size);
+  MPI_Comm_split(comm,node_rank ? MPI_UNDEFINED : 0,global_rank,
+      &pcu_leader_comm);
+  int info[3] = {global_rank, 0, 0}; /* leader rank, node index, nodes */
+  if (pcu_leader_comm != MPI_COMM_NULL) {
+    MPI_Comm_rank(pcu_leader_comm,&(info[1]));
+    MPI_Comm_size(pcu_leader_comm,&(info[2]));
+  }
+  MPI_Bcast(info,3,MPI_INT,0,pcu_node_comm);
+  node_index = info[1];
+  int local[2];
+  local[0] = (global_rank == info[0] + node_rank);
+  local[1] = (node_size == 1);
+  int global[2];
+  MPI_Allreduce(local,global,2,MPI_INT,MPI_MIN,comm);
+  nodes_contiguous = global[0];
+  hierarchical = (info[2] > 1) && (!global[1]);
+}
+
 void pcu_pmpi_init(MPI_Comm comm)
 {
   original_comm = comm;
   MPI_Comm_dup(comm,&pcu_user_comm);
   MPI_Comm_dup(comm,&pcu_coll_comm);
+  MPI_Comm_dup(comm,&pcu_neighbor_comm);
   MPI_Comm_size(comm,&global_size);
   MPI_Comm_rank(comm,&global_rank);
+  init_nodes(comm);
 }
 
 void pcu_pmpi_finalize(void)
 {
   MPI_Comm_free(&pcu_user_comm);
   MPI_Comm_free(&pcu_coll_comm);
+  MPI_Comm_free(&pcu_neighbor_comm);
+  MPI_Comm_free(&pcu_node_comm);
+  if (pcu_leader_comm != MPI_COMM_NULL)
+    MPI_Comm_free(&pcu_leader_comm);
 }
 
 int pcu_pmpi_size(void)
@@ -107,6 +150,21 @@ bool pcu_pmpi_receive2(pcu_message* m, int tag, MPI_Comm comm)
   return true;
 }
 
+bool pcu_pmpi_hierarchical(void)
+{
+  return hierarchical;
+}
+
+bool pcu_pmpi_nodes_contiguous(void)
+{
+  return nodes_contiguous;
+}
+
+int pcu_pmpi_node_index(void)
+{
+  return node_index;
+}
+
 void pcu_pmpi_switch(MPI_Comm new_comm)
 {
   pcu_pmpi_finalize();
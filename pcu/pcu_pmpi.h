@@ -24,6 +24,10 @@ void pcu_pmpi_send2(pcu_message* m, int tag, MPI_Comm comm);
 bool pcu_pmpi_receive2(pcu_message* m, int tag, MPI_Comm comm);
 bool pcu_pmpi_done(pcu_message* m);
 
+bool pcu_pmpi_hierarchical(void);
+bool pcu_pmpi_nodes_contiguous(void);
+int pcu_pmpi_node_index(void);
+
 void pcu_pmpi_switch(MPI_Comm new_comm);
 MPI_Comm pcu_pmpi_comm(void);
 
@@ -31,5 +35,8 @@ extern pcu_mpi pcu_pmpi;
 
 extern MPI_Comm pcu_user_comm;
 extern MPI_Comm pcu_coll_comm;
+extern MPI_Comm pcu_neighbor_comm;
+extern MPI_Comm pcu_node_comm;
+extern MPI_Comm pcu_leader_comm;
 
 #endif
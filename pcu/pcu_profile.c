@@ -0,0 +1,247 @@
+/******************************************************************************
+
+  Copyright 2011 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#include "pcu_profile.h"
+#include "PCU.h"
+#include "reel.h"
+#include "pcu_mpi.h"
+#include "pcu_thread.h"
+#include "noto_malloc.h"
+#include <stdio.h>
+#include <string.h>
+
+/* statistics of one named phase, summed over its calls */
+enum {
+  calls_stat,
+  peers_stat, //peers sent to
+  sent_stat, //bytes packed
+  wire_stat, //bytes sent after compression
+  messages_stat, //messages received
+  received_stat, //bytes received
+  pack_stat, //seconds from the start of a phase until sending
+  wait_stat, //seconds in the starting barrier and waiting for messages
+  unpack_stat, //seconds between receives, spent unpacking
+  stat_count
+};
+
+static const char* const stat_names[stat_count] = {
+  "calls",
+  "peers",
+  "sent bytes",
+  "wire bytes",
+  "messages",
+  "received bytes",
+  "pack seconds",
+  "wait seconds",
+  "unpack seconds"
+};
+
+typedef struct
+{
+  char* name;
+  double stats[stat_count];
+} pcu_profile_entry;
+
+/* thread-local so that threads in PCU_Thrd_Run,
+   which start with the profiler off, do not race */
+static PCU_THREAD_LOCAL bool enabled = false;
+static PCU_THREAD_LOCAL pcu_profile_entry* entries = NULL;
+static PCU_THREAD_LOCAL int entry_count = 0;
+static PCU_THREAD_LOCAL int entry_capacity = 0;
+/* the phase being profiled and the time of its last event */
+static PCU_THREAD_LOCAL pcu_profile_entry* current = NULL;
+static PCU_THREAD_LOCAL double mark;
+
+void pcu_profile_enable(bool on)
+{
+  enabled = on;
+  current = NULL;
+}
+
+bool pcu_profile_enabled(void)
+{
+  return enabled;
+}
+
+/* entries are found by linear search, programs
+   only have a few dozen distinct phases */
+static pcu_profile_entry* get_entry(const char* name)
+{
+  for (int i = 0; i < entry_count; ++i)
+    if (!strcmp(entries[i].name, name))
+      return entries + i;
+  if (entry_count == entry_capacity) {
+    entry_capacity = entry_capacity ? (entry_capacity * 2) : 16;
+    entries = noto_realloc(entries,
+        entry_capacity * sizeof(pcu_profile_entry));
+  }
+  pcu_profile_entry* e = entries + entry_count++;
+  size_t length = strlen(name) + 1;
+  NOTO_MALLOC(e->name, length);
+  memcpy(e->name, name, length);
+  for (int i = 0; i < stat_count; ++i)
+    e->stats[i] = 0;
+  return e;
+}
+
+void pcu_profile_begin(const char* name)
+{
+  if (!enabled)
+    return;
+  current = get_entry(name ? name : "(unnamed)");
+  current->stats[calls_stat] += 1;
+  mark = MPI_Wtime();
+}
+
+void pcu_profile_begun(void)
+{
+  if (!current)
+    return;
+  double now = MPI_Wtime();
+  current->stats[wait_stat] += now - mark;
+  mark = now;
+}
+
+void pcu_profile_send(int peers, size_t raw, size_t wire)
+{
+  if (!current)
+    return;
+  double now = MPI_Wtime();
+  current->stats[pack_stat] += now - mark;
+  current->stats[peers_stat] += peers;
+  current->stats[sent_stat] += raw;
+  current->stats[wire_stat] += wire;
+  mark = now;
+}
+
+void pcu_profile_listen(void)
+{
+  if (!current)
+    return;
+  double now = MPI_Wtime();
+  current->stats[unpack_stat] += now - mark;
+  mark = now;
+}
+
+void pcu_profile_listened(bool received, size_t size)
+{
+  if (!current)
+    return;
+  double now = MPI_Wtime();
+  current->stats[wait_stat] += now - mark;
+  mark = now;
+  if (received) {
+    current->stats[messages_stat] += 1;
+    current->stats[received_stat] += size;
+  } else
+    current = NULL;
+}
+
+static int hash_name(const char* name)
+{
+  unsigned h = 5381;
+  for (; *name; ++name)
+    h = h * 33 + (unsigned char)*name;
+  return (int)(h & 0x7FFFFFFF);
+}
+
+/* the table only makes sense if all ranks recorded the same
+   phases in the same order, which is checked by comparing
+   the minimum and maximum hash of each name */
+static bool same_entries(pcu_coll* c)
+{
+  int counts[2] = {entry_count, -entry_count};
+  pcu_allreduce(c, pcu_min_ints, counts, sizeof(counts));
+  if (counts[0] != -counts[1])
+    return false;
+  int* hashes;
+  NOTO_MALLOC(hashes, 2 * entry_count + 1);
+  for (int i = 0; i < entry_count; ++i) {
+    hashes[2 * i] = hash_name(entries[i].name);
+    hashes[2 * i + 1] = -hashes[2 * i];
+  }
+  pcu_allreduce(c, pcu_min_ints, hashes, 2 * entry_count * sizeof(int));
+  bool same = true;
+  for (int i = 0; i < entry_count; ++i)
+    if (hashes[2 * i] != -hashes[2 * i + 1])
+      same = false;
+  noto_free(hashes);
+  return same;
+}
+
+void pcu_profile_report(pcu_coll* c)
+{
+  if (!enabled)
+    return;
+  bool root = !pcu_mpi_rank();
+  if (!same_entries(c)) {
+    if (root)
+      fprintf(stderr, "PCU profile: ranks recorded different phases, "
+          "no report\n");
+    return;
+  }
+  size_t n = entry_count * stat_count;
+  double* min;
+  double* max;
+  double* sum;
+  NOTO_MALLOC(min, n + 1);
+  NOTO_MALLOC(max, n + 1);
+  NOTO_MALLOC(sum, n + 1);
+  for (int i = 0; i < entry_count; ++i)
+    for (int j = 0; j < stat_count; ++j)
+      min[i * stat_count + j] = max[i * stat_count + j] =
+        sum[i * stat_count + j] = entries[i].stats[j];
+  pcu_allreduce(c, pcu_min_doubles, min, n * sizeof(double));
+  pcu_allreduce(c, pcu_max_doubles, max, n * sizeof(double));
+  pcu_allreduce(c, pcu_add_doubles, sum, n * sizeof(double));
+  if (root) {
+    int ranks = pcu_mpi_size();
+    printf("PCU profile over %d ranks\n", ranks);
+    for (int i = 0; i < entry_count; ++i) {
+      printf("phase \"%s\"\n", entries[i].name);
+      printf("  %-16s %14s %14s %14s\n", "per rank", "min", "avg", "max");
+      for (int j = 0; j < stat_count; ++j) {
+        size_t k = i * stat_count + j;
+        printf("  %-16s %14.6g %14.6g %14.6g\n", stat_names[j],
+            min[k], sum[k] / ranks, max[k]);
+      }
+    }
+  }
+  noto_free(min);
+  noto_free(max);
+  noto_free(sum);
+}
+
+void pcu_profile_free(void)
+{
+  for (int i = 0; i < entry_count; ++i)
+    noto_free(entries[i].name);
+  noto_free(entries);
+  entries = NULL;
+  entry_count = 0;
+  entry_capacity = 0;
+  current = NULL;
+}
+
+/** \brief Turns the communication profiler on or off.
+  \details While on, every global communication phase is timed and
+  its traffic counted, grouped by the name given to
+  PCU_Comm_Begin_Named.
+  PCU_Comm_Free then prints a table with the minimum, average and
+  maximum of each statistic across ranks.
+  The profiler is also turned on by setting the PCU_PROFILE
+  environment variable to anything but 0.
+  This function must be called by all ranks between phases.
+ */
+void PCU_Comm_Profile(bool on)
+{
+  if (!PCU_Comm_Initialized())
+    reel_fail("Comm_Profile called before Comm_Init");
+  pcu_profile_enable(on);
+}
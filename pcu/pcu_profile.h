@@ -0,0 +1,33 @@
+/******************************************************************************
+
+  Copyright 2011 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#ifndef PCU_PROFILE_H
+#define PCU_PROFILE_H
+
+#include "pcu_coll.h"
+
+/* the PCU profiler (pcu_profile for short) accumulates statistics
+   about the global communication phases, grouped by the name given
+   to PCU_Comm_Begin_Named, and reports them across ranks.
+   The public API in pcu.c calls the hooks below around
+   the corresponding pcu_msg calls, and they do nothing
+   unless profiling is enabled. */
+
+void pcu_profile_enable(bool on);
+bool pcu_profile_enabled(void);
+void pcu_profile_begin(const char* name);
+void pcu_profile_begun(void);
+void pcu_profile_send(int peers, size_t raw, size_t wire);
+void pcu_profile_listen(void);
+void pcu_profile_listened(bool received, size_t size);
+/* collective, prints the table from rank 0 */
+void pcu_profile_report(pcu_coll* c);
+void pcu_profile_free(void);
+
+#endif
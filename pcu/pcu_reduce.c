@@ -0,0 +1,107 @@
+/******************************************************************************
+
+  Copyright 2025 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#include "PCU.h"
+#include "pcu_thread.h"
+#include "noto_malloc.h"
+#include "reel.h"
+#include <string.h>
+
+/* the record reduced by PCU_Add_Max_Longs_Begin carries its
+   number of sums in front, since an MPI_Op has no other state */
+struct pcu_reduction_struct
+{
+  long* user;
+  long* record;
+  size_t n;
+  MPI_Datatype type;
+  MPI_Op op;
+  MPI_Request request;
+};
+
+static void add_max_longs(void* in, void* inout, int* len, MPI_Datatype* t)
+{
+  int size;
+  MPI_Type_size(*t, &size);
+  size_t n = size / sizeof(long);
+  long* a = in;
+  long* b = inout;
+  for (int r = 0; r < *len; ++r, a += n, b += n) {
+    size_t sums = b[0];
+    for (size_t i = 1; i <= sums; ++i)
+      b[i] += a[i];
+    for (size_t i = sums + 1; i < n; ++i)
+      if (a[i] > b[i])
+        b[i] = a[i];
+  }
+}
+
+/** \brief Begins a non-blocking reduction of n longs, summing the
+  first (sums) of them and taking the maximum of the rest.
+  \details A minimum is the negated maximum of negated values, so
+  one call can stand for several separate reductions.
+  The array must not be touched until PCU_Reduction_Wait returns,
+  after which it holds the results.
+  All ranks must begin their reductions in the same order.
+ */
+PCU_Reduction PCU_Add_Max_Longs_Begin(long* p, size_t sums, size_t n)
+{
+  if (!PCU_Comm_Initialized())
+    reel_fail("Add_Max_Longs_Begin called before Comm_Init");
+  if (pcu_thread_running())
+    reel_fail("PCU non-blocking reductions are not supported "
+              "inside PCU_Thrd_Run");
+  if (sums > n)
+    reel_fail("Add_Max_Longs_Begin: %zu sums of %zu values", sums, n);
+  PCU_Reduction r;
+  NOTO_MALLOC(r, 1);
+  r->user = p;
+  r->n = n;
+  NOTO_MALLOC(r->record, n + 1);
+  r->record[0] = sums;
+  memcpy(r->record + 1, p, n * sizeof(long));
+  MPI_Type_contiguous(n + 1, MPI_LONG, &r->type);
+  MPI_Type_commit(&r->type);
+  MPI_Op_create(add_max_longs, 1, &r->op);
+  MPI_Iallreduce(MPI_IN_PLACE, r->record, 1, r->type, r->op,
+      PCU_Get_Comm(), &r->request);
+  return r;
+}
+
+/** \brief Returns true once the reduction \a r has completed.
+  \details Calling this now and then lets the reduction
+  progress while the caller does other work.
+ */
+bool PCU_Reduction_Test(PCU_Reduction r)
+{
+  int flag;
+  MPI_Test(&r->request, &flag, MPI_STATUS_IGNORE);
+  return flag;
+}
+
+/** \brief Waits for the reduction \a r, copies its results
+  into the user array and frees it.
+ */
+void PCU_Reduction_Wait(PCU_Reduction r)
+{
+  MPI_Wait(&r->request, MPI_STATUS_IGNORE);
+  memcpy(r->user, r->record + 1, r->n * sizeof(long));
+  MPI_Op_free(&r->op);
+  MPI_Type_free(&r->type);
+  noto_free(r->record);
+  noto_free(r);
+}
+
+/** \brief Sums the first (sums) of n longs and takes the
+  maximum of the rest in a single reduction.
+ */
+void PCU_Add_Max_Longs(long* p, size_t sums, size_t n)
+{
+  PCU_Reduction_Wait(PCU_Add_Max_Longs_Begin(p, sums, n));
+}
@@ -0,0 +1,396 @@
+/******************************************************************************
+
+  Copyright 2011 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#include "pcu_thread.h"
+#include "PCU.h"
+#include "pcu_msg.h"
+#include "pcu_order.h"
+#include "pcu_pmpi.h"
+#include "noto_malloc.h"
+#include "reel.h"
+#include <pthread.h>
+#include <string.h>
+
+/* PCU rank r is thread (r % T) of MPI rank (r / T),
+   where T is the number of threads per process.
+
+   A message to a thread of the same process is posted as an
+   envelope in the mailbox of the receiving thread, pointing to the
+   send buffer. The receiver copies the data out and marks the
+   envelope delivered, which is when the send is done.
+   This matches the synchronous semantics of MPI_Issend that pcu_msg
+   relies on for termination detection.
+   Each mailbox is a FIFO, so messages from one thread to another
+   on the same communicator are not overtaken by later ones.
+
+   A message to another process is an MPI_Issend whose tag
+   encodes the sending and receiving threads, so each thread
+   only ever receives the MPI messages addressed to it. */
+
+typedef struct pcu_envelope_struct
+{
+  MPI_Comm comm;
+  int from; //PCU rank of the sender
+  int to_thread;
+  const char* data; //points into the sender's buffer
+  size_t size;
+  bool delivered;
+  struct pcu_envelope_struct* next;
+} pcu_envelope;
+
+typedef struct
+{
+  pthread_mutex_t lock;
+  pcu_envelope* first;
+  pcu_envelope* last;
+} pcu_mailbox;
+
+static int thread_count = 1;
+static bool running = false;
+static pcu_mailbox* mailboxes = NULL;
+static PCU_THREAD_LOCAL int thread_rank = 0;
+
+bool pcu_thread_running(void)
+{
+  return running;
+}
+
+int pcu_thread_rank(void)
+{
+  return thread_rank;
+}
+
+int pcu_thread_size(void)
+{
+  return thread_count;
+}
+
+static int tmpi_size(void)
+{
+  return pcu_pmpi_size() * thread_count;
+}
+
+static int tmpi_rank(void)
+{
+  return pcu_pmpi_rank() * thread_count + thread_rank;
+}
+
+static int get_tag(int from_thread, int to_thread)
+{
+  return from_thread * thread_count + to_thread;
+}
+
+static void post(pcu_message* m, MPI_Comm comm)
+{
+  pcu_envelope* e;
+  NOTO_MALLOC(e, 1);
+  e->comm = comm;
+  e->from = tmpi_rank();
+  e->to_thread = m->peer % thread_count;
+  e->data = m->buffer.start;
+  e->size = m->buffer.size;
+  e->delivered = false;
+  e->next = NULL;
+  pcu_mailbox* box = mailboxes + e->to_thread;
+  pthread_mutex_lock(&(box->lock));
+  if (box->last)
+    box->last->next = e;
+  else
+    box->first = e;
+  box->last = e;
+  pthread_mutex_unlock(&(box->lock));
+  m->envelope = e;
+}
+
+static void tmpi_send(pcu_message* m, MPI_Comm comm)
+{
+  int to_process = m->peer / thread_count;
+  if (to_process == pcu_pmpi_rank()) {
+    post(m, comm);
+    return;
+  }
+  m->envelope = NULL;
+  int peer = m->peer;
+  m->peer = to_process;
+  pcu_pmpi_send2(m, get_tag(thread_rank, peer % thread_count), comm);
+  m->peer = peer;
+}
+
+static bool tmpi_done(pcu_message* m)
+{
+  pcu_envelope* e = m->envelope;
+  if (!e)
+    return pcu_pmpi_done(m);
+  pcu_mailbox* box = mailboxes + e->to_thread;
+  pthread_mutex_lock(&(box->lock));
+  bool delivered = e->delivered;
+  pthread_mutex_unlock(&(box->lock));
+  if (!delivered)
+    return false;
+  noto_free(e);
+  m->envelope = NULL;
+  /* so that asking again is answered like a completed MPI send */
+  m->request = MPI_REQUEST_NULL;
+  return true;
+}
+
+/* takes the first matching envelope out of this thread's mailbox
+   and copies its data, the sender frees the envelope */
+static bool receive_local(pcu_message* m, MPI_Comm comm)
+{
+  pcu_mailbox* box = mailboxes + thread_rank;
+  pthread_mutex_lock(&(box->lock));
+  pcu_envelope* previous = NULL;
+  pcu_envelope* e = box->first;
+  while (e && ((e->comm != comm) ||
+               ((m->peer != MPI_ANY_SOURCE) && (m->peer != e->from)))) {
+    previous = e;
+    e = e->next;
+  }
+  if (e) {
+    if (previous)
+      previous->next = e->next;
+    else
+      box->first = e->next;
+    if (box->last == e)
+      box->last = previous;
+    m->peer = e->from;
+    pcu_resize_buffer(&(m->buffer), e->size);
+    if (e->size)
+      memcpy(m->buffer.start, e->data, e->size);
+    e->delivered = true;
+  }
+  pthread_mutex_unlock(&(box->lock));
+  return e != NULL;
+}
+
+static bool receive_remote(pcu_message* m, MPI_Comm comm, int from_thread)
+{
+  int peer = m->peer;
+  if (peer != MPI_ANY_SOURCE)
+    m->peer = peer / thread_count;
+  if (!pcu_pmpi_receive2(m, get_tag(from_thread, thread_rank), comm)) {
+    m->peer = peer;
+    return false;
+  }
+  m->peer = m->peer * thread_count + from_thread;
+  return true;
+}
+
+static bool tmpi_receive(pcu_message* m, MPI_Comm comm)
+{
+  if (receive_local(m, comm))
+    return true;
+  if (m->peer != MPI_ANY_SOURCE) {
+    if (m->peer / thread_count == pcu_pmpi_rank())
+      return false;
+    return receive_remote(m, comm, m->peer % thread_count);
+  }
+  for (int i = 0; i < thread_count; ++i)
+    if (receive_remote(m, comm, i))
+      return true;
+  return false;
+}
+
+pcu_mpi pcu_tmpi =
+{ .size = tmpi_size,
+  .rank = tmpi_rank,
+  .send = tmpi_send,
+  .done = tmpi_done,
+  .receive = tmpi_receive };
+
+typedef struct
+{
+  void* (*function)(void*);
+  void* in;
+  void* out;
+  int rank;
+} pcu_thread_start;
+
+static void* start(void* in)
+{
+  pcu_thread_start* s = in;
+  thread_rank = s->rank;
+  s->out = s->function(s->in);
+  return NULL;
+}
+
+void* pcu_thread_run(int nthreads, void* (*function)(void*), void* in)
+{
+  if (running)
+    reel_fail("PCU_Thrd_Run called from inside PCU_Thrd_Run");
+  if (nthreads < 1)
+    reel_fail("PCU_Thrd_Run needs at least one thread, not %d", nthreads);
+  int provided;
+  MPI_Query_thread(&provided);
+  if (provided < MPI_THREAD_MULTIPLE)
+    reel_fail("PCU_Thrd_Run requires MPI_THREAD_MULTIPLE");
+  if (get_tag(nthreads - 1, nthreads - 1) > 32767)
+    reel_fail("PCU_Thrd_Run supports at most 181 threads per process");
+  NOTO_MALLOC(mailboxes, nthreads);
+  for (int i = 0; i < nthreads; ++i) {
+    pthread_mutex_init(&(mailboxes[i].lock), NULL);
+    mailboxes[i].first = mailboxes[i].last = NULL;
+  }
+  thread_count = nthreads;
+  running = true;
+  pcu_mpi* previous = pcu_get_mpi();
+  pcu_set_mpi(&pcu_tmpi);
+  pcu_thread_start* starts;
+  NOTO_MALLOC(starts, nthreads);
+  pthread_t* threads;
+  NOTO_MALLOC(threads, nthreads);
+  for (int i = 0; i < nthreads; ++i) {
+    starts[i].function = function;
+    starts[i].in = in;
+    starts[i].out = NULL;
+    starts[i].rank = i;
+    if (pthread_create(threads + i, NULL, start, starts + i))
+      reel_fail("PCU_Thrd_Run could not create thread %d", i);
+  }
+  for (int i = 0; i < nthreads; ++i)
+    pthread_join(threads[i], NULL);
+  void* out = starts[0].out;
+  noto_free(threads);
+  noto_free(starts);
+  pcu_set_mpi(previous);
+  running = false;
+  thread_count = 1;
+  for (int i = 0; i < nthreads; ++i)
+    pthread_mutex_destroy(&(mailboxes[i].lock));
+  noto_free(mailboxes);
+  mailboxes = NULL;
+  return out;
+}
+
+typedef struct
+{
+  void (*function)(void*, size_t, size_t);
+  void* in;
+  size_t first;
+  size_t end;
+  pthread_t thread;
+  bool started;
+} pcu_thread_chunk;
+
+static void* run_chunk(void* in)
+{
+  pcu_thread_chunk* c = in;
+  c->function(c->in, c->first, c->end);
+  return NULL;
+}
+
+void pcu_thread_chunks(int nthreads, size_t n,
+    void (*function)(void*, size_t, size_t), void* in)
+{
+  if (nthreads < 1)
+    nthreads = 1;
+  pcu_thread_chunk* chunks;
+  NOTO_MALLOC(chunks, nthreads);
+  for (int i = 0; i < nthreads; ++i) {
+    chunks[i].function = function;
+    chunks[i].in = in;
+    chunks[i].first = (n * i) / nthreads;
+    chunks[i].end = (n * (i + 1)) / nthreads;
+    chunks[i].started = false;
+  }
+  /* the calling thread takes the first chunk, and any
+     chunk whose thread could not be made */
+  for (int i = 1; i < nthreads; ++i)
+    if (chunks[i].first < chunks[i].end)
+      chunks[i].started = !pthread_create(&(chunks[i].thread), NULL,
+          run_chunk, chunks + i);
+  if (chunks[0].first < chunks[0].end)
+    run_chunk(chunks);
+  for (int i = 1; i < nthreads; ++i)
+    if (chunks[i].started)
+      pthread_join(chunks[i].thread, NULL);
+    else if (chunks[i].first < chunks[i].end)
+      run_chunk(chunks + i);
+  noto_free(chunks);
+}
+
+typedef struct
+{
+  PCU_Thrd_Func function;
+  void* in;
+} thread_start;
+
+/* each thread gets a messenger of its own, set up
+   the way PCU_Comm_Init sets up the process one */
+static void* run_thread(void* in)
+{
+  thread_start* s = in;
+  pcu_msg* m = pcu_get_msg();
+  pcu_make_msg(m);
+  m->order = pcu_order_new();
+  void* out = s->function(s->in);
+  if (m->order)
+    pcu_order_free(m->order);
+  pcu_free_msg(m);
+  return out;
+}
+
+/** \brief Runs \a function on \a nthreads threads in each process.
+  \details Inside \a function, each thread is a PCU rank of its own:
+  PCU_Comm_Self and PCU_Comm_Peers count threads over all processes,
+  with the threads of a process being consecutive ranks, and
+  all of the message passing and collective APIs work among them.
+  Messages between threads of the same process are copied
+  through shared memory, only messages between processes use MPI.
+  MPI must have been initialized with MPI_THREAD_MULTIPLE.
+  This function must be called by all processes with the same
+  \a nthreads, it returns what \a function returned on thread 0
+  after all threads are done.
+  Non-blocking phases (PCU_Phase_Begin), PCU_Switch_Comm and the
+  profiler are not available inside \a function, and each thread
+  starts with deterministic ordering on.
+ */
+void* PCU_Thrd_Run(int nthreads, PCU_Thrd_Func function, void* in)
+{
+  if (!PCU_Comm_Initialized())
+    reel_fail("Thrd_Run called before Comm_Init");
+  thread_start s;
+  s.function = function;
+  s.in = in;
+  return pcu_thread_run(nthreads, run_thread, &s);
+}
+
+/** \brief Returns the index of the calling thread within its process.
+  \details This is zero outside of PCU_Thrd_Run.
+ */
+int PCU_Thrd_Self(void)
+{
+  return pcu_thread_rank();
+}
+
+/** \brief Returns the number of threads per process.
+  \details This is one outside of PCU_Thrd_Run.
+ */
+int PCU_Thrd_Peers(void)
+{
+  return pcu_thread_size();
+}
+
+/** \brief Runs \a function over the indices [0, \a n) on up to
+  \a nthreads threads.
+  \details The indices are split into \a nthreads contiguous chunks
+  of nearly equal size and \a function is called once per non-empty
+  chunk with \a in and the chunk's [first, end) range.
+  These are plain threads for shared-memory loops, not PCU ranks,
+  so \a function must not communicate through PCU.
+  The calling thread runs the first chunk, and any chunk whose
+  thread could not be created, so this always completes.
+  Nothing is collective, and it may be called inside PCU_Thrd_Run.
+ */
+void PCU_Thrd_Chunks(int nthreads, size_t n, PCU_Thrd_Chunk function,
+    void* in)
+{
+  pcu_thread_chunks(nthreads, n, function, in);
+}
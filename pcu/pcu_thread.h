@@ -0,0 +1,44 @@
+/******************************************************************************
+
+  Copyright 2011 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#ifndef PCU_THREAD_H
+#define PCU_THREAD_H
+
+#include "pcu_mpi.h"
+
+/* the PCU thread system (pcu_thread for short) runs several
+   threads per MPI process, each of them a PCU rank of its own.
+   It provides pcu_tmpi, a pcu_mpi implementation in which
+   messages between threads of the same process are copied through
+   shared memory and only messages between processes use MPI,
+   which must then support MPI_THREAD_MULTIPLE.
+   Since pcu_msg and pcu_coll are built over pcu_mpi,
+   they work unchanged on top of it. */
+
+#if defined(__GNUC__) || defined(__INTEL_COMPILER) || defined(__clang__)
+#define PCU_THREAD_LOCAL __thread
+#else
+#define PCU_THREAD_LOCAL _Thread_local
+#endif
+
+extern pcu_mpi pcu_tmpi;
+
+/* runs (function) on (nthreads) new threads with pcu_tmpi in place,
+   returns what thread 0 returned */
+void* pcu_thread_run(int nthreads, void* (*function)(void*), void* in);
+bool pcu_thread_running(void);
+int pcu_thread_rank(void);
+int pcu_thread_size(void);
+/* splits [0,n) into (nthreads) contiguous chunks and runs
+   (function) on each of them on a plain thread of its own,
+   returning when all chunks are done */
+void pcu_thread_chunks(int nthreads, size_t n,
+    void (*function)(void*, size_t, size_t), void* in);
+
+#endif
@@ -0,0 +1,477 @@
+/******************************************************************************
+
+  Copyright 2011 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#include "pcu_timer.h"
+#include "PCU.h"
+#include "reel.h"
+#include "pcu_pmpi.h"
+#include "pcu_thread.h"
+#include "noto_malloc.h"
+#include <stdio.h>
+#include <string.h>
+
+/* one node of the call tree, the roots have parent -1 */
+typedef struct
+{
+  char* name;
+  int parent;
+  int calls;
+  double seconds;
+  double start; //of the call in progress
+} pcu_region;
+
+/* one call of a region for the trace */
+typedef struct
+{
+  int region;
+  double start;
+  double end;
+} pcu_event;
+
+static PCU_THREAD_LOCAL bool enabled = false;
+static PCU_THREAD_LOCAL pcu_region* regions = NULL;
+static PCU_THREAD_LOCAL int region_count = 0;
+static PCU_THREAD_LOCAL int region_capacity = 0;
+static PCU_THREAD_LOCAL int current = -1;
+static PCU_THREAD_LOCAL char* trace_prefix = NULL;
+static PCU_THREAD_LOCAL pcu_event* events = NULL;
+static PCU_THREAD_LOCAL int event_count = 0;
+static PCU_THREAD_LOCAL int event_capacity = 0;
+static PCU_THREAD_LOCAL double origin;
+
+void pcu_timer_enable(bool on)
+{
+  if (on && !enabled)
+    origin = MPI_Wtime();
+  enabled = on;
+  current = -1;
+}
+
+bool pcu_timer_enabled(void)
+{
+  return enabled;
+}
+
+void pcu_timer_trace(const char* prefix)
+{
+  noto_free(trace_prefix);
+  trace_prefix = NULL;
+  if (!prefix)
+    return;
+  size_t length = strlen(prefix) + 1;
+  NOTO_MALLOC(trace_prefix, length);
+  memcpy(trace_prefix, prefix, length);
+}
+
+/* children are found by linear search, a region
+   rarely has more than a handful of them */
+static int get_child(int parent, const char* name)
+{
+  for (int i = 0; i < region_count; ++i)
+    if (regions[i].parent == parent && !strcmp(regions[i].name, name))
+      return i;
+  if (region_count == region_capacity) {
+    region_capacity = region_capacity ? (region_capacity * 2) : 32;
+    regions = noto_realloc(regions, region_capacity * sizeof(pcu_region));
+  }
+  pcu_region* r = regions + region_count;
+  size_t length = strlen(name) + 1;
+  NOTO_MALLOC(r->name, length);
+  memcpy(r->name, name, length);
+  r->parent = parent;
+  r->calls = 0;
+  r->seconds = 0;
+  return region_count++;
+}
+
+void pcu_timer_begin(const char* name)
+{
+  if (!enabled)
+    return;
+  current = get_child(current, name ? name : "(unnamed)");
+  regions[current].start = MPI_Wtime();
+}
+
+static void add_event(int region, double start, double end)
+{
+  if (event_count == event_capacity) {
+    event_capacity = event_capacity ? (event_capacity * 2) : 1024;
+    events = noto_realloc(events, event_capacity * sizeof(pcu_event));
+  }
+  pcu_event* e = events + event_count++;
+  e->region = region;
+  e->start = start;
+  e->end = end;
+}
+
+/* an end without a begin, as when the timers were
+   turned on inside a region, is ignored */
+void pcu_timer_end(void)
+{
+  if (!enabled || current < 0)
+    return;
+  pcu_region* r = regions + current;
+  double now = MPI_Wtime();
+  r->seconds += now - r->start;
+  r->calls += 1;
+  if (trace_prefix)
+    add_event(current, r->start, now);
+  current = r->parent;
+}
+
+int pcu_timer_count(void)
+{
+  return region_count;
+}
+
+const char* pcu_timer_name(int region)
+{
+  return regions[region].name;
+}
+
+int pcu_timer_parent(int region)
+{
+  return regions[region].parent;
+}
+
+int pcu_timer_calls(int region)
+{
+  return regions[region].calls;
+}
+
+double pcu_timer_seconds(int region)
+{
+  return regions[region].seconds;
+}
+
+/* a region travels as its parent index, calls,
+   seconds and nul-terminated name */
+static size_t packed_size(pcu_region* r)
+{
+  return 2 * sizeof(int) + sizeof(double) + strlen(r->name) + 1;
+}
+
+static char* pack_region(char* at, pcu_region* r)
+{
+  memcpy(at, &r->parent, sizeof(int));
+  at += sizeof(int);
+  memcpy(at, &r->calls, sizeof(int));
+  at += sizeof(int);
+  memcpy(at, &r->seconds, sizeof(double));
+  at += sizeof(double);
+  size_t length = strlen(r->name) + 1;
+  memcpy(at, r->name, length);
+  return at + length;
+}
+
+/* a node of the merged tree with its statistics
+   over the ranks that entered it */
+typedef struct
+{
+  const char* name; //points into the gathered buffer
+  int parent;
+  int ranks;
+  double calls;
+  double min;
+  double max;
+  double sum;
+} pcu_merged;
+
+static int merge_region(pcu_merged** merged, int* count, int* capacity,
+    int parent, const char* name, int calls, double seconds)
+{
+  int i;
+  for (i = 0; i < *count; ++i)
+    if ((*merged)[i].parent == parent && !strcmp((*merged)[i].name, name))
+      break;
+  if (i == *count) {
+    if (*count == *capacity) {
+      *capacity = *capacity ? (*capacity * 2) : 32;
+      *merged = noto_realloc(*merged, *capacity * sizeof(pcu_merged));
+    }
+    pcu_merged* m = *merged + (*count)++;
+    m->name = name;
+    m->parent = parent;
+    m->ranks = 0;
+    m->calls = 0;
+    m->min = seconds;
+    m->max = seconds;
+    m->sum = 0;
+  }
+  pcu_merged* m = *merged + i;
+  m->ranks += 1;
+  m->calls += calls;
+  if (seconds < m->min)
+    m->min = seconds;
+  if (seconds > m->max)
+    m->max = seconds;
+  m->sum += seconds;
+  return i;
+}
+
+static void print_children(pcu_merged* merged, int count,
+    int parent, int depth)
+{
+  for (int i = 0; i < count; ++i) {
+    pcu_merged* m = merged + i;
+    if (m->parent != parent)
+      continue;
+    int indent = 2 * depth;
+    int width = 36 - indent;
+    printf("%*s%-*s %6d %10.0f %12.6f %12.6f %12.6f\n", indent, "",
+        width > 0 ? width : 0, m->name, m->ranks, m->calls,
+        m->min, m->sum / m->ranks, m->max);
+    print_children(merged, count, i, depth + 1);
+  }
+}
+
+/* the trees of the ranks differ in general, so rank 0 gathers
+   them all and merges the regions with the same path */
+static void print_tree(MPI_Comm comm)
+{
+  int self, ranks;
+  MPI_Comm_rank(comm, &self);
+  MPI_Comm_size(comm, &ranks);
+  size_t size = 0;
+  for (int i = 0; i < region_count; ++i)
+    size += packed_size(regions + i);
+  char* buf;
+  NOTO_MALLOC(buf, size + 1);
+  char* at = buf;
+  for (int i = 0; i < region_count; ++i)
+    at = pack_region(at, regions + i);
+  int counts[2] = {(int)size, region_count};
+  int* all_counts = NULL;
+  int* displs = NULL;
+  int* sizes = NULL;
+  char* all = NULL;
+  if (!self) {
+    NOTO_MALLOC(all_counts, 2 * ranks);
+    NOTO_MALLOC(displs, ranks);
+    NOTO_MALLOC(sizes, ranks);
+  }
+  MPI_Gather(counts, 2, MPI_INT, all_counts, 2, MPI_INT, 0, comm);
+  int total = 0;
+  if (!self) {
+    for (int i = 0; i < ranks; ++i) {
+      sizes[i] = all_counts[2 * i];
+      displs[i] = total;
+      total += sizes[i];
+    }
+    NOTO_MALLOC(all, total + 1);
+  }
+  MPI_Gatherv(buf, (int)size, MPI_BYTE,
+      all, sizes, displs, MPI_BYTE, 0, comm);
+  noto_free(buf);
+  if (self)
+    return;
+  pcu_merged* merged = NULL;
+  int merged_count = 0;
+  int merged_capacity = 0;
+  at = all;
+  for (int rank = 0; rank < ranks; ++rank) {
+    int n = all_counts[2 * rank + 1];
+    /* parents come before their children, so the
+       merged index of a parent is always known */
+    int* map;
+    NOTO_MALLOC(map, n + 1);
+    for (int i = 0; i < n; ++i) {
+      int parent, calls;
+      double seconds;
+      memcpy(&parent, at, sizeof(int));
+      at += sizeof(int);
+      memcpy(&calls, at, sizeof(int));
+      at += sizeof(int);
+      memcpy(&seconds, at, sizeof(double));
+      at += sizeof(double);
+      const char* name = at;
+      at += strlen(name) + 1;
+      map[i] = merge_region(&merged, &merged_count, &merged_capacity,
+          parent < 0 ? -1 : map[parent], name, calls, seconds);
+    }
+    noto_free(map);
+  }
+  printf("PCU timers over %d ranks, seconds over the ranks "
+      "that entered each region\n", ranks);
+  printf("%-36s %6s %10s %12s %12s %12s\n",
+      "region", "ranks", "calls", "min", "avg", "max");
+  print_children(merged, merged_count, -1, 0);
+  noto_free(merged);
+  noto_free(all);
+  noto_free(all_counts);
+  noto_free(displs);
+  noto_free(sizes);
+}
+
+static void write_escaped(FILE* f, const char* s)
+{
+  for (; *s; ++s) {
+    if (*s == '"' || *s == '\\')
+      fputc('\\', f);
+    if ((unsigned char)*s >= ' ')
+      fputc(*s, f);
+  }
+}
+
+/* the Chrome trace event format, timestamps in microseconds;
+   the files of all ranks can be loaded together since each
+   uses its rank as the process id */
+static void write_trace(MPI_Comm comm)
+{
+  int self;
+  MPI_Comm_rank(comm, &self);
+  char* path;
+  NOTO_MALLOC(path, strlen(trace_prefix) + 32);
+  sprintf(path, "%s%d.json", trace_prefix, self);
+  FILE* f = fopen(path, "w");
+  if (!f) {
+    fprintf(stderr, "PCU timers: could not write %s\n", path);
+    noto_free(path);
+    return;
+  }
+  fprintf(f, "{\"traceEvents\":[\n");
+  for (int i = 0; i < event_count; ++i) {
+    pcu_event* e = events + i;
+    fprintf(f, "%s{\"name\":\"", i ? ",\n" : "");
+    write_escaped(f, regions[e->region].name);
+    fprintf(f, "\",\"cat\":\"pcu\",\"ph\":\"X\",\"ts\":%.3f,"
+        "\"dur\":%.3f,\"pid\":%d,\"tid\":0}",
+        (e->start - origin) * 1e6, (e->end - e->start) * 1e6, self);
+  }
+  fprintf(f, "\n]}\n");
+  fclose(f);
+  noto_free(path);
+}
+
+void pcu_timer_report(MPI_Comm comm)
+{
+  if (!enabled)
+    return;
+  print_tree(comm);
+  if (trace_prefix)
+    write_trace(comm);
+}
+
+void pcu_timer_free(void)
+{
+  for (int i = 0; i < region_count; ++i)
+    noto_free(regions[i].name);
+  noto_free(regions);
+  regions = NULL;
+  region_count = 0;
+  region_capacity = 0;
+  current = -1;
+  noto_free(events);
+  events = NULL;
+  event_count = 0;
+  event_capacity = 0;
+  pcu_timer_trace(NULL);
+}
+
+/** \brief Turns the region timers on or off.
+  \details While on, each PCU_Timer_Begin to PCU_Timer_End pair is
+  timed as a region, and regions begun inside others form a call tree.
+  PCU_Comm_Free then prints the tree merged over the ranks with the
+  minimum, average and maximum seconds of each region.
+  The timers are also turned on by setting the PCU_TIMERS
+  environment variable to anything but 0, or by setting PCU_TRACE.
+  This function must be called by all ranks outside of any region.
+ */
+void PCU_Timers(bool on)
+{
+  if (!PCU_Comm_Initialized())
+    reel_fail("Timers called before Comm_Init");
+  pcu_timer_enable(on);
+}
+
+/** \brief Keeps every region call for Chrome trace files.
+  \details While the timers are on, each rank also records its region
+  calls and the report writes them to the file prefix<rank>.json in
+  the trace event format read by chrome://tracing and Perfetto.
+  A NULL prefix stops the recording. The PCU_TRACE environment
+  variable sets the prefix when PCU starts.
+ */
+void PCU_Timers_Trace(const char* prefix)
+{
+  pcu_timer_trace(prefix);
+}
+
+/** \brief Prints the region tree now rather than at PCU_Comm_Free.
+  \details This function must be called by all ranks, outside
+  PCU_Thrd_Run, and does nothing if the timers are off.
+ */
+void PCU_Timers_Report(void)
+{
+  if (!PCU_Comm_Initialized())
+    reel_fail("Timers_Report called before Comm_Init");
+  if (pcu_thread_running())
+    reel_fail("Timers_Report called inside PCU_Thrd_Run");
+  pcu_timer_report(pcu_pmpi_comm());
+}
+
+/** \brief Begins a timed region inside the current one.
+  \details This only checks a flag while the timers are off.
+  C++ code should prefer a scoped PCU_Region.
+ */
+void PCU_Timer_Begin(const char* name)
+{
+  pcu_timer_begin(name);
+}
+
+/** \brief Ends the region begun last. */
+void PCU_Timer_End(void)
+{
+  pcu_timer_end();
+}
+
+/** \brief Returns the number of regions this rank has timed.
+  \details Regions are numbered in the order they were first begun,
+  so a parent always comes before its children, and the tree of
+  each rank is its own. Tools that compare runs read the tree with
+  PCU_Timer_Name, PCU_Timer_Parent, PCU_Timer_Calls and
+  PCU_Timer_Seconds.
+ */
+int PCU_Timers_Count(void)
+{
+  return pcu_timer_count();
+}
+
+static void check_region(int region)
+{
+  if (region < 0 || region >= pcu_timer_count())
+    reel_fail("invalid timer region %d", region);
+}
+
+/** \brief Returns the name of a region, see PCU_Timers_Count. */
+const char* PCU_Timer_Name(int region)
+{
+  check_region(region);
+  return pcu_timer_name(region);
+}
+
+/** \brief Returns the parent of a region or -1 for a root. */
+int PCU_Timer_Parent(int region)
+{
+  check_region(region);
+  return pcu_timer_parent(region);
+}
+
+/** \brief Returns how many times a region was ended. */
+int PCU_Timer_Calls(int region)
+{
+  check_region(region);
+  return pcu_timer_calls(region);
+}
+
+/** \brief Returns the seconds spent in a region on this rank. */
+double PCU_Timer_Seconds(int region)
+{
+  check_region(region);
+  return pcu_timer_seconds(region);
+}
@@ -0,0 +1,40 @@
+/******************************************************************************
+
+  Copyright 2011 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#ifndef PCU_TIMER_H
+#define PCU_TIMER_H
+
+#include <mpi.h>
+#include <stdbool.h>
+
+/* the PCU timers (pcu_timer for short) time named regions that
+   nest into a call tree: a region begun inside another one is its
+   child, so the same name under different parents is timed apart.
+   Regions are thread-local like the profiler, and beginning or
+   ending one only checks a flag while the timers are off.
+   With tracing on every region call is also kept as an event for
+   a Chrome trace file per rank. */
+
+void pcu_timer_enable(bool on);
+bool pcu_timer_enabled(void);
+void pcu_timer_trace(const char* prefix);
+void pcu_timer_begin(const char* name);
+void pcu_timer_end(void);
+/* the regions of this thread, parents before their children */
+int pcu_timer_count(void);
+const char* pcu_timer_name(int region);
+int pcu_timer_parent(int region);
+int pcu_timer_calls(int region);
+double pcu_timer_seconds(int region);
+/* collective over comm, gathers the trees and prints their merge
+   from rank 0, then writes the trace files if tracing */
+void pcu_timer_report(MPI_Comm comm);
+void pcu_timer_free(void);
+
+#endif
@@ -37,10 +37,18 @@ set(SOURCES
    pcu_aa.c
    pcu_coll.c
    pcu_io.c
+   pcu_iostats.c
+   pcu_lz.c
+  pcu_mem.c
    pcu_buffer.c
    pcu_mpi.c
    pcu_msg.c
    pcu_order.c
+   pcu_phase.c
+   pcu_profile.c
+  pcu_reduce.c
+   pcu_thread.c
+   pcu_timer.c
    pcu_pmpi.c
    pcu_util.c
    noto/noto_malloc.c
@@ -33,7 +33,6 @@ namespace {
     ctrl.adaptFlag = 1; //enable adaptation
     ctrl.adaptStrategy = 6; //banded isotropic adaptation around the zero level set
     ctrl.solutionMigration = 1;
-    ctrl.outMeshFileName = std::string("bz2:chefStream/");
   }
 }
 
@@ -22,7 +22,9 @@ namespace chef {
   /** @brief read from files and write to stream */
   void cook(gmi_model*& g, apf::Mesh2*& m,
       ph::Input& ctrl, GRStream* out);
-  /** @brief read and write to and from streams */
+  /** @brief read and write to and from streams
+      @remark no output directories or auxiliary files are made
+              unless writeRestartFiles or writeGeomBCFiles is set */
   void cook(gmi_model*& g, apf::Mesh2*& m,
       ph::Input& ctrl, RStream* in, GRStream* out);
   /** @brief extract a field from a packed field */
@@ -103,13 +103,11 @@ void setupOutputSubdir(std::string& path, bool all_mkdir)
   PCU_Barrier();
 }
 
-void setupInputSubdir(std::string& path)
+std::string getInputSubdirPath(std::string const& path, int parts, int part)
 {
-  if (PCU_Comm_Peers() <= DIR_FANOUT)
-    return;
-  int self = PCU_Comm_Self();
-  int subGroup = self / DIR_FANOUT;
-  std::string newpath;
+  if (parts <= DIR_FANOUT)
+    return path;
+  int subGroup = part / DIR_FANOUT;
   std::stringstream ss;
 
   std::size_t found = path.find_last_of("/");
@@ -123,9 +121,14 @@ void setupInputSubdir(std::string& path)
     //insert before the last "/" character the subgroup id 0, 1, 2 etc
     ss << path.substr(0,found) << "/" << subGroup << "/" << path.substr(found+1);
   }
+  return ss.str();
+}
 
-//  printf("Rank: %d - Path in setupInputSubdir: %s\n", self, ss.str().c_str());
-  path = ss.str();
+void setupInputSubdir(std::string& path)
+{
+  if (PCU_Comm_Peers() <= DIR_FANOUT)
+    return;
+  path = getInputSubdirPath(path, PCU_Comm_Peers(), PCU_Comm_Self());
   PCU_Barrier();
 }
 
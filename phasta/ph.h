@@ -13,6 +13,8 @@ void goToStepDir(int step, bool all_mkdir=false);
 void goToParentDir();
 std::string setupOutputDir(bool all_mkdir=false);
 void setupInputSubdir(std::string& path);
+/* the path setupInputSubdir gives part (part) of (parts) */
+std::string getInputSubdirPath(std::string const& path, int parts, int part);
 void setupOutputSubdir(std::string& path, bool all_mkdir=false);
 void writeAuxiliaryFiles(std::string path, int timestep_or_dat);
 bool mesh_has_ext(const char* filename, const char* ext);
@@ -4,7 +4,6 @@
 #include <ma.h>
 #include <PCU.h>
 #include <sam.h>
-#include <samSz.h>
 #include <parma.h>
 
 #include <cstdio>
@@ -182,18 +181,56 @@ void adapt(Input& in, apf::Mesh2* m)
   m->verify();
 }
 
-void setLevelSetIsoField(apf::MeshEntity* v, double* sol,
-    ph::Input& in, apf::Field* szFld) {
+/* the size field of strategy 6, computed in place: the vertices in
+   the band around the zero level set get the band sizes without
+   looking at their edges, the others keep the average length of
+   their edges as samSz::isoSize computes it, with one exchange */
+static apf::Field* getLevelSetSize(Input& in, apf::Mesh* m)
+{
+  apf::Field* soln = m->findField("solution");
+  PCU_ALWAYS_ASSERT(soln);
+  PCU_ALWAYS_ASSERT(apf::countComponents(soln) == in.ensa_dof);
   int distIdx = 5;  // this is the component in the solution field that holds the distance field
-  const double dist = std::fabs(sol[distIdx]);
-  double h = apf::getScalar(szFld,v,0);
-  if ( dist < in.alphaDist )
-    h = in.alphaSize;
-  else if ( dist < in.betaDist )
-    h = in.betaSize;
-  else if ( dist < in.gammaDist )
-    h = in.gammaSize;
-  apf::setScalar(szFld,v,0,h);
+  apf::Field* sz = apf::createFieldOn(m, "lvlSetSize", apf::SCALAR);
+  /* edge length sum and count, summed over the parts */
+  apf::Field* edges = apf::createPackedField(m, "lvlSetEdges", 2);
+  apf::NewArray<double> s(in.ensa_dof);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::getComponents(soln, v, 0, &s[0]);
+    const double dist = std::fabs(s[distIdx]);
+    double lc[2] = {0, 0};
+    if ( dist < in.alphaDist )
+      apf::setScalar(sz, v, 0, in.alphaSize);
+    else if ( dist < in.betaDist )
+      apf::setScalar(sz, v, 0, in.betaSize);
+    else if ( dist < in.gammaDist )
+      apf::setScalar(sz, v, 0, in.gammaSize);
+    else {
+      apf::Up up;
+      m->getUp(v, up);
+      for (int i = 0; i < up.n; ++i)
+        if (m->isOwned(up.e[i])) {
+          lc[0] += apf::measure(m, up.e[i]);
+          lc[1] += 1;
+        }
+    }
+    apf::setComponents(edges, v, 0, lc);
+  }
+  m->end(it);
+  apf::accumulate(edges);
+  apf::synchronize(edges);
+  it = m->begin(0);
+  while ((v = m->iterate(it))) {
+    double lc[2];
+    apf::getComponents(edges, v, 0, lc);
+    if (lc[1]) /* outside the band */
+      apf::setScalar(sz, v, 0, lc[0] / lc[1]);
+  }
+  m->end(it);
+  apf::destroyField(edges);
+  return sz;
 }
 
 }
@@ -211,34 +248,11 @@ namespace chef {
 
   void adaptLevelSet(ph::Input& in, apf::Mesh2* m)
   {
-    ma::Input* ma_in = ma::configureMatching(m, in.recursiveUR);
-    ph::setupBalance("preAdaptBalanceMethod", in.preAdaptBalanceMethod,
-        ma_in->shouldRunPreParma, ma_in->shouldRunPreZoltan,
-        ma_in->shouldRunPreZoltanRib);
-    // get the level set
-    apf::Field* soln = m->findField("solution");
-    PCU_ALWAYS_ASSERT(soln);
-    // assert that there is a scalar component
-    int size = apf::countComponents(soln);
-    PCU_ALWAYS_ASSERT(size == in.ensa_dof);
-    fprintf(stderr, "found %d components in solution field\n", size);
-    // get the size field
-    apf::Field* szFld = samSz::isoSize(m);
-    apf::NewArray<double> s(in.ensa_dof);
-    apf::MeshIterator* it = m->begin(0);
-    apf::MeshEntity* v;
-    while ((v = m->iterate(it))) {
-      apf::getComponents(soln, v, 0, &s[0]);
-      setLevelSetIsoField(v, &s[0], in, szFld);
-    }
-    m->end(it);
-    if (in.snap) {
-      if (!ma_in->shouldSnap)
-        ph::fail("adapt.inp requests snapping but model doesn't support it\n");
-    } else {
-      ma_in->shouldSnap = false;
-    }
+    if (in.snap && !m->canSnap())
+      ph::fail("adapt.inp requests snapping but model doesn't support it\n");
+    apf::Field* szFld = ph::getLevelSetSize(in, m);
     chef::adapt(m,szFld,in);
+    apf::destroyField(szFld);
   }
 
   void uniformRefinement(ph::Input& in, apf::Mesh2* m)
@@ -0,0 +1,104 @@
+#include "phAggregate.h"
+#include <PCU.h>
+#include <pcu_util.h>
+#include <pcu_io.h>
+#include <algorithm>
+#include <sstream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace ph {
+
+enum {
+  VERSION = 1,
+  HEADER_BYTES = 24,
+  ENTRY_BYTES = 16
+};
+
+static void putBigEndian(unsigned char* p, unsigned long long v, int bytes)
+{
+  for (int i = bytes - 1; i >= 0; --i) {
+    p[i] = v & 0xFF;
+    v >>= 8;
+  }
+}
+
+std::string getAggregatePath(std::string const& prefix, int partsPerFile)
+{
+  std::stringstream ss;
+  ss << prefix << PCU_Comm_Self() / partsPerFile + 1;
+  return ss.str();
+}
+
+static MPI_File openGroup(std::string const& path, MPI_Comm comm)
+{
+  double start = pcu_io_time();
+  MPI_File fh;
+  int mode = MPI_MODE_CREATE | MPI_MODE_WRONLY;
+  if (MPI_File_open(comm, path.c_str(), mode, MPI_INFO_NULL, &fh)
+      != MPI_SUCCESS) {
+    fprintf(stderr, "failed to open \"%s\"!\n", path.c_str());
+    abort();
+  }
+  pcu_io_opened(PCU_IO_PHASTA, start);
+  return fh;
+}
+
+static void closeGroup(MPI_File& fh)
+{
+  double start = pcu_io_time();
+  MPI_File_close(&fh);
+  pcu_io_closed(PCU_IO_PHASTA, start);
+}
+
+void writeAggregate(std::string const& prefix, int partsPerFile,
+    char const* data, size_t size)
+{
+  int self = PCU_Comm_Self();
+  int peers = PCU_Comm_Peers();
+  int file = self / partsPerFile;
+  int first = file * partsPerFile;
+  int count = std::min(partsPerFile, peers - first);
+  MPI_Comm comm;
+  MPI_Comm_split(PCU_Get_Comm(), file, self, &comm);
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  unsigned long long stored = size;
+  unsigned long long offset = 0;
+  MPI_Exscan(&stored, &offset, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+  unsigned long long headSize = HEADER_BYTES +
+    (unsigned long long)count * ENTRY_BYTES;
+  if (!rank)
+    offset = 0;
+  offset += headSize;
+  unsigned char entry[ENTRY_BYTES];
+  putBigEndian(entry, offset, 8);
+  putBigEndian(entry + 8, stored, 8);
+  std::vector<unsigned char> head;
+  if (!rank) {
+    head.resize(headSize);
+    memcpy(&head[0], "PHGA", 4);
+    putBigEndian(&head[4], VERSION, 4);
+    putBigEndian(&head[8], peers, 4);
+    putBigEndian(&head[12], (peers + partsPerFile - 1) / partsPerFile, 4);
+    putBigEndian(&head[16], first, 4);
+    putBigEndian(&head[20], count, 4);
+  } else {
+    headSize = 0;
+  }
+  MPI_Gather(entry, ENTRY_BYTES, MPI_BYTE,
+      rank ? 0 : &head[HEADER_BYTES], ENTRY_BYTES, MPI_BYTE, 0, comm);
+  std::string path = getAggregatePath(prefix, partsPerFile);
+  MPI_File fh = openGroup(path, comm);
+  MPI_File_set_size(fh, 0);
+  pcu_io_transfer_all(fh, comm, 0, rank ? 0 : (char*)&head[0], headSize,
+      true, PCU_IO_PHASTA);
+  pcu_io_transfer_all(fh, comm, offset, const_cast<char*>(data), stored,
+      true, PCU_IO_PHASTA);
+  closeGroup(fh);
+  MPI_Comm_free(&comm);
+}
+
+}
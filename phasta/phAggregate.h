@@ -0,0 +1,33 @@
+#ifndef PH_AGGREGATE_H
+#define PH_AGGREGATE_H
+
+#include <string>
+#include <cstddef>
+
+namespace ph {
+
+/* Aggregated files: groups of (partsPerFile) consecutive parts
+   share one file each, written with collective MPI-IO calls.
+   A file holds a header, an index with one entry per part, then
+   the parts' sections in order, each the unchanged bytes the part
+   would have written to its own file.  Numbers are big-endian.
+
+   header: "PHGA", version, parts, files, first part,
+           parts in this file (4 bytes each)
+   entry:  offset, bytes (8 bytes each)
+
+   Chef only writes this format; PHASTA reads it.  Chef reads geombc
+   coordinates back only when redistributing a restart onto a
+   different number of parts, which the per-group index cannot
+   serve, so those files must be written one per part. */
+
+/* the path of the aggregated file holding this part */
+std::string getAggregatePath(std::string const& prefix, int partsPerFile);
+
+/* writes this part's section of its group's file, collectively */
+void writeAggregate(std::string const& prefix, int partsPerFile,
+    char const* data, size_t size);
+
+}
+
+#endif
@@ -209,6 +209,7 @@ static void addAttribute(BCFactories& fs, pAttribute a, pGEntity ge,
   ph::FieldBCs& fbcs = bcs.fields[type];
   BCFactory f = fs[type];
   fbcs.bcs.insert( f(a, ge) );
+  fbcs.reached.clear();
 }
 
 static void addAttributes(BCFactories& fs, pPList as, pGEntity ge,
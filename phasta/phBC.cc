@@ -79,6 +79,7 @@ ConstantBC* makeConstantBC(BCs& bcs, std::string const& name, int dim, int tag,
   bc->tag = tag;
   bc->value = new double[nvals];
   fbcs.bcs.insert(bc);
+  fbcs.reached.clear();
   return bc;
 }
 
@@ -274,6 +275,24 @@ double* getBCValue(gmi_model* gm, FieldBCs& bcs, gmi_ent* ge,
   return bc->eval(x);
 }
 
+static void reachBCs(gmi_model* gm, FieldBCs& bcs, gmi_ent* ge,
+    std::vector<BC*>& found)
+{
+  ConstantBC keyObj;
+  keyObj.tag = gmi_tag(gm, ge);
+  keyObj.dim = gmi_dim(gm, ge);
+  BC* key = &keyObj;
+  FieldBCs::Set::iterator it = bcs.bcs.find(key);
+  if (it != bcs.bcs.end()) {
+    found.push_back(*it);
+    return;
+  }
+  gmi_set* up = gmi_adjacent(gm, ge, gmi_dim(gm, ge) + 1);
+  for (int i = 0; i < up->n; ++i)
+    reachBCs(gm, bcs, up->e[i], found);
+  gmi_free_set(up);
+}
+
 /* starting from the current geometric entity,
    try to find attribute (kbc) attached to
    geometric entities by searching all upward
@@ -283,25 +302,32 @@ double* getBCValue(gmi_model* gm, FieldBCs& bcs, gmi_ent* ge,
    adjacencies as graph edges.
    if an attached attribute is found on an
    entity, the search continues without looking
-   at its upward adjacencies */
+   at its upward adjacencies.
+   the search only depends on the model entity,
+   so it is done for the first mesh entity
+   classified there and only evaluation is left
+   for the rest */
+std::vector<BC*> const& getReachedBCs(gmi_model* gm, FieldBCs& bcs,
+    gmi_ent* ge)
+{
+  FieldBCs::Reached::iterator it = bcs.reached.find(ge);
+  if (it != bcs.reached.end())
+    return it->second;
+  std::vector<BC*>& found = bcs.reached[ge];
+  reachBCs(gm, bcs, ge, found);
+  return found;
+}
+
 static bool applyBC(gmi_model* gm, gmi_ent* ge,
     FieldBCs& bcs,
     apf::Vector3 const& x,
     KnownBC const& kbc,
     double* values, int* bits)
 {
-  double* v = getBCValue(gm, bcs, ge, x);
-  if (v) {
-    kbc.apply(values, bits, kbc, v);
-    return true;
-  }
-  bool appliedAny = false;
-  gmi_set* up = gmi_adjacent(gm, ge, gmi_dim(gm, ge) + 1);
-  for (int i = 0; i < up->n; ++i)
-    if ( applyBC(gm, up->e[i], bcs, x, kbc, values, bits) )
-      appliedAny = true;
-  gmi_free_set(up);
-  return appliedAny;
+  std::vector<BC*> const& reached = getReachedBCs(gm, bcs, ge);
+  for (size_t i = 0; i < reached.size(); ++i)
+    kbc.apply(values, bits, kbc, reached[i]->eval(x));
+  return !reached.empty();
 }
 
 static bool applyBCs(gmi_model* gm, gmi_ent* ge,
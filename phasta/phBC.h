@@ -4,6 +4,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <apfVector.h>
 #include <gmi.h>
@@ -119,6 +120,10 @@ struct FieldBCs
   ~FieldBCs();
   typedef std::set<BC*, BCPointerLess> Set;
   Set bcs;
+  /* the conditions first reached from each model entity,
+     see getReachedBCs. Cleared when bcs changes */
+  typedef std::map<gmi_ent*, std::vector<BC*> > Reached;
+  Reached reached;
 };
 
 struct BCs
@@ -146,6 +151,12 @@ bool applyElasticConstaints(gmi_model* gm, BCs& bcs, gmi_ent* e,
 double* getBCValue(gmi_model* gm, FieldBCs& bcs, gmi_ent* ge,
     apf::Vector3 const& x = apf::Vector3(0,0,0));
 
+/* the conditions found by searching upward from ge, stopping
+   at entities that have one, in search order. The search runs
+   once per model entity and is remembered in bcs.reached */
+std::vector<BC*> const& getReachedBCs(gmi_model* gm, FieldBCs& bcs,
+    gmi_ent* ge);
+
 bool haveBC(BCs& bcs, std::string const& name);
 
 ConstantBC* makeConstantBC(BCs& bcs, std::string const& name, int dim, int tag,
@@ -121,13 +121,14 @@ void getBoundaryBlockKey(apf::Mesh* m, apf::MeshEntity* e,
 void getBoundaryBlocks(apf::Mesh* m, BCs& bcs, Blocks& b)
 {
   int boundaryDim = m->getDimension() - 1;
+  FieldBCs& dgbcs = bcs.fields["DG interface"];
   apf::MeshIterator* it = m->begin(boundaryDim);
   apf::MeshEntity* f;
   while ((f = m->iterate(it))) {
     apf::ModelEntity* me = m->toModel(f);
     if (m->getModelType(me) != boundaryDim)
       continue;
-    if (getBCValue(m->getModel(), bcs.fields["DG interface"], (gmi_ent*) me) != 0) {
+    if (getBCValue(m->getModel(), dgbcs, (gmi_ent*) me) != 0) {
       apf::DgCopies dgCopies;
       m->getDgCopies(f, dgCopies);
       if (dgCopies.getSize() == 1) // This prevents adding interface elements...
@@ -5,6 +5,10 @@
 #include <apf.h>
 #include <stdio.h>
 #include <pcu_util.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
 
 namespace ph {
 
@@ -46,62 +50,198 @@ void readBubbles(Bubbles& bubbles, std::string bubbleFileName)
 
 }
 
-void setBubbleScalars(apf::Mesh* m, apf::MeshEntity* v,
-    Bubbles& bubbles, double* sol)
+/* the bubbles binned by center on a uniform grid of about one
+   bubble per cell. The cells are searched in rings around a point,
+   until no bubble in the next ring can be nearer or contain it */
+struct BubbleGrid
 {
-  apf::Vector3 v_center;
-  m->getPoint(v, 0, v_center);
-
-  int bubbleid = 0; // Initialization critical here
-  double distx;
-  double disty;
-  double distz;
-  double tmpdist;
-  double distance = 1e99; // Initialization critical here
-
-  /* search through bubbles, 
-     find the distance to the nearet bubble membrane (sphere) */
-  for(unsigned long i=0; i<bubbles.size(); i++) 
+  BubbleGrid(Bubbles const& b):
+    bubbles(b),
+    maxRadius(0)
   {
-    distx = (v_center[0]-bubbles[i].center[0]);
-    disty = (v_center[1]-bubbles[i].center[1]);
-    distz = (v_center[2]-bubbles[i].center[2]);
-    tmpdist = sqrt(distx*distx + disty*disty + distz*distz)
-            - bubbles[i].radius;
-    if(tmpdist < distance)
-    {
-      distance = tmpdist;
-      if (distance < 0) 
-      {
-        bubbleid = bubbles[i].id;
-        break;
-        //if v is inside a bubble, stop searching since
-        //bubbles should not intersect each other
+    apf::Vector3 upper;
+    for (int j = 0; j < 3; ++j)
+      lower[j] = upper[j] = bubbles.empty() ? 0 : bubbles[0].center[j];
+    for (size_t i = 0; i < bubbles.size(); ++i) {
+      for (int j = 0; j < 3; ++j) {
+        lower[j] = std::min(lower[j], bubbles[i].center[j]);
+        upper[j] = std::max(upper[j], bubbles[i].center[j]);
       }
+      maxRadius = std::max(maxRadius, bubbles[i].radius);
+    }
+    double extent = 0;
+    for (int j = 0; j < 3; ++j)
+      extent = std::max(extent, upper[j] - lower[j]);
+    double perSide = std::ceil(std::cbrt(double(bubbles.size())));
+    h = extent > 0 ? extent / perSide : 1;
+    for (int j = 0; j < 3; ++j)
+      dims[j] = int((upper[j] - lower[j]) / h) + 1;
+    /* counting sort by cell, which keeps the file order in a cell */
+    first.assign(dims[0] * dims[1] * dims[2] + 1, 0);
+    std::vector<int> cells(bubbles.size());
+    for (size_t i = 0; i < bubbles.size(); ++i) {
+      int c[3];
+      for (int j = 0; j < 3; ++j)
+        c[j] = std::min(dims[j] - 1,
+            int((bubbles[i].center[j] - lower[j]) / h));
+      cells[i] = (c[0] * dims[1] + c[1]) * dims[2] + c[2];
+      ++first[cells[i] + 1];
     }
+    for (size_t i = 1; i < first.size(); ++i)
+      first[i] += first[i - 1];
+    items.resize(bubbles.size());
+    std::vector<int> next(first.begin(), first.end() - 1);
+    for (size_t i = 0; i < bubbles.size(); ++i)
+      items[next[cells[i]]++] = i;
   }
+  struct Search
+  {
+    apf::Vector3 x;
+    double outside; // distance to the nearest membrane outside of
+    int inside; // the first bubble in file order containing x
+    double insideDistance;
+  };
+  void searchCell(Search& s, int a, int b, int c) const
+  {
+    int cell = (a * dims[1] + b) * dims[2] + c;
+    for (int k = first[cell]; k < first[cell + 1]; ++k) {
+      int i = items[k];
+      double distx = (s.x[0]-bubbles[i].center[0]);
+      double disty = (s.x[1]-bubbles[i].center[1]);
+      double distz = (s.x[2]-bubbles[i].center[2]);
+      double tmpdist = sqrt(distx*distx + disty*disty + distz*distz)
+                     - bubbles[i].radius;
+      if (tmpdist < 0) {
+        if (s.inside == -1 || i < s.inside) {
+          s.inside = i;
+          s.insideDistance = tmpdist;
+        }
+      } else if (tmpdist < s.outside) {
+        s.outside = tmpdist;
+      }
+    }
+  }
+  /* the cells of the grid at ring (k) around cell (o) */
+  void searchRing(Search& s, int const o[3], int k) const
+  {
+    int lo[3], hi[3];
+    for (int j = 0; j < 3; ++j) {
+      lo[j] = std::max(o[j] - k, 0);
+      hi[j] = std::min(o[j] + k, dims[j] - 1);
+    }
+    for (int a = lo[0]; a <= hi[0]; ++a)
+      for (int b = lo[1]; b <= hi[1]; ++b) {
+        if (std::abs(a - o[0]) == k || std::abs(b - o[1]) == k) {
+          for (int c = lo[2]; c <= hi[2]; ++c)
+            searchCell(s, a, b, c);
+          continue;
+        }
+        if (o[2] - k >= 0 && o[2] - k < dims[2])
+          searchCell(s, a, b, o[2] - k);
+        if (k && o[2] + k >= 0 && o[2] + k < dims[2])
+          searchCell(s, a, b, o[2] + k);
+      }
+  }
+  /* the same distance and id as testing every bubble in file order,
+     stopping at the first one that contains x */
+  void find(apf::Vector3 const& x, double& distance, int& bubbleid) const
+  {
+    Search s;
+    s.x = x;
+    s.outside = 1e99;
+    s.inside = -1;
+    s.insideDistance = 0;
+    int o[3];
+    int start = 0;
+    int reach = 0;
+    for (int j = 0; j < 3; ++j) {
+      double c = std::floor((x[j] - lower[j]) / h);
+      c = std::max(-1e9, std::min(1e9, c));
+      o[j] = int(c);
+      start = std::max(start, std::max(-o[j], o[j] - (dims[j] - 1)));
+      reach = std::max(reach, std::max(o[j], dims[j] - 1 - o[j]));
+    }
+    if (!bubbles.empty())
+      for (int k = start; k <= reach; ++k) {
+        /* centers in ring k are at least k - 1 cells away */
+        double bound = (k - 1) * h - maxRadius;
+        double best = s.inside == -1 ? s.outside : 0;
+        if (k > start && bound >= best)
+          break;
+        searchRing(s, o, k);
+      }
+    if (s.inside == -1) {
+      distance = s.outside;
+      bubbleid = 0;
+    } else {
+      distance = s.insideDistance;
+      bubbleid = bubbles[s.inside].id;
+    }
+  }
+  Bubbles const& bubbles;
+  apf::Vector3 lower;
+  double h;
+  int dims[3];
+  double maxRadius;
+  /* the bubbles of cell i are items[first[i]] to items[first[i+1]-1] */
+  std::vector<int> first;
+  std::vector<int> items;
+};
 
-  sol[5] = distance;
-  sol[6] = static_cast<double>(bubbleid);
-
-}
+/* the vertices are read and the results written serially,
+   only the searches in between run on (threads) */
+struct BubbleSearch
+{
+  BubbleSearch(Bubbles const& b):
+    grid(b)
+  {
+  }
+  static void compute(void* p, size_t first, size_t end)
+  {
+    BubbleSearch* all = static_cast<BubbleSearch*>(p);
+    for (size_t i = first; i < end; ++i)
+      all->grid.find(all->points[i], all->distances[i], all->ids[i]);
+  }
+  void run(int threads)
+  {
+    size_t n = points.size();
+    distances.resize(n);
+    ids.resize(n);
+    PCU_Thrd_Chunks(threads, n, compute, this);
+  }
+  BubbleGrid grid;
+  std::vector<apf::Vector3> points;
+  std::vector<double> distances;
+  std::vector<int> ids;
+};
 
 void initBubbles(apf::Mesh* m, Input& in)
 {
   Bubbles bubbles;
   readBubbles(bubbles, in.bubbleFileName);
   PCU_ALWAYS_ASSERT(in.ensa_dof >= 7);
-  apf::NewArray<double> s(in.ensa_dof);
-  apf::Field* f = m->findField("solution");
+  BubbleSearch search(bubbles);
   apf::MeshIterator* it = m->begin(0);
   apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    search.points.push_back(x);
+  }
+  m->end(it);
+  search.run(in.bubbleThreads);
+  apf::NewArray<double> s(in.ensa_dof);
+  apf::Field* f = m->findField("solution");
+  it = m->begin(0);
+  size_t i = 0;
   while ((v = m->iterate(it))) {
     apf::getComponents(f, v, 0, &s[0]);
-    setBubbleScalars(m, v, bubbles, &s[0]);
+    s[5] = search.distances[i];
+    s[6] = static_cast<double>(search.ids[i]);
     apf::setComponents(f, v, 0, &s[0]);
+    ++i;
   }
   m->end(it);
 }
 
 }
-
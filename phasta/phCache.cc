@@ -0,0 +1,128 @@
+#include "phCache.h"
+#include "phOutput.h"
+#include "phHash.h"
+#include <apf.h>
+#include <apfMesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+namespace ph {
+
+static void hashInt(unsigned long long& h, int i)
+{
+  hashBytes(h, &i, sizeof(i));
+}
+
+static void hashPoint(unsigned long long& h, apf::Mesh* m,
+    apf::MeshEntity* v)
+{
+  apf::Vector3 x;
+  m->getPoint(v, 0, x);
+  hashBytes(h, &x[0], 3 * sizeof(double));
+}
+
+/* entities are identified by their vertices' coordinates,
+   so the hash follows the mesh and not its memory layout
+   beyond the iteration order */
+static unsigned long long hashPart(apf::Mesh* m)
+{
+  unsigned long long h = hashStart;
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    hashInt(h, m->count(d));
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      hashInt(h, m->getType(e));
+      apf::ModelEntity* c = m->toModel(e);
+      hashInt(h, m->getModelType(c));
+      hashInt(h, m->getModelTag(c));
+      apf::Downward vs;
+      int nv = m->getDownward(e, 0, vs);
+      for (int i = 0; i < nv; ++i)
+        hashPoint(h, m, vs[i]);
+      apf::Copies remotes;
+      m->getRemotes(e, remotes);
+      APF_ITERATE(apf::Copies, remotes, rit)
+        hashInt(h, rit->first);
+      if (m->hasMatching()) {
+        apf::Matches matches;
+        m->getMatches(e, matches);
+        for (size_t i = 0; i < matches.getSize(); ++i)
+          hashInt(h, matches[i].peer);
+      }
+    }
+    m->end(it);
+  }
+  return h;
+}
+
+static unsigned long long hashFile(std::string const& path)
+{
+  unsigned long long h = hashStart;
+  std::ifstream f(path.c_str(), std::ios::binary);
+  char buf[1 << 16];
+  while (f) {
+    f.read(buf, sizeof(buf));
+    hashBytes(h, buf, f.gcount());
+  }
+  return h;
+}
+
+std::string getGeomBCKey(Input& in, apf::Mesh* m)
+{
+  double t0 = PCU_Time();
+  unsigned long long h[3] = {0, 0, 0};
+  /* odd weights keep the sum sensitive to which part has what */
+  h[0] = hashPart(m) * (2ULL * PCU_Comm_Self() + 1);
+  if (!PCU_Comm_Self()) {
+    h[1] = hashGeomBCInputs(in);
+    h[2] = hashFile(in.attributeFileName);
+  }
+  MPI_Allreduce(MPI_IN_PLACE, h, 3, MPI_UNSIGNED_LONG_LONG, MPI_SUM,
+      PCU_Get_Comm());
+  std::stringstream ss;
+  ss << std::hex << h[0] << ' ' << h[1] << ' ' << h[2]
+     << ' ' << std::dec << PCU_Comm_Peers();
+  double t1 = PCU_Time();
+  if (!PCU_Comm_Self())
+    printf("geombc key computed in %f seconds\n", t1 - t0);
+  return ss.str();
+}
+
+bool hasCachedGeomBC(Input& in, std::string const& dir,
+    std::string const& subdir, std::string const& key)
+{
+  std::string keyPath = dir + "geombc.key";
+  int matches = 0;
+  if (!PCU_Comm_Self()) {
+    std::ifstream f(keyPath.c_str());
+    std::string old;
+    matches = std::getline(f, old) && old == key;
+  }
+  PCU_Max_Ints(&matches, 1);
+  int exists = !access(getGeomBCPath(in, subdir).c_str(), R_OK);
+  PCU_Min_Ints(&exists, 1);
+  bool cached = matches && exists;
+  if (!cached && !PCU_Comm_Self())
+    remove(keyPath.c_str());
+  if (cached && !PCU_Comm_Self())
+    printf("geombc files in %s are up to date\n", dir.c_str());
+  return cached;
+}
+
+void saveGeomBCKey(std::string const& dir, std::string const& key)
+{
+  PCU_Barrier();
+  if (PCU_Comm_Self())
+    return;
+  std::string keyPath = dir + "geombc.key";
+  std::ofstream f(keyPath.c_str());
+  PCU_ALWAYS_ASSERT(f.is_open());
+  f << key << '\n';
+}
+
+}
@@ -0,0 +1,34 @@
+#ifndef PH_CACHE_H
+#define PH_CACHE_H
+
+#include <string>
+#include "phInput.h"
+
+namespace apf {
+class Mesh;
+}
+
+namespace ph {
+
+/* With cacheGeomBC, chef records a key next to the geombc files it
+   writes: a hash of every part's mesh (coordinates, connectivity,
+   classification, remote copies and matches), of the attribute file
+   and of the settings from hashGeomBCInputs.  When a later run finds
+   the same key and all the files, it skips building and writing the
+   geombc files and only writes the restart files. */
+
+/* the key of this mesh and input, the same on all parts */
+std::string getGeomBCKey(Input& in, apf::Mesh* m);
+
+/* true on all parts if (dir)geombc.key holds (key) and every
+   part's geombc file under (subdir) exists.  Otherwise the stale
+   key is removed. */
+bool hasCachedGeomBC(Input& in, std::string const& dir,
+    std::string const& subdir, std::string const& key);
+
+/* records (key) for the geombc files just written */
+void saveGeomBCKey(std::string const& dir, std::string const& key);
+
+}
+
+#endif
@@ -474,42 +474,33 @@ static Constraint* combineElas(Constraint* a, Constraint* b,
 
 typedef Constraint* (*Make)(double* values);
 
-/* similar flow to getFirstApplied in phBC.cc, but we
-   have to account for all first-reachable BCs, not just
-   the first one we see. */
+/* all first-reachable BCs are combined, from the
+   search of getReachedBCs in phBC.cc */
 Constraint* combineAll(gmi_model* gm, FieldBCs& bcs, Make make,
     gmi_ent* ge, apf::Vector3 const& x, Constraint* a)
 {
-  double* v = getBCValue(gm, bcs, ge, x);
-  if (v) {
+  std::vector<BC*> const& reached = getReachedBCs(gm, bcs, ge);
+  for (size_t i = 0; i < reached.size(); ++i) {
     DebugConstraint dbg;
-    dbg.modelTag = gmi_tag(gm, ge);
-    dbg.modelDim = gmi_dim(gm, ge);
-    Constraint* b = make(v);
-    return combine(a, b, dbg);
+    dbg.modelTag = reached[i]->tag;
+    dbg.modelDim = reached[i]->dim;
+    Constraint* b = make(reached[i]->eval(x));
+    a = combine(a, b, dbg);
   }
-  gmi_set* up = gmi_adjacent(gm, ge, gmi_dim(gm, ge) + 1);
-  for (int i = 0; i < up->n; ++i)
-    a = combineAll(gm, bcs, make, up->e[i], x, a);
-  gmi_free_set(up);
   return a;
 }
 
 Constraint* combineAllElas(gmi_model* gm, FieldBCs& bcs, Make make,
     gmi_ent* ge, apf::Vector3 const& x, Constraint* a)
 {
-  double* v = getBCValue(gm, bcs, ge, x);
-  if (v) {
+  std::vector<BC*> const& reached = getReachedBCs(gm, bcs, ge);
+  for (size_t i = 0; i < reached.size(); ++i) {
     DebugConstraint dbg;
-    dbg.modelTag = gmi_tag(gm, ge);
-    dbg.modelDim = gmi_dim(gm, ge);
-    Constraint* b = make(v);
-    return combineElas(a, b, dbg);
+    dbg.modelTag = reached[i]->tag;
+    dbg.modelDim = reached[i]->dim;
+    Constraint* b = make(reached[i]->eval(x));
+    a = combineElas(a, b, dbg);
   }
-  gmi_set* up = gmi_adjacent(gm, ge, gmi_dim(gm, ge) + 1);
-  for (int i = 0; i < up->n; ++i)
-    a = combineAllElas(gm, bcs, make, up->e[i], x, a);
-  gmi_free_set(up);
   return a;
 }
 
@@ -519,23 +510,20 @@ Constraint* combineInterface
   gmi_ent* ge, apf::Vector3 const& x, Constraint* a
 )
 {
-  double* v = getBCValue(gm, bcs, ge, x);
-  if (v) {
+  (void)x;
+  std::vector<BC*> const& reached = getReachedBCs(gm, bcs, ge);
+  for (size_t i = 0; i < reached.size(); ++i) {
     /* The interface attribute only takes an integer value now
        and it is not even used. So, in order to reuse combineElas,
        fake value (u) is used. It is equivalent to mag=0, direction=(1,0,0)
      */
     double u[4] = {0,1,0,0}; 
     DebugConstraint dbg;
-    dbg.modelTag = gmi_tag(gm, ge);
-    dbg.modelDim = gmi_dim(gm, ge);
+    dbg.modelTag = reached[i]->tag;
+    dbg.modelDim = reached[i]->dim;
     Constraint* b = make(u);
-    return combineElas(a, b, dbg);
+    a = combineElas(a, b, dbg);
   }
-  gmi_set* up = gmi_adjacent(gm, ge, gmi_dim(gm, ge) + 1);
-  for (int i = 0; i < up->n; ++i)
-    a = combineInterface(gm, bcs, make, up->e[i], x, a);
-  gmi_free_set(up);
   return a;
 }
 
@@ -14,6 +14,7 @@
 #include <phOutput.h>
 #include <phPartition.h>
 #include <phFilterMatching.h>
+#include <phCache.h>
 #include "phInterfaceCutter.h"
 #include "phiotimer.h" //for phastaio_initStats and phastaio_printStats
 #include <parma.h>
@@ -137,6 +138,20 @@ namespace ph {
         ph::balance(in,m);
   }
 
+  static apf::MdsOrder getReorderMethod(std::string const& method) {
+    if (method == "rcm")
+      return apf::RCM_ORDER;
+    if (method == "hilbert")
+      return apf::HILBERT_ORDER;
+    if (method == "morton")
+      return apf::MORTON_ORDER;
+    if (method == "blocked")
+      return apf::BLOCKED_ORDER;
+    if (!PCU_Comm_Self())
+      fprintf(stderr, "unknown reorderMethod \"%s\"\n", method.c_str());
+    abort();
+  }
+
   void checkReorder(apf::Mesh2* m, ph::Input& in, int numMasters) {
     /* check if the mesh changed at all */
     if ( (PCU_Comm_Peers()!=numMasters) ||
@@ -145,6 +160,10 @@ namespace ph {
         in.tetrahedronize ||
         in.isReorder )
     {
+      if (in.isReorder && in.reorderMethod != "bfs") {
+        apf::reorderMdsMesh(m,getReorderMethod(in.reorderMethod));
+        return;
+      }
       apf::MeshTag* order = NULL;
       if (in.isReorder && PCU_Comm_Peers() > 1)
         order = Parma_BfsReorder(m);
@@ -158,19 +177,62 @@ namespace ph {
   }
 
   void preprocess(apf::Mesh2* m, Input& in, Output& out, BCs& bcs) {
+    PCU_Region region("ph::preprocess");
     phastaio_initStats();
     if(PCU_Comm_Peers() > 1)
       ph::migrateInterfaceItr(m, bcs);
     if (in.simmetrixMesh == 0)
       ph::checkReorder(m,in,PCU_Comm_Peers());
-    if (in.adaptFlag)
+    /* streamed outputs need no directories unless
+       file copies of them were requested */
+    bool inMemory = out.grs &&
+      !in.writeRestartFiles && !in.writeGeomBCFiles;
+    if (in.adaptFlag && !inMemory)
       ph::goToStepDir(in.timeStepNumber,in.ramdisk);
-    std::string path = ph::setupOutputDir(in.ramdisk);
+    std::string path;
+    if (!inMemory)
+      path = ph::setupOutputDir(in.ramdisk);
     std::string subDirPath = path;
-    ph::setupOutputSubdir(subDirPath,in.ramdisk);
+    if (!inMemory)
+      ph::setupOutputSubdir(subDirPath,in.ramdisk);
+    /* with cacheGeomBC, geombc files of the same mesh and
+       settings are kept and only the restart files are written */
+    bool useCache = in.cacheGeomBC && !out.grs;
+    std::string key;
+    bool cached = false;
+    if (useCache) {
+      key = ph::getGeomBCKey(in, m);
+      cached = ph::hasCachedGeomBC(in, path,
+          in.geombcPartsPerFile > 0 ? path : subDirPath, key);
+    }
     ph::enterFilteredMatching(m, in, bcs);
-    ph::generateOutput(in, bcs, m, out);
+    if (cached)
+      ph::generateFieldOutput(in, bcs, m, out);
+    else
+      ph::generateOutput(in, bcs, m, out);
     ph::exitFilteredMatching(m);
+    if ( in.writeGeomBCFiles ) {
+      if(!PCU_Comm_Self()) printf("write additional geomBC file for visualization\n");
+      // store the value of the function pointer
+      FILE* (*fn)(Output& out, const char* path) = out.openfile_write;
+      // set function pointer for file writing
+      out.openfile_write = chef::openfile_write;
+      ph::writeGeomBC(out, path, in.timeStepNumber); //write geombc for viz only
+      // reset the function pointer to the original value
+      out.openfile_write = fn;
+    }
+    if (!cached) {
+      /* aggregated geombc files are few enough for one directory */
+      if (in.geombcPartsPerFile > 0)
+        ph::writeGeomBC(out, path); //write geombc
+      else
+        ph::writeGeomBC(out, subDirPath); //write geombc
+      if (useCache)
+        ph::saveGeomBCKey(path, key);
+    }
+    /* the geombc arrays are done with before the restart
+       buffers are filled, so the two never coexist */
+    ph::freeOutputArrays(out);
     // a path is not needed for inmem
     if ( in.writeRestartFiles ) {
       if(!PCU_Comm_Self()) printf("write file-based restart file\n");
@@ -187,25 +249,16 @@ namespace ph {
     }
     if ( ! in.outMeshFileName.empty() )
       m->writeNative(in.outMeshFileName.c_str());
-    if ( in.writeGeomBCFiles ) {
-      if(!PCU_Comm_Self()) printf("write additional geomBC file for visualization\n");
-      // store the value of the function pointer
-      FILE* (*fn)(Output& out, const char* path) = out.openfile_write;
-      // set function pointer for file writing
-      out.openfile_write = chef::openfile_write;
-      ph::writeGeomBC(out, path, in.timeStepNumber); //write geombc for viz only
-      // reset the function pointer to the original value
-      out.openfile_write = fn;
-    }
-    ph::writeGeomBC(out, subDirPath); //write geombc
-    if(!PCU_Comm_Self())
+    /* a streaming solver has the part count from MPI
+       and the time step from the restart stream */
+    if(!PCU_Comm_Self() && !inMemory)
       ph::writeAuxiliaryFiles(path, in.timeStepNumber);
     m->verify();
 #ifdef HAVE_SIMMETRIX
     gmi_model* g = m->getModel();
     ph::clearAttAssociation(g,in);
 #endif
-    if (in.adaptFlag)
+    if (in.adaptFlag && !inMemory)
       ph::goToParentDir();
     if(in.printIOtime) phastaio_printStats();
   }
@@ -226,6 +279,7 @@ namespace ph {
 namespace chef {
   void bake(gmi_model*& g, apf::Mesh2*& m,
       ph::Input& in, ph::Output& out) {
+    PCU_Region region("chef::bake");
     PCU_ALWAYS_ASSERT(PCU_Comm_Peers() % in.splitFactor == 0);
     apf::Migration* plan = 0;
     ph::BCs bcs;
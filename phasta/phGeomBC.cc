@@ -2,6 +2,7 @@
 #include "phOutput.h"
 #include "phIO.h"
 #include "phiotimer.h"
+#include "phAggregate.h"
 #include <sstream>
 #include <pcu_util.h>
 #include <cstdlib>
@@ -282,21 +283,45 @@ static void writeGrowthCurves(Output& o, FILE* f)
   }
 }
 
+static std::string getTimestepOrDat(int timestep)
+{
+  if (! timestep)
+    return "dat";
+  std::stringstream tss;
+  tss << timestep;
+  return tss.str();
+}
+
+std::string getGeomBCPath(Input& in, std::string path, int timestep)
+{
+  std::string timestep_or_dat = getTimestepOrDat(timestep);
+  if (in.geombcPartsPerFile > 0)
+    return getAggregatePath(path + "geombc-agg." + timestep_or_dat + ".",
+        in.geombcPartsPerFile);
+  return path + buildGeomBCFileName(timestep_or_dat);
+}
+
 void writeGeomBC(Output& o, std::string path, int timestep)
 {
   double t0 = PCU_Time();
   apf::Mesh* m = o.mesh;
-  std::stringstream tss; 
-  std::string timestep_or_dat;
-  if (! timestep)
-    timestep_or_dat = "dat";
-  else {
-    tss << timestep;   
-    timestep_or_dat = tss.str();
-  }
-  path += buildGeomBCFileName(timestep_or_dat);
+  std::string timestep_or_dat = getTimestepOrDat(timestep);
   phastaio_setfile(GEOMBC_WRITE);
-  FILE* f = o.openfile_write(o, path.c_str());
+  /* with aggregation the part writes to memory first, and the
+     groups of parts then share geombc-agg.<timestep_or_dat>.<file> */
+  int perFile = 0;
+  if (!o.grs && o.in->geombcPartsPerFile > 0)
+    perFile = o.in->geombcPartsPerFile;
+  char* aggData = 0;
+  size_t aggSize = 0;
+  FILE* f;
+  if (perFile) {
+    path += "geombc-agg." + timestep_or_dat + ".";
+    f = open_memstream(&aggData, &aggSize);
+  } else {
+    path += buildGeomBCFileName(timestep_or_dat);
+    f = o.openfile_write(o, path.c_str());
+  }
   if (!f) {
     fprintf(stderr,"failed to open \"%s\"!\n", path.c_str());
     abort();
@@ -363,6 +388,10 @@ void writeGeomBC(Output& o, std::string path, int timestep)
   writeEdges(o, f);
   writeGrowthCurves(o, f);
   PHASTAIO_CLOSETIME(fclose(f);)
+  if (perFile) {
+    writeAggregate(path, perFile, aggData, aggSize);
+    free(aggData);
+  }
   double t1 = PCU_Time();
   if (!PCU_Comm_Self())
     printf("geombc file written in %f seconds\n", t1 - t0);
@@ -187,9 +187,9 @@ void getGrowthCurves(Output& o)
     int ngc = PList_size(allSeeds);
 
     o.nGrowthCurves = ngc;
-    o.arrays.gcflt = new double[ngc];
-    o.arrays.gcgr  = new double[ngc];
-    o.arrays.igcnv = new int[ngc];
+    o.arrays.gcflt = o.arena.allocate<double>(ngc);
+    o.arrays.gcgr  = o.arena.allocate<double>(ngc);
+    o.arrays.igcnv = o.arena.allocate<int>(ngc);
 
     pPList growthVertices = PList_new();
     pPList growthEdges = PList_new();
@@ -225,7 +225,7 @@ void getGrowthCurves(Output& o)
     int nv = PList_size(allGrowthVertices);
 
     o.nLayeredMeshVertices = nv;
-    o.arrays.igclv = new apf::MeshEntity*[nv];
+    o.arrays.igclv = o.arena.allocate<apf::MeshEntity*>(nv);
 
     for(int i = 0; i < PList_size(allGrowthVertices); i++){
       vertex = (pVertex)PList_item(allGrowthVertices,i);
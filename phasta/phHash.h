@@ -0,0 +1,25 @@
+#ifndef PH_HASH_H
+#define PH_HASH_H
+
+#include <cstddef>
+
+namespace ph {
+
+/* 64-bit FNV-1a: start from hashStart and feed bytes with hashBytes.
+   The hashes are compared across runs and parts, so they must not
+   depend on anything but the bytes given. */
+
+unsigned long long const hashStart = 14695981039346656037ULL;
+
+inline void hashBytes(unsigned long long& h, void const* p, size_t n)
+{
+  unsigned char const* b = static_cast<unsigned char const*>(p);
+  for (size_t i = 0; i < n; ++i) {
+    h ^= b[i];
+    h *= 1099511628211ULL;
+  }
+}
+
+}
+
+#endif
@@ -1,9 +1,11 @@
 #include <PCU.h>
 #include "phInput.h"
 #include <fstream>
+#include <sstream>
 #include <map>
 #include <set>
 #include "ph.h"
+#include "phHash.h"
 #include <pcu_util.h>
 
 /** \file phInput.cc
@@ -39,6 +41,7 @@ static void setDefaults(Input& in)
   in.solutionMigration = 1;
   in.useAttachedFields = 0;
   in.isReorder = 0;
+  in.reorderMethod = "bfs";
   in.openfile_read = 0;
   in.tetrahedronize = 0;
   in.recursiveUR = 1;
@@ -49,8 +52,10 @@ static void setDefaults(Input& in)
   in.threaded = 1;
   in.initBubbles = 0;
   in.bubbleFileName = "bubbles.inp";
+  in.bubbleThreads = 1;
   in.formElementGraph = 0;
   in.restartFileName = "restart";
+  in.restartSourceParts = 0;
   in.phastaIO = 1;
   in.snap = 0;
   in.transferParametric = 0;
@@ -62,6 +67,8 @@ static void setDefaults(Input& in)
   in.writeGeomBCFiles = 0;  // write additional geombc file for vis in streaming
   in.writeRestartFiles = 0;  // write additional restart file for vis in streaming
   in.ramdisk = 0;
+  in.geombcPartsPerFile = 0;
+  in.cacheGeomBC = 0;
   in.meshqCrtn = 0.027; 
   in.elementImbalance = 1.03;
   in.vertexImbalance = 1.05;
@@ -121,14 +128,17 @@ static void formMaps(Input& in, StringMap& stringMap, IntMap& intMap, DblMap& db
   intMap["phastaIO"] = &in.phastaIO;
   intMap["splitFactor"] = &in.splitFactor;
   intMap["SolutionMigration"] = &in.solutionMigration;
+  intMap["restartSourceParts"] = &in.restartSourceParts;
   intMap["UseAttachedFields"] = &in.useAttachedFields;
   intMap["DisplacementMigration"] = &in.displacementMigration;
   intMap["isReorder"] = &in.isReorder;
+  stringMap["reorderMethod"] = &in.reorderMethod;
   intMap["Tetrahedronize"] = &in.tetrahedronize;
   intMap["LocalPtn"] = &in.localPtn;
   intMap["dwalMigration"] = &in.dwalMigration;
   intMap["buildMapping"] = &in.buildMapping;
   intMap["elementsPerMigration"] = &in.elementsPerMigration;
+  intMap["bubbleThreads"] = &in.bubbleThreads;
   intMap["threaded"] = &in.threaded;
   intMap["initBubbles"] = &in.initBubbles;
   stringMap["bubbleFileName"] = &in.bubbleFileName;
@@ -143,6 +153,8 @@ static void formMaps(Input& in, StringMap& stringMap, IntMap& intMap, DblMap& db
   intMap["writeGeomBCFiles"] = &in.writeGeomBCFiles;
   intMap["writeRestartFiles"] = &in.writeRestartFiles;
   intMap["ramdisk"] = &in.ramdisk;
+  intMap["geombcPartsPerFile"] = &in.geombcPartsPerFile;
+  intMap["cacheGeomBC"] = &in.cacheGeomBC;
   dblMap["validQuality"] = &in.validQuality;
   dblMap["meshqCrtn"] = &in.meshqCrtn;
   dblMap["elementImbalance"] = &in.elementImbalance;
@@ -266,4 +278,57 @@ int countScalarBCs(Input& in)
   return in.ensa_dof - 5;
 }
 
+static void makeRuntimeOnly(stringset& runtime)
+{
+  runtime.insert("timeStepNumber");
+  runtime.insert("restartFileName");
+  runtime.insert("outMeshFileName");
+  runtime.insert("SolutionMigration");
+  runtime.insert("restartSourceParts");
+  runtime.insert("UseAttachedFields");
+  runtime.insert("DisplacementMigration");
+  runtime.insert("initBubbles");
+  runtime.insert("bubbleFileName");
+  runtime.insert("bubbleThreads");
+  runtime.insert("timing");
+  runtime.insert("printIOtime");
+  runtime.insert("writeGeomBCFiles");
+  runtime.insert("writeRestartFiles");
+  runtime.insert("ramdisk");
+  runtime.insert("geombcPartsPerFile");
+  runtime.insert("cacheGeomBC");
+}
+
+template <class T>
+static void hashMap(unsigned long long& h, stringset& runtime,
+    std::map<std::string, T*>& map)
+{
+  typename std::map<std::string, T*>::iterator it;
+  for (it = map.begin(); it != map.end(); ++it) {
+    if (runtime.count(it->first))
+      continue;
+    hashBytes(h, it->first.c_str(), it->first.size() + 1);
+    std::stringstream ss;
+    ss.precision(17);
+    ss << *(it->second);
+    std::string v = ss.str();
+    hashBytes(h, v.c_str(), v.size() + 1);
+  }
+}
+
+unsigned long long hashGeomBCInputs(Input& in)
+{
+  StringMap stringMap;
+  IntMap intMap;
+  DblMap dblMap;
+  formMaps(in, stringMap, intMap, dblMap);
+  stringset runtime;
+  makeRuntimeOnly(runtime);
+  unsigned long long h = hashStart;
+  hashMap(h, runtime, stringMap);
+  hashMap(h, runtime, intMap);
+  hashMap(h, runtime, dblMap);
+  return h;
+}
+
 }
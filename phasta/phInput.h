@@ -42,6 +42,12 @@ class Input
       stamp to the name of this restartFileName variable, as well as the file
       number. */
     std::string restartFileName;
+    /** \brief the number of parts the restart files were written on,
+        if different from the number of processes.
+        \details the nodal fields are then matched to the mesh
+       vertices by the coordinates in the geombc.dat files next to
+       the restart files. Zero means the same number of parts. */
+    int restartSourceParts;
     /** \brief path to the spj or smd file containing the boundary
        and initial conditions*/
     std::string attributeFileName;
@@ -105,6 +111,12 @@ class Input
     int useAttachedFields;
     int displacementMigration;
     int isReorder;
+    /** \brief the vertex ordering applied when isReorder is set.
+        \details valid options are 'bfs' (the default, Parma's breadth first
+      search on more than one part), 'rcm' (reverse Cuthill-McKee), 'hilbert',
+      'morton', and 'blocked' (Hilbert blocks each ordered by reverse
+      Cuthill-McKee). The bandwidth and profile before and after are printed. */
+    std::string reorderMethod;
     /** \brief tetrahedronize a mixed mesh if set to 1. */
     int tetrahedronize;
     /** \brief enables the use of local partitioning methods.
@@ -121,6 +133,9 @@ class Input
     int threaded;
     int initBubbles;
     std::string bubbleFileName;
+    /** \brief the number of threads finding the nearest bubble
+        of each vertex for initBubbles */
+    int bubbleThreads;
     int formElementGraph;
     int snap;
     int transferParametric;
@@ -139,6 +154,16 @@ class Input
        between phasta and chef. */
     int writeRestartFiles;
     int ramdisk;
+    /** \brief if positive, groups of this many consecutive parts
+        share each geombc file, written with collective MPI-IO.
+        \details see phAggregate.h for the layout. Chef does not
+        read these files back. Streamed geombc data is not affected. */
+    int geombcPartsPerFile;
+    /** \brief skip building and writing the geombc files when the
+        mesh, the attribute file and the settings they depend on are
+        the same as when the existing files were written.
+        \details see phCache.h */
+    int cacheGeomBC;
     /** \brief the value of criteria for the mesh measure.
         \details this is only used in solver-adaptor (phastaChef) loop.
        If the mesh quality is less than this value,
@@ -182,6 +207,9 @@ class Input
 int countNaturalBCs(Input& in);
 int countEssentialBCs(Input& in);
 int countScalarBCs(Input& in);
+/** \brief a hash of the settings, except those that only affect
+    the restart files or how outputs are stored */
+unsigned long long hashGeomBCInputs(Input& in);
 
 }
 
@@ -54,7 +54,18 @@ static void getCoordinates(Output& o)
 {
   apf::Mesh* m = o.mesh;
   int n = m->count(0);
-  double* x = new double[n * 3];
+  double* x = o.arena.allocate<double>(n * 3);
+  /* the coordinate array in iteration order, if there is one */
+  double const* span = 0;
+  if (n && m->countTagSpan(apf::Mesh::VERTEX) == n)
+    span = m->getPointSpan(0, n);
+  if (span) {
+    for (int i = 0; i < n; ++i)
+      for (int j = 0; j < 3; ++j)
+        x[j * n + i] = span[3 * i + j]; /* FORTRAN indexing */
+    o.arrays.coordinates = x;
+    return;
+  }
   apf::MeshEntity* v;
   int i = 0;
   apf::MeshIterator* it = m->begin(0);
@@ -74,8 +85,8 @@ static void getM2GFields(Output& o) {
   apf::Mesh* m = o.mesh;
   gmi_model* gm = m->getModel();
   int n = m->count(0);
-  o.arrays.m2gClsfcn = new int[n * 3];
-  o.arrays.m2gParCoord = new double[n * 2];
+  o.arrays.m2gClsfcn = o.arena.allocate<int>(n * 3);
+  o.arrays.m2gParCoord = o.arena.allocate<double>(n * 2);
   apf::MeshEntity* v;
   apf::Vector3 pm;
   for (int j = 0; j < 3; ++j) pm[j] = 0.0;
@@ -116,7 +127,7 @@ static void getGlobal(Output& o)
   int self = PCU_Comm_Self();
   int peers = PCU_Comm_Peers();
   int id = self + 1;
-  o.arrays.globalNodeNumbers = new int[n];
+  o.arrays.globalNodeNumbers = o.arena.allocate<int>(n);
   for (int i = 0; i < n; ++i) {
     o.arrays.globalNodeNumbers[i] = id;
     id += peers;
@@ -130,21 +141,39 @@ static void getVertexLinks(Output& o, apf::Numbering* n, BCs& bcs)
   encodeILWORK(n, links, o.nlwork, o.arrays.ilwork);
 }
 
+/* the block of each element type (or element and boundary face type)
+   is looked up in the block map once and then read from a table */
+static int getBlockIndex(Blocks& bs, BlockKey const& k, int& cached)
+{
+  if (cached < 0) {
+    PCU_ALWAYS_ASSERT(bs.keyToIndex.count(k));
+    cached = bs.keyToIndex[k];
+  }
+  return cached;
+}
+
 static void getInterior(Output& o, BCs& bcs, apf::Numbering* n)
 {
   apf::Mesh* m = o.mesh;
   Blocks& bs = o.blocks.interior;
-  int*** ien     = new int**[bs.getSize()];
+  int*** ien     = o.arena.allocate<int**>(bs.getSize());
   int**  mattype = 0;
-  if (bcs.fields.count("material type"))
-    mattype = new int* [bs.getSize()];
+  FieldBCs* matbcs = 0;
+  if (bcs.fields.count("material type")) {
+    mattype = o.arena.allocate<int*>(bs.getSize());
+    matbcs = &bcs.fields["material type"];
+  }
   apf::NewArray<int> js(bs.getSize());
   for (int i = 0; i < bs.getSize(); ++i) {
-    ien    [i] = new int*[bs.nElements[i]];
+    ien    [i] = o.arena.allocateRows<int>(bs.nElements[i],
+        bs.nElementNodes[i]);
     if (mattype)
-      mattype[i] = new int [bs.nElements[i]];
+      mattype[i] = o.arena.allocate<int>(bs.nElements[i]);
     js[i] = 0;
   }
+  int blockOfType[apf::Mesh::TYPES];
+  for (int t = 0; t < apf::Mesh::TYPES; ++t)
+    blockOfType[t] = -1;
   gmi_model* gm = m->getModel();
   apf::MeshEntity* e;
   apf::MeshIterator* it = m->begin(m->getDimension());
@@ -152,10 +181,8 @@ static void getInterior(Output& o, BCs& bcs, apf::Numbering* n)
     BlockKey k;
     getInteriorBlockKey(m, e, k);
     int nv = k.nElementVertices;
-    PCU_ALWAYS_ASSERT(bs.keyToIndex.count(k));
-    int i = bs.keyToIndex[k];
+    int i = getBlockIndex(bs, k, blockOfType[m->getType(e)]);
     int j = js[i];
-    ien[i][j] = new int[nv];
     apf::Downward v;
     getVertices(m, e, v);
     for (int k = 0; k < nv; ++k)
@@ -167,9 +194,7 @@ static void getInterior(Output& o, BCs& bcs, apf::Numbering* n)
       apf::Vector3 x;
       //m->getPoint(e, 0, x);
       x = apf::getLinearCentroid(m, e);
-      std::string s("material type");
-      FieldBCs& fbcs = bcs.fields[s];
-      double* matval = getBCValue(gm, fbcs, ge, x);
+      double* matval = getBCValue(gm, *matbcs, ge, x);
       mattype[i][j] = *matval;
     }
     ++js[i];
@@ -227,21 +252,31 @@ static void getBoundary(Output& o, BCs& bcs, apf::Numbering* n)
   gmi_model* gm = m->getModel();
   int nbc = countNaturalBCs(*o.in);
   Blocks& bs = o.blocks.boundary;
-  int*** ienb = new int**[bs.getSize()];
+  int*** ienb = o.arena.allocate<int**>(bs.getSize());
   int**  mattypeb = 0;
-  if (bcs.fields.count("material type"))
-    mattypeb = new int*[bs.getSize()];
-  int*** ibcb = new int**[bs.getSize()];
-  double*** bcb = new double**[bs.getSize()];
+  FieldBCs* matbcs = 0;
+  if (bcs.fields.count("material type")) {
+    mattypeb = o.arena.allocate<int*>(bs.getSize());
+    matbcs = &bcs.fields["material type"];
+  }
+  FieldBCs& dgbcs = bcs.fields["DG interface"];
+  int*** ibcb = o.arena.allocate<int**>(bs.getSize());
+  double*** bcb = o.arena.allocate<double**>(bs.getSize());
   apf::NewArray<int> js(bs.getSize());
   for (int i = 0; i < bs.getSize(); ++i) {
-    ienb[i]     = new int*[bs.nElements[i]];
+    ienb[i]     = o.arena.allocateRows<int>(bs.nElements[i],
+        bs.nElementNodes[i]);
     if (mattypeb)
-      mattypeb[i] = new int [bs.nElements[i]];
-    ibcb[i]     = new int*[bs.nElements[i]];
-    bcb[i]      = new double*[bs.nElements[i]];
+      mattypeb[i] = o.arena.allocate<int>(bs.nElements[i]);
+    /* the arena zeroes the codes and values */
+    ibcb[i]     = o.arena.allocateRows<int>(bs.nElements[i], 2);
+    bcb[i]      = o.arena.allocateRows<double>(bs.nElements[i], nbc);
     js[i] = 0;
   }
+  int blockOfTypes[apf::Mesh::TYPES][apf::Mesh::TYPES];
+  for (int t = 0; t < apf::Mesh::TYPES; ++t)
+    for (int ft = 0; ft < apf::Mesh::TYPES; ++ft)
+      blockOfTypes[t][ft] = -1;
   int boundaryDim = m->getDimension() - 1;
   apf::MeshEntity* f;
   apf::MeshIterator* it = m->begin(boundaryDim);
@@ -249,7 +284,7 @@ static void getBoundary(Output& o, BCs& bcs, apf::Numbering* n)
     apf::ModelEntity* me = m->toModel(f);
     if (m->getModelType(me) != boundaryDim)
       continue;
-    if (getBCValue(m->getModel(), bcs.fields["DG interface"], (gmi_ent*) me) != 0){
+    if (getBCValue(gm, dgbcs, (gmi_ent*) me) != 0){
       apf::DgCopies dgCopies;
       m->getDgCopies(f, dgCopies);
       if (dgCopies.getSize() == 1) // This prevents adding interface elements...
@@ -261,18 +296,14 @@ static void getBoundary(Output& o, BCs& bcs, apf::Numbering* n)
     apf::MeshEntity* e = m->getUpward(f, 0);
     BlockKey k;
     getBoundaryBlockKey(m, e, f, k);
-    PCU_ALWAYS_ASSERT(bs.keyToIndex.count(k));
-    int i = bs.keyToIndex[k];
+    int i = getBlockIndex(bs, k, blockOfTypes[m->getType(e)][m->getType(f)]);
     int j = js[i];
     int nv = k.nElementVertices;
     apf::Downward v;
     getBoundaryVertices(m, e, f, v);
-    ienb[i][j] = new int[nv];
     checkBoundaryVertex(m, f, v, k.elementType);
     for (int k = 0; k < nv; ++k)
       ienb[i][j][k] = apf::getNumber(n, v[k], 0, 0);
-    bcb[i][j] = new double[nbc]();
-    ibcb[i][j] = new int[2](); /* <- parens initialize to zero */
     apf::Vector3 x = apf::getLinearCentroid(m, f);
     applyNaturalBCs(gm, gf, bcs, x, bcb[i][j], ibcb[i][j]);
 
@@ -280,9 +311,7 @@ static void getBoundary(Output& o, BCs& bcs, apf::Numbering* n)
     if (mattypeb) {
       gmi_ent* ge = (gmi_ent*)m->toModel(e);
       x = apf::getLinearCentroid(m, e);
-      std::string s("material type");
-      FieldBCs& fbcs = bcs.fields[s];
-      double* matvalb = getBCValue(gm, fbcs, ge, x);
+      double* matvalb = getBCValue(gm, *matbcs, ge, x);
       mattypeb[i][j] = *matvalb;
     }
     ++js[i];
@@ -305,7 +334,7 @@ static void getRigidBody(Output& o, BCs& bcs, apf::Numbering* n) {
   std::map<int, int> rbIDmap; // map id to model tag
   std::map<int, int>::iterator rit;
   int nv = m->count(0);
-  int* f = new int[nv];
+  int* f = o.arena.allocate<int>(nv);
   o.numRigidBody = 0;
 
 // initialize f with -1 for all mesh vertices
@@ -369,8 +398,8 @@ static void getRigidBody(Output& o, BCs& bcs, apf::Numbering* n) {
   }
 
   int rbIDs_size = PCU_Max_Int(rbIDmap.size());
-  int* rbIDs = new int[rbIDs_size]();
-  int* rbMTs = new int[rbIDs_size]();
+  int* rbIDs = o.arena.allocate<int>(rbIDs_size);
+  int* rbMTs = o.arena.allocate<int>(rbIDs_size);
 
   if (!PCU_Comm_Self()) {
     int count = 0;
@@ -440,7 +469,7 @@ bool checkInterface(Output& o, BCs& bcs) {
 static void getInterfaceFlag(Output& o, BCs& bcs) {
   apf::Mesh* m = o.mesh;
   int n = m->count(0);
-  int* f = new int[n];
+  int* f = o.arena.allocate<int>(n);
   apf::MeshEntity* v;
   int i = 0;
   o.hasDGInterface = 0;
@@ -473,20 +502,20 @@ static void getInterface
   apf::Mesh*        m  = o.mesh;
   gmi_model*        gm = m->getModel();
   BlocksInterface&  bs = o.blocks.interface;
-  int***            ienif0 = new int**[bs.getSize()];
-  int***            ienif1 = new int**[bs.getSize()];
+  int***            ienif0 = o.arena.allocate<int**>(bs.getSize());
+  int***            ienif1 = o.arena.allocate<int**>(bs.getSize());
   int**             mattypeif0 = 0;
   int**             mattypeif1 = 0;
   if (bcs.fields.count("material type")) {
-    mattypeif0 = new int*[bs.getSize()];
-    mattypeif1 = new int*[bs.getSize()];
+    mattypeif0 = o.arena.allocate<int*>(bs.getSize());
+    mattypeif1 = o.arena.allocate<int*>(bs.getSize());
   }
   apf::NewArray<int> js(bs.getSize());
   for (int i = 0; i < bs.getSize(); ++i) {
-    ienif0[i] = new int*[bs.nElements[i]];
-    ienif1[i] = new int*[bs.nElements[i]];
-    if (mattypeif0) mattypeif0[i] = new int [bs.nElements[i]];
-    if (mattypeif1) mattypeif1[i] = new int [bs.nElements[i]];
+    ienif0[i] = o.arena.allocate<int*>(bs.nElements[i]);
+    ienif1[i] = o.arena.allocate<int*>(bs.nElements[i]);
+    if (mattypeif0) mattypeif0[i] = o.arena.allocate<int>(bs.nElements[i]);
+    if (mattypeif1) mattypeif1[i] = o.arena.allocate<int>(bs.nElements[i]);
     js[i] = 0;
   }
   int interfaceDim = m->getDimension() - 1;
@@ -552,8 +581,8 @@ static void getInterface
     for (int i = 0; i < nv1; i++)
       v1[i] = v1_rot[i];
 
-    ienif0[i][j] = new int[nv0];
-    ienif1[i][j] = new int[nv1];
+    ienif0[i][j] = o.arena.allocate<int>(nv0);
+    ienif1[i][j] = o.arena.allocate<int>(nv1);
     checkBoundaryVertex(m, face,              v0, k.elementType );
     checkBoundaryVertex(m, dgCopies[0].entity, v1, k.elementType1);
     for (int k = 0; k < nv0; ++k)
@@ -639,7 +668,7 @@ static apf::MeshEntity* getLocalPeriodicMaster(apf::MatchedSharing* sh,
 static void getLocalPeriodicMasters(Output& o, apf::Numbering* n, BCs& bcs)
 {
   apf::Mesh* m = o.mesh;
-  int* iper = new int[m->count(0)];
+  int* iper = o.arena.allocate<int>(m->count(0));
   apf::MeshIterator* it = m->begin(0);
   apf::MeshEntity* e;
   apf::MatchedSharing* sh = m->hasMatching() ? new apf::MatchedSharing(m) : 0;
@@ -681,11 +710,9 @@ static void getEssentialBCs(BCs& bcs, Output& o)
   if (in.axisymmetry)
     angles = tagAngles(m, bcs, ms);
   int nv = m->count(0);
-  o.arrays.nbc = new int[nv];
-  for (int i = 0; i < nv; ++i)
-    o.arrays.nbc[i] = 0;
-  o.arrays.ibc = new int[nv]();
-  o.arrays.bc = new double*[nv];
+  o.arrays.nbc = o.arena.allocate<int>(nv);
+  o.arrays.ibc = o.arena.allocate<int>(nv);
+  o.arrays.bc = o.arena.allocate<double*>(nv);
   o.nEssentialBCNodes = 0;
   int ibc;
   int nec = countEssentialBCs(in);
@@ -716,7 +743,7 @@ static void getEssentialBCs(BCs& bcs, Output& o)
     if (hasBC) {
       o.arrays.nbc[i] = ei + 1;
       o.arrays.ibc[ei] = ibc;
-      double* bc_ei = new double[nec];
+      double* bc_ei = o.arena.allocate<double>(nec);
       for (int j = 0; j < nec; ++j)
         bc_ei[j] = bc[j];
       o.arrays.bc[ei] = bc_ei;
@@ -774,7 +801,7 @@ static void getGCEssentialBCs(Output& o, apf::Numbering* n)
       if(o.arrays.nbc[vID] <= 0){ // not in array
         o.arrays.nbc[vID] = ei + 1;
         o.arrays.ibc[ei] = ibc;
-        double* bc_new = new double[nec];
+        double* bc_new = o.arena.allocate<double>(nec);
         for(k = 0; k < ebcStr; k++)
           bc_new[k] = 0;
         for(k = ebcStr; k < ebcEnd; k++)
@@ -802,18 +829,18 @@ static void getGCEssentialBCs(Output& o, apf::Numbering* n)
 
 // receive top most node
   PCU_Comm_Send();
+  apf::NewArray<double> rbc(nec);
   while (PCU_Comm_Receive()) {
     apf::MeshEntity* rvent;
     PCU_COMM_UNPACK(rvent);
     int ribc = 0;
     PCU_Comm_Unpack(&ribc, sizeof(int));
-    double* rbc = new double[nec];
     PCU_Comm_Unpack(&(rbc[0]), nec*sizeof(double));
     vID = apf::getNumber(n, rvent, 0, 0);
     if(o.arrays.nbc[vID] <= 0){
       o.arrays.nbc[vID] = ei + 1;
       o.arrays.ibc[ei] = ribc;
-      double* rbc_new = new double[nec];
+      double* rbc_new = o.arena.allocate<double>(nec);
       for(k = 0; k < ebcStr; k++)
         rbc_new[k] = 0;
       for(k = ebcStr; k < ebcEnd; k++)
@@ -829,7 +856,7 @@ static void getGCEssentialBCs(Output& o, apf::Numbering* n)
   }
 
 // transfer entity to numbering
-  o.arrays.igclvid = new int[o.nLayeredMeshVertices];
+  o.arrays.igclvid = o.arena.allocate<int>(o.nLayeredMeshVertices);
   for(int i = 0; i < o.nLayeredMeshVertices; i++){
     o.arrays.igclvid[i] = apf::getNumber(n, o.arrays.igclv[i], 0, 0);
   }
@@ -896,7 +923,7 @@ static void getEdges(Output& o, apf::Numbering* vn, apf::Numbering* rn, BCs& bcs
     apf::Mesh* m = o.mesh;
     PCU_ALWAYS_ASSERT(m->getDimension() == 3);
     int nelems = m->count(3);
-    o.arrays.iel = new int[nelems * 6];
+    o.arrays.iel = o.arena.allocate<int>(nelems * 6);
     apf::MeshIterator* it = m->begin(3);
     apf::MeshEntity* e;
     int i = 0;
@@ -916,8 +943,8 @@ static void getEdges(Output& o, apf::Numbering* vn, apf::Numbering* rn, BCs& bcs
     apf::Mesh* m = o.mesh;
     int nelems = m->count(3);
     int nedges = m->count(1);
-    o.arrays.ileo = new int[nedges + 1];
-    o.arrays.ile = new int[nelems * 6];
+    o.arrays.ileo = o.arena.allocate<int>(nedges + 1);
+    o.arrays.ile = o.arena.allocate<int>(nelems * 6);
     apf::MeshIterator* it = m->begin(1);
     apf::MeshEntity* e;
     int i = 0;
@@ -939,80 +966,58 @@ static void getEdges(Output& o, apf::Numbering* vn, apf::Numbering* rn, BCs& bcs
   }
 }
 
-Output::~Output()
+/* chunks this large are shared by the smaller arrays,
+   larger arrays get their own */
+static size_t const arenaChunkBytes = 4 << 20;
+
+void* OutputArena::allocateBytes(size_t n)
 {
-  delete [] arrays.coordinates;
-  delete [] arrays.ilwork;
-  delete [] arrays.ilworkf;
-  delete [] arrays.iper;
-  delete [] arrays.globalNodeNumbers;
-  Blocks& ibs = blocks.interior;
-  for (int i = 0; i < ibs.getSize(); ++i) {
-    for (int j = 0; j < ibs.nElements[i]; ++j)
-      delete [] arrays.ien    [i][j];
-    delete [] arrays.ien    [i];
-    if (arrays.mattype) delete [] arrays.mattype[i];
-  }
-  delete [] arrays.ien;
-  if (arrays.mattype) delete [] arrays.mattype;
-  Blocks& bbs = blocks.boundary;
-  for (int i = 0; i < bbs.getSize(); ++i) {
-    for (int j = 0; j < bbs.nElements[i]; ++j) {
-      delete [] arrays.ienb[i][j];
-      delete [] arrays.ibcb[i][j];
-      delete [] arrays.bcb[i][j];
-    }
-    delete [] arrays.ienb[i];
-    delete [] arrays.ibcb[i];
-    delete [] arrays.bcb[i];
-    if (arrays.mattypeb) delete [] arrays.mattypeb[i];
-  }
-  delete [] arrays.ienb;
-  delete [] arrays.ibcb;
-  delete [] arrays.bcb;
-  delete [] arrays.nbc;
-  delete [] arrays.ibc;
-  if (arrays.mattypeb) delete [] arrays.mattypeb;
-  for (int i = 0; i < nEssentialBCNodes; ++i)
-    delete [] arrays.bc[i];
-  delete [] arrays.bc;
-  delete [] arrays.ienneigh;
-  BlocksInterface& ifbs = blocks.interface;
-  for (int i = 0; i < ifbs.getSize(); ++i) {
-    for (int j = 0; j < ifbs.nElements[i]; ++j) {
-      delete [] arrays.ienif0[i][j];
-      delete [] arrays.ienif1[i][j];
-    }
-    delete [] arrays.ienif0[i];
-    delete [] arrays.ienif1[i];
-    if (arrays.mattypeif0) delete [] arrays.mattypeif0[i];
-    if (arrays.mattypeif1) delete [] arrays.mattypeif1[i];
-  }
-  delete [] arrays.ienif0;
-  delete [] arrays.ienif1;
-  if (arrays.mattypeif0) delete [] arrays.mattypeif0;
-  if (arrays.mattypeif1) delete [] arrays.mattypeif1;
-  delete [] arrays.ilworkl;
-  delete [] arrays.iel;
-  delete [] arrays.ileo;
-  delete [] arrays.ile;
-//-------growth curve--------
-  if (in->simmetrixMesh) {
-    delete [] arrays.gcflt;
-    delete [] arrays.gcgr;
-    delete [] arrays.igcnv;
-    delete [] arrays.igclv;
-    delete [] arrays.igclvid;
+  /* zero sizes still get distinct storage, as new[] gives */
+  n = std::max(n, (size_t)1);
+  n = (n + 15) & ~(size_t)15;
+  if (n > arenaChunkBytes / 4) {
+    char* big = static_cast<char*>(calloc(n, 1));
+    PCU_ALWAYS_ASSERT(big);
+    chunks.push_back(big);
+    bytes += n;
+    return big;
   }
-//---------------------------
-  if (in->mesh2geom) {
-    delete [] arrays.m2gClsfcn;
-    delete [] arrays.m2gParCoord;
+  if (n > left) {
+    next = static_cast<char*>(calloc(arenaChunkBytes, 1));
+    PCU_ALWAYS_ASSERT(next);
+    chunks.push_back(next);
+    left = arenaChunkBytes;
+    bytes += arenaChunkBytes;
   }
-  delete [] arrays.interfaceFlag;
-  delete [] arrays.rigidBodyIDs;
-  delete [] arrays.rigidBodyMTs;
-  delete [] arrays.rigidBodyTag;
+  void* p = next;
+  next += n;
+  left -= n;
+  return p;
+}
+
+void OutputArena::clear()
+{
+  for (size_t i = 0; i < chunks.size(); ++i)
+    free(chunks[i]);
+  chunks.clear();
+  next = 0;
+  left = 0;
+  bytes = 0;
+}
+
+void freeOutputArrays(Output& o)
+{
+  delete [] o.arrays.ilwork;
+  delete [] o.arrays.ilworkf;
+  delete [] o.arrays.ilworkl;
+  delete [] o.arrays.ienneigh;
+  o.arena.clear();
+  o.arrays = EnsaArrays();
+}
+
+Output::~Output()
+{
+  freeOutputArrays(*this);
 }
 
 void generateOutput(Input& in, BCs& bcs, apf::Mesh* mesh, Output& o)
@@ -1051,8 +1056,20 @@ void generateOutput(Input& in, BCs& bcs, apf::Mesh* mesh, Output& o)
   if (in.initBubbles)
     initBubbles(o.mesh, in);
   double t1 = PCU_Time();
-  if (!PCU_Comm_Self())
+  double mb = PCU_Max_Double(o.arena.getBytes() / (1024. * 1024.));
+  if (!PCU_Comm_Self()) {
     printf("generated output structs in %f seconds\n",t1 - t0);
+    printf("output arrays use at most %f MB on a part\n", mb);
+  }
+}
+
+void generateFieldOutput(Input& in, BCs& bcs, apf::Mesh* mesh, Output& o)
+{
+  o.in = &in;
+  o.mesh = mesh;
+  getInitialConditions(bcs, o);
+  if (in.initBubbles)
+    initBubbles(o.mesh, in);
 }
 
 }
@@ -4,6 +4,8 @@
 #include "phInput.h"
 #include "phBlock.h"
 #include "phBC.h"
+#include <cstddef>
+#include <vector>
 
 namespace apf {
 class Mesh;
@@ -129,8 +131,46 @@ idx:   0  1 2  3   4   5  6   7   8   9  10   11  12  13  14  15   16   17   18
 };
 
 
+/* zeroed storage for the output arrays, carved from a few large
+   chunks instead of one allocation per array (or per row),
+   and freed all at once */
+class OutputArena
+{
+  public:
+    OutputArena():next(0),left(0),bytes(0) {}
+    ~OutputArena() {clear();}
+    template <class T>
+    T* allocate(size_t n)
+    {
+      return static_cast<T*>(allocateBytes(n * sizeof(T)));
+    }
+    /* rows of (width) each, sharing one allocation */
+    template <class T>
+    T** allocateRows(int n, int width)
+    {
+      T** rows = allocate<T*>(n);
+      T* all = allocate<T>((size_t)n * width);
+      for (int j = 0; j < n; ++j)
+        rows[j] = all + (size_t)j * width;
+      return rows;
+    }
+    void clear();
+    /* bytes of the chunks held */
+    size_t getBytes() const {return bytes;}
+  private:
+    OutputArena(OutputArena const&);
+    OutputArena& operator=(OutputArena const&);
+    void* allocateBytes(size_t n);
+    std::vector<char*> chunks;
+    char* next;
+    size_t left;
+    size_t bytes;
+};
+
 struct Output
 {
+  Output():in(0),mesh(0),nEssentialBCNodes(0),openfile_write(0),grs(0),
+    arrays() {}
   ~Output();
   Input* in;
   apf::Mesh* mesh;
@@ -149,13 +189,24 @@ struct Output
   bool hasDGInterface;
   bool numRigidBody;
   FILE* (*openfile_write)(Output& out, const char* path);
+  /* the in-memory destination of geombc and restart data, if any */
   GRStream* grs;
   AllBlocks blocks;
   EnsaArrays arrays;
+  /* where the arrays are allocated, except the links from phLinks.cc */
+  OutputArena arena;
 };
 
 void generateOutput(Input& in, BCs& bcs, apf::Mesh* mesh, Output& o);
+/* only the parts of generateOutput that change the mesh fields
+   written to restart files, for when the geombc files are kept */
+void generateFieldOutput(Input& in, BCs& bcs, apf::Mesh* mesh, Output& o);
 void writeGeomBC(Output& o, std::string path, int timestep_or_dat = 0);
+/* frees the arrays of generateOutput once the last writeGeomBC
+   is done, leaving the counts and blocks */
+void freeOutputArrays(Output& o);
+/* the file writeGeomBC writes this part to, for file outputs */
+std::string getGeomBCPath(Input& in, std::string path, int timestep = 0);
 
 }
 
@@ -6,11 +6,15 @@
 #include "phiotimer.h"
 #include "apfShape.h"
 #include "ph.h"
+#include "phHash.h"
 #include <cstdlib>
 #include <fstream>
 #include <sstream>
 #include <pcu_util.h>
 #include <cstring>
+#include <algorithm>
+#include <map>
+#include <vector>
 #ifdef HAVE_SIMMETRIX
 #include <apfSIM.h>
 #endif
@@ -418,17 +422,274 @@ static double* buildMappingVtxId(apf::Mesh* m)
   return data;
 }
 
-static std::string buildRestartFileName(std::string prefix, int step)
+static std::string buildRestartFileName(std::string prefix, int step,
+    int rank = PCU_Comm_Self() + 1)
 {
   std::stringstream ss;
-  int rank = PCU_Comm_Self() + 1;
   ss << prefix << '.' << step << '.' << rank;
   return ss.str();
 }
 
+/* a restart written on (in.restartSourceParts) parts. The restart
+   files carry no global ids, so the vertices are matched by their
+   coordinates in the geombc files written next to them: owned
+   vertices and source nodes meet at the part their coordinates
+   hash to, which sends the values back to the owner */
+
+struct SourceField
+{
+  std::string name;
+  int vars;
+  double* data;
+};
+
+struct SourcePart
+{
+  int nodes;
+  double* coordinates;
+  std::vector<SourceField> fields;
+};
+
+struct Point
+{
+  double x[3];
+  bool operator<(Point const& other) const
+  {
+    return std::lexicographical_compare(x, x + 3, other.x, other.x + 3);
+  }
+};
+
+static int getRendezvous(Point const& p)
+{
+  unsigned long long h = hashStart;
+  hashBytes(h, p.x, sizeof(p.x));
+  return h % PCU_Comm_Peers();
+}
+
+static FILE* openSourceFile(Input& in, std::string const& path)
+{
+  FILE* f = in.openfile_read(in, path.c_str());
+  if (!f) {
+    fprintf(stderr,"failed to open \"%s\"!\n", path.c_str());
+    abort();
+  }
+  return f;
+}
+
+static void readSourcePart(Input& in, int part, SourcePart& sp)
+{
+  std::string prefix = getInputSubdirPath(in.restartFileName,
+      in.restartSourceParts, part);
+  std::string dir = prefix.substr(0, prefix.find_last_of('/') + 1);
+  std::stringstream ss;
+  ss << dir << "geombc.dat." << part + 1;
+  FILE* f = openSourceFile(in, ss.str());
+  int swap = ph_should_swap(f);
+  int vars, step;
+  char hname[1024];
+  int ret = ph_read_field(f, "co-ordinates", swap,
+      &sp.coordinates, &sp.nodes, &vars, &step, hname);
+  PCU_ALWAYS_ASSERT(ret == 2 && vars == 3);
+  fclose(f);
+  f = openSourceFile(in,
+      buildRestartFileName(prefix, in.timeStepNumber, part + 1));
+  swap = ph_should_swap(f);
+  SourceField sf;
+  int nodes;
+  while ((ret = ph_read_field(f, "", swap,
+          &sf.data, &nodes, &sf.vars, &step, hname))) {
+    if (ret == 1)
+      continue;
+    if (nodes != sp.nodes) {
+      if (!part)
+        fprintf(stderr, "field \"%s\" is not nodal, it is not "
+                        "redistributed\n", hname);
+      free(sf.data);
+      continue;
+    }
+    PCU_ALWAYS_ASSERT(step == in.timeStepNumber);
+    sf.name = hname;
+    sp.fields.push_back(sf);
+  }
+  fclose(f);
+}
+
+/* the fields of source part 0, which part 0 reads */
+static void shareFieldList(std::vector<SourcePart> const& parts,
+    std::vector<std::string>& names, std::vector<int>& vars)
+{
+  PCU_Comm_Begin();
+  if (!PCU_Comm_Self()) {
+    std::vector<SourceField> const& fields = parts[0].fields;
+    for (int to = 0; to < PCU_Comm_Peers(); ++to) {
+      int n = fields.size();
+      PCU_COMM_PACK(to, n);
+      for (size_t i = 0; i < fields.size(); ++i) {
+        int length = fields[i].name.size();
+        PCU_COMM_PACK(to, length);
+        PCU_Comm_Pack(to, fields[i].name.c_str(), length);
+        PCU_COMM_PACK(to, fields[i].vars);
+      }
+    }
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    int n;
+    PCU_COMM_UNPACK(n);
+    for (int i = 0; i < n; ++i) {
+      int length;
+      PCU_COMM_UNPACK(length);
+      std::string name(length, '\0');
+      PCU_Comm_Unpack(&name[0], length);
+      int v;
+      PCU_COMM_UNPACK(v);
+      names.push_back(name);
+      vars.push_back(v);
+    }
+  }
+}
+
+static void readAndRedistribute(Input& in, apf::Mesh* m)
+{
+  int self = PCU_Comm_Self();
+  int peers = PCU_Comm_Peers();
+  std::vector<SourcePart> parts;
+  for (int p = self; p < in.restartSourceParts; p += peers) {
+    parts.push_back(SourcePart());
+    readSourcePart(in, p, parts.back());
+  }
+  std::vector<std::string> names;
+  std::vector<int> vars;
+  shareFieldList(parts, names, vars);
+  int width = 0;
+  for (size_t i = 0; i < vars.size(); ++i)
+    width += vars[i];
+  /* send owned vertices and source nodes to their rendezvous */
+  PCU_Comm_Begin();
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  int index = 0;
+  while ((v = m->iterate(it))) {
+    if (m->isOwned(v)) {
+      Point p;
+      apf::Vector3 x;
+      m->getPoint(v, 0, x);
+      x.toArray(p.x);
+      int to = getRendezvous(p);
+      int isSource = 0;
+      PCU_COMM_PACK(to, isSource);
+      PCU_COMM_PACK(to, p);
+      PCU_COMM_PACK(to, index);
+    }
+    ++index;
+  }
+  m->end(it);
+  std::vector<double> values(width);
+  for (size_t i = 0; i < parts.size(); ++i) {
+    SourcePart& sp = parts[i];
+    PCU_ALWAYS_ASSERT(sp.fields.size() == names.size());
+    for (int j = 0; j < sp.nodes; ++j) {
+      Point p;
+      for (int k = 0; k < 3; ++k)
+        p.x[k] = sp.coordinates[k * sp.nodes + j];
+      int c = 0;
+      for (size_t f = 0; f < names.size(); ++f) {
+        PCU_ALWAYS_ASSERT(sp.fields[f].name == names[f]);
+        PCU_ALWAYS_ASSERT(sp.fields[f].vars == vars[f]);
+        for (int k = 0; k < vars[f]; ++k)
+          values[c++] = sp.fields[f].data[k * sp.nodes + j];
+      }
+      int to = getRendezvous(p);
+      int isSource = 1;
+      PCU_COMM_PACK(to, isSource);
+      PCU_COMM_PACK(to, p);
+      PCU_Comm_Pack(to, &values[0], width * sizeof(double));
+    }
+    free(sp.coordinates);
+    for (size_t f = 0; f < sp.fields.size(); ++f)
+      free(sp.fields[f].data);
+  }
+  PCU_Comm_Send();
+  typedef std::map<Point, std::vector<double> > Sources;
+  Sources sources;
+  std::vector<std::pair<Point, std::pair<int, int> > > requests;
+  while (PCU_Comm_Receive()) {
+    int isSource;
+    Point p;
+    PCU_COMM_UNPACK(isSource);
+    PCU_COMM_UNPACK(p);
+    if (isSource) {
+      PCU_Comm_Unpack(&values[0], width * sizeof(double));
+      /* nodes on part boundaries arrive once per part, keep one */
+      sources.insert(std::make_pair(p, values));
+    } else {
+      PCU_COMM_UNPACK(index);
+      requests.push_back(std::make_pair(p,
+            std::make_pair(PCU_Comm_Sender(), index)));
+    }
+  }
+  /* send the values back to the owners */
+  long missing = 0;
+  PCU_Comm_Begin();
+  for (size_t i = 0; i < requests.size(); ++i) {
+    Sources::iterator s = sources.find(requests[i].first);
+    if (s == sources.end()) {
+      ++missing;
+      continue;
+    }
+    int to = requests[i].second.first;
+    PCU_COMM_PACK(to, requests[i].second.second);
+    PCU_Comm_Pack(to, &s->second[0], width * sizeof(double));
+  }
+  PCU_Comm_Send();
+  size_t n = m->count(0);
+  std::vector<double*> data(names.size());
+  for (size_t f = 0; f < names.size(); ++f)
+    data[f] = (double*)calloc(n * vars[f], sizeof(double));
+  while (PCU_Comm_Receive()) {
+    PCU_COMM_UNPACK(index);
+    PCU_Comm_Unpack(&values[0], width * sizeof(double));
+    int c = 0;
+    for (size_t f = 0; f < names.size(); ++f)
+      for (int k = 0; k < vars[f]; ++k)
+        data[f][k * n + index] = values[c++];
+  }
+  missing = PCU_Add_Long(missing);
+  if (missing) {
+    if (!self)
+      fprintf(stderr, "%ld vertices have no match in the restart "
+                      "written on %d parts\n", missing, in.restartSourceParts);
+    abort();
+  }
+  for (size_t f = 0; f < names.size(); ++f) {
+    char const* name = names[f].c_str();
+    int out_size = vars[f];
+    if (names[f] == "solution")
+      out_size = in.ensa_dof;
+    if (m->findField(name)) {
+      if (!self)
+        fprintf(stderr, "field \"%s\" already attached to the mesh, "
+                        "ignoring request to re-attach...\n", name);
+    } else {
+      attachField(m, name, data[f], vars[f], out_size);
+      apf::synchronize(m->findField(name));
+    }
+    free(data[f]);
+  }
+}
+
 void readAndAttachFields(Input& in, apf::Mesh* m) {
   phastaio_initStats();
   double t0 = PCU_Time();
+  if (in.restartSourceParts > 0 &&
+      in.restartSourceParts != PCU_Comm_Peers()) {
+    readAndRedistribute(in, m);
+    double t1 = PCU_Time();
+    if (!PCU_Comm_Self())
+      printf("fields of %d parts read and redistributed in %f seconds\n",
+          in.restartSourceParts, t1 - t0);
+    return;
+  }
   setupInputSubdir(in.restartFileName);
   std::string filename = buildRestartFileName(in.restartFileName, in.timeStepNumber);
   phastaio_setfile(RESTART_READ);
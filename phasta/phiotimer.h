@@ -3,48 +3,60 @@
 
 /** \file phiotimer.h
     \brief timers for reading and writing phasta files
+    \details the macros also record the operations in the PCU
+             I/O statistics, as phasta files (see PCU_IO_Stats)
 */
 
+#include <pcu_io.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 #define PHASTAIO_READTIME(cmd,bytes) {\
     phastaioTime t0,t1;\
+    const double pcu_t0 = pcu_io_time();\
     phastaio_time(&t0);\
     cmd\
     phastaio_time(&t1);\
     const size_t time = phastaio_time_diff(&t0,&t1);\
     phastaio_addReadTime(time);\
     phastaio_addReadBytes(bytes);\
+    pcu_io_read(PCU_IO_PHASTA,(bytes),pcu_t0);\
 }
 
 #define PHASTAIO_WRITETIME(cmd,bytes) {\
     phastaioTime t0,t1;\
+    const double pcu_t0 = pcu_io_time();\
     phastaio_time(&t0);\
     cmd\
     phastaio_time(&t1);\
     const size_t time = phastaio_time_diff(&t0,&t1);\
     phastaio_addWriteTime(time);\
     phastaio_addWriteBytes(bytes);\
+    pcu_io_wrote(PCU_IO_PHASTA,(bytes),pcu_t0);\
 }
 
 #define PHASTAIO_OPENTIME(cmd) {\
     phastaioTime t0,t1;\
+    const double pcu_t0 = pcu_io_time();\
     phastaio_time(&t0);\
     cmd\
     phastaio_time(&t1);\
     const size_t time = phastaio_time_diff(&t0,&t1);\
     phastaio_addOpenTime(time);\
+    pcu_io_opened(PCU_IO_PHASTA,pcu_t0);\
 }
 
 #define PHASTAIO_CLOSETIME(cmd) {\
     phastaioTime t0,t1;\
+    const double pcu_t0 = pcu_io_time();\
     phastaio_time(&t0);\
     cmd\
     phastaio_time(&t1);\
     const size_t time = phastaio_time_diff(&t0,&t1);\
     phastaio_addCloseTime(time);\
+    pcu_io_closed(PCU_IO_PHASTA,pcu_t0);\
 }
 
 /* \brief constants to identify the different phasta and chef files */
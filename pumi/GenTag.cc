@@ -12,6 +12,7 @@
 #include <cstdlib>
 #include <pcu_util.h>
 #include <cstring>
+#include <algorithm>
 
 //enum PUMI_TagType {/*0*/ PUMI_DBL, /*1*/ PUMI_INT, /*2*/ PUMI_LONG,
 //              /*3*/ PUMI_ENT,   /*4*/ PUMI_SET,  /*5*/ PUMI_PTR,
@@ -38,10 +39,16 @@ TagHandle::TagHandle(
   tag_type = in_type;
   tag_size = in_size;
   bytes = typeSizes[in_type]*in_size;
+  stride = (in_type == PUMI_STR) ? sizeof(char*) : bytes;
 }
 
 TagHandle::~TagHandle()
 {
+  if (tag_type != PUMI_STR)
+    return;
+  for (size_t i=0; i < present.size(); ++i)
+    if (present[i])
+      free(*static_cast<char**>(getData(i)));
 }
 
 bool TagHandle::operator<(const TagHandle& other) const
@@ -49,144 +56,102 @@ bool TagHandle::operator<(const TagHandle& other) const
   return tag_name < other.tag_name;
 }
 
-Taggable::Taggable()
-{
-  container = 0;
-  size = 0;
-}
-
-Taggable::~Taggable()
-{
-  clearTagData();
-}
-
-typedef Taggable::Entry Entry;
-
-static void removeEntry(Entry*& container, int e, int& size)
+void* TagHandle::addData(int i)
 {
-  Entry* container2 = new Entry[size-1];
-  int i;
-  int j=0;
-  for (i=0; i < e; ++i)
-    container2[j++] = container[i];
-  for (i=e+1; i < size; ++i)
-    container2[j++] = container[i];
-  delete [] container;
-  container = container2;
-  --size;
+  if (i >= (int)present.size())
+  {
+    /* grow geometrically, entities are usually numbered in order */
+    size_t n = std::max((size_t)i + 1, present.size() * 2);
+    present.resize(n, 0);
+    values.resize(n * stride);
+  }
+  present[i] = 1;
+  return getData(i);
 }
 
-static Entry* addEntry(
-    Entry*& container,
-    TagHandle* handle,
-    int& size)
+void TagHandle::deleteData(int i)
 {
-  Entry* container2 = new Entry[size+1];
-  for (int i=0; i < size; ++i)
-    container2[i] = container[i];
-  container2[size].handle = handle;
-  delete [] container;
-  container = container2;
-  Entry* e = container + size;
-  ++size;
-  return e;
+  if (!hasData(i))
+    return;
+  if (tag_type == PUMI_STR)
+    free(*static_cast<char**>(getData(i)));
+  present[i] = 0;
 }
 
-static int findEntry(Entry* container, TagHandle* handle, int size)
+Taggable::Taggable()
 {
-  for (int i=0; i < size; ++i)
-    if (container[i].handle == handle)
-      return i;
-  return -1;
+  index = -1;
 }
 
-static void freeEntry(Entry* e)
+Taggable::~Taggable()
 {
-  TagHandle* handle = e->handle;
-  if ((handle->getBytes() > sizeof(void*))
-    ||(handle->getType() == PUMI_STR))
-    free(e->data);
+  clearTagData();
 }
 
 void Taggable::deleteTagData(TagHandle* tag)
 {
-  int const i = findEntry(container,tag,size);
-  if (i==-1)
+  std::vector<TagHandle*>::iterator it =
+    std::find(tags.begin(), tags.end(), tag);
+  if (it == tags.end())
     return;
-  freeEntry(container+i);
-  removeEntry(container,i,size);
+  tag->deleteData(index);
+  tags.erase(it);
 }
 
 void Taggable::clearTagData()
 {
-  for (int i=0; i < size; ++i)
-    freeEntry(container+i);
-  delete [] container;
+  for (size_t i=0; i < tags.size(); ++i)
+    tags[i]->deleteData(index);
+  tags.clear();
 }
 
 bool Taggable::hasTagData(TagHandle* tag)
 {
-  return findEntry(container,tag,size) != -1;
+  return index != -1 && tag->hasData(index);
 }
 
 bool Taggable::getTagData(TagHandle* tag, void* data)
 {
-  int const i = findEntry(container,tag,size);
-  if (i==-1)
+  if (!hasTagData(tag))
     return false;
-  Entry* e = container + i;
-  size_t const bytes = e->handle->getBytes();
-  if (bytes > sizeof(void*))
-    memcpy(data,e->data,bytes);
-  else
-    memcpy(data,&(e->data),bytes);
+  memcpy(data,tag->getData(index),tag->getBytes());
   return true;
 }
 
+/* the slot of (tag) on this entity, added if it had no value */
+static void* getSlot(Taggable* obj, TagHandle* tag)
+{
+  int const index = obj->getTagIndex();
+  PCU_ALWAYS_ASSERT(index != -1);
+  if (tag->hasData(index))
+    return tag->getData(index);
+  obj->tags.push_back(tag);
+  return tag->addData(index);
+}
+
 void Taggable::setTagData(TagHandle* tag, void const* data)
 {
-  int i = findEntry(container,tag,size);
-  size_t const bytes = tag->getBytes();
-  Entry* e;
-  if (i==-1)
-  {
-    e = addEntry(container,tag,size);
-    if (bytes > sizeof(void*))
-      e->data = malloc(bytes);
-  }
-  else
-    e = container + i;
-  if (bytes > sizeof(void*))
-    memcpy(e->data,data,bytes);
-  else
-    memcpy(&(e->data),data,bytes);
+  memcpy(getSlot(this,tag),data,tag->getBytes());
 }
 
 const char* Taggable::getTagString(TagHandle* tag)
 {
   PCU_ALWAYS_ASSERT(tag->getType()==PUMI_STR);
-  int const i = findEntry(container,tag,size);
-  if (i==-1)
+  if (!hasTagData(tag))
     return 0;
-  return static_cast<const char*>(container[i].data);
+  return *static_cast<char**>(tag->getData(index));
 }
 
 void Taggable::setTagString(TagHandle* tag, const char* data)
 {
   PCU_ALWAYS_ASSERT(tag->getType()==PUMI_STR);
-  int i = findEntry(container,tag,size);
+  bool had = hasTagData(tag);
+  char** slot = static_cast<char**>(getSlot(this,tag));
+  if (had)
+    free(*slot);
   size_t const bytes = strlen(data)+1;
-  Entry* e;
-  if (i==-1)
-  {
-    e = addEntry(container,tag,size);
-    e->data = 0;
-  }
-  else
-    e = container + i;
-  free(e->data);
-  e->data = malloc(bytes);
-  memcpy(e->data,data,bytes);
+  *slot = static_cast<char*>(malloc(bytes));
+  memcpy(*slot,data,bytes);
 }
 
 int Tag_GetType(pTag tag)
@@ -287,7 +252,7 @@ bool Taggable_HasTag (pTaggable obj, pTag tag)
 {
   /* this behavior is absolutely ridiculous, but we will
      keep it around for compatibility.... */
-  if ( ! tag) return (obj->size != 0);
+  if ( ! tag) return !obj->tags.empty();
   return obj->hasTagData(tag);
 }
 
@@ -298,7 +263,5 @@ void Taggable_DelTag (pTaggable obj, pTag tag)
 
 void Taggable_GetTag (pTaggable obj, std::vector<pTag>& tags)
 {
-  tags.resize(obj->size);
-  for (int i=0; i < obj->size; ++i)
-    tags[i] = obj->container[i].handle;
+  tags = obj->tags;
 }
@@ -32,11 +32,23 @@ class TagHandle
     size_t getBytes() {return bytes;}
     bool operator<(const TagHandle& other) const;
     static size_t const typeSizes[PUMI_TAGTYPES];
+    /* the values of all entities are kept here, by Taggable index,
+       rather than on each entity. strings keep a pointer per entity */
+    bool hasData(int i) const
+    {
+      return i < (int)present.size() && present[i];
+    }
+    void* getData(int i) {return &values[(size_t)i * stride];}
+    void* addData(int i);
+    void deleteData(int i);
   protected:
     std::string tag_name;
     int tag_type;
     int tag_size;
     size_t bytes;
+    size_t stride;
+    std::vector<char> values;
+    std::vector<char> present;
 };
 
 //******************************
@@ -52,16 +64,14 @@ class Taggable
 //******************************
 {
   public:
-    struct Entry
-    {
-      TagHandle* handle;
-      void* data;
-    };
-    Entry* container;
-    int size;
-
     Taggable();
     ~Taggable();
+    /* the position of this entity's values in each tag,
+       see mPartEntityContainer::add */
+    int getTagIndex() {return index;}
+    void setTagIndex(int i) {index = i;}
+    /* the tags this entity has values of */
+    std::vector<TagHandle*> tags;
 
     void deleteTagData(TagHandle* tag);
     void clearTagData();
@@ -70,6 +80,8 @@ class Taggable
     void setTagData(TagHandle* tag, void const* data);
     const char* getTagString(TagHandle* tag);
     void setTagString(TagHandle* tag, const char* data);
+  private:
+    int index;
 };
 
 // ***************************************************
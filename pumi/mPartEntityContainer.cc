@@ -9,9 +9,13 @@
 *******************************************************************************/
 #include "mPartEntityContainer.h"
 #include <pcu_util.h>
+#include <stdint.h>
 
 mPartEntityContainer::mPartEntityContainer()
 {
+  for (int d=0; d < _DIMS_; ++d)
+    count[d] = 0;
+  nextIndex = 0;
 }
 
 mPartEntityContainer::~mPartEntityContainer()
@@ -32,21 +36,62 @@ mPartEntityContainer::iter mPartEntityContainer::end(int what)
   return gEntities[what].end<gEntity>();
 }
 
+static size_t hashSlot(gmi_ent* e, size_t capacity)
+{
+  /* some models use small integers as entity pointers */
+  uint64_t k = (uint64_t)(uintptr_t)e * 0x9E3779B97F4A7C15ull;
+  return (size_t)(k >> 32) & (capacity - 1);
+}
+
+static gEntity** findSlot(std::vector<gEntity*>& slots, gmi_ent* e)
+{
+  size_t const capacity = slots.size();
+  size_t i = hashSlot(e, capacity);
+  while (slots[i] && slots[i]->getGmi() != e)
+    i = (i + 1) & (capacity - 1);
+  return &slots[i];
+}
+
+static void rehash(std::vector<gEntity*>& slots, size_t capacity)
+{
+  std::vector<gEntity*> old(capacity, (gEntity*)0);
+  old.swap(slots);
+  for (size_t i=0; i < old.size(); ++i)
+    if (old[i])
+      *findSlot(slots, old[i]->getGmi()) = old[i];
+}
+
 void mPartEntityContainer::add(int d, gEntity* e)
 { 
   gEntities[d].push_back(e);
-  gEntities_map[d].insert(std::map<gmi_ent*, gEntity*>::value_type(e->getGmi(), e));
+  e->setTagIndex(nextIndex++);
+  if (2 * (count[d] + 1) > (int)slots[d].size())
+    rehash(slots[d], slots[d].empty() ? 64 : 2 * slots[d].size());
+  gEntity** slot = findSlot(slots[d], e->getGmi());
+  if (!*slot)
+    ++count[d];
+  *slot = e;
 }
 
 void mPartEntityContainer::del(int d, gEntity* e)
 { 
   gEntities[d].remove(e);
-  gEntities_map[d].erase(std::map<gmi_ent*, gEntity*>::key_type(e->getGmi()));
+  if (slots[d].empty())
+    return;
+  gEntity** slot = findSlot(slots[d], e->getGmi());
+  if (!*slot)
+    return;
+  *slot = 0;
+  --count[d];
+  /* reinsert the rest of the run so that lookups still find it */
+  rehash(slots[d], slots[d].size());
 }
 
 gEntity* mPartEntityContainer::getGeomEnt(int d, gmi_ent* e)
 {
-  return gEntities_map[d][e];
+  if (slots[d].empty())
+    return 0;
+  return *findSlot(slots[d], e);
 }
 
 
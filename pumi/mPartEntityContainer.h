@@ -13,7 +13,7 @@
 #include "GenTag.h"
 #include "pumi_list.h"
 #include "gmi.h"
-#include <map>
+#include <vector>
 class gEntity : public Taggable, public ListMember
 {
 public:
@@ -32,7 +32,11 @@ class mPartEntityContainer
   private:
     enum { _DIMS_ = 4 };
     List gEntities[_DIMS_];
-    std::map<gmi_ent*, gEntity*> gEntities_map[_DIMS_]; // gmi_ent to gEntity
+    /* gmi_ent to gEntity, open addressing by gmi_ent pointer */
+    std::vector<gEntity*> slots[_DIMS_];
+    int count[_DIMS_];
+    /* the next Taggable index, shared by all dimensions */
+    int nextIndex;
   public:
     mPartEntityContainer();
     virtual ~mPartEntityContainer();
@@ -79,6 +79,10 @@ typedef apf::Adjacent Adjacent; // adjacency container
 typedef apf::Sharing Ownership;
 typedef apf::Sharing* pOwnership;
 typedef apf::CopyArray CopyArray; // array type for remote copies
+class mFieldView;
+typedef mFieldView* pFieldView; // contiguous owned values of a field
+class mGhostPlan;
+typedef mGhostPlan* pGhostPlan; // ghost copy updates of fields
 
 // singleton to save model/mesh
 class pumi
@@ -97,6 +101,11 @@ public:
   pMeshTag ghost_tag;
   std::vector<pMeshEnt> ghost_vec[4];
   std::vector<pMeshEnt> ghosted_vec[4];
+  // owners under one ownership rule, see pumi_ownership_freeze
+  pMesh owner_mesh;
+  pOwnership owner_rule;
+  pMeshTag owner_tag;
+  unsigned long owner_changes;
 private:
   static pumi* _instance;
 };
@@ -339,8 +348,35 @@ void pumi_ghost_createLayer (pMesh m, int brgType, int ghostType, int numLayer,
 // Ghosting: ghosting plan object for local elements or part to destinations. 
 void pumi_ghost_create(pMesh m, Ghosting* plan);
 
+/* 
+replace the ghost copies with those the plan asks for, only destroying the
+ghost copies the plan no longer asks for and sending the missing ones.
+Ghost copies already in place are kept along with their data, so this is
+cheaper than pumi_ghost_delete followed by pumi_ghost_create when the ghost
+layer changes little. The plan is deleted.
+*/
+void pumi_ghost_update(pMesh m, Ghosting* plan);
+
+// pumi_ghost_update with the plan pumi_ghost_createLayer would compute
+void pumi_ghost_updateLayer (pMesh m, int brgType, int ghostType, int numLayer, int includeCopy);
+
 void pumi_ghost_delete (pMesh m);
 
+/*
+persistent plan updating the ghost copies of fields from their owners,
+built once from the ghosting maps so that each pumi_ghost_synchronize is
+one neighbor exchange carrying the values of all the fields, with no
+per-entity messages. Meant for element fields (constant or integration
+point shapes) updated every stage of an explicit solver; fields with
+nodes on part boundaries should be synchronized on those first.
+The plan is invalid once the ghost layer, the mesh, or the set of
+entities with values of the fields changes, so set the fields before
+making it. Running it replaces the PCU neighbor set.
+*/
+pGhostPlan pumi_ghost_createFieldPlan(pMesh m, std::vector<pField> const& fields);
+void pumi_ghost_synchronize(pGhostPlan p);
+void pumi_ghostPlan_delete(pGhostPlan p);
+
 //************************************
 // MISCELLANEOUS
 //************************************
@@ -352,6 +388,12 @@ void pumi_mesh_deleteGlobalID(pMesh m);
 void pumi_mesh_verify(pMesh m, bool abort_on_error=true);
 // verify user-defined ownership and mesh counter
 void pumi_ownership_verify(pMesh m, pOwnership o);
+// evaluate the ownership rule once for every entity, so that pumi_ment_getOwnPID,
+// pumi_ment_getOwnEnt and pumi_ment_isOwned with o read the owner instead.
+// the owners are ignored once the mesh changes and dropped by pumi_ownership_unfreeze
+// or pumi_mesh_delete
+void pumi_ownership_freeze(pMesh m, pOwnership o);
+void pumi_ownership_unfreeze(pMesh m);
 // print mesh size info - global and local
 void pumi_mesh_print(pMesh m, bool print_ent=false);
 
@@ -380,6 +422,12 @@ void pumi_ment_get2ndAdj (pMeshEnt e, int brgType, int tgtType, std::vector<pMes
 int pumi_ment_getAdjacent(pMeshEnt e, int tgtType, Adjacent& result);
 int pumi_ment_get2ndAdjacent(pMeshEnt e, int brgType, int tgtType, Adjacent& result);
 
+// get adjacent entities of all entities of dimension dim at once, in compressed rows:
+// the targets of the i-th entity of m->begin(dim) are targets[offsets[i]..offsets[i+1]-1],
+// given by pumi_ment_getID. upward rows read the snapshot of apf::freezeMdsAdjacency, if any
+void pumi_mesh_getAdj(pMesh m, int dim, int tgtType, std::vector<int>& offsets, std::vector<int>& targets);
+void pumi_mesh_get2ndAdj(pMesh m, int dim, int brgType, int tgtType, std::vector<int>& offsets, std::vector<int>& targets);
+
 // return entity's geometric classification
 pGeomEnt pumi_ment_getGeomClas(pMeshEnt e);
 
@@ -516,6 +564,18 @@ void pumi_field_copy(pField f, pField r);
 void pumi_field_add(pField f1, pField f2, pField r);
 void pumi_field_multiply(pField f, double d, pField r);
 
+// contiguous view of the values of a field on owned nodes, in the order
+// pumi_numbering_createOwn numbers the nodes, node components together.
+// the view keeps a communication plan, valid until the mesh or ownership changes
+pFieldView pumi_field_createView(pField f, pOwnership o=NULL);
+void pumi_fieldView_delete(pFieldView v);
+double* pumi_fieldView_getData(pFieldView v);
+int pumi_fieldView_getSize(pFieldView v); // number of values, not nodes
+// copy the view's values to the owned nodes and on to their copies
+void pumi_field_synchronize(pFieldView v);
+// sum the values of all copies onto the owned nodes and copy them into the view
+void pumi_field_accumulate(pFieldView v);
+
 // verify field
 void pumi_field_verify(pMesh m, pField f=NULL, pOwnership o=NULL);
 void pumi_field_print(pField f);
@@ -15,6 +15,7 @@
 #include <pcu_util.h>
 #include <PCU.h>
 #include <cstdlib> // for malloc and free
+#include <vector>
 
 //************************************
 // Field shape and nodes
@@ -138,6 +139,94 @@ void pumi_field_accumulate(pField f, pOwnership o)
   apf::accumulateFieldData(f->getData(), o, false);
 }
 
+class mFieldView
+{
+public:
+  pField field;
+  int components;
+  std::vector<pMeshEnt> entities; // one per owned node
+  std::vector<int> nodes;
+  std::vector<double> values;
+  apf::SyncPlan* plan;
+};
+
+/* node values go between the field and the view */
+static void readView(pFieldView v)
+{
+  for (size_t i=0; i<v->entities.size(); ++i)
+    apf::getComponents(v->field, v->entities[i], v->nodes[i], &v->values[i*v->components]);
+}
+
+static void writeView(pFieldView v)
+{
+  for (size_t i=0; i<v->entities.size(); ++i)
+    apf::setComponents(v->field, v->entities[i], v->nodes[i], &v->values[i*v->components]);
+}
+
+pFieldView pumi_field_createView(pField f, pOwnership o)
+{
+  pMesh m = static_cast<pMesh>(apf::getMesh(f));
+  pShape s = apf::getShape(f);
+  pOwnership shr = o ? o : apf::getSharing(m);
+  pFieldView v = new mFieldView();
+  v->field = f;
+  v->components = apf::countComponents(f);
+  // the walk of apf::numberOwnedNodes
+  for (int d=0; d<4; ++d)
+  {
+    if (!s->hasNodesIn(d))
+      continue;
+    pMeshIter it = m->begin(d);
+    pMeshEnt e;
+    while ((e = m->iterate(it)))
+    {
+      if (!shr->isOwned(e))
+        continue;
+      int nnodes = s->countNodesOn(m->getType(e));
+      for (int node=0; node<nnodes; ++node)
+      {
+        v->entities.push_back(e);
+        v->nodes.push_back(node);
+      }
+    }
+    m->end(it);
+  }
+  v->values.resize(v->entities.size()*v->components);
+  v->plan = apf::makeSyncPlan(f, o);
+  if (!o)
+    delete shr;
+  readView(v);
+  return v;
+}
+
+void pumi_fieldView_delete(pFieldView v)
+{
+  apf::destroySyncPlan(v->plan);
+  delete v;
+}
+
+double* pumi_fieldView_getData(pFieldView v)
+{
+  return v->values.empty() ? NULL : &v->values[0];
+}
+
+int pumi_fieldView_getSize(pFieldView v)
+{
+  return v->values.size();
+}
+
+void pumi_field_synchronize(pFieldView v)
+{
+  writeView(v);
+  apf::synchronize(v->plan);
+}
+
+void pumi_field_accumulate(pFieldView v)
+{
+  apf::accumulate(v->plan);
+  readView(v);
+}
+
 void pumi_field_freeze(pField f)
 {  
   if (!isFrozen(f))
@@ -41,11 +41,7 @@ void pumi_gent_getRevClas (pGeomEnt ge, std::vector<pMeshEnt>& ents)
   PCU_ALWAYS_ASSERT(!ents.size());
   int dim=gmi_dim(pumi::instance()->model->getGmi(), ge->getGmi());
   pMesh m = pumi::instance()->mesh;
-  pMeshEnt e;
-  apf::MeshIterator* ent_it = m->begin(dim);
-  while ((e = m->iterate(ent_it)))
-    if (((gmi_ent*)m->toModel(e))==ge->getGmi())  ents.push_back(e);
-  m->end(ent_it);
+  m->getClassified((apf::ModelEntity*)ge->getGmi(), dim, ents);
 }
 
 void get_one_level_adj (pGeom g, std::set<pGeomEnt>& ents, 
@@ -45,7 +45,7 @@ pGeom pumi_geom_load(const char* filename, const char* model_type, void (*geom_l
   else if (!strcmp(model_type,"mesh"))
   {
     gmi_register_mesh();
-    pumi::instance()->model = new gModel(gmi_load(filename));
+    pumi::instance()->model = new gModel(gmi_load_bcast(filename));
     pumi_geom_freeze(pumi::instance()->model);
   }
   else if (!strcmp(model_type,"analytic")) 
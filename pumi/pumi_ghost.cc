@@ -149,6 +149,11 @@ static pMeshEnt unpackGhost(Ghosting* plan, apf::DynamicArray<pMeshTag>& tags)
   residence.insert(from);
   plan->getMesh()->setResidence(entity,residence);
   apf::unpackTags(plan->getMesh(),entity,tags);
+  /* a sender ghosted before passes its ghosted_tag along,
+     but the new ghost copy is not ghosted itself */
+  pMeshTag ghosted_tag = pumi::instance()->ghosted_tag;
+  if (plan->getMesh()->hasTag(entity, ghosted_tag))
+    plan->getMesh()->removeTag(entity, ghosted_tag);
   apf::unpackRemotes(plan->getMesh(),entity);
 
   /* store the sender as a ghost copy */
@@ -389,6 +394,36 @@ void ghost_sendEntities(Ghosting* plan, int entDim,
 
 #include "apfNumbering.h"
 #include "apfShape.h"
+// *********************************************************
+static void ghost_exchange(Ghosting* plan, EntityVector entities_to_ghost[4])
+// *********************************************************
+{
+  apf::DynamicArray<pMeshTag> tags;
+  plan->getMesh()->getTags(tags);
+  for (int dimension = 0; dimension <= plan->ghost_dim; ++dimension)
+  {
+    PCU_Comm_Begin();
+    ghost_sendEntities(plan, dimension, entities_to_ghost[dimension], tags);
+    PCU_Comm_Send();
+    EntityVector received;
+    ghost_receiveEntities(plan,tags,received);
+    setupGhosts(plan->getMesh(),received);
+  }
+}
+
+// *********************************************************
+static void ghost_refreeze(pMesh m, std::vector<apf::Field*>& frozen_fields)
+// *********************************************************
+{
+  // frozen (array-based) field relies on local numbering of default field shape for accessing DOF
+  // if no default local numbering is found for default field shape, 
+  // apf::freeze creates a new local numbering. 
+  // local numbering has to be deleted after mesh modification and before freezing the field
+  while (m->countNumberings()) destroyNumbering(m->getNumbering(0));
+  for (std::vector<apf::Field*>::iterator fit=frozen_fields.begin(); fit!=frozen_fields.end(); ++fit)
+    apf::freeze(*fit);    
+}
+
 // *********************************************************
 void pumi_ghost_create(pMesh m, Ghosting* plan)
 // *********************************************************
@@ -411,54 +446,158 @@ void pumi_ghost_create(pMesh m, Ghosting* plan)
 
   EntityVector entities_to_ghost[4];
   ghost_collectEntities(m, plan, entities_to_ghost);
+  ghost_exchange(plan, entities_to_ghost);
+  
+  delete plan;
+  m->acceptChanges();
+  ghost_refreeze(m, frozen_fields);
 
-  apf::DynamicArray<pMeshTag> tags;
-  plan->getMesh()->getTags(tags);
-  for (int dimension = 0; dimension <= plan->ghost_dim; ++dimension)
+  if (!PCU_Comm_Self())
+    printf("mesh ghosted in %f seconds\n", PCU_Time()-t0);
+}
+
+// *********************************************************
+static void ghost_destroyStale(pMesh m, Ghosting* plan)
+// *********************************************************
+{
+  /* every copy of a ghosted entity holds the same target parts
+     after ghost_collectEntities, so each drops the ghost copies
+     outside them on its own, and the owner tells the ghosts */
+  int self = pumi_rank();
+  pMeshTag ghosted_tag = pumi::instance()->ghosted_tag;
+  std::vector<pMeshEnt> stale[4];
+  PCU_Comm_Begin();
+  for (int d=0; d<4; ++d)
   {
-    PCU_Comm_Begin();
-    ghost_sendEntities(plan, dimension, entities_to_ghost[dimension], tags);
-    PCU_Comm_Send();
-    EntityVector received;
-    ghost_receiveEntities(plan,tags,received);
-    setupGhosts(plan->getMesh(),received);
+    std::vector<pMeshEnt>& ghosted = pumi::instance()->ghosted_vec[d];
+    std::vector<pMeshEnt> kept_ghosted;
+    for (std::vector<pMeshEnt>::iterator it=ghosted.begin(); it!=ghosted.end(); ++it)
+    {
+      pMeshEnt e = *it;
+      apf::Copies ghosts;
+      m->getGhosts(e, ghosts);
+      apf::Copies kept;
+      APF_ITERATE(apf::Copies, ghosts, git)
+      {
+        if (plan->has(e) && plan->sending(e, d).count(git->first))
+          kept.insert(*git);
+        else if (m->getOwner(e)==self)
+          PCU_COMM_PACK(git->first, git->second);
+      }
+      if (kept.size()==ghosts.size())
+      {
+        kept_ghosted.push_back(e);
+        continue;
+      }
+      m->deleteGhost(e);
+      APF_ITERATE(apf::Copies, kept, kit)
+        m->addGhost(e, kit->first, kit->second);
+      if (kept.empty())
+        m->removeTag(e, ghosted_tag);
+      else
+        kept_ghosted.push_back(e);
+    }
+    ghosted.swap(kept_ghosted);
   }
-  
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive())
+  {
+    pMeshEnt g;
+    PCU_COMM_UNPACK(g);
+    stale[getDimension(m, g)].push_back(g);
+  }
+  /* no ghost kept here bounds a stale one,
+     since the target parts cover the closures */
+  pMeshTag tag = m->createIntTag("ghost_stale_mark",1);
+  int dummy=1;
+  for (int d=3; d>=0; --d)
+  {
+    for (std::vector<pMeshEnt>::iterator it=stale[d].begin(); it!=stale[d].end(); ++it)
+      m->setIntTag(*it, tag, &dummy);
+    std::vector<pMeshEnt>& ghost = pumi::instance()->ghost_vec[d];
+    std::vector<pMeshEnt> kept;
+    for (std::vector<pMeshEnt>::iterator it=ghost.begin(); it!=ghost.end(); ++it)
+      if (!m->hasTag(*it, tag))
+        kept.push_back(*it);
+    ghost.swap(kept);
+    for (std::vector<pMeshEnt>::iterator it=stale[d].begin(); it!=stale[d].end(); ++it)
+      m->destroy(*it);
+  }
+  m->destroyTag(tag);
+}
+
+// *********************************************************
+void pumi_ghost_update(pMesh m, Ghosting* plan)
+// *********************************************************
+{
+  if (PCU_Comm_Peers()==1)
+  {
+    delete plan;
+    return;
+  }
+
+  std::vector<apf::Field*> frozen_fields;
+  for (int i=0; i<m->countFields(); ++i)
+  {
+    pField f = m->getField(i);
+    if (isFrozen(f))
+    {
+      frozen_fields.push_back(f); // turn field data from tag to array
+      apf::unfreeze(f);
+    }
+  }
+
+  double t0=PCU_Time();
+
+  EntityVector entities_to_ghost[4];
+  ghost_collectEntities(m, plan, entities_to_ghost);
+  ghost_destroyStale(m, plan);
+  /* ghost_sendEntities skips the ghost copies that remain */
+  ghost_exchange(plan, entities_to_ghost);
+
   delete plan;
   m->acceptChanges();
-  
-  // frozen (array-based) field relies on local numbering of default field shape for accessing DOF
-  // if no default local numbering is found for default field shape, 
-  // apf::freeze creates a new local numbering. 
-  // local numbering has to be deleted after mesh modification and before freezing the field
-  while (m->countNumberings()) destroyNumbering(m->getNumbering(0));
-  for (std::vector<apf::Field*>::iterator fit=frozen_fields.begin(); fit!=frozen_fields.end(); ++fit)
-    apf::freeze(*fit);    
+  ghost_refreeze(m, frozen_fields);
 
   if (!PCU_Comm_Self())
-    printf("mesh ghosted in %f seconds\n", PCU_Time()-t0);
+    printf("ghosts updated in %f seconds\n", PCU_Time()-t0);
 }
 
 // *********************************************************
-void do_off_part_bridge(pMesh m, int brg_dim, int ghost_dim, int num_layer, 
-                        std::set<pMeshEnt>** off_bridge_set, Ghosting* plan)
+static void ghost_setNeighbors(pMesh m, int brg_dim)
+// *********************************************************
+{
+  // off-part bridges only go to the remote copies of bridges
+  std::set<int> peers;
+  pMeshEnt e;
+  apf::MeshIterator* it = m->begin(brg_dim);
+  while ((e = m->iterate(it)))
+  {
+    if (m->isGhost(e) || !m->isShared(e)) continue;
+    apf::Copies remotes;
+    m->getRemotes(e,remotes);
+    APF_ITERATE(apf::Copies,remotes,rit)
+      peers.insert(rit->first);
+  }
+  m->end(it);
+  std::vector<int> neighbors(peers.begin(), peers.end());
+  PCU_Comm_Neighbors(neighbors.empty() ? 0 : &(neighbors[0]), neighbors.size());
+}
+
+// *********************************************************
+static void ghost_sendOffBridges(pMesh m, int num_layer, std::set<pMeshEnt>** off_bridge_set)
 // *********************************************************
 {
-  std::map<pMeshEnt, set<int> > off_bridge_marker;
-  pMeshEnt ghost_ent;
   pMeshEnt brg_ent;
   void* msg_send;
   pMeshEnt* s_ent;
   size_t msg_size;
-  int dummy=1;
-  PCU_Comm_Begin();
-
-  for (int layer=2; layer<num_layer+1; ++layer)
+  for (int layer=0; layer<num_layer+1; ++layer)
   {
     for (int pid=0; pid<pumi_size(); ++pid)
     {
       for (std::set<pMeshEnt>::iterator off_it=off_bridge_set[layer][pid].begin(); 
-            off_it!=off_bridge_set[layer][pid].end(); ++off_it)
+          off_it!=off_bridge_set[layer][pid].end(); ++off_it)
       {
         brg_ent = *off_it;
         apf::Copies brg_remotes;
@@ -470,243 +609,144 @@ void do_off_part_bridge(pMesh m, int brg_dim, int ghost_dim, int num_layer,
           msg_send = malloc(msg_size);
           s_ent = (pMeshEnt*)msg_send; 
           *s_ent = brg_rit->second; 
-          int *s_int = (int*)((char*)msg_send + sizeof(pMeshEnt));
-          s_int[0]=layer;
-          s_int[1]=pid;
+          int *p_int = (int*)((char*)msg_send + sizeof(pMeshEnt));
+          p_int[0]=layer;
+          p_int[1]=pid;
           PCU_Comm_Write(brg_rit->first, (void*)msg_send, msg_size);
           free(msg_send);    
         }  // APF_ITERATE
-      } // for (std::map<pMeshEnt, set<int> >::iterator iter     
+      } // for off_it     
     }
   }
   // clean up
   for (int i=0; i<num_layer+1;++i)
     for (int j=0; j<pumi_size();++j)
       off_bridge_set[i][j].clear();
+}
 
-  PCU_Comm_Send();
-  // receive phase
-  void *msg_recv;
-  int pid_from;
-  int* r_int;
-  pMeshEnt r;
-  int r_layer, r_pid;
+// *********************************************************
+static void ghost_receiveOffBridge(pMesh m, int brg_dim, int ghost_dim, int num_layer,
+                                   std::set<pMeshEnt>** off_bridge_set, Ghosting* plan,
+                                   std::map<pMeshEnt, set<int> >& off_bridge_marker,
+                                   pMeshEnt r, int r_layer, int r_pid)
+// *********************************************************
+{
+  pMeshEnt ghost_ent;
+  int dummy=1;
   pMeshTag tag = m->findTag("ghost_check_mark");
   std::vector<pMeshEnt> processed_ent;
   std::vector<pMeshEnt> adj_ent;
 
-  while(PCU_Comm_Read(&pid_from, &msg_recv, &msg_size))
+  off_bridge_marker[r].insert(r_pid);
+
+  apf::Adjacent ghost_cands;
+  m->getAdjacent(r,ghost_dim, ghost_cands);   
+  APF_ITERATE(apf::Adjacent, ghost_cands, adj_ent_it)
   {
-    processed_ent.clear();
+    ghost_ent = *adj_ent_it;
+    if (m->isGhost(ghost_ent)) continue; // skip ghost copy
+    plan->send(ghost_ent, r_pid);
+
+    m->setIntTag(ghost_ent,tag,&dummy);
+    processed_ent.push_back(ghost_ent);
 
-    r = *((pMeshEnt*)msg_recv); 
-    r_int = (int*)((char*)msg_recv+sizeof(pMeshEnt)); 
-    r_layer=r_int[0];
-    r_pid=r_int[1];
-    off_bridge_marker[r].insert(r_pid);
-    apf::Adjacent ghost_cands;
-    m->getAdjacent(r,ghost_dim, ghost_cands);   
-    APF_ITERATE(apf::Adjacent, ghost_cands, adj_ent_it)
+    if (r_layer<num_layer)
     {
-      ghost_ent = *adj_ent_it;
-      if (m->isGhost(ghost_ent)) continue; // skip ghost copy
-      plan->send(ghost_ent, r_pid);
+      apf::Downward adjacent;
+      int num_brg=m->getDownward(ghost_ent,brg_dim, adjacent);
+      for (int b=0; b<num_brg; ++b)
+      {     
+        if (m->isShared(adjacent[b]) && adjacent[b]!=r && !pumi_ment_isOn(adjacent[b], r_pid))
+        {
+          // a bridge received for r_pid already reached all its copies
+          if (off_bridge_marker[adjacent[b]].find(r_pid)==off_bridge_marker[adjacent[b]].end())
+            off_bridge_set[r_layer+1][r_pid].insert(adjacent[b]);
+        }
+      }
+    } // if (layer+1<=num_layer)
+  } // APF_ITERATE
 
-      m->setIntTag(ghost_ent,tag,&dummy);
-      processed_ent.push_back(ghost_ent);
-    
-      if (r_layer<num_layer)
+  int start_prev_layer=0, size_prev_layer=processed_ent.size(), num_prev_layer;
+  for (int layer=r_layer+1; layer<num_layer+1; ++layer)
+  {  
+    num_prev_layer=0;
+    for (int i=start_prev_layer; i<size_prev_layer; ++i)
+    {
+      ghost_ent = processed_ent.at(i);
+      adj_ent.clear();
+      pumi_ment_get2ndAdj (ghost_ent, brg_dim, ghost_dim, adj_ent);
+
+      for (std::vector<pMeshEnt>::iterator git=adj_ent.begin(); git!=adj_ent.end(); ++git)
+      {
+        if (m->isGhost(*git) || m->hasTag(*git,tag))
+          continue; // skip ghost copy or already-processed copy
+      
+        plan->send(*git, r_pid);
+ 
+        m->setIntTag(*git,tag,&dummy);
+        processed_ent.push_back(*git);
+        ++num_prev_layer;
+      } // for (std::vector<pMeshEnt>::iterator git=adj_ent.begin()
+
+      // collect off-part adjacent bridges
+      if (layer<num_layer)
       {
         apf::Downward adjacent;
         int num_brg=m->getDownward(ghost_ent,brg_dim, adjacent);
         for (int b=0; b<num_brg; ++b)
         {     
           if (m->isShared(adjacent[b]) && adjacent[b]!=r && !pumi_ment_isOn(adjacent[b], r_pid))
-            off_bridge_set[r_layer+1][r_pid].insert(adjacent[b]);
-        }
-      } // if (r_layer<num_layer)
-    } // APF_ITERATE
-
-    int start_prev_layer=0, size_prev_layer=processed_ent.size(), num_prev_layer;
-    for (int layer=r_layer+1; layer<num_layer+1; ++layer)
-    {  
-      num_prev_layer=0;
-      for (int i=start_prev_layer; i<size_prev_layer; ++i)
-      {
-        ghost_ent = processed_ent.at(i);
-        adj_ent.clear();
-        pumi_ment_get2ndAdj (ghost_ent, brg_dim, ghost_dim, adj_ent);
-
-        for (std::vector<pMeshEnt>::iterator git=adj_ent.begin(); git!=adj_ent.end(); ++git)
-        {
-          if (m->isGhost(*git) || m->hasTag(*git,tag))
-            continue; // skip ghost copy or already-processed copy
-      
-          plan->send(*git, r_pid);
-
-          m->setIntTag(*git,tag,&dummy);
-          processed_ent.push_back(*git);
-          ++num_prev_layer;
-        } // for (std::vector<pMeshEnt>::iterator git=adj_ent.begin()
-
-        // collect off-part adjacent bridges
-        if (layer<num_layer)
-        {
-          apf::Downward adjacent;
-          int num_brg=m->getDownward(ghost_ent,brg_dim, adjacent);
-          for (int b=0; b<num_brg; ++b)
-          {     
-            if (m->isShared(adjacent[b]) && adjacent[b]!=r && !pumi_ment_isOn(adjacent[b], r_pid))
-              off_bridge_set[layer+1][r_pid].insert(adjacent[b]);
-          } // for int b=0
-        } // if (layer<=num_layer)
-      } // for int i=start_prev_layer
-      start_prev_layer+=size_prev_layer;
-      size_prev_layer+=num_prev_layer;
-    } // for layer
-    for (std::vector<pMeshEnt>::iterator git=processed_ent.begin(); git!=processed_ent.end(); ++git)
-      m->removeTag(*git,tag);
-  } // while r
-
-  if (num_layer==2) return;
-
-  // the below runs only if num_layer>2
-  int global_num_off_part, local_num_off_part=0;
-  for (int i=0; i<num_layer+1;++i)
-    for (int j=0; j<pumi_size();++j)
-      local_num_off_part+=off_bridge_set[i][j].size();
-  MPI_Allreduce(&local_num_off_part, &global_num_off_part, 1,MPI_INT,MPI_SUM,PCU_Get_Comm());
+            off_bridge_set[layer+1][r_pid].insert(adjacent[b]);
+        } // for int b=0
+      } // if (layer<=num_layer)
+    } // for int i=start_prev_layer
+    start_prev_layer+=size_prev_layer;
+    size_prev_layer+=num_prev_layer;
+  } // for layer
+  for (std::vector<pMeshEnt>::iterator git=processed_ent.begin(); git!=processed_ent.end(); ++git)
+    m->removeTag(*git,tag);
+}
 
-  while (global_num_off_part)
+// *********************************************************
+void do_off_part_bridge(pMesh m, int brg_dim, int ghost_dim, int num_layer, 
+                        std::set<pMeshEnt>** off_bridge_set, Ghosting* plan)
+// *********************************************************
+{
+  /* the bridges sent in round k are of layer k+1 or more, and
+     receiving one only adds bridges of higher layers, so
+     num_layer-1 rounds among the parts sharing bridges complete
+     the plan without any global termination check */
+  std::map<pMeshEnt, set<int> > off_bridge_marker;
+  ghost_setNeighbors(m, brg_dim);
+  for (int round=1; round<num_layer; ++round)
   {
-    PCU_Comm_Begin();
-
-    for (int layer=0; layer<num_layer+1; ++layer)
-    {
-      for (int pid=0; pid<pumi_size(); ++pid)
-      {
-        for (std::set<pMeshEnt>::iterator off_it=off_bridge_set[layer][pid].begin(); 
-            off_it!=off_bridge_set[layer][pid].end(); ++off_it)
-        {
-          brg_ent = *off_it;
-          apf::Copies brg_remotes;
-          m->getRemotes(brg_ent,brg_remotes);
-          APF_ITERATE(apf::Copies,brg_remotes,brg_rit)
-          {
-            if (brg_rit->first==pid) continue;
-            msg_size=sizeof(pMeshEnt) +2*sizeof(int);
-            msg_send = malloc(msg_size);
-            s_ent = (pMeshEnt*)msg_send; 
-            *s_ent = brg_rit->second; 
-            int *p_int = (int*)((char*)msg_send + sizeof(pMeshEnt));
-            p_int[0]=layer;
-            p_int[1]=pid;
-            PCU_Comm_Write(brg_rit->first, (void*)msg_send, msg_size);
-            free(msg_send);    
-          }  // APF_ITERATE
-        } // for off_it     
-      }
-    }
-    // clean up
-    for (int i=0; i<num_layer+1;++i)
-      for (int j=0; j<pumi_size();++j)
-        off_bridge_set[i][j].clear();
-
+    PCU_Comm_Begin_Neighbors();
+    ghost_sendOffBridges(m, num_layer, off_bridge_set);
     PCU_Comm_Send();
 
+    // receive phase
+    void *msg_recv;
+    int pid_from;
+    size_t msg_size;
     while (PCU_Comm_Read(&pid_from, &msg_recv, &msg_size))
     {
-      processed_ent.clear();
-
-      r = *((pMeshEnt*)msg_recv); 
-      r_int = (int*)((char*)msg_recv+sizeof(pMeshEnt)); 
-
-      r_layer=r_int[0];
-      r_pid=r_int[1];
+      pMeshEnt r = *((pMeshEnt*)msg_recv); 
+      int* r_int = (int*)((char*)msg_recv+sizeof(pMeshEnt)); 
+      int r_layer=r_int[0];
+      int r_pid=r_int[1];
       PCU_ALWAYS_ASSERT(r_layer<=num_layer && r_pid<pumi_size());
-      off_bridge_marker[r].insert(r_pid);
-
-      apf::Adjacent ghost_cands;
-      m->getAdjacent(r,ghost_dim, ghost_cands);   
-      APF_ITERATE(apf::Adjacent, ghost_cands, adj_ent_it)
-      {
-        ghost_ent = *adj_ent_it;
-        if (m->isGhost(ghost_ent)) continue; // skip ghost copy
-        plan->send(ghost_ent, r_pid);
-
-        m->setIntTag(ghost_ent,tag,&dummy);
-        processed_ent.push_back(ghost_ent);
-
-        if (r_layer<num_layer)
-        {
-          apf::Downward adjacent;
-          int num_brg=m->getDownward(ghost_ent,brg_dim, adjacent);
-          for (int b=0; b<num_brg; ++b)
-          {     
-            if (m->isShared(adjacent[b]) && adjacent[b]!=r && !pumi_ment_isOn(adjacent[b], r_pid))
-            {
-              if (off_bridge_marker[adjacent[b]].find(r_pid)==off_bridge_marker[adjacent[b]].end())
-                off_bridge_set[r_layer+1][r_pid].insert(adjacent[b]);
-            }
-          }
-        } // if (layer+1<=num_layer)
-      } // APF_ITERATE
-
-      int start_prev_layer=0, size_prev_layer=processed_ent.size(), num_prev_layer;
-      for (int layer=r_layer+1; layer<num_layer+1; ++layer)
-      {  
-        num_prev_layer=0;
-        for (int i=start_prev_layer; i<size_prev_layer; ++i)
-        {
-          ghost_ent = processed_ent.at(i);
-          adj_ent.clear();
-          pumi_ment_get2ndAdj (ghost_ent, brg_dim, ghost_dim, adj_ent);
-  
-          for (std::vector<pMeshEnt>::iterator git=adj_ent.begin(); git!=adj_ent.end(); ++git)
-          {
-            if (m->isGhost(*git) || m->hasTag(*git,tag))
-              continue; // skip ghost copy or already-processed copy
-      
-            plan->send(*git, r_pid);
- 
-            m->setIntTag(*git,tag,&dummy);
-            processed_ent.push_back(*git);
-            ++num_prev_layer;
-          } // for (std::vector<pMeshEnt>::iterator git=adj_ent.begin()
-
-          // collect off-part adjacent bridges
-          if (layer<num_layer)
-          {
-            apf::Downward adjacent;
-            int num_brg=m->getDownward(ghost_ent,brg_dim, adjacent);
-            for (int b=0; b<num_brg; ++b)
-            {     
-              if (m->isShared(adjacent[b]) && adjacent[b]!=r && !pumi_ment_isOn(adjacent[b], r_pid))
-                off_bridge_set[layer+1][r_pid].insert(adjacent[b]);
-            } // for int b=0
-          } // if (layer<=num_layer)
-        } // for int i=start_prev_layer
-        start_prev_layer+=size_prev_layer;
-        size_prev_layer+=num_prev_layer;
-      } // for layer
-      for (std::vector<pMeshEnt>::iterator git=processed_ent.begin(); git!=processed_ent.end(); ++git)
-        m->removeTag(*git,tag);
+      ghost_receiveOffBridge(m, brg_dim, ghost_dim, num_layer, off_bridge_set, plan,
+                             off_bridge_marker, r, r_layer, r_pid);
     }  // while (PCU_Comm_Read)
-    local_num_off_part=0;
-    for (int i=0; i<num_layer+1;++i)
-      for (int j=0; j<pumi_size();++j)
-        local_num_off_part+=off_bridge_set[i][j].size();
-    MPI_Allreduce(&local_num_off_part, &global_num_off_part, 1,MPI_INT,MPI_SUM,PCU_Get_Comm());
-  } // while global_off_part_brg
+  }
 }
 
 
 // *********************************************************
-void pumi_ghost_createLayer (pMesh m, int brg_dim, int ghost_dim, int num_layer, int include_copy)
+static Ghosting* ghost_computeLayer (pMesh m, int brg_dim, int ghost_dim, int num_layer,
+                                     int include_copy, const char* caller)
 // *********************************************************
 {
-  if (PCU_Comm_Peers()==1 || num_layer==0) return;
-  
   int dummy=1, mesh_dim=m->getDimension(), self = pumi_rank();;
   
   // brid/ghost dim check
@@ -714,8 +754,8 @@ void pumi_ghost_createLayer (pMesh m, int brg_dim, int ghost_dim, int num_layer,
       ghost_dim>mesh_dim || ghost_dim<1)
   {
     if (!self)
-       std::cout<<__func__<<" ERROR: invalid bridge/ghost dimension\n";   
-    return;
+       std::cout<<caller<<" ERROR: invalid bridge/ghost dimension\n";   
+    return NULL;
   }
 
   double t0 = PCU_Time();
@@ -836,13 +876,36 @@ void pumi_ghost_createLayer (pMesh m, int brg_dim, int ghost_dim, int num_layer,
     delete [] off_bridge_set[i];
   delete [] off_bridge_set;
 
-// ********************************************
-// STEP 3: perform ghosting
-// ********************************************
   if (!PCU_Comm_Self())
     printf("ghosting plan computed in %f seconds\n", PCU_Time()-t0);
+  return plan;
+}
 
-  pumi_ghost_create(m, plan);
+// *********************************************************
+void pumi_ghost_createLayer (pMesh m, int brg_dim, int ghost_dim, int num_layer, int include_copy)
+// *********************************************************
+{
+  if (PCU_Comm_Peers()==1 || num_layer==0) return;
+  Ghosting* plan = ghost_computeLayer(m, brg_dim, ghost_dim, num_layer,
+                                      include_copy, __func__);
+  if (plan)
+    pumi_ghost_create(m, plan);
+}
+
+// *********************************************************
+void pumi_ghost_updateLayer (pMesh m, int brg_dim, int ghost_dim, int num_layer, int include_copy)
+// *********************************************************
+{
+  if (PCU_Comm_Peers()==1) return;
+  if (num_layer==0)
+  {
+    pumi_ghost_delete(m);
+    return;
+  }
+  Ghosting* plan = ghost_computeLayer(m, brg_dim, ghost_dim, num_layer,
+                                      include_copy, __func__);
+  if (plan)
+    pumi_ghost_update(m, plan);
 }
 
 // *********************************************************
@@ -907,4 +970,3 @@ void pumi_ghost_getInfo (pMesh, std::vector<int>&)
   if (!pumi_rank()) 
     std::cout<<"[PUMI ERROR] "<<__func__<<" failed: not supported\n";
 }
-
@@ -0,0 +1,169 @@
+/****************************************************************************** 
+
+  (c) 2004-2025 Scientific Computation Research Center, 
+      Rensselaer Polytechnic Institute. All rights reserved.
+  
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+ 
+*******************************************************************************/
+#include "pumi.h"
+#include <PCU.h>
+#include <pcu_util.h>
+#include <map>
+#include <vector>
+#include "apf.h"
+#include "apfFieldData.h"
+#include "apfShape.h"
+
+/* the ghosted entities whose values go to one peer part,
+   or the ghosts whose values come from it, in message order */
+struct GhostPeer
+{
+  GhostPeer():values(0) {}
+  std::vector<pMeshEnt> entities;
+  int values;
+};
+
+class mGhostPlan
+{
+public:
+  std::vector<pField> fields;
+  std::map<int, GhostPeer> sends;
+  std::map<int, GhostPeer> receives;
+  std::vector<int> neighbors;
+  pMesh mesh;
+  unsigned long changes;
+};
+
+static bool ghost_hasNodes(pGhostPlan p, int d)
+{
+  for (size_t i=0; i<p->fields.size(); ++i)
+    if (p->fields[i]->getShape()->hasNodesIn(d))
+      return true;
+  return false;
+}
+
+/* the values of all fields on an entity travel together */
+static int ghost_countValues(pGhostPlan p, pMeshEnt e)
+{
+  int d = apf::getDimension(p->mesh, e);
+  int n = 0;
+  for (size_t i=0; i<p->fields.size(); ++i)
+    if (p->fields[i]->getShape()->hasNodesIn(d) &&
+        p->fields[i]->getData()->hasEntity(e))
+      n += p->fields[i]->countValuesOn(e);
+  return n;
+}
+
+// *********************************************************
+pGhostPlan pumi_ghost_createFieldPlan(pMesh m, std::vector<pField> const& fields)
+// *********************************************************
+{
+  pGhostPlan p = new mGhostPlan();
+  p->fields = fields;
+  p->mesh = m;
+  p->changes = m->countChanges();
+  int self = pumi_rank();
+  PCU_Comm_Begin();
+  for (int d=0; d<4; ++d)
+  {
+    if (!ghost_hasNodes(p, d))
+      continue;
+    std::vector<pMeshEnt>& ghosted = pumi::instance()->ghosted_vec[d];
+    for (size_t i=0; i<ghosted.size(); ++i)
+    {
+      pMeshEnt e = ghosted[i];
+      // every copy knows the ghosts, only the owner sends
+      if (m->getOwner(e)!=self)
+        continue;
+      int n = ghost_countValues(p, e);
+      if (!n)
+        continue;
+      Copies ghosts;
+      m->getGhosts(e, ghosts);
+      APF_ITERATE(Copies, ghosts, git)
+      {
+        GhostPeer& peer = p->sends[git->first];
+        peer.entities.push_back(e);
+        peer.values += n;
+        PCU_COMM_PACK(git->first, git->second);
+      }
+    }
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Listen())
+  {
+    GhostPeer& peer = p->receives[PCU_Comm_Sender()];
+    while (!PCU_Comm_Unpacked())
+    {
+      pMeshEnt e;
+      PCU_COMM_UNPACK(e);
+      peer.entities.push_back(e);
+      peer.values += ghost_countValues(p, e);
+    }
+  }
+  for (std::map<int, GhostPeer>::iterator it=p->sends.begin(); it!=p->sends.end(); ++it)
+    p->neighbors.push_back(it->first);
+  for (std::map<int, GhostPeer>::iterator it=p->receives.begin(); it!=p->receives.end(); ++it)
+    if (!p->sends.count(it->first))
+      p->neighbors.push_back(it->first);
+  return p;
+}
+
+// *********************************************************
+void pumi_ghost_synchronize(pGhostPlan p)
+// *********************************************************
+{
+  PCU_ALWAYS_ASSERT(p->mesh->countChanges()==p->changes);
+  size_t nf = p->fields.size();
+  PCU_Comm_Neighbors(p->neighbors.empty() ? 0 : &p->neighbors[0],
+      p->neighbors.size());
+  PCU_Comm_Begin_Neighbors();
+  for (std::map<int, GhostPeer>::iterator it=p->sends.begin(); it!=p->sends.end(); ++it)
+  {
+    GhostPeer& peer = it->second;
+    double* out = PCU_COMM_RESERVE(it->first, double, peer.values);
+    for (size_t i=0; i<peer.entities.size(); ++i)
+    {
+      pMeshEnt e = peer.entities[i];
+      int d = apf::getDimension(p->mesh, e);
+      for (size_t j=0; j<nf; ++j)
+      {
+        pField f = p->fields[j];
+        apf::FieldDataOf<double>* data = f->getData();
+        if (!f->getShape()->hasNodesIn(d) || !data->hasEntity(e))
+          continue;
+        data->get(e, out);
+        out += f->countValuesOn(e);
+      }
+    }
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive())
+  {
+    GhostPeer& peer = p->receives[PCU_Comm_Sender()];
+    double const* in = PCU_COMM_EXTRACT(double, peer.values);
+    for (size_t i=0; i<peer.entities.size(); ++i)
+    {
+      pMeshEnt e = peer.entities[i];
+      int d = apf::getDimension(p->mesh, e);
+      for (size_t j=0; j<nf; ++j)
+      {
+        pField f = p->fields[j];
+        apf::FieldDataOf<double>* data = f->getData();
+        if (!f->getShape()->hasNodesIn(d) || !data->hasEntity(e))
+          continue;
+        data->set(e, in);
+        in += f->countValuesOn(e);
+      }
+    }
+  }
+}
+
+// *********************************************************
+void pumi_ghostPlan_delete(pGhostPlan p)
+// *********************************************************
+{
+  delete p;
+}
@@ -141,6 +141,54 @@ void pumi_ment_get2ndAdj (pMeshEnt e, int bridge_dim, int target_dim, std::vecto
     vecAdjEnt.push_back(adjacent[i]);
 }
 
+void pumi_mesh_getAdj(pMesh m, int dim, int target_dim, std::vector<int>& offsets, std::vector<int>& targets)
+{
+  PCU_ALWAYS_ASSERT(dim!=target_dim && target_dim>=0);
+  offsets.assign(1, 0);
+  targets.clear();
+  offsets.reserve(m->count(dim)+1);
+  apf::Adjacent adjacent;
+  pMeshEnt e;
+  pMeshIter it = m->begin(dim);
+  while ((e = m->iterate(it)))
+  {
+    if (dim>target_dim)
+    {
+      apf::Downward down;
+      int n = m->getDownward(e, target_dim, down);
+      for (int i=0; i<n; ++i)
+        targets.push_back(getMdsIndex(m, down[i]));
+    }
+    else
+    {
+      m->getAdjacent(e, target_dim, adjacent);
+      for (size_t i=0; i<adjacent.getSize(); ++i)
+        targets.push_back(getMdsIndex(m, adjacent[i]));
+    }
+    offsets.push_back(targets.size());
+  }
+  m->end(it);
+}
+
+void pumi_mesh_get2ndAdj(pMesh m, int dim, int bridge_dim, int target_dim, std::vector<int>& offsets, std::vector<int>& targets)
+{
+  PCU_ALWAYS_ASSERT(bridge_dim!=target_dim);
+  offsets.assign(1, 0);
+  targets.clear();
+  offsets.reserve(m->count(dim)+1);
+  apf::Adjacent adjacent;
+  pMeshEnt e;
+  pMeshIter it = m->begin(dim);
+  while ((e = m->iterate(it)))
+  {
+    apf::getBridgeAdjacent(m, e, bridge_dim, target_dim, adjacent);
+    for (size_t i=0; i<adjacent.getSize(); ++i)
+      targets.push_back(getMdsIndex(m, adjacent[i]));
+    offsets.push_back(targets.size());
+  }
+  m->end(it);
+}
+
 int pumi_ment_getID(pMeshEnt e)
 {
   return getMdsIndex(pumi::instance()->mesh, e);
@@ -158,10 +206,57 @@ pMeshEnt pumi_medge_getOtherVtx(pMeshEnt edge, pMeshEnt vtx)
   return apf::getEdgeVertOppositeVert(pumi::instance()->mesh, edge, vtx);
 }
 
+// owners frozen by pumi_ownership_freeze
+void pumi_ownership_unfreeze(pMesh m)
+{
+  pumi* p = pumi::instance();
+  if (!p->owner_tag || p->owner_mesh!=m) return;
+  for (int d=0; d<4; ++d)
+    apf::removeTagFromDimension(m, p->owner_tag, d);
+  m->destroyTag(p->owner_tag);
+  p->owner_mesh = NULL;
+  p->owner_rule = NULL;
+  p->owner_tag = NULL;
+}
+
+void pumi_ownership_freeze(pMesh m, pOwnership o)
+{
+  pumi* p = pumi::instance();
+  if (p->owner_mesh) pumi_ownership_unfreeze(p->owner_mesh);
+  p->owner_tag = m->createIntTag("pumi_owner", 1);
+  for (int d=0; d<=m->getDimension(); ++d)
+  {
+    pMeshEnt e;
+    pMeshIter it = m->begin(d);
+    while ((e = m->iterate(it)))
+    {
+      int owner = o->getOwner(e);
+      m->setIntTag(e, p->owner_tag, &owner);
+    }
+    m->end(it);
+  }
+  p->owner_mesh = m;
+  p->owner_rule = o;
+  p->owner_changes = m->countChanges();
+}
+
+static bool hasFrozenOwners(pOwnership o)
+{
+  pumi* p = pumi::instance();
+  return o && o==p->owner_rule && p->mesh==p->owner_mesh &&
+    p->owner_changes==p->mesh->countChanges();
+}
+
 // owner part information
 int pumi_ment_getOwnPID(pMeshEnt e, pOwnership o)
 {
   pMesh m = pumi::instance()->mesh;
+  if (hasFrozenOwners(o))
+  {
+    int owner;
+    m->getIntTag(e, pumi::instance()->owner_tag, &owner);
+    return owner;
+  }
   if (!o)
   {
     if (m->isGhost(e))
@@ -195,8 +290,8 @@ pMeshEnt pumi_ment_getOwnEnt(pMeshEnt e, pOwnership o)
 
 bool pumi_ment_isOwned(pMeshEnt e, pOwnership o)
 {  
-  if (!o) 
-    return (pumi_ment_getOwnPID(e)==pumi_rank());
+  if (!o || hasFrozenOwners(o))
+    return (pumi_ment_getOwnPID(e, o)==pumi_rank());
   return o->isOwned(e);
 }
 
@@ -57,49 +57,61 @@ pMeshEnt pumi_mesh_createElem(pMesh m, pGeomEnt ge, int ent_topology, pMeshEnt*
   return apf::buildElement(m, (apf::ModelEntity*)ge, ent_topology, vertices);
 }
 
-void generate_globalid(pMesh m, pMeshTag tag, int dim, pOwnership o)
+static bool isOwnedBy(pMesh m, pMeshEnt e, pOwnership o)
 {
-  pMeshEnt e;
-  int num_own=0;
-
-  apf::MeshIterator* it = m->begin(dim);
-  while ((e = m->iterate(it)))
-    if ((o && o->isOwned(e)) || (!o && m->isOwned(e)))
-      ++num_own;
-  m->end(it);
+  return o ? o->isOwned(e) : m->isOwned(e);
+}
 
-  PCU_Exscan_Ints(&num_own,1);
-  int initial_id=num_own;
+/* numbers the owned entities of all dimensions with one scan and
+   sends the numbers to the copies and ghosts in one exchange */
+static void generate_globalid(pMesh m, pMeshTag tag, pOwnership o)
+{
+  pMeshEnt e;
+  int dim = m->getDimension();
+  int num_own[4] = {0, 0, 0, 0};
+  for (int d=0; d<=dim; ++d)
+  {
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it)))
+      if (isOwnedBy(m, e, o))
+        ++num_own[d];
+    m->end(it);
+  }
+  PCU_Exscan_Ints(num_own, 4);
 
   PCU_Comm_Begin();
-  it = m->begin(dim);
-  while ((e = m->iterate(it)))
+  for (int d=0; d<=dim; ++d)
   {
-    if ((o && !o->isOwned(e)) || (!o && !m->isOwned(e)))
-      continue;
-
-    m->setIntTag(e, tag, &initial_id);
-    Copies remotes;
-    m->getRemotes(e, remotes);
-    APF_ITERATE(Copies, remotes, it)
+    int initial_id=num_own[d];
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it)))
     {
-      PCU_COMM_PACK(it->first, it->second);
-      PCU_Comm_Pack(it->first, &initial_id, sizeof(int));
-    }
+      if (!isOwnedBy(m, e, o))
+        continue;
 
-    if (m->isGhosted(e))
-    {
-      Copies ghosts;
-      m->getGhosts(e, ghosts);
-      APF_ITERATE(Copies, ghosts, it)
+      m->setIntTag(e, tag, &initial_id);
+      Copies remotes;
+      m->getRemotes(e, remotes);
+      APF_ITERATE(Copies, remotes, it)
       {
         PCU_COMM_PACK(it->first, it->second);
         PCU_Comm_Pack(it->first, &initial_id, sizeof(int));
       }
+
+      if (m->isGhosted(e))
+      {
+        Copies ghosts;
+        m->getGhosts(e, ghosts);
+        APF_ITERATE(Copies, ghosts, it)
+        {
+          PCU_COMM_PACK(it->first, it->second);
+          PCU_Comm_Pack(it->first, &initial_id, sizeof(int));
+        }
+      }
+      ++initial_id;
     }
-    ++initial_id;
+    m->end(it);
   }
-  m->end(it);
 
   PCU_Comm_Send();
   int global_id;
@@ -121,13 +133,12 @@ void pumi_mesh_createGlobalID(pMesh m, pOwnership o)
   if (tag)  // destroy existing tag
   {
     for (int i=0; i<4; ++i)
-      apf::removeTagFromDimension(m, tag, m->getDimension());
+      apf::removeTagFromDimension(m, tag, i);
   }  
   else
     tag = m->createIntTag("global_id",1);
 
-  for (int i=0; i<=m->getDimension(); ++i)
-    generate_globalid(m, tag, i, o);
+  generate_globalid(m, tag, o);
 }
 
 //*******************************************************
@@ -151,6 +162,10 @@ pumi::pumi(): mesh(NULL), model(NULL)
   num_local_ent = NULL;
   num_own_ent = NULL;
   num_global_ent = NULL;
+  owner_mesh = NULL;
+  owner_rule = NULL;
+  owner_tag = NULL;
+  owner_changes = 0;
 }
 
 pumi::~pumi()
@@ -582,6 +597,7 @@ void pumi_mesh_write (pMesh m, const char* filename, const char* mesh_type)
 
 void pumi_mesh_delete(pMesh m)
 {
+  pumi_ownership_unfreeze(m);
   if (m->findTag("ghost_tag"))
     m->destroyTag(pumi::instance()->ghost_tag);
   if (m->findTag("ghosted_tag"))
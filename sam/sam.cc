@@ -2,7 +2,9 @@
 #include "samSz.h"
 #include <apfGeometry.h>
 #include <apfField.h>
+#include <gmi.h>
 #include <pcu_util.h>
+#include <PCU.h>
 #include <stdio.h>
 #include <math.h>
 
@@ -127,22 +129,170 @@ void multiplySFCyl(apf::Mesh* m, apf::Field* sf, double factor, double* cyl) {
   m->end(itr);
 }
 
+/* the vertices classified on a model region and its closure,
+   found through the reverse classification */
+static void getRegionVerts(apf::Mesh* m, int tag,
+    std::vector<apf::MeshEntity*>& vtxs)
+{
+  int type = 3; // 3D region by default
+  apf::ModelEntity* region = m->findModelEntity(type, tag);
+  gmi_model* g = m->getModel();
+  for (int d = 0; d <= type; ++d) {
+    gmi_iter* it = gmi_begin(g, d);
+    gmi_ent* ge;
+    while ((ge = gmi_next(g, it))) {
+      apf::ModelEntity* me = (apf::ModelEntity*)ge;
+      if (me == region || m->isInClosureOf(me, region))
+        m->getClassified(me, 0, vtxs);
+    }
+    gmi_end(g, it);
+  }
+}
+
 void multiplySFRegion(apf::Mesh* m, apf::Field* sf, double factor, int tag) {
   /* tag should be a tag of a region */
   PCU_ALWAYS_ASSERT(m->findField(apf::getName(sf)));
-  int type = 3; // 3D region by default
+  /* the vertices classified on the region and its closure */
+  std::vector<apf::MeshEntity*> vtxs;
+  getRegionVerts(m, tag, vtxs);
+  for (size_t i = 0; i < vtxs.size(); ++i) {
+    double h = apf::getScalar(sf,vtxs[i],0);
+    apf::setScalar(sf,vtxs[i],0,h*factor);
+  }
+}
+
+enum { MULTIPLY, BOX, CYL, REGION };
+
+void SizeOps::multiply(double factor)
+{
+  Op op;
+  op.type = MULTIPLY;
+  op.factor = factor;
+  ops.push_back(op);
+}
+
+void SizeOps::multiplyBox(double factor, double* box)
+{
+  PCU_ALWAYS_ASSERT(box[3] > 0 && box[4] > 0 && box[5] > 0);
+  Op op;
+  op.type = BOX;
+  op.factor = factor;
+  for (int i = 0; i < 6; ++i)
+    op.shape[i] = box[i];
+  ops.push_back(op);
+}
+
+void SizeOps::multiplyCyl(double factor, double* cyl)
+{
+  /* same cylinder as multiplySFCyl */
+  PCU_ALWAYS_ASSERT(cyl[6] > 0 && cyl[7] > 0);
+  Op op;
+  op.type = CYL;
+  op.factor = factor;
+  for (int i = 0; i < 8; ++i)
+    op.shape[i] = cyl[i];
+  ops.push_back(op);
+}
+
+void SizeOps::multiplyRegion(double factor, int tag)
+{
+  Op op;
+  op.type = REGION;
+  op.factor = factor;
+  op.tag = tag;
+  ops.push_back(op);
+}
+
+/* runs the whole chain of operations on many vertices in
+   contiguous chunks, one per thread */
+struct SizeChunks
+{
+  static void compute(void* p, size_t first, size_t end)
+  {
+    SizeChunks* all = static_cast<SizeChunks*>(p);
+    std::vector<SizeOps::Op> const& ops = *all->ops;
+    for (size_t i = first; i < end; ++i) {
+      apf::Vector3 const& x = all->points[i];
+      double h = all->sizes[i];
+      for (size_t j = 0; j < ops.size(); ++j) {
+        SizeOps::Op const& op = ops[j];
+        bool in = true;
+        if (op.type == BOX)
+          in = apf::withinBox(x, apf::Vector3(op.shape),
+              apf::Vector3(op.shape + 3));
+        else if (op.type == CYL)
+          in = apf::withinCyl(x, apf::Vector3(op.shape),
+              op.shape[6], op.shape[7], apf::Vector3(op.shape + 3));
+        else if (op.type == REGION)
+          in = all->inRegion[j][i];
+        if (in)
+          h *= op.factor;
+      }
+      all->sizes[i] = h;
+    }
+  }
+  void run(int threads)
+  {
+    size_t n = sizes.size();
+    PCU_Thrd_Chunks(threads, n, compute, this);
+  }
+  std::vector<SizeOps::Op> const* ops;
+  std::vector<apf::Vector3> points;
+  std::vector<double> sizes;
+  /* for each region operation, whether each vertex is in it */
+  std::vector<std::vector<char> > inRegion;
+};
+
+/* the fields are read and the results written serially,
+   only the operations in between are computed on (threads) */
+void SizeOps::apply(apf::Mesh* m, apf::Field* sf, int threads)
+{
+  PCU_ALWAYS_ASSERT(m->findField(apf::getName(sf)));
+  size_t n = m->count(0);
+  std::vector<apf::MeshEntity*> verts(n);
+  SizeChunks chunks;
+  chunks.ops = &ops;
+  chunks.points.resize(n);
+  chunks.sizes.resize(n);
+  chunks.inRegion.resize(ops.size());
+  bool regions = false;
+  for (size_t j = 0; j < ops.size(); ++j)
+    if (ops[j].type == REGION)
+      regions = true;
+  apf::MeshTag* ids = regions ? m->createIntTag("sam_vertex_id", 1) : 0;
   apf::MeshEntity* vtx;
+  int i = 0;
   apf::MeshIterator* itr = m->begin(0);
   while( (vtx = m->iterate(itr)) ) {
-    apf::ModelEntity* m_vtx = m->toModel(vtx);
-    apf::ModelEntity* region = m->findModelEntity(type, tag);
-    if (m_vtx == region ||
-	    m->isInClosureOf(m_vtx, region)) {
-      double h = apf::getScalar(sf,vtx,0);
-      apf::setScalar(sf,vtx,0,h*factor);
-	}
+    verts[i] = vtx;
+    m->getPoint(vtx, 0, chunks.points[i]);
+    chunks.sizes[i] = apf::getScalar(sf,vtx,0);
+    if (ids)
+      m->setIntTag(vtx, ids, &i);
+    ++i;
   }
   m->end(itr);
+  for (size_t j = 0; j < ops.size(); ++j) {
+    if (ops[j].type != REGION)
+      continue;
+    chunks.inRegion[j].assign(n, 0);
+    std::vector<apf::MeshEntity*> vtxs;
+    getRegionVerts(m, ops[j].tag, vtxs);
+    for (size_t k = 0; k < vtxs.size(); ++k) {
+      int id;
+      m->getIntTag(vtxs[k], ids, &id);
+      chunks.inRegion[j][id] = 1;
+    }
+  }
+  chunks.run(threads);
+  for (size_t k = 0; k < n; ++k) {
+    apf::setScalar(sf,verts[k],0,chunks.sizes[k]);
+    if (ids)
+      m->removeTag(verts[k], ids);
+  }
+  if (ids)
+    m->destroyTag(ids);
+  apf::synchronize(sf);
 }
 
 }
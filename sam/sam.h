@@ -2,6 +2,7 @@
 #define SAM_H
 
 #include <apf.h>
+#include <vector>
 
 namespace sam {
 
@@ -14,6 +15,26 @@ void multiplySFBox(apf::Mesh* m, apf::Field* sf, double factor, double* box);
 void multiplySFCyl(apf::Mesh* m, apf::Field* sf, double factor, double* cyl);
 void multiplySFRegion(apf::Mesh* m, apf::Field* sf, double factor, int tag);
 
+/* a chain of the multiplySF* scalings that apply() runs in one
+   pass over the vertices, computing on (threads) and synchronizing
+   the size field once at the end */
+class SizeOps {
+  public:
+    void multiply(double factor);
+    void multiplyBox(double factor, double* box);
+    void multiplyCyl(double factor, double* cyl);
+    void multiplyRegion(double factor, int tag);
+    void apply(apf::Mesh* m, apf::Field* sf, int threads = 1);
+    struct Op {
+      int type;
+      double factor;
+      double shape[8];
+      int tag;
+    };
+  private:
+    std::vector<Op> ops;
+};
+
 }
 
 #endif
@@ -3,6 +3,8 @@
 #include <apf.h>
 #include <apfMesh.h>
 #include <PCU.h>
+#include <algorithm>
+#include <vector>
 
 namespace sam {
 
@@ -106,4 +108,138 @@ void scaleIsoSizeField(apf::Field* iso_field, double targetElementCount) {
   m->end(it);
 }
 
+/* the size and weighted volume at each integration point
+   of this part, so that a scaled and clamped size field can be
+   integrated again without going back to the mesh */
+class MetricSamples : public apf::Integrator {
+  apf::Field* iso_field;
+  apf::Element* element;
+
+public:
+  int dim;
+  std::vector<double> h;
+  std::vector<double> dV;
+
+  MetricSamples(apf::Field* iso_field_):
+    apf::Integrator(1),
+    iso_field(iso_field_),
+    element(0),
+    dim(apf::getMesh(iso_field_)->getDimension()) {
+  }
+  virtual void inElement(apf::MeshElement* me) {
+    element = apf::createElement(iso_field, me);
+  }
+  virtual void outElement() {
+    apf::destroyElement(element);
+  }
+  virtual void atPoint(apf::Vector3 const& xi, double w, double dV_) {
+    h.push_back(apf::getScalar(element, xi));
+    dV.push_back(w * dV_);
+  }
+  /* the elements of this part for the sizes scaled and clamped */
+  double count(double scale, double hmin, double hmax) {
+    double sum = 0;
+    for (size_t i = 0; i < h.size(); ++i) {
+      double s = h[i] * scale;
+      if (hmin > 0)
+        s = std::max(s, hmin);
+      if (hmax > 0)
+        s = std::min(s, hmax);
+      sum += getVolumeChange(dim, s) * dV[i];
+    }
+    return sum / getPerfectVolume(dim);
+  }
+};
+
+static double getBytesPerElement(apf::Mesh* m) {
+  apf::MeshMemory u;
+  m->getMemoryUsage(u);
+  double bytes = 0;
+  for (int t = 0; t < apf::Mesh::TYPES; ++t)
+    bytes += u.downward[t] + u.upward[t] + u.coordinates[t] +
+      u.tags[t] + u.remotes[t] + u.other[t];
+  size_t n = m->count(m->getDimension());
+  return n ? bytes / n : 0;
+}
+
+ElementCountEstimate estimateElementCount(apf::Field* iso_field,
+    double scale, double hmin, double hmax) {
+  apf::Mesh* m = apf::getMesh(iso_field);
+  MetricSamples samples(iso_field);
+  samples.process(m);
+  ElementCountEstimate e;
+  e.local = samples.count(scale, hmin, hmax);
+  e.localBytes = e.local * getBytesPerElement(m);
+  double sums[2] = {e.local, e.localBytes};
+  PCU_Add_Doubles(sums, 2);
+  e.global = sums[0];
+  e.globalBytes = sums[1];
+  e.maxPart = PCU_Max_Double(e.local);
+  return e;
+}
+
+double getIsoLengthScalar(apf::Field* iso_field, double targetElementCount,
+    double hmin, double hmax, double tolerance) {
+  apf::Mesh* m = apf::getMesh(iso_field);
+  MetricSamples samples(iso_field);
+  samples.process(m);
+  /* without clamping the count goes as scale^-dim, which
+     gives the starting guess */
+  double count = PCU_Add_Double(samples.count(1, 0, 0));
+  double scale = getLengthScalar(samples.dim, targetElementCount,
+      count * getPerfectVolume(samples.dim));
+  /* bracket the target between a finer (lo) and a coarser (hi)
+     scale; the count never grows with the scale */
+  double lo = scale;
+  double hi = scale;
+  const int maxSteps = 60;
+  for (int i = 0; i < maxSteps; ++i) {
+    count = PCU_Add_Double(samples.count(scale, hmin, hmax));
+    if (fabs(count - targetElementCount) <= tolerance * targetElementCount)
+      return scale;
+    if (count > targetElementCount) {
+      lo = scale;
+      if (hi > lo)
+        break;
+      hi = scale = scale * 2;
+    } else {
+      hi = scale;
+      if (lo < hi)
+        break;
+      lo = scale = scale / 2;
+    }
+  }
+  /* the clamps can keep the target out of reach,
+     then the closest bracket end is the answer */
+  for (int i = 0; i < maxSteps && lo < hi; ++i) {
+    scale = sqrt(lo * hi);
+    count = PCU_Add_Double(samples.count(scale, hmin, hmax));
+    if (fabs(count - targetElementCount) <= tolerance * targetElementCount)
+      break;
+    if (count > targetElementCount)
+      lo = scale;
+    else
+      hi = scale;
+  }
+  return scale;
+}
+
+void scaleIsoSizeField(apf::Field* iso_field, double targetElementCount,
+    double hmin, double hmax) {
+  apf::Mesh* m = apf::getMesh(iso_field);
+  double lengthScalar = getIsoLengthScalar(iso_field, targetElementCount,
+      hmin, hmax);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* vert;
+  while ((vert = m->iterate(it))) {
+    double h = apf::getScalar(iso_field, vert, 0) * lengthScalar;
+    if (hmin > 0)
+      h = std::max(h, hmin);
+    if (hmax > 0)
+      h = std::min(h, hmax);
+    apf::setScalar(iso_field, vert, 0, h);
+  }
+  m->end(it);
+}
+
 }
@@ -10,6 +10,39 @@ namespace sam {
 double getIsoLengthScalar(apf::Field* iso_field, double targetElementCount);
 void scaleIsoSizeField(apf::Field* iso_field, double targetElementCount);
 
+/* the elements and mesh memory that adapting to an isotropic
+   size field is predicted to give, without adapting */
+struct ElementCountEstimate {
+  /* elements on this part */
+  double local;
+  /* elements on all parts */
+  double global;
+  /* elements on the largest part */
+  double maxPart;
+  /* bytes on this part and on all parts, at the bytes per
+     element of the current mesh (zero if it reports no memory) */
+  double localBytes;
+  double globalBytes;
+};
+
+/* predicts the elements of the size field scaled by (scale) and
+   then clamped to [hmin, hmax], where a bound that is not positive
+   is left open. one integration pass and two reductions */
+ElementCountEstimate estimateElementCount(apf::Field* iso_field,
+    double scale = 1, double hmin = 0, double hmax = 0);
+
+/* the scale factor that gives targetElementCount within a relative
+   (tolerance) once the sizes are clamped to [hmin, hmax].
+   the size field is integrated once, then each bisection
+   step is a loop over the samples and one reduction */
+double getIsoLengthScalar(apf::Field* iso_field, double targetElementCount,
+    double hmin, double hmax, double tolerance = 1e-3);
+
+/* scales the size field to targetElementCount and clamps it
+   to [hmin, hmax] */
+void scaleIsoSizeField(apf::Field* iso_field, double targetElementCount,
+    double hmin, double hmax);
+
 }
 
 #endif
@@ -17,33 +17,35 @@ void getEdgeLenAndCnt(apf::Mesh* m, apf::MeshEntity* v, double& len, int& cnt) {
   }
 }
 
-void setLenAndCnt(apf::Mesh* m, apf::Field* fLen, apf::Field* fCnt) {
-  double len = 0;
-  int cnt = 0;
+/* sums the owned incident edge lengths and counts of each vertex
+   in a two component field, added across parts in one exchange */
+apf::Field* getLenAndCnt(apf::Mesh* m) {
+  apf::Field* f = apf::createPackedField(m, "incidentEdgeLengthCount", 2);
   apf::MeshEntity* vtx;
   apf::MeshIterator* itr = m->begin(0);
   while( (vtx = m->iterate(itr)) ) {
+    double len = 0;
+    int cnt = 0;
     getEdgeLenAndCnt(m, vtx, len, cnt);
-    apf::setScalar(fLen, vtx, 0, len);
-    apf::setScalar(fCnt, vtx, 0, cnt);
+    double lc[2] = {len, double(cnt)};
+    apf::setComponents(f, vtx, 0, lc);
   }
   m->end(itr);
-  apf::accumulate(fLen);
-  apf::accumulate(fCnt);
-  apf::synchronize(fLen);
-  apf::synchronize(fCnt);
+  apf::accumulate(f);
+  return f;
 }
 
-apf::Field* getIsoSize(apf::Mesh* m, apf::Field* fLen, apf::Field* fCnt) {
+apf::Field* getIsoSize(apf::Mesh* m, apf::Field* fLenCnt) {
   if (m->findField("isoSize"))
     apf::destroyField(m->findField("isoSize"));
   apf::Field* sz = createFieldOn(m, "isoSize", apf::SCALAR);
   apf::MeshEntity* vtx;
   apf::MeshIterator* itr = m->begin(0);
   while( (vtx = m->iterate(itr)) ) {
-    int cnt = static_cast<int>(apf::getScalar(fCnt,vtx,0));
-    double h = apf::getScalar(fLen,vtx,0);
-    apf::setScalar(sz,vtx,0,h/cnt);
+    double lc[2];
+    apf::getComponents(fLenCnt, vtx, 0, lc);
+    int cnt = static_cast<int>(lc[1]);
+    apf::setScalar(sz,vtx,0,lc[0]/cnt);
   }
   m->end(itr);
   return sz;
@@ -54,12 +56,9 @@ apf::Field* getIsoSize(apf::Mesh* m, apf::Field* fLen, apf::Field* fCnt) {
 namespace samSz {
 
 apf::Field* isoSize(apf::Mesh* m) {
-  apf::Field* fLen = createFieldOn(m, "incidentEdgeLength", apf::SCALAR);
-  apf::Field* fCnt = createFieldOn(m, "incidentEdgeCount", apf::SCALAR);
-  setLenAndCnt(m,fLen,fCnt);
-  apf::Field* isoSz = getIsoSize(m,fLen,fCnt);
-  apf::destroyField(fLen);
-  apf::destroyField(fCnt);
+  apf::Field* fLenCnt = getLenAndCnt(m);
+  apf::Field* isoSz = getIsoSize(m,fLenCnt);
+  apf::destroyField(fLenCnt);
   return isoSz;
 }
 
@@ -33,6 +33,10 @@ apf::Field* getGradIPField(apf::Field* f,
                            int order);
 
 /** @brief recover a nodal field using patch recovery
+  * @details patches around part boundary entities are first
+  *          completed by sending integration point samples to
+  *          the owner, and only patches that still lack points
+  *          migrate elements through an apf::CavityOp.
   * @param ip_field (In) integration point field
   */
 apf::Field* recoverField(apf::Field* ip_field);
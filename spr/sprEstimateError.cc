@@ -11,7 +11,6 @@
 
 #include <apfMesh.h>
 #include <apfShape.h>
-#include <apfCavityOp.h>
 
 #include <limits>
 
@@ -94,34 +93,6 @@ static void setupEstimation(Estimation* e, apf::Field* eps, double tolerance)
   e->size = 0;
 }
 
-/* computes $\|f\|^2$ */
-class SelfProduct : public SInt
-{
-  public:
-    SelfProduct(Estimation* e):
-      SInt(e->integration_order), estimation(e), element(0)
-    {
-      v.setSize(apf::countComponents(e->eps_star));
-    }
-    void inElement(apf::MeshElement* meshElement)
-    {
-      element = apf::createElement(estimation->eps_star, meshElement);
-    }
-    void outElement()
-    {
-      apf::destroyElement(element);
-    }
-    void atPoint(apf::Vector3 const& p, double w, double dV)
-    {
-      apf::getComponents(element, p, &v[0]);
-      r += (v * v) * w * dV;
-    }
-  private:
-    Estimation* estimation;
-    apf::Element* element;
-    apf::DynamicVector v;
-};
-
 /* computes the integral over the element of the
    sum of the squared differences between the
    original and recovered fields */
@@ -167,13 +138,23 @@ class ElementError : public SInt
     apf::DynamicVector v1, v2;
 };
 
-/* computes the $\sum_{i=1}^n \|e_\epsilon\|^{\frac{2d}{2p+d}}$ term. */
-class Error : public ElementError
+/* in one pass over the elements, computes $\|f\|^2$ of the
+   recovered field in (norm), the
+   $\sum_{i=1}^n \|e_\epsilon\|^{\frac{2d}{2p+d}}$ term in (r),
+   and keeps each element's $\|e_\epsilon\|^2$ in the
+   element size field until the sizes replace it */
+class Errors : public ElementError
 {
   public:
-    Error(Estimation* e):
-      ElementError(e)
+    Errors(Estimation* e):
+      ElementError(e),
+      norm(0)
+    {
+    }
+    void atPoint(apf::Vector3 const& xi, double w, double dV)
     {
+      ElementError::atPoint(xi, w, dV);
+      norm += (v2 * v2) * w * dV;
     }
     void outElement()
     {
@@ -181,37 +162,25 @@ class Error : public ElementError
       double d = estimation->mesh->getDimension();
       double p = estimation->recovered_order;
       r += pow(sqrt(sum), ((2 * d) / (2 * p + d)));
+      apf::setScalar(estimation->element_size, entity, 0, sum);
     }
-};
-
-/* computes the $\|e_\epsilon\|^{-\frac{2}{2p+d}}_e$ term
-   (over one element only) */
-class Error2 : public ElementError
-{
-  public:
-    Error2(Estimation* e):
-      ElementError(e)
-    {
-    }
-    void outElement()
+    void parallelReduce()
     {
-      ElementError::outElement();
-      double p = estimation->recovered_order;
-      double d = estimation->mesh->getDimension();
-      r = pow(sqrt(sum), -(2 / (2 * p + d)));
+      double sums[2] = {r, norm};
+      PCU_Add_Doubles(sums, 2);
+      r = sums[0];
+      norm = sums[1];
     }
+    double norm;
 };
 
 static void computeSizeFactor(Estimation* e)
 {
-  SelfProduct epsStarNormIntegrator(e);
-  epsStarNormIntegrator.process(e->mesh);
-  double epsStarNorm = sqrt(epsStarNormIntegrator.r);
-  Error errorIntegrator(e);
-  errorIntegrator.process(e->mesh);
-  double a = e->tolerance * e->tolerance *
-             epsStarNorm * epsStarNorm;
-  double b = a / errorIntegrator.r;
+  e->element_size = apf::createStepField(e->mesh, "esize", apf::SCALAR);
+  Errors errors(e);
+  errors.process(e->mesh);
+  double a = e->tolerance * e->tolerance * errors.norm;
+  double b = a / errors.r;
   double p = e->recovered_order;
   e->size_factor = pow(b, 1.0 / (2.0 * p));
 }
@@ -227,75 +196,59 @@ static double getCurrentSize(apf::Mesh* m, apf::MeshEntity* e)
   return h;
 }
 
-static double getDesiredSize(Estimation* e, apf::MeshEntity* entity)
-{
-  Error2 errorNormIntegrator(e);
-  apf::MeshElement* element = apf::createMeshElement(e->mesh, entity);
-  errorNormIntegrator.process(element);
-  double errorNorm = errorNormIntegrator.r;
-  apf::destroyMeshElement(element);
-  double h = getCurrentSize(e->mesh, entity);
-  return h * errorNorm * e->size_factor;
-}
-
+/* replaces the element errors left by computeSizeFactor with
+   the desired sizes, using the
+   $\|e_\epsilon\|^{-\frac{2}{2p+d}}_e$ term of each element */
 static void getElementSizeField(Estimation* e)
 {
-  apf::Field* eSize = apf::createStepField(e->mesh, "esize", apf::SCALAR);
-  int d = e->mesh->getDimension();
+  double p = e->recovered_order;
+  double d = e->mesh->getDimension();
   apf::MeshEntity* entity;
   apf::MeshIterator* elements = e->mesh->begin(d);
   while ((entity = e->mesh->iterate(elements))) {
-    double h = getDesiredSize(e, entity);
-    apf::setScalar(eSize, entity, 0, h);
+    double sum = apf::getScalar(e->element_size, entity, 0);
+    double errorNorm = pow(sqrt(sum), -(2 / (2 * p + d)));
+    double h = getCurrentSize(e->mesh, entity);
+    apf::setScalar(e->element_size, entity, 0,
+        h * errorNorm * e->size_factor);
   }
   e->mesh->end(elements);
-  e->element_size = eSize;
-}
-
-void averageToVertex(apf::Field* ef, apf::Field* vf, apf::MeshEntity* ent)
-{
-  apf::Mesh* m = apf::getMesh(ef);
-  apf::Adjacent elements;
-  m->getAdjacent(ent, m->getDimension(), elements);
-  double s=0;
-  for (std::size_t i=0; i < elements.getSize(); ++i)
-    s += apf::getScalar(ef, elements[i], 0);
-  s /= elements.getSize();
-  apf::setScalar(vf, ent, 0, s);
 }
 
-class AverageOp : public apf::CavityOp
-{
-  public:
-    AverageOp(Estimation* e):
-      apf::CavityOp(e->mesh),
-      estimation(e),
-      entity(0)
-    {
-    }
-    virtual Outcome setEntity(apf::MeshEntity* e)
-    {
-      entity = e;
-      if (apf::hasEntity(estimation->size, entity))
-        return SKIP;
-      if ( ! requestLocality(&entity, 1))
-        return REQUEST;
-      return OK;
-    }
-    virtual void apply()
-    {
-      averageToVertex(estimation->element_size,
-          estimation->size, entity);
-    }
-    Estimation* estimation;
-    apf::MeshEntity* entity;
-};
-
+/* averages the element sizes around each vertex. the sums and
+   counts of the elements on each part are added up in one
+   exchange rather than pulling the elements together */
 void averageSizeField(Estimation* e)
 {
-  e->size = apf::createLagrangeField(e->mesh, "size", apf::SCALAR, 1);
-  AverageOp op(e);
-  op.applyToDimension(0);
+  apf::Mesh* m = e->mesh;
+  e->size = apf::createLagrangeField(m, "size", apf::SCALAR, 1);
+  apf::Field* sums = apf::createPackedField(m, "size_sums", 2,
+      apf::getLagrange(1));
+  apf::zeroField(sums);
+  apf::MeshEntity* entity;
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  while ((entity = m->iterate(it))) {
+    double h = apf::getScalar(e->element_size, entity, 0);
+    apf::Downward verts;
+    int nv = m->getDownward(entity, 0, verts);
+    for (int i = 0; i < nv; ++i) {
+      double s[2];
+      apf::getComponents(sums, verts[i], 0, s);
+      s[0] += h;
+      s[1] += 1;
+      apf::setComponents(sums, verts[i], 0, s);
+    }
+  }
+  m->end(it);
+  apf::accumulate(sums);
+  it = m->begin(0);
+  while ((entity = m->iterate(it))) {
+    double s[2];
+    apf::getComponents(sums, entity, 0, s);
+    apf::setScalar(e->size, entity, 0, s[0] / s[1]);
+  }
+  m->end(it);
+  apf::destroyField(sums);
 }
 
 static void estimateError(Estimation* e)
@@ -310,6 +263,7 @@ static void estimateError(Estimation* e)
 
 apf::Field* getSPRSizeField(apf::Field* eps, double adaptRatio)
 {
+  PCU_Region region("spr::getSPRSizeField");
   double t0 = PCU_Time();
   Estimation e;
   setupEstimation(&e, eps, adaptRatio);
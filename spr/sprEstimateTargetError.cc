@@ -245,6 +245,7 @@ apf::Field* getTargetSPRSizeField(
     double alpha,
     double beta)
 {
+  PCU_Region region("spr::getTargetSPRSizeField");
   double t0 = PCU_Time();
   PCU_ALWAYS_ASSERT(target > 0);
   PCU_ALWAYS_ASSERT(alpha < beta);
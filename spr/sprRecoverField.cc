@@ -16,10 +16,26 @@
 #include <mthQR.h>
 
 #include <set>
+#include <map>
+#include <algorithm>
+#include <cmath>
 #include <pcu_util.h>
 
 namespace spr {
 
+/* the least squares fit of one patch shape */
+struct Fit {
+  Fit():ok(false) {}
+  /* false if the samples do not determine a polynomial */
+  bool ok;
+  /* node j of the patch entity gets the sum over samples k
+     of weights[j * samples + k] times the value of sample k,
+     with the samples in key order */
+  std::vector<double> weights;
+};
+
+typedef std::map<std::vector<long>, Fit> FitCache;
+
 /* overall information useful during recovery */
 struct Recovery {
   apf::Mesh* mesh;
@@ -46,6 +62,8 @@ struct Recovery {
   apf::Field* f;
   /* output field containing recovered nodal data */
   apf::Field* f_star;
+  /* fits of recent patches, see prepareFit */
+  FitCache fits;
 };
 
 static int determinePointsPerElement(apf::Field* f)
@@ -103,10 +121,6 @@ struct Samples {
   apf::NewArray<apf::NewArray<double> > values;
 };
 
-struct QRDecomp {
-  mth::Matrix<double> Q;
-  mth::Matrix<double> R;
-};
 
 typedef std::set<apf::MeshEntity*> EntitySet;
 
@@ -121,7 +135,35 @@ struct Patch {
   apf::MeshEntity* entity;
   EntitySet elements;
   Samples samples;
-  QRDecomp qr;
+  /* the samples in the order of the fit's key */
+  std::vector<int> order;
+  Fit const* fit;
+};
+
+/* decides whether the upward adjacencies of some entities
+   can be used in a patch, see apf::CavityOp::requestLocality */
+class Locality
+{
+  public:
+    virtual ~Locality() {}
+    virtual bool request(apf::MeshEntity** entities, int count) = 0;
+};
+
+/* patches that only grow around entities this part has all the
+   elements of, which needs no migration */
+class PartLocality : public Locality
+{
+  public:
+    PartLocality(apf::Mesh* m):mesh(m) {}
+    virtual bool request(apf::MeshEntity** entities, int count)
+    {
+      for (int i = 0; i < count; ++i)
+        if (mesh->isShared(entities[i]))
+          return false;
+      return true;
+    }
+  private:
+    apf::Mesh* mesh;
 };
 
 static void setupPatch(Patch* p, Recovery* r)
@@ -129,6 +171,7 @@ static void setupPatch(Patch* p, Recovery* r)
   p->mesh = r->mesh;
   p->recovery = r;
   p->entity = 0;
+  p->fit = 0;
 }
 
 static void startPatch(Patch* p, apf::MeshEntity* e)
@@ -153,9 +196,9 @@ static void addElementsToPatch(Patch* p, apf::DynamicArray<apf::MeshEntity*>& es
     addElementToPatch(p, es[i]);
 }
 
-static bool getInitialPatch(Patch* p, apf::CavityOp* o)
+static bool getInitialPatch(Patch* p, Locality* o)
 {
-  if ( ! o->requestLocality(&p->entity,1))
+  if ( ! o->request(&p->entity,1))
     return false;
   apf::DynamicArray<apf::MeshEntity*> adjacent;
   p->mesh->getAdjacent(p->entity, p->recovery->dim, adjacent);
@@ -164,7 +207,7 @@ static bool getInitialPatch(Patch* p, apf::CavityOp* o)
 }
 
 static bool addElementsThatShare(Patch* p, int dim,
-    EntitySet& old_elements, apf::CavityOp* o)
+    EntitySet& old_elements, Locality* o)
 {
   EntitySet bridges;
   APF_ITERATE(EntitySet, old_elements, it)
@@ -177,7 +220,7 @@ static bool addElementsThatShare(Patch* p, int dim,
   std::vector<apf::MeshEntity*> 
     bridge_array(bridges.begin(),bridges.end());
   bridges.clear();
-  if ( ! o->requestLocality(&(bridge_array[0]),bridge_array.size()))
+  if ( ! o->request(&(bridge_array[0]),bridge_array.size()))
     return false;
   for (size_t i=0; i < bridge_array.size(); ++i)
   {
@@ -199,16 +242,21 @@ static void getSamplePoints(Patch* p)
   int nc = apf::countComponents(r->f);
   s->allocate(np,nc);
   std::size_t i = 0;
+  apf::MeshElement* me = 0;
   APF_ITERATE(EntitySet, p->elements, it) {
-    apf::MeshElement* me = apf::createMeshElement(r->mesh, *it);
+    if (me)
+      apf::rebindMeshElement(me, *it);
+    else
+      me = apf::createMeshElement(r->mesh, *it);
     for (int l = 0; l < r->points_per_element; ++l) {
       apf::Vector3 param;
       apf::getIntPoint(me, r->order, l, param);
       apf::mapLocalToGlobal(me, param, s->points[i]);
       ++i;
     }
-    apf::destroyMeshElement(me);
   }
+  if (me)
+    apf::destroyMeshElement(me);
 }
 
 static void getSampleValues(Patch* p)
@@ -281,76 +329,161 @@ static void evalPolynomialTerms(
   }
 }
 
-static bool preparePolynomialFit(
-    int dim,
-    int order,
-    int num_points,
-    apf::NewArray<apf::Vector3> const& points,
-    QRDecomp& qr)
+/* replaces the least squares fit of a patch, given the samples
+   relative to the patch center in key order, by the weights of
+   each sample value in each recovered nodal value. The nodal
+   values of all components then come from one product, and
+   the QR decomposition of A is only needed to build the weights:
+   with A = Q1 R1, node j gets t_j^T R1^-1 Q1^T b, so solving
+   R1^T u_j = t_j gives weights Q1 u_j */
+static bool computeFit(int dim, int order,
+    std::vector<apf::Vector3> const& points,
+    std::vector<apf::Vector3> const& nodes,
+    Fit& fit)
 {
-  unsigned m = num_points;
+  unsigned m = points.size();
   unsigned n = countPolynomialTerms(dim, order);
   PCU_ALWAYS_ASSERT(m >= n);
   mth::Matrix<double> A(m,n);
-  mth::Vector<double> p;
+  mth::Vector<double> t;
   for (unsigned i = 0; i < m; ++i) {
-    evalPolynomialTerms(dim, order, points[i], p);
-    for (unsigned j = 0; j < p.size(); ++j)
-      A(i,j) = p(j);
+    evalPolynomialTerms(dim, order, points[i], t);
+    for (unsigned j = 0; j < t.size(); ++j)
+      A(i,j) = t(j);
   }
-  unsigned rank = mth::decomposeQR(A, qr.Q, qr.R);
-  return rank == A.cols();
+  mth::Matrix<double> Q;
+  mth::Matrix<double> R;
+  fit.ok = (mth::decomposeQR(A, Q, R) == n);
+  if (!fit.ok)
+    return false;
+  fit.weights.assign(nodes.size() * m, 0);
+  std::vector<double> u(n);
+  for (size_t j = 0; j < nodes.size(); ++j) {
+    evalPolynomialTerms(dim, order, nodes[j], t);
+    for (unsigned i = 0; i < n; ++i) {
+      double sum = t(i);
+      for (unsigned k = 0; k < i; ++k)
+        sum -= R(k,i) * u[k];
+      u[i] = sum / R(i,i);
+    }
+    double* w = &fit.weights[j * m];
+    for (unsigned k = 0; k < m; ++k)
+      for (unsigned i = 0; i < n; ++i)
+        w[k] += Q(k,i) * u[i];
+  }
+  return true;
 }
 
-static void runPolynomialFit(QRDecomp const& qr,
-                             mth::Vector<double> const& values,
-                             mth::Vector<double>& coeffs)
-{
-  mth::solveFromQR(qr.Q, qr.R, values, coeffs);
-}
+/* sample positions relative to the patch size, rounded to this
+   many parts, so that congruent patches share a key */
+static double const keyResolution = 4294967296.0;
+/* fits kept at once, the cache restarts when it is full */
+static size_t const maxFits = 4096;
+
+struct SampleOrder {
+  SampleOrder(std::vector<long> const& k):key(k) {}
+  bool operator()(int a, int b) const
+  {
+    for (int i = 0; i < 3; ++i)
+      if (key[3 * a + i] != key[3 * b + i])
+        return key[3 * a + i] < key[3 * b + i];
+    return a < b;
+  }
+  std::vector<long> const& key;
+};
 
-static double evalPolynomial(int dim, int order, apf::Vector3& point,
-    mth::Vector<double>& coeffs)
+/* finds or computes the fit of the current samples. patches that
+   are translations of each other, as in structured regions,
+   share one fit through the cache of the recovery */
+static bool prepareFit(Patch* p)
 {
-  mth::Vector<double> terms;
-  evalPolynomialTerms(dim, order, point, terms);
-  return coeffs * terms;
+  Recovery* r = p->recovery;
+  apf::Mesh* m = r->mesh;
+  Samples* s = &p->samples;
+  int np = s->num_points;
+  apf::Vector3 center = apf::getLinearCentroid(m, p->entity);
+  int nn = m->getShape()->countNodesOn(m->getType(p->entity));
+  std::vector<apf::Vector3> points(np);
+  double radius = 0;
+  for (int i = 0; i < np; ++i) {
+    points[i] = s->points[i] - center;
+    radius = std::max(radius, points[i].getLength());
+  }
+  std::vector<apf::Vector3> nodes(nn);
+  for (int i = 0; i < nn; ++i) {
+    m->getPoint(p->entity, i, nodes[i]);
+    nodes[i] = nodes[i] - center;
+  }
+  std::vector<long> coords(3 * np);
+  for (int i = 0; i < np; ++i)
+    for (int j = 0; j < 3; ++j)
+      coords[3 * i + j] = lround(points[i][j] / radius * keyResolution);
+  p->order.resize(np);
+  for (int i = 0; i < np; ++i)
+    p->order[i] = i;
+  std::sort(p->order.begin(), p->order.end(), SampleOrder(coords));
+  int exponent;
+  double mantissa = frexp(radius, &exponent);
+  std::vector<long> key;
+  key.reserve(3 * (np + nn) + 2);
+  key.push_back(exponent);
+  key.push_back(lround(mantissa * keyResolution));
+  for (int i = 0; i < np; ++i)
+    for (int j = 0; j < 3; ++j)
+      key.push_back(coords[3 * p->order[i] + j]);
+  for (int i = 0; i < nn; ++i)
+    for (int j = 0; j < 3; ++j)
+      key.push_back(lround(nodes[i][j] / radius * keyResolution));
+  FitCache::iterator it = r->fits.find(key);
+  if (it != r->fits.end()) {
+    p->fit = &it->second;
+    return p->fit->ok;
+  }
+  if (r->fits.size() >= maxFits)
+    r->fits.clear();
+  Fit& fit = r->fits[key];
+  std::vector<apf::Vector3> ordered(np);
+  for (int i = 0; i < np; ++i)
+    ordered[i] = points[p->order[i]];
+  computeFit(r->dim, r->order, ordered, nodes, fit);
+  p->fit = &fit;
+  return fit.ok;
 }
 
 static bool prepareSpr(Patch* p)
 {
-  Recovery* r = p->recovery;
   getSamplePoints(p);
-  return preparePolynomialFit(r->dim, r->order, p->samples.num_points,
-      p->samples.points, p->qr);
+  return prepareFit(p);
 }
 
-static void runSpr(Patch* p)
+/* applies the fit of a prepared patch to its sample values and
+   sets the recovered values on its entity */
+static void fitSamples(Patch* p)
 {
   Recovery* r = p->recovery;
   apf::Mesh* m = r->mesh;
   Samples* s = &p->samples;
-  getSampleValues(p);
   int num_components = apf::countComponents(r->f_star);
   int num_nodes = m->getShape()->countNodesOn(m->getType(p->entity));
-  mth::Vector<double> values(s->num_points);
-  apf::NewArray<apf::Vector3> nodal_points(num_nodes);
-  apf::NewArray<apf::NewArray<double> > recovered_values(num_nodes);
-  for (int i = 0; i < num_nodes; ++i) {
-    recovered_values[i].allocate(num_components);
-    m->getPoint(p->entity, i, nodal_points[i]);
-  }
-  for (int i = 0; i < num_components; ++i) {
-    for (int j = 0; j < s->num_points; ++j)
-      values(j) = s->values[j][i];
-    mth::Vector<double> coeffs;
-    runPolynomialFit(p->qr, values, coeffs);
-    for (int j = 0; j < num_nodes; ++j)
-      recovered_values[j][i] = evalPolynomial(
-          r->dim, r->order, nodal_points[j], coeffs);
+  int np = s->num_points;
+  apf::NewArray<double> recovered(num_components);
+  for (int j = 0; j < num_nodes; ++j) {
+    double const* w = &p->fit->weights[j * np];
+    for (int i = 0; i < num_components; ++i)
+      recovered[i] = 0;
+    for (int k = 0; k < np; ++k) {
+      double const* v = &s->values[p->order[k]][0];
+      for (int i = 0; i < num_components; ++i)
+        recovered[i] += w[k] * v[i];
+    }
+    apf::setComponents(r->f_star, p->entity, j, &recovered[0]);
   }
-  for (int i = 0; i < num_nodes; ++i)
-    apf::setComponents(r->f_star, p->entity, i, &(recovered_values[i][0]));
+}
+
+static void runSpr(Patch* p)
+{
+  getSampleValues(p);
+  fitSamples(p);
 }
 
 static bool hasEnoughPoints(Patch* p)
@@ -363,7 +496,7 @@ static bool hasEnoughPoints(Patch* p)
   return prepareSpr(p);
 }
 
-static bool expandAsNecessary(Patch* p, apf::CavityOp* o)
+static bool expandAsNecessary(Patch* p, Locality* o)
 {
   if (hasEnoughPoints(p))
     return true;
@@ -386,14 +519,14 @@ static bool expandAsNecessary(Patch* p, apf::CavityOp* o)
   }
 }
 
-static bool buildPatch(Patch* p, apf::CavityOp* o)
+static bool buildPatch(Patch* p, Locality* o)
 {
   if (!getInitialPatch(p, o)) return false;
   if (!expandAsNecessary(p, o)) return false;
   return true;
 }
 
-class PatchOp : public apf::CavityOp
+class PatchOp : public apf::CavityOp, public Locality
 {
 public:
   PatchOp(Recovery* r):
@@ -401,6 +534,10 @@ public:
   {
     setupPatch(&patch, r);
   }
+  virtual bool request(apf::MeshEntity** entities, int count)
+  {
+    return requestLocality(entities, count);
+  }
   virtual Outcome setEntity(apf::MeshEntity* e)
   {
     if (hasEntity(patch.recovery->f_star, e))
@@ -417,14 +554,179 @@ public:
   Patch patch;
 };
 
+/* the samples of the elements around (e) on this part, as the
+   points then the values of each integration point */
+static void packSamples(Recovery* r, apf::MeshEntity* e, int to,
+    apf::MeshEntity* remote)
+{
+  apf::Adjacent elements;
+  r->mesh->getAdjacent(e, r->dim, elements);
+  int nc = apf::countComponents(r->f);
+  int n = elements.getSize();
+  PCU_COMM_PACK(to, remote);
+  PCU_COMM_PACK(to, n);
+  apf::NewArray<double> values(nc);
+  for (int i = 0; i < n; ++i) {
+    apf::MeshElement* me = apf::createMeshElement(r->mesh, elements[i]);
+    for (int l = 0; l < r->points_per_element; ++l) {
+      apf::Vector3 param;
+      apf::Vector3 point;
+      apf::getIntPoint(me, r->order, l, param);
+      apf::mapLocalToGlobal(me, param, point);
+      apf::getComponents(r->f, elements[i], l, &values[0]);
+      PCU_COMM_PACK(to, point);
+      PCU_Comm_Pack(to, &values[0], nc * sizeof(double));
+    }
+    apf::destroyMeshElement(me);
+  }
+}
+
+typedef std::map<apf::MeshEntity*, std::vector<double> > RemoteSamples;
+
+static void unpackSamples(Recovery* r, RemoteSamples& remote)
+{
+  int nc = apf::countComponents(r->f);
+  apf::MeshEntity* e;
+  PCU_COMM_UNPACK(e);
+  int n;
+  PCU_COMM_UNPACK(n);
+  std::vector<double>& samples = remote[e];
+  size_t at = samples.size();
+  samples.resize(at + (size_t)n * r->points_per_element * (3 + nc));
+  PCU_Comm_Unpack(&samples[at], (samples.size() - at) * sizeof(double));
+}
+
+/* the patch of a shared entity from the elements around it on
+   every part, which the parts holding copies sent to the owner */
+static bool fitSharedPatch(Patch* p, std::vector<double> const& remote)
+{
+  Recovery* r = p->recovery;
+  int nc = apf::countComponents(r->f);
+  int local = countPatchPoints(p);
+  int np = local + remote.size() / (3 + nc);
+  if (np < r->polynomial_terms)
+    return false;
+  getSamplePoints(p);
+  getSampleValues(p);
+  Samples* s = &p->samples;
+  Samples all;
+  all.allocate(np, nc);
+  for (int i = 0; i < local; ++i) {
+    all.points[i] = s->points[i];
+    for (int j = 0; j < nc; ++j)
+      all.values[i][j] = s->values[i][j];
+  }
+  double const* x = remote.empty() ? 0 : &remote[0];
+  for (int i = local; i < np; ++i) {
+    all.points[i] = apf::Vector3(x[0], x[1], x[2]);
+    for (int j = 0; j < nc; ++j)
+      all.values[i][j] = x[3 + j];
+    x += 3 + nc;
+  }
+  s->allocate(np, nc);
+  for (int i = 0; i < np; ++i) {
+    s->points[i] = all.points[i];
+    for (int j = 0; j < nc; ++j)
+      s->values[i][j] = all.values[i][j];
+  }
+  if (!prepareFit(p))
+    return false;
+  fitSamples(p);
+  return true;
+}
+
+static void sendRecovered(Recovery* r, apf::MeshEntity* e)
+{
+  int nc = apf::countComponents(r->f_star);
+  int nn = r->mesh->getShape()->countNodesOn(r->mesh->getType(e));
+  apf::NewArray<double> values(nc * nn);
+  for (int i = 0; i < nn; ++i)
+    apf::getComponents(r->f_star, e, i, &values[i * nc]);
+  apf::Copies remotes;
+  r->mesh->getRemotes(e, remotes);
+  APF_ITERATE(apf::Copies, remotes, it) {
+    PCU_COMM_PACK(it->first, it->second);
+    PCU_Comm_Pack(it->first, &values[0], nc * nn * sizeof(double));
+  }
+}
+
+static void receiveRecovered(Recovery* r)
+{
+  int nc = apf::countComponents(r->f_star);
+  apf::MeshEntity* e;
+  PCU_COMM_UNPACK(e);
+  int nn = r->mesh->getShape()->countNodesOn(r->mesh->getType(e));
+  apf::NewArray<double> values(nc * nn);
+  PCU_Comm_Unpack(&values[0], nc * nn * sizeof(double));
+  for (int i = 0; i < nn; ++i)
+    apf::setComponents(r->f_star, e, i, &values[i * nc]);
+}
+
+/* recovers the entities of dimension (d) whose first patch is
+   complete without migration: unshared entities whose patch stays
+   away from the part boundary, and shared entities whose elements
+   on all parts suffice, gathered at the owner like one ghost layer.
+   Whatever is left goes to the patch operator, which pulls. */
+static void recoverDimension(Recovery* r, PatchOp& op, int d)
+{
+  apf::Mesh* m = r->mesh;
+  Patch* p = &op.patch;
+  PartLocality locality(m);
+  std::vector<apf::MeshEntity*> shared;
+  PCU_Comm_Begin();
+  apf::MeshIterator* it = m->begin(d);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    if (m->isShared(e)) {
+      if (m->isOwned(e)) {
+        shared.push_back(e);
+        continue;
+      }
+      int owner = m->getOwner(e);
+      apf::Copies remotes;
+      m->getRemotes(e, remotes);
+      packSamples(r, e, owner, remotes[owner]);
+      continue;
+    }
+    startPatch(p, e);
+    if (buildPatch(p, &locality))
+      runSpr(p);
+  }
+  m->end(it);
+  PCU_Comm_Send();
+  RemoteSamples remote;
+  while (PCU_Comm_Receive())
+    unpackSamples(r, remote);
+  PCU_Comm_Begin();
+  for (size_t i = 0; i < shared.size(); ++i) {
+    startPatch(p, shared[i]);
+    apf::Adjacent elements;
+    m->getAdjacent(shared[i], r->dim, elements);
+    addElementsToPatch(p, elements);
+    if (fitSharedPatch(p, remote[shared[i]]))
+      sendRecovered(r, shared[i]);
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive())
+    receiveRecovered(r);
+  std::vector<apf::MeshEntity*> left;
+  it = m->begin(d);
+  while ((e = m->iterate(it)))
+    if (!apf::hasEntity(r->f_star, e))
+      left.push_back(e);
+  m->end(it);
+  op.applyToList(d, left);
+}
+
 apf::Field* recoverField(apf::Field* f)
 {
+  PCU_Region region("spr::recoverField");
   Recovery recovery;
   setupRecovery(&recovery, f);
   PatchOp op(&recovery);
   for (int d = 0; d <= 3; ++d)
     if (recovery.mesh->getShape()->hasNodesIn(d))
-      op.applyToDimension(d);
+      recoverDimension(&recovery, op, d);
   return recovery.f_star;
 }
 
@@ -0,0 +1,479 @@
+/*
+ * Copyright 2015 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include <apf_stkConfig.h>
+#include "apfExodus.h"
+#include <apfShape.h>
+#include <gmi.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <exodusII.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+
+namespace apf {
+
+struct ExodusBlock
+{
+  int64_t id;
+  std::vector<MeshEntity*> elements;
+  /* this rank's first element in the file block */
+  int64_t start;
+};
+
+struct ExodusFile
+{
+  Mesh* mesh;
+  int id;
+  /* all ranks write one file together */
+  bool shared;
+  int step;
+  /* the nodes this rank writes, in file order from nodeStart */
+  std::vector<Node> nodes;
+  int64_t nodeStart;
+  std::vector<ExodusBlock> blocks;
+  std::vector<Field*> nodalFields;
+  std::vector<Field*> elementFields;
+};
+
+static void check(int status, const char* call)
+{
+  if (status < 0) {
+    fprintf(stderr, "apf::ExodusFile: %s failed with error %d\n",
+        call, status);
+    abort();
+  }
+}
+
+/* this rank's first entry and the total entries of an object
+   that each rank holds (count) entries of */
+static void place(bool shared, int64_t count, int64_t& start, int64_t& total)
+{
+  if (shared) {
+    start = PCU_Exscan_Long(count);
+    total = PCU_Add_Long(count);
+  } else {
+    start = 0;
+    total = count;
+  }
+}
+
+static int openFile(ExodusFile* f, const char* filename)
+{
+  int mode = EX_CLOBBER | EX_ALL_INT64_API | EX_ALL_INT64_DB;
+  int cpuWordSize = sizeof(double);
+  int ioWordSize = sizeof(double);
+  int peers = PCU_Comm_Peers();
+  f->shared = (peers == 1);
+#ifdef PARALLEL_AWARE_EXODUS
+  if (peers > 1) {
+    f->shared = true;
+    return ex_create_par(filename, mode | EX_NETCDF4,
+        &cpuWordSize, &ioWordSize, PCU_Get_Comm(), MPI_INFO_NULL);
+  }
+#endif
+  if (f->shared)
+    return ex_create(filename, mode, &cpuWordSize, &ioWordSize);
+  std::stringstream digits;
+  digits << peers;
+  std::stringstream name;
+  name << filename << '.' << peers << '.'
+       << std::setw(digits.str().size()) << std::setfill('0')
+       << PCU_Comm_Self();
+  return ex_create(name.str().c_str(), mode, &cpuWordSize, &ioWordSize);
+}
+
+static char* const* getNames(std::vector<std::string> const& from,
+    std::vector<char*>& to)
+{
+  to.resize(from.size());
+  for (size_t i = 0; i < from.size(); ++i)
+    to[i] = const_cast<char*>(from[i].c_str());
+  return to.empty() ? 0 : &to[0];
+}
+
+static void putNames(int id, ex_entity_type type, StkModels::Vector& models)
+{
+  if (models.empty())
+    return;
+  std::vector<std::string> names;
+  for (size_t i = 0; i < models.size(); ++i)
+    names.push_back(models[i]->stkName);
+  std::vector<char*> p;
+  check(ex_put_names(id, type, const_cast<char**>(getNames(names, p))),
+      "ex_put_names");
+}
+
+/* follows getTopology, which assumes serendipity quadratic
+   quadrilaterals and hexahedra */
+static const char* getExodusType(Mesh* m, int type)
+{
+  static const char* const linear[Mesh::TYPES] =
+  {"SPHERE","BAR2","TRI3","QUAD4","TETRA4","HEX8","WEDGE6","PYRAMID5"};
+  static const char* const quadratic[Mesh::TYPES] =
+  {"SPHERE","BAR3","TRI6","QUAD8","TETRA10","HEX20","WEDGE15","PYRAMID13"};
+  if (m->getShape()->getOrder() == 1)
+    return linear[type];
+  return quadratic[type];
+}
+
+/* returns the number of nodes in the file */
+static int64_t collectNodes(ExodusFile* f, GlobalNumbering* global,
+    Numbering* local)
+{
+  Mesh* m = f->mesh;
+  DynamicArray<Node> all;
+  getNodes(global, all);
+  int64_t total;
+  if (f->shared) {
+    std::vector<Node> owned;
+    for (size_t i = 0; i < all.getSize(); ++i)
+      if (m->isOwned(all[i].entity))
+        owned.push_back(all[i]);
+    place(true, owned.size(), f->nodeStart, total);
+    f->nodes.resize(owned.size());
+    for (size_t i = 0; i < owned.size(); ++i)
+      f->nodes[getNumber(global, owned[i]) - f->nodeStart] = owned[i];
+  } else {
+    f->nodes.resize(all.getSize());
+    for (size_t i = 0; i < all.getSize(); ++i)
+      f->nodes[getNumber(local, all[i].entity, all[i].node, 0)] = all[i];
+    place(false, f->nodes.size(), f->nodeStart, total);
+  }
+  return total;
+}
+
+static void writeNodes(ExodusFile* f, GlobalNumbering* global)
+{
+  Mesh* m = f->mesh;
+  size_t n = f->nodes.size();
+  std::vector<double> x(n), y(n), z(n);
+  std::vector<int64_t> ids(n);
+  for (size_t i = 0; i < n; ++i) {
+    Vector3 p;
+    m->getPoint(f->nodes[i].entity, f->nodes[i].node, p);
+    x[i] = p[0];
+    y[i] = p[1];
+    z[i] = p[2];
+    ids[i] = getNumber(global, f->nodes[i]) + 1;
+  }
+  check(ex_put_partial_coord(f->id, f->nodeStart + 1, n,
+        x.data(), y.data(), z.data()), "ex_put_partial_coord");
+  if (!f->shared)
+    check(ex_put_partial_id_map(f->id, EX_NODE_MAP, 1, n, ids.data()),
+        "ex_put_partial_id_map");
+}
+
+static int64_t getFileNode(ExodusFile* f, GlobalNumbering* global,
+    Numbering* local, Node n)
+{
+  if (f->shared)
+    return getNumber(global, n) + 1;
+  return getNumber(local, n.entity, n.node, 0) + 1;
+}
+
+/* elements go block by block, and within a block rank by rank
+   when the file is shared. the file position of each element is
+   left in (position) for the side sets */
+static void writeElements(ExodusFile* f, StkModels& models,
+    GlobalNumbering* global, Numbering* local, MeshTag* position)
+{
+  Mesh* m = f->mesh;
+  int d = m->getDimension();
+  StkModels::Vector& sets = models.models[d];
+  int nodesPerElement = getCellTopology(m)->node_count;
+  const char* type = getExodusType(m, getFirstType(m, d));
+  std::vector<int64_t> ids;
+  int64_t globalEnd = 0;
+  int64_t fileEnd = 0;
+  for (size_t b = 0; b < f->blocks.size(); ++b) {
+    ExodusBlock& block = f->blocks[b];
+    int64_t count = block.elements.size();
+    int64_t globalStart, globalTotal, total;
+    place(true, count, globalStart, globalTotal);
+    place(f->shared, count, block.start, total);
+    check(ex_put_block(f->id, EX_ELEM_BLOCK, block.id, type,
+          total, nodesPerElement, 0, 0, 0), "ex_put_block");
+    std::vector<int64_t> conn(count * nodesPerElement);
+    NewArray<long> numbers;
+    NewArray<int> localNumbers;
+    for (int64_t i = 0; i < count; ++i) {
+      MeshEntity* e = block.elements[i];
+      int n = getElementNumbers(global, e, numbers);
+      PCU_ALWAYS_ASSERT(n == nodesPerElement);
+      if (!f->shared)
+        getElementNumbers(local, e, localNumbers);
+      for (int j = 0; j < n; ++j)
+        conn[i * n + j] = f->shared ? numbers[j] + 1 : localNumbers[j] + 1;
+      long p = fileEnd + block.start + i + 1;
+      m->setLongTag(e, position, &p);
+      ids.push_back(globalEnd + globalStart + i + 1);
+    }
+    check(ex_put_partial_conn(f->id, EX_ELEM_BLOCK, block.id,
+          block.start + 1, count, conn.data(), 0, 0), "ex_put_partial_conn");
+    globalEnd += globalTotal;
+    fileEnd += total;
+  }
+  putNames(f->id, EX_ELEM_BLOCK, sets);
+  if (!f->shared)
+    check(ex_put_partial_id_map(f->id, EX_ELEM_MAP, 1, ids.size(),
+          ids.data()), "ex_put_partial_id_map");
+}
+
+static void writeNodeSets(ExodusFile* f, StkModels& models,
+    GlobalNumbering* global, Numbering* local)
+{
+  Mesh* m = f->mesh;
+  StkModels::Vector& sets = models.models[0];
+  std::map<StkModel*, size_t> index;
+  for (size_t i = 0; i < sets.size(); ++i)
+    index[sets[i]] = i;
+  std::vector<std::vector<int64_t> > entries(sets.size());
+  typedef std::map<ModelEntity*, std::set<StkModel*> > ModelSets;
+  ModelSets modelSets;
+  for (size_t i = 0; i < f->nodes.size(); ++i) {
+    Node n = f->nodes[i];
+    ModelEntity* me = m->toModel(n.entity);
+    if (!modelSets.count(me))
+      collectEntityModels(m, models.invMaps[0], me, modelSets[me]);
+    std::set<StkModel*>& in = modelSets[me];
+    APF_ITERATE(std::set<StkModel*>, in, it)
+      entries[index[*it]].push_back(getFileNode(f, global, local, n));
+  }
+  for (size_t i = 0; i < sets.size(); ++i) {
+    int64_t start, total;
+    place(f->shared, entries[i].size(), start, total);
+    check(ex_put_set_param(f->id, EX_NODE_SET, i + 1, total, 0),
+        "ex_put_set_param");
+    check(ex_put_partial_set(f->id, EX_NODE_SET, i + 1, start + 1,
+          entries[i].size(), entries[i].data(), 0), "ex_put_partial_set");
+  }
+  putNames(f->id, EX_NODE_SET, sets);
+}
+
+/* sides are written by their owners, as the element and side
+   pair of the element on the side's first upward adjacency */
+static void writeSideSets(ExodusFile* f, StkModels& models,
+    MeshTag* position)
+{
+  Mesh* m = f->mesh;
+  int d = m->getDimension() - 1;
+  StkModels::Vector& sets = models.models[d];
+  std::map<StkModel*, size_t> index;
+  for (size_t i = 0; i < sets.size(); ++i)
+    index[sets[i]] = i;
+  std::vector<std::vector<int64_t> > elements(sets.size());
+  std::vector<std::vector<int64_t> > sides(sets.size());
+  MeshIterator* it = m->begin(d);
+  MeshEntity* s;
+  while ((s = m->iterate(it))) {
+    ModelEntity* me = m->toModel(s);
+    if (!models.invMaps[d].count(me))
+      continue;
+    if (f->shared && !m->isOwned(s))
+      continue;
+    MeshEntity* e = m->getUpward(s, 0);
+    if (!e || !m->hasTag(e, position))
+      continue;
+    size_t i = index[models.invMaps[d][me]];
+    long p;
+    m->getLongTag(e, position, &p);
+    elements[i].push_back(p);
+    sides[i].push_back(getLocalSideId(m, e, s) + 1);
+  }
+  m->end(it);
+  for (size_t i = 0; i < sets.size(); ++i) {
+    int64_t start, total;
+    place(f->shared, elements[i].size(), start, total);
+    check(ex_put_set_param(f->id, EX_SIDE_SET, i + 1, total, 0),
+        "ex_put_set_param");
+    check(ex_put_partial_set(f->id, EX_SIDE_SET, i + 1, start + 1,
+          elements[i].size(), elements[i].data(), sides[i].data()),
+        "ex_put_partial_set");
+  }
+  putNames(f->id, EX_SIDE_SET, sets);
+}
+
+static int countElementNodes(Mesh* m, Field* f)
+{
+  return getShape(f)->countNodesOn(getFirstType(m, m->getDimension()));
+}
+
+static void addNames(Field* f, int nodes, std::vector<std::string>& names)
+{
+  static const char* const vector[3] = {"_x","_y","_z"};
+  static const char* const matrix[9] =
+  {"_xx","_xy","_xz","_yx","_yy","_yz","_zx","_zy","_zz"};
+  int nc = countComponents(f);
+  for (int i = 0; i < nodes; ++i)
+    for (int j = 0; j < nc; ++j) {
+      std::stringstream name;
+      name << getName(f);
+      if (getValueType(f) == VECTOR)
+        name << vector[j];
+      else if (getValueType(f) == MATRIX)
+        name << matrix[j];
+      else if (nc > 1)
+        name << '_' << j;
+      if (nodes > 1)
+        name << '_' << i;
+      names.push_back(name.str());
+    }
+}
+
+static void defineVariables(ExodusFile* f)
+{
+  Mesh* m = f->mesh;
+  int d = m->getDimension();
+  std::vector<std::string> nodal;
+  std::vector<std::string> element;
+  for (int i = 0; i < m->countFields(); ++i) {
+    Field* field = m->getField(i);
+    FieldShape* shape = getShape(field);
+    bool inside = shape->hasNodesIn(d);
+    for (int j = 0; j < d; ++j)
+      if (shape->hasNodesIn(j))
+        inside = false;
+    if (shape == m->getShape()) {
+      f->nodalFields.push_back(field);
+      addNames(field, 1, nodal);
+    } else if (inside) {
+      f->elementFields.push_back(field);
+      addNames(field, countElementNodes(m, field), element);
+    }
+  }
+  std::vector<char*> p;
+  if (!nodal.empty()) {
+    check(ex_put_variable_param(f->id, EX_NODAL, nodal.size()),
+        "ex_put_variable_param");
+    check(ex_put_variable_names(f->id, EX_NODAL, nodal.size(),
+          const_cast<char**>(getNames(nodal, p))), "ex_put_variable_names");
+  }
+  if (!element.empty() && !f->blocks.empty()) {
+    check(ex_put_variable_param(f->id, EX_ELEM_BLOCK, element.size()),
+        "ex_put_variable_param");
+    check(ex_put_variable_names(f->id, EX_ELEM_BLOCK, element.size(),
+          const_cast<char**>(getNames(element, p))), "ex_put_variable_names");
+    std::vector<int> table(f->blocks.size() * element.size(), 1);
+    check(ex_put_truth_table(f->id, EX_ELEM_BLOCK, f->blocks.size(),
+          element.size(), table.data()), "ex_put_truth_table");
+  }
+}
+
+ExodusFile* createExodusFile(
+    Mesh* m,
+    StkModels& models,
+    const char* filename)
+{
+  ExodusFile* f = new ExodusFile();
+  f->mesh = m;
+  f->step = 0;
+  f->id = openFile(f, filename);
+  check(f->id, "ex_create");
+  int d = m->getDimension();
+  GlobalNumbering* global = numberGlobalNodes(m, "exodus_node");
+  Numbering* local = 0;
+  if (!f->shared)
+    local = numberOverlapNodes(m, "exodus_local_node");
+  StkModels::Vector& blockSets = models.models[d];
+  f->blocks.resize(blockSets.size());
+  std::map<StkModel*, size_t> index;
+  for (size_t i = 0; i < blockSets.size(); ++i) {
+    index[blockSets[i]] = i;
+    f->blocks[i].id = i + 1;
+  }
+  MeshIterator* it = m->begin(d);
+  MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    ModelEntity* me = m->toModel(e);
+    if (models.invMaps[d].count(me))
+      f->blocks[index[models.invMaps[d][me]]].elements.push_back(e);
+  }
+  m->end(it);
+  int64_t nodes = collectNodes(f, global, local);
+  int64_t elements = 0;
+  for (size_t i = 0; i < f->blocks.size(); ++i)
+    elements += f->blocks[i].elements.size();
+  if (f->shared)
+    elements = PCU_Add_Long(elements);
+  check(ex_put_init(f->id, "apf", d, nodes, elements, f->blocks.size(),
+        models.models[0].size(), models.models[d - 1].size()), "ex_put_init");
+  static const char* const coordNames[3] = {"x","y","z"};
+  check(ex_put_coord_names(f->id, const_cast<char**>(coordNames)),
+      "ex_put_coord_names");
+  writeNodes(f, global);
+  MeshTag* position = m->createLongTag("exodus_element", 1);
+  writeElements(f, models, global, local, position);
+  writeNodeSets(f, models, global, local);
+  writeSideSets(f, models, position);
+  defineVariables(f);
+  apf::removeTagFromDimension(m, position, d);
+  m->destroyTag(position);
+  destroyGlobalNumbering(global);
+  if (local)
+    destroyNumbering(local);
+  check(ex_update(f->id), "ex_update");
+  return f;
+}
+
+void writeExodusStep(ExodusFile* f, double time)
+{
+  ++f->step;
+  check(ex_put_time(f->id, f->step, &time), "ex_put_time");
+  int var = 0;
+  size_t n = f->nodes.size();
+  for (size_t i = 0; i < f->nodalFields.size(); ++i) {
+    Field* field = f->nodalFields[i];
+    int nc = countComponents(field);
+    std::vector<double> values(nc * n);
+    NewArray<double> c(nc);
+    for (size_t j = 0; j < n; ++j) {
+      getComponents(field, f->nodes[j].entity, f->nodes[j].node, &c[0]);
+      for (int k = 0; k < nc; ++k)
+        values[k * n + j] = c[k];
+    }
+    for (int k = 0; k < nc; ++k)
+      check(ex_put_partial_var(f->id, f->step, EX_NODAL, ++var, 1,
+            f->nodeStart + 1, n, &values[k * n]), "ex_put_partial_var");
+  }
+  var = 0;
+  for (size_t i = 0; i < f->elementFields.size(); ++i) {
+    Field* field = f->elementFields[i];
+    int nc = countComponents(field);
+    int nn = countElementNodes(f->mesh, field);
+    NewArray<double> c(nc);
+    for (size_t b = 0; b < f->blocks.size(); ++b) {
+      ExodusBlock& block = f->blocks[b];
+      size_t count = block.elements.size();
+      std::vector<double> values(nn * nc * count);
+      for (size_t j = 0; j < count; ++j)
+        for (int k = 0; k < nn; ++k) {
+          getComponents(field, block.elements[j], k, &c[0]);
+          for (int l = 0; l < nc; ++l)
+            values[(k * nc + l) * count + j] = c[l];
+        }
+      for (int k = 0; k < nn * nc; ++k)
+        check(ex_put_partial_var(f->id, f->step, EX_ELEM_BLOCK, var + k + 1,
+              block.id, block.start + 1, count, values.data() + k * count),
+            "ex_put_partial_var");
+    }
+    var += nn * nc;
+  }
+  check(ex_update(f->id), "ex_update");
+}
+
+void closeExodusFile(ExodusFile* f)
+{
+  check(ex_close(f->id), "ex_close");
+  delete f;
+}
+
+}
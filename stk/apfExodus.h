@@ -0,0 +1,39 @@
+/*
+ * Copyright 2015 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef APF_EXODUS_H
+#define APF_EXODUS_H
+
+#include "apfAlbany.h"
+
+namespace apf {
+
+/* an Exodus II file written straight from an apf mesh, with no
+   STK mesh in between */
+struct ExodusFile;
+
+/* writes the coordinates, one element block per element set of
+   (models), and the node and side sets found by classification.
+   nodal fields are those with the coordinate shape and element
+   fields those with nodes only inside elements; vector and matrix
+   values are split into components.
+   when exodus is built with parallel io all ranks write their
+   pieces of one file collectively, otherwise each rank writes
+   filename.N.r in the layout epu joins */
+ExodusFile* createExodusFile(
+    Mesh* m,
+    StkModels& models,
+    const char* filename);
+
+/* appends a time step with the current field values */
+void writeExodusStep(ExodusFile* file, double time);
+
+void closeExodusFile(ExodusFile* file);
+
+}
+
+#endif
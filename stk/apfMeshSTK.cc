@@ -145,6 +145,8 @@ static void buildElements(
     StkModel* model = *mit;
     tmpMap[model] = meta->get_part(model->stkName, required_by);
   }
+  NewArray<long> node_ids;
+  std::vector<stk::mesh::EntityId> stk_node_ids;
   MeshIterator* it = m->begin(d);
   MeshEntity* e;
   while ((e = m->iterate(it))) {
@@ -158,9 +160,8 @@ static void buildElements(
     StkModel* model = models.invMaps[d][me];
     stk::mesh::Part* part = tmpMap[model];
     stk::mesh::EntityId e_id = getStkId(n[d], Node(e, 0));
-    NewArray<long> node_ids;
     int nodes = getElementNumbers(n[0], e, node_ids);
-    std::vector<stk::mesh::EntityId> stk_node_ids(nodes);
+    stk_node_ids.resize(nodes);
     for (int j = 0; j < nodes; ++j)
       stk_node_ids[j] = node_ids[j] + 1;
     stk::mesh::declare_element(*bulk, *part, e_id, stk_node_ids);
@@ -168,6 +169,9 @@ static void buildElements(
   m->end(it);
 }
 
+/* nodes on the same model entity belong to the same parts,
+   so the parts are found once per model entity and the nodes
+   are declared straight from that table */
 static void buildNodes(
     GlobalNumbering* nn,
     StkModels& models,
@@ -182,20 +186,24 @@ static void buildNodes(
     StkModel* model = *mit;
     tmpMap[model] = meta->get_part(model->stkName, required_by);
   }
+  typedef std::map<ModelEntity*, stk::mesh::PartVector> ModelParts;
+  ModelParts modelParts;
   DynamicArray<Node> nodes;
   apf::getNodes(nn, nodes);
   APF_ITERATE(DynamicArray<Node>, nodes, nit) {
     Node n = *nit;
     MeshEntity* e = n.entity;
     ModelEntity* me = m->toModel(e);
-    std::set<StkModel*> mset;
-    collectEntityModels(m, models.invMaps[d], me, mset);
-    stk::mesh::PartVector parts;
-    parts.reserve(mset.size());
-    APF_ITERATE(std::set<StkModel*>, mset, mit)
-      parts.push_back(tmpMap[*mit]);
+    if (!modelParts.count(me)) {
+      std::set<StkModel*> mset;
+      collectEntityModels(m, models.invMaps[d], me, mset);
+      stk::mesh::PartVector& parts = modelParts[me];
+      parts.reserve(mset.size());
+      APF_ITERATE(std::set<StkModel*>, mset, mit)
+        parts.push_back(tmpMap[*mit]);
+    }
     stk::mesh::EntityId e_id = getStkId(nn, n);
-    bulk->declare_entity(stk::topology::NODE_RANK, e_id, parts);
+    bulk->declare_entity(stk::topology::NODE_RANK, e_id, modelParts[me]);
   }
 }
 
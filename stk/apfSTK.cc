@@ -222,261 +222,47 @@ static Node lookup(long id, GlobalMap& map)
   return map[id];
 }
 
-void writeStkField(
-    Field* field,
-    StkScalarField& stkField,
-    StkBucket& bucket,
-    GlobalMap& globalIdsToNodes)
-{
-  StkBulkData& bulk = bucket.mesh();
-  double* data = stk::mesh::field_data(stkField, bucket);
-  size_t nodesInBucket = bucket.size();
-  for (size_t i=0; i < nodesInBucket; ++i)
-  {
-    long globalId = bulk.identifier(bucket[i]);
-    Node node = lookup(globalId,globalIdsToNodes);
-    data[i] = getScalar(field, node.entity, node.node);
-  }
-}
-
-void writeStkField(
-    Field* field,
-    StkVectorField& stkField,
-    StkBucket& bucket,
-    GlobalMap& globalIdsToNodes)
-{
-  StkBulkData& bulk = bucket.mesh();
-  double* data = stk::mesh::field_data(stkField, bucket);
-  size_t nodesInBucket = bucket.size();
-  for (size_t i=0; i < nodesInBucket; ++i)
-  {
-    long globalId = bulk.identifier(bucket[i]);
-    Node node = lookup(globalId,globalIdsToNodes);
-    Vector3 value;
-    getVector(field, node.entity, node.node, value);
-    for (size_t j=0; j < 3; ++j)
-      data[3*i + j] = value[j];
-  }
-}
-
-void writeStkField(
-    Field* field,
-    StkTensorField& stkField,
-    StkBucket& bucket,
-    GlobalMap& globalIdsToNodes)
-{
-  StkBulkData& bulk = bucket.mesh();
-  double* data = stk::mesh::field_data(stkField, bucket);
-  size_t nodesInBucket = bucket.size();
-  for (size_t i=0; i < nodesInBucket; ++i)
-  {
-    long globalId = bulk.identifier(bucket[i]);
-    Node node = lookup(globalId,globalIdsToNodes);
-    Matrix3x3 value;
-    getMatrix(field, node.entity, node.node, value);
-    for (size_t j=0; j < 3; ++j)
-    for (size_t k=0; k < 3; ++k)
-      data[9*i + 3*j + k] = value[j][k];
-  }
-}
-
-void writeStkField(
-    Field* field,
-    StkQPScalarField& stkField,
-    StkBucket& bucket,
-    GlobalMap& globalIdsToElems)
-{
-  StkBulkData& bulk = bucket.mesh();
-  double* data = stk::mesh::field_data(stkField, bucket);
-  size_t nqp = stk::mesh::find_restriction(
-      stkField, bucket.entity_rank(), bucket.supersets()).dimension();
-  size_t elemsInBucket = bucket.size();
-  for (size_t i=0; i < elemsInBucket; ++i)
-  {
-    long globalId = bulk.identifier(bucket[i]);
-    MeshEntity* elem = lookup(globalId,globalIdsToElems).entity;
-    for (size_t j=0; j < nqp; ++j)
-      data[nqp*i + j] = getScalar(field,elem,j);
-  }
-}
-
-void writeStkField(
-    Field* field,
-    StkQPVectorField& stkField,
-    StkBucket& bucket,
-    GlobalMap& globalIdsToElems)
-{
-  StkBulkData& bulk = bucket.mesh();
-  double* data = stk::mesh::field_data(stkField, bucket);
-  size_t nqp = stk::mesh::find_restriction(
-      stkField, bucket.entity_rank(), bucket.supersets()).dimension();
-  size_t elemsInBucket = bucket.size();
-  for (size_t i=0; i < elemsInBucket; ++i)
-  {
-    long globalId = bulk.identifier(bucket[i]);
-    MeshEntity* elem = lookup(globalId,globalIdsToElems).entity;
-    Vector3 value;
-    for (size_t j=0; j < nqp; ++j)
-    {
-      getVector(field,elem,j,value);
-      for (size_t k=0; k < 3; ++k)
-        data[nqp*3*i + 3*j + k] = value[k];
-    }
-  }
-}
-
-void writeStkField(
-    Field* field,
-    StkQPTensorField& stkField,
-    StkBucket& bucket,
-    GlobalMap& globalIdsToElems)
-{
-  StkBulkData& bulk = bucket.mesh();
-  double* data = stk::mesh::field_data(stkField, bucket);
-  size_t nqp = stk::mesh::find_restriction(
-      stkField, bucket.entity_rank(), bucket.supersets()).dimension();
-  size_t elemsInBucket = bucket.size();
-  for (size_t i=0; i < elemsInBucket; ++i)
-  {
-    long globalId = bulk.identifier(bucket[i]);
-    MeshEntity* elem = lookup(globalId,globalIdsToElems).entity;
-    Matrix3x3 value;
-    for (size_t j=0; j < nqp; ++j)
-    {
-      getMatrix(field,elem,j,value);
-      for (int k=0; k < 3; ++k)
-      for (int l=0; l < 3; ++l)
-        data[nqp*9*i + 9*j + 3*k + l] = value[k][l];
-    }
-  }
-}
-
-void readStkField(
-    Field* field,
-    StkScalarField& stkField,
-    StkBucket& bucket,
-    GlobalMap& globalIdsToNodes)
-{
-  StkBulkData& bulk = bucket.mesh();
-  double* data = stk::mesh::field_data(stkField, bucket);
-  size_t nodesInBucket = bucket.size();
-  for (size_t i=0; i < nodesInBucket; ++i)
-  {
-    long globalId = bulk.identifier(bucket[i]);
-    Node node = lookup(globalId,globalIdsToNodes);
-    setScalar(field, node.entity, node.node, data[i]);
-  }
-}
-
-void readStkField(
-    Field* field,
-    StkVectorField& stkField,
-    StkBucket& bucket,
-    GlobalMap& globalIdsToNodes)
-{
-  StkBulkData& bulk = bucket.mesh();
-  double* data = stk::mesh::field_data(stkField, bucket);
-  size_t nodesInBucket = bucket.size();
-  for (size_t i=0; i < nodesInBucket; ++i)
-  {
-    long globalId = bulk.identifier(bucket[i]);
-    Node node = lookup(globalId,globalIdsToNodes);
-    Vector3 value;
-    for (size_t j=0; j < 3; ++j)
-      value[j] = data[3*i + j];
-    setVector(field, node.entity, node.node, value);
-  }
-}
-
-void readStkField(
-    Field* field,
-    StkTensorField& stkField,
-    StkBucket& bucket,
-    GlobalMap& globalIdsToNodes)
-{
-  StkBulkData& bulk = bucket.mesh();
-  double* data = stk::mesh::field_data(stkField, bucket);
-  size_t nodesInBucket = bucket.size();
-  for (size_t i=0; i < nodesInBucket; ++i)
-  {
-    long globalId = bulk.identifier(bucket[i]);
-    Node node = lookup(globalId,globalIdsToNodes);
-    Matrix3x3 value;
-    for (size_t j=0; j < 3; ++j)
-    for (size_t k=0; k < 3; ++k)
-      value[j][k] = data[9*i + 3*j + k];
-    setMatrix(field, node.entity, node.node, value);
-  }
-}
-
-void readStkField(
-    Field* field,
-    StkQPScalarField& stkField,
-    StkBucket& bucket,
-    GlobalMap& globalIdsToElems)
-{
-  StkBulkData& bulk = bucket.mesh();
-  double* data = stk::mesh::field_data(stkField, bucket);
-  size_t nqp = stk::mesh::find_restriction(
-      stkField, bucket.entity_rank(), bucket.supersets()).dimension();
-  size_t elemsInBucket = bucket.size();
-  for (size_t i=0; i < elemsInBucket; ++i)
-  {
-    long globalId = bulk.identifier(bucket[i]);
-    MeshEntity* elem = lookup(globalId,globalIdsToElems).entity;
-    for (size_t j=0; j < nqp; ++j)
-      setScalar(field, elem, j, data[nqp*i + j]);
-  }
-}
+/* the stk buckets of one rank holding owned and shared entities
+   and, aligned with their entries, the apf node behind each one */
+struct StkRankMap
+{
+  stk::mesh::BucketVector buckets;
+  std::vector<size_t> offsets;
+  std::vector<Node> ents;
+};
 
-void readStkField(
-    Field* field,
-    StkQPVectorField& stkField,
-    StkBucket& bucket,
-    GlobalMap& globalIdsToElems)
-{
-  StkBulkData& bulk = bucket.mesh();
-  double* data = stk::mesh::field_data(stkField, bucket);
-  size_t nqp = stk::mesh::find_restriction(
-      stkField, bucket.entity_rank(), bucket.supersets()).dimension();
-  size_t elemsInBucket = bucket.size();
-  for (size_t i=0; i < elemsInBucket; ++i)
-  {
-    long globalId = bulk.identifier(bucket[i]);
-    MeshEntity* elem = lookup(globalId,globalIdsToElems).entity;
-    Vector3 value;
-    for (size_t j=0; j < nqp; ++j)
-    {
-      for (size_t k=0; k < 3; ++k)
-        value[k] = data[nqp*3*i + 3*j + k];
-      setVector(field,elem,j,value);
-    }
-  }
-}
+struct StkFieldMap
+{
+  Mesh* mesh;
+  unsigned long changes;
+  /* nodes, then elements */
+  StkRankMap ranks[2];
+};
 
-void readStkField(
+/* copies one bucket of a stk field to or from the apf field.
+   stk keeps the values of each entity contiguous in apf component
+   order, nodal fields one node per entity and qp fields all the
+   element's nodes, so each apf node is a single block copy */
+static void transferBucket(
     Field* field,
-    StkQPTensorField& stkField,
-    StkBucket& bucket,
-    GlobalMap& globalIdsToElems)
-{
-  StkBulkData& bulk = bucket.mesh();
-  double* data = stk::mesh::field_data(stkField, bucket);
-  size_t nqp = stk::mesh::find_restriction(
-      stkField, bucket.entity_rank(), bucket.supersets()).dimension();
-  size_t elemsInBucket = bucket.size();
-  for (size_t i=0; i < elemsInBucket; ++i)
+    double* data,
+    size_t nodesPerEntity,
+    bool isQP,
+    Node const* ents,
+    size_t count,
+    bool toStk)
+{
+  size_t nc = countComponents(field);
+  for (size_t i=0; i < count; ++i)
+  for (size_t j=0; j < nodesPerEntity; ++j)
   {
-    long globalId = bulk.identifier(bucket[i]);
-    MeshEntity* elem = lookup(globalId,globalIdsToElems).entity;
-    Matrix3x3 value;
-    for (size_t j=0; j < nqp; ++j)
-    {
-      getMatrix(field,elem,j,value);
-      for (int k=0; k < 3; ++k)
-      for (int l=0; l < 3; ++l)
-        data[nqp*9*i + 9*j + 3*k + l] = value[k][l];
-    }
+    MeshEntity* e = ents[i].entity;
+    int node = isQP ? j : ents[i].node;
+    double* values = data + (nodesPerEntity*i + j)*nc;
+    if (toStk)
+      getComponents(field, e, node, values);
+    else
+      setComponents(field, e, node, values);
   }
 }
 
@@ -489,37 +275,24 @@ class StkBridge
         bool exists);
     virtual ~StkBridge() {}
     void transfer(
-        StkMetaData* metaData,
-        StkBulkData* bulkData,
-        GlobalMap& globalIdsToVerts,
-        GlobalMap& globalIdsToElems,
+        StkFieldMap* map,
         bool toStk)
     {
-      stk::mesh::Selector overlapSelector =
-        metaData->locally_owned_part() |
-        metaData->globally_shared_part();
-      stk::mesh::BucketVector buckets;
-      stk::mesh::EntityRank rank = stk::topology::NODE_RANK;
-      if (isQP)
-        rank = stk::topology::ELEMENT_RANK;
-      bulkData->get_buckets(rank, overlapSelector, buckets);
-      GlobalMap* globalIdsToEnts = &globalIdsToVerts;
-      if (isQP)
-        globalIdsToEnts = &globalIdsToElems;
-      APF_CONST_ITERATE(stk::mesh::BucketVector, buckets, it)
+      StkRankMap& rank = map->ranks[isQP ? 1 : 0];
+      for (size_t i=0; i < rank.buckets.size(); ++i)
       {
-        if (toStk)
-          write(*it,*globalIdsToEnts);
-        else
-          read(*it,*globalIdsToEnts);
+        StkBucket& bucket = *(rank.buckets[i]);
+        if (!bucket.size())
+          continue;
+        size_t nodesPerEntity;
+        double* data = getData(bucket, nodesPerEntity);
+        transferBucket(apfField, data, nodesPerEntity, isQP,
+            &rank.ents[rank.offsets[i]], bucket.size(), toStk);
       }
     }
-    virtual void read(
-        StkBucket* bucket,
-        GlobalMap& globalIdsToEnts) = 0;
-    virtual void write(
-        StkBucket* bucket,
-        GlobalMap& globalIdsToEnts) = 0;
+    virtual double* getData(
+        StkBucket& bucket,
+        size_t& nodesPerEntity) = 0;
     Field* apfField;
     bool isQP;
 };
@@ -540,17 +313,12 @@ class NodalBridge : public StkBridge
       isQP = false;
     }
     virtual ~NodalBridge() {}
-    virtual void read(
-        StkBucket* bucket,
-        GlobalMap& globalIdsToEnts)
-    {
-      readStkField(apfField,*stkField,*bucket,globalIdsToEnts);
-    }
-    virtual void write(
-        StkBucket* bucket,
-        GlobalMap& globalIdsToEnts)
+    virtual double* getData(
+        StkBucket& bucket,
+        size_t& nodesPerEntity)
     {
-      writeStkField(apfField,*stkField,*bucket,globalIdsToEnts);
+      nodesPerEntity = 1;
+      return stk::mesh::field_data(*stkField, bucket);
     }
   private:
     T* stkField;
@@ -580,17 +348,13 @@ class QPBridge : public StkBridge
       isQP = true;
     }
     virtual ~QPBridge() {}
-    virtual void read(
-        StkBucket* bucket,
-        GlobalMap& globalIdsToEnts)
-    {
-      readStkField(apfField,*stkField,*bucket,globalIdsToEnts);
-    }
-    virtual void write(
-        StkBucket* bucket,
-        GlobalMap& globalIdsToEnts)
+    virtual double* getData(
+        StkBucket& bucket,
+        size_t& nodesPerEntity)
     {
-      writeStkField(apfField,*stkField,*bucket,globalIdsToEnts);
+      nodesPerEntity = stk::mesh::find_restriction(
+          *stkField, bucket.entity_rank(), bucket.supersets()).dimension();
+      return stk::mesh::field_data(*stkField, bucket);
     }
   private:
     T* stkField;
@@ -641,6 +405,54 @@ static void generateGlobalIdsToEnts(
   }
 }
 
+static void mapRank(
+    GlobalNumbering* n,
+    stk::mesh::EntityRank stkRank,
+    StkMetaData* metaData,
+    StkBulkData* bulkData,
+    StkRankMap& rank)
+{
+  GlobalMap globalIdsToEnts;
+  generateGlobalIdsToEnts(n, globalIdsToEnts);
+  stk::mesh::Selector overlapSelector =
+    metaData->locally_owned_part() |
+    metaData->globally_shared_part();
+  bulkData->get_buckets(stkRank, overlapSelector, rank.buckets);
+  size_t nbuckets = rank.buckets.size();
+  rank.offsets.resize(nbuckets + 1);
+  rank.offsets[0] = 0;
+  for (size_t i=0; i < nbuckets; ++i)
+    rank.offsets[i + 1] = rank.offsets[i] + rank.buckets[i]->size();
+  rank.ents.resize(rank.offsets[nbuckets]);
+  for (size_t i=0; i < nbuckets; ++i)
+  {
+    StkBucket& bucket = *(rank.buckets[i]);
+    Node* ents = &rank.ents[rank.offsets[i]];
+    for (size_t j=0; j < bucket.size(); ++j)
+      ents[j] = lookup(bulkData->identifier(bucket[j]), globalIdsToEnts);
+  }
+}
+
+StkFieldMap* makeStkFieldMap(
+    GlobalNumbering* n[4],
+    StkMetaData* meta,
+    StkBulkData* bulk)
+{
+  Mesh* m = getMesh(n[0]);
+  StkFieldMap* map = new StkFieldMap();
+  map->mesh = m;
+  map->changes = m->countChanges();
+  mapRank(n[0], stk::topology::NODE_RANK, meta, bulk, map->ranks[0]);
+  mapRank(n[m->getDimension()], stk::topology::ELEMENT_RANK,
+      meta, bulk, map->ranks[1]);
+  return map;
+}
+
+void destroyStkFieldMap(StkFieldMap* map)
+{
+  delete map;
+}
+
 void declareField(Field* f, StkMetaData* md)
 {
   delete StkBridge::get(f, md, false);
@@ -658,30 +470,25 @@ void copyFieldsToMeta(
 void transferField(
     Field* f,
     StkMetaData* md,
-    StkBulkData* bd,
-    GlobalMap& vm,
-    GlobalMap& em,
+    StkFieldMap* map,
     bool toStk)
 {
   StkBridge* bridge = StkBridge::get(f, md, true);
-  bridge->transfer(md, bd, vm, em, toStk);
+  bridge->transfer(map, toStk);
   delete bridge;
 }
 
 void transferFields(
-    GlobalNumbering* n[4],
+    StkFieldMap* map,
     StkMetaData* metaData,
-    StkBulkData* bulkData,
     bool toStk)
 {
-  Mesh* m = getMesh(n[0]);
-  GlobalMap nm;
-  generateGlobalIdsToEnts(n[0], nm);
-  GlobalMap em;
-  generateGlobalIdsToEnts(n[m->getDimension()], em);
-  transferField(m->getCoordinateField(), metaData, bulkData, nm, em, toStk);
+  Mesh* m = map->mesh;
+  PCU_ALWAYS_ASSERT_VERBOSE(map->changes == m->countChanges(),
+      "apf::StkFieldMap used after the apf mesh changed");
+  transferField(m->getCoordinateField(), metaData, map, toStk);
   for (int i=0; i < m->countFields(); ++i)
-    transferField(m->getField(i), metaData, bulkData, nm, em, toStk);
+    transferField(m->getField(i), metaData, map, toStk);
 }
 
 void copyFieldsToBulk(
@@ -689,7 +496,9 @@ void copyFieldsToBulk(
     StkMetaData* meta,
     StkBulkData* bulk)
 {
-  transferFields(n, meta, bulk, true);
+  StkFieldMap* map = makeStkFieldMap(n, meta, bulk);
+  transferFields(map, meta, true);
+  destroyStkFieldMap(map);
 }
 
 void copyFieldsFromBulk(
@@ -697,7 +506,23 @@ void copyFieldsFromBulk(
     StkMetaData* meta,
     StkBulkData* bulk)
 {
-  transferFields(n, meta, bulk, false);
+  StkFieldMap* map = makeStkFieldMap(n, meta, bulk);
+  transferFields(map, meta, false);
+  destroyStkFieldMap(map);
+}
+
+void copyFieldsToBulk(
+    StkFieldMap* map,
+    StkMetaData* meta)
+{
+  transferFields(map, meta, true);
+}
+
+void copyFieldsFromBulk(
+    StkFieldMap* map,
+    StkMetaData* meta)
+{
+  transferFields(map, meta, false);
 }
 #endif
 
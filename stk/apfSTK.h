@@ -48,6 +48,28 @@ void copyFieldsFromBulk(
     StkMetaData* meta,
     StkBulkData* bulk);
 
+/* the apf node behind every owned and shared stk node and element,
+   laid out bucket by bucket, so that repeated field copies go
+   straight to the stk bucket arrays without global id lookups.
+   it is valid until either mesh changes, after which it must be
+   rebuilt */
+struct StkFieldMap;
+
+StkFieldMap* makeStkFieldMap(
+    GlobalNumbering* n[4],
+    StkMetaData* meta,
+    StkBulkData* bulk);
+
+void destroyStkFieldMap(StkFieldMap* map);
+
+void copyFieldsToBulk(
+    StkFieldMap* map,
+    StkMetaData* meta);
+
+void copyFieldsFromBulk(
+    StkFieldMap* map,
+    StkMetaData* meta);
+
 void writeExodus(
     apf::Mesh* mesh,
     apf::StkModels& models,
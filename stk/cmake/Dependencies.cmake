@@ -1,4 +1,4 @@
 TRIBITS_PACKAGE_DEFINE_DEPENDENCIES(
   LIB_REQUIRED_PACKAGES SCORECapf Shards
-  LIB_OPTIONAL_PACKAGES STKIO STKMesh STKTopology STKUtil SEACASIoss Teuchos
+  LIB_OPTIONAL_PACKAGES STKIO STKMesh STKTopology STKUtil SEACASIoss SEACASExodus Teuchos
   )
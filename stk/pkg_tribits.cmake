@@ -4,7 +4,8 @@ tribits_package(SCORECapf_stk)
 SET(ENABLE_STK_MESH OFF)
 if(SCORECapf_stk_ENABLE_STKIO AND
    SCORECapf_stk_ENABLE_STKMesh AND
-   SCORECapf_stk_ENABLE_SEACASIoss)
+   SCORECapf_stk_ENABLE_SEACASIoss AND
+   SCORECapf_stk_ENABLE_SEACASExodus)
   SET(ENABLE_STK_MESH ON)
 endif()
 
@@ -22,8 +23,8 @@ set(SOURCES
 set(HEADERS apfAlbany.h)
 
 if(ENABLE_STK_MESH)
-  set(HEADERS ${HEADERS} apfSTK.h)
-  set(SOURCES ${SOURCES} apfExodusOutput.cc)
+  set(HEADERS ${HEADERS} apfSTK.h apfExodus.h)
+  set(SOURCES ${SOURCES} apfExodusOutput.cc apfExodus.cc)
 endif()
 
 #Library
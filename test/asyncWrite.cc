@@ -0,0 +1,85 @@
+#include <apf.h>
+#include <apfBox.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi.h>
+#include <gmi_null.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+/* writes a box with a field as VTK and smb files, both directly
+   and on background threads, changes the field while the background
+   writes run, and checks that their files equal the direct ones */
+
+namespace {
+
+std::string readFile(const char* path)
+{
+  std::ifstream file(path, std::ios::binary);
+  PCU_ALWAYS_ASSERT(file.is_open());
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+void setField(apf::Mesh* m, apf::Field* f, double scale)
+{
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    apf::setScalar(f, v, 0, scale * (x[0] + 10 * x[1] + 100 * x[2]));
+  }
+  m->end(it);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 1);
+  gmi_register_null();
+  apf::Mesh2* m = apf::makeMdsBox(4, 4, 4, 1, 1, 1, true);
+  apf::Field* f = apf::createFieldOn(m, "u", apf::SCALAR);
+  setField(m, f, 1);
+  apf::writeVtkFiles("sync_box", m);
+  m->writeNative("sync_box.smb");
+  apf::AsyncWrite* vtk = apf::writeVtkFilesAsync("async_box", m);
+  apf::AsyncWrite* smb = apf::writeMdsAsync(m, "async_box.smb");
+  setField(m, f, -1);
+  apf::writeMdsAsync(m, "async_changed.smb");
+  apf::waitForWrite(vtk);
+  apf::waitForWrite(smb);
+  PCU_ALWAYS_ASSERT(readFile("sync_box/0/0.vtu") ==
+                    readFile("async_box/0/0.vtu"));
+  PCU_ALWAYS_ASSERT(readFile("sync_box0.smb") == readFile("async_box0.smb"));
+  apf::waitForWrites();
+  PCU_ALWAYS_ASSERT(readFile("sync_box0.smb") !=
+                    readFile("async_changed0.smb"));
+  m->destroyNative();
+  apf::destroyMesh(m);
+  m = apf::loadMdsMesh(gmi_load(".null"), "async_changed.smb");
+  f = m->findField("u");
+  PCU_ALWAYS_ASSERT(f);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    PCU_ALWAYS_ASSERT(apf::getScalar(f, v, 0) == -(x[0] + 10 * x[1] + 100 * x[2]));
+  }
+  m->end(it);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  if (!PCU_Comm_Self())
+    printf("outputs written on background threads\n");
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
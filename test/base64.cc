@@ -209,6 +209,20 @@ void runCombinedTests()
 
   PCU_ALWAYS_ASSERT(resultStr == alphabet1);
 
+  //test3, every byte value through the buffer encoder, which
+  // must agree with the string encoder at each length
+  std::string bytes;
+  for ( int i = 0; i < 256; i++ )
+    bytes += (char)i;
+  for ( unsigned long len = 0; len <= bytes.length(); len++ )
+  {
+    std::string encoded(lion::base64EncodedLength(len), '#');
+    if ( len )
+      lion::base64Encode(bytes.c_str(), len, &encoded[0]);
+    PCU_ALWAYS_ASSERT(encoded == lion::base64Encode(bytes.c_str(), len));
+    PCU_ALWAYS_ASSERT(lion::base64Decode(encoded) == bytes.substr(0, len));
+  }
+
   std::cout << "Combined tests pass!" << std::endl;
 }
 
@@ -0,0 +1,432 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfNumbering.h>
+#include <apfShape.h>
+#include <ma.h>
+#include <parma.h>
+#include <pumi.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* Timed mesh operations on generated boxes, run on 1, 2, 4 ...
+   ranks of the job so one launch gives a scaling table.
+   Every result is one line starting with "bench," in the columns
+   of the "#bench," header; other output is diagnostics. */
+
+namespace {
+
+int nx, ny, nz;
+bool simplices;
+bool weak;
+
+struct Result
+{
+  Result():seconds(0), items(0), bytes(0) {}
+  double seconds;
+  long items;
+  long bytes;
+};
+
+double startTimer()
+{
+  PCU_Barrier();
+  return PCU_Time();
+}
+
+/* the slowest rank's time and the totals over ranks */
+void finish(Result& r, double t0)
+{
+  r.seconds = PCU_Max_Double(PCU_Time() - t0);
+  r.items = PCU_Add_Long(r.items);
+  r.bytes = PCU_Add_Long(r.bytes);
+}
+
+long fileSize(std::string const& path)
+{
+  std::ifstream f(path.c_str(), std::ios::binary | std::ios::ate);
+  return f ? long(f.tellg()) : 0;
+}
+
+const int repeats = 10;
+
+Result benchAdjacency(apf::Mesh2* m)
+{
+  Result r;
+  int dim = m->getDimension();
+  apf::Adjacent adj;
+  double t0 = startTimer();
+  for (int i = 0; i < repeats; ++i) {
+    apf::MeshIterator* it = m->begin(0);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      m->getAdjacent(e, dim, adj);
+      r.items += adj.getSize();
+    }
+    m->end(it);
+    it = m->begin(dim);
+    while ((e = m->iterate(it))) {
+      apf::Downward down;
+      r.items += m->getDownward(e, 0, down);
+    }
+    m->end(it);
+  }
+  finish(r, t0);
+  return r;
+}
+
+Result benchIterate(apf::Mesh2* m)
+{
+  Result r;
+  double t0 = startTimer();
+  for (int i = 0; i < repeats; ++i)
+    for (int d = 0; d <= m->getDimension(); ++d) {
+      apf::MeshIterator* it = m->begin(d);
+      while (m->iterate(it))
+        ++r.items;
+      m->end(it);
+    }
+  finish(r, t0);
+  return r;
+}
+
+Result benchField(apf::Mesh2* m)
+{
+  Result r;
+  apf::Field* f = apf::createFieldOn(m, "bench", apf::VECTOR);
+  apf::Vector3 v(1, 2, 3);
+  double t0 = startTimer();
+  for (int i = 0; i < repeats; ++i) {
+    apf::MeshIterator* it = m->begin(0);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it)))
+      apf::setVector(f, e, 0, v);
+    m->end(it);
+    it = m->begin(0);
+    while ((e = m->iterate(it))) {
+      apf::getVector(f, e, 0, v);
+      r.items += 2;
+    }
+    m->end(it);
+  }
+  r.bytes = r.items * 3 * sizeof(double);
+  finish(r, t0);
+  apf::destroyField(f);
+  return r;
+}
+
+Result benchSynchronize(apf::Mesh2* m)
+{
+  Result r;
+  apf::Field* f = apf::createFieldOn(m, "bench", apf::VECTOR);
+  apf::zeroField(f);
+  long copies = 0;
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it)))
+    if (m->isShared(e) && m->isOwned(e)) {
+      apf::Copies remotes;
+      m->getRemotes(e, remotes);
+      copies += remotes.size();
+    }
+  m->end(it);
+  double t0 = startTimer();
+  for (int i = 0; i < repeats; ++i)
+    apf::synchronize(f);
+  r.items = copies * repeats;
+  r.bytes = r.items * 3 * sizeof(double);
+  finish(r, t0);
+  apf::destroyField(f);
+  return r;
+}
+
+/* every element moves to the next part */
+Result benchMigrate(apf::Mesh2* m)
+{
+  Result r;
+  int to = (PCU_Comm_Self() + 1) % PCU_Comm_Peers();
+  apf::Migration* plan = new apf::Migration(m);
+  plan->send(to);
+  r.items = m->count(m->getDimension());
+  double t0 = startTimer();
+  apf::migrateSilent(m, plan);
+  finish(r, t0);
+  return r;
+}
+
+Result benchGhost(apf::Mesh2* m)
+{
+  Result r;
+  int dim = m->getDimension();
+  long before = m->count(dim);
+  /* the ghosting works on the mesh pumi holds */
+  pumi::instance()->mesh = m;
+  double t0 = startTimer();
+  pumi_ghost_createLayer(m, 0, dim, 1, 1);
+  r.items = m->count(dim) - before;
+  finish(r, t0);
+  pumi_ghost_delete(m);
+  pumi::instance()->mesh = 0;
+  return r;
+}
+
+Result benchNumbering(apf::Mesh2* m)
+{
+  Result r;
+  double t0 = startTimer();
+  apf::GlobalNumbering* n =
+    apf::makeGlobal(apf::numberOwnedNodes(m, "bench"));
+  apf::synchronize(n);
+  r.items = apf::countOwned(m, 0);
+  finish(r, t0);
+  apf::destroyGlobalNumbering(n);
+  return r;
+}
+
+Result benchVtk(apf::Mesh2* m)
+{
+  Result r;
+  r.items = m->count(m->getDimension());
+  double t0 = startTimer();
+  apf::writeVtkFiles("bench_vtk", m);
+  finish(r, t0);
+  return r;
+}
+
+std::string smbPiece()
+{
+  std::stringstream ss;
+  ss << "bench_mesh" << PCU_Comm_Self() << ".smb";
+  return ss.str();
+}
+
+Result benchSmbWrite(apf::Mesh2* m)
+{
+  Result r;
+  r.items = m->count(m->getDimension());
+  double t0 = startTimer();
+  m->writeNative("bench_mesh.smb");
+  r.bytes = fileSize(smbPiece());
+  finish(r, t0);
+  return r;
+}
+
+Result benchSmbRead(apf::Mesh2* m)
+{
+  Result r;
+  m->writeNative("bench_mesh.smb");
+  r.bytes = fileSize(smbPiece());
+  double t0 = startTimer();
+  apf::Mesh2* read = apf::loadMdsMesh(m->getModel(), "bench_mesh.smb");
+  r.items = read->count(read->getDimension());
+  finish(r, t0);
+  apf::disownMdsModel(read);
+  read->destroyNative();
+  apf::destroyMesh(read);
+  return r;
+}
+
+void refine(apf::Mesh2* m)
+{
+  ma::Input* in = ma::configureUniformRefine(m, 1);
+  in->shouldSnap = false;
+  in->shouldTransferParametric = false;
+  in->shouldFixShape = false;
+  ma::adapt(in);
+}
+
+Result benchRefine(apf::Mesh2* m)
+{
+  Result r;
+  double t0 = startTimer();
+  refine(m);
+  r.items = m->count(m->getDimension());
+  finish(r, t0);
+  return r;
+}
+
+/* twice the edge length of the box before refinement */
+class Coarser : public ma::IsotropicFunction
+{
+  public:
+    double getValue(ma::Entity*)
+    {
+      return 2.0 / std::max(nx, std::max(ny, nz));
+    }
+};
+
+Result benchCoarsen(apf::Mesh2* m)
+{
+  Result r;
+  refine(m);
+  long before = m->count(m->getDimension());
+  Coarser size;
+  ma::Input* in = ma::configure(m, &size);
+  in->shouldSnap = false;
+  in->shouldTransferParametric = false;
+  in->shouldFixShape = false;
+  double t0 = startTimer();
+  ma::adapt(in);
+  r.items = before - m->count(m->getDimension());
+  finish(r, t0);
+  return r;
+}
+
+/* a quarter of the elements of odd parts go to the part below,
+   which the balancer then spreads back */
+Result benchBalance(apf::Mesh2* m)
+{
+  Result r;
+  int self = PCU_Comm_Self();
+  apf::Migration* plan = new apf::Migration(m);
+  if (self % 2) {
+    apf::MeshIterator* it = m->begin(m->getDimension());
+    apf::MeshEntity* e;
+    int i = 0;
+    while ((e = m->iterate(it)))
+      if (i++ % 4 == 0)
+        plan->send(e, self - 1);
+    m->end(it);
+  }
+  apf::migrateSilent(m, plan);
+  apf::MeshTag* weights = Parma_WeighByMemory(m);
+  apf::Balancer* balancer = Parma_MakeElmBalancer(m);
+  double t0 = startTimer();
+  balancer->balance(weights, 1.05);
+  r.items = m->count(m->getDimension());
+  finish(r, t0);
+  delete balancer;
+  apf::removeTagFromDimension(m, weights, m->getDimension());
+  m->destroyTag(weights);
+  return r;
+}
+
+typedef Result (*Bench)(apf::Mesh2* m);
+
+struct Entry
+{
+  const char* name;
+  Bench run;
+  const char* unit;
+  /* mesh adaptation only handles simplices */
+  bool simplexOnly;
+};
+
+Entry const benches[] = {
+  {"adjacency", benchAdjacency, "adjacencies", false},
+  {"iterate", benchIterate, "entities", false},
+  {"field", benchField, "values", false},
+  {"synchronize", benchSynchronize, "copies", false},
+  {"migrate", benchMigrate, "elements", false},
+  {"ghost", benchGhost, "elements", false},
+  {"numbering", benchNumbering, "nodes", false},
+  {"vtk_write", benchVtk, "elements", false},
+  {"smb_write", benchSmbWrite, "elements", false},
+  {"smb_read", benchSmbRead, "elements", false},
+  {"refine", benchRefine, "elements", true},
+  {"coarsen", benchCoarsen, "elements", true},
+  {"balance", benchBalance, "elements", false}
+};
+int const nbenches = sizeof(benches) / sizeof(benches[0]);
+
+/* the seconds of each benchmark on one rank, for efficiency */
+std::vector<double> baseline(nbenches, 0);
+
+void run(Entry const& b, int index, int ranks)
+{
+  int scale = weak ? ranks : 1;
+  apf::Mesh2* m = apf::makeDistributedMdsBox(nx * scale, ny, nz,
+      scale, 1, 1, simplices);
+  long elements = PCU_Add_Long(apf::countOwned(m, m->getDimension()));
+  Result r = b.run(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  if (ranks == 1)
+    baseline[index] = r.seconds;
+  double efficiency = 0;
+  if (r.seconds > 0)
+    efficiency = baseline[index] / (r.seconds * (weak ? 1 : ranks));
+  if (!PCU_Comm_Self())
+    printf("bench,%s,%s,%d,%ld,%s,%ld,%ld,%.6e,%.6e,%.6e,%.3f\n",
+        b.name, weak ? "weak" : "strong", ranks, elements, b.unit,
+        r.items, r.bytes, r.seconds,
+        r.seconds > 0 ? r.items / r.seconds : 0.0,
+        r.seconds > 0 ? r.bytes / r.seconds : 0.0,
+        efficiency);
+}
+
+bool isSelected(const char* name, int argc, char** argv)
+{
+  if (argc == 6)
+    return true;
+  for (int i = 6; i < argc; ++i)
+    if (!strcmp(argv[i], name))
+      return true;
+  return false;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  if (argc < 6 || (strcmp(argv[1], "weak") && strcmp(argv[1], "strong"))) {
+    if (!PCU_Comm_Self()) {
+      printf("Usage: %s <strong|weak> <nx> <ny> <nz> <is> [bench...]\n",
+          argv[0]);
+      printf("runs on 1, 2, 4 ... ranks of the job; weak scaling "
+             "stretches the box in x by the rank count\n");
+      printf("benchmarks:");
+      for (int i = 0; i < nbenches; ++i)
+        printf(" %s", benches[i].name);
+      printf("\n");
+    }
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  weak = !strcmp(argv[1], "weak");
+  nx = atoi(argv[2]);
+  ny = atoi(argv[3]);
+  nz = atoi(argv[4]);
+  simplices = atoi(argv[5]);
+  gmi_register_mesh();
+  int self;
+  int peers;
+  MPI_Comm_rank(MPI_COMM_WORLD, &self);
+  MPI_Comm_size(MPI_COMM_WORLD, &peers);
+  if (!self)
+    printf("#bench,name,scaling,ranks,elements,unit,items,bytes,"
+           "seconds,items_per_s,bytes_per_s,efficiency\n");
+  for (int ranks = 1; ; ranks = std::min(ranks * 2, peers)) {
+    MPI_Comm sub;
+    MPI_Comm_split(MPI_COMM_WORLD, self < ranks, self, &sub);
+    /* switching duplicates the communicator, so the idle ranks
+       switch to theirs too for the switch back to be collective */
+    PCU_Switch_Comm(sub);
+    if (self < ranks)
+      for (int i = 0; i < nbenches; ++i)
+        if (isSelected(benches[i].name, argc, argv) &&
+            (simplices || !benches[i].simplexOnly))
+          run(benches[i], i, ranks);
+    PCU_Switch_Comm(MPI_COMM_WORLD);
+    MPI_Comm_free(&sub);
+    /* rank 0 of every run holds the baselines */
+    MPI_Bcast(&baseline[0], nbenches, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    if (ranks == peers)
+      break;
+  }
+  /* high-water bytes by subsystem over all the runs */
+  PCU_Mem_Print();
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -4,11 +4,15 @@
 #include <gmi_analytic.h>
 #include <gmi_null.h>
 #include <apfMDS.h>
+#include <apfBox.h>
+#include <apfShape.h>
 #include <apf.h>
 #include <PCU.h>
 #include <apfDynamicMatrix.h>
 #include <pcu_util.h>
 #include <cstdlib>
+#include <fstream>
+#include <sstream>
 
 /* this test file contains tests for
  * a curved 2D mesh
@@ -462,6 +466,65 @@ void test3D(apf::Mesh2* m)
   test3DJacobian(m);
   test3DJacobianTri(m);
 }
+
+/* writes the order 4 tet (m) as VTK Lagrange cells and compares the
+ * last node of the cell, the interior node at xi = (1/4,1/4,1/4),
+ * with the mapping of the mesh */
+void testLagrangeVtu(apf::Mesh2* m, const char* prefix)
+{
+  PCU_ALWAYS_ASSERT(m->getShape()->getOrder() == 4);
+  crv::writeLagrangeVtuFiles(m,apf::Mesh::TET,prefix);
+  std::stringstream ss;
+  ss << prefix << "/lagrange_tet/vtu/order_4_" << PCU_Comm_Self() << ".vtu";
+  std::ifstream file(ss.str().c_str());
+  PCU_ALWAYS_ASSERT(file.is_open());
+  std::string line;
+  while (std::getline(file,line) && line != "<Points>");
+  std::getline(file,line);
+  apf::Vector3 x;
+  for (int i = 0; i < 35; ++i)
+    file >> x[0] >> x[1] >> x[2];
+  PCU_ALWAYS_ASSERT(file);
+  apf::MeshIterator* it = m->begin(3);
+  apf::MeshEntity* e = m->iterate(it);
+  m->end(it);
+  apf::MeshElement* me = apf::createMeshElement(m,e);
+  apf::Vector3 y;
+  apf::mapLocalToGlobal(me,apf::Vector3(0.25,0.25,0.25),y);
+  apf::destroyMeshElement(me);
+  PCU_ALWAYS_ASSERT((x-y).getLength() < 1e-5);
+}
+/* the values kept at integration points match the functions,
+ * on tets with and without faces on the boundary */
+void testCachedBlended(int order, int blendOrder)
+{
+  apf::Mesh2* m = apf::makeMdsBox(2,2,2,1,1,1,true);
+  crv::BezierCurver bc(m,order,blendOrder);
+  bc.run();
+  apf::NewArray<double> cached, direct;
+  apf::MeshIterator* it = m->begin(3);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    apf::MeshElement* me = apf::createMeshElement(m,e);
+    apf::Element* elem = apf::createElement(m->getCoordinateField(),me);
+    apf::EntityShape* shape =
+      m->getShape()->getEntityShape(apf::Mesh::TET);
+    for (int i = 0; i < apf::countIntPoints(me,2); ++i) {
+      apf::Vector3 xi;
+      apf::getIntPoint(me,2,i,xi);
+      apf::getShapeValues(elem,xi,cached);
+      shape->getValues(m,e,xi,direct);
+      for (int j = 0; j < shape->countNodes(); ++j)
+        PCU_ALWAYS_ASSERT(std::fabs(cached[j]-direct[j]) < 1e-15);
+    }
+    apf::destroyElement(elem);
+    apf::destroyMeshElement(me);
+  }
+  m->end(it);
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
 /* Tests 3D with blending functions. This can go as high as the order of
  * triangles implemented. There are no nodes inside the tetrahedron
  *
@@ -484,8 +547,11 @@ void test3DBlended()
       crv::BezierCurver bc(m,order,blendOrder);
       bc.run();
       test3D(m);
+      if(order == 4)
+        testLagrangeVtu(m,"blended");
       m->destroyNative();
       apf::destroyMesh(m);
+      testCachedBlended(order,blendOrder);
     }
   }
 }
@@ -533,6 +599,7 @@ void test3DFull()
 
       // write the field
       crv::writeCurvedVtuFiles(m,apf::Mesh::TET,2,"curved");
+      testLagrangeVtu(m,"curved");
     }
     m->destroyNative();
     apf::destroyMesh(m);
@@ -544,6 +611,30 @@ void test3DFull()
     bc.run();
     crv::changeMeshOrder(m,5);
     test3D(m);
+    // elevating in chunks gives the same control points
+    apf::Mesh2* m2 = createMesh3D();
+    crv::BezierCurver bc2(m2,order,0);
+    bc2.run();
+    crv::changeMeshOrder(m2,5,3);
+    for(int d = 1; d <= 3; ++d){
+      apf::MeshIterator* it = m->begin(d);
+      apf::MeshIterator* it2 = m2->begin(d);
+      apf::MeshEntity* e;
+      apf::MeshEntity* e2;
+      while ((e = m->iterate(it)) && (e2 = m2->iterate(it2))){
+        int nodes = m->getShape()->countNodesOn(m->getType(e));
+        for(int i = 0; i < nodes; ++i){
+          apf::Vector3 x, x2;
+          m->getPoint(e,i,x);
+          m2->getPoint(e2,i,x2);
+          PCU_ALWAYS_ASSERT((x-x2).getLength() < 1e-15);
+        }
+      }
+      m->end(it);
+      m2->end(it2);
+    }
+    m2->destroyNative();
+    apf::destroyMesh(m2);
     m->destroyNative();
     apf::destroyMesh(m);
   }
@@ -1,5 +1,6 @@
 #include <crv.h>
 #include <crvBezier.h>
+#include <crvBezierShapes.h>
 #include <crvTables.h>
 #include <crvSnap.h>
 #include <crvMath.h>
@@ -13,6 +14,7 @@
 #include <mth.h>
 #include <mth_def.h>
 #include <pcu_util.h>
+#include <cmath>
 #include <ostream>
 /* This file contains miscellaneous tests relating to ordering, math
  * and transformation matrices
@@ -65,6 +67,32 @@ void testNodeIndexing(){
   == crv::getTetNodeIndex(P,i,j,k));
 }
 
+/* the shape functions specialized by order against the general ones */
+void testShapeTables(){
+  int const types[3] = {apf::Mesh::EDGE,apf::Mesh::TRIANGLE,apf::Mesh::TET};
+  apf::Vector3 const points[4] = {apf::Vector3(-0.3,0,0),
+    apf::Vector3(0.1,0.2,0.3),apf::Vector3(0.7,0.05,0.1),
+    apf::Vector3(0.25,0.25,0.25)};
+  for(int t = 0; t < 3; ++t)
+    for(int P = 1; P <= 6; ++P){
+      int n = crv::getNumControlPoints(types[t],P);
+      crv::bezierShape shape = crv::getBezierShape(types[t],P);
+      crv::bezierShapeGrads grads = crv::getBezierShapeGrads(types[t],P);
+      for(int x = 0; x < 4; ++x){
+        apf::NewArray<double> v0(n), v1(n);
+        apf::NewArray<apf::Vector3> g0(n), g1(n);
+        crv::bezier[types[t]](P,points[x],v0);
+        crv::bezierGrads[types[t]](P,points[x],g0);
+        shape(P,points[x],v1);
+        grads(P,points[x],g1);
+        for(int i = 0; i < n; ++i){
+          PCU_ALWAYS_ASSERT(std::fabs(v0[i]-v1[i]) < 1e-14);
+          PCU_ALWAYS_ASSERT((g0[i]-g1[i]).getLength() < 1e-13);
+        }
+      }
+    }
+}
+
 static double const a_data[35][35] = {{1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
     {0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
     {0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
@@ -168,6 +196,7 @@ int main(int argc, char** argv)
   MPI_Init(&argc,&argv);
   PCU_Comm_Init();
   testNodeIndexing();
+  testShapeTables();
   testMatrixInverse();
   PCU_Comm_Free();
   MPI_Finalize();
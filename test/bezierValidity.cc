@@ -397,6 +397,19 @@ void test3D()
     } else {
       PCU_ALWAYS_ASSERT(validityTag == 1);
     }
+    crv::Quality* qual = crv::makeQuality(m,2);
+    apf::MeshEntity* tets[2] = {tet,tet};
+    int tags[2];
+    qual->checkValidities(tets,2,tags);
+    PCU_ALWAYS_ASSERT(tags[0] == qual->checkValidity(tet));
+    PCU_ALWAYS_ASSERT(tags[1] == tags[0]);
+    delete qual;
+    PCU_ALWAYS_ASSERT((crv::countNumberInvalidElements(m) > 0) ==
+        (order == 4));
+    std::vector<apf::MeshEntity*> invalid;
+    PCU_ALWAYS_ASSERT(crv::findInvalidElements(m,invalid,4) ==
+        crv::countNumberInvalidElements(m));
+    PCU_ALWAYS_ASSERT(invalid.size() == 0 || invalid[0] == tet);
     crv::getQuality(m,tet);
     m->destroyNative();
     apf::destroyMesh(m);
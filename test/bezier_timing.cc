@@ -0,0 +1,183 @@
+#include <crv.h>
+#include <crvBezier.h>
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <apf.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/* times the curved mesh kernels on Bezier box meshes of triangles
+   and tetrahedra, orders 1 to 6, and reports elements per second
+   of the slowest rank. The box has (n) divisions per side, the
+   curved VTU files go under the existing directory (prefix) */
+
+namespace {
+
+std::vector<apf::MeshEntity*> getElements(apf::Mesh* m)
+{
+  std::vector<apf::MeshEntity*> elements;
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it)))
+    elements.push_back(e);
+  m->end(it);
+  return elements;
+}
+
+/* shape function values and gradients at the integration
+   points of the element's order */
+void timeBasis(apf::Mesh* m, std::vector<apf::MeshEntity*> const& elements)
+{
+  int order = m->getShape()->getOrder();
+  apf::NewArray<double> values;
+  apf::NewArray<apf::Vector3> grads;
+  apf::MeshElement* me = apf::createMeshElement(m,elements[0]);
+  int np = apf::countIntPoints(me,order);
+  std::vector<apf::Vector3> xi(np);
+  for (int i = 0; i < np; ++i)
+    apf::getIntPoint(me,order,i,xi[i]);
+  apf::destroyMeshElement(me);
+  apf::EntityShape* shape =
+    m->getShape()->getEntityShape(m->getType(elements[0]));
+  for (size_t k = 0; k < elements.size(); ++k)
+    for (int i = 0; i < np; ++i) {
+      shape->getValues(m,elements[k],xi[i],values);
+      shape->getLocalGradients(m,elements[k],xi[i],grads);
+    }
+}
+
+/* the Jacobian determinant coefficients behind the quality,
+   which is only defined from order 2 */
+void timeJacobian(apf::Mesh* m, std::vector<apf::MeshEntity*> const& elements)
+{
+  crv::Quality* qual = crv::makeQuality(m,2);
+  for (size_t k = 0; k < elements.size(); ++k)
+    qual->getQuality(elements[k]);
+  delete qual;
+}
+
+void timeValidity(apf::Mesh* m, std::vector<apf::MeshEntity*> const&)
+{
+  std::vector<apf::MeshEntity*> invalid;
+  PCU_ALWAYS_ASSERT(crv::findInvalidElements(m,invalid) == 0);
+}
+
+/* uniform triangle subdivision, tetrahedra split at the centroid,
+   which is tabulated up to order 4 */
+void timeSubdivision(apf::Mesh* m,
+    std::vector<apf::MeshEntity*> const& elements)
+{
+  int order = m->getShape()->getOrder();
+  int type = m->getType(elements[0]);
+  apf::NewArray<apf::Vector3> nodes;
+  apf::NewArray<apf::Vector3> triNodes[4];
+  apf::NewArray<apf::Vector3> tetNodes[4];
+  int n = crv::getNumControlPoints(type,order);
+  for (int t = 0; t < 4; ++t) {
+    triNodes[t].allocate(n);
+    tetNodes[t].allocate(n);
+  }
+  apf::Vector3 centroid(0.25,0.25,0.25);
+  apf::MeshElement* me = apf::createMeshElement(m,elements[0]);
+  apf::Element* elem = apf::createElement(m->getCoordinateField(),me);
+  for (size_t k = 0; k < elements.size(); ++k) {
+    if (k) {
+      apf::rebindMeshElement(me,elements[k]);
+      apf::rebindElement(elem,me);
+    }
+    apf::getVectorNodes(elem,nodes);
+    if (type == apf::Mesh::TRIANGLE)
+      crv::subdivideBezierTriangle(order,nodes,triNodes);
+    else
+      crv::subdivideBezierTet(order,centroid,nodes,tetNodes);
+  }
+  apf::destroyElement(elem);
+  apf::destroyMeshElement(me);
+}
+
+const char* prefix;
+
+void timeVtu(apf::Mesh* m, std::vector<apf::MeshEntity*> const& elements)
+{
+  crv::writeCurvedVtuFiles(m,m->getType(elements[0]),4,prefix);
+}
+
+typedef void (*Kernel)(apf::Mesh* m,
+    std::vector<apf::MeshEntity*> const& elements);
+
+struct Timed
+{
+  const char* name;
+  Kernel kernel;
+  int minOrder;
+  int maxTetOrder;
+};
+
+Timed const kernels[] = {
+  {"basis", timeBasis, 1, 6},
+  {"jacobian", timeJacobian, 2, 6},
+  {"validity", timeValidity, 1, 6},
+  {"subdivision", timeSubdivision, 1, 4},
+  {"vtu", timeVtu, 1, 6}
+};
+int const kernelCount = sizeof(kernels) / sizeof(kernels[0]);
+
+void run(int dim, int n)
+{
+  for (int order = 1; order <= 6; ++order) {
+    apf::Mesh2* m = apf::makeMdsBox(n,n,dim == 3 ? n : 0,1,1,1,true);
+    crv::BezierCurver bc(m,order,0);
+    bc.run();
+    std::vector<apf::MeshEntity*> elements = getElements(m);
+    long total = PCU_Add_Long(elements.size());
+    /* the writers print as they go, so the row waits for the end */
+    double rates[kernelCount];
+    for (int i = 0; i < kernelCount; ++i) {
+      rates[i] = -1;
+      if (order < kernels[i].minOrder ||
+          (dim == 3 && order > kernels[i].maxTetOrder))
+        continue;
+      double t0 = PCU_Time();
+      kernels[i].kernel(m,elements);
+      double t = PCU_Max_Double(PCU_Time() - t0);
+      rates[i] = t > 0 ? total / t : 0;
+    }
+    if (!PCU_Comm_Self()) {
+      printf("%s order %d, %ld elements, per second:",
+          dim == 3 ? "tet" : "triangle", order, total);
+      for (int i = 0; i < kernelCount; ++i)
+        if (rates[i] < 0)
+          printf(" %s -", kernels[i].name);
+        else
+          printf(" %s %.4g", kernels[i].name, rates[i]);
+      printf("\n");
+    }
+    m->destroyNative();
+    apf::destroyMesh(m);
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  gmi_register_null();
+  int n = 4;
+  if (argc > 1)
+    n = atoi(argv[1]);
+  prefix = argc > 2 ? argv[2] : ".";
+  PCU_ALWAYS_ASSERT(n > 0);
+  run(2,4 * n);
+  run(3,n);
+  PCU_Comm_Free();
+  MPI_Finalize();
+  return 0;
+}
@@ -64,11 +64,16 @@ int main(int argc, char** argv)
   verifyArgs(argc, argv);
   getArgs(argv);
   gmi_register_mesh();
-  apf::Mesh2* m = apf::makeMdsBox(nx,ny,nz,wx,wy,wz,is);
+  apf::Mesh2* m;
+  if (PCU_Comm_Peers() > 1)
+    m = apf::makeDistributedMdsBox(nx,ny,nz,wx,wy,wz,is);
+  else
+    m = apf::makeMdsBox(nx,ny,nz,wx,wy,wz,is);
   gmi_model* g = m->getModel();
-  m->verify();
+  apf::verify(m, apf::VERIFY_ALL, true, 2);
   m->writeNative(meshFile);
-  gmi_write_dmg(g, modelFile);
+  if (!PCU_Comm_Self())
+    gmi_write_dmg(g, modelFile);
   m->destroyNative();
   apf::destroyMesh(m);
   PCU_Comm_Free();
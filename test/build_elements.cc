@@ -0,0 +1,113 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <vector>
+
+/* rebuilds the local elements of a mesh both one at a time
+   and in bulk, expecting the same entities and orientations */
+
+namespace {
+
+apf::Mesh2* copyVerts(const char* model, apf::Mesh* m,
+    std::vector<apf::MeshEntity*>& verts)
+{
+  apf::Mesh2* c = apf::makeEmptyMdsMesh(gmi_load(model), m->getDimension(),
+      false);
+  apf::MeshEntity* v;
+  apf::MeshIterator* it = m->begin(0);
+  while ((v = m->iterate(it))) {
+    apf::Vector3 p;
+    m->getPoint(v, 0, p);
+    apf::ModelEntity* g = m->toModel(v);
+    g = c->findModelEntity(m->getModelType(g), m->getModelTag(g));
+    verts.push_back(c->createVertex(g, p, apf::Vector3(0,0,0)));
+  }
+  m->end(it);
+  return c;
+}
+
+void checkSame(apf::Mesh2* a, apf::MeshEntity* ea,
+    apf::Mesh2* b, apf::MeshEntity* eb)
+{
+  PCU_ALWAYS_ASSERT(a->getType(ea) == b->getType(eb));
+  for (int d = 1; d < a->getDimension(); ++d) {
+    apf::Downward da, db;
+    int n = a->getDownward(ea, d, da);
+    PCU_ALWAYS_ASSERT(b->getDownward(eb, d, db) == n);
+    for (int i = 0; i < n; ++i) {
+      apf::Downward va, vb;
+      int nv = a->getDownward(da[i], 0, va);
+      b->getDownward(db[i], 0, vb);
+      for (int j = 0; j < nv; ++j)
+        PCU_ALWAYS_ASSERT(apf::getMdsIndex(a, va[j]) ==
+                          apf::getMdsIndex(b, vb[j]));
+    }
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  int dim = m->getDimension();
+  std::vector<apf::MeshEntity*> va, vb;
+  apf::Mesh2* a = copyVerts(argv[1], m, va);
+  apf::Mesh2* b = copyVerts(argv[1], m, vb);
+  apf::ModelEntity* interior = b->findModelEntity(dim, 0);
+  for (int t = 0; t < apf::Mesh::TYPES; ++t) {
+    if (apf::Mesh::typeDimension[t] != dim)
+      continue;
+    int nv = apf::Mesh::adjacentCount[t][0];
+    std::vector<apf::MeshEntity*> conn;
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(dim);
+    while ((e = m->iterate(it))) {
+      if (m->getType(e) != t)
+        continue;
+      apf::Downward v;
+      m->getDownward(e, 0, v);
+      for (int i = 0; i < nv; ++i)
+        conn.push_back(vb[apf::getMdsIndex(m, v[i])]);
+    }
+    m->end(it);
+    int n = conn.size() / nv;
+    if (!n)
+      continue;
+    std::vector<apf::MeshEntity*> ea(n), eb(n);
+    for (int i = 0; i < n; ++i) {
+      apf::Downward v;
+      for (int j = 0; j < nv; ++j)
+        v[j] = va[apf::getMdsIndex(b, conn[i * nv + j])];
+      ea[i] = apf::buildElement(a, a->findModelEntity(dim, 0), t, v);
+    }
+    apf::buildElements(b, interior, t, n, &conn[0], &eb[0]);
+    for (int i = 0; i < n; ++i)
+      checkSame(a, ea[i], b, eb[i]);
+    /* building again finds what is already there */
+    std::vector<apf::MeshEntity*> again(n);
+    apf::buildElements(b, interior, t, n, &conn[0], &again[0]);
+    PCU_ALWAYS_ASSERT(again == eb);
+  }
+  for (int d = 0; d <= dim; ++d) {
+    PCU_ALWAYS_ASSERT(a->count(d) == m->count(d));
+    PCU_ALWAYS_ASSERT(b->count(d) == m->count(d));
+  }
+  a->destroyNative();
+  apf::destroyMesh(a);
+  b->destroyNative();
+  apf::destroyMesh(b);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  if (!PCU_Comm_Self())
+    printf("bulk and one-at-a-time construction agree\n");
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,44 @@
+#include "spikedChain.h"
+#include <apf.h>
+#include <apfMesh2.h>
+#include <gmi_null.h>
+#include <parma.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* builds a chain of slabs of tets with most of them on part 0
+   and balances the elements when part 0 should hold twice the
+   weight of the others, as a faster rank would */
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  gmi_register_null();
+  Parma_SetCapacities(PCU_Comm_Self() ? 1.0 : 2.0);
+  apf::Mesh2* m = makeSpikedChain();
+  apf::MeshTag* weights = setWeights(m);
+  double before = Parma_GetWeightedEntImbalance(m, weights, 3);
+  apf::Balancer* balancer = Parma_MakeElmFlowBalancer(m, 1.0, 1);
+  balancer->balance(weights, 1.05);
+  delete balancer;
+  double after = Parma_GetWeightedEntImbalance(m, weights, 3);
+  Parma_PrintWeightedPtnStats(m, weights, "capacity");
+  double elms = m->count(3);
+  double share = elms / PCU_Add_Double(elms);
+  double spikeShare = PCU_Max_Double(PCU_Comm_Self() ? 0 : share);
+  if (!PCU_Comm_Self())
+    printf("element imbalance %.3f -> %.3f, part 0 holds %.3f\n",
+        before, after, spikeShare);
+  PCU_ALWAYS_ASSERT(after < 1.10);
+  /* 2 of 2 + (peers - 1) shares */
+  double want = 2.0 / (PCU_Comm_Peers() + 1);
+  PCU_ALWAYS_ASSERT(spikeShare > want / 1.10 && spikeShare < want * 1.10);
+  m->verify();
+  apf::removeTagFromDimension(m, weights, m->getDimension());
+  m->destroyTag(weights);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
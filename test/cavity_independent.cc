@@ -0,0 +1,72 @@
+#include <apf.h>
+#include <apfCavityOp.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* applies a vertex cavity operator with independent pulls
+   and checks that every vertex was visited exactly once */
+
+namespace {
+
+class VisitOp : public apf::CavityOp
+{
+  public:
+    VisitOp(apf::Mesh* m):
+      apf::CavityOp(m),
+      visits(0),
+      entity(0)
+    {
+      tag = m->createIntTag("visited", 1);
+      setIndependentPulls(true);
+    }
+    virtual Outcome setEntity(apf::MeshEntity* e)
+    {
+      entity = e;
+      if (mesh->hasTag(entity, tag))
+        return SKIP;
+      if ( ! requestLocality(&entity, 1))
+        return REQUEST;
+      return OK;
+    }
+    virtual void apply()
+    {
+      PCU_ALWAYS_ASSERT( ! mesh->isShared(entity));
+      int n = mesh->countUpward(entity);
+      mesh->setIntTag(entity, tag, &n);
+      ++visits;
+    }
+    apf::MeshTag* tag;
+    long visits;
+    apf::MeshEntity* entity;
+};
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  long total = PCU_Add_Long(apf::countOwned(m, 0));
+  VisitOp op(m);
+  op.applyToDimension(0);
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(op.visits) == total);
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(apf::countOwned(m, 0)) == total);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it)))
+    PCU_ALWAYS_ASSERT(m->hasTag(v, op.tag));
+  m->end(it);
+  apf::verify(m);
+  apf::removeTagFromDimension(m, op.tag, 0);
+  m->destroyTag(op.tag);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,95 @@
+#include <apf.h>
+#include <apfCavityOp.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* applies a vertex cavity operator on two threads per process,
+   when MPI allows it, and checks that every vertex was visited
+   exactly once and that the mesh is whole again afterwards */
+
+namespace {
+
+class VisitOp : public apf::CavityOp
+{
+  public:
+    VisitOp(apf::Mesh* m):
+      apf::CavityOp(m),
+      visits(0),
+      entity(0)
+    {
+      tag = m->createIntTag("visited", 1);
+    }
+    virtual Outcome setEntity(apf::MeshEntity* e)
+    {
+      entity = e;
+      if (mesh->hasTag(entity, tag))
+        return SKIP;
+      if ( ! requestLocality(&entity, 1))
+        return REQUEST;
+      return OK;
+    }
+    virtual void apply()
+    {
+      int n = mesh->countUpward(entity);
+      mesh->setIntTag(entity, tag, &n);
+      ++visits;
+    }
+    apf::MeshTag* tag;
+    long visits;
+    apf::MeshEntity* entity;
+};
+
+struct Visits
+{
+  int threads;
+  long counts[2];
+};
+
+void visit(apf::Mesh2* m, void* data)
+{
+  Visits* v = static_cast<Visits*>(data);
+  PCU_ALWAYS_ASSERT(PCU_Thrd_Peers() == v->threads);
+  PCU_ALWAYS_ASSERT(PCU_Comm_Peers() == PCU_Proc_Peers() * v->threads);
+  PCU_ALWAYS_ASSERT(m->count(m->getDimension()) > 0);
+  VisitOp op(m);
+  op.applyToDimension(0);
+  v->counts[PCU_Thrd_Self()] = op.visits;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  int provided;
+  MPI_Init_thread(&argc,&argv,MPI_THREAD_MULTIPLE,&provided);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  long vertices = PCU_Add_Long(apf::countOwned(m, 0));
+  long elements = PCU_Add_Long(m->count(m->getDimension()));
+  Visits v;
+  v.threads = provided == MPI_THREAD_MULTIPLE ? 2 : 1;
+  v.counts[0] = v.counts[1] = 0;
+  apf::runThreadedMdsMesh(m, m->getModel(), v.threads, visit, &v);
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(v.counts[0] + v.counts[1]) == vertices);
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(apf::countOwned(m, 0)) == vertices);
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(m->count(m->getDimension())) == elements);
+  apf::MeshTag* tag = m->findTag("visited");
+  PCU_ALWAYS_ASSERT(tag);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it)))
+    PCU_ALWAYS_ASSERT(m->hasTag(e, tag));
+  m->end(it);
+  apf::verify(m);
+  apf::removeTagFromDimension(m, tag, 0);
+  m->destroyTag(tag);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
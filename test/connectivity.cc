@@ -0,0 +1,89 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <map>
+#include <vector>
+
+/* compares the cached connectivity and classification tables of a
+   mesh with its adjacencies and classification, before and after
+   the mesh changes */
+
+namespace {
+
+void check(apf::Mesh* m, int dim)
+{
+  apf::Connectivity const& c = m->getConnectivity(dim);
+  PCU_ALWAYS_ASSERT(c.elements.size() == m->count(dim));
+  PCU_ALWAYS_ASSERT(c.offsets.size() == c.elements.size() + 1);
+  PCU_ALWAYS_ASSERT((size_t)c.offsets.back() == c.vertices.size());
+  apf::MeshIterator* it = m->begin(dim);
+  apf::MeshEntity* e;
+  size_t i = 0;
+  while ((e = m->iterate(it))) {
+    PCU_ALWAYS_ASSERT(c.elements[i] == e);
+    apf::Downward v;
+    int nv = m->getDownward(e, 0, v);
+    PCU_ALWAYS_ASSERT(c.offsets[i + 1] - c.offsets[i] == nv);
+    for (int j = 0; j < nv; ++j)
+      PCU_ALWAYS_ASSERT(c.vertices[c.offsets[i] + j] == v[j]);
+    ++i;
+  }
+  m->end(it);
+}
+
+void checkClassified(apf::Mesh* m, int dim)
+{
+  typedef std::map<apf::ModelEntity*, std::vector<apf::MeshEntity*> > On;
+  On on;
+  apf::MeshIterator* it = m->begin(dim);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it)))
+    on[m->toModel(e)].push_back(e);
+  m->end(it);
+  for (On::iterator i = on.begin(); i != on.end(); ++i) {
+    std::vector<apf::MeshEntity*> classified;
+    m->getClassified(i->first, dim, classified);
+    PCU_ALWAYS_ASSERT(classified == i->second);
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    check(m, d);
+    checkClassified(m, d);
+  }
+  apf::MeshEntity* v = m->createVert(0);
+  check(m, 0);
+  checkClassified(m, 0);
+  m->destroy(v);
+  check(m, 0);
+  checkClassified(m, 0);
+  m->acceptChanges();
+  check(m, m->getDimension());
+  apf::MeshIterator* it = m->begin(0);
+  v = m->iterate(it);
+  m->end(it);
+  it = m->begin(m->getDimension());
+  apf::ModelEntity* interior = m->toModel(m->iterate(it));
+  m->end(it);
+  apf::ModelEntity* c = m->toModel(v);
+  m->setModelEntity(v, interior);
+  checkClassified(m, 0);
+  m->setModelEntity(v, c);
+  checkClassified(m, 0);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,127 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfNumbering.h>
+#include <apfShape.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+
+/* copies a distributed box with apf::createMdsMesh on one and on
+   several threads and checks that entities, classification, remotes,
+   fields, numberings and tags come across in order */
+
+namespace {
+
+void decorate(apf::Mesh2* m)
+{
+  apf::Field* f = apf::createField(m, "u", apf::VECTOR,
+      apf::getLagrange(2));
+  apf::Numbering* n = apf::createNumbering(m, "n", m->getShape(), 1);
+  apf::MeshTag* t = m->createLongTag("t", 2);
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    int i = 0;
+    while ((e = m->iterate(it))) {
+      apf::Vector3 x = apf::getLinearCentroid(m, e);
+      if (d <= 1)
+        apf::setVector(f, e, 0, x * (d + 1));
+      if (d == 0)
+        apf::number(n, e, 0, 0, i);
+      if (i % 3 == 0) {
+        long v[2] = {d, i};
+        m->setLongTag(e, t, v);
+      }
+      ++i;
+    }
+    m->end(it);
+  }
+}
+
+void compare(apf::Mesh* a, apf::Mesh* b)
+{
+  apf::Field* fa = a->findField("u");
+  apf::Field* fb = b->findField("u");
+  apf::Numbering* na = a->findNumbering("n");
+  apf::Numbering* nb = b->findNumbering("n");
+  apf::MeshTag* ta = a->findTag("t");
+  apf::MeshTag* tb = b->findTag("t");
+  PCU_ALWAYS_ASSERT(fb && nb && tb);
+  PCU_ALWAYS_ASSERT(!b->findTag("apf_convert_index"));
+  for (int d = 0; d <= a->getDimension(); ++d) {
+    PCU_ALWAYS_ASSERT(a->count(d) == b->count(d));
+    apf::MeshIterator* ia = a->begin(d);
+    apf::MeshIterator* ib = b->begin(d);
+    apf::MeshEntity* ea;
+    while ((ea = a->iterate(ia))) {
+      apf::MeshEntity* eb = b->iterate(ib);
+      PCU_ALWAYS_ASSERT(a->getType(ea) == b->getType(eb));
+      apf::ModelEntity* ga = a->toModel(ea);
+      apf::ModelEntity* gb = b->toModel(eb);
+      PCU_ALWAYS_ASSERT(a->getModelType(ga) == b->getModelType(gb));
+      PCU_ALWAYS_ASSERT(a->getModelTag(ga) == b->getModelTag(gb));
+      apf::Vector3 xa = apf::getLinearCentroid(a, ea);
+      apf::Vector3 xb = apf::getLinearCentroid(b, eb);
+      PCU_ALWAYS_ASSERT((xa - xb).getLength() == 0);
+      apf::Copies ra, rb;
+      a->getRemotes(ea, ra);
+      b->getRemotes(eb, rb);
+      PCU_ALWAYS_ASSERT(ra.size() == rb.size());
+      apf::Parts pa, pb;
+      a->getResidence(ea, pa);
+      b->getResidence(eb, pb);
+      PCU_ALWAYS_ASSERT(pa == pb);
+      if (d <= 1) {
+        apf::Vector3 va, vb;
+        apf::getVector(fa, ea, 0, va);
+        apf::getVector(fb, eb, 0, vb);
+        PCU_ALWAYS_ASSERT((va - vb).getLength() == 0);
+      }
+      if (d == 0)
+        PCU_ALWAYS_ASSERT(apf::getNumber(na, ea, 0, 0) ==
+                          apf::getNumber(nb, eb, 0, 0));
+      PCU_ALWAYS_ASSERT(a->hasTag(ea, ta) == b->hasTag(eb, tb));
+      if (a->hasTag(ea, ta)) {
+        long la[2], lb[2];
+        a->getLongTag(ea, ta, la);
+        b->getLongTag(eb, tb, lb);
+        PCU_ALWAYS_ASSERT(la[0] == lb[0] && la[1] == lb[1]);
+      }
+    }
+    PCU_ALWAYS_ASSERT(!b->iterate(ib));
+    a->end(ia);
+    b->end(ib);
+  }
+}
+
+void test(apf::Mesh2* m, int threads)
+{
+  double t0 = PCU_Time();
+  apf::Mesh2* b = apf::createMdsMesh(m->getModel(), m, threads);
+  double t = PCU_Max_Double(PCU_Time() - t0);
+  apf::disownMdsModel(b);
+  apf::verify(b);
+  compare(m, b);
+  if (!PCU_Comm_Self())
+    printf("%d thread(s): copied in %f seconds\n", threads, t);
+  b->destroyNative();
+  apf::destroyMesh(b);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  apf::Mesh2* m = apf::makeDistributedMdsBox(10, 10, 10, 1, 1, 1, true);
+  decorate(m);
+  test(m, 1);
+  test(m, 4);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -1,5 +1,8 @@
 #include <apfMatrix.h>
+#include <mth.h>
+#include <mthEigen.h>
 #include <algorithm>
+#include <cmath>
 #include <pcu_util.h>
 
 struct Input {
@@ -125,8 +128,79 @@ static double diffnormEigenVecs(apf::Matrix3x3 const& a, apf::Matrix3x3 const& b
   return n;
 }
 
+/* checks A Q = Q L, Q^T Q = I, det(Q) = 1 and the ordering
+   relative to the size of A, using the closed form and Jacobi */
+static void checkDecomposition(mth::Matrix<double,3,3> const& a)
+{
+  double scale = 0;
+  for (unsigned i = 0; i < 3; ++i)
+  for (unsigned j = 0; j < 3; ++j)
+    scale = std::max(scale, std::fabs(a(i,j)));
+  if (scale == 0)
+    scale = 1;
+  mth::Vector<double,3> l;
+  mth::Matrix<double,3,3> q;
+  mth::eigenSymmetric(a, l, q);
+  mth::Vector<double,3> lj;
+  mth::Matrix<double,3,3> qj;
+  PCU_ALWAYS_ASSERT(mth::eigenJacobi(a, lj, qj, 50));
+  PCU_ALWAYS_ASSERT(l(0) <= l(1) && l(1) <= l(2));
+  for (unsigned k = 0; k < 3; ++k) {
+    PCU_ALWAYS_ASSERT(std::fabs(l(k) - lj(k)) < 1e-12 * scale);
+    for (unsigned i = 0; i < 3; ++i) {
+      double aq = 0;
+      for (unsigned j = 0; j < 3; ++j)
+        aq += a(i,j) * q(j,k);
+      PCU_ALWAYS_ASSERT(std::fabs(aq - q(i,k) * l(k)) < 1e-12 * scale);
+    }
+    for (unsigned m = 0; m < 3; ++m) {
+      double d = 0;
+      for (unsigned i = 0; i < 3; ++i)
+        d += q(i,k) * q(i,m);
+      PCU_ALWAYS_ASSERT(std::fabs(d - (k == m ? 1 : 0)) < 1e-12);
+    }
+  }
+  PCU_ALWAYS_ASSERT(std::fabs(mth::determinant(q) - 1) < 1e-12);
+}
+
+/* R diag(l) R^T for a rotation R that mixes all axes */
+static mth::Matrix<double,3,3> rotated(double l0, double l1, double l2)
+{
+  apf::Matrix3x3 R = apf::rotate(apf::Vector3(1,2,3).normalize(), 0.7);
+  apf::Matrix3x3 L(l0,0,0, 0,l1,0, 0,0,l2);
+  apf::Matrix3x3 A = R * L * apf::transpose(R);
+  mth::Matrix<double,3,3> a;
+  for (unsigned i = 0; i < 3; ++i)
+  for (unsigned j = 0; j < 3; ++j)
+    a(i,j) = A[i][j];
+  return a;
+}
+
+static void checkHardCases()
+{
+  double const cases[][3] = {
+    {0, 0, 0},
+    {3, 3, 3},
+    {1, 2, 3},
+    {1, 1, 4},
+    {-2, 5, 5},
+    {1, 1 + 1e-7, 2},
+    {1, 1 + 1e-9, 1 + 2e-9},
+    {-5, 0, 1e-20},
+    {1e-200, 2e-200, 4e-200},
+    {1e200, -1e200, 3e200}};
+  int n = sizeof(cases) / sizeof(cases[0]);
+  for (int i = 0; i < n; ++i)
+    checkDecomposition(rotated(cases[i][0], cases[i][1], cases[i][2]));
+  mth::Matrix<double,3,3> d;
+  d.zero();
+  d(0,0) = 2; d(1,1) = -1; d(2,2) = 2;
+  checkDecomposition(d);
+}
+
 int main()
 {
+  checkHardCases();
   for (int i = 0; i < NINPUTS; ++i) {
     apf::Matrix3x3 A(&(inputs[i].A[0]));
     apf::Matrix3x3 V(&(inputs[i].V[0]));
@@ -0,0 +1,89 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* moves one mesh element and one field element over all
+   entities of a mesh and compares them with fresh ones */
+
+namespace {
+
+void fill(apf::Field* f)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  apf::FieldShape* s = apf::getShape(f);
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    if (!s->hasNodesIn(d))
+      continue;
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      apf::Vector3 x = apf::getLinearCentroid(m, e);
+      int n = s->countNodesOn(m->getType(e));
+      for (int i = 0; i < n; ++i)
+        apf::setScalar(f, e, i, x[0] * x[0] + x[1] * x[2] + i);
+    }
+    m->end(it);
+  }
+}
+
+void test(apf::Mesh* m, int dim)
+{
+  apf::Field* f = apf::createField(m, "rebind", apf::SCALAR,
+      apf::getLagrange(2));
+  fill(f);
+  apf::MeshElement* me = 0;
+  apf::Element* fe = 0;
+  apf::Vector3 xi(0.2, 0.3, 0.1);
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(dim);
+  while ((e = m->iterate(it))) {
+    if (me) {
+      apf::rebindMeshElement(me, e);
+      apf::rebindElement(fe, me);
+    } else {
+      me = apf::createMeshElement(m, e);
+      fe = apf::createElement(f, me);
+    }
+    apf::MeshElement* me2 = apf::createMeshElement(m, e);
+    apf::Element* fe2 = apf::createElement(f, me2);
+    PCU_ALWAYS_ASSERT(apf::getMeshEntity(me) == e);
+    PCU_ALWAYS_ASSERT(apf::getMeshEntity(fe) == e);
+    PCU_ALWAYS_ASSERT(apf::getMeshElement(fe) == me);
+    PCU_ALWAYS_ASSERT(apf::getDV(me, xi) == apf::getDV(me2, xi));
+    PCU_ALWAYS_ASSERT(apf::getScalar(fe, xi) == apf::getScalar(fe2, xi));
+    apf::Vector3 g, g2;
+    apf::getGrad(fe, xi, g);
+    apf::getGrad(fe2, xi, g2);
+    for (int i = 0; i < 3; ++i)
+      PCU_ALWAYS_ASSERT(g[i] == g2[i]);
+    apf::destroyElement(fe2);
+    apf::destroyMeshElement(me2);
+  }
+  m->end(it);
+  if (me) {
+    apf::destroyElement(fe);
+    apf::destroyMeshElement(me);
+  }
+  apf::destroyField(f);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  for (int d = 1; d <= m->getDimension(); ++d)
+    test(m, d);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,62 @@
+#include "spikedChain.h"
+#include <apf.h>
+#include <apfMesh2.h>
+#include <gmi_null.h>
+#include <parma.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* builds a chain of slabs of tets with most of them on part 0
+   and balances the elements with and without a penalty on the
+   communication cost, which should keep the largest part
+   boundary no bigger */
+
+namespace {
+
+int getMaxShared(apf::Mesh* m) {
+  int loc, min, max;
+  long tot;
+  double avg;
+  Parma_GetSharedBdryVtxStats(m, loc, tot, min, max, avg);
+  return max;
+}
+
+void balance(bool comm, double& before, double& imb, int& shared)
+{
+  apf::Mesh2* m = makeSpikedChain();
+  apf::MeshTag* weights = setWeights(m);
+  before = Parma_GetWeightedEntImbalance(m, weights, 3);
+  apf::Balancer* balancer = comm ?
+    Parma_MakeElmCommBalancer(m, 0.5, 0.1, 1) :
+    Parma_MakeElmBalancer(m, 0.1, 1);
+  balancer->balance(weights, 1.05);
+  delete balancer;
+  imb = Parma_GetWeightedEntImbalance(m, weights, 3);
+  shared = getMaxShared(m);
+  m->verify();
+  apf::removeTagFromDimension(m, weights, m->getDimension());
+  m->destroyTag(weights);
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  gmi_register_null();
+  double before, plainImb, commImb;
+  int plainShared, commShared;
+  balance(false, before, plainImb, plainShared);
+  balance(true, before, commImb, commShared);
+  if (!PCU_Comm_Self())
+    printf("elements: imbalance %.3f max shared %d, "
+           "communication: imbalance %.3f max shared %d\n",
+           plainImb, plainShared, commImb, commShared);
+  PCU_ALWAYS_ASSERT(commImb < before);
+  PCU_ALWAYS_ASSERT(commShared <= plainShared);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,39 @@
+#include "spikedChain.h"
+#include <apf.h>
+#include <apfMesh2.h>
+#include <gmi_null.h>
+#include <parma.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdlib>
+
+/* builds a chain of slabs of tets with most of them on part 0,
+   so the last part is several hops from the spike, and balances
+   the elements with planned flows, optionally scoring the
+   selector's cavities on several threads */
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  gmi_register_null();
+  if (argc > 1)
+    Parma_SetSelectorThreads(atoi(argv[1]));
+  apf::Mesh2* m = makeSpikedChain();
+  apf::MeshTag* weights = setWeights(m);
+  double before = Parma_GetWeightedEntImbalance(m, weights, 3);
+  apf::Balancer* balancer = Parma_MakeElmFlowBalancer(m, 1.0, 1);
+  balancer->balance(weights, 1.05);
+  delete balancer;
+  double after = Parma_GetWeightedEntImbalance(m, weights, 3);
+  if (!PCU_Comm_Self())
+    printf("element imbalance %.3f -> %.3f\n", before, after);
+  PCU_ALWAYS_ASSERT(after < 1.10);
+  m->verify();
+  apf::removeTagFromDimension(m, weights, m->getDimension());
+  m->destroyTag(weights);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
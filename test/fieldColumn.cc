@@ -0,0 +1,185 @@
+#include <apf.h>
+#include <apfConvert.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <apfNumbering.h>
+#include <apfShape.h>
+#include <gmi_null.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <vector>
+
+/* builds a box of tets spread over the ranks in two different
+   ways, writes a linear vector field of one by the global vertex
+   ids and a quadratic packed field by the default numbering, then
+   reads the first into the other mesh and the second back into
+   the same mesh and checks all node values */
+
+namespace {
+
+int const n = 4;
+
+int const cubeTets[6][4] = {
+  {0,1,3,7},{0,1,7,5},{0,5,7,4},{0,3,2,7},{0,2,6,7},{0,6,4,7}};
+
+int vtxId(int i, int j, int k)
+{
+  return i + (j + k * (n + 1)) * (n + 1);
+}
+
+/* element e goes to rank e % peers if (strided),
+   otherwise the ranks get consecutive runs of elements */
+apf::Mesh2* makeBox(bool strided, apf::GlobalToVert& gv)
+{
+  int self = PCU_Comm_Self();
+  int peers = PCU_Comm_Peers();
+  int nelem = 6 * n * n * n;
+  std::vector<int> conn;
+  int e = 0;
+  for (int k = 0; k < n; ++k)
+  for (int j = 0; j < n; ++j)
+  for (int i = 0; i < n; ++i)
+  for (int t = 0; t < 6; ++t, ++e) {
+    int rank = strided ? e % peers : long(e) * peers / nelem;
+    if (rank != self)
+      continue;
+    for (int q = 0; q < 4; ++q) {
+      int b = cubeTets[t][q];
+      conn.push_back(vtxId(i + (b & 1), j + ((b >> 1) & 1), k + ((b >> 2) & 1)));
+    }
+  }
+  apf::Mesh2* m = apf::makeEmptyMdsMesh(gmi_load(".null"), 3, false);
+  apf::construct(m, conn.empty() ? 0 : &conn[0], conn.size() / 4,
+      apf::Mesh::TET, gv);
+  apf::alignMdsRemotes(m);
+  int nverts = (n + 1) * (n + 1) * (n + 1);
+  int quotient = nverts / peers;
+  int first = quotient * self;
+  int count = quotient;
+  if (self == peers - 1)
+    count += nverts % peers;
+  std::vector<double> xyz;
+  for (int v = first; v < first + count; ++v) {
+    xyz.push_back(v % (n + 1));
+    xyz.push_back((v / (n + 1)) % (n + 1));
+    xyz.push_back(v / ((n + 1) * (n + 1)));
+  }
+  apf::setCoords(m, xyz.empty() ? 0 : &xyz[0], count, gv);
+  apf::deriveMdsModel(m);
+  m->acceptChanges();
+  m->verify();
+  return m;
+}
+
+apf::GlobalNumbering* numberByIds(apf::Mesh2* m, apf::GlobalToVert& gv)
+{
+  apf::GlobalNumbering* ids =
+    apf::createGlobalNumbering(m, "ids", apf::getLagrange(1));
+  APF_ITERATE(apf::GlobalToVert, gv, it)
+    apf::number(ids, it->second, 0, it->first);
+  return ids;
+}
+
+apf::Vector3 getU(apf::Vector3 const& x)
+{
+  return apf::Vector3(x[0], 2 * x[1], x[2] + x[0]);
+}
+
+void getQ(apf::Mesh* m, apf::MeshEntity* e, double* q)
+{
+  apf::Vector3 x = apf::getLinearCentroid(m, e);
+  q[0] = x[0] + 10 * x[1] + 100 * x[2];
+  q[1] = -q[0];
+}
+
+void setFields(apf::Mesh* m, apf::Field* u, apf::Field* q)
+{
+  for (int d = 0; d < 2; ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      double v[2];
+      getQ(m, e, v);
+      apf::setComponents(q, e, 0, v);
+      if (d == 0) {
+        apf::Vector3 x;
+        m->getPoint(e, 0, x);
+        apf::setVector(u, e, 0, getU(x));
+      }
+    }
+    m->end(it);
+  }
+}
+
+void checkU(apf::Mesh* m, apf::Field* u)
+{
+  PCU_ALWAYS_ASSERT(apf::getValueType(u) == apf::VECTOR);
+  PCU_ALWAYS_ASSERT(apf::getShape(u) == apf::getLagrange(1));
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    apf::Vector3 x, v;
+    m->getPoint(e, 0, x);
+    apf::getVector(u, e, 0, v);
+    PCU_ALWAYS_ASSERT((v - getU(x)).getLength() == 0);
+  }
+  m->end(it);
+}
+
+void checkQ(apf::Mesh* m, apf::Field* q)
+{
+  PCU_ALWAYS_ASSERT(apf::getValueType(q) == apf::PACKED);
+  PCU_ALWAYS_ASSERT(apf::countComponents(q) == 2);
+  PCU_ALWAYS_ASSERT(apf::getShape(q) == apf::getLagrange(2));
+  for (int d = 0; d < 2; ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      double v[2], w[2];
+      getQ(m, e, v);
+      apf::getComponents(q, e, 0, w);
+      PCU_ALWAYS_ASSERT(v[0] == w[0] && v[1] == w[1]);
+    }
+    m->end(it);
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 1);
+  gmi_register_null();
+  apf::GlobalToVert gva, gvb;
+  apf::Mesh2* a = makeBox(true, gva);
+  apf::Mesh2* b = makeBox(false, gvb);
+  apf::Field* u = apf::createFieldOn(a, "u", apf::VECTOR);
+  apf::Field* q = apf::createPackedField(a, "q", 2, apf::getLagrange(2));
+  setFields(a, u, q);
+  apf::GlobalNumbering* ids = numberByIds(a, gva);
+  apf::writeFieldColumn(u, "u.apfc", ids);
+  apf::destroyGlobalNumbering(ids);
+  apf::writeFieldColumn(q, "q.apfc");
+  apf::destroyField(q);
+  ids = numberByIds(b, gvb);
+  checkU(b, apf::readFieldColumn(b, "u.apfc", ids));
+  apf::destroyGlobalNumbering(ids);
+  checkQ(a, apf::readFieldColumn(a, "q.apfc"));
+  /* an existing field is overwritten in place */
+  apf::zeroField(u);
+  ids = numberByIds(a, gva);
+  PCU_ALWAYS_ASSERT(apf::readFieldColumn(a, "u.apfc", ids) == u);
+  apf::destroyGlobalNumbering(ids);
+  checkU(a, u);
+  a->destroyNative();
+  apf::destroyMesh(a);
+  b->destroyNative();
+  apf::destroyMesh(b);
+  if (!PCU_Comm_Self())
+    printf("fields written and read as columns\n");
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,98 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <apfNumbering.h>
+#include <apfShape.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* freezes a field into arrays ordered by given numberings
+   and checks the values land where the numberings say,
+   through refreezing, synchronization and unfreezing */
+
+namespace {
+
+apf::Vector3 value(apf::Field* f, apf::MeshEntity* e, int node)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  apf::Vector3 x;
+  apf::getShape(f)->getNodeXi(m->getType(e), node, x);
+  apf::Vector3 c = apf::getLinearCentroid(m, e);
+  return c + x * 0.01;
+}
+
+void check(apf::Field* f, apf::Numbering* n)
+{
+  double const* a = apf::getArrayData(f);
+  PCU_ALWAYS_ASSERT(apf::getArrayNumbering(f) == n);
+  apf::DynamicArray<apf::Node> nodes;
+  apf::getNodes(n, nodes);
+  for (size_t i = 0; i < nodes.getSize(); ++i) {
+    apf::MeshEntity* e = nodes[i].entity;
+    int node = nodes[i].node;
+    int k = apf::getNumber(n, e, node, 0);
+    apf::Vector3 want = value(f, e, node);
+    apf::Vector3 got;
+    apf::getVector(f, e, node, got);
+    for (int c = 0; c < 3; ++c) {
+      PCU_ALWAYS_ASSERT(a[k * 3 + c] == want[c]);
+      PCU_ALWAYS_ASSERT(got[c] == want[c]);
+    }
+  }
+}
+
+/* numbers all nodes in the reverse of the overlap order */
+apf::Numbering* reverse(apf::Mesh* m, apf::FieldShape* s)
+{
+  apf::Numbering* fwd = apf::numberOverlapNodes(m, "fwd", s);
+  apf::Numbering* rev = apf::createNumbering(m, "rev", s, 1);
+  int count = apf::countNodes(fwd);
+  apf::DynamicArray<apf::Node> nodes;
+  apf::getNodes(fwd, nodes);
+  for (size_t i = 0; i < nodes.getSize(); ++i) {
+    apf::MeshEntity* e = nodes[i].entity;
+    int node = nodes[i].node;
+    apf::number(rev, e, node, 0,
+        count - 1 - apf::getNumber(fwd, e, node, 0));
+  }
+  apf::destroyNumbering(fwd);
+  return rev;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  apf::FieldShape* s = apf::getLagrange(2);
+  apf::Field* f = apf::createField(m, "array", apf::VECTOR, s);
+  apf::Numbering* own = apf::numberOverlapNodes(m, "own", s);
+  apf::Numbering* rev = reverse(m, s);
+  apf::DynamicArray<apf::Node> nodes;
+  apf::getNodes(own, nodes);
+  for (size_t i = 0; i < nodes.getSize(); ++i)
+    apf::setVector(f, nodes[i].entity, nodes[i].node,
+        value(f, nodes[i].entity, nodes[i].node));
+  apf::freeze(f, own);
+  check(f, own);
+  apf::freeze(f, rev);
+  check(f, rev);
+  apf::synchronize(f);
+  check(f, rev);
+  apf::unfreeze(f);
+  PCU_ALWAYS_ASSERT( ! apf::getArrayNumbering(f));
+  apf::freeze(f, own);
+  check(f, own);
+  apf::destroyField(f);
+  apf::destroyNumbering(rev);
+  apf::destroyNumbering(own);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,100 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <apfFieldHistory.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+/* stores a time series of a quadratic field in histories,
+   exact and within a tolerance, restores every step in
+   reverse order and reports the memory against full copies */
+
+namespace {
+
+int const steps = 48;
+
+double wave(apf::Vector3 const& x, int step)
+{
+  double t = step * 0.01;
+  return std::sin(3 * x[0] + t) * std::cos(2 * x[1]) + x[2] * t;
+}
+
+void setWave(apf::Field* f, int step)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  for (int d = 0; d <= 1; ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it)))
+      apf::setScalar(f, e, 0, wave(apf::getLinearCentroid(m, e), step));
+    m->end(it);
+  }
+}
+
+double getError(apf::Field* f, int step)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  double error = 0;
+  for (int d = 0; d <= 1; ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      double x = wave(apf::getLinearCentroid(m, e), step);
+      error = std::max(error, std::fabs(apf::getScalar(f, e, 0) - x));
+    }
+    m->end(it);
+  }
+  return error;
+}
+
+void test(apf::Field* f, apf::Field* to, double tolerance, double ratio)
+{
+  apf::FieldHistory* h = apf::createFieldHistory(f, tolerance, 8);
+  for (int i = 0; i < steps; ++i) {
+    setWave(f, i);
+    PCU_ALWAYS_ASSERT(apf::addSnapshot(h) == i);
+  }
+  PCU_ALWAYS_ASSERT(apf::countSnapshots(h) == steps);
+  for (int i = steps - 1; i >= 0; --i) {
+    apf::getSnapshot(h, i, to);
+    PCU_ALWAYS_ASSERT(getError(to, i) <= tolerance);
+  }
+  apf::getSnapshot(h, 3);
+  PCU_ALWAYS_ASSERT(getError(f, 3) <= tolerance);
+  double copies = apf::countSnapshotValues(h) * sizeof(double) * steps;
+  double bytes = apf::getHistoryBytes(h);
+  copies = PCU_Add_Double(copies);
+  bytes = PCU_Add_Double(bytes);
+  if (!PCU_Comm_Self())
+    printf("tolerance %g: %.0f bytes, %.2fx smaller than copies\n",
+        tolerance, bytes, copies / bytes);
+  PCU_ALWAYS_ASSERT(copies / bytes > ratio);
+  apf::destroyFieldHistory(h);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  apf::Mesh2* m = apf::makeDistributedMdsBox(8, 8, 8, 1, 1, 1, true);
+  apf::Field* f = apf::createField(m, "u", apf::SCALAR,
+      apf::getLagrange(2));
+  apf::zeroField(f);
+  apf::Field* to = apf::createField(m, "v", apf::SCALAR,
+      apf::getLagrange(2));
+  test(f, to, 0, 1);
+  test(f, to, 1e-6, 4);
+  apf::destroyField(to);
+  apf::destroyField(f);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
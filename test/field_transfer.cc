@@ -0,0 +1,135 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfSearch.h>
+#include <apfShape.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+/* transfers a linear function between boxes of different
+   resolution and element type, which must reproduce it */
+
+namespace {
+
+double linear(apf::Vector3 const& x)
+{
+  return 1 + x[0] + 2 * x[1] + 3 * x[2];
+}
+
+apf::Field* makeField(apf::Mesh* m, const char* name, int order)
+{
+  apf::Field* f = apf::createField(m, name, apf::SCALAR,
+      apf::getLagrange(order));
+  apf::zeroField(f);
+  return f;
+}
+
+void setLinear(apf::Field* f)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  apf::MeshEntity* v;
+  apf::MeshIterator* it = m->begin(0);
+  while ((v = m->iterate(it))) {
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    apf::setScalar(f, v, 0, linear(x));
+  }
+  m->end(it);
+}
+
+double getError(apf::Field* f)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  apf::FieldShape* s = apf::getShape(f);
+  double error = 0;
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    if (!s->hasNodesIn(d))
+      continue;
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      int type = m->getType(e);
+      for (int n = 0; n < s->countNodesOn(type); ++n) {
+        apf::Vector3 x;
+        if (d) {
+          apf::Vector3 xi;
+          s->getNodeXi(type, n, xi);
+          apf::MeshElement* me = apf::createMeshElement(m, e);
+          apf::mapLocalToGlobal(me, xi, x);
+          apf::destroyMeshElement(me);
+        } else {
+          m->getPoint(e, 0, x);
+        }
+        double value = apf::getScalar(f, e, n);
+        error = std::max(error, std::fabs(value - linear(x)));
+      }
+    }
+    m->end(it);
+  }
+  return PCU_Max_Double(error);
+}
+
+void checkLocate(apf::Mesh* m)
+{
+  apf::ElementTree* t = apf::createElementTree(m);
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    apf::Vector3 x = apf::getLinearCentroid(m, e);
+    apf::Vector3 xi;
+    double outside;
+    apf::MeshEntity* found = apf::locatePoint(t, x, xi, &outside);
+    PCU_ALWAYS_ASSERT(found == e);
+    PCU_ALWAYS_ASSERT(outside == 0);
+    apf::MeshElement* me = apf::createMeshElement(m, e);
+    apf::Vector3 y;
+    apf::mapLocalToGlobal(me, xi, y);
+    apf::destroyMeshElement(me);
+    PCU_ALWAYS_ASSERT((x - y).getLength() < 1e-12);
+  }
+  m->end(it);
+  apf::Vector3 far(10, 10, 10);
+  apf::Vector3 xi;
+  PCU_ALWAYS_ASSERT(!apf::locatePoint(t, far, xi));
+  apf::destroyElementTree(t);
+}
+
+void transfer(apf::Mesh* from, apf::Mesh* to, int order)
+{
+  apf::Field* a = makeField(from, "from", 1);
+  setLinear(a);
+  apf::Field* b = makeField(to, "to", order);
+  long missing = apf::transferField(a, b);
+  double error = getError(b);
+  if (!PCU_Comm_Self())
+    printf("order %d: %ld missing, max error %e\n", order, missing, error);
+  PCU_ALWAYS_ASSERT(missing == 0);
+  PCU_ALWAYS_ASSERT(error < 1e-10);
+  apf::destroyField(a);
+  apf::destroyField(b);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  apf::Mesh2* tets = apf::makeDistributedMdsBox(4, 4, 4, 1, 1, 1, true);
+  apf::Mesh2* hexes = apf::makeDistributedMdsBox(3, 5, 6, 1, 1, 1, false);
+  checkLocate(tets);
+  checkLocate(hexes);
+  transfer(tets, hexes, 1);
+  transfer(tets, hexes, 2);
+  transfer(hexes, tets, 2);
+  hexes->destroyNative();
+  apf::destroyMesh(hexes);
+  tets->destroyNative();
+  apf::destroyMesh(tets);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,69 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <parma.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+
+/* scatters single elements of a distributed box into the next
+   part, where most of them are islands, and checks that
+   Parma_ProcessDisconnectedParts moves every island back in
+   one migration */
+
+namespace {
+
+void scatter(apf::Mesh2* m)
+{
+  apf::Migration* plan = new apf::Migration(m);
+  int to = (PCU_Comm_Self() + 1) % PCU_Comm_Peers();
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  apf::MeshEntity* e;
+  int i = 0;
+  while ((e = m->iterate(it)))
+    if (i++ % 37 == 5)
+      plan->send(e, to);
+  m->end(it);
+  m->migrate(plan);
+}
+
+int countDisconnected(apf::Mesh* m)
+{
+  int max, loc;
+  double avg;
+  Parma_GetDisconnectedStats(m, max, avg, loc);
+  return PCU_Add_Int(loc);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  apf::Mesh2* m = apf::makeDistributedMdsBox(12, 12, 12, 1, 1, 1, true);
+  long elements = m->count(3);
+  elements = PCU_Add_Long(elements);
+  scatter(m);
+  int before = countDisconnected(m);
+  long movedComps, movedElms;
+  double t0 = PCU_Time();
+  Parma_ProcessDisconnectedParts(m, movedComps, movedElms);
+  double t = PCU_Max_Double(PCU_Time() - t0);
+  int after = countDisconnected(m);
+  if (!PCU_Comm_Self())
+    printf("%d disconnected components before, %d after, "
+        "moved %ld components %ld elements in %f seconds\n",
+        before, after, movedComps, movedElms, t);
+  PCU_ALWAYS_ASSERT(PCU_Comm_Peers() == 1 || before > 0);
+  PCU_ALWAYS_ASSERT(after == 0);
+  PCU_ALWAYS_ASSERT(movedComps >= before);
+  long count = m->count(3);
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(count) == elements);
+  m->verify();
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
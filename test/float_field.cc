@@ -0,0 +1,122 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cmath>
+
+/* checks that a single precision field rounds its values to float
+   and otherwise behaves like a double field, through element
+   evaluation, synchronization, freezing, files and mesh clones */
+
+namespace {
+
+double value(apf::Mesh* m, apf::MeshEntity* e, int c)
+{
+  apf::Vector3 x = apf::getLinearCentroid(m, e);
+  return x[0] / 3 + x[1] * x[2] + c;
+}
+
+void fill(apf::Field* f, bool ownedOnly)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(0);
+  while ((e = m->iterate(it))) {
+    apf::Vector3 v(-1, -1, -1);
+    if ( ! ownedOnly || m->isOwned(e))
+      for (int c = 0; c < 3; ++c)
+        v[c] = value(m, e, c);
+    apf::setVector(f, e, 0, v);
+  }
+  m->end(it);
+}
+
+void check(apf::Field* f, apf::Field* d)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(0);
+  while ((e = m->iterate(it))) {
+    apf::Vector3 v;
+    apf::getVector(f, e, 0, v);
+    for (int c = 0; c < 3; ++c)
+      PCU_ALWAYS_ASSERT(v[c] == (float)value(m, e, c));
+  }
+  m->end(it);
+  it = m->begin(m->getDimension());
+  apf::Vector3 xi(0.25, 0.25, 0.25);
+  while ((e = m->iterate(it))) {
+    apf::MeshElement* me = apf::createMeshElement(m, e);
+    apf::Element* fe = apf::createElement(f, me);
+    apf::Element* de = apf::createElement(d, me);
+    apf::Vector3 a, b;
+    apf::getVector(fe, xi, a);
+    apf::getVector(de, xi, b);
+    for (int c = 0; c < 3; ++c)
+      PCU_ALWAYS_ASSERT(std::fabs(a[c] - b[c]) < 1e-6 * (1 + std::fabs(b[c])));
+    apf::destroyElement(de);
+    apf::destroyElement(fe);
+    apf::destroyMeshElement(me);
+  }
+  m->end(it);
+}
+
+/* the clone of the mesh data sent to new parts keeps the field
+   in int tags */
+void checkClone(apf::Mesh2* m)
+{
+  PCU_Comm_Begin();
+  apf::packDataClone(m, PCU_Comm_Self());
+  PCU_Comm_Send();
+  apf::Mesh2* c = 0;
+  while (PCU_Comm_Receive()) {
+    c = apf::makeEmptyMdsMesh(m->getModel(), m->getDimension(), false);
+    apf::unpackDataClone(c);
+  }
+  PCU_ALWAYS_ASSERT(c && c->findField("single"));
+  apf::MeshTag* t = c->findTag("single_ver");
+  PCU_ALWAYS_ASSERT(t && c->getTagType(t) == apf::Mesh::INT);
+  apf::disownMdsModel(c);
+  c->destroyNative();
+  apf::destroyMesh(c);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  apf::Field* f = apf::createFloatField(m, "single", apf::VECTOR, 0,
+      m->getShape());
+  apf::Field* d = apf::createFieldOn(m, "double", apf::VECTOR);
+  fill(f, true);
+  fill(d, false);
+  apf::synchronize(f);
+  check(f, d);
+  apf::freeze(f);
+  check(f, d);
+  apf::unfreeze(f);
+  check(f, d);
+  checkClone(m);
+  m->writeNative("float_field/");
+  m->destroyNative();
+  apf::destroyMesh(m);
+  m = apf::loadMdsMesh(argv[1], "float_field/");
+  f = m->findField("single");
+  d = m->findField("double");
+  PCU_ALWAYS_ASSERT(f && d);
+  check(f, d);
+  apf::destroyField(d);
+  apf::destroyField(f);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,81 @@
+#include "spikedChain.h"
+#include <apf.h>
+#include <apfMesh2.h>
+#include <gmi_null.h>
+#include <parma.h>
+#include <PCU.h>
+#include <pumi.h>
+#include <pcu_util.h>
+#include <cmath>
+
+/* builds a chain of slabs of tets with most of them on part 0,
+   ghosts a layer of elements with pumi and checks that the ghost
+   cost tag sums to each part's owned plus ghost elements, then
+   balances with that tag and measures the rebuilt layer */
+
+namespace {
+
+/* owned plus ghost elements on the largest part over the average */
+double getGhostedImbalance(apf::Mesh2* m) {
+  pumi_ghost_createLayer(m, 0, 3, 1, 1);
+  double work = m->count(3);
+  pumi_ghost_delete(m);
+  return PCU_Max_Double(work) / (PCU_Add_Double(work) / PCU_Comm_Peers());
+}
+
+/* balances by element count or by ghost cost and returns the
+   owned plus ghost imbalance of the result */
+double balance(bool ghosts, double& before)
+{
+  apf::Mesh2* m = makeSpikedChain();
+  /* the ghosting works on the mesh pumi holds */
+  pumi::instance()->mesh = m;
+  before = getGhostedImbalance(m);
+  pumi_ghost_createLayer(m, 0, 3, 1, 1);
+  double work = m->count(3);
+  apf::MeshTag* costs = Parma_WeighByGhosts(m, NULL);
+  pumi_ghost_delete(m);
+  double sum = 0;
+  apf::MeshIterator* it = m->begin(3);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    double cost;
+    m->getDoubleTag(e, costs, &cost);
+    sum += cost;
+    if (!ghosts) {
+      cost = 1;
+      m->setDoubleTag(e, costs, &cost);
+    }
+  }
+  m->end(it);
+  PCU_ALWAYS_ASSERT(fabs(sum - work) < 1e-9 * work);
+  apf::Balancer* balancer = Parma_MakeElmBalancer(m, 0.2, 1);
+  balancer->balance(costs, 1.05);
+  delete balancer;
+  apf::removeTagFromDimension(m, costs, 3);
+  m->destroyTag(costs);
+  double after = getGhostedImbalance(m);
+  m->verify();
+  m->destroyNative();
+  apf::destroyMesh(m);
+  return after;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  pumi_start();
+  gmi_register_null();
+  double before;
+  double plain = balance(false, before);
+  double ghosted = balance(true, before);
+  if (!PCU_Comm_Self())
+    printf("owned plus ghost imbalance %.3f, %.3f balancing elements, "
+           "%.3f balancing ghost costs\n", before, plain, ghosted);
+  PCU_ALWAYS_ASSERT(ghosted < before);
+  PCU_ALWAYS_ASSERT(ghosted <= plain);
+  pumi_finalize();
+  MPI_Finalize();
+}
@@ -0,0 +1,94 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <apfConvert.h>
+#include <gmi_null.h>
+#include <parma.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <vector>
+
+/* builds a box of tets whose cubes are dealt to the ranks in turn,
+   so every part touches every other, then repartitions it from
+   scratch with the global inertial bisection */
+
+namespace {
+
+int const n = 8;
+
+apf::Mesh2* makeScatteredBox()
+{
+  static int const cubeTets[6][4] = {
+    {0,1,3,7},{0,1,7,5},{0,5,7,4},{0,3,2,7},{0,2,6,7},{0,6,4,7}};
+  int self = PCU_Comm_Self();
+  int peers = PCU_Comm_Peers();
+  int nv = n + 1;
+  std::vector<int> conn;
+  for (int k = 0; k < n; ++k)
+  for (int j = 0; j < n; ++j)
+  for (int i = 0; i < n; ++i) {
+    if ((i + j * n + k * n * n) % peers != self)
+      continue;
+    int c[8];
+    for (int b = 0; b < 8; ++b)
+      c[b] = (i + (b & 1)) + (j + ((b >> 1) & 1)) * nv
+           + (k + ((b >> 2) & 1)) * nv * nv;
+    for (int t = 0; t < 6; ++t)
+      for (int q = 0; q < 4; ++q)
+        conn.push_back(c[cubeTets[t][q]]);
+  }
+  int verts = nv * nv * nv;
+  std::vector<double> x;
+  for (int v = self * verts / peers; v < (self + 1) * verts / peers; ++v) {
+    x.push_back(v % nv);
+    x.push_back((v / nv) % nv);
+    x.push_back(v / (nv * nv));
+  }
+  apf::Mesh2* m = apf::makeEmptyMdsMesh(gmi_load(".null"), 3, false);
+  apf::GlobalToVert g;
+  apf::construct(m, &conn[0], conn.size() / 4, apf::Mesh::TET, g);
+  apf::alignMdsRemotes(m);
+  apf::deriveMdsModel(m);
+  apf::setCoords(m, &x[0], x.size() / 3, g);
+  m->acceptChanges();
+  m->verify();
+  return m;
+}
+
+long countShared(apf::Mesh* m) {
+  long shared = 0;
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it)))
+    if (m->isShared(v))
+      ++shared;
+  m->end(it);
+  return PCU_Add_Long(shared);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  gmi_register_null();
+  apf::Mesh2* m = makeScatteredBox();
+  long sharedBefore = countShared(m);
+  apf::Migration* plan = Parma_PlanGlobalRib(m, NULL);
+  m->migrate(plan);
+  double elms = m->count(3);
+  double imb = PCU_Max_Double(elms) /
+    (PCU_Add_Double(elms) / PCU_Comm_Peers());
+  long sharedAfter = countShared(m);
+  if (!PCU_Comm_Self())
+    printf("element imbalance %.3f, shared vertices %ld -> %ld\n",
+        imb, sharedBefore, sharedAfter);
+  PCU_ALWAYS_ASSERT(imb < 1.05);
+  PCU_ALWAYS_ASSERT(sharedAfter < sharedBefore);
+  m->verify();
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,84 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <apfNumbering.h>
+#include <apfShape.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* compares the fused global numbering with numberOwnedNodes,
+   makeGlobal and synchronize, checks its local to global map
+   and that an order tag decides the order of owned nodes */
+
+namespace {
+
+void compare(apf::Mesh* m, apf::FieldShape* s)
+{
+  apf::Numbering* local = apf::numberOwnedNodes(m, "old", s);
+  apf::GlobalNumbering* old = apf::makeGlobal(local);
+  apf::synchronize(old);
+  apf::DynamicArray<long> map;
+  apf::GlobalNumbering* fused =
+    apf::numberGlobalNodes(m, "fused", s, 0, &map);
+  apf::Numbering* overlap = apf::numberOverlapNodes(m, "overlap", s);
+  apf::DynamicArray<apf::Node> nodes;
+  apf::getNodes(old, nodes);
+  PCU_ALWAYS_ASSERT(map.getSize() == nodes.getSize());
+  for (size_t i = 0; i < nodes.getSize(); ++i) {
+    long n = apf::getNumber(fused, nodes[i]);
+    PCU_ALWAYS_ASSERT(n == apf::getNumber(old, nodes[i]));
+    int k = apf::getNumber(overlap, nodes[i].entity, nodes[i].node, 0);
+    PCU_ALWAYS_ASSERT(map[k] == n);
+  }
+  apf::destroyNumbering(overlap);
+  apf::destroyGlobalNumbering(fused);
+  apf::destroyGlobalNumbering(old);
+}
+
+/* owned vertices tagged in reverse mesh order
+   get decreasing numbers in mesh order */
+void checkOrder(apf::Mesh* m)
+{
+  apf::MeshTag* order = m->createIntTag("order", 1);
+  int rank = m->count(0);
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(0);
+  while ((e = m->iterate(it))) {
+    --rank;
+    m->setIntTag(e, order, &rank);
+  }
+  m->end(it);
+  apf::GlobalNumbering* n = apf::numberGlobalNodes(m, "ordered",
+      apf::getLagrange(1), order);
+  long last = -1;
+  it = m->begin(0);
+  while ((e = m->iterate(it)))
+    if (m->isOwned(e)) {
+      long k = apf::getNumber(n, e, 0);
+      PCU_ALWAYS_ASSERT(last == -1 || k < last);
+      last = k;
+    }
+  m->end(it);
+  apf::destroyGlobalNumbering(n);
+  apf::removeTagFromDimension(m, order, 0);
+  m->destroyTag(order);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  compare(m, apf::getLagrange(1));
+  compare(m, apf::getLagrange(2));
+  checkOrder(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
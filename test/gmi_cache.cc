@@ -0,0 +1,83 @@
+#include <gmi_analytic.h>
+#include <gmi_cache.h>
+#include <pcu_util.h>
+#include <cmath>
+
+/* checks that the closest point cache answers repeats and nearby
+   points from the cache and everything else from the model */
+
+namespace {
+
+int calls = 0;
+
+void sphere(double const p[2], double x[3], void*)
+{
+  x[0] = std::cos(p[0]) * std::sin(p[1]);
+  x[1] = std::sin(p[0]) * std::sin(p[1]);
+  x[2] = std::cos(p[1]);
+}
+
+void closestOnSphere(gmi_model*, gmi_ent*, double const from[3],
+    double to[3], double to_p[2])
+{
+  ++calls;
+  double r = std::sqrt(from[0] * from[0] + from[1] * from[1] +
+      from[2] * from[2]);
+  for (int i = 0; i < 3; ++i)
+    to[i] = from[i] / r;
+  to_p[0] = std::atan2(to[1], to[0]);
+  to_p[1] = std::acos(to[2]);
+}
+
+void check(gmi_model* m, gmi_ent* e, double const from[3], long hits,
+    long misses)
+{
+  double to[3];
+  double to_p[2];
+  gmi_closest_point(m, e, from, to, to_p);
+  double x[3];
+  gmi_eval(m, e, to_p, x);
+  for (int i = 0; i < 3; ++i)
+    PCU_ALWAYS_ASSERT(std::fabs(x[i] - to[i]) < 1e-12);
+  long h, n;
+  gmi_cache_stats(m, &h, &n);
+  PCU_ALWAYS_ASSERT(h == hits);
+  PCU_ALWAYS_ASSERT(n == misses);
+  PCU_ALWAYS_ASSERT(calls == misses);
+}
+
+}
+
+int main()
+{
+  gmi_model* inner = gmi_make_analytic();
+  int periodic[2] = {1, 0};
+  double ranges[2][2] = {{0, 6.28318530718}, {0, 3.14159265359}};
+  gmi_ent* face = gmi_add_analytic(inner, 2, 0, sphere, periodic, ranges, 0);
+  gmi_ent* other = gmi_add_analytic(inner, 2, 1, sphere, periodic, ranges, 0);
+  gmi_model_ops ops = *inner->ops;
+  ops.closest_point = closestOnSphere;
+  inner->ops = &ops;
+  gmi_model* m = gmi_make_cached(inner, 1e-6);
+  PCU_ALWAYS_ASSERT(gmi_can_eval(m));
+  PCU_ALWAYS_ASSERT(gmi_can_get_closest_point(m));
+  PCU_ALWAYS_ASSERT(!gmi_has_normal(m));
+  PCU_ALWAYS_ASSERT(!gmi_is_thread_safe(m));
+  PCU_ALWAYS_ASSERT(gmi_find(m, 2, 1) == other);
+  double a[3] = {2, 1, 0.5};
+  double near[3] = {2, 1, 0.5 + 1e-8};
+  double far[3] = {2, 1, 0.6};
+  check(m, face, a, 0, 1);
+  check(m, face, a, 1, 1);
+  check(m, face, near, 2, 1);
+  check(m, face, far, 2, 2);
+  /* each model entity has its own cache */
+  check(m, other, a, 2, 3);
+  /* many points, more than one entity cache holds */
+  for (int i = 0; i < 100; ++i) {
+    double p[3] = {1, 0.01 * i, 0.3};
+    check(m, face, p, 2, 4 + i);
+  }
+  check(m, face, far, 2, 104);
+  gmi_destroy(m);
+}
@@ -0,0 +1,99 @@
+#include <gmi_analytic.h>
+#include <pcu_util.h>
+#include <cmath>
+
+/* checks that batched evaluation and re-parameterization
+   match gmi_eval and gmi_reparam, and that the built-in
+   primitives and batch functions match their formulas */
+
+namespace {
+
+void circle(double const p[2], double x[3], void*)
+{
+  x[0] = std::cos(p[0]);
+  x[1] = std::sin(p[0]);
+  x[2] = 0;
+}
+
+void sphere(double const p[2], double x[3], void*)
+{
+  x[0] = std::cos(p[0]) * std::sin(p[1]);
+  x[1] = std::sin(p[0]) * std::sin(p[1]);
+  x[2] = std::cos(p[1]);
+}
+
+void spheres(int n, double const* p, double* x, void*)
+{
+  for (int i = 0; i < n; ++i)
+    sphere(p + 2 * i, x + 3 * i, 0);
+}
+
+void torus(double const p[2], double x[3], void*)
+{
+  double w = 2 + 0.5 * std::cos(p[1]);
+  x[0] = w * std::cos(p[0]);
+  x[1] = w * std::sin(p[0]);
+  x[2] = 0.5 * std::sin(p[1]);
+}
+
+}
+
+int main()
+{
+  gmi_model* m = gmi_make_analytic();
+  int periodic[2] = {1, 0};
+  double ranges[2][2] = {{0, 6.28318530718}, {0, 3.14159265359}};
+  gmi_ent* edge = gmi_add_analytic(m, 1, 0, circle, periodic, ranges, 0);
+  gmi_ent* face = gmi_add_analytic(m, 2, 0, sphere, periodic, ranges, 0);
+  gmi_ent* batched = gmi_add_analytic(m, 2, 1, 0, periodic, ranges, 0);
+  gmi_set_analytic_batch(m, batched, spheres);
+  double center[3] = {0, 0, 0};
+  double axis[3] = {0, 0, 1};
+  double radial[3] = {1, 0, 0.5};
+  double radii[2] = {2, 0.5};
+  gmi_ent* ring = gmi_add_analytic_primitive(m, 2, GMI_ANALYTIC_TORUS,
+      center, axis, radial, radii, periodic, ranges);
+  gmi_ent* ball = gmi_add_analytic_primitive(m, 3, GMI_ANALYTIC_SPHERE,
+      center, axis, radial, radii, periodic, ranges);
+  gmi_ent* ents[5] = {edge, face, batched, ring, ball};
+  gmi_analytic_fun formulas[5] = {circle, sphere, sphere, torus, 0};
+  enum { N = 20 };
+  gmi_ent* e[N];
+  double p[2 * N];
+  for (int i = 0; i < N; ++i) {
+    e[i] = ents[(i / 2) % 5];
+    p[2 * i] = 0.3 * i;
+    p[2 * i + 1] = 0.1 + 0.4 * i;
+  }
+  double x[3 * N];
+  gmi_eval_batch(m, N, e, p, x);
+  for (int i = 0; i < N; ++i) {
+    double y[3];
+    gmi_eval(m, e[i], p + 2 * i, y);
+    for (int j = 0; j < 3; ++j)
+      PCU_ALWAYS_ASSERT(x[3 * i + j] == y[j]);
+    gmi_analytic_fun f = formulas[(i / 2) % 5];
+    if (!f) {
+      /* the sphere primitive has radius 2 */
+      f = sphere;
+      for (int j = 0; j < 3; ++j)
+        y[j] /= 2;
+    }
+    double z[3];
+    f(p + 2 * i, z, 0);
+    for (int j = 0; j < 3; ++j)
+      PCU_ALWAYS_ASSERT(std::fabs(y[j] - z[j]) < 1e-12);
+  }
+  double q[2 * N];
+  gmi_reparam_batch(m, N, e, p, e, q);
+  for (int i = 0; i < N; ++i) {
+    double r[2];
+    gmi_reparam(m, e[i], p + 2 * i, e[i], r);
+    for (int j = 0; j < 2; ++j)
+      PCU_ALWAYS_ASSERT(q[2 * i + j] == r[j]);
+  }
+  PCU_ALWAYS_ASSERT(!gmi_is_thread_safe(m));
+  gmi_set_analytic_thread_safe(m, 1);
+  PCU_ALWAYS_ASSERT(gmi_is_thread_safe(m));
+  gmi_destroy(m);
+}
@@ -0,0 +1,64 @@
+#include <gmi_mesh.h>
+#include <apf.h>
+#include <apfBox.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* checks that a model loaded once and broadcast matches
+   the same model loaded by every rank */
+
+namespace {
+
+void checkSame(gmi_model* a, gmi_model* b)
+{
+  for (int d = 0; d <= 3; ++d) {
+    PCU_ALWAYS_ASSERT(a->n[d] == b->n[d]);
+    gmi_iter* ia = gmi_begin(a, d);
+    gmi_iter* ib = gmi_begin(b, d);
+    gmi_ent* ea;
+    while ((ea = gmi_next(a, ia))) {
+      gmi_ent* eb = gmi_next(b, ib);
+      PCU_ALWAYS_ASSERT(gmi_tag(a, ea) == gmi_tag(b, eb));
+      PCU_ALWAYS_ASSERT(gmi_find(b, d, gmi_tag(a, ea)) == eb);
+      for (int ad = d - 1; ad <= d + 1; ad += 2) {
+        if (ad < 0 || ad > 3)
+          continue;
+        gmi_set* sa = gmi_adjacent(a, ea, ad);
+        gmi_set* sb = gmi_adjacent(b, eb, ad);
+        PCU_ALWAYS_ASSERT(sa->n == sb->n);
+        for (int i = 0; i < sa->n; ++i)
+          PCU_ALWAYS_ASSERT(gmi_tag(a, sa->e[i]) == gmi_tag(b, sb->e[i]));
+        gmi_free_set(sa);
+        gmi_free_set(sb);
+      }
+    }
+    PCU_ALWAYS_ASSERT(!gmi_next(b, ib));
+    gmi_end(a, ia);
+    gmi_end(b, ib);
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  gmi_register_mesh();
+  const char* path = "gmi_load_bcast.dmg";
+  apf::Mesh2* m = apf::makeMdsBox(2,2,2,1,1,1,true);
+  if (!PCU_Comm_Self())
+    gmi_write_dmg(m->getModel(), path);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Barrier();
+  gmi_model* shared = gmi_load_bcast(path);
+  gmi_model* own = gmi_load(path);
+  checkSame(own, shared);
+  gmi_destroy(shared);
+  gmi_destroy(own);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,275 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_null.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <vector>
+
+/* writes a box of tets in two volumes with its corners, edges
+   and sides as Gmsh 4.1 files, binary and ASCII, then loads them
+   across all ranks and on each rank alone and checks the entity
+   counts, the boundary classification and the coordinates */
+
+namespace {
+
+int const n = 4;
+
+int const cubeTets[6][4] = {
+  {0,1,3,7},{0,1,7,5},{0,5,7,4},{0,3,2,7},{0,2,6,7},{0,6,4,7}};
+int const tetFaces[4][3] = {{0,1,2},{0,1,3},{1,2,3},{0,2,3}};
+
+struct Out {
+  FILE* f;
+  bool binary;
+};
+
+void putSize(Out& o, size_t x)
+{
+  if (o.binary)
+    fwrite(&x, sizeof(x), 1, o.f);
+  else
+    fprintf(o.f, "%lu ", (unsigned long)x);
+}
+
+void putInt(Out& o, int x)
+{
+  if (o.binary)
+    fwrite(&x, sizeof(x), 1, o.f);
+  else
+    fprintf(o.f, "%d ", x);
+}
+
+void putDouble(Out& o, double x)
+{
+  if (o.binary)
+    fwrite(&x, sizeof(x), 1, o.f);
+  else
+    fprintf(o.f, "%.17g ", x);
+}
+
+void endLine(Out& o)
+{
+  if (!o.binary)
+    fprintf(o.f, "\n");
+}
+
+int nodeTag(int i, int j, int k)
+{
+  return 1 + i + (j + k * (n + 1)) * (n + 1);
+}
+
+/* tets of the box in two volumes split at x = n / 2, and the
+   boundary triangles tagged by the side of the box */
+void makeBox(std::vector<int> tets[2], std::vector<int> sides[6])
+{
+  for (int k = 0; k < n; ++k)
+  for (int j = 0; j < n; ++j)
+  for (int i = 0; i < n; ++i) {
+    int c[8][3];
+    for (int b = 0; b < 8; ++b) {
+      c[b][0] = i + (b & 1);
+      c[b][1] = j + ((b >> 1) & 1);
+      c[b][2] = k + ((b >> 2) & 1);
+    }
+    for (int t = 0; t < 6; ++t) {
+      for (int q = 0; q < 4; ++q) {
+        int* p = c[cubeTets[t][q]];
+        tets[i < n / 2].push_back(nodeTag(p[0], p[1], p[2]));
+      }
+      for (int f = 0; f < 4; ++f) {
+        int* p[3];
+        for (int q = 0; q < 3; ++q)
+          p[q] = c[cubeTets[t][tetFaces[f][q]]];
+        for (int a = 0; a < 3; ++a)
+        for (int s = 0; s < 2; ++s) {
+          int at = s * n;
+          if (p[0][a] == at && p[1][a] == at && p[2][a] == at)
+            for (int q = 0; q < 3; ++q)
+              sides[a * 2 + s].push_back(nodeTag(p[q][0], p[q][1], p[q][2]));
+        }
+      }
+    }
+  }
+}
+
+void writeBox(const char* path, bool binary)
+{
+  std::vector<int> tets[2];
+  std::vector<int> sides[6];
+  makeBox(tets, sides);
+  Out o;
+  o.f = fopen(path, "wb");
+  o.binary = binary;
+  fprintf(o.f, "$MeshFormat\n4.1 %d 8\n", binary ? 1 : 0);
+  if (binary) {
+    int one = 1;
+    fwrite(&one, sizeof(one), 1, o.f);
+    fprintf(o.f, "\n");
+  }
+  fprintf(o.f, "$EndMeshFormat\n$Nodes\n");
+  /* two node blocks, to cut across */
+  int nodes = (n + 1) * (n + 1) * (n + 1);
+  int half = nodes / 2;
+  putSize(o, 2); putSize(o, nodes); putSize(o, 1); putSize(o, nodes);
+  endLine(o);
+  for (int b = 0; b < 2; ++b) {
+    int first = b ? half : 0;
+    int count = b ? nodes - half : half;
+    putInt(o, 3); putInt(o, b + 1); putInt(o, 0); putSize(o, count);
+    endLine(o);
+    for (int v = first; v < first + count; ++v) {
+      putSize(o, v + 1);
+      endLine(o);
+    }
+    for (int v = first; v < first + count; ++v) {
+      putDouble(o, v % (n + 1));
+      putDouble(o, (v / (n + 1)) % (n + 1));
+      putDouble(o, v / ((n + 1) * (n + 1)));
+      endLine(o);
+    }
+  }
+  if (binary)
+    fprintf(o.f, "\n");
+  fprintf(o.f, "$EndNodes\n$Elements\n");
+  size_t elements = 8 + 12 * n + tets[0].size() / 4 + tets[1].size() / 4;
+  for (int s = 0; s < 6; ++s)
+    elements += sides[s].size() / 3;
+  putSize(o, 28); putSize(o, elements); putSize(o, 1); putSize(o, elements);
+  endLine(o);
+  size_t tag = 1;
+  for (int c = 0; c < 8; ++c) {
+    putInt(o, 0); putInt(o, c + 1); putInt(o, 15); putSize(o, 1);
+    endLine(o);
+    putSize(o, tag++);
+    putSize(o, nodeTag((c & 1) * n, ((c >> 1) & 1) * n, ((c >> 2) & 1) * n));
+    endLine(o);
+  }
+  for (int a = 0; a < 3; ++a)
+  for (int c = 0; c < 4; ++c) {
+    putInt(o, 1); putInt(o, a * 4 + c + 1); putInt(o, 1); putSize(o, n);
+    endLine(o);
+    for (int i = 0; i < n; ++i) {
+      int p[2][3];
+      for (int q = 0; q < 2; ++q) {
+        p[q][a] = i + q;
+        p[q][(a + 1) % 3] = (c & 1) * n;
+        p[q][(a + 2) % 3] = ((c >> 1) & 1) * n;
+      }
+      putSize(o, tag++);
+      putSize(o, nodeTag(p[0][0], p[0][1], p[0][2]));
+      putSize(o, nodeTag(p[1][0], p[1][1], p[1][2]));
+      endLine(o);
+    }
+  }
+  for (int s = 0; s < 6; ++s) {
+    putInt(o, 2); putInt(o, s + 1); putInt(o, 2);
+    putSize(o, sides[s].size() / 3);
+    endLine(o);
+    for (size_t i = 0; i < sides[s].size(); i += 3) {
+      putSize(o, tag++);
+      for (int q = 0; q < 3; ++q)
+        putSize(o, sides[s][i + q]);
+      endLine(o);
+    }
+  }
+  for (int v = 0; v < 2; ++v) {
+    putInt(o, 3); putInt(o, v + 1); putInt(o, 4);
+    putSize(o, tets[v].size() / 4);
+    endLine(o);
+    for (size_t i = 0; i < tets[v].size(); i += 4) {
+      putSize(o, tag++);
+      for (int q = 0; q < 4; ++q)
+        putSize(o, tets[v][i + q]);
+      endLine(o);
+    }
+  }
+  if (binary)
+    fprintf(o.f, "\n");
+  fprintf(o.f, "$EndElements\n");
+  fclose(o.f);
+}
+
+void checkBox(apf::Mesh2* m)
+{
+  m->verify();
+  long counts[6] = {0, 0, 0, 0, 0, 0};
+  double x[3] = {0, 0, 0};
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    if (!m->isOwned(e))
+      continue;
+    ++counts[0];
+    if (m->getModelType(m->toModel(e)) == 0)
+      ++counts[4];
+    apf::Vector3 p;
+    m->getPoint(e, 0, p);
+    for (int j = 0; j < 3; ++j)
+      x[j] += p[j];
+  }
+  m->end(it);
+  it = m->begin(1);
+  while ((e = m->iterate(it)))
+    if (m->isOwned(e) && m->getModelType(m->toModel(e)) == 1)
+      ++counts[5];
+  m->end(it);
+  it = m->begin(2);
+  while ((e = m->iterate(it)))
+    if (m->isOwned(e) && m->getModelType(m->toModel(e)) == 2)
+      ++counts[1];
+  m->end(it);
+  it = m->begin(3);
+  while ((e = m->iterate(it))) {
+    ++counts[2];
+    if (m->getModelTag(m->toModel(e)) == 2)
+      ++counts[3];
+  }
+  m->end(it);
+  PCU_Add_Longs(counts, 6);
+  PCU_Add_Doubles(x, 3);
+  PCU_ALWAYS_ASSERT(counts[0] == (n + 1) * (n + 1) * (n + 1));
+  PCU_ALWAYS_ASSERT(counts[1] == 12 * n * n);
+  PCU_ALWAYS_ASSERT(counts[2] == 6 * n * n * n);
+  PCU_ALWAYS_ASSERT(counts[3] == 3 * n * n * n);
+  PCU_ALWAYS_ASSERT(counts[4] == 8);
+  PCU_ALWAYS_ASSERT(counts[5] == 12 * n);
+  double sum = (n + 1) * (n + 1) * n * (n + 1) / 2.0;
+  for (int j = 0; j < 3; ++j)
+    PCU_ALWAYS_ASSERT(x[j] == sum);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 1);
+  gmi_register_null();
+  const char* paths[2] = {"box_binary.msh", "box_ascii.msh"};
+  if (!PCU_Comm_Self())
+    for (int i = 0; i < 2; ++i)
+      writeBox(paths[i], i == 0);
+  PCU_Barrier();
+  for (int i = 0; i < 2; ++i) {
+    apf::Mesh2* m = apf::loadMdsFromGmshParallel(gmi_load(".null"), paths[i]);
+    checkBox(m);
+    m->destroyNative();
+    apf::destroyMesh(m);
+  }
+  MPI_Comm world = PCU_Get_Comm();
+  PCU_Switch_Comm(MPI_COMM_SELF);
+  for (int i = 0; i < 2; ++i) {
+    apf::Mesh2* m = apf::loadMdsFromGmsh(gmi_load(".null"), paths[i]);
+    checkBox(m);
+    m->destroyNative();
+    apf::destroyMesh(m);
+  }
+  PCU_Switch_Comm(world);
+  if (!PCU_Comm_Self())
+    printf("Gmsh 4.1 box loaded in parallel and serially\n");
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -3,6 +3,7 @@
 #include <pcu_util.h>
 #include <cstdlib>
 #include <iostream>
+#include <pthread.h>
 
 static void testType(int type, double expectedSum)
 {
@@ -26,12 +27,42 @@ static void testType(int type, double expectedSum)
   }
 }
 
+/* every point of every rule is in the index of distinct points */
+static void testIndex(int type)
+{
+  apf::EntityIntegration const* eg = apf::getIntegration(type);
+  int n = apf::countIntegrationPoints(type);
+  for (int i = 0; i < eg->countIntegrations(); ++i) {
+    apf::Integration const* g = eg->getIntegration(i);
+    for (int j = 0; j < g->countPoints(); ++j) {
+      int k = apf::findIntegrationPoint(type, g->getPoint(j)->param);
+      PCU_ALWAYS_ASSERT(0 <= k && k < n);
+    }
+  }
+  apf::Vector3 off(0.1234567, 0.2345678, 0.0123456);
+  PCU_ALWAYS_ASSERT(apf::findIntegrationPoint(type, off) == -1);
+}
+
+/* threads that are the first to use the index build it once */
+static void* testIndices(void*)
+{
+  for (int type = apf::Mesh::EDGE; type < apf::Mesh::TYPES; ++type)
+    testIndex(type);
+  return 0;
+}
+
 int main()
 {
+  pthread_t threads[4];
+  for (int i = 0; i < 4; ++i)
+    PCU_ALWAYS_ASSERT(!pthread_create(&threads[i], 0, testIndices, 0));
+  for (int i = 0; i < 4; ++i)
+    pthread_join(threads[i], 0);
   testType(apf::Mesh::EDGE,     2.0);
   testType(apf::Mesh::TRIANGLE, 1.0/2.0);
   testType(apf::Mesh::QUAD,     4.0);
   testType(apf::Mesh::TET,      1.0/6.0);
   testType(apf::Mesh::HEX,      8.0);
+  testIndices(0);
   return 0;
 }
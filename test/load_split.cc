@@ -0,0 +1,55 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <apfPartition.h>
+#include <gmi_mesh.h>
+#include <parma.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdlib>
+
+/* loads a mesh onto (factor) times its part count, streaming
+   the elements in small waves, and checks that no element was
+   lost and that the mesh is valid */
+
+namespace {
+
+struct Loaded
+{
+  long elements;
+};
+
+apf::Migration* split(apf::Mesh2* m, int factor, void* data)
+{
+  Loaded* loaded = static_cast<Loaded*>(data);
+  loaded->elements = m->count(m->getDimension());
+  apf::Splitter* splitter = Parma_MakeRibSplitter(m);
+  apf::Migration* plan = splitter->split(0, 1.10, factor);
+  delete splitter;
+  return plan;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 4);
+  gmi_register_mesh();
+  gmi_model* g = gmi_load(argv[1]);
+  int factor = atoi(argv[3]);
+  Loaded loaded;
+  loaded.elements = 0;
+  apf::Mesh2* m = apf::loadSplitMdsMesh(g, argv[2], factor,
+      split, &loaded, 10);
+  m->verify();
+  int dim = m->getDimension();
+  long n = m->count(dim);
+  PCU_ALWAYS_ASSERT(n > 0);
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(n) == PCU_Add_Long(loaded.elements));
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
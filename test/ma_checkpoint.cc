@@ -0,0 +1,63 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* checks that an adapt resumed from a checkpoint
+   ends with the same mesh as the run that wrote it */
+
+namespace {
+
+class Graded : public ma::IsotropicFunction
+{
+  public:
+    Graded(ma::Mesh* m):
+      mesh(m)
+    {
+    }
+    virtual double getValue(ma::Entity* v)
+    {
+      ma::Vector p = ma::getPosition(mesh, v);
+      return 0.05 + 0.3 * p[0] * p[0];
+    }
+  private:
+    ma::Mesh* mesh;
+};
+
+void adapt(const char* model, const char* mesh, int first,
+    const char* prefix, long* counts)
+{
+  ma::Mesh* m = apf::loadMdsMesh(model, mesh);
+  Graded sf(m);
+  ma::Input* in = ma::configure(m, &sf);
+  in->maximumIterations = 3;
+  in->firstIteration = first;
+  in->checkpointPrefix = prefix;
+  ma::adapt(in);
+  m->verify();
+  for (int d = 0; d < 4; ++d)
+    counts[d] = apf::countOwned(m, d);
+  PCU_Add_Longs(counts, 4);
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  long whole[4];
+  adapt(argv[1], argv[2], 0, "ma_checkpoint_", whole);
+  long resumed[4];
+  adapt(argv[1], "ma_checkpoint_0.smb", 1, 0, resumed);
+  for (int d = 0; d < 4; ++d)
+    PCU_ALWAYS_ASSERT(whole[d] == resumed[d]);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
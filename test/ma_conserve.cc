@@ -0,0 +1,85 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfShape.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cmath>
+
+/* coarsens and then refines a box carrying an element field
+   with conservative transfer, and checks that its integral
+   is kept */
+
+namespace {
+
+class Coarse : public ma::IsotropicFunction
+{
+  public:
+    virtual double getValue(ma::Entity*) {return 0.6;}
+};
+
+double integrate(apf::Field* f)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  double total = 0;
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it)))
+    total += apf::getScalar(f, e, 0) * apf::measure(m, e);
+  m->end(it);
+  return PCU_Add_Double(total);
+}
+
+void setField(apf::Field* f)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    apf::Vector3 c = apf::getLinearCentroid(m, e);
+    apf::setScalar(f, e, 0, 1 + c[0] + c[1] * c[1]);
+  }
+  m->end(it);
+}
+
+void check(apf::Field* f, double expected)
+{
+  double total = integrate(f);
+  PCU_ALWAYS_ASSERT(std::fabs(total - expected) < 1e-10 * std::fabs(expected));
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  gmi_register_mesh();
+  ma::Mesh* m = apf::makeMdsBox(4, 4, 4, 1, 1, 1, true);
+  apf::Field* f = apf::createField(m, "density", apf::SCALAR,
+      apf::getConstant(3));
+  setField(f);
+  double expected = integrate(f);
+  ma::SolutionTransfers* transfers = new ma::SolutionTransfers();
+  transfers->add(ma::createConservativeTransfer(f));
+  Coarse size;
+  ma::Input* in = ma::configure(m, &size, transfers);
+  in->maximumIterations = 1;
+  in->shouldSnap = false;
+  in->shouldTransferParametric = false;
+  ma::adapt(in);
+  check(f, expected);
+  in = ma::configureUniformRefine(m, 1, transfers);
+  in->shouldSnap = false;
+  in->shouldTransferParametric = false;
+  ma::adapt(in);
+  check(f, expected);
+  delete transfers;
+  m->verify();
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
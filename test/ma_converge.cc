@@ -0,0 +1,72 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* checks that adapt stops iterating once it converges */
+
+namespace {
+
+class Graded : public ma::IsotropicFunction
+{
+  public:
+    Graded(ma::Mesh* m):
+      mesh(m)
+    {
+    }
+    virtual double getValue(ma::Entity* v)
+    {
+      ma::Vector p = ma::getPosition(mesh, v);
+      return 0.05 + 0.3 * p[0] * p[0];
+    }
+  private:
+    ma::Mesh* mesh;
+};
+
+/* the number of iterations adapt ran and the
+   operations of the last one */
+int adapt(const char* model, const char* mesh,
+    double fraction, long count, long& lastOperations)
+{
+  ma::Mesh* m = apf::loadMdsMesh(model, mesh);
+  Graded sf(m);
+  ma::Input* in = ma::configure(m, &sf);
+  in->maximumIterations = 6;
+  in->convergedEdgeFraction = fraction;
+  in->convergedOperationCount = count;
+  ma::Profile profile;
+  in->profile = &profile;
+  ma::adapt(in);
+  m->verify();
+  m->destroyNative();
+  apf::destroyMesh(m);
+  int iterations = 0;
+  for (size_t i = 0; i < profile.stages.size(); ++i)
+    if (profile.stages[i].iteration + 1 > iterations)
+      iterations = profile.stages[i].iteration + 1;
+  lastOperations = 0;
+  for (size_t i = 0; i < profile.stages.size(); ++i)
+    if (profile.stages[i].iteration == iterations - 1)
+      lastOperations += profile.stages[i].succeeded;
+  return iterations;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  long last;
+  /* some edge is always fine, so this stops after one */
+  PCU_ALWAYS_ASSERT(adapt(argv[1], argv[2], 1, 0, last) == 1);
+  int iterations = adapt(argv[1], argv[2], 0, 100, last);
+  PCU_ALWAYS_ASSERT(iterations < 6);
+  PCU_ALWAYS_ASSERT(last < 100);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,106 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfConvert.h>
+#include <gmi_null.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <algorithm>
+#include <vector>
+
+/* coarsens the same box of tets built with its elements in two
+   different orders, and checks that deterministic adaptation
+   gives the same mesh both times */
+
+namespace {
+
+int const n = 4;
+
+class Coarse : public ma::IsotropicFunction
+{
+  public:
+    virtual double getValue(ma::Entity*) {return 3.0;}
+};
+
+apf::Mesh2* makeBox(bool reversed)
+{
+  static int const cubeTets[6][4] = {
+    {0,1,3,7},{0,1,7,5},{0,5,7,4},{0,3,2,7},{0,2,6,7},{0,6,4,7}};
+  int nv = n + 1;
+  std::vector<int> conn;
+  for (int k = 0; k < n; ++k)
+  for (int j = 0; j < n; ++j)
+  for (int i = 0; i < n; ++i) {
+    int c[8];
+    for (int b = 0; b < 8; ++b)
+      c[b] = (i + (b & 1)) + (j + ((b >> 1) & 1)) * nv
+           + (k + ((b >> 2) & 1)) * nv * nv;
+    for (int t = 0; t < 6; ++t)
+      for (int q = 0; q < 4; ++q)
+        conn.push_back(c[cubeTets[t][q]]);
+  }
+  if (reversed)
+    for (size_t a = 0, b = conn.size() - 4; a < b; a += 4, b -= 4)
+      std::swap_ranges(&conn[a], &conn[a] + 4, &conn[b]);
+  std::vector<double> x;
+  for (int v = 0; v < nv * nv * nv; ++v) {
+    x.push_back(v % nv);
+    x.push_back((v / nv) % nv);
+    x.push_back(v / (nv * nv));
+  }
+  apf::Mesh2* m = apf::makeEmptyMdsMesh(gmi_load(".null"), 3, false);
+  apf::GlobalToVert g;
+  apf::construct(m, &conn[0], conn.size() / 4, apf::Mesh::TET, g);
+  apf::deriveMdsModel(m);
+  apf::setCoords(m, &x[0], x.size() / 3, g);
+  m->acceptChanges();
+  return m;
+}
+
+bool isBefore(apf::Vector3 const& a, apf::Vector3 const& b)
+{
+  for (int i = 0; i < 3; ++i)
+    if (a[i] != b[i])
+      return a[i] < b[i];
+  return false;
+}
+
+std::vector<apf::Vector3> adaptBox(bool reversed)
+{
+  apf::Mesh2* m = makeBox(reversed);
+  Coarse size;
+  ma::Input* in = ma::configure(m, &size);
+  in->maximumIterations = 2;
+  in->shouldSnap = false;
+  in->shouldTransferParametric = false;
+  in->shouldBeDeterministic = true;
+  ma::adapt(in);
+  m->verify();
+  std::vector<apf::Vector3> points;
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it)))
+    points.push_back(apf::getLinearCentroid(m, v));
+  m->end(it);
+  std::sort(points.begin(), points.end(), isBefore);
+  PCU_ALWAYS_ASSERT(m->count(3) > 0);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  return points;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  gmi_register_null();
+  std::vector<apf::Vector3> a = adaptBox(false);
+  std::vector<apf::Vector3> b = adaptBox(true);
+  PCU_ALWAYS_ASSERT(a.size() == b.size());
+  for (size_t i = 0; i < a.size(); ++i)
+    PCU_ALWAYS_ASSERT(!isBefore(a[i], b[i]) && !isBefore(b[i], a[i]));
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
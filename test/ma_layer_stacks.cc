@@ -0,0 +1,216 @@
+#include <ma.h>
+#include <maAdapt.h>
+#include <maCrawler.h>
+#include <maLayer.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_null.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cmath>
+#include <vector>
+
+/* builds a prism boundary layer whose curves cross part
+   boundaries, then checks that layer numbers crawled along
+   the stack index match the ones crawled through the quads */
+
+namespace {
+
+const int n = 4;
+const int layers = 6;
+const double height = 0.1;
+
+int vertIndex(int i, int j, int k)
+{
+  return (k * (n + 1) + j) * (n + 1) + i;
+}
+
+void buildLayer(apf::Mesh2* m)
+{
+  apf::ModelEntity* region = m->findModelEntity(3, 0);
+  apf::ModelEntity* face = m->findModelEntity(2, 1);
+  std::vector<ma::Entity*> verts((n + 1) * (n + 1) * (layers + 1));
+  for (int k = 0; k <= layers; ++k)
+  for (int j = 0; j <= n; ++j)
+  for (int i = 0; i <= n; ++i) {
+    ma::Vector x(double(i) / n, double(j) / n, k * height);
+    verts[vertIndex(i, j, k)] = m->createVertex(region, x, ma::Vector(0,0,0));
+  }
+  for (int k = 0; k < layers; ++k)
+  for (int j = 0; j < n; ++j)
+  for (int i = 0; i < n; ++i) {
+    int corners[2][3] = {{vertIndex(i, j, k), vertIndex(i + 1, j, k),
+                          vertIndex(i + 1, j + 1, k)},
+                         {vertIndex(i, j, k), vertIndex(i + 1, j + 1, k),
+                          vertIndex(i, j + 1, k)}};
+    int up = vertIndex(0, 0, 1);
+    for (int t = 0; t < 2; ++t) {
+      ma::Entity* pv[6];
+      for (int c = 0; c < 3; ++c) {
+        pv[c] = verts[corners[t][c]];
+        pv[c + 3] = verts[corners[t][c] + up];
+      }
+      ma::Entity* p = apf::buildElement(m, region, apf::Mesh::PRISM, pv);
+      if (k)
+        continue;
+      ma::Entity* faces[5];
+      m->getDownward(p, 2, faces);
+      ma::Entity* base = faces[0];
+      m->setModelEntity(base, face);
+      ma::Entity* down[3];
+      m->getDownward(base, 1, down);
+      for (int c = 0; c < 3; ++c)
+        m->setModelEntity(down[c], face);
+      m->getDownward(base, 0, down);
+      for (int c = 0; c < 3; ++c)
+        m->setModelEntity(down[c], face);
+    }
+  }
+}
+
+/* halves along x and along the height, so that
+   curves cross a part boundary and run along one */
+void distribute(apf::Mesh2* m)
+{
+  apf::Migration* plan = new apf::Migration(m);
+  ma::Entity* e;
+  ma::Iterator* it = m->begin(3);
+  while ((e = m->iterate(it))) {
+    ma::Vector c = apf::getLinearCentroid(m, e);
+    int part = 0;
+    if (c[0] > 0.5)
+      part += 1;
+    if (c[2] > layers * height / 2)
+      part += 2;
+    plan->send(e, part);
+  }
+  m->end(it);
+  m->migrate(plan);
+}
+
+struct Numberer : public ma::Crawler
+{
+  Numberer(ma::Adapt* a_, int d, const char* name):
+    ma::Crawler(a_->mesh)
+  {
+    a = a_;
+    dimension = d;
+    tag = mesh->createIntTag(name, 1);
+  }
+  void begin(Layer& first)
+  {
+    ma::getDimensionBase(a, dimension, first);
+    int zero = 0;
+    for (size_t i = 0; i < first.size(); ++i)
+      mesh->setIntTag(first[i], tag, &zero);
+  }
+  ma::Entity* crawl(ma::Entity* e)
+  {
+    ma::HasTag p(mesh, tag);
+    ma::Entity* oe = getOther(e, p);
+    if (!oe)
+      return 0;
+    int k;
+    mesh->getIntTag(e, tag, &k);
+    ++k;
+    mesh->setIntTag(oe, tag, &k);
+    return oe;
+  }
+  void send(ma::Entity* e, int to)
+  {
+    int k;
+    mesh->getIntTag(e, tag, &k);
+    PCU_COMM_PACK(to, k);
+  }
+  bool recv(ma::Entity* e, int)
+  {
+    int k;
+    PCU_COMM_UNPACK(k);
+    if (mesh->hasTag(e, tag))
+      return false;
+    mesh->setIntTag(e, tag, &k);
+    return true;
+  }
+  ma::Adapt* a;
+  int dimension;
+  ma::Tag* tag;
+};
+
+int getHeight(ma::Mesh* m, ma::Entity* e)
+{
+  ma::Vector c = apf::getLinearCentroid(m, e);
+  return static_cast<int>(floor(c[2] / height + 0.5));
+}
+
+bool isAcross(ma::Mesh* m, ma::Entity* e)
+{
+  if (m->getType(e) == apf::Mesh::VERTEX)
+    return true;
+  ma::Entity* v[2];
+  m->getDownward(e, 0, v);
+  return getHeight(m, v[0]) == getHeight(m, v[1]);
+}
+
+void checkNumbers(ma::Adapt* a, int d)
+{
+  ma::Mesh* m = a->mesh;
+  Numberer byQuads(a, d, "by_quads");
+  ma::crawlLayers(&byQuads);
+  ma::LayerStacks stacks(a, d);
+  Numberer byStacks(a, d, "by_stacks");
+  byStacks.stacks = &stacks;
+  ma::crawlStacks(&byStacks);
+  long numbered = 0;
+  ma::Entity* e;
+  ma::Iterator* it = m->begin(d);
+  while ((e = m->iterate(it))) {
+    if ( ! isAcross(m, e)) {
+      PCU_ALWAYS_ASSERT( ! m->hasTag(e, byStacks.tag));
+      continue;
+    }
+    int k1, k2;
+    m->getIntTag(e, byQuads.tag, &k1);
+    m->getIntTag(e, byStacks.tag, &k2);
+    PCU_ALWAYS_ASSERT(k1 == k2);
+    PCU_ALWAYS_ASSERT(k2 == getHeight(m, e));
+    if (m->isOwned(e))
+      ++numbered;
+  }
+  m->end(it);
+  long expected = (d ? 2 * n * (n + 1) + n * n : (n + 1) * (n + 1))
+                * (layers + 1);
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(numbered) == expected);
+  apf::removeTagFromDimension(m, byQuads.tag, d);
+  m->destroyTag(byQuads.tag);
+  apf::removeTagFromDimension(m, byStacks.tag, d);
+  m->destroyTag(byStacks.tag);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 1);
+  PCU_ALWAYS_ASSERT(PCU_Comm_Peers() == 4);
+  gmi_register_null();
+  apf::Mesh2* m = apf::makeEmptyMdsMesh(gmi_load(".null"), 3, false);
+  if ( ! PCU_Comm_Self())
+    buildLayer(m);
+  m->acceptChanges();
+  distribute(m);
+  ma::Input* in = ma::configureIdentity(m);
+  ma::Adapt* a = new ma::Adapt(in);
+  PCU_ALWAYS_ASSERT(a->hasLayer);
+  ma::findLayerBase(a);
+  checkNumbers(a, 0);
+  checkNumbers(a, 1);
+  delete a;
+  delete in;
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,88 @@
+#include <ma.h>
+#include <maSize.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <vector>
+
+/* checks that cached edge lengths match measured ones,
+   also after a vertex moves */
+
+namespace {
+
+class Graded : public ma::IsotropicFunction
+{
+  public:
+    Graded(ma::Mesh* m):
+      mesh(m)
+    {
+    }
+    virtual double getValue(ma::Entity* v)
+    {
+      ma::Vector p = ma::getPosition(mesh, v);
+      return 0.05 + 0.3 * p[0] * p[0];
+    }
+  private:
+    ma::Mesh* mesh;
+};
+
+void measureEdges(ma::Mesh* m, ma::SizeField* sf, std::vector<double>& l)
+{
+  l.clear();
+  ma::Iterator* it = m->begin(1);
+  ma::Entity* e;
+  while ((e = m->iterate(it)))
+    l.push_back(sf->measure(e));
+  m->end(it);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  ma::Mesh* m = apf::loadMdsMesh(argv[1],argv[2]);
+  Graded f(m);
+  ma::SizeField* sf = ma::makeSizeField(m, &f);
+  std::vector<double> measured;
+  measureEdges(m, sf, measured);
+  ma::Tag* cache = ma::createLengthCache(m);
+  ma::setLengthCache(sf, cache);
+  std::vector<double> first;
+  measureEdges(m, sf, first);
+  PCU_ALWAYS_ASSERT(first == measured);
+  ma::Iterator* it = m->begin(1);
+  ma::Entity* e;
+  while ((e = m->iterate(it)))
+    PCU_ALWAYS_ASSERT(m->hasTag(e, cache));
+  m->end(it);
+  std::vector<double> second;
+  measureEdges(m, sf, second);
+  PCU_ALWAYS_ASSERT(second == measured);
+  /* move every vertex, which must invalidate every length */
+  it = m->begin(0);
+  while ((e = m->iterate(it))) {
+    ma::Vector p = ma::getPosition(m, e);
+    m->setPoint(e, 0, p * 1.1);
+  }
+  m->end(it);
+  std::vector<double> moved;
+  measureEdges(m, sf, moved);
+  ma::setLengthCache(sf, 0);
+  std::vector<double> remeasured;
+  measureEdges(m, sf, remeasured);
+  PCU_ALWAYS_ASSERT(moved == remeasured);
+  PCU_ALWAYS_ASSERT(moved != measured);
+  apf::removeTagFromDimension(m, cache, 1);
+  m->destroyTag(cache);
+  delete sf;
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,85 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <cstring>
+
+/* adapts with a profile and checks that its stages add up */
+
+namespace {
+
+class Graded : public ma::IsotropicFunction
+{
+  public:
+    Graded(ma::Mesh* m):
+      mesh(m)
+    {
+    }
+    virtual double getValue(ma::Entity* v)
+    {
+      ma::Vector p = ma::getPosition(mesh, v);
+      return 0.05 + 0.3 * p[0] * p[0];
+    }
+  private:
+    ma::Mesh* mesh;
+};
+
+const ma::StageProfile* find(ma::Profile& p, const char* name)
+{
+  for (size_t i = 0; i < p.stages.size(); ++i)
+    if (!strcmp(p.stages[i].name, name))
+      return &p.stages[i];
+  return 0;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  ma::Mesh* m = apf::loadMdsMesh(argv[1],argv[2]);
+  Graded sf(m);
+  ma::Input* in = ma::configure(m, &sf);
+  in->maximumIterations = 1;
+  in->shouldRunMidParma = true;
+  ma::Profile profile;
+  in->profile = &profile;
+  ma::adapt(in);
+  m->verify();
+  PCU_ALWAYS_ASSERT(find(profile, "coarsen"));
+  const ma::StageProfile* refine = find(profile, "refine");
+  PCU_ALWAYS_ASSERT(refine);
+  PCU_ALWAYS_ASSERT(refine->succeeded > 0);
+  PCU_ALWAYS_ASSERT(refine->entitiesAfter[3] > refine->entitiesBefore[3]);
+  for (size_t i = 0; i < profile.stages.size(); ++i) {
+    const ma::StageProfile& s = profile.stages[i];
+    PCU_ALWAYS_ASSERT(s.minTime <= s.time && s.time <= s.maxTime);
+    PCU_ALWAYS_ASSERT(s.minTime <= s.averageTime);
+    PCU_ALWAYS_ASSERT(s.averageTime <= s.maxTime);
+    PCU_ALWAYS_ASSERT(s.succeeded <= s.attempted);
+    PCU_ALWAYS_ASSERT(s.pullRounds >= 0);
+    PCU_ALWAYS_ASSERT(s.migratedElements >= 0);
+    if (i)
+      for (int d = 0; d < 4; ++d)
+        PCU_ALWAYS_ASSERT(s.entitiesBefore[d] ==
+                          profile.stages[i - 1].entitiesAfter[d]);
+  }
+  long owned = PCU_Add_Long(apf::countOwned(m, 3));
+  PCU_ALWAYS_ASSERT(profile.stages.back().entitiesAfter[3] == owned);
+  ma::writeProfile(&profile, "ma_profile_");
+  char name[64];
+  snprintf(name, sizeof(name), "ma_profile_%d.json", PCU_Comm_Self());
+  FILE* f = fopen(name, "r");
+  PCU_ALWAYS_ASSERT(f);
+  fclose(f);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
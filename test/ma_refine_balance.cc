@@ -0,0 +1,69 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <gmi_mesh.h>
+#include <parma.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+
+/* refines one corner of the mesh after balancing for
+   the refinement, which should leave the parts balanced */
+
+namespace {
+
+class Corner : public ma::IsotropicFunction
+{
+  public:
+    Corner(ma::Mesh* m):
+      mesh(m)
+    {
+    }
+    virtual double getValue(ma::Entity* v)
+    {
+      ma::Vector p = ma::getPosition(mesh, v);
+      if (p[0] < 0.3 && p[1] < 0.3)
+        return 0.05;
+      return 1;
+    }
+  private:
+    ma::Mesh* mesh;
+};
+
+double refine(const char* model, const char* mesh, bool predict)
+{
+  ma::Mesh* m = apf::loadMdsMesh(model, mesh);
+  Corner sf(m);
+  ma::Input* in = ma::configure(m, &sf);
+  in->maximumIterations = 1;
+  in->shouldCoarsen = false;
+  in->shouldFixShape = false;
+  in->shouldRunMidParma = true;
+  in->shouldBalanceForRefinement = predict;
+  ma::adapt(in);
+  m->verify();
+  double imbalance[4];
+  Parma_GetEntImbalance(m, &imbalance);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  return imbalance[3];
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  double sized = refine(argv[1], argv[2], false);
+  double predicted = refine(argv[1], argv[2], true);
+  if (!PCU_Comm_Self())
+    printf("element imbalance %f with size weights, %f predicted\n",
+        sized, predicted);
+  PCU_ALWAYS_ASSERT(predicted < 1.2);
+  PCU_ALWAYS_ASSERT(predicted <= sized);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
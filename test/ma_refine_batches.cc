@@ -0,0 +1,43 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* checks that refining in batches gives the same mesh
+   as refining all at once */
+
+namespace {
+
+void refine(const char* model, const char* mesh, long batch, long* counts)
+{
+  ma::Mesh* m = apf::loadMdsMesh(model, mesh);
+  ma::Input* in = ma::configureUniformRefine(m, 2);
+  in->refineBatchSize = batch;
+  ma::adapt(in);
+  m->verify();
+  for (int d = 0; d < 4; ++d)
+    counts[d] = apf::countOwned(m, d);
+  PCU_Add_Longs(counts, 4);
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  long all[4];
+  refine(argv[1], argv[2], 0, all);
+  long batched[4];
+  refine(argv[1], argv[2], 7, batched);
+  for (int d = 0; d < 4; ++d)
+    PCU_ALWAYS_ASSERT(all[d] == batched[d]);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
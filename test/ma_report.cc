@@ -0,0 +1,88 @@
+#include <ma.h>
+#include <maAdapt.h>
+#include <maStats.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdlib>
+
+/* checks the adapt report of a box against its entity counts,
+   and optionally that measuring the elements on several threads
+   gives the same report */
+
+namespace {
+
+long sum(long const* histogram)
+{
+  long n = 0;
+  for (int i = 0; i < ma::Report::BINS; ++i)
+    n += histogram[i];
+  return n;
+}
+
+void checkSame(ma::Report const& a, ma::Report const& b)
+{
+  PCU_ALWAYS_ASSERT(a.edgeCount == b.edgeCount);
+  PCU_ALWAYS_ASSERT(a.elementCount == b.elementCount);
+  PCU_ALWAYS_ASSERT(a.invalidCount == b.invalidCount);
+  PCU_ALWAYS_ASSERT(a.minQuality == b.minQuality);
+  PCU_ALWAYS_ASSERT(a.maxQuality == b.maxQuality);
+  for (int i = 0; i < ma::Report::BINS; ++i) {
+    PCU_ALWAYS_ASSERT(a.lengthHistogram[i] == b.lengthHistogram[i]);
+    PCU_ALWAYS_ASSERT(a.qualityHistogram[i] == b.qualityHistogram[i]);
+  }
+}
+
+void checkReport(ma::Mesh* m, int threads)
+{
+  ma::Input* in = ma::configureIdentity(m);
+  ma::Adapt* a = new ma::Adapt(in);
+  ma::Report r;
+  ma::report(a, r);
+  PCU_ALWAYS_ASSERT(r.edgeCount == long(m->count(1)));
+  PCU_ALWAYS_ASSERT(r.elementCount == long(m->count(m->getDimension())));
+  PCU_ALWAYS_ASSERT(sum(r.lengthHistogram) == r.edgeCount);
+  PCU_ALWAYS_ASSERT(sum(r.qualityHistogram) == r.elementCount);
+  PCU_ALWAYS_ASSERT(r.invalidCount == 0);
+  PCU_ALWAYS_ASSERT(0 < r.minQuality && r.minQuality <= r.maxQuality);
+  PCU_ALWAYS_ASSERT(r.maxQuality <= 1 + 1e-10);
+  double p[3] = {0.05, 0.5, 0.95};
+  double lastLength = r.minLength;
+  double lastQuality = r.minQuality;
+  for (int i = 0; i < 3; ++i) {
+    double l = r.getLengthPercentile(p[i]);
+    double q = r.getQualityPercentile(p[i]);
+    PCU_ALWAYS_ASSERT(lastLength <= l && l <= r.maxLength);
+    PCU_ALWAYS_ASSERT(lastQuality <= q && q <= r.maxQuality);
+    lastLength = l;
+    lastQuality = q;
+  }
+  if (threads > 1) {
+    ma::setReportThreads(threads);
+    ma::Report tr;
+    ma::report(a, tr);
+    checkSame(r, tr);
+    ma::setReportThreads(1);
+  }
+  ma::printReport(a);
+  delete a;
+  delete in;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  gmi_register_mesh();
+  ma::Mesh* m = apf::makeMdsBox(3, 4, 5, 1, 1, 1, true);
+  checkReport(m, argc > 1 ? atoi(argv[1]) : 1);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
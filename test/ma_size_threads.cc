@@ -0,0 +1,67 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <vector>
+
+/* checks that a log-interpolated size field built
+   on threads measures the same as a serial one */
+
+namespace {
+
+void setFields(ma::Mesh* m, apf::Field* sizes, apf::Field* frames)
+{
+  ma::Entity* v;
+  ma::Iterator* it = m->begin(0);
+  while ((v = m->iterate(it))) {
+    ma::Vector p = ma::getPosition(m, v);
+    apf::setVector(sizes, v, 0,
+        ma::Vector(0.1 + p[0] * 0.2, 0.2, 0.3 - p[1] * 0.1));
+    double c = 0.8;
+    double s = 0.6;
+    apf::setMatrix(frames, v, 0, ma::Matrix(c, -s, 0, s, c, 0, 0, 0, 1));
+  }
+  m->end(it);
+}
+
+void measure(ma::Mesh* m, apf::Field* sizes, apf::Field* frames,
+    int threads, std::vector<double>& lengths)
+{
+  ma::SizeField* sf = ma::makeSizeField(m, sizes, frames, true, threads);
+  lengths.clear();
+  ma::Entity* e;
+  ma::Iterator* it = m->begin(1);
+  while ((e = m->iterate(it)))
+    lengths.push_back(sf->measure(e));
+  m->end(it);
+  delete sf;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  ma::Mesh* m = apf::loadMdsMesh(argv[1], argv[2]);
+  apf::Field* sizes = apf::createLagrangeField(m, "sizes", apf::VECTOR, 1);
+  apf::Field* frames = apf::createLagrangeField(m, "frames", apf::MATRIX, 1);
+  setFields(m, sizes, frames);
+  std::vector<double> serial;
+  measure(m, sizes, frames, 1, serial);
+  std::vector<double> threaded;
+  measure(m, sizes, frames, 4, threaded);
+  PCU_ALWAYS_ASSERT(serial == threaded);
+  ma::Input* in = ma::configure(m, sizes, frames, 0, true, 4);
+  in->maximumIterations = 1;
+  ma::adapt(in);
+  m->verify();
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,79 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfConvert.h>
+#include <gmi_null.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <vector>
+
+/* builds a box of tets split into slabs along x, with the slivers
+   squashed into the first slabs, and corrects their shapes while
+   spreading the bad elements to the other parts */
+
+namespace {
+
+int const n = 6;
+
+apf::Mesh2* makeSquashedBox()
+{
+  static int const cubeTets[6][4] = {
+    {0,1,3,7},{0,1,7,5},{0,5,7,4},{0,3,2,7},{0,2,6,7},{0,6,4,7}};
+  int peers = PCU_Comm_Peers();
+  int self = PCU_Comm_Self();
+  int nv = n + 1;
+  std::vector<int> conn;
+  for (int k = 0; k < n; ++k)
+  for (int j = 0; j < n; ++j)
+  for (int i = 0; i < n; ++i) {
+    if (i * peers / n != self)
+      continue;
+    int c[8];
+    for (int b = 0; b < 8; ++b)
+      c[b] = (i + (b & 1)) + (j + ((b >> 1) & 1)) * nv
+           + (k + ((b >> 2) & 1)) * nv * nv;
+    for (int t = 0; t < 6; ++t)
+      for (int q = 0; q < 4; ++q)
+        conn.push_back(c[cubeTets[t][q]]);
+  }
+  int verts = nv * nv * nv;
+  std::vector<double> x;
+  for (int v = self * verts / peers; v < (self + 1) * verts / peers; ++v) {
+    int i = v % nv;
+    int j = (v / nv) % nv;
+    int k = v / (nv * nv);
+    x.push_back(i);
+    x.push_back(j);
+    x.push_back(i < n / 2 ? k * 0.05 : k);
+  }
+  apf::Mesh2* m = apf::makeEmptyMdsMesh(gmi_load(".null"), 3, false);
+  apf::GlobalToVert g;
+  apf::construct(m, &conn[0], conn.size() / 4, apf::Mesh::TET, g);
+  apf::alignMdsRemotes(m);
+  apf::deriveMdsModel(m);
+  apf::setCoords(m, &x[0], x.size() / 3, g);
+  m->acceptChanges();
+  m->verify();
+  return m;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  gmi_register_null();
+  apf::Mesh2* m = makeSquashedBox();
+  ma::Input* in = ma::configureIdentity(m);
+  in->maximumIterations = 0;
+  in->shouldFixShape = true;
+  in->shouldUseWorklist = true;
+  in->shouldSpreadBadElements = true;
+  ma::adapt(in);
+  m->verify();
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,75 @@
+#include <ma.h>
+#include <maShape.h>
+#include <maSize.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cmath>
+#include <vector>
+
+/* checks the batched tet quality kernel against the
+   single element formula, inverted tets included */
+
+namespace {
+
+class Unit : public ma::IsotropicFunction
+{
+  public:
+    virtual double getValue(ma::Entity*)
+    {
+      return 1;
+    }
+};
+
+bool close(double a, double b)
+{
+  return std::fabs(a - b) <= 1e-12 * std::fabs(b);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  ma::Mesh* m = apf::loadMdsMesh(argv[1],argv[2]);
+  Unit f;
+  ma::SizeField* sf = ma::makeSizeField(m, &f);
+  std::vector<ma::Entity*> tets;
+  ma::Iterator* it = m->begin(3);
+  ma::Entity* e;
+  while ((e = m->iterate(it)))
+    tets.push_back(e);
+  m->end(it);
+  std::vector<double> q(tets.size());
+  ma::measureTetQualities(m, sf, &tets[0], tets.size(), &q[0]);
+  for (size_t i = 0; i < tets.size(); ++i) {
+    ma::Vector p[4];
+    ma::getVertPoints(m, tets[i], p);
+    PCU_ALWAYS_ASSERT(close(q[i], ma::measureLinearTetQuality(p)));
+    PCU_ALWAYS_ASSERT(close(q[i], ma::measureTetQuality(m, sf, tets[i])));
+  }
+  /* a regular tet has quality one, and its mirror image minus one */
+  double x[2][12] = {{0, 0, 0, 1, 0, 0, 0.5, std::sqrt(3.) / 2, 0,
+                      0.5, std::sqrt(3.) / 6, std::sqrt(2. / 3.)}};
+  for (int i = 0; i < 12; ++i)
+    x[1][i] = (i % 3 == 2) ? -x[0][i] : x[0][i];
+  /* to the layout of measureTetQualities for two tets */
+  double soa[24];
+  for (int t = 0; t < 2; ++t)
+    for (int i = 0; i < 12; ++i)
+      soa[i * 2 + t] = x[t][i];
+  double regular[2];
+  ma::measureTetQualities(2, soa, regular);
+  PCU_ALWAYS_ASSERT(close(regular[0], 1));
+  PCU_ALWAYS_ASSERT(close(regular[1], -1));
+  delete sf;
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
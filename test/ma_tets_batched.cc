@@ -0,0 +1,73 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfConvert.h>
+#include <gmi_null.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdlib>
+#include <vector>
+
+/* builds a stack of prism layers and turns it into tets,
+   converting (argv[1]) elements at a time (0 for all at once) */
+
+namespace {
+
+apf::Mesh2* makePrismLayers(int nx, int nl)
+{
+  int nv = (nx+1)*(nx+1);
+  std::vector<int> conn;
+  std::vector<double> x;
+  for (int l = 0; l <= nl; ++l)
+  for (int j = 0; j <= nx; ++j)
+  for (int i = 0; i <= nx; ++i) {
+    x.push_back(i);
+    x.push_back(j);
+    x.push_back(l * 0.1);
+  }
+  for (int l = 0; l < nl; ++l)
+  for (int j = 0; j < nx; ++j)
+  for (int i = 0; i < nx; ++i) {
+    int a = l*nv + j*(nx+1) + i;
+    int t[2][3] = {{a, a+1, a+nx+2}, {a, a+nx+2, a+nx+1}};
+    for (int k = 0; k < 2; ++k) {
+      for (int q = 0; q < 3; ++q)
+        conn.push_back(t[k][q]);
+      for (int q = 0; q < 3; ++q)
+        conn.push_back(t[k][q] + nv);
+    }
+  }
+  apf::Mesh2* m = apf::makeEmptyMdsMesh(gmi_load(".null"), 3, false);
+  apf::GlobalToVert g;
+  apf::construct(m, &conn[0], conn.size() / 6, apf::Mesh::PRISM, g);
+  apf::alignMdsRemotes(m);
+  apf::deriveMdsModel(m);
+  apf::setCoords(m, &x[0], x.size() / 3, g);
+  m->acceptChanges();
+  m->verify();
+  return m;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  gmi_register_null();
+  PCU_ALWAYS_ASSERT(argc == 2);
+  apf::Mesh2* m = makePrismLayers(4, 3);
+  size_t prisms = m->count(3);
+  ma::Input* in = ma::configureIdentity(m);
+  in->shouldTurnLayerToTets = true;
+  in->maximumIterations = 0;
+  in->shouldFixShape = false;
+  in->refineBatchSize = atoi(argv[1]);
+  ma::adapt(in);
+  m->verify();
+  PCU_ALWAYS_ASSERT(m->count(3) == 3 * prisms);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,56 @@
+#include <ma.h>
+#include <maProfile.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstring>
+
+/* coarsens a box while tracing, and checks that the
+   collapse operator reports consistent counts */
+
+namespace {
+
+class Coarse : public ma::IsotropicFunction
+{
+  public:
+    virtual double getValue(ma::Entity*) {return 0.6;}
+};
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  gmi_register_mesh();
+  ma::Mesh* m = apf::makeMdsBox(4, 4, 4, 1, 1, 1, true);
+  Coarse size;
+  ma::Input* in = ma::configure(m, &size);
+  in->maximumIterations = 1;
+  in->shouldSnap = false;
+  in->shouldTransferParametric = false;
+  ma::TraceSummary trace;
+  in->tracer = &trace;
+  ma::adapt(in);
+  bool sawCollapse = false;
+  for (size_t i = 0; i < trace.operators.size(); ++i) {
+    ma::OperatorTrace& t = trace.operators[i];
+    PCU_ALWAYS_ASSERT(t.localityFailures <= t.shouldApplyCalls);
+    PCU_ALWAYS_ASSERT(t.applyCalls <= t.shouldApplyCalls);
+    PCU_ALWAYS_ASSERT(t.rollbacks <= t.applyCalls);
+    PCU_ALWAYS_ASSERT(t.shouldApplyTime >= 0 && t.applyTime >= 0);
+    if (!strcmp(t.name, "collapse")) {
+      sawCollapse = true;
+      PCU_ALWAYS_ASSERT(t.applyCalls > t.rollbacks);
+    }
+  }
+  PCU_ALWAYS_ASSERT(sawCollapse);
+  m->verify();
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,119 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <ma.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cmath>
+#include <cstdio>
+
+/* refines boxes with ma::refineUniformly and checks the exact
+   entity counts, the transfer of a quadratic field and that
+   ma::adapt with a uniform size field makes the same counts */
+
+namespace {
+
+double quadratic(apf::Vector3 const& x)
+{
+  return 1 + x[0] * x[0] + 2 * x[1] * x[2] - x[2];
+}
+
+void setField(apf::Field* f)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  for (int d = 0; d <= 1; ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      apf::Vector3 x = apf::getLinearCentroid(m, e);
+      apf::setScalar(f, e, 0, quadratic(x));
+    }
+    m->end(it);
+  }
+}
+
+double getError(apf::Field* f)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  double error = 0;
+  for (int d = 0; d <= 1; ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      apf::Vector3 x = apf::getLinearCentroid(m, e);
+      error = std::max(error,
+          std::fabs(apf::getScalar(f, e, 0) - quadratic(x)));
+    }
+    m->end(it);
+  }
+  return PCU_Max_Double(error);
+}
+
+void count(apf::Mesh* m, long* n)
+{
+  for (int d = 0; d < 4; ++d)
+    n[d] = d <= m->getDimension() ? apf::countOwned(m, d) : 0;
+  PCU_Add_Longs(n, 4);
+}
+
+apf::Mesh2* makeBox(int dim)
+{
+  return apf::makeDistributedMdsBox(4, 4, dim == 3 ? 4 : 0,
+      1, 1, dim == 3 ? 1 : 0, true);
+}
+
+void destroy(apf::Mesh2* m)
+{
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+void test(int dim, int levels)
+{
+  apf::Mesh2* m = makeBox(dim);
+  PCU_ALWAYS_ASSERT(ma::canRefineUniformly(m));
+  apf::Field* f = apf::createField(m, "u", apf::SCALAR,
+      apf::getLagrange(2));
+  setField(f);
+  long n[4];
+  count(m, n);
+  for (int i = 0; i < levels; ++i) {
+    long v = n[0] + n[1];
+    long e = 2 * n[1] + 3 * n[2] + n[3];
+    long t = 4 * n[2] + 8 * n[3];
+    long r = 8 * n[3];
+    n[0] = v; n[1] = e; n[2] = t; n[3] = r;
+  }
+  ma::refineUniformly(m, levels);
+  apf::verify(m);
+  long after[4];
+  count(m, after);
+  for (int d = 0; d < 4; ++d)
+    PCU_ALWAYS_ASSERT(after[d] == n[d]);
+  double error = getError(f);
+  if (!PCU_Comm_Self())
+    printf("%dD, %d levels: max field error %e\n", dim, levels, error);
+  PCU_ALWAYS_ASSERT(error < 1e-12);
+  apf::destroyField(f);
+  destroy(m);
+  m = makeBox(dim);
+  ma::adapt(ma::configureUniformRefine(m, levels));
+  count(m, after);
+  for (int d = 0; d < 4; ++d)
+    PCU_ALWAYS_ASSERT(after[d] == n[d]);
+  destroy(m);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  test(2, 2);
+  test(3, 2);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
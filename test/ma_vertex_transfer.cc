@@ -0,0 +1,68 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cmath>
+
+/* checks that refinement transfers linear fields exactly
+   to the new vertices */
+
+namespace {
+
+double linear(ma::Vector const& p)
+{
+  return 1 + p[0] + 2 * p[1] + 3 * p[2];
+}
+
+void setFields(ma::Mesh* m, apf::Field* s, apf::Field* v)
+{
+  ma::Entity* e;
+  ma::Iterator* it = m->begin(0);
+  while ((e = m->iterate(it))) {
+    ma::Vector p = ma::getPosition(m, e);
+    apf::setScalar(s, e, 0, linear(p));
+    apf::setVector(v, e, 0, p * 2);
+  }
+  m->end(it);
+}
+
+double getError(ma::Mesh* m, apf::Field* s, apf::Field* v)
+{
+  double error = 0;
+  ma::Entity* e;
+  ma::Iterator* it = m->begin(0);
+  while ((e = m->iterate(it))) {
+    ma::Vector p = ma::getPosition(m, e);
+    error = std::max(error,
+        std::fabs(apf::getScalar(s, e, 0) - linear(p)));
+    ma::Vector x;
+    apf::getVector(v, e, 0, x);
+    error = std::max(error, (x - p * 2).getLength());
+  }
+  m->end(it);
+  return PCU_Max_Double(error);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  ma::Mesh* m = apf::loadMdsMesh(argv[1], argv[2]);
+  apf::Field* s = apf::createFieldOn(m, "scalar", apf::SCALAR);
+  apf::Field* v = apf::createFieldOn(m, "vector", apf::VECTOR);
+  setFields(m, s, v);
+  ma::Input* in = ma::configureUniformRefine(m, 1);
+  ma::adapt(in);
+  m->verify();
+  PCU_ALWAYS_ASSERT(getError(m, s, v) < 1e-10);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
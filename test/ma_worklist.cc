@@ -0,0 +1,78 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstring>
+
+/* adapts once sweeping the mesh and once with worklists,
+   which visit the same entities in the same order */
+
+namespace {
+
+class Graded : public ma::IsotropicFunction
+{
+  public:
+    Graded(ma::Mesh* m):
+      mesh(m)
+    {
+    }
+    virtual double getValue(ma::Entity* v)
+    {
+      ma::Vector p = ma::getPosition(mesh, v);
+      return 0.05 + 0.3 * p[0] * p[0];
+    }
+  private:
+    ma::Mesh* mesh;
+};
+
+long countCollapses(ma::Profile& p)
+{
+  long n = 0;
+  for (size_t i = 0; i < p.stages.size(); ++i)
+    if (!strcmp(p.stages[i].name, "coarsen"))
+      n += p.stages[i].succeeded;
+  return n;
+}
+
+void adapt(const char* model, const char* mesh, bool worklist,
+    long counts[4], long& collapses)
+{
+  ma::Mesh* m = apf::loadMdsMesh(model, mesh);
+  Graded sf(m);
+  ma::Input* in = ma::configure(m, &sf);
+  in->maximumIterations = 2;
+  in->shouldUseWorklist = worklist;
+  ma::Profile profile;
+  in->profile = &profile;
+  ma::adapt(in);
+  m->verify();
+  for (int d = 0; d < 4; ++d)
+    counts[d] = PCU_Add_Long(apf::countOwned(m, d));
+  collapses = countCollapses(profile);
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  long swept[4];
+  long sweptCollapses;
+  adapt(argv[1], argv[2], false, swept, sweptCollapses);
+  long listed[4];
+  long listedCollapses;
+  adapt(argv[1], argv[2], true, listed, listedCollapses);
+  PCU_ALWAYS_ASSERT(sweptCollapses > 0);
+  PCU_ALWAYS_ASSERT(listedCollapses == sweptCollapses);
+  for (int d = 0; d < 4; ++d)
+    PCU_ALWAYS_ASSERT(listed[d] == swept[d]);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,67 @@
+#include <apfMatrix.h>
+#include <pcu_util.h>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+/* checks the closed form determinants against cofactor expansion
+   and the batched 3 by 3 kernels against apf::invert */
+
+namespace {
+
+double uniform()
+{
+  return double(std::rand()) / RAND_MAX * 2 - 1;
+}
+
+template <std::size_t N>
+apf::Matrix<N,N> randomMatrix()
+{
+  apf::Matrix<N,N> a;
+  for (std::size_t i = 0; i < N; ++i)
+  for (std::size_t j = 0; j < N; ++j)
+    a[i][j] = uniform();
+  return a;
+}
+
+template <std::size_t N>
+void checkDeterminant()
+{
+  apf::Matrix<N,N> a = randomMatrix<N>();
+  double expanded = 0;
+  for (std::size_t i = 0; i < N; ++i)
+    expanded += a[i][0] * apf::getCofactor(a, i, 0);
+  PCU_ALWAYS_ASSERT(std::fabs(apf::getDeterminant(a) - expanded) < 1e-12);
+}
+
+}
+
+int main()
+{
+  for (int i = 0; i < 100; ++i) {
+    checkDeterminant<2>();
+    checkDeterminant<3>();
+    checkDeterminant<4>();
+  }
+  int n = 100;
+  std::vector<double> a(n * 9);
+  for (int i = 0; i < n * 9; ++i)
+    a[i] = uniform();
+  std::vector<double> dets(n);
+  std::vector<double> inverses(n * 9);
+  apf::getDeterminants(n, &a[0], &dets[0]);
+  apf::invert(n, &a[0], &inverses[0]);
+  for (int k = 0; k < n; ++k) {
+    apf::Matrix3x3 m;
+    for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      m[i][j] = a[k * 9 + i * 3 + j];
+    PCU_ALWAYS_ASSERT(std::fabs(dets[k] - apf::getDeterminant(m)) < 1e-12);
+    apf::Matrix3x3 inv = apf::invert(m);
+    double scale = std::fabs(dets[k]);
+    for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      PCU_ALWAYS_ASSERT(
+          std::fabs(inverses[k * 9 + i * 3 + j] - inv[i][j]) * scale < 1e-12);
+  }
+}
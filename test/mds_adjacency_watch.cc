@@ -0,0 +1,93 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <algorithm>
+#include <vector>
+
+/* checks that adjacencies kept by the watch give the same answers
+   as the traversals, that a mesh change drops them and that
+   the budget is respected */
+
+namespace {
+
+typedef std::vector<apf::MeshEntity*> Answers;
+
+/* vertex to face and region to vertex, the two
+   common queries that MDS does not store */
+void collect(apf::Mesh* m, int from, int to, Answers& out)
+{
+  out.clear();
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(from);
+  while ((e = m->iterate(it))) {
+    apf::Adjacent adj;
+    m->getAdjacent(e, to, adj);
+    std::sort(adj.begin(), adj.end());
+    out.push_back(0);
+    out.insert(out.end(), adj.begin(), adj.end());
+  }
+  m->end(it);
+}
+
+void check(apf::Mesh2* m, int from, int to)
+{
+  Answers computed, kept;
+  collect(m, from, to, computed);
+  PCU_ALWAYS_ASSERT(m->hasAdjacency(from, to));
+  collect(m, from, to, kept);
+  PCU_ALWAYS_ASSERT(computed == kept);
+  apf::MdsAdjacencyStats s;
+  apf::getMdsAdjacencyStats(m, s);
+  PCU_ALWAYS_ASSERT(s.kept[from][to]);
+  PCU_ALWAYS_ASSERT(s.queries[from][to] == 2 * (long)m->count(from));
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  int dim = m->getDimension();
+  /* no room for anything more */
+  apf::MdsAdjacencyStats s;
+  apf::getMdsAdjacencyStats(m, s);
+  apf::watchMdsAdjacency(m, 1, s.bytes);
+  Answers answers;
+  collect(m, 0, dim - 1, answers);
+  PCU_ALWAYS_ASSERT(!m->hasAdjacency(0, dim - 1));
+  /* kept after the first query */
+  apf::watchMdsAdjacency(m, 1, 1L << 40);
+  check(m, 0, dim - 1);
+  check(m, dim, 0);
+  /* a modification drops them */
+  apf::MeshEntity* v = m->createVert(0);
+  m->destroy(v);
+  PCU_ALWAYS_ASSERT(!m->hasAdjacency(0, dim - 1));
+  PCU_ALWAYS_ASSERT(!m->hasAdjacency(dim, 0));
+  apf::printMdsAdjacencyStats(m);
+  /* and they must wait twice as long, then a
+     createAdjacency makes one permanent */
+  collect(m, 0, dim - 1, answers);
+  collect(m, dim, 0, answers);
+  PCU_ALWAYS_ASSERT(m->hasAdjacency(0, dim - 1));
+  m->createAdjacency(0, dim - 1);
+  apf::getMdsAdjacencyStats(m, s);
+  PCU_ALWAYS_ASSERT(s.drops[0][dim - 1] == 1);
+  PCU_ALWAYS_ASSERT(!s.kept[0][dim - 1]);
+  v = m->createVert(0);
+  m->destroy(v);
+  PCU_ALWAYS_ASSERT(m->hasAdjacency(0, dim - 1));
+  PCU_ALWAYS_ASSERT(!m->hasAdjacency(dim, 0));
+  apf::unwatchMdsAdjacency(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
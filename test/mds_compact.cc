@@ -0,0 +1,113 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <vector>
+
+/* refines a mesh to leave gaps in the MDS arrays,
+   then checks that compacting keeps the mesh valid,
+   removes the gaps, carries tags along, and frees memory.
+   Chunked iteration is checked with and without the gaps. */
+
+namespace {
+
+double tagValue(apf::Mesh* m, apf::MeshEntity* e)
+{
+  apf::Vector3 x = apf::getLinearCentroid(m, e);
+  return x[0] + 10 * x[1] + 100 * x[2];
+}
+
+void setTags(apf::Mesh* m, apf::MeshTag* t)
+{
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      double v = tagValue(m, e);
+      m->setDoubleTag(e, t, &v);
+    }
+    m->end(it);
+  }
+}
+
+void checkTags(apf::Mesh2* m, apf::MeshTag* t)
+{
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    int i = 0;
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      PCU_ALWAYS_ASSERT(apf::getMdsIndex(m, e) == i++);
+      double v;
+      m->getDoubleTag(e, t, &v);
+      PCU_ALWAYS_ASSERT(v == tagValue(m, e));
+    }
+    m->end(it);
+  }
+}
+
+void checkChunks(apf::Mesh* m)
+{
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    std::vector<apf::MeshEntity*> all;
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it)))
+      all.push_back(e);
+    m->end(it);
+    for (int chunks = 1; chunks < 8; chunks += 3) {
+      std::vector<apf::MeshEntity*> pieces;
+      for (int i = 0; i < chunks; ++i) {
+        it = m->beginChunk(d, i, chunks);
+        while ((e = m->iterate(it)))
+          pieces.push_back(e);
+        m->end(it);
+      }
+      PCU_ALWAYS_ASSERT(pieces == all);
+    }
+  }
+}
+
+size_t totalBytes(apf::Mesh* m)
+{
+  apf::MeshMemory u;
+  m->getMemoryUsage(u);
+  size_t n = 0;
+  for (int t = 0; t < apf::Mesh::TYPES; ++t)
+    n += u.downward[t] + u.upward[t] + u.coordinates[t] +
+         u.tags[t] + u.remotes[t] + u.other[t];
+  return n;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  ma::Input* in = ma::configureUniformRefine(m, 1);
+  in->shouldSnap = false;
+  in->shouldTransferParametric = false;
+  ma::adapt(in);
+  apf::MeshTag* t = m->createDoubleTag("compact_check", 1);
+  setTags(m, t);
+  checkChunks(m);
+  size_t before = totalBytes(m);
+  apf::compactMdsMesh(m);
+  PCU_ALWAYS_ASSERT(totalBytes(m) < before);
+  apf::printMemoryUsage(m);
+  apf::verify(m);
+  checkTags(m, t);
+  checkChunks(m);
+  m->destroyTag(t);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,66 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <vector>
+
+/* checks that upward adjacency queries give the same answers,
+   in the same order, from a frozen MDS mesh */
+
+namespace {
+
+typedef std::vector<apf::MeshEntity*> Answers;
+
+void collect(apf::Mesh* m, Answers& out)
+{
+  out.clear();
+  for (int d = 0; d < m->getDimension(); ++d) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      for (int ud = d + 1; ud <= m->getDimension(); ++ud) {
+        apf::Adjacent adj;
+        m->getAdjacent(e, ud, adj);
+        out.push_back(0);
+        out.insert(out.end(), adj.begin(), adj.end());
+      }
+      apf::Up up;
+      m->getUp(e, up);
+      PCU_ALWAYS_ASSERT(up.n == m->countUpward(e));
+      for (int i = 0; i < up.n; ++i)
+        PCU_ALWAYS_ASSERT(up.e[i] == m->getUpward(e, i));
+    }
+    m->end(it);
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  Answers linked, frozen;
+  collect(m, linked);
+  apf::freezeMdsAdjacency(m);
+  collect(m, frozen);
+  PCU_ALWAYS_ASSERT(linked == frozen);
+  /* a modification discards the snapshot */
+  apf::MeshEntity* v = m->createVert(0);
+  m->destroy(v);
+  collect(m, frozen);
+  PCU_ALWAYS_ASSERT(linked == frozen);
+  apf::freezeMdsAdjacency(m);
+  apf::thawMdsAdjacency(m);
+  collect(m, frozen);
+  PCU_ALWAYS_ASSERT(linked == frozen);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
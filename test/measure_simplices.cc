@@ -0,0 +1,50 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cmath>
+#include <vector>
+
+/* compares the blocked measures of edges, triangles and tets
+   with those integrated over their mesh elements */
+
+namespace {
+
+void check(apf::Mesh* m, int dim)
+{
+  std::vector<apf::MeshEntity*> ents;
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(dim);
+  while ((e = m->iterate(it)))
+    ents.push_back(e);
+  m->end(it);
+  std::vector<double> fast(ents.size());
+  if (!ents.empty())
+    apf::measureSimplices(m, ents.size(), &ents[0], &fast[0]);
+  for (size_t i = 0; i < ents.size(); ++i) {
+    apf::MeshElement* me = apf::createMeshElement(m, ents[i]);
+    double v = apf::measure(me);
+    apf::destroyMeshElement(me);
+    PCU_ALWAYS_ASSERT(std::fabs(fast[i] - v) <= 1e-12 * std::fabs(v));
+    PCU_ALWAYS_ASSERT(apf::measure(m, ents[i]) == fast[i]);
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  for (int d = 1; d <= m->getDimension(); ++d)
+    check(m, d);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
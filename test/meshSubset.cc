@@ -0,0 +1,129 @@
+#include <apf.h>
+#include <apfConvert.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_null.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <vector>
+
+/* builds a box of tets strided over the ranks, classifies its
+   x=0 side on model face 7, writes it, then loads the entities
+   of that face, with and without the adjacent layer of tets,
+   and checks the global counts of owned entities */
+
+namespace {
+
+int const n = 4;
+
+int const cubeTets[6][4] = {
+  {0,1,3,7},{0,1,7,5},{0,5,7,4},{0,3,2,7},{0,2,6,7},{0,6,4,7}};
+
+int vtxId(int i, int j, int k)
+{
+  return i + (j + k * (n + 1)) * (n + 1);
+}
+
+apf::Mesh2* makeBox(apf::GlobalToVert& gv)
+{
+  int self = PCU_Comm_Self();
+  int peers = PCU_Comm_Peers();
+  std::vector<int> conn;
+  int e = 0;
+  for (int k = 0; k < n; ++k)
+  for (int j = 0; j < n; ++j)
+  for (int i = 0; i < n; ++i)
+  for (int t = 0; t < 6; ++t, ++e) {
+    int rank = e % peers;
+    if (rank != self)
+      continue;
+    for (int q = 0; q < 4; ++q) {
+      int b = cubeTets[t][q];
+      conn.push_back(vtxId(i + (b & 1), j + ((b >> 1) & 1), k + ((b >> 2) & 1)));
+    }
+  }
+  apf::Mesh2* m = apf::makeEmptyMdsMesh(gmi_load(".null"), 3, false);
+  apf::construct(m, conn.empty() ? 0 : &conn[0], conn.size() / 4,
+      apf::Mesh::TET, gv);
+  apf::alignMdsRemotes(m);
+  int nverts = (n + 1) * (n + 1) * (n + 1);
+  int quotient = nverts / peers;
+  int first = quotient * self;
+  int count = quotient;
+  if (self == peers - 1)
+    count += nverts % peers;
+  std::vector<double> xyz;
+  for (int v = first; v < first + count; ++v) {
+    xyz.push_back(v % (n + 1));
+    xyz.push_back((v / (n + 1)) % (n + 1));
+    xyz.push_back(v / ((n + 1) * (n + 1)));
+  }
+  apf::setCoords(m, xyz.empty() ? 0 : &xyz[0], count, gv);
+  apf::deriveMdsModel(m);
+  m->acceptChanges();
+  m->verify();
+  return m;
+}
+
+void classifySide(apf::Mesh2* m)
+{
+  apf::ModelEntity* side = m->findModelEntity(2, 7);
+  for (int d = 0; d < 3; ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it)))
+      if (apf::getLinearCentroid(m, e)[0] == 0)
+        m->setModelEntity(e, side);
+    m->end(it);
+  }
+}
+
+/* a negative count is not checked */
+void checkCounts(apf::Mesh* m, long const* expected)
+{
+  for (int d = 0; d <= 3; ++d) {
+    if (expected[d] < 0)
+      continue;
+    long owned = 0;
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it)))
+      if (m->isOwned(e))
+        ++owned;
+    m->end(it);
+    PCU_ALWAYS_ASSERT(PCU_Add_Long(owned) == expected[d]);
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 1);
+  gmi_register_null();
+  apf::GlobalToVert gv;
+  apf::Mesh2* m = makeBox(gv);
+  classifySide(m);
+  m->writeNative("box.smb");
+  m->destroyNative();
+  apf::destroyMesh(m);
+  int side = 7;
+  m = apf::loadMdsSubset(gmi_load(".null"), "box.smb", 2, &side, 1);
+  long const faceOnly[4] = {(n + 1) * (n + 1), 3 * n * n + 2 * n, 2 * n * n, 0};
+  checkCounts(m, faceOnly);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  /* every tet of the first column of cubes touches x=0 */
+  m = apf::loadMdsSubset(gmi_load(".null"), "box.smb", 2, &side, 1, true);
+  long const withLayer[4] = {2 * (n + 1) * (n + 1), -1, -1, 6 * n * n};
+  checkCounts(m, withLayer);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  if (!PCU_Comm_Self())
+    printf("mesh subsets loaded\n");
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
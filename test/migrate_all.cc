@@ -0,0 +1,74 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* sends every element to the next part except for a few
+   that are explicitly kept, then checks the element counts
+   on each part and verifies the result */
+
+namespace {
+
+void count(apf::Mesh* m, long* n)
+{
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    n[d] = 0;
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it)))
+      if (m->isOwned(e))
+        ++n[d];
+    m->end(it);
+    n[d] = PCU_Add_Long(n[d]);
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  long before[4];
+  count(m, before);
+  int self = PCU_Comm_Self();
+  int to = (self + 1) % PCU_Comm_Peers();
+  int dim = m->getDimension();
+  apf::Migration* plan = new apf::Migration(m);
+  plan->send(to);
+  apf::MeshIterator* it = m->begin(dim);
+  apf::MeshEntity* e;
+  int i = 0;
+  int kept = 0;
+  while ((e = m->iterate(it)))
+    if (!(i++ % 3)) {
+      plan->send(e, self);
+      ++kept;
+    }
+  m->end(it);
+  PCU_ALWAYS_ASSERT(plan->count() == kept);
+  PCU_ALWAYS_ASSERT(plan->sendingAll() == to);
+  int sent = static_cast<int>(m->count(dim)) - kept;
+  m->migrate(plan);
+  m->verify();
+  long after[4];
+  count(m, after);
+  for (int d = 0; d <= dim; ++d)
+    PCU_ALWAYS_ASSERT(before[d] == after[d]);
+  PCU_Comm_Begin();
+  PCU_COMM_PACK(to, sent);
+  PCU_Comm_Send();
+  int received = 0;
+  while (PCU_Comm_Receive())
+    PCU_COMM_UNPACK(received);
+  PCU_ALWAYS_ASSERT(static_cast<int>(m->count(dim)) == kept + received);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
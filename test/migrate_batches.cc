@@ -0,0 +1,59 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* migrates with a tiny limit, so that the plan runs as many
+   migrations whose dimensions are each sent in several batches,
+   and verifies the result */
+
+namespace {
+
+void count(apf::Mesh* m, long* n)
+{
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    n[d] = 0;
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it)))
+      if (m->isOwned(e))
+        ++n[d];
+    m->end(it);
+    n[d] = PCU_Add_Long(n[d]);
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  long before[4];
+  count(m, before);
+  apf::setMigrationLimit(7);
+  apf::Migration* plan = new apf::Migration(m);
+  int to = (PCU_Comm_Self() + 1) % PCU_Comm_Peers();
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  apf::MeshEntity* e;
+  int i = 0;
+  while ((e = m->iterate(it)))
+    if (i++ % 2)
+      plan->send(e, to);
+  m->end(it);
+  m->migrate(plan);
+  m->verify();
+  long after[4];
+  count(m, after);
+  for (int d = 0; d <= m->getDimension(); ++d)
+    PCU_ALWAYS_ASSERT(before[d] == after[d]);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,66 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* estimates a migration, then does it and checks that the
+   estimates bound what actually happened */
+
+namespace {
+
+long countEntities(apf::Mesh* m)
+{
+  long n = 0;
+  for (int d = 0; d <= m->getDimension(); ++d)
+    n += m->count(d);
+  return n;
+}
+
+long countNeighbors(apf::Mesh* m)
+{
+  apf::Parts peers;
+  apf::getPeers(m, 0, peers);
+  return peers.size();
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  apf::Migration* plan = new apf::Migration(m);
+  apf::MigrationCost local, max;
+  apf::estimateMigration(m, plan, local, max);
+  PCU_ALWAYS_ASSERT(max.sendBytes == 0);
+  PCU_ALWAYS_ASSERT(max.receiveBytes == 0);
+  PCU_ALWAYS_ASSERT(local.entities == countEntities(m));
+  PCU_ALWAYS_ASSERT(local.neighbors == countNeighbors(m));
+  int to = (PCU_Comm_Self() + 1) % PCU_Comm_Peers();
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  apf::MeshEntity* e;
+  int i = 0;
+  while ((e = m->iterate(it)))
+    if (i++ % 2)
+      plan->send(e, to);
+  m->end(it);
+  apf::estimateMigration(m, plan, local, max);
+  if (PCU_Comm_Peers() > 1)
+    PCU_ALWAYS_ASSERT(local.sendBytes > 0);
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(local.sendBytes) ==
+                    PCU_Add_Long(local.receiveBytes));
+  PCU_ALWAYS_ASSERT(long(PCU_Max_SizeT(local.entities)) == max.entities);
+  m->migrate(plan);
+  m->verify();
+  PCU_ALWAYS_ASSERT(countEntities(m) <= local.entities);
+  PCU_ALWAYS_ASSERT(countNeighbors(m) <= local.neighbors);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
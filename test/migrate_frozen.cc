@@ -0,0 +1,110 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <apfNumbering.h>
+#include <apfShape.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* migrates a mesh with frozen fields and a long tag,
+   checking that the fields stay frozen with the values
+   that belong to each node and that the tag follows */
+
+namespace {
+
+apf::Vector3 value(apf::Field* f, apf::MeshEntity* e, int node)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  apf::Vector3 x;
+  apf::getShape(f)->getNodeXi(m->getType(e), node, x);
+  apf::Vector3 c = apf::getLinearCentroid(m, e);
+  return c + x * 0.01;
+}
+
+long key(apf::Mesh* m, apf::MeshEntity* v)
+{
+  apf::Vector3 x;
+  m->getPoint(v, 0, x);
+  return long(x[0] * 1e6) + long(x[1] * 1e3) + long(x[2]);
+}
+
+void fill(apf::Field* f)
+{
+  apf::DynamicArray<apf::Node> nodes;
+  apf::Numbering* n = apf::numberOverlapNodes(apf::getMesh(f), "fill",
+      apf::getShape(f));
+  apf::getNodes(n, nodes);
+  for (size_t i = 0; i < nodes.getSize(); ++i)
+    apf::setVector(f, nodes[i].entity, nodes[i].node,
+        value(f, nodes[i].entity, nodes[i].node));
+  apf::destroyNumbering(n);
+}
+
+void check(apf::Field* f)
+{
+  PCU_ALWAYS_ASSERT(apf::isFrozen(f));
+  double const* a = apf::getArrayData(f);
+  apf::Numbering* n = apf::getArrayNumbering(f);
+  apf::DynamicArray<apf::Node> nodes;
+  apf::getNodes(n, nodes);
+  for (size_t i = 0; i < nodes.getSize(); ++i) {
+    apf::MeshEntity* e = nodes[i].entity;
+    int node = nodes[i].node;
+    int k = apf::getNumber(n, e, node, 0);
+    apf::Vector3 want = value(f, e, node);
+    for (int c = 0; c < 3; ++c)
+      PCU_ALWAYS_ASSERT(a[k * 3 + c] == want[c]);
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  apf::Field* f1 = apf::createFieldOn(m, "linear", apf::VECTOR);
+  apf::Field* f2 = apf::createField(m, "quadratic", apf::VECTOR,
+      apf::getLagrange(2));
+  fill(f1);
+  fill(f2);
+  apf::freeze(f1);
+  apf::freeze(f2);
+  apf::MeshTag* t = m->createLongTag("key", 1);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    long k = key(m, e);
+    m->setLongTag(e, t, &k);
+  }
+  m->end(it);
+  apf::Migration* plan = new apf::Migration(m);
+  int to = (PCU_Comm_Self() + 1) % PCU_Comm_Peers();
+  it = m->begin(m->getDimension());
+  int i = 0;
+  while ((e = m->iterate(it)))
+    if (i++ % 3)
+      plan->send(e, to);
+  m->end(it);
+  m->migrate(plan);
+  m->verify();
+  check(f1);
+  check(f2);
+  it = m->begin(0);
+  while ((e = m->iterate(it))) {
+    long k;
+    m->getLongTag(e, t, &k);
+    PCU_ALWAYS_ASSERT(k == key(m, e));
+  }
+  m->end(it);
+  apf::removeTagFromDimension(m, t, 0);
+  m->destroyTag(t);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
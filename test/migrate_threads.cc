@@ -0,0 +1,82 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <pthread.h>
+#include <vector>
+
+/* fills a migration plan from several threads at once
+   and checks that the migration moved what they asked for */
+
+namespace {
+
+const int threads = 4;
+
+struct Fill
+{
+  apf::MigrationBuffers* buffers;
+  std::vector<apf::MeshEntity*>* elements;
+  int thread;
+  int to;
+};
+
+void* fill(void* arg)
+{
+  Fill* f = static_cast<Fill*>(arg);
+  std::vector<apf::MeshEntity*>& elements = *(f->elements);
+  for (size_t i = f->thread; i < elements.size(); i += threads)
+    if (i % 2)
+      f->buffers->send(f->thread, elements[i], f->to);
+  return 0;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  int dim = m->getDimension();
+  std::vector<apf::MeshEntity*> elements;
+  apf::MeshIterator* it = m->begin(dim);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it)))
+    elements.push_back(e);
+  m->end(it);
+  long total = PCU_Add_Long(elements.size());
+  long sent = elements.size() / 2;
+  apf::MigrationBuffers buffers(m, threads);
+  Fill fills[threads];
+  pthread_t ids[threads];
+  for (int i = 0; i < threads; ++i) {
+    fills[i].buffers = &buffers;
+    fills[i].elements = &elements;
+    fills[i].thread = i;
+    fills[i].to = (PCU_Comm_Self() + 1) % PCU_Comm_Peers();
+    pthread_create(&ids[i], 0, fill, &fills[i]);
+  }
+  for (int i = 0; i < threads; ++i)
+    pthread_join(ids[i], 0);
+  apf::Migration* plan = buffers.makePlan();
+  PCU_ALWAYS_ASSERT(plan->count() == sent);
+  long kept = elements.size() - sent;
+  PCU_Comm_Begin();
+  PCU_COMM_PACK(fills[0].to, sent);
+  PCU_Comm_Send();
+  long received = 0;
+  while (PCU_Comm_Receive())
+    PCU_COMM_UNPACK(received);
+  m->migrate(plan);
+  m->verify();
+  PCU_ALWAYS_ASSERT(long(m->count(dim)) == kept + received);
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(m->count(dim)) == total);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
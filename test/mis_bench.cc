@@ -0,0 +1,130 @@
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfMIS.h>
+#include <apf.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdlib>
+
+namespace {
+
+/* the color of every ghost, asked of its owner */
+void getGhostColors(apf::MisGraph const& g, std::vector<int>& colors)
+{
+  PCU_Comm_Begin();
+  for (size_t i = 0; i < g.ghostOwners.size(); ++i) {
+    int gi = i;
+    PCU_COMM_PACK(g.ghostOwners[i], g.ghostIds[i]);
+    PCU_COMM_PACK(g.ghostOwners[i], gi);
+  }
+  PCU_Comm_Send();
+  std::vector<int> asked;
+  std::vector<int> askers;
+  while (PCU_Comm_Receive()) {
+    int v, gi;
+    PCU_COMM_UNPACK(v);
+    PCU_COMM_UNPACK(gi);
+    asked.push_back(v);
+    askers.push_back(PCU_Comm_Sender());
+    asked.push_back(gi);
+  }
+  PCU_Comm_Begin();
+  for (size_t i = 0; i < askers.size(); ++i) {
+    PCU_COMM_PACK(askers[i], asked[2 * i + 1]);
+    PCU_COMM_PACK(askers[i], colors[asked[2 * i]]);
+  }
+  PCU_Comm_Send();
+  colors.resize(g.owned + g.ghostOwners.size());
+  while (PCU_Comm_Receive()) {
+    int gi, c;
+    PCU_COMM_UNPACK(gi);
+    PCU_COMM_UNPACK(c);
+    colors[g.owned + gi] = c;
+  }
+}
+
+/* neighbors have different colors and a vertex of color c has
+   neighbors of every lower color, so each color is a maximal
+   independent set of what the lower ones left */
+void checkColors(apf::MisGraph const& g, std::vector<int> colors)
+{
+  getGhostColors(g, colors);
+  std::vector<bool> seen;
+  for (int v = 0; v < g.owned; ++v) {
+    PCU_ALWAYS_ASSERT(colors[v] >= 0);
+    seen.assign(colors[v], false);
+    for (int j = g.offsets[v]; j < g.offsets[v + 1]; ++j) {
+      int c = colors[g.adjacent[j]];
+      PCU_ALWAYS_ASSERT(c != colors[v]);
+      if (c < colors[v])
+        seen[c] = true;
+    }
+    for (int c = 0; c < colors[v]; ++c)
+      PCU_ALWAYS_ASSERT(seen[c]);
+  }
+}
+
+/* set members have no neighbors in the set and
+   every other vertex has one */
+void checkSet(apf::MisGraph const& g, std::vector<bool> const& isIn)
+{
+  std::vector<int> in(isIn.begin(), isIn.end());
+  getGhostColors(g, in);
+  for (int v = 0; v < g.owned; ++v) {
+    bool touches = false;
+    for (int j = g.offsets[v]; j < g.offsets[v + 1]; ++j)
+      if (in[g.adjacent[j]])
+        touches = true;
+    PCU_ALWAYS_ASSERT(touches != (bool)in[v]);
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  if (argc != 5) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <nx> <ny> <nz> <is>\n", argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  apf::Mesh2* m = apf::makeDistributedMdsBox(atoi(argv[1]), atoi(argv[2]),
+      atoi(argv[3]), 1, 1, 1, atoi(argv[4]));
+  int dim = m->getDimension();
+  /* vertices by edges, then elements by vertices */
+  int pairs[2][2] = {{0, 1}, {dim, 0}};
+  for (int i = 0; i < 2; ++i) {
+    double t0 = PCU_Time();
+    apf::MisGraph g;
+    std::vector<apf::MeshEntity*> ents;
+    apf::buildMisGraph(m, pairs[i][0], pairs[i][1], g, ents);
+    double t1 = PCU_Time();
+    std::vector<bool> isIn;
+    apf::findIndependentSet(g, 0, isIn);
+    double t2 = PCU_Time();
+    std::vector<int> colors;
+    int ncolors = apf::colorGraph(g, 0, colors);
+    double t3 = PCU_Time();
+    checkSet(g, isIn);
+    checkColors(g, colors);
+    long n = PCU_Add_Long(g.owned);
+    long nin = 0;
+    for (int v = 0; v < g.owned; ++v)
+      nin += isIn[v];
+    nin = PCU_Add_Long(nin);
+    double t[3] = {t1 - t0, t2 - t1, t3 - t2};
+    PCU_Max_Doubles(t, 3);
+    if (!PCU_Comm_Self())
+      printf("%d by %d: %ld vertices, independent set %ld, %d colors; "
+             "graph %f s, set %f s, coloring %f s\n",
+             pairs[i][0], pairs[i][1], n, nin, ncolors, t[0], t[1], t[2]);
+  }
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -8,8 +8,9 @@
 #include <gmi_mesh.h>
 #include <pcu_util.h>
 #include <sstream>
+#include <algorithm>
 
-static void test_numbering(apf::Mesh* m) {
+static int test_numbering(apf::Mesh* m) {
   apf::FieldShape* S2 = apf::getSerendipity();
   apf::FieldShape* S1 = apf::getLagrange(1);
   apf::Field* f1 = apf::createField(m, "u", apf::VECTOR, S2);
@@ -32,6 +33,35 @@ static void test_numbering(apf::Mesh* m) {
   PCU_Debug_Open();
   PCU_Debug_Print("number owned: %d\n", num_owned);
   PCU_Debug_Print("number ghost: %d\n", num_ghost);
+  for (size_t n=0; n < global.size(); ++n)
+    apf::destroyGlobalNumbering(global[n]);
+  return num_ghost;
+}
+
+/* the fused numbering covers the same dofs as the one above, the
+   owned ones consecutively, and every row of its graph couples
+   to itself */
+static void test_fused(apf::Mesh* m, int dofs, apf::MixedLayout layout) {
+  std::vector<apf::Field*> fields;
+  fields.push_back(m->findField("u"));
+  fields.push_back(m->findField("p"));
+  std::vector<apf::GlobalNumbering*> global;
+  long owned = apf::numberGlobal(fields, global, layout);
+  PCU_ALWAYS_ASSERT(apf::countDOFs(global) == dofs);
+  long total = PCU_Add_Long(owned);
+  long first = PCU_Exscan_Long(owned);
+  apf::NodeGraph g;
+  apf::getMixedGraph(global, g);
+  PCU_ALWAYS_ASSERT(g.firstRow == first);
+  PCU_ALWAYS_ASSERT(long(g.offsets.size()) == owned + 1);
+  for (long i=0; i < owned; ++i) {
+    long* b = &g.columns[0] + g.offsets[i];
+    long* e = &g.columns[0] + g.offsets[i + 1];
+    PCU_ALWAYS_ASSERT(std::binary_search(b, e, first + i));
+    PCU_ALWAYS_ASSERT(0 <= *b && *(e - 1) < total);
+  }
+  for (size_t n=0; n < global.size(); ++n)
+    apf::destroyGlobalNumbering(global[n]);
 }
 
 static void write_output(apf::Mesh* m, const char* out) {
@@ -52,7 +82,9 @@ int main(int argc, char** argv)
   gmi_register_mesh();
   apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
   apf::reorderMdsMesh(m);
-  test_numbering(m);
+  int dofs = test_numbering(m);
+  test_fused(m, dofs, apf::NODE_INTERLEAVED);
+  test_fused(m, dofs, apf::FIELD_BLOCKED);
   write_output(m, argv[3]);
   m->destroyNative();
   apf::destroyMesh(m);
@@ -0,0 +1,88 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <apfNumbering.h>
+#include <apfShape.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <map>
+#include <set>
+
+/* builds the node graph of a global numbering and compares
+   it with one gathered through sets of element couplings */
+
+namespace {
+
+typedef std::map<long, std::set<long> > Graph;
+
+void gather(apf::GlobalNumbering* n, Graph& want)
+{
+  apf::Mesh* m = apf::getMesh(n);
+  apf::NewArray<long> numbers;
+  PCU_Comm_Begin();
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    int nen = apf::getElementNumbers(n, e, numbers);
+    for (int i = 0; i < nen; ++i)
+      for (int j = 0; j < nen; ++j)
+        for (int to = 0; to < PCU_Comm_Peers(); ++to) {
+          PCU_COMM_PACK(to, numbers[i]);
+          PCU_COMM_PACK(to, numbers[j]);
+        }
+  }
+  m->end(it);
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    long row, col;
+    PCU_COMM_UNPACK(row);
+    PCU_COMM_UNPACK(col);
+    want[row].insert(col);
+  }
+}
+
+void test(apf::Mesh* m, int order)
+{
+  apf::GlobalNumbering* n = apf::numberGlobalNodes(m, "graph",
+      apf::getLagrange(order));
+  apf::NodeGraph g;
+  apf::getNodeGraph(n, g);
+  Graph want;
+  gather(n, want);
+  long rows = g.offsets.getSize() - 1;
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(rows) == (long)want.size());
+  std::set<long> ghosts;
+  for (long i = 0; i < rows; ++i) {
+    std::set<long>& cols = want[g.firstRow + i];
+    PCU_ALWAYS_ASSERT(g.offsets[i + 1] - g.offsets[i] == (long)cols.size());
+    std::set<long>::iterator c = cols.begin();
+    for (long k = g.offsets[i]; k < g.offsets[i + 1]; ++k, ++c) {
+      PCU_ALWAYS_ASSERT(g.columns[k] == *c);
+      if (*c < g.firstRow || *c >= g.firstRow + rows)
+        ghosts.insert(*c);
+    }
+  }
+  PCU_ALWAYS_ASSERT(g.ghosts.getSize() == ghosts.size());
+  std::set<long>::iterator c = ghosts.begin();
+  for (size_t i = 0; i < g.ghosts.getSize(); ++i, ++c)
+    PCU_ALWAYS_ASSERT(g.ghosts[i] == *c);
+  apf::destroyGlobalNumbering(n);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  test(m, 1);
+  test(m, 2);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,239 @@
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+namespace {
+
+int ringPeer(int offset)
+{
+  int peers = PCU_Comm_Peers();
+  return (PCU_Comm_Self() + offset + peers) % peers;
+}
+
+/* every rank sends (count) integers to each ring neighbor,
+   optionally skipping the right neighbor to check
+   that empty neighbor messages are hidden */
+void exchange(bool neighborly, int count, bool skipRight)
+{
+  if (neighborly)
+    PCU_Comm_Begin_Neighbors();
+  else
+    PCU_Comm_Begin();
+  int self = PCU_Comm_Self();
+  int left = ringPeer(-1);
+  int right = ringPeer(1);
+  for (int i = 0; i < count; ++i) {
+    int value = self * count + i;
+    PCU_COMM_PACK(left, value);
+    if (!skipRight)
+      PCU_COMM_PACK(right, value);
+  }
+  PCU_Comm_Send();
+  int messages = 0;
+  int values = 0;
+  while (PCU_Comm_Listen()) {
+    int from = PCU_Comm_Sender();
+    PCU_ALWAYS_ASSERT(from == left || from == right);
+    while (!PCU_Comm_Unpacked()) {
+      int value;
+      PCU_COMM_UNPACK(value);
+      PCU_ALWAYS_ASSERT(value / count == from);
+      ++values;
+    }
+    ++messages;
+  }
+  std::set<int> senders;
+  if (count) {
+    senders.insert(right);
+    if (!skipRight)
+      senders.insert(left);
+  }
+  PCU_ALWAYS_ASSERT(messages == (int)senders.size());
+  PCU_ALWAYS_ASSERT(values == (skipRight ? 1 : 2) * count);
+}
+
+void testNeighbors()
+{
+  int ring[2] = {ringPeer(-1), ringPeer(1)};
+  PCU_Comm_Neighbors(ring, 2);
+  for (int i = 0; i < 10; ++i) {
+    exchange(true, i, i % 2);
+    exchange(i % 3, 2, false);
+  }
+  exchange(true, 0, false);
+  PCU_Comm_Neighbors(0, 0);
+  PCU_Comm_Begin_Neighbors();
+  PCU_Comm_Send();
+  PCU_ALWAYS_ASSERT(!PCU_Comm_Receive());
+}
+
+void testReserve()
+{
+  const int n = 1000;
+  PCU_Comm_Begin_Named("reserve");
+  double* out = PCU_COMM_RESERVE(ringPeer(1), double, n);
+  for (int i = 0; i < n; ++i)
+    out[i] = PCU_Comm_Self() + i;
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    size_t size;
+    PCU_Comm_Received(&size);
+    PCU_ALWAYS_ASSERT(size == n * sizeof(double));
+    double const* in = PCU_COMM_EXTRACT(double, n);
+    for (int i = 0; i < n; ++i)
+      PCU_ALWAYS_ASSERT(in[i] == PCU_Comm_Sender() + i);
+  }
+}
+
+void checkPhase(PCU_Phase p, int offset, int count)
+{
+  int messages = 0;
+  int last = -1;
+  while (PCU_Phase_Receive(p)) {
+    int from = PCU_Phase_Sender(p);
+    PCU_ALWAYS_ASSERT(from == ringPeer(-offset));
+    PCU_ALWAYS_ASSERT(from > last);
+    last = from;
+    PCU_ALWAYS_ASSERT(PCU_Phase_Received(p) == count * sizeof(int));
+    int const* in = (int const*)PCU_Phase_Extract(p, count * sizeof(int));
+    for (int i = 0; i < count; ++i)
+      PCU_ALWAYS_ASSERT(in[i] == from + i);
+    ++messages;
+  }
+  PCU_ALWAYS_ASSERT(messages == 1);
+}
+
+/* two phases in flight at once with a regular
+   phase run while they are being delivered */
+void testPhases()
+{
+  for (int round = 0; round < 4; ++round) {
+    PCU_Phase a = PCU_Phase_Begin();
+    PCU_Phase b = PCU_Phase_Begin();
+    int self = PCU_Comm_Self();
+    for (int i = 0; i < 10; ++i) {
+      int value = self + i;
+      PCU_PHASE_PACK(a, ringPeer(1), value);
+    }
+    int* out = (int*)PCU_Phase_Reserve(b, ringPeer(-1), 100 * sizeof(int));
+    for (int i = 0; i < 100; ++i)
+      out[i] = self + i;
+    PCU_Phase_Send(a);
+    PCU_Phase_Send(b);
+    exchange(false, 3, false);
+    PCU_Phase_Test(b);
+    if (round % 2) {
+      checkPhase(b, -1, 100);
+      checkPhase(a, 1, 10);
+    } else {
+      PCU_Phase_Wait(a);
+      checkPhase(a, 1, 10);
+    }
+    PCU_Phase_End(a);
+    PCU_Phase_End(b);
+  }
+}
+
+/* sends redundant and random data around the ring,
+   with only some ranks choosing to compress */
+void testCompression()
+{
+  bool compress = !(PCU_Comm_Self() % 2);
+  PCU_Comm_Compress(compress ? 64 : 0);
+  const int n = 10000;
+  /* the small message needs its own peer */
+  bool small = PCU_Comm_Peers() > 2;
+  std::vector<int> values(n);
+  srand(PCU_Comm_Self() + 1);
+  for (int pass = 0; pass < 2; ++pass) {
+    for (int i = 0; i < n; ++i)
+      values[i] = pass ? rand() : (i % 7) + PCU_Comm_Self();
+    size_t raw0, wire0;
+    PCU_Comm_Traffic(&raw0, &wire0);
+    PCU_Comm_Begin();
+    PCU_Comm_Pack(ringPeer(1), &values[0], n * sizeof(int));
+    int answer = 42;
+    if (small)
+      PCU_COMM_PACK(ringPeer(-1), answer);
+    PCU_Comm_Send();
+    while (PCU_Comm_Receive()) {
+      size_t size;
+      PCU_Comm_Received(&size);
+      if (size == sizeof(int)) {
+        PCU_COMM_UNPACK(answer);
+        PCU_ALWAYS_ASSERT(answer == 42);
+        continue;
+      }
+      PCU_ALWAYS_ASSERT(size == n * sizeof(int));
+      std::vector<int> in(n);
+      PCU_Comm_Unpack(&in[0], size);
+      if (!pass)
+        for (int i = 0; i < n; ++i)
+          PCU_ALWAYS_ASSERT(in[i] == (i % 7) + PCU_Comm_Sender());
+    }
+    size_t raw1, wire1;
+    PCU_Comm_Traffic(&raw1, &wire1);
+    PCU_ALWAYS_ASSERT(raw1 - raw0 == (n + small) * sizeof(int));
+    if (compress && !pass)
+      PCU_ALWAYS_ASSERT(wire1 - wire0 < (raw1 - raw0) / 10);
+  }
+  PCU_Comm_Compress(0);
+}
+
+void testCollectives()
+{
+  int self = PCU_Comm_Self();
+  int peers = PCU_Comm_Peers();
+  long sum = (long)peers * (peers - 1) / 2;
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(self) == sum);
+  PCU_ALWAYS_ASSERT(PCU_Max_Int(self) == peers - 1);
+  PCU_ALWAYS_ASSERT(PCU_Min_Double(self + 0.5) == 0.5);
+  long before[2] = {self, 1};
+  PCU_Exscan_Longs(before, 2);
+  PCU_ALWAYS_ASSERT(before[0] == (long)self * (self - 1) / 2);
+  PCU_ALWAYS_ASSERT(before[1] == self);
+  PCU_ALWAYS_ASSERT(PCU_Exscan_Int(2) == 2 * self);
+  PCU_Barrier();
+}
+
+/* the same tests with every thread as a rank */
+void* runThreaded(void*)
+{
+  PCU_ALWAYS_ASSERT(PCU_Comm_Peers() == PCU_Proc_Peers() * PCU_Thrd_Peers());
+  PCU_ALWAYS_ASSERT(PCU_Comm_Self() ==
+      PCU_Proc_Self() * PCU_Thrd_Peers() + PCU_Thrd_Self());
+  testNeighbors();
+  testReserve();
+  testCollectives();
+  testCompression();
+  return 0;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  int provided;
+  MPI_Init_thread(&argc,&argv,MPI_THREAD_MULTIPLE,&provided);
+  PCU_Comm_Init();
+  PCU_Protect();
+  PCU_Comm_Profile(true);
+  testNeighbors();
+  PCU_Comm_Graph(true);
+  testNeighbors();
+  PCU_Comm_Graph(false);
+  testReserve();
+  testCollectives();
+  testPhases();
+  testCompression();
+  if (provided == MPI_THREAD_MULTIPLE)
+    PCU_Thrd_Run(3, runThreaded, 0);
+  if (!PCU_Comm_Self())
+    printf("pcu_msg tests passed%s\n",
+        provided == MPI_THREAD_MULTIPLE ? ", also with threads" : "");
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
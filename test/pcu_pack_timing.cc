@@ -0,0 +1,77 @@
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/* packs many small records to randomly chosen neighbors,
+   stressing the peer lookup in PCU_Comm_Pack */
+
+namespace {
+
+struct Record {
+  long id;
+  double value;
+};
+
+void getNeighbors(int count, std::vector<int>& neighbors)
+{
+  int self = PCU_Comm_Self();
+  int peers = PCU_Comm_Peers();
+  for (int i = 0; i < count; ++i) {
+    int offset = (i / 2 + 1) * ((i % 2) ? -1 : 1);
+    neighbors.push_back(((self + offset) % peers + peers) % peers);
+  }
+}
+
+void run(long records, int neighborCount)
+{
+  std::vector<int> neighbors;
+  getNeighbors(neighborCount, neighbors);
+  srand(PCU_Comm_Self() + 1);
+  double t0 = PCU_Time();
+  PCU_Comm_Begin();
+  for (long i = 0; i < records; ++i) {
+    Record r;
+    r.id = i;
+    r.value = i * 0.5;
+    PCU_COMM_PACK(neighbors[rand() % neighborCount], r);
+  }
+  double t1 = PCU_Time();
+  PCU_Comm_Send();
+  long received = 0;
+  while (PCU_Comm_Receive()) {
+    Record r;
+    PCU_COMM_UNPACK(r);
+    ++received;
+  }
+  double t2 = PCU_Time();
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(received) == PCU_Add_Long(records));
+  double pack = PCU_Max_Double(t1 - t0);
+  double exchange = PCU_Max_Double(t2 - t1);
+  if (!PCU_Comm_Self())
+    printf("packed %ld records of %lu bytes to %d neighbors: "
+           "pack %f seconds, exchange %f seconds\n",
+           records, (unsigned long)sizeof(Record), neighborCount,
+           pack, exchange);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  long records = 10 * 1000 * 1000;
+  int neighborCount = 16;
+  if (argc > 1)
+    records = atol(argv[1]);
+  if (argc > 2)
+    neighborCount = atoi(argv[2]);
+  PCU_ALWAYS_ASSERT(neighborCount > 0);
+  for (int i = 0; i < 3; ++i)
+    run(records, neighborCount);
+  PCU_Comm_Free();
+  MPI_Finalize();
+  return 0;
+}
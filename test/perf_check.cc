@@ -0,0 +1,381 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <ma.h>
+#include <parma.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* Runs named performance scenarios on generated boxes with the PCU
+   timers on, and either records the seconds of every timer region
+   as a JSON baseline or compares them with one. A region is known
+   by its path from the scenario, such as "ma_adapt/ma::adapt/
+   ma::coarsen", and its seconds are those of the slowest rank.
+   Comparing prints one "perf," line per region and fails if a region
+   got slower than the tolerance allows. */
+
+namespace {
+
+int n;
+
+apf::Mesh2* makeBox()
+{
+  return apf::makeDistributedMdsBox(n, n, n, 1, 1, 1, true);
+}
+
+void destroy(apf::Mesh2* m)
+{
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+ma::Input* configureQuiet(ma::Input* in)
+{
+  in->shouldSnap = false;
+  in->shouldTransferParametric = false;
+  return in;
+}
+
+/* uniform refinement, as in the refine2x tests */
+void runRefine()
+{
+  apf::Mesh2* m = makeBox();
+  ma::adapt(configureQuiet(ma::configureUniformRefine(m, 1)));
+  destroy(m);
+}
+
+/* the graded size field of ma_test, refining on one side of
+   the box and coarsening on the other, with ParMA balancing */
+class Linear : public ma::IsotropicFunction
+{
+  public:
+    Linear(ma::Mesh* m)
+    {
+      mesh = m;
+      average = ma::getAverageEdgeLength(m);
+      ma::getBoundingBox(m, lower, upper);
+    }
+    virtual double getValue(ma::Entity* v)
+    {
+      ma::Vector p = ma::getPosition(mesh, v);
+      double x = (p[0] - lower[0]) / (upper[0] - lower[0]);
+      return average * (4 * x + 2) / 3;
+    }
+  private:
+    ma::Mesh* mesh;
+    double average;
+    ma::Vector lower;
+    ma::Vector upper;
+};
+
+void runAdapt()
+{
+  apf::Mesh2* m = makeBox();
+  Linear sf(m);
+  ma::Input* in = configureQuiet(ma::configure(m, &sf));
+  in->shouldRunMidParma = true;
+  in->shouldRunPostParma = true;
+  ma::adapt(in);
+  destroy(m);
+}
+
+void setUnitWeight(apf::Mesh* m, apf::MeshTag* tag, int dim)
+{
+  double w = 1;
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(dim);
+  while ((e = m->iterate(it)))
+    m->setDoubleTag(e, tag, &w);
+  m->end(it);
+}
+
+/* after a quarter of the elements of odd parts moved to the part
+   below: the memory balancing of bench, then the vertex and
+   element balancing of ptnParma */
+void runParma()
+{
+  apf::Mesh2* m = makeBox();
+  int dim = m->getDimension();
+  int self = PCU_Comm_Self();
+  apf::Migration* plan = new apf::Migration(m);
+  if (self % 2) {
+    apf::MeshIterator* it = m->begin(dim);
+    apf::MeshEntity* e;
+    int i = 0;
+    while ((e = m->iterate(it)))
+      if (i++ % 4 == 0)
+        plan->send(e, self - 1);
+    m->end(it);
+  }
+  apf::migrateSilent(m, plan);
+  apf::MeshTag* weights = Parma_WeighByMemory(m);
+  apf::Balancer* balancer = Parma_MakeElmBalancer(m);
+  balancer->balance(weights, 1.05);
+  delete balancer;
+  apf::removeTagFromDimension(m, weights, dim);
+  m->destroyTag(weights);
+  weights = m->createDoubleTag("perf_check_weight", 1);
+  setUnitWeight(m, weights, 0);
+  setUnitWeight(m, weights, dim);
+  balancer = Parma_MakeVtxElmBalancer(m, 0.5, 0);
+  balancer->balance(weights, 1.05);
+  delete balancer;
+  apf::removeTagFromDimension(m, weights, 0);
+  apf::removeTagFromDimension(m, weights, dim);
+  m->destroyTag(weights);
+  destroy(m);
+}
+
+void runSmb()
+{
+  apf::Mesh2* m = makeBox();
+  m->writeNative("perf_check.smb");
+  apf::Mesh2* read = apf::loadMdsMesh(m->getModel(), "perf_check.smb");
+  apf::disownMdsModel(read);
+  destroy(read);
+  destroy(m);
+}
+
+struct Scenario
+{
+  const char* name;
+  void (*run)();
+};
+
+Scenario const scenarios[] = {
+  {"ma_refine", runRefine},
+  {"ma_adapt", runAdapt},
+  {"parma_balance", runParma},
+  {"smb_roundtrip", runSmb}
+};
+int const nscenarios = sizeof(scenarios) / sizeof(scenarios[0]);
+
+typedef std::map<std::string, double> Times;
+
+/* the local regions by path */
+void getLocalTimes(Times& times)
+{
+  std::vector<std::string> paths(PCU_Timers_Count());
+  for (int i = 0; i < PCU_Timers_Count(); ++i) {
+    int parent = PCU_Timer_Parent(i);
+    paths[i] = PCU_Timer_Name(i);
+    if (parent >= 0)
+      paths[i] = paths[parent] + "/" + paths[i];
+    times[paths[i]] += PCU_Timer_Seconds(i);
+  }
+}
+
+void packString(int to, std::string const& s)
+{
+  int length = s.size();
+  PCU_COMM_PACK(to, length);
+  PCU_Comm_Pack(to, s.c_str(), length);
+}
+
+std::string unpackString()
+{
+  int length;
+  PCU_COMM_UNPACK(length);
+  std::string s(length, ' ');
+  PCU_Comm_Unpack(&s[0], length);
+  return s;
+}
+
+/* regions may differ by rank, so rank 0 collects all paths
+   and every rank then reduces its seconds along them */
+void getTimes(Times& times)
+{
+  Times local;
+  getLocalTimes(local);
+  PCU_Comm_Begin();
+  for (Times::iterator it = local.begin(); it != local.end(); ++it)
+    packString(0, it->first);
+  PCU_Comm_Send();
+  std::set<std::string> all;
+  while (PCU_Comm_Receive())
+    all.insert(unpackString());
+  PCU_Comm_Begin();
+  if (!PCU_Comm_Self())
+    for (int to = 0; to < PCU_Comm_Peers(); ++to)
+      for (std::set<std::string>::iterator it = all.begin();
+           it != all.end(); ++it)
+        packString(to, *it);
+  PCU_Comm_Send();
+  std::vector<std::string> paths;
+  while (PCU_Comm_Receive())
+    paths.push_back(unpackString());
+  std::vector<double> seconds(paths.size() + 1, 0);
+  for (size_t i = 0; i < paths.size(); ++i)
+    if (local.count(paths[i]))
+      seconds[i] = local[paths[i]];
+  PCU_Max_Doubles(&seconds[0], paths.size());
+  for (size_t i = 0; i < paths.size(); ++i)
+    times[paths[i]] = seconds[i];
+}
+
+void writeBaseline(const char* path, Times const& times)
+{
+  std::ofstream f(path);
+  PCU_ALWAYS_ASSERT(f);
+  f << "{\n  \"n\": " << n << ",\n  \"ranks\": " << PCU_Comm_Peers()
+    << ",\n  \"seconds\": {";
+  char const* sep = "\n";
+  f.precision(9);
+  for (Times::const_iterator it = times.begin(); it != times.end(); ++it) {
+    f << sep << "    \"" << it->first << "\": " << it->second;
+    sep = ",\n";
+  }
+  f << "\n  }\n}\n";
+}
+
+/* reads what writeBaseline writes: the "key": number pairs,
+   the ones inside "seconds" being region paths */
+bool readBaseline(const char* path, Times& times, int& baseN, int& ranks)
+{
+  std::ifstream f(path);
+  if (!f)
+    return false;
+  std::stringstream ss;
+  ss << f.rdbuf();
+  std::string text = ss.str();
+  bool inSeconds = false;
+  size_t i = 0;
+  while ((i = text.find('"', i)) != std::string::npos) {
+    size_t end = text.find('"', i + 1);
+    if (end == std::string::npos)
+      return false;
+    std::string key = text.substr(i + 1, end - i - 1);
+    size_t colon = text.find_first_not_of(" \t\n", end + 1);
+    if (colon == std::string::npos || text[colon] != ':')
+      return false;
+    size_t value = text.find_first_not_of(" \t\n", colon + 1);
+    if (value == std::string::npos)
+      return false;
+    i = value;
+    if (text[value] == '{') {
+      inSeconds = (key == "seconds");
+      continue;
+    }
+    double x = atof(text.c_str() + value);
+    if (inSeconds)
+      times[key] = x;
+    else if (key == "n")
+      baseN = x;
+    else if (key == "ranks")
+      ranks = x;
+  }
+  return true;
+}
+
+/* differences below this many seconds are noise */
+double const floorSeconds = 1e-3;
+
+bool compare(Times const& base, Times const& now, double tolerance)
+{
+  bool ok = true;
+  std::set<std::string> paths;
+  for (Times::const_iterator it = base.begin(); it != base.end(); ++it)
+    paths.insert(it->first);
+  for (Times::const_iterator it = now.begin(); it != now.end(); ++it)
+    paths.insert(it->first);
+  printf("#perf,region,baseline,seconds,delta_percent,status\n");
+  for (std::set<std::string>::iterator it = paths.begin();
+       it != paths.end(); ++it) {
+    Times::const_iterator b = base.find(*it);
+    Times::const_iterator c = now.find(*it);
+    if (b == base.end()) {
+      printf("perf,%s,,%.6f,,new\n", it->c_str(), c->second);
+      continue;
+    }
+    if (c == now.end()) {
+      printf("perf,%s,%.6f,,,missing\n", it->c_str(), b->second);
+      continue;
+    }
+    double delta = c->second - b->second;
+    double percent = b->second > 0 ? 100 * delta / b->second : 0;
+    bool slower = c->second > b->second * (1 + tolerance) &&
+                  delta > floorSeconds;
+    if (slower)
+      ok = false;
+    printf("perf,%s,%.6f,%.6f,%+.1f,%s\n", it->c_str(), b->second,
+        c->second, percent, slower ? "SLOWER" : "ok");
+  }
+  return ok;
+}
+
+bool isSelected(const char* name, int argc, char** argv)
+{
+  if (argc <= 5)
+    return true;
+  for (int i = 5; i < argc; ++i)
+    if (!strcmp(argv[i], name))
+      return true;
+  return false;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  if (argc < 4 || (strcmp(argv[1], "record") && strcmp(argv[1], "compare"))) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <record|compare> <baseline.json> <n> "
+             "[tolerance] [scenarios]\n"
+             "  n: box divisions per axis\n"
+             "  tolerance: allowed slowdown, 0.2 for 20%%\n",
+             argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  bool record = !strcmp(argv[1], "record");
+  const char* baselinePath = argv[2];
+  n = atoi(argv[3]);
+  double tolerance = argc > 4 ? atof(argv[4]) : 0.2;
+  PCU_Timers(true);
+  for (int i = 0; i < nscenarios; ++i)
+    if (isSelected(scenarios[i].name, argc, argv)) {
+      PCU_Barrier();
+      PCU_Region region(scenarios[i].name);
+      scenarios[i].run();
+    }
+  Times times;
+  getTimes(times);
+  int failed = 0;
+  if (!PCU_Comm_Self()) {
+    if (record) {
+      writeBaseline(baselinePath, times);
+      printf("recorded %d regions in %s\n", (int)times.size(), baselinePath);
+    } else {
+      Times base;
+      int baseN = n;
+      int ranks = PCU_Comm_Peers();
+      if (!readBaseline(baselinePath, base, baseN, ranks)) {
+        fprintf(stderr, "could not read baseline %s\n", baselinePath);
+        failed = 1;
+      } else {
+        if (baseN != n || ranks != PCU_Comm_Peers())
+          printf("warning: baseline of n %d on %d ranks, "
+                 "this run is n %d on %d ranks\n",
+                 baseN, ranks, n, PCU_Comm_Peers());
+        failed = !compare(base, times, tolerance);
+      }
+    }
+  }
+  failed = PCU_Max_Int(failed);
+  PCU_Timers(false);
+  PCU_Comm_Free();
+  MPI_Finalize();
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+#include <apf.h>
+#include <apfBox.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_null.h>
+#include <phInput.h>
+#include <phIO.h>
+#include <phRestart.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+/* writes the geombc coordinates and a restart of a distributed box
+   as if it were on twice as many parts, each rank writing its
+   vertices as two source parts, then reads the restart back with
+   restartSourceParts and checks the values each vertex gets */
+
+namespace {
+
+int const step = 3;
+int const vars = 2;
+char const* const prefix = "ph_redistribute_files/restart";
+
+void getValues(apf::Vector3 const& x, double* v)
+{
+  v[0] = x[0] + 10 * x[1] + 100 * x[2];
+  v[1] = -x[0];
+}
+
+FILE* openfile_read(ph::Input&, const char* path)
+{
+  return fopen(path, "r");
+}
+
+/* writes the vertices [first, end) of (verts) as source part (part) */
+void writeSourcePart(apf::Mesh* m, std::vector<apf::MeshEntity*>& verts,
+    size_t first, size_t end, int part)
+{
+  int nodes = end - first;
+  std::vector<double> coords(3 * nodes);
+  std::vector<double> values(vars * nodes);
+  for (int j = 0; j < nodes; ++j) {
+    apf::Vector3 x;
+    m->getPoint(verts[first + j], 0, x);
+    double v[vars];
+    getValues(x, v);
+    for (int k = 0; k < 3; ++k)
+      coords[k * nodes + j] = x[k];
+    for (int k = 0; k < vars; ++k)
+      values[k * nodes + j] = v[k];
+  }
+  std::stringstream ss;
+  ss << "ph_redistribute_files/geombc.dat." << part + 1;
+  FILE* f = fopen(ss.str().c_str(), "w");
+  PCU_ALWAYS_ASSERT(f);
+  ph_write_preamble(f);
+  int params[2] = {nodes, 3};
+  ph_write_doubles(f, "co-ordinates", &coords[0], coords.size(), 2, params);
+  fclose(f);
+  ss.str("");
+  ss << prefix << '.' << step << '.' << part + 1;
+  f = fopen(ss.str().c_str(), "w");
+  PCU_ALWAYS_ASSERT(f);
+  ph_write_preamble(f);
+  ph_write_field(f, "solution", &values[0], nodes, vars, step);
+  fclose(f);
+}
+
+void writeSource(apf::Mesh* m)
+{
+  if (!PCU_Comm_Self())
+    mkdir("ph_redistribute_files", 0755);
+  PCU_Barrier();
+  std::vector<apf::MeshEntity*> verts;
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it)))
+    verts.push_back(v);
+  m->end(it);
+  size_t half = verts.size() / 2;
+  writeSourcePart(m, verts, 0, half, 2 * PCU_Comm_Self());
+  writeSourcePart(m, verts, half, verts.size(), 2 * PCU_Comm_Self() + 1);
+  PCU_Barrier();
+}
+
+void check(apf::Mesh* m)
+{
+  apf::Field* f = m->findField("solution");
+  PCU_ALWAYS_ASSERT(f);
+  PCU_ALWAYS_ASSERT(apf::countComponents(f) == vars);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    double expected[vars];
+    getValues(x, expected);
+    double got[vars];
+    apf::getComponents(f, v, 0, got);
+    for (int k = 0; k < vars; ++k)
+      PCU_ALWAYS_ASSERT(got[k] == expected[k]);
+  }
+  m->end(it);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 1);
+  gmi_register_null();
+  apf::Mesh2* m = apf::makeDistributedMdsBox(6, 6, 6, 1, 1, 1, true);
+  writeSource(m);
+  ph::Input in;
+  in.openfile_read = openfile_read;
+  in.restartFileName = prefix;
+  in.timeStepNumber = step;
+  in.restartSourceParts = 2 * PCU_Comm_Peers();
+  in.ensa_dof = vars;
+  ph::readAndAttachFields(in, m);
+  check(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
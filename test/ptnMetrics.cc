@@ -0,0 +1,109 @@
+#include "spikedChain.h"
+#include <apf.h>
+#include <apfMesh2.h>
+#include <gmi_null.h>
+#include <parma.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+/* computes the partition metrics of a chain of slabs of tets with
+   most of them on part 0, checks them against the separate stat
+   queries, and appends them in both file formats */
+
+namespace {
+
+bool near(double a, double b) {
+  return std::fabs(a - b) < 1e-9 * std::max(1.0, std::fabs(b));
+}
+
+int countLines(const char* path) {
+  FILE* f = fopen(path, "r");
+  PCU_ALWAYS_ASSERT(f);
+  int lines = 0;
+  int c;
+  while ((c = fgetc(f)) != EOF)
+    if (c == '\n')
+      ++lines;
+  fclose(f);
+  return lines;
+}
+
+void checkMetrics(apf::Mesh* m, apf::MeshTag* weights,
+    Parma_PtnMetrics const& pm) {
+  PCU_ALWAYS_ASSERT(pm.parts == PCU_Comm_Peers());
+  double imb[4];
+  Parma_GetEntImbalance(m, &imb);
+  for (int d = 0; d < 4; ++d)
+    PCU_ALWAYS_ASSERT(near(pm.entImbalance[d], imb[d]));
+  Parma_GetWeightedEntImbalance(m, weights, &imb);
+  for (int d = 0; d < 4; ++d)
+    PCU_ALWAYS_ASSERT(near(pm.weightedImbalance[d], imb[d]));
+  int max, numMax, loc, min;
+  long tot;
+  double avg;
+  Parma_GetNeighborStats(m, max, numMax, avg, loc);
+  PCU_ALWAYS_ASSERT(pm.maxNeighbors == max);
+  PCU_ALWAYS_ASSERT(near(pm.avgNeighbors, avg));
+  Parma_GetSharedBdryVtxStats(m, loc, tot, min, max, avg);
+  PCU_ALWAYS_ASSERT(pm.totSharedVtx == tot);
+  PCU_ALWAYS_ASSERT(pm.maxSharedVtx == max);
+  PCU_ALWAYS_ASSERT(pm.minSharedVtx == min);
+  PCU_ALWAYS_ASSERT(near(pm.avgSharedVtx, avg));
+  Parma_GetOwnedBdryVtxStats(m, loc, tot, min, max, avg);
+  PCU_ALWAYS_ASSERT(pm.totOwnedBdryVtx == tot);
+  Parma_GetDisconnectedStats(m, max, avg, loc);
+  PCU_ALWAYS_ASSERT(pm.maxDisconnected == max);
+  PCU_ALWAYS_ASSERT(near(pm.avgDisconnected, avg));
+  PCU_ALWAYS_ASSERT(pm.emptyParts == 0);
+  /* every shared vertex copy sends to each of its other copies */
+  PCU_ALWAYS_ASSERT(pm.commVolume >= pm.totSharedVtx);
+  PCU_ALWAYS_ASSERT(pm.maxCommVolume >= pm.maxSharedVtx);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  gmi_register_null();
+  apf::Mesh2* m = makeSpikedChain();
+  apf::MeshTag* weights = setWeights(m);
+  const char* csv = "ptnMetrics.csv";
+  const char* json = "ptnMetrics.json";
+  if (!PCU_Comm_Self()) {
+    remove(csv);
+    remove(json);
+  }
+  Parma_PtnMetrics pm;
+  Parma_GetPtnMetrics(m, weights, pm);
+  checkMetrics(m, weights, pm);
+  Parma_WritePtnMetrics(pm, csv, "initial");
+  Parma_WritePtnMetrics(pm, json, "initial");
+  apf::Balancer* balancer = Parma_MakeElmBalancer(m, 0.5, 0);
+  balancer->balance(weights, 1.05);
+  delete balancer;
+  Parma_PtnMetrics balanced;
+  Parma_GetPtnMetrics(m, weights, balanced);
+  checkMetrics(m, weights, balanced);
+  PCU_ALWAYS_ASSERT(balanced.entImbalance[3] < pm.entImbalance[3]);
+  Parma_WritePtnMetrics(balanced, csv, "balanced");
+  Parma_WritePtnMetrics(balanced, json, "balanced");
+  if (!PCU_Comm_Self()) {
+    printf("element imbalance %.3f -> %.3f, comm volume %ld -> %ld\n",
+        pm.entImbalance[3], balanced.entImbalance[3],
+        pm.commVolume, balanced.commVolume);
+    /* one header row and two data rows, two json rows */
+    PCU_ALWAYS_ASSERT(countLines(csv) == 3);
+    PCU_ALWAYS_ASSERT(countLines(json) == 2);
+  }
+  apf::removeTagFromDimension(m, weights, m->getDimension());
+  m->destroyTag(weights);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
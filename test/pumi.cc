@@ -2,6 +2,7 @@
 #include <apf.h>
 #include <apfMesh2.h>
 #include <apfMDS.h>
+#include <apfShape.h>
 #include <PCU.h>
 #include <apfZoltan.h>
 #include <pcu_util.h>
@@ -79,6 +80,8 @@ void TEST_MESH(pMesh m);
 void TEST_MESH_TAG(pMesh m);
 void TEST_NEW_MESH(pMesh m);
 void TEST_GHOSTING(pMesh m);
+void TEST_GHOST_UPDATE(pMesh m);
+void TEST_GHOST_FIELD(pMesh m);
 void TEST_FIELD(pMesh m);
 
 //*********************************************************
@@ -188,8 +191,13 @@ int main(int argc, char** argv)
 
   TEST_MESH(m);
  
- // re-load partitioned mesh via file i/o
+ // re-load partitioned mesh via file i/o, deleting the mesh while
+ // its owners are frozen
+  pOwnership frozen=new testOwnership(m);
+  pumi_ownership_freeze(m, frozen);
   pumi_mesh_delete(m);
+  PCU_ALWAYS_ASSERT(!pumi::instance()->owner_mesh);
+  delete frozen;
 
   g = pumi_geom_load(modelFile);
   if (num_in_part==1 && pumi_size()>1)
@@ -200,6 +208,10 @@ int main(int argc, char** argv)
 
   pOwnership o=new testOwnership(m);
   pumi_ownership_verify(m, o);
+  mit = m->begin(0);
+  while ((e = m->iterate(mit)))
+    PCU_ALWAYS_ASSERT(pumi_ment_getOwnPID(e, o)==o->getOwner(e));
+  m->end(mit);
   delete o;
 
   if (!pumi_rank()) std::cout<<"\n[test_pumi] clean loaded tags from the mesh file\n";
@@ -226,6 +238,8 @@ int main(int argc, char** argv)
   if (!pumi_rank()) std::cout<<"\n[test_pumi] "<<fields.size()<<" field(s) generated, synchronized, and frozen\n\n";
 
   TEST_GHOSTING(m);
+  TEST_GHOST_UPDATE(m);
+  TEST_GHOST_FIELD(m);
 
   // delete global ID
   pumi_mesh_deleteGlobalID(m);
@@ -256,6 +270,11 @@ void TEST_MESH(pMesh m)
   pMeshEnt e;
   std::vector<pMeshEnt> adj_vtx;
   std::vector<pMeshEnt> adj_elem;
+  std::vector<int> offsets, targets, offsets2, targets2;
+  pumi_mesh_getAdj(m, mesh_dim, 0, offsets, targets);
+  pumi_mesh_get2ndAdj(m, mesh_dim, 0, mesh_dim, offsets2, targets2);
+  PCU_ALWAYS_ASSERT(offsets.size()==(size_t)pumi_mesh_getNumEnt(m, mesh_dim)+1);
+  int row=0;
 
   pMeshIter mit = m->begin(mesh_dim);
   while ((e = m->iterate(mit)))
@@ -266,6 +285,16 @@ void TEST_MESH(pMesh m)
     adj_vtx.clear();
     pumi_ment_getAdj(e, 0, adj_vtx);
     PCU_ALWAYS_ASSERT((size_t)pumi_ment_getNumAdj(e, 0)==adj_vtx.size());
+    // check bulk adjacency
+    PCU_ALWAYS_ASSERT((size_t)(offsets[row+1]-offsets[row])==adj_vtx.size());
+    for (size_t i=0; i<adj_vtx.size(); ++i)
+      PCU_ALWAYS_ASSERT(targets[offsets[row]+i]==pumi_ment_getID(adj_vtx[i]));
+    std::vector<pMeshEnt> adj_2nd;
+    pumi_ment_get2ndAdj(e, 0, mesh_dim, adj_2nd);
+    PCU_ALWAYS_ASSERT((size_t)(offsets2[row+1]-offsets2[row])==adj_2nd.size());
+    for (size_t i=0; i<adj_2nd.size(); ++i)
+      PCU_ALWAYS_ASSERT(targets2[offsets2[row]+i]==pumi_ment_getID(adj_2nd[i]));
+    ++row;
 
     adj_elem.clear();
     pumi_ment_getAdj(adj_vtx.at(0), mesh_dim, adj_elem);
@@ -740,6 +769,57 @@ void TEST_FIELD(pMesh m)
   }
   m->end(it);
   pumi_field_verify(m, f, o);
+
+  // owners evaluated once
+  pumi_ownership_freeze(m, o);
+  it = m->begin(0);
+  while ((e = m->iterate(it)))
+  {
+    PCU_ALWAYS_ASSERT(pumi_ment_getOwnPID(e, o)==o->getOwner(e));
+    PCU_ALWAYS_ASSERT(pumi_ment_isOwned(e, o)==o->isOwned(e));
+  }
+  m->end(it);
+  pumi_ownership_unfreeze(m);
+
+  // the owned values as one array
+  pFieldView v = pumi_field_createView(f, o);
+  double* values = pumi_fieldView_getData(v);
+  int size = pumi_fieldView_getSize(v);
+  for (int i=0; i<size; ++i)
+    values[i] *= 2.;
+  pumi_field_synchronize(v);
+  int k=0;
+  it = m->begin(0);
+  while ((e = m->iterate(it)))
+  {
+    pumi_node_getCoord(e, 0, xyz);
+    pumi_node_getField(f, e, 0, data);
+    for (int i=0; i<3;++i)
+      if (pumi_ment_isOnBdry(e))
+        PCU_ALWAYS_ASSERT(data[i] == 2.*pumi_ment_getGlobalID(e));
+      else
+        PCU_ALWAYS_ASSERT(data[i] == 2.*xyz[i]);
+    if (pumi_ment_isOwned(e, o))
+      for (int i=0; i<3;++i)
+        PCU_ALWAYS_ASSERT(values[k++] == data[i]);
+  }
+  m->end(it);
+  PCU_ALWAYS_ASSERT(k==size);
+  // each copy adds its value onto the owner
+  std::vector<double> before(values, values+size);
+  pumi_field_accumulate(v);
+  k=0;
+  it = m->begin(0);
+  while ((e = m->iterate(it)))
+  {
+    pumi_node_getField(f, e, 0, data);
+    if (!pumi_ment_isOwned(e, o)) continue;
+    int copies = pumi_ment_getNumRmt(e)+1;
+    for (int i=0; i<3;++i, ++k)
+      PCU_ALWAYS_ASSERT(values[k] == data[i] && values[k] == copies*before[k]);
+  }
+  m->end(it);
+  pumi_fieldView_delete(v);
   delete o;
 }
 
@@ -0,0 +1,127 @@
+#include <apf.h>
+#include <apfShape.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <pumi.h>
+#include <iostream>
+#include <vector>
+
+/* the ghosting tests of test_pumi, see pumi.cc */
+
+static void getGhostCounts(pMesh m, int* counts)
+{
+  for (int i=0; i<4; ++i)
+    counts[i] = pumi_mesh_getNumEnt(m, i);
+}
+
+static void checkGhostCounts(pMesh m, int* counts)
+{
+  for (int i=0; i<4; ++i)
+    PCU_ALWAYS_ASSERT(counts[i] == pumi_mesh_getNumEnt(m, i));
+  pumi_mesh_verify(m);
+  pumi_field_verify(m);
+}
+
+void TEST_GHOST_UPDATE(pMesh m)
+{
+  int mesh_dim=pumi_mesh_getDim(m);
+  int org_mcount[4], one_layer[4], two_layers[4], face_layer[4];
+  getGhostCounts(m, org_mcount);
+  pumi_ghost_createLayer (m, 0, mesh_dim, 1, 1);
+  getGhostCounts(m, one_layer);
+  pumi_ghost_delete(m);
+  pumi_ghost_createLayer (m, 0, mesh_dim, 2, 1);
+  getGhostCounts(m, two_layers);
+  pumi_ghost_delete(m);
+  pumi_ghost_createLayer (m, mesh_dim-1, mesh_dim, 1, 0);
+  getGhostCounts(m, face_layer);
+
+  // each update must match ghosting from scratch
+  pumi_ghost_updateLayer (m, 0, mesh_dim, 1, 1);
+  checkGhostCounts(m, one_layer);
+  pumi_ghost_updateLayer (m, 0, mesh_dim, 2, 1);
+  checkGhostCounts(m, two_layers);
+  pumi_ghost_updateLayer (m, 0, mesh_dim, 1, 1);
+  checkGhostCounts(m, one_layer);
+  pumi_ghost_updateLayer (m, mesh_dim-1, mesh_dim, 1, 0);
+  checkGhostCounts(m, face_layer);
+  pumi_ghost_updateLayer (m, mesh_dim-1, mesh_dim, 0, 0);
+  checkGhostCounts(m, org_mcount);
+  if (!pumi_rank()) std::cout<<"\n[test_pumi] pumi_ghost_updateLayer matches pumi_ghost_createLayer\n";
+}
+
+static double ghostValue(pMeshEnt e, int node, int comp)
+{
+  return pumi_ment_getGlobalID(e)*100 + node*10 + comp;
+}
+
+/* owners set element values, ghosts start wrong,
+   and one run of the plan must fix every ghost */
+static void setGhostFields(pMesh m, std::vector<pField>& fields)
+{
+  pMeshEnt e;
+  pMeshIter it = m->begin(pumi_mesh_getDim(m));
+  while ((e = m->iterate(it)))
+  {
+    for (size_t i=0; i<fields.size(); ++i)
+    {
+      int nc = pumi_field_getSize(fields[i]);
+      int nn = pumi_shape_getNumNode(pumi_field_getShape(fields[i]), pumi_ment_getTopo(e));
+      for (int n=0; n<nn; ++n)
+      {
+        double data[3];
+        for (int c=0; c<nc; ++c)
+          data[c] = pumi_ment_isGhost(e) ? -1 : ghostValue(e, n, c);
+        pumi_node_setField(fields[i], e, n, data);
+      }
+    }
+  }
+  m->end(it);
+}
+
+static void checkGhostFields(pMesh m, std::vector<pField>& fields)
+{
+  pMeshEnt e;
+  pMeshIter it = m->begin(pumi_mesh_getDim(m));
+  while ((e = m->iterate(it)))
+  {
+    for (size_t i=0; i<fields.size(); ++i)
+    {
+      int nc = pumi_field_getSize(fields[i]);
+      int nn = pumi_shape_getNumNode(pumi_field_getShape(fields[i]), pumi_ment_getTopo(e));
+      for (int n=0; n<nn; ++n)
+      {
+        double data[3];
+        pumi_node_getField(fields[i], e, n, data);
+        for (int c=0; c<nc; ++c)
+          PCU_ALWAYS_ASSERT(data[c] == ghostValue(e, n, c));
+      }
+    }
+  }
+  m->end(it);
+}
+
+void TEST_GHOST_FIELD(pMesh m)
+{
+  int mesh_dim=pumi_mesh_getDim(m);
+  pumi_ghost_createLayer (m, 0, mesh_dim, 1, 1);
+  std::vector<pField> fields;
+  fields.push_back(pumi_field_create(m, "ghost_constant", 1, PUMI_PACKED,
+      apf::getConstant(mesh_dim)));
+  fields.push_back(pumi_field_create(m, "ghost_ip", 3, PUMI_PACKED,
+      apf::getIPShape(mesh_dim, 2)));
+  setGhostFields(m, fields);
+  pGhostPlan plan = pumi_ghost_createFieldPlan(m, fields);
+  for (int step=0; step<2; ++step)
+  {
+    if (step)
+      setGhostFields(m, fields);
+    pumi_ghost_synchronize(plan);
+    checkGhostFields(m, fields);
+  }
+  pumi_ghostPlan_delete(plan);
+  for (size_t i=0; i<fields.size(); ++i)
+    pumi_field_delete(fields[i]);
+  pumi_ghost_delete(m);
+  if (!pumi_rank()) std::cout<<"\n[test_pumi] pumi_ghost_synchronize updated element field ghosts\n";
+}
@@ -12,13 +12,16 @@
 #include <SimModel.h>
 #endif
 #include <stdlib.h>
+#include <string.h>
 
 int main(int argc, char** argv) {
   MPI_Init(&argc,&argv);
   PCU_Comm_Init();
-  if ( argc != 4 ) {
+  if ( argc != 4 && argc != 5 ) {
     if ( !PCU_Comm_Self() )
-      printf("Usage: %s <model> <mesh> <out prefix>\n", argv[0]);
+      printf("Usage: %s <model> <mesh> <out prefix>"
+          " [hilbert|morton|rcm|blocked]\n",
+          argv[0]);
     MPI_Finalize();
     exit(EXIT_FAILURE);
   }
@@ -32,8 +35,19 @@ int main(int argc, char** argv) {
   gmi_register_null();
   gmi_register_mesh();
   apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
-  apf::MeshTag* order = Parma_BfsReorder(m);
-  apf::reorderMdsMesh(m, order);
+  if (argc == 5 && !strcmp(argv[4], "hilbert")) {
+    apf::reorderMdsMesh(m, apf::HILBERT_ORDER);
+  } else if (argc == 5 && !strcmp(argv[4], "morton")) {
+    apf::reorderMdsMesh(m, apf::MORTON_ORDER);
+  } else if (argc == 5 && !strcmp(argv[4], "rcm")) {
+    apf::reorderMdsMesh(m, apf::RCM_ORDER);
+  } else if (argc == 5 && !strcmp(argv[4], "blocked")) {
+    apf::reorderMdsMesh(m, apf::BLOCKED_ORDER);
+  } else {
+    apf::MeshTag* order = Parma_BfsReorder(m);
+    apf::reorderMdsMesh(m, order);
+  }
+  apf::verify(m);
   m->writeNative(argv[3]);
   m->destroyNative();
   apf::destroyMesh(m);
@@ -0,0 +1,225 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <apfShapeBatch.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cmath>
+#include <vector>
+
+/* evaluates the elements of a mesh in batches and compares
+   the results with those of the one-element API */
+
+namespace {
+
+bool close(double a, double b)
+{
+  return std::fabs(a - b) <= 1e-10 * (1 + std::fabs(b));
+}
+
+/* arbitrary node values, so no shape reproduces them by accident */
+void setNodes(apf::Field* f)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  apf::FieldShape* s = apf::getShape(f);
+  int nc = apf::countComponents(f);
+  std::vector<double> v(nc);
+  int k = 0;
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    if (!s->hasNodesIn(d))
+      continue;
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it)))
+      for (int n = 0; n < s->countNodesOn(m->getType(e)); ++n) {
+        for (int c = 0; c < nc; ++c)
+          v[c] = std::sin(++k);
+        apf::setComponents(f, e, n, &v[0]);
+      }
+    m->end(it);
+  }
+}
+
+void compare(apf::Field* f, apf::ShapeBatch* b,
+    std::vector<apf::MeshEntity*>& elements,
+    std::vector<apf::Vector3>& xi)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  apf::evaluateShapeBatch(b, elements.size(), &elements[0]);
+  int np = xi.size();
+  int nn = apf::countBatchNodes(b);
+  double const* values = apf::getBatchValues(b);
+  double const* jacobians = apf::getBatchJacobians(b);
+  double const* detJ = apf::getBatchDetJ(b);
+  double const* grads = apf::getBatchGrads(b);
+  std::vector<double> fieldValues(elements.size() * np);
+  std::vector<double> fieldGrads(fieldValues.size() * 3);
+  apf::evaluateFieldBatch(b, f, &fieldValues[0], &fieldGrads[0]);
+  for (size_t e = 0; e < elements.size(); ++e) {
+    apf::MeshElement* me = apf::createMeshElement(m, elements[e]);
+    apf::Element* fe = apf::createElement(f, me);
+    PCU_ALWAYS_ASSERT(apf::countNodes(fe) == nn);
+    for (int p = 0; p < np; ++p) {
+      int ep = e * np + p;
+      apf::NewArray<double> v;
+      apf::getShapeValues(fe, xi[p], v);
+      for (int n = 0; n < nn; ++n)
+        PCU_ALWAYS_ASSERT(close(values[p * nn + n], v[n]));
+      apf::Matrix3x3 J;
+      apf::getJacobian(me, xi[p], J);
+      for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+          PCU_ALWAYS_ASSERT(close(jacobians[ep * 9 + i * 3 + j], J[i][j]));
+      PCU_ALWAYS_ASSERT(close(detJ[ep], apf::getDV(me, xi[p])));
+      apf::NewArray<apf::Vector3> g;
+      apf::getShapeGrads(fe, xi[p], g);
+      for (int d = 0; d < 3; ++d)
+        for (int n = 0; n < nn; ++n)
+          PCU_ALWAYS_ASSERT(close(grads[(ep * 3 + d) * nn + n], g[n][d]));
+      PCU_ALWAYS_ASSERT(close(fieldValues[ep], apf::getScalar(fe, xi[p])));
+      apf::Vector3 fg;
+      apf::getGrad(fe, xi[p], fg);
+      for (int d = 0; d < 3; ++d)
+        PCU_ALWAYS_ASSERT(close(fieldGrads[ep * 3 + d], fg[d]));
+    }
+    apf::destroyElement(fe);
+    apf::destroyMeshElement(me);
+  }
+}
+
+void testType(apf::Field* f, int type)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  apf::MeshIterator* it = m->beginType(type);
+  apf::MeshEntity* e = m->iterate(it);
+  m->end(it);
+  if (!e)
+    return;
+  apf::MeshElement* me = apf::createMeshElement(m, e);
+  std::vector<apf::Vector3> xi(apf::countIntPoints(me, 2));
+  for (size_t p = 0; p < xi.size(); ++p)
+    apf::getIntPoint(me, 2, p, xi[p]);
+  apf::destroyMeshElement(me);
+  apf::ShapeBatch* b = apf::createShapeBatch(m, apf::getShape(f), type,
+      xi.size(), &xi[0]);
+  std::vector<apf::MeshEntity*> elements;
+  size_t n = 0;
+  it = m->beginType(type);
+  while ((e = m->iterate(it))) {
+    PCU_ALWAYS_ASSERT(m->getType(e) == type);
+    elements.push_back(e);
+    ++n;
+    if (elements.size() == 64) {
+      compare(f, b, elements, xi);
+      elements.clear();
+    }
+  }
+  m->end(it);
+  PCU_ALWAYS_ASSERT(n == m->countType(type));
+  if (!elements.empty())
+    compare(f, b, elements, xi);
+  apf::destroyShapeBatch(b);
+}
+
+/* the elements are batched one type at a time */
+void test(apf::Mesh* m, int order)
+{
+  apf::Field* f = apf::createField(m, "batch", apf::SCALAR,
+      apf::getLagrange(order));
+  setNodes(f);
+  int dim = m->getDimension();
+  size_t n = 0;
+  for (int type = 0; type < apf::Mesh::TYPES; ++type)
+    if (apf::Mesh::typeDimension[type] == dim) {
+      testType(f, type);
+      n += m->countType(type);
+    }
+  PCU_ALWAYS_ASSERT(n == m->count(dim));
+  apf::destroyField(f);
+}
+
+/* sum factorized interpolation against the one-element API */
+void testTensor(apf::Mesh* m, int order)
+{
+  apf::Field* f = apf::createField(m, "tensor", apf::VECTOR,
+      apf::getLagrange(order));
+  setNodes(f);
+  int type = m->getDimension() == 3 ? apf::Mesh::HEX : apf::Mesh::QUAD;
+  double const x[4] = {-0.86, -0.34, 0.34, 0.86};
+  apf::ShapeBatch* b = apf::createTensorShapeBatch(m, apf::getShape(f),
+      type, 4, x);
+  std::vector<apf::MeshEntity*> elements;
+  apf::MeshIterator* it = m->beginType(type);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it)))
+    elements.push_back(e);
+  m->end(it);
+  int np = m->getDimension() == 3 ? 64 : 16;
+  apf::evaluateShapeBatch(b, elements.size(), &elements[0]);
+  std::vector<double> values(elements.size() * np * 3);
+  std::vector<double> grads(values.size() * 3);
+  apf::evaluateFieldBatch(b, f, &values[0], &grads[0]);
+  double const* jacobians = apf::getBatchJacobians(b);
+  for (size_t i = 0; i < elements.size(); ++i) {
+    apf::MeshElement* me = apf::createMeshElement(m, elements[i]);
+    apf::Element* fe = apf::createElement(f, me);
+    for (int p = 0; p < np; ++p) {
+      int ep = i * np + p;
+      apf::Vector3 xi(x[p % 4], x[p / 4 % 4], 0);
+      if (np == 64)
+        xi[2] = x[p / 16];
+      apf::Matrix3x3 J;
+      apf::getJacobian(me, xi, J);
+      for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 3; ++c)
+          PCU_ALWAYS_ASSERT(close(jacobians[ep * 9 + r * 3 + c], J[r][c]));
+      double v[3];
+      apf::getComponents(fe, xi, v);
+      apf::Matrix3x3 g;
+      apf::getVectorGrad(fe, xi, g);
+      for (int c = 0; c < 3; ++c) {
+        PCU_ALWAYS_ASSERT(close(values[ep * 3 + c], v[c]));
+        for (int d = 0; d < 3; ++d)
+          PCU_ALWAYS_ASSERT(close(grads[(ep * 3 + c) * 3 + d], g[d][c]));
+      }
+    }
+    apf::destroyElement(fe);
+    apf::destroyMeshElement(me);
+  }
+  apf::destroyShapeBatch(b);
+  apf::destroyField(f);
+}
+
+void testTensors()
+{
+  apf::Mesh2* quads = apf::makeMdsBox(3, 2, 0, 1, 0.5, 0, false);
+  testTensor(quads, 1);
+  testTensor(quads, 2);
+  quads->destroyNative();
+  apf::destroyMesh(quads);
+  apf::Mesh2* hexes = apf::makeMdsBox(2, 3, 2, 1, 1.5, 0.7, false);
+  testTensor(hexes, 1);
+  hexes->destroyNative();
+  apf::destroyMesh(hexes);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  test(m, 1);
+  test(m, 2);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  testTensors();
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,118 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+/* compares the per-peer lists of shared entities
+   with the remote copies of every entity and checks that
+   both sides of each list agree on its order,
+   before and after migration repacks them */
+
+namespace {
+
+typedef std::map<int, std::vector<apf::MeshEntity*> > PeerEntities;
+
+void check(apf::Mesh2* m)
+{
+  PCU_ALWAYS_ASSERT(m->hasSharedLists());
+  for (int d = 0; d < m->getDimension(); ++d) {
+    PeerEntities expected;
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      apf::Copies remotes;
+      m->getRemotes(e, remotes);
+      APF_ITERATE(apf::Copies, remotes, rit)
+        expected[rit->first].push_back(e);
+    }
+    m->end(it);
+    apf::Parts peers;
+    m->getSharedPeers(d, peers);
+    PCU_ALWAYS_ASSERT(peers.size() == expected.size());
+    PCU_Comm_Begin();
+    APF_ITERATE(apf::Parts, peers, pit) {
+      apf::DynamicArray<apf::MeshEntity*> found;
+      m->getSharedWith(d, *pit, found);
+      std::vector<apf::MeshEntity*> sorted(found.begin(), found.end());
+      std::sort(sorted.begin(), sorted.end());
+      std::vector<apf::MeshEntity*>& ex = expected[*pit];
+      std::sort(ex.begin(), ex.end());
+      PCU_ALWAYS_ASSERT(sorted == ex);
+      for (size_t i = 0; i < found.getSize(); ++i) {
+        apf::Copies remotes;
+        m->getRemotes(found[i], remotes);
+        PCU_COMM_PACK(*pit, remotes[*pit]);
+      }
+    }
+    PCU_Comm_Send();
+    while (PCU_Comm_Receive()) {
+      apf::DynamicArray<apf::MeshEntity*> found;
+      m->getSharedWith(d, PCU_Comm_Sender(), found);
+      for (size_t i = 0; i < found.getSize(); ++i) {
+        apf::MeshEntity* r;
+        PCU_COMM_UNPACK(r);
+        PCU_ALWAYS_ASSERT(r == found[i]);
+      }
+    }
+  }
+}
+
+/* a field accumulated over the copies counts them */
+void checkAccumulate(apf::Mesh2* m)
+{
+  apf::Field* f = apf::createFieldOn(m, "copy_count", apf::SCALAR);
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(0);
+  while ((e = m->iterate(it)))
+    apf::setScalar(f, e, 0, 1);
+  m->end(it);
+  apf::accumulate(f);
+  it = m->begin(0);
+  while ((e = m->iterate(it))) {
+    apf::Copies remotes;
+    m->getRemotes(e, remotes);
+    PCU_ALWAYS_ASSERT(apf::getScalar(f, e, 0) == remotes.size() + 1);
+  }
+  m->end(it);
+  apf::destroyField(f);
+}
+
+void migrateSome(apf::Mesh2* m)
+{
+  apf::Migration* plan = new apf::Migration(m);
+  int peer = (PCU_Comm_Self() + 1) % PCU_Comm_Peers();
+  int i = 0;
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  while ((e = m->iterate(it)))
+    if (i++ % 7 == 0)
+      plan->send(e, peer);
+  m->end(it);
+  m->migrate(plan);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  check(m);
+  checkAccumulate(m);
+  migrateSome(m);
+  check(m);
+  checkAccumulate(m);
+  apf::verify(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,104 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfNumbering.h>
+#include <apfShape.h>
+#include <gmi_null.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+
+/* checks apf::Mesh::getCachedSharing against apf::NormalSharing,
+   before and after the mesh changes, times ownership queries, and
+   checks that synchronizing with the cached sharing leaves it alone */
+
+namespace {
+
+void compare(apf::Mesh* m, apf::Sharing* a, apf::Sharing* b)
+{
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      PCU_ALWAYS_ASSERT(a->isOwned(e) == b->isOwned(e));
+      PCU_ALWAYS_ASSERT(a->isShared(e) == b->isShared(e));
+      PCU_ALWAYS_ASSERT(a->getOwner(e) == b->getOwner(e));
+      apf::CopyArray ca, cb;
+      a->getCopies(e, ca);
+      b->getCopies(e, cb);
+      PCU_ALWAYS_ASSERT(ca.getSize() == cb.getSize());
+    }
+    m->end(it);
+  }
+}
+
+double timeOwned(apf::Mesh* m, apf::Sharing* s, long& owned)
+{
+  double t0 = PCU_Time();
+  owned = 0;
+  for (int i = 0; i < 10; ++i)
+    for (int d = 0; d <= m->getDimension(); ++d)
+      owned += apf::countOwned(m, d, s);
+  return PCU_Max_Double(PCU_Time() - t0);
+}
+
+/* a matched mesh skips the shared lists, so synchronize falls back
+   on the cached sharing, which it must not delete */
+void testSynchronize()
+{
+  gmi_register_null();
+  apf::Mesh2* m = apf::makeEmptyMdsMesh(gmi_load(".null"), 3, true);
+  apf::Vector3 points[4] = {
+    apf::Vector3(0, 0, 0),
+    apf::Vector3(1, 0, 0),
+    apf::Vector3(0, 1, 0),
+    apf::Vector3(0, 0, 1)};
+  apf::buildOneElement(m, 0, apf::Mesh::TET, points);
+  apf::deriveMdsModel(m);
+  m->acceptChanges();
+  apf::Sharing* cached = m->getCachedSharing();
+  apf::Numbering* n = apf::numberOwnedNodes(m, "n", apf::getLagrange(1));
+  apf::synchronize(n, 0, true);
+  PCU_ALWAYS_ASSERT(cached == m->getCachedSharing());
+  apf::NormalSharing normal(m);
+  compare(m, cached, &normal);
+  apf::destroyNumbering(n);
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  apf::Mesh2* m = apf::makeDistributedMdsBox(12, 12, 12, 1, 1, 1, true);
+  apf::NormalSharing normal(m);
+  apf::Sharing* cached = m->getCachedSharing();
+  PCU_ALWAYS_ASSERT(cached == m->getCachedSharing());
+  compare(m, cached, &normal);
+  long a, b;
+  double ta = timeOwned(m, &normal, a);
+  double tb = timeOwned(m, cached, b);
+  PCU_ALWAYS_ASSERT(a == b);
+  if (!PCU_Comm_Self())
+    printf("ownership queries: normal %f s, cached %f s\n", ta, tb);
+  /* a change leaves the tables behind, the answers stay right */
+  apf::Vector3 x(2, 2, 2);
+  apf::Vector3 p(0, 0, 0);
+  apf::MeshEntity* v = m->createVertex(0, x, p);
+  PCU_ALWAYS_ASSERT(cached->isOwned(v));
+  PCU_ALWAYS_ASSERT(!cached->isShared(v));
+  compare(m, cached, &normal);
+  m->destroy(v);
+  m->acceptChanges();
+  cached = m->getCachedSharing();
+  compare(m, cached, &normal);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  testSynchronize();
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,36 @@
+#include <apf.h>
+#include <gmi_mesh.h>
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <PCU.h>
+#include <apfADIOS2.h>
+#include <cstdlib>
+
+#include <iostream>
+
+int main(int argc, char** argv) {
+  MPI_Init(&argc, &argv);
+  PCU_Comm_Init();
+  if (argc != 4 && argc != 5) {
+    if (PCU_Comm_Self() == 0) {
+      std::cout << "\n";
+      std::cout << "usage: smb2adios in.dmg in.smb out.bp [adios2.xml]\n";
+      std::cout << "   or: smb2adios                               (usage)\n";
+    }
+    PCU_Comm_Free();
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  gmi_register_mesh();
+  gmi_register_null();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1], argv[2]);
+  apf::ADIOS2Output* o =
+    apf::openADIOS2Output(argv[3], argc == 5 ? argv[4] : 0);
+  apf::writeADIOS2Step(o, m);
+  apf::closeADIOS2Output(o);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
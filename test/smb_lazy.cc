@@ -0,0 +1,96 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* writes tags and a field to smb files, then checks that
+   loading them lazily gives the same values as loading them
+   eagerly, including after some tags are never used */
+
+namespace {
+
+double value(apf::Mesh* m, apf::MeshEntity* e)
+{
+  apf::Vector3 x = apf::getLinearCentroid(m, e);
+  return x[0] + 10 * x[1] + 100 * x[2];
+}
+
+void setValues(apf::Mesh* m)
+{
+  apf::MeshTag* d = m->createDoubleTag("lazy_double", 1);
+  apf::MeshTag* i = m->createIntTag("lazy_int", 1);
+  m->createIntTag("lazy_unused", 1);
+  apf::Field* f = apf::createFieldOn(m, "lazy_field", apf::SCALAR);
+  for (int dim = 0; dim <= m->getDimension(); ++dim) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(dim);
+    while ((e = m->iterate(it))) {
+      double v = value(m, e);
+      m->setDoubleTag(e, d, &v);
+      int n = dim;
+      m->setIntTag(e, i, &n);
+      if (!dim)
+        apf::setScalar(f, e, 0, v);
+    }
+    m->end(it);
+  }
+}
+
+void checkValues(apf::Mesh* m)
+{
+  apf::MeshTag* d = m->findTag("lazy_double");
+  apf::MeshTag* i = m->findTag("lazy_int");
+  apf::Field* f = m->findField("lazy_field");
+  PCU_ALWAYS_ASSERT(d && i && f);
+  for (int dim = 0; dim <= m->getDimension(); ++dim) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(dim);
+    while ((e = m->iterate(it))) {
+      double v;
+      m->getDoubleTag(e, d, &v);
+      PCU_ALWAYS_ASSERT(v == value(m, e));
+      int n;
+      m->getIntTag(e, i, &n);
+      PCU_ALWAYS_ASSERT(n == dim);
+      if (!dim)
+        PCU_ALWAYS_ASSERT(apf::getScalar(f, e, 0) == value(m, e));
+    }
+    m->end(it);
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  setValues(m);
+  m->writeNative("lazy_tags/");
+  m->destroyNative();
+  apf::destroyMesh(m);
+  m = apf::loadMdsMesh(gmi_load(argv[1]), "lazy_tags/", true);
+  /* a checksum is the first use of the tag */
+  apf::MeshTag* i = m->findTag("lazy_int");
+  unsigned sum = m->getTagChecksum(i, apf::Mesh::VERTEX);
+  checkValues(m);
+  PCU_ALWAYS_ASSERT(sum == m->getTagChecksum(i, apf::Mesh::VERTEX));
+  m->destroyTag(m->findTag("lazy_unused"));
+  /* writing over the files it came from */
+  m->writeNative("lazy_tags/");
+  m->destroyNative();
+  apf::destroyMesh(m);
+  m = apf::loadMdsMesh(gmi_load(argv[1]), "lazy_tags/", true);
+  PCU_ALWAYS_ASSERT(!m->findTag("lazy_unused"));
+  checkValues(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,116 @@
+#include <apf.h>
+#include <apfBox.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_null.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <string>
+
+/* writes a distributed box with a field and a tag to smb files under
+   the path prefix given on the command line ("agg:" or "gz:" for
+   example), loads them back and checks that entities, classification,
+   remotes, the field and the tag come across in order */
+
+namespace {
+
+void decorate(apf::Mesh2* m)
+{
+  apf::Field* f = apf::createFieldOn(m, "u", apf::VECTOR);
+  apf::MeshTag* t = m->createIntTag("t", 2);
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    int i = 0;
+    while ((e = m->iterate(it))) {
+      if (d == 0) {
+        apf::Vector3 x;
+        m->getPoint(e, 0, x);
+        apf::setVector(f, e, 0, x * 2);
+      }
+      if (i % 3 == 0) {
+        int v[2] = {d, i};
+        m->setIntTag(e, t, v);
+      }
+      ++i;
+    }
+    m->end(it);
+  }
+}
+
+void compare(apf::Mesh* a, apf::Mesh* b)
+{
+  apf::Field* fa = a->findField("u");
+  apf::Field* fb = b->findField("u");
+  apf::MeshTag* ta = a->findTag("t");
+  apf::MeshTag* tb = b->findTag("t");
+  PCU_ALWAYS_ASSERT(fb && tb);
+  for (int d = 0; d <= a->getDimension(); ++d) {
+    PCU_ALWAYS_ASSERT(a->count(d) == b->count(d));
+    apf::MeshIterator* ia = a->begin(d);
+    apf::MeshIterator* ib = b->begin(d);
+    apf::MeshEntity* ea;
+    while ((ea = a->iterate(ia))) {
+      apf::MeshEntity* eb = b->iterate(ib);
+      PCU_ALWAYS_ASSERT(a->getType(ea) == b->getType(eb));
+      apf::ModelEntity* ga = a->toModel(ea);
+      apf::ModelEntity* gb = b->toModel(eb);
+      PCU_ALWAYS_ASSERT(a->getModelType(ga) == b->getModelType(gb));
+      PCU_ALWAYS_ASSERT(a->getModelTag(ga) == b->getModelTag(gb));
+      apf::Vector3 xa = apf::getLinearCentroid(a, ea);
+      apf::Vector3 xb = apf::getLinearCentroid(b, eb);
+      PCU_ALWAYS_ASSERT((xa - xb).getLength() == 0);
+      apf::Copies ra, rb;
+      a->getRemotes(ea, ra);
+      b->getRemotes(eb, rb);
+      PCU_ALWAYS_ASSERT(ra.size() == rb.size());
+      for (apf::Copies::iterator it = ra.begin(); it != ra.end(); ++it)
+        PCU_ALWAYS_ASSERT(rb.count(it->first));
+      if (d == 0) {
+        apf::Vector3 va, vb;
+        apf::getVector(fa, ea, 0, va);
+        apf::getVector(fb, eb, 0, vb);
+        PCU_ALWAYS_ASSERT((va - vb).getLength() == 0);
+      }
+      PCU_ALWAYS_ASSERT(a->hasTag(ea, ta) == b->hasTag(eb, tb));
+      if (a->hasTag(ea, ta)) {
+        int la[2], lb[2];
+        a->getIntTag(ea, ta, la);
+        b->getIntTag(eb, tb, lb);
+        PCU_ALWAYS_ASSERT(la[0] == lb[0] && la[1] == lb[1]);
+      }
+    }
+    PCU_ALWAYS_ASSERT(!b->iterate(ib));
+    a->end(ia);
+    b->end(ib);
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 2);
+  gmi_register_null();
+  /* groups of two parts share each aggregated file */
+  apf::setSmbPartsPerFile(2);
+  std::string path = std::string(argv[1]) + "roundtrip_box/";
+  apf::Mesh2* m = apf::makeDistributedMdsBox(6, 6, 6, 1, 1, 1, true);
+  decorate(m);
+  m->writeNative(path.c_str());
+  apf::Mesh2* b = apf::loadMdsMesh(m->getModel(), path.c_str());
+  apf::disownMdsModel(b);
+  b->verify();
+  compare(m, b);
+  if (!PCU_Comm_Self())
+    printf("%s smb files read back\n", argv[1]);
+  b->destroyNative();
+  apf::destroyMesh(b);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
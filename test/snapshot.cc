@@ -0,0 +1,151 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <apfSnapshot.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cmath>
+#include <cstdio>
+
+/* runs element and node kernels on the flat arrays of an
+   apf::Snapshot and checks them against the mesh */
+
+namespace {
+
+double linear(double const* x)
+{
+  return 1 + x[0] + 2 * x[1] + 3 * x[2];
+}
+
+double tetVolume(double const* x0, double const* x1,
+    double const* x2, double const* x3)
+{
+  double a[3], b[3], c[3];
+  for (int i = 0; i < 3; ++i) {
+    a[i] = x1[i] - x0[i];
+    b[i] = x2[i] - x0[i];
+    c[i] = x3[i] - x0[i];
+  }
+  return (a[0] * (b[1] * c[2] - b[2] * c[1]) -
+          a[1] * (b[0] * c[2] - b[2] * c[0]) +
+          a[2] * (b[0] * c[1] - b[1] * c[0])) / 6;
+}
+
+void checkArrays(apf::Mesh* m, apf::Snapshot* s)
+{
+  std::vector<apf::MeshEntity*> const& verts =
+    m->getConnectivity(0).elements;
+  std::vector<apf::MeshEntity*> const& elems =
+    m->getConnectivity(3).elements;
+  PCU_ALWAYS_ASSERT(s->coordinates.size() == verts.size() * 3);
+  PCU_ALWAYS_ASSERT(s->offsets.size() == elems.size() + 1);
+  for (size_t i = 0; i < elems.size(); ++i) {
+    PCU_ALWAYS_ASSERT(s->types[i] == apf::Mesh::TET);
+    apf::Downward ev;
+    int nv = m->getDownward(elems[i], 0, ev);
+    PCU_ALWAYS_ASSERT(s->offsets[i + 1] - s->offsets[i] == nv);
+    for (int j = 0; j < nv; ++j)
+      PCU_ALWAYS_ASSERT(verts[s->vertices[s->offsets[i] + j]] == ev[j]);
+    apf::ModelEntity* g = m->toModel(elems[i]);
+    PCU_ALWAYS_ASSERT(s->elementModels[i * 2] == m->getModelType(g));
+    PCU_ALWAYS_ASSERT(s->elementModels[i * 2 + 1] == m->getModelTag(g));
+  }
+  for (size_t i = 0; i < verts.size(); ++i) {
+    apf::ModelEntity* g = m->toModel(verts[i]);
+    PCU_ALWAYS_ASSERT(s->vertexModels[i * 2] == m->getModelType(g));
+    PCU_ALWAYS_ASSERT(s->vertexModels[i * 2 + 1] == m->getModelTag(g));
+  }
+}
+
+/* the volume of the part from the arrays alone */
+void checkVolume(apf::Mesh* m, apf::Snapshot* s)
+{
+  double const* x = &s->coordinates[0];
+  double volume = 0;
+  for (size_t i = 0; i + 1 < s->offsets.size(); ++i) {
+    int const* v = &s->vertices[s->offsets[i]];
+    volume += tetVolume(x + v[0] * 3, x + v[1] * 3,
+                        x + v[2] * 3, x + v[3] * 3);
+  }
+  double expected = 0;
+  apf::MeshIterator* it = m->begin(3);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it)))
+    expected += apf::measure(m, e);
+  m->end(it);
+  PCU_ALWAYS_ASSERT(std::fabs(volume - expected) < 1e-12);
+}
+
+/* reads a quadratic field, evaluates a linear function at
+   its nodes from the arrays and writes it back */
+void checkField(apf::Mesh* m, apf::Snapshot* s)
+{
+  apf::SnapshotField& sf = s->fields[0];
+  PCU_ALWAYS_ASSERT(sf.components == 1);
+  PCU_ALWAYS_ASSERT(sf.nodes[0] == 1 && sf.nodes[1] == 1);
+  PCU_ALWAYS_ASSERT(sf.nodes[2] == 0 && sf.nodes[3] == 0);
+  std::vector<apf::MeshEntity*> const& edges =
+    m->getConnectivity(1).elements;
+  PCU_ALWAYS_ASSERT(sf.values.size() == sf.start[1] + edges.size());
+  for (size_t i = 0; i < sf.values.size(); ++i)
+    PCU_ALWAYS_ASSERT(sf.values[i] == 7);
+  std::vector<double> values(sf.values.size());
+  size_t nverts = s->coordinates.size() / 3;
+  for (size_t i = 0; i < nverts; ++i)
+    values[i] = linear(&s->coordinates[i * 3]);
+  /* the snapshot has vertex coordinates only,
+     so the edge midpoints come from the mesh */
+  for (size_t i = 0; i < edges.size(); ++i) {
+    apf::Vector3 x = apf::getLinearCentroid(m, edges[i]);
+    double a[3];
+    x.toArray(a);
+    values[sf.start[1] + i] = linear(a);
+  }
+  apf::writeSnapshotField(s, 0, &values[0]);
+  for (int d = 0; d <= 1; ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      double a[3];
+      apf::getLinearCentroid(m, e).toArray(a);
+      double value = apf::getScalar(sf.field, e, 0);
+      PCU_ALWAYS_ASSERT(std::fabs(value - linear(a)) < 1e-12);
+    }
+    m->end(it);
+  }
+  apf::readSnapshotField(s, 0);
+  for (size_t i = 0; i < values.size(); ++i)
+    PCU_ALWAYS_ASSERT(sf.values[i] == values[i]);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  apf::Mesh2* m = apf::makeDistributedMdsBox(4, 4, 4, 1, 1, 1, true);
+  apf::Field* f = apf::createField(m, "u", apf::SCALAR,
+      apf::getLagrange(2));
+  for (int d = 0; d <= 1; ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it)))
+      apf::setScalar(f, e, 0, 7);
+    m->end(it);
+  }
+  apf::Snapshot* s = apf::makeSnapshot(m, &f, 1);
+  checkArrays(m, s);
+  checkVolume(m, s);
+  checkField(m, s);
+  apf::destroySnapshot(s);
+  if (!PCU_Comm_Self())
+    printf("snapshot checks passed\n");
+  apf::destroyField(f);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
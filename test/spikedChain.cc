@@ -0,0 +1,73 @@
+#include "spikedChain.h"
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfConvert.h>
+#include <gmi_null.h>
+#include <PCU.h>
+#include <vector>
+
+namespace {
+
+int const n = 4;
+int const slabs = 16;
+
+int getSlabPart(int i) {
+  int peers = PCU_Comm_Peers();
+  int spike = slabs - (peers - 1);
+  if (i < spike)
+    return 0;
+  return i - spike + 1;
+}
+
+}
+
+apf::Mesh2* makeSpikedChain()
+{
+  static int const cubeTets[6][4] = {
+    {0,1,3,7},{0,1,7,5},{0,5,7,4},{0,3,2,7},{0,2,6,7},{0,6,4,7}};
+  int self = PCU_Comm_Self();
+  int peers = PCU_Comm_Peers();
+  int nx = slabs + 1;
+  int ny = n + 1;
+  std::vector<int> conn;
+  for (int k = 0; k < n; ++k)
+  for (int j = 0; j < n; ++j)
+  for (int i = 0; i < slabs; ++i) {
+    if (getSlabPart(i) != self)
+      continue;
+    int c[8];
+    for (int b = 0; b < 8; ++b)
+      c[b] = (i + (b & 1)) + (j + ((b >> 1) & 1)) * nx
+           + (k + ((b >> 2) & 1)) * nx * ny;
+    for (int t = 0; t < 6; ++t)
+      for (int q = 0; q < 4; ++q)
+        conn.push_back(c[cubeTets[t][q]]);
+  }
+  int verts = nx * ny * ny;
+  std::vector<double> x;
+  for (int v = self * verts / peers; v < (self + 1) * verts / peers; ++v) {
+    x.push_back(v % nx);
+    x.push_back((v / nx) % ny);
+    x.push_back(v / (nx * ny));
+  }
+  apf::Mesh2* m = apf::makeEmptyMdsMesh(gmi_load(".null"), 3, false);
+  apf::GlobalToVert g;
+  apf::construct(m, &conn[0], conn.size() / 4, apf::Mesh::TET, g);
+  apf::alignMdsRemotes(m);
+  apf::deriveMdsModel(m);
+  apf::setCoords(m, &x[0], x.size() / 3, g);
+  m->acceptChanges();
+  m->verify();
+  return m;
+}
+
+apf::MeshTag* setWeights(apf::Mesh* m) {
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  apf::MeshEntity* e;
+  apf::MeshTag* tag = m->createDoubleTag("parma_weight", 1);
+  double w = 1.0;
+  while ((e = m->iterate(it)))
+    m->setDoubleTag(e, tag, &w);
+  m->end(it);
+  return tag;
+}
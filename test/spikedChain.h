@@ -0,0 +1,14 @@
+#ifndef SPIKEDCHAIN_H
+#define SPIKEDCHAIN_H
+
+#include <apfMesh2.h>
+
+/* the fixture of the parma balancing tests: a chain of 16 slabs
+   of 4x4x4 cubes split into tets, with one slab on each part past
+   part 0 and the rest on part 0 */
+apf::Mesh2* makeSpikedChain();
+
+/* a unit "parma_weight" tag on the elements */
+apf::MeshTag* setWeights(apf::Mesh* m);
+
+#endif
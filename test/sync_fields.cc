@@ -0,0 +1,113 @@
+#include <apf.h>
+#include <apfShape.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* checks that synchronizing and accumulating a list of fields
+   together gives the same values as doing it one field at a time */
+
+namespace {
+
+enum { FIELDS = 4 };
+
+void create(apf::Mesh* m, char prefix, apf::Field** f)
+{
+  int dim = m->getDimension();
+  char name[3] = {prefix, '0', 0};
+  int types[FIELDS] = {apf::SCALAR, apf::VECTOR, apf::MATRIX, apf::SCALAR};
+  apf::FieldShape* shapes[FIELDS] = {apf::getLagrange(2),
+    apf::getLagrange(1), apf::getLagrange(1), apf::getConstant(dim)};
+  for (int i = 0; i < FIELDS; ++i, ++name[1])
+    f[i] = apf::createField(m, name, types[i], shapes[i]);
+}
+
+void fill(apf::Field* f, bool ownedOnly)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  apf::FieldShape* s = apf::getShape(f);
+  int nc = apf::countComponents(f);
+  apf::NewArray<double> c(nc);
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    if (!s->hasNodesIn(d))
+      continue;
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      int n = s->countNodesOn(m->getType(e));
+      for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < nc; ++j) {
+          c[j] = 1 + j;
+          if (ownedOnly)
+            c[j] = m->isOwned(e) ? (PCU_Comm_Self() + i + j) : -1;
+        }
+        apf::setComponents(f, e, i, &c[0]);
+      }
+    }
+    m->end(it);
+  }
+}
+
+void compare(apf::Field* a, apf::Field* b)
+{
+  apf::Mesh* m = apf::getMesh(a);
+  apf::FieldShape* s = apf::getShape(a);
+  int nc = apf::countComponents(a);
+  apf::NewArray<double> ca(nc);
+  apf::NewArray<double> cb(nc);
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    if (!s->hasNodesIn(d))
+      continue;
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      int n = s->countNodesOn(m->getType(e));
+      for (int i = 0; i < n; ++i) {
+        apf::getComponents(a, e, i, &ca[0]);
+        apf::getComponents(b, e, i, &cb[0]);
+        for (int j = 0; j < nc; ++j)
+          PCU_ALWAYS_ASSERT(ca[j] == cb[j]);
+      }
+    }
+    m->end(it);
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  apf::Field* a[FIELDS];
+  apf::Field* b[FIELDS];
+  create(m, 'a', a);
+  create(m, 'b', b);
+  for (int i = 0; i < FIELDS; ++i) {
+    fill(a[i], true);
+    fill(b[i], true);
+    apf::synchronize(b[i]);
+  }
+  apf::synchronize(a, FIELDS);
+  for (int i = 0; i < FIELDS; ++i) {
+    compare(a[i], b[i]);
+    fill(a[i], false);
+    fill(b[i], false);
+    apf::accumulate(b[i]);
+  }
+  apf::accumulate(a, FIELDS);
+  for (int i = 0; i < FIELDS; ++i) {
+    compare(a[i], b[i]);
+    apf::destroyField(a[i]);
+    apf::destroyField(b[i]);
+  }
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
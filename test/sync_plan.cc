@@ -0,0 +1,87 @@
+#include <apf.h>
+#include <apfShape.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* checks that synchronize and accumulate through an apf::SyncPlan
+   give the same values as the plain versions */
+
+namespace {
+
+void fill(apf::Field* f, bool ownedOnly, int round)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  apf::FieldShape* s = apf::getShape(f);
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    if (!s->hasNodesIn(d))
+      continue;
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      int n = s->countNodesOn(m->getType(e));
+      for (int i = 0; i < n; ++i) {
+        double value = 1;
+        if (ownedOnly)
+          value = m->isOwned(e) ? (PCU_Comm_Self() + i + round) : -1;
+        apf::setScalar(f, e, i, value);
+      }
+    }
+    m->end(it);
+  }
+}
+
+void compare(apf::Field* a, apf::Field* b)
+{
+  apf::Mesh* m = apf::getMesh(a);
+  apf::FieldShape* s = apf::getShape(a);
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    if (!s->hasNodesIn(d))
+      continue;
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      int n = s->countNodesOn(m->getType(e));
+      for (int i = 0; i < n; ++i)
+        PCU_ALWAYS_ASSERT(apf::getScalar(a, e, i) == apf::getScalar(b, e, i));
+    }
+    m->end(it);
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  apf::Field* a = apf::createField(m, "a", apf::SCALAR, apf::getLagrange(2));
+  apf::Field* b = apf::createField(m, "b", apf::SCALAR, apf::getLagrange(2));
+  /* the plan covers the entities that have values */
+  fill(a, false, 0);
+  apf::SyncPlan* plan = apf::makeSyncPlan(a);
+  for (int round = 0; round < 3; ++round) {
+    fill(a, true, round);
+    fill(b, true, round);
+    apf::synchronize(plan);
+    apf::synchronize(b);
+    compare(a, b);
+    fill(a, false, round);
+    fill(b, false, round);
+    apf::accumulate(plan);
+    apf::accumulate(b);
+    compare(a, b);
+  }
+  apf::destroySyncPlan(plan);
+  apf::destroyField(a);
+  apf::destroyField(b);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,85 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <parma.h>
+#include <PCU.h>
+#include <pcu_util.h>
+
+/* checks that tag spans see the same values as
+   per-entity tag access, in iteration order,
+   and the point span the same coordinates */
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 3);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
+  int dim = m->getDimension();
+  apf::MeshTag* w = m->createDoubleTag("span_weight", 1);
+  apf::MeshTag* id = m->createIntTag("span_id", 2);
+  size_t spanned = 0;
+  for (int t = 0; t < apf::Mesh::TYPES; ++t) {
+    if (apf::Mesh::typeDimension[t] != dim)
+      continue;
+    int n = m->countTagSpan(t);
+    spanned += n;
+    if (!n)
+      continue;
+    double* x = m->setDoubleTagSpan(w, t, 0, n);
+    for (int i = 0; i < n; ++i)
+      x[i] = i % 3 + 1;
+    int* y = m->setIntTagSpan(id, t, 1, n - 1);
+    for (int i = 0; i < n - 1; ++i) {
+      y[2 * i] = t;
+      y[2 * i + 1] = i + 1;
+    }
+  }
+  PCU_ALWAYS_ASSERT(spanned == m->count(dim));
+  double sum = 0;
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(dim);
+  int i = 0;
+  while ((e = m->iterate(it))) {
+    double x;
+    m->getDoubleTag(e, w, &x);
+    PCU_ALWAYS_ASSERT(x == i % 3 + 1);
+    sum += x;
+    PCU_ALWAYS_ASSERT(m->hasTag(e, id) == (i != 0));
+    if (i) {
+      int y[2];
+      m->getIntTag(e, id, y);
+      PCU_ALWAYS_ASSERT(y[0] == m->getType(e));
+      PCU_ALWAYS_ASSERT(y[1] == i);
+    }
+    ++i;
+  }
+  m->end(it);
+  double avg = Parma_GetWeightedEntImbalance(m, w, dim);
+  PCU_ALWAYS_ASSERT(avg >= 1);
+  apf::removeTagFromDimension(m, w, dim);
+  apf::removeTagFromDimension(m, id, dim);
+  m->destroyTag(w);
+  m->destroyTag(id);
+  int nv = m->countTagSpan(apf::Mesh::VERTEX);
+  PCU_ALWAYS_ASSERT(nv == (int)m->count(0));
+  double* points = m->getPointSpan(0, nv);
+  it = m->begin(0);
+  i = 0;
+  while ((e = m->iterate(it))) {
+    apf::Vector3 p;
+    m->getPoint(e, 0, p);
+    PCU_ALWAYS_ASSERT((p - apf::Vector3(points + 3 * i)).getLength() == 0);
+    points[3 * i] += 1;
+    m->getPoint(e, 0, p);
+    PCU_ALWAYS_ASSERT(p[0] == points[3 * i]);
+    ++i;
+  }
+  m->end(it);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
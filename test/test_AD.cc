@@ -10,6 +10,13 @@ void compare(AD const& x, double val, double da, double db)
   PCU_ALWAYS_ASSERT(fabs(x.dx(1) - db) < 1e-15);
 }
 
+/* all three directions of one pass against hand derivatives */
+void compare(AD const& x, double val, double da, double db, double dc)
+{
+  compare(x, val, da, db);
+  PCU_ALWAYS_ASSERT(fabs(x.dx(2) - dc) < 1e-15);
+}
+
 AD f1(AD const& a, AD const& b)
 {
   return a + b;
@@ -25,4 +32,21 @@ int main()
 
   AD f = f1(a,b);
   compare(f, 3.000000000000000, 1.000000000000000, 1.000000000000000);
+
+  AD c = 4.0;
+  c.diff(2);
+  compare(a * b * c, 8, 8, 4, 2);
+  compare(a * b / c, 0.5, 0.5, 0.25, -0.125);
+  compare(2. / c, 0.5, 0, 0, -0.125);
+  compare(mth::sqrt(c) * b, 4, 0, 2, 0.5);
+  compare(mth::exp(a - 1.) * b, 2, 2, 1, 0);
+  compare(mth::pow(c, 2) + mth::log(b), 16 + log(2.), 0, 0.5, 8);
+
+  AD g = a * b;
+  g *= c;
+  compare(g, 8, 8, 4, 2);
+  g /= c;
+  compare(g, 2, 2, 1, 0);
+  g /= b;
+  compare(g, 1, 1, 0, 0);
 }
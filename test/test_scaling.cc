@@ -1,5 +1,6 @@
 #include <pcu_util.h>
 #include <iostream>
+#include <cmath>
 
 #include <gmi_mesh.h>
 #include <apfMDS.h>
@@ -22,6 +23,27 @@ int main(int argc, char** argv)
   std::cout << "scaling factor " << scaling_factor << '\n';
   PCU_ALWAYS_ASSERT(scaling_factor < 2.0);
   PCU_ALWAYS_ASSERT(0.5 < scaling_factor);
+  double target = 2 * PCU_Add_Double(m->count(m->getDimension()));
+  double unclamped = sam::getIsoLengthScalar(identity_size, target);
+  sam::ElementCountEstimate e = sam::estimateElementCount(identity_size,
+      unclamped);
+  PCU_ALWAYS_ASSERT(fabs(e.global - target) < 1e-8 * target);
+  PCU_ALWAYS_ASSERT(e.maxPart <= e.global);
+  /* a lower clamp that binds on the finer half of the
+     sizes needs the bisection */
+  double hmin = 0;
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it)))
+    hmin += apf::getScalar(identity_size, v, 0);
+  m->end(it);
+  hmin = unclamped * PCU_Add_Double(hmin) /
+    PCU_Add_Double(m->count(0));
+  double clamped = sam::getIsoLengthScalar(identity_size, target,
+      hmin, 0, 1e-6);
+  e = sam::estimateElementCount(identity_size, clamped, hmin, 0);
+  PCU_ALWAYS_ASSERT(fabs(e.global - target) <= 1e-6 * target);
+  PCU_ALWAYS_ASSERT(clamped < unclamped);
   m->destroyNative();
   apf::destroyMesh(m);
   PCU_Comm_Free();
@@ -33,7 +33,40 @@ mpi_test(integrate 1 ./integrate)
 mpi_test(qr_test 1 ./qr)
 mpi_test(base64 1 ./base64)
 mpi_test(tensor_test 1 ./tensor)
+mpi_test(gmi_eval_batch 1 ./gmi_eval_batch)
+mpi_test(gmi_cache 1 ./gmi_cache)
+mpi_test(gmi_load_bcast 4 ./gmi_load_bcast)
+mpi_test(box_distributed_tet 4 ./box 6 5 4 1 1 1 1 dbox.dmg dbox.smb)
+mpi_test(box_distributed_hex 6 ./box 6 5 4 1 1 1 0 dbox.dmg dbox.smb)
+mpi_test(box_distributed_tri 4 ./box 7 5 0 1 1 0 1 dbox.dmg dbox.smb)
+mpi_test(ma_report 1 ./ma_report)
+mpi_test(ma_report_threads 1 ./ma_report 3)
+mpi_test(ma_trace 1 ./ma_trace)
+mpi_test(ma_tets_batched 1 ./ma_tets_batched 0)
+mpi_test(ma_tets_streamed 1 ./ma_tets_batched 1)
+mpi_test(ma_spread_bad 3 ./ma_spread_bad)
+mpi_test(ma_conserve 1 ./ma_conserve)
+mpi_test(ma_deterministic 1 ./ma_deterministic)
+mpi_test(ma_uniform 4 ./ma_uniform)
+mpi_test(elmFlowBalance 4 ./elmFlowBalance)
+mpi_test(elmFlowBalance_threads 4 ./elmFlowBalance 3)
+mpi_test(elmCommBalance 4 ./elmCommBalance)
+mpi_test(capacityBalance 4 ./capacityBalance)
+mpi_test(ghostCostBalance 4 ./ghostCostBalance)
+mpi_test(ptnMetrics 4 ./ptnMetrics)
+mpi_test(gmshParallel 4 ./gmshParallel)
+mpi_test(ugridParallel 4 ./ugridParallel)
+mpi_test(fieldColumn 4 ./fieldColumn)
+mpi_test(asyncWrite 1 ./asyncWrite)
+mpi_test(vtk_raw 1 ./vtk_raw)
+mpi_test(vtk_aggregate 4 ./vtk_aggregate)
+mpi_test(meshSubset 4 ./meshSubset)
+mpi_test(globalRib 3 ./globalRib)
+mpi_test(hilbertBalance 4 ./hilbertBalance)
+mpi_test(topoMap 4 ./topoMap)
 mpi_test(verify_convert 1 ./verify_convert)
+mpi_test(pcu_msg_1 1 ./pcu_msg)
+mpi_test(pcu_msg_4 4 ./pcu_msg)
 
 if(ENABLE_SIMMETRIX)
   mpi_test(in_closure_of 1
@@ -113,6 +146,7 @@ if(ENABLE_SIMMETRIX AND PCU_COMPRESS AND SIM_PARASOLID
     "${MDIR}/mesh_.smb"
     WORKING_DIRECTORY ${MDIR})
 endif()
+mpi_test(ph_redistribute 4 ./ph_redistribute)
 
 if(ENABLE_ZOLTAN)
   mpi_test(pumi3d-1p 4
@@ -133,6 +167,13 @@ if(ENABLE_OMEGA_H)
     ${MESHES}/cube/cube.dmg
     converted.smb)
 endif()
+if(ENABLE_ADIOS2)
+  mpi_test(mdsToADIOS2 1
+    ./smb2adios
+    ${MESHES}/cube/cube.dmg
+    ${MESHES}/cube/pumi670/cube.smb
+    cube.bp)
+endif()
 mpi_test(test_scaling 1
   ./test_scaling
   ${MESHES}/cube/cube.dmg
@@ -156,6 +197,24 @@ mpi_test(reorder_serial 1
   ${MESHES}/cube/cube.dmg
   ${MESHES}/cube/pumi7k/cube.smb
   cube_bfs.smb)
+mpi_test(reorder_hilbert 1
+  ./reorder
+  ${MESHES}/cube/cube.dmg
+  ${MESHES}/cube/pumi7k/cube.smb
+  cube_hilbert.smb
+  hilbert)
+mpi_test(reorder_rcm 1
+  ./reorder
+  ${MESHES}/cube/cube.dmg
+  ${MESHES}/cube/pumi7k/cube.smb
+  cube_rcm.smb
+  rcm)
+mpi_test(reorder_blocked 1
+  ./reorder
+  ${MESHES}/cube/cube.dmg
+  ${MESHES}/cube/pumi7k/cube.smb
+  cube_blocked.smb
+  blocked)
 mpi_test(create_misCube 1
   ./create_mis
   ${MESHES}/cube/cube.dmg
@@ -166,6 +225,12 @@ mpi_test(create_misSquare 1
   ${MESHES}/square/square.dmg
   ${MESHES}/square/square.smb
   mis_test)
+mpi_test(mis_bench_tet 4 ./mis_bench 8 8 8 1)
+mpi_test(mis_bench_quad 3 ./mis_bench 12 10 0 0)
+mpi_test(bench_strong 2 ./bench strong 4 4 4 1)
+mpi_test(bench_weak 2 ./bench weak 4 4 2 0)
+mpi_test(perf_check_record 2 ./perf_check record perf_check.json 4)
+mpi_test(perf_check_compare 2 ./perf_check compare perf_check.json 4 10)
 
 set(MDIR ${MESHES}/fun3d)
 mpi_test(inviscid_ugrid 4
@@ -313,6 +378,159 @@ mpi_test(verify_parallel 4
   ./verify
   "${MDIR}/pipe.${GXT}"
   "pipe_4_.smb")
+mpi_test(sync_plan 4
+  ./sync_plan
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(mds_freeze 4
+  ./mds_freeze
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(mds_adjacency_watch 4
+  ./mds_adjacency_watch
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(mds_compact 4
+  ./mds_compact
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(tag_span 4
+  ./tag_span
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(build_elements 4
+  ./build_elements
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(smb_lazy 4
+  ./smb_lazy
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(smb_agg 4 ./smb_roundtrip agg:)
+if(PCU_ZLIB)
+  mpi_test(smb_gz 4 ./smb_roundtrip gz:)
+endif()
+mpi_test(shared_with 4
+  ./shared_with
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(shape_batch 4
+  ./shape_batch
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(field_array 4
+  ./field_array
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(measure_simplices 4
+  ./measure_simplices
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(global_nodes 4
+  ./global_nodes
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(node_graph 4
+  ./node_graph
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(sync_fields 4
+  ./sync_fields
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(element_rebind 4
+  ./element_rebind
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(float_field 4
+  ./float_field
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(field_transfer 4 ./field_transfer)
+mpi_test(sharing_cache 4 ./sharing_cache)
+mpi_test(snapshot 4 ./snapshot)
+mpi_test(field_history 4 ./field_history)
+mpi_test(convert_mds 4 ./convert_mds)
+mpi_test(fix_islands 4 ./fix_islands)
+mpi_test(connectivity 4
+  ./connectivity
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(migrate_batches 4
+  ./migrate_batches
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(migrate_frozen 4
+  ./migrate_frozen
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(migrate_all 4
+  ./migrate_all
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(migrate_estimate 4
+  ./migrate_estimate
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(migrate_threads 4
+  ./migrate_threads
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(ma_profile 4
+  ./ma_profile
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(ma_length_cache 4
+  ./ma_length_cache
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(ma_tet_quality 4
+  ./ma_tet_quality
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(ma_worklist 4
+  ./ma_worklist
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(ma_refine_balance 4
+  ./ma_refine_balance
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(ma_converge 4
+  ./ma_converge
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(ma_refine_batches 4
+  ./ma_refine_batches
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(ma_vertex_transfer 4
+  ./ma_vertex_transfer
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(ma_checkpoint 4
+  ./ma_checkpoint
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(ma_size_threads 4
+  ./ma_size_threads
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(ma_layer_stacks 4
+  ./ma_layer_stacks)
+mpi_test(load_split 4
+  ./load_split
+  "${MDIR}/pipe.${GXT}"
+  "pipe_2_.smb"
+  2)
+mpi_test(cavity_independent 4
+  ./cavity_independent
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
+mpi_test(cavity_threads 4
+  ./cavity_threads
+  "${MDIR}/pipe.${GXT}"
+  "pipe_4_.smb")
 mpi_test(vtxElmMixedBalance 4
   ./vtxElmMixedBalance
   "${MDIR}/pipe.${GXT}"
@@ -334,6 +552,12 @@ mpi_test(reorder 4
   "${MDIR}/torus.dmg"
   "${MDIR}/4imb/torus.smb"
   "torusBfs4p/")
+mpi_test(reorder_morton 4
+  ./reorder
+  "${MDIR}/torus.dmg"
+  "${MDIR}/4imb/torus.smb"
+  "torusMorton4p/"
+  morton)
 mpi_test(balance 4
   ./balance
   "${MDIR}/torus.dmg"
@@ -500,6 +724,10 @@ mpi_test(change_dim 1
   ./newdim)
 mpi_test(ma_insphere 1
   ./ma_insphere)
+mpi_test(matrix_batch 1
+  ./matrix_batch)
+mpi_test(test_AD 1
+  ./test_AD)
 if(ENABLE_SIMMETRIX)
   set(MDIR ${MESHES}/upright)
   if(SIMMODSUITE_SimAdvMeshing_FOUND)
@@ -0,0 +1,104 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <apfConvert.h>
+#include <gmi_null.h>
+#include <parma.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <vector>
+
+/* builds a chain of slabs whose parts are numbered 0,2,1,3 along
+   the chain, then treats ranks in pairs as nodes. The mapping should
+   put neighbors in the chain on the same node. */
+
+namespace {
+
+int const n = 4;
+int const slabs = 8;
+
+int getSlabPart(int i) {
+  static int const order[4] = {0, 2, 1, 3};
+  return order[i * 4 / slabs];
+}
+
+apf::Mesh2* makeChain()
+{
+  static int const cubeTets[6][4] = {
+    {0,1,3,7},{0,1,7,5},{0,5,7,4},{0,3,2,7},{0,2,6,7},{0,6,4,7}};
+  int self = PCU_Comm_Self();
+  int peers = PCU_Comm_Peers();
+  int nx = slabs + 1;
+  int ny = n + 1;
+  std::vector<int> conn;
+  for (int k = 0; k < n; ++k)
+  for (int j = 0; j < n; ++j)
+  for (int i = 0; i < slabs; ++i) {
+    if (getSlabPart(i) != self)
+      continue;
+    int c[8];
+    for (int b = 0; b < 8; ++b)
+      c[b] = (i + (b & 1)) + (j + ((b >> 1) & 1)) * nx
+           + (k + ((b >> 2) & 1)) * nx * ny;
+    for (int t = 0; t < 6; ++t)
+      for (int q = 0; q < 4; ++q)
+        conn.push_back(c[cubeTets[t][q]]);
+  }
+  int verts = nx * ny * ny;
+  std::vector<double> x;
+  for (int v = self * verts / peers; v < (self + 1) * verts / peers; ++v) {
+    x.push_back(v % nx);
+    x.push_back((v / nx) % ny);
+    x.push_back(v / (nx * ny));
+  }
+  apf::Mesh2* m = apf::makeEmptyMdsMesh(gmi_load(".null"), 3, false);
+  apf::GlobalToVert g;
+  apf::construct(m, &conn[0], conn.size() / 4, apf::Mesh::TET, g);
+  apf::alignMdsRemotes(m);
+  apf::deriveMdsModel(m);
+  apf::setCoords(m, &x[0], x.size() / 3, g);
+  m->acceptChanges();
+  m->verify();
+  return m;
+}
+
+/* shared vertex copies on other nodes */
+long countOffNode(apf::Mesh* m, int ranksPerNode) {
+  long off = 0;
+  int node = PCU_Comm_Self() / ranksPerNode;
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::Copies remotes;
+    m->getRemotes(v, remotes);
+    APF_ITERATE(apf::Copies, remotes, rit)
+      if (rit->first / ranksPerNode != node)
+        ++off;
+  }
+  m->end(it);
+  return PCU_Add_Long(off);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(PCU_Comm_Peers() == 4);
+  gmi_register_null();
+  apf::Mesh2* m = makeChain();
+  long elms = PCU_Add_Long(m->count(3));
+  long before = countOffNode(m, 2);
+  Parma_MapToTopology(m, 2, 1);
+  long after = countOffNode(m, 2);
+  if (!PCU_Comm_Self())
+    printf("off-node vertex copies %ld -> %ld\n", before, after);
+  PCU_ALWAYS_ASSERT(after < before);
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(m->count(3)) == elms);
+  m->verify();
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
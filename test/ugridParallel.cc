@@ -0,0 +1,234 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_null.h>
+#include <PCU.h>
+#include <pcu_byteorder.h>
+#include <pcu_io.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <vector>
+
+/* writes a box of hexes and prisms as little and big endian UGRID
+   files and a partition vector of slabs, then loads them across
+   all ranks and checks the entity counts, the tags and the
+   coordinates, and that elements follow the partition vector */
+
+namespace {
+
+int const n = 4;
+
+struct Box {
+  std::vector<double> xyz;
+  std::vector<unsigned> tris, quads, triTags, quadTags, prisms, hexes;
+};
+
+unsigned vtxId(int i, int j, int k)
+{
+  return 1 + i + (j + k * (n + 1)) * (n + 1);
+}
+
+/* cells with x below the middle are hexes, the others are split
+   into two prisms along the diagonal of their bottom */
+void makeBox(Box& b)
+{
+  for (int k = 0; k <= n; ++k)
+  for (int j = 0; j <= n; ++j)
+  for (int i = 0; i <= n; ++i) {
+    b.xyz.push_back(i);
+    b.xyz.push_back(j);
+    b.xyz.push_back(k);
+  }
+  for (int k = 0; k < n; ++k)
+  for (int j = 0; j < n; ++j)
+  for (int i = 0; i < n; ++i) {
+    unsigned c[8] = {
+      vtxId(i, j, k), vtxId(i + 1, j, k),
+      vtxId(i + 1, j + 1, k), vtxId(i, j + 1, k),
+      vtxId(i, j, k + 1), vtxId(i + 1, j, k + 1),
+      vtxId(i + 1, j + 1, k + 1), vtxId(i, j + 1, k + 1)};
+    if (i < n / 2) {
+      b.hexes.insert(b.hexes.end(), c, c + 8);
+    } else {
+      unsigned p[2][6] = {
+        {c[0], c[1], c[2], c[4], c[5], c[6]},
+        {c[0], c[2], c[3], c[4], c[6], c[7]}};
+      b.prisms.insert(b.prisms.end(), p[0], p[0] + 6);
+      b.prisms.insert(b.prisms.end(), p[1], p[1] + 6);
+    }
+  }
+  /* the sides x, y and z at 0 and n */
+  for (int a = 0; a < 3; ++a)
+  for (int s = 0; s < 2; ++s)
+  for (int v = 0; v < n; ++v)
+  for (int u = 0; u < n; ++u) {
+    int q[4][3];
+    int du[4] = {0, 1, 1, 0};
+    int dv[4] = {0, 0, 1, 1};
+    for (int c = 0; c < 4; ++c) {
+      q[c][a] = s * n;
+      q[c][(a + 1) % 3] = u + du[c];
+      q[c][(a + 2) % 3] = v + dv[c];
+    }
+    unsigned ids[4];
+    for (int c = 0; c < 4; ++c)
+      ids[c] = vtxId(q[c][0], q[c][1], q[c][2]);
+    int tag = a * 2 + s + 1;
+    /* z sides of the prism half are cut like the prism bottoms */
+    if (a == 2 && u >= n / 2) {
+      unsigned t[2][3] = {{ids[0], ids[1], ids[2]}, {ids[0], ids[2], ids[3]}};
+      for (int h = 0; h < 2; ++h) {
+        b.tris.insert(b.tris.end(), t[h], t[h] + 3);
+        b.triTags.push_back(tag);
+      }
+    } else {
+      b.quads.insert(b.quads.end(), ids, ids + 4);
+      b.quadTags.push_back(tag);
+    }
+  }
+}
+
+void writeUnsigneds(FILE* f, std::vector<unsigned> v, bool swap)
+{
+  if (v.empty())
+    return;
+  if (swap)
+    pcu_swap_unsigneds(&v[0], v.size());
+  fwrite(&v[0], sizeof(unsigned), v.size(), f);
+}
+
+void writeBox(Box const& b, const char* path, bool swap)
+{
+  FILE* f = fopen(path, "wb");
+  std::vector<unsigned> h(7);
+  h[0] = b.xyz.size() / 3;
+  h[1] = b.tris.size() / 3;
+  h[2] = b.quads.size() / 4;
+  h[3] = 0;
+  h[4] = 0;
+  h[5] = b.prisms.size() / 6;
+  h[6] = b.hexes.size() / 8;
+  writeUnsigneds(f, h, swap);
+  std::vector<double> xyz(b.xyz);
+  if (swap)
+    pcu_swap_doubles(&xyz[0], xyz.size());
+  fwrite(&xyz[0], sizeof(double), xyz.size(), f);
+  writeUnsigneds(f, b.tris, swap);
+  writeUnsigneds(f, b.quads, swap);
+  writeUnsigneds(f, b.triTags, swap);
+  writeUnsigneds(f, b.quadTags, swap);
+  writeUnsigneds(f, b.prisms, swap);
+  writeUnsigneds(f, b.hexes, swap);
+  fclose(f);
+}
+
+/* the part of each vertex is its slab of z */
+int getPart(int id)
+{
+  int k = id / ((n + 1) * (n + 1));
+  return k * PCU_Comm_Peers() / (n + 1);
+}
+
+void writePtn(const char* path)
+{
+  FILE* f = fopen(path, "w");
+  for (int id = 0; id < (n + 1) * (n + 1) * (n + 1); ++id)
+    fprintf(f, "%d\n", getPart(id));
+  fclose(f);
+}
+
+void checkBox(apf::Mesh2* m, Box const& b, bool partitioned)
+{
+  apf::deriveMdsModel(m);
+  m->verify();
+  apf::MeshTag* ids = m->findTag("ugrid-vtx-ids");
+  apf::MeshTag* tags = m->findTag("ugrid-face-tag");
+  PCU_ALWAYS_ASSERT(ids && tags);
+  long counts[4] = {0, 0, 0, 0};
+  double x[4] = {0, 0, 0, 0};
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    if (!m->isOwned(e))
+      continue;
+    ++counts[0];
+    apf::Vector3 p;
+    m->getPoint(e, 0, p);
+    int id;
+    m->getIntTag(e, ids, &id);
+    for (int j = 0; j < 3; ++j)
+      x[j] += p[j];
+    x[3] += id;
+  }
+  m->end(it);
+  it = m->begin(2);
+  while ((e = m->iterate(it)))
+    if (m->isOwned(e) && m->hasTag(e, tags)) {
+      int tag;
+      m->getIntTag(e, tags, &tag);
+      ++counts[1];
+      counts[2] += tag;
+    }
+  m->end(it);
+  it = m->begin(3);
+  while ((e = m->iterate(it))) {
+    ++counts[3];
+    if (partitioned) {
+      apf::Downward verts;
+      m->getDownward(e, 0, verts);
+      int id;
+      m->getIntTag(verts[0], ids, &id);
+      PCU_ALWAYS_ASSERT(getPart(id) == PCU_Comm_Self());
+    }
+  }
+  m->end(it);
+  PCU_Add_Longs(counts, 4);
+  PCU_Add_Doubles(x, 4);
+  long nverts = b.xyz.size() / 3;
+  long faces = b.triTags.size() + b.quadTags.size();
+  long tagSum = 0;
+  for (size_t i = 0; i < b.triTags.size(); ++i)
+    tagSum += b.triTags[i];
+  for (size_t i = 0; i < b.quadTags.size(); ++i)
+    tagSum += b.quadTags[i];
+  PCU_ALWAYS_ASSERT(counts[0] == nverts);
+  PCU_ALWAYS_ASSERT(counts[1] == faces);
+  PCU_ALWAYS_ASSERT(counts[2] == tagSum);
+  PCU_ALWAYS_ASSERT(counts[3] == long(b.prisms.size() / 6 + b.hexes.size() / 8));
+  double sum = (n + 1) * (n + 1) * n * (n + 1) / 2.0;
+  for (int j = 0; j < 3; ++j)
+    PCU_ALWAYS_ASSERT(x[j] == sum);
+  PCU_ALWAYS_ASSERT(x[3] == nverts * (nverts - 1) / 2.0);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 1);
+  gmi_register_null();
+  Box b;
+  makeBox(b);
+  bool bigHost = (PCU_HOST_ORDER == PCU_BIG_ENDIAN);
+  const char* paths[2] = {"box.lb8.ugrid", "box.b8.ugrid"};
+  if (!PCU_Comm_Self()) {
+    writeBox(b, paths[0], bigHost);
+    writeBox(b, paths[1], !bigHost);
+    writePtn("box.ptn");
+  }
+  PCU_Barrier();
+  for (int i = 0; i < 2; ++i)
+  for (int p = 0; p < 2; ++p) {
+    apf::Mesh2* m = apf::loadMdsFromUgridParallel(gmi_load(".null"),
+        paths[i], p ? "box.ptn" : 0);
+    checkBox(m, b, p);
+    m->destroyNative();
+    apf::destroyMesh(m);
+  }
+  if (!PCU_Comm_Self())
+    printf("UGRID box loaded in parallel\n");
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
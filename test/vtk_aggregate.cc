@@ -0,0 +1,105 @@
+#include <apf.h>
+#include <apfBox.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_null.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* writes a distributed box with a field as one VTK file per part
+   and as aggregated files shared by several parts, then reads both
+   back and checks that the aggregated files hold the same pieces in
+   part order and that the .pvtu lists only the shared files */
+
+namespace {
+
+int const files = 2;
+
+std::string readFile(const char* path)
+{
+  std::ifstream file(path, std::ios::binary);
+  PCU_ALWAYS_ASSERT(file.is_open());
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+/* appends the <Piece> elements of (text) to (pieces) */
+void getPieces(std::string const& text, std::vector<std::string>& pieces)
+{
+  size_t at = 0;
+  while ((at = text.find("<Piece", at)) != std::string::npos) {
+    size_t end = text.find("</Piece>", at);
+    PCU_ALWAYS_ASSERT(end != std::string::npos);
+    end += 8;
+    pieces.push_back(text.substr(at, end - at));
+    at = end;
+  }
+}
+
+int countSources(std::string const& pvtu)
+{
+  int n = 0;
+  size_t at = 0;
+  while ((at = pvtu.find("<Piece Source=", at)) != std::string::npos) {
+    ++n;
+    ++at;
+  }
+  return n;
+}
+
+void check()
+{
+  int peers = PCU_Comm_Peers();
+  PCU_ALWAYS_ASSERT(countSources(readFile("agg_box/agg_box.pvtu")) == files);
+  std::vector<std::string> parts;
+  for (int i = 0; i < peers; ++i) {
+    std::stringstream ss;
+    ss << "part_box/0/" << i << ".vtu";
+    getPieces(readFile(ss.str().c_str()), parts);
+  }
+  std::vector<std::string> shared;
+  for (int i = 0; i < files; ++i) {
+    std::stringstream ss;
+    ss << "agg_box/0/" << i << ".vtu";
+    getPieces(readFile(ss.str().c_str()), shared);
+  }
+  PCU_ALWAYS_ASSERT(parts.size() == size_t(peers));
+  PCU_ALWAYS_ASSERT(shared == parts);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 1);
+  gmi_register_null();
+  apf::Mesh2* m = apf::makeDistributedMdsBox(6, 6, 6, 1, 1, 1, true);
+  apf::Field* f = apf::createFieldOn(m, "u", apf::SCALAR);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    apf::setScalar(f, v, 0, x[0] + 10 * x[1] + 100 * x[2]);
+  }
+  m->end(it);
+  apf::writeVtkFiles("part_box", m);
+  apf::writeAggregatedVtkFiles("agg_box", m, files);
+  PCU_Barrier();
+  if (!PCU_Comm_Self()) {
+    check();
+    printf("%d parts read back from %d files\n", PCU_Comm_Peers(), files);
+  }
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,119 @@
+#include <apf.h>
+#include <apfBox.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <gmi_null.h>
+#include <lionCompress.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* writes a box with a field as VTK files with raw appended arrays
+   and with base64 arrays, on one and on several compression threads,
+   checks that the threads do not change the files (the arrays span
+   several compression blocks), and reads the coordinates and field
+   back from the raw appended data */
+
+namespace {
+
+std::string readFile(const char* path)
+{
+  std::ifstream file(path, std::ios::binary);
+  PCU_ALWAYS_ASSERT(file.is_open());
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+double getValue(apf::Vector3 const& x)
+{
+  return x[0] + 10 * x[1] + 100 * x[2];
+}
+
+/* the uncompressed values of the appended array (name) */
+void readRawArray(std::string const& vtu, const char* name,
+    std::vector<double>& values)
+{
+  std::string key = std::string("Name=\"") + name + "\"";
+  size_t at = vtu.find(key);
+  PCU_ALWAYS_ASSERT(at != std::string::npos);
+  at = vtu.find("offset=\"", at);
+  PCU_ALWAYS_ASSERT(at != std::string::npos);
+  size_t offset = atol(vtu.c_str() + at + 8);
+  std::string start = "<AppendedData encoding=\"raw\">\n_";
+  size_t data = vtu.find(start);
+  PCU_ALWAYS_ASSERT(data != std::string::npos);
+  data += start.size() + offset;
+  unsigned bytes;
+  memcpy(&bytes, vtu.data() + data, sizeof(bytes));
+  values.resize(bytes / sizeof(double));
+  if (bytes)
+    memcpy(&values[0], vtu.data() + data + sizeof(bytes), bytes);
+}
+
+void checkRaw(apf::Mesh* m, std::string const& vtu)
+{
+  std::vector<double> coords;
+  std::vector<double> values;
+  readRawArray(vtu, "coordinates", coords);
+  readRawArray(vtu, "u", values);
+  PCU_ALWAYS_ASSERT(coords.size() == 3 * m->count(0));
+  PCU_ALWAYS_ASSERT(values.size() == m->count(0));
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  size_t i = 0;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    for (int j = 0; j < 3; ++j)
+      PCU_ALWAYS_ASSERT(coords[3 * i + j] == x[j]);
+    PCU_ALWAYS_ASSERT(values[i] == getValue(x));
+    ++i;
+  }
+  m->end(it);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  PCU_ALWAYS_ASSERT(argc == 1);
+  gmi_register_null();
+  apf::Mesh2* m = apf::makeMdsBox(36, 36, 36, 1, 1, 1, true);
+  apf::Field* f = apf::createFieldOn(m, "u", apf::SCALAR);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    apf::setScalar(f, v, 0, getValue(x));
+  }
+  m->end(it);
+  apf::writeRawVtkFiles("raw_box", m);
+  apf::writeVtkFiles("b64_box", m);
+  apf::setVtkThreads(4);
+  apf::writeRawVtkFiles("raw_box_threads", m);
+  apf::writeVtkFiles("b64_box_threads", m);
+  apf::setVtkThreads(1);
+  std::string raw = readFile("raw_box/0/0.vtu");
+  PCU_ALWAYS_ASSERT(raw == readFile("raw_box_threads/0/0.vtu"));
+  PCU_ALWAYS_ASSERT(readFile("b64_box/0/0.vtu") ==
+                    readFile("b64_box_threads/0/0.vtu"));
+  PCU_ALWAYS_ASSERT(raw != readFile("b64_box/0/0.vtu"));
+  if (!lion::can_compress)
+    checkRaw(m, raw);
+  else
+    printf("compressed arrays are not read back\n");
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -1,6 +1,8 @@
 #include <PCU.h>
 #include "apfZoltan.h"
+#include "apfZoltanMesh.h"
 #include <apfMesh.h>
+#include <apf.h>
 #include <pcu_util.h>
 
 namespace apf {
@@ -36,11 +38,9 @@ static long getElementGid(GlobalNumbering* gn, MeshEntity* e)
   return getNumber(gn, Node(e, 0));
 }
 
-static void packOtherGid(GlobalNumbering* gn, MeshEntity* s)
+static void packOtherGid(Mesh* m, MeshEntity* s, long gid)
 {
-  Mesh* m = getMesh(gn);
   Copy other = getOtherSide(m, s);
-  long gid = getElementGid(gn, getSideElement(m, s));
   PCU_COMM_PACK(other.peer, other.entity);
   PCU_COMM_PACK(other.peer, gid);
 }
@@ -64,7 +64,7 @@ MeshTag* tagOpposites(GlobalNumbering* gn, const char* name)
   MeshEntity* e;
   while ((e = m->iterate(it)))
     if (hasOtherSide(m, e))
-      packOtherGid(gn, e);
+      packOtherGid(m, e, getElementGid(gn, getSideElement(m, e)));
   m->end(it);
   PCU_Comm_Send();
   while (PCU_Comm_Receive())
@@ -113,4 +113,90 @@ int* getElementToElement(apf::Mesh* m)
   return e2e;
 }
 
+/* element ids are the iteration order offset by an Exscan,
+   as numberElements and makeGlobal would give them, found
+   through a temporary tag of local ids */
+void buildDualGraph(Mesh* m, bool local, bool withVertices, DualGraph& g)
+{
+  int dim = m->getDimension();
+  g.elements = m->getConnectivity(dim).elements;
+  int n = g.elements.size();
+  long first = local ? 0 : PCU_Exscan_Long(n);
+  MeshTag* index = m->createIntTag("zb_index", 1);
+  g.ids.resize(n);
+  for (int i = 0; i < n; ++i) {
+    m->setIntTag(g.elements[i], index, &i);
+    g.ids[i] = first + i;
+  }
+  MeshTag* opposites = 0;
+  if (!local) {
+    opposites = m->createLongTag("zb_opposite", 1);
+    PCU_Comm_Begin();
+    MeshIterator* it = m->begin(dim - 1);
+    MeshEntity* s;
+    while ((s = m->iterate(it)))
+      if (hasOtherSide(m, s)) {
+        int i;
+        m->getIntTag(getSideElement(m, s), index, &i);
+        packOtherGid(m, s, first + i);
+      }
+    m->end(it);
+    PCU_Comm_Send();
+    while (PCU_Comm_Receive())
+      unpackOtherGid(m, opposites);
+  }
+  int self = m->getId();
+  g.offsets.assign(1, 0);
+  g.adjacent.clear();
+  g.parts.clear();
+  for (int i = 0; i < n; ++i) {
+    MeshEntity* e = g.elements[i];
+    Downward sides;
+    int ns = m->getDownward(e, dim - 1, sides);
+    for (int j = 0; j < ns; ++j) {
+      Up up;
+      m->getUp(sides[j], up);
+      if (up.n == 2) {
+        int k;
+        m->getIntTag(up.e[0] == e ? up.e[1] : up.e[0], index, &k);
+        g.adjacent.push_back(first + k);
+        g.parts.push_back(local ? 0 : self);
+      } else if (up.n == 1 && opposites && m->hasTag(sides[j], opposites)) {
+        long gid;
+        m->getLongTag(sides[j], opposites, &gid);
+        g.adjacent.push_back(gid);
+        g.parts.push_back(getOtherSide(m, sides[j]).peer);
+      }
+    }
+    g.offsets.push_back(g.adjacent.size());
+  }
+  removeTagFromDimension(m, index, dim);
+  m->destroyTag(index);
+  if (opposites) {
+    removeTagFromDimension(m, opposites, dim - 1);
+    m->destroyTag(opposites);
+  }
+  g.vertexOffsets.clear();
+  g.vertices.clear();
+  if (withVertices) {
+    Connectivity const& c = m->getConnectivity(dim);
+    g.vertexOffsets = c.offsets;
+    g.vertices.resize(c.vertices.size());
+    if (local) {
+      Numbering* ln = numberOverlapNodes(m, "zoltan_vtx");
+      for (size_t i = 0; i < c.vertices.size(); ++i)
+        g.vertices[i] = getNumber(ln, c.vertices[i], 0, 0);
+      destroyNumbering(ln);
+    } else {
+      GlobalNumbering* gn = numberGlobalNodes(m, "zoltan_vtx");
+      for (size_t i = 0; i < c.vertices.size(); ++i)
+        g.vertices[i] = getNumber(gn, Node(c.vertices[i], 0));
+      destroyGlobalNumbering(gn);
+    }
+  }
+  g.changes = m->countChanges();
+  g.built = true;
+  g.hasVertices = withVertices;
+}
+
 }
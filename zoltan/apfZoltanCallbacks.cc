@@ -75,30 +75,14 @@ static int setZoltanLbApproach(struct Zoltan_Struct* ztn, ZoltanMesh* zb)
   return 0;
 }
 
-static long get(MeshEntity* e, ZoltanMesh *zz)
-{
-  if (!zz->isLocal)
-    return getNumber(zz->global,Node(e,0));
-  else
-    return getNumber(zz->local, e, 0, 0);
-}
-
-static int getPartId(Mesh* m, MeshEntity* s)
-{
-  if (m->isShared(s))
-    return getOtherCopy(m, s).peer;
-  Matches matches;
-  m->getMatches(s, matches);
-  PCU_ALWAYS_ASSERT(matches.getSize() == 1);
-  return matches[0].peer;
-}
+/* the callbacks below answer from the cached dual graph */
 
 //ZOLTAN_NUM_OBJ_FN_TYPE
 int zoltanCountNodes(void* data, int* ierr)
 {
   ZoltanMesh* zb = static_cast<ZoltanMesh*>(data);
   *ierr=ZOLTAN_OK;
-  return zb->elements.getSize();
+  return zb->graph.elements.size();
 }
 
 //ZOLTAN_OBJ_LIST_FN_TYPE
@@ -107,21 +91,18 @@ void zoltanGetNodes(void* data, int ngid, int nlid,
     float* weights, int* ierr)
 {
   ZoltanMesh* zb = static_cast<ZoltanMesh*>(data);
+  DualGraph& g = zb->graph;
   *ierr=ZOLTAN_OK;
-  for (size_t ind=0;ind<zb->elements.getSize();ind++) {
+  std::vector<double> w(nweights);
+  for (size_t ind=0;ind<g.elements.size();ind++) {
     lids[ind*nlid]=ind;
-    MeshEntity *ent = zb->elements[ind];
-    gids[ind*ngid]= get(ent, zb);
-    double* w = (double*)calloc(nweights,sizeof(double));
-    zb->mesh->getDoubleTag(ent,zb->weights,w);
+    gids[ind*ngid]=g.ids[ind];
+    if (!nweights)
+      continue;
+    zb->mesh->getDoubleTag(g.elements[ind],zb->weights,&w[0]);
     for (int i=0;i<nweights;i++)
       weights[ind*nweights+i]=w[i];
-    free(w);
   }
-
-  //if weights arent being used
-  if (nweights==0)
-    weights=NULL;
 }
 
 //ZOLTAN_NUM_EDGES_FN_TYPE
@@ -129,24 +110,9 @@ int zoltanCountEdges(void* data, int, int,
     ZOLTAN_ID_PTR, ZOLTAN_ID_PTR lid, int* ierr)
 {
   ZoltanMesh* zb = static_cast<ZoltanMesh*>(data);
-  int edges = 0;
-  MeshEntity* element=zb->elements[*lid];
-  Mesh* mesh = zb->mesh;
-  int dim = getDimension(mesh, element);
-  Downward faces;
-  int nfaces;
-  nfaces = mesh->getDownward(element,dim-1,faces);
-  for (int i=0;i<nfaces;i++) {
-    MeshEntity* face = faces[i];
-    Up elements;
-    mesh->getUp(face,elements);
-    if (elements.n==2)
-      edges++;
-    else if (elements.n==1&&!zb->isLocal&&mesh->hasTag(face,zb->opposite))
-      edges++;
-  }
+  DualGraph& g = zb->graph;
   *ierr = ZOLTAN_OK;
-  return edges;
+  return g.offsets[*lid + 1] - g.offsets[*lid];
 }
 
 //ZOLTAN_EDGE_LIST_FN_TYPE
@@ -156,32 +122,12 @@ void zoltanGetEdges(void* data, int ngid, int,
     int, float*, int* ierr)
 {
   ZoltanMesh* zb = static_cast<ZoltanMesh*>(data);
-  MeshEntity* element=zb->elements[*lid];
-  Mesh* mesh = zb->mesh;
-  int dim = getDimension(mesh, element);
-  Downward faces;
-  int nfaces;
-  nfaces = mesh->getDownward(element,dim-1,faces);
+  DualGraph& g = zb->graph;
   int ind=0;
-  for (int i=0;i<nfaces;i++) {
-    MeshEntity* face = faces[i];
-    Up elements;
-    mesh->getUp(face,elements);
-    if (elements.n==2) {
-      MeshEntity* ent = elements.e[0];
-      if (element==ent)
-        ent=elements.e[1];
-      gids[ngid*ind] = get(ent,zb);
-      pids[ind] = zb->isLocal ? 0 : mesh->getId();
-      ind++;
-    }
-    else if (elements.n==1&&!zb->isLocal&&mesh->hasTag(face,zb->opposite)) {
-      long value;
-      mesh->getLongTag(face,zb->opposite,&value);
-      gids[ngid*ind]=value;
-      pids[ind]=getPartId(mesh,face);
-      ind++;
-    }
+  for (int j=g.offsets[*lid];j<g.offsets[*lid + 1];j++) {
+    gids[ngid*ind] = g.adjacent[j];
+    pids[ind] = g.parts[j];
+    ind++;
   }
   *ierr = ZOLTAN_OK;
 }
@@ -192,7 +138,7 @@ void getCentroid(void *data, int, int,
     int *ierr)
 {
   ZoltanMesh* zb = static_cast<ZoltanMesh*>(data);
-  getLinearCentroid(zb->mesh,zb->elements[*lid]).toArray(coords);
+  getLinearCentroid(zb->mesh,zb->graph.elements[*lid]).toArray(coords);
   *ierr=ZOLTAN_OK;
 }
 
@@ -208,35 +154,15 @@ void getHg(void* data, int ngid, int, int totAdjVtx, int,
     int *ierr)
 {
   ZoltanMesh* zb = static_cast<ZoltanMesh*>(data);
-  Numbering* ln = NULL;
-  GlobalNumbering* gn = NULL;
-  if( zb->isLocal ) {
-    ln = numberOverlapNodes(zb->mesh, "zoltan_vtx");
-  } else {
-    gn = makeGlobal(numberOwnedNodes(zb->mesh, "zoltan_vtx"));
-    synchronize(gn);
+  DualGraph& g = zb->graph;
+  PCU_ALWAYS_ASSERT(g.hasVertices);
+  for (size_t ind=0;ind<g.elements.size();ind++) {
+    elmIds[ind*ngid]=g.ids[ind];
+    adjVtxIdx[ind]=g.vertexOffsets[ind];
   }
-  Downward verts;
-  int prevCnt = adjVtxIdx[0] = 0;
-  for (size_t ind=0;ind<zb->elements.getSize();ind++) {
-    MeshEntity* elm = zb->elements[ind];
-    elmIds[ind*ngid]= get(elm, zb);
-    adjVtxIdx[ind] = prevCnt;
-    int nv = prevCnt = zb->mesh->getDownward(elm, 0, verts);
-    prevCnt += adjVtxIdx[ind];
-    for(int i=0; i<nv; i++) {
-      //add get(...) support for vertices???
-      const int avIdx = (adjVtxIdx[ind]+i)*ngid;
-      PCU_ALWAYS_ASSERT(totAdjVtx > avIdx);
-      long gid = zb->isLocal ?
-        getNumber(ln,verts[i],0,0) : getNumber(gn,Node(verts[i],0));
-      adjVtx[avIdx] = gid;
-    }
-  }
-  if( zb->isLocal )
-    destroyNumbering(ln);
-  else
-    destroyGlobalNumbering(gn);
+  PCU_ALWAYS_ASSERT(totAdjVtx >= (int)g.vertices.size());
+  for (size_t i=0;i<g.vertices.size();i++)
+    adjVtx[i*ngid]=g.vertices[i];
   *ierr=ZOLTAN_OK;
 }
 
@@ -247,17 +173,10 @@ void getHgSize(void* data,
     int* format, //out - hardcoded to compressed vtx
     int* ierr) {
   ZoltanMesh* zb = static_cast<ZoltanMesh*>(data);
-
+  DualGraph& g = zb->graph;
   *format = ZOLTAN_COMPRESSED_VERTEX;
-  *numElms = zb->elements.getSize();
-
-  *numAdjVtx = 0;
-  for (size_t i=0;i<zb->elements.getSize();i++) {
-    MeshEntity* elm = zb->elements[i];
-    const int type = zb->mesh->getType(elm);
-    const int nsides = apf::Mesh::adjacentCount[type][0];
-    *numAdjVtx += nsides;
-  }
+  *numElms = g.elements.size();
+  *numAdjVtx = g.vertices.size();
   *ierr=ZOLTAN_OK;
 }
 
@@ -382,7 +301,7 @@ void ZoltanData::ptn()
 
 void ZoltanData::getExport(int ind, int *localId, int *export_part)
 {
-  PCU_ALWAYS_ASSERT(export_lids[ind]<zb->elements.getSize());
+  PCU_ALWAYS_ASSERT(export_lids[ind]<zb->graph.elements.size());
   *localId = export_lids[ind];
   *export_part = export_to_part[ind];
 }
@@ -24,44 +24,24 @@ ZoltanMesh::ZoltanMesh(Mesh* mesh_, bool isLocal_, int method_, int approach_,
   debug = dbg;
   tolerance = 0;
   multiple = 0;
-  local = 0;
-  global = 0;
-  opposite = 0;
 }
 
 ZoltanMesh::~ZoltanMesh()
 {
-  if (local)
-    destroyNumbering(local);
-  if (global)
-    destroyGlobalNumbering(global);
-  if (opposite) {
-    const int sideDim = mesh->getDimension() - 1;
-    removeTagFromDimension(mesh, opposite, sideDim);
-    mesh->destroyTag(opposite);
-  }
 }
 
-static void getElements(ZoltanMesh* b)
+/* the dual graph is rebuilt only after the mesh structure
+   changes, which every part must agree on for a global graph */
+static void updateGraph(ZoltanMesh* b)
 {
-  Mesh* m = b->mesh;
-  b->elements.setSize(m->count(m->getDimension()));
-  MeshIterator* it = m->begin(m->getDimension());
-  MeshEntity* e;
-  size_t i = 0;
-  while ((e = m->iterate(it)))
-    b->elements[i++] = e;
-  PCU_ALWAYS_ASSERT(i == b->elements.getSize());
-  m->end(it);
-}
-
-static void setupNumberings(ZoltanMesh* b)
-{
-  b->local = numberElements(b->mesh, "zoltan_element");
-  if (!b->isLocal) {
-    Numbering* tmp = numberElements(b->mesh, "zoltan");
-    b->global = makeGlobal(tmp);
-  }
+  DualGraph& g = b->graph;
+  bool withVertices = (b->method == HYPERGRAPH);
+  bool stale = !g.built || g.changes != b->mesh->countChanges() ||
+    (withVertices && !g.hasVertices);
+  if (!b->isLocal)
+    stale = PCU_Or(stale);
+  if (stale)
+    buildDualGraph(b->mesh, b->isLocal, withVertices, g);
 }
 
 static Migration* convertResult(ZoltanMesh* b, ZoltanData* ztn)
@@ -72,7 +52,7 @@ static Migration* convertResult(ZoltanMesh* b, ZoltanData* ztn)
     int lid;
     int exportPart;
     ztn->getExport(ind,&lid,&exportPart);
-    plan->send(b->elements[lid],exportPart);
+    plan->send(b->graph.elements[lid],exportPart);
   }
   return plan;
 }
@@ -82,10 +62,7 @@ Migration* ZoltanMesh::run(MeshTag* w, double tol, int mult)
   weights = w;
   tolerance = tol;
   multiple = mult;
-  setupNumberings(this);
-  getElements(this);
-  if (!isLocal)
-    opposite = tagOpposites(global, "zb_opposite");
+  updateGraph(this);
   ZoltanData ztn(this);
   ztn.run();
   return convertResult(this, &ztn);
@@ -10,9 +10,39 @@
 
 #include <apfMesh.h>
 #include <apfNumbering.h>
+#include <vector>
 
 namespace apf {
 
+/* the element dual graph of a mesh part in compressed rows,
+   kept by the Zoltan adapter while the mesh does not change */
+struct DualGraph
+{
+  DualGraph():changes(0),built(false),hasVertices(false) {}
+  /* the elements in mesh iteration order, local id (i) is elements[i] */
+  std::vector<MeshEntity*> elements;
+  /* element (i) has id ids[i], global unless the graph is local */
+  std::vector<long> ids;
+  /* the neighbors of element (i) are adjacent[offsets[i]] up to
+     adjacent[offsets[i + 1]], each on part parts[j] */
+  std::vector<int> offsets;
+  std::vector<long> adjacent;
+  std::vector<int> parts;
+  /* the vertex ids of element (i) are vertices[vertexOffsets[i]]
+     up to vertices[vertexOffsets[i + 1]], for hypergraphs */
+  std::vector<int> vertexOffsets;
+  std::vector<long> vertices;
+  unsigned long changes;
+  bool built;
+  bool hasVertices;
+};
+
+/* builds (g) for the current mesh. a local graph numbers the
+   elements of this part alone and leaves out the neighbors on
+   other parts, a global one is collective. the element to
+   vertex lists are only made if (withVertices) */
+void buildDualGraph(Mesh* m, bool local, bool withVertices, DualGraph& g);
+
 class ZoltanMesh
 {
   public:
@@ -28,10 +58,7 @@ class ZoltanMesh
     bool debug;
     double tolerance;
     int multiple;
-    Numbering* local;
-    DynamicArray<MeshEntity*> elements;
-    GlobalNumbering* global;
-    MeshTag* opposite;
+    DualGraph graph;
 };
 
 }